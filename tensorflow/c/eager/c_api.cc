@@ -879,7 +879,7 @@ void TFE_OpSetAttrValueProto(const TFE_Op* op, const char* attr_name,
   }
   tensorflow::EagerOperation* operation =
       OperationFromInterface(tensorflow::unwrap(const_cast<TFE_Op*>(op)));
-  operation->MutableAttrs()->Set(attr_name, attr_value);
+  status->status = operation->SetAttrValue(attr_name, attr_value);
 }
 
 TF_CAPI_EXPORT extern int TFE_OpGetInputLength(TFE_Op* op,
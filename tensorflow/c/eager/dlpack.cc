@@ -27,6 +27,15 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/platform/logging.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "xla/stream_executor/event.h"
+#include "xla/stream_executor/gpu/gpu_driver.h"
+#include "xla/stream_executor/gpu/gpu_event.h"
+#include "xla/stream_executor/gpu/gpu_executor.h"
+#include "xla/stream_executor/gpu/gpu_types.h"
+#include "xla/stream_executor/stream.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
 namespace {
@@ -64,6 +73,45 @@ const Tensor* GetTensorFromHandle(TFE_TensorHandle* h, TF_Status* status) {
   return tensor;
 }
 
+// Makes the pending writes to the tensor of `handle` visible to the consumer
+// stream `stream`, see TFE_HandleToDLPackWithStream.
+Status SyncWithConsumerStream(TensorHandle* handle, int64_t stream) {
+  Device* device = handle->device();
+  if (device == nullptr || stream == -1) {
+    return OkStatus();
+  }
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  if (stream != 0 && device_info != nullptr &&
+      device_info->stream != nullptr) {
+    // Orders the consumer stream after the work enqueued so far on the compute
+    // stream, instead of blocking the host until the whole device is idle.
+    se::Stream* compute_stream = device_info->stream;
+    se::Event event(compute_stream->parent());
+    if (!event.Init()) {
+      return errors::Internal("Failed to create an event for DLPack");
+    }
+    compute_stream->ThenRecordEvent(&event);
+    if (!compute_stream->ok()) {
+      return errors::Internal("Failed to record an event for DLPack");
+    }
+    // The event is released once the consumer stream has waited for it.
+    if (!se::gpu::GpuDriver::WaitStreamOnEvent(
+            se::gpu::ExtractGpuExecutor(compute_stream->parent())
+                ->gpu_context(),
+            reinterpret_cast<se::gpu::GpuStreamHandle>(stream),
+            static_cast<se::gpu::GpuEvent*>(event.implementation())
+                ->gpu_event())) {
+      return errors::Internal("Failed to make stream ", stream,
+                              " wait for the DLPack tensor");
+    }
+    return OkStatus();
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return device->Sync();
+}
+
 // Deleter for DLManagedTensor
 void DLManagedTensorDeleter(DLManagedTensor* arg) {
   TfDlManagedTensorCtx* owner =
@@ -277,17 +325,28 @@ void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
 }
 
 void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
+  return TFE_HandleToDLPackWithStream(h, /*stream=*/0, status);
+}
+
+void* TFE_HandleToDLPackWithStream(TFE_TensorHandle* h, int64_t stream,
+                                   TF_Status* status) {
   auto tf_dlm_context = GetDlContext(h, status);
   if (!status->status.ok()) {
     return nullptr;
   }
 
-  auto* tf_dlm_data = TFE_TensorHandleDevicePointer(h, status);
+  const Tensor* tensor = GetTensorFromHandle(h, status);
   if (!status->status.ok()) {
     return nullptr;
   }
+  status->status = SyncWithConsumerStream(
+      TensorHandleFromInterface(unwrap(h)), stream);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  void* tf_dlm_data =
+      const_cast<void*>(static_cast<const void*>(tensor->tensor_data().data()));
 
-  const Tensor* tensor = GetTensorFromHandle(h, status);
   TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
 
   auto tf_dlm_type = GetDlDataType(data_type, status);
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_C_EAGER_DLPACK_H_
 #define TENSORFLOW_C_EAGER_DLPACK_H_
 
+#include <cstdint>
+
 #include "tensorflow/c/eager/c_api.h"
 
 namespace tensorflow {
@@ -28,6 +30,17 @@ const char* const kDlTensorCapsuleName = "dltensor";
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
+// Same as TFE_HandleToDLPack, but follows the stream semantics of the
+// `__dlpack__(stream)` protocol instead of syncing the whole device: a GPU
+// tensor's pending writes are ordered before the work later enqueued on the
+// consumer's CUDA or ROCm stream `stream`, without blocking the host. 1 and 2
+// denote the legacy and per-thread default CUDA streams, -1 skips the
+// synchronization, which is then up to the consumer, and 0 syncs the device
+// like TFE_HandleToDLPack.
+TF_CAPI_EXPORT extern void* TFE_HandleToDLPackWithStream(TFE_TensorHandle* h,
+                                                         int64_t stream,
+                                                         TF_Status* status);
+
 // Converts DLPack (DLManagedTensor*) to eager tensor handle.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
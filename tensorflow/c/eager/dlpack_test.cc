@@ -109,5 +109,40 @@ TEST(DLPack, HandleFromDLPackStrides) {
   TF_DeleteStatus(status);
 }
 
+TEST(DLPack, HandleToDLPackWithStream) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  std::vector<int64_t> shape = {2, 3};
+  std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  DLManagedTensor dlm_in = {};
+  DLTensor* dltensor_in = &dlm_in.dl_tensor;
+  dltensor_in->data = data.data();
+  dltensor_in->device = {kDLCPU, 0};
+  dltensor_in->ndim = static_cast<int32_t>(shape.size());
+  dltensor_in->dtype = {kDLFloat, 32, 1};
+  dltensor_in->shape = shape.data();
+  TFE_TensorHandle* handle = TFE_HandleFromDLPack(&dlm_in, status, ctx);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  // A CPU tensor has no stream to synchronize with, whatever the consumer.
+  for (int64_t stream : {-1, 0, 1}) {
+    auto* dlm_out = static_cast<DLManagedTensor*>(
+        TFE_HandleToDLPackWithStream(handle, stream, status));
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(dlm_out->dl_tensor.data, data.data());
+    EXPECT_EQ(dlm_out->dl_tensor.ndim, 2);
+    EXPECT_EQ(dlm_out->dl_tensor.shape[1], 3);
+    TFE_CallDLManagedTensorDeleter(dlm_out);
+  }
+
+  TFE_DeleteTensorHandle(handle);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -17,25 +17,124 @@ limitations under the License.
 
 #include <string>
 #include <tuple>
+#include <unordered_set>
+#include <utility>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/tools/proto_splitter/cc/max_size.h"
 // TODO(b/291933687), TODO(b/291001524)
 #if !defined(PLATFORM_WINDOWS) && !defined(__APPLE__)
 #include "tensorflow/tools/proto_splitter/cc/saved_model_splitter.h"
+#include "tensorflow/tools/proto_splitter/cc/util.h"
+#include "tensorflow/tools/proto_splitter/chunk.pb.h"
 #include "tensorflow/tools/proto_splitter/merge.h"
 #endif
 #define IS_OSS false
 namespace tensorflow {
 namespace image_format {
+namespace {
+
+// Returns the index of the MetaGraphDef of `saved_model_proto` whose tags are
+// `tags`, or -1 if there is none.
+int FindMetaGraphDefIndex(const SavedModel& saved_model_proto,
+                          const std::unordered_set<std::string>& tags) {
+  for (int i = 0; i < saved_model_proto.meta_graphs_size(); ++i) {
+    const auto& graph_tags =
+        saved_model_proto.meta_graphs(i).meta_info_def().tags();
+    if (std::unordered_set<std::string>(graph_tags.begin(), graph_tags.end()) ==
+        tags) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+#if !defined(PLATFORM_WINDOWS) && !defined(__APPLE__)
+// Reads the MetaGraphDef whose tags are `tags` from {file_prefix}.cpb, reading
+// the base chunk first and then only the chunked fields of that MetaGraphDef.
+// Sets `read` to false, without reading any chunked field, when the base chunk
+// does not tell which MetaGraphDef matches, so that the caller falls back to
+// reading the whole SavedModel.
+absl::Status ReadChunkedMetaGraphDef(
+    const std::string& file_prefix,
+    const std::unordered_set<std::string>& tags, MetaGraphDef* meta_graph_def,
+    bool* read) {
+  using ::proto_splitter::ChunkedField;
+  using ::proto_splitter::ChunkMetadata;
+  *read = false;
+
+  SavedModel saved_model_proto;
+  ChunkMetadata partial_metadata;
+  int index_to_read;
+  {
+    TF_ASSIGN_OR_RETURN(auto reader, tools::proto_splitter::GetRiegeliReader(
+                                         absl::StrCat(file_prefix, ".cpb")));
+    absl::StatusOr<ChunkMetadata> metadata =
+        tools::proto_splitter::GetChunkMetadata(reader);
+    if (!metadata.ok() || !metadata->message().has_chunk_index()) {
+      reader.Close();
+      return absl::OkStatus();
+    }
+    absl::StatusOr<std::string> base_chunk = tools::proto_splitter::ReadChunk(
+        reader, metadata->chunks(metadata->message().chunk_index()));
+    reader.Close();
+    TF_RETURN_IF_ERROR(base_chunk.status());
+    if (!saved_model_proto.ParseFromString(*base_chunk)) {
+      return absl::DataLossError(absl::StrCat(
+          "Couldn't parse the base chunk of ", file_prefix, ".cpb"));
+    }
+
+    // Chunks with an empty field tag are slices of the SavedModel itself,
+    // which might hold more MetaGraphDefs.
+    for (const ChunkedField& chunked_field :
+         metadata->message().chunked_fields()) {
+      if (chunked_field.field_tag().empty()) return absl::OkStatus();
+    }
+    const int index = FindMetaGraphDefIndex(saved_model_proto, tags);
+    if (index < 0) return absl::OkStatus();
+
+    *partial_metadata.mutable_chunks() = metadata->chunks();
+    for (const ChunkedField& chunked_field :
+         metadata->message().chunked_fields()) {
+      const auto& field_tag = chunked_field.field_tag();
+      if (field_tag.size() >= 2 &&
+          field_tag[0].field() == SavedModel::kMetaGraphsFieldNumber &&
+          field_tag[1].has_index() && field_tag[1].index() == index) {
+        *partial_metadata.mutable_message()->add_chunked_fields() =
+            chunked_field;
+      }
+    }
+    *read = true;
+    LOG(INFO) << "Reading " << partial_metadata.message().chunked_fields_size()
+              << " of " << metadata->message().chunked_fields_size()
+              << " chunked fields of " << file_prefix << ".cpb";
+    index_to_read = index;
+  }
+  if (!partial_metadata.message().chunked_fields().empty()) {
+    // The partial metadata has no base chunk, so its chunked fields are merged
+    // into the base chunk read above.
+    TF_RETURN_IF_ERROR(tools::proto_splitter::Merger::ReadPartial(
+        file_prefix, partial_metadata, &saved_model_proto));
+  }
+  metrics::SavedModelReadCount(saved_model::GetWriteVersion(saved_model_proto))
+      .IncrementBy(1);
+  *meta_graph_def =
+      std::move(*saved_model_proto.mutable_meta_graphs(index_to_read));
+  return absl::OkStatus();
+}
+#endif
+
+}  // namespace
 
 absl::Status ReadSavedModel(const std::string& file_prefix,
                             SavedModel* saved_model_proto) {
@@ -95,6 +194,37 @@ absl::Status ReadSavedModel(const std::string& file_prefix,
                    "permissions for accessing it."));
 }
 
+absl::Status ReadMetaGraphDef(const std::string& file_prefix,
+                              const std::unordered_set<std::string>& tags,
+                              MetaGraphDef* meta_graph_def) {
+#if !defined(PLATFORM_WINDOWS) && !defined(__APPLE__)
+  auto saved_model_pbtxt_exists = internal::FileExists(
+      Env::Default(), absl::StrCat(file_prefix, ".pbtxt"));
+  absl::StatusOr<bool> only_contains_pb =
+      tools::proto_splitter::OnlyContainsPb(file_prefix);
+  if (!saved_model_pbtxt_exists.value_or(false) && only_contains_pb.ok() &&
+      !*only_contains_pb) {
+    LOG(INFO) << "Reading meta graph with tags { " << absl::StrJoin(tags, " ")
+              << " } from: " << file_prefix;
+    bool read;
+    TF_RETURN_IF_ERROR(
+        ReadChunkedMetaGraphDef(file_prefix, tags, meta_graph_def, &read));
+    if (read) return absl::OkStatus();
+  }
+#endif
+
+  SavedModel saved_model_proto;
+  TF_RETURN_IF_ERROR(ReadSavedModel(file_prefix, &saved_model_proto));
+  const int index = FindMetaGraphDefIndex(saved_model_proto, tags);
+  if (index < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not find meta graph def matching supplied tags: { ",
+                     absl::StrJoin(tags, " "), " } in ", file_prefix));
+  }
+  *meta_graph_def = std::move(*saved_model_proto.mutable_meta_graphs(index));
+  return absl::OkStatus();
+}
+
 absl::Status WriteSavedModel(SavedModel* saved_model_proto,
                              const std::string& file_prefix) {
 #if !defined(PLATFORM_WINDOWS) && !defined(__APPLE__)
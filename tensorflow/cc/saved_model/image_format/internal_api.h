@@ -18,10 +18,12 @@ limitations under the License.
 
 #include <string>
 #include <tuple>
+#include <unordered_set>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 
 #define IS_OSS false
@@ -34,6 +36,15 @@ namespace image_format {
 absl::Status ReadSavedModel(const std::string& file_prefix,
                             SavedModel* saved_model_proto);
 
+// Reads the MetaGraphDef whose tags are `tags` from the SavedModel at
+// {file_prefix}{.pb|.cpb}. For a chunked SavedModel, only the base chunk and
+// the chunks of the fields of that MetaGraphDef are read and merged, so e.g.
+// the large constants of the graphs of other MetaGraphDefs are skipped.
+// Returns a NotFound status when no MetaGraphDef matches.
+absl::Status ReadMetaGraphDef(const std::string& file_prefix,
+                              const std::unordered_set<std::string>& tags,
+                              MetaGraphDef* meta_graph_def);
+
 // Writes the SavedModel proto to a file or to string. If the proto is < the
 // protobuf maximum size, then it will be serialized as a `.pb` proto binary.
 // When larger than the maximum size, the SavedModel proto is destructively
@@ -314,6 +314,42 @@ Status GenVariableMethods(const tf2xla::Config& config,
   return OkStatus();
 }
 
+// Generate the set_weights_data method, for the variables holding the
+// constants moved to the weights blob.
+Status GenWeightsMethod(const CodegenOpts& opts, const tf2xla::Config& config,
+                        string* methods) {
+  if (opts.external_weights.empty()) return OkStatus();
+  string setters;
+  for (const ExternalWeight& weight : opts.external_weights) {
+    int index = -1;
+    for (int i = 0; i < config.variable_size(); ++i) {
+      if (config.variable(i).name() == weight.variable_name) {
+        index = config.feed_size() + i;
+        break;
+      }
+    }
+    if (index < 0) {
+      return errors::InvalidArgument("Missing variable ", weight.variable_name,
+                                     " of external weight");
+    }
+    absl::StrAppend(&setters, "    set_arg_data(", index, ", data + ",
+                    weight.offset, ");\n");
+  }
+  const string code = R"(
+  // Points the readonly variables holding the constants of the weights file
+  // into `weights`, a copy or a read-only memory mapping of that file, which
+  // must be aligned to {{ALIGN}} bytes and outlive the uses of this object.
+  void set_weights_data(const void* weights) {
+    const char* data = static_cast<const char*>(weights);
+{{SETTERS}}  }
+)";
+  *methods += absl::StrReplaceAll(
+      code,
+      {{"{{ALIGN}}", absl::StrCat(xla::cpu_function_runtime::MinAlign())},
+       {"{{SETTERS}}", setters}});
+  return OkStatus();
+}
+
 // Generate shape infos for args (inputs).
 Status GenArgShapeInfos(const xla::ProgramShapeProto& ps, string* infos) {
   for (int i = 0; i < ps.parameters_size(); ++i) {
@@ -502,6 +538,7 @@ Status GenerateHeader(const CodegenOpts& opts, const tf2xla::Config& config,
   TF_RETURN_IF_ERROR(GenArgMethods(config, ps, compile_result, &methods_arg));
   TF_RETURN_IF_ERROR(GenResultMethods(config, ps, &methods_result));
   TF_RETURN_IF_ERROR(GenVariableMethods(config, ps, &methods_variable));
+  TF_RETURN_IF_ERROR(GenWeightsMethod(opts, config, &methods_variable));
   string arg_shape_infos, result_shape_infos;
   TF_RETURN_IF_ERROR(GenArgShapeInfos(ps, &arg_shape_infos));
   TF_RETURN_IF_ERROR(
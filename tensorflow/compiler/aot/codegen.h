@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/aot/compile.h"
+#include "tensorflow/compiler/aot/externalize_constants.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 
 namespace tensorflow {
@@ -51,6 +52,10 @@ struct CodegenOpts {
 
   // If true, sets this executable as an XLA Runtime one.
   bool use_xla_runtime = false;
+
+  // The constants moved out of the graph into the weights blob.  If non-empty,
+  // generate a set_weights_data method pointing their variables into the blob.
+  std::vector<ExternalWeight> external_weights;
 };
 
 // Describes a generated metadata object file.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "llvm-c/Target.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "tensorflow/compiler/aot/codegen.h"
+#include "tensorflow/compiler/aot/externalize_constants.h"
 #include "tensorflow/compiler/aot/flags.h"
 #include "tensorflow/compiler/aot/quantize.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.h"
@@ -254,6 +255,16 @@ Status Main(const MainFlags& flags) {
   }
   GraphDef graph_def;
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.graph, &graph_def));
+  std::vector<ExternalWeight> external_weights;
+  if (!flags.out_weights.empty()) {
+    string weights;
+    TF_RETURN_IF_ERROR(
+        ExternalizeConstants(flags.externalize_constants_min_bytes,
+                             &graph_def, &config, &weights, &external_weights));
+    TF_RETURN_IF_ERROR(ValidateConfig(config));
+    TF_RETURN_IF_ERROR(
+        WriteStringToFile(Env::Default(), flags.out_weights, weights));
+  }
   CompileResult compile_result;
 
   Status status =
@@ -273,6 +284,7 @@ Status Main(const MainFlags& flags) {
   codegen_opts.gen_name_to_index = flags.gen_name_to_index;
   codegen_opts.gen_program_shape = flags.gen_program_shape;
   codegen_opts.target_triple = flags.target_triple;
+  codegen_opts.external_weights = std::move(external_weights);
   // Set the XLA Runtime bit if this is an HloLowering.
   if (!flags.mlir_components.empty() && flags.mlir_components != "None") {
     for (auto component : absl::StrSplit(flags.mlir_components, ',')) {
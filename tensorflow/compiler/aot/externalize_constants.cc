@@ -0,0 +1,141 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/externalize_constants.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/cpu_function_runtime.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+namespace {
+
+// A variable holding the contents of one or more identical constants.
+struct WeightVariable {
+  DataType dtype;
+  TensorShape shape;
+  int64_t offset;
+  int64_t size;
+  // The name of the VarHandleOp node of the variable.
+  string handle_name;
+};
+
+bool SameWeight(const WeightVariable& var, const Tensor& t,
+                absl::string_view blob) {
+  const absl::string_view data = t.tensor_data();
+  return var.dtype == t.dtype() && var.shape == t.shape() &&
+         var.size == data.size() &&
+         blob.substr(var.offset, var.size) == data;
+}
+
+}  // namespace
+
+Status ExternalizeConstants(int64_t min_bytes, GraphDef* graph_def,
+                            tf2xla::Config* config, string* blob,
+                            std::vector<ExternalWeight>* weights) {
+  std::set<string> fed_nodes;
+  for (const tf2xla::Feed& feed : config->feed()) {
+    fed_nodes.insert(feed.id().node_name());
+  }
+  const int64_t align = xla::cpu_function_runtime::MinAlign();
+
+  // The variables, keyed by the fingerprint of their contents.
+  absl::flat_hash_map<uint64, std::vector<WeightVariable>> variables;
+  std::vector<NodeDef> handles;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() != "Const" || fed_nodes.count(node.name()) > 0) continue;
+    const auto value_it = node.attr().find("value");
+    if (value_it == node.attr().end()) continue;
+    Tensor t;
+    if (!t.FromProto(value_it->second.tensor())) {
+      return errors::InvalidArgument("Invalid value of Const node ",
+                                     node.name());
+    }
+    if (!DataTypeCanUseMemcpy(t.dtype()) || t.TotalBytes() < min_bytes) {
+      continue;
+    }
+
+    const absl::string_view data = t.tensor_data();
+    std::vector<WeightVariable>& candidates = variables[Fingerprint64(data)];
+    const WeightVariable* var = nullptr;
+    for (const WeightVariable& candidate : candidates) {
+      if (SameWeight(candidate, t, *blob)) {
+        var = &candidate;
+        break;
+      }
+    }
+    if (var == nullptr) {
+      const string name = absl::StrCat("weight_", weights->size());
+      const string shared_name = absl::StrCat("tfcompile_", name);
+      blob->resize((blob->size() + align - 1) / align * align, '\0');
+      WeightVariable new_var{t.dtype(), t.shape(),
+                             static_cast<int64_t>(blob->size()),
+                             static_cast<int64_t>(data.size()),
+                             absl::StrCat(node.name(), "/", shared_name)};
+      blob->append(data.data(), data.size());
+      weights->push_back({name, new_var.offset});
+
+      NodeDef& handle = handles.emplace_back();
+      handle.set_name(new_var.handle_name);
+      handle.set_op("VarHandleOp");
+      handle.set_device(node.device());
+      AddNodeAttr("dtype", t.dtype(), &handle);
+      AddNodeAttr("shape", t.shape(), &handle);
+      AddNodeAttr("container", "", &handle);
+      AddNodeAttr("shared_name", shared_name, &handle);
+
+      tf2xla::Variable* variable = config->add_variable();
+      variable->set_node_name(shared_name);
+      variable->set_name(name);
+      t.shape().AsProto(variable->mutable_shape());
+      variable->set_type(t.dtype());
+      variable->set_readonly(true);
+
+      candidates.push_back(std::move(new_var));
+      var = &candidates.back();
+    }
+
+    // Keeps the name, device and control inputs of the Const node, so that
+    // its consumers and the fetches are left alone.
+    node.set_op("ReadVariableOp");
+    node.mutable_attr()->clear();
+    AddNodeAttr("dtype", var->dtype, &node);
+    node.add_input(var->handle_name);
+    const int num_inputs = node.input_size();
+    for (int i = num_inputs - 1; i > 0; --i) {
+      node.mutable_input()->SwapElements(i, i - 1);
+    }
+  }
+  for (NodeDef& handle : handles) {
+    *graph_def->add_node() = std::move(handle);
+  }
+  return OkStatus();
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -0,0 +1,59 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_AOT_EXTERNALIZE_CONSTANTS_H_
+#define TENSORFLOW_COMPILER_AOT_EXTERNALIZE_CONSTANTS_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// ExternalWeight describes a constant that was moved out of the graph into
+// the weights blob.
+struct ExternalWeight {
+  // The name of the readonly variable holding the constant in generated code.
+  string variable_name;
+
+  // The byte offset of the contents of the constant in the weights blob.
+  int64_t offset = 0;
+};
+
+// ExternalizeConstants replaces the Const nodes in `graph_def` holding at least
+// `min_bytes` bytes of POD data with reads of readonly variables, which are
+// appended to `config`, and appends the contents of those constants to `blob`,
+// each aligned to xla::cpu_function_runtime::MinAlign() bytes.
+//
+// Constants with the same type, shape and contents share a single variable and
+// a single copy in the blob. Constants in the function library and constants
+// that are fed are left alone.
+//
+// The compiled function then reads the constants from wherever the blob is at
+// runtime, e.g. a read-only memory mapping of it, instead of embedding them in
+// its object file.
+Status ExternalizeConstants(int64_t min_bytes, GraphDef* graph_def,
+                            tf2xla::Config* config, string* blob,
+                            std::vector<ExternalWeight>* weights);
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_EXTERNALIZE_CONSTANTS_H_
@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/externalize_constants.h"
+
+#include <string>
+#include <vector>
+
+#include "xla/cpu_function_runtime.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+NodeDef* AddConst(const string& name, const Tensor& value, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  AddNodeAttr("dtype", value.dtype(), node);
+  AddNodeAttr("value", value, node);
+  return node;
+}
+
+const NodeDef* FindNode(const string& name, const GraphDef& graph) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+TEST(ExternalizeConstantsTest, DeduplicatesLargeConstants) {
+  const Tensor weights = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  const Tensor other = test::AsTensor<float>({5, 6, 7, 8}, {2, 2});
+  GraphDef graph;
+  AddConst("a", weights, &graph);
+  AddConst("b", weights, &graph)->add_input("^a");
+  AddConst("c", other, &graph);
+  AddConst("small", test::AsScalar<float>(1), &graph);
+  AddConst("fed", other, &graph);
+  tf2xla::Config config;
+  config.add_feed()->mutable_id()->set_node_name("fed");
+
+  string blob;
+  std::vector<ExternalWeight> externalized;
+  TF_ASSERT_OK(ExternalizeConstants(/*min_bytes=*/16, &graph, &config, &blob,
+                                    &externalized));
+
+  // "a" and "b" share a variable, "c" gets its own.
+  ASSERT_EQ(externalized.size(), 2);
+  EXPECT_EQ(externalized[0].variable_name, "weight_0");
+  EXPECT_EQ(externalized[0].offset, 0);
+  EXPECT_EQ(externalized[1].variable_name, "weight_1");
+  const int64_t align = xla::cpu_function_runtime::MinAlign();
+  EXPECT_EQ(externalized[1].offset, align);
+  ASSERT_EQ(blob.size(), align + other.TotalBytes());
+  EXPECT_EQ(blob.substr(0, weights.TotalBytes()), weights.tensor_data());
+  EXPECT_EQ(blob.substr(align), other.tensor_data());
+
+  ASSERT_EQ(config.variable_size(), 2);
+  EXPECT_EQ(config.variable(0).node_name(), "tfcompile_weight_0");
+  EXPECT_EQ(config.variable(0).name(), "weight_0");
+  EXPECT_EQ(config.variable(0).type(), DT_FLOAT);
+  EXPECT_TRUE(config.variable(0).readonly());
+
+  const NodeDef* a = FindNode("a", graph);
+  const NodeDef* b = FindNode("b", graph);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(a->op(), "ReadVariableOp");
+  EXPECT_EQ(b->op(), "ReadVariableOp");
+  ASSERT_EQ(b->input_size(), 2);
+  EXPECT_EQ(b->input(0), a->input(0));
+  EXPECT_EQ(b->input(1), "^a");
+  const NodeDef* handle = FindNode(a->input(0), graph);
+  ASSERT_NE(handle, nullptr);
+  EXPECT_EQ(handle->op(), "VarHandleOp");
+  EXPECT_EQ(handle->attr().at("shared_name").s(), "tfcompile_weight_0");
+
+  EXPECT_EQ(FindNode("small", graph)->op(), "Const");
+  EXPECT_EQ(FindNode("fed", graph)->op(), "Const");
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
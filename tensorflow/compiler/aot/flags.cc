@@ -75,6 +75,17 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "function."},
       {"out_session_module", &flags->out_session_module,
        "Output session module proto."},
+      {"out_weights", &flags->out_weights,
+       "If set, output file for the contents of the large constants of the "
+       "graph, which are then read from readonly variables instead of being "
+       "embedded in the function object.  The generated set_weights_data "
+       "method points those variables at a copy or a read-only memory "
+       "mapping of this file."},
+      {"externalize_constants_min_bytes",
+       &flags->externalize_constants_min_bytes,
+       "With --out_weights, the minimum size in bytes of the constants to "
+       "write to the weights file.  Smaller constants, e.g. shapes that must "
+       "be known at compile time, stay in the function object."},
       {"mlir_components", &flags->mlir_components,
        "The MLIR components to enable. Currently only Bridge is supported."},
       {"experimental_quantize", &flags->experimental_quantize,
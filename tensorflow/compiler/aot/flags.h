@@ -41,6 +41,8 @@ struct MainFlags {
   string out_metadata_object;
   string out_header;
   string out_session_module;
+  string out_weights;
+  int64_t externalize_constants_min_bytes = 1024;
   string mlir_components;
   bool experimental_quantize = false;
 
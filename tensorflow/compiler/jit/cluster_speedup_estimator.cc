@@ -0,0 +1,139 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_speedup_estimator.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+
+namespace tensorflow {
+namespace {
+
+OpInfo::TensorProperties GetTensorProperties(const Node& node, int output,
+                                             const GraphShapeInfo& shape_info) {
+  OpInfo::TensorProperties properties;
+  properties.set_dtype(node.output_type(output));
+  auto it = shape_info.find(node.name());
+  if (it != shape_info.end() && output < it->second.size()) {
+    it->second[output].shape.AsProto(properties.mutable_shape());
+  } else {
+    properties.mutable_shape()->set_unknown_rank(true);
+  }
+  return properties;
+}
+
+}  // namespace
+
+ClusterSpeedupEstimator::ClusterSpeedupEstimator(
+    const Graph& graph, const GraphShapeInfo& shape_info)
+    : node_costs_(graph.num_node_ids()) {
+  grappler::OpLevelCostEstimator estimator;
+  absl::flat_hash_map<std::string, DeviceProperties> device_properties;
+  for (const Node* node : graph.op_nodes()) {
+    const std::string& device = !node->assigned_device_name().empty()
+                                    ? node->assigned_device_name()
+                                    : node->requested_device();
+    auto it = device_properties.find(device);
+    if (it == device_properties.end()) {
+      it = device_properties.emplace(device, grappler::GetDeviceInfo(device))
+               .first;
+    }
+
+    grappler::OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = device;
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node->type_string());
+    *op_info.mutable_attr() = node->def().attr();
+    *op_info.mutable_device() = it->second;
+    std::vector<const Edge*> input_edges(node->num_inputs(), nullptr);
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->IsControlEdge()) {
+        input_edges[edge->dst_input()] = edge;
+      }
+    }
+    for (const Edge* edge : input_edges) {
+      *op_info.add_inputs() =
+          edge != nullptr
+              ? GetTensorProperties(*edge->src(), edge->src_output(),
+                                    shape_info)
+              : OpInfo::TensorProperties();
+    }
+    for (int i = 0; i < node->num_outputs(); ++i) {
+      *op_info.add_outputs() = GetTensorProperties(*node, i, shape_info);
+    }
+
+    grappler::Costs costs = estimator.PredictCosts(op_context);
+    NodeCosts& node_costs = node_costs_[node->id()];
+    node_costs.execution_ns = costs.execution_time.count();
+    node_costs.compute_ns = costs.compute_time.count();
+    // GB/s are bytes per ns.
+    const double gb_per_sec = estimator.GetDeviceInfo(it->second).gb_per_sec;
+    for (const OpInfo::TensorProperties& output : op_info.outputs()) {
+      node_costs.output_transfer_ns.push_back(
+          grappler::CalculateTensorSize(output) / gb_per_sec);
+    }
+  }
+}
+
+double ClusterSpeedupEstimator::EstimateSpeedup(
+    absl::Span<Node* const> nodes) const {
+  absl::flat_hash_set<const Node*> cluster(nodes.begin(), nodes.end());
+  double executor_ns = 0;
+  double execution_ns = 0;
+  double compute_ns = 0;
+  double saved_transfer_ns = 0;
+  for (const Node* node : nodes) {
+    const NodeCosts& node_costs = node_costs_[node->id()];
+    executor_ns += node_costs.execution_ns + kExecutorOpOverheadNs;
+    execution_ns += node_costs.execution_ns;
+    compute_ns += node_costs.compute_ns;
+
+    // The outputs read inside the cluster are not read from memory, and the
+    // outputs only read inside the cluster are not written to memory either.
+    std::vector<bool> read_outside(node->num_outputs(), false);
+    std::vector<bool> read_inside(node->num_outputs(), false);
+    for (const Edge* edge : node->out_edges()) {
+      if (edge->IsControlEdge() ||
+          edge->src_output() >= node_costs.output_transfer_ns.size()) {
+        continue;
+      }
+      if (cluster.contains(edge->dst())) {
+        read_inside[edge->src_output()] = true;
+        saved_transfer_ns += node_costs.output_transfer_ns[edge->src_output()];
+      } else {
+        read_outside[edge->src_output()] = true;
+      }
+    }
+    for (int i = 0; i < read_inside.size(); ++i) {
+      if (read_inside[i] && !read_outside[i]) {
+        saved_transfer_ns += node_costs.output_transfer_ns[i];
+      }
+    }
+  }
+  const double cluster_ns =
+      std::max(compute_ns, execution_ns - saved_transfer_ns) +
+      kClusterOverheadNs;
+  return executor_ns / cluster_ns;
+}
+
+}  // namespace tensorflow
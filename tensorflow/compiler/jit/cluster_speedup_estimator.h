@@ -0,0 +1,66 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_ESTIMATOR_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_ESTIMATOR_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// Estimates how much faster a cluster of TF nodes runs when compiled with XLA
+// than when run by the TF executor, from the costs that grappler's
+// OpLevelCostEstimator predicts for its nodes.
+//
+// Compiling a cluster saves the per-op overhead of the executor, as well as
+// the memory traffic of the tensors that do not leave the cluster, but adds
+// the overhead of launching the cluster. So tiny clusters, or clusters of ops
+// that are bound by their compute time, are not worth compiling.
+class ClusterSpeedupEstimator {
+ public:
+  // The estimated time the TF executor spends dispatching an op, in ns.
+  static constexpr double kExecutorOpOverheadNs = 2000;
+
+  // The estimated time spent launching an XLA cluster, i.e. running its
+  // _XlaCompile and _XlaRun ops, in ns.
+  static constexpr double kClusterOverheadNs = 10000;
+
+  // Predicts the costs of the nodes of `graph`, whose output shapes are in
+  // `shape_info`. The tensors whose shapes are unknown are costed as scalars.
+  ClusterSpeedupEstimator(const Graph& graph, const GraphShapeInfo& shape_info);
+
+  // Returns the estimated time the TF executor takes to run `nodes` divided
+  // by the estimated time a cluster of `nodes` takes to run.
+  double EstimateSpeedup(absl::Span<Node* const> nodes) const;
+
+ private:
+  struct NodeCosts {
+    double execution_ns = 0;
+    double compute_ns = 0;
+    // The time it takes to write or to read each output of the node.
+    std::vector<double> output_transfer_ns;
+  };
+
+  // Indexed by node id.
+  std::vector<NodeCosts> node_costs_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_ESTIMATOR_H_
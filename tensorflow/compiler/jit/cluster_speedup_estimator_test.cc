@@ -0,0 +1,84 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_speedup_estimator.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class ClusterSpeedupEstimatorTest : public ::testing::Test {
+ protected:
+  // Builds a chain of `n` elementwise ops on a tensor of shape `shape`, and
+  // returns the ops.
+  std::vector<Node*> BuildChain(int n, const PartialTensorShape& shape) {
+    Scope root = Scope::NewRootScope().ExitOnError().WithDevice(kCpu);
+    Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape(shape));
+    for (int i = 0; i < n; ++i) {
+      x = i % 2 == 0 ? ops::Neg(root.WithOpName(absl::StrCat("op", i)), x)
+                     : ops::Exp(root.WithOpName(absl::StrCat("op", i)), x);
+    }
+    graph_ = std::make_unique<Graph>(OpRegistry::Global());
+    TF_CHECK_OK(root.ToGraph(graph_.get()));
+    TF_CHECK_OK(InferShapes(graph_.get(), /*arg_shapes=*/{},
+                            /*fnlib_def=*/nullptr, &shape_info_));
+
+    std::vector<Node*> nodes;
+    for (Node* node : graph_->op_nodes()) {
+      if (node->name() != "x") {
+        nodes.push_back(node);
+      }
+    }
+    return nodes;
+  }
+
+  std::unique_ptr<Graph> graph_;
+  GraphShapeInfo shape_info_;
+};
+
+TEST_F(ClusterSpeedupEstimatorTest, MemoryBoundClusterIsFaster) {
+  std::vector<Node*> nodes = BuildChain(4, PartialTensorShape({1024, 1024}));
+  ClusterSpeedupEstimator estimator(*graph_, shape_info_);
+  EXPECT_GT(estimator.EstimateSpeedup(nodes), 1.0);
+}
+
+TEST_F(ClusterSpeedupEstimatorTest, TinyClusterIsSlower) {
+  std::vector<Node*> nodes = BuildChain(2, PartialTensorShape({}));
+  ClusterSpeedupEstimator estimator(*graph_, shape_info_);
+  EXPECT_LT(estimator.EstimateSpeedup(nodes), 1.0);
+}
+
+TEST_F(ClusterSpeedupEstimatorTest, LargerClustersAreFaster) {
+  std::vector<Node*> nodes = BuildChain(8, PartialTensorShape({1024}));
+  ClusterSpeedupEstimator estimator(*graph_, shape_info_);
+  EXPECT_LT(estimator.EstimateSpeedup(absl::MakeSpan(nodes).subspan(0, 2)),
+            estimator.EstimateSpeedup(nodes));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -126,6 +126,12 @@ StatusOr<Signature> Signature::Build(
       case XlaCompiler::Argument::kResource:
         signature.args.push_back(
             TensorTypeAndShape(arg.type, arg.DimensionSizesAsInlinedVector()));
+        // Parameters with bounded dynamic dimensions are followed by the
+        // dynamism of their dimensions.
+        if (arg.kind == XlaCompiler::Argument::kParameter &&
+            arg.value_dynamism.has_value()) {
+          signature.args.push_back(*arg.value_dynamism);
+        }
         break;
       default:
         return errors::InvalidArgument(
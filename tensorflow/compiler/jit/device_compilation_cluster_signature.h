@@ -31,7 +31,9 @@ struct DeviceCompilationClusterSignature {
 
   // List of args (either as a TensorTypeAndShape or as a Tensor value)
   // for compile-time constant arguments to the compilation, ordered by
-  // argument number. Tensors must be in host memory.
+  // argument number. Tensors must be in host memory. The shape of a parameter
+  // with bounded dynamic dimensions holds their bounds, and is followed by a
+  // Tensor with the dynamism of each dimension.
   using TensorTypeAndShape =
       std::pair<DataType, absl::InlinedVector<int64_t, 4>>;
   absl::InlinedVector<std::variant<Tensor, TensorTypeAndShape>, 8> args;
@@ -94,6 +94,29 @@ TEST(DeviceCompilationClusterSignatureTest, SignatureUniqueness) {
   EXPECT_FALSE(s1 == s2);
 }
 
+TEST(DeviceCompilationClusterSignatureTest, DynamicParameters) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({8, 3});
+
+  TF_ASSERT_OK_AND_ASSIGN(DeviceCompilationClusterSignature s1,
+                          DeviceCompilationClusterSignature::Build(fn, args));
+
+  // A leading dimension bounded by 8 differs from a static one of size 8.
+  Tensor dynamism(DT_BOOL, TensorShape({2}));
+  dynamism.vec<bool>()(0) = true;
+  dynamism.vec<bool>()(1) = false;
+  args[0].value_dynamism = dynamism;
+  TF_ASSERT_OK_AND_ASSIGN(DeviceCompilationClusterSignature s2,
+                          DeviceCompilationClusterSignature::Build(fn, args));
+
+  EXPECT_NE(SignatureHash()(s1), SignatureHash()(s2));
+  EXPECT_FALSE(s1 == s2);
+}
+
 void BM_BuildSignature(::testing::benchmark::State& state) {
   const int n_args = state.range(0);
 
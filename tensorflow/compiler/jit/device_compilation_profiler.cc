@@ -19,18 +19,41 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tsl/platform/mutex.h"
 
 namespace tensorflow {
 namespace {
+auto* cluster_compile_count = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_compile_count",
+    "The number of times each XLA cluster was compiled.", "cluster");
+
+auto* cluster_compile_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_compile_time_usecs",
+    "The cumulative time spent compiling each XLA cluster.", "cluster");
+
+auto* cluster_fallback_count = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_fallback_count",
+    "The number of executions of each XLA cluster that fell back to the TF "
+    "function call.",
+    "cluster");
+
+auto* cluster_execution_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_execution_time_usecs",
+    "The cumulative host time spent running the executables of each XLA "
+    "cluster.",
+    "cluster");
+
 bool ShouldBeMegamorphic(int64_t compile_count, int64_t execution_count) {
   const int64_t kCompileThreshold = 10;
   const int64_t kMinExecutionsPerCompile = 50;
@@ -65,6 +88,13 @@ constexpr int64_t kDefaultCompilationThreshold = 2;
 // Maximum number of ongoing compilations.
 constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
 
+// Clusters executed at least this many times may queue compilations beyond
+// kMaxNumOngoingCompilations, up to kMaxNumOngoingHotCompilations. Queued
+// compilations of hotter clusters run first.
+constexpr int64_t kMinHotClusterExecutions = 100;
+constexpr int64_t kMaxNumOngoingHotCompilations =
+    2 * kMaxNumOngoingCompilations;
+
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -85,6 +115,12 @@ DeviceCompilationProfiler::GetCompileStats(const NameAttrList& function) const {
                           function.name());
 }
 
+absl::flat_hash_map<std::string, DeviceCompilationProfiler::ClusterCompileStats>
+DeviceCompilationProfiler::GetAllCompileStats() const {
+  mutex_lock lock(mu_);
+  return cluster_compile_stats_;
+}
+
 void DeviceCompilationProfiler::RegisterExecution(
     const NameAttrList& function) {
   mutex_lock lock(mu_);
@@ -94,10 +130,86 @@ void DeviceCompilationProfiler::RegisterExecution(
   RegisterExecutionForCluster(function, &it->second);
 }
 
+void DeviceCompilationProfiler::RegisterFallback(const NameAttrList& function) {
+  cluster_fallback_count->GetCell(function.name())->IncrementBy(1);
+
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  ++it->second.fallback_count;
+}
+
+void DeviceCompilationProfiler::RegisterExecutionTime(
+    const NameAttrList& function, int64_t execution_time_us) {
+  cluster_execution_time_usecs->GetCell(function.name())
+      ->IncrementBy(execution_time_us);
+
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  ++it->second.timed_execution_count;
+  it->second.cumulative_execution_time_us += execution_time_us;
+}
+
+void DeviceCompilationProfiler::RegisterCompiledSignature(
+    const NameAttrList& function, absl::string_view signature) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  if (it->second.compile_count == 0) {
+    return;
+  }
+  VLOG(1) << "Recompiling " << function.name() << " for " << signature;
+  std::vector<std::string>& signatures = it->second.recompile_signatures;
+  if (signatures.size() >= kMaxRecompileSignatures) {
+    signatures.erase(signatures.begin());
+  }
+  signatures.emplace_back(signature);
+}
+
+std::vector<int> DeviceCompilationProfiler::RegisterArgumentShapes(
+    const NameAttrList& function, absl::Span<const XlaArgument> args) {
+  std::vector<int64_t> leading_dims(args.size(), -1);
+  for (int i = 0, end = args.size(); i < end; ++i) {
+    if (args[i].kind != XlaArgument::kParameter) continue;
+    std::vector<int64_t> dims = args[i].DimensionSizes();
+    if (!dims.empty()) leading_dims[i] = dims[0];
+  }
+
+  mutex_lock lock(mu_);
+  auto [it, inserted] = cluster_argument_dims_.emplace(function.name(),
+                                                       ClusterArgumentDims{});
+  ClusterArgumentDims& seen = it->second;
+  if (inserted || seen.leading_dims.size() != leading_dims.size()) {
+    seen.leading_dims = std::move(leading_dims);
+    seen.is_dynamic.assign(seen.leading_dims.size(), false);
+    return {};
+  }
+
+  std::vector<int> dynamic_args;
+  for (int i = 0, end = leading_dims.size(); i < end; ++i) {
+    if (seen.leading_dims[i] < 0 || leading_dims[i] < 0) continue;
+    if (!seen.is_dynamic[i] && seen.leading_dims[i] != leading_dims[i]) {
+      VLOG(1) << "Leading dimension of argument " << i << " of "
+              << function.name() << " changed from " << seen.leading_dims[i]
+              << " to " << leading_dims[i];
+      seen.is_dynamic[i] = true;
+    }
+    if (seen.is_dynamic[i]) dynamic_args.push_back(i);
+  }
+  return dynamic_args;
+}
+
 Status DeviceCompilationProfiler::RegisterCompilation(
     const NameAttrList& function, int64_t compile_time_us,
     bool used_persistent_cache) {
   metrics::UpdateXlaCompilationTime(compile_time_us);
+  cluster_compile_count->GetCell(function.name())->IncrementBy(1);
+  cluster_compile_time_usecs->GetCell(function.name())
+      ->IncrementBy(compile_time_us);
 
   const std::string& function_name = function.name();
 
@@ -181,7 +293,10 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
 
   if (compile_mode == DeviceCompileMode::kAsync) {
     // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
+    const bool is_hot =
+        it->second.execution_count >= kMinHotClusterExecutions;
+    if (num_ongoing_compilations_ >= (is_hot ? kMaxNumOngoingHotCompilations
+                                             : kMaxNumOngoingCompilations)) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
               << " because of too many ongoing compilations.";
       return false;
@@ -18,8 +18,15 @@ limitations under the License.
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 
 namespace tensorflow {
@@ -41,6 +48,20 @@ class DeviceCompilationProfiler : public ResourceBase {
     // Cumulative time spent compiling the cluster.
     int64_t cumulative_compile_time_us = 0;
 
+    // The number of executions of the cluster that fell back to the TF
+    // function call because no executable was ready for their signature.
+    int64_t fallback_count = 0;
+
+    // The number of executions of a compiled executable that were timed, and
+    // the cumulative host time spent running them. On devices that execute
+    // asynchronously this is only the time spent launching the executable.
+    int64_t timed_execution_count = 0;
+    int64_t cumulative_execution_time_us = 0;
+
+    // The signatures of the most recent recompilations of the cluster, i.e.
+    // of the compilations after the first one, oldest first.
+    std::vector<std::string> recompile_signatures;
+
     // True if we have decided that this cluster is too dynamic (i.e. its shapes
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
@@ -51,14 +72,25 @@ class DeviceCompilationProfiler : public ResourceBase {
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
-          ", is_megamorphic=", is_megamorphic, "}");
+          ", fallback_count=", fallback_count,
+          ", timed_execution_count=", timed_execution_count,
+          ", cumulative_execution_time_us=", cumulative_execution_time_us,
+          ", recompile_signatures=[", absl::StrJoin(recompile_signatures, ", "),
+          "], is_megamorphic=", is_megamorphic, "}");
     }
   };
 
+  // The maximum number of recompile signatures kept for each cluster.
+  static constexpr int kMaxRecompileSignatures = 8;
+
   // Returns the compilation statistics for the given cluster.
   StatusOr<ClusterCompileStats> GetCompileStats(
       const NameAttrList& function) const;
 
+  // Returns the compilation statistics of all clusters, keyed by cluster name.
+  absl::flat_hash_map<std::string, ClusterCompileStats> GetAllCompileStats()
+      const;
+
   // Determines whether the cluster should be compiled. Creates and inserts an
   // entry into stats (also calls `RegisterExecution`) for `function` if it
   // doesn't already exist.
@@ -71,6 +103,28 @@ class DeviceCompilationProfiler : public ResourceBase {
   // sets the megamorphic bit accordingly).
   void RegisterExecution(const NameAttrList& function);
 
+  // Registers an execution of the cluster through the TF function call, when
+  // no executable was ready for its signature.
+  void RegisterFallback(const NameAttrList& function);
+
+  // Registers the host time spent running a compiled executable of the
+  // cluster.
+  void RegisterExecutionTime(const NameAttrList& function,
+                             int64_t execution_time_us);
+
+  // Registers the signature that the cluster is about to be compiled for. The
+  // signatures of the compilations after the first one are kept as the causes
+  // of the recompilations.
+  void RegisterCompiledSignature(const NameAttrList& function,
+                                 absl::string_view signature);
+
+  // Registers the shapes of the arguments to a cluster execution. Returns the
+  // indices of the parameters whose leading dimension has been seen to change
+  // between executions of the cluster, which are the candidates for shape
+  // bucketing.
+  std::vector<int> RegisterArgumentShapes(const NameAttrList& function,
+                                          absl::Span<const XlaArgument> args);
+
   // Registers a cluster compilation. Increments the compilation count and
   // accumulates the compile time for the given cluster. Also broadcasts an
   // XlaJitCompilationActivity.
@@ -90,6 +144,19 @@ class DeviceCompilationProfiler : public ResourceBase {
   absl::flat_hash_map<std::string, ClusterCompileStats> cluster_compile_stats_
       TF_GUARDED_BY(mu_);
 
+  // The leading dimensions of the parameters of a cluster, seen so far.
+  struct ClusterArgumentDims {
+    // The leading dimension of each argument, or -1 if the argument is not a
+    // parameter with at least one dimension.
+    std::vector<int64_t> leading_dims;
+    // Whether the leading dimension of each argument has changed.
+    std::vector<bool> is_dynamic;
+  };
+
+  // Maps cluster names to the leading dimensions of their arguments.
+  absl::flat_hash_map<std::string, ClusterArgumentDims> cluster_argument_dims_
+      TF_GUARDED_BY(mu_);
+
   int64_t num_ongoing_compilations_ TF_GUARDED_BY(mu_) = 0;
 
   DeviceCompilationProfiler(const DeviceCompilationProfiler&) = delete;
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -212,6 +213,36 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, ShouldCompileHotClusterAsync) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  const int64_t kMaxNumOngoingCompilations = 10;
+  for (int i = 0; i < kMaxNumOngoingCompilations; ++i) {
+    profiler->IncrementOngoingAsyncCompilations();
+  }
+
+  for (int i = 0; i < 99; ++i) {
+    profiler->RegisterExecution(function);
+  }
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  // Hot clusters may queue compilations past the limit for other clusters.
+  profiler->RegisterExecution(function);
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  for (int i = 0; i < kMaxNumOngoingCompilations; ++i) {
+    profiler->IncrementOngoingAsyncCompilations();
+  }
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -239,5 +270,91 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
                                              kDefaultCompilationThreshold));
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterArgumentShapes) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  std::vector<XlaArgument> args(3);
+  args[0].kind = XlaArgument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({4, 3});
+  args[1].kind = XlaArgument::kParameter;
+  args[1].type = DT_FLOAT;
+  args[1].shape = TensorShape({2});
+  args[2].kind = XlaArgument::kConstant;
+  args[2].type = DT_INT32;
+  args[2].constant_value = Tensor(DT_INT32, {4});
+
+  EXPECT_THAT(profiler->RegisterArgumentShapes(function, args),
+              ::testing::IsEmpty());
+  EXPECT_THAT(profiler->RegisterArgumentShapes(function, args),
+              ::testing::IsEmpty());
+
+  args[0].shape = TensorShape({7, 3});
+  args[2].constant_value = Tensor(DT_INT32, {7});
+  EXPECT_THAT(profiler->RegisterArgumentShapes(function, args),
+              ::testing::ElementsAre(0));
+
+  // The argument stays dynamic once its leading dimension has changed.
+  args[0].shape = TensorShape({4, 3});
+  EXPECT_THAT(profiler->RegisterArgumentShapes(function, args),
+              ::testing::ElementsAre(0));
+}
+
+TEST(DeviceCompilationProfilerTest, RegisterFallbackAndExecutionTime) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterFallback(function);
+  profiler->RegisterFallback(function);
+  profiler->RegisterExecutionTime(function, 10);
+  profiler->RegisterExecutionTime(function, 32);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.fallback_count, 2);
+  EXPECT_EQ(stats.timed_execution_count, 2);
+  EXPECT_EQ(stats.cumulative_execution_time_us, 42);
+}
+
+TEST(DeviceCompilationProfilerTest, RegisterCompiledSignature) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+  NameAttrList other_function;
+  other_function.set_name("OtherFunc");
+
+  // The signature of the first compilation is not a recompilation.
+  profiler->RegisterCompiledSignature(function, "sig0");
+  TF_ASSERT_OK(profiler->RegisterCompilation(function, 1, false));
+  for (int i = 1; i <= DeviceCompilationProfiler::kMaxRecompileSignatures + 1;
+       ++i) {
+    profiler->RegisterCompiledSignature(function, absl::StrCat("sig", i));
+    TF_ASSERT_OK(profiler->RegisterCompilation(function, 1, false));
+  }
+  profiler->RegisterExecution(other_function);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  ASSERT_EQ(stats.recompile_signatures.size(),
+            DeviceCompilationProfiler::kMaxRecompileSignatures);
+  EXPECT_EQ(stats.recompile_signatures.front(), "sig2");
+  EXPECT_EQ(stats.recompile_signatures.back(),
+            absl::StrCat(
+                "sig", DeviceCompilationProfiler::kMaxRecompileSignatures + 1));
+
+  auto all_stats = profiler->GetAllCompileStats();
+  EXPECT_EQ(all_stats.size(), 2);
+  EXPECT_EQ(all_stats["TestFunc"].compile_count,
+            DeviceCompilationProfiler::kMaxRecompileSignatures + 2);
+  EXPECT_EQ(all_stats["OtherFunc"].execution_count, 1);
+}
+
 }  // namespace
 }  // namespace tensorflow
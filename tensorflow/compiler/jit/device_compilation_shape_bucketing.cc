@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketing.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+/*static*/ ShapeBucketingPolicy ShapeBucketingPolicy::PowersOfTwo() {
+  return ShapeBucketingPolicy(/*buckets=*/{});
+}
+
+/*static*/ StatusOr<ShapeBucketingPolicy> ShapeBucketingPolicy::FromBuckets(
+    std::vector<int64_t> buckets) {
+  if (buckets.empty()) {
+    return errors::InvalidArgument("Shape bucketing needs at least one bucket");
+  }
+  for (int64_t bucket : buckets) {
+    if (bucket <= 0) {
+      return errors::InvalidArgument("Shape buckets must be positive, got ",
+                                     bucket);
+    }
+  }
+  std::sort(buckets.begin(), buckets.end());
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  return ShapeBucketingPolicy(std::move(buckets));
+}
+
+/*static*/ StatusOr<ShapeBucketingPolicy> ShapeBucketingPolicy::Parse(
+    absl::string_view spec) {
+  if (spec == "pow2") return PowersOfTwo();
+  std::vector<int64_t> buckets;
+  for (absl::string_view bucket : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(bucket, &size)) {
+      return errors::InvalidArgument("Invalid shape bucket '", bucket,
+                                     "' in '", spec, "'");
+    }
+    buckets.push_back(size);
+  }
+  return FromBuckets(std::move(buckets));
+}
+
+std::optional<int64_t> ShapeBucketingPolicy::Bucket(int64_t size) const {
+  if (size <= 0) return std::nullopt;
+  if (buckets_.empty()) {
+    int64_t bucket = 1;
+    while (bucket < size) bucket <<= 1;
+    return bucket;
+  }
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), size);
+  if (it == buckets_.end()) return std::nullopt;
+  return *it;
+}
+
+bool ShapeBucketingPolicy::BucketArguments(
+    absl::Span<const int> dynamic_args, std::vector<XlaArgument>* args) const {
+  bool bucketed = false;
+  for (int index : dynamic_args) {
+    XlaArgument& arg = (*args)[index];
+    if (arg.kind != XlaArgument::kParameter || arg.value_dynamism.has_value() ||
+        !absl::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    TensorShape shape = absl::get<TensorShape>(arg.shape);
+    if (shape.dims() == 0) continue;
+    std::optional<int64_t> bucket = Bucket(shape.dim_size(0));
+    if (!bucket.has_value()) continue;
+
+    shape.set_dim(0, *bucket);
+    arg.shape = shape;
+    // For entry computations, XlaCompiler reads the value dynamism of a
+    // parameter as the dynamism of its dimensions.
+    Tensor dynamism(DT_BOOL, TensorShape({shape.dims()}));
+    dynamism.vec<bool>().setConstant(false);
+    dynamism.vec<bool>()(0) = true;
+    arg.value_dynamism = std::move(dynamism);
+    bucketed = true;
+  }
+  return bucketed;
+}
+
+}  // namespace tensorflow
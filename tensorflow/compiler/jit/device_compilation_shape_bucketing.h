@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETING_H_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+
+// Rounds the sizes of the dynamic dimensions of the arguments to a cluster up
+// to buckets, so that DeviceCompiler compiles one executable per bucket
+// instead of one per size.
+//
+// A bucketed argument is compiled with a leading dimension bounded by its
+// bucket. XLA pads such dimensions to their bound and masks the padding, and
+// the executable reports the actual sizes of its dynamic outputs, which are
+// sliced when they are converted back to tensors.
+class ShapeBucketingPolicy {
+ public:
+  // Rounds sizes up to the next power of two.
+  static ShapeBucketingPolicy PowersOfTwo();
+
+  // Rounds sizes up to the smallest of `buckets` that holds them. Sizes above
+  // the largest bucket are not bucketed.
+  static StatusOr<ShapeBucketingPolicy> FromBuckets(
+      std::vector<int64_t> buckets);
+
+  // Parses a policy from either "pow2" or a comma separated list of buckets,
+  // e.g. "8,16,32,64".
+  static StatusOr<ShapeBucketingPolicy> Parse(absl::string_view spec);
+
+  // Returns the bucket holding `size`, or std::nullopt if `size` is not
+  // bucketed.
+  std::optional<int64_t> Bucket(int64_t size) const;
+
+  // Rounds the leading dimension of the parameters `dynamic_args` of `args` up
+  // to its bucket and marks it as dynamic. Returns whether any argument was
+  // bucketed.
+  bool BucketArguments(absl::Span<const int> dynamic_args,
+                       std::vector<XlaArgument>* args) const;
+
+ private:
+  explicit ShapeBucketingPolicy(std::vector<int64_t> buckets)
+      : buckets_(std::move(buckets)) {}
+
+  // Sorted buckets, or empty for powers of two.
+  std::vector<int64_t> buckets_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETING_H_
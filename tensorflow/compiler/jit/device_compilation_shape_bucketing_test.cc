@@ -0,0 +1,81 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketing.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ShapeBucketingPolicyTest, PowersOfTwo) {
+  ShapeBucketingPolicy policy = ShapeBucketingPolicy::PowersOfTwo();
+  EXPECT_EQ(policy.Bucket(1), 1);
+  EXPECT_EQ(policy.Bucket(3), 4);
+  EXPECT_EQ(policy.Bucket(64), 64);
+  EXPECT_EQ(policy.Bucket(65), 128);
+  EXPECT_EQ(policy.Bucket(0), std::nullopt);
+}
+
+TEST(ShapeBucketingPolicyTest, ConfiguredBuckets) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBucketingPolicy policy,
+                          ShapeBucketingPolicy::Parse("32,8,16"));
+  EXPECT_EQ(policy.Bucket(1), 8);
+  EXPECT_EQ(policy.Bucket(9), 16);
+  EXPECT_EQ(policy.Bucket(32), 32);
+  EXPECT_EQ(policy.Bucket(33), std::nullopt);
+}
+
+TEST(ShapeBucketingPolicyTest, InvalidBuckets) {
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      ShapeBucketingPolicy::Parse("8,x").status()));
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(ShapeBucketingPolicy::Parse("0,8").status()));
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(ShapeBucketingPolicy::Parse("").status()));
+}
+
+TEST(ShapeBucketingPolicyTest, BucketArguments) {
+  std::vector<XlaArgument> args(3);
+  args[0].kind = XlaArgument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({5, 3});
+  args[1].kind = XlaArgument::kParameter;
+  args[1].type = DT_FLOAT;
+  args[1].shape = TensorShape({5, 3});
+  args[2].kind = XlaArgument::kConstant;
+  args[2].type = DT_INT32;
+  args[2].constant_value = Tensor(DT_INT32, {2});
+
+  ShapeBucketingPolicy policy = ShapeBucketingPolicy::PowersOfTwo();
+  EXPECT_FALSE(policy.BucketArguments({2}, &args));
+  EXPECT_TRUE(policy.BucketArguments({0, 2}, &args));
+
+  EXPECT_EQ(absl::get<TensorShape>(args[0].shape), TensorShape({8, 3}));
+  ASSERT_TRUE(args[0].value_dynamism.has_value());
+  EXPECT_TRUE(args[0].value_dynamism->vec<bool>()(0));
+  EXPECT_FALSE(args[0].value_dynamism->vec<bool>()(1));
+  EXPECT_EQ(absl::get<TensorShape>(args[1].shape), TensorShape({5, 3}));
+  EXPECT_FALSE(args[1].value_dynamism.has_value());
+}
+
+}  // namespace
+}  // namespace tensorflow
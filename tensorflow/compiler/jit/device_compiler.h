@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -31,10 +33,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_cache.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketing.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tf_graph_to_hlo_compiler.h"
+#include "tensorflow/compiler/jit/tf_to_hlo_lowering_cache.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
@@ -42,6 +46,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 
 namespace tensorflow {
 
@@ -61,7 +67,10 @@ namespace tensorflow {
 // to disk.
 //
 // Since XLA computations must have static shapes, DeviceCompiler generates a
-// new XLA computation for each new set of input shapes.
+// new XLA computation for each new set of input shapes. With a shape bucketing
+// policy, the parameters of a cluster whose leading dimension changes between
+// executions are compiled with that dimension bounded by its bucket instead,
+// so that one XLA computation serves all the sizes of a bucket.
 // TODO(b/255826209): De-templatize once we've moved to Device API completely.
 template <typename ExecutableType, typename ClientType>
 class DeviceCompiler : public ResourceBase {
@@ -125,6 +134,14 @@ class DeviceCompiler : public ResourceBase {
     return compiler_client_.get();
   }
 
+  // Sets the policy to bucket the dynamic dimensions of cluster arguments
+  // with. The executables of bucketed clusters take inputs with bounded
+  // dynamic shapes, so this must only be set when they are run by
+  // XlaComputationLaunchContext. Must be called before any compilation.
+  void set_shape_bucketing_policy(std::optional<ShapeBucketingPolicy> policy) {
+    shape_bucketing_policy_ = std::move(policy);
+  }
+
   string DebugString() const override;
 
  private:
@@ -165,9 +182,37 @@ class DeviceCompiler : public ResourceBase {
       compiler_client_;
   std::unique_ptr<DeviceCompilationCache<ExecutableType>> cache_;
 
+  std::optional<ShapeBucketingPolicy> shape_bucketing_policy_;
+
+  // An asynchronous compilation waiting for a thread of
+  // `async_compiler_threads_`.
+  struct PendingCompilation {
+    // The number of executions of the cluster when it was queued.
+    int64_t priority;
+    // Orders compilations of the same priority by arrival.
+    uint64 sequence;
+    std::function<void()> compile;
+  };
+
+  // Orders the heap of pending compilations so that the hottest comes first.
+  static bool CompilesAfter(const PendingCompilation& a,
+                            const PendingCompilation& b) {
+    if (a.priority != b.priority) return a.priority < b.priority;
+    return a.sequence > b.sequence;
+  }
+
+  // Runs the pending compilation of the hottest cluster.
+  void RunHottestPendingCompilation();
+
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  mutex pending_compilations_mu_;
+  std::vector<PendingCompilation> pending_compilations_
+      TF_GUARDED_BY(pending_compilations_mu_);
+  uint64 next_pending_compilation_sequence_
+      TF_GUARDED_BY(pending_compilations_mu_) = 0;
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -289,8 +334,17 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
     DeviceCompilationProfiler* profiler, mutex* mu) {
   tensorflow::Env* env = tensorflow::Env::Default();
   const uint64 compile_start_us = env->NowMicros();
+  profiler->RegisterCompiledSignature(function, sig.HumanString());
+  profiler::TraceMe trace_me([&] {
+    return profiler::TraceMeEncode(
+        "DeviceCompiler::CompileStrict",
+        {{"cluster", function.name()}, {"signature", sig.HumanString()}});
+  });
 
-  TfGraphToHloCompiler compiler(options);
+  TfGraphToHloCompiler compiler(
+      options, GetXlaOpsCommonFlags()->tf_xla_share_hlo_lowerings
+                   ? TfToHloLoweringCache::Global()
+                   : nullptr);
   cache_value.compile_state = DeviceCompileState::kCompiled;
 
   std::unique_ptr<ExecutableType> out_executable;
@@ -370,7 +424,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -388,10 +442,41 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+
+  // Compilations wait for a compiler thread in order of how often their
+  // cluster has run, so that the hottest clusters get compiled first.
+  int64_t priority = 0;
+  if (auto stats = profiler->GetCompileStats(function); stats.ok()) {
+    priority = stats->execution_count;
+  }
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    pending_compilations_.push_back(PendingCompilation{
+        priority, next_pending_compilation_sequence_++, std::move(compile)});
+    std::push_heap(pending_compilations_.begin(), pending_compilations_.end(),
+                   CompilesAfter);
+  }
+  async_compiler_threads_->Schedule([this] { RunHottestPendingCompilation(); });
   return OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType,
+                    ClientType>::RunHottestPendingCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    // Every pending compilation schedules one call.
+    DCHECK(!pending_compilations_.empty());
+    std::pop_heap(pending_compilations_.begin(), pending_compilations_.end(),
+                  CompilesAfter);
+    compile = std::move(pending_compilations_.back().compile);
+    pending_compilations_.pop_back();
+  }
+  compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -410,8 +495,26 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
       VLOG(3) << i << ": " << args[i].HumanString();
     }
   }
-  TF_ASSIGN_OR_RETURN(auto signature,
-                      DeviceCompilationClusterSignature::Build(function, args));
+  // Bucket the parameters of clusters whose shapes have been seen to change.
+  std::vector<XlaCompiler::Argument> bucketed_args;
+  if (shape_bucketing_policy_.has_value() &&
+      scope == CompileScope::kFunction) {
+    std::vector<int> dynamic_args =
+        profiler->RegisterArgumentShapes(function, args);
+    if (!dynamic_args.empty()) {
+      bucketed_args = args;
+      if (!shape_bucketing_policy_->BucketArguments(dynamic_args,
+                                                    &bucketed_args)) {
+        bucketed_args.clear();
+      }
+    }
+  }
+  const std::vector<XlaCompiler::Argument>& compile_args =
+      bucketed_args.empty() ? args : bucketed_args;
+
+  TF_ASSIGN_OR_RETURN(
+      auto signature,
+      DeviceCompilationClusterSignature::Build(function, compile_args));
 
   // The outer lock protects the existence of the mutex in the map.
   mutex* cluster_mutex;
@@ -467,24 +570,28 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     if (!profiler->ShouldCompileCluster(function, compile_mode,
                                         current_request_count)) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
+      profiler->RegisterFallback(function);
       return OkStatus();
     } else if (compile_mode == DeviceCompileMode::kAsync) {
       VLOG(2) << "Queueing asynchronous compilation for signature: "
               << human_signature;
       TF_RETURN_IF_ERROR(CompileAsynchronous(signature, compile_options,
-                                             options, args, function, scope,
-                                             ctx, profiler));
+                                             options, compile_args, function,
+                                             scope, ctx, profiler));
+      profiler->RegisterFallback(function);
       return OkStatus();
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
       TF_ASSIGN_OR_RETURN(
           cache_value,
-          CompileStrict(signature, compile_options, options, args, function,
-                        cache_value, scope, ctx, profiler, cluster_mutex));
+          CompileStrict(signature, compile_options, options, compile_args,
+                        function, cache_value, scope, ctx, profiler,
+                        cluster_mutex));
     }
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    profiler->RegisterFallback(function);
     return OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
 #include "absl/log/log.h"
+#include "tensorflow/compiler/jit/serialized_cache_entry_lru.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -38,6 +41,12 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// The directory can be on any file system known to Env, e.g. a GCS bucket
+// shared by many hosts, which then compile each cluster once between them. A
+// non-empty `platform_fingerprint` keeps hosts from loading executables built
+// by another compiler or for another device, and recently used entries are
+// kept in memory, shared by all the persistors of the process.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -74,6 +83,15 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-empty, identifies the compiler and the device that executables
+    // are built with, e.g. the TensorFlow version and the device model. It is
+    // part of the keys of the entries.
+    std::string platform_fingerprint;
+
+    // The number of bytes of recently used entries to keep in memory, in an
+    // LRU shared by all persistors of the process.
+    int64_t in_memory_cache_bytes = 0;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -157,6 +175,11 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const std::string platform_fingerprint_;
+
+  // Recently used entries, or nullptr if they are not kept in memory.
+  SerializedCacheEntryLru* const in_memory_cache_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +193,15 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      platform_fingerprint_(config.platform_fingerprint),
+      in_memory_cache_(config.in_memory_cache_bytes > 0
+                           ? SerializedCacheEntryLru::Global()
+                           : nullptr) {
+  if (in_memory_cache_ != nullptr) {
+    in_memory_cache_->ReserveCapacity(config.in_memory_cache_bytes);
+  }
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -183,7 +214,11 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.device_type(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
-          : "");
+          : "",
+      key.platform_fingerprint().empty()
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         Fingerprint64(key.platform_fingerprint())));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -205,6 +240,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_platform_fingerprint(platform_fingerprint_);
   return key;
 }
 
@@ -231,12 +267,20 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
     const XlaSerializedCacheKey& key) const {
   Env* env = Env::Default();
   const std::string file_path = GetFilePath(key);
+  if (in_memory_cache_ != nullptr) {
+    if (auto entry = in_memory_cache_->Lookup(file_path); entry.has_value()) {
+      return entry;
+    }
+  }
   if (!env->FileExists(file_path).ok()) {
     return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
   }
 
   XlaSerializedCacheEntry entry;
   TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  if (in_memory_cache_ != nullptr) {
+    in_memory_cache_->Insert(file_path, entry);
+  }
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
@@ -306,7 +350,11 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
         "Could not create a unique file inside ", persistent_cache_directory_));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_path, GetFilePath(entry.key())));
+  if (in_memory_cache_ != nullptr) {
+    in_memory_cache_->Insert(GetFilePath(entry.key()), entry);
+  }
+  return OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -425,6 +425,34 @@ TEST_F(DeviceExecutionPersistorTest, LoadFileDoesntExist) {
   EXPECT_FALSE(loaded_executable.has_value());
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadPlatformFingerprintMismatch) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.platform_fingerprint = "platform_1";
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(StatusOr<std::string>(serialized_xla_executable_)));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // Executables built on another platform are not loaded.
+  config.platform_fingerprint = "platform_2";
+  XlaDeviceExecutablePersistor other_persistor(config,
+                                               DefaultXlaOptions().device_type);
+  auto loaded_executable = other_persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+
+  EXPECT_FALSE(loaded_executable.has_value());
+}
+
 TEST_F(DeviceExecutionPersistorTest, LoadSerializedKeyMismatch) {
   XlaDeviceExecutablePersistor::Config config(
       /*persistent_cache_directory=*/cache_dir_,
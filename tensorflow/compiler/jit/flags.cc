@@ -105,6 +105,18 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            "Minimum number of operators in an XLA compilation. Ignored for "
            "operators placed on an XLA device or operators explicitly marked "
            "for compilation."),
+      Flag("tf_xla_min_cluster_speedup",
+           &mark_for_compilation_flags->tf_xla_min_cluster_speedup,
+           "If positive, clusters estimated to run less than this many times "
+           "faster with XLA than with the TF executor are not compiled. "
+           "Ignored for operators placed on an XLA device or operators "
+           "explicitly marked for compilation."),
+      Flag("tf_xla_clustering_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_profile,
+           "If non-empty, the path of an XlaClusteringProfile of measured "
+           "cluster speedups. Profiled clusters are compiled if and only if "
+           "they were faster with XLA. Ignored for operators placed on an XLA "
+           "device or operators explicitly marked for compilation."),
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
@@ -167,6 +179,12 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_in_memory_bytes",
+           &mark_for_compilation_flags
+                ->tf_xla_persistent_cache_in_memory_bytes,
+           "The number of bytes of recently used persistent cache entries to "
+           "keep in memory, shared by all devices. Zero disables the "
+           "in-memory cache."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -228,6 +246,8 @@ void AllocateAndParseFlags() {
       0;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_general = 0;
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
+  mark_for_compilation_flags->tf_xla_min_cluster_speedup = 0;
+  mark_for_compilation_flags->tf_xla_clustering_profile = "";
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
@@ -242,6 +262,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
+  mark_for_compilation_flags->tf_xla_persistent_cache_in_memory_bytes = 0;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
@@ -263,6 +284,9 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_shape_bucketing = "";
+  ops_flags->tf_xla_num_spmd_partitions = 1;
+  ops_flags->tf_xla_share_hlo_lowerings = false;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +358,25 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_shape_bucketing", &ops_flags->tf_xla_shape_bucketing,
+            "If non-empty, the leading dimension of the arguments to a "
+            "cluster is rounded up to a bucket once it changes between "
+            "executions, so that one compilation serves all the sizes of a "
+            "bucket. Either \"pow2\" or a comma separated list of sizes. Only "
+            "applies to clusters not run with Device API (PjRt)."),
+       Flag("tf_xla_num_spmd_partitions",
+            &ops_flags->tf_xla_num_spmd_partitions,
+            "If greater than one, the clusters run with Device API (PjRt) "
+            "that have sharding annotations are SPMD-partitioned over this "
+            "many local devices, which the executable transfers data between. "
+            "The unannotated arguments and results of the clusters are "
+            "replicated."),
+       Flag("tf_xla_share_hlo_lowerings",
+            &ops_flags->tf_xla_share_hlo_lowerings,
+            "If true, the lowerings of clusters to HLO are cached by the "
+            "fingerprint of their functions and shared by all the devices and "
+            "sessions of the process, and concurrent lowerings of the same "
+            "cluster wait for the first one."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -59,6 +59,17 @@ struct MarkForCompilationPassFlags {
   // placed on an XLA device or operators explicitly marked for compilation.
   int32 tf_xla_min_cluster_size;
 
+  // If positive, clusters that grappler's cost model estimates to run less
+  // than this many times faster with XLA than with the TF executor are not
+  // compiled. Ignored like tf_xla_min_cluster_size.
+  float tf_xla_min_cluster_speedup;
+
+  // If non-empty, the path of an XlaClusteringProfile. The profiled clusters
+  // that were faster with XLA are compiled whatever their size and estimated
+  // speedup, and the others are not compiled. Ignored like
+  // tf_xla_min_cluster_size.
+  string tf_xla_clustering_profile;
+
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
@@ -104,6 +115,10 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // The number of bytes of recently used persistent cache entries to keep in
+  // memory. Zero disables the in-memory cache.
+  int64_t tf_xla_persistent_cache_in_memory_bytes;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -151,6 +166,18 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If non-empty, the buckets that the leading dimension of cluster arguments
+  // is rounded up to once it changes between executions, either "pow2" or a
+  // comma separated list of sizes. See ShapeBucketingPolicy.
+  std::string tf_xla_shape_bucketing;
+  // If greater than one, the clusters run with Device API (PjRt) that have
+  // sharding annotations, e.g. from XlaSharding ops, are SPMD-partitioned over
+  // this many local devices. Defaults to 1.
+  int32 tf_xla_num_spmd_partitions;
+  // If true, the lowerings of clusters to HLO are shared by the devices and
+  // sessions of the process, so that devices of the same type lower each
+  // cluster signature once. Defaults to false.
+  bool tf_xla_share_hlo_lowerings;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -346,6 +346,23 @@ StatusOr<xla::ExecutionOutput> RunExecutable(
   return execution_output;
 }
 
+// Records the host time spent running `function` since `start_time_us` with
+// the DeviceCompilationProfiler `profiler_name` of `rm`, if there is one.
+void RegisterExecutionTime(ResourceMgr* rm, const std::string& profiler_name,
+                           const NameAttrList& function,
+                           uint64 start_time_us) {
+  DeviceCompilationProfiler* profiler;
+  if (rm == nullptr ||
+      !rm->Lookup<DeviceCompilationProfiler>(rm->default_container(),
+                                             profiler_name, &profiler)
+           .ok()) {
+    return;
+  }
+  core::ScopedUnref profiler_ref(profiler);
+  profiler->RegisterExecutionTime(
+      function, Env::Default()->NowMicros() - start_time_us);
+}
+
 StatusOr<std::pair<std::vector<XlaCompiler::Argument>, ResourceVarsSnapshot>>
 GetXlaCompilerArgsAndSnapshotVariables(
     absl::Span<const int> variable_indices,
@@ -542,7 +559,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
     auto run_pjrt_cluster = [ctx, pjrt_client, pjrt_executable,
                              compilation_result, done, inputs,
-                             resources = resources_]() {
+                             resources = resources_, function = function_,
+                             device_type = platform_info_.device_type()]() {
       // Separate scope so that VariableInfo locks are released before done() is
       // called.
       {
@@ -554,11 +572,19 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
             done);
         OP_REQUIRES_OK_ASYNC(ctx, LockVariables(absl::MakeSpan(variable_infos)),
                              done);
+        uint64 start_time_us = Env::Default()->NowMicros();
         OP_REQUIRES_OK_ASYNC(
             ctx,
             RunPjRtExecutable(inputs, variable_infos, *compilation_result,
                               pjrt_client, pjrt_executable, ctx),
             done);
+        StatusOr<ResourceMgr*> rm =
+            GetResourceMgrForDeviceCompiler(*ctx, device_type);
+        if (rm.ok()) {
+          RegisterExecutionTime(
+              *rm, GetPjRtDeviceCompilationProfilerResourceName(device_type),
+              function, start_time_us);
+        }
       }
       VLOG(2) << "Done executing with PJRT.";
       done();
@@ -577,7 +603,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_,
+                          function = function_]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -626,11 +653,15 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       xla::RunId run_id(0);
       run_options.set_run_id(run_id);
 
+      uint64 start_time_us = Env::Default()->NowMicros();
       StatusOr<xla::ExecutionOutput> execution_output = RunExecutable(
           platform_info, launch_context, std::move(*execution_inputs),
           run_options, executable, ctx, allocator.get());
       OP_REQUIRES_ASYNC(ctx, execution_output.ok(), execution_output.status(),
                         done);
+      RegisterExecutionTime(ctx->resource_manager(),
+                            "device_compilation_profiler", function,
+                            start_time_us);
 
       OP_REQUIRES_OK_ASYNC(
           ctx,
@@ -34,13 +34,16 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/cluster_speedup_estimator.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -112,6 +115,14 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If positive, clusters whose estimated speedup over the TF executor is
+    // below this value are not compiled.
+    float min_cluster_speedup;
+
+    // The speedups measured with XLA, keyed by cluster fingerprint. Profiled
+    // clusters are compiled if and only if their speedup is at least one.
+    absl::flat_hash_map<uint64, double> profiled_speedups;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -311,6 +322,14 @@ class MarkForCompilationPassImpl {
   // tf_xla_min_cluster_size, are applied here.
   Status CreateClusters();
 
+  // Returns the cycles graph node IDs of the clusters whose estimated speedup
+  // is below debug_options_.min_cluster_speedup.
+  absl::flat_hash_set<int> FindSlowClusters();
+
+  // Returns the profiled speedups of the clusters in
+  // debug_options_.profiled_speedups, keyed by cycles graph node id.
+  absl::flat_hash_map<int, double> FindProfiledClusterSpeedups();
+
   Status DumpDebugInfo();
 
   bool IsCompilationCandidate(Node* n) const {
@@ -956,6 +975,64 @@ int64_t GetNextClusterSequenceNumber(uint64 fingerprint) {
   return ClusterSequenceNumberGenerator::Global().GetNext(fingerprint);
 }
 
+absl::flat_hash_set<int> MarkForCompilationPassImpl::FindSlowClusters() {
+  absl::flat_hash_map<int, std::vector<Node*>> cluster_nodes;
+  for (Node* n : compilation_candidates_) {
+    if (!declustered_nodes_.contains(n)) {
+      cluster_nodes[GetClusterForNode(n)->cycles_graph_node_id()].push_back(n);
+    }
+  }
+
+  // The costs of the nodes whose shapes are unknown are underestimated, which
+  // makes clusters look slower, so a failure to infer shapes is not fatal.
+  GraphShapeInfo shape_info;
+  Status status = InferShapes(graph_, /*arg_shapes=*/{}, flib_def_,
+                              &shape_info);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to infer shapes for estimating cluster speedups: "
+            << status;
+  }
+  ClusterSpeedupEstimator estimator(*graph_, shape_info);
+
+  absl::flat_hash_set<int> slow_clusters;
+  for (const auto& [cluster_id, nodes] : cluster_nodes) {
+    double speedup = estimator.EstimateSpeedup(nodes);
+    if (speedup < debug_options_.min_cluster_speedup) {
+      VLOG(2) << "Not compiling cluster "
+              << GetClusterForCyclesGraphNode(cluster_id)->DebugString(*graph_)
+              << " with estimated speedup " << speedup;
+      slow_clusters.insert(cluster_id);
+    }
+  }
+  return slow_clusters;
+}
+
+absl::flat_hash_map<int, double>
+MarkForCompilationPassImpl::FindProfiledClusterSpeedups() {
+  // These are the nodes that get the cluster names the clustering summaries
+  // compute the fingerprints from.
+  absl::flat_hash_map<int, std::vector<absl::string_view>> cluster_node_names;
+  for (Node* n : compilation_candidates_) {
+    if (!declustered_nodes_.contains(n)) {
+      cluster_node_names[GetClusterForNode(n)->cycles_graph_node_id()]
+          .push_back(n->name());
+    }
+  }
+
+  absl::flat_hash_map<int, double> profiled_speedups;
+  for (auto& [cluster_id, node_names] : cluster_node_names) {
+    auto it = debug_options_.profiled_speedups.find(
+        FingerprintCluster(std::move(node_names)));
+    if (it != debug_options_.profiled_speedups.end()) {
+      VLOG(2) << "Cluster "
+              << GetClusterForCyclesGraphNode(cluster_id)->DebugString(*graph_)
+              << " has profiled speedup " << it->second;
+      profiled_speedups[cluster_id] = it->second;
+    }
+  }
+  return profiled_speedups;
+}
+
 Status MarkForCompilationPassImpl::CreateClusters() {
   TF_RET_CHECK(initialized_ && edges_contracted_ && !clusters_created_);
   clusters_created_ = true;
@@ -967,12 +1044,24 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
 
+  absl::flat_hash_set<int> slow_clusters;
+  if (debug_options_.min_cluster_speedup > 0) {
+    slow_clusters = FindSlowClusters();
+  }
+
+  absl::flat_hash_map<int, double> profiled_speedups;
+  if (!debug_options_.profiled_speedups.empty()) {
+    profiled_speedups = FindProfiledClusterSpeedups();
+  }
+
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
-  // * have more than debug_options_.xla_min_cluster_size elements (applicable
-  //   only if compilation is enabled, otherwise there will be no such
-  //   candidates).
+  // * were profiled to be faster with XLA, or
+  // * have more than debug_options_.xla_min_cluster_size elements, and are
+  //   neither profiled nor estimated to be slower than
+  //   debug_options_.min_cluster_speedup (applicable only if compilation is
+  //   enabled, otherwise there will be no such candidates).
   for (Node* n : compilation_candidates_) {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
@@ -986,8 +1075,15 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
-        cluster->has_functional_control_flow() ||
+    auto profiled_speedup =
+        profiled_speedups.find(cluster->cycles_graph_node_id());
+    bool is_beneficial =
+        profiled_speedup != profiled_speedups.end()
+            ? profiled_speedup->second >= 1.0
+            : cluster->effective_cluster_size() >=
+                      debug_options_.min_cluster_size &&
+                  !slow_clusters.contains(cluster->cycles_graph_node_id());
+    if (is_beneficial || cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
 
@@ -1919,6 +2015,12 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.min_cluster_speedup = flags->tf_xla_min_cluster_speedup;
+  if (!flags->tf_xla_clustering_profile.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        debug_options.profiled_speedups,
+        ReadProfiledClusterSpeedups(flags->tf_xla_clustering_profile));
+  }
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1938,6 +2040,12 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.min_cluster_speedup = flags->tf_xla_min_cluster_speedup;
+  if (!flags->tf_xla_clustering_profile.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        debug_options.profiled_speedups,
+        ReadProfiledClusterSpeedups(flags->tf_xla_clustering_profile));
+  }
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
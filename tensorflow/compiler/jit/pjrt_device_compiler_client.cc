@@ -19,7 +19,24 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "tensorflow/compiler/jit/flags.h"
+
 namespace tensorflow {
+namespace {
+
+// Returns true if an instruction of `computation` has a sharding annotation.
+bool HasShardingAnnotations(const xla::XlaComputation& computation) {
+  for (const auto& hlo_computation : computation.proto().computations()) {
+    for (const auto& instruction : hlo_computation.instructions()) {
+      if (instruction.has_sharding()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
 
 xla::CompileOptions GetPjRtCompileOptions(
     const XlaCompiler::Options& options,
@@ -28,6 +45,17 @@ xla::CompileOptions GetPjRtCompileOptions(
   pjrt_compile_options.argument_layouts = result.xla_input_shapes;
   pjrt_compile_options.executable_build_options =
       GetExecutableBuildOptions(options, result, /*default_device_ordinal=*/-1);
+  xla::ExecutableBuildOptions& build_options =
+      pjrt_compile_options.executable_build_options;
+  const int num_spmd_partitions =
+      GetXlaOpsCommonFlags()->tf_xla_num_spmd_partitions;
+  if (num_spmd_partitions > 1 && build_options.num_replicas() == 1 &&
+      HasShardingAnnotations(*result.computation)) {
+    VLOG(1) << "SPMD-partitioning the computation over " << num_spmd_partitions
+            << " devices.";
+    build_options.set_num_partitions(num_spmd_partitions);
+    build_options.set_use_spmd_partitioning(true);
+  }
   if (pjrt_compile_options.executable_build_options.num_replicas() > 1 ||
       pjrt_compile_options.executable_build_options.num_partitions() > 1) {
     // Compile executable for sharded program
@@ -0,0 +1,74 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/flags.h"
+#include "xla/client/sharding_builder.h"
+#include "xla/client/xla_builder.h"
+#include "xla/shape_util.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::CompilationResult BuildNegate(bool with_sharding) {
+  xla::XlaBuilder builder("negate");
+  xla::XlaOp param = xla::Parameter(
+      &builder, 0, xla::ShapeUtil::MakeShape(xla::F32, {8}), "param");
+  if (with_sharding) {
+    builder.SetSharding(xla::sharding_builder::Tile1D(
+        xla::ShapeUtil::MakeShape(xla::F32, {8}), /*num_tiles=*/2));
+  }
+  xla::Neg(param);
+  XlaCompiler::CompilationResult result;
+  result.computation =
+      std::make_shared<xla::XlaComputation>(builder.Build().value());
+  return result;
+}
+
+class GetPjRtCompileOptionsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GetXlaOpsCommonFlags()->tf_xla_num_spmd_partitions = 2;
+  }
+  void TearDown() override {
+    GetXlaOpsCommonFlags()->tf_xla_num_spmd_partitions = 1;
+  }
+};
+
+TEST_F(GetPjRtCompileOptionsTest, PartitionsShardedComputations) {
+  auto compile_options =
+      GetPjRtCompileOptions(XlaCompiler::Options(), BuildNegate(true));
+
+  EXPECT_EQ(compile_options.executable_build_options.num_partitions(), 2);
+  EXPECT_TRUE(compile_options.executable_build_options.use_spmd_partitioning());
+  EXPECT_FALSE(compile_options.compile_portable_executable);
+}
+
+TEST_F(GetPjRtCompileOptionsTest, DoesNotPartitionUnshardedComputations) {
+  auto compile_options =
+      GetPjRtCompileOptions(XlaCompiler::Options(), BuildNegate(false));
+
+  EXPECT_EQ(compile_options.executable_build_options.num_partitions(), 1);
+  EXPECT_FALSE(
+      compile_options.executable_build_options.use_spmd_partitioning());
+  EXPECT_TRUE(compile_options.compile_portable_executable);
+}
+
+}  // namespace
+}  // namespace tensorflow
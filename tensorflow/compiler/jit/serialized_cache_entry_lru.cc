@@ -0,0 +1,67 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/serialized_cache_entry_lru.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+namespace tensorflow {
+
+/*static*/ SerializedCacheEntryLru* SerializedCacheEntryLru::Global() {
+  static SerializedCacheEntryLru* lru = new SerializedCacheEntryLru();
+  return lru;
+}
+
+void SerializedCacheEntryLru::ReserveCapacity(int64_t capacity_bytes) {
+  mutex_lock lock(mu_);
+  capacity_bytes_ = std::max(capacity_bytes_, capacity_bytes);
+}
+
+std::optional<XlaSerializedCacheEntry> SerializedCacheEntryLru::Lookup(
+    const std::string& path) {
+  mutex_lock lock(mu_);
+  auto it = index_.find(path);
+  if (it == index_.end()) return std::nullopt;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->entry;
+}
+
+void SerializedCacheEntryLru::Insert(const std::string& path,
+                                     const XlaSerializedCacheEntry& entry) {
+  const int64_t entry_bytes = entry.ByteSizeLong();
+  mutex_lock lock(mu_);
+  if (auto it = index_.find(path); it != index_.end()) {
+    size_bytes_ -= it->second->bytes;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  if (entry_bytes > capacity_bytes_) return;
+  entries_.push_front(CachedEntry{path, entry, entry_bytes});
+  index_[path] = entries_.begin();
+  size_bytes_ += entry_bytes;
+  EvictToCapacity();
+}
+
+void SerializedCacheEntryLru::EvictToCapacity() {
+  while (size_bytes_ > capacity_bytes_) {
+    size_bytes_ -= entries_.back().bytes;
+    index_.erase(entries_.back().path);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SERIALIZED_CACHE_ENTRY_LRU_H_
+#define TENSORFLOW_COMPILER_JIT_SERIALIZED_CACHE_ENTRY_LRU_H_
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An in-process LRU cache of the entries of persistent compilation caches,
+// keyed by their path. It saves reading an entry from a remote file system
+// again, e.g. for every device or session of a process that compiles the same
+// cluster.
+class SerializedCacheEntryLru {
+ public:
+  explicit SerializedCacheEntryLru(int64_t capacity_bytes = 0)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Returns the LRU shared by all persistors of the process, which holds
+  // nothing until its capacity is raised.
+  static SerializedCacheEntryLru* Global();
+
+  // Raises the capacity of the cache to at least `capacity_bytes`.
+  void ReserveCapacity(int64_t capacity_bytes);
+
+  // Returns the entry stored at `path`, if it is cached.
+  std::optional<XlaSerializedCacheEntry> Lookup(const std::string& path);
+
+  // Caches `entry` at `path`, evicting the least recently used entries to
+  // stay within capacity. Entries larger than the capacity are not cached.
+  void Insert(const std::string& path, const XlaSerializedCacheEntry& entry);
+
+  int64_t size_bytes() const {
+    mutex_lock lock(mu_);
+    return size_bytes_;
+  }
+
+ private:
+  struct CachedEntry {
+    std::string path;
+    XlaSerializedCacheEntry entry;
+    int64_t bytes;
+  };
+  using Entries = std::list<CachedEntry>;
+
+  void EvictToCapacity() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  int64_t capacity_bytes_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Most recently used first.
+  Entries entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entries::iterator> index_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SERIALIZED_CACHE_ENTRY_LRU_H_
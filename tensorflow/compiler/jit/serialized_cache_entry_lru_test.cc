@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/serialized_cache_entry_lru.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+
+namespace tensorflow {
+namespace {
+
+XlaSerializedCacheEntry MakeEntry(int executable_size) {
+  XlaSerializedCacheEntry entry;
+  entry.set_executable(std::string(executable_size, 'x'));
+  return entry;
+}
+
+TEST(SerializedCacheEntryLruTest, LooksUpInsertedEntries) {
+  SerializedCacheEntryLru lru(/*capacity_bytes=*/1024);
+  EXPECT_FALSE(lru.Lookup("a").has_value());
+  lru.Insert("a", MakeEntry(10));
+  auto entry = lru.Lookup("a");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->executable().size(), 10);
+
+  // Replacing an entry does not count it twice.
+  lru.Insert("a", MakeEntry(20));
+  EXPECT_EQ(lru.size_bytes(), MakeEntry(20).ByteSizeLong());
+}
+
+TEST(SerializedCacheEntryLruTest, EvictsLeastRecentlyUsedEntries) {
+  const int64_t entry_bytes = MakeEntry(100).ByteSizeLong();
+  SerializedCacheEntryLru lru(/*capacity_bytes=*/2 * entry_bytes);
+  lru.Insert("a", MakeEntry(100));
+  lru.Insert("b", MakeEntry(100));
+  // Makes "b" the least recently used entry.
+  EXPECT_TRUE(lru.Lookup("a").has_value());
+  lru.Insert("c", MakeEntry(100));
+
+  EXPECT_TRUE(lru.Lookup("a").has_value());
+  EXPECT_FALSE(lru.Lookup("b").has_value());
+  EXPECT_TRUE(lru.Lookup("c").has_value());
+  EXPECT_EQ(lru.size_bytes(), 2 * entry_bytes);
+}
+
+TEST(SerializedCacheEntryLruTest, DoesNotCacheEntriesAboveCapacity) {
+  SerializedCacheEntryLru lru;
+  lru.Insert("a", MakeEntry(10));
+  EXPECT_FALSE(lru.Lookup("a").has_value());
+
+  lru.ReserveCapacity(1024);
+  lru.Insert("a", MakeEntry(10));
+  EXPECT_TRUE(lru.Lookup("a").has_value());
+  lru.Insert("b", MakeEntry(2048));
+  EXPECT_FALSE(lru.Lookup("b").has_value());
+}
+
+}  // namespace
+}  // namespace tensorflow
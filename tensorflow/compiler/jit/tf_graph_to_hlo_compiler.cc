@@ -23,8 +23,21 @@ Status TfGraphToHloCompiler::Compile(const XlaCompiler::CompileOptions& options,
                                      const NameAttrList& function,
                                      absl::Span<const XlaArgument> args,
                                      XlaCompilationResult* result) {
-  return ADD_SOURCE_LOCATION(
-      xla_compiler_.CompileFunction(options, function, args, result));
+  auto lower = [&](XlaCompilationResult* lowered) {
+    return ADD_SOURCE_LOCATION(
+        xla_compiler_.CompileFunction(options, function, args, lowered));
+  };
+  if (lowering_cache_ == nullptr) {
+    return lower(result);
+  }
+  StatusOr<TfToHloLoweringCache::Key> key = TfToHloLoweringCache::BuildKey(
+      xla_compiler_.options(), options, function, args);
+  if (!key.ok()) {
+    VLOG(1) << "Not caching the lowering of " << function.name() << ": "
+            << key.status();
+    return lower(result);
+  }
+  return lowering_cache_->GetOrLower(*key, lower, result);
 }
 
 Status TfGraphToHloCompiler::CompileSingleOp(
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/compiler/jit/tf_to_hlo_compiler.h"
+#include "tensorflow/compiler/jit/tf_to_hlo_lowering_cache.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
 
@@ -29,12 +30,16 @@ class TfGraphToHloCompiler : public TfToHloCompiler {
  public:
   TfGraphToHloCompiler() = delete;
 
-  explicit TfGraphToHloCompiler(const XlaCompiler::Options& options)
-      : xla_compiler_(options) {}
+  // If `lowering_cache` is not null, the lowerings of functions are shared
+  // through it.
+  explicit TfGraphToHloCompiler(
+      const XlaCompiler::Options& options,
+      TfToHloLoweringCache* lowering_cache = nullptr)
+      : xla_compiler_(options), lowering_cache_(lowering_cache) {}
 
   // Compiles a Tensorflow `function` into an HloModuleProto stored in the
   // XlaCompilationResult pointed to by `result` by calling
-  // XlaCompiler::CompileFunction.
+  // XlaCompiler::CompileFunction, unless the lowering cache already holds it.
   Status Compile(const XlaCompiler::CompileOptions& options,
                  const NameAttrList& function,
                  absl::Span<const XlaArgument> args,
@@ -50,6 +55,7 @@ class TfGraphToHloCompiler : public TfToHloCompiler {
 
  private:
   XlaCompiler xla_compiler_;
+  TfToHloLoweringCache* lowering_cache_;  // Not owned.
 
   TfGraphToHloCompiler(const TfGraphToHloCompiler&) = delete;
   void operator=(const TfGraphToHloCompiler&) = delete;
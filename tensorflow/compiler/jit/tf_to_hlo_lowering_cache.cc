@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/tf_to_hlo_lowering_cache.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+
+uint64 TfToHloLoweringCache::Key::Hash::operator()(const Key& key) const {
+  return FingerprintCat64(
+      DeviceCompilationClusterSignature::Hash()(key.signature),
+      key.context_fingerprint);
+}
+
+/*static*/ TfToHloLoweringCache* TfToHloLoweringCache::Global() {
+  static TfToHloLoweringCache* cache = new TfToHloLoweringCache();
+  return cache;
+}
+
+/*static*/ StatusOr<TfToHloLoweringCache::Key> TfToHloLoweringCache::BuildKey(
+    const XlaCompiler::Options& options,
+    const XlaCompiler::CompileOptions& compile_options,
+    const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args) {
+  TF_RET_CHECK(options.flib_def != nullptr);
+  const FunctionDef* fdef = options.flib_def->Find(function.name());
+  if (fdef == nullptr) {
+    return errors::NotFound("Function ", function.name(), " not found");
+  }
+
+  Key key;
+  TF_ASSIGN_OR_RETURN(key.signature,
+                      DeviceCompilationClusterSignature::Build(function, args));
+
+  FunctionDefLibrary library =
+      options.flib_def->ReachableDefinitions(*fdef).ToProto();
+  *library.add_function() = *fdef;
+  std::string serialized_library;
+  if (!SerializeToStringDeterministic(library, &serialized_library)) {
+    return errors::Internal("Failed to serialize the function library of ",
+                            function.name());
+  }
+
+  uint64 fingerprint = Fingerprint64(serialized_library);
+  fingerprint = FingerprintCat64(
+      fingerprint, Fingerprint64(options.device_type.type_string()));
+  fingerprint = FingerprintCat64(fingerprint, options.graph_def_version);
+  fingerprint = FingerprintCat64(fingerprint, options.allow_cpu_custom_calls);
+  const bool compile_option_bits[] = {
+      compile_options.use_tuple_arg,
+      compile_options.return_updated_values_for_all_resources,
+      compile_options.always_return_tuple,
+      compile_options.is_entry_computation,
+      compile_options.add_token_input_output,
+      compile_options.alias_resource_update,
+      compile_options.alias_donatable_arguments,
+  };
+  for (bool bit : compile_option_bits) {
+    fingerprint = FingerprintCat64(fingerprint, bit);
+  }
+  key.context_fingerprint = fingerprint;
+  return key;
+}
+
+Status TfToHloLoweringCache::GetOrLower(
+    const Key& key,
+    const std::function<Status(XlaCompiler::CompilationResult*)>& lower,
+    XlaCompiler::CompilationResult* result) {
+  std::shared_ptr<Entry> entry;
+  bool is_first = false;
+  {
+    mutex_lock lock(mu_);
+    std::shared_ptr<Entry>& cached_entry = entries_[key];
+    if (cached_entry == nullptr) {
+      cached_entry = std::make_shared<Entry>();
+      is_first = true;
+      ++num_lowerings_;
+    }
+    entry = cached_entry;
+  }
+
+  if (is_first) {
+    entry->status = lower(&entry->result);
+    if (!entry->status.ok()) {
+      mutex_lock lock(mu_);
+      entries_.erase(key);
+    }
+    entry->done.Notify();
+  } else {
+    VLOG(2) << "Reusing the lowering of " << key.signature.HumanString();
+    entry->done.WaitForNotification();
+  }
+
+  TF_RETURN_IF_ERROR(entry->status);
+  *result = entry->result;
+  return OkStatus();
+}
+
+}  // namespace tensorflow
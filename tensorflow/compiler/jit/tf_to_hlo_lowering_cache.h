@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_TF_TO_HLO_LOWERING_CACHE_H_
+#define TENSORFLOW_COMPILER_JIT_TF_TO_HLO_LOWERING_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide cache of the HLO that TF functions are lowered to, shared by
+// the DeviceCompilers of all the devices and sessions of a process. Devices of
+// the same type that run the same clusters, e.g. the GPUs of a host, then lower
+// each cluster signature once instead of once per device.
+//
+// Concurrent lowerings of the same key wait for the first one instead of
+// repeating it, while lowerings of different keys run concurrently. Failed
+// lowerings are not cached.
+class TfToHloLoweringCache {
+ public:
+  struct Key {
+    DeviceCompilationClusterSignature signature;
+
+    // A fingerprint of everything else the lowering depends on, i.e. the
+    // compilation device, the compile options and the definitions of the
+    // functions reachable from the cluster.
+    uint64 context_fingerprint;
+
+    bool operator==(const Key& other) const {
+      return context_fingerprint == other.context_fingerprint &&
+             signature == other.signature;
+    }
+
+    struct Hash {
+      uint64 operator()(const Key& key) const;
+    };
+  };
+
+  TfToHloLoweringCache() = default;
+
+  // Returns the cache shared by the process.
+  static TfToHloLoweringCache* Global();
+
+  // Builds the key of lowering `function` with `args`. Assumes that the
+  // compilation devices of the same type use the same shape determination
+  // functions.
+  static StatusOr<Key> BuildKey(
+      const XlaCompiler::Options& options,
+      const XlaCompiler::CompileOptions& compile_options,
+      const NameAttrList& function,
+      absl::Span<const XlaCompiler::Argument> args);
+
+  // Copies the lowering cached for `key` to `result`, calling `lower` to
+  // lower it first if it is not cached yet.
+  Status GetOrLower(
+      const Key& key,
+      const std::function<Status(XlaCompiler::CompilationResult*)>& lower,
+      XlaCompiler::CompilationResult* result);
+
+  // Returns the number of times GetOrLower called `lower`.
+  int64_t num_lowerings() const {
+    mutex_lock lock(mu_);
+    return num_lowerings_;
+  }
+
+ private:
+  struct Entry {
+    Notification done;
+    Status status;
+    XlaCompiler::CompilationResult result;
+  };
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Key, std::shared_ptr<Entry>, Key::Hash> entries_
+      TF_GUARDED_BY(mu_);
+  int64_t num_lowerings_ TF_GUARDED_BY(mu_) = 0;
+
+  TfToHloLoweringCache(const TfToHloLoweringCache&) = delete;
+  void operator=(const TfToHloLoweringCache&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_TF_TO_HLO_LOWERING_CACHE_H_
@@ -0,0 +1,154 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/tf_to_hlo_lowering_cache.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_op_registry.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+class TfToHloLoweringCacheTest : public ::testing::Test {
+ protected:
+  TfToHloLoweringCacheTest() : flib_def_(OpRegistry::Global()) {
+    TF_CHECK_OK(flib_def_.AddFunctionDef(test::function::XTimesTwo()));
+    options_.device_type = DeviceType(DEVICE_CPU_XLA_JIT);
+    options_.flib_def = &flib_def_;
+    function_.set_name("XTimesTwo");
+    (*function_.mutable_attr())["T"].set_type(DT_FLOAT);
+    args_.resize(1);
+    args_[0].kind = XlaCompiler::Argument::kParameter;
+    args_[0].type = DT_FLOAT;
+    args_[0].shape = TensorShape({2});
+  }
+
+  TfToHloLoweringCache::Key BuildKey() {
+    return TfToHloLoweringCache::BuildKey(options_, compile_options_,
+                                          function_, args_)
+        .value();
+  }
+
+  FunctionLibraryDefinition flib_def_;
+  XlaCompiler::Options options_;
+  XlaCompiler::CompileOptions compile_options_;
+  NameAttrList function_;
+  std::vector<XlaCompiler::Argument> args_;
+};
+
+TEST_F(TfToHloLoweringCacheTest, KeyDependsOnContext) {
+  TfToHloLoweringCache::Key key = BuildKey();
+  EXPECT_TRUE(key == BuildKey());
+
+  args_[0].shape = TensorShape({3});
+  EXPECT_FALSE(key == BuildKey());
+  args_[0].shape = TensorShape({2});
+
+  compile_options_.alias_resource_update = true;
+  EXPECT_FALSE(key == BuildKey());
+  compile_options_.alias_resource_update = false;
+
+  options_.device_type = DeviceType(DEVICE_GPU_XLA_JIT);
+  EXPECT_FALSE(key == BuildKey());
+  options_.device_type = DeviceType(DEVICE_CPU_XLA_JIT);
+
+  FunctionLibraryDefinition other_flib_def(OpRegistry::Global());
+  FunctionDef other_fdef = test::function::XTimesTwo();
+  other_fdef.mutable_node_def(0)->set_name("other_two");
+  TF_ASSERT_OK(other_flib_def.AddFunctionDef(other_fdef));
+  options_.flib_def = &other_flib_def;
+  EXPECT_FALSE(key == BuildKey());
+}
+
+TEST_F(TfToHloLoweringCacheTest, BuildKeyFailsForUnknownFunction) {
+  function_.set_name("Unknown");
+  EXPECT_TRUE(errors::IsNotFound(
+      TfToHloLoweringCache::BuildKey(options_, compile_options_, function_,
+                                     args_)
+          .status()));
+}
+
+TEST_F(TfToHloLoweringCacheTest, LowersEachKeyOnce) {
+  TfToHloLoweringCache cache;
+  int num_calls = 0;
+  auto lower = [&num_calls](XlaCompiler::CompilationResult* result) {
+    ++num_calls;
+    result->outputs.resize(num_calls);
+    return OkStatus();
+  };
+
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(cache.GetOrLower(BuildKey(), lower, &result));
+  TF_ASSERT_OK(cache.GetOrLower(BuildKey(), lower, &result));
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(result.outputs.size(), 1);
+
+  args_[0].shape = TensorShape({3});
+  TF_ASSERT_OK(cache.GetOrLower(BuildKey(), lower, &result));
+  EXPECT_EQ(num_calls, 2);
+  EXPECT_EQ(result.outputs.size(), 2);
+  EXPECT_EQ(cache.num_lowerings(), 2);
+}
+
+TEST_F(TfToHloLoweringCacheTest, DoesNotCacheFailures) {
+  TfToHloLoweringCache cache;
+  int num_calls = 0;
+  auto lower = [&num_calls](XlaCompiler::CompilationResult* result) {
+    return ++num_calls == 1 ? errors::Internal("Failed") : OkStatus();
+  };
+
+  XlaCompiler::CompilationResult result;
+  EXPECT_FALSE(cache.GetOrLower(BuildKey(), lower, &result).ok());
+  TF_EXPECT_OK(cache.GetOrLower(BuildKey(), lower, &result));
+  EXPECT_EQ(num_calls, 2);
+}
+
+TEST_F(TfToHloLoweringCacheTest, ConcurrentLoweringsOfSameKeyWait) {
+  TfToHloLoweringCache cache;
+  TfToHloLoweringCache::Key key = BuildKey();
+  std::atomic<int> num_calls = 0;
+  auto lower = [&num_calls](XlaCompiler::CompilationResult* result) {
+    ++num_calls;
+    Env::Default()->SleepForMicroseconds(1000);
+    return OkStatus();
+  };
+
+  constexpr int kNumThreads = 8;
+  BlockingCounter counter(kNumThreads);
+  thread::ThreadPool pool(Env::Default(), "lowering", kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    pool.Schedule([&] {
+      XlaCompiler::CompilationResult result;
+      TF_EXPECT_OK(cache.GetOrLower(key, lower, &result));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  EXPECT_EQ(num_calls, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/inlined_vector.h"
@@ -326,6 +327,9 @@ namespace {
 struct ClusterInfo {
   int size;
 
+  // The names of the nodes in the cluster.
+  std::vector<absl::string_view> node_names;
+
   // Maps op names to the number of times they appear in the cluster.
   absl::flat_hash_map<absl::string_view, int> op_histogram;
 };
@@ -349,11 +353,21 @@ void ClusterInfoToProtobuf(XlaAutoClusteringSummary::Cluster* result,
                            absl::string_view name, const ClusterInfo& info) {
   result->set_name(std::string(name));
   result->set_size(info.size);
+  result->set_fingerprint(FingerprintCluster(info.node_names));
   HistogramMapToRepeatedOpAndCount(result->mutable_op_histogram(),
                                    info.op_histogram);
 }
 }  // namespace
 
+uint64 FingerprintCluster(std::vector<absl::string_view> node_names) {
+  absl::c_sort(node_names);
+  uint64 fingerprint = 0;
+  for (absl::string_view node_name : node_names) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(node_name));
+  }
+  return fingerprint;
+}
+
 XlaAutoClusteringSummary GetXlaAutoClusteringSummary(const Graph& graph) {
   absl::flat_hash_map<absl::string_view, ClusterInfo> cluster_name_to_info;
   XlaAutoClusteringSummary result;
@@ -366,6 +380,7 @@ XlaAutoClusteringSummary GetXlaAutoClusteringSummary(const Graph& graph) {
       result.set_clustered_node_count(result.clustered_node_count() + 1);
       ClusterInfo* info = &cluster_name_to_info[*cluster_name];
       info->size++;
+      info->node_names.push_back(n->name());
       info->op_histogram[n->type_string()]++;
     } else {
       result.set_unclustered_node_count(result.unclustered_node_count() + 1);
@@ -19,6 +19,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_UTIL_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -92,6 +93,11 @@ bool IsShapeConsumerOp(const Node& node);
 // `XlaAutoClusteringSummary` for details.
 XlaAutoClusteringSummary GetXlaAutoClusteringSummary(const Graph& graph);
 
+// Computes a fingerprint of the cluster made of the nodes named `node_names`.
+// It does not depend on the order of the names, so the same cluster of the same
+// model gets the same fingerprint across runs, whatever its cluster name.
+uint64 FingerprintCluster(std::vector<absl::string_view> node_names);
+
 // Returns the set of nodes that have a path to or from nodes that may have ref
 // variables as input or output.
 //
@@ -284,5 +284,14 @@ TEST(NodesRelatedToRefVariables, Cycles) {
 
   EXPECT_EQ(names, expected);
 }
+
+TEST(FingerprintCluster, IgnoresNodeOrder) {
+  EXPECT_EQ(FingerprintCluster({"a", "b", "c"}),
+            FingerprintCluster({"c", "a", "b"}));
+  EXPECT_NE(FingerprintCluster({"a", "b", "c"}),
+            FingerprintCluster({"a", "b", "d"}));
+  EXPECT_NE(FingerprintCluster({"a", "b"}),
+            FingerprintCluster({"a", "b", "c"}));
+}
 }  // namespace
 }  // namespace tensorflow
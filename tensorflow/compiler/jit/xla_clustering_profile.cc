@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+Status XlaClusteringProfileRecorder::Listen(
+    const XlaAutoClusteringActivity& auto_clustering_activity) {
+  mutex_lock lock(mu_);
+  for (const auto& cluster : auto_clustering_activity.summary().clusters()) {
+    cluster_fingerprints_[cluster.name()] = cluster.fingerprint();
+  }
+  return OkStatus();
+}
+
+void XlaClusteringProfileRecorder::RecordExecutionTime(
+    absl::string_view cluster_name, bool with_xla, int64_t execution_time_us) {
+  mutex_lock lock(mu_);
+  auto it = cluster_fingerprints_.find(cluster_name);
+  if (it == cluster_fingerprints_.end()) {
+    VLOG(3) << "Not recording the execution time of unknown cluster "
+            << cluster_name;
+    return;
+  }
+  ClusterTimes& times = cluster_times_[it->second];
+  if (with_xla) {
+    ++times.xla_sample_count;
+    times.xla_time_us += execution_time_us;
+  } else {
+    ++times.non_xla_sample_count;
+    times.non_xla_time_us += execution_time_us;
+  }
+}
+
+XlaClusteringProfile XlaClusteringProfileRecorder::GetProfile(
+    int64_t min_sample_count) const {
+  XlaClusteringProfile profile;
+  mutex_lock lock(mu_);
+  for (const auto& [fingerprint, times] : cluster_times_) {
+    if (times.xla_sample_count < min_sample_count ||
+        times.non_xla_sample_count < min_sample_count ||
+        times.xla_time_us <= 0) {
+      continue;
+    }
+    XlaClusteringProfile::Cluster* cluster = profile.add_clusters();
+    cluster->set_fingerprint(fingerprint);
+    cluster->set_speedup(
+        (static_cast<double>(times.non_xla_time_us) /
+         times.non_xla_sample_count) /
+        (static_cast<double>(times.xla_time_us) / times.xla_sample_count));
+    cluster->set_xla_sample_count(times.xla_sample_count);
+    cluster->set_non_xla_sample_count(times.non_xla_sample_count);
+  }
+  return profile;
+}
+
+void XlaClusteringProfileRecorder::Flush() {
+  if (output_path_.empty()) {
+    return;
+  }
+  Status status =
+      WriteXlaClusteringProfile(output_path_, GetProfile(min_sample_count_));
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write the XLA clustering profile to "
+                 << output_path_ << ": " << status;
+  }
+}
+
+Status WriteXlaClusteringProfile(const std::string& path,
+                                 const XlaClusteringProfile& profile) {
+  return WriteTextProto(Env::Default(), path, profile);
+}
+
+StatusOr<absl::flat_hash_map<uint64, double>> ReadProfiledClusterSpeedups(
+    const std::string& path) {
+  XlaClusteringProfile profile;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(Env::Default(), path, &profile));
+  absl::flat_hash_map<uint64, double> speedups;
+  for (const auto& cluster : profile.clusters()) {
+    speedups[cluster.fingerprint()] = cluster.speedup();
+  }
+  return speedups;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,103 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
+#include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Builds an XlaClusteringProfile from the execution times of XLA clusters with
+// and without XLA, e.g. recorded by a production job that runs a sample of its
+// steps with the clusters uncompiled.
+//
+// Execution times are recorded by cluster name. The recorder maps the names to
+// the fingerprints of the clusters from the auto-clustering activities it
+// listens to, so it must be registered before the graphs are clustered.
+class XlaClusteringProfileRecorder : public XlaActivityListener {
+ public:
+  // If `output_path` is not empty, Flush writes the profile of the clusters
+  // with at least `min_sample_count` samples with and without XLA to it.
+  explicit XlaClusteringProfileRecorder(std::string output_path = "",
+                                        int64_t min_sample_count = 1)
+      : output_path_(std::move(output_path)),
+        min_sample_count_(min_sample_count) {}
+
+  Status Listen(
+      const XlaAutoClusteringActivity& auto_clustering_activity) override;
+
+  Status Listen(
+      const XlaJitCompilationActivity& jit_compilation_activity) override {
+    return OkStatus();
+  }
+
+  Status Listen(const XlaOptimizationRemark& optimization_remark) override {
+    return OkStatus();
+  }
+
+  void Flush() override;
+
+  // Records one execution of the cluster named `cluster_name`. Executions of
+  // clusters that were not auto-clustered since the recorder was registered
+  // are ignored.
+  void RecordExecutionTime(absl::string_view cluster_name, bool with_xla,
+                           int64_t execution_time_us);
+
+  // Returns the profile of the clusters with at least `min_sample_count`
+  // samples with and without XLA.
+  XlaClusteringProfile GetProfile(int64_t min_sample_count) const;
+
+ private:
+  struct ClusterTimes {
+    int64_t xla_sample_count = 0;
+    int64_t xla_time_us = 0;
+    int64_t non_xla_sample_count = 0;
+    int64_t non_xla_time_us = 0;
+  };
+
+  const std::string output_path_;
+  const int64_t min_sample_count_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, uint64> cluster_fingerprints_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64, ClusterTimes> cluster_times_ TF_GUARDED_BY(mu_);
+};
+
+// Writes `profile` to `path` as a text proto.
+Status WriteXlaClusteringProfile(const std::string& path,
+                                 const XlaClusteringProfile& profile);
+
+// Reads the profile at `path`, as a text or binary proto, and returns the
+// measured speedups keyed by cluster fingerprint.
+StatusOr<absl::flat_hash_map<uint64, double>> ReadProfiledClusterSpeedups(
+    const std::string& path);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CLUSTERING_PROFILE_H_
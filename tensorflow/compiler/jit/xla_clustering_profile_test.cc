@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_clustering_profile.h"
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaAutoClusteringActivity MakeActivity() {
+  XlaAutoClusteringActivity activity;
+  auto* cluster = activity.mutable_summary()->add_clusters();
+  cluster->set_name("cluster_0");
+  cluster->set_fingerprint(100);
+  cluster = activity.mutable_summary()->add_clusters();
+  cluster->set_name("cluster_1");
+  cluster->set_fingerprint(200);
+  return activity;
+}
+
+TEST(XlaClusteringProfileRecorderTest, ComputesSpeedups) {
+  XlaClusteringProfileRecorder recorder;
+  TF_ASSERT_OK(recorder.Listen(MakeActivity()));
+
+  recorder.RecordExecutionTime("cluster_0", /*with_xla=*/true, 10);
+  recorder.RecordExecutionTime("cluster_0", /*with_xla=*/true, 30);
+  recorder.RecordExecutionTime("cluster_0", /*with_xla=*/false, 60);
+  recorder.RecordExecutionTime("cluster_1", /*with_xla=*/true, 50);
+  recorder.RecordExecutionTime("cluster_1", /*with_xla=*/false, 25);
+  recorder.RecordExecutionTime("unknown_cluster", /*with_xla=*/false, 25);
+
+  XlaClusteringProfile profile = recorder.GetProfile(/*min_sample_count=*/1);
+  ASSERT_EQ(profile.clusters_size(), 2);
+  absl::flat_hash_map<uint64, XlaClusteringProfile::Cluster> clusters;
+  for (const auto& cluster : profile.clusters()) {
+    clusters[cluster.fingerprint()] = cluster;
+  }
+  EXPECT_DOUBLE_EQ(clusters[100].speedup(), 3.0);
+  EXPECT_EQ(clusters[100].xla_sample_count(), 2);
+  EXPECT_EQ(clusters[100].non_xla_sample_count(), 1);
+  EXPECT_DOUBLE_EQ(clusters[200].speedup(), 0.5);
+
+  // Only cluster_0 has two samples with XLA, and neither has two without.
+  EXPECT_EQ(recorder.GetProfile(/*min_sample_count=*/2).clusters_size(), 0);
+}
+
+TEST(XlaClusteringProfileRecorderTest, FlushWritesProfile) {
+  std::string path =
+      io::JoinPath(testing::TmpDir(), "xla_clustering_profile.pbtxt");
+  XlaClusteringProfileRecorder recorder(path);
+  TF_ASSERT_OK(recorder.Listen(MakeActivity()));
+  recorder.RecordExecutionTime("cluster_1", /*with_xla=*/true, 20);
+  recorder.RecordExecutionTime("cluster_1", /*with_xla=*/false, 50);
+  recorder.Flush();
+
+  TF_ASSERT_OK_AND_ASSIGN(auto speedups, ReadProfiledClusterSpeedups(path));
+  ASSERT_EQ(speedups.size(), 1);
+  EXPECT_DOUBLE_EQ(speedups[200], 2.5);
+}
+
+TEST(XlaClusteringProfileTest, ReadMissingProfileFails) {
+  EXPECT_FALSE(ReadProfiledClusterSpeedups(
+                   io::JoinPath(testing::TmpDir(), "no_such_profile"))
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
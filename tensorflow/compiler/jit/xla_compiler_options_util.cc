@@ -144,6 +144,9 @@ XlaCompiler::CompileOptions GenerateCompileOptions(
   compile_options.always_return_tuple = false;
   compile_options.alias_resource_update =
       !has_ref_vars && may_alias_resource_update;
+  // Unlike resource updates, donated arguments do not need the variables to
+  // stay locked from compilation to execution.
+  compile_options.alias_donatable_arguments = !has_ref_vars;
   return compile_options;
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
@@ -85,6 +86,56 @@ absl::flat_hash_map<int, int> CreateVariableLookup(
   return variable_lookup;
 }
 
+// Runs all the partitions of the SPMD-partitioned `executable` on its
+// addressable devices and returns the outputs of the partition on `device`.
+// The partitioner replicates the arguments and results that are not annotated
+// with a sharding, so PjRt copies the arguments, which are on `device`, to the
+// other devices, and the outputs of the partition on `device` are complete.
+// The copies are appended to `owned_executable_args`.
+StatusOr<std::vector<std::unique_ptr<xla::PjRtBuffer>>> ExecuteSpmdPartitions(
+    absl::Span<xla::PjRtBuffer* const> executable_args,
+    xla::PjRtDevice* device, const xla::ExecuteOptions& options,
+    xla::PjRtLoadedExecutable* executable,
+    std::vector<std::unique_ptr<xla::PjRtBuffer>>* owned_executable_args,
+    std::optional<xla::PjRtFuture<Status>>& future) {
+  absl::Span<xla::PjRtDevice* const> devices =
+      executable->addressable_devices();
+  auto it = absl::c_find(devices, device);
+  if (it == devices.end()) {
+    return errors::InvalidArgument("Device ", device->DebugString(),
+                                   " does not run a partition of ",
+                                   executable->name());
+  }
+  const int partition = it - devices.begin();
+
+  std::vector<std::vector<xla::PjRtBuffer*>> argument_handles(devices.size());
+  for (int i = 0; i < devices.size(); ++i) {
+    if (i == partition) {
+      argument_handles[i].assign(executable_args.begin(),
+                                 executable_args.end());
+      continue;
+    }
+    argument_handles[i].reserve(executable_args.size());
+    for (xla::PjRtBuffer* arg : executable_args) {
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<xla::PjRtBuffer> copy,
+                          arg->CopyToDevice(devices[i]));
+      argument_handles[i].push_back(copy.get());
+      owned_executable_args->push_back(std::move(copy));
+    }
+  }
+
+  // Requests the futures, so that the copies can be kept alive until the
+  // partition on `device` is done.
+  std::optional<std::vector<xla::PjRtFuture<Status>>> futures(std::in_place);
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::vector<std::unique_ptr<xla::PjRtBuffer>>> outputs,
+      executable->Execute(argument_handles, options, futures));
+  if (futures.has_value()) {
+    future = std::move((*futures)[partition]);
+  }
+  return std::move(outputs[partition]);
+}
+
 }  // anonymous namespace
 
 std::vector<const Tensor*> InputsFromContext(OpKernelContext* ctx) {
@@ -143,6 +194,58 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `tensor` into a new buffer for the bounded dynamic `device_shape`,
+// which holds the data of the tensor followed by its dimension sizes.
+static StatusOr<se::OwningDeviceMemory> CopyToDynamicShapeBuffer(
+    OpKernelContext* ctx, const xla::Shape& device_shape, const Tensor& tensor,
+    int device_ordinal, se::DeviceMemoryAllocator* allocator) {
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  const se::Platform* platform = nullptr;
+  if (stream != nullptr) {
+    platform = stream->parent()->platform();
+  } else {
+    // Stream is not set for the host platform.
+    TF_ASSIGN_OR_RETURN(platform,
+                        se::MultiPlatformManager::PlatformWithId(
+                            XlaPlatformInfoFromDevice(ctx->device())));
+  }
+  TF_ASSIGN_OR_RETURN(auto transfer_manager,
+                      xla::TransferManager::GetForPlatform(platform));
+
+  const int64_t metadata_offset = transfer_manager->GetByteSizeRequirement(
+      xla::ShapeUtil::MakeStaticShape(device_shape));
+  const int64_t buffer_size =
+      transfer_manager->GetByteSizeRequirement(device_shape);
+  auto dims = std::make_shared<std::vector<int32_t>>(
+      tensor.shape().dim_sizes().begin(), tensor.shape().dim_sizes().end());
+  const int64_t metadata_size = dims->size() * sizeof(int32_t);
+  TF_RET_CHECK(tensor.dims() == device_shape.rank());
+  TF_RET_CHECK(tensor.TotalBytes() <= metadata_offset);
+  TF_RET_CHECK(metadata_offset + metadata_size <= buffer_size);
+
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory buffer,
+                      allocator->Allocate(device_ordinal, buffer_size));
+  se::DeviceMemoryBase data = buffer.cref();
+  se::DeviceMemoryBase metadata =
+      buffer->GetByteSlice(metadata_offset, metadata_size);
+  if (stream != nullptr) {
+    stream->ThenMemcpy(&data, XlaTensor::DeviceMemoryFromTensor(tensor),
+                       tensor.TotalBytes());
+    stream->ThenMemcpy(&metadata, dims->data(), metadata_size);
+    // Keeps the dimension sizes alive until they are copied.
+    stream->ThenDoHostCallback([dims]() {});
+    if (!stream->ok()) {
+      return errors::Internal("Failed to copy a dynamic shape input");
+    }
+  } else {
+    std::memcpy(data.opaque(), tensor.tensor_data().data(),
+                tensor.TotalBytes());
+    std::memcpy(metadata.opaque(), dims->data(), metadata_size);
+  }
+  return std::move(buffer);
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -176,8 +279,15 @@ XlaComputationLaunchContext::PopulateInputs(
                           ? resource_var_it->second
                           : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
+    // Like OpKernelContext::forward_input, an argument that nothing else
+    // refers to can be donated, so that the output aliased with it is written
+    // in place.
+    bool is_donatable_argument =
+        !is_resource_variable &&
+        !ctx->input_is_ref(arg_num - missing_ctx_input_prefix);
     bool donate_buffer =
-        t->RefCountIsOne() && is_updated_resource_variable &&
+        t->RefCountIsOne() &&
+        (is_updated_resource_variable || is_donatable_argument) &&
         input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
     VLOG(3) << "Processing input: " << i
             << "; is_resource_variable=" << is_resource_variable
@@ -195,6 +305,17 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
+    if (device_shape.is_dynamic() && !is_resource_variable) {
+      // The parameter was compiled with bounded dynamic dimensions, see
+      // ShapeBucketingPolicy.
+      TF_ASSIGN_OR_RETURN(
+          se::OwningDeviceMemory buffer,
+          CopyToDynamicShapeBuffer(ctx, device_shape, *t, device_ordinal_,
+                                   xla_allocator_));
+      execution_input.SetBuffer(
+          xla::ShapeIndex{}, xla::MaybeOwningDeviceMemory(std::move(buffer)));
+      continue;
+    }
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
@@ -670,6 +791,11 @@ Status PreparePjRtExecutableArguments(
                 pjrt_device);
         owned_args->push_back(std::move(pjrt_buffer));
         args->push_back(owned_args->back().get());
+        // The PjRtBuffer does not own the memory of the tensor, so it can not
+        // outlive the tensor as the output aliased with it.
+        if (!variable_snapshots.contains(arg_num)) {
+          non_donatable_input_indices->insert(args->size() - 1);
+        }
       }
     } else {
       if (av_tensor->GetBuffer() == nullptr) {
@@ -896,7 +1022,15 @@ StatusOr<std::vector<std::unique_ptr<xla::PjRtBuffer>>> RunPjRtExecutable(
 
   std::vector<std::unique_ptr<xla::PjRtBuffer>> execute_outputs;
   std::optional<xla::PjRtFuture<Status>> future;
-  if (executable->num_replicas() != 1 || executable->num_partitions() != 1) {
+  if (executable->num_partitions() > 1) {
+    TF_ASSIGN_OR_RETURN(
+        execute_outputs,
+        ExecuteSpmdPartitions(
+            executable_args, device,
+            GetPjRtExecuteOptions(device_type,
+                                  std::move(non_donatable_input_indices)),
+            executable, &owned_executable_args, future));
+  } else if (executable->num_replicas() != 1) {
     TF_ASSIGN_OR_RETURN(
         execute_outputs,
         executable->ExecuteSharded(
@@ -24,8 +24,10 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketing.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -65,6 +68,13 @@ XlaDeviceCompiler* CreateXlaDeviceCompiler(
       std::make_unique<XlaDeviceCompilerClient>(local_client));
 }
 
+// Returns the fingerprint of the executables built for `device_kind`, so that
+// the hosts sharing a persistent cache only load the executables built by the
+// same TensorFlow version for the same kind of device.
+std::string PlatformFingerprint(absl::string_view device_kind) {
+  return absl::StrCat(TF_VERSION_STRING, ",", device_kind);
+}
+
 PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
                                              xla::PjRtClient* pjrt_client) {
   std::string persistent_cache_directory =
@@ -75,6 +85,10 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.platform_fingerprint = PlatformFingerprint(absl::StrCat(
+      pjrt_client->platform_name(), ",", pjrt_client->platform_version()));
+  persistor_config.in_memory_cache_bytes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_in_memory_bytes;
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -199,6 +213,8 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.in_memory_cache_bytes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_in_memory_bytes;
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
@@ -269,9 +285,28 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
                                    platform_info.device_type().type());
   }
 
+  std::optional<ShapeBucketingPolicy> shape_bucketing_policy;
+  const std::string& shape_bucketing =
+      GetXlaOpsCommonFlags()->tf_xla_shape_bucketing;
+  if (!shape_bucketing.empty()) {
+    TF_ASSIGN_OR_RETURN(shape_bucketing_policy,
+                        ShapeBucketingPolicy::Parse(shape_bucketing));
+  }
+
+  const se::DeviceDescription& device_description =
+      client.value()
+          ->backend()
+          .default_stream_executor()
+          ->GetDeviceDescription();
+  persistor_config.platform_fingerprint = PlatformFingerprint(
+      absl::StrCat(platform.value()->Name(), ",", device_description.name(),
+                   ",", device_description.platform_version()));
+
   *xla_device_compiler = CreateXlaDeviceCompiler(
       persistor_config, DeviceType(registration->compilation_device_name),
       client.value());
+  (*xla_device_compiler)
+      ->set_shape_bucketing_policy(std::move(shape_bucketing_policy));
   return OkStatus();
 }
 
@@ -115,8 +115,11 @@ limitations under the License.
 #include "tensorflow/lite/tools/versioning/op_version.h"
 #include "tensorflow/lite/tools/versioning/runtime_version.h"
 #include "tensorflow/lite/version.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/fingerprint.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/tstring.h"
 
 using llvm::dyn_cast;
@@ -787,6 +790,9 @@ class Translator {
   // in the idx map, the value is a pair of offset and size
   absl::flat_hash_map<int, std::pair<uint64_t, uint64_t>> buffer_idx_map_;
   absl::flat_hash_map<int, std::vector<uint8_t>> buffer_data_map_;
+  // Maps buffer index to the data of a buffer stored in a constant attribute
+  // of the module, which is referenced instead of copied to save memory.
+  absl::flat_hash_map<int, absl::string_view> buffer_view_map_;
 
   // Maps custom options data to corresponding node
   // Key is set to be the list of input tensor indices and list of output tensor
@@ -849,6 +855,13 @@ class Translator {
   // Map from mlir constant attribute to the buffer index. This is used to
   // deduplicate the buffers in the flatbuffer.
   llvm::DenseMap<mlir::ElementsAttr, int> const_attribute_to_buffer_map_;
+
+  // Map from the fingerprint and size of the data of a buffer written into
+  // the flatbuffer to its index. This deduplicates the buffers of distinct
+  // constant attributes with the same data. Buffers stored after the
+  // flatbuffer are deduplicated in AppendBufferData instead.
+  absl::flat_hash_map<std::pair<uint64_t, size_t>, int>
+      buffer_content_to_buffer_map_;
 };
 
 bool Translator::EstimateArithmeticCount(int64_t* count) {
@@ -904,6 +917,20 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     const_attribute_to_buffer_map_[attr] = index;
   }
 
+  // Returns true if a buffer with the same data was already built, in which
+  // case `index` is set to the index of that buffer.
+  auto find_buffer_with_same_data = [&](const void* data, size_t size) {
+    if (!can_be_deduplicated) return false;
+    const uint64_t fingerprint = tsl::Fingerprint64(
+        absl::string_view(reinterpret_cast<const char*>(data), size));
+    auto it = buffer_content_to_buffer_map_.try_emplace(
+        std::make_pair(fingerprint, size), index);
+    if (it.second) return false;
+    index = it.first->second;
+    const_attribute_to_buffer_map_[attr] = index;
+    return true;
+  };
+
   // TF doesn't currently support 4-bit types (DT_INT4), so we'll run into
   // trouble calling ConvertToTensor(). For now, extract the tensor data from
   // ElementsAttr directly in this and read type from tflite::TensorType instead
@@ -925,12 +952,37 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
         require_use_buffer_offset_ = true;
         return empty_buffer_;
       }
+      if (find_buffer_with_same_data(packed_buffer.data(),
+                                     packed_buffer.size())) {
+        return empty_buffer_;
+      }
       auto buffer_data =
           builder_.CreateVector(packed_buffer.data(), packed_buffer.size());
       return tflite::CreateBuffer(builder_, buffer_data);
     }
   }
 
+  // The raw data of non-splat dense attributes of byte-aligned numeric types
+  // is laid out as in TFLite, so buffers stored after the flatbuffer reference
+  // it instead of copying the data of every constant of the model.
+  if (use_buffer_offset_) {
+    auto dense_attr = attr.dyn_cast<mlir::DenseElementsAttr>();
+    mlir::Type element_type = attr.getElementType();
+    if (auto quant_type = element_type.dyn_cast<mlir::quant::QuantizedType>()) {
+      element_type = quant_type.getStorageType();
+    }
+    if (auto complex_type = element_type.dyn_cast<mlir::ComplexType>()) {
+      element_type = complex_type.getElementType();
+    }
+    if (dense_attr && !dense_attr.isSplat() && element_type.isIntOrFloat() &&
+        element_type.getIntOrFloatBitWidth() % 8 == 0) {
+      llvm::ArrayRef<char> raw_data = dense_attr.getRawData();
+      buffer_view_map_[index] =
+          absl::string_view(raw_data.data(), raw_data.size());
+      return tflite::CreateBuffer(builder_, 0, 1, 1);
+    }
+  }
+
   tensorflow::Tensor tensor;
   auto status = tensorflow::ConvertToTensor(attr, &tensor);
   if (!status.ok()) {
@@ -961,6 +1013,10 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
         require_use_buffer_offset_ = true;
         return empty_buffer_;
       }
+      if (find_buffer_with_same_data(tensor_buffer, bytes)) {
+        free(tensor_buffer);
+        return empty_buffer_;
+      }
       auto buffer_data = builder_.CreateVector(
           reinterpret_cast<uint8_t*>(tensor_buffer), bytes);
       free(tensor_buffer);
@@ -979,6 +1035,9 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
       require_use_buffer_offset_ = true;
       return empty_buffer_;
     }
+    if (find_buffer_with_same_data(tensor_data.data(), tensor_data.size())) {
+      return empty_buffer_;
+    }
     auto buffer_data = builder_.CreateVector(
         reinterpret_cast<const uint8_t*>(tensor_data.data()),
         tensor_data.size());
@@ -3139,18 +3198,57 @@ std::optional<std::string> Translator::TranslateInternal() {
 
 void Translator::AppendBufferData(std::string& result) {
   std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> hashcode_to_pos;
+  std::vector<std::pair<int, absl::string_view>> buffers;
+  buffers.reserve(buffer_data_map_.size() + buffer_view_map_.size());
+  for (const auto& it : buffer_data_map_) {
+    buffers.emplace_back(
+        it.first,
+        absl::string_view(reinterpret_cast<const char*>(it.second.data()),
+                          it.second.size()));
+  }
+  buffers.insert(buffers.end(), buffer_view_map_.begin(),
+                 buffer_view_map_.end());
+
+  // Fingerprinting dominates the time spent here for large models, so the
+  // buffers are fingerprinted in parallel.
+  std::vector<uint64_t> hashes(buffers.size());
+  auto fingerprint = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      hashes[i] = tsl::Fingerprint64(buffers[i].second);
+    }
+  };
+  const int num_threads =
+      std::min<int64_t>(tsl::port::MaxParallelism(), buffers.size());
+  if (num_threads > 1) {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(),
+                                        "tflite_buffer_fingerprint",
+                                        num_threads);
+    int64_t total_bytes = 0;
+    for (const auto& buffer : buffers) total_bytes += buffer.second.size();
+    thread_pool.ParallelFor(buffers.size(), total_bytes / buffers.size() + 1,
+                            fingerprint);
+  } else {
+    fingerprint(0, buffers.size());
+  }
+
+  // Reserve the space of all the buffers up front, so that appending them
+  // does not reallocate the result.
+  size_t reserved_size = result.size() + 16 * (buffers.size() + 2) + 32;
+  for (const auto& buffer : buffers) reserved_size += buffer.second.size();
+  result.reserve(reserved_size);
+
   // Pad to be 16 bytes aligned
   while (result.size() % 16 != 0) result += '\0';
-  for (auto& it : buffer_data_map_) {
-    auto buffer = std::string(it.second.begin(), it.second.end());
-    int64_t index = it.first;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    int64_t index = buffers[i].first;
+    absl::string_view data = buffers[i].second;
     int64_t offset = result.size();
-    int64_t size = it.second.size();
-    uint64_t hash = tsl::Fingerprint64(buffer);
+    int64_t size = data.size();
+    uint64_t hash = hashes[i];
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
       hashcode_to_pos[hash] = std::make_pair(offset, size);
       buffer_idx_map_[index] = std::make_pair(offset, size);
-      result += std::string(it.second.begin(), it.second.end());
+      result.append(data.data(), data.size());
       // Pad to be 16 bytes aligned
       while (result.size() % 16 != 0) result += '\0';
     } else {
@@ -191,6 +191,14 @@ void EmitKernel(FunctionEmitterContext& function_context,
     arguments.push_back(id);
   }
 
+  // Results without uses are dead once the kernel returns, so their registers
+  // can be reused right away, which also releases the dead values as soon as
+  // the registers are overwritten.
+  for (auto result : op.getResults()) {
+    const auto& reg_info = function_context.register_table[result];
+    if (reg_info.num_uses == 0) function_context.FreeRegId(reg_info.id);
+  }
+
   constructor.construct_arguments(arguments.size())
       .Assign(arguments.begin(), arguments.end());
   constructor.construct_last_uses(last_uses.size())
@@ -256,6 +264,13 @@ void EmitFunction(const ModuleEmitterContext& module_context,
   }
   constructor.construct_input_regs(input_regs);
 
+  // The registers of the unused arguments are only freed after all arguments
+  // got their own registers.
+  for (auto arg : block.getArguments()) {
+    const auto& reg_info = register_table[arg];
+    if (reg_info.num_uses == 0) function_context.FreeRegId(reg_info.id);
+  }
+
   for (auto& op : block) {
     for (auto result : op.getResults()) {
       register_table[result] = {static_cast<int>(
@@ -94,6 +94,44 @@ TEST(MlirToByteCodeTest, Basic) {
   EXPECT_TRUE(kernels[10].results().empty());
 }
 
+TEST(MlirToByteCodeTest, ReusesRegistersOfUnusedValues) {
+  constexpr char kUnusedValuesMlir[] =
+      "tensorflow/compiler/mlir/tfrt/translate/mlrt/testdata/"
+      "unused_values.mlir";
+
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::func::FuncDialect>();
+  mlir::MLIRContext mlir_context(registry);
+  mlir_context.allowUnregisteredDialects();
+  auto mlir_module = mlir::parseSourceFile<mlir::ModuleOp>(
+      tsl::GetDataDependencyFilepath(kUnusedValuesMlir), &mlir_context);
+
+  AttributeEncoderRegistry attribute_encoder_registry;
+  bc::Buffer buffer =
+      EmitExecutable(attribute_encoder_registry, mlir_module.get()).value();
+
+  bc::Executable executable(buffer.data());
+
+  auto functions = executable.functions();
+  ASSERT_EQ(functions.size(), 1);
+
+  // The unused argument and the unused result do not hold on to registers.
+  auto function = functions[0];
+  EXPECT_EQ(function.num_regs(), 3);
+  EXPECT_THAT(function.input_regs(), ElementsAreArray({0, 1}));
+  EXPECT_THAT(function.output_regs(), ElementsAreArray({2}));
+
+  auto kernels = function.kernels();
+  ASSERT_EQ(kernels.size(), 3);
+
+  EXPECT_THAT(kernels[0].arguments(), ElementsAreArray({0, 0}));
+  EXPECT_THAT(kernels[0].results(), ElementsAreArray({1, 2}));
+
+  EXPECT_THAT(kernels[1].arguments(), ElementsAreArray({1, 0}));
+  EXPECT_THAT(kernels[1].last_uses(), ElementsAreArray({1, 1}));
+  EXPECT_THAT(kernels[1].results(), ElementsAreArray({2}));
+}
+
 template <typename T>
 absl::StatusOr<T> DecodeAttribute(absl::string_view data) {
   if (data.size() < sizeof(T))
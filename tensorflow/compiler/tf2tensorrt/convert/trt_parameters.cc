@@ -76,6 +76,8 @@ string ProfileStrategyToName(const ProfileStrategy strategy) {
       return "Range+Optimal";
     case ProfileStrategy::kImplicitBatchModeCompatible:
       return "ImplicitBatchModeCompatible";
+    case ProfileStrategy::kClustered:
+      return "Clustered";
   }
   return "Unknown";
 }
@@ -92,6 +94,8 @@ Status ProfileStrategyFromName(const string& name, ProfileStrategy* strategy) {
     *strategy = ProfileStrategy::kRangeOptimal;
   } else if (name_lowercase == "implicitbatchmodecompatible") {
     *strategy = ProfileStrategy::kImplicitBatchModeCompatible;
+  } else if (name_lowercase == "clustered") {
+    *strategy = ProfileStrategy::kClustered;
   } else {
     return errors::InvalidArgument("Invalid profile strategy: ", name);
   }
@@ -55,11 +55,15 @@ string DebugString(const TrtPrecisionMode mode);
 // - `kRangeOptimal`: create the profiles for both `Range` and `Optimal`.
 // - `kImplicitBatchModeCompatible`: create the profiles that will produce the
 //   same GPU engines as the implicit_batch_mode would produce.
+// - `kClustered`: cluster the inputs into a bounded number of profiles, such
+//   that the inputs are as close as possible to the max dims of their profile,
+//   weighting each input by how often it was seen.
 enum class ProfileStrategy {
   kRange,
   kOptimal,
   kRangeOptimal,
   kImplicitBatchModeCompatible,
+  kClustered,
 };
 
 string ProfileStrategyToName(const ProfileStrategy strategy);
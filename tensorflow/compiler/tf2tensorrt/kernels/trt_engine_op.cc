@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <algorithm>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -46,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
@@ -140,6 +142,9 @@ class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
 
+  // Waits for the engines being built in the background.
+  ~TRTEngineOp() override;
+
   void ComputeAsync(OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -188,13 +193,27 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
-  // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // Builds and returns a cuda engine for the input shapes and profiles on the
+  // device named device_name. ctx may be null if the op has no resource
+  // inputs. If building the engine fails, the caller should enter a dummy entry
+  // into the cache_resource cache so we don't continually try to build the
+  // same failing engine.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+      TRTEngineCacheResource* cache_resource,
+      TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+      const string& device_name);
+
+  // Schedules building the engine for the input shapes and profiles on the
+  // engine build thread pool, unless such a build is pending already, and adds
+  // the engine to the cache_resource cache once it is built. In explicit batch
+  // mode, the engine and the profiles replace those of cache_resource.
+  void BuildEngineInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource,
+      TrtShapeOptimizationProfile profiles)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -247,8 +266,37 @@ class TRTEngineOp : public AsyncOpKernel {
   // Flag to detect whether native segment nodes have been deleted from graph
   bool native_segment_absent_;
 
+  // Whether to build the engines in the background and execute the native
+  // segment until they are built.
+  bool build_engines_in_background_;
+
+  // The number of requests whose input shapes no profile includes after
+  // which the profiles are rebuilt from the input shapes seen so far, or 0 if
+  // the profiles are never rebuilt. Only used in explicit batch mode when the
+  // engines are built in the background.
+  int64 profile_rebuild_threshold_;
+
+  // The maximum number of profiles when they are rebuilt.
+  int64 max_num_rebuilt_profiles_;
+
   int64 workspace_size_;
   mutex engine_mutex_;
+
+  // The number of requests whose input shapes no profile includes since the
+  // profiles were last rebuilt.
+  int64 num_uncovered_requests_ TF_GUARDED_BY(engine_mutex_) = 0;
+
+  // Held shared by the requests, and exclusively to replace the engines and
+  // profiles that the requests use outside of engine_mutex_. Acquired before
+  // engine_mutex_.
+  mutex engine_swap_mutex_;
+
+  // The input shapes of the engines being built in the background, or a
+  // single empty key in explicit batch mode, where one engine serves all the
+  // profiles. pending_builds_cv_ is notified whenever a build completes.
+  std::unordered_set<std::vector<TensorShape>, VectorTensorShapeHasher>
+      pending_builds_ TF_GUARDED_BY(engine_mutex_);
+  condition_variable pending_builds_cv_;
   FunctionLibraryRuntime::Handle native_execution_func_handle_;
 
   // The finalized calibrator for inference.
@@ -303,6 +351,40 @@ void* GetTensorAddress(const Tensor* tensor_ptr) {
   }
 }
 
+// Returns whether TRTEngineOps should build their engines in the background
+// instead of in the request that misses the cache. The requests execute the
+// native segment until the engines are built.
+static bool BuildEnginesInBackground() {
+  bool value;
+  Status status = ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                     /*default_val=*/false, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return value;
+}
+
+// Returns the value of the int64 environment variable var_name, or
+// default_val if it is not set.
+static int64 ReadInt64EnvVar(const char* var_name, int64 default_val) {
+  int64 value;
+  Status status = ReadInt64FromEnvVar(var_name, default_val, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return default_val;
+  }
+  return value;
+}
+
+// Returns the thread pool shared by all the TRTEngineOps to build engines in
+// the background. It has a single thread, since building an engine already
+// uses the GPU fully.
+static thread::ThreadPool* EngineBuildThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "tf_trt_engine_build", /*num_threads=*/1);
+  return pool;
+}
+
 static Status FunctionDefToGraphDef(FunctionLibraryRuntime::Handle handle,
                                     FunctionLibraryRuntime* flib_runtime,
                                     GraphDef* graph_def) {
@@ -479,6 +561,13 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
     }
   }
 
+  // Resource inputs are converted to weights from the OpKernelContext of the
+  // request, so they need the engine to be built in the request.
+  build_engines_in_background_ =
+      BuildEnginesInBackground() && !native_segment_absent_ &&
+      absl::c_all_of(input_mask_,
+                     [](bool is_engine_input) { return is_engine_input; });
+
   // TODO(laigd): calibration_data is used in TF v1.x and we keep it only for
   // backward compatibility reasons. Remove it once all known users switch to
   // 2.0.
@@ -550,6 +639,25 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
       [](PartialTensorShape shape) { return !shape.IsFullyDefined(); });
   VLOG(2) << "TRTEngineOp has_dynamic_shape_input_: "
           << has_dynamic_shape_input_;
+
+  // Rebuilding the profiles from the live traffic needs the native segment to
+  // execute the requests until the new engine is built.
+  profile_rebuild_threshold_ = 0;
+  if (build_engines_in_background_ && !use_implicit_batch_ &&
+      !static_engine_) {
+    profile_rebuild_threshold_ =
+        ReadInt64EnvVar("TF_TRT_PROFILE_REBUILD_THRESHOLD", 0);
+  }
+  max_num_rebuilt_profiles_ = ReadInt64EnvVar(
+      "TF_TRT_MAX_NUM_REBUILT_PROFILES",
+      TrtShapeOptimizationProfile::kDefaultMaxNumClusteredProfiles);
+}
+
+TRTEngineOp::~TRTEngineOp() {
+  mutex_lock lock(engine_mutex_);
+  while (!pending_builds_.empty()) {
+    pending_builds_cv_.wait(lock);
+  }
 }
 
 // Copies input tensor ctx->input(i) (which is in device memory) to the host,
@@ -831,6 +939,9 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
   OP_REQUIRES_OK_ASYNC(ctx, GetEngineCacheResource(ctx, &cache_res),
                        dummy_async_helper);
   core::ScopedUnref unref_cache_res(cache_res);
+  // Keeps the engines and profiles from being replaced by a background build
+  // while they are used.
+  tf_shared_lock swap_lock(engine_swap_mutex_);
 
   // Get shapes of inputs to engine.
   std::vector<TensorShape> input_concrete_shapes;
@@ -887,8 +998,10 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
         cache_res->profiles_.AddShape(input_concrete_shapes);
       }
       // Create profiles out of collected shapes during profile generation.
-      cache_res->profiles_.InitProfiles(input_partial_shapes_,
-                                        profile_strategy_);
+      OP_REQUIRES_OK_ASYNC(ctx,
+                           cache_res->profiles_.InitProfiles(
+                               input_partial_shapes_, profile_strategy_),
+                           dummy_async_helper);
     }
   }
 
@@ -1087,15 +1200,17 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
-    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+    TRTEngineCacheResource* cache_resource,
+    TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+    const string& device_name) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
+  TRT_ENSURE(profiles);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
-      use_implicit_batch_ || cache_resource->profiles_.IsStaticCompatible();
+      use_implicit_batch_ || profiles->IsStaticCompatible();
   const std::vector<PartialTensorShape>& conversion_input_shapes =
       use_concrete_shapes
           ? std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
@@ -1107,9 +1222,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1117,22 +1231,83 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
-      &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      profiles, name(), use_explicit_precision_, &cluster, device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+void TRTEngineOp::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_res,
+    TrtShapeOptimizationProfile profiles) {
+  std::vector<TensorShape> key =
+      use_implicit_batch_ ? input_concrete_shapes : std::vector<TensorShape>();
+  if (!pending_builds_.insert(key).second) return;
+  const int platform_device_id =
+      ctx->device()->tensorflow_accelerator_device_info()->gpu_id;
+  string device_name = ctx->device()->name();
+  VLOG(1) << "Scheduling a background build of the TensorRT engine for "
+          << name() << " with input shapes: "
+          << DebugString(input_concrete_shapes);
+
+  cache_res->Ref();
+  EngineBuildThreadPool()->Schedule([this, input_concrete_shapes, batch_size,
+                                     key = std::move(key), platform_device_id,
+                                     device_name = std::move(device_name),
+                                     cache_res,
+                                     profiles = std::move(profiles)]() mutable {
+    core::ScopedUnref sc(cache_res);
+    auto err = cudaSetDevice(platform_device_id);
+    if (err != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_device_id
+                 << " in engine build thread";
+    }
+    // The engine is built without holding engine_mutex_, and for a copy of the
+    // profiles, so that the requests keep executing the native segment or the
+    // current engine meanwhile. Up to this point, calibrator_ can never be
+    // empty, as in GetEngine.
+    auto result = BuildEngine(input_concrete_shapes, batch_size,
+                              use_calibration_, calibrator_.get(), cache_res,
+                              &profiles, /*ctx=*/nullptr, device_name);
+
+    mutex_lock swap_lock(engine_swap_mutex_);
+    mutex_lock lock(engine_mutex_);
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = result.status();
+    if (status.ok()) {
+      status = profiles.CreateExecutionContexts(result.value().get(),
+                                                &exec_contexts);
+    }
+    if (status.ok()) {
+      if (!use_implicit_batch_) {
+        // A single engine serves all the profiles in explicit batch mode.
+        cache_res->profiles_.ReplaceProfiles(std::move(profiles));
+        cache_res->cache_.clear();
+      }
+      cache_res->cache_.emplace(
+          input_concrete_shapes,
+          std::make_unique<EngineContext>(std::move(result.value()),
+                                          std::move(exec_contexts)));
+      VLOG(1) << "Added new engine to cache of " << name()
+              << ". Cache size: " << cache_res->cache_.size();
+    } else if (use_implicit_batch_ || cache_res->cache_.size() == 0) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again. A failed rebuild of the
+      // profiles keeps the current engine.
+      cache_res->cache_.emplace(input_concrete_shapes,
+                                std::make_unique<EngineContext>());
+    }
+    pending_builds_.erase(key);
+    pending_builds_cv_.notify_all();
+  });
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1220,8 +1395,13 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       }
       auto result = BuildEngine(input_concrete_shapes, batch_size,
                                 /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res, ctx);
+                                /*calibrator=*/nullptr, cache_res,
+                                &cache_res->profiles_, ctx,
+                                ctx->device()->name());
       if (!result.ok()) {
+        // Store an empty engine in the cache so we don't try to build the
+        // same failing engine again.
+        cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.value());
@@ -1261,10 +1441,34 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
 
   int profile_id = -1;
   if (!use_implicit_batch_) {
+    if (profile_rebuild_threshold_ > 0) {
+      // Collect the histogram of the input shapes to rebuild the profiles.
+      cache_res->profiles_.AddShape(input_concrete_shapes);
+    }
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
     // Since all profiles are already created at this point, finding no
-    // compatible profiles results in falling back to native TF.
+    // compatible profiles results in falling back to native TF, until the
+    // profiles are rebuilt from the input shapes seen so far if requested.
     if (profile_id == -1) {
+      if (profile_rebuild_threshold_ > 0 &&
+          ++num_uncovered_requests_ >= profile_rebuild_threshold_ &&
+          pending_builds_.empty() && AllowEngineNativeSegmentExecution()) {
+        VLOG(1) << "Rebuilding the profiles of " << name() << " after "
+                << num_uncovered_requests_ << " requests matched no profile";
+        num_uncovered_requests_ = 0;
+        TrtShapeOptimizationProfile profiles = cache_res->profiles_;
+        profiles.clear();
+        Status s = profiles.InitProfiles(input_partial_shapes_,
+                                         ProfileStrategy::kClustered,
+                                         max_num_rebuilt_profiles_);
+        if (s.ok()) {
+          BuildEngineInBackground(input_concrete_shapes, batch_size, ctx,
+                                  cache_res, std::move(profiles));
+        } else {
+          LOG_WARNING_WITH_PREFIX << "Not rebuilding the profiles of " << name()
+                                  << ": " << s;
+        }
+      }
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
   }
@@ -1290,12 +1494,24 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    // Build the engine in the background if the native segment can be
+    // executed until it is built.
+    if (build_engines_in_background_ && AllowEngineNativeSegmentExecution()) {
+      BuildEngineInBackground(input_concrete_shapes, batch_size, ctx,
+                              cache_res, cache_res->profiles_);
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
         BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
+                    calibrator_.get(), cache_res, &cache_res->profiles_, ctx,
+                    ctx->device()->name());
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine = std::move(result.value());
@@ -112,7 +112,7 @@ class TRTEngineOpTestBase : public OpsTestBase {
           TensorShapeUtils::MakeShape(std::vector<int32>{1, 2}, &my_shape));
       profile.AddShape({my_shape, {}});
 
-      profile.InitProfiles({shape}, ProfileStrategy::kOptimal);
+      TF_CHECK_OK(profile.InitProfiles({shape}, ProfileStrategy::kOptimal));
       std::vector<PartialTensorShape> shape_vec{shape, {}};
       TF_CHECK_OK(convert::CreateStaticEngine(
           params, info, 1, shape_vec, &profile, &segment_string, nullptr));
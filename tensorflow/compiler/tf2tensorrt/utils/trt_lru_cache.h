@@ -58,6 +58,11 @@ class LRUCache {
 
   size_t size() const { return objects_.size(); }
 
+  void clear() {
+    objects_.clear();
+    keys_.clear();
+  }
+
   size_t count(const key_type& key) const { return objects_.count(key); }
 
   value_type& at(const key_type& key) { return Touch(key); }
@@ -53,5 +53,21 @@ TEST(LRUCacheTest, Basic) {
   EXPECT_EQ(cache.count(40), 1);
 }
 
+TEST(LRUCacheTest, Clear) {
+  LRUCache<int, int, std::hash<int>> cache;
+  cache.reserve(2);
+  cache.emplace(10, 100);
+  cache.emplace(20, 200);
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.count(10), 0);
+  // The cleared entries don't count against the capacity anymore.
+  cache.emplace(30, 300);
+  cache.emplace(40, 400);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.at(30), 300);
+  EXPECT_EQ(cache.at(40), 400);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -17,8 +17,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
 
 #include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -125,6 +129,147 @@ Status TrtShapeOptimizationProfile::RangeStrategy(
   return OkStatus();
 }
 
+namespace {
+
+// The number of the most frequent shapes that ClusteredStrategy clusters
+// pairwise. The less frequent shapes are then added to the closest cluster.
+constexpr int kMaxPairwiseClusteredShapes = 64;
+
+// Returns the total number of elements of the input tensors, i.e. of the first
+// half of dimvec, the second half holding the shape values.
+int64_t NumInputElements(const std::vector<nvinfer1::Dims>& dimvec) {
+  int64_t num_elements = 0;
+  for (int i = 0; i < dimvec.size() / 2; i++) {
+    int64_t tensor_elements = 1;
+    for (int j = 0; j < dimvec[i].nbDims; j++) {
+      tensor_elements *= dimvec[i].d[j];
+    }
+    num_elements += tensor_elements;
+  }
+  return num_elements;
+}
+
+// A set of collected shapes that share an optimization profile.
+struct ShapeCluster {
+  ShapeCluster(const std::vector<nvinfer1::Dims>& dimvec, int64_t dimvec_count)
+      : min(dimvec),
+        max(dimvec),
+        opt(dimvec),
+        opt_count(dimvec_count),
+        count(dimvec_count),
+        weighted_num_elements(dimvec_count * NumInputElements(dimvec)) {}
+
+  // Returns how many more elements running the inputs of the cluster with max
+  // dims would process, which approximates the cost of sharing a profile.
+  int64_t PaddingCost() const {
+    return count * NumInputElements(max) - weighted_num_elements;
+  }
+
+  // Adds the shapes of other to this cluster.
+  Status Merge(const ShapeCluster& other) {
+    TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+        &min, other.min, [](int a, int b) { return std::min(a, b); }));
+    TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+        &max, other.max, [](int a, int b) { return std::max(a, b); }));
+    if (other.opt_count > opt_count) {
+      opt = other.opt;
+      opt_count = other.opt_count;
+    }
+    count += other.count;
+    weighted_num_elements += other.weighted_num_elements;
+    return OkStatus();
+  }
+
+  std::vector<nvinfer1::Dims> min;
+  std::vector<nvinfer1::Dims> max;
+  // The most frequent shape of the cluster and its number of occurrences.
+  std::vector<nvinfer1::Dims> opt;
+  int64_t opt_count;
+  // The number of occurrences of all the shapes of the cluster, and the sum of
+  // their number of elements weighted by their number of occurrences.
+  int64_t count;
+  int64_t weighted_num_elements;
+};
+
+// Returns by how much merging a and b increases the padding cost.
+StatusOr<int64_t> MergeCost(const ShapeCluster& a, const ShapeCluster& b) {
+  ShapeCluster merged = a;
+  TF_RETURN_IF_ERROR(merged.Merge(b));
+  return merged.PaddingCost() - a.PaddingCost() - b.PaddingCost();
+}
+
+}  // namespace
+
+// Greedily merges the pair of clusters whose padding cost grows the least,
+// starting from one cluster per shape, until at most max_num_profiles are
+// left. Each cluster becomes a profile, whose opt dims are its most frequent
+// shape.
+Status TrtShapeOptimizationProfile::ClusteredStrategy(
+    const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+    const std::vector<int64_t>& collected_counts, int max_num_profiles) {
+  if (collected_shapes.empty()) return OkStatus();
+  max_num_profiles = std::max(max_num_profiles, 1);
+
+  std::vector<int> order(collected_shapes.size());
+  std::iota(order.begin(), order.end(), 0);
+  absl::c_stable_sort(order, [&collected_counts](int a, int b) {
+    return collected_counts[a] > collected_counts[b];
+  });
+  const int num_pairwise =
+      std::min<int>(order.size(), kMaxPairwiseClusteredShapes);
+  std::vector<ShapeCluster> clusters;
+  for (int k = 0; k < num_pairwise; k++) {
+    clusters.emplace_back(collected_shapes[order[k]],
+                          collected_counts[order[k]]);
+  }
+  while (clusters.size() > max_num_profiles) {
+    int best_a = 0;
+    int best_b = 1;
+    int64_t best_cost = std::numeric_limits<int64_t>::max();
+    for (int a = 0; a < clusters.size(); a++) {
+      for (int b = a + 1; b < clusters.size(); b++) {
+        TF_ASSIGN_OR_RETURN(int64_t cost, MergeCost(clusters[a], clusters[b]));
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_a = a;
+          best_b = b;
+        }
+      }
+    }
+    TF_RETURN_IF_ERROR(clusters[best_a].Merge(clusters[best_b]));
+    clusters.erase(clusters.begin() + best_b);
+  }
+  for (int k = num_pairwise; k < order.size(); k++) {
+    ShapeCluster cluster(collected_shapes[order[k]],
+                         collected_counts[order[k]]);
+    if (clusters.size() < max_num_profiles) {
+      clusters.push_back(std::move(cluster));
+      continue;
+    }
+    int best = 0;
+    int64_t best_cost = std::numeric_limits<int64_t>::max();
+    for (int c = 0; c < clusters.size(); c++) {
+      TF_ASSIGN_OR_RETURN(int64_t cost, MergeCost(clusters[c], cluster));
+      if (cost < best_cost) {
+        best_cost = cost;
+        best = c;
+      }
+    }
+    TF_RETURN_IF_ERROR(clusters[best].Merge(cluster));
+  }
+
+  for (const ShapeCluster& cluster : clusters) {
+    VLOG(2) << "Initializing optimization profile config with min="
+            << DebugString(cluster.min) << ", opt=" << DebugString(cluster.opt)
+            << ", max=" << DebugString(cluster.max) << " for "
+            << cluster.count << " inputs";
+    OptimizationProfileConfig profConfig{cluster.min, cluster.opt,
+                                         cluster.max};
+    profiles_.push_back(std::move(profConfig));
+  }
+  return OkStatus();
+}
+
 void TrtShapeOptimizationProfile::OptimalStrategy(
     const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes) {
   for (auto& shape_vec : collected_shapes) {
@@ -138,6 +283,38 @@ void TrtShapeOptimizationProfile::OptimalStrategy(
   }
 }
 
+void TrtShapeOptimizationProfile::AddShape(
+    const std::vector<TensorShape>& shapes) {
+  string key = absl::StrCat(DebugString(shapes), ";",
+                            DebugString(actual_shape_values_));
+  auto it = input_shape_indices_.find(key);
+  if (it != input_shape_indices_.end()) {
+    input_shape_counts_[it->second]++;
+    return;
+  }
+  if (input_shapes_.size() >= kMaxCollectedShapes) {
+    VLOG(2) << "Not collecting shape(s) " << DebugString(shapes)
+            << " since " << kMaxCollectedShapes
+            << " shapes were already collected.";
+    return;
+  }
+  input_shape_indices_.emplace(std::move(key), input_shapes_.size());
+  input_shapes_.push_back(shapes);
+  input_shape_values_.push_back(actual_shape_values_);
+  input_shape_counts_.push_back(1);
+  VLOG(1) << "Collected shape(s) " << DebugString(shapes) << " for profiles.";
+}
+
+void TrtShapeOptimizationProfile::ReplaceProfiles(
+    TrtShapeOptimizationProfile&& other) {
+  other.input_shapes_ = std::move(input_shapes_);
+  other.input_shape_values_ = std::move(input_shape_values_);
+  other.input_shape_counts_ = std::move(input_shape_counts_);
+  other.input_shape_indices_ = std::move(input_shape_indices_);
+  other.actual_shape_values_ = std::move(actual_shape_values_);
+  *this = std::move(other);
+}
+
 // Collects the values of tensors that are ShapeTensorCompatible to. The values
 // are stored in the actual_shape_values_ member variable.
 Status TrtShapeOptimizationProfile::CollectShapeValues(OpKernelContext* ctx) {
@@ -240,10 +417,11 @@ void FixShapeValueProfile(OptimizationProfileConfig* prof,
   }
 }
 
-// Checks whether rhs is already contained in values.
-bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
-                      const std::vector<nvinfer1::Dims>& rhs) {
-  for (auto& lhs : values) {
+// Returns the index of rhs in values, or -1 if it is not contained in values.
+int CollectedIndex(const std::vector<std::vector<nvinfer1::Dims>>& values,
+                   const std::vector<nvinfer1::Dims>& rhs) {
+  for (int k = 0; k < values.size(); k++) {
+    const std::vector<nvinfer1::Dims>& lhs = values[k];
     bool ret = lhs.size() == rhs.size();
     for (int i = 0; ret && i < lhs.size(); i++) {
       ret &= lhs[i].nbDims == rhs[i].nbDims;
@@ -251,26 +429,27 @@ bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
         ret &= (lhs[i].d[j] == rhs[i].d[j]);
       }
     }
-    if (ret) return true;
+    if (ret) return k;
   }
-  return false;
+  return -1;
 }
 
-void TrtShapeOptimizationProfile::InitProfiles(
+Status TrtShapeOptimizationProfile::InitProfiles(
     const std::vector<PartialTensorShape>& input_partial_shapes,
-    ProfileStrategy strategy) {
+    ProfileStrategy strategy, int max_num_profiles) {
   strategy_ = strategy;
   if (input_shapes_.size() == 0) {
     VLOG(1) << "Not creating profiles without input_shapes. "
                "You have to enable profile generation mode first (build).";
-    return;
+    return OkStatus();
   }
   // Preprocess the vector of input shapes and shape values:
   // - Converts TensorShape -> nvinfer::Dims.
   // - Concatenates the shape values after the input shapes:
   //   dimvec = [dim0, dim1,..., shapeval0, shapval1, ...]
-  // - Ensures that the list is unique.
+  // - Ensures that the list is unique, summing up the occurrences.
   std::vector<std::vector<nvinfer1::Dims>> collected_shapes;
+  std::vector<int64_t> collected_counts;
   for (int i = 0; i < input_shapes_.size(); i++) {
     auto shape_vec = input_shapes_[i];
     VLOG(2) << "Initprofiles, processing shape " << i;
@@ -287,8 +466,12 @@ void TrtShapeOptimizationProfile::InitProfiles(
       // that case consicutive elements in collected_shapes contain the user
       // defined values of min, opt and max, and it is valid the have min = opt
       // and opt = max.
-      if (!AlreadyCollected(collected_shapes, dimvec)) {
+      int index = CollectedIndex(collected_shapes, dimvec);
+      if (index < 0) {
         collected_shapes.push_back(dimvec);
+        collected_counts.push_back(input_shape_counts_[i]);
+      } else {
+        collected_counts[index] += input_shape_counts_[i];
       }
     }
   }
@@ -301,17 +484,29 @@ void TrtShapeOptimizationProfile::InitProfiles(
     // those is outlined in the dynamic shape support implementation plan.
     case ProfileStrategy::kRange:
       VLOG(1) << "Creating profiles with Range strategy";
-      TF_CHECK_OK(RangeStrategy(collected_shapes));
+      TF_RETURN_IF_ERROR(RangeStrategy(collected_shapes));
       break;
     case ProfileStrategy::kRangeOptimal:
       VLOG(1) << "Creating profiles with RangeOptimal strategy";
       OptimalStrategy(collected_shapes);
-      TF_CHECK_OK(RangeStrategy(collected_shapes));
+      TF_RETURN_IF_ERROR(RangeStrategy(collected_shapes));
       break;
     case ProfileStrategy::kOptimal:
       VLOG(1) << "Creating profiles with Optimal strategy";
       OptimalStrategy(collected_shapes);
       break;
+    case ProfileStrategy::kClustered:
+      VLOG(1) << "Creating at most " << max_num_profiles
+              << " profiles with Clustered strategy";
+      if (Status s = ClusteredStrategy(collected_shapes, collected_counts,
+                                       max_num_profiles);
+          !s.ok()) {
+        LOG_WARNING_WITH_PREFIX << "Falling back to the Range strategy, since "
+                                   "the input shapes cannot be clustered: "
+                                << s;
+        TF_RETURN_IF_ERROR(RangeStrategy(collected_shapes));
+      }
+      break;
   }
   // Define a mask that describe which input could be a shape tensor. Note
   // that here we can have false positives. The shape tensor mask will be
@@ -331,6 +526,7 @@ void TrtShapeOptimizationProfile::InitProfiles(
       }
     }
   }
+  return OkStatus();
 }
 
 void TrtShapeOptimizationProfile::InitCalibProfile(
@@ -21,6 +21,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/tf2tensorrt/common/datavec.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/trt_parameters.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
@@ -204,14 +205,19 @@ struct OptimizationProfileConfig {
 // before the engine is created.
 class TrtShapeOptimizationProfile {
  public:
+  // The maximum number of distinct input shapes that are collected.
+  static constexpr int kMaxCollectedShapes = 1024;
+
+  // The default maximum number of profiles of the kClustered strategy.
+  static constexpr int kDefaultMaxNumClusteredProfiles = 4;
+
   TrtShapeOptimizationProfile() {}
 
-  // Stores input shape information during profile_generation_mode.
-  void AddShape(const std::vector<TensorShape>& shapes) {
-    input_shapes_.push_back(shapes);
-    input_shape_values_.push_back(actual_shape_values_);
-    VLOG(1) << "Collected shape(s) " << DebugString(shapes) << " for profiles.";
-  }
+  // Stores input shape information during profile_generation_mode, or during
+  // inference to rebuild the profiles from the observed traffic. Shapes that
+  // were already collected only increment their number of occurrences, and
+  // new shapes are dropped once kMaxCollectedShapes are collected.
+  void AddShape(const std::vector<TensorShape>& shapes);
 
   // Stores the input mask.
   void SetInputMask(const std::vector<bool>& input_mask) {
@@ -248,9 +254,16 @@ class TrtShapeOptimizationProfile {
   // Creates optimization profiles profiles_ for the set of concrete input
   // shapes collected in input_shapes_. The input_partial_shapes of the network
   // is used to ensure that the created optimization profiles are compatible
-  // with the network.
-  void InitProfiles(const std::vector<PartialTensorShape>& input_partial_shapes,
-                    ProfileStrategy strategy);
+  // with the network. max_num_profiles is only used by the kClustered
+  // strategy, which falls back to kRange if the shapes cannot be clustered.
+  Status InitProfiles(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      ProfileStrategy strategy,
+      int max_num_profiles = kDefaultMaxNumClusteredProfiles);
+
+  // Replaces the optimization profiles with those of other, e.g. once an
+  // engine is built for them, but keeps the shapes collected by this object.
+  void ReplaceProfiles(TrtShapeOptimizationProfile&& other);
 
   void InitCalibProfile(const std::vector<TensorShape>& shapes);
 
@@ -290,6 +303,13 @@ class TrtShapeOptimizationProfile {
   // stored.
   std::vector<std::vector<nvinfer1::Dims>> input_shape_values_;
 
+  // The number of times each element of input_shapes_ was collected.
+  std::vector<int64_t> input_shape_counts_;
+
+  // The indices in input_shapes_ of the collected shapes and shape values,
+  // keyed by their debug string.
+  absl::flat_hash_map<string, int> input_shape_indices_;
+
   // Shape values present in the current inference call.
   std::vector<nvinfer1::Dims> actual_shape_values_;
 
@@ -342,6 +362,9 @@ class TrtShapeOptimizationProfile {
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
   Status RangeStrategy(
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
+  Status ClusteredStrategy(
+      const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+      const std::vector<int64_t>& collected_counts, int max_num_profiles);
 };
 
 }  // namespace tensorrt
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string.h>
 
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -152,7 +153,8 @@ INSTANTIATE_TEST_CASE_P(
     OptProfilesTestInstantiation, TrtShapeOptimizationProfileTest,
     ::testing::Values(ProfileStrategy::kRange, ProfileStrategy::kOptimal,
                       ProfileStrategy::kRangeOptimal,
-                      ProfileStrategy::kImplicitBatchModeCompatible));
+                      ProfileStrategy::kImplicitBatchModeCompatible,
+                      ProfileStrategy::kClustered));
 
 TEST_P(TrtShapeOptimizationProfileTest, Static) {
   // Static mode does not depend on strategies, we test only once.
@@ -208,7 +210,7 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   }
   std::vector<PartialTensorShape> input_partial_shapes;
   TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
-  profile.InitProfiles(input_partial_shapes, strategy_);
+  TF_CHECK_OK(profile.InitProfiles(input_partial_shapes, strategy_));
 
   // Configure and build engine.
   TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
@@ -223,6 +225,9 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   switch (strategy_) {
     case (ProfileStrategy::kImplicitBatchModeCompatible):
     case (ProfileStrategy::kOptimal):
+    // There are fewer shapes than the default maximum number of clustered
+    // profiles.
+    case (ProfileStrategy::kClustered):
       n_profiles_exp = input_profiles.size();
       break;
     case (ProfileStrategy::kRange):
@@ -242,7 +247,8 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   // Check if the profiles are assigned correctly.
   for (auto dimvec : input_profiles) {
     bool test_optimal_prof = strategy_ == ProfileStrategy::kOptimal ||
-                             strategy_ == ProfileStrategy::kRangeOptimal;
+                             strategy_ == ProfileStrategy::kRangeOptimal ||
+                             strategy_ == ProfileStrategy::kClustered;
     CheckProfile(dimvec, &profile, true, test_optimal_prof);
   }
   bool has_prof = (strategy_ == ProfileStrategy::kRange ||
@@ -250,6 +256,71 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, ClusteredByFrequency) {
+  if (strategy_ != ProfileStrategy::kClustered) return;
+
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  std::vector<bool> input_mask(2, true);
+  profile.SetInputMask(input_mask);
+
+  // Pairs of input shapes with the number of times they are seen.
+  std::vector<std::pair<std::vector<nvinfer1::Dims3>, int>> input_shapes{
+      {{nvinfer1::Dims3(2, 2, 10), nvinfer1::Dims3(2, 2, 10)}, 5},
+      {{nvinfer1::Dims3(3, 3, 10), nvinfer1::Dims3(3, 3, 10)}, 1},
+      {{nvinfer1::Dims3(16, 16, 10), nvinfer1::Dims3(16, 16, 10)}, 3},
+      {{nvinfer1::Dims3(15, 15, 10), nvinfer1::Dims3(15, 15, 10)}, 1},
+  };
+  for (const auto& input_shape : input_shapes) {
+    std::vector<TensorShape> shape_vec =
+        DimVecToShapeVec(input_shape.first, true);
+    for (int i = 0; i < input_shape.second; i++) {
+      profile.AddShape(shape_vec);
+    }
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  TF_CHECK_OK(profile.InitProfiles(input_partial_shapes, strategy_,
+                                   /*max_num_profiles=*/2));
+
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+
+  // The small and the large shapes are clustered, each profile being optimal
+  // for its most frequent shape.
+  EXPECT_EQ(exec_contexts_.size(), 2);
+  CheckProfile(input_shapes[0].first, &profile, true, true);
+  CheckProfile(input_shapes[1].first, &profile, true, false);
+  CheckProfile(input_shapes[2].first, &profile, true, true);
+  CheckProfile(input_shapes[3].first, &profile, true, false);
+  CheckProfile({nvinfer1::Dims3(9, 9, 10), nvinfer1::Dims3(9, 9, 10)},
+               &profile, false, false);
+}
+
+TEST_P(TrtShapeOptimizationProfileTest, ShapesOfDifferentRanks) {
+  if (strategy_ != ProfileStrategy::kClustered &&
+      strategy_ != ProfileStrategy::kRange) {
+    return;
+  }
+  TrtShapeOptimizationProfile profile;
+  profile.SetInputMask({true});
+  profile.AddShape({TensorShape({2, 2})});
+  profile.AddShape({TensorShape({2, 2})});
+  profile.AddShape({TensorShape({3, 3, 3})});
+
+  // Neither the cluster nor the range of the shapes can be computed, which
+  // is an error instead of a crash.
+  EXPECT_TRUE(errors::IsInvalidArgument(profile.InitProfiles(
+      {PartialTensorShape()}, strategy_, /*max_num_profiles=*/1)));
+  EXPECT_EQ(profile.GetNumProfiles(), 0);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tf2xla/mlir_bridge_rollout_policy.h"
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -194,8 +195,9 @@ Status BuildComputation(
     const XlaShapeLayoutHelpers::ShapeDeterminationFns& shape_determination_fns,
     bool is_entry_computation, bool return_updated_values_for_all_resources,
     bool always_return_tuple, bool use_tuple_arg, bool alias_resource_update,
-    xla::XlaBuilder* builder, xla::XlaComputation* computation,
-    int* num_computation_outputs, int* num_nonconst_outputs,
+    bool alias_donatable_arguments, xla::XlaBuilder* builder,
+    xla::XlaComputation* computation, int* num_computation_outputs,
+    int* num_nonconst_outputs,
     std::vector<XlaCompiler::OutputDescription>* outputs,
     std::vector<XlaCompiler::ResourceUpdate>* resource_updates,
     xla::Shape* output_shape, absl::Span<int const> input_mapping) {
@@ -420,6 +422,41 @@ Status BuildComputation(
     xla::XlaScopedShardingAssignment assign_sharding(builder, op_sharding);
     tuple = xla::Tuple(builder, elems);
   }
+
+  if (is_entry_computation && alias_donatable_arguments && !use_tuple_arg) {
+    TF_ASSIGN_OR_RETURN(xla::ProgramShape program_shape,
+                        builder->GetProgramShape());
+    absl::flat_hash_set<int64_t> aliased_params;
+    absl::flat_hash_set<int64_t> aliased_outputs;
+    for (const xla::XlaBuilder::InputOutputAlias& alias : aliases) {
+      aliased_params.insert(alias.param_number);
+      aliased_outputs.insert(alias.output_index[0]);
+    }
+    for (int64_t output = 0; output < *num_nonconst_outputs; ++output) {
+      const xla::Shape& output_shape =
+          program_shape.result().tuple_shapes(output);
+      if (aliased_outputs.contains(output) || !output_shape.IsArray() ||
+          output_shape.is_dynamic()) {
+        continue;
+      }
+      for (int xla_arg = 0; xla_arg < input_mapping.size(); ++xla_arg) {
+        if (args[input_mapping[xla_arg]].kind ==
+                XlaCompiler::Argument::kParameter &&
+            !aliased_params.contains(xla_arg) &&
+            xla::ShapeUtil::Equal(program_shape.parameters(xla_arg),
+                                  output_shape)) {
+          VLOG(3) << "Storing donatable alias: {" << output << "}: ("
+                  << xla_arg << ", {})";
+          aliases.push_back({xla::ShapeIndex({output}), xla_arg,
+                             xla::ShapeIndex{},
+                             xla::HloInputOutputAliasConfig::kMayAlias});
+          aliased_params.insert(xla_arg);
+          break;
+        }
+      }
+    }
+  }
+
   bool returns_tuple = always_return_tuple || elems.size() != 1;
   VLOG(3) << "Computation returns a tuple=" << returns_tuple;
   if (!returns_tuple) {
@@ -1596,7 +1633,8 @@ Status XlaCompiler::CompileGraph(const XlaCompiler::CompileOptions& options,
       options.is_entry_computation,
       options.return_updated_values_for_all_resources,
       options.always_return_tuple, options.use_tuple_arg,
-      options.alias_resource_update, builder.get(), result->computation.get(),
+      options.alias_resource_update, options.alias_donatable_arguments,
+      builder.get(), result->computation.get(),
       &num_computation_outputs, &num_nonconst_outputs, &result->outputs,
       &result->resource_updates, &result->xla_output_shape,
       result->input_mapping));
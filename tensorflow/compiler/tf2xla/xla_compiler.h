@@ -134,6 +134,11 @@ class XlaCompiler {
     // Resource updates are converted into input / output of xla. The two
     // buffers are aliased with other if this option is true.
     bool alias_resource_update = false;
+
+    // If true, each output of the computation may be aliased with a
+    // parameter argument of the same shape, so that the executable writes the
+    // output in place when the caller donates the buffer of the argument.
+    bool alias_donatable_arguments = false;
   };
 
   using OutputDescription = ::tensorflow::XlaOutputDescription;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/all_to_all.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -40,23 +41,39 @@ limitations under the License.
 namespace tensorflow {
 
 AllToAll::AllToAll()
-    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr), counter_(0) {}
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      done_(nullptr),
+      counter_(0),
+      next_step_(0) {}
 
-StatusCallback AllToAll::CheckCounterAndCallDone() {
-  return [this](const Status& s) {
+StatusCallback AllToAll::CheckCounterAndCallDone(int step) {
+  return [this, step](const Status& s) {
     Status final_status;
+    int step_to_start = -1;
+    bool all_done = false;
     {
       mutex_lock l(mu_);
       status_.Update(s);
       ++counter_;
+      // The remaining steps are started even after an error, so that the
+      // peers waiting for them are not stuck.
+      if (++step_counters_[step] == 2 &&
+          next_step_ < col_params_->group.group_size) {
+        step_to_start = next_step_++;
+      }
       // For all devices other than itself, there's a send and a receive. We
       // wait until all of them complete.
-      if (counter_ < 2 * col_params_->group.group_size) {
-        return;
-      }
       CHECK_LE(counter_, 2 * col_params_->group.group_size);  // Crash ok.
+      all_done = counter_ == 2 * col_params_->group.group_size;
       final_status = status_;
     }
+    if (step_to_start >= 0) {
+      StartStep(step_to_start);
+    }
+    if (!all_done) {
+      return;
+    }
     if (!final_status.ok()) {
       done_(final_status);
       return;
@@ -110,16 +127,30 @@ void AllToAll::Run(StatusCallback done) {
     output_chunks_.push_back(output_buffer_.SubSlice(output_index));
   }
 
-  for (int i = 0; i < col_params_->group.group_size; ++i) {
-    auto default_rank = col_params_->default_rank;
-    // Issue send request from current device to all devices in group.
-    DispatchSend(default_rank, i, &input_chunks_[i], CheckCounterAndCallDone());
-    // Issue receive requests from all devices to current device.
-    DispatchRecv(i, default_rank, &output_chunks_[i],
-                 CheckCounterAndCallDone());
+  const int group_size = col_params_->group.group_size;
+  int num_steps_to_start;
+  {
+    mutex_lock l(mu_);
+    step_counters_.assign(group_size, 0);
+    next_step_ = std::min(group_size, kMaxPendingSteps);
+    num_steps_to_start = next_step_;
+  }
+  for (int step = 0; step < num_steps_to_start; ++step) {
+    StartStep(step);
   }
 }
 
+void AllToAll::StartStep(int step) {
+  const int group_size = col_params_->group.group_size;
+  const int default_rank = col_params_->default_rank;
+  const int target_rank = (default_rank + step) % group_size;
+  const int src_rank = (default_rank - step + group_size) % group_size;
+  DispatchSend(default_rank, target_rank, &input_chunks_[target_rank],
+               CheckCounterAndCallDone(step));
+  DispatchRecv(src_rank, default_rank, &output_chunks_[src_rank],
+               CheckCounterAndCallDone(step));
+}
+
 void AllToAll::DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
                             const StatusCallback& done) {
   string send_buf_key =
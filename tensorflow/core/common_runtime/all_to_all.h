@@ -27,6 +27,13 @@ limitations under the License.
 namespace tensorflow {
 
 // Implementation of collective all-to-all.
+//
+// The exchanges are scheduled pairwise: in step s, each rank r sends its
+// chunk to rank r + s and receives the chunk of rank r - s (modulo the group
+// size), and at most kMaxPendingSteps steps are in flight. Every rank thus
+// sends to and receives from a single peer per step instead of all of them at
+// once, which avoids incast at scale. Since default ranks are ordered by task,
+// the first steps mostly exchange with the devices of the same task.
 class AllToAll : public CollectiveImplementationInterface {
  public:
   AllToAll();
@@ -43,6 +50,8 @@ class AllToAll : public CollectiveImplementationInterface {
       std::shared_ptr<CollectiveContext> col_ctx) override;
 
  private:
+  static constexpr int kMaxPendingSteps = 8;
+
   std::shared_ptr<CollectiveContext> col_ctx_;
   const CollectiveParams* col_params_;  // Not owned
   std::vector<Tensor> input_chunks_;
@@ -52,6 +61,10 @@ class AllToAll : public CollectiveImplementationInterface {
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
   int counter_ TF_GUARDED_BY(mu_);
+  // The next step to start, and the number of finished sends and receives of
+  // each step.
+  int next_step_ TF_GUARDED_BY(mu_);
+  std::vector<int> step_counters_ TF_GUARDED_BY(mu_);
 
   void DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
                     const StatusCallback& done);
@@ -59,10 +72,14 @@ class AllToAll : public CollectiveImplementationInterface {
   void DispatchRecv(int src_rank, int target_rank, Tensor* tensor,
                     const StatusCallback& done);
 
+  // Starts the send and the receive of `step`.
+  void StartStep(int step);
+
   // Atomically increments counter_ by one for sending, one for receiving.
-  // Invokes done when counter_ reaches 2.
+  // Starts the next step once both of `step` are done, and invokes done when
+  // counter_ reaches 2 * group_size.
   // The purpose of checking counter_ is to ensure that done_ is called once.
-  StatusCallback CheckCounterAndCallDone();
+  StatusCallback CheckCounterAndCallDone(int step);
 };
 
 }  // namespace tensorflow
@@ -95,6 +95,41 @@ TEST_F(AllToAllTest, SuccessDifferentRank) {
                                   test::AsTensor<double>({9., 6., 3.}));
 }
 
+TEST_F(AllToAllTest, MoreDevicesThanPendingSteps) {
+  const int group_size = 11;
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                      /*num_devices_per_worker*/ group_size,
+                                      DEVICE_CPU);
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < group_size; ++i) {
+    Tensor t(DT_DOUBLE, TensorShape({group_size}));
+    for (int j = 0; j < group_size; ++j) {
+      t.flat<double>()(j) = i * group_size + j;
+    }
+    tensors.push_back(t);
+  }
+  BlockingCounter counter(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    SchedClosure([this, &tensors, i, &counter]() {
+      auto col_params = CreateCollectiveParams(*test_env_, i, "AllToAll",
+                                               ALL_TO_ALL_COLLECTIVE, DT_DOUBLE,
+                                               tensors[i].shape());
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          col_params->group.members[i].device.name(), &device));
+      TF_CHECK_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                &tensors[i], &tensors[i]));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (int i = 0; i < group_size; ++i) {
+    for (int j = 0; j < group_size; ++j) {
+      EXPECT_EQ(j * group_size + i, tensors[i].flat<double>()(j));
+    }
+  }
+}
+
 TEST_F(AllToAllTest, Failure) {
   test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
                                       /*num_devices_per_worker*/ 3, DEVICE_CPU);
@@ -0,0 +1,209 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/constant_fold_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// The memory charged for an entry on top of its tensor, so that the entries
+// which only keep the size of their tensor are also evicted.
+constexpr int64_t kEntryOverheadBytes = 64;
+
+}  // namespace
+
+ConstantFoldCache::ConstantFoldCache(int64_t capacity_bytes,
+                                     const string& cache_dir, Env* env)
+    : capacity_bytes_(capacity_bytes), cache_dir_(cache_dir), env_(env) {}
+
+ConstantFoldCache* ConstantFoldCache::Global() {
+  static ConstantFoldCache* const cache = []() -> ConstantFoldCache* {
+    int64_t capacity_mb;
+    Status s =
+        ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_MB", 0, &capacity_mb);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      capacity_mb = 0;
+    }
+    string cache_dir;
+    s = ReadStringFromEnvVar("TF_CONSTANT_FOLDING_CACHE_DIR", "", &cache_dir);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      cache_dir.clear();
+    }
+    if (capacity_mb <= 0 && cache_dir.empty()) {
+      return nullptr;
+    }
+    Env* env = Env::Default();
+    if (!cache_dir.empty()) {
+      s = env->RecursivelyCreateDir(cache_dir);
+      if (!s.ok() && !errors::IsAlreadyExists(s)) {
+        LOG(ERROR) << "Cannot create the constant folding cache directory "
+                   << cache_dir << ": " << s;
+        cache_dir.clear();
+      }
+    }
+    VLOG(1) << "Constant folding cache: " << capacity_mb << " MB in memory"
+            << (cache_dir.empty() ? "" : ", persisted in ") << cache_dir;
+    return new ConstantFoldCache(std::max<int64_t>(capacity_mb, 0) << 20,
+                                 cache_dir, env);
+  }();
+  return cache;
+}
+
+bool ConstantFoldCache::Lookup(uint64 key, Tensor* value,
+                               int64_t* total_bytes) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      Entry& entry = it->second;
+      lru_.splice(lru_.begin(), lru_, entry.lru_position);
+      if (entry.has_value) {
+        *value = entry.value;
+      }
+      *total_bytes = entry.total_bytes;
+      ++num_hits_;
+      return true;
+    }
+  }
+
+  Tensor persisted;
+  if (cache_dir_.empty() || !ReadFromDisk(key, &persisted)) {
+    mutex_lock l(mu_);
+    ++num_misses_;
+    return false;
+  }
+  *value = persisted;
+  *total_bytes = persisted.TotalBytes();
+  mutex_lock l(mu_);
+  ++num_hits_;
+  if (!entries_.contains(key)) {
+    InsertLocked(key, persisted, persisted.TotalBytes());
+  }
+  return true;
+}
+
+void ConstantFoldCache::Insert(uint64 key, const Tensor& value,
+                               int64_t max_value_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (entries_.contains(key)) {
+      return;
+    }
+    InsertLocked(key, value, max_value_bytes);
+  }
+  if (!cache_dir_.empty() && value.TotalBytes() <= max_value_bytes) {
+    WriteToDisk(key, value);
+  }
+}
+
+void ConstantFoldCache::InsertLocked(uint64 key, const Tensor& value,
+                                     int64_t max_value_bytes) {
+  Entry& entry = entries_[key];
+  entry.total_bytes = value.TotalBytes();
+  entry.has_value = entry.total_bytes <= max_value_bytes;
+  if (entry.has_value) {
+    entry.value = value;
+    size_bytes_ += entry.total_bytes;
+  }
+  size_bytes_ += kEntryOverheadBytes;
+  lru_.push_front(key);
+  entry.lru_position = lru_.begin();
+  EvictLocked();
+}
+
+void ConstantFoldCache::EvictLocked() {
+  while (size_bytes_ > capacity_bytes_ && !lru_.empty()) {
+    auto it = entries_.find(lru_.back());
+    DCHECK(it != entries_.end());
+    size_bytes_ -= kEntryOverheadBytes;
+    if (it->second.has_value) {
+      size_bytes_ -= it->second.total_bytes;
+    }
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+}
+
+string ConstantFoldCache::Filename(uint64 key) const {
+  return io::JoinPath(
+      cache_dir_,
+      strings::Printf("%016llx.tensor", static_cast<unsigned long long>(key)));
+}
+
+bool ConstantFoldCache::ReadFromDisk(uint64 key, Tensor* value) const {
+  const string filename = Filename(key);
+  if (!env_->FileExists(filename).ok()) {
+    return false;
+  }
+  TensorProto proto;
+  Status s = ReadBinaryProto(env_, filename, &proto);
+  if (!s.ok() || !value->FromProto(proto)) {
+    VLOG(1) << "Cannot read the constant folding cache file " << filename
+            << ": " << s;
+    return false;
+  }
+  return true;
+}
+
+void ConstantFoldCache::WriteToDisk(uint64 key, const Tensor& value) const {
+  TensorProto proto;
+  value.AsProtoTensorContent(&proto);
+  const string filename = Filename(key);
+  // Writes to a temporary file first, so that concurrent readers, e.g. of
+  // other processes, never read a partial file.
+  const string tmp_filename =
+      strings::Printf("%s.%016llx.tmp", filename.c_str(),
+                      static_cast<unsigned long long>(random::New64()));
+  Status s = WriteBinaryProto(env_, tmp_filename, proto);
+  if (s.ok()) {
+    s = env_->RenameFile(tmp_filename, filename);
+  }
+  if (!s.ok()) {
+    VLOG(1) << "Cannot write the constant folding cache file " << filename
+            << ": " << s;
+    env_->DeleteFile(tmp_filename).IgnoreError();
+  }
+}
+
+int64_t ConstantFoldCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t ConstantFoldCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+int64_t ConstantFoldCache::size_bytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLD_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLD_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of the tensors computed by constant folding, keyed by a fingerprint
+// of the subgraph computing each tensor (see `ConstantFold`), so that loading
+// the same model or instantiating the same function again does not evaluate
+// its constant subgraphs again. Thread-safe.
+//
+// The tensors are kept in memory up to `capacity_bytes`, evicting the least
+// recently used ones, and also written to `cache_dir` if it is not empty, in
+// which case the cache outlives the process.
+class ConstantFoldCache {
+ public:
+  ConstantFoldCache(int64_t capacity_bytes, const string& cache_dir, Env* env);
+
+  ConstantFoldCache(const ConstantFoldCache&) = delete;
+  ConstantFoldCache& operator=(const ConstantFoldCache&) = delete;
+
+  // Returns the process-wide cache, or nullptr if disabled. The cache is
+  // configured by the TF_CONSTANT_FOLDING_CACHE_MB and
+  // TF_CONSTANT_FOLDING_CACHE_DIR environment variables, and is disabled if
+  // neither is set.
+  static ConstantFoldCache* Global();
+
+  // Returns false if there is no tensor for `key`. Otherwise sets
+  // `total_bytes` to the size of the tensor, and `value` to the tensor unless
+  // it was too large for the cache to keep it (see `Insert`).
+  bool Lookup(uint64 key, Tensor* value, int64_t* total_bytes);
+
+  // Inserts the tensor of `key`. Only the size of the tensor is kept if it is
+  // larger than `max_value_bytes`, since constant folding then discards it
+  // anyway.
+  void Insert(uint64 key, const Tensor& value, int64_t max_value_bytes);
+
+  int64_t num_hits() const;
+  int64_t num_misses() const;
+  int64_t size_bytes() const;
+
+ private:
+  struct Entry {
+    Tensor value;
+    int64_t total_bytes = 0;
+    bool has_value = false;
+    std::list<uint64>::iterator lru_position;
+  };
+
+  // Returns the file persisting the tensor of `key`.
+  string Filename(uint64 key) const;
+
+  // Reads the tensor of `key` from `cache_dir_`, returning false on failure.
+  bool ReadFromDisk(uint64 key, Tensor* value) const;
+  void WriteToDisk(uint64 key, const Tensor& value) const;
+
+  void InsertLocked(uint64 key, const Tensor& value, int64_t max_value_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void EvictLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_bytes_;
+  const string cache_dir_;
+  Env* const env_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  // The keys of `entries_`, most recently used first.
+  std::list<uint64> lru_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLD_CACHE_H_
@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/constant_fold_cache.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ConstantFoldCacheTest, LookupAndInsert) {
+  ConstantFoldCache cache(/*capacity_bytes=*/1 << 20, /*cache_dir=*/"",
+                          Env::Default());
+  Tensor value;
+  int64_t total_bytes;
+  EXPECT_FALSE(cache.Lookup(1, &value, &total_bytes));
+
+  cache.Insert(1, test::AsTensor<float>({1, 2, 3}), /*max_value_bytes=*/1024);
+  ASSERT_TRUE(cache.Lookup(1, &value, &total_bytes));
+  test::ExpectTensorEqual<float>(value, test::AsTensor<float>({1, 2, 3}));
+  EXPECT_EQ(total_bytes, 12);
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 1);
+}
+
+TEST(ConstantFoldCacheTest, OnlyKeepsSizeOfLargeTensors) {
+  ConstantFoldCache cache(/*capacity_bytes=*/1 << 20, /*cache_dir=*/"",
+                          Env::Default());
+  cache.Insert(1, test::AsTensor<float>({1, 2, 3}), /*max_value_bytes=*/8);
+  Tensor value;
+  int64_t total_bytes;
+  ASSERT_TRUE(cache.Lookup(1, &value, &total_bytes));
+  EXPECT_FALSE(value.IsInitialized());
+  EXPECT_EQ(total_bytes, 12);
+}
+
+TEST(ConstantFoldCacheTest, EvictsLeastRecentlyUsed) {
+  // Holds two tensors of 1 KB, with the overhead of their entries.
+  ConstantFoldCache cache(/*capacity_bytes=*/2 * 1024 + 512, /*cache_dir=*/"",
+                          Env::Default());
+  Tensor value(DT_FLOAT, TensorShape({256}));
+  cache.Insert(1, value, /*max_value_bytes=*/1 << 20);
+  cache.Insert(2, value, /*max_value_bytes=*/1 << 20);
+  Tensor found;
+  int64_t total_bytes;
+  EXPECT_TRUE(cache.Lookup(1, &found, &total_bytes));
+  cache.Insert(3, value, /*max_value_bytes=*/1 << 20);
+
+  EXPECT_TRUE(cache.Lookup(1, &found, &total_bytes));
+  EXPECT_FALSE(cache.Lookup(2, &found, &total_bytes));
+  EXPECT_TRUE(cache.Lookup(3, &found, &total_bytes));
+  EXPECT_LE(cache.size_bytes(), 2 * 1024 + 512);
+}
+
+TEST(ConstantFoldCacheTest, PersistsOnDisk) {
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "constant_fold_cache_test");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(cache_dir));
+  {
+    ConstantFoldCache cache(/*capacity_bytes=*/0, cache_dir, Env::Default());
+    cache.Insert(42, test::AsTensor<int32>({4, 2}), /*max_value_bytes=*/1024);
+  }
+  // A new cache, e.g. of another process, finds the tensor.
+  ConstantFoldCache cache(/*capacity_bytes=*/1 << 20, cache_dir,
+                          Env::Default());
+  Tensor value;
+  int64_t total_bytes;
+  ASSERT_TRUE(cache.Lookup(42, &value, &total_bytes));
+  test::ExpectTensorEqual<int32>(value, test::AsTensor<int32>({4, 2}));
+  EXPECT_FALSE(cache.Lookup(43, &value, &total_bytes));
+}
+
+}  // namespace
+}  // namespace tensorflow
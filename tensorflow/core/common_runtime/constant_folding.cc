@@ -17,20 +17,26 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/constant_fold_cache.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -39,10 +45,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
@@ -613,6 +623,157 @@ bool ReplaceTensorWithConstant(
   return true;
 }
 
+// Returns a fingerprint of the subgraph of "constant_graph" computing each
+// tensor of "tensors", which depends on the ops, attributes and data inputs of
+// its nodes, but not on their names. Sets "cacheable" to false for the tensors
+// whose value may not only depend on their subgraph, e.g. because it calls a
+// function.
+void FingerprintConstantTensors(const Graph& constant_graph,
+                                const std::vector<NodeAndOutput>& tensors,
+                                std::vector<uint64>* fingerprints,
+                                std::vector<bool>* cacheable) {
+  // Kernels may change between versions, and the fingerprints may be
+  // persisted.
+  static const uint64 kSalt = Hash64(TF_VERSION_STRING);
+  std::vector<uint64> node_fingerprints(constant_graph.num_node_ids(), kSalt);
+  std::vector<bool> node_cacheable(constant_graph.num_node_ids(), true);
+  std::vector<Node*> order;
+  GetReversePostOrder(constant_graph, &order);
+  for (Node* n : order) {
+    if (!n->IsOp()) continue;
+    bool is_cacheable = !n->IsFunctionCall();
+    uint64 fingerprint = Hash64Combine(kSalt, Hash64(n->type_string()));
+    std::vector<std::pair<string, const AttrValue*>> attrs;
+    for (const auto& attr : n->attrs()) {
+      attrs.emplace_back(attr.first, &attr.second);
+    }
+    std::sort(attrs.begin(), attrs.end());
+    for (const auto& attr : attrs) {
+      if (attr.second->has_func() ||
+          (attr.second->has_list() && attr.second->list().func_size() > 0)) {
+        is_cacheable = false;
+      }
+      fingerprint = Hash64Combine(fingerprint, Hash64(attr.first));
+      fingerprint = Hash64Combine(fingerprint, AttrValueHash(*attr.second));
+    }
+    std::vector<const Edge*> inputs;
+    if (!n->input_edges(&inputs).ok()) {
+      is_cacheable = false;
+    }
+    // Control edges do not change the values, and are ignored.
+    for (const Edge* e : inputs) {
+      fingerprint = Hash64Combine(
+          fingerprint, Hash64Combine(node_fingerprints[e->src()->id()],
+                                     e->src_output()));
+      is_cacheable = is_cacheable && node_cacheable[e->src()->id()];
+    }
+    node_fingerprints[n->id()] = fingerprint;
+    node_cacheable[n->id()] = is_cacheable;
+  }
+
+  fingerprints->clear();
+  cacheable->clear();
+  for (const NodeAndOutput& tensor : tensors) {
+    fingerprints->push_back(Hash64Combine(
+        node_fingerprints[tensor.first->id()], tensor.second));
+    cacheable->push_back(node_cacheable[tensor.first->id()]);
+  }
+}
+
+// Splits "tensors" into at most "max_groups" groups which depend on disjoint
+// subgraphs of "constant_graph", balancing the number of nodes of the
+// groups. Returns the indices in "tensors" of the tensors of each group.
+std::vector<std::vector<int>> GroupIndependentTensors(
+    const Graph& constant_graph, const std::vector<NodeAndOutput>& tensors,
+    const std::vector<int>& indices, int max_groups) {
+  if (max_groups <= 1) {
+    return {indices};
+  }
+  // Finds the weakly connected components of the graph.
+  std::vector<int> parent(constant_graph.num_node_ids());
+  for (int i = 0; i < parent.size(); ++i) parent[i] = i;
+  auto find = [&parent](int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (const Edge* e : constant_graph.edges()) {
+    if (!e->src()->IsOp() || !e->dst()->IsOp()) continue;
+    parent[find(e->src()->id())] = find(e->dst()->id());
+  }
+  std::unordered_map<int, int> component_sizes;
+  for (const Node* n : constant_graph.op_nodes()) {
+    ++component_sizes[find(n->id())];
+  }
+
+  std::map<int, std::vector<int>> components;
+  for (int index : indices) {
+    components[find(tensors[index].first->id())].push_back(index);
+  }
+  // Assigns the largest components first, each to the smallest group.
+  std::vector<std::pair<int, int>> sizes_and_components;
+  for (const auto& component : components) {
+    sizes_and_components.emplace_back(component_sizes[component.first],
+                                      component.first);
+  }
+  std::sort(sizes_and_components.rbegin(), sizes_and_components.rend());
+  const int num_groups =
+      std::min<int>(max_groups, sizes_and_components.size());
+  std::vector<std::vector<int>> groups(num_groups);
+  std::vector<int64_t> group_sizes(num_groups, 0);
+  for (const auto& size_and_component : sizes_and_components) {
+    const int group =
+        std::min_element(group_sizes.begin(), group_sizes.end()) -
+        group_sizes.begin();
+    group_sizes[group] += size_and_component.first;
+    const std::vector<int>& component = components[size_and_component.second];
+    groups[group].insert(groups[group].end(), component.begin(),
+                         component.end());
+  }
+  for (std::vector<int>& group : groups) {
+    std::sort(group.begin(), group.end());
+  }
+  return groups;
+}
+
+// Runs "fn" for each index in [0, n) on the calling thread and on "runner".
+// Does not wait for the closures passed to "runner" to start, so that it does
+// not deadlock if the calling thread is one of the threads of "runner".
+void RunInParallel(int n, std::function<void(std::function<void()>)>* runner,
+                 std::function<void(int)> fn) {
+  struct State {
+    std::function<void(int)> fn;
+    int n = 0;
+    std::atomic<int> next{0};
+    mutex mu;
+    condition_variable cv;
+    int num_done TF_GUARDED_BY(mu) = 0;
+  };
+  auto state = std::make_shared<State>();
+  state->fn = std::move(fn);
+  state->n = n;
+  auto work = [state]() {
+    for (int i = state->next.fetch_add(1); i < state->n;
+         i = state->next.fetch_add(1)) {
+      state->fn(i);
+      mutex_lock l(state->mu);
+      if (++state->num_done == state->n) {
+        state->cv.notify_all();
+      }
+    }
+  };
+  for (int i = 1; i < n; ++i) {
+    (*runner)(work);
+  }
+  work();
+  mutex_lock l(state->mu);
+  while (state->num_done < n) {
+    state->cv.wait(l);
+  }
+}
+
 }  // namespace
 
 Status ConstantFold(const ConstantFoldingOptions& opts,
@@ -663,6 +824,7 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
           << graph->num_node_ids();
 
   std::vector<string> tensors_to_fetch_names;
+  std::vector<NodeAndOutput> tensors_to_fetch_nodes;
   std::vector<NodeAndOutput> tensors_to_replace;
   // Sorting the nodes based on the name gives us a stable ordering between runs
   // for the same graph.
@@ -677,31 +839,99 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
   for (auto n : tensors_to_fetch_sorted) {
     tensors_to_fetch_names.push_back(
         strings::StrCat(n.first.first->name(), ":", n.first.second));
+    tensors_to_fetch_nodes.push_back(n.first);
     tensors_to_replace.push_back(n.second);
   }
-
-  auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
-  // Evaluate the constant foldable nodes.
-  std::vector<Tensor> outputs;
-  auto delete_tensors = gtl::MakeCleanup([&graph_runner, &outputs] {
+  std::vector<Tensor> outputs(tensors_to_fetch_names.size());
+  // The known sizes of the tensors of "outputs", or -1.
+  std::vector<int64_t> output_bytes(outputs.size(), -1);
+
+  // Looks up the tensors in the cache, and only evaluates the others.
+  ConstantFoldCache* cache =
+      opts.cache != nullptr ? opts.cache : ConstantFoldCache::Global();
+  std::vector<uint64> fingerprints;
+  std::vector<bool> cacheable;
+  std::vector<int> to_evaluate;
+  if (cache != nullptr) {
+    FingerprintConstantTensors(*constant_graph, tensors_to_fetch_nodes,
+                               &fingerprints, &cacheable);
+  }
+  for (int c = 0; c < outputs.size(); ++c) {
+    if (cache != nullptr && cacheable[c]) {
+      Tensor value;
+      int64_t total_bytes;
+      if (cache->Lookup(fingerprints[c], &value, &total_bytes) &&
+          (value.IsInitialized() ||
+           total_bytes > opts.max_constant_size_in_bytes)) {
+        outputs[c] = std::move(value);
+        output_bytes[c] = total_bytes;
+        continue;
+      }
+    }
+    to_evaluate.push_back(c);
+  }
+  VLOG(1) << "Evaluating " << to_evaluate.size() << " of " << outputs.size()
+          << " constant tensors";
+
+  // Evaluates the constant foldable nodes, with one GraphRunner per group of
+  // independent tensors.
+  std::function<void(std::function<void()>)>* runner =
+      function_library != nullptr ? function_library->runner() : nullptr;
+  const int max_groups =
+      runner != nullptr && *runner ? port::MaxParallelism() : 1;
+  const std::vector<std::vector<int>> groups = GroupIndependentTensors(
+      *constant_graph, tensors_to_fetch_nodes, to_evaluate, max_groups);
+  std::vector<std::unique_ptr<GraphRunner>> graph_runners(groups.size());
+  std::vector<std::vector<Tensor>> group_outputs(groups.size());
+  auto delete_tensors = gtl::MakeCleanup([&graph_runners, &group_outputs] {
     // Output tensors need to be cleared before the GraphRunner is deleted.
-    outputs.clear();
-    graph_runner.reset(nullptr);
+    group_outputs.clear();
+    graph_runners.clear();
   });
-
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  std::vector<Status> statuses(groups.size());
+  auto evaluate_group = [&](int g) {
+    if (groups[g].empty()) return;
+    std::vector<string> names;
+    for (int c : groups[g]) {
+      names.push_back(tensors_to_fetch_names[c]);
+    }
+    graph_runners[g] = std::make_unique<GraphRunner>(env);
+    statuses[g] =
+        graph_runners[g]->Run(constant_graph.get(), function_library,
+                              {} /* inputs*/, names, &group_outputs[g]);
+  };
+  if (groups.size() > 1) {
+    RunInParallel(groups.size(), runner, evaluate_group);
+  } else if (!groups.empty()) {
+    evaluate_group(0);
+  }
+  for (int g = 0; g < groups.size(); ++g) {
+    const Status& s = statuses[g];
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    for (int i = 0; i < groups[g].size(); ++i) {
+      const int c = groups[g][i];
+      outputs[c] = group_outputs[g][i];
+      output_bytes[c] = outputs[c].TotalBytes();
+      if (cache != nullptr && cacheable[c]) {
+        cache->Insert(fingerprints[c],
+                      output_bytes[c] <= opts.max_constant_size_in_bytes
+                          ? tensor::DeepCopy(outputs[c])
+                          : outputs[c],
+                      opts.max_constant_size_in_bytes);
+      }
+    }
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
   // original graph with those constants.
   int32_t num_nodes_replaced = 0;
   for (size_t c = 0; c < outputs.size(); ++c) {
+    // The cache only keeps the size of the tensors too large to be replaced.
+    if (output_bytes[c] > opts.max_constant_size_in_bytes) continue;
     const gtl::FlatSet<Node*>& control_deps =
         constant_control_deps[tensors_to_replace[c].first];
     if (ReplaceTensorWithConstant(
@@ -26,6 +26,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class ConstantFoldCache;
+
 // This generator type is used to generate a name for the newly folded node
 // based on the node's old name.
 using ConstantFoldNameGenerator =
@@ -49,6 +51,10 @@ struct ConstantFoldingOptions {
   // default id generator that monotonically increases is used if nullptr is
   // passed.
   ConstantFoldNameGenerator generate_new_name = nullptr;
+
+  // The cache of the folded tensors. `ConstantFoldCache::Global()` is used if
+  // nullptr is passed, which is disabled by default.
+  ConstantFoldCache* cache = nullptr;  // not owned
 };
 
 // Perform constant folding optimization on "graph".
@@ -57,6 +63,8 @@ struct ConstantFoldingOptions {
 // and replaces those nodes with the result of the evaluation.
 // "partition_device", if non-null, is the device where all the graph nodes are
 // assumed to execute.
+// Independent constant subgraphs are evaluated in parallel on the runner of
+// "function_library", if any.
 // Sets `was_mutated` to true if and only if "graph" has been mutated.
 // The status is only set to a non-OK state if an unexpected error is hit
 // running the graph.
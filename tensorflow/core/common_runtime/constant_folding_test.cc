@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/nn_ops.h"
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/constant_fold_cache.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -134,6 +135,38 @@ TEST_F(ConstantFoldingTest, Basic) {
                          {2, 2});
 }
 
+TEST_F(ConstantFoldingTest, Cache) {
+  ConstantFoldCache cache(/*capacity_bytes=*/1 << 20, /*cache_dir=*/"",
+                          Env::Default());
+  ConstantFoldingOptions opts;
+  opts.cache = &cache;
+  for (const string& prefix : {"first", "second"}) {
+    // The node names of the graphs differ, but not their constant subgraphs.
+    Scope s = Scope::NewRootScope().NewSubScope(prefix);
+    BuildSimpleGraph(&s);
+    Graph g(OpRegistry::Global());
+    TF_ASSERT_OK(s.ToGraph(&g));
+
+    bool was_mutated;
+    TF_ASSERT_OK(
+        ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+    EXPECT_TRUE(was_mutated);
+
+    std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+    Node* s1 = index.at(strings::StrCat(prefix, "/s1"));
+    Node* s2 = index.at(strings::StrCat(prefix, "/s2"));
+    EXPECT_EQ(1, s1->num_inputs());
+    ExpectNodeClose<float>(*(s1->in_nodes().begin()), {1.0, 2.0, 3.0, 4.0},
+                           {2, 2});
+    EXPECT_EQ(1, s2->num_inputs());
+    ExpectNodeClose<float>(*(s2->in_nodes().begin()), {2.0, 1.0, 4.0, 3.0},
+                           {2, 2});
+  }
+  // The tensors of the second graph come from the cache.
+  EXPECT_EQ(cache.num_misses(), 2);
+  EXPECT_EQ(cache.num_hits(), 2);
+}
+
 // Tests that different node creation ordering creates same graph after constant
 // folding.
 TEST_F(ConstantFoldingTest, DeterministicFolding) {
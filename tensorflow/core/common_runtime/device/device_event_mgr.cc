@@ -28,7 +28,8 @@ namespace tensorflow {
 
 namespace {
 // The EventMgr has 1 thread for the polling loop and one to execute
-// event callback functions. Issues for reconsideration:
+// event callback functions, or just the latter with host callbacks. Issues for
+// reconsideration:
 //  - Is this the right number of threads?
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
@@ -100,14 +101,27 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
-      threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
+      threadpool_(Env::Default(), "Device_Event_Manager",
+                  use_host_callbacks_ ? 1 : kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
-  StartPollingLoop();
+  if (!use_host_callbacks_) {
+    StartPollingLoop();
+  }
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
 
+  {
+    // The host callbacks refer to this EventMgr, so wait for them to run.
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
+
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
       threadpool_.Schedule(std::move(callback));
@@ -189,6 +203,55 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   }
 }
 
+void EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()> func) {
+  int64_t sequence_number;
+  {
+    mutex_lock l(mu_);
+    sequence_number = next_sequence_number_++;
+    host_callbacks_[stream].push_back({sequence_number, std::move(func)});
+    ++num_pending_host_callbacks_;
+  }
+  // Entrained outside of mu_, since the host callbacks of the stream may
+  // already be waiting for it. Any host callback entrained later runs after
+  // the work that preceded every callback with a lower sequence number, so the
+  // first one to run schedules all of them at once.
+  stream->ThenDoHostCallback([this, stream, sequence_number]() {
+    RunHostCallbacks(stream, sequence_number);
+  });
+}
+
+void EventMgr::RunHostCallbacks(se::Stream* stream, int64_t sequence_number) {
+  std::vector<std::function<void()>> callbacks;
+  {
+    mutex_lock l(mu_);
+    auto stream_it = host_callbacks_.find(stream);
+    if (stream_it != host_callbacks_.end()) {
+      auto& stream_callbacks = stream_it->second;
+      while (!stream_callbacks.empty() &&
+             stream_callbacks.front().first <= sequence_number) {
+        callbacks.push_back(std::move(stream_callbacks.front().second));
+        stream_callbacks.pop_front();
+      }
+      if (stream_callbacks.empty()) {
+        host_callbacks_.erase(stream_it);
+      }
+    }
+    if (!callbacks.empty()) {
+      // The host callback thread may not call into the device, so the
+      // callbacks run in the threadpool.
+      threadpool_.Schedule([callbacks = std::move(callbacks)]() {
+        for (const auto& callback : callbacks) {
+          callback();
+        }
+      });
+    }
+    if (--num_pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  }
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
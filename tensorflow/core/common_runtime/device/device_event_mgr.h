@@ -68,6 +68,10 @@ class EventMgr {
   // be brief and non-blocking since it executes in the one thread used for all
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      EnqueueHostCallback(stream, std::move(func));
+      return;
+    }
     mutex_lock l(mu_);
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
@@ -80,6 +84,10 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // If true, the completion of the streams is signaled by host callbacks
+  // entrained onto them instead of polled events, and there is no polling
+  // loop.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -90,6 +98,16 @@ class EventMgr {
   void EnqueueCallback(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Set up `func` to be called by the threadpool once the host callback that
+  // this entrains onto `stream` runs.
+  void EnqueueHostCallback(se::Stream* stream, std::function<void()> func)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Runs on the host callback thread of `stream`. Schedules the callbacks of
+  // `stream` enqueued up to `sequence_number` as one batch.
+  void RunHostCallbacks(se::Stream* stream, int64_t sequence_number)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // This function should be called at roughly the same tempo as QueueTensors()
   // to check whether pending events have recorded, and then retire them.
   //
@@ -115,6 +133,16 @@ class EventMgr {
       std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
       callbacks_ TF_GUARDED_BY(mu_);
 
+  // Callbacks waiting on their host callbacks, with the sequence number of
+  // their host callback, when use_host_callbacks_.
+  absl::flat_hash_map<se::Stream*,
+                      std::deque<std::pair<int64_t, std::function<void()>>>>
+      host_callbacks_ TF_GUARDED_BY(mu_);
+  int64_t next_sequence_number_ TF_GUARDED_BY(mu_) = 0;
+  // The host callbacks entrained onto the streams that have not run yet.
+  int64_t num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -136,6 +136,38 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  constexpr int kNumCallbacks = 100;
+  mutex mu;
+  std::vector<int> order;
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [i, &mu, &order, &note]() {
+      mutex_lock l(mu);
+      order.push_back(i);
+      if (order.size() == kNumCallbacks) {
+        note.Notify();
+      }
+    });
+  }
+  note.WaitForNotification();
+  // The callbacks of a stream run in order, and no event is polled.
+  mutex_lock l(mu);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -63,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -77,6 +79,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/device_profiler_session.h"
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -90,6 +93,23 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Returns a hash of the feeds, fetches and targets of a run, in their order,
+// without building its executors key.
+uint64 RunSignature(gtl::ArraySlice<string> inputs,
+                    gtl::ArraySlice<string> outputs,
+                    gtl::ArraySlice<string> target_nodes, bool is_partial_run,
+                    const string& debug_tensor_watches_summary) {
+  uint64 signature =
+      Hash64Combine(is_partial_run, Hash64(debug_tensor_watches_summary));
+  for (gtl::ArraySlice<string> names : {inputs, outputs, target_nodes}) {
+    signature = Hash64Combine(signature, names.size());
+    for (const string& name : names) {
+      signature = Hash64Combine(signature, Hash64(name));
+    }
+  }
+  return signature;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -327,6 +347,10 @@ DirectSession::DirectSession(const SessionOptions& options,
       factory_(factory),
       cancellation_manager_(new CancellationManager()),
       operation_timeout_in_ms_(options_.config.operation_timeout_in_ms()) {
+  lock_free_executors_.reset(
+      new std::atomic<const CachedExecutorsEntry*>[kLockFreeExecutorsSize]);
+  std::fill(lock_free_executors_.get(),
+            lock_free_executors_.get() + kLockFreeExecutorsSize, nullptr);
   const int thread_pool_size =
       options_.config.session_inter_op_thread_pool_size();
   if (thread_pool_size > 0) {
@@ -338,6 +362,26 @@ DirectSession::DirectSession(const SessionOptions& options,
           &owned));
       thread_pools_.emplace_back(pool, owned);
     }
+  } else if (options_.config.experimental().inter_op_spin_wait_threads() >
+             0) {
+    SpinWaitThreadPool::Options pool_options;
+    pool_options.env = options_.env;
+    pool_options.name = "SpinWaitCompute";
+    // Bounds the number of threads reserved by the session.
+    pool_options.num_threads =
+        std::min(options_.config.experimental().inter_op_spin_wait_threads(),
+                 port::MaxParallelism());
+    if (options_.config.experimental().inter_op_spin_wait_micros() > 0) {
+      pool_options.spin_wait_micros =
+          options_.config.experimental().inter_op_spin_wait_micros();
+    }
+    VLOG(1) << "Direct session inter op spin wait threads: "
+            << pool_options.num_threads;
+    spin_wait_thread_pool_ =
+        std::make_unique<SpinWaitThreadPool>(pool_options);
+    thread_pools_.emplace_back(
+        new thread::ThreadPool(spin_wait_thread_pool_.get()),
+        true /* owned */);
   } else if (options_.config.use_per_session_threads()) {
     thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
                                true /* owned */);
@@ -399,6 +443,9 @@ DirectSession::~DirectSession() {
   for (auto& it : partial_runs_) {
     it.second.reset(nullptr);
   }
+  for (int i = 0; i < kLockFreeExecutorsSize; ++i) {
+    delete lock_free_executors_[i].load(std::memory_order_relaxed);
+  }
   for (auto& it : executors_) {
     it.second.reset();
   }
@@ -411,6 +458,7 @@ DirectSession::~DirectSession() {
   for (const auto& p_and_owned : thread_pools_) {
     if (p_and_owned.second) delete p_and_owned.first;
   }
+  spin_wait_thread_pool_.reset();
 
   execution_state_.reset(nullptr);
   flib_def_.reset(nullptr);
@@ -706,6 +754,11 @@ Status DirectSession::RunInternal(
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
     device_profiler_session = DeviceProfilerSession::Create();
   }
+  // Unless the step is traced for RunMetadata, it may be sampled by the
+  // continuous profiler.
+  profiler::SamplingProfiler::ScopedStep sampled_step(
+      device_profiler_session == nullptr ? profiler::SamplingProfiler::Global()
+                                         : nullptr);
 
   // Register this step with session's cancellation manager, so that
   // `Session::Close()` will cancel the step.
@@ -841,6 +894,12 @@ Status DirectSession::RunInternal(
       }
     }
   }
+
+  if (run_metadata != nullptr &&
+      run_options.experimental().output_grappler_pass_stats()) {
+    *run_metadata->mutable_grappler_pass_stats() =
+        executors_and_keys->grappler_pass_stats;
+  }
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
   return OkStatus();
@@ -1343,7 +1402,7 @@ Status DirectSession::CreateExecutors(
   std::unordered_map<string, std::unique_ptr<Graph>> graphs;
   TF_RETURN_IF_ERROR(CreateGraphs(
       options, &graphs, &func_info->flib_def, run_state_args, &ek->input_types,
-      &ek->output_types, &ek->collective_graph_key));
+      &ek->output_types, &ek->collective_graph_key, &ek->grappler_pass_stats));
 
   if (run_state_args->is_partial_run) {
     ek->graph = std::move(run_state_args->graph);
@@ -1403,6 +1462,10 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.step_graph_replay =
+        options_.config.experimental().enable_step_graph_replay();
+    params.step_arena_allocation =
+        options_.config.experimental().enable_step_arena_allocation();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1507,22 +1570,41 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Lock-free lookup path, no key construction.
+  const uint64 signature = RunSignature(inputs, outputs, target_nodes,
+                                        run_state_args->is_partial_run,
+                                        debug_tensor_watches_summary);
+  ExecutorsAndKeys* cached_executors_and_keys = LookupLockFreeExecutors(
+      signature, inputs, outputs, target_nodes, run_state_args->is_partial_run,
+      debug_tensor_watches_summary);
+
   // Fast lookup path, no sorting.
-  const string key = strings::StrCat(
-      absl::StrJoin(inputs, ","), "->", absl::StrJoin(outputs, ","), "/",
-      absl::StrJoin(target_nodes, ","), "/", run_state_args->is_partial_run,
-      "/", debug_tensor_watches_summary);
+  string key;
+  if (cached_executors_and_keys == nullptr || handle_name_counter_value >= 0) {
+    key = strings::StrCat(absl::StrJoin(inputs, ","), "->",
+                          absl::StrJoin(outputs, ","), "/",
+                          absl::StrJoin(target_nodes, ","), "/",
+                          run_state_args->is_partial_run, "/",
+                          debug_tensor_watches_summary);
+  }
   // Set the handle, if it's needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
         strings::StrCat(key, ";", handle_name_counter_value);
   }
+  if (cached_executors_and_keys != nullptr) {
+    *executors_and_keys = cached_executors_and_keys;
+    return OkStatus();
+  }
 
   // See if we already have the executors for this run.
   {
-    mutex_lock l(executor_lock_);  // could use reader lock
+    mutex_lock l(executor_lock_);
     auto it = executors_.find(key);
     if (it != executors_.end()) {
+      InsertLockFreeExecutors(signature, inputs, outputs, target_nodes,
+                              run_state_args->is_partial_run,
+                              debug_tensor_watches_summary, it->second.get());
       *executors_and_keys = it->second.get();
       return OkStatus();
     }
@@ -1556,6 +1638,9 @@ Status DirectSession::GetOrCreateExecutors(
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
     if (it != executors_.end()) {
+      InsertLockFreeExecutors(signature, inputs, outputs, target_nodes,
+                              run_state_args->is_partial_run,
+                              debug_tensor_watches_summary, it->second.get());
       *executors_and_keys = it->second.get();
       return OkStatus();
     }
@@ -1601,17 +1686,77 @@ Status DirectSession::GetOrCreateExecutors(
   // Insert the value under the original key, so the fast path lookup will work
   // if the user uses the same order of inputs, outputs, and targets again.
   executors_.emplace(key, insert_result.first->second);
+  InsertLockFreeExecutors(signature, inputs, outputs, target_nodes,
+                          run_state_args->is_partial_run,
+                          debug_tensor_watches_summary,
+                          insert_result.first->second.get());
   *executors_and_keys = insert_result.first->second.get();
 
   return OkStatus();
 }
 
+DirectSession::ExecutorsAndKeys* DirectSession::LookupLockFreeExecutors(
+    uint64 signature, gtl::ArraySlice<string> inputs,
+    gtl::ArraySlice<string> outputs, gtl::ArraySlice<string> target_nodes,
+    bool is_partial_run, const string& debug_tensor_watches_summary) {
+  for (int i = 0; i < kLockFreeExecutorsSize; ++i) {
+    const CachedExecutorsEntry* entry =
+        lock_free_executors_[(signature + i) % kLockFreeExecutorsSize].load(
+            std::memory_order_acquire);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    if (entry->signature == signature &&
+        entry->is_partial_run == is_partial_run &&
+        absl::c_equal(entry->inputs, inputs) &&
+        absl::c_equal(entry->outputs, outputs) &&
+        absl::c_equal(entry->target_nodes, target_nodes) &&
+        entry->debug_tensor_watches_summary == debug_tensor_watches_summary) {
+      return entry->executors_and_keys;
+    }
+  }
+  return nullptr;
+}
+
+void DirectSession::InsertLockFreeExecutors(
+    uint64 signature, gtl::ArraySlice<string> inputs,
+    gtl::ArraySlice<string> outputs, gtl::ArraySlice<string> target_nodes,
+    bool is_partial_run, const string& debug_tensor_watches_summary,
+    ExecutorsAndKeys* executors_and_keys) {
+  // Keeps the table at most half full, so that the probe sequences are short.
+  if (num_lock_free_executors_ >= kLockFreeExecutorsSize / 2 ||
+      LookupLockFreeExecutors(signature, inputs, outputs, target_nodes,
+                              is_partial_run,
+                              debug_tensor_watches_summary) != nullptr) {
+    return;
+  }
+  auto* entry = new CachedExecutorsEntry{
+      signature,
+      std::vector<string>(inputs.begin(), inputs.end()),
+      std::vector<string>(outputs.begin(), outputs.end()),
+      std::vector<string>(target_nodes.begin(), target_nodes.end()),
+      is_partial_run,
+      debug_tensor_watches_summary,
+      executors_and_keys};
+  for (int i = 0;; ++i) {
+    std::atomic<const CachedExecutorsEntry*>& slot =
+        lock_free_executors_[(signature + i) % kLockFreeExecutorsSize];
+    if (slot.load(std::memory_order_relaxed) == nullptr) {
+      slot.store(entry, std::memory_order_release);
+      break;
+    }
+  }
+  ++num_lock_free_executors_;
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
     std::unique_ptr<FunctionLibraryDefinition>* flib_def,
     RunStateArgs* run_state_args, DataTypeVector* input_types,
-    DataTypeVector* output_types, int64_t* collective_graph_key) {
+    DataTypeVector* output_types, int64_t* collective_graph_key,
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>*
+        grappler_pass_stats) {
   mutex_lock l(graph_state_lock_);
   if (finalized_) {
     return errors::FailedPrecondition("Session has been finalized.");
@@ -1640,6 +1785,7 @@ Status DirectSession::CreateGraphs(
         execution_state->BuildGraph(subgraph_options, &client_graph));
   }
   *collective_graph_key = client_graph->collective_graph_key;
+  grappler_pass_stats->Swap(&client_graph->grappler_pass_stats);
 
   if (subgraph_options.callable_options.feed_size() !=
       client_graph->feed_types.size()) {
@@ -1701,7 +1847,13 @@ Status DirectSession::CreateGraphs(
   popts.control_flow_added = false;
 
   std::unordered_map<string, GraphDef> partitions;
+  metrics::ScopedCounter<2> setup_timings(
+      metrics::GetGraphOptimizationCounter(), {"GraphSetup", "Partition"});
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
+  VLOG(1) << "Partitioned " << client_graph->graph.num_nodes()
+          << " nodes into " << partitions.size() << " partitions in "
+          << *setup_timings.DurationMicroSec() << " us";
+  setup_timings.ReportAndStop();
 
   std::vector<string> device_names;
   device_names.reserve(devices_.size());
@@ -1724,18 +1876,49 @@ Status DirectSession::CreateGraphs(
     }
   }
 
+  // The partitions are independent, so convert them concurrently on the
+  // inter-op threads, unless this is one of them: the calling thread would
+  // then block a thread that the conversion may be waiting for.
+  setup_timings.Reset({"GraphSetup", "ConvertPartitions"});
+  std::vector<std::pair<const string, GraphDef>*> partition_defs;
+  partition_defs.reserve(partitions.size());
   for (auto& partition : partitions) {
-    std::unique_ptr<Graph> device_graph(
-        new Graph(client_graph->flib_def.get()));
-    device_graph->SetConstructionContext(ConstructionContext::kDirectSession);
-    GraphConstructorOptions device_opts;
-    // There are internal operations (e.g., send/recv) that we now allow.
-    device_opts.allow_internal_ops = true;
-    device_opts.expect_device_spec = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
-        device_opts, std::move(partition.second), device_graph.get()));
-    outputs->emplace(partition.first, std::move(device_graph));
+    partition_defs.push_back(&partition);
+  }
+  std::vector<std::unique_ptr<Graph>> device_graphs(partition_defs.size());
+  std::vector<Status> convert_statuses(partition_defs.size());
+  auto convert_partitions = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      device_graphs[i] = std::make_unique<Graph>(client_graph->flib_def.get());
+      device_graphs[i]->SetConstructionContext(
+          ConstructionContext::kDirectSession);
+      GraphConstructorOptions device_opts;
+      // There are internal operations (e.g., send/recv) that we now allow.
+      device_opts.allow_internal_ops = true;
+      device_opts.expect_device_spec = true;
+      convert_statuses[i] = ConvertGraphDefToGraph(
+          device_opts, std::move(partition_defs[i]->second),
+          device_graphs[i].get());
+    }
+  };
+  thread::ThreadPool* pool = thread_pools_[0].first;
+  if (partition_defs.size() > 1 && pool->CurrentThreadId() == -1) {
+    pool->ParallelFor(
+        partition_defs.size(),
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+            /*cost_per_unit=*/std::nullopt, /*block_size=*/1),
+        convert_partitions);
+  } else {
+    convert_partitions(0, partition_defs.size());
+  }
+  for (int i = 0; i < partition_defs.size(); ++i) {
+    TF_RETURN_IF_ERROR(convert_statuses[i]);
+    outputs->emplace(partition_defs[i]->first, std::move(device_graphs[i]));
   }
+  VLOG(1) << "Converted " << partition_defs.size() << " partitions in "
+          << *setup_timings.DurationMicroSec() << " us";
+  setup_timings.ReportAndStop();
 
   GraphOptimizationPassOptions optimization_options;
   optimization_options.session_options = &options_;
@@ -1894,11 +2077,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       const std::vector<Allocator*>* fetch_allocators)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_allocators_(fetch_allocators) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1924,11 +2109,17 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return OkStatus();
   }
 
+  Allocator* GetRetvalAllocator(int index) const override {
+    return index < fetch_allocators_->size() ? (*fetch_allocators_)[index]
+                                             : nullptr;
+  }
+
  private:
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  const std::vector<Allocator*>* const fetch_allocators_;  // Not owned.
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1942,6 +2133,15 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallable(handle, feed_tensors, fetch_tensors, run_metadata,
+                     threadpool_options, /*fetch_allocators=*/{});
+}
+
+::tensorflow::Status DirectSession::RunCallable(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options,
+    const std::vector<Allocator*>& fetch_allocators) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
@@ -1975,6 +2175,12 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
+  if (!fetch_allocators.empty() &&
+      fetch_allocators.size() != executors_and_keys->output_types.size()) {
+    return errors::InvalidArgument(
+        "Expected ", executors_and_keys->output_types.size(),
+        " fetch allocators, but got ", fetch_allocators.size());
+  }
   if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
@@ -2014,7 +2220,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+                                  actual_feed_tensors, fetch_tensors,
+                                  &fetch_allocators);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/spin_wait_thread_pool.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -131,6 +132,12 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Allocator*>& fetch_allocators) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -176,6 +183,10 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // The results of the Grappler passes that optimized the graphs.
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>
+        grappler_pass_stats;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -245,6 +256,35 @@ class DirectSession : public Session {
       gtl::ArraySlice<string> target_nodes,
       ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
 
+  // The feeds, fetches and targets of a `Run()` call, in the order of the
+  // call, with the executors which run them.
+  struct CachedExecutorsEntry {
+    uint64 signature;
+    std::vector<string> inputs;
+    std::vector<string> outputs;
+    std::vector<string> target_nodes;
+    bool is_partial_run;
+    string debug_tensor_watches_summary;
+    ExecutorsAndKeys* executors_and_keys;  // Owned by `executors_`.
+  };
+
+  // Returns the executors which `lock_free_executors_` caches for the given
+  // `signature` and run, or nullptr. Does not take any lock.
+  ExecutorsAndKeys* LookupLockFreeExecutors(
+      uint64 signature, gtl::ArraySlice<string> inputs,
+      gtl::ArraySlice<string> outputs, gtl::ArraySlice<string> target_nodes,
+      bool is_partial_run, const string& debug_tensor_watches_summary);
+
+  // Caches `executors_and_keys` in `lock_free_executors_`, unless the cache
+  // is full or already holds the run.
+  void InsertLockFreeExecutors(uint64 signature, gtl::ArraySlice<string> inputs,
+                               gtl::ArraySlice<string> outputs,
+                               gtl::ArraySlice<string> target_nodes,
+                               bool is_partial_run,
+                               const string& debug_tensor_watches_summary,
+                               ExecutorsAndKeys* executors_and_keys)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
   ::tensorflow::Status CreateExecutors(
@@ -261,7 +301,9 @@ class DirectSession : public Session {
       std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
       std::unique_ptr<FunctionLibraryDefinition>* flib_def,
       RunStateArgs* run_state_args, DataTypeVector* input_types,
-      DataTypeVector* output_types, int64_t* collective_graph_key);
+      DataTypeVector* output_types, int64_t* collective_graph_key,
+      protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>*
+          grappler_pass_stats);
 
   ::tensorflow::Status RunInternal(
       int64_t step_id, const RunOptions& run_options,
@@ -349,6 +391,9 @@ class DirectSession : public Session {
   // The thread-pools to use for running ops, with a bool indicating if the pool
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
+  // The threads of the inter-op thread pool, if
+  // `inter_op_spin_wait_threads` is set.
+  std::unique_ptr<SpinWaitThreadPool> spin_wait_thread_pool_;
 
   Status init_error_;  // Set to an error if construction failed.
 
@@ -367,6 +412,16 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
 
+  // A read-mostly cache of `executors_`, looked up by the signature of the
+  // runs without taking any lock or building their keys. It is an
+  // open-addressing hash table with linear probing: the entries are only
+  // added, under `executor_lock_`, and deleted with the session. The runs
+  // which do not fit into it use `executors_`.
+  static constexpr int kLockFreeExecutorsSize = 1024;
+  std::unique_ptr<std::atomic<const CachedExecutorsEntry*>[]>
+      lock_free_executors_;
+  int num_lock_free_executors_ TF_GUARDED_BY(executor_lock_) = 0;
+
   class RunCallableCallFrame;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
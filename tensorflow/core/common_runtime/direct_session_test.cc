@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <random>
@@ -48,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool_options.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -197,6 +199,64 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+// An allocator counting its allocations, which are served by the CPU
+// allocator.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    num_allocations_.fetch_add(1);
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_allocations() const { return num_allocations_.load(); }
+
+ private:
+  std::atomic<int> num_allocations_{0};
+};
+
+TEST_F(DirectSessionMinusAXTest, RunCallableWithFetchAllocators) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Feeds `a` so that `y` is computed by its MatMul kernel.
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({a_ + ":0"}, {y_ + ":0"}, {}), &handle));
+  Tensor a(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a, {3, 2, -1, 0});
+
+  CountingAllocator allocator;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {a}, &outputs, nullptr,
+                                      thread::ThreadPoolOptions(),
+                                      {&allocator}));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_EQ(allocator.num_allocations(), i + 1);
+  }
+
+  // The fetched tensor is allocated as usual without fetch allocators.
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->RunCallable(handle, {a}, &outputs, nullptr,
+                                    thread::ThreadPoolOptions(), {}));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_EQ(allocator.num_allocations(), 2);
+
+  Status s = session->RunCallable(handle, {a}, &outputs, nullptr,
+                                  thread::ThreadPoolOptions(),
+                                  {&allocator, &allocator});
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.message(), "fetch allocators"));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -577,6 +637,37 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestConcurrency_FetchOrders) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  // Run the graph 1000 times in 4 different threads concurrently, with the
+  // fetches in both orders, so that the executors cached for each order are
+  // looked up concurrently with their creation.
+  auto fn = [this, &session](bool reverse) {
+    std::vector<string> output_names = {y_ + ":0", y_neg_ + ":0"};
+    if (reverse) std::swap(output_names[0], output_names[1]);
+    for (int i = 0; i < 1000; ++i) {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+      ASSERT_EQ(2, outputs.size());
+      EXPECT_FLOAT_EQ(reverse ? -3.0 : 3.0, outputs[0].matrix<float>()(0, 0));
+      EXPECT_FLOAT_EQ(reverse ? 3.0 : -3.0, outputs[1].matrix<float>()(0, 0));
+    }
+  };
+
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule([fn, i]() { fn(/*reverse=*/i % 2 == 1); });
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -647,6 +738,84 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestSpinWaitThreads) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_inter_op_spin_wait_threads(2);
+  options.config.mutable_experimental()->set_inter_op_spin_wait_micros(20);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  // Run the graph 1000 times in 4 different threads concurrently.
+  std::vector<string> output_names = {y_ + ":0"};
+  auto fn = [&session, output_names]() {
+    for (int i = 0; i < 1000; ++i) {
+      std::vector<std::pair<string, Tensor>> inputs;
+      std::vector<Tensor> outputs;
+      Status s = session->Run(inputs, output_names, {}, &outputs);
+      TF_ASSERT_OK(s);
+      ASSERT_EQ(1, outputs.size());
+      auto mat = outputs[0].matrix<float>();
+      EXPECT_FLOAT_EQ(3.0, mat(0, 0));
+    }
+  };
+
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule(fn);
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
+TEST_F(DirectSessionMinusAXTest, TestStepGraphReplay) {
+  Initialize({3, 2, -1, 0});
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_enable_step_graph_replay(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The replayed schedule is reused by each step.
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, TestStepArenaAllocation) {
+  Initialize({3, 2, -1, 0});
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_enable_step_arena_allocation(
+      true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The outputs of each step outlive its arena.
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<std::vector<Tensor>> outputs(3);
+  for (std::vector<Tensor>& step_outputs : outputs) {
+    TF_ASSERT_OK(session->Run({}, output_names, {}, &step_outputs));
+  }
+  for (const std::vector<Tensor>& step_outputs : outputs) {
+    ASSERT_EQ(1, step_outputs.size());
+    EXPECT_FLOAT_EQ(5.0, step_outputs[0].matrix<float>()(0, 0));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
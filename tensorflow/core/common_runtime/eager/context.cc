@@ -68,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 #endif  // !IS_MOBILE_PLATFORM
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/util/env_var.h"
@@ -97,10 +98,26 @@ bool ReadBoolFromEnvVar(StringPiece env_var_name, bool default_val) {
   return default_val;
 }
 
+int64_t ReadInt64FromEnvVar(StringPiece env_var_name, int64_t default_val) {
+  int64_t val;
+  if (tensorflow::ReadInt64FromEnvVar(env_var_name, default_val, &val).ok()) {
+    return val;
+  }
+  return default_val;
+}
+
 auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
 
+auto* eager_kernel_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/eager_kernel_cache_lookups",
+    "The number of lookups of the eager kernel cache.", "result");
+
+auto* eager_kernel_cache_evictions = monitoring::Counter<0>::New(
+    "/tensorflow/core/eager_kernel_cache_evictions",
+    "The number of kernels evicted from the eager kernel cache.");
+
 }  // namespace
 
 const int64_t EagerContext::kGlobalRendezvousId = -1;
@@ -132,14 +149,19 @@ EagerContext::EagerContext(
       rendezvous_(std::move(rendezvous)),
       thread_pool_(NewThreadPoolFromSessionOptions(opts)),
       cluster_flr_(cluster_flr),
+      kernel_cache_(ReadInt64FromEnvVar("TF_EAGER_KERNEL_CACHE_CAPACITY", 0)),
       log_device_placement_(opts.config.log_device_placement()),
       allow_soft_placement_(opts.config.allow_soft_placement()),
       num_active_steps_(0),
       step_container_(std::make_unique<ScopedStepContainer>(
           0, [this](const string& name) { ClearResourceContainer(name); })),
-      default_executor_(async,
-                        /*enable_streaming_enqueue=*/!opts.config.experimental()
-                            .disable_eager_executor_streaming_enqueue()),
+      default_executor_(
+          async,
+          /*enable_streaming_enqueue=*/!opts.config.experimental()
+              .disable_eager_executor_streaming_enqueue(),
+          /*in_flight_nodes_limit=*/0,
+          /*lazy_batch_size=*/
+          ReadInt64FromEnvVar("TF_EAGER_LAZY_BATCH_SIZE", 0)),
       log_memory_(LogMemory::IsEnabled()),
       env_(opts.env),
       collective_executor_mgr_(collective_executor_mgr, /*owned=*/false),
@@ -456,7 +478,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    kernel_cache_.Clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -1072,7 +1094,7 @@ EagerContext::GetCacheStats() {
   CacheStats stats;
   {
     mutex_lock l(cache_mu_);
-    stats.kernel_cache_size = kernel_cache_.size();
+    stats.kernel_cache_size = kernel_cache_.Size();
     for (const auto& iter : registered_functions_) {
       stats.func_kernel_cache_entries[iter.first] =
           iter.second->cached_kernel_keys->size();
@@ -1103,7 +1125,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        kernel_cache_.Erase(key);
       }
       registered_functions_.erase(func);
     }
@@ -1186,14 +1208,10 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
-  }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
-  return new_ref;
+  core::RefCountPtr<KernelAndDevice> kernel = kernel_cache_.Lookup(cache_key);
+  eager_kernel_cache_lookups->GetCell(kernel != nullptr ? "hit" : "miss")
+      ->IncrementBy(1);
+  return kernel;
 }
 
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
@@ -1205,10 +1223,14 @@ Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
 
 void EagerContext::AddKernelToCache(Fprint128 cache_key,
                                     KernelAndDevice* kernel) {
+  // Adds the kernel under cache_mu_, so that it is not added for a function
+  // while RemoveFunction erases the cached kernels of that function.
   mutex_lock ml(cache_mu_);
-  core::RefCountPtr<KernelAndDevice> new_ref(kernel);
-  new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  const int64_t num_evicted = kernel_cache_.Add(cache_key, kernel);
+  if (num_evicted > 0) {
+    VLOG(3) << "Evicted " << num_evicted << " kernels from the cache";
+    eager_kernel_cache_evictions->GetCell()->IncrementBy(num_evicted);
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <forward_list>
 #include <functional>
 #include <memory>
@@ -32,10 +34,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+// The longest time nodes are buffered in lazy batching mode.
+constexpr std::chrono::microseconds kLazyBatchDelay(100);
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
-                             int in_flight_nodes_limit)
+                             int in_flight_nodes_limit, int lazy_batch_size)
     : next_node_id_(0),
       ok_(true),
       thread_(async ? tensorflow::Env::Default()->StartThread(
@@ -46,11 +51,15 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
-      in_flight_nodes_limit_(in_flight_nodes_limit) {
+      in_flight_nodes_limit_(in_flight_nodes_limit),
+      lazy_batch_size_(async ? std::max(lazy_batch_size, 0) : 0) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
   }
+  if (lazy_batch_size_ > 0) {
+    VLOG(4) << "EagerExecutor lazy batch size is set to " << lazy_batch_size_;
+  }
 }
 
 EagerExecutor::~EagerExecutor() {
@@ -162,8 +171,10 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
       if (status.ok()) {
         node_queue_.push(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
-        // start processing requests again.
-        if (node_queue_.size() == 1) {
+        // start processing requests again. In lazy batching mode, also wake it
+        // once a batch is complete.
+        if (node_queue_.size() == 1 ||
+            (lazy_batch_size_ > 0 && node_queue_.size() == lazy_batch_size_)) {
           nodes_pending_.notify_all();
         }
         if (in_flight_nodes_limit_ == 0) {
@@ -208,6 +219,10 @@ tensorflow::Status EagerExecutor::WaitForAllPendingNodesLocked(
   if (node_queue_.empty() && unfinished_nodes_.empty()) return OkStatus();
   // node_queue_ must be empty in sync mode.
   DCHECK(Async() || node_queue_.empty());
+  if (BufferingLocked()) {
+    flushing_ = true;
+    nodes_pending_.notify_all();
+  }
   auto last_id = next_node_id_ - 1;
   DVLOG(3) << "Wait for Node: [id " << last_id << "] ";
   node_done_notifications_.insert(std::make_pair(last_id, &cond));
@@ -351,10 +366,23 @@ void EagerExecutor::Run() {
     core::RefCountPtr<NodeItem> curr_item;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
-      while (node_queue_.empty() || !status_.ok()) {
+      while (true) {
         if (state_ == ExecutorState::kShutDown) return;
-        nodes_pending_.wait(l);
+        if (node_queue_.empty() || !status_.ok()) {
+          // Start buffering the next batch.
+          flushing_ = false;
+          nodes_pending_.wait(l);
+        } else if (BufferingLocked()) {
+          if (nodes_pending_.wait_for(l, kLazyBatchDelay) ==
+              std::cv_status::timeout) {
+            flushing_ = true;
+          }
+        } else {
+          break;
+        }
       }
+      // Run the whole batch, including the nodes added meanwhile.
+      flushing_ = lazy_batch_size_ > 0;
       // Obtain raw pointer since we don't want to remove from the queue until
       // the node has been run. Otherwise, WaitForAllPendingNodes can return
       // too early.
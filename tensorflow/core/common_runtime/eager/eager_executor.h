@@ -113,10 +113,18 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
 // EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
+//
+// In async mode with a positive `lazy_batch_size`, the executor thread is not
+// woken up for each node. The nodes are buffered until `lazy_batch_size` of
+// them are pending, a wait for pending nodes is requested, or a short delay
+// has passed since the first buffered node, and then run back to back. This
+// saves a thread wake-up per op for sequences of tiny ops, at the cost of up to
+// the delay of latency for reads of their outputs.
 class EagerExecutor {
  public:
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
-                         int in_flight_nodes_limit = 0);
+                         int in_flight_nodes_limit = 0,
+                         int lazy_batch_size = 0);
 
   ~EagerExecutor();
 
@@ -220,6 +228,13 @@ class EagerExecutor {
 
   Status WaitImpl(bool wait_all, uint64 node_id);
 
+  // Returns true if the executor thread should keep buffering the pending
+  // nodes instead of running them.
+  bool BufferingLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_) {
+    return lazy_batch_size_ > 0 && !flushing_ &&
+           node_queue_.size() < lazy_batch_size_;
+  }
+
   std::atomic<uint64> next_node_id_;
 
   mutable mutex node_queue_mutex_;
@@ -277,6 +292,12 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // The number of nodes buffered before they are run, or 0 to run them as soon
+  // as possible. See the class comment.
+  const size_t lazy_batch_size_;
+  // Whether the buffered nodes are being run, until the queue is empty.
+  bool flushing_ TF_GUARDED_BY(node_queue_mutex_) = false;
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
@@ -16,7 +16,9 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +104,22 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+class NotifyingEagerNode : public EagerNode {
+ public:
+  explicit NotifyingEagerNode(Notification* done) : done_(done) {}
+
+  Status Run() override {
+    done_->Notify();
+    return OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "notifyingEagerNode"; }
+
+ private:
+  Notification* done_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -185,6 +203,31 @@ TEST(EagerExecutorTest, TestAsyncExecutorWithAsyncEagerNode) {
   ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorWithLazyBatching) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*lazy_batch_size=*/4);
+
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 10; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  // Waiting runs the incomplete last batch too.
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (const auto& state : states) {
+    ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+
+  // A node that does not complete a batch still runs after a delay.
+  Notification done;
+  auto node = std::make_unique<NotifyingEagerNode>(&done);
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::move(node)));
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(/*timeout_in_us=*/10000000));
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorWithInFlightRequestLimit) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true,
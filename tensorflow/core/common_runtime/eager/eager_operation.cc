@@ -50,33 +50,33 @@ void EagerOperation::Clear() {
 
 Status EagerOperation::SetAttrValue(const char* attr_name,
                                     const AttrValue& value) {
-  MutableAttrs()->Set(attr_name, value);
+  UnbindAndMutableAttrs()->Set(attr_name, value);
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrString(const char* attr_name, const char* data,
                                      size_t length) {
-  MutableAttrs()->Set(attr_name, StringPiece(data, length));
+  UnbindAndMutableAttrs()->Set(attr_name, StringPiece(data, length));
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrInt(const char* attr_name, int64_t value) {
-  MutableAttrs()->Set(attr_name, static_cast<int64_t>(value));
+  UnbindAndMutableAttrs()->Set(attr_name, static_cast<int64_t>(value));
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrFloat(const char* attr_name, float value) {
-  MutableAttrs()->Set(attr_name, value);
+  UnbindAndMutableAttrs()->Set(attr_name, value);
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrBool(const char* attr_name, bool value) {
-  MutableAttrs()->Set(attr_name, value);
+  UnbindAndMutableAttrs()->Set(attr_name, value);
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrType(const char* attr_name, DataType value) {
-  MutableAttrs()->Set(attr_name, value);
+  UnbindAndMutableAttrs()->Set(attr_name, value);
   return OkStatus();
 }
 
@@ -98,7 +98,7 @@ Status EagerOperation::SetAttrShape(const char* attr_name, const int64_t* dims,
     }
   }
 
-  MutableAttrs()->Set(attr_name, proto);
+  UnbindAndMutableAttrs()->Set(attr_name, proto);
 
   return OkStatus();
 }
@@ -110,7 +110,7 @@ Status EagerOperation::SetAttrFunction(const char* attr_name,
   func->set_name(value->Name());
   auto* value_operation = down_cast<const EagerOperation*>(value);
   value_operation->Attrs().FillAttrValueMap(func->mutable_attr());
-  MutableAttrs()->Set(attr_name, attr_value);
+  UnbindAndMutableAttrs()->Set(attr_name, attr_value);
   return OkStatus();
 }
 
@@ -119,14 +119,14 @@ Status EagerOperation::SetAttrFunctionName(const char* attr_name,
   AttrValue attr_value;
   NameAttrList* func = attr_value.mutable_func();
   func->set_name(data, length);
-  MutableAttrs()->Set(attr_name, attr_value);
+  UnbindAndMutableAttrs()->Set(attr_name, attr_value);
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrTensor(const char* attr_name,
                                      AbstractTensorInterface* tensor) {
   Tensor t = TensorFromInterface(tensor);
-  MutableAttrs()->Set(attr_name, t);
+  UnbindAndMutableAttrs()->Set(attr_name, t);
   return OkStatus();
 }
 
@@ -138,21 +138,21 @@ Status EagerOperation::SetAttrStringList(const char* attr_name,
   for (int i = 0; i < num_values; ++i) {
     v[i] = StringPiece(static_cast<const char*>(values[i]), lengths[i]);
   }
-  MutableAttrs()->Set(attr_name, v);
+  UnbindAndMutableAttrs()->Set(attr_name, v);
 
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrFloatList(const char* attr_name,
                                         const float* values, int num_values) {
-  MutableAttrs()->Set(attr_name,
+  UnbindAndMutableAttrs()->Set(attr_name,
                       gtl::ArraySlice<const float>(values, num_values));
   return OkStatus();
 }
 
 Status EagerOperation::SetAttrIntList(const char* attr_name,
                                       const int64_t* values, int num_values) {
-  MutableAttrs()->Set(
+  UnbindAndMutableAttrs()->Set(
       attr_name, gtl::ArraySlice<const int64_t>(
                      reinterpret_cast<const int64_t*>(values), num_values));
   return OkStatus();
@@ -160,7 +160,7 @@ Status EagerOperation::SetAttrIntList(const char* attr_name,
 
 Status EagerOperation::SetAttrTypeList(const char* attr_name,
                                        const DataType* values, int num_values) {
-  MutableAttrs()->Set(attr_name,
+  UnbindAndMutableAttrs()->Set(attr_name,
                       gtl::ArraySlice<const DataType>(values, num_values));
   return OkStatus();
 }
@@ -172,7 +172,7 @@ Status EagerOperation::SetAttrBoolList(const char* attr_name,
   for (int i = 0; i < num_values; ++i) {
     b[i] = values[i];
   }
-  MutableAttrs()->Set(attr_name,
+  UnbindAndMutableAttrs()->Set(attr_name,
                       gtl::ArraySlice<const bool>(b.get(), num_values));
   return OkStatus();
 }
@@ -200,7 +200,7 @@ Status EagerOperation::SetAttrShapeList(const char* attr_name,
       }
     }
   }
-  MutableAttrs()->Set(
+  UnbindAndMutableAttrs()->Set(
       attr_name, gtl::ArraySlice<TensorShapeProto>(proto.get(), num_values));
   return OkStatus();
 }
@@ -214,7 +214,7 @@ Status EagerOperation::SetAttrFunctionList(
     funcs[i].set_name(value_operation->Name());
     value_operation->Attrs().FillAttrValueMap(funcs[i].mutable_attr());
   }
-  MutableAttrs()->Set(
+  UnbindAndMutableAttrs()->Set(
       attr_name, gtl::ArraySlice<const NameAttrList>(funcs.get(), num_values));
   return OkStatus();
 }
@@ -323,6 +323,7 @@ Status EagerOperation::Reset(
     const absl::optional<EagerFunctionParams> eager_func_params) {
   DCHECK(inputs_.empty());
   ClearInferenceState();
+  UnbindKernel();
   bool is_function = false;
   TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
 
@@ -474,6 +475,7 @@ Status EagerOperation::SetDeviceName(const char* c_name) {
     last_set_device_name_ = name;
     device_name_ = DeviceNameUtils::ParsedNameToString(device_parsed_name_);
     device_ = kVariantDeviceNull;
+    UnbindKernel();
   }
   return OkStatus();
 }
@@ -502,7 +504,8 @@ string VariantDeviceDebugString(VariantDevice device) {
 const AbstractOpAttrs* EagerOperation::GetOpAttrs() const { return &attrs_; }
 
 void EagerOperation::AddAttrs(const AbstractOpAttrs* op_attrs) {
-  attrs_.CopyAttributes(*(down_cast<const AttrBuilder*>(op_attrs)));
+  UnbindAndMutableAttrs()->CopyAttributes(
+      *(down_cast<const AttrBuilder*>(op_attrs)));
 }
 
 string EagerOperation::DebugString() const {
@@ -76,6 +76,9 @@ class EagerOperation : public ImmediateExecutionOperation {
   Status SetDeviceName(const char* name) override;
 
   void SetDevice(VariantDevice device) {
+    if (device != device_) {
+      UnbindKernel();
+    }
     device_ = device;
     device_name_ = std::visit(
         [](auto* device) { return device == nullptr ? "" : device->name(); },
@@ -174,6 +177,22 @@ class EagerOperation : public ImmediateExecutionOperation {
   AttrBuilder* MutableAttrs() { return &attrs_; }
   const AttrBuilder& Attrs() const { return attrs_; }
 
+  // A kernel that the last execution of this op resolved, bound to the op so
+  // that EagerExecute can run it again when the op is executed with new
+  // inputs, without resolving it again. Reset, and the changes of the device or
+  // of the attributes of the op, unbind it.
+  struct BoundKernel {
+    core::RefCountPtr<KernelAndDevice> kernel;
+    // The context policies that select the kernel, at the time it was bound.
+    bool allow_soft_placement;
+    bool run_eager_op_as_function;
+  };
+  const BoundKernel& bound_kernel() const { return bound_kernel_; }
+  void BindKernel(BoundKernel bound_kernel) {
+    bound_kernel_ = std::move(bound_kernel);
+  }
+  void UnbindKernel() { bound_kernel_.kernel.reset(); }
+
   // TensorHandleInputs and MutableTensorHandleInputs first check that all
   // inputs are TensorHandles, i.e. that there are no custom device inputs. They
   // return a bad status otherwise.
@@ -192,6 +211,7 @@ class EagerOperation : public ImmediateExecutionOperation {
   // This is useful if we want the EagerOperation to point to a different
   // function.
   void UpdateName(const string& name) {
+    UnbindKernel();
     op_name_ = name.c_str();
     attrs_.set_op_name(name);
   }
@@ -256,6 +276,12 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   const tensorflow::OpDef* GetOpDef(Status* status);
 
+  // Returns the attributes for the attribute setters, which unbind the kernel.
+  AttrBuilder* UnbindAndMutableAttrs() {
+    UnbindKernel();
+    return &attrs_;
+  }
+
   void ClearInferenceState() {
     op_def_ = nullptr;
     inference_arg_idx_ = 0;
@@ -309,6 +335,8 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   std::optional<EagerFunctionParams> eager_func_params_;
 
+  BoundKernel bound_kernel_;
+
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
   int inference_arg_idx_;  // arg definition index for the next input to be
@@ -32,6 +32,7 @@ limitations under the License.
 // Required for IS_MOBILE_PLATFORM
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/strings/str_replace.h"
 #include "tensorflow/core/common_runtime/arg_ret_placement.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
@@ -1611,28 +1612,22 @@ Status CreateUnshapedOutput(
 #endif  // !IS_MOBILE_PLATFORM
 }
 
-Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
-                        EagerOperation* op, TensorHandle** retvals) {
-  EagerExecutor& executor = op->Executor();
-  EagerContext& ctx = op->EagerContext();
+// Runs `kernel` on `inputs` with `executor`, or schedules it if the executor
+// is async. `release_inputs` is called once the inputs are no longer needed by
+// the caller, which allows them to be forwarded in async mode.
+Status AddOrExecuteKernel(
+    EagerContext& ctx, EagerExecutor& executor,
+    core::RefCountPtr<KernelAndDevice> kernel,
+    const absl::InlinedVector<TensorHandle*, 4>& inputs,
+    const std::optional<EagerFunctionParams>& eager_func_params,
+    CancellationManager* cancellation_manager,
+    const std::optional<ManagedStackTrace>& stack_trace,
+    absl::FunctionRef<void()> release_inputs, TensorHandle** retvals) {
   GraphCollector* graph_collector = nullptr;
   if (ctx.ShouldStoreGraphs()) {
     graph_collector = ctx.GetGraphCollector();
   }
   const int num_outputs = kernel->num_outputs();
-  std::optional<EagerFunctionParams> eager_func_params =
-      op->eager_func_params();
-  if (kernel->IsCrossProcess() && !eager_func_params.has_value()) {
-    // Create an eager op id for a cross-process function if not exist.
-#if defined(IS_MOBILE_PLATFORM)
-    return errors::Unimplemented(
-        "Cross-process functions are not supported on mobile devices.");
-#else   // !IS_MOBILE_PLATFORM
-    const int64_t op_id = ctx.RemoteMgr()->NextOpId();
-    eager_func_params = EagerFunctionParams{
-        op_id, /* is_component_function= */ false, /* step_id= */ std::nullopt};
-#endif  // !IS_MOBILE_PLATFORM
-  }
   if (executor.Async()) {
     const DataTypeVector& output_dtypes = kernel->output_dtypes();
     for (int i = 0, end = num_outputs; i < end; ++i) {
@@ -1648,16 +1643,13 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
                                  eager_func_params, &ctx, &retvals[i]));
       }
     }
-    const absl::InlinedVector<TensorHandle*, 4>* inputs;
-    TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
     auto node = std::make_unique<AsyncExecuteNode>(
-        &ctx, *inputs, eager_func_params, std::move(kernel), graph_collector,
-        op->GetCancellationManager(),
-        absl::Span<TensorHandle*>(retvals, num_outputs), op->GetStackTrace());
-    // Release the inputs from the eager operation since the AsyncExecuteNode
-    // would have taken ownership. This allows the inputs to be forwarded if
-    // possible.
-    op->Clear();
+        &ctx, inputs, eager_func_params, std::move(kernel), graph_collector,
+        cancellation_manager, absl::Span<TensorHandle*>(retvals, num_outputs),
+        stack_trace);
+    // Release the inputs from the caller since the AsyncExecuteNode would have
+    // taken ownership. This allows the inputs to be forwarded if possible.
+    release_inputs();
     // For async mode, execution order will make sure that all
     // input handles are ready before executing them.
     // TODO(b/137118203): Consider executing "cheap" kernels inline for
@@ -1667,21 +1659,140 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     for (int i = 0, end = num_outputs; i < end; ++i) {
       retvals[i] = nullptr;
     }
-    const absl::InlinedVector<TensorHandle*, 4>* inputs;
-    TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
-    ExecuteNode node(&ctx, *inputs, eager_func_params, kernel, graph_collector,
-                     op->GetCancellationManager(),
-                     {retvals, static_cast<size_t>(num_outputs)},
-                     op->GetStackTrace());
+    ExecuteNode node(&ctx, inputs, eager_func_params, kernel, graph_collector,
+                     cancellation_manager,
+                     {retvals, static_cast<size_t>(num_outputs)}, stack_trace);
     Status s = executor.SyncExecute(&node);
     // We release the inputs AFTER executing the operation in sync mode since
     // ExecuteNode does not increment the reference count and thus does not have
     // ownership of the inputs while executing.
-    op->Clear();
+    release_inputs();
     return s;
   }
 }
 
+Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
+                        EagerOperation* op, TensorHandle** retvals) {
+  EagerContext& ctx = op->EagerContext();
+  std::optional<EagerFunctionParams> eager_func_params =
+      op->eager_func_params();
+  if (kernel->IsCrossProcess() && !eager_func_params.has_value()) {
+    // Create an eager op id for a cross-process function if not exist.
+#if defined(IS_MOBILE_PLATFORM)
+    return errors::Unimplemented(
+        "Cross-process functions are not supported on mobile devices.");
+#else   // !IS_MOBILE_PLATFORM
+    const int64_t op_id = ctx.RemoteMgr()->NextOpId();
+    eager_func_params = EagerFunctionParams{
+        op_id, /* is_component_function= */ false, /* step_id= */ std::nullopt};
+#endif  // !IS_MOBILE_PLATFORM
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+  return AddOrExecuteKernel(ctx, op->Executor(), std::move(kernel), *inputs,
+                            eager_func_params, op->GetCancellationManager(),
+                            op->GetStackTrace(), [op]() { op->Clear(); },
+                            retvals);
+}
+
+void MaybeLogExecution(const EagerContext& ctx, const string& op_name,
+                       const KernelAndDevice& kernel) {
+  if (ctx.LogDevicePlacement() || VLOG_IS_ON(1)) {
+    string msg = strings::StrCat("Executing op ", op_name, " in device ",
+                                 kernel.device()->name());
+    if (!logging::LogToListeners(msg)) {
+      LOG(INFO) << msg;
+    }
+  }
+}
+
+// Returns whether `kernel`, resolved for `op`, can run `op` again when it is
+// executed with new inputs of the same dtypes and on the same devices. The
+// kernel of a function also depends on the dtypes and shapes of the resources
+// it takes, and small constant optimization folds the values of the inputs
+// into the kernel, neither of which ExecuteBoundKernel checks.
+bool CanBindKernel(const EagerOperation& op, KernelAndDevice& kernel) {
+  if (!op.IsLocal() || !std::holds_alternative<Device*>(op.Device()) ||
+      kernel.IsCrossProcess() || IsSmallConstantOptimizationEnabled(op)) {
+    return false;
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op.TensorHandleInputs(&inputs).ok()) {
+    return false;
+  }
+  for (const TensorHandle* handle : *inputs) {
+    if (handle->Type() == TensorHandle::PACKED ||
+        handle->Type() == TensorHandle::REMOTE) {
+      return false;
+    }
+  }
+  if (kernel.IsFunction()) {
+    for (DataType dtype : kernel.input_dtypes()) {
+      if (dtype == DT_RESOURCE) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Runs the kernel bound to `op` by its last execution on the new inputs of
+// `op`, which skips the rewrites, the placement, the attribute fingerprinting
+// and the kernel cache lookup of EagerLocalExecute. Only the dtypes and the
+// devices of the inputs are checked, and the inputs are not copied. If they
+// don't match the kernel, or the context policies that select the kernel have
+// changed, the kernel is unbound, `*ran` is false and `op` should go through
+// the regular path.
+Status ExecuteBoundKernel(EagerOperation* op, TensorHandle** retvals,
+                          int* num_retvals, bool* ran) {
+  *ran = false;
+  EagerContext& ctx = op->EagerContext();
+  const EagerOperation::BoundKernel& bound = op->bound_kernel();
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (bound.allow_soft_placement != ctx.AllowSoftPlacement() ||
+      bound.run_eager_op_as_function != ctx.RunEagerOpAsFunction() ||
+      bound.kernel->num_outputs() > *num_retvals ||
+      !op->TensorHandleInputs(&inputs).ok() ||
+      bound.kernel->num_inputs() != static_cast<int>(inputs->size())) {
+    op->UnbindKernel();
+    return OkStatus();
+  }
+  const DataTypeVector& input_dtypes = bound.kernel->input_dtypes();
+  for (int i = 0, end = inputs->size(); i < end; ++i) {
+    TensorHandle* handle = (*inputs)[i];
+    if (handle->dtype != input_dtypes[i] ||
+        handle->Type() == TensorHandle::PACKED ||
+        handle->DeviceOrHostCPU(ctx) != bound.kernel->InputDevice(i)) {
+      op->UnbindKernel();
+      return OkStatus();
+    }
+  }
+  *ran = true;
+  profiler::TraceMe activity(
+      [&] { return absl::StrCat("ExecuteBoundKernel: ", op->Name()); },
+      profiler::TraceMeLevel::kInfo);
+  TF_RETURN_IF_ERROR(op->Executor().status());
+
+  bound.kernel->Ref();
+  core::RefCountPtr<KernelAndDevice> kernel(bound.kernel.get());
+  const int num_outputs = kernel->num_outputs();
+  *num_retvals = num_outputs;
+  MaybeLogExecution(ctx, op->Name(), *kernel);
+  Status s = AddOrExecuteKernel(
+      ctx, op->Executor(), std::move(kernel), *inputs, op->eager_func_params(),
+      op->GetCancellationManager(), op->GetStackTrace(),
+      [op]() { op->Clear(); }, retvals);
+  if (!s.ok()) {
+    for (int i = 0; i < num_outputs; ++i) {
+      if (retvals[i] != nullptr) {
+        retvals[i]->Unref();
+        retvals[i] = nullptr;
+      }
+    }
+  }
+  return s;
+}
+
 // There are a lot of references to devices in this function and around.
 // Here is what they mean:
 //  EagerOperation::Device(): The device on which the user requested the op
@@ -1696,8 +1807,11 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
 //    runtime. In this case, we don't select a device because running
 //    a function with explicitly requested device has different behavior than
 //    running without an explicitly requested device.
+//
+// If `bind_kernel` is true and the kernel can run `op` again with new inputs,
+// the kernel is bound to `op` for ExecuteBoundKernel.
 Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
-                         int* num_retvals) {
+                         int* num_retvals, bool bind_kernel = false) {
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op->op_name(), op->eager_func_params().has_value()
                          ? op->eager_func_params().value().step_id.value_or(0)
@@ -1728,6 +1842,8 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
   TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
       EagerOpRewriteRegistry::POST_PLACEMENT, op, &out_op));
   if (out_op) {
+    // A bound kernel skips the rewrites, so it must not depend on them.
+    bind_kernel = false;
     op = out_op.get();
     // If the out op doesn't have device, either because it is a new op or
     // the op wasn't placed successfully, then we do the placement again.
@@ -1740,12 +1856,12 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
   int num_outputs = kernel->num_outputs();
   TF_RETURN_IF_ERROR(ValidateInputTypeAndPlacement(&ctx, op, kernel));
 
-  if (ctx.LogDevicePlacement() || VLOG_IS_ON(1)) {
-    string msg = strings::StrCat("Executing op ", op->Name(), " in device ",
-                                 kernel->device()->name());
-    if (!logging::LogToListeners(msg)) {
-      LOG(INFO) << msg;
-    }
+  MaybeLogExecution(ctx, op->Name(), *kernel);
+
+  if (bind_kernel && CanBindKernel(*op, *kernel)) {
+    kernel->Ref();
+    op->BindKernel({core::RefCountPtr<KernelAndDevice>(kernel.get()),
+                    ctx.AllowSoftPlacement(), ctx.RunEagerOpAsFunction()});
   }
 
   Status s = AddOrExecuteNode(std::move(kernel), op, retvals);
@@ -2106,16 +2222,24 @@ Status DoEagerExecute(EagerOperation* op, TensorHandle** retvals,
     op->Executor().ClearError();
   }
 
+  if (op->bound_kernel().kernel != nullptr) {
+    bool ran;
+    Status s = ExecuteBoundKernel(op, retvals, num_retvals, &ran);
+    if (ran) return s;
+  }
+
   std::unique_ptr<tensorflow::EagerOperation> out_op;
   TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
       EagerOpRewriteRegistry::PRE_EXECUTION, op, &out_op));
 
   if (op->IsLocal()) {
+    // A bound kernel skips the rewrites, so it must not depend on them.
+    const bool bind_kernel = out_op == nullptr;
     if (out_op) {
       op = out_op.get();
     }
     TF_RETURN_IF_ERROR(MaybePackInputTensor(op));
-    return EagerLocalExecute(op, retvals, num_retvals);
+    return EagerLocalExecute(op, retvals, num_retvals, bind_kernel);
   }
 
 #if defined(IS_MOBILE_PLATFORM)
@@ -38,6 +38,10 @@ namespace tensorflow {
 //  Note that in the Async + Remote case, EagerExecute should still return
 //  quickly, but it will schedule the op to be executed remotely.
 //
+// A local op that is executed again with new inputs, without changing its
+// device or attributes, runs the kernel bound to it by its last execution (see
+// EagerOperation::bound_kernel) if the inputs have the same dtypes and devices.
+//
 // 'retvals' must point to a pre-allocated array of TensorHandle* and
 // '*num_retvals' should be set to the size of this array. It is an error if
 // the size of 'retvals' is less than the number of outputs. This call sets
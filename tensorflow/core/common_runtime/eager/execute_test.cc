@@ -410,5 +410,67 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, ReexecutedOpRunsBoundKernel) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+
+  auto make_handle = [ctx](Tensor tensor) {
+    return core::RefCountPtr<TensorHandle>(
+        down_cast<TensorHandle*>(ctx->CreateLocalHandleFromTFTensor(
+            tensor, ctx->HostCPUName().c_str())));
+  };
+  auto x = make_handle(test::AsScalar<int64_t>(3));
+  auto y = make_handle(test::AsScalar<int64_t>(2));
+  auto z = make_handle(test::AsScalar<int64_t>(5));
+  auto w = make_handle(test::AsScalar<float>(5));
+
+  auto op = std::make_unique<EagerOperation>(ctx);
+  TF_ASSERT_OK(op->Reset(
+      /*op=*/"Mul",
+      /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto execute = [&op](TensorHandle* a, TensorHandle* b, int64_t expected) {
+    TF_ASSERT_OK(op->AddInput(a));
+    TF_ASSERT_OK(op->AddInput(b));
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    ASSERT_EQ(num_retvals, 1);
+    const Tensor* result;
+    TF_ASSERT_OK(retvals[0]->Tensor(&result));
+    test::ExpectTensorEqual<int64_t>(*result,
+                                     test::AsScalar<int64_t>(expected));
+    retvals[0]->Unref();
+  };
+
+  execute(x.get(), y.get(), 6);
+  const KernelAndDevice* kernel = op->bound_kernel().kernel.get();
+  ASSERT_NE(kernel, nullptr);
+  execute(x.get(), z.get(), 15);
+  EXPECT_EQ(op->bound_kernel().kernel.get(), kernel);
+
+  // Changing the device of the op unbinds the kernel.
+  TF_ASSERT_OK(op->SetDeviceName("/job:localhost/replica:0/task:0/cpu:0"));
+  EXPECT_EQ(op->bound_kernel().kernel, nullptr);
+  execute(y.get(), z.get(), 10);
+  EXPECT_NE(op->bound_kernel().kernel, nullptr);
+
+  // Inputs of another dtype don't match the bound kernel, so the op goes
+  // through the regular path, which rejects them.
+  TF_ASSERT_OK(op->AddInput(x.get()));
+  TF_ASSERT_OK(op->AddInput(w.get()));
+  std::vector<TensorHandle*> retvals(1);
+  int num_retvals = retvals.size();
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      EagerExecute(op.get(), retvals.data(), &num_retvals)));
+  EXPECT_EQ(op->bound_kernel().kernel, nullptr);
+
+  op.reset();
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,161 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/node_hash_map.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/refcount.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A cache of reference counted kernels keyed by their fingerprint.
+//
+// The entries are spread over shards with their own locks, and lookups only
+// take a shared lock, so concurrent eager ops rarely contend on the cache.
+// If the capacity is positive, a shard that outgrows its share of the
+// capacity evicts its least recently used entries. An evicted kernel stays
+// alive while it is referenced elsewhere.
+template <typename T>
+class KernelCache {
+ public:
+  // A capacity of 0 means no limit.
+  explicit KernelCache(int64_t capacity = 0)
+      : shard_capacity_(capacity > 0
+                            ? std::max<int64_t>(
+                                  1, (capacity + kNumShards - 1) / kNumShards)
+                            : 0) {}
+
+  // Returns a new reference to the kernel cached for `key`, or null.
+  tsl::core::RefCountPtr<T> Lookup(const tsl::Fprint128& key) {
+    Shard& shard = GetShard(key);
+    tsl::tf_shared_lock l(shard.mu);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return nullptr;
+    it->second.last_use.store(
+        shard.clock.fetch_add(1, std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    it->second.kernel->Ref();
+    return tsl::core::RefCountPtr<T>(it->second.kernel.get());
+  }
+
+  // Caches `kernel` for `key`, replacing any kernel cached for it, and
+  // returns the number of entries evicted to stay within the capacity.
+  int64_t Add(const tsl::Fprint128& key, T* kernel) {
+    kernel->Ref();
+    tsl::core::RefCountPtr<T> new_ref(kernel);
+    Shard& shard = GetShard(key);
+    // The evicted kernels are released once the lock is released.
+    std::vector<tsl::core::RefCountPtr<T>> evicted;
+    {
+      tsl::mutex_lock l(shard.mu);
+      Entry& entry = shard.entries[key];
+      entry.kernel.swap(new_ref);
+      entry.last_use.store(shard.clock.fetch_add(1, std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+      if (shard_capacity_ > 0 && shard.entries.size() > shard_capacity_) {
+        Evict(shard, &evicted);
+      }
+    }
+    return evicted.size();
+  }
+
+  // Removes the kernel cached for `key`, if any.
+  void Erase(const tsl::Fprint128& key) {
+    tsl::core::RefCountPtr<T> erased;
+    Shard& shard = GetShard(key);
+    tsl::mutex_lock l(shard.mu);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return;
+    erased = std::move(it->second.kernel);
+    shard.entries.erase(it);
+  }
+
+  void Clear() {
+    for (Shard& shard : shards_) {
+      tsl::mutex_lock l(shard.mu);
+      shard.entries.clear();
+    }
+  }
+
+  int64_t Size() const {
+    int64_t size = 0;
+    for (const Shard& shard : shards_) {
+      tsl::tf_shared_lock l(shard.mu);
+      size += shard.entries.size();
+    }
+    return size;
+  }
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  struct Entry {
+    tsl::core::RefCountPtr<T> kernel;
+    // The value of the shard clock at the last use of the entry.
+    std::atomic<int64_t> last_use{0};
+  };
+
+  struct Shard {
+    mutable tsl::mutex mu;
+    // Node based, so that the entries, and their atomics, do not move.
+    absl::node_hash_map<tsl::Fprint128, Entry, tsl::Fprint128Hasher> entries
+        TF_GUARDED_BY(mu);
+    std::atomic<int64_t> clock{0};
+  };
+
+  Shard& GetShard(const tsl::Fprint128& key) {
+    // The low bits are used by the hash of the entries of a shard.
+    return shards_[key.high64 % kNumShards];
+  }
+
+  // Evicts the least recently used eighth of the capacity of `shard` at once,
+  // so that the cost of finding them is amortized over many additions.
+  void Evict(Shard& shard, std::vector<tsl::core::RefCountPtr<T>>* evicted)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    const size_t num_to_keep = shard_capacity_ - shard_capacity_ / 8;
+    std::vector<std::pair<int64_t, tsl::Fprint128>> uses;
+    uses.reserve(shard.entries.size());
+    for (const auto& entry : shard.entries) {
+      uses.emplace_back(entry.second.last_use.load(std::memory_order_relaxed),
+                        entry.first);
+    }
+    const size_t num_to_evict = uses.size() - num_to_keep;
+    std::nth_element(
+        uses.begin(), uses.begin() + num_to_evict, uses.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < num_to_evict; ++i) {
+      auto it = shard.entries.find(uses[i].second);
+      evicted->push_back(std::move(it->second.kernel));
+      shard.entries.erase(it);
+    }
+  }
+
+  const size_t shard_capacity_;
+  std::array<Shard, kNumShards> shards_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/kernel_cache.h"
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/refcount.h"
+
+namespace tensorflow {
+namespace {
+
+struct FakeKernel : public tsl::core::RefCounted {
+  explicit FakeKernel(int id) : id(id) {}
+  int id;
+};
+
+tsl::Fprint128 Key(uint64_t i) { return {i, i * 7}; }
+
+TEST(KernelCacheTest, LooksUpAddedKernels) {
+  KernelCache<FakeKernel> cache;
+  EXPECT_EQ(nullptr, cache.Lookup(Key(1)));
+  tsl::core::RefCountPtr<FakeKernel> kernel(new FakeKernel(1));
+  EXPECT_EQ(0, cache.Add(Key(1), kernel.get()));
+  EXPECT_FALSE(kernel->RefCountIsOne());
+  EXPECT_EQ(1, cache.Lookup(Key(1))->id);
+  EXPECT_EQ(1, cache.Size());
+
+  cache.Erase(Key(1));
+  EXPECT_EQ(nullptr, cache.Lookup(Key(1)));
+  EXPECT_TRUE(kernel->RefCountIsOne());
+}
+
+TEST(KernelCacheTest, ReplacesKernels) {
+  KernelCache<FakeKernel> cache;
+  tsl::core::RefCountPtr<FakeKernel> kernel1(new FakeKernel(1));
+  tsl::core::RefCountPtr<FakeKernel> kernel2(new FakeKernel(2));
+  cache.Add(Key(1), kernel1.get());
+  cache.Add(Key(1), kernel2.get());
+  EXPECT_TRUE(kernel1->RefCountIsOne());
+  EXPECT_EQ(2, cache.Lookup(Key(1))->id);
+  EXPECT_EQ(1, cache.Size());
+}
+
+TEST(KernelCacheTest, EvictsLeastRecentlyUsedKernels) {
+  // 16 shards of 8 entries.
+  KernelCache<FakeKernel> cache(/*capacity=*/128);
+  constexpr int kNumKeys = 1000;
+  int64_t num_evicted = 0;
+  for (int i = 0; i < kNumKeys; ++i) {
+    tsl::core::RefCountPtr<FakeKernel> kernel(new FakeKernel(i));
+    num_evicted += cache.Add(Key(i), kernel.get());
+    // Keeps using the first kernel.
+    ASSERT_NE(nullptr, cache.Lookup(Key(0)));
+  }
+  EXPECT_LE(cache.Size(), 128);
+  EXPECT_EQ(kNumKeys, cache.Size() + num_evicted);
+  EXPECT_EQ(0, cache.Lookup(Key(0))->id);
+  EXPECT_EQ(kNumKeys - 1, cache.Lookup(Key(kNumKeys - 1))->id);
+  EXPECT_EQ(nullptr, cache.Lookup(Key(1)));
+}
+
+TEST(KernelCacheTest, ClearsKernels) {
+  KernelCache<FakeKernel> cache;
+  tsl::core::RefCountPtr<FakeKernel> kernel(new FakeKernel(1));
+  cache.Add(Key(1), kernel.get());
+  cache.Add(Key(2), kernel.get());
+  cache.Clear();
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_TRUE(kernel->RefCountIsOne());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -65,8 +65,67 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// Keeps the memory of up to kMaxBlocks released tensor handles of a thread.
+class TensorHandleMemoryCache {
+ public:
+  TensorHandleMemoryCache() { blocks_.reserve(kMaxBlocks); }
+  ~TensorHandleMemoryCache() {
+    for (void* block : blocks_) {
+      ::operator delete(block);
+    }
+  }
+
+  void* Allocate() {
+    if (blocks_.empty()) return ::operator new(sizeof(TensorHandle));
+    void* block = blocks_.back();
+    blocks_.pop_back();
+    return block;
+  }
+
+  void Deallocate(void* block) {
+    if (blocks_.size() < kMaxBlocks) {
+      blocks_.push_back(block);
+    } else {
+      ::operator delete(block);
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxBlocks = 64;
+  std::vector<void*> blocks_;
+};
+
+// Returns the cache of the calling thread, or null while the thread exits.
+TensorHandleMemoryCache* ThreadTensorHandleMemoryCache() {
+  // Handles can still be released by the destructors of other thread locals
+  // after the cache is destroyed.
+  static thread_local bool destroyed = false;
+  struct Cache : public TensorHandleMemoryCache {
+    ~Cache() { destroyed = true; }
+  };
+  static thread_local Cache cache;
+  return destroyed ? nullptr : &cache;
+}
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  TensorHandleMemoryCache* cache = ThreadTensorHandleMemoryCache();
+  if (size != sizeof(TensorHandle) || cache == nullptr) {
+    return ::operator new(size);
+  }
+  return cache->Allocate();
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  TensorHandleMemoryCache* cache = ThreadTensorHandleMemoryCache();
+  if (size != sizeof(TensorHandle) || cache == nullptr) {
+    ::operator delete(ptr);
+    return;
+  }
+  cache->Deallocate(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
@@ -123,6 +123,11 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
                                               EagerContext* ctx);
 #endif  // IS_MOBILE_PLATFORM
 
+  // Tensor handles are allocated from a small per-thread cache of released
+  // handles, since eager ops create and release one for each output.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   // Templated struct `AutoReleaser` in
   // core/runtime_fallback/runtime/kernel_utils.h needs a Release() method
   // defined.
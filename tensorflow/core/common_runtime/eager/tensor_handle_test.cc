@@ -73,6 +73,22 @@ TEST(TensorHandle_ShapeTest, AsyncShape) {
   ctx->Unref();
 }
 
+TEST(TensorHandle_MemoryTest, ReusesMemoryOfReleasedHandles) {
+  TensorHandle* handle =
+      TensorHandle::CreateLocalHandle(Tensor(DT_FLOAT, TensorShape({2})));
+  const void* memory = handle;
+  handle->Unref();
+
+  // The memory of the released handle is reused by the next one.
+  handle = TensorHandle::CreateLocalHandle(Tensor(DT_INT32, TensorShape({3})));
+  EXPECT_EQ(memory, handle);
+  EXPECT_EQ(handle->DataType(), DT_INT32);
+  int64_t num_elements = -1;
+  TF_EXPECT_OK(handle->NumElements(&num_elements));
+  EXPECT_EQ(num_elements, 3);
+  handle->Unref();
+}
+
 static Device* CreateDevice(const char* type, const char* name,
                             bool is_local = true) {
   class FakeDevice : public Device {
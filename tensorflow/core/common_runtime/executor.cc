@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
 #include "absl/time/time.h"
@@ -34,7 +35,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/replay_propagator_state.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -78,6 +81,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
@@ -151,7 +155,8 @@ class ExecutorImpl : public Executor {
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             immutable_state_.params().session_metadata);
     return OkStatus();
   }
 
@@ -162,21 +167,90 @@ class ExecutorImpl : public Executor {
   friend class ExecutorState;
 
   // Stores execution time information about the kernels in an executor's graph.
+  //
+  // Also holds the always-on counters of the executor in monitoring, which are
+  // aggregated by session name and op type. Their cells are looked up once, and
+  // the per-kernel counters are only updated for a random sample of one kernel
+  // in kCounterSampleRate, which stands for kCounterSampleRate kernels. So most
+  // kernels neither read the clock nor touch a shared cache line for them.
   class KernelStats {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    void Initialize(const GraphView& gview,
+                    const SessionMetadata* session_metadata) {
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      const string session =
+          session_metadata != nullptr ? session_metadata->name() : "";
+      counters_.resize(gview.num_nodes());
+      absl::flat_hash_map<string, metrics::ExecutorKernelCounters> op_counters;
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
         }
+        if (gview.node(i) && gview.node(i)->kernel) {
+          const string& op = gview.node(i)->kernel->type_string();
+          auto [it, inserted] = op_counters.try_emplace(op);
+          if (inserted) {
+            it->second = metrics::GetExecutorKernelCounters(session, op);
+          }
+          counters_[i] = it->second;
+        }
       }
+      ready_nodes_sampler_ = metrics::GetExecutorReadyNodesSampler(session);
+      thread_pool_wait_sampler_ =
+          metrics::GetExecutorThreadPoolWaitSampler(session);
+      deferred_ops_counter_ = metrics::GetExecutorDeferredOpsCounter(session);
+      const double frequency = static_cast<double>(
+          profile_utils::CpuUtils::GetCycleCounterFrequency());
+      nsecs_per_cycle_ = frequency > 0 ? 1e9 / frequency : 0;
+    }
+
+    static constexpr int kCounterSampleRate = 16;
+
+    // Returns true for a random one in kCounterSampleRate calls, which decides
+    // whether the counters of the next kernel are updated. A per-thread
+    // xorshift generator keeps the decision free of shared state, and unlike
+    // taking every n-th kernel, does not alias with the period of a graph.
+    static bool SampleCounters() {
+      static thread_local uint32 state = 2463534242;
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state % kCounterSampleRate == 0;
+    }
+
+    // Returns the counters of the op type of the given node.
+    const metrics::ExecutorKernelCounters& counters(
+        const NodeItem& node) const {
+      return counters_[node.node_id];
+    }
+
+    // Adds a sampled kernel to `counter`.
+    static void RecordSampledKernel(monitoring::CounterCell* counter) {
+      counter->IncrementBy(kCounterSampleRate);
+    }
+
+    // Adds the time of a sampled synchronous kernel to the counters.
+    void RecordSampledKernelTime(const NodeItem& node,
+                                 uint64 elapsed_cycles) const {
+      counters_[node.node_id].kernel_time_nsecs->IncrementBy(
+          static_cast<int64_t>(elapsed_cycles * nsecs_per_cycle_ *
+                               kCounterSampleRate));
+    }
+
+    monitoring::SamplerCell* ready_nodes_sampler() const {
+      return ready_nodes_sampler_;
+    }
+    monitoring::SamplerCell* thread_pool_wait_sampler() const {
+      return thread_pool_wait_sampler_;
+    }
+    monitoring::CounterCell* deferred_ops_counter() const {
+      return deferred_ops_counter_;
     }
 
     // Returns true iff the given node is considered "expensive". The
@@ -210,6 +284,15 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Returns the number of bytes allocated from the step arena by the latest
+    // step, which is used to size the arena of the next step.
+    size_t step_arena_bytes() const {
+      return step_arena_bytes_.load(std::memory_order_relaxed);
+    }
+    void set_step_arena_bytes(size_t bytes) {
+      step_arena_bytes_.store(bytes, std::memory_order_relaxed);
+    }
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
@@ -221,6 +304,14 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    std::atomic<size_t> step_arena_bytes_{0};
+
+    // The counters of the op type of each node, indexed by node ID.
+    std::vector<metrics::ExecutorKernelCounters> counters_;
+    monitoring::SamplerCell* ready_nodes_sampler_ = nullptr;
+    monitoring::SamplerCell* thread_pool_wait_sampler_ = nullptr;
+    monitoring::CounterCell* deferred_ops_counter_ = nullptr;
+    double nsecs_per_cycle_ = 0;
   };
 
   ImmutableExecutorState immutable_state_;
@@ -304,12 +395,15 @@ class ExecutorState {
   void ProcessInline(TaggedNodeReadyQueue* inline_ready,
                      int64_t scheduled_nsec);
 
+  // `sample_counters` is whether the kernel updates the executor counters.
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
-                     EntryVector* outputs, NodeExecStatsInterface* stats);
+                     EntryVector* outputs, NodeExecStatsInterface* stats,
+                     bool sample_counters);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
                     NodeExecStatsInterface* stats,
-                    activity_watcher::ActivityId activity_id);
+                    activity_watcher::ActivityId activity_id,
+                    bool sample_counters);
   void ProcessNoop(NodeExecStatsInterface* stats);
   void ProcessConstTensor(const NodeItem& item, EntryVector* outputs,
                           NodeExecStatsInterface* stats);
@@ -394,6 +488,14 @@ class ExecutorState {
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
+  // If not null, the arena which serves the allocations of the step from
+  // `step_arena_base_allocator_`.
+  StepArenaAllocator* step_arena_allocator_ = nullptr;
+  Allocator* step_arena_base_allocator_ = nullptr;
+  // The allocators of the outputs of the nodes which are fetched into
+  // caller-owned memory (see `CallFrameInterface::GetRetvalAllocator`),
+  // indexed by output, by node ID.
+  absl::flat_hash_map<int, std::vector<Allocator*>> output_allocators_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
@@ -453,6 +555,28 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (immutable_state_.params().step_arena_allocation) {
+    step_arena_base_allocator_ =
+        immutable_state_.params().device->GetAllocator(AllocatorAttributes());
+    step_arena_allocator_ = new StepArenaAllocator(
+        step_arena_base_allocator_, kernel_stats_->step_arena_bytes());
+  }
+  if (call_frame_ != nullptr) {
+    for (const auto& it : immutable_state_.retval_outputs()) {
+      std::vector<Allocator*> allocators;
+      for (const auto& output_and_index : it.second) {
+        Allocator* allocator =
+            call_frame_->GetRetvalAllocator(output_and_index.second);
+        if (allocator == nullptr) continue;
+        allocators.resize(
+            immutable_state_.graph_view().node(it.first)->num_outputs);
+        allocators[output_and_index.first] = allocator;
+      }
+      if (!allocators.empty()) {
+        output_allocators_.emplace(it.first, std::move(allocators));
+      }
+    }
+  }
 }
 
 template <class PropagatorStateType>
@@ -460,6 +584,12 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
   if (device_context_) {
     device_context_->Unref();
   }
+  if (step_arena_allocator_) {
+    kernel_stats_->set_step_arena_bytes(
+        step_arena_allocator_->allocated_bytes());
+    // The tensors which outlive the step keep the arena alive.
+    step_arena_allocator_->Unref();
+  }
   delete slice_reader_cache_;
 }
 
@@ -472,17 +602,24 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c, int sample_rate) {
   alignas(64) static std::atomic<int64_t> num_dequeue_ops{0};
 
   auto n_enqueues = num_enqueue_ops.fetch_add(1, std::memory_order_relaxed);
-  // Sample the queue length on at least every 16 enqueue operations. This
-  // amortizes the cost of metric updates across 16 operations.
+  // Sample the queue length and the wait in the thread pool on at least every
+  // 16 enqueue operations. This amortizes the cost of metric updates across 16
+  // operations.
+  int64_t enqueue_nsec = 0;
   if (n_enqueues % std::max(16, sample_rate) == 0) {
     auto n_dequeues = num_dequeue_ops.load(std::memory_order_relaxed);
     metrics::UpdateGraphPendingQueueLength(n_enqueues - n_dequeues);
+    enqueue_nsec = EnvTime::NowNanos();
   }
 
   // mutable is needed because std::forward<Closure> in the lambda body may move
   // the Closure `c`.
-  runner_([c = std::forward<Closure>(c)]() mutable {
+  runner_([c = std::forward<Closure>(c), enqueue_nsec,
+           wait_sampler = kernel_stats_->thread_pool_wait_sampler()]() mutable {
     num_dequeue_ops.fetch_add(1, std::memory_order_relaxed);
+    if (enqueue_nsec != 0) {
+      wait_sampler->Add((EnvTime::NowNanos() - enqueue_nsec) / 1000.0);
+    }
     std::forward<Closure>(c)();
   });
 }
@@ -582,7 +719,7 @@ bool MightTrace(const tracing::EventCollector* event_collector,
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::ProcessSync(
     const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
-    NodeExecStatsInterface* stats) {
+    NodeExecStatsInterface* stats, bool sample_counters) {
   Status s;
   OpKernelContext ctx(params, item.num_outputs);
   nodestats::SetOpStart(stats);
@@ -591,6 +728,8 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
 
+  const uint64 start_cycles =
+      sample_counters ? profile_utils::CpuUtils::GetCurrentClockCycle() : 0;
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
                                  op_kernel->name_view());
@@ -615,6 +754,10 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (sample_counters) {
+    kernel_stats_->RecordSampledKernelTime(
+        item, profile_utils::CpuUtils::GetCurrentClockCycle() - start_cycles);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -626,11 +769,16 @@ template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ProcessAsync(
     const NodeItem& item, const OpKernelContext::Params& params,
     const TaggedNode& tagged_node, Entry* first_input,
-    NodeExecStatsInterface* stats, activity_watcher::ActivityId activity_id) {
+    NodeExecStatsInterface* stats, activity_watcher::ActivityId activity_id,
+    bool sample_counters) {
   AsyncOpKernel* async_kernel = item.kernel->AsAsync();
   DCHECK(async_kernel != nullptr);
   AsyncState* state =
       new AsyncState(params, tagged_node, &item, first_input, stats);
+  if (sample_counters) {
+    ExecutorImpl::KernelStats::RecordSampledKernel(
+        kernel_stats_->counters(item).async_kernels);
+  }
 
   nodestats::SetOpStart(stats);
 
@@ -774,7 +922,10 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
   params->stats_collector = stats_collector_;
+  params->step_arena_allocator = step_arena_allocator_;
+  params->step_arena_base_allocator = step_arena_base_allocator_;
   params->inc_num_deferred_ops_function = [this]() {
+    kernel_stats_->deferred_ops_counter()->IncrementBy(1);
     mutex_lock lock(num_deferred_ops_mu_);
     num_deferred_ops_++;
   };
@@ -804,6 +955,9 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   bool completed = false;
   int64_t last_iter_num = -1;
   std::unique_ptr<profiler::TraceMeConsumer> iteration_scope;
+  // The first node was scheduled on the thread pool, and the others were made
+  // ready by the nodes before them on this thread.
+  bool scheduled = true;
   while (!inline_ready->empty()) {
     TaggedNode tagged_node = inline_ready->front();
 
@@ -828,6 +982,15 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
     inline_ready->pop_front();
     const NodeItem& item = tagged_node.get_node_item();
     const int id = item.node_id;
+    const bool sample_counters = !tagged_node.get_is_dead() &&
+                                 ExecutorImpl::KernelStats::SampleCounters();
+    if (sample_counters) {
+      const metrics::ExecutorKernelCounters& counters =
+          kernel_stats_->counters(item);
+      ExecutorImpl::KernelStats::RecordSampledKernel(
+          scheduled ? counters.scheduled_kernels : counters.inline_kernels);
+    }
+    scheduled = false;
 
     propagator_.MaybeMarkStarted(tagged_node);
     const activity_watcher::ActivityId activity_id =
@@ -912,6 +1075,14 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
+      params->output_allocator_array = nullptr;
+      if (TF_PREDICT_FALSE(item.is_any_consumer_retval) &&
+          !output_allocators_.empty()) {
+        auto it = output_allocators_.find(item.node_id);
+        if (it != output_allocators_.end()) {
+          params->output_allocator_array = it->second.data();
+        }
+      }
       params->forward_from_array = item.forward_from();
       params->outputs_required_array = item.outputs_required.get();
       params->inputs = *inputs;
@@ -919,10 +1090,10 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       if (item.kernel_is_async) {
         ProcessAsync(item, *params, tagged_node, first_input, stats,
-                     activity_id);
+                     activity_id, sample_counters);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, params.get(), &outputs, stats);
+        s = ProcessSync(item, params.get(), &outputs, stats, sample_counters);
       }
     }
 
@@ -1273,11 +1444,29 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  // Sample the number of ready nodes on a random one in 16 calls, which
+  // amortizes the cost of the metric update without a shared call counter.
+  if (ExecutorImpl::KernelStats::SampleCounters()) {
+    kernel_stats_->ready_nodes_sampler()->Add(ready->size());
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  if (immutable_state_.has_critical_path_lengths() && ready->size() > 1) {
+    // Dispatch the nodes on the longest paths to the end of the graph first,
+    // so that they are not delayed behind nodes which have slack.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [this](const TaggedNode& a, const TaggedNode& b) {
+                       return immutable_state_.critical_path_length(
+                                  *a.node_item) >
+                              immutable_state_.critical_path_length(
+                                  *b.node_item);
+                     });
+  }
+
   if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
@@ -1512,6 +1701,10 @@ void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
+  } else if (!immutable_state_.replay_schedule().empty()) {
+    (new ExecutorState<ReplayPropagatorState>(args, immutable_state_,
+                                              &kernel_stats_))
+        ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
     (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
         ->RunAsync(std::move(done));
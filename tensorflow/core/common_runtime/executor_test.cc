@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -47,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -77,11 +80,24 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
+  // The `LocalExecutorParams` options used by the tests.
+  struct CreateOptions {
+    bool critical_path_scheduling = false;
+    bool step_graph_replay = false;
+    bool step_arena_allocation = false;
+    const SessionMetadata* session_metadata = nullptr;
+  };
+
   // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  void Create(std::unique_ptr<const Graph> graph,
+              const CreateOptions& options = {}) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.critical_path_scheduling = options.critical_path_scheduling;
+    params.step_graph_replay = options.step_graph_replay;
+    params.step_arena_allocation = options.step_arena_allocation;
+    params.session_metadata = options.session_metadata;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -266,6 +282,23 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeCriticalPathScheduling) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  CreateOptions options;
+  options.critical_path_scheduling = true;
+  Create(std::move(g), options);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -303,6 +336,88 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
 }
 #endif
 
+TEST_F(ExecutorTest, StepGraphReplay) {
+  // x0 = 1
+  // x{i+1} = (x{i} + 1) + (x{i} + 1)
+  //
+  // out <- x10
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto one = test::graph::Constant(g.get(), V(1.0));
+  Node* x = one;
+  for (int i = 0; i < 10; ++i) {
+    auto a = test::graph::Add(g.get(), x, one);
+    auto b = test::graph::Add(g.get(), x, one);
+    x = test::graph::Add(g.get(), a, b);
+  }
+  test::graph::Send(g.get(), x, "out", ALICE, kIncarnation, BOB);
+  CreateOptions options;
+  options.step_graph_replay = true;
+  Create(std::move(g), options);
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_EQ(3070.0, V(out));  // x{i} = 3 * 2^i - 2
+    rendez->Unref();
+  }
+}
+
+TEST_F(ExecutorTest, StepArenaAllocation) {
+  // x0 = 1
+  // x{i+1} = (x{i} + 1) + (x{i} + 1)
+  //
+  // out <- x10
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto one = test::graph::Constant(g.get(), V(1.0));
+  Node* x = one;
+  for (int i = 0; i < 10; ++i) {
+    auto a = test::graph::Add(g.get(), x, one);
+    auto b = test::graph::Add(g.get(), x, one);
+    x = test::graph::Add(g.get(), a, b);
+  }
+  test::graph::Send(g.get(), x, "out", ALICE, kIncarnation, BOB);
+  CreateOptions options;
+  options.step_arena_allocation = true;
+  Create(std::move(g), options);
+  std::vector<Tensor> outs;
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    rendez->Unref();
+    // The outputs outlive their steps.
+    outs.push_back(out);
+  }
+  for (const Tensor& out : outs) {
+    EXPECT_EQ(3070.0, V(out));  // x{i} = 3 * 2^i - 2
+  }
+}
+
+TEST_F(ExecutorTest, StepGraphReplayUnsupportedGraph) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(64, g.get());
+  CreateOptions options;
+  options.step_graph_replay = true;
+  Create(std::move(g), options);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(64.0, V(out));
+}
+
 TEST_F(ExecutorTest, SimpleSwitchLive) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -440,6 +555,48 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+TEST_F(ExecutorTest, ExportsSampledKernelCounters) {
+  constexpr int kChainLength = 100;
+  constexpr int kNumRuns = 100;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* node = test::graph::Constant(g.get(), V(1.0));
+  for (int i = 0; i < kChainLength; ++i) {
+    node = test::graph::Identity(g.get(), node);
+  }
+  FixupSourceAndSinkEdges(g.get());
+  SessionMetadata session_metadata;
+  session_metadata.set_name("executor_counters_test");
+  CreateOptions options;
+  options.session_metadata = &session_metadata;
+  Create(std::move(g), options);
+
+  monitoring::testing::CellReader<int64_t> kernels(
+      "/tensorflow/core/executor/kernels");
+  monitoring::testing::CellReader<int64_t> kernel_time(
+      "/tensorflow/core/executor/kernel_time_nsecs");
+  monitoring::testing::CellReader<int64_t> async_kernels(
+      "/tensorflow/core/executor/async_kernels");
+  for (int i = 0; i < kNumRuns; ++i) {
+    TF_ASSERT_OK(Run(rendez_));
+  }
+
+  // A random one kernel in 16 is counted, as 16 kernels. With 10000 kernels,
+  // the standard deviation of the estimate is about 4% of the count, so it
+  // misses by more than 20% with a probability of less than 1e-6.
+  const int64_t inline_kernels =
+      kernels.Delta("executor_counters_test", "Identity", "inline");
+  const int64_t scheduled_kernels =
+      kernels.Delta("executor_counters_test", "Identity", "scheduled");
+  EXPECT_EQ(inline_kernels % 16, 0);
+  EXPECT_EQ(scheduled_kernels % 16, 0);
+  EXPECT_NEAR(inline_kernels + scheduled_kernels, kChainLength * kNumRuns,
+              kChainLength * kNumRuns / 5);
+  // Each Identity is made ready by the kernel before it, and runs inline.
+  EXPECT_GT(inline_kernels, scheduled_kernels);
+  EXPECT_GT(kernel_time.Delta("executor_counters_test", "Identity"), 0);
+  EXPECT_EQ(async_kernels.Delta("executor_counters_test", "Identity"), 0);
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
@@ -521,6 +678,26 @@ BENCHMARK(BM_const_identity)
     ->ArgPair(100, 1)
     ->ArgPair(100, 100);
 
+// A chain of 'length' inexpensive kernels, which run inline one after the
+// other. Measures the per-kernel overhead of the executor, including the
+// always-on counters.
+static void BM_identity_chain(::testing::benchmark::State& state) {
+  const int length = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node = test::graph::Constant(g, Tensor(1.0f));
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Identity(g, node);
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetLabel(strings::StrCat("Nodes = ", length + 1));
+  state.SetItemsProcessed((length + 1) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_identity_chain)->UseRealTime()->Arg(16)->Arg(1024);
+
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
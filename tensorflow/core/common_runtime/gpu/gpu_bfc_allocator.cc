@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "tsl/framework/bfc_allocator.h"
 #include "tsl/platform/logging.h"
+#include "tsl/util/env_var.h"
 
 namespace tensorflow {
 
@@ -80,6 +81,19 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+size_t GetMemoryEventHistorySize() {
+  int64_t history_size = 0;
+  Status status = tsl::ReadInt64FromEnvVar(
+      "TF_GPU_BFC_MEMORY_EVENT_HISTORY_SIZE", 0, &history_size);
+  if (!status.ok() || history_size < 0) {
+    LOG(ERROR) << "The TF_GPU_BFC_MEMORY_EVENT_HISTORY_SIZE environment "
+               << "variable is set but could not be parsed as a non-negative "
+               << "integer. Not recording memory events.";
+    return 0;
+  }
+  return history_size;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(
@@ -95,6 +109,14 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.compaction_fragmentation_threshold =
+            opts.compaction_fragmentation_threshold;
+        o.release_idle_memory_micros = opts.release_idle_memory_micros;
+        if (opts.memory_event_history_size.has_value()) {
+          o.memory_event_history_size = *opts.memory_event_history_size;
+        } else {
+          o.memory_event_history_size = GetMemoryEventHistorySize();
+        }
         return o;
       }()) {}
 
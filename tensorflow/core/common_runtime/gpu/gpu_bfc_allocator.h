@@ -45,6 +45,14 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
     std::optional<bool> garbage_collection;
 
     double fragmentation_fraction = 0;
+    // See BFCAllocator::Options::compaction_fragmentation_threshold.
+    double compaction_fragmentation_threshold = 0;
+    // See BFCAllocator::Options::release_idle_memory_micros.
+    int64_t release_idle_memory_micros = 0;
+    // See BFCAllocator::Options::memory_event_history_size. If nullopt,
+    // defaults to TF_GPU_BFC_MEMORY_EVENT_HISTORY_SIZE, or 0 if that envvar is
+    // not present.
+    std::optional<size_t> memory_event_history_size;
     bool allow_retry_on_failure = true;
   };
 
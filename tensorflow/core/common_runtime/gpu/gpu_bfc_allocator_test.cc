@@ -19,7 +19,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
 #include <algorithm>
+#include <limits>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "xla/stream_executor/gpu/gpu_driver.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tsl/platform/test_benchmark.h"
 #include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
+#include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
 
 namespace tsl {
 namespace {
@@ -228,6 +231,124 @@ TEST_P(GPUBFCAllocatorTest, ExerciseCoalescing) {
   a.DeallocateRaw(first_ptr_after);
 }
 
+TEST_P(GPUBFCAllocatorTest, CompactMovesAllocationsDown) {
+  GPUBFCAllocator::Options options;
+  options.compaction_fragmentation_threshold = 0.1;
+  // The four allocations fill the memory.
+  constexpr size_t kSize = 2 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 4 * kSize, "GPU_0_bfc", options);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(64, kSize));
+  }
+  EXPECT_FALSE(a.ShouldCompact());
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[2]);
+  EXPECT_TRUE(a.ShouldCompact());
+
+  // An allocation that cannot be relocated stays where it is.
+  auto refuse = [](void*, const void*, size_t) { return false; };
+  EXPECT_EQ(0, a.Compact({ptrs[3]}, refuse));
+  EXPECT_EQ(kSize, a.RequestedSize(ptrs[3]));
+
+  // The highest allocation moves to the lowest free chunk.
+  std::vector<std::pair<void*, const void*>> moves;
+  auto relocate = [&moves](void* dst, const void* src, size_t num_bytes) {
+    EXPECT_EQ(kSize, num_bytes);
+    moves.emplace_back(dst, src);
+    return true;
+  };
+  EXPECT_EQ(kSize, a.Compact({ptrs[1], ptrs[3]}, relocate));
+  ASSERT_EQ(1, moves.size());
+  EXPECT_EQ(ptrs[0], moves[0].first);
+  EXPECT_EQ(ptrs[3], moves[0].second);
+  EXPECT_EQ(kSize, a.RequestedSize(ptrs[0]));
+  EXPECT_EQ(2 * kSize, a.GetStats()->bytes_in_use);
+  EXPECT_FALSE(a.ShouldCompact());
+
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[1]);
+  EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+}
+
+TEST_P(GPUBFCAllocatorTest, ReleaseFreeMemoryAtEndOfRegions) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  // The allocations take 2MiB and 8MiB from the sub-allocator.
+  void* small = a.AllocateRaw(64, 1 << 20);
+  void* large = a.AllocateRaw(64, 8 << 20);
+  EXPECT_EQ(10 << 20, *a.GetStats()->pool_bytes);
+  EXPECT_EQ(0, a.ReleaseFreeMemory(std::numeric_limits<size_t>::max()));
+
+  a.DeallocateRaw(large);
+  EXPECT_EQ(8 << 20, a.ReleaseFreeMemory(1));
+  EXPECT_EQ(2 << 20, *a.GetStats()->pool_bytes);
+  EXPECT_EQ(0, a.ReleaseFreeMemory(std::numeric_limits<size_t>::max()));
+
+  // The allocator grows back.
+  large = a.AllocateRaw(64, 8 << 20);
+  EXPECT_NE(nullptr, large);
+  a.DeallocateRaw(large);
+  a.DeallocateRaw(small);
+}
+
+TEST_P(GPUBFCAllocatorTest, ReleaseIdleMemory) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.release_idle_memory_micros = 1000;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  void* small = a.AllocateRaw(64, 1 << 20);
+  void* large = a.AllocateRaw(64, 8 << 20);
+  a.DeallocateRaw(large);
+  EXPECT_EQ(10 << 20, *a.GetStats()->pool_bytes);
+
+  // The memory of `large` is released once it is idle, when memory is freed.
+  Env::Default()->SleepForMicroseconds(2000);
+  a.DeallocateRaw(a.AllocateRaw(64, 256));
+  EXPECT_EQ(2 << 20, *a.GetStats()->pool_bytes);
+  a.DeallocateRaw(small);
+}
+
+TEST_P(GPUBFCAllocatorTest, RecordsMemoryEvents) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.memory_event_history_size = 4;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  void* large;
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("MatMul", 7);
+    large = a.AllocateRaw(64, 1 << 20);
+  }
+  MemoryDump md = a.RecordMemoryMap();
+  ASSERT_EQ(2, md.event_size());
+  EXPECT_EQ(tensorflow::MemEvent::EXTEND, md.event(0).type());
+  EXPECT_EQ(2 << 20, md.event(0).size());
+  EXPECT_EQ(2 << 20, md.event(0).pool_bytes());
+  EXPECT_EQ(tensorflow::MemEvent::ALLOCATE, md.event(1).type());
+  EXPECT_EQ(reinterpret_cast<uint64>(large), md.event(1).address());
+  EXPECT_EQ(1 << 20, md.event(1).requested_size());
+  EXPECT_EQ("MatMul", md.event(1).op_name());
+  EXPECT_EQ(7, md.event(1).step_id());
+  EXPECT_EQ(1 << 20, md.event(1).bytes_in_use());
+
+  // Only the most recent events are kept.
+  void* small = a.AllocateRaw(64, 256);
+  a.DeallocateRaw(large);
+  a.DeallocateRaw(small);
+  md = a.RecordMemoryMap();
+  ASSERT_EQ(4, md.event_size());
+  EXPECT_EQ(tensorflow::MemEvent::ALLOCATE, md.event(0).type());
+  EXPECT_EQ("MatMul", md.event(0).op_name());
+  EXPECT_EQ(tensorflow::MemEvent::DEALLOCATE, md.event(3).type());
+  EXPECT_EQ(reinterpret_cast<uint64>(small), md.event(3).address());
+  EXPECT_EQ(0, md.event(3).bytes_in_use());
+  for (int i = 1; i < md.event_size(); ++i) {
+    EXPECT_LE(md.event(i - 1).timestamp_micros(),
+              md.event(i).timestamp_micros());
+  }
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocateZeroBufSize) {
   GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
   float* ptr = TypedAllocator::Allocate<float>(&a, 0, {});
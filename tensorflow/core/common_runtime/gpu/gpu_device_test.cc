@@ -606,6 +606,38 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, CopyPageableTensorsThroughStagingBuffers) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_accelerator_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  ASSERT_NE(nullptr, device_context->host_memory_allocator());
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  constexpr int kNumElements = 1 << 20;
+  Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+  // The tensors of cpu_allocator() are in pageable memory, so both copies are
+  // staged through the pinned host memory pool.
+  Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+  ASSERT_EQ(AllocatorMemoryType::kHostPageable, cpu_tensor.GetMemoryType());
+  auto input = cpu_tensor.flat<float>();
+  for (int i = 0; i < kNumElements; ++i) {
+    input(i) = i;
+  }
+  CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+  Tensor output_cpu_tensor(cpu_allocator(), DT_FLOAT,
+                           TensorShape({kNumElements}));
+  CopyGPUToCPU(&gpu_tensor, &output_cpu_tensor, device, device_context);
+  auto output = output_cpu_tensor.flat<float>();
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(input(i), output(i)) << " for index " << i;
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
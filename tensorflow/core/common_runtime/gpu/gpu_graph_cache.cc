@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+GpuGraphCache::GpuGraphCache(se::StreamExecutor* executor,
+                             const Options& options)
+    : executor_(executor), options_(options) {
+  CHECK_GT(options_.max_entries, 0);
+}
+
+GpuGraphCache::~GpuGraphCache() = default;
+
+/*static*/ uint64 GpuGraphCache::Key(absl::Span<const Tensor* const> tensors,
+                                     uint64 generation) {
+  uint64 key = generation;
+  for (const Tensor* tensor : tensors) {
+    key = Hash64Combine(key, tensor->dtype());
+    key = Hash64Combine(key, tensor->dims());
+    for (int64_t dim : tensor->shape().dim_sizes()) {
+      key = Hash64Combine(key, dim);
+    }
+    key = Hash64Combine(
+        key, reinterpret_cast<uintptr_t>(DMAHelper::base(tensor)));
+  }
+  return key;
+}
+
+GpuGraphCache::Entry* GpuGraphCache::GetEntry(uint64 key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    if (entries_.size() >= options_.max_entries) {
+      auto lru = entries_.begin();
+      for (auto entry_it = entries_.begin(); entry_it != entries_.end();
+           ++entry_it) {
+        if (entry_it->second.last_use < lru->second.last_use) {
+          lru = entry_it;
+        }
+      }
+      VLOG(2) << "Dropping the least recently used GPU graph " << lru->first;
+      // A command buffer that is still executing is freed once it completes.
+      entries_.erase(lru);
+    }
+    it = entries_.emplace(key, Entry()).first;
+  }
+  it->second.last_use = ++use_count_;
+  return &it->second;
+}
+
+Status GpuGraphCache::Run(uint64 key, se::Stream* stream, const Step& step) {
+  mutex_lock l(mu_);
+  Entry* entry = GetEntry(key);
+  if (entry->command_buffer != nullptr) {
+    ++num_replays_;
+    return executor_->Submit(stream, *entry->command_buffer);
+  }
+  if (entry->uncapturable || entry->num_runs < options_.num_warmup_runs) {
+    ++entry->num_runs;
+    return step(stream);
+  }
+
+  // The capture does not execute the work of the step, so it is submitted
+  // below, or the step is run eagerly if the capture fails.
+  auto command_buffer = se::CommandBuffer::Trace(
+      executor_,
+      [&step](se::Stream* trace_stream) { return step(trace_stream); },
+      se::CommandBuffer::Mode::kPrimary);
+  if (!command_buffer.ok()) {
+    LOG(WARNING) << "Failed to capture a GPU graph, running the step eagerly "
+                    "from now on: "
+                 << command_buffer.status();
+    entry->uncapturable = true;
+    return step(stream);
+  }
+  ++num_captures_;
+  entry->command_buffer =
+      std::make_unique<se::CommandBuffer>(std::move(command_buffer).value());
+  return executor_->Submit(stream, *entry->command_buffer);
+}
+
+void GpuGraphCache::Invalidate() {
+  mutex_lock l(mu_);
+  entries_.clear();
+}
+
+int64_t GpuGraphCache::num_captures() const {
+  mutex_lock l(mu_);
+  return num_captures_;
+}
+
+int64_t GpuGraphCache::num_replays() const {
+  mutex_lock l(mu_);
+  return num_replays_;
+}
+
+}  // namespace tensorflow
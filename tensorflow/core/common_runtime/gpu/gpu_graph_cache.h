@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xla/stream_executor/command_buffer.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Captures the GPU work of a step into a command buffer (a CUDA graph) and
+// replays it in later steps with the same key, so that the kernels of the step
+// are launched with one call instead of one per kernel.
+//
+// A step is a function that enqueues its work onto the stream it is given.
+// Each key is first run eagerly for Options::num_warmup_runs steps, so that
+// the lazy initialization of the kernels (e.g. library handles and
+// autotuning) happens outside of the capture. The next step is captured,
+// which does not execute its work, and then submitted. Later steps with the
+// key only submit the command buffer and do not call the step at all. If the
+// capture fails, e.g. because the step synchronizes with the host, the key is
+// run eagerly from then on.
+//
+// A command buffer refers to the device memory that was used during its
+// capture. So the step must be deterministic for its key, and only use device
+// memory that stays allocated at the same address for as long as the key is
+// cached: the tensors of the key, and any scratch memory that the caller keeps
+// alive. Keys from Key() include the addresses of the tensors, so a step that
+// gets a reallocated input or resource is captured again; Invalidate() drops
+// all command buffers, e.g. when the caller's scratch memory is released.
+class GpuGraphCache {
+ public:
+  struct Options {
+    // The number of eager steps of a key before it is captured.
+    int num_warmup_runs = 1;
+    // The maximum number of keys, beyond which the least recently used ones
+    // are dropped.
+    int max_entries = 16;
+  };
+
+  using Step = std::function<Status(se::Stream*)>;
+
+  GpuGraphCache(se::StreamExecutor* executor, const Options& options);
+  ~GpuGraphCache();
+
+  // Returns a key of a step from the dtypes, shapes and device addresses of
+  // the `tensors` it reads or writes, and a `generation` that the caller
+  // changes when anything else the step depends on changes.
+  static uint64 Key(absl::Span<const Tensor* const> tensors,
+                    uint64 generation = 0);
+
+  // Runs `step` for `key` on `stream`, by replaying or capturing it if
+  // possible. Steps of one cache are serialized.
+  Status Run(uint64 key, se::Stream* stream, const Step& step);
+
+  // Drops all command buffers.
+  void Invalidate();
+
+  int64_t num_captures() const;
+  int64_t num_replays() const;
+
+ private:
+  struct Entry {
+    int num_runs = 0;
+    // Set if the capture failed.
+    bool uncapturable = false;
+    std::unique_ptr<se::CommandBuffer> command_buffer;
+    int64_t last_use = 0;
+  };
+
+  // Returns the entry of `key`, dropping the least recently used entry if
+  // there are too many.
+  Entry* GetEntry(uint64 key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  se::StreamExecutor* const executor_;
+  const Options options_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t use_count_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_captures_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_replays_ TF_GUARDED_BY(mu_) = 0;
+
+  GpuGraphCache(const GpuGraphCache&) = delete;
+  void operator=(const GpuGraphCache&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
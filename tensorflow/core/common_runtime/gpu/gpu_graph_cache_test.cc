@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumElements = 256;
+
+class GpuGraphCacheTest : public ::testing::Test {
+ protected:
+  GpuGraphCacheTest()
+      : executor_(se::GPUMachineManager()->ExecutorForDevice(0).value()),
+        stream_(std::make_unique<se::Stream>(executor_)) {
+    stream_->Init();
+    src_ = executor_->AllocateArray<float>(kNumElements);
+    dst_ = executor_->AllocateArray<float>(kNumElements);
+  }
+
+  ~GpuGraphCacheTest() override {
+    executor_->Deallocate(&src_);
+    executor_->Deallocate(&dst_);
+  }
+
+  // Copies `value`s to src_, then runs the step, which copies src_ to dst_,
+  // and returns the first element of dst_.
+  float RunCopy(GpuGraphCache* cache, uint64 key, float value) {
+    std::vector<float> host(kNumElements, value);
+    stream_->ThenMemcpy(&src_, host.data(), kNumElements * sizeof(float));
+    TF_CHECK_OK(cache->Run(key, stream_.get(), [this](se::Stream* stream) {
+      ++num_step_calls_;
+      stream->ThenMemcpy(&dst_, src_, kNumElements * sizeof(float));
+      return stream->ok() ? OkStatus() : errors::Internal("Copy failed");
+    }));
+    stream_->ThenMemcpy(host.data(), dst_, kNumElements * sizeof(float));
+    TF_CHECK_OK(stream_->BlockHostUntilDone());
+    return host[0];
+  }
+
+  se::StreamExecutor* executor_;
+  std::unique_ptr<se::Stream> stream_;
+  se::DeviceMemory<float> src_;
+  se::DeviceMemory<float> dst_;
+  int num_step_calls_ = 0;
+};
+
+TEST_F(GpuGraphCacheTest, CapturesAndReplays) {
+  GpuGraphCache cache(executor_, GpuGraphCache::Options());
+  // Warm up, then capture.
+  EXPECT_EQ(1.0f, RunCopy(&cache, 1, 1.0f));
+  EXPECT_EQ(2.0f, RunCopy(&cache, 1, 2.0f));
+  EXPECT_EQ(2, num_step_calls_);
+  EXPECT_EQ(1, cache.num_captures());
+
+  // The replays copy the current values of src_ without calling the step.
+  EXPECT_EQ(3.0f, RunCopy(&cache, 1, 3.0f));
+  EXPECT_EQ(4.0f, RunCopy(&cache, 1, 4.0f));
+  EXPECT_EQ(2, num_step_calls_);
+  EXPECT_EQ(2, cache.num_replays());
+
+  // Another key is captured separately.
+  EXPECT_EQ(5.0f, RunCopy(&cache, 2, 5.0f));
+  EXPECT_EQ(6.0f, RunCopy(&cache, 2, 6.0f));
+  EXPECT_EQ(4, num_step_calls_);
+  EXPECT_EQ(2, cache.num_captures());
+
+  cache.Invalidate();
+  EXPECT_EQ(7.0f, RunCopy(&cache, 1, 7.0f));
+  EXPECT_EQ(5, num_step_calls_);
+}
+
+TEST_F(GpuGraphCacheTest, DropsLeastRecentlyUsedEntries) {
+  GpuGraphCache::Options options;
+  options.num_warmup_runs = 0;
+  options.max_entries = 2;
+  GpuGraphCache cache(executor_, options);
+  RunCopy(&cache, 1, 1.0f);
+  RunCopy(&cache, 2, 1.0f);
+  RunCopy(&cache, 1, 1.0f);
+  EXPECT_EQ(2, num_step_calls_);
+  // Drops key 2, which is captured again.
+  RunCopy(&cache, 3, 1.0f);
+  RunCopy(&cache, 1, 1.0f);
+  RunCopy(&cache, 2, 1.0f);
+  EXPECT_EQ(4, num_step_calls_);
+  EXPECT_EQ(4, cache.num_captures());
+}
+
+TEST_F(GpuGraphCacheTest, RunsUncapturableStepsEagerly) {
+  GpuGraphCache cache(executor_, GpuGraphCache::Options());
+  int num_calls = 0;
+  GpuGraphCache::Step step = [&num_calls](se::Stream* stream) {
+    ++num_calls;
+    // Synchronizing with the host is not allowed during a capture.
+    return stream->BlockHostUntilDone();
+  };
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(cache.Run(1, stream_.get(), step));
+  }
+  // The failed capture and the eager run of the step both call it.
+  EXPECT_EQ(5, num_calls);
+  EXPECT_EQ(0, cache.num_captures());
+}
+
+TEST(GpuGraphCacheKeyTest, DependsOnShapesAndAddresses) {
+  Tensor a(DT_FLOAT, TensorShape({2, 3}));
+  Tensor b(DT_FLOAT, TensorShape({2, 3}));
+  Tensor a_reshaped;
+  ASSERT_TRUE(a_reshaped.CopyFrom(a, TensorShape({3, 2})));
+  EXPECT_EQ(GpuGraphCache::Key({&a}), GpuGraphCache::Key({&a}));
+  EXPECT_NE(GpuGraphCache::Key({&a}), GpuGraphCache::Key({&b}));
+  EXPECT_NE(GpuGraphCache::Key({&a}), GpuGraphCache::Key({&a_reshaped}));
+  EXPECT_NE(GpuGraphCache::Key({&a}), GpuGraphCache::Key({&a}, 1));
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
+#include "tensorflow/core/common_runtime/thread_local_caching_allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tsl/framework/allocator.h"
@@ -207,6 +208,8 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          o.release_idle_memory_micros =
+              options.experimental().release_idle_memory_ms() * 1000;
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -244,6 +247,17 @@ Allocator* GPUProcessState::GetGPUAllocator(
           new se::GpuCudaMallocAsyncAllocator(platform_device_id, total_bytes);
     }
 
+    // Keeps the recently freed small chunks of the BFC allocator in per-thread
+    // caches, so that most allocations do not take its lock.
+    if (gpu_bfc_allocator != nullptr &&
+        options.experimental().thread_local_allocator_cache_bytes() > 0) {
+      ThreadLocalCachingAllocator::Options cache_options;
+      cache_options.max_bytes_per_thread =
+          options.experimental().thread_local_allocator_cache_bytes();
+      gpu_allocator =
+          new ThreadLocalCachingAllocator(gpu_allocator, cache_options);
+    }
+
     Allocator* recording_allocator = nullptr;
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
       ProcessState::MemDesc md;
@@ -41,6 +41,24 @@ TEST(GpuServingDeviceSelector, Basic) {
   EXPECT_EQ(reservation.device_index(), 0);
 }
 
+TEST(GpuServingDeviceSelector, LeastLoaded) {
+  GpuServingDeviceSelector selector(/*num_devices=*/3,
+                                    std::make_unique<LeastLoadedPolicy>());
+
+  const std::string program_fingerprint = "TensorFlow";
+  DeviceReservation reservation0 = selector.ReserveDevice(program_fingerprint);
+  DeviceReservation reservation1 = selector.ReserveDevice(program_fingerprint);
+  DeviceReservation reservation2 = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation0.device_index(), 0);
+  EXPECT_EQ(reservation1.device_index(), 1);
+  EXPECT_EQ(reservation2.device_index(), 2);
+
+  // Only device 1 is idle.
+  reservation1.reset();
+  DeviceReservation reservation3 = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation3.device_index(), 1);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
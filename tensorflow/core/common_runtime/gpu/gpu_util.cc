@@ -298,21 +298,37 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64_t total_bytes = gpu_tensor->TotalBytes();
+  void* dst_ptr = GetBase(cpu_tensor);
+  // A copy to pageable memory is staged by the GPU driver synchronously and in
+  // small chunks, so it goes through a buffer of the pinned host memory pool
+  // instead, which is reused once the copy completes.
+  void* staging_buffer = nullptr;
+  Allocator* host_memory_allocator = device_context->host_memory_allocator();
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    if (NeedStaging(cpu_tensor) && host_memory_allocator != nullptr) {
+      staging_buffer = host_memory_allocator->AllocateRaw(
+          tensorflow::Allocator::kAllocatorAlignment, total_bytes);
+    }
+    send_device_to_host_stream->ThenMemcpy(
+        staging_buffer != nullptr ? staging_buffer : dst_ptr, gpu_src_ptr,
+        total_bytes);
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_ref, staging_buffer, dst_ptr,
+       total_bytes, host_memory_allocator]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
         input_ref.Unref();
+        if (staging_buffer != nullptr) {
+          std::memcpy(dst_ptr, staging_buffer, total_bytes);
+          host_memory_allocator->DeallocateRaw(staging_buffer);
+        }
         done(OkStatus());
       });
 }
@@ -372,6 +388,11 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
+      // Leave the staging to the driver if the pool is exhausted.
+      do_staging = staging_buffer != nullptr;
+    }
+
+    if (do_staging) {
       std::memcpy(staging_buffer, src_ptr, total_bytes);
       input_ref.Unref();
 
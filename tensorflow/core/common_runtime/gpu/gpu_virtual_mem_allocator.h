@@ -65,8 +65,11 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // next_alloc_offset_. To accommodate this, the virtual_address_space_size
   // should be much larger than the max physical size of the allocator.
   //
-  // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
-  // this free function should never be invoked.
+  // In practice, the BFC allocator coalesces adjacent AllocationRegions, and
+  // only frees the allocations at the end of its regions when it releases their
+  // idle or reclaimed memory (see BFCAllocator::ReleaseFreeMemory), highest
+  // first, so that the physical memory is unmapped and the address range is
+  // mapped again when the allocator grows back.
   void Free(void* ptr, size_t num_bytes) override;
 
   bool SupportsCoalescing() const override { return true; }
@@ -626,6 +626,9 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
       OptimizationPassRegistry::PRE_PLACEMENT, optimization_options));
 
   if (run_placer_) {
+    tensorflow::metrics::ScopedCounter<2> placer_timings(
+        tensorflow::metrics::GetGraphOptimizationCounter(),
+        {"GraphSetup", "Placer"});
     Placer placer(new_graph.get(), "", flib_def_.get(), device_set_,
                   /* default_local_device= */ nullptr,
                   session_options_ == nullptr ||
@@ -653,7 +656,8 @@ Status GraphExecutionState::OptimizeGraph(
     const BuildGraphOptions& options, const Graph& graph,
     const FunctionLibraryDefinition* flib_def,
     std::unique_ptr<Graph>* optimized_graph,
-    std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
+    std::unique_ptr<FunctionLibraryDefinition>* optimized_flib,
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats) {
 #ifdef IS_MOBILE_PLATFORM
   return errors::InvalidArgument("Mobile platforms not supported");
 #else
@@ -814,9 +818,9 @@ Status GraphExecutionState::OptimizeGraph(
 
     // Now we can run the MetaOptimizer on the constructed GrapplerItem.
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(
-        grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+        std::move(item), session_options_->config, cpu_device, &cluster,
+        &new_graph, pass_stats));
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -872,8 +876,9 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   std::unique_ptr<Graph> optimized_graph;
   std::unique_ptr<FunctionLibraryDefinition> optimized_flib;
 
+  protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats> pass_stats;
   Status s = OptimizeGraph(options, *graph_, flib_def_.get(), &optimized_graph,
-                           &optimized_flib);
+                           &optimized_flib, &pass_stats);
   if (!s.ok()) {
     VLOG(2) << "Grappler optimization failed. Error: " << s.message();
     // Simply copy the original graph and the function library if we couldn't
@@ -970,6 +975,7 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
       new ClientGraph(std::move(optimized_flib), rewrite_metadata.feed_types,
                       rewrite_metadata.fetch_types, collective_graph_key));
   CopyGraph(*optimized_graph, &dense_copy->graph);
+  dense_copy->grappler_pass_stats.Swap(&pass_stats);
 
   // TODO(vrv): We should check invariants of the graph here.
   metrics::UpdateGraphBuildTime(Env::Default()->NowMicros() - start_time_usecs);
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 struct SessionOptions;
@@ -69,6 +70,9 @@ struct ClientGraph {
   DataTypeVector feed_types;
   DataTypeVector fetch_types;
   int64_t collective_graph_key;
+  // The results of the Grappler passes that optimized the graph.
+  protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>
+      grappler_pass_stats;
 };
 
 // GraphExecutionState is responsible for generating an
@@ -143,12 +147,16 @@ class GraphExecutionState {
   Status BuildGraph(const BuildGraphOptions& options,
                     std::unique_ptr<ClientGraph>* out);
 
-  // Optimize the graph with the node set specified in `options`.
+  // Optimize the graph with the node set specified in `options`. If
+  // `pass_stats` is non-null, the results of the Grappler passes are
+  // appended to it.
   Status OptimizeGraph(
       const BuildGraphOptions& options, const Graph& graph,
       const FunctionLibraryDefinition* flib_def,
       std::unique_ptr<Graph>* optimized_graph,
-      std::unique_ptr<FunctionLibraryDefinition>* optimized_flib);
+      std::unique_ptr<FunctionLibraryDefinition>* optimized_flib,
+      protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats =
+          nullptr);
 
   // The graph returned by BuildGraph may contain only the pruned
   // graph, whereas some clients may want access to the full graph.
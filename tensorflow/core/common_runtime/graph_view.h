@@ -81,6 +81,8 @@ struct NodeItem {
                                                      // of any output edge is a
                                                      // merge or control trigger
                                                      // node.
+  bool is_any_consumer_retval : 1;  // True iff the destination of any data
+                                    // output edge is a `_Retval` node.
   bool is_any_input_ref_typed : 1;  // True iff any IsRefType(dt) for dt in this
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
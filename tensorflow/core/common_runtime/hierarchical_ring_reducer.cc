@@ -0,0 +1,334 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns `a` modulo `n`, in [0, n).
+int Mod(int a, int n) { return ((a % n) + n) % n; }
+
+int IndexOf(const std::vector<int>& ring, int rank) {
+  return std::find(ring.begin(), ring.end(), rank) - ring.begin();
+}
+
+}  // namespace
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  absl::flat_hash_map<string, int> num_devices_per_task;
+  for (const CollGroupMember& member : col_params->group.members) {
+    ++num_devices_per_task[member.task];
+  }
+  const int num_devices = num_devices_per_task.begin()->second;
+  for (const auto& it : num_devices_per_task) {
+    if (it.second != num_devices) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices on "
+          "every task, but task ",
+          it.first, " has ", it.second, " devices instead of ", num_devices);
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s = RunSync();
+  if (!s.ok()) {
+    StartAbort(s);
+  }
+  ca_.reset();  // Give up Refs on output tensor.
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunSync() {
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  std::vector<int> local_ring;
+  std::vector<int> cross_ring;
+  MakeRings(&local_ring, &cross_ring);
+  const int rank = col_params_->default_rank;
+  const int num_tasks = cross_ring.size();
+  const int local_index = IndexOf(local_ring, rank);
+  const int task_index = IndexOf(cross_ring, rank);
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank " << rank
+          << " local_index " << local_index << " task_index " << task_index;
+
+  const int num_chunks = local_ring.size() * num_tasks;
+  chunk_elts_ = CollectiveAdapter::AlignedChunkElts(
+      DataTypeSize(col_ctx_->output->dtype()),
+      col_ctx_->output->NumElements(), num_chunks);
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_chunks,
+                                  col_ctx_->device->GetAllocator(attr)));
+
+  // Shard l is made of the T chunks that start at chunk l * T, and its chunk t
+  // is reduced by the device of task t.
+  const int shard = local_index * num_tasks;
+  TF_RETURN_IF_ERROR(RunRingPass("local_reduce", /*reduce=*/true, local_ring,
+                                 0, num_tasks));
+  TF_RETURN_IF_ERROR(RunRingPass("cross_reduce", /*reduce=*/true, cross_ring,
+                                 shard, 1));
+  if (col_params_->final_op) {
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    Tensor group_size_tensor;
+    if (col_params_->group.device_type != "CPU") {
+      group_size_tensor = ca_->Scalar(
+          col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+          AllocationAttributes());
+      Notification note;
+      Status status;
+      col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+          &group_size_val, col_ctx_->device, &group_size_tensor,
+          [&note, &status](const Status& s) {
+            status.Update(s);
+            note.Notify();
+          });
+      note.WaitForNotification();
+      TF_RETURN_IF_ERROR(status);
+    } else {
+      group_size_tensor = group_size_val;
+    }
+    Tensor chunk = ChunksAlias(shard + task_index, 1);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &chunk, &group_size_tensor));
+  }
+  TF_RETURN_IF_ERROR(RunRingPass("cross_gather", /*reduce=*/false, cross_ring,
+                                 shard, 1));
+  TF_RETURN_IF_ERROR(RunRingPass("local_gather", /*reduce=*/false, local_ring,
+                                 0, num_tasks));
+  ca_->ConsumeFinalValue(col_ctx_->output);
+  return OkStatus();
+}
+
+void HierarchicalRingReducer::MakeRings(std::vector<int>* local_ring,
+                                        std::vector<int>* cross_ring) {
+  // The tasks are ordered by their first device, and the devices of each task
+  // by their default rank, which every member of the group agrees on.
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  std::vector<string> tasks;
+  absl::flat_hash_map<string, std::vector<int>> task_ranks;
+  for (int r = 0; r < members.size(); ++r) {
+    std::vector<int>& ranks = task_ranks[members[r].task];
+    if (ranks.empty()) {
+      tasks.push_back(members[r].task);
+    }
+    ranks.push_back(r);
+  }
+  *local_ring = task_ranks[members[col_params_->default_rank].task];
+  const int local_index = IndexOf(*local_ring, col_params_->default_rank);
+  cross_ring->clear();
+  for (const string& task : tasks) {
+    cross_ring->push_back(task_ranks[task][local_index]);
+  }
+}
+
+Tensor HierarchicalRingReducer::ChunksAlias(int first_chunk, int num_chunks) {
+  const Tensor& value = ca_->Value();
+  const int64_t total_elts = value.NumElements();
+  const int64_t start = std::min(total_elts, first_chunk * chunk_elts_);
+  const int64_t end =
+      std::min(total_elts, (first_chunk + num_chunks) * chunk_elts_);
+  // As in CollectiveAdapter::ChunkAlias(), empty chunks are taken from the
+  // front of the tensor to avoid an illegal offset.
+  return (start < end) ? value.Slice(start, end) : value.Slice(0, 0);
+}
+
+Status HierarchicalRingReducer::RunRingPass(const string& pass, bool reduce,
+                                            const std::vector<int>& ring,
+                                            int first_chunk,
+                                            int chunks_per_piece) {
+  profiler::TraceMe activity(pass, profiler::TraceMeLevel::kInfo);
+  const int n = ring.size();
+  const int rank = col_params_->default_rank;
+  const int pos = IndexOf(ring, rank);
+  const int next = ring[Mod(pos + 1, n)];
+  const int prev = ring[Mod(pos - 1, n)];
+  auto piece = [this, first_chunk, chunks_per_piece](int p) {
+    return ChunksAlias(first_chunk + p * chunks_per_piece, chunks_per_piece);
+  };
+  // The piece received in step s, which is sent on in step s + 1. A
+  // reduce-scatter starts one piece earlier, so that each device ends up with
+  // its own piece.
+  auto recv_piece = [pos, n, reduce](int s) {
+    return Mod(pos - s - (reduce ? 2 : 1), n);
+  };
+
+  // The values received for a reduction need their own buffers. They are
+  // allocated up front, and on GPU the pass waits for the currently queued
+  // work of the compute stream, since the buffers are not guaranteed to be
+  // valid (e.g. for RDMA write) until it completes.
+  std::vector<Tensor> tmp_chunks;
+  if (reduce && n > 1) {
+    Allocator* allocator = col_ctx_->device->GetAllocator(
+        col_ctx_->op_ctx->output_alloc_attr(0));
+    for (int s = 0; s < n - 1; ++s) {
+      tmp_chunks.emplace_back(
+          allocator, col_ctx_->output->dtype(),
+          TensorShape({piece(recv_piece(s)).NumElements()}));
+    }
+    const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+        col_ctx_->device->tensorflow_accelerator_device_info();
+    if (gpu_info) {
+      Notification note;
+      TF_RETURN_IF_ERROR(gpu_info->default_context->ThenExecute(
+          col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); }));
+      note.WaitForNotification();
+    }
+  }
+
+  for (int s = 0; s < n - 1; ++s) {
+    Tensor send_chunk = piece(Mod(recv_piece(s) + 1, n));
+    Tensor recv_chunk = piece(recv_piece(s));
+    Tensor* recv_buf = reduce ? &tmp_chunks[s] : &recv_chunk;
+    mutex mu;
+    Status status;
+    BlockingCounter counter(2);
+    auto done = [this, &mu, &status, &counter](const Status& step_status) {
+      if (!step_status.ok()) {
+        // Unblocks the other transfers of this device and its peers.
+        StartAbort(step_status);
+      }
+      {
+        mutex_lock l(mu);
+        status.Update(step_status);
+      }
+      counter.DecrementCount();
+    };
+    DispatchSend(next, strings::StrCat(col_ctx_->exec_key, ":", pass, ":", s,
+                                       ":", rank, ":", next),
+                 &send_chunk, done);
+    DispatchRecv(prev, strings::StrCat(col_ctx_->exec_key, ":", pass, ":", s,
+                                       ":", prev, ":", rank),
+                 recv_buf, done);
+    counter.Wait();
+    TF_RETURN_IF_ERROR(status);
+    if (reduce) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &recv_chunk, &tmp_chunks[s]));
+    }
+  }
+  return OkStatus();
+}
+
+void HierarchicalRingReducer::DispatchSend(int target_rank, const string& key,
+                                           const Tensor* tensor,
+                                           const StatusCallback& done) {
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[target_rank].device.name(),
+      col_params_->group.members[target_rank].task, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+void HierarchicalRingReducer::DispatchRecv(int src_rank, const string& key,
+                                           Tensor* tensor,
+                                           const StatusCallback& done) {
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_rank].device.name(),
+      col_params_->group.members[src_rank].task,
+      col_params_->group.members[src_rank].is_local, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
+      0 /*dev_to_dev_stream_index*/, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  {
+    mutex_lock l(abort_mu_);
+    if (abort_started_) {
+      return;
+    }
+    abort_started_ = true;
+  }
+  LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+  CancellationManager* cancellation_manager =
+      col_ctx_->op_ctx->cancellation_manager();
+  if (cancellation_manager == nullptr ||
+      (!cancellation_manager->IsCancelled() &&
+       !cancellation_manager->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
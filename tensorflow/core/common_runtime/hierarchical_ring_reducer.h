@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// With T tasks of L devices, the tensor is split into L shards of T chunks.
+// The devices of each task first reduce-scatter the shards in a ring, so that
+// the l-th device of a task holds shard l reduced over its task. The l-th
+// devices of all tasks then all-reduce that shard in a ring across the tasks,
+// and finally the devices of each task all-gather the shards in a ring. So
+// only 2 * (T - 1) / T of a shard, instead of 2 * (T * L - 1) / (T * L) of the
+// tensor, leaves each device over the network, i.e. the cross-task traffic
+// drops by a factor of L compared to RingReducer.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer() = default;
+  ~HierarchicalRingReducer() override = default;
+
+  // Checks that every task has the same number of devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs the collective, blocking until it is done.
+  Status RunSync();
+
+  // Returns the ring of default ranks of the devices on the task of this
+  // device, and the ring of default ranks of the devices with the same index
+  // as this device on their tasks.
+  void MakeRings(std::vector<int>* local_ring, std::vector<int>* cross_ring);
+
+  // Returns an alias of `num_chunks` consecutive chunks of the output,
+  // starting at `first_chunk`.
+  Tensor ChunksAlias(int first_chunk, int num_chunks);
+
+  // Reduce-scatters or all-gathers over `ring` the pieces of
+  // `chunks_per_piece` consecutive chunks starting at `first_chunk`, one
+  // piece per device of the ring. After a reduce-scatter, the n-th device of
+  // the ring holds the reduced n-th piece. `pass` names the pass in keys.
+  Status RunRingPass(const string& pass, bool reduce,
+                     const std::vector<int>& ring, int first_chunk,
+                     int chunks_per_piece);
+
+  void DispatchSend(int target_rank, const string& key, const Tensor* tensor,
+                    const StatusCallback& done);
+  void DispatchRecv(int src_rank, const string& key, Tensor* tensor,
+                    const StatusCallback& done);
+
+  // Aborts the pending sends and receives of the collective executor, unless
+  // the op is being cancelled anyway. Only the first call has an effect.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // The number of elements of each chunk but the last ones.
+  int64_t chunk_elts_ = 0;
+  mutex abort_mu_;
+  bool abort_started_ TF_GUARDED_BY(abort_mu_) = false;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
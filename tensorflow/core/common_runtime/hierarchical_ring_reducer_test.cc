@@ -0,0 +1,123 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k =
+      CreateOpKernel(device->device_type(), device,
+                     device->GetAllocator(AllocatorAttributes()), node_def,
+                     TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  // Reduces tensors of `num_elements` over `num_workers` tasks with
+  // `num_devices` devices each, and checks that every device gets the mean.
+  void RunTest(int num_workers, int num_devices, int num_elements) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<Tensor> tensors;
+    std::vector<double> expected(num_elements, 0.0);
+    for (int r = 0; r < group_size; ++r) {
+      Tensor t(DT_DOUBLE, TensorShape({num_elements}));
+      for (int i = 0; i < num_elements; ++i) {
+        t.flat<double>()(i) = r * 100 + i;
+        expected[i] += (r * 100 + i) / static_cast<double>(group_size);
+      }
+      tensors.push_back(t);
+    }
+    BlockingCounter counter(group_size);
+    for (int r = 0; r < group_size; ++r) {
+      SchedClosure([this, &tensors, r, &counter]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, r, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+            DT_DOUBLE, tensors[r].shape());
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[r].device.name(), &device));
+        auto merge_op = GetBinOp("Add", DT_DOUBLE, device);
+        auto final_op = GetBinOp("Div", DT_DOUBLE, device);
+        col_params->merge_op = merge_op.get();
+        col_params->final_op = final_op.get();
+        TF_CHECK_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                  &tensors[r], &tensors[r]));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int r = 0; r < group_size; ++r) {
+      test::ExpectTensorNear<double>(
+          tensors[r],
+          test::AsTensor<double>(expected, TensorShape({num_elements})), 1e-9);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(HierarchicalRingReducerTest, MultipleTasks) { RunTest(2, 3, 17); }
+
+TEST_F(HierarchicalRingReducerTest, SingleTask) { RunTest(1, 4, 9); }
+
+TEST_F(HierarchicalRingReducerTest, SingleDevicePerTask) { RunTest(3, 1, 8); }
+
+TEST_F(HierarchicalRingReducerTest, FewerElementsThanChunks) {
+  RunTest(2, 4, 3);
+}
+
+TEST_F(HierarchicalRingReducerTest, RequiresSameNumberOfDevicesPerTask) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 2,
+                                      /*num_devices_per_worker*/ 2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, 0, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_DOUBLE, TensorShape({4}));
+  col_params->group.members.pop_back();
+  CollectiveImplementationInterface* collective_impl = nullptr;
+  TF_ASSERT_OK(
+      CollectiveRegistry::Lookup("HierarchicalRingReduce", &collective_impl));
+  core::ScopedUnref unref_collective_impl(collective_impl);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      collective_impl->InitializeCollectiveParams(col_params.get())));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/hierarchical_tree_broadcaster.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 // Set true for greater intelligibility of debug mode log messages.
 #define READABLE_KEYS false
@@ -43,13 +45,15 @@ namespace tensorflow {
 namespace {
 // Key to be used for BufRendezvous by Broadcaster.
 string BroadcastBufKey(const string& exec_key, int subdiv, int src_rank,
-                       int dst_rank) {
+                       int dst_rank, int chunk) {
   if (READABLE_KEYS) {
     return strings::StrCat("broadcast(", exec_key, "):subdiv(", subdiv,
-                           "):src(", src_rank, "):dst(", dst_rank, ")");
+                           "):src(", src_rank, "):dst(", dst_rank, "):chunk(",
+                           chunk, ")");
   } else {
     // TODO(b/78352018): Try a denser format, e.g. a 64 or 128 bit hash.
-    return strings::StrCat(exec_key, ":", subdiv, ":", src_rank, ":", dst_rank);
+    return strings::StrCat(exec_key, ":", subdiv, ":", src_rank, ":", dst_rank,
+                           ":", chunk);
   }
 }
 }  // namespace
@@ -58,7 +62,15 @@ HierarchicalTreeBroadcaster::HierarchicalTreeBroadcaster()
     : col_ctx_(nullptr),
       col_params_(nullptr),
       done_(nullptr),
-      is_source_(false) {}
+      is_source_(false) {
+  // All members of a group must use the same chunk size.
+  Status s = ReadInt64FromEnvVar("TF_COLLECTIVE_BROADCAST_CHUNK_BYTES",
+                                 kDefaultChunkBytes, &chunk_bytes_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    chunk_bytes_ = kDefaultChunkBytes;
+  }
+}
 
 int HierarchicalTreeBroadcaster::GetDeviceTask(
     int device_rank, const std::vector<int>& dev_per_task) {
@@ -288,13 +300,18 @@ void HierarchicalTreeBroadcaster::TreeSendTo(const CollectiveParams& cp,
 // Subsequent subdivs correspond to intra-task broadcasts.  Subdiv i+1
 // corresponds to broadcast between all devices on task i.  Thus, each task
 // participates in at most 2 subdivs.
+//
+// A device receives the value in at most one subdiv, the one in which it is not
+// the source, and forwards it in all of its subdivs.  Large values are split
+// into chunks of about chunk_bytes_, and each chunk is forwarded as soon as it
+// is received, so that the broadcast is pipelined through the levels of the
+// trees rather than taking one transfer of the whole value per level.
 void HierarchicalTreeBroadcaster::RunTree() {
   int num_subdivs = static_cast<int>(col_params_->subdiv_rank.size());
-  // TODO(b/78352018): this is easily improved when a node participates in both
-  // first and second subdivision.  It would first send to its descendents in
-  // the first subdiv, then wait until all pending ops are finished before
-  // sending to descendents in second subdiv.  A better implementation would
-  // collapse the two send blocks.
+  int recv_subdiv = -1;
+  int recv_from_rank = -1;
+  // (subdiv, rank) of the devices to which this device forwards the value.
+  std::vector<std::pair<int, int>> send_to;
   for (int si = 0; si < num_subdivs; si++) {
     int my_rank = col_params_->subdiv_rank[si];
     // If rank is -1, this device does not participate in this subdiv.
@@ -309,103 +326,129 @@ void HierarchicalTreeBroadcaster::RunTree() {
               << " subdiv=" << si << " perm=" << subdiv_buf
               << " my_rank=" << my_rank << " source_rank=" << source_rank;
     }
+    if (my_rank != source_rank) {
+      DCHECK_EQ(recv_subdiv, -1);
+      recv_subdiv = si;
+      recv_from_rank = TreeRecvFrom(*col_params_, si);
+    }
+    std::vector<int> send_to_ranks;
+    TreeSendTo(*col_params_, si, &send_to_ranks);
+    for (int target_rank : send_to_ranks) {
+      send_to.emplace_back(si, target_rank);
+    }
+  }
+
+  mutex mu;               // also guards status_ while callbacks are pending
+  int pending_count = 0;  // TF_GUARDED_BY(mu)
+  condition_variable all_done;
+  auto op_done = [this, &mu, &pending_count, &all_done](const Status& s) {
+    mutex_lock l(mu);
+    status_.Update(s);
+    --pending_count;
+    if (0 == pending_count) {
+      all_done.notify_all();
+    }
+  };
 
-    mutex mu;               // also guards status_ while callbacks are pending
-    int pending_count = 0;  // TF_GUARDED_BY(mu)
-    condition_variable all_done;
+  // For the original source device, we copy input to output if they are
+  // different.
+  if (is_source_ && col_ctx_->input != col_ctx_->output &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    VLOG(2) << "copying input to output for device=" << col_ctx_->device_name;
+    {
+      mutex_lock l(mu);
+      ++pending_count;
+    }
+    DeviceContext* op_dev_ctx = col_ctx_->op_ctx->op_device_context();
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        op_dev_ctx, op_dev_ctx, col_ctx_->device, col_ctx_->device,
+        col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0, /*stream_index*/
+        op_done);
+  }
 
-    if (my_rank >= 0 && my_rank != source_rank) {
-      // Begin by receiving the value.
+  const Tensor* value = is_source_ ? col_ctx_->input : col_ctx_->output;
+  const int64_t chunk_elts = ChunkElts(*value);
+  const int num_chunks = std::max<int64_t>(
+      (value->NumElements() + chunk_elts - 1) / chunk_elts, 1);
+  // The chunks being sent, which must outlive the sends.
+  std::vector<Tensor> send_chunks;
+  send_chunks.reserve(num_chunks);
+  for (int c = 0; c < num_chunks; ++c) {
+    if (recv_subdiv >= 0) {
       profiler::TraceMe activity(
-          [&] { return strings::StrCat("ReceiveValue:", si); },
+          [&] { return strings::StrCat("ReceiveValue:", recv_subdiv); },
           profiler::TraceMeLevel::kInfo);
-      int recv_from_rank = TreeRecvFrom(*col_params_, si);
+      Tensor recv_chunk = Chunk(*col_ctx_->output, c, chunk_elts);
       Notification note;
-      DispatchRecv(si, recv_from_rank, my_rank, col_ctx_->output,
+      DispatchRecv(recv_subdiv, recv_from_rank,
+                   col_params_->subdiv_rank[recv_subdiv], c, &recv_chunk,
                    [this, &mu, &note](const Status& s) {
                      mutex_lock l(mu);
                      status_.Update(s);
                      note.Notify();
                    });
       note.WaitForNotification();
+      mutex_lock l(mu);
+      if (!status_.ok()) break;
     }
-
-    // Then forward value to all descendent devices.
-    {
-      profiler::TraceMe activity(
-          [&] { return strings::StrCat("ForwardValue:", si); },
-          profiler::TraceMeLevel::kInfo);
-      if (my_rank >= 0 && status_.ok()) {
-        std::vector<int> send_to_ranks;
-        TreeSendTo(*col_params_, si, &send_to_ranks);
-        for (int i = 0; i < send_to_ranks.size(); ++i) {
-          int target_rank = send_to_ranks[i];
-          {
-            mutex_lock l(mu);
-            ++pending_count;
-          }
-          DispatchSend(si, target_rank, my_rank,
-                       (is_source_ ? col_ctx_->input : col_ctx_->output),
-                       [this, &mu, &pending_count, &all_done](const Status& s) {
-                         mutex_lock l(mu);
-                         status_.Update(s);
-                         --pending_count;
-                         if (pending_count == 0) {
-                           all_done.notify_all();
-                         }
-                       });
-        }
-      }
-
-      // For the original source device, we copy input to output if they are
-      // different.
-      // If there is only 1 subdiv, we do this in that subdiv.  If there is more
-      // than 1 subdiv, then the original source device will participate in 2
-      // subdivs - the global inter-task broadcast and one local intra-task
-      // broadcast.  In this case, we perform the copy in the second subdiv for
-      // this device.
-      if (status_.ok() && is_source_ && (1 == num_subdivs || 0 != si)) {
-        VLOG(2) << "copying input to output for device="
-                << col_ctx_->device_name << " subdiv=" << si;
-        if (col_ctx_->input != col_ctx_->output &&
-            (DMAHelper::base(col_ctx_->input) !=
-             DMAHelper::base(col_ctx_->output))) {
-          {
-            mutex_lock l(mu);
-            ++pending_count;
-          }
-          DeviceContext* op_dev_ctx = col_ctx_->op_ctx->op_device_context();
-          CollectiveRemoteAccessLocal::MemCpyAsync(
-              op_dev_ctx, op_dev_ctx, col_ctx_->device, col_ctx_->device,
-              col_ctx_->op_ctx->input_alloc_attr(0),
-              col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
-              col_ctx_->output, 0, /*stream_index*/
-              [this, &mu, &pending_count, &all_done](const Status& s) {
-                mutex_lock l(mu);
-                status_.Update(s);
-                --pending_count;
-                if (0 == pending_count) {
-                  all_done.notify_all();
-                }
-              });
-        }
-      }
-
-      // Then wait for all pending actions to complete.
+    if (send_to.empty()) continue;
+
+    // Forward the chunk to all descendent devices while the next one is
+    // received.
+    profiler::TraceMe activity(
+        [&] { return strings::StrCat("ForwardValue:", c); },
+        profiler::TraceMeLevel::kInfo);
+    send_chunks.push_back(Chunk(*value, c, chunk_elts));
+    for (const auto& subdiv_and_rank : send_to) {
       {
         mutex_lock l(mu);
-        if (pending_count > 0) {
-          all_done.wait(l);
-        }
+        ++pending_count;
       }
+      DispatchSend(subdiv_and_rank.first, subdiv_and_rank.second,
+                   col_params_->subdiv_rank[subdiv_and_rank.first], c,
+                   &send_chunks.back(), op_done);
+    }
+  }
+
+  // Then wait for all pending actions to complete.
+  {
+    mutex_lock l(mu);
+    while (pending_count > 0) {
+      all_done.wait(l);
     }
   }
   VLOG(2) << "device=" << col_ctx_->device_name << " return status " << status_;
   done_(status_);
 }
 
+int64_t HierarchicalTreeBroadcaster::ChunkElts(const Tensor& value) const {
+  if (chunk_bytes_ <= 0 || value.TotalBytes() <= chunk_bytes_ ||
+      !DataTypeCanUseMemcpy(value.dtype())) {
+    return std::max<int64_t>(value.NumElements(), 1);
+  }
+  // The chunks are aligned like those of the other collectives, which may
+  // make them a bit larger than chunk_bytes_.
+  return CollectiveAdapter::AlignedChunkElts(
+      DataTypeSize(value.dtype()), value.NumElements(),
+      (value.TotalBytes() + chunk_bytes_ - 1) / chunk_bytes_);
+}
+
+Tensor HierarchicalTreeBroadcaster::Chunk(const Tensor& value, int chunk,
+                                          int64_t chunk_elts) const {
+  const int64_t total_elts = value.NumElements();
+  if (chunk_elts >= total_elts) {
+    return value;
+  }
+  Tensor flat;
+  CHECK(flat.CopyFrom(value, TensorShape({total_elts})));
+  const int64_t start = chunk * chunk_elts;
+  return flat.Slice(start, std::min(total_elts, start + chunk_elts));
+}
+
 void HierarchicalTreeBroadcaster::DispatchSend(int subdiv, int dst_rank,
-                                               int src_rank,
+                                               int src_rank, int chunk,
                                                const Tensor* src_tensor,
                                                const StatusCallback& done) {
   profiler::ScopedMemoryDebugAnnotation op_annotation(
@@ -413,7 +456,7 @@ void HierarchicalTreeBroadcaster::DispatchSend(int subdiv, int dst_rank,
       src_tensor->dtype(),
       [src_tensor]() { return src_tensor->shape().DebugString(); });
   string send_buf_key =
-      BroadcastBufKey(col_ctx_->exec_key, subdiv, src_rank, dst_rank);
+      BroadcastBufKey(col_ctx_->exec_key, subdiv, src_rank, dst_rank, chunk);
   int dst_idx =
       col_params_->instance.impl_details.subdiv_permutations[subdiv][dst_rank];
   VLOG(3) << "DispatchSend " << send_buf_key << " from_device "
@@ -431,10 +474,11 @@ void HierarchicalTreeBroadcaster::DispatchSend(int subdiv, int dst_rank,
 }
 
 void HierarchicalTreeBroadcaster::DispatchRecv(int subdiv, int src_rank,
-                                               int dst_rank, Tensor* dst_tensor,
+                                               int dst_rank, int chunk,
+                                               Tensor* dst_tensor,
                                                const StatusCallback& done) {
   string recv_buf_key =
-      BroadcastBufKey(col_ctx_->exec_key, subdiv, src_rank, dst_rank);
+      BroadcastBufKey(col_ctx_->exec_key, subdiv, src_rank, dst_rank, chunk);
   int src_idx =
       col_params_->instance.impl_details.subdiv_permutations[subdiv][src_rank];
   VLOG(3) << "DispatchRecv " << recv_buf_key << " from_device "
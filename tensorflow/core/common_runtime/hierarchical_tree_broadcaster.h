@@ -23,8 +23,14 @@ limitations under the License.
 namespace tensorflow {
 
 // Hierarchical tree-algorithm implementation of collective broadcast.
+//
+// Values larger than the chunk size, which is set by the
+// TF_COLLECTIVE_BROADCAST_CHUNK_BYTES environment variable (4MiB by default,
+// not positive to disable chunking), are broadcast in a pipeline of chunks.
 class HierarchicalTreeBroadcaster : public CollectiveImplementationInterface {
  public:
+  static constexpr int64_t kDefaultChunkBytes = 4 << 20;
+
   HierarchicalTreeBroadcaster();
   ~HierarchicalTreeBroadcaster() override = default;
 
@@ -61,16 +67,23 @@ class HierarchicalTreeBroadcaster : public CollectiveImplementationInterface {
   // Get the task to which the device at `device_rank` belongs.
   int GetDeviceTask(int device_rank, const std::vector<int>& dev_per_task);
 
-  // Sends `src_tensor` asynchronously from this device to device at `dst_rank`
-  // in `subdiv`.  Calls `done` upon completion.
-  void DispatchSend(int subdiv, int dst_rank, int src_rank,
+  // Returns the number of elements of each chunk of `value`.
+  int64_t ChunkElts(const Tensor& value) const;
+
+  // Returns a flat alias of the `chunk`-th chunk of `chunk_elts` elements of
+  // `value`, or `value` itself if it has only one chunk.
+  Tensor Chunk(const Tensor& value, int chunk, int64_t chunk_elts) const;
+
+  // Sends chunk `chunk` in `src_tensor` asynchronously from this device to
+  // device at `dst_rank` in `subdiv`.  Calls `done` upon completion.
+  void DispatchSend(int subdiv, int dst_rank, int src_rank, int chunk,
                     const Tensor* src_tensor, const StatusCallback& done);
 
-  // Receives a tensor into the memory buffer owned by `dst_tensor` at this
-  // device from device at `src_rank` in `subdiv`.  Calls `done` upon
+  // Receives chunk `chunk` into the memory buffer owned by `dst_tensor` at
+  // this device from device at `src_rank` in `subdiv`.  Calls `done` upon
   // completion.
-  void DispatchRecv(int subdiv, int src_rank, int dst_rank, Tensor* dst_tensor,
-                    const StatusCallback& done);
+  void DispatchRecv(int subdiv, int src_rank, int dst_rank, int chunk,
+                    Tensor* dst_tensor, const StatusCallback& done);
 
   // Executes the hierarchical broadcast defined by this op.
   void RunTree();
@@ -80,6 +93,7 @@ class HierarchicalTreeBroadcaster : public CollectiveImplementationInterface {
   StatusCallback done_;
   Status status_;
   bool is_source_;
+  int64_t chunk_bytes_;
 };
 
 }  // namespace tensorflow
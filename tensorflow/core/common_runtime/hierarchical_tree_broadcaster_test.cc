@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/hierarchical_tree_broadcaster.h"
 
 #include <algorithm>
+#include <cstdlib>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
@@ -455,6 +456,19 @@ DEF_TEST(INT64, CPU, 2, 4, 128, 0, false)
 // Failure cases
 DEF_TEST(FLOAT, CPU, 2, 4, 128, 1, true)
 DEF_TEST(FLOAT, CPU, 2, 4, 128, 5, false)
+
+TEST_F(HierarchicalTreeBroadcasterTest, Chunked) {
+  // 1001 floats are broadcast in 16 chunks, the last one shorter.
+  setenv("TF_COLLECTIVE_BROADCAST_CHUNK_BYTES", "256", 1);
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, 2, 4, 1001, 0, false);
+  unsetenv("TF_COLLECTIVE_BROADCAST_CHUNK_BYTES");
+}
+
+TEST_F(HierarchicalTreeBroadcasterTest, ChunkedFailure) {
+  setenv("TF_COLLECTIVE_BROADCAST_CHUNK_BYTES", "256", 1);
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, 2, 4, 1001, 20, true);
+  unsetenv("TF_COLLECTIVE_BROADCAST_CHUNK_BYTES");
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
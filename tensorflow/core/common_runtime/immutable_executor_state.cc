@@ -15,15 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -146,6 +151,14 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
         break;
       }
     }
+    item->is_any_consumer_retval = false;
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || !e->dst()->IsRetval()) continue;
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(e->dst()->attrs(), "index", &index));
+      retval_outputs_[id].emplace_back(e->src_output(), index);
+      item->is_any_consumer_retval = true;
+    }
     const Tensor* const_tensor = item->kernel->const_tensor();
     if (const_tensor) {
       // Hold onto a shallow copy of the constant tensor in `*this` so that the
@@ -259,9 +272,101 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+
+  bool critical_path_scheduling = params_.critical_path_scheduling;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_EXECUTOR_CRITICAL_PATH_SCHEDULING",
+                                        critical_path_scheduling,
+                                        &critical_path_scheduling));
+  if (critical_path_scheduling) {
+    InitializeCriticalPathLengths(graph);
+  }
+  bool step_graph_replay = params_.step_graph_replay;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_EXECUTOR_STEP_GRAPH_REPLAY",
+                                        step_graph_replay, &step_graph_replay));
+  if (step_graph_replay) {
+    InitializeReplaySchedule();
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
+void ImmutableExecutorState::InitializeReplaySchedule() {
+  // The schedule runs one node at a time, so it cannot wait for asynchronous
+  // kernels, nor follow the readiness of nodes which depends on the values of
+  // v1-style control flow.
+  if (requires_control_flow_) {
+    VLOG(1) << "Step-graph replay is disabled: the graph has control flow.";
+    return;
+  }
+  const int num_nodes = gview_.num_nodes();
+  for (int id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item != nullptr && item->kernel_is_async) {
+      VLOG(1) << "Step-graph replay is disabled: node "
+              << item->kernel->name() << " is asynchronous.";
+      return;
+    }
+  }
+
+  // Simulates a run in which the ready nodes are processed in FIFO order, as
+  // `SimplePropagatorState` would make them ready.
+  std::vector<int32> pending(num_nodes);
+  for (int id = 0; id < num_nodes; ++id) {
+    pending[id] = atomic_pending_counts_[id].load(std::memory_order_relaxed);
+  }
+  replay_schedule_.reserve(num_nodes);
+  replay_schedule_.insert(replay_schedule_.end(), root_nodes_.begin(),
+                          root_nodes_.end());
+  for (size_t i = 0; i < replay_schedule_.size(); ++i) {
+    const NodeItem* item = replay_schedule_[i];
+    for (const EdgeInfo& e : item->output_edges()) {
+      if (--pending[e.dst_id] == 0) {
+        replay_schedule_.push_back(&gview_.node_ref(e.dst_id));
+      }
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      if (--pending[e.dst_id] == 0) {
+        replay_schedule_.push_back(&gview_.node_ref(e.dst_id));
+      }
+    }
+  }
+}
+
+void ImmutableExecutorState::InitializeCriticalPathLengths(const Graph& graph) {
+  // The estimated cost (in microseconds) of the nodes without a measured cost,
+  // depending on whether their kernel is marked as expensive.
+  constexpr int64_t kExpensiveNodeCost = 10;
+  constexpr int64_t kInexpensiveNodeCost = 1;
+
+  // Ignores the back edges of the loops, so that the ordering is acyclic.
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order, NodeComparatorID(),
+                      [](const Edge& edge) {
+                        return !edge.src()->IsNextIteration();
+                      });
+
+  const CostModel* cost_model = params_.cost_model;
+  critical_path_lengths_.assign(graph.num_node_ids(), 0);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const Node* n = *it;
+    const NodeItem* item = gview_.node(n->id());
+    int64_t cost = 0;
+    if (cost_model != nullptr && cost_model->TotalCount(n) > 0) {
+      cost = cost_model->TimeEstimate(n).value();
+    } else if (item != nullptr && item->kernel != nullptr) {
+      cost = item->kernel->IsExpensive() ? kExpensiveNodeCost
+                                         : kInexpensiveNodeCost;
+    }
+    int64_t longest_successor_path = 0;
+    if (!n->IsNextIteration()) {
+      for (const Node* dst : n->out_nodes()) {
+        longest_successor_path = std::max(longest_successor_path,
+                                          critical_path_lengths_[dst->id()]);
+      }
+    }
+    critical_path_lengths_[n->id()] = cost + longest_successor_path;
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 #include <deque>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -101,6 +102,34 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Whether the critical path lengths of the nodes have been computed, i.e.
+  // whether `LocalExecutorParams::critical_path_scheduling` is enabled.
+  bool has_critical_path_lengths() const {
+    return !critical_path_lengths_.empty();
+  }
+
+  // Returns the order in which the nodes are run at each step if step-graph
+  // replay is enabled (see `LocalExecutorParams::step_graph_replay`) and
+  // supported by the graph, or an empty vector otherwise.
+  const std::vector<const NodeItem*>& replay_schedule() const {
+    return replay_schedule_;
+  }
+
+  // Returns the (output index, retval index) pairs of the outputs of each node
+  // consumed by a `_Retval` node, by node ID.
+  const absl::flat_hash_map<int, std::vector<std::pair<int, int>>>&
+  retval_outputs() const {
+    return retval_outputs_;
+  }
+
+  // Returns the estimated cost of the longest path from the node to the end
+  // of the graph, including the node itself.
+  //
+  // REQUIRES: `has_critical_path_lengths()`.
+  int64_t critical_path_length(const NodeItem& node_item) const {
+    return critical_path_lengths_[node_item.node_id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +154,8 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeCriticalPathLengths(const Graph& graph);
+  void InitializeReplaySchedule();
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -155,6 +186,17 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // If critical path scheduling is enabled, the critical path length of each
+  // node, indexed by node ID.
+  std::vector<int64_t> critical_path_lengths_;
+
+  // If step-graph replay is enabled and supported, all the nodes which run at
+  // each step, in a topological order.
+  std::vector<const NodeItem*> replay_schedule_;
+
+  // See `retval_outputs()`.
+  absl::flat_hash_map<int, std::vector<std::pair<int, int>>> retval_outputs_;
+
   ImmutableExecutorState(const ImmutableExecutorState&) = delete;
   void operator=(const ImmutableExecutorState&) = delete;
 };
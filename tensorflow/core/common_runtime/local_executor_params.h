@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,35 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If true, the ready nodes with the longest path to the end of the graph
+  // are dispatched first, rather than in discovery order. The length of a path
+  // is the sum of the estimated costs of its nodes. Can also be enabled with
+  // the TF_EXECUTOR_CRITICAL_PATH_SCHEDULING environment variable.
+  bool critical_path_scheduling = false;
+
+  // Optional measured costs of the nodes (e.g. from a `CostModelManager`),
+  // used by critical path scheduling. Only used while the executor is
+  // initialized.
+  const CostModel* cost_model = nullptr;
+
+  // If true, and the graph has neither v1-style control flow nor asynchronous
+  // kernels, each step runs the nodes one at a time in a schedule computed
+  // when the executor is initialized, instead of tracking the pending inputs
+  // of each node. This trades inter-op parallelism for lower per-node
+  // overhead, which pays off for small graphs of cheap kernels. Set from
+  // `ConfigProto.Experimental.enable_step_graph_replay` by the sessions, and
+  // can also be enabled with the TF_EXECUTOR_STEP_GRAPH_REPLAY environment
+  // variable.
+  bool step_graph_replay = false;
+
+  // If true, the kernels allocate the tensors which use the default
+  // allocator attributes from a per-step `StepArenaAllocator`, which is sized
+  // from the allocations of the previous step. This saves most calls to the
+  // device allocator for graphs which allocate the same tensors at each step,
+  // at the cost of holding on to more memory during the step. Set from
+  // `ConfigProto.Experimental.enable_step_arena_allocation` by the sessions.
+  bool step_arena_allocation = false;
 };
 
 }  // end namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -47,9 +48,12 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/host_info.h"
@@ -601,7 +605,12 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
                 &dev_set, default_device,
                 options.config_proto.allow_soft_placement(),
                 options.config_proto.log_device_placement());
-  TF_RETURN_IF_ERROR(placer.Run(optimization_options));
+  {
+    tensorflow::metrics::ScopedCounter<2> placer_timings(
+        tensorflow::metrics::GetGraphOptimizationCounter(),
+        {"GraphSetup", "Placer"});
+    TF_RETURN_IF_ERROR(placer.Run(optimization_options));
+  }
 
   DEBUG_DATA_DUMPER()->DumpGraph(function_name, kDebugGroupMain,
                                  "before_post_placement_passes", graph.get(),
@@ -647,7 +656,10 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
       optimization_source);
 }
 
-StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
+namespace {
+// Runs the graph optimization passes, or reads their results from the file
+// cache, see OptimizeFunctionGraphOrReadFromFileCache.
+StatusOr<OptimizedFunctionGraphInfo> OptimizeOrReadFromFileCache(
     const string& function_name, AttrSlice attrs,
     const FunctionLibraryRuntime::InstantiateOptions& options,
     const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
@@ -764,6 +776,152 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
 
   return optimized_function_graph_info;
 }
+}  // namespace
+
+OptimizedFunctionGraphCache::OptimizedFunctionGraphCache(int64_t capacity)
+    : capacity_(capacity) {
+  CHECK_GT(capacity_, 0);
+}
+
+/*static*/ OptimizedFunctionGraphCache* OptimizedFunctionGraphCache::Global() {
+  static OptimizedFunctionGraphCache* cache = []() {
+    int64_t capacity = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar(kGraphMemoryCachingCapacityEnvVariableName,
+                                    0, &capacity));
+    return capacity > 0 ? new OptimizedFunctionGraphCache(capacity) : nullptr;
+  }();
+  return cache;
+}
+
+/*static*/ std::optional<Fprint128> OptimizedFunctionGraphCache::Key(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* lib_def,
+    const std::vector<CompositeDevice*>& composite_devices,
+    Device* default_device) {
+  // The component functions have unique names, so they are never reused.
+  if (options.is_component_function || options.optimize_graph_fn ||
+      options.graph_collector != nullptr) {
+    return std::nullopt;
+  }
+  if (options.lib_def != nullptr) {
+    lib_def = options.lib_def;
+  }
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) return std::nullopt;
+
+  // The library is covered by the fingerprint of its definitions instead of
+  // its address.
+  FunctionLibraryRuntime::InstantiateOptions canonical_options = options;
+  canonical_options.lib_def = nullptr;
+  Fprint128 key =
+      Fingerprint128(Canonicalize(function_name, attrs, canonical_options));
+  string serialized;
+  SerializeToStringDeterministic(*fdef, &serialized);
+  key = FingerprintCat128(key, Fingerprint128(serialized));
+  SerializeToStringDeterministic(lib_def->ReachableDefinitions(*fdef).ToProto(),
+                                 &serialized);
+  key = FingerprintCat128(key, Fingerprint128(serialized));
+
+  string devices = absl::StrCat(
+      options.is_multi_device_function, options.allow_soft_placement,
+      options.int_args_and_retvals_on_device,
+      options.shape_inference_on_tfe_dialect_import, ",",
+      options.xla_compile_device_type, ",",
+      default_device != nullptr ? default_device->name() : "");
+  for (const Device* device : dev_set.devices()) {
+    absl::StrAppend(&devices, ",", device->name(), ":",
+                    device->device_type());
+  }
+  for (const CompositeDevice* device : composite_devices) {
+    absl::StrAppend(&devices, ",", device->name(), "[",
+                    absl::StrJoin(*device->underlying_devices(), ","), "]");
+  }
+  return FingerprintCat128(key, Fingerprint128(devices));
+}
+
+std::optional<OptimizedFunctionGraph> OptimizedFunctionGraphCache::Lookup(
+    const Fprint128& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return std::nullopt;
+  it->second.last_use = ++use_count_;
+  return it->second.graph;
+}
+
+void OptimizedFunctionGraphCache::Insert(const Fprint128& key,
+                                         OptimizedFunctionGraph graph) {
+  mutex_lock l(mu_);
+  if (!entries_.contains(key) && entries_.size() >= capacity_) {
+    auto lru = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.last_use < lru->second.last_use) lru = it;
+    }
+    VLOG(2) << "Dropping the least recently used optimized graph of "
+            << lru->second.graph.name();
+    entries_.erase(lru);
+  }
+  Entry& entry = entries_[key];
+  entry.graph = std::move(graph);
+  entry.last_use = ++use_count_;
+}
+
+int64_t OptimizedFunctionGraphCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env,
+    absl::Duration caching_threshold_duration) {
+  OptimizedFunctionGraphCache* memory_cache =
+      OptimizedFunctionGraphCache::Global();
+  std::optional<Fprint128> memory_cache_key;
+  if (memory_cache != nullptr) {
+    memory_cache_key = OptimizedFunctionGraphCache::Key(
+        function_name, attrs, options, dev_set, input_lib_def,
+        composite_devices, default_device);
+  }
+  if (memory_cache_key.has_value()) {
+    std::optional<OptimizedFunctionGraph> proto =
+        memory_cache->Lookup(*memory_cache_key);
+    if (proto.has_value()) {
+      StatusOr<OptimizedFunctionGraphInfo> optimized_function_graph_info =
+          OptimizedFunctionGraphInfo::FromProto(*proto);
+      if (optimized_function_graph_info.ok()) {
+        VLOG(3) << "Restored the optimized graph from the memory cache; "
+                   "function name: "
+                << function_name;
+        metrics::UpdateFunctionGraphOptimizationSavingTime(
+            optimized_function_graph_info->optimization_duration_usecs,
+            metrics::GraphOptimizationSource::kJit);
+        metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+            1, metrics::GraphOptimizationSource::kJit);
+        return optimized_function_graph_info;
+      }
+      LOG(ERROR) << "Restoring the optimized graph from the memory cache "
+                    "failed, running the graph optimization passes instead. "
+                    "Error: "
+                 << optimized_function_graph_info.status();
+    }
+  }
+
+  StatusOr<OptimizedFunctionGraphInfo> optimized_function_graph_info =
+      OptimizeOrReadFromFileCache(
+          function_name, attrs, options, dev_set, input_lib_def,
+          composite_devices, cpu_device, default_device, env,
+          caching_threshold_duration);
+  if (memory_cache_key.has_value() && optimized_function_graph_info.ok()) {
+    memory_cache->Insert(
+        *memory_cache_key,
+        OptimizedFunctionGraphInfo::ToProto(*optimized_function_graph_info));
+  }
+  return optimized_function_graph_info;
+}
 
 StatusOr<std::unique_ptr<std::unordered_map<string, std::unique_ptr<Graph>>>>
 PreprocessAndPartitionGraph(
@@ -17,16 +17,23 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_FUNCTION_GRAPH_UTILS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_FUNCTION_GRAPH_UTILS_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 // TODO(b/246646753): add more tests.
@@ -38,6 +45,56 @@ static const char kGraphCachingEnvVariableName[] = "TF_GRAPH_CACHING";
 // The threshold of the graph optimization duration to be cached.
 // Note: setting this threshold to 0 means to cache for every function.
 constexpr absl::Duration kCachingThresholdDuration = absl::Seconds(3);
+// The name of the env variable for the number of optimized function graphs
+// cached in memory for the whole process.
+// Note: 0, the default, means no caching in memory.
+static const char kGraphMemoryCachingCapacityEnvVariableName[] =
+    "TF_GRAPH_MEMORY_CACHING_CAPACITY";
+
+// A process-wide cache of optimized function graphs. It lets the
+// ProcessFunctionLibraryRuntimes of short-lived eager contexts and sessions
+// skip the optimization passes of the functions that were already optimized
+// for the same devices and options. The graphs are kept as protos, and the
+// least recently used ones are evicted beyond the capacity.
+class OptimizedFunctionGraphCache {
+ public:
+  explicit OptimizedFunctionGraphCache(int64_t capacity);
+
+  // Returns the cache of the process, or null if
+  // kGraphMemoryCachingCapacityEnvVariableName is not set.
+  static OptimizedFunctionGraphCache* Global();
+
+  // Returns the key of the optimized graph of `function_name`, which covers
+  // the definitions of the function and of the functions it calls, the
+  // attributes, options and devices. Returns nullopt if the optimization
+  // can't be cached, e.g. since it depends on a callback of the options.
+  static std::optional<Fprint128> Key(
+      const string& function_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const DeviceSet& dev_set, const FunctionLibraryDefinition* lib_def,
+      const std::vector<CompositeDevice*>& composite_devices,
+      Device* default_device);
+
+  // Returns a copy of the graph cached for `key`, if any.
+  std::optional<OptimizedFunctionGraph> Lookup(const Fprint128& key);
+
+  // Caches `graph` for `key`.
+  void Insert(const Fprint128& key, OptimizedFunctionGraph graph);
+
+  int64_t size() const;
+
+ private:
+  struct Entry {
+    OptimizedFunctionGraph graph;
+    uint64_t last_use = 0;
+  };
+
+  const int64_t capacity_;
+  mutable mutex mu_;
+  absl::flat_hash_map<Fprint128, Entry, Fprint128Hasher> entries_
+      TF_GUARDED_BY(mu_);
+  uint64_t use_count_ TF_GUARDED_BY(mu_) = 0;
+};
 
 // TODO(iga): Reword
 // Pins each arg that emits a `DT_RESOURCE` tensor to the device on which the
@@ -64,9 +121,9 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
 
 // Outputs graph optimization results (as OptimizedFunctionGraphInfo proto),
 // either by running the actual graph optimization passes,  or by reloading from
-// the file cache if existent. If cache loading fails, it goes ahead and runs
-// the graph optimization passes. Returns error if running the optimization
-// passes fails.
+// the memory cache or the file cache if existent. If cache loading fails, it
+// goes ahead and runs the graph optimization passes. Returns error if running
+// the optimization passes fails.
 StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
     const string& function_name, AttrSlice attrs,
     const FunctionLibraryRuntime::InstantiateOptions& options,
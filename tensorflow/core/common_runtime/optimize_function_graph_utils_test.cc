@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -245,5 +246,62 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizedFunctionGraphCacheTest, KeyDependsOnFunctionAndDevices) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDevice();
+  // The libraries of different runtimes share the keys of their functions.
+  auto lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  auto other_lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 3, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  std::optional<Fprint128> key = OptimizedFunctionGraphCache::Key(
+      "FindDevice", {}, opts, device_set, lib_def.get(),
+      /*composite_devices=*/{}, devices[1].get());
+  ASSERT_TRUE(key.has_value());
+  EXPECT_EQ(key, OptimizedFunctionGraphCache::Key(
+                     "FindDevice", {}, opts, device_set, other_lib_def.get(),
+                     /*composite_devices=*/{}, devices[1].get()));
+  EXPECT_NE(key, OptimizedFunctionGraphCache::Key(
+                     "FindDevice", {}, opts, device_set, lib_def.get(),
+                     /*composite_devices=*/{}, devices[2].get()));
+  EXPECT_FALSE(OptimizedFunctionGraphCache::Key(
+                   "Missing", {}, opts, device_set, lib_def.get(),
+                   /*composite_devices=*/{}, devices[1].get())
+                   .has_value());
+  opts.is_component_function = true;
+  EXPECT_FALSE(OptimizedFunctionGraphCache::Key(
+                   "FindDevice", {}, opts, device_set, lib_def.get(),
+                   /*composite_devices=*/{}, devices[1].get())
+                   .has_value());
+}
+
+TEST(OptimizedFunctionGraphCacheTest, EvictsLeastRecentlyUsedGraphs) {
+  OptimizedFunctionGraphCache cache(/*capacity=*/2);
+  for (uint64_t i = 1; i <= 2; ++i) {
+    OptimizedFunctionGraph graph;
+    graph.set_name(absl::StrCat("f", i));
+    cache.Insert({i, 0}, graph);
+  }
+  ASSERT_TRUE(cache.Lookup({1, 0}).has_value());
+  EXPECT_EQ(cache.Lookup({1, 0})->name(), "f1");
+
+  OptimizedFunctionGraph graph;
+  graph.set_name("f3");
+  cache.Insert({3, 0}, graph);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup({1, 0}).has_value());
+  EXPECT_FALSE(cache.Lookup({2, 0}).has_value());
+  EXPECT_TRUE(cache.Lookup({3, 0}).has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -993,6 +993,17 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
     refcounted_done->Ref();
   }
 
+  // Running a local component runs its inexpensive ops inline, so all but the
+  // last local components are launched through the runner. The components
+  // then start concurrently instead of one after the other, and a component
+  // waiting for the outputs of another one does not delay its launch.
+  int num_local_components = 0;
+  if (opts.runner != nullptr) {
+    for (const auto& pair : data->glue_) {
+      if (GetFLR(pair.first) != nullptr) ++num_local_components;
+    }
+  }
+
   FunctionLibraryRuntime::Options opts_copy = opts;
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
@@ -1055,11 +1066,21 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
       VLOG(4) << "    with " << opts_copy.DebugString();
 
       std::vector<Tensor>* comp_tensor_rets = new std::vector<Tensor>;
-      flr->Run(
-          opts_copy, comp_handle, GetLocalArgs(comp_args.args),
-          comp_tensor_rets,
-          TensorsToFunctionRetsDoneCallback(comp_rets, comp_tensor_rets,
-                                            std::move(component_fn_callback)));
+      auto launch = [flr, opts_copy, comp_handle,
+                     local_args = GetLocalArgs(comp_args.args),
+                     comp_tensor_rets, comp_rets,
+                     component_fn_callback =
+                         std::move(component_fn_callback)]() mutable {
+        flr->Run(opts_copy, comp_handle, local_args, comp_tensor_rets,
+                 TensorsToFunctionRetsDoneCallback(
+                     comp_rets, comp_tensor_rets,
+                     std::move(component_fn_callback)));
+      };
+      if (--num_local_components > 0) {
+        (*opts.runner)(std::move(launch));
+      } else {
+        launch();
+      }
     } else {
       opts_copy.remote_execution = true;
 
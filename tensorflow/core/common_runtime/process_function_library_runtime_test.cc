@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -1122,6 +1123,130 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+// The launches of the two components of a multi-device function, as seen by
+// their ComponentLaunchOp kernels, which are constructed when the component
+// first runs.
+struct ComponentLaunches {
+  Notification launched[2];
+  std::atomic<int> num_peers_seen{0};
+};
+ComponentLaunches* component_launches = nullptr;
+
+REGISTER_OP("ComponentLaunchOp")
+    .Input("in: T")
+    .Output("out: T")
+    .Attr("T: type")
+    .Attr("component: int")
+    .SetShapeFn(shape_inference::UnchangedShape);
+class ComponentLaunchOp : public OpKernel {
+ public:
+  explicit ComponentLaunchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    int component;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("component", &component));
+    component_launches->launched[component].Notify();
+    // Components launched one after the other never see each other.
+    if (WaitForNotificationWithTimeout(
+            &component_launches->launched[1 - component],
+            /*timeout_in_us=*/10 * 1000 * 1000)) {
+      ++component_launches->num_peers_seen;
+    }
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    ctx->set_output(0, ctx->input(0));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("ComponentLaunchOp").Device(DEVICE_CPU),
+                        ComponentLaunchOp);
+
+// A function with a component on CPU:0 running `op0` and a component on CPU:1
+// running `op1`, each forwarding its float input to its output.
+FunctionDef TwoCpuComponents(const string& op0, int64_t component0,
+                             const string& op1, int64_t component1) {
+  auto attrs = [](const string& op, int64_t component) {
+    std::vector<std::pair<string, FunctionDefHelper::AttrValueWrapper>> attrs =
+        {{"T", DT_FLOAT}};
+    if (op == "ComponentLaunchOp") attrs.push_back({"component", component});
+    return attrs;
+  };
+  return FunctionDefHelper::Define(
+      // Name
+      "TwoCpuComponents",
+      // Args
+      {"x0: float", "x1: float"},
+      // Return values
+      {"y0: float", "y1: float"},
+      // Attrs
+      {},
+      // Nodes
+      {{{"y0"}, op0, {"x0"}, attrs(op0, component0), {}, "/device:CPU:0"},
+       {{"y1"}, op1, {"x1"}, attrs(op1, component1), {}, "/device:CPU:1"}});
+}
+
+// Runs TwoCpuComponents with a runner counting the closures it schedules, and
+// returns the status passed to `done`, which must be called once.
+Status RunTwoCpuComponents(ProcessFunctionLibraryRuntimeTest* fixture,
+                           std::vector<Tensor>* rets, int* num_scheduled) {
+  FunctionLibraryRuntime::Handle handle;
+  TF_RETURN_IF_ERROR(fixture->Instantiate(
+      "TwoCpuComponents", {},
+      MakeOptions("CPU:0", {"CPU:0", "CPU:1"}, {"CPU:0", "CPU:1"}), &handle));
+  std::atomic<int> scheduled{0};
+  std::function<void(std::function<void()>)> runner =
+      [&scheduled](std::function<void()> fn) {
+        ++scheduled;
+        test::function::FunctionTestSchedClosure(fn);
+      };
+  FunctionLibraryRuntime::Options opts;
+  opts.runner = &runner;
+  Status status;
+  std::atomic<int> num_done{0};
+  Notification done;
+  fixture->proc_flr_->Run(
+      opts, handle,
+      {test::AsScalar<float>(1.0), test::AsScalar<float>(2.0)}, rets,
+      [&status, &num_done, &done](const Status& s) {
+        status = s;
+        if (++num_done == 1) done.Notify();
+      });
+  done.WaitForNotification();
+  EXPECT_EQ(num_done, 1);
+  *num_scheduled = scheduled;
+  TF_CHECK_OK(fixture->proc_flr_->ReleaseHandle(handle));
+  return status;
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_LaunchesLocalComponentsConcurrently) {
+  Init({TwoCpuComponents("ComponentLaunchOp", 0, "ComponentLaunchOp", 1)});
+  ComponentLaunches launches;
+  component_launches = &launches;
+
+  std::vector<Tensor> rets;
+  int num_scheduled = 0;
+  TF_EXPECT_OK(RunTwoCpuComponents(this, &rets, &num_scheduled));
+  component_launches = nullptr;
+
+  // Each component was launched while the other one was being launched.
+  EXPECT_EQ(launches.num_peers_seen, 2);
+  EXPECT_GE(num_scheduled, 1);
+  ASSERT_EQ(rets.size(), 2);
+  test::ExpectTensorEqual<float>(rets[0], test::AsScalar<float>(1.0));
+  test::ExpectTensorEqual<float>(rets[1], test::AsScalar<float>(2.0));
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_FailingComponentCallsDoneOnce) {
+  Init({TwoCpuComponents("Identity", 0, "BrokenOp", 1)});
+
+  std::vector<Tensor> rets;
+  int num_scheduled = 0;
+  Status status = RunTwoCpuComponents(this, &rets, &num_scheduled);
+  EXPECT_TRUE(errors::IsInternal(status)) << "Actual status: " << status;
+  EXPECT_TRUE(absl::StrContains(status.message(), "I am broken"));
+  EXPECT_GE(num_scheduled, 1);
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/replay_propagator_state.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+ReplayPropagatorState::ReplayPropagatorState(
+    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog)
+    : step_id_(step_id),
+      vlog_(vlog || VLOG_IS_ON(1)),
+      schedule_(immutable_state.replay_schedule()),
+      input_tensors_(immutable_state.get_root_frame_info().total_inputs) {
+  DCHECK(!schedule_.empty());
+}
+
+ReplayPropagatorState::~ReplayPropagatorState() {}
+
+void ReplayPropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  DCHECK(roots.empty() || roots[0] == schedule_[0]);
+  DCHECK_EQ(next_, 0);
+  ready->push_back(TaggedNode{schedule_[next_++]});
+}
+
+void ReplayPropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
+                                             EntryVector* outputs,
+                                             TaggedNodeSeq* ready) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat(
+            "ExecutorPropagateOutputs#", "id=", step_id_,
+            ",kernel_name=", tagged_node.node_item->kernel->name_view(),
+            ",num_output_edges=", tagged_node.node_item->num_output_edges,
+            "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+
+  DCHECK(ready->empty());
+  DCHECK_EQ(tagged_node.node_item, schedule_[next_ - 1]);
+
+  // The control edges need no propagation: their destinations run later in
+  // the schedule anyway.
+  for (const EdgeInfo& e : tagged_node.node_item->output_edges()) {
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+  }
+
+  if (next_ < schedule_.size()) {
+    ready->push_back(TaggedNode{schedule_[next_++]});
+  }
+}
+
+void ReplayPropagatorState::DumpState() {
+  mutex_lock l(mu_);
+  // Dump the nodes which have not run yet and hold on to tensors.
+  for (size_t i = next_; i < schedule_.size(); ++i) {
+    DumpPendingNodeState(*schedule_[i], input_tensors_.data(), false);
+  }
+  // Then the active node.
+  if (active_node_ != nullptr) {
+    DumpActiveNodeState(*active_node_, input_tensors_.data());
+  }
+}
+
+}  // namespace tensorflow
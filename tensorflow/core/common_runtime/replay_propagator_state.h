@@ -0,0 +1,116 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_REPLAY_PROPAGATOR_STATE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_REPLAY_PROPAGATOR_STATE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Represents the ephemeral "edge state" associated with one invocation of
+// `Executor::Run()`, when the nodes are run in the precomputed
+// `ImmutableExecutorState::replay_schedule()`.
+//
+// Unlike `SimplePropagatorState`, `ReplayPropagatorState` does not count the
+// pending inputs of the nodes: after processing a node, it makes the next node
+// of the schedule ready. The nodes thus run one at a time, and every node
+// runs after all its inputs are available.
+//
+// NOTE: `ReplayPropagatorState` requires all the kernels of the graph to be
+// synchronous, and does not support "v1-style" control flow. The
+// `replay_schedule()` is empty for the graphs which do not meet these
+// requirements.
+class ReplayPropagatorState {
+ public:
+  ReplayPropagatorState(const ImmutableExecutorState& immutable_state,
+                        int64_t step_id, bool vlog);
+  ~ReplayPropagatorState();
+
+  using TaggedNode = SimplePropagatorState::TaggedNode;
+  using TaggedNodeReadyQueue = SimplePropagatorState::TaggedNodeReadyQueue;
+  using TaggedNodeSeq = SimplePropagatorState::TaggedNodeSeq;
+
+  // Adds a `TaggedNode` for the first node of the schedule to `*ready`. The
+  // `roots` are the first nodes of the schedule.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // After processing the outputs, propagates the outputs to their dsts, and
+  // adds the next node of the schedule to `*ready`. Contents of *outputs are
+  // left in an indeterminate state after returning from this method.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  // Returns an array of `Entry` objects corresponding to the inputs of
+  // `tagged_node`.
+  Entry* GetInputTensors(const TaggedNode& tagged_node) {
+    return input_tensors_.data() + tagged_node.node_item->input_start;
+  }
+
+  FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
+    return {0, 0};
+  }
+
+  // Provide debugging output of the state of the executor.
+  void DumpState();
+
+  // For debugging/logging only.
+  void MaybeMarkStarted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      active_node_ = tagged_node.node_item;
+    }
+  }
+  void MaybeMarkCompleted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      active_node_ = nullptr;
+    }
+  }
+
+ private:
+  const int64_t step_id_;
+  const bool vlog_;
+
+  const std::vector<const NodeItem*>& schedule_;
+
+  // The index in `schedule_` of the next node to make ready.
+  //
+  // NOTE: No need to protect `next_` nor `input_tensors_` by any locks: the
+  // nodes run one at a time, and each one is made ready by the
+  // `PropagateOutputs()` call of the previous one.
+  size_t next_ = 0;
+
+  // The i-th node's j-th input is stored at
+  // `input_tensors[impl_->nodes[i].input_start + j]`.
+  std::vector<Entry> input_tensors_;
+
+  // If `vlog_` is true, this stores the running node, if any.
+  mutex mu_;
+  const NodeItem* active_node_ TF_GUARDED_BY(mu_) = nullptr;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_REPLAY_PROPAGATOR_STATE_H_
@@ -52,6 +52,12 @@ class RequestCost {
     int64_t padding_size = 0;
     // Costs for processing this batch.
     absl::flat_hash_map<std::string, absl::Duration> batch_costs;
+    // Time this rpc request waited to be batched, from its enqueuing until
+    // this batch started processing.
+    absl::Duration queueing_time = absl::ZeroDuration();
+    // In this batch, the costs for processing the padding that are assigned
+    // to this rpc request, in proportion to its input size.
+    absl::flat_hash_map<std::string, absl::Duration> padding_costs;
   };
 
   // Records the metrics of a batch.
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "Eigen/Core"  // from @eigen_archive
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -68,6 +71,122 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
 
+// The unary element-wise ops that the executor evaluates itself when they form
+// a chain, instead of running their kernels (see `KernelState::cwise_chain`).
+enum class CwiseOp {
+  kAbs,
+  kCeil,
+  kExp,
+  kFloor,
+  kLog,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+// Returns true if `n` is a unary element-wise op that can be part of a chain,
+// and sets `op` accordingly.
+bool GetFusableCwiseOp(const Node& n, CwiseOp* op) {
+  static const auto* const kCwiseOps =
+      new absl::flat_hash_map<string, CwiseOp>({
+          {"Abs", CwiseOp::kAbs},
+          {"Ceil", CwiseOp::kCeil},
+          {"Exp", CwiseOp::kExp},
+          {"Floor", CwiseOp::kFloor},
+          {"Log", CwiseOp::kLog},
+          {"Neg", CwiseOp::kNeg},
+          {"Reciprocal", CwiseOp::kReciprocal},
+          {"Relu", CwiseOp::kRelu},
+          {"Rsqrt", CwiseOp::kRsqrt},
+          {"Sigmoid", CwiseOp::kSigmoid},
+          {"Sqrt", CwiseOp::kSqrt},
+          {"Square", CwiseOp::kSquare},
+          {"Tanh", CwiseOp::kTanh},
+      });
+  auto it = kCwiseOps->find(n.type_string());
+  if (it == kCwiseOps->end() || n.num_inputs() != 1 || n.num_outputs() != 1 ||
+      n.input_type(0) != n.output_type(0) ||
+      (n.output_type(0) != DT_FLOAT && n.output_type(0) != DT_DOUBLE) ||
+      // A kernel label selects a kernel other than the default one.
+      n.attrs().Find("_kernel") != nullptr) {
+    return false;
+  }
+  *op = it->second;
+  return true;
+}
+
+template <typename T>
+void ApplyCwiseOp(CwiseOp op,
+                  Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>* y) {
+  // These are the Eigen functors used by the kernels of the ops.
+  switch (op) {
+    case CwiseOp::kAbs:
+      *y = y->abs();
+      break;
+    case CwiseOp::kCeil:
+      *y = y->ceil();
+      break;
+    case CwiseOp::kExp:
+      *y = y->exp();
+      break;
+    case CwiseOp::kFloor:
+      *y = y->floor();
+      break;
+    case CwiseOp::kLog:
+      *y = y->log();
+      break;
+    case CwiseOp::kNeg:
+      *y = -*y;
+      break;
+    case CwiseOp::kReciprocal:
+      *y = y->inverse();
+      break;
+    case CwiseOp::kRelu:
+      *y = y->max(static_cast<T>(0));
+      break;
+    case CwiseOp::kRsqrt:
+      *y = y->rsqrt();
+      break;
+    case CwiseOp::kSigmoid:
+      *y = y->logistic();
+      break;
+    case CwiseOp::kSqrt:
+      *y = y->sqrt();
+      break;
+    case CwiseOp::kSquare:
+      *y = y->square();
+      break;
+    case CwiseOp::kTanh:
+      *y = y->tanh();
+      break;
+  }
+}
+
+// Computes `out = ops[n-1](...ops[0](in))` over the `size` elements of `in`,
+// which may alias `out`. The ops are applied one block at a time, so that the
+// intermediate values stay in the L1 cache.
+template <typename T>
+void ApplyCwiseChain(const std::vector<CwiseOp>& ops, const T* in, T* out,
+                     int64_t size) {
+  using Array = Eigen::Array<T, Eigen::Dynamic, 1>;
+  constexpr int64_t kBlockSize = 1024;
+  for (int64_t start = 0; start < size; start += kBlockSize) {
+    const int64_t block_size = std::min(kBlockSize, size - start);
+    Eigen::Map<Array> y(out + start, block_size);
+    if (in != out) {
+      y = Eigen::Map<const Array>(in + start, block_size);
+    }
+    for (CwiseOp op : ops) {
+      ApplyCwiseOp<T>(op, &y);
+    }
+  }
+}
+
 class SingleThreadedExecutorImpl : public Executor {
  public:
   explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
@@ -235,6 +354,10 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
+    if (params_.device->device_type() == DEVICE_CPU) {
+      FuseCwiseChains(nodes_with_kernels, node_to_index_map);
+    }
+
     if (!kernels_.empty()) {
       const KernelState& last_kernel_state = kernels_.back();
       total_num_inputs_ =
@@ -254,6 +377,84 @@ class SingleThreadedExecutorImpl : public Executor {
     return OkStatus();
   }
 
+  // Finds the chains of at least two unary element-wise ops, where each op but
+  // the last one only feeds the next one, and sets them up to be evaluated
+  // by a single loop when the first op of the chain runs.
+  void FuseCwiseChains(
+      const std::vector<Node*>& nodes_with_kernels,
+      const absl::flat_hash_map<Node*, size_t>& node_to_index_map) {
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      if (kernels_[i].fused_into_chain) continue;
+      const Node* n = nodes_with_kernels[i];
+      CwiseOp op;
+      if (!GetFusableCwiseOp(*n, &op)) continue;
+      const DataType dtype = n->output_type(0);
+      std::vector<CwiseOp> chain = {op};
+      std::vector<size_t> chain_indices = {i};
+      while (n->out_edges().size() == 1) {
+        const Edge* e = *n->out_edges().begin();
+        const Node* next = e->dst();
+        // `next` runs as part of the chain, i.e. before its position in the
+        // topological order, so it must not have any other input.
+        if (e->IsControlEdge() || !GetFusableCwiseOp(*next, &op) ||
+            next->output_type(0) != dtype || next->in_edges().size() != 1) {
+          break;
+        }
+        chain.push_back(op);
+        chain_indices.push_back(node_to_index_map.at(next));
+        n = next;
+      }
+      if (chain.size() < 2) continue;
+
+      VLOG(2) << "Fusing a chain of " << chain.size()
+              << " element-wise ops starting at "
+              << nodes_with_kernels[i]->name();
+      KernelState& first_state = kernels_[i];
+      const KernelState& last_state = kernels_[chain_indices.back()];
+      first_state.output_locations = last_state.output_locations;
+      first_state.output_alloc_attrs = last_state.output_alloc_attrs;
+      first_state.cwise_chain = std::move(chain);
+      for (size_t j = 1; j < chain_indices.size(); ++j) {
+        kernels_[chain_indices[j]].fused_into_chain = true;
+      }
+    }
+  }
+
+  // Evaluates the `cwise_chain` of `kernel_state` over `input`, forwarding
+  // the input buffer to `output` if nothing else refers to it.
+  Status RunCwiseChain(const KernelState& kernel_state, Device* device,
+                       const Entry& input, Tensor* output) {
+    const Tensor& x = input.state == Entry::State::HAS_CONST_TENSOR
+                          ? *input.const_tensor
+                          : *input.val;
+    if (input.state == Entry::State::HAS_VALUE && x.RefCountIsOne()) {
+      *output = x;
+    } else {
+      *output = Tensor(device->GetAllocator(kernel_state.output_alloc_attrs[0]),
+                       x.dtype(), x.shape());
+      if (!output->IsInitialized()) {
+        return errors::ResourceExhausted(
+            "OOM when allocating tensor with shape ", x.shape().DebugString(),
+            " for the output of ", kernel_state.kernel->name());
+      }
+    }
+    switch (x.dtype()) {
+      case DT_FLOAT:
+        ApplyCwiseChain(kernel_state.cwise_chain, x.flat<float>().data(),
+                        output->flat<float>().data(), x.NumElements());
+        break;
+      case DT_DOUBLE:
+        ApplyCwiseChain(kernel_state.cwise_chain, x.flat<double>().data(),
+                        output->flat<double>().data(), x.NumElements());
+        break;
+      default:
+        return errors::Internal("Unexpected type ", DataTypeString(x.dtype()),
+                                " for the input of ",
+                                kernel_state.kernel->name());
+    }
+    return OkStatus();
+  }
+
   Status Run(const Args& args) override {
     // The inputs to each kernel are stored contiguously in `inputs`.
     //
@@ -413,6 +614,26 @@ class SingleThreadedExecutorImpl : public Executor {
       const size_t num_inputs = kernel_state.num_inputs;
       const size_t num_outputs = kernel_state.num_outputs;
 
+      if (kernel_state.fused_into_chain) {
+        continue;
+      } else if (!kernel_state.cwise_chain.empty()) {
+        Tensor output;
+        TF_RETURN_IF_ERROR(RunCwiseChain(
+            kernel_state, device, inputs[input_start_index], &output));
+        inputs[input_start_index].ClearVal();
+        const std::vector<size_t>& locations = kernel_state.output_locations[0];
+        for (size_t k = 0; k < locations.size(); ++k) {
+          Entry& input = inputs[locations[k]];
+          input.state = Entry::State::HAS_VALUE;
+          if (k + 1 < locations.size()) {
+            input.val.Init(output);
+          } else {
+            input.val.Init(std::move(output));
+          }
+        }
+        continue;
+      }
+
       node_inputs.clear();
       node_inputs.resize(num_inputs);
       input_alloc_attrs.clear();
@@ -527,6 +748,16 @@ class SingleThreadedExecutorImpl : public Executor {
     // Memory space information for each output of `kernel`.
     std::vector<AllocatorAttributes>
         output_alloc_attrs;  // Length = `num_outputs`.
+
+    // If not empty, `kernel` is the first op of a chain of unary element-wise
+    // ops, which are evaluated by a single loop over the input of `kernel`
+    // instead of running their kernels. `output_locations` and
+    // `output_alloc_attrs` are then those of the last op of the chain.
+    std::vector<CwiseOp> cwise_chain;
+
+    // True if `kernel` is evaluated as part of the `cwise_chain` of a
+    // previous kernel, and must not run.
+    bool fused_into_chain = false;
   };
   std::vector<KernelState> kernels_;
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <string>
 #include <utility>
@@ -249,6 +250,46 @@ TEST_F(ExecutorTest, EmptyOutput) {
   EXPECT_EQ(0, retvals[1].tensor_data().size());
 }
 
+TEST_F(ExecutorTest, CwiseChain) {
+  // a = Sqrt(Abs(Neg(in)))
+  // b = Exp(Square(a))
+  // c = Neg(Square(a))
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* in = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  Node* a = test::graph::Unary(g.get(), "Neg", in);
+  a = test::graph::Unary(g.get(), "Abs", a);
+  a = test::graph::Unary(g.get(), "Sqrt", a);
+  Node* b = test::graph::Unary(g.get(), "Square", a);
+  b = test::graph::Unary(g.get(), "Exp", b);
+  Node* c = test::graph::Unary(g.get(), "Square", a);
+  c = test::graph::Unary(g.get(), "Neg", c);
+  test::graph::Retval(g.get(), 0, a);
+  test::graph::Retval(g.get(), 1, b);
+  test::graph::Retval(g.get(), 2, c);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  Tensor arg(DT_FLOAT, TensorShape({3000}));
+  for (int i = 0; i < arg.NumElements(); ++i) {
+    arg.flat<float>()(i) = i % 4;
+  }
+  FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT, DT_FLOAT, DT_FLOAT});
+  TF_ASSERT_OK(call_frame.SetArgs({arg}));
+  TF_ASSERT_OK(Run(&call_frame));
+  std::vector<Tensor> retvals;
+  TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  for (int i = 0; i < arg.NumElements(); ++i) {
+    const float x = i % 4;
+    EXPECT_NEAR(std::sqrt(x), retvals[0].flat<float>()(i), 1e-6);
+    EXPECT_NEAR(std::exp(x), retvals[1].flat<float>()(i), 1e-4);
+    EXPECT_NEAR(-x, retvals[2].flat<float>()(i), 1e-6);
+  }
+
+  // Verify that the argument values are unchanged.
+  const Tensor* arg_0;
+  TF_ASSERT_OK(call_frame.GetArg(0, &arg_0));
+  EXPECT_EQ(3.0, arg_0->flat<float>()(3));
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -0,0 +1,343 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/allocator_registry.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+constexpr size_t kMaxSmallAllocationBytes = 4 << 10;
+// The size classes are the multiples of kAlignment up to kLinearClassBytes,
+// and then the multiples of 2^(k-2) in (2^k, 2^(k+1)], for each k.
+constexpr size_t kLinearClassBytes = 512;
+// The minimum number of objects moved at once between a magazine and a depot.
+constexpr size_t kMinMagazineCapacity = 8;
+// The maximum number of shards, which are picked by the current CPU.
+constexpr int kMaxShards = 256;
+
+constexpr uintptr_t kSlabMask = SlabCPUAllocator::kSlabBytes - 1;
+
+// Returns the first slot of the slab at `address` in a table of 2^log2_size.
+size_t SlabSlot(uintptr_t address, int log2_size) {
+  const uint64 hash = (address >> 16) * uint64{0x9e3779b97f4a7c15};
+  return hash >> (64 - log2_size);
+}
+
+}  // namespace
+
+// The magazines and stats of a CPU, on their own cache lines.
+struct alignas(64) SlabCPUAllocator::Shard {
+  mutex mu;
+  // The free objects of each size class.
+  std::vector<std::vector<void*>> magazines TF_GUARDED_BY(mu);
+  // The stats of the operations run on this CPU. The bytes in use may be
+  // negative if their objects were allocated on another CPU.
+  int64_t num_allocs TF_GUARDED_BY(mu) = 0;
+  int64_t bytes_in_use TF_GUARDED_BY(mu) = 0;
+  int64_t largest_alloc_size TF_GUARDED_BY(mu) = 0;
+};
+
+SlabCPUAllocator::SlabCPUAllocator(const Options& options)
+    : options_(options),
+      num_shards_(std::min(std::max(port::NumTotalCPUs(), 1), kMaxShards)),
+      shards_(new Shard[num_shards_]) {
+  CHECK_LE(options_.max_small_allocation_bytes, kMaxSmallAllocationBytes);
+  for (size_t size = kAlignment; size <= options_.max_small_allocation_bytes;
+       size += kAlignment) {
+    const size_t step =
+        size <= kLinearClassBytes
+            ? kAlignment
+            : size_t{1} << (Log2Floor64(static_cast<uint64>(size - 1)) - 2);
+    if (class_sizes_.empty() || size > class_sizes_.back()) {
+      class_sizes_.push_back((size + step - 1) / step * step);
+    }
+    class_for_size_.push_back(class_sizes_.size() - 1);
+  }
+  const int num_classes = class_sizes_.size();
+  for (size_t class_size : class_sizes_) {
+    magazine_capacities_.push_back(std::max(
+        kMinMagazineCapacity, options_.max_magazine_bytes / class_size));
+  }
+  depots_.reset(new Depot[num_classes]);
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    shards_[i].magazines.resize(num_classes);
+  }
+
+  // At most half of the slots of the slab table are used.
+  const size_t max_slabs =
+      std::max<size_t>(options_.max_slab_memory_bytes / kSlabBytes, 1);
+  slab_table_log2_size_ = Log2Ceiling64(max_slabs) + 1;
+  slab_table_.reset(
+      new std::atomic<uintptr_t>[size_t{1} << slab_table_log2_size_]);
+  for (size_t i = 0; i < (size_t{1} << slab_table_log2_size_); ++i) {
+    slab_table_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+SlabCPUAllocator::~SlabCPUAllocator() {
+  mutex_lock l(slab_mu_);
+  for (void* slab : slabs_) {
+    port::AlignedFree(slab);
+  }
+}
+
+SlabCPUAllocator::Shard* SlabCPUAllocator::CurrentShard() {
+  int cpu = port::GetCurrentCPU();
+  if (cpu < 0) {
+    // Spread the threads over the shards if the CPU is unknown.
+    static std::atomic<int> next_thread{0};
+    thread_local const int thread =
+        next_thread.fetch_add(1, std::memory_order_relaxed);
+    cpu = thread;
+  }
+  return &shards_[cpu % num_shards_];
+}
+
+void* SlabCPUAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0 || num_bytes > options_.max_small_allocation_bytes ||
+      alignment > kAlignment) {
+    return AllocateLarge(alignment, num_bytes);
+  }
+  const int size_class = class_for_size_[(num_bytes - 1) / kAlignment];
+  Shard* shard = CurrentShard();
+  mutex_lock l(shard->mu);
+  std::vector<void*>& magazine = shard->magazines[size_class];
+  if (magazine.empty() && !Refill(size_class, &magazine)) {
+    l.unlock();
+    return AllocateLarge(alignment, num_bytes);
+  }
+  void* ptr = magazine.back();
+  magazine.pop_back();
+  if (CPUAllocatorStatsEnabled()) {
+    RecordAllocation(shard, class_sizes_[size_class]);
+  }
+  return ptr;
+}
+
+void SlabCPUAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const int size_class = SlabClass(ptr);
+  if (size_class < 0) {
+    DeallocateLarge(ptr);
+    return;
+  }
+  Shard* shard = CurrentShard();
+  mutex_lock l(shard->mu);
+  std::vector<void*>& magazine = shard->magazines[size_class];
+  if (magazine.size() >= magazine_capacities_[size_class]) {
+    Flush(size_class, &magazine);
+  }
+  magazine.push_back(ptr);
+  if (CPUAllocatorStatsEnabled()) {
+    RecordDeallocation(shard, class_sizes_[size_class]);
+  }
+}
+
+bool SlabCPUAllocator::Refill(int size_class, std::vector<void*>* magazine) {
+  Depot& depot = depots_[size_class];
+  {
+    mutex_lock l(depot.mu);
+    if (!depot.free_objects.empty()) {
+      const size_t n = std::min(depot.free_objects.size(),
+                                magazine_capacities_[size_class] / 2);
+      magazine->insert(magazine->end(), depot.free_objects.end() - n,
+                       depot.free_objects.end());
+      depot.free_objects.resize(depot.free_objects.size() - n);
+      return true;
+    }
+  }
+  return AllocateSlab(size_class, magazine);
+}
+
+void SlabCPUAllocator::Flush(int size_class, std::vector<void*>* magazine) {
+  const size_t n = magazine->size() / 2;
+  Depot& depot = depots_[size_class];
+  mutex_lock l(depot.mu);
+  depot.free_objects.insert(depot.free_objects.end(), magazine->end() - n,
+                            magazine->end());
+  magazine->resize(magazine->size() - n);
+}
+
+bool SlabCPUAllocator::AllocateSlab(int size_class,
+                                    std::vector<void*>* magazine) {
+  char* slab;
+  {
+    mutex_lock l(slab_mu_);
+    if ((slabs_.size() + 1) * kSlabBytes > options_.max_slab_memory_bytes) {
+      return false;
+    }
+    slab = static_cast<char*>(port::AlignedMalloc(kSlabBytes, kSlabBytes));
+    if (slab == nullptr) return false;
+    slabs_.push_back(slab);
+
+    const uintptr_t address = reinterpret_cast<uintptr_t>(slab);
+    const size_t mask = (size_t{1} << slab_table_log2_size_) - 1;
+    size_t slot = SlabSlot(address, slab_table_log2_size_);
+    while (slab_table_[slot].load(std::memory_order_relaxed) != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slab_table_[slot].store(address | (size_class + 1),
+                            std::memory_order_release);
+  }
+  VLOG(3) << "SlabCPUAllocator: new slab of " << class_sizes_[size_class]
+          << " byte objects at " << static_cast<void*>(slab);
+
+  // The objects beyond the capacity of the magazine go to the depot, and the
+  // lowest addresses are allocated first.
+  const size_t class_size = class_sizes_[size_class];
+  const size_t num_objects = kSlabBytes / class_size;
+  const size_t num_to_magazine =
+      std::min(num_objects, magazine_capacities_[size_class]);
+  if (num_objects > num_to_magazine) {
+    Depot& depot = depots_[size_class];
+    mutex_lock l(depot.mu);
+    for (size_t i = num_objects; i > num_to_magazine; --i) {
+      depot.free_objects.push_back(slab + (i - 1) * class_size);
+    }
+  }
+  for (size_t i = num_to_magazine; i > 0; --i) {
+    magazine->push_back(slab + (i - 1) * class_size);
+  }
+  return true;
+}
+
+int SlabCPUAllocator::SlabClass(const void* ptr) const {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr) & ~kSlabMask;
+  const size_t mask = (size_t{1} << slab_table_log2_size_) - 1;
+  size_t slot = SlabSlot(address, slab_table_log2_size_);
+  while (true) {
+    const uintptr_t value = slab_table_[slot].load(std::memory_order_acquire);
+    if (value == 0) return -1;
+    if ((value & ~kSlabMask) == address) {
+      return static_cast<int>(value & kSlabMask) - 1;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+void* SlabCPUAllocator::AllocateLarge(size_t alignment, size_t num_bytes) {
+  void* ptr = port::AlignedMalloc(num_bytes, alignment);
+  if (ptr != nullptr && CPUAllocatorStatsEnabled()) {
+    Shard* shard = CurrentShard();
+    mutex_lock l(shard->mu);
+    RecordAllocation(shard, port::MallocExtension_GetAllocatedSize(ptr));
+  }
+  return ptr;
+}
+
+void SlabCPUAllocator::DeallocateLarge(void* ptr) {
+  if (CPUAllocatorStatsEnabled()) {
+    Shard* shard = CurrentShard();
+    mutex_lock l(shard->mu);
+    RecordDeallocation(shard, port::MallocExtension_GetAllocatedSize(ptr));
+  }
+  port::AlignedFree(ptr);
+}
+
+void SlabCPUAllocator::RecordAllocation(Shard* shard, int64_t bytes) {
+  ++shard->num_allocs;
+  shard->bytes_in_use += bytes;
+  shard->largest_alloc_size = std::max(shard->largest_alloc_size, bytes);
+}
+
+void SlabCPUAllocator::RecordDeallocation(Shard* shard, int64_t bytes) {
+  shard->bytes_in_use -= bytes;
+}
+
+size_t SlabCPUAllocator::AllocatedSizeSlow(const void* ptr) const {
+  const int size_class = SlabClass(ptr);
+  if (size_class < 0) return port::MallocExtension_GetAllocatedSize(ptr);
+  return class_sizes_[size_class];
+}
+
+absl::optional<AllocatorStats> SlabCPUAllocator::GetStats() {
+  if (!CPUAllocatorStatsEnabled()) return absl::nullopt;
+  AllocatorStats stats;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    stats.num_allocs += shards_[i].num_allocs;
+    stats.bytes_in_use += shards_[i].bytes_in_use;
+    stats.largest_alloc_size =
+        std::max(stats.largest_alloc_size, shards_[i].largest_alloc_size);
+  }
+  mutex_lock l(stats_mu_);
+  peak_bytes_in_use_ = std::max(peak_bytes_in_use_, stats.bytes_in_use);
+  stats.peak_bytes_in_use = peak_bytes_in_use_;
+  return stats;
+}
+
+bool SlabCPUAllocator::ClearStats() {
+  if (!CPUAllocatorStatsEnabled()) return false;
+  int64_t bytes_in_use = 0;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    shards_[i].num_allocs = 0;
+    shards_[i].largest_alloc_size = 0;
+    bytes_in_use += shards_[i].bytes_in_use;
+  }
+  mutex_lock l(stats_mu_);
+  peak_bytes_in_use_ = bytes_in_use;
+  return true;
+}
+
+size_t SlabCPUAllocator::slab_memory_bytes() const {
+  mutex_lock l(slab_mu_);
+  return slabs_.size() * kSlabBytes;
+}
+
+namespace {
+
+bool UseSlabCPUAllocator() {
+  bool use_slabs = false;
+  Status status =
+      ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_SLABS", false, &use_slabs);
+  if (!status.ok()) {
+    LOG(ERROR) << "SlabCPUAllocator: " << status.message();
+  }
+  return use_slabs;
+}
+
+class SlabCPUAllocatorFactory : public AllocatorFactory {
+ public:
+  Allocator* CreateAllocator() override { return new SlabCPUAllocator; }
+
+  // The sub-allocators feed allocators with their own pools, e.g. a
+  // BFCAllocator, so they do not need the slabs.
+  SubAllocator* CreateSubAllocator(int numa_node) override {
+    return new BasicCPUAllocator(port::kNUMANoAffinity, {}, {});
+  }
+};
+
+// Preferred over the default CPU allocator, and over MklCPUAllocator, only if
+// requested.
+REGISTER_MEM_ALLOCATOR("SlabCPUAllocator", UseSlabCPUAllocator() ? 300 : 50,
+                       SlabCPUAllocatorFactory);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,140 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A CPU allocator for small host tensors, e.g. scalars, shapes and indices.
+//
+// Allocations of at most Options::max_small_allocation_bytes are rounded up to
+// size classes, which are multiples of kAllocatorAlignment, and carved out of
+// slabs of kSlabBytes. The free objects of each class are kept in a magazine
+// per CPU, which is refilled from and flushed to a depot per class in
+// batches, so that most allocations only take the uncontended lock of the
+// magazines of the current CPU. The slabs are only returned to the system
+// when the allocator is destroyed.
+//
+// Larger or over-aligned allocations go to port::AlignedMalloc. As for the
+// default CPU allocator, the stats are only collected while
+// CPUAllocatorStatsEnabled(); they are kept per CPU and summed by GetStats(),
+// whose peak_bytes_in_use is the peak observed by GetStats().
+//
+// Registered with the AllocatorFactoryRegistry as "SlabCPUAllocator", and
+// preferred over the default CPU allocator if TF_CPU_ALLOCATOR_USE_SLABS is
+// true.
+class SlabCPUAllocator : public Allocator {
+ public:
+  static constexpr size_t kSlabBytes = 64 << 10;
+
+  struct Options {
+    // The largest allocation served from the slabs, at most 4KiB.
+    size_t max_small_allocation_bytes = 4 << 10;
+    // The bytes of objects of a class that the magazine of a CPU may keep.
+    size_t max_magazine_bytes = 32 << 10;
+    // The maximum memory of the slabs. Small allocations beyond it go to
+    // port::AlignedMalloc.
+    size_t max_slab_memory_bytes = size_t{1} << 30;
+  };
+
+  SlabCPUAllocator() : SlabCPUAllocator(Options()) {}
+  explicit SlabCPUAllocator(const Options& options);
+  ~SlabCPUAllocator() override;
+
+  std::string Name() override { return "slab_cpu"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  size_t AllocatedSizeSlow(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // Returns the memory of the slabs allocated so far.
+  size_t slab_memory_bytes() const;
+
+ private:
+  struct Shard;
+
+  struct Depot {
+    mutex mu;
+    std::vector<void*> free_objects TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard of the current CPU.
+  Shard* CurrentShard();
+
+  // Refills the empty `magazine` of `size_class` from its depot, or from a new
+  // slab. Returns false if no slab can be allocated.
+  bool Refill(int size_class, std::vector<void*>* magazine);
+  // Moves half of the full `magazine` of `size_class` to its depot.
+  void Flush(int size_class, std::vector<void*>* magazine);
+  bool AllocateSlab(int size_class, std::vector<void*>* magazine);
+
+  // Returns the size class of the slab that contains `ptr`, or -1 if `ptr` was
+  // not allocated from a slab.
+  int SlabClass(const void* ptr) const;
+
+  void* AllocateLarge(size_t alignment, size_t num_bytes);
+  void DeallocateLarge(void* ptr);
+  // Require shard->mu.
+  void RecordAllocation(Shard* shard, int64_t bytes);
+  void RecordDeallocation(Shard* shard, int64_t bytes);
+
+  const Options options_;
+  // The size of each class, and the class of each multiple of
+  // kAllocatorAlignment up to max_small_allocation_bytes.
+  std::vector<size_t> class_sizes_;
+  std::vector<int> class_for_size_;
+  std::vector<size_t> magazine_capacities_;
+  std::unique_ptr<Depot[]> depots_;
+
+  int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+
+  // An insert-only open-addressing table of the slabs, from the address of a
+  // slab to its size class + 1.
+  int slab_table_log2_size_;
+  std::unique_ptr<std::atomic<uintptr_t>[]> slab_table_;
+
+  mutable mutex slab_mu_;
+  std::vector<void*> slabs_ TF_GUARDED_BY(slab_mu_);
+
+  mutex stats_mu_;
+  int64_t peak_bytes_in_use_ TF_GUARDED_BY(stats_mu_) = 0;
+
+  SlabCPUAllocator(const SlabCPUAllocator&) = delete;
+  void operator=(const SlabCPUAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SlabCPUAllocatorTest, ReusesSmallObjects) {
+  SlabCPUAllocator a;
+  void* ptr = a.AllocateRaw(Allocator::kAllocatorAlignment, 8);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) %
+                   Allocator::kAllocatorAlignment);
+  EXPECT_EQ(64, a.AllocatedSizeSlow(ptr));
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, a.slab_memory_bytes());
+  a.DeallocateRaw(ptr);
+  EXPECT_EQ(ptr, a.AllocateRaw(Allocator::kAllocatorAlignment, 64));
+  a.DeallocateRaw(ptr);
+
+  // The allocations are rounded up to their size class.
+  ptr = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(1024, a.AllocatedSizeSlow(ptr));
+  a.DeallocateRaw(ptr);
+  ptr = a.AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  EXPECT_EQ(4096, a.AllocatedSizeSlow(ptr));
+  a.DeallocateRaw(ptr);
+  EXPECT_EQ(3 * SlabCPUAllocator::kSlabBytes, a.slab_memory_bytes());
+}
+
+TEST(SlabCPUAllocatorTest, LargeAllocationsBypassSlabs) {
+  SlabCPUAllocator a;
+  void* ptr = a.AllocateRaw(Allocator::kAllocatorAlignment, 4097);
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0, 4097);
+  a.DeallocateRaw(ptr);
+  ptr = a.AllocateRaw(256, 16);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % 256);
+  a.DeallocateRaw(ptr);
+  EXPECT_EQ(0, a.slab_memory_bytes());
+}
+
+TEST(SlabCPUAllocatorTest, FallsBackBeyondSlabMemory) {
+  SlabCPUAllocator::Options options;
+  options.max_slab_memory_bytes = SlabCPUAllocator::kSlabBytes;
+  SlabCPUAllocator a(options);
+  // Twice as many objects as fit in the slab.
+  constexpr int kNumObjects = 2 * SlabCPUAllocator::kSlabBytes / 4096;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < kNumObjects; ++i) {
+    ptrs.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+    ASSERT_NE(nullptr, ptrs.back());
+    memset(ptrs.back(), i, 4096);
+  }
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, a.slab_memory_bytes());
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+}
+
+TEST(SlabCPUAllocatorTest, CollectsStats) {
+  SlabCPUAllocator a;
+  EnableCPUAllocatorStats();
+  void* small = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* other = a.AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(256, stats->bytes_in_use);
+  EXPECT_EQ(256, stats->peak_bytes_in_use);
+  EXPECT_EQ(128, stats->largest_alloc_size);
+  a.DeallocateRaw(small);
+  a.DeallocateRaw(other);
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(256, stats->peak_bytes_in_use);
+  EXPECT_TRUE(a.ClearStats());
+  EXPECT_EQ(0, a.GetStats()->num_allocs);
+  DisableCPUAllocatorStats();
+  EXPECT_FALSE(a.GetStats());
+}
+
+TEST(SlabCPUAllocatorTest, FreesFromOtherThreads) {
+  SlabCPUAllocator a;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumObjects = 1000;
+  std::vector<std::vector<void*>> ptrs(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumObjects; ++j) {
+      ptrs[i].push_back(
+          a.AllocateRaw(Allocator::kAllocatorAlignment, 64 * (j % 16 + 1)));
+    }
+  }
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(
+          Env::Default()->StartThread({}, "free", [&a, &ptrs, i]() {
+            for (int k = 0; k < 10; ++k) {
+              for (void* ptr : ptrs[i]) {
+                a.DeallocateRaw(ptr);
+              }
+              for (int j = 0; j < kNumObjects; ++j) {
+                const size_t num_bytes = 64 * (j % 16 + 1);
+                ptrs[i][j] =
+                    a.AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+                memset(ptrs[i][j], i, num_bytes);
+              }
+            }
+          }));
+    }
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumObjects; ++j) {
+      EXPECT_EQ(i, static_cast<char*>(ptrs[i][j])[64 * (j % 16 + 1) - 1]);
+      a.DeallocateRaw(ptrs[i][j]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
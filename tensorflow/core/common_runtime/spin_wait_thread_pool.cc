@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/spin_wait_thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+struct PerThread {
+  const SpinWaitThreadPool* pool = nullptr;
+  int thread_id = -1;
+};
+
+PerThread* GetPerThread() {
+  static thread_local PerThread per_thread;
+  return &per_thread;
+}
+
+}  // namespace
+
+SpinWaitThreadPool::SpinWaitThreadPool(const Options& options)
+    : options_(options) {
+  CHECK_GE(options_.num_threads, 1);
+  threads_.reserve(options_.num_threads);
+  for (int i = 0; i < options_.num_threads; ++i) {
+    threads_.push_back(absl::WrapUnique(options_.env->StartThread(
+        options_.thread_options, options_.name,
+        [this, i]() { WorkerLoop(i); })));
+  }
+}
+
+SpinWaitThreadPool::~SpinWaitThreadPool() {
+  {
+    mutex_lock l(mu_);
+    done_.store(true);
+    cv_.notify_all();
+  }
+  // Each thread is joined in its destructor.
+  threads_.clear();
+}
+
+void SpinWaitThreadPool::Schedule(std::function<void()> fn) {
+  DCHECK(fn != nullptr);
+  mutex_lock l(mu_);
+  queue_.push_back(std::move(fn));
+  num_pending_.fetch_add(1);
+  // The spinning threads pick the closure up by themselves, so only wake up a
+  // thread if there are more pending closures than spinning threads. A thread
+  // which stops spinning checks the queue under `mu_` before blocking, so no
+  // closure is left behind.
+  if (num_blocked_ > 0 &&
+      static_cast<int>(queue_.size()) > num_spinning_.load()) {
+    cv_.notify_one();
+  }
+}
+
+int SpinWaitThreadPool::NumThreads() const { return options_.num_threads; }
+
+int SpinWaitThreadPool::CurrentThreadId() const {
+  const PerThread* per_thread = GetPerThread();
+  return per_thread->pool == this ? per_thread->thread_id : -1;
+}
+
+void SpinWaitThreadPool::WorkerLoop(int thread_id) {
+  PerThread* per_thread = GetPerThread();
+  per_thread->pool = this;
+  per_thread->thread_id = thread_id;
+  std::function<void()> fn;
+  while (NextClosure(&fn)) {
+    fn();
+    fn = nullptr;
+  }
+}
+
+bool SpinWaitThreadPool::NextClosure(std::function<void()>* fn) {
+  if (options_.spin_wait_micros > 0) {
+    num_spinning_.fetch_add(1);
+    const uint64 deadline =
+        options_.env->NowMicros() + options_.spin_wait_micros;
+    do {
+      if (num_pending_.load() > 0) {
+        mutex_lock l(mu_);
+        if (TryPop(fn)) {
+          num_spinning_.fetch_sub(1);
+          return true;
+        }
+      }
+    } while (!done_.load() && options_.env->NowMicros() < deadline);
+    num_spinning_.fetch_sub(1);
+  }
+
+  mutex_lock l(mu_);
+  while (!TryPop(fn)) {
+    if (done_.load()) {
+      return false;
+    }
+    ++num_blocked_;
+    num_blocking_waits_.fetch_add(1, std::memory_order_relaxed);
+    cv_.wait(l);
+    --num_blocked_;
+  }
+  return true;
+}
+
+bool SpinWaitThreadPool::TryPop(std::function<void()>* fn) {
+  if (queue_.empty()) {
+    return false;
+  }
+  *fn = std::move(queue_.front());
+  queue_.pop_front();
+  num_pending_.fetch_sub(1);
+  return true;
+}
+
+}  // namespace tensorflow
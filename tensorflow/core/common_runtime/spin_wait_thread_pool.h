@@ -0,0 +1,106 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SPIN_WAIT_THREAD_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SPIN_WAIT_THREAD_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool_interface.h"
+
+namespace tensorflow {
+
+// A thread pool with a fixed number of threads and a FIFO queue, whose idle
+// threads poll the queue during `spin_wait_micros` before blocking on a
+// condition variable.
+//
+// As long as a thread is polling, scheduling a closure does not wake up any
+// thread, so that closures scheduled in quick succession, e.g. the kernels of
+// a step of a small graph, do not pay the latency of a futex wakeup.
+class SpinWaitThreadPool : public thread::ThreadPoolInterface {
+ public:
+  struct Options {
+    Env* env = Env::Default();
+    ThreadOptions thread_options;
+    std::string name = "spin_wait";
+    int num_threads = 1;
+    // How long an idle thread polls the queue before blocking.
+    int64_t spin_wait_micros = 50;
+  };
+
+  explicit SpinWaitThreadPool(const Options& options);
+
+  // Runs the pending closures, then joins the threads.
+  ~SpinWaitThreadPool() override;
+
+  void Schedule(std::function<void()> fn) override;
+
+  int NumThreads() const override;
+
+  // Returns the index of the current thread in the pool, or -1 if it does not
+  // belong to the pool.
+  int CurrentThreadId() const override;
+
+  // Returns the number of times a thread of the pool blocked waiting for
+  // work.
+  int64_t num_blocking_waits() const {
+    return num_blocking_waits_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Runs the closures of the queue until the pool is destroyed.
+  void WorkerLoop(int thread_id);
+
+  // Waits for a closure of the queue, returning false once the pool is
+  // destroyed and the queue is empty.
+  bool NextClosure(std::function<void()>* fn);
+
+  // Pops the front closure of the queue, if any.
+  bool TryPop(std::function<void()>* fn) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutex mu_;
+  condition_variable cv_;
+  std::deque<std::function<void()>> queue_ TF_GUARDED_BY(mu_);
+  // The number of threads blocked on `cv_`.
+  int num_blocked_ TF_GUARDED_BY(mu_) = 0;
+  // Set under `mu_` when the pool is destroyed, and polled without it by the
+  // spinning threads.
+  std::atomic<bool> done_{false};
+
+  // The size of `queue_`, polled without `mu_` by the spinning threads.
+  std::atomic<int64_t> num_pending_{0};
+  // The number of threads polling `num_pending_`.
+  std::atomic<int> num_spinning_{0};
+  std::atomic<int64_t> num_blocking_waits_{0};
+
+  std::vector<std::unique_ptr<Thread>> threads_;
+
+  SpinWaitThreadPool(const SpinWaitThreadPool&) = delete;
+  void operator=(const SpinWaitThreadPool&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SPIN_WAIT_THREAD_POOL_H_
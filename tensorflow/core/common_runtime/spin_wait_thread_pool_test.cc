@@ -0,0 +1,106 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/spin_wait_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+SpinWaitThreadPool::Options MakeOptions(int num_threads,
+                                        int64_t spin_wait_micros) {
+  SpinWaitThreadPool::Options options;
+  options.num_threads = num_threads;
+  options.spin_wait_micros = spin_wait_micros;
+  return options;
+}
+
+TEST(SpinWaitThreadPoolTest, RunsAllClosures) {
+  for (int64_t spin_wait_micros : {0, 50, 10000}) {
+    SpinWaitThreadPool pool(MakeOptions(4, spin_wait_micros));
+    EXPECT_EQ(pool.NumThreads(), 4);
+    constexpr int kNumClosures = 1000;
+    std::atomic<int> count(0);
+    BlockingCounter done(kNumClosures);
+    for (int i = 0; i < kNumClosures; ++i) {
+      pool.Schedule([&]() {
+        count.fetch_add(1);
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+    EXPECT_EQ(count.load(), kNumClosures);
+  }
+}
+
+TEST(SpinWaitThreadPoolTest, RunsPendingClosuresOnDestruction) {
+  std::atomic<int> count(0);
+  {
+    SpinWaitThreadPool pool(MakeOptions(1, 0));
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&count]() { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(SpinWaitThreadPoolTest, CurrentThreadId) {
+  SpinWaitThreadPool pool(MakeOptions(2, 50));
+  EXPECT_EQ(pool.CurrentThreadId(), -1);
+  std::vector<int> ids(10, -1);
+  BlockingCounter done(ids.size());
+  for (int& id : ids) {
+    pool.Schedule([&pool, &id, &done]() {
+      id = pool.CurrentThreadId();
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  for (int id : ids) {
+    EXPECT_GE(id, 0);
+    EXPECT_LT(id, 2);
+  }
+}
+
+TEST(SpinWaitThreadPoolTest, SpinningThreadsDoNotBlock) {
+  // With a spin wait much longer than the test, the threads never block.
+  SpinWaitThreadPool pool(MakeOptions(2, 60 * 1000 * 1000));
+  for (int i = 0; i < 100; ++i) {
+    Notification done;
+    pool.Schedule([&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+  EXPECT_EQ(pool.num_blocking_waits(), 0);
+}
+
+TEST(SpinWaitThreadPoolTest, IdleThreadsBlock) {
+  SpinWaitThreadPool pool(MakeOptions(1, 1));
+  for (int i = 0; i < 10; ++i) {
+    Notification done;
+    pool.Schedule([&done]() { done.Notify(); });
+    done.WaitForNotification();
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  EXPECT_GE(pool.num_blocking_waits(), 10);
+}
+
+}  // namespace
+}  // namespace tensorflow
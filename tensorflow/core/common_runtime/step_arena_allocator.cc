@@ -0,0 +1,179 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+size_t RoundUp(size_t num_bytes, size_t alignment) {
+  return (num_bytes + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base,
+                                       size_t initial_slab_bytes)
+    : base_(base),
+      name_(absl::StrCat("step_arena_", base->Name())),
+      next_slab_bytes_(RoundUp(
+          std::clamp(initial_slab_bytes, kMinSlabBytes, kMaxSlabBytes),
+          kAllocatorAlignment)) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (const auto& [begin, slab] : slabs_) {
+    DCHECK_EQ(slab->num_allocations.load(std::memory_order_relaxed), 0);
+    base_->DeallocateRaw(slab->begin);
+  }
+}
+
+bool StepArenaAllocator::NewSlab() {
+  const size_t slab_bytes = next_slab_bytes_;
+  char* begin =
+      static_cast<char*>(base_->AllocateRaw(kAllocatorAlignment, slab_bytes));
+  if (begin == nullptr) {
+    return false;
+  }
+  if (current_ != nullptr &&
+      current_->num_allocations.load(std::memory_order_relaxed) == 0) {
+    base_->DeallocateRaw(current_->begin);
+    slabs_.erase(current_->begin);
+  }
+  auto slab = std::make_unique<Slab>();
+  slab->begin = begin;
+  slab->num_bytes = slab_bytes;
+  current_ = slab.get();
+  slabs_[begin] = std::move(slab);
+  ++num_slabs_allocated_;
+  next_slab_bytes_ = std::min(2 * next_slab_bytes_, kMaxSlabBytes);
+  return true;
+}
+
+void* StepArenaAllocator::AllocateFromCurrentSlab(size_t num_bytes) {
+  if (current_ == nullptr) {
+    return nullptr;
+  }
+  size_t top = current_->top.load(std::memory_order_relaxed);
+  do {
+    if (num_bytes > current_->num_bytes - top) {
+      return nullptr;
+    }
+  } while (!current_->top.compare_exchange_weak(top, top + num_bytes,
+                                                std::memory_order_relaxed));
+  current_->num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return current_->begin + top;
+}
+
+StepArenaAllocator::Slab* StepArenaAllocator::FindSlab(const char* ptr) const {
+  auto it = slabs_.upper_bound(ptr);
+  if (it == slabs_.begin()) {
+    return nullptr;
+  }
+  Slab* slab = std::prev(it)->second.get();
+  return ptr < slab->begin + slab->num_bytes ? slab : nullptr;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const size_t rounded_bytes = RoundUp(num_bytes, kAllocatorAlignment);
+  allocated_bytes_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+  if (num_bytes > 0 && alignment <= kAllocatorAlignment) {
+    void* ptr;
+    {
+      tf_shared_lock l(mu_);
+      ptr = AllocateFromCurrentSlab(rounded_bytes);
+    }
+    if (ptr == nullptr) {
+      mutex_lock l(mu_);
+      // Another thread may have started a new slab in the meantime.
+      ptr = AllocateFromCurrentSlab(rounded_bytes);
+      // Only the allocations which use at most half of a new slab justify
+      // starting it, unless it is the first slab.
+      const size_t max_new_slab_allocation_bytes =
+          current_ == nullptr ? next_slab_bytes_ : next_slab_bytes_ / 2;
+      if (ptr == nullptr && rounded_bytes <= max_new_slab_allocation_bytes &&
+          NewSlab()) {
+        ptr = AllocateFromCurrentSlab(rounded_bytes);
+      }
+    }
+    if (ptr != nullptr) {
+      Ref();
+      return ptr;
+    }
+  }
+  void* ptr = base_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    Ref();
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  const char* p = static_cast<const char*>(ptr);
+  bool in_slab = false;
+  bool emptied_slab = false;
+  {
+    tf_shared_lock l(mu_);
+    Slab* slab = FindSlab(p);
+    if (slab != nullptr) {
+      in_slab = true;
+      const int64_t num_allocations =
+          slab->num_allocations.fetch_sub(1, std::memory_order_acq_rel);
+      DCHECK_GT(num_allocations, 0);
+      emptied_slab = num_allocations == 1;
+    }
+  }
+  if (emptied_slab) {
+    mutex_lock l(mu_);
+    // The slab may have been allocated from, reset or released since. A slab
+    // found empty with the exclusive lock held holds no live allocation.
+    Slab* slab = FindSlab(p);
+    if (slab != nullptr &&
+        slab->num_allocations.load(std::memory_order_relaxed) == 0) {
+      if (slab == current_) {
+        slab->top.store(0, std::memory_order_relaxed);
+      } else {
+        base_->DeallocateRaw(slab->begin);
+        slabs_.erase(slab->begin);
+      }
+    }
+  }
+  if (!in_slab) {
+    base_->DeallocateRaw(ptr);
+  }
+  // The allocator may be deleted here.
+  Unref();
+}
+
+size_t StepArenaAllocator::allocated_bytes() const {
+  return allocated_bytes_.load(std::memory_order_relaxed);
+}
+
+int64_t StepArenaAllocator::num_slabs_allocated() const {
+  mutex_lock l(mu_);
+  return num_slabs_allocated_;
+}
+
+}  // namespace tensorflow
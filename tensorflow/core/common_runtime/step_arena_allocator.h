@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An allocator which serves the allocations of one executor step by bumping a
+// pointer in large slabs obtained from a base allocator, so that most
+// allocations neither call the base allocator nor contend on its lock.
+//
+// A slab is returned to the base allocator once all its allocations have been
+// deallocated, and the bytes of the current slab are reused once it is empty.
+// Tensors which outlive the step, e.g. the outputs of the step, keep their
+// slab alive, and the allocator itself is reference-counted: each live
+// allocation holds a reference, so that the owner can `Unref()` it at the end
+// of the step.
+//
+// Allocations which are large relative to the slabs, or which require an
+// alignment larger than `Allocator::kAllocatorAlignment`, are delegated to the
+// base allocator.
+//
+// The allocations from the current slab, and the deallocations which leave
+// their slab non-empty, only hold a shared lock and update the slab
+// atomically, so that the concurrent kernels of a step do not serialize on the
+// arena. Starting, resetting and releasing slabs hold the exclusive lock.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  // The bounds of the size of the slabs.
+  static constexpr size_t kMinSlabBytes = 64 << 10;
+  static constexpr size_t kMaxSlabBytes = 16 << 20;
+
+  // `base` must outlive the allocator. The first slab has
+  // `initial_slab_bytes`, clamped to [kMinSlabBytes, kMaxSlabBytes]; e.g. the
+  // `allocated_bytes()` of the arena of the previous step, so that a step
+  // which allocates the same tensors fits into a single slab.
+  StepArenaAllocator(Allocator* base, size_t initial_slab_bytes);
+  ~StepArenaAllocator() override;
+
+  std::string Name() override { return name_; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns the total number of bytes allocated so far, including the
+  // allocations delegated to the base allocator.
+  size_t allocated_bytes() const;
+
+  // Returns the number of slabs obtained from the base allocator so far.
+  int64_t num_slabs_allocated() const;
+
+ private:
+  struct Slab {
+    char* begin;
+    size_t num_bytes;
+    // The offset of the unallocated bytes of the slab. Only reset with the
+    // exclusive lock held.
+    std::atomic<size_t> top{0};
+    std::atomic<int64_t> num_allocations{0};
+  };
+
+  // Bump-allocates `num_bytes` from the current slab, or returns nullptr if
+  // they do not fit.
+  void* AllocateFromCurrentSlab(size_t num_bytes) TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  // Returns the slab which holds `ptr`, or nullptr if none does.
+  Slab* FindSlab(const char* ptr) const TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  // Makes a new slab of `next_slab_bytes_` current. Returns false if the base
+  // allocator failed.
+  bool NewSlab() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;
+  const std::string name_;
+
+  mutable mutex mu_;
+  // The size of the next slab.
+  size_t next_slab_bytes_ TF_GUARDED_BY(mu_);
+  std::atomic<size_t> allocated_bytes_{0};
+  int64_t num_slabs_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // The live slabs, by start address.
+  std::map<const char*, std::unique_ptr<Slab>> slabs_ TF_GUARDED_BY(mu_);
+  // The slab from which the allocations are served. Not owned.
+  Slab* current_ TF_GUARDED_BY(mu_) = nullptr;
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
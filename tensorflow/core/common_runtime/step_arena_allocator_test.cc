@@ -0,0 +1,201 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the live allocations of the wrapped CPU allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_live_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_allocations_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_live_allocations() const { return num_live_allocations_; }
+
+ private:
+  std::atomic<int> num_live_allocations_{0};
+};
+
+TEST(StepArenaAllocatorTest, AllocatesFromOneSlab) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  EXPECT_EQ(arena->Name(), "step_arena_counting");
+
+  void* a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1);
+  void* c = arena->AllocateRaw(16, 1000);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % Allocator::kAllocatorAlignment, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % Allocator::kAllocatorAlignment, 0);
+  EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 128);
+  EXPECT_EQ(static_cast<char*>(c) - static_cast<char*>(b), 64);
+  EXPECT_EQ(arena->num_slabs_allocated(), 1);
+  EXPECT_EQ(arena->allocated_bytes(), 128 + 64 + 1024);
+  EXPECT_EQ(base.num_live_allocations(), 1);
+
+  arena->DeallocateRaw(a);
+  arena->DeallocateRaw(b);
+  arena->DeallocateRaw(c);
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, ReusesEmptySlab) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+    arena->DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(arena->num_slabs_allocated(), 1);
+  EXPECT_EQ(arena->allocated_bytes(), 100 * 4096);
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, FreesFullSlabs) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  const size_t num_bytes = StepArenaAllocator::kMinSlabBytes / 4;
+  void* first = arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+  for (int i = 0; i < 3; ++i) {
+    arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+  }
+  // The first slab is full: the allocation starts a second one.
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+  EXPECT_EQ(arena->num_slabs_allocated(), 2);
+  EXPECT_EQ(base.num_live_allocations(), 2);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_live_allocations(), 2);
+
+  // Frees the first slab once all its allocations are deallocated.
+  for (int i = 0; i < 4; ++i) {
+    arena->DeallocateRaw(static_cast<char*>(first) + i * num_bytes);
+  }
+  EXPECT_EQ(base.num_live_allocations(), 1);
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, DelegatesLargeAllocations) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  void* small = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                   StepArenaAllocator::kMaxSlabBytes);
+  void* aligned = arena->AllocateRaw(1024, 100);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 1024, 0);
+  EXPECT_EQ(arena->num_slabs_allocated(), 1);
+  EXPECT_EQ(base.num_live_allocations(), 3);
+  arena->DeallocateRaw(large);
+  arena->DeallocateRaw(aligned);
+  EXPECT_EQ(base.num_live_allocations(), 1);
+  arena->DeallocateRaw(small);
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, InitialSlabFitsPreviousStep) {
+  CountingAllocator base;
+  size_t allocated_bytes = 0;
+  for (int step = 0; step < 2; ++step) {
+    auto* arena = new StepArenaAllocator(&base, allocated_bytes);
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+      ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                        StepArenaAllocator::kMinSlabBytes / 2));
+    }
+    EXPECT_EQ(arena->num_slabs_allocated(), step == 0 ? 2 : 1);
+    for (void* ptr : ptrs) {
+      arena->DeallocateRaw(ptr);
+    }
+    allocated_bytes = arena->allocated_bytes();
+    arena->Unref();
+  }
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 1000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([arena, t]() {
+        // Each thread keeps some allocations alive while it allocates more,
+        // and checks that no other thread wrote over them.
+        std::vector<char*> ptrs;
+        for (int i = 0; i < kNumAllocations; ++i) {
+          const size_t num_bytes = 64 + (i % 7) * 512;
+          char* ptr = static_cast<char*>(
+              arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes));
+          ASSERT_NE(ptr, nullptr);
+          std::memset(ptr, t, num_bytes);
+          ptrs.push_back(ptr);
+          if (ptrs.size() == 16) {
+            for (char* p : ptrs) {
+              EXPECT_EQ(p[0], t);
+              arena->DeallocateRaw(p);
+            }
+            ptrs.clear();
+          }
+        }
+        for (char* p : ptrs) {
+          EXPECT_EQ(p[0], t);
+          arena->DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, OutlivesOwner) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*initial_slab_bytes=*/0);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  // E.g. the step ends while one of its outputs is still alive.
+  arena->Unref();
+  EXPECT_EQ(base.num_live_allocations(), 1);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_live_allocations(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,388 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/thread_local_caching_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The smallest size class. The size classes above it are the multiples of
+// 2^(k-2) in (2^k, 2^(k+1)], for each k.
+constexpr int kLog2MinClassBytes = 8;
+constexpr size_t kMinClassBytes = size_t{1} << kLog2MinClassBytes;
+constexpr size_t kMaxCachedAllocationBytes = 8 << 20;
+
+// The chunks are aligned to Allocator::kAllocatorAlignment, so the low bits of
+// their address store their size class in the chunk table.
+constexpr uintptr_t kSizeClassMask = Allocator::kAllocatorAlignment - 1;
+constexpr uintptr_t kEmptySlot = 0;
+constexpr uintptr_t kErasedSlot = 1;
+// The maximum number of slots probed when looking up a chunk.
+constexpr int kMaxProbes = 64;
+
+int SizeClass(size_t num_bytes) {
+  if (num_bytes <= kMinClassBytes) return 0;
+  // 2^log2 < num_bytes <= 2^(log2 + 1).
+  const int log2 = Log2Floor64(num_bytes - 1);
+  const size_t step = size_t{1} << (log2 - 2);
+  const size_t num_steps = (num_bytes + step - 1) / step;  // In [5, 8].
+  return 1 + (log2 - kLog2MinClassBytes) * 4 + (num_steps - 5);
+}
+
+size_t SizeClassBytes(int size_class) {
+  if (size_class == 0) return kMinClassBytes;
+  const int log2 = kLog2MinClassBytes + (size_class - 1) / 4;
+  return (5 + (size_class - 1) % 4) * (size_t{1} << (log2 - 2));
+}
+
+std::atomic<uint64> next_allocator_id{1};
+
+}  // namespace
+
+struct ThreadLocalCachingAllocator::ThreadCache {
+  explicit ThreadCache(int num_size_classes) : chunks(num_size_classes) {}
+
+  // Taken by the owning thread, and by `ReleaseCachedChunks` on other threads.
+  // Never acquired before `SharedState::mu` by the owning thread.
+  mutex mu;
+  // The free chunks, by size class.
+  std::vector<std::vector<void*>> chunks TF_GUARDED_BY(mu);
+  size_t bytes TF_GUARDED_BY(mu) = 0;
+};
+
+// The caches of the calling thread, by allocator id.
+class ThreadLocalCachingAllocator::ThreadCacheMap {
+ public:
+  ~ThreadCacheMap() {
+    for (auto& it : caches_) {
+      std::shared_ptr<SharedState> shared = it.second.shared.lock();
+      if (shared == nullptr) continue;
+      mutex_lock l(shared->mu);
+      if (shared->allocator != nullptr) {
+        shared->allocator->ReleaseThreadCache(it.second.cache);
+      }
+    }
+  }
+
+  ThreadCache* Find(uint64 id) {
+    if (id == last_id_) return last_cache_;
+    auto it = caches_.find(id);
+    if (it == caches_.end()) return nullptr;
+    last_id_ = id;
+    last_cache_ = it->second.cache;
+    return last_cache_;
+  }
+
+  void Insert(uint64 id, std::weak_ptr<SharedState> shared,
+              ThreadCache* cache) {
+    caches_[id] = {std::move(shared), cache};
+    last_id_ = id;
+    last_cache_ = cache;
+  }
+
+ private:
+  struct Entry {
+    std::weak_ptr<SharedState> shared;
+    // Owned by the allocator.
+    ThreadCache* cache;
+  };
+
+  uint64 last_id_ = 0;
+  ThreadCache* last_cache_ = nullptr;
+  absl::flat_hash_map<uint64, Entry> caches_;
+};
+
+ThreadLocalCachingAllocator::ThreadLocalCachingAllocator(
+    Allocator* wrapped, const Options& options)
+    : wrapped_(wrapped),
+      options_(options),
+      num_size_classes_(
+          SizeClass(std::min(std::max(options.max_cached_allocation_bytes,
+                                      size_t{1}),
+                             kMaxCachedAllocationBytes)) +
+          1),
+      id_(next_allocator_id.fetch_add(1, std::memory_order_relaxed)),
+      shared_(std::make_shared<SharedState>()) {
+  DCHECK_LE(options_.max_cached_allocation_bytes, kMaxCachedAllocationBytes);
+  DCHECK_LE(num_size_classes_, kSizeClassMask + 1);
+  chunk_table_log2_size_ =
+      Log2Ceiling64(std::max<int64_t>(2 * options_.max_cached_chunks, 2));
+  const size_t table_size = size_t{1} << chunk_table_log2_size_;
+  chunk_table_.reset(new std::atomic<uintptr_t>[table_size]);
+  for (size_t i = 0; i < table_size; ++i) {
+    chunk_table_[i].store(kEmptySlot, std::memory_order_relaxed);
+  }
+  mutex_lock l(shared_->mu);
+  shared_->allocator = this;
+  central_chunks_.resize(num_size_classes_);
+}
+
+ThreadLocalCachingAllocator::~ThreadLocalCachingAllocator() {
+  mutex_lock l(shared_->mu);
+  // No thread may use this allocator anymore, so their caches can be drained
+  // from here.
+  for (const auto& cache : thread_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    for (const std::vector<void*>& chunks : cache->chunks) {
+      for (void* ptr : chunks) ReturnToWrapped(ptr);
+    }
+  }
+  thread_caches_.clear();
+  for (const std::vector<void*>& chunks : central_chunks_) {
+    for (void* ptr : chunks) ReturnToWrapped(ptr);
+  }
+  central_chunks_.clear();
+  shared_->allocator = nullptr;
+}
+
+void* ThreadLocalCachingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  // The chunks freed with a timestamp must go back to the wrapped allocator,
+  // which decides when they are safe to reuse.
+  if (num_bytes == 0 || num_bytes > options_.max_cached_allocation_bytes ||
+      alignment > Allocator::kAllocatorAlignment ||
+      allocation_attr.freed_by_func != nullptr) {
+    return AllocateFromWrapped(alignment, num_bytes, allocation_attr);
+  }
+  const int size_class = SizeClass(num_bytes);
+  ThreadCache* cache = GetThreadCache();
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    if (!chunks.empty()) {
+      void* ptr = chunks.back();
+      chunks.pop_back();
+      cache->bytes -= SizeClassBytes(size_class);
+      return ptr;
+    }
+  }
+  return AllocateUncachedChunk(cache, size_class, allocation_attr);
+}
+
+void ThreadLocalCachingAllocator::DeallocateRaw(void* ptr) {
+  const int size_class = LookupChunk(ptr);
+  if (size_class < 0) {
+    wrapped_->DeallocateRaw(ptr);
+    return;
+  }
+  ThreadCache* cache = GetThreadCache();
+  const size_t num_bytes = SizeClassBytes(size_class);
+  {
+    mutex_lock l(cache->mu);
+    if (cache->bytes + num_bytes <= options_.max_bytes_per_thread) {
+      cache->chunks[size_class].push_back(ptr);
+      cache->bytes += num_bytes;
+      return;
+    }
+  }
+  FlushToCentral(cache, size_class, ptr);
+}
+
+size_t ThreadLocalCachingAllocator::ReleaseCachedChunks() {
+  mutex_lock l(shared_->mu);
+  size_t released_bytes = central_bytes_;
+  for (const auto& cache : thread_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    for (std::vector<void*>& chunks : cache->chunks) {
+      for (void* ptr : chunks) ReturnToWrapped(ptr);
+      chunks.clear();
+    }
+    released_bytes += cache->bytes;
+    cache->bytes = 0;
+  }
+  for (std::vector<void*>& chunks : central_chunks_) {
+    for (void* ptr : chunks) ReturnToWrapped(ptr);
+    chunks.clear();
+  }
+  central_bytes_ = 0;
+  return released_bytes;
+}
+
+size_t ThreadLocalCachingAllocator::central_bytes() const {
+  mutex_lock l(shared_->mu);
+  return central_bytes_;
+}
+
+ThreadLocalCachingAllocator::ThreadCache*
+ThreadLocalCachingAllocator::GetThreadCache() {
+  static thread_local ThreadCacheMap thread_caches;
+  ThreadCache* cache = thread_caches.Find(id_);
+  if (cache != nullptr) return cache;
+  auto new_cache = std::make_unique<ThreadCache>(num_size_classes_);
+  cache = new_cache.get();
+  {
+    mutex_lock l(shared_->mu);
+    thread_caches_.push_back(std::move(new_cache));
+  }
+  thread_caches.Insert(id_, shared_, cache);
+  return cache;
+}
+
+void* ThreadLocalCachingAllocator::AllocateFromWrapped(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  // The caches may hold the memory that the allocation needs.
+  if (ptr == nullptr && ReleaseCachedChunks() > 0) {
+    ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  return ptr;
+}
+
+void* ThreadLocalCachingAllocator::AllocateUncachedChunk(
+    ThreadCache* cache, int size_class,
+    const AllocationAttributes& allocation_attr) {
+  const size_t num_bytes = SizeClassBytes(size_class);
+  std::vector<void*> batch;
+  {
+    mutex_lock l(shared_->mu);
+    std::vector<void*>& central_chunks = central_chunks_[size_class];
+    const int batch_size =
+        std::min<size_t>(options_.batch_size, central_chunks.size());
+    batch.assign(central_chunks.end() - batch_size, central_chunks.end());
+    central_chunks.resize(central_chunks.size() - batch_size);
+    central_bytes_ -= batch_size * num_bytes;
+  }
+  if (!batch.empty()) {
+    void* ptr = batch.back();
+    batch.pop_back();
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    chunks.insert(chunks.end(), batch.begin(), batch.end());
+    cache->bytes += batch.size() * num_bytes;
+    return ptr;
+  }
+
+  void* ptr = AllocateFromWrapped(Allocator::kAllocatorAlignment, num_bytes,
+                                  allocation_attr);
+  // If the chunk cannot be inserted, it is freed to the wrapped allocator.
+  if (ptr != nullptr) InsertChunk(ptr, size_class);
+  return ptr;
+}
+
+void ThreadLocalCachingAllocator::FlushToCentral(ThreadCache* cache,
+                                                 int size_class, void* ptr) {
+  const size_t num_bytes = SizeClassBytes(size_class);
+  std::vector<void*> batch = {ptr};
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    const int batch_size =
+        std::min<size_t>(options_.batch_size - 1, chunks.size());
+    batch.insert(batch.end(), chunks.end() - batch_size, chunks.end());
+    chunks.resize(chunks.size() - batch_size);
+    cache->bytes -= batch_size * num_bytes;
+  }
+  mutex_lock l(shared_->mu);
+  for (void* chunk : batch) {
+    AddToCentralLocked(size_class, chunk);
+  }
+}
+
+void ThreadLocalCachingAllocator::ReleaseThreadCache(ThreadCache* cache) {
+  {
+    mutex_lock cache_lock(cache->mu);
+    for (int size_class = 0; size_class < cache->chunks.size(); ++size_class) {
+      for (void* ptr : cache->chunks[size_class]) {
+        AddToCentralLocked(size_class, ptr);
+      }
+    }
+  }
+  auto it = std::find_if(thread_caches_.begin(), thread_caches_.end(),
+                         [cache](const std::unique_ptr<ThreadCache>& c) {
+                           return c.get() == cache;
+                         });
+  if (it != thread_caches_.end()) thread_caches_.erase(it);
+}
+
+void ThreadLocalCachingAllocator::AddToCentralLocked(int size_class,
+                                                     void* ptr) {
+  const size_t num_bytes = SizeClassBytes(size_class);
+  if (central_bytes_ + num_bytes > options_.max_central_bytes) {
+    ReturnToWrapped(ptr);
+    return;
+  }
+  central_chunks_[size_class].push_back(ptr);
+  central_bytes_ += num_bytes;
+}
+
+void ThreadLocalCachingAllocator::ReturnToWrapped(void* ptr) {
+  EraseChunk(ptr);
+  wrapped_->DeallocateRaw(ptr);
+}
+
+size_t ThreadLocalCachingAllocator::ChunkSlot(const void* ptr) const {
+  const uint64 hash = (reinterpret_cast<uintptr_t>(ptr) >> 6) *
+                      uint64{0x9e3779b97f4a7c15};
+  return hash >> (64 - chunk_table_log2_size_);
+}
+
+bool ThreadLocalCachingAllocator::InsertChunk(void* ptr, int size_class) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  if ((address & kSizeClassMask) != 0) return false;
+  const uintptr_t entry = address | size_class;
+  const size_t mask = (size_t{1} << chunk_table_log2_size_) - 1;
+  size_t slot = ChunkSlot(ptr);
+  for (int i = 0; i < kMaxProbes; ++i, slot = (slot + 1) & mask) {
+    uintptr_t value = chunk_table_[slot].load(std::memory_order_relaxed);
+    while (value == kEmptySlot || value == kErasedSlot) {
+      if (chunk_table_[slot].compare_exchange_weak(
+              value, entry, std::memory_order_release,
+              std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+int ThreadLocalCachingAllocator::LookupChunk(const void* ptr) const {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  const size_t mask = (size_t{1} << chunk_table_log2_size_) - 1;
+  size_t slot = ChunkSlot(ptr);
+  for (int i = 0; i < kMaxProbes; ++i, slot = (slot + 1) & mask) {
+    const uintptr_t value = chunk_table_[slot].load(std::memory_order_acquire);
+    if (value == kEmptySlot) return -1;
+    if ((value & ~kSizeClassMask) == address) {
+      return value & kSizeClassMask;
+    }
+  }
+  return -1;
+}
+
+void ThreadLocalCachingAllocator::EraseChunk(const void* ptr) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  const size_t mask = (size_t{1} << chunk_table_log2_size_) - 1;
+  size_t slot = ChunkSlot(ptr);
+  for (int i = 0; i < kMaxProbes; ++i, slot = (slot + 1) & mask) {
+    const uintptr_t value = chunk_table_[slot].load(std::memory_order_relaxed);
+    if (value == kEmptySlot) return;
+    if ((value & ~kSizeClassMask) == address) {
+      chunk_table_[slot].store(kErasedSlot, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,191 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_LOCAL_CACHING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_LOCAL_CACHING_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that keeps the recently freed small chunks of a wrapped
+// allocator, e.g. a BFCAllocator, in per-thread caches, so that allocating and
+// freeing them does not take the lock of the wrapped allocator.
+//
+// The chunks are rounded up to size classes whose internal fragmentation is
+// at most 25%. When the cache of a thread exceeds its capacity, a batch of its
+// chunks moves to a central free list, from which the caches of all threads
+// are refilled in batches, and which returns the chunks to the wrapped
+// allocator beyond its own capacity. The chunks cached by a thread return to
+// the central free list when the thread exits.
+//
+// When the wrapped allocator fails, e.g. for a large allocation while the
+// memory is held by the caches, the caches of all threads and the central free
+// list are drained to it and the allocation is retried. Each thread cache has
+// its own lock, which is only contended while they are drained.
+//
+// The cached chunks count as in use in the stats of the wrapped allocator, and
+// the requested size of a cached chunk is the size of its class.
+class ThreadLocalCachingAllocator : public Allocator {
+ public:
+  struct Options {
+    // The largest allocation served by the caches, at most 8MiB. Larger ones
+    // go to the wrapped allocator directly.
+    size_t max_cached_allocation_bytes = 256 << 10;
+    // The bytes that each thread may keep in its cache.
+    size_t max_bytes_per_thread = 4 << 20;
+    // The bytes that the central free list may keep.
+    size_t max_central_bytes = 64 << 20;
+    // The number of chunks that move at once between the cache of a thread
+    // and the central free list.
+    int batch_size = 16;
+    // The maximum number of chunks owned by the caches at any time. Chunks
+    // allocated beyond it are not cached.
+    int64_t max_cached_chunks = 1 << 16;
+  };
+
+  // Takes ownership of `wrapped`.
+  ThreadLocalCachingAllocator(Allocator* wrapped, const Options& options);
+  ~ThreadLocalCachingAllocator() override;
+
+  std::string Name() override { return wrapped_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override {
+    return wrapped_->TracksAllocationSizes();
+  }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return wrapped_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return wrapped_->AllocatedSize(ptr);
+  }
+
+  int64_t AllocationId(const void* ptr) const override {
+    return wrapped_->AllocationId(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+
+  bool ClearStats() override { return wrapped_->ClearStats(); }
+
+  void SetSafeFrontier(uint64 count) override {
+    wrapped_->SetSafeFrontier(count);
+  }
+
+  void SetStreamAndPreallocateMemory(void* stream) override {
+    wrapped_->SetStreamAndPreallocateMemory(stream);
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+  // Returns the chunks of the central free list and of the caches of all the
+  // threads to the wrapped allocator. Returns the number of bytes released.
+  size_t ReleaseCachedChunks();
+
+  // Returns the bytes of the chunks in the central free list.
+  size_t central_bytes() const;
+
+ private:
+  struct ThreadCache;
+  class ThreadCacheMap;
+
+  struct SharedState {
+    mutex mu;
+    // Null once the allocator is destroyed.
+    ThreadLocalCachingAllocator* allocator TF_GUARDED_BY(mu);
+  };
+
+  // Returns the cache of the calling thread, creating it on first use.
+  ThreadCache* GetThreadCache();
+
+  // Allocates from the wrapped allocator, and retries after draining the
+  // caches if it fails.
+  void* AllocateFromWrapped(size_t alignment, size_t num_bytes,
+                            const AllocationAttributes& allocation_attr);
+
+  // Gets a chunk of `size_class` for the calling thread, whose cache has none,
+  // from the central free list or the wrapped allocator.
+  void* AllocateUncachedChunk(ThreadCache* cache, int size_class,
+                              const AllocationAttributes& allocation_attr);
+
+  // Moves `ptr` and a batch of the chunks of `size_class` of `cache` to the
+  // central free list.
+  void FlushToCentral(ThreadCache* cache, int size_class, void* ptr);
+
+  // Moves the chunks of a thread `cache` to the central free list, and
+  // destroys the cache.
+  void ReleaseThreadCache(ThreadCache* cache)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shared_->mu);
+
+  void AddToCentralLocked(int size_class, void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shared_->mu);
+  void ReturnToWrapped(void* ptr);
+
+  // A lock-free open-addressing table of the chunks owned by the caches, from
+  // the address of a chunk to its size class.
+  bool InsertChunk(void* ptr, int size_class);
+  // Returns -1 if `ptr` is not owned by the caches.
+  int LookupChunk(const void* ptr) const;
+  void EraseChunk(const void* ptr);
+  size_t ChunkSlot(const void* ptr) const;
+
+  const std::unique_ptr<Allocator> wrapped_;
+  const Options options_;
+  const int num_size_classes_;
+  // Identifies this allocator among the allocators cached by a thread, even
+  // if another allocator is later created at the same address.
+  const uint64 id_;
+
+  int chunk_table_log2_size_;
+  std::unique_ptr<std::atomic<uintptr_t>[]> chunk_table_;
+
+  // Shared with the threads, which may exit after this allocator is destroyed.
+  std::shared_ptr<SharedState> shared_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_
+      TF_GUARDED_BY(shared_->mu);
+  // The chunks of the central free list, by size class.
+  std::vector<std::vector<void*>> central_chunks_ TF_GUARDED_BY(shared_->mu);
+  size_t central_bytes_ TF_GUARDED_BY(shared_->mu) = 0;
+
+  ThreadLocalCachingAllocator(const ThreadLocalCachingAllocator&) = delete;
+  void operator=(const ThreadLocalCachingAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_LOCAL_CACHING_ALLOCATOR_H_
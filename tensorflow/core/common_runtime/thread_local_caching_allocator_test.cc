@@ -0,0 +1,259 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/thread_local_caching_allocator.h"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// The allocations of a CountingAllocator, which may outlive it.
+struct Allocations {
+  mutex mu;
+  absl::flat_hash_map<void*, size_t> sizes TF_GUARDED_BY(mu);
+  int num_allocations TF_GUARDED_BY(mu) = 0;
+  size_t live_bytes TF_GUARDED_BY(mu) = 0;
+  // The allocations which would exceed it fail, like a device out of memory.
+  size_t max_live_bytes TF_GUARDED_BY(mu) = std::numeric_limits<size_t>::max();
+};
+
+class CountingAllocator : public Allocator {
+ public:
+  explicit CountingAllocator(Allocations* allocations)
+      : allocations_(allocations) {}
+
+  std::string Name() override { return "counting"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    mutex_lock l(allocations_->mu);
+    if (allocations_->live_bytes + num_bytes > allocations_->max_live_bytes) {
+      return nullptr;
+    }
+    void* ptr = port::AlignedMalloc(num_bytes, alignment);
+    allocations_->sizes[ptr] = num_bytes;
+    allocations_->live_bytes += num_bytes;
+    ++allocations_->num_allocations;
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    {
+      mutex_lock l(allocations_->mu);
+      auto it = allocations_->sizes.find(ptr);
+      CHECK(it != allocations_->sizes.end());
+      allocations_->live_bytes -= it->second;
+      allocations_->sizes.erase(it);
+    }
+    port::AlignedFree(ptr);
+  }
+
+  bool TracksAllocationSizes() const override { return true; }
+
+  size_t RequestedSize(const void* ptr) const override {
+    mutex_lock l(allocations_->mu);
+    return allocations_->sizes.at(const_cast<void*>(ptr));
+  }
+
+ private:
+  Allocations* const allocations_;
+};
+
+class ThreadLocalCachingAllocatorTest : public ::testing::Test {
+ protected:
+  void CreateAllocator(const ThreadLocalCachingAllocator::Options& options) {
+    allocator_ = std::make_unique<ThreadLocalCachingAllocator>(
+        new CountingAllocator(&allocations_), options);
+  }
+
+  int num_allocations() {
+    mutex_lock l(allocations_.mu);
+    return allocations_.num_allocations;
+  }
+
+  int num_live_allocations() {
+    mutex_lock l(allocations_.mu);
+    return allocations_.sizes.size();
+  }
+
+  void set_max_live_bytes(size_t max_live_bytes) {
+    mutex_lock l(allocations_.mu);
+    allocations_.max_live_bytes = max_live_bytes;
+  }
+
+  Allocations allocations_;
+  std::unique_ptr<ThreadLocalCachingAllocator> allocator_;
+};
+
+TEST_F(ThreadLocalCachingAllocatorTest, ReusesFreedChunks) {
+  CreateAllocator({});
+  void* ptr = allocator_->AllocateRaw(64, 1000);
+  // The allocation is rounded up to its size class.
+  EXPECT_EQ(1024, allocator_->RequestedSize(ptr));
+  allocator_->DeallocateRaw(ptr);
+  EXPECT_EQ(1, num_live_allocations());
+
+  EXPECT_EQ(ptr, allocator_->AllocateRaw(64, 1024));
+  EXPECT_EQ(1, num_allocations());
+  allocator_->DeallocateRaw(ptr);
+
+  allocator_.reset();
+  EXPECT_EQ(0, num_live_allocations());
+}
+
+TEST_F(ThreadLocalCachingAllocatorTest, DoesNotCacheLargeAllocations) {
+  ThreadLocalCachingAllocator::Options options;
+  options.max_cached_allocation_bytes = 4096;
+  CreateAllocator(options);
+  void* ptr = allocator_->AllocateRaw(64, 4097);
+  EXPECT_EQ(4097, allocator_->RequestedSize(ptr));
+  allocator_->DeallocateRaw(ptr);
+  EXPECT_EQ(0, num_live_allocations());
+
+  // Over-aligned allocations are not cached either.
+  ptr = allocator_->AllocateRaw(128, 1024);
+  allocator_->DeallocateRaw(ptr);
+  EXPECT_EQ(0, num_live_allocations());
+}
+
+TEST_F(ThreadLocalCachingAllocatorTest, FlushesToCentralFreeList) {
+  ThreadLocalCachingAllocator::Options options;
+  options.max_bytes_per_thread = 4096;
+  options.batch_size = 2;
+  CreateAllocator(options);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(allocator_->AllocateRaw(64, 1024));
+  }
+  for (void* ptr : ptrs) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  // The thread cache keeps at most 4 chunks.
+  EXPECT_EQ(4 * 1024, allocator_->central_bytes());
+  EXPECT_EQ(8, num_live_allocations());
+
+  // The other threads refill their cache from the central free list.
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread({}, "refill", [this]() {
+        allocator_->DeallocateRaw(allocator_->AllocateRaw(64, 1024));
+      }));
+  thread.reset();
+  EXPECT_EQ(8, num_allocations());
+
+  allocator_->ReleaseCachedChunks();
+  EXPECT_EQ(0, allocator_->central_bytes());
+  EXPECT_EQ(0, num_live_allocations());
+}
+
+TEST_F(ThreadLocalCachingAllocatorTest, FreesFromOtherThreads) {
+  CreateAllocator({});
+  constexpr int kNumThreads = 4;
+  constexpr int kNumChunks = 100;
+  std::vector<std::vector<void*>> ptrs(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumChunks; ++j) {
+      ptrs[i].push_back(allocator_->AllocateRaw(64, 256 * (j % 10 + 1)));
+    }
+  }
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(
+          Env::Default()->StartThread({}, "free", [this, &ptrs, i]() {
+            for (int k = 0; k < 10; ++k) {
+              for (void* ptr : ptrs[i]) {
+                allocator_->DeallocateRaw(ptr);
+              }
+              for (int j = 0; j < kNumChunks; ++j) {
+                ptrs[i][j] = allocator_->AllocateRaw(64, 256 * (j % 10 + 1));
+              }
+            }
+            for (void* ptr : ptrs[i]) {
+              allocator_->DeallocateRaw(ptr);
+            }
+          }));
+    }
+  }
+  // The exited threads returned their chunks to the central free list.
+  EXPECT_GT(allocator_->central_bytes(), 0);
+  EXPECT_EQ(kNumThreads * kNumChunks, num_live_allocations());
+
+  allocator_.reset();
+  EXPECT_EQ(0, num_live_allocations());
+}
+
+TEST_F(ThreadLocalCachingAllocatorTest, DrainsCachesWhenOutOfMemory) {
+  ThreadLocalCachingAllocator::Options options;
+  options.max_cached_allocation_bytes = 4096;
+  CreateAllocator(options);
+  set_max_live_bytes(8192);
+
+  // Another thread keeps 4KiB in its cache.
+  Notification cached, done;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread({}, "cache", [this, &cached, &done]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 4; ++i) {
+          ptrs.push_back(allocator_->AllocateRaw(64, 1024));
+        }
+        for (void* ptr : ptrs) {
+          allocator_->DeallocateRaw(ptr);
+        }
+        cached.Notify();
+        done.WaitForNotification();
+      }));
+  cached.WaitForNotification();
+  EXPECT_EQ(4, num_live_allocations());
+
+  // A large allocation only fits once the cache of the other thread is
+  // drained.
+  void* large = allocator_->AllocateRaw(64, 6000);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(1, num_live_allocations());
+  allocator_->DeallocateRaw(large);
+
+  // So does an uncached chunk, after the calling thread cached the others.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 6; ++i) {
+    ptrs.push_back(allocator_->AllocateRaw(64, 1024));
+  }
+  for (void* ptr : ptrs) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  void* chunk = allocator_->AllocateRaw(64, 4096);
+  ASSERT_NE(chunk, nullptr);
+  allocator_->DeallocateRaw(chunk);
+
+  // Fails if it does not fit even with the caches drained.
+  EXPECT_EQ(allocator_->AllocateRaw(64, 10000), nullptr);
+
+  done.Notify();
+  thread.reset();
+  allocator_.reset();
+  EXPECT_EQ(0, num_live_allocations());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -29,6 +29,7 @@ info. It does not have any negative impact on performance. */
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
@@ -40,7 +41,12 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -53,6 +59,43 @@ info. It does not have any negative impact on performance. */
 #endif  // INTEL_MKL
 
 namespace tensorflow {
+namespace {
+
+// Returns the inter-op thread pool of the given NUMA node, which is shared by
+// all the devices of the node, and whose threads are pinned to the node.
+thread::ThreadPool* GetNumaInterOpThreadPool(const SessionOptions& options,
+                                             int numa_node) {
+  static mutex& mu = *new mutex;
+  static auto& pools = *new gtl::InlinedVector<thread::ThreadPool*, 4>;
+
+  mutex_lock l(mu);
+  while (pools.size() <= numa_node) {
+    pools.push_back(nullptr);
+  }
+  if (pools[numa_node] == nullptr) {
+    // Use the session setting, else the environment setting, else the
+    // parallelism of the node.
+    int32_t num_threads = options.config.inter_op_parallelism_threads();
+    if (num_threads <= 0) {
+      num_threads = NumInterOpThreadsFromEnvironment();
+    }
+    if (num_threads <= 0) {
+      num_threads = port::MaxParallelism(numa_node);
+    }
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    pools[numa_node] = new thread::ThreadPool(
+        options.env, thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+    VLOG(1) << "NUMA node " << numa_node << " inter-op thread pool: "
+            << num_threads << " threads";
+  }
+  return pools[numa_node];
+}
+
+}  // namespace
 
 ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                    const string& name, Bytes memory_limit,
@@ -73,6 +116,13 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
     }
   }
 
+  if (options.config.experimental().use_numa_affinity() &&
+      options.config.experimental().use_numa_inter_op_thread_pools() &&
+      locality.numa_node() != port::kNUMANoAffinity) {
+    set_tensorflow_device_thread_pool(
+        GetNumaInterOpThreadPool(options, locality.numa_node()));
+  }
+
 #if defined(ENABLE_ONEDNN_OPENMP) && defined(INTEL_MKL)
   // Early return when MKL is disabled
   if (!IsMKLEnabled()) return;
@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+
+ReadaheadFile::ReadaheadFile(std::unique_ptr<RandomAccessFile> file,
+                             thread::ThreadPool* thread_pool, size_t block_size,
+                             int64_t num_blocks)
+    : file_(std::move(file)),
+      thread_pool_(thread_pool),
+      block_size_(block_size),
+      num_blocks_(std::max<int64_t>(num_blocks, 1)) {
+  DCHECK_GT(block_size_, 0);
+}
+
+ReadaheadFile::~ReadaheadFile() {
+  mutex_lock l(mu_);
+  while (num_outstanding_reads_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+Status ReadaheadFile::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ReadaheadFile::Read(uint64 offset, size_t n, StringPiece* result,
+                           char* scratch) const {
+  mutex_lock l(mu_);
+  size_t bytes_read = 0;
+  Status status;
+  while (bytes_read < n) {
+    const uint64 position = offset + bytes_read;
+    const uint64 index = position / block_size_;
+    std::shared_ptr<Block> block = GetBlock(index);
+    while (!block->done) {
+      cond_var_.wait(l);
+    }
+    const size_t block_offset = position - index * block_size_;
+    if (block_offset < block->data.size()) {
+      const size_t to_copy =
+          std::min(n - bytes_read, block->data.size() - block_offset);
+      std::memcpy(scratch + bytes_read, block->data.data() + block_offset,
+                  to_copy);
+      bytes_read += to_copy;
+    }
+    if (bytes_read < n && block->data.size() < block_size_) {
+      // The block is short, either because of an error or because it is the
+      // last block of the file.
+      status = block->status.ok()
+                   ? errors::OutOfRange("Read less bytes than requested")
+                   : block->status;
+      break;
+    }
+  }
+  *result = StringPiece(scratch, bytes_read);
+  return status;
+}
+
+std::shared_ptr<ReadaheadFile::Block> ReadaheadFile::GetBlock(
+    uint64 index) const {
+  if (!blocks_.empty() && blocks_.front()->index > index) {
+    // Backwards seek: restart the readahead window at `index`.
+    blocks_.clear();
+  }
+  while (!blocks_.empty() && blocks_.front()->index < index) {
+    blocks_.pop_front();
+  }
+  if (blocks_.empty()) {
+    ScheduleRead(index);
+  }
+  while (blocks_.size() < static_cast<size_t>(num_blocks_) &&
+         blocks_.back()->index < eof_index_) {
+    ScheduleRead(blocks_.back()->index + 1);
+  }
+  return blocks_.front();
+}
+
+void ReadaheadFile::ScheduleRead(uint64 index) const {
+  auto block = std::make_shared<Block>(index);
+  blocks_.push_back(block);
+  ++num_outstanding_reads_;
+  thread_pool_->Schedule([this, block]() {
+    std::string data;
+    data.resize(block_size_);
+    StringPiece result;
+    Status s =
+        file_->Read(block->index * block_size_, block_size_, &result, &data[0]);
+    if (result.data() == data.data()) {
+      data.resize(result.size());
+    } else {
+      data.assign(result.data(), result.size());
+    }
+    mutex_lock l(mu_);
+    block->data = std::move(data);
+    block->status = s;
+    block->done = true;
+    if (block->data.size() < block_size_) {
+      eof_index_ = std::min(eof_index_, block->index);
+    }
+    --num_outstanding_reads_;
+    cond_var_.notify_all();
+  });
+}
+
+}  // namespace data
+}  // namespace tensorflow
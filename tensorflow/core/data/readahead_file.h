@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
+#define TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `RandomAccessFile` that keeps up to `num_blocks` block reads of the
+// underlying file in flight ahead of the current read position.
+//
+// The file is split into fixed-size blocks. A read for a block schedules reads
+// for the blocks that follow it on `thread_pool`, so that sequential readers
+// (such as `io::SequentialRecordReader`) find their data already fetched
+// instead of waiting on the latency of the underlying filesystem. Reads that
+// move backwards discard the readahead window.
+//
+// Thread-safe. The destructor blocks until all in-flight reads complete.
+class ReadaheadFile : public RandomAccessFile {
+ public:
+  // `thread_pool` is not owned and must outlive this object.
+  ReadaheadFile(std::unique_ptr<RandomAccessFile> file,
+                thread::ThreadPool* thread_pool, size_t block_size,
+                int64_t num_blocks);
+  ~ReadaheadFile() override;
+
+  Status Name(StringPiece* result) const override;
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override;
+
+ private:
+  struct Block {
+    explicit Block(uint64 index) : index(index) {}
+
+    const uint64 index;
+    std::string data;
+    Status status;
+    bool done = false;
+  };
+
+  // Returns the block with the given index, scheduling reads for it and the
+  // blocks following it as needed.
+  std::shared_ptr<Block> GetBlock(uint64 index) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Schedules a read of the block with the given index.
+  void ScheduleRead(uint64 index) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  const size_t block_size_;
+  const int64_t num_blocks_;
+
+  mutable mutex mu_;
+  mutable condition_variable cond_var_;
+  // Blocks with consecutive indices starting at the most recently read block.
+  mutable std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  // Index of the first block known to extend past the end of the file.
+  mutable uint64 eof_index_ TF_GUARDED_BY(mu_) =
+      std::numeric_limits<uint64>::max();
+  mutable int64_t num_outstanding_reads_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
@@ -0,0 +1,95 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class ReadaheadFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    contents_.resize(1000);
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<char>('a' + i % 26);
+    }
+    filename_ = io::JoinPath(testing::TmpDir(), "readahead_file_test");
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_, contents_));
+  }
+
+  std::unique_ptr<ReadaheadFile> MakeFile(size_t block_size,
+                                          int64_t num_blocks) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename_, &file));
+    return std::make_unique<ReadaheadFile>(std::move(file), &thread_pool_,
+                                           block_size, num_blocks);
+  }
+
+  thread::ThreadPool thread_pool_{Env::Default(), "readahead_test", 4};
+  std::string filename_;
+  std::string contents_;
+};
+
+TEST_F(ReadaheadFileTest, SequentialReads) {
+  for (size_t block_size : {1, 7, 64, 1000, 4096}) {
+    for (int64_t num_blocks : {1, 4}) {
+      auto file = MakeFile(block_size, num_blocks);
+      std::vector<char> scratch(100);
+      for (uint64 offset = 0; offset < contents_.size(); offset += 100) {
+        StringPiece result;
+        TF_ASSERT_OK(file->Read(offset, 100, &result, scratch.data()));
+        EXPECT_EQ(result, StringPiece(contents_).substr(offset, 100));
+      }
+    }
+  }
+}
+
+TEST_F(ReadaheadFileTest, ReadPastEndOfFile) {
+  auto file = MakeFile(/*block_size=*/64, /*num_blocks=*/4);
+  std::vector<char> scratch(100);
+  StringPiece result;
+  Status s = file->Read(950, 100, &result, scratch.data());
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_EQ(result, StringPiece(contents_).substr(950));
+
+  s = file->Read(2000, 100, &result, scratch.data());
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(ReadaheadFileTest, BackwardsSeek) {
+  auto file = MakeFile(/*block_size=*/64, /*num_blocks=*/4);
+  std::vector<char> scratch(10);
+  StringPiece result;
+  TF_ASSERT_OK(file->Read(500, 10, &result, scratch.data()));
+  EXPECT_EQ(result, StringPiece(contents_).substr(500, 10));
+  TF_ASSERT_OK(file->Read(3, 10, &result, scratch.data()));
+  EXPECT_EQ(result, StringPiece(contents_).substr(3, 10));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
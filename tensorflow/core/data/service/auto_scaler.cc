@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
 
@@ -36,6 +37,11 @@ namespace tensorflow {
 namespace data {
 
 constexpr double kAutoScalerOutlierSigmas = 1.0;
+// How far back the workload history used for forecasts reaches.
+constexpr absl::Duration kWorkloadHistoryWindow = absl::Minutes(10);
+// Minimum time between two samples of the workload history. Reports received
+// in between overwrite the latest sample.
+constexpr absl::Duration kWorkloadSampleInterval = absl::Seconds(1);
 
 template <typename T>
 double GetMedian(const absl::flat_hash_map<T, double>& rates) {
@@ -96,10 +102,30 @@ void ReplaceOutliers(const absl::flat_hash_map<T, double>& rates,
   }
 }
 
-std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
-    TF_LOCKS_EXCLUDED(mu_) {
-  tsl::mutex_lock l(mu_);
+namespace {
+
+// Fits `ys` as a linear function of `xs` by least squares, and returns the
+// value of the function at `x`.
+double ExtrapolateLinearTrend(const std::vector<double>& xs,
+                              const std::vector<double>& ys, double x) {
+  const double n = static_cast<double>(xs.size());
+  const double mean_x = std::accumulate(xs.begin(), xs.end(), 0.0) / n;
+  const double mean_y = std::accumulate(ys.begin(), ys.end(), 0.0) / n;
+  double covariance = 0.0;
+  double variance = 0.0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    covariance += (xs[i] - mean_x) * (ys[i] - mean_y);
+    variance += (xs[i] - mean_x) * (xs[i] - mean_x);
+  }
+  if (variance == 0.0) return mean_y;
 
+  return mean_y + (covariance / variance) * (x - mean_x);
+}
+
+}  // namespace
+
+std::optional<AutoScaler::WorkloadSample> AutoScaler::CurrentWorkload() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (worker_throughputs_.empty() || consumption_rates_.empty())
     return std::nullopt;
 
@@ -124,12 +150,82 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
   double average_worker_throughput =
       worker_throughputs_sum_ / static_cast<double>(worker_throughputs_.size());
 
+  WorkloadSample workload;
+  workload.time = absl::FromUnixMicros(env_->NowMicros());
+  workload.consumption_rate = consumption_rates_sum_;
+  workload.worker_throughput = average_worker_throughput;
+  return workload;
+}
+
+void AutoScaler::RecordWorkloadSample() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::optional<WorkloadSample> workload = CurrentWorkload();
+  if (!workload.has_value()) return;
+
+  if (!workload_history_.empty() &&
+      workload->time - workload_history_.back().time <
+          kWorkloadSampleInterval) {
+    workload_history_.back().consumption_rate = workload->consumption_rate;
+    workload_history_.back().worker_throughput = workload->worker_throughput;
+  } else {
+    workload_history_.push_back(*workload);
+  }
+  while (workload->time - workload_history_.front().time >
+         kWorkloadHistoryWindow) {
+    workload_history_.pop_front();
+  }
+}
+
+std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+
+  std::optional<WorkloadSample> workload = CurrentWorkload();
+  if (!workload.has_value()) return std::nullopt;
+
   int64_t optimal_number_of_workers =
-      ceil(consumption_rates_sum_ / average_worker_throughput);
+      ceil(workload->consumption_rate / workload->worker_throughput);
 
   return std::max(int64_t{1}, optimal_number_of_workers);
 }
 
+std::optional<int64_t> AutoScaler::GetForecastedNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+
+  std::optional<WorkloadSample> workload = CurrentWorkload();
+  if (!workload.has_value()) return std::nullopt;
+
+  double consumption_rate = workload->consumption_rate;
+  double worker_throughput = workload->worker_throughput;
+  if (workload_history_.size() >= 2) {
+    const absl::Time start_time = workload_history_.front().time;
+    std::vector<double> times, consumption_rates, worker_throughputs;
+    for (const WorkloadSample& sample : workload_history_) {
+      times.push_back(absl::ToDoubleSeconds(sample.time - start_time));
+      consumption_rates.push_back(sample.consumption_rate);
+      worker_throughputs.push_back(sample.worker_throughput);
+    }
+    const double forecast_time =
+        absl::ToDoubleSeconds(workload->time + horizon - start_time);
+    consumption_rate = std::max(
+        0.0, ExtrapolateLinearTrend(times, consumption_rates, forecast_time));
+    const double forecasted_worker_throughput =
+        ExtrapolateLinearTrend(times, worker_throughputs, forecast_time);
+    // A non-positive throughput is not feasible. Falls back to the lowest
+    // observed throughput.
+    worker_throughput =
+        forecasted_worker_throughput > 0.0
+            ? forecasted_worker_throughput
+            : *std::min_element(worker_throughputs.begin(),
+                                worker_throughputs.end());
+  }
+
+  int64_t forecasted_number_of_workers =
+      ceil(consumption_rate / worker_throughput);
+
+  return std::max(int64_t{1}, forecasted_number_of_workers);
+}
+
 tsl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
                                              absl::Duration processing_time)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -142,6 +238,7 @@ tsl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
   double worker_throughput = 1.0 / absl::ToDoubleSeconds(processing_time);
   tsl::mutex_lock l(mu_);
   worker_throughputs_[worker_address] = worker_throughput;
+  RecordWorkloadSample();
 
   return tsl::OkStatus();
 }
@@ -159,6 +256,7 @@ tsl::Status AutoScaler::ReportTargetProcessingTime(
   double consumption_rate = 1.0 / absl::ToDoubleSeconds(target_processing_time);
   tsl::mutex_lock l(mu_);
   consumption_rates_[consumer_id] = consumption_rate;
+  RecordWorkloadSample();
 
   return tsl::OkStatus();
 }
@@ -171,6 +269,7 @@ tsl::Status AutoScaler::RemoveWorker(const std::string& worker_address)
         absl::StrCat("Worker with address ", worker_address, " not found"));
 
   worker_throughputs_.erase(worker_address);
+  RecordWorkloadSample();
 
   return tsl::OkStatus();
 }
@@ -183,6 +282,7 @@ tsl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
         absl::StrCat("Consumer with ID ", consumer_id, " not found"));
 
   consumption_rates_.erase(consumer_id);
+  RecordWorkloadSample();
 
   return tsl::OkStatus();
 }
@@ -190,7 +290,7 @@ tsl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
 void MultipleIterationsAutoScaler::EnsureIterationIsRegistered(
     int64_t iteration_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (!auto_scalers_.contains(iteration_id)) {
-    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>();
+    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>(env_);
   }
 }
 
@@ -263,6 +363,22 @@ std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     return optimal_number_of_workers;
 }
 
+std::optional<int64_t>
+MultipleIterationsAutoScaler::GetForecastedNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  std::optional<int64_t> forecasted_number_of_workers;
+  tsl::tf_shared_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    std::optional<int64_t> iteration_forecast =
+        auto_scaler->GetForecastedNumberOfWorkers(horizon);
+    if (!iteration_forecast.has_value()) continue;
+
+    forecasted_number_of_workers =
+        std::max(forecasted_number_of_workers.value_or(0), *iteration_forecast);
+  }
+  return forecasted_number_of_workers;
+}
+
 tsl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
     int64_t iteration_id, const std::string& worker_address,
     absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
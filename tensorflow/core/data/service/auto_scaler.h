@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/thread_annotations.h"
@@ -63,16 +65,28 @@ namespace data {
 // follows:
 //  N = (Sum of CRs reported by all consumers) /
 //      (Average of WTs reported by all workers)
+// 3. It keeps a history of the sum of CRs and the average WT over the last 10
+// minutes. To forecast the number of workers needed in the future, both are
+// extrapolated along their linear trends.
 //
 // AutoScaler is thread-safe.
 class AutoScaler {
  public:
-  AutoScaler() = default;
+  AutoScaler() : AutoScaler(tsl::Env::Default()) {}
+  // `env` is the clock used to timestamp the workload history.
+  explicit AutoScaler(tsl::Env* env) : env_(env) {}
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the forecasted number of workers needed `horizon` from now,
+  // according to the trend of the recently observed workload. If the history
+  // is too short to show a trend, returns the current estimate. If there are
+  // no previously reported processing and target processing times, returns
+  // nullopt.
+  std::optional<int64_t> GetForecastedNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address`. Returns an error if `processing_time` is ZeroDuration or
   // negative.
@@ -96,12 +110,32 @@ class AutoScaler {
   tsl::Status RemoveConsumer(int64_t consumer_id) TF_LOCKS_EXCLUDED(mu_);
 
  private:
+  // The observed workload at a point in time.
+  struct WorkloadSample {
+    absl::Time time;
+    // Sum of the consumption rates of all consumers.
+    double consumption_rate = 0.0;
+    // Average throughput of the workers.
+    double worker_throughput = 0.0;
+  };
+
+  // Returns the current workload, or nullopt if there are no reported
+  // processing or target processing times.
+  std::optional<WorkloadSample> CurrentWorkload() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Appends the current workload to `workload_history_`, and drops samples
+  // which are too old to reflect the current trend.
+  void RecordWorkloadSample() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from worker address to worker throughput.
   absl::flat_hash_map<std::string, double> worker_throughputs_
       TF_GUARDED_BY(mu_);
   // Map from consumer id to consumption rate.
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
+  // Samples of the workload, ordered by time.
+  std::deque<WorkloadSample> workload_history_ TF_GUARDED_BY(mu_);
 };
 
 // Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
@@ -114,7 +148,10 @@ class AutoScaler {
 // MultipleIterationsAutoScaler is thread-safe.
 class MultipleIterationsAutoScaler {
  public:
-  MultipleIterationsAutoScaler() = default;
+  MultipleIterationsAutoScaler()
+      : MultipleIterationsAutoScaler(tsl::Env::Default()) {}
+  // `env` is the clock used to timestamp the workload history.
+  explicit MultipleIterationsAutoScaler(tsl::Env* env) : env_(env) {}
   // Unregisters iteration with `iteration_id`, removing its reported
   // times from consideration of the current workload estimation.
   // Returns an error if the specified iteration does not exist.
@@ -131,6 +168,12 @@ class MultipleIterationsAutoScaler {
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the forecasted number of workers needed `horizon` from now, as
+  // the maximum of the forecasts of all iterations. If there are no previously
+  // reported processing and target processing times for at least one
+  // iteration, returns nullopt.
+  std::optional<int64_t> GetForecastedNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
@@ -167,6 +210,7 @@ class MultipleIterationsAutoScaler {
   // workload estimation.
   void EnsureIterationIsRegistered(int64_t iteration_id)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from iteration id to AutoScaler.
   absl::flat_hash_map<int64_t, std::unique_ptr<AutoScaler>> auto_scalers_
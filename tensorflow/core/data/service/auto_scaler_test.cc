@@ -20,6 +20,8 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/fake_clock_env.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/status_matchers.h"
 
@@ -308,6 +310,85 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+TEST(AutoScalerTest, GetForecastedNumberOfWorkersInitialState) {
+  AutoScaler auto_scaler;
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Minutes(1)),
+            std::nullopt);
+}
+
+TEST(AutoScalerTest, GetForecastedNumberOfWorkersWithoutHistory) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Milliseconds(25)));
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Minutes(1)), 8);
+}
+
+// Worker 0:
+//   - Processing time = 0.25 [s] -> Throughput = 4 [elements/s]
+// Consumer 0:
+//   - At 0 [s]: Consumption rate = 40 [elements/s]
+//   - At 10 [s]: Consumption rate = 50 [elements/s]
+//
+// Forecasted consumption rate at 25 [s] = 65 [elements/s]
+// Forecasted number of workers = ceil(65 / 4) = 17
+TEST(AutoScalerTest, GetForecastedNumberOfWorkersIncreasingConsumption) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.25)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Milliseconds(25)));
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Milliseconds(20)));
+
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 13);
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Seconds(15)), 17);
+}
+
+// Worker 0:
+//   - At 0 [s]: Throughput = 5 [elements/s]
+//   - At 10 [s]: Throughput = 4 [elements/s]
+// Consumer 0:
+//   - Consumption rate = 40 [elements/s]
+//
+// Forecasted throughput at 15 [s] = 3.5 [elements/s]
+// Forecasted number of workers = ceil(40 / 3.5) = 12
+TEST(AutoScalerTest, GetForecastedNumberOfWorkersDecreasingThroughput) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Milliseconds(25)));
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.25)));
+
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 10);
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Seconds(5)), 12);
+  // The forecasted throughput would be negative, so the lowest observed
+  // throughput is used.
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Seconds(100)), 10);
+}
+
+TEST(AutoScalerTest, GetForecastedNumberOfWorkersIgnoresOldWorkload) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.25)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Microseconds(12500)));
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Minutes(11)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Milliseconds(25)));
+
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Minutes(1)), 10);
+}
+
 TEST(MultipleIterationsAutoScalerTest, UnregisterExistingIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(
@@ -743,6 +824,35 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest,
+     GetForecastedNumberOfWorkersInitialState) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Minutes(1)),
+            std::nullopt);
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetForecastedNumberOfWorkersMaximumOfIterations) {
+  FakeClockEnv env(Env::Default());
+  MultipleIterationsAutoScaler auto_scaler(&env);
+  // Iteration 0 needs 8 workers.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Milliseconds(25)));
+  // Iteration 1 needs 10 workers now and 13 workers in 5 seconds.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Seconds(0.25)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Milliseconds(50)));
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Microseconds(25000)));
+
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 10);
+  EXPECT_EQ(auto_scaler.GetForecastedNumberOfWorkers(absl::Seconds(5)), 13);
+}
+
 }  // namespace
 
 }  // namespace data
@@ -20,14 +20,20 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/logging_utils.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +52,11 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory which some trainer has not read yet
+// are spilled to local disk, so that a lagging trainer does not force a large
+// memory budget. Spilled elements are read back from disk and are not
+// re-inserted into memory.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -89,6 +100,30 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element so it can be spilled to disk. Only needs to be
+  // implemented if the cache is configured with a spill directory.
+  virtual Status SerializeElement(const ElementType& element,
+                                  std::string& serialized) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support spilling elements to disk.");
+  }
+
+  // Parses an element serialized by `SerializeElement`.
+  virtual StatusOr<ElementType> DeserializeElement(
+      const std::string& serialized) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support spilling elements to disk.");
+  }
+};
+
+// Configures the disk tier of a `CrossTrainerCache`.
+struct CrossTrainerCacheSpillOptions {
+  // Directory to spill elements to. If empty, evicted elements are discarded.
+  std::string directory;
+  // Maximum total size of spilled elements in bytes, as estimated by
+  // `CachableSequence::GetElementSizeBytes`.
+  size_t max_size_bytes = 0;
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -101,6 +136,12 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+  // Creates a `CrossTrainerCache` which spills elements that lagging trainers
+  // still need to disk, as configured by `spill_options`.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      CrossTrainerCacheSpillOptions spill_options);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -124,6 +165,45 @@ class CrossTrainerCache {
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    // Number of elements the trainer is behind the newest cached element.
+    size_t trainer_lag;
+  };
+
+  // An element evicted from memory to disk. Until it has been written, the
+  // element stays in memory. The file is deleted when the last reference is
+  // dropped, so readers can keep reading an element that has been evicted.
+  struct SpilledElement {
+    SpilledElement(std::string filename, size_t size_bytes,
+                   std::shared_ptr<const ElementType> element)
+        : filename(std::move(filename)),
+          size_bytes(size_bytes),
+          element(std::move(element)) {}
+    ~SpilledElement() {
+      if (written) {
+        Status s = Env::Default()->DeleteFile(filename);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to delete spilled tf.data service "
+                       << "cross-trainer cache element " << filename << ": "
+                       << s;
+        }
+      }
+    }
+
+    const std::string filename;
+    const size_t size_bytes;
+    // The element, if it has not been written to `filename` yet. Guarded by
+    // the cache's `mu_`.
+    std::shared_ptr<const ElementType> element;
+    // Whether the element has been written. Guarded by the cache's `mu_` until
+    // there are no more references to the cache.
+    bool written = false;
+  };
+
+  // An element found in the cache, either in memory or on disk.
+  struct CachedElement {
+    std::shared_ptr<const ElementType> element;
+    std::shared_ptr<SpilledElement> spilled;
+    size_t trainer_lag = 0;
   };
 
   // Returns the next element and metrics about this query.
@@ -139,21 +219,45 @@ class CrossTrainerCache {
   size_t GetElementIndex(const std::string& trainer_id);
 
   // Returns the next element for `trainer_id`.
-  StatusOr<std::shared_ptr<const ElementType>> GetElement(
-      const std::string& trainer_id);
+  StatusOr<CachedElement> GetElement(const std::string& trainer_id);
+
+  // Returns the element, reading it from disk if it has been spilled.
+  StatusOr<std::shared_ptr<const ElementType>> ReadElement(
+      const CachedElement& cached_element);
 
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // Returns the freed elements which need to be written to disk.
+  std::vector<std::shared_ptr<SpilledElement>> FreeSpace(
+      size_t new_element_size_bytes);
+
+  // Moves the element at `element_index`, which has been evicted from memory,
+  // to the disk tier if a trainer still needs it. Returns the spilled element
+  // if it needs to be written to disk.
+  std::shared_ptr<SpilledElement> MaybeSpill(
+      size_t element_index, std::shared_ptr<const ElementType> element,
+      size_t element_size_bytes);
+
+  // Writes spilled elements to disk. If writing fails, the element is kept in
+  // memory.
+  void WriteSpilledElements(
+      const std::vector<std::shared_ptr<SpilledElement>>& spilled_elements);
 
-  // Records the cache hit rate and cache size.
-  void RecordMetrics(const CacheQueryResult& result);
+  // Returns the index of the oldest element in either tier.
+  size_t WindowStartIndex() const;
+
+  // Records the cache hit rate, cache size, and the lag of `trainer_id`.
+  void RecordMetrics(const std::string& trainer_id,
+                     const CacheQueryResult& result);
 
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
+  const CrossTrainerCacheSpillOptions spill_options_;
+  // Prefix of spilled element filenames, unique to this cache.
+  const std::string spill_file_prefix_;
 
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
@@ -170,6 +274,11 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Elements spilled to disk, which precede the elements in `cache_`. The
+  // first spilled element has index `cache_start_index_ - spilled_.size()`.
+  std::deque<std::shared_ptr<SpilledElement>> spilled_ TF_GUARDED_BY(mu_);
+  size_t spilled_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
@@ -184,12 +293,32 @@ template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
     std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : CrossTrainerCache(max_cache_size_bytes, std::move(cachable_sequence),
+                        CrossTrainerCacheSpillOptions()) {}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    CrossTrainerCacheSpillOptions spill_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
+      spill_options_(std::move(spill_options)),
+      spill_file_prefix_(
+          spill_options_.directory.empty()
+              ? ""
+              : io::JoinPath(spill_options_.directory,
+                             absl::StrCat("cross_trainer_cache_",
+                                          random::New64(), "_"))),
       cachable_sequence_(std::move(cachable_sequence)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << FormatBytes(max_cache_size_bytes) << " of memory.";
+  if (!spill_options_.directory.empty()) {
+    VLOG(2) << "tf.data service cross-trainer cache spills up to "
+            << FormatBytes(spill_options_.max_size_bytes) << " to "
+            << spill_options_.directory << ".";
+  }
 }
 
 template <class ElementType>
@@ -202,7 +331,7 @@ CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
   }
 
   TF_ASSIGN_OR_RETURN(CacheQueryResult result, GetCacheQueryResult(trainer_id));
-  RecordMetrics(result);
+  RecordMetrics(trainer_id, result);
   return result.element;
 }
 
@@ -211,15 +340,14 @@ StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
 CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
-  while (true) {
+  std::optional<CachedElement> cached_element;
+  while (!cached_element.has_value()) {
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
-        TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
+        TF_ASSIGN_OR_RETURN(cached_element, GetElement(trainer_id));
+        break;
       }
 
       // Extends the cache or waits for another thread to extend the cache. When
@@ -242,6 +370,12 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       TF_RETURN_IF_ERROR(s);
     }
   }
+
+  // Spilled elements are read from disk without holding `mu_`.
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
+                      ReadElement(*cached_element));
+  return CacheQueryResult{element, /*is_cache_hit=*/!should_extend_cache,
+                          cached_element->trainer_lag};
 }
 
 template <class ElementType>
@@ -251,7 +385,7 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
 }
 
 template <class ElementType>
-StatusOr<std::shared_ptr<const ElementType>>
+StatusOr<typename CrossTrainerCache<ElementType>::CachedElement>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = GetElementIndex(trainer_id);
@@ -261,22 +395,50 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
         element_index);
   }
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
+  CachedElement result;
+  if (element_index < cache_start_index_) {
+    result.spilled =
+        spilled_[element_index - (cache_start_index_ - spilled_.size())];
+    result.element = result.spilled->element;
+  } else {
+    result.element = cache_[element_index - cache_start_index_];
+  }
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
+  result.trainer_lag = cache_start_index_ + cache_.size() - element_index - 1;
   return result;
 }
 
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadElement(const CachedElement& cached_element)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (cached_element.element) {
+    return cached_element.element;
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(
+      Env::Default(), cached_element.spilled->filename, &serialized));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  if (element_index < WindowStartIndex()) {
+    element_index = WindowStartIndex();
   }
   return element_index;
 }
 
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::WindowStartIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return cache_start_index_ - spilled_.size();
+}
+
 template <class ElementType>
 Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(ElementType element, cachable_sequence_->GetNext());
@@ -289,31 +451,112 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
+  std::vector<std::shared_ptr<SpilledElement>> spilled_elements;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    spilled_elements = FreeSpace(new_element_size_bytes);
+    cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+    cache_size_bytes_ += new_element_size_bytes;
+  }
+  // Spilled elements stay readable from memory while they are written, so
+  // trainers do not wait for the disk writes.
+  WriteSpilledElements(spilled_elements);
   return OkStatus();
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+std::vector<std::shared_ptr<
+    typename CrossTrainerCache<ElementType>::SpilledElement>>
+CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
+  std::vector<std::shared_ptr<SpilledElement>> spilled_elements;
+  size_t num_elements_freed = 0;
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
-    size_t free_bytes =
-        cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    std::shared_ptr<const ElementType> element = std::move(cache_.front());
+    size_t free_bytes = cachable_sequence_->GetElementSizeBytes(*element);
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
-    ++num_elements_discarded;
+    ++num_elements_freed;
+    std::shared_ptr<SpilledElement> spilled =
+        MaybeSpill(cache_start_index_ - 1, std::move(element), free_bytes);
+    if (spilled) {
+      spilled_elements.push_back(std::move(spilled));
+    }
   }
 
-  VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
+  VLOG(3) << "Freed " << num_elements_freed << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << FormatBytes(cache_size_bytes_) << ".";
+          << FormatBytes(cache_size_bytes_) << ". Spilled "
+          << spilled_elements.size() << " element(s), disk usage: "
+          << FormatBytes(spilled_size_bytes_) << ".";
+  return spilled_elements;
+}
+
+template <class ElementType>
+std::shared_ptr<typename CrossTrainerCache<ElementType>::SpilledElement>
+CrossTrainerCache<ElementType>::MaybeSpill(
+    size_t element_index, std::shared_ptr<const ElementType> element,
+    size_t element_size_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  bool needed_by_trainer = false;
+  for (const auto& [trainer_id, trainer_index] :
+       trainer_to_element_index_map_) {
+    if (trainer_index <= element_index) {
+      needed_by_trainer = true;
+      break;
+    }
+  }
+  if (spill_options_.directory.empty() || !needed_by_trainer ||
+      element_size_bytes > spill_options_.max_size_bytes) {
+    // The spilled elements are older than this one, so they must be discarded
+    // too to keep the cached elements contiguous.
+    spilled_.clear();
+    spilled_size_bytes_ = 0;
+    return nullptr;
+  }
+  while (!spilled_.empty() && spilled_size_bytes_ + element_size_bytes >
+                                  spill_options_.max_size_bytes) {
+    spilled_size_bytes_ -= spilled_.front()->size_bytes;
+    spilled_.pop_front();
+  }
+  auto spilled = std::make_shared<SpilledElement>(
+      absl::StrCat(spill_file_prefix_, element_index), element_size_bytes,
+      std::move(element));
+  spilled_.push_back(spilled);
+  spilled_size_bytes_ += element_size_bytes;
+  return spilled;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::WriteSpilledElements(
+    const std::vector<std::shared_ptr<SpilledElement>>& spilled_elements)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (spilled_elements.empty()) {
+    return;
+  }
+  Status s = Env::Default()->RecursivelyCreateDir(spill_options_.directory);
+  for (const std::shared_ptr<SpilledElement>& spilled : spilled_elements) {
+    std::string serialized;
+    if (s.ok()) {
+      // `spilled->element` is only reset by this thread.
+      s = cachable_sequence_->SerializeElement(*spilled->element, serialized);
+    }
+    if (s.ok()) {
+      s = WriteStringToFile(Env::Default(), spilled->filename, serialized);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache "
+                   << "element to " << spilled->filename
+                   << "; keeping it in memory: " << s;
+      Env::Default()->DeleteFile(spilled->filename).IgnoreError();
+      return;
+    }
+    mutex_lock l(mu_);
+    spilled->written = true;
+    spilled->element.reset();
+  }
 }
 
 template <class ElementType>
@@ -338,14 +581,19 @@ bool CrossTrainerCache<ElementType>::IsCancelled() const
 
 template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
-    const CacheQueryResult& result) {
+    const std::string& trainer_id, const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
-  size_t cache_size_bytes = 0;
+  size_t cache_size_bytes = 0, spilled_size_bytes = 0;
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    spilled_size_bytes = spilled_size_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
+  metrics::RecordTFDataServiceCrossTrainerCacheSpilledSizeBytes(
+      spilled_size_bytes);
+  metrics::RecordTFDataServiceCrossTrainerCacheTrainerLag(trainer_id,
+                                                          result.trainer_lag);
 }
 
 }  // namespace data
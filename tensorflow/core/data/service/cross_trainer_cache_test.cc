@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -61,6 +63,31 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+class SpillableRange : public InfiniteRange {
+ public:
+  Status SerializeElement(const int64_t& element,
+                          std::string& serialized) const override {
+    serialized = absl::StrCat(element);
+    return OkStatus();
+  }
+  StatusOr<int64_t> DeserializeElement(
+      const std::string& serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Invalid element ", serialized);
+    }
+    return element;
+  }
+};
+
+CrossTrainerCacheSpillOptions SpillOptions(size_t max_size_bytes) {
+  CrossTrainerCacheSpillOptions options;
+  options.directory =
+      io::JoinPath(testing::TmpDir(), "cross_trainer_cache_spill");
+  options.max_size_bytes = max_size_bytes;
+  return options;
+}
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -205,6 +232,67 @@ TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      SpillOptions(/*max_size_bytes=*/1024));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer reads the elements evicted from memory from disk.
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SpillSizeIsBounded) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      SpillOptions(/*max_size_bytes=*/10 * sizeof(int64_t)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 5 elements are in memory and 10 elements are on disk.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(85)));
+}
+
+TEST(CrossTrainerCacheTest, DoesNotSpillDataNoTrainerNeeds) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_spilled_size_bytes");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      SpillOptions(/*max_size_bytes=*/1024));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+    EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(i)));
+    EXPECT_EQ(cell_reader.Read(), 0);
+  }
+}
+
+TEST(CrossTrainerCacheTest, TrainerLagMetrics) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_trainer_lag");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/1024, std::make_unique<InfiniteRange>());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+    EXPECT_EQ(cell_reader.Read("Fast trainer"), 0);
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_EQ(cell_reader.Read("Slow trainer"), 9);
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(1)));
+  EXPECT_EQ(cell_reader.Read("Slow trainer"), 8);
+}
+
 TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   CrossTrainerCache<int64_t> cache(
@@ -27,6 +27,7 @@ limitations under the License.
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
@@ -129,6 +130,7 @@ Status DataServiceDispatcherClient::GetDatasetDef(const std::string& dataset_id,
 Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
                                              int64_t repetition,
                                              int64_t split_provider_index,
+                                             const std::string& locality,
                                              Tensor& split,
                                              bool& end_of_splits) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
@@ -136,6 +138,7 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
+  req.set_locality(locality);
   GetSplitResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
@@ -379,6 +382,19 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetAutoScalerForecast(
+    absl::Duration horizon, GetAutoScalerForecastResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetAutoScalerForecastRequest request;
+  request.set_horizon_ms(absl::ToInt64Milliseconds(horizon));
+  grpc::Status s = stub_->GetAutoScalerForecast(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get auto-scaler forecast", s);
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
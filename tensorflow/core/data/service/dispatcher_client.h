@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
@@ -62,10 +63,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
+  // provider index. The dispatcher prefers splits whose data is stored at
+  // `locality`, if it is non-empty.
   Status GetSplit(int64_t iteration_id, int64_t repetition,
-                  int64_t split_provider_index, Tensor& split,
-                  bool& end_of_splits);
+                  int64_t split_provider_index, const std::string& locality,
+                  Tensor& split, bool& end_of_splits);
 
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
@@ -137,6 +139,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Returns the number of workers needed by the current workload, and the
+  // number forecasted to be needed `horizon` from now.
+  Status GetAutoScalerForecast(absl::Duration horizon,
+                               GetAutoScalerForecastResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
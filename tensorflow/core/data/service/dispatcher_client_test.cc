@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dataset_store.h"
@@ -149,6 +150,23 @@ TEST_F(DispatcherClientTest, GetDataServiceConfig) {
   EXPECT_EQ(config.deployment_mode(), DEPLOYMENT_MODE_COLOCATED);
 }
 
+TEST_F(DispatcherClientTest, GetAutoScalerForecastWithoutWorkload) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  GetAutoScalerForecastResponse response;
+  TF_ASSERT_OK(
+      dispatcher_client_->GetAutoScalerForecast(absl::Minutes(5), response));
+  EXPECT_EQ(response.optimal_number_of_workers(), 0);
+  EXPECT_EQ(response.forecasted_number_of_workers(), 0);
+}
+
+TEST_F(DispatcherClientTest, GetAutoScalerForecastNegativeHorizon) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  GetAutoScalerForecastResponse response;
+  EXPECT_THAT(
+      dispatcher_client_->GetAutoScalerForecast(absl::Minutes(-1), response),
+      StatusIs(error::INVALID_ARGUMENT, HasSubstr("must be non-negative")));
+}
+
 TEST_F(DispatcherClientTest, SnapshotSkeletonWritten) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> paths,
@@ -94,6 +94,10 @@ constexpr char kDatasetsDir[] = "datasets";
 // between completing a stream and getting assigned a new one.
 constexpr int kDefaultWorkerMaxConcurrentSnapshots = 3;
 
+// Number of splits the dispatcher reads ahead to find one whose data is stored
+// near the requesting worker.
+constexpr int64_t kSplitLocalityLookahead = 16;
+
 constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
@@ -279,7 +283,7 @@ void DataServiceDispatcherImpl::Stop() TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     cancelled_ = true;
     for (const auto& [iteration_id, source_providers] : split_providers_) {
-      for (const std::unique_ptr<SplitProvider>& split_provider :
+      for (const std::unique_ptr<LocalitySplitProvider>& split_provider :
            source_providers) {
         split_providers.push_back(split_provider.get());
       }
@@ -307,11 +311,11 @@ size_t DataServiceDispatcherImpl::NumActiveIterations() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceDispatcherImpl::RestoreSplitProviders(
     const Iteration& iteration,
-    std::vector<std::unique_ptr<SplitProvider>>& restored)
+    std::vector<std::unique_ptr<LocalitySplitProvider>>& restored)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   const std::vector<int64_t>& indices =
       iteration.distributed_epoch_state.value().indices;
-  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  std::vector<std::unique_ptr<LocalitySplitProvider>> split_providers;
   TF_RETURN_IF_ERROR(
       MakeSplitProviders(iteration.job->dataset_id, split_providers));
   for (int provider_index = 0; provider_index < indices.size();
@@ -515,7 +519,7 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
           << provider_index;
   mutex_lock l(get_split_mu_);
   int64_t current_repetition = 0;
-  SplitProvider* split_provider = nullptr;
+  LocalitySplitProvider* split_provider = nullptr;
   {
     mutex_lock l(mu_);
     std::shared_ptr<const Iteration> iteration;
@@ -545,7 +549,8 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   }
   Tensor split;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  TF_RETURN_IF_ERROR(
+      split_provider->GetNext(request->locality(), &split, &end_of_splits));
   TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
                                          provider_index, end_of_splits));
   response->set_end_of_splits(end_of_splits);
@@ -562,13 +567,24 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
 
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
-    std::vector<std::unique_ptr<SplitProvider>>& split_providers)
+    std::vector<std::unique_ptr<LocalitySplitProvider>>& split_providers)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::shared_ptr<const Dataset> dataset;
   TF_RETURN_IF_ERROR(state_.DatasetFromId(dataset_id, dataset));
   std::shared_ptr<const DatasetDef> dataset_def;
   TF_RETURN_IF_ERROR(GetDatasetDef(*dataset, dataset_def));
-  TF_RETURN_IF_ERROR(CreateSplitProviders(*dataset_def, split_providers));
+  std::vector<std::unique_ptr<SplitProvider>> source_providers;
+  TF_RETURN_IF_ERROR(CreateSplitProviders(*dataset_def, source_providers));
+  // The journal only records the number of splits produced, and a restarted
+  // dispatcher replays them in order. So splits are only reordered by locality
+  // when the dispatcher is not fault tolerant.
+  const int64_t lookahead =
+      config_.fault_tolerant_mode() ? 0 : kSplitLocalityLookahead;
+  split_providers.clear();
+  for (std::unique_ptr<SplitProvider>& source_provider : source_providers) {
+    split_providers.push_back(std::make_unique<LocalitySplitProvider>(
+        std::move(source_provider), lookahead));
+  }
   return OkStatus();
 }
 
@@ -1248,6 +1264,25 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetAutoScalerForecast(
+    const GetAutoScalerForecastRequest* request,
+    GetAutoScalerForecastResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  if (request->horizon_ms() < 0) {
+    return errors::InvalidArgument(
+        "The forecast horizon must be non-negative, but got ",
+        request->horizon_ms(), "ms.");
+  }
+  response->set_optimal_number_of_workers(
+      auto_scaler_.GetOptimalNumberOfWorkers().value_or(0));
+  response->set_forecasted_number_of_workers(
+      auto_scaler_
+          .GetForecastedNumberOfWorkers(
+              absl::Milliseconds(request->horizon_ms()))
+          .value_or(0));
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
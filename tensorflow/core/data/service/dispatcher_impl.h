@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
+#include "tensorflow/core/data/service/split_provider.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -187,6 +188,8 @@ class DataServiceDispatcherImpl {
   Status DisableCompressionAtRuntime(
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
+  Status GetAutoScalerForecast(const GetAutoScalerForecastRequest* request,
+                               GetAutoScalerForecastResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -200,13 +203,13 @@ class DataServiceDispatcherImpl {
   // `restored`.
   Status RestoreSplitProviders(
       const DispatcherState::Iteration& iteration,
-      std::vector<std::unique_ptr<SplitProvider>>& restored)
+      std::vector<std::unique_ptr<LocalitySplitProvider>>& restored)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Makes split providers for the specified `dataset_id`, and stores them in
   // `split_providers`.
   Status MakeSplitProviders(
       const std::string& dataset_id,
-      std::vector<std::unique_ptr<SplitProvider>>& split_providers)
+      std::vector<std::unique_ptr<LocalitySplitProvider>>& split_providers)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Registers a dataset, storing the new dataset's id in `dataset_id`.
   Status RegisterDataset(const DatasetDef& dataset,
@@ -361,7 +364,8 @@ class DataServiceDispatcherImpl {
   // Store of dataset definitions.
   std::unique_ptr<DatasetStore> dataset_store_ TF_GUARDED_BY(mu_);
   // Mapping from iteration id to the split providers for the iteration.
-  absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
+  absl::flat_hash_map<int64_t,
+                      std::vector<std::unique_ptr<LocalitySplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats,
@@ -0,0 +1,750 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !PLATFORM_WINDOWS
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x7466646174617368;  // "tfdatash"
+constexpr size_t kCacheLineBytes = 64;
+// Number of times a blocked reader or writer polls the ring before sleeping.
+constexpr int64_t kNumSpins = 1000;
+constexpr int64_t kSleepMicros = 50;
+// How often a blocked server thread checks whether its client is alive,
+// measured in polls.
+constexpr int64_t kLivenessCheckInterval = 20000;
+constexpr int64_t kPollChannelsIntervalMicros = 1000;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared memory rings require lock-free 64-bit atomics.");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory rings require lock-free 32-bit atomics.");
+
+// State of a channel. Clients claim free channels, and servers return released
+// channels to the free state after resetting their rings.
+enum ChannelState : uint32_t {
+  kChannelFree = 0,
+  kChannelClaimed = 1,
+  kChannelReleased = 2,
+};
+
+struct RingHeader {
+  // Total number of bytes written and read. Each is only modified by one side.
+  alignas(kCacheLineBytes) std::atomic<uint64_t> write_pos{0};
+  alignas(kCacheLineBytes) std::atomic<uint64_t> read_pos{0};
+};
+
+struct ChannelHeader {
+  alignas(kCacheLineBytes) std::atomic<uint32_t> state{kChannelFree};
+  std::atomic<int32_t> client_pid{0};
+  RingHeader request;
+  RingHeader response;
+};
+
+struct SegmentHeader {
+  uint64_t magic = 0;
+  uint64_t num_channels = 0;
+  uint64_t request_buffer_bytes = 0;
+  uint64_t response_buffer_bytes = 0;
+  std::atomic<uint32_t> server_running{0};
+};
+
+// Fixed-size prefix of a response.
+struct ResponseHeader {
+  int32_t status_code = 0;
+  uint8_t end_of_sequence = 0;
+  uint8_t skip = 0;
+  uint8_t compressed = 0;
+  uint32_t num_components = 0;
+  int64_t element_index = 0;
+  uint64_t status_message_bytes = 0;
+};
+
+size_t RoundUp(size_t n) {
+  return (n + kCacheLineBytes - 1) / kCacheLineBytes * kCacheLineBytes;
+}
+
+size_t ChannelBytes(const SegmentHeader& header) {
+  return RoundUp(sizeof(ChannelHeader)) + header.request_buffer_bytes +
+         header.response_buffer_bytes;
+}
+
+size_t SegmentBytes(const SegmentHeader& header) {
+  return RoundUp(sizeof(SegmentHeader)) +
+         header.num_channels * ChannelBytes(header);
+}
+
+std::string SegmentName(int segment_id) {
+  return absl::StrCat("/tf_data_service_shm_", segment_id);
+}
+
+// Called whenever a ring operation cannot make progress, with the number of
+// unsuccessful attempts so far. Returns an error to abort the operation.
+using WaitFn = std::function<Status(int64_t)>;
+
+void Backoff(int64_t attempt) {
+  if (attempt >= kNumSpins) {
+    Env::Default()->SleepForMicroseconds(kSleepMicros);
+  }
+}
+
+// A single-producer single-consumer byte stream over a ring buffer in shared
+// memory.
+class Ring {
+ public:
+  Ring(RingHeader* header, char* data, uint64_t capacity)
+      : header_(header), data_(data), capacity_(capacity) {}
+
+  Status Write(const void* src, size_t n, const WaitFn& wait) {
+    const char* bytes = static_cast<const char*>(src);
+    int64_t attempt = 0;
+    while (n > 0) {
+      const uint64_t write_pos =
+          header_->write_pos.load(std::memory_order_relaxed);
+      const uint64_t read_pos =
+          header_->read_pos.load(std::memory_order_acquire);
+      const uint64_t free_bytes = capacity_ - (write_pos - read_pos);
+      if (free_bytes == 0) {
+        TF_RETURN_IF_ERROR(wait(attempt++));
+        continue;
+      }
+      attempt = 0;
+      const uint64_t offset = write_pos % capacity_;
+      const size_t chunk = std::min<uint64_t>(
+          {static_cast<uint64_t>(n), free_bytes, capacity_ - offset});
+      std::memcpy(data_ + offset, bytes, chunk);
+      header_->write_pos.store(write_pos + chunk, std::memory_order_release);
+      bytes += chunk;
+      n -= chunk;
+    }
+    return OkStatus();
+  }
+
+  Status Read(void* dst, size_t n, const WaitFn& wait) {
+    char* bytes = static_cast<char*>(dst);
+    int64_t attempt = 0;
+    while (n > 0) {
+      const uint64_t read_pos =
+          header_->read_pos.load(std::memory_order_relaxed);
+      const uint64_t write_pos =
+          header_->write_pos.load(std::memory_order_acquire);
+      const uint64_t available = write_pos - read_pos;
+      if (available == 0) {
+        TF_RETURN_IF_ERROR(wait(attempt++));
+        continue;
+      }
+      attempt = 0;
+      const uint64_t offset = read_pos % capacity_;
+      const size_t chunk = std::min<uint64_t>(
+          {static_cast<uint64_t>(n), available, capacity_ - offset});
+      std::memcpy(bytes, data_ + offset, chunk);
+      header_->read_pos.store(read_pos + chunk, std::memory_order_release);
+      bytes += chunk;
+      n -= chunk;
+    }
+    return OkStatus();
+  }
+
+  Status WriteString(absl::string_view s, const WaitFn& wait) {
+    const uint64_t size = s.size();
+    TF_RETURN_IF_ERROR(Write(&size, sizeof(size), wait));
+    return Write(s.data(), s.size(), wait);
+  }
+
+  Status ReadString(std::string* s, const WaitFn& wait) {
+    uint64_t size = 0;
+    TF_RETURN_IF_ERROR(Read(&size, sizeof(size), wait));
+    s->resize(size);
+    return Read(&(*s)[0], size, wait);
+  }
+
+  // Only called by the server while no client owns the channel.
+  void Reset() {
+    header_->write_pos.store(0, std::memory_order_relaxed);
+    header_->read_pos.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  RingHeader* const header_;
+  char* const data_;
+  const uint64_t capacity_;
+};
+
+// A view of one channel of a mapped segment.
+class Channel {
+ public:
+  Channel(char* segment_data, int64_t index) {
+    const SegmentHeader* segment =
+        reinterpret_cast<const SegmentHeader*>(segment_data);
+    char* base = segment_data + RoundUp(sizeof(SegmentHeader)) +
+                 index * ChannelBytes(*segment);
+    header_ = reinterpret_cast<ChannelHeader*>(base);
+    char* request_data = base + RoundUp(sizeof(ChannelHeader));
+    char* response_data = request_data + segment->request_buffer_bytes;
+    request_ = std::make_unique<Ring>(&header_->request, request_data,
+                                      segment->request_buffer_bytes);
+    response_ = std::make_unique<Ring>(&header_->response, response_data,
+                                       segment->response_buffer_bytes);
+  }
+
+  ChannelHeader* header() const { return header_; }
+  Ring& request() const { return *request_; }
+  Ring& response() const { return *response_; }
+
+ private:
+  ChannelHeader* header_;
+  std::unique_ptr<Ring> request_;
+  std::unique_ptr<Ring> response_;
+};
+
+bool ProcessExists(int32_t pid) {
+#if !defined(PLATFORM_WINDOWS)
+  return pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH;
+#else
+  return true;
+#endif  // !PLATFORM_WINDOWS
+}
+
+Status WriteTensor(const Tensor& tensor, Ring& ring, const WaitFn& wait) {
+  const int32_t dtype = tensor.dtype();
+  TF_RETURN_IF_ERROR(ring.Write(&dtype, sizeof(dtype), wait));
+  const uint8_t raw = DataTypeCanUseMemcpy(tensor.dtype());
+  TF_RETURN_IF_ERROR(ring.Write(&raw, sizeof(raw), wait));
+  if (!raw) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    return ring.WriteString(proto.SerializeAsString(), wait);
+  }
+  const int32_t num_dims = tensor.dims();
+  TF_RETURN_IF_ERROR(ring.Write(&num_dims, sizeof(num_dims), wait));
+  for (int i = 0; i < num_dims; ++i) {
+    const int64_t dim = tensor.dim_size(i);
+    TF_RETURN_IF_ERROR(ring.Write(&dim, sizeof(dim), wait));
+  }
+  // The tensor buffer is copied straight into the ring, without going through
+  // a `TensorProto`.
+  return ring.Write(tensor.tensor_data().data(), tensor.TotalBytes(), wait);
+}
+
+Status ReadTensor(Ring& ring, const WaitFn& wait, Tensor* tensor) {
+  int32_t dtype = 0;
+  TF_RETURN_IF_ERROR(ring.Read(&dtype, sizeof(dtype), wait));
+  uint8_t raw = 0;
+  TF_RETURN_IF_ERROR(ring.Read(&raw, sizeof(raw), wait));
+  if (!raw) {
+    std::string serialized;
+    TF_RETURN_IF_ERROR(ring.ReadString(&serialized, wait));
+    TensorProto proto;
+    if (!proto.ParseFromString(serialized) || !tensor->FromProto(proto)) {
+      return errors::Internal("Failed to parse tensor.");
+    }
+    return OkStatus();
+  }
+  int32_t num_dims = 0;
+  TF_RETURN_IF_ERROR(ring.Read(&num_dims, sizeof(num_dims), wait));
+  if (num_dims < 0 || num_dims > TensorShape::MaxDimensions()) {
+    return errors::Internal("Invalid tensor rank ", num_dims, ".");
+  }
+  std::vector<int64_t> dims(num_dims);
+  for (int64_t& dim : dims) {
+    TF_RETURN_IF_ERROR(ring.Read(&dim, sizeof(dim), wait));
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &shape));
+  *tensor = Tensor(static_cast<DataType>(dtype), shape);
+  return ring.Read(const_cast<char*>(tensor->tensor_data().data()),
+                   tensor->TotalBytes(), wait);
+}
+
+Status WriteResponse(const Status& status, const GetElementResult& result,
+                     Ring& ring, const WaitFn& wait) {
+  ResponseHeader header;
+  header.status_code = status.raw_code();
+  header.status_message_bytes = status.message().size();
+  header.end_of_sequence = result.end_of_sequence;
+  header.skip = result.skip;
+  header.element_index = result.element_index;
+  const CompressedElement* compressed = nullptr;
+  if (status.ok() && result.components.size() == 1 &&
+      result.components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(result.components[0].shape())) {
+    compressed =
+        result.components[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  header.compressed = compressed != nullptr;
+  header.num_components = status.ok() ? result.components.size() : 0;
+  TF_RETURN_IF_ERROR(ring.Write(&header, sizeof(header), wait));
+  if (!status.ok()) {
+    return ring.Write(status.message().data(), status.message().size(), wait);
+  }
+  if (compressed != nullptr) {
+    return ring.WriteString(compressed->SerializeAsString(), wait);
+  }
+  for (const Tensor& component : result.components) {
+    TF_RETURN_IF_ERROR(WriteTensor(component, ring, wait));
+  }
+  return OkStatus();
+}
+
+Status ReadResponse(Ring& ring, const WaitFn& wait, GetElementResult& result) {
+  ResponseHeader header;
+  TF_RETURN_IF_ERROR(ring.Read(&header, sizeof(header), wait));
+  if (header.status_code != static_cast<int32_t>(absl::StatusCode::kOk)) {
+    std::string message(header.status_message_bytes, '\0');
+    TF_RETURN_IF_ERROR(ring.Read(&message[0], message.size(), wait));
+    return Status(static_cast<absl::StatusCode>(header.status_code), message);
+  }
+  result.end_of_sequence = header.end_of_sequence;
+  result.skip = header.skip;
+  result.element_index = header.element_index;
+  if (header.compressed) {
+    std::string serialized;
+    TF_RETURN_IF_ERROR(ring.ReadString(&serialized, wait));
+    CompressedElement compressed;
+    if (!compressed.ParseFromString(serialized)) {
+      return errors::Internal("Failed to parse compressed element.");
+    }
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(compressed);
+    result.components.push_back(std::move(tensor));
+    return OkStatus();
+  }
+  for (uint32_t i = 0; i < header.num_components; ++i) {
+    result.components.emplace_back();
+    TF_RETURN_IF_ERROR(ReadTensor(ring, wait, &result.components.back()));
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+ShmSegment::ShmSegment(std::string name, char* data, size_t size, bool owned)
+    : name_(std::move(name)), data_(data), size_(size), owned_(owned) {}
+
+ShmSegment::~ShmSegment() {
+#if !defined(PLATFORM_WINDOWS)
+  munmap(data_, size_);
+  if (owned_) {
+    shm_unlink(name_.c_str());
+  }
+#endif  // !PLATFORM_WINDOWS
+}
+
+Status ShmSegment::Create(const std::string& name, size_t size,
+                          std::unique_ptr<ShmSegment>* out) {
+#if !defined(PLATFORM_WINDOWS)
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(absl::StrCat("Failed to create shared memory ",
+                                        "segment ", name),
+                           errno);
+  }
+  if (ftruncate(fd, size) != 0) {
+    int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::IOError(
+        absl::StrCat("Failed to resize shared memory segment ", name), error);
+  }
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int error = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::IOError(
+        absl::StrCat("Failed to map shared memory segment ", name), error);
+  }
+  out->reset(new ShmSegment(name, static_cast<char*>(data), size,
+                            /*owned=*/true));
+  return OkStatus();
+#else
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on this platform.");
+#endif  // !PLATFORM_WINDOWS
+}
+
+Status ShmSegment::Open(const std::string& name,
+                        std::unique_ptr<ShmSegment>* out) {
+#if !defined(PLATFORM_WINDOWS)
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(
+        absl::StrCat("Failed to open shared memory segment ", name), errno);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int error = errno;
+    close(fd);
+    return errors::IOError(
+        absl::StrCat("Failed to stat shared memory segment ", name), error);
+  }
+  const size_t size = st.st_size;
+  if (size < sizeof(SegmentHeader)) {
+    close(fd);
+    return errors::FailedPrecondition("Shared memory segment ", name,
+                                      " is too small: ", size, " bytes.");
+  }
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int error = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    return errors::IOError(
+        absl::StrCat("Failed to map shared memory segment ", name), error);
+  }
+  std::unique_ptr<ShmSegment> segment(new ShmSegment(
+      name, static_cast<char*>(data), size, /*owned=*/false));
+  const SegmentHeader* header =
+      reinterpret_cast<const SegmentHeader*>(segment->data());
+  if (header->magic != kSegmentMagic || SegmentBytes(*header) > size) {
+    return errors::FailedPrecondition(
+        "Shared memory segment ", name,
+        " was not created by a tf.data service worker.");
+  }
+  *out = std::move(segment);
+  return OkStatus();
+#else
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on this platform.");
+#endif  // !PLATFORM_WINDOWS
+}
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             ShmTransferOptions options)
+    : get_element_(std::move(get_element)), options_(options) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  stopping_ = true;
+  if (segment_) {
+    reinterpret_cast<SegmentHeader*>(segment_->data())
+        ->server_running.store(0, std::memory_order_release);
+  }
+  poll_thread_.reset();
+  std::vector<std::unique_ptr<Thread>> threads;
+  {
+    mutex_lock l(mu_);
+    threads = std::move(channel_threads_);
+  }
+  threads.clear();
+}
+
+Status ShmDataTransferServer::Start() {
+  if (options_.num_channels <= 0 || options_.request_buffer_bytes <= 0 ||
+      options_.response_buffer_bytes <= 0) {
+    return errors::InvalidArgument(
+        "Shared memory transfer options must be positive.");
+  }
+  SegmentHeader layout;
+  layout.num_channels = options_.num_channels;
+  layout.request_buffer_bytes = RoundUp(options_.request_buffer_bytes);
+  layout.response_buffer_bytes = RoundUp(options_.response_buffer_bytes);
+  // Segment ids are used in place of a port, so they must be positive ints.
+  Status s;
+  do {
+    segment_id_ = 1 + random::New64() % (std::numeric_limits<int>::max() - 1);
+    s = ShmSegment::Create(SegmentName(segment_id_), SegmentBytes(layout),
+                           &segment_);
+  } while (errors::IsAlreadyExists(s));
+  TF_RETURN_IF_ERROR(s);
+
+  SegmentHeader* header = new (segment_->data()) SegmentHeader();
+  header->num_channels = layout.num_channels;
+  header->request_buffer_bytes = layout.request_buffer_bytes;
+  header->response_buffer_bytes = layout.response_buffer_bytes;
+  for (int64_t i = 0; i < options_.num_channels; ++i) {
+    new (Channel(segment_->data(), i).header()) ChannelHeader();
+  }
+  header->server_running.store(1, std::memory_order_relaxed);
+  // Published last, so that clients never observe a partially initialized
+  // segment.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kSegmentMagic;
+
+  {
+    mutex_lock l(mu_);
+    serving_.assign(options_.num_channels, false);
+    channel_threads_.resize(options_.num_channels);
+  }
+  poll_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_shm_transfer_poll", [this]() { PollChannels(); }));
+  VLOG(1) << "Started shared memory data transfer server on segment "
+          << SegmentName(segment_id_);
+  return OkStatus();
+}
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  return port::Hostname();
+}
+
+void ShmDataTransferServer::PollChannels() {
+  while (!stopping_) {
+    for (int64_t i = 0; i < options_.num_channels; ++i) {
+      Channel channel(segment_->data(), i);
+      if (channel.header()->state.load(std::memory_order_acquire) ==
+          kChannelFree) {
+        continue;
+      }
+      mutex_lock l(mu_);
+      if (serving_[i]) {
+        continue;
+      }
+      serving_[i] = true;
+      // Joins the thread which served the previous client, which has already
+      // finished.
+      channel_threads_[i].reset();
+      channel_threads_[i] = absl::WrapUnique(Env::Default()->StartThread(
+          {}, "tf_data_shm_transfer_channel",
+          [this, i]() { ServeChannel(i); }));
+    }
+    Env::Default()->SleepForMicroseconds(kPollChannelsIntervalMicros);
+  }
+}
+
+void ShmDataTransferServer::ServeChannel(int64_t index) {
+  Channel channel(segment_->data(), index);
+  ChannelHeader* header = channel.header();
+  WaitFn wait = [this, header](int64_t attempt) -> Status {
+    if (stopping_) {
+      return errors::Cancelled("Server is stopping.");
+    }
+    if (header->state.load(std::memory_order_acquire) != kChannelClaimed) {
+      return errors::Cancelled("Client released the channel.");
+    }
+    if (attempt > 0 && attempt % kLivenessCheckInterval == 0 &&
+        !ProcessExists(header->client_pid.load(std::memory_order_relaxed))) {
+      return errors::Cancelled("Client process exited.");
+    }
+    Backoff(attempt);
+    return OkStatus();
+  };
+  while (true) {
+    std::string serialized;
+    Status s = channel.request().ReadString(&serialized, wait);
+    if (!s.ok()) {
+      VLOG(2) << "Stop serving shared memory channel " << index << ": " << s;
+      break;
+    }
+    GetElementRequest req;
+    if (!req.ParseFromString(serialized)) {
+      LOG(ERROR) << "Failed to parse GetElementRequest on shared memory "
+                 << "channel " << index;
+      break;
+    }
+    GetElementResult result;
+    Status get_element_status = get_element_(&req, &result);
+    s = WriteResponse(get_element_status, result, channel.response(), wait);
+    if (!s.ok()) {
+      VLOG(2) << "Stop serving shared memory channel " << index << ": " << s;
+      break;
+    }
+  }
+  channel.request().Reset();
+  channel.response().Reset();
+  header->client_pid.store(0, std::memory_order_relaxed);
+  header->state.store(kChannelFree, std::memory_order_release);
+  mutex_lock l(mu_);
+  serving_[index] = false;
+}
+
+ShmDataTransferClient::ShmDataTransferClient(absl::string_view address)
+    : address_(address) {
+  VLOG(2) << "Create ShmDataTransferClient for worker " << address_ << ".";
+}
+
+ShmDataTransferClient::~ShmDataTransferClient() {
+  mutex_lock l(mu_);
+  ReleaseChannel();
+}
+
+Status ShmDataTransferClient::EnsureChannel() {
+  if (channel_ >= 0) {
+    return OkStatus();
+  }
+  if (!segment_) {
+    absl::string_view id = address_;
+    const size_t colon = id.rfind(':');
+    if (colon != absl::string_view::npos) {
+      id.remove_prefix(colon + 1);
+    }
+    int segment_id = 0;
+    if (!absl::SimpleAtoi(id, &segment_id)) {
+      return errors::InvalidArgument(
+          "Failed to parse shared memory segment id from address ", address_);
+    }
+    TF_RETURN_IF_ERROR(ShmSegment::Open(SegmentName(segment_id), &segment_));
+  }
+  SegmentHeader* header = reinterpret_cast<SegmentHeader*>(segment_->data());
+  for (int64_t i = 0; i < header->num_channels; ++i) {
+    Channel channel(segment_->data(), i);
+    uint32_t expected = kChannelFree;
+    if (channel.header()->state.compare_exchange_strong(
+            expected, kChannelClaimed, std::memory_order_acq_rel)) {
+#if !defined(PLATFORM_WINDOWS)
+      channel.header()->client_pid.store(getpid(), std::memory_order_relaxed);
+#endif  // !PLATFORM_WINDOWS
+      channel_ = i;
+      return OkStatus();
+    }
+  }
+  return errors::Unavailable("All ", header->num_channels,
+                             " shared memory channels of worker ", address_,
+                             " are in use.");
+}
+
+void ShmDataTransferClient::ReleaseChannel() {
+  if (channel_ < 0) {
+    return;
+  }
+  Channel(segment_->data(), channel_)
+      .header()
+      ->state.store(kChannelReleased, std::memory_order_release);
+  channel_ = -1;
+}
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  VLOG(3) << "GetElement for task " << req.task_id() << " from shared memory "
+          << "worker server.";
+  mutex_lock l(mu_);
+  if (cancelled_) {
+    return errors::Cancelled("Client was cancelled.");
+  }
+  TF_RETURN_IF_ERROR(EnsureChannel());
+  Channel channel(segment_->data(), channel_);
+  const SegmentHeader* segment =
+      reinterpret_cast<const SegmentHeader*>(segment_->data());
+  ChannelHeader* header = channel.header();
+  WaitFn wait = [this, segment, header](int64_t attempt) -> Status {
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    if (segment->server_running.load(std::memory_order_acquire) == 0) {
+      return errors::Unavailable("Worker ", address_, " stopped serving.");
+    }
+    if (header->state.load(std::memory_order_acquire) != kChannelClaimed) {
+      return errors::Internal("Worker ", address_,
+                              " closed the shared memory channel.");
+    }
+    Backoff(attempt);
+    return OkStatus();
+  };
+  int64_t start_time_us = env_->NowMicros();
+  Status s = channel.request().WriteString(req.SerializeAsString(), wait);
+  if (s.ok()) {
+    s = ReadResponse(channel.response(), wait, result);
+  }
+  int64_t end_time_us = env_->NowMicros();
+  if (!s.ok()) {
+    // The server resets the channel once released, so that a failed or
+    // cancelled request cannot leave a partial message behind.
+    ReleaseChannel();
+    return s;
+  }
+  metrics::RecordTFDataServiceGetElementDuration(kShmTransferProtocol,
+                                                 end_time_us - start_time_us);
+  return OkStatus();
+}
+
+void ShmDataTransferClient::TryCancel() {
+  VLOG(2) << "Cancel ShmDataTransferClient for worker " << address_ << ".";
+  cancelled_ = true;
+}
+
+StatusOr<std::string> ShmDataTransferClient::GetCompatibilityInfo() const {
+  return port::Hostname();
+}
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  const std::string hostname = port::Hostname();
+  if (server_compatibility_info != hostname) {
+    return errors::FailedPrecondition(
+        "Shared memory data transfer requires the tf.data service worker to "
+        "run on the same host as the client, but the worker runs on ",
+        server_compatibility_info, " and the client runs on ", hostname, ".");
+  }
+  return OkStatus();
+}
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol, [](DataTransferServer::GetElementT get_element,
+                                 std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<ShmDataTransferServer>(get_element);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<ShmDataTransferClient>(config.address);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
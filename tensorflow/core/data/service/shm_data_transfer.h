@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for tf.data service workers which are colocated with
+// their clients. Elements are exchanged through a POSIX shared memory segment
+// created by the worker instead of over a loopback gRPC connection.
+//
+// To use it, start the worker with `data_transfer_protocol: "shm"` and
+// `data_transfer_address: "localhost:%port%"`. The "port" reported for the
+// protocol identifies the shared memory segment rather than a TCP port.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Layout of the shared memory segment created by `ShmDataTransferServer`.
+struct ShmTransferOptions {
+  // Maximum number of clients which can be connected at the same time.
+  int64_t num_channels = 16;
+  // Capacity of the ring buffer carrying requests from each client.
+  int64_t request_buffer_bytes = 64 << 10;
+  // Capacity of the ring buffer carrying elements to each client. Elements
+  // larger than the buffer are streamed through it in pieces.
+  int64_t response_buffer_bytes = 4 << 20;
+};
+
+// A mapping of a POSIX shared memory segment into this process.
+class ShmSegment {
+ public:
+  ~ShmSegment();
+
+  // Creates a new segment of `size` bytes. The segment is unlinked when the
+  // returned object is destroyed.
+  static Status Create(const std::string& name, size_t size,
+                       std::unique_ptr<ShmSegment>* out);
+  // Maps an existing segment created by another process.
+  static Status Open(const std::string& name,
+                     std::unique_ptr<ShmSegment>* out);
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  ShmSegment(std::string name, char* data, size_t size, bool owned);
+
+  const std::string name_;
+  char* const data_;
+  const size_t size_;
+  // Whether this process created the segment and should unlink it.
+  const bool owned_;
+};
+
+// Serves elements from a shared memory segment. Each client claims one of the
+// segment's channels, which consists of a pair of single-producer
+// single-consumer ring buffers for requests and responses. The server has a
+// thread per claimed channel.
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element,
+                                 ShmTransferOptions options = {});
+  ~ShmDataTransferServer() override;
+
+  Status Start() override;
+
+  // Returns the id of the shared memory segment.
+  int Port() const override { return segment_id_; }
+
+  // Returns the hostname, since clients must run on the same host.
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  // Starts serving threads for newly claimed channels until the server is
+  // stopped.
+  void PollChannels();
+  // Serves requests on the channel with the given index until the client
+  // releases it or the server is stopped.
+  void ServeChannel(int64_t index);
+
+  const GetElementT get_element_;
+  const ShmTransferOptions options_;
+  int segment_id_ = 0;
+  std::unique_ptr<ShmSegment> segment_;
+
+  mutex mu_;
+  std::atomic<bool> stopping_ = false;
+  // Whether there is a thread serving the channel with a given index.
+  std::vector<bool> serving_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Thread>> channel_threads_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> poll_thread_;
+};
+
+// Fetches elements from a `ShmDataTransferServer` in another process on the
+// same host.
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // `address` is the address of the transfer server, whose port is the id of
+  // the shared memory segment.
+  explicit ShmDataTransferClient(absl::string_view address);
+  ~ShmDataTransferClient() override;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+
+  void TryCancel() override;
+
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override;
+
+ private:
+  // Maps the server segment and claims a channel if not done yet.
+  Status EnsureChannel() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Hands the claimed channel back to the server.
+  void ReleaseChannel() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string address_;
+  std::atomic<bool> cancelled_ = false;
+
+  // Held for the duration of a request, since a channel carries one request
+  // at a time.
+  mutex mu_;
+  std::unique_ptr<ShmSegment> segment_ TF_GUARDED_BY(mu_);
+  int64_t channel_ TF_GUARDED_BY(mu_) = -1;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
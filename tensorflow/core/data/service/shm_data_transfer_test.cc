@@ -0,0 +1,219 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Returns the element {task_id, "element_<task_id>"}, ends the sequence for
+// task 0 and fails for negative tasks.
+Status GetTestElement(const GetElementRequest* req, GetElementResult* result) {
+  if (req->task_id() < 0) {
+    return errors::InvalidArgument("Invalid task ", req->task_id());
+  }
+  if (req->task_id() == 0) {
+    result->end_of_sequence = true;
+    return OkStatus();
+  }
+  result->element_index = req->task_id();
+  result->components.push_back(Tensor(int64_t{req->task_id()}));
+  result->components.push_back(
+      Tensor(tstring(absl::StrCat("element_", req->task_id()))));
+  return OkStatus();
+}
+
+GetElementRequest MakeRequest(int64_t task_id) {
+  GetElementRequest req;
+  req.set_task_id(task_id);
+  return req;
+}
+
+std::string Address(const ShmDataTransferServer& server) {
+  return absl::StrCat("localhost:", server.Port());
+}
+
+TEST(ShmDataTransferTest, GetElement) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  for (int64_t task_id = 1; task_id < 10; ++task_id) {
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(MakeRequest(task_id), result));
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_EQ(result.element_index, task_id);
+    ASSERT_EQ(result.components.size(), 2);
+    test::ExpectEqual(result.components[0], Tensor(int64_t{task_id}));
+    test::ExpectEqual(result.components[1],
+                      Tensor(tstring(absl::StrCat("element_", task_id))));
+  }
+}
+
+TEST(ShmDataTransferTest, EndOfSequence) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  GetElementResult result;
+  TF_ASSERT_OK(client.GetElement(MakeRequest(0), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, PropagatesErrors) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  GetElementResult result;
+  EXPECT_THAT(client.GetElement(MakeRequest(-1), result),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("Invalid task -1")));
+  // The client recovers from the error.
+  TF_ASSERT_OK(client.GetElement(MakeRequest(1), result));
+  test::ExpectEqual(result.components[0], Tensor(int64_t{1}));
+}
+
+TEST(ShmDataTransferTest, ElementLargerThanBuffer) {
+  Tensor large(DT_FLOAT, TensorShape({1000, 100}));
+  large.flat<float>().setRandom();
+  ShmTransferOptions options;
+  options.request_buffer_bytes = 64;
+  options.response_buffer_bytes = 1024;
+  ShmDataTransferServer server(
+      [&large](const GetElementRequest*, GetElementResult* result) {
+        result->components.push_back(large);
+        return OkStatus();
+      },
+      options);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  for (int i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(MakeRequest(1), result));
+    ASSERT_EQ(result.components.size(), 1);
+    test::ExpectEqual(result.components[0], large);
+  }
+}
+
+TEST(ShmDataTransferTest, CompressedElement) {
+  std::vector<Tensor> element = {Tensor(int64_t{5}), Tensor(tstring("abc"))};
+  ShmDataTransferServer server(
+      [&element](const GetElementRequest*, GetElementResult* result) {
+        CompressedElement compressed;
+        TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(compressed);
+        result->components.push_back(tensor);
+        return OkStatus();
+      });
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  GetElementResult result;
+  TF_ASSERT_OK(client.GetElement(MakeRequest(1), result));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* compressed =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(compressed, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*compressed, &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 2);
+  test::ExpectEqual(uncompressed[0], element[0]);
+  test::ExpectEqual(uncompressed[1], element[1]);
+}
+
+TEST(ShmDataTransferTest, MultipleClients) {
+  ShmTransferOptions options;
+  options.num_channels = 2;
+  ShmDataTransferServer server(GetTestElement, options);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client1(Address(server));
+  ShmDataTransferClient client2(Address(server));
+  GetElementResult result1, result2;
+  TF_ASSERT_OK(client1.GetElement(MakeRequest(1), result1));
+  TF_ASSERT_OK(client2.GetElement(MakeRequest(2), result2));
+  test::ExpectEqual(result1.components[0], Tensor(int64_t{1}));
+  test::ExpectEqual(result2.components[0], Tensor(int64_t{2}));
+
+  ShmDataTransferClient client3(Address(server));
+  GetElementResult result3;
+  EXPECT_THAT(client3.GetElement(MakeRequest(3), result3),
+              StatusIs(error::UNAVAILABLE, HasSubstr("are in use")));
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  client.TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client.GetElement(MakeRequest(1), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST(ShmDataTransferTest, SegmentNotFound) {
+  ShmDataTransferClient client("localhost:1");
+  GetElementResult result;
+  EXPECT_FALSE(client.GetElement(MakeRequest(1), result).ok());
+}
+
+TEST(ShmDataTransferTest, CheckCompatibility) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  ShmDataTransferClient client(Address(server));
+  TF_ASSERT_OK_AND_ASSIGN(std::string server_info,
+                          server.GetCompatibilityInfo());
+  TF_EXPECT_OK(client.CheckCompatibility(server_info));
+  EXPECT_THAT(client.CheckCompatibility("another_host"),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+TEST(ShmDataTransferTest, Registered) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(
+      DataTransferServer::Build(kShmTransferProtocol, GetTestElement, &server));
+  TF_ASSERT_OK(server->Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kShmTransferProtocol,
+      {kShmTransferProtocol, absl::StrCat("localhost:", server->Port())},
+      &client));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(MakeRequest(4), result));
+  test::ExpectEqual(result.components[0], Tensor(int64_t{4}));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
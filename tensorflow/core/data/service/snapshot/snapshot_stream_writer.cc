@@ -40,9 +40,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/path.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace tensorflow {
@@ -51,6 +53,9 @@ namespace {
 
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 constexpr int64_t kUnknownNumElements = -1;
+// Maximum total size of the elements buffered for the chunk writer threads.
+// At least one element is always buffered.
+constexpr int64_t kMaxBufferedBytes = 512 << 20;  // 512MB
 
 // Extracts the index from the `filename` of an uncommitted chunk. The chunk
 // file name is expected to be chunk_<chunk_index>.
@@ -73,6 +78,9 @@ SnapshotStreamWriter::SnapshotStreamWriter(
     : params_(params), iterator_(std::move(iterator)) {
   DCHECK_NE(iterator_.get(), nullptr);
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
+  chunk_writer_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+      params_.env, "tf_data_service_snapshot_chunk_writer",
+      std::max<int64_t>(params_.num_chunk_writer_threads, 1));
   snapshot_thread_ = absl::WrapUnique(params_.env->StartThread(
       /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_thread",
       [this]() { WriteSnapshotAndLog(); }));
@@ -143,19 +151,25 @@ absl::Status SnapshotStreamWriter::WriteChunk() {
             << ", stream " << params_.stream_index << ", chunk " << chunk_index_
             << ".";
 
-  std::string uncommitted_chunk_file_path =
+  TF_RETURN_IF_ERROR(WaitForChunkWriter());
+  auto chunk = std::make_shared<PendingChunk>(
       tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
-                        absl::StrCat("chunk_", chunk_index_));
-  snapshot_util::TFRecordWriter writer(
-      TranslateFileName(uncommitted_chunk_file_path), params_.compression);
-  TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
-  while (ShouldWriteRecord()) {
-    TF_RETURN_IF_ERROR(WriteRecord(writer));
+                        absl::StrCat("chunk_", chunk_index_)));
+  chunk_writer_pool_->Schedule([this, chunk]() { RunChunkWriter(chunk); });
+  {
+    auto close_chunk = gtl::MakeCleanup([this, &chunk]() {
+      mutex_lock l(chunk_mu_);
+      chunk->closed = true;
+      chunk_cv_.notify_all();
+    });
+    while (ShouldWriteRecord()) {
+      TF_RETURN_IF_ERROR(WriteRecord(*chunk));
+    }
   }
-  TF_RETURN_IF_ERROR(writer.Close());
   chunk_file_to_num_elements_[absl::StrCat("chunk_", chunk_index_)] =
       chunk_num_elements_;
   if (ShouldCommit()) {
+    TF_RETURN_IF_ERROR(WaitForChunkWrites());
     TF_RETURN_IF_ERROR(Commit());
   }
   metrics::RecordTFDataServiceSnapshotBytesCommitted(chunk_size_bytes_);
@@ -218,21 +232,95 @@ bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
          !end_of_sequence_ && completed_.ok();
 }
 
-absl::Status SnapshotStreamWriter::WriteRecord(
-    snapshot_util::TFRecordWriter& writer) {
+absl::Status SnapshotStreamWriter::WriteRecord(PendingChunk& chunk) {
   std::vector<Tensor> element;
   TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_sequence_));
   if (end_of_sequence_) {
-    return writer.Close();
+    return absl::OkStatus();
   }
-  tsl::profiler::TraceMe activity("SnapshotWriteRecord",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  TF_RETURN_IF_ERROR(writer.WriteTensors(element));
-  chunk_size_bytes_ += EstimatedSizeBytes(element);
+  const int64_t element_size_bytes = EstimatedSizeBytes(element);
+  {
+    mutex_lock l(chunk_mu_);
+    while (buffered_bytes_ > 0 &&
+           buffered_bytes_ + element_size_bytes > kMaxBufferedBytes &&
+           chunk_write_status_.ok()) {
+      chunk_cv_.wait(l);
+    }
+    TF_RETURN_IF_ERROR(chunk_write_status_);
+    buffered_bytes_ += element_size_bytes;
+    chunk.elements.emplace_back(std::move(element), element_size_bytes);
+    chunk_cv_.notify_all();
+  }
+  chunk_size_bytes_ += element_size_bytes;
   ++chunk_num_elements_;
   return absl::OkStatus();
 }
 
+void SnapshotStreamWriter::RunChunkWriter(std::shared_ptr<PendingChunk> chunk) {
+  absl::Status status = WriteChunkFile(*chunk);
+  mutex_lock l(chunk_mu_);
+  // Drops the elements which could not be written after an error.
+  for (const auto& [element, element_size_bytes] : chunk->elements) {
+    buffered_bytes_ -= element_size_bytes;
+  }
+  chunk->elements.clear();
+  chunk_write_status_.Update(status);
+  --num_active_chunk_writes_;
+  chunk_cv_.notify_all();
+}
+
+absl::Status SnapshotStreamWriter::WriteChunkFile(PendingChunk& chunk) {
+  snapshot_util::TFRecordWriter writer(TranslateFileName(chunk.file_path),
+                                       params_.compression);
+  TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
+  while (true) {
+    std::vector<Tensor> element;
+    int64_t element_size_bytes = 0;
+    {
+      mutex_lock l(chunk_mu_);
+      while (chunk.elements.empty() && !chunk.closed) {
+        chunk_cv_.wait(l);
+      }
+      if (chunk.elements.empty()) {
+        break;
+      }
+      element = std::move(chunk.elements.front().first);
+      element_size_bytes = chunk.elements.front().second;
+      chunk.elements.pop_front();
+    }
+    tsl::profiler::TraceMe activity("SnapshotWriteRecord",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    absl::Status status = writer.WriteTensors(element);
+    {
+      mutex_lock l(chunk_mu_);
+      buffered_bytes_ -= element_size_bytes;
+      chunk_cv_.notify_all();
+    }
+    TF_RETURN_IF_ERROR(status);
+  }
+  return writer.Close();
+}
+
+absl::Status SnapshotStreamWriter::WaitForChunkWriter() {
+  mutex_lock l(chunk_mu_);
+  while (num_active_chunk_writes_ >=
+             std::max<int64_t>(params_.num_chunk_writer_threads, 1) &&
+         chunk_write_status_.ok()) {
+    chunk_cv_.wait(l);
+  }
+  TF_RETURN_IF_ERROR(chunk_write_status_);
+  ++num_active_chunk_writes_;
+  return absl::OkStatus();
+}
+
+absl::Status SnapshotStreamWriter::WaitForChunkWrites() {
+  mutex_lock l(chunk_mu_);
+  while (num_active_chunk_writes_ > 0) {
+    chunk_cv_.wait(l);
+  }
+  return chunk_write_status_;
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -33,16 +34,19 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
 
 constexpr int64_t kDefaultMaxChunkSizeBytes = 2 * (size_t{1} << 30);  // 2GB
 constexpr absl::Duration kDefaultCheckpointInterval = absl::Minutes(20);
+constexpr int64_t kDefaultNumChunkWriterThreads = 4;
 
 struct SnapshotWriterParams {
   // The directory path of the snapshot. See the comment on SnapshotStreamWriter
@@ -69,6 +73,11 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // Number of threads which serialize, compress, and write chunk files. Chunk
+  // files are written in the background while the dataset iterator produces
+  // the elements of the next chunk.
+  int64_t num_chunk_writer_threads = kDefaultNumChunkWriterThreads;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -175,8 +184,33 @@ class SnapshotStreamWriter {
   // chunk.
   bool ShouldWriteRecord() const;
 
-  // Writes the next record to the current chunk.
-  absl::Status WriteRecord(snapshot_util::TFRecordWriter& writer);
+  // A chunk whose elements are produced by the snapshot thread and written to
+  // `file_path` by a chunk writer thread.
+  struct PendingChunk {
+    explicit PendingChunk(std::string file_path)
+        : file_path(std::move(file_path)) {}
+
+    const std::string file_path;
+    // Elements not yet written, with their estimated sizes in bytes.
+    std::deque<std::pair<std::vector<Tensor>, int64_t>> elements;
+    // True once the snapshot thread has produced all elements of the chunk.
+    bool closed = false;
+  };
+
+  // Produces the next record and hands it to the writer of `chunk`.
+  absl::Status WriteRecord(PendingChunk& chunk);
+
+  // Writes the elements of `chunk` to its file as they are produced. Runs on a
+  // chunk writer thread.
+  void RunChunkWriter(std::shared_ptr<PendingChunk> chunk);
+  absl::Status WriteChunkFile(PendingChunk& chunk);
+
+  // Waits for a chunk writer thread to become available.
+  absl::Status WaitForChunkWriter();
+
+  // Waits until all chunk files have been written. Returns the first error
+  // encountered by the chunk writers.
+  absl::Status WaitForChunkWrites();
 
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
@@ -243,6 +277,19 @@ class SnapshotStreamWriter {
   // - If the snapshot has not finished, this is false.
   absl::StatusOr<bool> completed_ TF_GUARDED_BY(mu_) = false;
 
+  // Coordinates the snapshot thread with the chunk writer threads.
+  mutable mutex chunk_mu_;
+  condition_variable chunk_cv_;
+  // Number of chunk files which are being written.
+  int64_t num_active_chunk_writes_ TF_GUARDED_BY(chunk_mu_) = 0;
+  // Total estimated size of the elements produced but not yet written.
+  int64_t buffered_bytes_ TF_GUARDED_BY(chunk_mu_) = 0;
+  // The first error returned by a chunk writer.
+  absl::Status chunk_write_status_ TF_GUARDED_BY(chunk_mu_);
+
+  // Must outlive `snapshot_thread_`, and is destroyed after the chunk writers
+  // finish.
+  std::unique_ptr<tsl::thread::ThreadPool> chunk_writer_pool_;
   std::unique_ptr<Thread> snapshot_thread_;
 };
 
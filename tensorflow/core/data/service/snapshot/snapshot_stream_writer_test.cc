@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -292,6 +293,58 @@ TEST_P(SnapshotStreamWriterParameterizedTest, WriteErrorFile) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST_P(SnapshotStreamWriterParameterizedTest, SingleChunkWriterThread) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  std::string compression = GetParam();
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     compression, Env::Default(),
+                                     /*max_chunk_size_bytes=*/1};
+  writer_params.num_chunk_writer_threads = 1;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(ReadSnapshot<int64_t>(
+                    tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                      absl::StrCat("chunk_0_", i, "_1")),
+                    compression,
+                    /*num_elements=*/1),
+                IsOkAndHolds(ElementsAre(i)));
+  }
+}
+
+TEST_P(SnapshotStreamWriterParameterizedTest, CommitEachChunk) {
+  int64_t range = 20;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  std::string compression = GetParam();
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{
+      snapshot_path,
+      /*stream_index=*/0,
+      compression,
+      Env::Default(),
+      /*max_chunk_size_bytes=*/1,
+      /*checkpoint_interval=*/absl::ZeroDuration()};
+  writer_params.num_chunk_writer_threads = 8;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  for (int i = 0; i < range; ++i) {
+    EXPECT_THAT(ReadSnapshot<int64_t>(
+                    tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                      absl::StrCat("chunk_0_", i, "_1")),
+                    compression,
+                    /*num_elements=*/1),
+                IsOkAndHolds(ElementsAre(i)));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(Compression, SnapshotStreamWriterParameterizedTest,
                          ValuesIn<std::string>({tsl::io::compression::kNone,
                                                 tsl::io::compression::kGzip,
@@ -15,11 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -44,7 +49,7 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
   TF_RETURN_IF_ERROR(grpc_util::Retry(
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
-                                     split_provider_index_, *split,
+                                     split_provider_index_, locality_, *split,
                                      *end_of_splits);
       },
       "get next split",
@@ -81,6 +86,89 @@ Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+Status LocalitySplitProvider::GetNext(absl::string_view locality,
+                                      Tensor* split, bool* end_of_splits) {
+  auto match = buffer_.end();
+  if (!locality.empty()) {
+    match = std::find_if(buffer_.begin(), buffer_.end(),
+                         [locality](const BufferedSplit& buffered) {
+                           return buffered.locality == locality;
+                         });
+    while (match == buffer_.end() && !end_of_splits_ &&
+           static_cast<int64_t>(buffer_.size()) < lookahead_) {
+      TF_RETURN_IF_ERROR(BufferNextSplit());
+      if (!end_of_splits_ && buffer_.back().locality == locality) {
+        match = std::prev(buffer_.end());
+      }
+    }
+  }
+  if (match == buffer_.end() && !buffer_.empty()) {
+    // No split is stored near the requester. Steals the oldest one.
+    match = buffer_.begin();
+  }
+  if (match != buffer_.end()) {
+    *split = std::move(match->split);
+    *end_of_splits = false;
+    buffer_.erase(match);
+    return OkStatus();
+  }
+  if (end_of_splits_) {
+    *end_of_splits = true;
+    return OkStatus();
+  }
+  return split_provider_->GetNext(split, end_of_splits);
+}
+
+Status LocalitySplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
+  return GetNext(/*locality=*/"", split, end_of_splits);
+}
+
+Status LocalitySplitProvider::BufferNextSplit() {
+  BufferedSplit buffered;
+  TF_RETURN_IF_ERROR(
+      split_provider_->GetNext(&buffered.split, &end_of_splits_));
+  if (!end_of_splits_) {
+    buffered.locality = split_provider_->GetLocalityHint(buffered.split);
+    buffer_.push_back(std::move(buffered));
+  }
+  return OkStatus();
+}
+
+Status LocalitySplitProvider::Reset() {
+  buffer_.clear();
+  end_of_splits_ = false;
+  return split_provider_->Reset();
+}
+
+Status LocalitySplitProvider::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  if (!buffer_.empty()) {
+    return errors::FailedPrecondition(
+        "Cannot save a LocalitySplitProvider with ", buffer_.size(),
+        " buffered splits.");
+  }
+  return split_provider_->Save(std::move(full_name), writer);
+}
+
+Status LocalitySplitProvider::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  buffer_.clear();
+  end_of_splits_ = false;
+  return split_provider_->Restore(std::move(full_name), reader);
+}
+
+int64_t LocalitySplitProvider::Cardinality() const {
+  return split_provider_->Cardinality();
+}
+
+void LocalitySplitProvider::Cancel() { split_provider_->Cancel(); }
+
+std::string LocalitySplitProvider::GetLocalityHint(const Tensor& split) const {
+  return split_provider_->GetLocalityHint(split);
+}
+
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -35,14 +39,18 @@ namespace data {
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
 class DataServiceSplitProvider : public SplitProvider {
  public:
+  // `locality` is the locality of the worker, which the dispatcher uses to
+  // prefer splits stored near the worker.
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           const std::string& locality = "")
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        locality_(locality) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -57,12 +65,58 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::string locality_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
+// SplitProvider which prefers to hand out splits whose locality hint matches
+// the locality of the requester. Up to `lookahead` splits are read ahead from
+// the wrapped split provider to find a match. A requester without a matching
+// split steals the oldest buffered split, so idle workers are never starved.
+// With a `lookahead` of 0, splits are produced in the wrapped provider's order.
+//
+// This class is not thread-safe.
+class LocalitySplitProvider : public SplitProvider {
+ public:
+  LocalitySplitProvider(std::unique_ptr<SplitProvider> split_provider,
+                        int64_t lookahead)
+      : split_provider_(std::move(split_provider)), lookahead_(lookahead) {}
+
+  // Gets the next split, preferring a split whose locality hint is
+  // `locality`. An empty `locality` matches no split.
+  Status GetNext(absl::string_view locality, Tensor* split,
+                 bool* end_of_splits);
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override;
+  Status Reset() override;
+  Status Save(std::function<std::string(std::string)> full_name,
+              IteratorStateWriter* writer) override;
+  Status Restore(std::function<std::string(std::string)> full_name,
+                 IteratorStateReader* reader) override;
+  int64_t Cardinality() const override;
+  void Cancel() override;
+  std::string GetLocalityHint(const Tensor& split) const override;
+
+ private:
+  struct BufferedSplit {
+    Tensor split;
+    std::string locality;
+  };
+
+  // Reads the next split of the wrapped provider into `buffer_`.
+  Status BufferNextSplit();
+
+  const std::unique_ptr<SplitProvider> split_provider_;
+  const int64_t lookahead_;
+  // Splits read ahead from `split_provider_` but not yet handed out.
+  std::deque<BufferedSplit> buffer_;
+  // Whether `split_provider_` has reached the end of splits.
+  bool end_of_splits_ = false;
+};
+
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
@@ -17,13 +17,17 @@ limitations under the License.
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/test_util.h"
+#include "tensorflow/core/data/split_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -33,6 +37,7 @@ namespace data {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
 
 std::vector<int64_t> GetCardinalities(
@@ -110,6 +115,73 @@ TEST(SplitProviderTest, SampleFromDatasetsCardinality) {
               UnorderedElementsAre(5, 5, 5, kInfiniteCardinality));
 }
 
+// Produces splits 0, 1, ..., n - 1, where even splits are stored in "zone_0"
+// and odd splits in "zone_1".
+class ZonedSplitProvider : public IndexSplitProvider {
+ public:
+  explicit ZonedSplitProvider(int64_t n) : IndexSplitProvider(n) {}
+
+  std::string GetLocalityHint(const Tensor& split) const override {
+    return absl::StrCat("zone_", split.scalar<int64_t>()() % 2);
+  }
+};
+
+std::vector<int64_t> GetSplits(LocalitySplitProvider& split_provider,
+                               absl::string_view locality, int64_t count) {
+  std::vector<int64_t> splits;
+  for (int64_t i = 0; i < count; ++i) {
+    Tensor split;
+    bool end_of_splits = false;
+    TF_CHECK_OK(split_provider.GetNext(locality, &split, &end_of_splits));
+    if (end_of_splits) {
+      break;
+    }
+    splits.push_back(split.scalar<int64_t>()());
+  }
+  return splits;
+}
+
+TEST(LocalitySplitProviderTest, PrefersLocalSplits) {
+  LocalitySplitProvider split_provider(std::make_unique<ZonedSplitProvider>(8),
+                                       /*lookahead=*/4);
+  EXPECT_THAT(GetSplits(split_provider, "zone_1", 2), ElementsAre(1, 3));
+  EXPECT_THAT(GetSplits(split_provider, "zone_0", 2), ElementsAre(0, 2));
+  EXPECT_THAT(GetSplits(split_provider, "", 10), ElementsAre(4, 5, 6, 7));
+}
+
+TEST(LocalitySplitProviderTest, StealsRemoteSplits) {
+  LocalitySplitProvider split_provider(std::make_unique<ZonedSplitProvider>(6),
+                                       /*lookahead=*/4);
+  EXPECT_THAT(GetSplits(split_provider, "zone_0", 3), ElementsAre(0, 2, 4));
+  // No split is left in zone 0, so buffered zone 1 splits are stolen.
+  EXPECT_THAT(GetSplits(split_provider, "zone_0", 10), ElementsAre(1, 3, 5));
+}
+
+TEST(LocalitySplitProviderTest, UnknownLocality) {
+  LocalitySplitProvider split_provider(std::make_unique<ZonedSplitProvider>(4),
+                                       /*lookahead=*/4);
+  EXPECT_THAT(GetSplits(split_provider, "zone_2", 10),
+              ElementsAre(0, 1, 2, 3));
+}
+
+TEST(LocalitySplitProviderTest, NoLookahead) {
+  LocalitySplitProvider split_provider(std::make_unique<ZonedSplitProvider>(4),
+                                       /*lookahead=*/0);
+  EXPECT_THAT(GetSplits(split_provider, "zone_1", 10),
+              ElementsAre(0, 1, 2, 3));
+}
+
+TEST(LocalitySplitProviderTest, Reset) {
+  LocalitySplitProvider split_provider(std::make_unique<ZonedSplitProvider>(4),
+                                       /*lookahead=*/4);
+  EXPECT_THAT(GetSplits(split_provider, "zone_1", 10), ElementsAre(1, 3, 0, 2));
+  EXPECT_THAT(GetSplits(split_provider, "zone_1", 10), IsEmpty());
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_THAT(GetSplits(split_provider, "zone_1", 1), ElementsAre(1));
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_THAT(GetSplits(split_provider, "", 10), ElementsAre(0, 1, 2, 3));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -152,8 +153,11 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
+  // If `spill_options` has a directory, elements evicted from memory that a
+  // lagging trainer still needs are spilled to it.
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+                             size_t max_cache_size_bytes,
+                             CrossTrainerCacheSpillOptions spill_options = {});
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -179,6 +183,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    Status SerializeElement(const GetElementResult& element,
+                            std::string& serialized) const override;
+    StatusOr<GetElementResult> DeserializeElement(
+        const std::string& serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
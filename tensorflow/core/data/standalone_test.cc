@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/standalone.h"
 
+#include <limits>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tsl/lib/core/status_test_util.h"
 
 namespace tensorflow {
@@ -574,6 +576,41 @@ TEST(NoAutotune, Standalone) {
   EXPECT_EQ(iterator->model(), nullptr);
 }
 
+// Returns the dataset graph of `graph_string` with the stop of its range set
+// to `stop`.
+GraphDef GraphWithRangeStop(const char* graph_string, int64_t stop) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(graph_string, &graph_def);
+  for (NodeDef& node : *graph_def.mutable_node()) {
+    if (node.name() == "Const/_1") {
+      (*node.mutable_attr())["value"].mutable_tensor()->set_int64_val(0, stop);
+    }
+  }
+  return graph_def;
+}
+
+// Measures the cost of GetNext through a pipeline, so that the difference
+// between pipelines is the per-element overhead of their extra stages.
+void BM_GetNext(::testing::benchmark::State& state, const char* graph_string) {
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph(
+      {},
+      GraphWithRangeStop(graph_string, std::numeric_limits<int64_t>::max()),
+      &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  for (auto s : state) {
+    outputs.clear();
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+  }
+}
+
+BENCHMARK_CAPTURE(BM_GetNext, Range, kRangeGraphProto);
+BENCHMARK_CAPTURE(BM_GetNext, RangeMap, kMapGraphProto);
+BENCHMARK_CAPTURE(BM_GetNext, RangeMapNoAutotune, kMapGraphNoAutotuneProto);
+
 }  // namespace
 }  // namespace standalone
 }  // namespace data
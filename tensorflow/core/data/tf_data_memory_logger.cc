@@ -19,9 +19,11 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/tfdataz_metrics.h"
 #include "tensorflow/core/platform/env.h"
@@ -33,12 +35,28 @@ namespace data {
 
 namespace {
 const int64_t kLogFrequencyS = 30;  // How often to log.
+const int kNumTopIterators = 5;     // How many iterators to log.
+const int kNumTopNodes = 3;         // How many nodes to log per iterator.
 
 struct IteratorMemoryUsage {
   std::optional<std::string> dataset_name;
   int64_t memory_usage;
+  // The nodes of the iterator buffering the most bytes, in decreasing order.
+  std::vector<std::pair<std::string, int64_t>> top_node_usages;
 };
 
+std::vector<std::pair<std::string, int64_t>> TopNodeUsages(
+    const absl::flat_hash_map<std::string, int64_t>& node_usages) {
+  std::vector<std::pair<std::string, int64_t>> top_node_usages(
+      node_usages.begin(), node_usages.end());
+  std::sort(top_node_usages.begin(), top_node_usages.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+  if (top_node_usages.size() > kNumTopNodes) {
+    top_node_usages.resize(kNumTopNodes);
+  }
+  return top_node_usages;
+}
+
 int64_t TotalMemoryUsage(const std::vector<IteratorMemoryUsage>& usages) {
   int64_t total_memory_usage = 0;
   for (const auto& usage : usages) {
@@ -52,9 +70,10 @@ void LogDatasetMemoryUsage() {
       metric_collectors = TfDatazMetricsRegistry::GetIteratorMetricCollectors();
   std::vector<IteratorMemoryUsage> usages;
   for (const auto& metric_collector : metric_collectors) {
-    usages.push_back(
-        IteratorMemoryUsage{metric_collector->DatasetName(),
-                            metric_collector->GetIteratorTotalMemoryUsage()});
+    usages.push_back(IteratorMemoryUsage{
+        metric_collector->DatasetName(),
+        metric_collector->GetIteratorTotalMemoryUsage(),
+        TopNodeUsages(metric_collector->GetIteratorMemoryUsagePerNode())});
   }
   std::sort(usages.begin(), usages.end(), [](const auto& a, const auto& b) {
     return a.memory_usage > b.memory_usage;
@@ -63,7 +82,7 @@ void LogDatasetMemoryUsage() {
           << ") tf.data iterators: "
           << strings::HumanReadableNumBytes(TotalMemoryUsage(usages));
   VLOG(4) << "Top usages: ";
-  for (int i = 0; i < 5; ++i) {
+  for (int i = 0; i < kNumTopIterators; ++i) {
     if (i >= usages.size()) {
       break;
     }
@@ -75,6 +94,10 @@ void LogDatasetMemoryUsage() {
     } else {
       VLOG(4) << "Dataset " << i << " (no name set): " << usage_string;
     }
+    for (const auto& [node_name, node_usage] : usages[i].top_node_usages) {
+      VLOG(4) << "  " << node_name << ": "
+              << strings::HumanReadableNumBytes(node_usage);
+    }
   }
 }
 
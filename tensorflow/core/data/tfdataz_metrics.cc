@@ -131,6 +131,15 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+absl::flat_hash_map<std::string, int64_t>
+TfDatazMetricsCollector::GetIteratorMemoryUsagePerNode() {
+  absl::flat_hash_map<std::string, int64_t> usage;
+  for (const auto& [node_name, bytes] : iterator_->BufferedBytesPerNode()) {
+    usage[node_name] = static_cast<int64_t>(bytes);
+  }
+  return usage;
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
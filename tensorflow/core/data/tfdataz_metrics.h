@@ -20,6 +20,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -116,6 +117,11 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the memory (in bytes) used by each node of the iterator, keyed by
+  // the long name of the node. The values add up to
+  // `GetIteratorTotalMemoryUsage()`.
+  absl::flat_hash_map<std::string, int64_t> GetIteratorMemoryUsagePerNode();
+
  private:
   DatasetBaseIterator* iterator_;  // not owned
   ApproximateLatencyEstimator latency_estimator_;
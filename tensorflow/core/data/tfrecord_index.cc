@@ -0,0 +1,184 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_statistics.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kIndexSuffix[] = ".tfrecord_index";
+constexpr char kMagic[] = "TFRIDX01";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+constexpr size_t kHeaderSize = kMagicSize + 3 * sizeof(uint64_t);
+constexpr size_t kFooterSize = sizeof(uint32_t);
+// Buffer used to scan the record headers when building an index.
+constexpr int64_t kScanBufferSize = 256 << 10;  // 256KB.
+
+Status CheckFileVersion(Env* env, const std::string& filename,
+                        const TFRecordIndex& index) {
+  FileStatistics stats;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stats));
+  if (static_cast<uint64_t>(stats.length) != index.file_size ||
+      stats.mtime_nsec != index.file_mtime_nsec) {
+    return errors::FailedPrecondition("The index of ", filename,
+                                      " was built for a different version of "
+                                      "the file.");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+std::string TFRecordIndexFilename(absl::string_view cache_dir,
+                                  absl::string_view filename) {
+  const uint64_t fingerprint = Fingerprint64(filename);
+  return io::JoinPath(
+      cache_dir, absl::StrCat(io::Basename(filename), ".",
+                              absl::Hex(fingerprint, absl::kZeroPad16),
+                              kIndexSuffix));
+}
+
+Status BuildTFRecordIndex(Env* env, const std::string& filename,
+                          TFRecordIndex* index) {
+  FileStatistics stats;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stats));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReaderOptions options;
+  options.buffer_size = kScanBufferSize;
+  io::RecordReader reader(file.get(), options);
+
+  index->file_size = stats.length;
+  index->file_mtime_nsec = stats.mtime_nsec;
+  index->offsets.clear();
+  uint64 offset = 0;
+  while (true) {
+    const uint64 record_offset = offset;
+    int num_skipped = 0;
+    Status s = reader.SkipRecords(&offset, /*num_to_skip=*/1, &num_skipped);
+    if (errors::IsOutOfRange(s) && num_skipped == 0) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(s);
+    index->offsets.push_back(record_offset);
+  }
+  VLOG(2) << "Indexed " << index->offsets.size() << " records of " << filename;
+  return OkStatus();
+}
+
+Status WriteTFRecordIndex(Env* env, const std::string& cache_dir,
+                          const std::string& filename,
+                          const TFRecordIndex& index) {
+  std::string contents;
+  contents.reserve(kHeaderSize + index.offsets.size() * sizeof(uint64_t) +
+                   kFooterSize);
+  contents.append(kMagic, kMagicSize);
+  core::PutFixed64(&contents, index.file_size);
+  core::PutFixed64(&contents, static_cast<uint64_t>(index.file_mtime_nsec));
+  core::PutFixed64(&contents, index.offsets.size());
+  for (uint64_t offset : index.offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  const uint32_t crc = crc32c::Value(contents.data(), contents.size());
+  core::PutFixed32(&contents, crc32c::Mask(crc));
+
+  // Write to a temporary file first, so that concurrent readers never observe
+  // a partially written index.
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(cache_dir));
+  const std::string index_filename = TFRecordIndexFilename(cache_dir, filename);
+  const std::string tmp_filename =
+      absl::StrCat(index_filename, ".tmp.", random::New64());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  Status s = env->RenameFile(tmp_filename, index_filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+Status ReadTFRecordIndex(Env* env, const std::string& cache_dir,
+                         const std::string& filename, TFRecordIndex* index) {
+  const std::string index_filename = TFRecordIndexFilename(cache_dir, filename);
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() < kHeaderSize + kFooterSize ||
+      absl::string_view(contents.data(), kMagicSize) != kMagic) {
+    return errors::DataLoss("Invalid TFRecord index ", index_filename);
+  }
+  const size_t data_size = contents.size() - kFooterSize;
+  const uint32_t crc =
+      crc32c::Unmask(core::DecodeFixed32(contents.data() + data_size));
+  if (crc != crc32c::Value(contents.data(), data_size)) {
+    return errors::DataLoss("Corrupted TFRecord index ", index_filename);
+  }
+  const char* p = contents.data() + kMagicSize;
+  index->file_size = core::DecodeFixed64(p);
+  index->file_mtime_nsec = static_cast<int64_t>(core::DecodeFixed64(p + 8));
+  const uint64_t num_records = core::DecodeFixed64(p + 16);
+  if (num_records != (data_size - kHeaderSize) / sizeof(uint64_t) ||
+      (data_size - kHeaderSize) % sizeof(uint64_t) != 0) {
+    return errors::DataLoss("Invalid number of records in TFRecord index ",
+                            index_filename);
+  }
+  p = contents.data() + kHeaderSize;
+  index->offsets.resize(num_records);
+  for (uint64_t i = 0; i < num_records; ++i) {
+    index->offsets[i] = core::DecodeFixed64(p + i * sizeof(uint64_t));
+  }
+  return CheckFileVersion(env, filename, *index);
+}
+
+Status LoadOrBuildTFRecordIndex(Env* env, const std::string& cache_dir,
+                                const std::string& filename,
+                                TFRecordIndex* index) {
+  if (cache_dir.empty()) {
+    return BuildTFRecordIndex(env, filename, index);
+  }
+  Status s = ReadTFRecordIndex(env, cache_dir, filename, index);
+  if (s.ok()) {
+    return OkStatus();
+  }
+  if (!errors::IsNotFound(s)) {
+    LOG(WARNING) << "Rebuilding the index of " << filename << ": " << s;
+  }
+  TF_RETURN_IF_ERROR(BuildTFRecordIndex(env, filename, index));
+  s = WriteTFRecordIndex(env, cache_dir, filename, *index);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write the index of " << filename << " to "
+                 << cache_dir << ": " << s;
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
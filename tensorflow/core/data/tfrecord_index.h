@@ -0,0 +1,85 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// Offsets of the records of an uncompressed TFRecord file, which allow reading
+// the record at any position with a single seek.
+//
+// Indices are only persisted to an index cache directory chosen by the user,
+// never next to the data. The index of a file is stored in that directory
+// with the layout below (integers are little-endian):
+//
+//   char[8]  magic "TFRIDX01"
+//   uint64   size of the indexed file in bytes
+//   uint64   modification time of the indexed file in nanoseconds
+//   uint64   number of records `n`
+//   uint64   offsets[n]
+//   uint32   masked crc32c of all the preceding bytes
+//
+// The size and modification time identify the version of the file that was
+// indexed, so that an index is not used after its file is rewritten.
+struct TFRecordIndex {
+  uint64_t file_size = 0;
+  int64_t file_mtime_nsec = 0;
+  std::vector<uint64_t> offsets;
+};
+
+// Returns the name of the index file of the TFRecord file `filename` in the
+// index cache directory `cache_dir`. The name is made of the basename of the
+// file and of a fingerprint of its full path, so that files with the same
+// basename in different directories get distinct indices.
+std::string TFRecordIndexFilename(absl::string_view cache_dir,
+                                  absl::string_view filename);
+
+// Scans the record headers of the uncompressed TFRecord file `filename` and
+// returns their offsets.
+Status BuildTFRecordIndex(Env* env, const std::string& filename,
+                          TFRecordIndex* index);
+
+// Writes `index` to the index file of `filename` in `cache_dir`, creating the
+// directory if needed.
+Status WriteTFRecordIndex(Env* env, const std::string& cache_dir,
+                          const std::string& filename,
+                          const TFRecordIndex& index);
+
+// Reads the index file of `filename` in `cache_dir`. Returns `NotFound` if
+// there is no index, `DataLoss` if it is corrupted and `FailedPrecondition` if
+// it was built for a different version of the file.
+Status ReadTFRecordIndex(Env* env, const std::string& cache_dir,
+                         const std::string& filename, TFRecordIndex* index);
+
+// Builds the index of `filename`. If `cache_dir` is not empty, the index is
+// read from it if it has a valid one, and is otherwise written to it so that
+// later readers can reuse it. Failing to write the index is not an error.
+Status LoadOrBuildTFRecordIndex(Env* env, const std::string& cache_dir,
+                                const std::string& filename,
+                                TFRecordIndex* index);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
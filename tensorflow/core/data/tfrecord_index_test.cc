@@ -0,0 +1,185 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class TFRecordIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    data_dir_ = io::JoinPath(testing::TmpDir(), "tfrecord_index_test_data");
+    cache_dir_ = io::JoinPath(testing::TmpDir(), "tfrecord_index_test_cache");
+    int64_t undeleted_files, undeleted_dirs;
+    for (const std::string& dir : {data_dir_, cache_dir_}) {
+      Env::Default()
+          ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+          .IgnoreError();
+    }
+    TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(data_dir_));
+    filename_ = io::JoinPath(data_dir_, "records");
+    TF_ASSERT_OK(WriteRecords({"a", "bb", "", "dddd"}));
+  }
+
+  Status WriteRecords(const std::vector<std::string>& records) {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename_, &file));
+    io::RecordWriter writer(file.get());
+    for (const std::string& record : records) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    return file->Close();
+  }
+
+  // Reads the record at `offset` of the test file.
+  std::string ReadRecord(uint64 offset) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename_, &file));
+    io::RecordReader reader(file.get());
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    return record;
+  }
+
+  std::string data_dir_;
+  std::string cache_dir_;
+  std::string filename_;
+};
+
+TEST_F(TFRecordIndexTest, BuildIndex) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename_, &index));
+  ASSERT_EQ(index.offsets.size(), 4);
+  EXPECT_EQ(ReadRecord(index.offsets[0]), "a");
+  EXPECT_EQ(ReadRecord(index.offsets[1]), "bb");
+  EXPECT_EQ(ReadRecord(index.offsets[2]), "");
+  EXPECT_EQ(ReadRecord(index.offsets[3]), "dddd");
+}
+
+TEST_F(TFRecordIndexTest, EmptyFile) {
+  TF_ASSERT_OK(WriteRecords({}));
+  TFRecordIndex index;
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename_, &index));
+  EXPECT_TRUE(index.offsets.empty());
+}
+
+TEST_F(TFRecordIndexTest, WriteAndRead) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename_, &index));
+  TF_ASSERT_OK(
+      WriteTFRecordIndex(Env::Default(), cache_dir_, filename_, index));
+  TFRecordIndex read_index;
+  TF_ASSERT_OK(
+      ReadTFRecordIndex(Env::Default(), cache_dir_, filename_, &read_index));
+  EXPECT_EQ(read_index.file_size, index.file_size);
+  EXPECT_EQ(read_index.file_mtime_nsec, index.file_mtime_nsec);
+  EXPECT_EQ(read_index.offsets, index.offsets);
+}
+
+TEST_F(TFRecordIndexTest, MissingIndex) {
+  TFRecordIndex index;
+  EXPECT_TRUE(errors::IsNotFound(
+      ReadTFRecordIndex(Env::Default(), cache_dir_, filename_, &index)));
+}
+
+TEST_F(TFRecordIndexTest, CorruptedIndex) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename_, &index));
+  TF_ASSERT_OK(
+      WriteTFRecordIndex(Env::Default(), cache_dir_, filename_, index));
+  const std::string index_filename =
+      TFRecordIndexFilename(cache_dir_, filename_);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+  contents[contents.size() / 2] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, contents));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ReadTFRecordIndex(Env::Default(), cache_dir_, filename_, &index)));
+}
+
+TEST_F(TFRecordIndexTest, StaleIndex) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename_, &index));
+  TF_ASSERT_OK(
+      WriteTFRecordIndex(Env::Default(), cache_dir_, filename_, index));
+  TF_ASSERT_OK(WriteRecords({"a", "bb", "", "dddd", "eeeee"}));
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      ReadTFRecordIndex(Env::Default(), cache_dir_, filename_, &index)));
+
+  TF_ASSERT_OK(
+      LoadOrBuildTFRecordIndex(Env::Default(), cache_dir_, filename_, &index));
+  ASSERT_EQ(index.offsets.size(), 5);
+  EXPECT_EQ(ReadRecord(index.offsets[4]), "eeeee");
+}
+
+TEST_F(TFRecordIndexTest, LoadOrBuildWritesIndexToCacheDir) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(
+      LoadOrBuildTFRecordIndex(Env::Default(), cache_dir_, filename_, &index));
+  EXPECT_EQ(index.offsets.size(), 4);
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      TFRecordIndexFilename(cache_dir_, filename_)));
+  TFRecordIndex read_index;
+  TF_ASSERT_OK(
+      ReadTFRecordIndex(Env::Default(), cache_dir_, filename_, &read_index));
+  EXPECT_EQ(read_index.offsets, index.offsets);
+  // Nothing is written next to the data.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(data_dir_, &children));
+  EXPECT_EQ(children, std::vector<std::string>({"records"}));
+}
+
+TEST_F(TFRecordIndexTest, LoadOrBuildWithoutCacheDir) {
+  TFRecordIndex index;
+  TF_ASSERT_OK(LoadOrBuildTFRecordIndex(Env::Default(), /*cache_dir=*/"",
+                                        filename_, &index));
+  EXPECT_EQ(index.offsets.size(), 4);
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(data_dir_, &children));
+  EXPECT_EQ(children, std::vector<std::string>({"records"}));
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(cache_dir_)));
+}
+
+TEST_F(TFRecordIndexTest, IndexFilenamesOfSameBasename) {
+  EXPECT_NE(TFRecordIndexFilename(cache_dir_, "/a/records"),
+            TFRecordIndexFilename(cache_dir_, "/b/records"));
+}
+
+TEST_F(TFRecordIndexTest, TruncatedFile) {
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename_, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_,
+                                 contents.substr(0, contents.size() - 2)));
+  TFRecordIndex index;
+  EXPECT_FALSE(BuildTFRecordIndex(Env::Default(), filename_, &index).ok());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/unbounded_thread_pool.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -23,12 +24,41 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/resource.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 
 namespace tensorflow {
 namespace data {
 
+UnboundedThreadPool::UnboundedThreadPool(Env* env, const string& thread_name,
+                                         const ThreadOptions& thread_options,
+                                         int num_work_stealing_threads)
+    : unbounded_work_queue_(env, thread_name, thread_options),
+      num_work_stealing_threads_(std::max(num_work_stealing_threads, 0)) {
+  if (num_work_stealing_threads_ == 0) {
+    return;
+  }
+  int num_pools = 1;
+  if (thread_options.numa_node == port::kNUMANoAffinity &&
+      port::NUMAEnabled()) {
+    num_pools = std::min(port::NUMANumNodes(), num_work_stealing_threads_);
+  }
+  for (int i = 0; i < num_pools; ++i) {
+    ThreadOptions pool_thread_options = thread_options;
+    if (num_pools > 1) {
+      pool_thread_options.numa_node = i;
+    }
+    const int num_threads = num_work_stealing_threads_ / num_pools +
+                            (i < num_work_stealing_threads_ % num_pools);
+    work_stealing_pools_.push_back(std::make_unique<thread::ThreadPool>(
+        env, pool_thread_options, strings::StrCat(thread_name, "_nonblocking"),
+        num_threads, /*low_latency_hint=*/false));
+  }
+}
+
 // A logical implementation of the `tensorflow::Thread` interface that uses
 // physical threads in an `UnboundedThreadPool` to perform the work.
 //
@@ -81,6 +111,31 @@ void UnboundedThreadPool::Schedule(std::function<void()> fn) {
   ScheduleOnWorkQueue(std::move(tagged_fn), /*done=*/nullptr);
 }
 
+void UnboundedThreadPool::ScheduleNonBlocking(std::function<void()> fn) {
+  if (work_stealing_pools_.empty()) {
+    Schedule(std::move(fn));
+    return;
+  }
+  const int num_pools = work_stealing_pools_.size();
+  // Keep the closure on the NUMA node of the scheduling thread, which is the
+  // node of the work-stealing thread when a closure schedules more work.
+  int index = port::NUMAGetThreadNodeAffinity();
+  if (index < 0 || index >= num_pools) {
+    index = next_pool_.fetch_add(1, std::memory_order_relaxed) % num_pools;
+  }
+  work_stealing_pools_[index]->Schedule([fn = std::move(fn)]() {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag, "ThreadPool");
+    fn();
+  });
+}
+
+std::function<void(std::function<void()>)>
+UnboundedThreadPool::get_non_blocking_runner() {
+  return [this](std::function<void()> fn) {
+    ScheduleNonBlocking(std::move(fn));
+  };
+}
+
 int UnboundedThreadPool::NumThreads() const { return -1; }
 
 int UnboundedThreadPool::CurrentThreadId() const { return -1; }
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_UNBOUNDED_THREAD_POOL_H_
 #define TENSORFLOW_CORE_DATA_UNBOUNDED_THREAD_POOL_H_
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 
 namespace tensorflow {
@@ -33,6 +36,12 @@ namespace data {
 // potentially large number of "logical" threads onto a smaller number of
 // "physical" threads. The multiplexing is achieved by using an
 // `UnboundedWorkQueue`.
+//
+// The pool can additionally own a fixed number of work-stealing threads, with
+// a queue per thread, for closures which do not block (see
+// `ScheduleNonBlocking`). On machines with multiple NUMA nodes, these threads
+// are split into a pool per node, and closures run on the node of the thread
+// which schedules them.
 class UnboundedThreadPool : public thread::ThreadPoolInterface {
  public:
   UnboundedThreadPool(Env* env, const string& thread_name)
@@ -40,6 +49,11 @@ class UnboundedThreadPool : public thread::ThreadPoolInterface {
   UnboundedThreadPool(Env* env, const string& thread_name,
                       const ThreadOptions& thread_options)
       : unbounded_work_queue_(env, thread_name, thread_options) {}
+  // Creates a pool with `num_work_stealing_threads` work-stealing threads in
+  // addition to the unbounded logical threads.
+  UnboundedThreadPool(Env* env, const string& thread_name,
+                      const ThreadOptions& thread_options,
+                      int num_work_stealing_threads);
   ~UnboundedThreadPool() override = default;
 
   // Returns an implementation of `ThreadFactory` that can be used to create
@@ -50,6 +64,17 @@ class UnboundedThreadPool : public thread::ThreadPoolInterface {
   int NumThreads() const override;
   int CurrentThreadId() const override;
 
+  // Schedules `fn` on the work-stealing threads, or on a logical thread if the
+  // pool has none. `fn` must not block on other work scheduled on this pool.
+  void ScheduleNonBlocking(std::function<void()> fn);
+
+  // Returns a runner which schedules closures with `ScheduleNonBlocking`, for
+  // use as `IteratorContext::Params::runner`.
+  std::function<void(std::function<void()>)> get_non_blocking_runner();
+
+  // Returns the number of work-stealing threads.
+  int NumWorkStealingThreads() const { return num_work_stealing_threads_; }
+
  private:
   class LogicalThreadFactory;
   class LogicalThreadWrapper;
@@ -58,6 +83,12 @@ class UnboundedThreadPool : public thread::ThreadPoolInterface {
                            std::shared_ptr<Notification> done);
 
   UnboundedWorkQueue unbounded_work_queue_;
+  int num_work_stealing_threads_ = 0;
+  // A work-stealing pool per NUMA node, or a single pool without NUMA
+  // affinity.
+  std::vector<std::unique_ptr<thread::ThreadPool>> work_stealing_pools_;
+  // Used to spread closures scheduled from threads without NUMA affinity.
+  std::atomic<uint64_t> next_pool_ = 0;
 };
 
 }  // namespace data
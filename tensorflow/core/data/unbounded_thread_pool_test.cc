@@ -83,6 +83,39 @@ TEST(UnboundedThreadPool, MultipleBlockingThreads) {
   }
 }
 
+TEST(UnboundedThreadPool, ScheduleNonBlocking) {
+  UnboundedThreadPool pool(Env::Default(), "test", ThreadOptions(),
+                           /*num_work_stealing_threads=*/4);
+  EXPECT_EQ(pool.NumWorkStealingThreads(), 4);
+
+  // Each closure schedules another closure, which runs on the work-stealing
+  // threads as well.
+  const int kNumClosures = 100;
+  std::atomic<int> i(0);
+  BlockingCounter bc(2 * kNumClosures);
+  auto runner = pool.get_non_blocking_runner();
+  for (int j = 0; j < kNumClosures; ++j) {
+    runner([&]() {
+      ++i;
+      bc.DecrementCount();
+      pool.ScheduleNonBlocking([&]() {
+        ++i;
+        bc.DecrementCount();
+      });
+    });
+  }
+  bc.Wait();
+  EXPECT_EQ(i, 2 * kNumClosures);
+}
+
+TEST(UnboundedThreadPool, ScheduleNonBlockingWithoutWorkStealingThreads) {
+  UnboundedThreadPool pool(Env::Default(), "test");
+  EXPECT_EQ(pool.NumWorkStealingThreads(), 0);
+  Notification n;
+  pool.ScheduleNonBlocking([&n]() { n.Notify(); });
+  n.WaitForNotification();
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -12,8 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cinttypes>
+#include <functional>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -223,6 +228,186 @@ void PrintSizeHistory(const MemoryDump& md, bool by_age) {
     }
   }
 }
+
+// Adds [begin, end) to the disjoint ranges of `ranges`, from begin to end.
+void AddRange(uint64 begin, uint64 end, std::map<uint64, uint64>* ranges) {
+  auto it = ranges->upper_bound(begin);
+  if (it != ranges->begin() && std::prev(it)->second >= begin) {
+    --it;
+    begin = it->first;
+  }
+  while (it != ranges->end() && it->first <= end) {
+    end = std::max(end, it->second);
+    it = ranges->erase(it);
+  }
+  (*ranges)[begin] = end;
+}
+
+void RemoveRange(uint64 begin, uint64 end, std::map<uint64, uint64>* ranges) {
+  auto it = ranges->upper_bound(begin);
+  if (it != ranges->begin() && std::prev(it)->second > begin) --it;
+  while (it != ranges->end() && it->first < end) {
+    const uint64 range_begin = it->first;
+    const uint64 range_end = it->second;
+    it = ranges->erase(it);
+    if (range_begin < begin) (*ranges)[range_begin] = begin;
+    if (range_end > end) (*ranges)[end] = range_end;
+  }
+}
+
+// The chunks in use, by address, and the op that allocated them.
+struct LiveChunk {
+  int64_t size;
+  string op_name;
+};
+
+// Returns the fragmentation of the free memory of `pool` between the chunks
+// of `live`, computed as by BFCAllocator::GetFragmentation().
+double Fragmentation(const std::map<uint64, uint64>& pool,
+                     const std::map<uint64, LiveChunk>& live) {
+  uint64 free_bytes = 0;
+  uint64 largest_free_bytes = 0;
+  for (const auto& range : pool) {
+    uint64 begin = range.first;
+    for (auto it = live.lower_bound(range.first);
+         it != live.end() && it->first < range.second; ++it) {
+      free_bytes += it->first - begin;
+      largest_free_bytes = std::max(largest_free_bytes, it->first - begin);
+      begin = it->first + it->second.size;
+    }
+    if (range.second > begin) {
+      free_bytes += range.second - begin;
+      largest_free_bytes = std::max(largest_free_bytes, range.second - begin);
+    }
+  }
+  return free_bytes == 0 ? 0 : 1 - static_cast<double>(largest_free_bytes) /
+                                       static_cast<double>(free_bytes);
+}
+
+const char* EventTypeName(const MemEvent& event) {
+  switch (event.type()) {
+    case MemEvent::ALLOCATE:
+      return "alloc";
+    case MemEvent::DEALLOCATE:
+      return "free";
+    case MemEvent::EXTEND:
+      return "extend";
+    case MemEvent::RELEASE:
+      return "release";
+    default:
+      return "unknown";
+  }
+}
+
+// Replays the recorded events of `md`, and prints the memory use and
+// fragmentation at `num_points` points in time, and the ops that held the
+// memory at the peak.
+void PrintTimeline(const MemoryDump& md, int num_points) {
+  printf("------------Memory Timeline--------\n");
+  if (md.event_size() == 0) {
+    printf("no memory events, see TF_GPU_BFC_MEMORY_EVENT_HISTORY_SIZE\n");
+    return;
+  }
+
+  // The events may not start with an empty allocator, so the state before the
+  // first event is found by undoing the events from the final state.
+  std::map<uint64, uint64> pool;
+  std::map<uint64, LiveChunk> live;
+  for (const auto& it : md.chunk()) {
+    AddRange(it.address(), it.address() + it.size(), &pool);
+    if (it.in_use()) {
+      live[it.address()] = {it.size(), "<before history>"};
+    }
+  }
+  for (int i = md.event_size() - 1; i >= 0; --i) {
+    const MemEvent& event = md.event(i);
+    switch (event.type()) {
+      case MemEvent::ALLOCATE:
+        live.erase(event.address());
+        break;
+      case MemEvent::DEALLOCATE:
+        live[event.address()] = {event.size(), "<before history>"};
+        break;
+      case MemEvent::EXTEND:
+        RemoveRange(event.address(), event.address() + event.size(), &pool);
+        break;
+      case MemEvent::RELEASE:
+        AddRange(event.address(), event.address() + event.size(), &pool);
+        break;
+      default:
+        break;
+    }
+  }
+
+  int peak = 0;
+  for (int i = 1; i < md.event_size(); ++i) {
+    if (md.event(i).bytes_in_use() > md.event(peak).bytes_in_use()) peak = i;
+  }
+  const uint64 start_micros = md.event(0).timestamp_micros();
+  const int interval = std::max(1, md.event_size() / std::max(num_points, 1));
+  const uint64 end_micros = md.event(md.event_size() - 1).timestamp_micros();
+  printf("num events: %d over %" PRIu64 " us\n", md.event_size(),
+         static_cast<uint64_t>(end_micros - start_micros));
+  std::vector<std::pair<int64_t, string>> bytes_by_op;
+  for (int i = 0; i < md.event_size(); ++i) {
+    const MemEvent& event = md.event(i);
+    switch (event.type()) {
+      case MemEvent::ALLOCATE:
+        live[event.address()] = {
+            event.size(), event.op_name().empty() ? "<unknown>"
+                                                  : event.op_name()};
+        break;
+      case MemEvent::DEALLOCATE:
+        live.erase(event.address());
+        break;
+      case MemEvent::EXTEND:
+        AddRange(event.address(), event.address() + event.size(), &pool);
+        break;
+      case MemEvent::RELEASE:
+        RemoveRange(event.address(), event.address() + event.size(), &pool);
+        break;
+      default:
+        break;
+    }
+    if (i % interval == 0 || i == peak || i == md.event_size() - 1) {
+      printf("  t=+%" PRIu64 "us bytes_in_use=%" PRId64 " pool_bytes=%" PRId64
+             " fragmentation=%.3f %s %" PRId64 " bytes%s\n",
+             static_cast<uint64_t>(event.timestamp_micros() - start_micros),
+             static_cast<int64_t>(event.bytes_in_use()),
+             static_cast<int64_t>(event.pool_bytes()),
+             Fragmentation(pool, live), EventTypeName(event),
+             static_cast<int64_t>(event.size()), i == peak ? " (peak)" : "");
+    }
+    if (i == peak) {
+      std::map<string, int64_t> op_bytes;
+      for (const auto& it : live) {
+        op_bytes[it.second.op_name] += it.second.size;
+      }
+      for (const auto& it : op_bytes) {
+        bytes_by_op.emplace_back(it.second, it.first);
+      }
+    }
+  }
+
+  const MemEvent& peak_event = md.event(peak);
+  printf("Peak bytes_in_use: %" PRId64 " at t=+%" PRIu64 "us",
+         static_cast<int64_t>(peak_event.bytes_in_use()),
+         static_cast<uint64_t>(peak_event.timestamp_micros() - start_micros));
+  if (peak_event.type() == MemEvent::ALLOCATE) {
+    printf(", reached by %" PRId64 " bytes for op=%s step=%x",
+           static_cast<int64_t>(peak_event.size()),
+           peak_event.op_name().c_str(),
+           static_cast<uint>(0xFFFF & peak_event.step_id()));
+  }
+  printf("\nBytes in use at peak by op:\n");
+  std::sort(bytes_by_op.begin(), bytes_by_op.end(),
+            std::greater<std::pair<int64_t, string>>());
+  for (const auto& it : bytes_by_op) {
+    printf("  %12" PRId64 " %5.1f%% %s\n", it.first,
+           100 * it.first / static_cast<float>(peak_event.bytes_in_use()),
+           it.second.c_str());
+  }
+}
 }  // namespace tensorflow
 
 int main(int argc, char** argv) {
@@ -233,6 +418,8 @@ int main(int argc, char** argv) {
   bool by_age = true;
   bool freed_at = false;
   bool size_history = false;
+  bool timeline = false;
+  int32_t timeline_points = 20;
   std::string chunk_type = "A";
   std::string op_name = "";
   std::vector<tensorflow::Flag> flag_list = {
@@ -258,6 +445,12 @@ int main(int argc, char** argv) {
                        "(default).  Displays only Chunks of this type."),
       tensorflow::Flag("size_history", &size_history,
                        "If true, show the size history."),
+      tensorflow::Flag("timeline", &timeline,
+                       "If true, replay the recorded memory events and show "
+                       "the memory use and fragmentation over time, and the "
+                       "ops that held the memory at the peak."),
+      tensorflow::Flag("timeline_points", &timeline_points,
+                       "The number of points in time shown by --timeline."),
   };
   bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
   if (!parse_result || path.empty()) {
@@ -267,6 +460,7 @@ int main(int argc, char** argv) {
   tensorflow::port::InitMain(argv[0], &argc, &argv);
   tensorflow::MemoryDump md = tensorflow::ReadDumpFile(path);
   tensorflow::PrintSummary(md);
+  if (timeline) tensorflow::PrintTimeline(md, timeline_points);
   if (chunk_type != "A") {
     md = FilterByChunkType(md, chunk_type[0]);
   }
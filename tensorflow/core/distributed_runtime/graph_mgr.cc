@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 
 #include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/build_graph_options.h"
@@ -68,7 +70,10 @@ GraphMgr::GraphMgr(const WorkerEnv* worker_env, const DeviceMgr* device_mgr)
 }
 
 GraphMgr::~GraphMgr() {
-  for (const auto& p : table_) p.second->Unref();
+  for (const auto& p : table_) {
+    p.second->collective_group_prefetch_cancel_mgr->StartCancel();
+    p.second->Unref();
+  }
 }
 
 GraphMgr::Item::~Item() {
@@ -101,6 +106,45 @@ static Status ValidateGraphDefForDevices(const GraphDef& gdef) {
   return OkStatus();
 }
 
+// Starts resolving the groups of the collective ops of "graph" on "device"
+// in the background, so that the resolution overlaps with the rest of the
+// graph registration and the first step of these ops finds their groups
+// complete. The ops join their groups again when they run, which is a no-op
+// for a device that has already joined. The resolution is cancelled with
+// "cancel_mgr", e.g. when the graph is deregistered before its groups are
+// complete.
+static void PrefetchCollectiveGroups(
+    const Graph& graph, Device* device, ParamResolverInterface* resolver,
+    std::shared_ptr<CancellationManager> cancel_mgr) {
+  std::unordered_set<int32> group_keys;
+  for (const Node* node : graph.op_nodes()) {
+    if (!node->IsCollective()) continue;
+    int32_t group_key;
+    int32_t group_size;
+    if (!TryGetNodeAttr(node->attrs(), "group_key", &group_key) ||
+        !TryGetNodeAttr(node->attrs(), "group_size", &group_size) ||
+        group_size <= 0 || !group_keys.insert(group_key).second) {
+      continue;
+    }
+    auto* group_params = new CollGroupParams;
+    group_params->group_key = group_key;
+    group_params->group_size = group_size;
+    group_params->device_type = DeviceType(device->device_type());
+    VLOG(1) << "Prefetching group " << group_key << " for " << device->name();
+    resolver->CompleteGroupAsync(
+        device->attributes(), group_params, cancel_mgr.get(),
+        [group_params, device_name = device->name(),
+         cancel_mgr](const Status& s) {
+          // The collective ops report the error when they run.
+          if (!s.ok()) {
+            VLOG(1) << "Failed to prefetch group " << group_params->group_key
+                    << " for " << device_name << ": " << s;
+          }
+          delete group_params;
+        });
+  }
+}
+
 Status GraphMgr::DecorateAndPublishGraphForDebug(
     const DebugOptions& debug_options, Graph* graph, Device* device) {
   std::unique_ptr<DebugGraphDecoratorInterface> decorator;
@@ -205,6 +249,10 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
   LocalExecutorParams params;
+  params.step_graph_replay =
+      config_proto.experimental().enable_step_graph_replay();
+  params.step_arena_allocation =
+      config_proto.experimental().enable_step_arena_allocation();
 
   item->units.reserve(partitions.size());
   item->graph_mgr = this;
@@ -306,6 +354,17 @@ Status GraphMgr::Register(const string& handle, const GraphDef& gdef,
     return s;
   }
 
+  ParamResolverInterface* resolver =
+      worker_env_->collective_executor_mgr != nullptr
+          ? worker_env_->collective_executor_mgr->GetParamResolver()
+          : nullptr;
+  if (resolver != nullptr) {
+    for (const ExecutionUnit& unit : item->units) {
+      PrefetchCollectiveGroups(*unit.graph, unit.device, resolver,
+                               item->collective_group_prefetch_cancel_mgr);
+    }
+  }
+
   // Inserts one item into table_.
   {
     mutex_lock l(mu_);
@@ -330,6 +389,7 @@ Status GraphMgr::Deregister(const string& handle) {
     item = iter->second;
     table_.erase(iter);
   }
+  item->collective_group_prefetch_cancel_mgr->StartCancel();
   item->Unref();
   return OkStatus();
 }
@@ -345,6 +405,7 @@ Status GraphMgr::DeregisterAll() {
     table_.clear();
   }
   for (auto item : items) {
+    item->collective_group_prefetch_cancel_mgr->StartCancel();
     item->Unref();
   }
   return OkStatus();
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -148,6 +149,12 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64_t collective_graph_key;
+
+    // Cancels the resolution of the collective groups started at registration
+    // when the graph is deregistered. Shared with the pending resolutions,
+    // which may complete after the item is destroyed.
+    std::shared_ptr<CancellationManager> collective_group_prefetch_cancel_mgr =
+        std::make_shared<CancellationManager>();
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_mgr.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/debug.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTaskName[] = "/job:worker/replica:0/task:0";
+constexpr char kDeviceName[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+// Never completes a group on its own, so that the only way for a resolution
+// to finish is through its cancellation manager.
+class PendingGroupParamResolver : public TestParamResolver {
+ public:
+  void CompleteGroupAsync(const DeviceAttributes& device,
+                          CollGroupParams* group_params,
+                          CancellationManager* cancel_mgr,
+                          const StatusCallback& done) override {
+    mutex_lock l(mu_);
+    group_keys_.push_back(group_params->group_key);
+    if (cancel_mgr == nullptr) {
+      done(errors::Internal("Group resolution cannot be cancelled"));
+      return;
+    }
+    CancellationToken token = cancel_mgr->get_cancellation_token();
+    bool registered = cancel_mgr->RegisterCallback(token, [this, done]() {
+      done(errors::Cancelled("Group resolution cancelled"));
+      mutex_lock l(mu_);
+      ++num_cancelled_;
+    });
+    if (!registered) {
+      done(errors::Cancelled("Group resolution cancelled"));
+      ++num_cancelled_;
+    }
+  }
+
+  std::vector<int32> group_keys() {
+    mutex_lock l(mu_);
+    return group_keys_;
+  }
+
+  int num_cancelled() {
+    mutex_lock l(mu_);
+    return num_cancelled_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<int32> group_keys_ TF_GUARDED_BY(mu_);
+  int num_cancelled_ TF_GUARDED_BY(mu_) = 0;
+};
+
+class GraphMgrTest : public ::testing::Test {
+ protected:
+  GraphMgrTest() {
+    std::vector<std::unique_ptr<Device>> devices;
+    TF_CHECK_OK(DeviceFactory::AddDevices(SessionOptions(), kTaskName,
+                                          &devices));
+    device_mgr_ = std::make_unique<StaticDeviceMgr>(std::move(devices));
+    worker_env_.env = Env::Default();
+    worker_env_.device_mgr = device_mgr_.get();
+    worker_env_.collective_executor_mgr =
+        std::make_unique<TestCollectiveExecutorMgr>(&resolver_,
+                                                    /*rma=*/nullptr);
+    graph_mgr_ = std::make_unique<GraphMgr>(&worker_env_, device_mgr_.get());
+  }
+
+  // Returns a graph with a single CollectiveReduce in group "group_key".
+  static GraphDef CollectiveGraph(int group_key) {
+    GraphDef gdef;
+    NodeDef* input = gdef.add_node();
+    TF_CHECK_OK(NodeDefBuilder("input", "Const")
+                    .Attr("dtype", DT_FLOAT)
+                    .Attr("value", test::AsScalar<float>(1.0f))
+                    .Device(kDeviceName)
+                    .Finalize(input));
+    TF_CHECK_OK(NodeDefBuilder("reduce", "CollectiveReduce")
+                    .Input("input", 0, DT_FLOAT)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("group_size", 2)
+                    .Attr("group_key", group_key)
+                    .Attr("instance_key", 1)
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Id")
+                    .Attr("subdiv_offsets", std::vector<int32>())
+                    .Device(kDeviceName)
+                    .Finalize(gdef.add_node()));
+    return gdef;
+  }
+
+  Status Register(const GraphDef& gdef, std::string* graph_handle) {
+    return graph_mgr_->Register("session", gdef, GraphOptions(),
+                                DebugOptions(), ConfigProto(),
+                                /*collective_graph_key=*/0,
+                                /*session=*/nullptr, /*cluster_flr=*/nullptr,
+                                graph_handle);
+  }
+
+  PendingGroupParamResolver resolver_;
+  std::unique_ptr<DeviceMgr> device_mgr_;
+  WorkerEnv worker_env_;
+  std::unique_ptr<GraphMgr> graph_mgr_;
+};
+
+TEST_F(GraphMgrTest, DeregisterCancelsCollectiveGroupPrefetch) {
+  std::string graph_handle;
+  TF_ASSERT_OK(Register(CollectiveGraph(/*group_key=*/7), &graph_handle));
+  EXPECT_EQ(resolver_.group_keys(), std::vector<int32>({7}));
+  EXPECT_EQ(resolver_.num_cancelled(), 0);
+
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle));
+  EXPECT_EQ(resolver_.num_cancelled(), 1);
+}
+
+TEST_F(GraphMgrTest, DeregisterAllCancelsCollectiveGroupPrefetches) {
+  std::string graph_handle1;
+  TF_ASSERT_OK(Register(CollectiveGraph(/*group_key=*/7), &graph_handle1));
+  std::string graph_handle2;
+  TF_ASSERT_OK(Register(CollectiveGraph(/*group_key=*/8), &graph_handle2));
+  EXPECT_EQ(resolver_.group_keys(), std::vector<int32>({7, 8}));
+
+  TF_ASSERT_OK(graph_mgr_->DeregisterAll());
+  EXPECT_EQ(resolver_.num_cancelled(), 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/eager/streaming_enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -74,6 +77,19 @@ bool EnableStreaming() {
   return result;
 }
 
+// The largest number of operations coalesced into a single streaming enqueue
+// request, read from "TF_EAGER_CLIENT_STREAMING_ENQUEUE_BATCH_SIZE". With the
+// default of 1, every request is streamed as is.
+int64_t StreamingEnqueueBatchSize() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar(
+      "TF_EAGER_CLIENT_STREAMING_ENQUEUE_BATCH_SIZE", 1, &result));
+  return result;
+}
+
+using GrpcStreamingEnqueueBatcher =
+    StreamingEnqueueBatcher<StreamingRPCDispatcher<EnqueueResponse>>;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -202,7 +218,7 @@ class GrpcEagerClient : public EagerClient {
     mutex_lock l(mu_);
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
-      it->second.CancelCall();
+      it->second->CancelCall();
       enqueue_dispatchers_.erase(it);
     } else if (EnableStreaming()) {
       LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
@@ -221,19 +237,20 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      core::RefCountPtr<GrpcStreamingEnqueueBatcher> dispatcher;
+      {
+        mutex_lock l(mu_);
+        auto& it_dispatcher = enqueue_dispatchers_[request->context_id()];
+        if (it_dispatcher == nullptr) {
+          it_dispatcher.reset(new GrpcStreamingEnqueueBatcher(
+              StreamingEnqueueBatchSize(), &stub_, cq_,
+              "/tensorflow.eager.EagerService/StreamingEnqueue"));
+        }
+        dispatcher.reset(it_dispatcher.get());
+        dispatcher->Ref();
       }
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      dispatcher->SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -256,7 +273,7 @@ class GrpcEagerClient : public EagerClient {
 
   mutable mutex mu_;
 
-  std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
+  std::unordered_map<uint64, core::RefCountPtr<GrpcStreamingEnqueueBatcher>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
   StatusCallback callback_wrapper(StatusCallback done) {
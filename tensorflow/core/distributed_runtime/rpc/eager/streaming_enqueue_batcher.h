@@ -0,0 +1,178 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_STREAMING_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_STREAMING_ENQUEUE_BATCHER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Streams the enqueue requests of a remote context with `Dispatcher`, usually
+// a StreamingRPCDispatcher<EnqueueResponse>, coalescing consecutive requests
+// into batches of up to `max_batch_size` operations while kMaxInFlightBatches
+// earlier batches wait for their responses. So requests are still sent right
+// away when the stream keeps up, and sent in fewer, larger messages when it
+// does not. The order of the requests is preserved, and each response gets the
+// queue responses of its own request.
+//
+// A failure of any request of a batch is reported to all its requests, as a
+// failure of an earlier request of the stream already is.
+//
+// Thread-safe.
+template <class Dispatcher>
+class StreamingEnqueueBatcher : public core::RefCounted {
+ public:
+  static constexpr int kMaxInFlightBatches = 4;
+
+  // `dispatcher_args` are passed to the constructor of the dispatcher.
+  template <typename... DispatcherArgs>
+  explicit StreamingEnqueueBatcher(int64_t max_batch_size,
+                                   DispatcherArgs&&... dispatcher_args)
+      : dispatcher_(std::forward<DispatcherArgs>(dispatcher_args)...),
+        max_batch_size_(max_batch_size) {}
+
+  void SendNextRequest(const EnqueueRequest& request, EnqueueResponse* response,
+                       StatusCallback done) {
+    if (max_batch_size_ <= 1) {
+      dispatcher_.SendNextRequest(request, response, std::move(done));
+      return;
+    }
+    {
+      mutex_lock l(mu_);
+      if (pending_ == nullptr) {
+        pending_ = std::make_unique<Batch>();
+        pending_->request.set_context_id(request.context_id());
+      }
+      pending_->request.mutable_queue()->MergeFrom(request.queue());
+      pending_->callers.push_back(
+          {response, std::move(done), request.queue_size()});
+      if (num_in_flight_ < kMaxInFlightBatches ||
+          pending_->request.queue_size() >= max_batch_size_) {
+        ready_.push_back(std::move(pending_));
+      }
+    }
+    SendReadyBatches();
+  }
+
+  // Cancels the streaming call, which fails the batches waiting for their
+  // responses, and fails the batches that were not sent yet.
+  void CancelCall() {
+    std::deque<std::unique_ptr<Batch>> unsent;
+    {
+      mutex_lock l(mu_);
+      unsent.swap(ready_);
+      if (pending_ != nullptr) {
+        unsent.push_back(std::move(pending_));
+      }
+    }
+    dispatcher_.CancelCall();
+    for (std::unique_ptr<Batch>& batch : unsent) {
+      batch->Complete(errors::Cancelled("Streaming enqueue was cancelled"));
+    }
+  }
+
+ private:
+  struct Caller {
+    EnqueueResponse* response;
+    StatusCallback done;
+    int num_items;
+  };
+
+  struct Batch {
+    // Splits the responses of the batch over the responses of its requests.
+    void Complete(const Status& status) {
+      int item = 0;
+      for (Caller& caller : callers) {
+        if (status.ok()) {
+          for (int i = 0;
+               i < caller.num_items && item < response.queue_response_size();
+               ++i, ++item) {
+            caller.response->add_queue_response()->Swap(
+                response.mutable_queue_response(item));
+          }
+        }
+        caller.done(status);
+      }
+    }
+
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<Caller> callers;
+  };
+
+  // Sends the ready batches in order, unless another call is already sending
+  // them. The callbacks of the dispatcher can be invoked while it sends.
+  void SendReadyBatches() {
+    mu_.lock();
+    if (sending_) {
+      mu_.unlock();
+      return;
+    }
+    sending_ = true;
+    while (!ready_.empty()) {
+      Batch* batch = ready_.front().release();
+      ready_.pop_front();
+      ++num_in_flight_;
+      mu_.unlock();
+      this->Ref();
+      dispatcher_.SendNextRequest(
+          batch->request, &batch->response, [this, batch](const Status& s) {
+            std::unique_ptr<Batch> done_batch(batch);
+            done_batch->Complete(s);
+            {
+              mutex_lock l(mu_);
+              --num_in_flight_;
+              if (pending_ != nullptr) {
+                ready_.push_back(std::move(pending_));
+              }
+            }
+            SendReadyBatches();
+            this->Unref();
+          });
+      mu_.lock();
+    }
+    sending_ = false;
+    mu_.unlock();
+  }
+
+  Dispatcher dispatcher_;
+  const int64_t max_batch_size_;
+
+  mutex mu_;
+  // The batch that new requests are added to.
+  std::unique_ptr<Batch> pending_ TF_GUARDED_BY(mu_);
+  // The batches to send, in order.
+  std::deque<std::unique_ptr<Batch>> ready_ TF_GUARDED_BY(mu_);
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_STREAMING_ENQUEUE_BATCHER_H_
@@ -0,0 +1,297 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/streaming_enqueue_batcher.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// The requests sent by a FakeDispatcher, which are completed by the test.
+struct FakeStream {
+  struct Call {
+    EnqueueRequest request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  // Fills the response of call `i` with a queue response per operation, each
+  // naming its operation as a device, and completes the call with `status`.
+  void Complete(int i, const Status& status = OkStatus()) {
+    Call call;
+    {
+      mutex_lock l(mu);
+      call = std::move(calls[i]);
+    }
+    for (const QueueItem& item : call.request.queue()) {
+      call.response->add_queue_response()->add_device(
+          absl::StrCat("op:", item.operation().id()));
+    }
+    call.done(status);
+  }
+
+  int num_calls() {
+    mutex_lock l(mu);
+    return calls.size();
+  }
+
+  EnqueueRequest request(int i) {
+    mutex_lock l(mu);
+    return calls[i].request;
+  }
+
+  std::vector<int64_t> operation_ids(int i) {
+    std::vector<int64_t> ids;
+    for (const QueueItem& item : request(i).queue()) {
+      ids.push_back(item.operation().id());
+    }
+    return ids;
+  }
+
+  mutex mu;
+  std::vector<Call> calls TF_GUARDED_BY(mu);
+  // If set, sends notify `send_started` and block until `unblock_sends` is
+  // notified.
+  Notification* send_started = nullptr;
+  Notification* unblock_sends = nullptr;
+  bool cancelled = false;
+};
+
+class FakeDispatcher {
+ public:
+  explicit FakeDispatcher(FakeStream* stream) : stream_(stream) {}
+
+  void SendNextRequest(const EnqueueRequest& request, EnqueueResponse* response,
+                       StatusCallback done) {
+    if (stream_->unblock_sends != nullptr) {
+      stream_->send_started->Notify();
+      stream_->unblock_sends->WaitForNotification();
+    }
+    mutex_lock l(stream_->mu);
+    stream_->calls.push_back({request, response, std::move(done)});
+  }
+
+  void CancelCall() { stream_->cancelled = true; }
+
+ private:
+  FakeStream* stream_;
+};
+
+using TestBatcher = StreamingEnqueueBatcher<FakeDispatcher>;
+
+// A request with an operation per id.
+EnqueueRequest MakeRequest(const std::vector<int64_t>& ids) {
+  EnqueueRequest request;
+  request.set_context_id(7);
+  for (int64_t id : ids) {
+    request.add_queue()->mutable_operation()->set_id(id);
+  }
+  return request;
+}
+
+std::vector<std::string> Devices(const EnqueueResponse& response) {
+  std::vector<std::string> devices;
+  for (const QueueResponse& queue_response : response.queue_response()) {
+    devices.insert(devices.end(), queue_response.device().begin(),
+                   queue_response.device().end());
+  }
+  return devices;
+}
+
+// The response and status of a request sent to the batcher.
+struct Result {
+  EnqueueResponse response;
+  Status status;
+  bool done = false;
+
+  StatusCallback callback() {
+    return [this](const Status& s) {
+      status = s;
+      done = true;
+    };
+  }
+};
+
+TEST(StreamingEnqueueBatcherTest, SendsRequestsAsIsWithoutBatching) {
+  FakeStream stream;
+  core::RefCountPtr<TestBatcher> batcher(
+      new TestBatcher(/*max_batch_size=*/1, &stream));
+  constexpr int kNumRequests = TestBatcher::kMaxInFlightBatches + 2;
+  std::vector<Result> results(kNumRequests);
+  for (int i = 0; i < kNumRequests; ++i) {
+    batcher->SendNextRequest(MakeRequest({i}), &results[i].response,
+                             results[i].callback());
+  }
+  ASSERT_EQ(stream.num_calls(), kNumRequests);
+  for (int i = 0; i < kNumRequests; ++i) {
+    EXPECT_EQ(stream.operation_ids(i), std::vector<int64_t>({i}));
+    stream.Complete(i);
+    EXPECT_TRUE(results[i].done);
+    EXPECT_EQ(Devices(results[i].response),
+              std::vector<std::string>({absl::StrCat("op:", i)}));
+  }
+}
+
+TEST(StreamingEnqueueBatcherTest, BatchesRequestsWhileBatchesAreInFlight) {
+  FakeStream stream;
+  core::RefCountPtr<TestBatcher> batcher(
+      new TestBatcher(/*max_batch_size=*/8, &stream));
+  constexpr int kInFlight = TestBatcher::kMaxInFlightBatches;
+  std::vector<Result> results(kInFlight + 3);
+  // The first requests are sent as is, until kMaxInFlightBatches wait for
+  // their responses.
+  for (int i = 0; i < kInFlight; ++i) {
+    batcher->SendNextRequest(MakeRequest({i}), &results[i].response,
+                             results[i].callback());
+  }
+  ASSERT_EQ(stream.num_calls(), kInFlight);
+  // The next ones wait for a response, and are sent in a single batch.
+  batcher->SendNextRequest(MakeRequest({10, 11}), &results[kInFlight].response,
+                           results[kInFlight].callback());
+  batcher->SendNextRequest(MakeRequest({12}), &results[kInFlight + 1].response,
+                           results[kInFlight + 1].callback());
+  batcher->SendNextRequest(MakeRequest({13, 14}),
+                           &results[kInFlight + 2].response,
+                           results[kInFlight + 2].callback());
+  EXPECT_EQ(stream.num_calls(), kInFlight);
+
+  stream.Complete(0);
+  EXPECT_TRUE(results[0].done);
+  TF_EXPECT_OK(results[0].status);
+  ASSERT_EQ(stream.num_calls(), kInFlight + 1);
+  EXPECT_EQ(stream.operation_ids(kInFlight),
+            std::vector<int64_t>({10, 11, 12, 13, 14}));
+  EXPECT_EQ(stream.request(kInFlight).context_id(), uint64_t{7});
+
+  // Each request gets the responses of its own operations.
+  stream.Complete(kInFlight);
+  for (int i = kInFlight; i < kInFlight + 3; ++i) {
+    EXPECT_TRUE(results[i].done);
+    TF_EXPECT_OK(results[i].status);
+  }
+  EXPECT_EQ(Devices(results[kInFlight].response),
+            std::vector<std::string>({"op:10", "op:11"}));
+  EXPECT_EQ(Devices(results[kInFlight + 1].response),
+            std::vector<std::string>({"op:12"}));
+  EXPECT_EQ(Devices(results[kInFlight + 2].response),
+            std::vector<std::string>({"op:13", "op:14"}));
+
+  for (int i = 1; i < kInFlight; ++i) {
+    stream.Complete(i);
+    EXPECT_TRUE(results[i].done);
+  }
+}
+
+TEST(StreamingEnqueueBatcherTest, SendsFullBatchesRightAway) {
+  FakeStream stream;
+  core::RefCountPtr<TestBatcher> batcher(
+      new TestBatcher(/*max_batch_size=*/3, &stream));
+  constexpr int kInFlight = TestBatcher::kMaxInFlightBatches;
+  std::vector<Result> results(kInFlight + 3);
+  for (int i = 0; i < kInFlight; ++i) {
+    batcher->SendNextRequest(MakeRequest({i}), &results[i].response,
+                             results[i].callback());
+  }
+  batcher->SendNextRequest(MakeRequest({10, 11}), &results[kInFlight].response,
+                           results[kInFlight].callback());
+  EXPECT_EQ(stream.num_calls(), kInFlight);
+  // This request fills the batch, which is sent although kMaxInFlightBatches
+  // are still in flight.
+  batcher->SendNextRequest(MakeRequest({12}), &results[kInFlight + 1].response,
+                           results[kInFlight + 1].callback());
+  ASSERT_EQ(stream.num_calls(), kInFlight + 1);
+  EXPECT_EQ(stream.operation_ids(kInFlight),
+            std::vector<int64_t>({10, 11, 12}));
+  batcher->SendNextRequest(MakeRequest({13}), &results[kInFlight + 2].response,
+                           results[kInFlight + 2].callback());
+  EXPECT_EQ(stream.num_calls(), kInFlight + 1);
+
+  // A failure of a batch is reported to all its requests.
+  stream.Complete(kInFlight, errors::Internal("remote failure"));
+  EXPECT_TRUE(errors::IsInternal(results[kInFlight].status));
+  EXPECT_TRUE(errors::IsInternal(results[kInFlight + 1].status));
+  EXPECT_TRUE(Devices(results[kInFlight].response).empty());
+  // Which gives way to the next batch.
+  ASSERT_EQ(stream.num_calls(), kInFlight + 2);
+  EXPECT_EQ(stream.operation_ids(kInFlight + 1), std::vector<int64_t>({13}));
+
+  for (int i = 0; i < kInFlight; ++i) {
+    stream.Complete(i);
+  }
+  stream.Complete(kInFlight + 1);
+  for (const Result& result : results) {
+    EXPECT_TRUE(result.done);
+  }
+}
+
+TEST(StreamingEnqueueBatcherTest, CancelFailsUnsentBatches) {
+  FakeStream stream;
+  core::RefCountPtr<TestBatcher> batcher(
+      new TestBatcher(/*max_batch_size=*/2, &stream));
+  Notification send_started;
+  Notification unblock_sends;
+  stream.send_started = &send_started;
+  stream.unblock_sends = &unblock_sends;
+  std::vector<Result> results(3);
+
+  // The first request blocks in the dispatcher, so the batches of the next
+  // requests are left ready but unsent, as when the stream is slow to accept
+  // them.
+  std::unique_ptr<Thread> sender(Env::Default()->StartThread(
+      ThreadOptions(), "sender", [&batcher, &results]() {
+        batcher->SendNextRequest(MakeRequest({0}), &results[0].response,
+                                 results[0].callback());
+      }));
+  send_started.WaitForNotification();
+  batcher->SendNextRequest(MakeRequest({1, 2}), &results[1].response,
+                           results[1].callback());
+  batcher->SendNextRequest(MakeRequest({3}), &results[2].response,
+                           results[2].callback());
+  EXPECT_FALSE(results[1].done);
+  EXPECT_FALSE(results[2].done);
+
+  batcher->CancelCall();
+  EXPECT_TRUE(stream.cancelled);
+  EXPECT_TRUE(results[1].done);
+  EXPECT_TRUE(errors::IsCancelled(results[1].status));
+  EXPECT_TRUE(results[2].done);
+  EXPECT_TRUE(errors::IsCancelled(results[2].status));
+
+  unblock_sends.Notify();
+  sender.reset();
+  // Only the first request reached the dispatcher.
+  ASSERT_EQ(stream.num_calls(), 1);
+  EXPECT_EQ(stream.operation_ids(0), std::vector<int64_t>({0}));
+  stream.Complete(0, errors::Cancelled("cancelled"));
+  EXPECT_TRUE(errors::IsCancelled(results[0].status));
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -26,7 +26,9 @@ limitations under the License.
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/server_builder.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -590,6 +592,39 @@ ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
   return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
 }
 
+namespace {
+
+constexpr char kGrpcProtocol[] = "grpc";
+constexpr char kGrpcTransportPrefix[] = "grpc+";
+
+struct RendezvousMgrRegistry {
+  mutex mu;
+  std::map<string, RendezvousMgrCreationFunction> funcs TF_GUARDED_BY(mu);
+};
+
+RendezvousMgrRegistry* GetRendezvousMgrRegistry() {
+  static RendezvousMgrRegistry* registry = new RendezvousMgrRegistry;
+  return registry;
+}
+
+}  // namespace
+
+void RegisterGrpcRendezvousMgr(const string& transport,
+                               RendezvousMgrCreationFunction func) {
+  RendezvousMgrRegistry* registry = GetRendezvousMgrRegistry();
+  mutex_lock l(registry->mu);
+  if (!registry->funcs.emplace(transport, std::move(func)).second) {
+    LOG(FATAL) << "Two RendezvousMgrs registered for transport " << transport;
+  }
+}
+
+RendezvousMgrCreationFunction GetGrpcRendezvousMgr(const string& transport) {
+  RendezvousMgrRegistry* registry = GetRendezvousMgrRegistry();
+  mutex_lock l(registry->mu);
+  auto it = registry->funcs.find(transport);
+  return it == registry->funcs.end() ? nullptr : it->second;
+}
+
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
   return std::unique_ptr<Master>(new Master(master_env, 0.0));
 }
@@ -598,10 +633,19 @@ std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
 Status GrpcServer::Create(const ServerDef& server_def, Env* env,
                           DeviceMgr* local_device_mgr,
                           std::unique_ptr<ServerInterface>* out_server) {
-  std::unique_ptr<GrpcServer> ret(
-      new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   GrpcServerOptions options;
   options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  if (absl::StartsWith(server_def.protocol(), kGrpcTransportPrefix)) {
+    const string transport(
+        absl::StripPrefix(server_def.protocol(), kGrpcTransportPrefix));
+    options.rendezvous_mgr_func = GetGrpcRendezvousMgr(transport);
+    if (options.rendezvous_mgr_func == nullptr) {
+      return errors::InvalidArgument(
+          "No RendezvousMgr registered for protocol ", server_def.protocol());
+    }
+  }
+  std::unique_ptr<GrpcServer> ret(
+      new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   options.local_device_mgr = local_device_mgr;
   Status s = ret->Init(options);
   if (!s.ok()) {
@@ -635,7 +679,11 @@ namespace {
 class GrpcServerFactory : public ServerFactory {
  public:
   bool AcceptsOptions(const ServerDef& server_def) override {
-    return server_def.protocol() == "grpc";
+    if (absl::StartsWith(server_def.protocol(), kGrpcTransportPrefix)) {
+      return GetGrpcRendezvousMgr(string(absl::StripPrefix(
+                 server_def.protocol(), kGrpcTransportPrefix))) != nullptr;
+    }
+    return server_def.protocol() == kGrpcProtocol;
   }
 
   Status NewServer(const ServerDef& server_def, const Options& options,
@@ -64,6 +64,16 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
     WorkerCreationFunction;
 
+// Registers `func` to create the RendezvousMgr of the GrpcServers whose
+// protocol is "grpc+<transport>". This lets a transport move the tensors of
+// RecvTensor over another fabric, e.g. with RDMA reads into registered
+// buffers, while gRPC carries the control plane and the tensor metadata.
+void RegisterGrpcRendezvousMgr(const string& transport,
+                               RendezvousMgrCreationFunction func);
+
+// Returns the function registered for `transport`, or nullptr.
+RendezvousMgrCreationFunction GetGrpcRendezvousMgr(const string& transport);
+
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
@@ -21,6 +21,7 @@ limitations under the License.
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+struct RecvTensorCompressionOptions;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -45,9 +46,17 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// If "compression" is not null, "val" is compressed as per it when that is
+// worthwhile, and the result must be decoded by TensorResponse.
+//
+// The data of large tensors is not copied: *result shares the buffer of
+// "val", and holds a reference to it until *result is destroyed.
+//
 // Discards original contents of *result.
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result);
+void EncodeTensorToByteBuffer(
+    bool is_dead, const Tensor& val, bool require_ack,
+    ::grpc::ByteBuffer* result,
+    const RecvTensorCompressionOptions* compression = nullptr);
 
 }  // namespace grpc
 }  // namespace tensorflow
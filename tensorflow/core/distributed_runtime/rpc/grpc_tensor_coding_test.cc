@@ -100,4 +100,21 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, SharesLargeTensorData) {
+  ::grpc::ByteBuffer buf;
+  const char* data = nullptr;
+  {
+    Tensor t(DT_FLOAT, TensorShape({1024}));
+    test::FillIota<float>(&t, 0.0f);
+    data = t.tensor_data().data();
+    grpc::EncodeTensorToByteBuffer(false, t, false, &buf);
+  }
+  std::vector<::grpc::Slice> slices;
+  ASSERT_TRUE(buf.Dump(&slices).ok());
+  ASSERT_EQ(2, slices.size());
+  // The last slice still points to the data of the destroyed tensor.
+  EXPECT_EQ(data, reinterpret_cast<const char*>(slices[1].begin()));
+  EXPECT_EQ(1023.0f, reinterpret_cast<const float*>(slices[1].begin())[1023]);
+}
+
 }  // namespace tensorflow
@@ -148,6 +148,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -284,6 +285,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -418,17 +438,130 @@ class GrpcWorkerService : public tsl::AsyncServiceInterface {
 
 }  // namespace
 
+// The responses to the requests of RecvTensorBatch RPCs whose tensors were
+// not available when their batch was answered, by request id. The receivers
+// get them with RecvTensor requests of the same request ids.
+class RecvTensorLeftovers {
+ public:
+  // Keeps the response to "request_id" once it is finished.
+  void Add(int64_t request_id, int64_t step_id) {
+    mutex_lock l(mu_);
+    leftovers_[request_id].step_id = step_id;
+  }
+
+  // Sets the response to "request_id", and sends it if it was requested.
+  void Finish(int64_t request_id, const Status& status,
+              const ::grpc::ByteBuffer& buffer) {
+    Leftover leftover;
+    {
+      mutex_lock l(mu_);
+      auto it = leftovers_.find(request_id);
+      if (it == leftovers_.end()) return;  // The step was cleaned up.
+      if (it->second.response == nullptr) {
+        it->second.finished = true;
+        it->second.status = status;
+        it->second.buffer = buffer;
+        return;
+      }
+      leftover = std::move(it->second);
+      leftovers_.erase(it);
+    }
+    *leftover.response = buffer;
+    leftover.done(status);
+  }
+
+  // Returns false if there is no response to "request_id". Otherwise sends
+  // the response into "response", now or once it is finished.
+  bool Take(int64_t request_id, ::grpc::ByteBuffer* response,
+            const StatusCallback& done) {
+    Leftover leftover;
+    {
+      mutex_lock l(mu_);
+      auto it = leftovers_.find(request_id);
+      if (it == leftovers_.end()) return false;
+      if (!it->second.finished) {
+        it->second.response = response;
+        it->second.done = done;
+        return true;
+      }
+      leftover = std::move(it->second);
+      leftovers_.erase(it);
+    }
+    *response = leftover.buffer;
+    done(leftover.status);
+    return true;
+  }
+
+  void CleanEntriesForStep(int64_t step_id) {
+    std::vector<StatusCallback> dones;
+    {
+      mutex_lock l(mu_);
+      for (auto it = leftovers_.begin(); it != leftovers_.end();) {
+        if (it->second.step_id == step_id) {
+          if (it->second.done) dones.push_back(std::move(it->second.done));
+          leftovers_.erase(it++);
+        } else {
+          ++it;
+        }
+      }
+    }
+    for (const StatusCallback& done : dones) {
+      done(errors::Aborted("Step ", step_id, " was cleaned up"));
+    }
+  }
+
+ private:
+  struct Leftover {
+    int64_t step_id = 0;
+    bool finished = false;
+    Status status;
+    ::grpc::ByteBuffer buffer;
+    // Set if the response was requested before it was finished.
+    ::grpc::ByteBuffer* response = nullptr;
+    StatusCallback done;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<int64_t, Leftover> leftovers_ TF_GUARDED_BY(mu_);
+};
+
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
     : Worker(worker_env),
       recv_buf_max_chunk_(
           config.experimental().recv_buf_max_chunk() > 0
               ? config.experimental().recv_buf_max_chunk()
-              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)) {
+              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)),
+      recv_tensor_leftovers_(std::make_unique<RecvTensorLeftovers>()) {
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  const ConfigProto::Experimental& experimental = config.experimental();
+  DataType float_dtype = DT_INVALID;
+  switch (experimental.recv_tensor_float_compression()) {
+    case ConfigProto::Experimental::RECV_TENSOR_FLOAT_COMPRESSION_FLOAT16:
+      float_dtype = DT_HALF;
+      break;
+    case ConfigProto::Experimental::RECV_TENSOR_FLOAT_COMPRESSION_BFLOAT16:
+      float_dtype = DT_BFLOAT16;
+      break;
+    default:
+      break;
+  }
+  if (float_dtype != DT_INVALID ||
+      experimental.recv_tensor_snappy_compression()) {
+    recv_tensor_compression_ = std::make_unique<RecvTensorCompressionOptions>();
+    recv_tensor_compression_->float_dtype = float_dtype;
+    recv_tensor_compression_->snappy =
+        experimental.recv_tensor_snappy_compression();
+    if (experimental.recv_tensor_compression_min_bytes() > 0) {
+      recv_tensor_compression_->min_bytes =
+          experimental.recv_tensor_compression_min_bytes();
+    }
+  }
 }
 
+GrpcWorker::~GrpcWorker() = default;
+
 void GrpcWorker::EnableResponseCache() {
   VLOG(3) << "Enabling gRPC tensor response cache.";
   response_cache_ = std::make_unique<RpcResponseCache>();
@@ -445,13 +578,23 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t request_id = request->request_id();
   const int64_t step_id = request->step_id();
 
+  // The tensor may have been requested by a RecvTensorBatch RPC already.
+  if (request_id != 0 &&
+      recv_tensor_leftovers_->Take(request_id, response, done)) {
+    return;
+  }
+
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  const RecvTensorCompressionOptions* compression =
+      request->accept_compressed_tensor() ? recv_tensor_compression_.get()
+                                          : nullptr;
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [response, done, cache_enabled, compression](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response,
+                                     compression);
     }
     done(status);
   };
@@ -524,13 +667,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
         }
 
         const bool on_host = send_args.alloc_attrs.on_host();
-        if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
+        if (!src_dev->tensorflow_accelerator_device_info() || on_host ||
+            val.TotalBytes() == 0) {
           return rendezvous_done(val, is_dead, status);
         }
 
+        // The tensor is copied into pinned host memory, which the encoded
+        // response then sends from without another copy: the slice of the
+        // tensor data holds a reference to the buffer of `copy` until gRPC is
+        // done with it.
         DeviceContext* send_dev_context = send_args.device_context;
         AllocatorAttributes alloc_attrs;
         alloc_attrs.set_gpu_compatible(true);
+        alloc_attrs.set_nic_compatible(true);
         alloc_attrs.set_on_host(true);
         profiler::ScopedMemoryDebugAnnotation op_annotation(
             "GrpcWorker::RecvTensorAsync::consumer_callback",
@@ -554,6 +703,106 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int num_requests = request->request_size();
+  for (const RecvTensorRequest& recv_request : request->request()) {
+    if (recv_request.request_id() == 0) {
+      done(errors::InvalidArgument(
+          "RecvTensorBatch requires the request_id of every request"));
+      return;
+    }
+  }
+  // Each request is served as a RecvTensor request of its own, so that it
+  // shares the response cache, compression and device copies of RecvTensor.
+  // The requests are copied, as they may outlive the RPC.
+  struct Batch {
+    explicit Batch(const RecvTensorBatchRequest& request)
+        : requests(request.request().begin(), request.request().end()),
+          opts(requests.size()),
+          buffers(requests.size()),
+          finished(requests.size(), false) {}
+    const std::vector<RecvTensorRequest> requests;
+    std::vector<CallOptions> opts;
+    std::vector<::grpc::ByteBuffer> buffers;
+    mutex mu;
+    std::vector<bool> finished TF_GUARDED_BY(mu);
+    int num_finished TF_GUARDED_BY(mu) = 0;
+    Status status TF_GUARDED_BY(mu);
+    bool all_started TF_GUARDED_BY(mu) = false;
+    bool responded TF_GUARDED_BY(mu) = false;
+  };
+  auto batch = std::make_shared<Batch>(*request);
+  opts->SetCancelCallback([batch]() {
+    for (CallOptions& request_opts : batch->opts) {
+      request_opts.StartCancel();
+    }
+  });
+
+  // Responds with the tensors that are available, once there is any. Waiting
+  // for all of them could deadlock, as a tensor may only be produced after the
+  // receiver got another tensor of the batch.
+  auto maybe_respond = [this, opts, batch, num_requests, response, done]() {
+    Status status;
+    {
+      mutex_lock l(batch->mu);
+      if (batch->responded || !batch->all_started ||
+          (batch->num_finished == 0 && num_requests > 0)) {
+        return;
+      }
+      batch->responded = true;
+      status = batch->status;
+      for (int i = 0; status.ok() && i < num_requests; ++i) {
+        RecvTensorResponse* recv_response = response->add_response();
+        if (!batch->finished[i]) {
+          response->add_unavailable(i);
+        } else if (!tsl::GrpcMaybeParseProto(&batch->buffers[i],
+                                             recv_response)) {
+          status = errors::Internal("Cannot parse RecvTensor response");
+        }
+      }
+      if (status.ok()) {
+        for (int i : response->unavailable()) {
+          recv_tensor_leftovers_->Add(batch->requests[i].request_id(),
+                                      batch->requests[i].step_id());
+        }
+      }
+    }
+    opts->ClearCancelCallback();
+    done(status);
+  };
+
+  for (int i = 0; i < num_requests; ++i) {
+    const int64_t request_id = batch->requests[i].request_id();
+    GrpcRecvTensorAsync(
+        &batch->opts[i], &batch->requests[i], &batch->buffers[i],
+        [this, batch, i, request_id, maybe_respond](const Status& s) {
+          bool left_over;
+          {
+            mutex_lock l(batch->mu);
+            left_over = batch->responded;
+            if (!left_over) {
+              batch->finished[i] = true;
+              ++batch->num_finished;
+              batch->status.Update(s);
+            }
+          }
+          if (left_over) {
+            recv_tensor_leftovers_->Finish(request_id, s, batch->buffers[i]);
+          } else {
+            maybe_respond();
+          }
+        });
+  }
+  {
+    mutex_lock l(batch->mu);
+    batch->all_started = true;
+  }
+  maybe_respond();
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -736,6 +985,7 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  recv_tensor_leftovers_->CleanEntriesForStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
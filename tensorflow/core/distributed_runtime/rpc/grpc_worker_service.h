@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -40,10 +41,12 @@ class ConfigProto;
 struct WorkerEnv;
 class WorkerSession;
 class RpcResponseCache;
+class RecvTensorLeftovers;
 
 class GrpcWorker : public Worker {
  public:
   GrpcWorker(WorkerEnv* env, const ConfigProto& config);
+  ~GrpcWorker() override;
 
   // Specialized version of RecvTensor for gRPC, which avoids a copy.
   virtual void GrpcRecvTensorAsync(CallOptions* opts,
@@ -51,6 +54,14 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Serves each request of the batch with GrpcRecvTensorAsync(), and responds
+  // as soon as some of them are done. The responses to the others are kept
+  // for the RecvTensor requests of the same request ids.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -70,6 +81,10 @@ class GrpcWorker : public Worker {
  private:
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  // How the RecvTensor responses are compressed, for the receivers that
+  // accept it. Null if they are not.
+  std::unique_ptr<RecvTensorCompressionOptions> recv_tensor_compression_;
+  std::unique_ptr<RecvTensorLeftovers> recv_tensor_leftovers_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
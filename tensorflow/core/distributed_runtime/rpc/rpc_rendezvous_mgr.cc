@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -26,20 +31,101 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+// Batching of the RecvTensor requests of small tensors, shared by the
+// rendezvous of all steps. Within a step, the recvs from the same worker that
+// start within `window_micros` of the first one are sent in one
+// RecvTensorBatch RPC, if their edges carried at most kMaxBatchedTensorBytes
+// the last time they were received. So every edge is received with its own
+// RecvTensor RPC in the first step, and batched from then on while its
+// tensors stay small. The edges whose tensors were not available yet when
+// their batch was answered are not batched anymore, since each of them costs
+// an extra RecvTensor RPC.
+class RecvTensorBatching {
+ public:
+  static constexpr int64_t kMaxBatchedTensorBytes = 4096;
+
+  explicit RecvTensorBatching(int64_t window_micros)
+      : window_micros_(window_micros) {}
+
+  bool enabled() const { return window_micros_ > 0; }
+  int64_t window_micros() const { return window_micros_; }
+
+  // Returns a key identifying the edge of "parsed" across steps and
+  // iterations.
+  static string EdgeKey(const Rendezvous::ParsedKey& parsed) {
+    return strings::StrCat(parsed.src_device, ";", parsed.dst_device, ";",
+                           parsed.edge_name);
+  }
+
+  bool ShouldBatch(const string& src_worker, const string& edge) {
+    tf_shared_lock l(mu_);
+    return small_edges_.contains(edge) && !late_edges_.contains(edge) &&
+           !unsupported_workers_.contains(src_worker);
+  }
+
+  void RecordTensorBytes(const string& edge, int64_t num_bytes) {
+    const bool small = num_bytes <= kMaxBatchedTensorBytes;
+    {
+      tf_shared_lock l(mu_);
+      if (small_edges_.contains(edge) == small) return;
+    }
+    mutex_lock l(mu_);
+    if (small) {
+      small_edges_.insert(edge);
+    } else {
+      small_edges_.erase(edge);
+    }
+  }
+
+  void RecordUnavailable(const string& edge) {
+    mutex_lock l(mu_);
+    late_edges_.insert(edge);
+  }
+
+  // Stops batching the recvs from "src_worker", which does not support
+  // RecvTensorBatch.
+  void MarkUnsupported(const string& src_worker) {
+    mutex_lock l(mu_);
+    if (unsupported_workers_.insert(src_worker).second) {
+      LOG(WARNING) << src_worker << " does not support RecvTensorBatch, "
+                   << "receiving its tensors one at a time.";
+    }
+  }
+
+ private:
+  const int64_t window_micros_;
+  mutex mu_;
+  absl::flat_hash_set<string> small_edges_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<string> late_edges_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<string> unsupported_workers_ TF_GUARDED_BY(mu_);
+};
+
 namespace {
 
+// A recv waiting in a batch.
+struct BatchedRecv {
+  Rendezvous::ParsedKey parsed;
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback done;
+};
+
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<RecvTensorBatching> batching)
+      : BaseRemoteRendezvous(env, step_id), batching_(std::move(batching)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +135,26 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives the tensor with a RecvTensor RPC of the given request id.
+  void RecvTensorAsync(const Rendezvous::ParsedKey& parsed,
+                       const Rendezvous::Args& recv_args, int64_t request_id,
+                       const string& edge, DoneCallback done);
+
+  // The recvs of a batch share their source worker and their cancellation
+  // manager, which aborts the whole batch.
+  using BatchKey = std::pair<string, CancellationManager*>;
+
+  // Adds the recv to the pending batch of its worker, which is sent when the
+  // batching window of its first recv ends.
+  void AddToBatch(const string& src_worker, BatchedRecv recv);
+  void SendBatch(const BatchKey& key);
+  void BatchDone(RpcRecvTensorBatchCall* call);
+
+  const std::shared_ptr<RecvTensorBatching> batching_;
+  mutex batches_mu_;
+  absl::flat_hash_map<BatchKey, std::vector<BatchedRecv>> batches_
+      TF_GUARDED_BY(batches_mu_);
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -58,9 +164,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
   RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
 
-  void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
-            AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+  void Init(WorkerInterface* wi, int64_t step_id, int64_t request_id,
+            StringPiece key, AllocatorAttributes alloc_attrs,
+            Device* dst_device, const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -68,7 +175,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     done_ = std::move(done);
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
-    req_.set_request_id(GetUniqueRequestId());
+    req_.set_request_id(request_id);
+    // TensorResponse decodes the tensors that the sender chose to compress.
+    req_.set_accept_compressed_tensor(true);
   }
 
   void Reset() {
@@ -230,10 +339,118 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve a batch of tensors from the same remote process.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorBatchCall(const string& src_worker, WorkerInterface* wi,
+                         int64_t step_id, std::vector<BatchedRecv> recvs)
+      : src_worker_(src_worker), wi_(wi), recvs_(std::move(recvs)) {
+    for (const BatchedRecv& recv : recvs_) {
+      RecvTensorRequest* req = req_.add_request();
+      req->set_step_id(step_id);
+      const StringPiece key = recv.parsed.FullKey();
+      req->set_rendezvous_key(key.data(), key.size());
+      req->set_request_id(GetUniqueRequestId());
+      req->set_accept_compressed_tensor(true);
+    }
+  }
+
+  ~RpcRecvTensorBatchCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorBatchCall destructor.";
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // See RpcRecvTensorCall::StartRTCall() for why the abort is checked after
+    // sending out the RPC.
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorBatchCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  const string& src_worker() const { return src_worker_; }
+  std::vector<BatchedRecv>* recvs() { return &recvs_; }
+  RecvTensorBatchResponse* response() { return &resp_; }
+  int64_t request_id(int i) const { return req_.request(i).request_id(); }
+
+ private:
+  const string src_worker_;
+  WorkerInterface* wi_;  // Not owned.
+  std::vector<BatchedRecv> recvs_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  RpcRecvTensorBatchCall(const RpcRecvTensorBatchCall&) = delete;
+  void operator=(const RpcRecvTensorBatchCall&) = delete;
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  string edge;
+  if (batching_->enabled()) {
+    edge = RecvTensorBatching::EdgeKey(parsed);
+    string src_worker;
+    string src_rel_device;
+    if (DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                         &src_rel_device) &&
+        batching_->ShouldBatch(src_worker, edge)) {
+      AddToBatch(src_worker, {parsed, recv_args, std::move(done)});
+      return;
+    }
+  }
+  RecvTensorAsync(parsed, recv_args, GetUniqueRequestId(), edge,
+                  std::move(done));
+}
+
+void RpcRemoteRendezvous::RecvTensorAsync(const Rendezvous::ParsedKey& parsed,
+                                          const Rendezvous::Args& recv_args,
+                                          int64_t request_id,
+                                          const string& edge,
+                                          DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -269,8 +486,8 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  call->Init(rwi, step_id_, request_id, parsed.FullKey(), recv_args.alloc_attrs,
+             dst_device, recv_args, std::move(done));
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -289,12 +506,15 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  call->Start([this, call, recv_args, worker_cache, edge]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
     // current status should be bad.
     Status s = call->status();
+    if (s.ok() && !edge.empty()) {
+      batching_->RecordTensorBytes(edge, call->tensor().TotalBytes());
+    }
     // NOTE: `*session()` can potentially be deleted before we return from
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
@@ -305,15 +525,155 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::AddToBatch(const string& src_worker,
+                                     BatchedRecv recv) {
+  const BatchKey key(src_worker, recv.recv_args.cancellation_manager);
+  bool new_batch;
+  {
+    mutex_lock l(batches_mu_);
+    std::vector<BatchedRecv>& batch = batches_[key];
+    new_batch = batch.empty();
+    batch.push_back(std::move(recv));
+  }
+  if (new_batch) {
+    Ref();
+    env_->env->SchedClosureAfter(batching_->window_micros(), [this, key]() {
+      SendBatch(key);
+      Unref();
+    });
+  }
+}
+
+void RpcRemoteRendezvous::SendBatch(const BatchKey& key) {
+  std::vector<BatchedRecv> recvs;
+  {
+    mutex_lock l(batches_mu_);
+    auto it = batches_.find(key);
+    if (it == batches_.end()) return;
+    recvs = std::move(it->second);
+    batches_.erase(it);
+  }
+  const string& src_worker = key.first;
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    const Status s = errors::Internal("No worker known as ", src_worker);
+    for (BatchedRecv& recv : recvs) {
+      recv.done(s, Args(), recv.recv_args, Tensor(), false);
+    }
+    return;
+  }
+  const Rendezvous::Args recv_args = recvs.front().recv_args;
+  auto* call =
+      new RpcRecvTensorBatchCall(src_worker, rwi, step_id_, std::move(recvs));
+
+  // Record "call" in calls_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+  if (!call->status().ok()) {
+    DeregisterCall(call, recv_args);
+    call->ReleaseWorker(sess->worker_cache());
+    for (BatchedRecv& recv : *call->recvs()) {
+      recv.done(call->status(), Args(), recv.recv_args, Tensor(), false);
+    }
+    delete call;
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, recv_args, worker_cache]() {
+    DeregisterCall(call, recv_args);
+    call->ReleaseWorker(session()->worker_cache());
+    BatchDone(call);
+    delete call;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::BatchDone(RpcRecvTensorBatchCall* call) {
+  std::vector<BatchedRecv>& recvs = *call->recvs();
+  Status s = call->status();
+  if (errors::IsUnimplemented(s)) {
+    batching_->MarkUnsupported(call->src_worker());
+    for (BatchedRecv& recv : recvs) {
+      RecvFromRemoteAsync(recv.parsed, recv.recv_args, std::move(recv.done));
+    }
+    return;
+  }
+  const int num_recvs = recvs.size();
+  if (s.ok() && call->response()->response_size() != num_recvs) {
+    s = errors::Internal("RecvTensorBatch returned ",
+                         call->response()->response_size(), " tensors for ",
+                         num_recvs, " requests");
+  }
+
+  // The tensors that were not available yet are received with RecvTensor
+  // RPCs of the request ids of the batch, which the sender answers with the
+  // responses it kept for them.
+  std::vector<bool> available(num_recvs, true);
+  if (s.ok()) {
+    for (int i : call->response()->unavailable()) {
+      if (i < 0 || i >= num_recvs) {
+        s = errors::Internal("RecvTensorBatch returned an invalid index ", i);
+        break;
+      }
+      available[i] = false;
+    }
+  }
+
+  // Decodes all the tensors before calling any "done", which can delete
+  // `*session()`.
+  std::vector<TensorResponse> responses(num_recvs);
+  std::vector<Status> statuses(num_recvs, s);
+  for (int i = 0; i < num_recvs && s.ok(); ++i) {
+    if (!available[i]) continue;
+    Device* dst_device = nullptr;
+    statuses[i] =
+        session()->device_mgr()->LookupDevice(recvs[i].parsed.dst_device,
+                                              &dst_device);
+    if (statuses[i].ok()) {
+      responses[i].InitAlloc(dst_device, recvs[i].recv_args.alloc_attrs);
+      statuses[i] =
+          responses[i].InitFrom(call->response()->mutable_response(i));
+    }
+    if (statuses[i].ok()) {
+      batching_->RecordTensorBytes(RecvTensorBatching::EdgeKey(recvs[i].parsed),
+                                   responses[i].tensor().TotalBytes());
+    }
+  }
+  for (int i = 0; i < num_recvs && s.ok(); ++i) {
+    if (available[i]) continue;
+    const string edge = RecvTensorBatching::EdgeKey(recvs[i].parsed);
+    batching_->RecordUnavailable(edge);
+    RecvTensorAsync(recvs[i].parsed, recvs[i].recv_args, call->request_id(i),
+                    edge, std::move(recvs[i].done));
+  }
+  for (int i = 0; i < num_recvs; ++i) {
+    if (s.ok() && !available[i]) continue;
+    recvs[i].done(statuses[i], Args(), recvs[i].recv_args,
+                  responses[i].tensor(), responses[i].metadata().is_dead());
+  }
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  int64_t window_micros = 0;
+  Status s = ReadInt64FromEnvVar("TF_RECV_TENSOR_BATCH_WINDOW_USECS", 0,
+                                 &window_micros);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    window_micros = 0;
+  }
+  batching_ = std::make_shared<RecvTensorBatching>(window_micros);
+}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, batching_));
 }
 
 }  // end namespace tensorflow
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -27,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 
@@ -99,12 +104,65 @@ class DummyWorkerCache : public WorkerCacheInterface {
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
 
+// A worker that returns the edge name of each key as its tensor, and counts
+// the RecvTensor and RecvTensorBatch calls.
+class BatchingWorker : public TestWorkerInterface {
+ public:
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    ++num_recv_tensor_calls;
+    RecvTensorResponse proto = MakeResponse(request->rendezvous_key());
+    done(response->InitFrom(&proto));
+  }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    ++num_recv_tensor_batch_calls;
+    for (int i = 0; i < request->request_size(); ++i) {
+      const string& key = request->request(i).rendezvous_key();
+      if (MakeKey(key).edge_name == late_edge) {
+        response->add_response();
+        response->add_unavailable(i);
+      } else {
+        *response->add_response() = MakeResponse(key);
+      }
+    }
+    done(OkStatus());
+  }
+
+  std::atomic<int> num_recv_tensor_calls{0};
+  std::atomic<int> num_recv_tensor_batch_calls{0};
+  // The edge whose tensors are reported as unavailable in batches.
+  string late_edge;
+
+ private:
+  static RecvTensorResponse MakeResponse(const string& key) {
+    RecvTensorResponse response;
+    V(string(MakeKey(key).edge_name)).AsProtoField(response.mutable_tensor());
+    return response;
+  }
+};
+
+class BatchingWorkerCache : public DummyWorkerCache {
+ public:
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return &worker_;
+  }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+
+  BatchingWorker worker_;
+};
+
 static Device* CreateDevice(const char* type, const char* name) {
   class FakeDevice : public Device {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +400,70 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST(RpcRendezvousMgrBatchingTest, BatchesSmallRecvsAfterFirstStep) {
+  setenv("TF_RECV_TENSOR_BATCH_WINDOW_USECS", "10000", 1);
+  BatchingWorkerCache* cache = new BatchingWorkerCache;
+  WorkerEnv env;
+  env.env = Env::Default();
+  WorkerSession worker_session(
+      "rpc_session", "/job:mnist/replica:1/task:2",
+      std::unique_ptr<WorkerCacheInterface>(cache),
+      std::unique_ptr<DeviceMgr>(CreateDeviceMgr()),
+      std::unique_ptr<GraphMgr>(), nullptr,
+      [](WorkerSession* worker_session, bool called,
+         DeviceMgr* remote_device_mgr) { return nullptr; });
+  RpcRendezvousMgr rmgr(&env);
+  unsetenv("TF_RECV_TENSOR_BATCH_WINDOW_USECS");
+
+  const std::vector<string> edges = {"a", "b", "c"};
+  auto recv_all = [&](int64_t step_id) {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session));
+    mutex mu;
+    Status status;
+    std::vector<string> values(edges.size());
+    BlockingCounter counter(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", edges[i], FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, Rendezvous::Args(),
+          [&mu, &status, &values, &counter, i](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              if (s.ok()) values[i] = V(val);
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_EXPECT_OK(status);
+    EXPECT_EQ(edges, values);
+    rmgr.Cleanup(step_id);
+  };
+
+  // The sizes of the tensors are unknown in the first step.
+  recv_all(1);
+  EXPECT_EQ(3, cache->worker_.num_recv_tensor_calls);
+  EXPECT_EQ(0, cache->worker_.num_recv_tensor_batch_calls);
+
+  recv_all(2);
+  EXPECT_EQ(3, cache->worker_.num_recv_tensor_calls);
+  EXPECT_EQ(1, cache->worker_.num_recv_tensor_batch_calls);
+
+  // The late tensor is received on its own, and is not batched anymore.
+  cache->worker_.late_edge = "b";
+  recv_all(3);
+  EXPECT_EQ(4, cache->worker_.num_recv_tensor_calls);
+  EXPECT_EQ(2, cache->worker_.num_recv_tensor_batch_calls);
+
+  recv_all(4);
+  EXPECT_EQ(5, cache->worker_.num_recv_tensor_calls);
+  EXPECT_EQ(3, cache->worker_.num_recv_tensor_batch_calls);
+}
+
 }  // namespace tensorflow
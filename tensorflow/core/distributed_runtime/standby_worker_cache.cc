@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/standby_worker_cache.h"
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+StandbyWorkerCache::StandbyWorkerCache(WorkerCacheInterface* wrapped)
+    : WorkerCacheWrapper(wrapped), wrapped_(wrapped) {
+  std::vector<string> workers;
+  wrapped_->ListWorkers(&workers);
+  const absl::flat_hash_set<string> all_workers(workers.begin(),
+                                                workers.end());
+  for (const string& worker : workers) {
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(worker, &parsed) || !parsed.has_job) {
+      continue;
+    }
+    parsed.job = StandbyJobName(parsed.job);
+    const string standby = DeviceNameUtils::ParsedNameToString(parsed);
+    if (all_workers.contains(standby)) {
+      VLOG(1) << "Task " << standby << " is the standby of " << worker;
+      standby_tasks_[worker] = standby;
+    }
+  }
+}
+
+/*static*/ string StandbyWorkerCache::StandbyJobName(const string& job_name) {
+  return strings::StrCat(job_name, "_standby");
+}
+
+Status StandbyWorkerCache::FailOver(const string& task) {
+  auto it = standby_tasks_.find(task);
+  if (it == standby_tasks_.end()) {
+    return errors::NotFound("Task ", task, " has no standby task");
+  }
+  LOG(WARNING) << "Failing over from task " << task << " to " << it->second;
+  mutex_lock l(mu_);
+  failed_tasks_.insert(task);
+  return OkStatus();
+}
+
+string StandbyWorkerCache::ServingTask(const string& task) const {
+  tf_shared_lock l(mu_);
+  if (failed_tasks_.contains(task)) return standby_tasks_.at(task);
+  return task;
+}
+
+WorkerInterface* StandbyWorkerCache::GetOrCreateWorker(const string& target) {
+  const string task = ServingTask(target);
+  WorkerInterface* worker = wrapped_->GetOrCreateWorker(task);
+  if (worker != nullptr) {
+    mutex_lock l(mu_);
+    auto& entry = worker_tasks_[worker];
+    entry.first = task;
+    ++entry.second;
+  }
+  return worker;
+}
+
+void StandbyWorkerCache::ReleaseWorker(const string& target,
+                                       WorkerInterface* worker) {
+  string task = target;
+  {
+    mutex_lock l(mu_);
+    auto it = worker_tasks_.find(worker);
+    if (it != worker_tasks_.end()) {
+      task = it->second.first;
+      if (--it->second.second == 0) worker_tasks_.erase(it);
+    }
+  }
+  wrapped_->ReleaseWorker(task, worker);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STANDBY_WORKER_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STANDBY_WORKER_CACHE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/distributed_runtime/worker_cache_wrapper.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A worker cache that routes the requests for a task to its hot standby task
+// once the task has failed over, so that the other tasks of a session keep
+// running instead of aborting it.
+//
+// The standby of "/job:<job>/replica:<r>/task:<t>" is the task of the same
+// replica and index in the job "<job>_standby", if the cluster has it. Keeping
+// the state of a standby up to date, e.g. by replicating the variables of a
+// parameter server to it, is up to the job.
+class StandbyWorkerCache : public WorkerCacheWrapper {
+ public:
+  // `wrapped` must outlive this cache.
+  explicit StandbyWorkerCache(WorkerCacheInterface* wrapped);
+
+  // Returns the name of the standby job of `job_name`.
+  static string StandbyJobName(const string& job_name);
+
+  // Routes the requests for `task` to its standby task from now on. Returns
+  // NotFound if `task` has no standby task.
+  Status FailOver(const string& task);
+
+  // Returns the task that serves the requests for `task`.
+  string ServingTask(const string& task) const;
+
+  WorkerInterface* GetOrCreateWorker(const string& target) override;
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override;
+
+ private:
+  WorkerCacheInterface* const wrapped_;  // Not owned.
+  // The standby task of each task that has one.
+  absl::flat_hash_map<string, string> standby_tasks_;
+
+  mutable mutex mu_;
+  absl::flat_hash_set<string> failed_tasks_ TF_GUARDED_BY(mu_);
+  // The task each worker was created for, and the number of times it was
+  // returned but not released yet, so that a failover between the creation
+  // and the release of a worker releases it with the right task.
+  absl::flat_hash_map<WorkerInterface*, std::pair<string, int>> worker_tasks_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STANDBY_WORKER_CACHE_H_
@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/standby_worker_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kPs0[] = "/job:ps/replica:0/task:0";
+constexpr char kPs1[] = "/job:ps/replica:0/task:1";
+constexpr char kStandby0[] = "/job:ps_standby/replica:0/task:0";
+
+// Records the tasks with which workers are released.
+class ReleaseRecordingWorkerCache : public TestWorkerCache {
+ public:
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {
+    released.emplace_back(target, worker);
+  }
+
+  std::vector<std::pair<string, WorkerInterface*>> released;
+};
+
+class StandbyWorkerCacheTest : public ::testing::Test {
+ protected:
+  StandbyWorkerCacheTest() {
+    wrapped_.AddWorker(kPs0, &ps0_);
+    wrapped_.AddWorker(kPs1, &ps1_);
+    wrapped_.AddWorker(kStandby0, &standby0_);
+  }
+
+  ReleaseRecordingWorkerCache wrapped_;
+  TestWorkerInterface ps0_;
+  TestWorkerInterface ps1_;
+  TestWorkerInterface standby0_;
+};
+
+TEST_F(StandbyWorkerCacheTest, RoutesToStandbyAfterFailOver) {
+  StandbyWorkerCache cache(&wrapped_);
+  EXPECT_EQ(&ps0_, cache.GetOrCreateWorker(kPs0));
+  EXPECT_EQ(kPs0, cache.ServingTask(kPs0));
+
+  TF_ASSERT_OK(cache.FailOver(kPs0));
+  EXPECT_EQ(kStandby0, cache.ServingTask(kPs0));
+  EXPECT_EQ(&standby0_, cache.GetOrCreateWorker(kPs0));
+  // The other tasks are not affected.
+  EXPECT_EQ(&ps1_, cache.GetOrCreateWorker(kPs1));
+}
+
+TEST_F(StandbyWorkerCacheTest, FailOverRequiresStandby) {
+  StandbyWorkerCache cache(&wrapped_);
+  EXPECT_TRUE(errors::IsNotFound(cache.FailOver(kPs1)));
+  EXPECT_EQ(kPs1, cache.ServingTask(kPs1));
+}
+
+TEST_F(StandbyWorkerCacheTest, ReleasesWorkersWithTheirTask) {
+  StandbyWorkerCache cache(&wrapped_);
+  WorkerInterface* before = cache.GetOrCreateWorker(kPs0);
+  TF_ASSERT_OK(cache.FailOver(kPs0));
+  WorkerInterface* after = cache.GetOrCreateWorker(kPs0);
+  cache.ReleaseWorker(kPs0, before);
+  cache.ReleaseWorker(kPs0, after);
+  ASSERT_EQ(2, wrapped_.released.size());
+  EXPECT_EQ(std::make_pair(string(kPs0), before), wrapped_.released[0]);
+  EXPECT_EQ(std::make_pair(string(kStandby0), after), wrapped_.released[1]);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,11 +18,105 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
+bool CompressRecvTensor(const Tensor& val,
+                        const RecvTensorCompressionOptions& options,
+                        RecvTensorResponse* response) {
+  if (val.TotalBytes() < options.min_bytes) {
+    return false;
+  }
+  if (val.dtype() == DT_FLOAT &&
+      (options.float_dtype == DT_HALF || options.float_dtype == DT_BFLOAT16)) {
+    Tensor downcast(options.float_dtype, val.shape());
+    auto src = val.flat<float>();
+    if (options.float_dtype == DT_BFLOAT16) {
+      RoundFloatToBFloat16(src.data(), downcast.flat<bfloat16>().data(),
+                           src.size());
+    } else {
+      auto dst = downcast.flat<Eigen::half>();
+      for (int64_t i = 0; i < src.size(); ++i) {
+        dst(i) = static_cast<Eigen::half>(src(i));
+      }
+    }
+    downcast.AsProtoTensorContent(response->mutable_tensor());
+    response->set_compression(RECV_TENSOR_COMPRESSION_DOWNCAST);
+    response->set_uncompressed_dtype(DT_FLOAT);
+    return true;
+  }
+  if (options.snappy && DataTypeIsInteger(val.dtype())) {
+    StringPiece data = val.tensor_data();
+    string compressed;
+    if (!port::Snappy_Compress(data.data(), data.size(), &compressed) ||
+        compressed.size() >= data.size()) {
+      return false;
+    }
+    TensorProto* proto = response->mutable_tensor();
+    proto->set_dtype(val.dtype());
+    val.shape().AsProto(proto->mutable_tensor_shape());
+    proto->set_tensor_content(std::move(compressed));
+    response->set_compression(RECV_TENSOR_COMPRESSION_SNAPPY);
+    return true;
+  }
+  return false;
+}
+
+Status DecompressRecvTensor(RecvTensorResponse* response) {
+  switch (response->compression()) {
+    case RECV_TENSOR_COMPRESSION_NONE:
+      return OkStatus();
+    case RECV_TENSOR_COMPRESSION_DOWNCAST: {
+      Tensor downcast;
+      if (response->uncompressed_dtype() != DT_FLOAT ||
+          !downcast.FromProto(response->tensor())) {
+        return errors::InvalidArgument("Cannot parse downcast tensor");
+      }
+      Tensor val(DT_FLOAT, downcast.shape());
+      auto dst = val.flat<float>();
+      if (downcast.dtype() == DT_BFLOAT16) {
+        BFloat16ToFloat(downcast.flat<bfloat16>().data(), dst.data(),
+                        dst.size());
+      } else if (downcast.dtype() == DT_HALF) {
+        auto src = downcast.flat<Eigen::half>();
+        for (int64_t i = 0; i < dst.size(); ++i) {
+          dst(i) = static_cast<float>(src(i));
+        }
+      } else {
+        return errors::InvalidArgument("Cannot upcast a tensor of type ",
+                                       DataTypeString(downcast.dtype()));
+      }
+      val.AsProtoTensorContent(response->mutable_tensor());
+      break;
+    }
+    case RECV_TENSOR_COMPRESSION_SNAPPY: {
+      const string& content = response->tensor().tensor_content();
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                              &length)) {
+        return errors::InvalidArgument("Cannot parse compressed tensor");
+      }
+      string uncompressed(length, '\0');
+      if (!port::Snappy_Uncompress(content.data(), content.size(),
+                                   &uncompressed[0])) {
+        return errors::InvalidArgument("Cannot parse compressed tensor");
+      }
+      response->mutable_tensor()->set_tensor_content(std::move(uncompressed));
+      break;
+    }
+    default:
+      return errors::InvalidArgument("Unknown tensor compression ",
+                                     response->compression());
+  }
+  response->clear_compression();
+  response->clear_uncompressed_dtype();
+  return OkStatus();
+}
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -51,8 +145,11 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
-  Status s;
   meta_.Swap(response);
+  Status s = DecompressRecvTensor(&meta_);
+  if (!s.ok()) {
+    return s;
+  }
   if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
@@ -87,6 +184,7 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    TF_RETURN_IF_ERROR(DecompressRecvTensor(&meta_));
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -276,7 +374,10 @@ bool TensorResponse::ParseFast(Source* source) {
 }
 
 bool TensorResponse::ParseSlow(Source* source) {
-  if (!meta_.ParseFromZeroCopyStream(source->contents())) {
+  // The compressed tensors are only parsed here, since ParseFast() does not
+  // know the compression fields.
+  if (!meta_.ParseFromZeroCopyStream(source->contents()) ||
+      !DecompressRecvTensor(&meta_).ok()) {
     return false;
   }
 
@@ -28,6 +28,26 @@ namespace tensorflow {
 class DeviceBase;
 class TensorProto;
 
+// How a sender compresses the tensors that it returns for RecvTensor.
+struct RecvTensorCompressionOptions {
+  // DT_HALF or DT_BFLOAT16 to downcast DT_FLOAT tensors to, or DT_INVALID.
+  DataType float_dtype = DT_INVALID;
+  // Whether to compress the contents of integer tensors with Snappy.
+  bool snappy = false;
+  // Smaller tensors are not compressed.
+  int64_t min_bytes = 64 << 10;
+};
+
+// Sets `response->tensor()` to `val` compressed as per `options` and records
+// the compression in `response`. Returns false, leaving `response` unchanged,
+// if `val` is not worth compressing.
+bool CompressRecvTensor(const Tensor& val,
+                        const RecvTensorCompressionOptions& options,
+                        RecvTensorResponse* response);
+
+// Undoes the compression of `response->tensor()`, if any.
+Status DecompressRecvTensor(RecvTensorResponse* response);
+
 // TensorResponse can be used as the destination of an RPC that returns
 // a RecvTensorResponse.  It efficiently decodes the incoming data
 // into Tensor contents as well as associated metadata.
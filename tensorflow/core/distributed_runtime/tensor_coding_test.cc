@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +157,49 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, Compressed) {
+  // Small integers are exact in all of the float types.
+  Tensor floats(DT_FLOAT, TensorShape({4, 64}));
+  Tensor ints(DT_INT64, TensorShape({4, 64}));
+  for (int i = 0; i < floats.NumElements(); ++i) {
+    floats.flat<float>()(i) = i % 16;
+    ints.flat<int64_t>()(i) = i % 16;
+  }
+  RecvTensorCompressionOptions options;
+  options.snappy = true;
+  options.min_bytes = 0;
+  DummyDevice cpu_device(Env::Default());
+  for (DataType float_dtype : {DT_HALF, DT_BFLOAT16}) {
+    options.float_dtype = float_dtype;
+    for (const Tensor* src : {&floats, &ints}) {
+      RecvTensorResponse proto;
+      proto.set_send_start_micros(123456);
+      ASSERT_TRUE(CompressRecvTensor(*src, options, &proto));
+      EXPECT_NE(RECV_TENSOR_COMPRESSION_NONE, proto.compression());
+      EXPECT_LT(proto.tensor().tensor_content().size(), src->TotalBytes());
+      string encoded;
+      proto.AppendToString(&encoded);
+
+      StringSource source(&encoded, 1024);
+      TensorResponse response;
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      EXPECT_EQ(RECV_TENSOR_COMPRESSION_NONE,
+                response.metadata().compression());
+      EXPECT_EQ(123456, response.metadata().send_start_micros());
+      test::ExpectEqual(*src, response.tensor());
+    }
+  }
+
+  // Small tensors and the other dtypes are not compressed.
+  RecvTensorResponse proto;
+  EXPECT_FALSE(CompressRecvTensor(test::AsTensor<double>({1.0, 2.0}), options,
+                                  &proto));
+  options.min_bytes = floats.TotalBytes() + 1;
+  EXPECT_FALSE(CompressRecvTensor(floats, options, &proto));
+  EXPECT_FALSE(proto.has_tensor());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -409,6 +409,11 @@ class SplitProvider {
   // Cancels the split provider. After cancelling, all other existing and future
   // calls should return quickly without blocking.
   virtual void Cancel() {}
+  // Returns a hint about where the data of `split` lives, such as the region
+  // of a GCS bucket or the host of an HDFS datanode. The tf.data service
+  // dispatcher prefers to assign splits to workers with a matching locality.
+  // Returns an empty string if the location is unknown.
+  virtual std::string GetLocalityHint(const Tensor& split) const { return ""; }
 };
 
 // Returns the runner threadpool size from an OpKernelContext.
@@ -1054,6 +1059,13 @@ class IteratorBase : public Checkpointable {
     return 0;
   }
 
+  // Returns the number of bytes buffered by each node of the iterator which
+  // counts towards `TotalBufferedBytes()`, keyed by the long name of the node.
+  model::Node::NodeValues BufferedBytesPerNode() const {
+    if (node_) return node_->BufferedBytesPerNode();
+    return {};
+  }
+
  protected:
   // Returns a node that models this iterator.
   virtual std::shared_ptr<model::Node> CreateNode(
@@ -313,6 +313,12 @@ class CallFrameInterface {
   virtual bool CanConsumeArg(int index) const { return false; }
 
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns the allocator of the caller-owned memory in which the value of
+  // `index` should be allocated, or nullptr to use the allocator of the
+  // device. Only the kernels which allocate their output with
+  // `allocate_output` use it.
+  virtual Allocator* GetRetvalAllocator(int index) const { return nullptr; }
 };
 
 // Represents a function call frame. I.e., the data structure used to
@@ -52,6 +52,44 @@ auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* executor_kernel_time_nsecs = tsl::monitoring::Counter<2>::New(
+    "/tensorflow/core/executor/kernel_time_nsecs",
+    "The time spent in synchronous kernels by the executor in nanoseconds, "
+    "estimated from a sample of the kernels.",
+    "session", "op");
+
+auto* executor_kernels = tsl::monitoring::Counter<3>::New(
+    "/tensorflow/core/executor/kernels",
+    "The number of kernels run by the executor, either inline on the thread "
+    "which made them ready or scheduled on the inter-op thread pool, "
+    "estimated from a sample of the kernels.",
+    "session", "op", "dispatch");
+
+auto* executor_async_kernels = tsl::monitoring::Counter<2>::New(
+    "/tensorflow/core/executor/async_kernels",
+    "The number of asynchronous kernels run by the executor, estimated from a "
+    "sample of the kernels.",
+    "session", "op");
+
+auto* executor_deferred_ops = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/executor/deferred_ops",
+    "The number of ops deferred by kernels past their completion.", "session");
+
+auto* executor_ready_nodes = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/ready_nodes",
+     "The number of nodes which become ready at once in the executor.",
+     "session"},
+    // Power of 2 with bucket count 16 (> 32k)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 16)});
+
+auto* executor_thread_pool_wait_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/thread_pool_wait_usecs",
+     "The time that the tasks of the executor wait in the inter-op thread "
+     "pool in microseconds.",
+     "session"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -93,6 +131,12 @@ auto* tf_data_bytes_fetched_counter = tsl::monitoring::Counter<0>::New(
     "/tensorflow/data/bytes_fetched",
     "The number of bytes fetched from tf.data Dataset iterator.");
 
+auto* tf_data_bucketing_tokens_counter = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/data/bucketing/tokens",
+    "The number of values in batches produced by token budget bucketing, "
+    "split into {'real', 'padding'}.",
+    "type");
+
 auto* tf_data_elements_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
@@ -184,6 +228,14 @@ auto* tf_data_iterator_gap_msec_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count of 20 (from 1 msec to about 2.2 secs).
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 20)});
 
+auto* tf_data_shuffle_buffer_fill_time_msec_histogram =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/data/shuffle_buffer_fill_time",
+         "The time (in milliseconds) spent filling a tf.data shuffle buffer "
+         "before the first element of an epoch could be produced."},
+        // Power of 2 with bucket count of 20 (from 1 msec to about 8.7 mins).
+        {tsl::monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* tf_data_optimization_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
@@ -214,6 +266,18 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_spilled_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_spilled_size_bytes",
+        "tf.data service cross-trainer cache disk usage in bytes.");
+
+auto* tf_data_service_cross_trainer_cache_trainer_lag =
+    tsl::monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_trainer_lag",
+        "Number of elements a trainer lags behind the newest element in the "
+        "tf.data service cross-trainer cache.",
+        "trainer_id");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
@@ -427,6 +491,24 @@ tsl::monitoring::Counter<2>* GetGraphOptimizationCounter() {
   return graph_optimization_counter;
 }
 
+auto* grappler_pass_graph_delta = tsl::monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/grappler_pass_graph_delta",
+    "The change in the size of the graph made by the last run of each "
+    "Grappler pass.",
+    "name", "quantity");
+
+void UpdateGrapplerPassGraphDelta(const string& optimizer_name,
+                                  int64_t num_nodes_delta,
+                                  int64_t num_edges_delta,
+                                  int64_t memory_bytes_delta) {
+  grappler_pass_graph_delta->GetCell(optimizer_name, "nodes")
+      ->Set(num_nodes_delta);
+  grappler_pass_graph_delta->GetCell(optimizer_name, "edges")
+      ->Set(num_edges_delta);
+  grappler_pass_graph_delta->GetCell(optimizer_name, "memory_bytes")
+      ->Set(memory_bytes_delta);
+}
+
 std::string GraphOptimizationSourceMapping(GraphOptimizationSource source) {
   switch (source) {
     case GraphOptimizationSource::kJit:
@@ -482,6 +564,14 @@ void RecordTFDataBytesFetched(int64_t num_bytes) {
   tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
 }
 
+void RecordTFDataBucketingTokens(int64_t num_real_tokens,
+                                 int64_t num_padding_tokens) {
+  tf_data_bucketing_tokens_counter->GetCell("real")->IncrementBy(
+      num_real_tokens);
+  tf_data_bucketing_tokens_counter->GetCell("padding")->IncrementBy(
+      num_padding_tokens);
+}
+
 void RecordTFDataExperiment(const string& name) {
   tf_data_experiment_counter->GetCell(name)->IncrementBy(1);
 }
@@ -556,6 +646,12 @@ void RecordTFDataIteratorGap(uint64 duration_us) {
   tf_data_iterator_gap_msec_histogram_cell->Add(duration_us * 0.001);
 }
 
+void RecordTFDataShuffleBufferFillTime(uint64 duration_us) {
+  static auto* tf_data_shuffle_buffer_fill_time_cell =
+      tf_data_shuffle_buffer_fill_time_msec_histogram->GetCell();
+  tf_data_shuffle_buffer_fill_time_cell->Add(duration_us * 0.001);
+}
+
 void RecordTFDataOptimization(const string& name, int64_t num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
@@ -627,6 +723,17 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheSpilledSizeBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_spilled_size_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
+void RecordTFDataServiceCrossTrainerCacheTrainerLag(
+    const std::string& trainer_id, size_t num_elements) {
+  tf_data_service_cross_trainer_cache_trainer_lag->GetCell(trainer_id)->Set(
+      static_cast<int64_t>(num_elements));
+}
+
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
@@ -723,6 +830,32 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+ExecutorKernelCounters GetExecutorKernelCounters(const string& session,
+                                                 const string& op) {
+  ExecutorKernelCounters counters;
+  counters.kernel_time_nsecs = executor_kernel_time_nsecs->GetCell(session, op);
+  counters.inline_kernels = executor_kernels->GetCell(session, op, "inline");
+  counters.scheduled_kernels =
+      executor_kernels->GetCell(session, op, "scheduled");
+  counters.async_kernels = executor_async_kernels->GetCell(session, op);
+  return counters;
+}
+
+tsl::monitoring::SamplerCell* GetExecutorReadyNodesSampler(
+    const string& session) {
+  return executor_ready_nodes->GetCell(session);
+}
+
+tsl::monitoring::SamplerCell* GetExecutorThreadPoolWaitSampler(
+    const string& session) {
+  return executor_thread_pool_wait_usecs->GetCell(session);
+}
+
+tsl::monitoring::CounterCell* GetExecutorDeferredOpsCounter(
+    const string& session) {
+  return executor_deferred_ops->GetCell(session);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
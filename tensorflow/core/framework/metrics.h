@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
@@ -80,6 +81,11 @@ monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64_t num_bytes);
 
+// Records the number of real and padding values in a batch produced by
+// token budget bucketing.
+void RecordTFDataBucketingTokens(int64_t num_real_tokens,
+                                 int64_t num_padding_tokens);
+
 // Records the number of times a tf.data experiment was applied.
 void RecordTFDataExperiment(const string& name);
 
@@ -124,6 +130,10 @@ void RecordTFDataServiceRuntimeCompressionDecision(bool compression_decision);
 // related action.
 void RecordTFDataServiceCompressionAction(const string& action);
 
+// Records the time (in microseconds) spent filling a shuffle buffer before the
+// first element of an epoch could be produced.
+void RecordTFDataShuffleBufferFillTime(uint64 duration_us);
+
 // Records the time (in microseconds) during which `IteratorResource` was busy
 // processing at least one `GetNext()` request.
 void RecordTFDataIteratorBusy(uint64 duration_us);
@@ -181,6 +191,14 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records tf.data service cross-trainer cache disk usage in bytes.
+void RecordTFDataServiceCrossTrainerCacheSpilledSizeBytes(size_t bytes);
+
+// Records how many elements the trainer `trainer_id` lags behind the newest
+// element in the tf.data service cross-trainer cache.
+void RecordTFDataServiceCrossTrainerCacheTrainerLag(
+    const std::string& trainer_id, size_t num_elements);
+
 // Records tf.data distributed snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
@@ -240,6 +258,38 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// The counters of the kernels of one op type which the executor runs in the
+// sessions of one name. They are always collected, unlike step stats, from a
+// sample of the kernels, each of which counts for the kernels it stands for.
+struct ExecutorKernelCounters {
+  // The time spent in the synchronous kernels in nanoseconds.
+  monitoring::CounterCell* kernel_time_nsecs = nullptr;
+  // The number of kernels run on the thread which made them ready.
+  monitoring::CounterCell* inline_kernels = nullptr;
+  // The number of kernels scheduled on the inter-op thread pool.
+  monitoring::CounterCell* scheduled_kernels = nullptr;
+  // The number of asynchronous kernels.
+  monitoring::CounterCell* async_kernels = nullptr;
+};
+
+// Returns the counters of the kernels of type `op` which the executor runs in
+// the sessions named `session`, which is empty for sessions without metadata.
+ExecutorKernelCounters GetExecutorKernelCounters(const string& session,
+                                                 const string& op);
+
+// Returns a sampler of the number of nodes which become ready at once in the
+// executor in the sessions named `session`.
+monitoring::SamplerCell* GetExecutorReadyNodesSampler(const string& session);
+
+// Returns a sampler of the time in microseconds that the tasks of the executor
+// wait in the inter-op thread pool in the sessions named `session`.
+monitoring::SamplerCell* GetExecutorThreadPoolWaitSampler(
+    const string& session);
+
+// Returns a counter of the ops which kernels defer past their completion,
+// e.g. to wait for a device, in the sessions named `session`.
+monitoring::CounterCell* GetExecutorDeferredOpsCounter(const string& session);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -457,6 +507,13 @@ class ScopedCounter final {
 // passes.
 monitoring::Counter<2>* GetGraphOptimizationCounter();
 
+// Records the change in the number of nodes and edges, and in the estimated
+// memory, of the graph optimized by the last run of a Grappler pass.
+void UpdateGrapplerPassGraphDelta(const string& optimizer_name,
+                                  int64_t num_nodes_delta,
+                                  int64_t num_edges_delta,
+                                  int64_t memory_bytes_delta);
+
 // Updates metrics for time to distribute variables to all TPU hosts.
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 
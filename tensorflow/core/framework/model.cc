@@ -693,6 +693,17 @@ class AsyncInterleaveMany : public Node {
     if (parameter) {
       parallelism = std::min(parallelism, (*parameter)->value);
     }
+    // If the cycle length is tunable, it bounds the number of inputs that can
+    // be processed in parallel.
+    auto* cycle_length = gtl::FindOrNull(parameters_, kCycleLength);
+    const bool cycle_length_tunable = cycle_length &&
+                                      (*cycle_length)->state &&
+                                      (*cycle_length)->state->tunable;
+    bool cycle_length_bound = false;
+    if (cycle_length_tunable && (*cycle_length)->value < parallelism) {
+      parallelism = (*cycle_length)->value;
+      cycle_length_bound = true;
+    }
     double output_time_for_inputs =
         OutputTimeForInputs(*output_times) -
         (*output_times)[inputs_.front()->long_name()];
@@ -732,6 +743,13 @@ class AsyncInterleaveMany : public Node {
         (*gradients)[std::make_pair(long_name(), (*parameter)->name)] =
             buffer_size_der - producer_time_der * producer_time / parallelism;
       }
+      // Add derivative w.r.t. own cycle length parameter.
+      if (cycle_length_tunable) {
+        (*gradients)[std::make_pair(long_name(), (*cycle_length)->name)] =
+            cycle_length_bound
+                ? -producer_time_der * producer_time / parallelism
+                : 0.0L;
+      }
     } else {
       wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
                                   /*producer_time_derivative=*/nullptr,
@@ -1716,6 +1734,17 @@ double Node::TotalBufferedBytes() const {
   return total_bytes[long_name()];
 }
 
+Node::NodeValues Node::BufferedBytesPerNode() const {
+  Node::NodeValues buffered_bytes;
+  tf_shared_lock l(mu_);
+  for (const auto& node : CollectNodesLocked(TraversalOrder::BFS, IsAnyNode)) {
+    tf_shared_lock l(node->mu_);
+    node->BufferedBytesPerNodeHelper(&buffered_bytes);
+  }
+  BufferedBytesPerNodeHelper(&buffered_bytes);
+  return buffered_bytes;
+}
+
 double Node::TotalMaximumBufferedBytes() const {
   Node::NodeValues total_bytes;
   tf_shared_lock l(mu_);
@@ -2069,6 +2098,15 @@ void Node::TotalBufferedBytesHelper(Node::NodeValues* total_bytes) const
   total_bytes->insert(std::make_pair(long_name(), result));
 }
 
+void Node::BufferedBytesPerNodeHelper(Node::NodeValues* buffered_bytes) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (!autotune_ || (!parameters_.contains(kBufferSize) &&
+                     !parameters_.contains(kParallelism))) {
+    return;
+  }
+  buffered_bytes->insert(std::make_pair(long_name(), buffered_bytes_));
+}
+
 void Node::TotalMaximumBufferedBytesHelper(Node::NodeValues* total_bytes) const
     TF_SHARED_LOCKS_REQUIRED(mu_) {
   if (!autotune_) {
@@ -2359,6 +2397,11 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  if (EnforceRamBudget(snapshot, optimization_params.ram_budget())) {
+    ram_budget_manager.RequestModelAllocation(
+        TotalMaximumBufferedBytes(snapshot));
+    ResetBufferWatermarks();
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -3043,6 +3086,41 @@ bool Model::UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget) {
   return upsized;
 }
 
+bool Model::EnforceRamBudget(std::shared_ptr<Node> snapshot,
+                             int64_t ram_budget) {
+  const double max_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  if (max_buffered_bytes <= static_cast<double>(ram_budget)) {
+    return false;
+  }
+  ModelParameters buffer_size_parameters;
+  for (auto& pair : CollectTunableParameters(snapshot)) {
+    if (pair.second->name == kBufferSize) {
+      buffer_size_parameters.push_back(pair);
+    }
+  }
+  // Shrink all buffers by the same factor so that full buffers fit in the
+  // budget, without going below the minimum buffer size.
+  const double scaling_factor =
+      std::max(0.0, static_cast<double>(ram_budget)) / max_buffered_bytes;
+  bool downsized = false;
+  for (auto& [node_name, parameter] : buffer_size_parameters) {
+    const double new_value =
+        std::max(parameter->min, std::floor(parameter->value * scaling_factor));
+    if (new_value >= parameter->value) {
+      continue;
+    }
+    VLOG(2) << "Downsize buffer " << node_name << "::" << parameter->name
+            << " from " << parameter->value << " to " << new_value
+            << " to respect the ram budget of " << ram_budget << " bytes";
+    parameter->value = new_value;
+    downsized = true;
+  }
+  if (downsized) {
+    UpdateStateValues(&buffer_size_parameters);
+  }
+  return downsized;
+}
+
 void Model::ResetBufferWatermarks() {
   Node::NodeVector nodes =
       output()->CollectNodes(TraversalOrder::BFS, IsAnyNode);
@@ -583,6 +583,10 @@ class Node {
   // which autotuning is enabled.
   double TotalBufferedBytes() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the number of bytes buffered by each node in the subtree which
+  // counts towards `TotalBufferedBytes()`, keyed by the long name of the node.
+  NodeValues BufferedBytesPerNode() const TF_LOCKS_EXCLUDED(mu_);
+
   // Collects the total buffer limit of all nodes in the subtree for which
   // autotuning is enabled. This number represents the amount of memory that
   // would be used by the subtree nodes if all of their buffers were full.
@@ -783,6 +787,11 @@ class Node {
   void TotalBufferedBytesHelper(NodeValues* total_bytes) const
       TF_SHARED_LOCKS_REQUIRED(mu_);
 
+  // Records the number of bytes buffered by this node in `buffered_bytes` if
+  // the node counts towards `TotalBufferedBytes()`.
+  void BufferedBytesPerNodeHelper(NodeValues* buffered_bytes) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+
   // Compute total maximum buffered bytes for the node and store in the total
   // bytes map.
   void TotalMaximumBufferedBytesHelper(NodeValues* total_bytes) const
@@ -1049,6 +1058,11 @@ class Model {
   // respecting the ram budget. Returns true if any buffer is upsized.
   bool UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget);
 
+  // Shrinks the buffer_size parameters of all nodes rooted at `snapshot`
+  // proportionally if the buffers could use more than `ram_budget` bytes when
+  // full. Returns true if any buffer is downsized.
+  bool EnforceRamBudget(std::shared_ptr<Node> snapshot, int64_t ram_budget);
+
   // Reset buffer watermarks of all asynchronous nodes to their buffered
   // elements.
   void ResetBufferWatermarks();
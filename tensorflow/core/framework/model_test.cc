@@ -40,6 +40,8 @@ namespace {
 using ::tensorflow::monitoring::testing::CellReader;
 using ::testing::AllOf;
 using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 std::function<int64_t()> CpuBudgetFunc(int64_t budget) {
   return [budget]() { return budget; };
@@ -661,6 +663,36 @@ TEST(BufferedBytesTest, Node) {
   EXPECT_EQ(node->inputs().size(), 0);
 }
 
+TEST(BufferedBytesPerNodeTest, Node) {
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {1, "Prefetch", nullptr}, 1,
+      {model::MakeParameter(
+          kBufferSize,
+          std::make_shared<SharedState>(/*value=*/3, nullptr, nullptr),
+          /*min=*/1, /*max=*/10)});
+  std::shared_ptr<Node> input = model::MakeAsyncKnownRatioNode(
+      {2, "ParallelMap", node}, 1,
+      {model::MakeParameter(
+          kParallelism,
+          std::make_shared<SharedState>(/*value=*/2, nullptr, nullptr),
+          /*min=*/1, /*max=*/10)});
+  std::shared_ptr<Node> source =
+      model::MakeSourceNode({3, "TensorSlice", input});
+  node->add_input(input);
+  input->add_input(source);
+  node->record_buffer_event(30, 1);
+  input->record_buffer_event(12, 2);
+  source->record_buffer_event(5, 1);
+
+  // The source node does not count towards the buffered bytes.
+  EXPECT_THAT(node->BufferedBytesPerNode(),
+              UnorderedElementsAre(Pair(node->long_name(), 30),
+                                   Pair(input->long_name(), 12)));
+  EXPECT_EQ(node->TotalBufferedBytes(), 42);
+  EXPECT_THAT(input->BufferedBytesPerNode(),
+              UnorderedElementsAre(Pair(input->long_name(), 12)));
+}
+
 // Returns a weighted sum of a prior and the actual processing time.
 double weighted_processing_time(int64_t num_elements, double processing_time,
                                 double prior) {
@@ -2556,6 +2588,75 @@ TEST_F(BufferSizeTest, OptimizeBuffers_TightMemory) {
   EXPECT_EQ(4, node_4->buffered_elements_high());
 }
 
+TEST_F(BufferSizeTest, EnforceRamBudget) {
+  ReadModel(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Prefetch"
+        autotune: true
+        bytes_produced: 10000
+        num_elements: 100
+        processing_time: 2000
+        node_class: ASYNC_KNOWN_RATIO
+        inputs: 2
+        ratio: 1
+        parameters: {
+          name: "buffer_size"
+          value: 8
+          state_value: 8
+          min: 1
+          max: 10
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Prefetch"
+        autotune: true
+        bytes_produced: 10000
+        num_elements: 100
+        processing_time: 2000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        parameters: {
+          name: "buffer_size"
+          value: 4
+          state_value: 4
+          min: 1
+          max: 10
+          tunable: true
+        }
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  // Full buffers would use 1200 bytes. Expect both buffers to be halved.
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, CpuBudgetFunc(1000),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/600,
+                   /*model_input_time=*/0, ram_budget_manager,
+                   &cancellation_manager);
+  EXPECT_DOUBLE_EQ(4.0, GetNode(1)->parameter_value(kBufferSize));
+  EXPECT_DOUBLE_EQ(2.0, GetNode(2)->parameter_value(kBufferSize));
+
+  // The buffers are not shrunk below their minimum size.
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, CpuBudgetFunc(1000),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/10,
+                   /*model_input_time=*/0, ram_budget_manager,
+                   &cancellation_manager);
+  EXPECT_DOUBLE_EQ(1.0, GetNode(1)->parameter_value(kBufferSize));
+  EXPECT_DOUBLE_EQ(1.0, GetNode(2)->parameter_value(kBufferSize));
+}
+
 TEST_F(ModelTimingTest, OptimizeStageBased_OneStage) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -619,9 +619,20 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, the allocations which the device would serve from
+    // `step_arena_base_allocator` are served by this step-scoped allocator
+    // instead.
+    Allocator* step_arena_allocator = nullptr;
+    Allocator* step_arena_base_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, array indexed by output number for this node of the
+    // allocators to use for the outputs allocated by `allocate_output`
+    // instead of the device allocators, where not null.
+    Allocator* const* output_allocator_array = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -1274,6 +1285,9 @@ class OpKernelContext {
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
 
   // Helpers for `set_output()`.
 
@@ -168,6 +168,60 @@ bool MemoryLoggingEnabled() {
   return memory_logging_enabled;
 }
 
+// A buffer of a few bytes of a simple type in host memory, stored inline with
+// the buffer itself, so that the tensors of scalars and short vectors such as
+// shapes and indices take one heap allocation instead of two.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static constexpr size_t kMaxBytes = 32;
+
+  // Returns whether the buffer of a tensor of `n` elements of `type` that is
+  // to be allocated by `a` can be inlined: `a` must allocate untracked host
+  // memory, since the inlined bytes are not allocated by `a`.
+  static bool CanInline(Allocator* a, DataType type, int64_t n) {
+    return n > 0 && DataTypeCanUseMemcpy(type) &&
+           n * DataTypeSize(type) <= kMaxBytes &&
+           a->GetMemoryType() == AllocatorMemoryType::kHostPageable &&
+           !a->TracksAllocationSizes() && !a->AllocatesOpaqueHandle() &&
+           !MemoryLoggingEnabled();
+  }
+
+  static InlineBuffer* New(size_t size) {
+    void* ptr =
+        port::AlignedMalloc(sizeof(InlineBuffer), EIGEN_MAX_ALIGN_BYTES);
+    return new (ptr) InlineBuffer(size);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // `core::RefCounted::Unref()` frees the buffer through this override.
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+
+  static void operator delete(void*, void*) {
+    // Some compilers require an overridden class-specific deallocation
+    // function, which will be called if placement `new` throws an exception.
+  }
+
+ private:
+  explicit InlineBuffer(size_t size) : TensorBuffer(bytes_), size_(size) {}
+  ~InlineBuffer() override = default;
+
+  alignas(EIGEN_MAX_ALIGN_BYTES) char bytes_[kMaxBytes];
+  const size_t size_;
+};
+
 // A set of helper functions depending on T.
 template <typename T>
 struct Helper {
@@ -968,7 +1022,9 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  if (InlineBuffer::CanInline(a, type, shape_.num_elements())) {
+    buf_ = InlineBuffer::New(shape_.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
@@ -982,7 +1038,9 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  if (InlineBuffer::CanInline(a, type, shape_.num_elements())) {
+    buf_ = InlineBuffer::New(shape_.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
@@ -1182,6 +1182,31 @@ TEST(Tensor_Float, SimpleWithAllocator) {
   ASSERT_EQ(p.dtype(), DT_FLOAT);
 }
 
+TEST(Tensor_Float, SmallTensorsAreInlined) {
+  auto* a = cpu_allocator();
+  Tensor t(a, DT_FLOAT, TensorShape({2, 4}));
+  EXPECT_TRUE(t.IsAligned());
+  TensorDescription p;
+  t.FillDescription(&p);
+  EXPECT_EQ(p.allocation_description().allocator_name(), "InlineBuffer");
+  EXPECT_EQ(p.allocation_description().requested_bytes(), 32);
+
+  for (int i = 0; i < 8; ++i) {
+    t.flat<float>()(i) = i;
+  }
+  TestCopies<float>(t);
+  Tensor row = t.Slice(1, 2);
+  EXPECT_TRUE(row.SharesBufferWith(t));
+  EXPECT_EQ(row.flat<float>()(0), 4.0f);
+
+  Tensor large(a, DT_FLOAT, TensorShape({2, 5}));
+  large.FillDescription(&p);
+  EXPECT_EQ(p.allocation_description().allocator_name(), a->Name());
+
+  Tensor empty(a, DT_FLOAT, TensorShape({0}));
+  EXPECT_EQ(empty.TotalBytes(), 0);
+}
+
 TEST(Tensor_Int32, SimpleWithHelper) {
   Tensor t1 = test::AsTensor<int32>({0, 1, 2, 3, 4, 5}, {2, 3});
   Tensor t2(t1.dtype(), t1.shape());
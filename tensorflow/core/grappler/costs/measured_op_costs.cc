@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_costs.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns the key of the measurements that PredictTime interpolates between.
+string SignatureKey(const OpInfo& op_info) {
+  string key = absl::StrCat(op_info.op(), ";", op_info.device().type());
+  for (const OpInfo::TensorProperties& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";", input.dtype());
+  }
+  return key;
+}
+
+// Returns the number of elements of the inputs and outputs, or -1 if a shape
+// is not fully known.
+int64_t NumElements(const OpInfo& op_info) {
+  int64_t num_elements = 0;
+  auto add = [&num_elements](const OpInfo::TensorProperties& tensor) {
+    if (tensor.shape().unknown_rank()) return false;
+    int64_t n = 1;
+    for (const auto& dim : tensor.shape().dim()) {
+      if (dim.size() < 0) return false;
+      n *= dim.size();
+    }
+    num_elements += n;
+    return true;
+  };
+  for (const auto& input : op_info.inputs()) {
+    if (!add(input)) return -1;
+  }
+  for (const auto& output : op_info.outputs()) {
+    if (!add(output)) return -1;
+  }
+  return num_elements;
+}
+
+string ShapesKey(const OpInfo& op_info) {
+  string key = SignatureKey(op_info);
+  for (const OpInfo::TensorProperties& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";");
+    for (const auto& dim : input.shape().dim()) {
+      absl::StrAppend(&key, dim.size(), ",");
+    }
+  }
+  return key;
+}
+
+}  // namespace
+
+MeasuredOpCosts::MeasuredOpCosts(const OpPerformanceList& measurements) {
+  // Averages the measurements with the same shapes, and then those with the
+  // same number of elements.
+  absl::flat_hash_map<string, std::pair<double, int>> sums;
+  absl::flat_hash_map<string, const OpInfo*> op_infos;
+  for (const OpPerformance& measurement : measurements.op_performance()) {
+    if (NumElements(measurement.op()) < 0) {
+      VLOG(1) << "Ignoring the measurement of an op with unknown shapes: "
+              << measurement.op().ShortDebugString();
+      continue;
+    }
+    const string key = ShapesKey(measurement.op());
+    auto& sum = sums[key];
+    sum.first += measurement.compute_cost();
+    ++sum.second;
+    op_infos.emplace(key, &measurement.op());
+  }
+  using SumsByElements = absl::flat_hash_map<int64_t, std::pair<double, int>>;
+  absl::flat_hash_map<string, SumsByElements> by_elements;
+  for (const auto& [key, sum] : sums) {
+    const double nanos = sum.first / sum.second;
+    exact_measurements_[key] = nanos;
+    const OpInfo& op_info = *op_infos.at(key);
+    auto& element_sum =
+        by_elements[SignatureKey(op_info)][NumElements(op_info)];
+    element_sum.first += nanos;
+    ++element_sum.second;
+  }
+  for (const auto& [key, sums_by_elements] : by_elements) {
+    std::vector<Measurement>& signature_measurements = measurements_[key];
+    for (const auto& [num_elements, sum] : sums_by_elements) {
+      signature_measurements.push_back({num_elements, sum.first / sum.second});
+    }
+    std::sort(signature_measurements.begin(), signature_measurements.end(),
+              [](const Measurement& a, const Measurement& b) {
+                return a.num_elements < b.num_elements;
+              });
+  }
+}
+
+/*static*/ Status MeasuredOpCosts::Load(
+    const string& path, std::unique_ptr<MeasuredOpCosts>* op_costs) {
+  OpPerformanceList measurements;
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(Env::Default(), path, &measurements));
+  *op_costs = std::make_unique<MeasuredOpCosts>(measurements);
+  return OkStatus();
+}
+
+/*static*/ const MeasuredOpCosts* MeasuredOpCosts::Global() {
+  static const MeasuredOpCosts* global = []() -> const MeasuredOpCosts* {
+    const char* path = std::getenv("TF_GRAPPLER_MEASURED_OP_COSTS");
+    if (path == nullptr || *path == '\0') return nullptr;
+    std::unique_ptr<MeasuredOpCosts> op_costs;
+    Status s = Load(path, &op_costs);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to load the measured op costs from " << path
+                 << ": " << s;
+      return nullptr;
+    }
+    return op_costs.release();
+  }();
+  return global;
+}
+
+std::optional<Costs::NanoSeconds> MeasuredOpCosts::PredictTime(
+    const OpInfo& op_info, bool* exact) const {
+  *exact = false;
+  const int64_t num_elements = NumElements(op_info);
+  if (num_elements < 0) return std::nullopt;
+  auto exact_it = exact_measurements_.find(ShapesKey(op_info));
+  if (exact_it != exact_measurements_.end()) {
+    *exact = true;
+    return Costs::NanoSeconds(exact_it->second);
+  }
+  auto it = measurements_.find(SignatureKey(op_info));
+  if (it == measurements_.end()) return std::nullopt;
+  const std::vector<Measurement>& measurements = it->second;
+
+  auto upper = std::lower_bound(measurements.begin(), measurements.end(),
+                                num_elements,
+                                [](const Measurement& m, int64_t n) {
+                                  return m.num_elements < n;
+                                });
+  // Beyond the measured range, the time is proportional to the number of
+  // elements of the nearest measurement.
+  if (upper == measurements.end() || upper == measurements.begin()) {
+    const Measurement& nearest =
+        upper == measurements.end() ? measurements.back() : *upper;
+    if (nearest.num_elements == 0) return Costs::NanoSeconds(nearest.nanos);
+    return Costs::NanoSeconds(nearest.nanos * num_elements /
+                              nearest.num_elements);
+  }
+  const Measurement& lower = *(upper - 1);
+  const double fraction =
+      static_cast<double>(num_elements - lower.num_elements) /
+      (upper->num_elements - lower.num_elements);
+  return Costs::NanoSeconds(lower.nanos +
+                            fraction * (upper->nanos - lower.nanos));
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,77 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_COSTS_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_COSTS_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Execution times of ops measured on a device, e.g. by microbenchmarks run on
+// the target hardware, which OpLevelCostEstimator uses instead of its roofline
+// model for the ops they cover.
+//
+// Each measurement is an OpPerformance with the op, its input and output
+// properties and its device type, and the measured `compute_cost` in
+// nanoseconds. An op whose inputs have the shapes of a measurement gets its
+// time. Otherwise, the time is interpolated linearly in the number of input
+// and output elements between the measurements of the same op, device type
+// and input dtypes, or extrapolated proportionally beyond them.
+class MeasuredOpCosts {
+ public:
+  explicit MeasuredOpCosts(const OpPerformanceList& measurements);
+
+  // Reads an OpPerformanceList from `path`, in binary or text format.
+  static Status Load(const string& path,
+                     std::unique_ptr<MeasuredOpCosts>* op_costs);
+
+  // Returns the measurements loaded from the file named by the
+  // TF_GRAPPLER_MEASURED_OP_COSTS environment variable, or null if it is not
+  // set or cannot be read.
+  static const MeasuredOpCosts* Global();
+
+  // Returns the time of `op_info`, or nullopt if no measurement applies to it.
+  // Sets `exact` to whether a measurement had the same shapes.
+  std::optional<Costs::NanoSeconds> PredictTime(const OpInfo& op_info,
+                                                bool* exact) const;
+
+ private:
+  struct Measurement {
+    int64_t num_elements;
+    double nanos;
+  };
+
+  // The measurements of each op, device type and input dtypes, sorted by
+  // their number of elements.
+  absl::flat_hash_map<string, std::vector<Measurement>> measurements_;
+  // The measurements by op, device type, input dtypes and shapes.
+  absl::flat_hash_map<string, double> exact_measurements_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_COSTS_H_
@@ -0,0 +1,112 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_costs.h"
+
+#include <memory>
+#include <optional>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpInfo MatMulInfo(int m, int k, int n) {
+  OpInfo op_info;
+  op_info.set_op("MatMul");
+  op_info.mutable_device()->set_type("GPU");
+  auto add = [](OpInfo::TensorProperties* tensor, int rows, int cols) {
+    tensor->set_dtype(DT_FLOAT);
+    tensor->mutable_shape()->add_dim()->set_size(rows);
+    tensor->mutable_shape()->add_dim()->set_size(cols);
+  };
+  add(op_info.add_inputs(), m, k);
+  add(op_info.add_inputs(), k, n);
+  add(op_info.add_outputs(), m, n);
+  return op_info;
+}
+
+void AddMeasurement(const OpInfo& op_info, int64_t nanos,
+                    OpPerformanceList* measurements) {
+  OpPerformance* measurement = measurements->add_op_performance();
+  *measurement->mutable_op() = op_info;
+  measurement->set_compute_cost(nanos);
+}
+
+class MeasuredOpCostsTest : public ::testing::Test {
+ protected:
+  MeasuredOpCostsTest() {
+    OpPerformanceList measurements;
+    // 300 elements.
+    AddMeasurement(MatMulInfo(10, 10, 10), 100, &measurements);
+    AddMeasurement(MatMulInfo(10, 10, 10), 200, &measurements);
+    // 1200 elements.
+    AddMeasurement(MatMulInfo(20, 20, 20), 1000, &measurements);
+    op_costs_ = std::make_unique<MeasuredOpCosts>(measurements);
+  }
+
+  std::unique_ptr<MeasuredOpCosts> op_costs_;
+};
+
+TEST_F(MeasuredOpCostsTest, ExactMatch) {
+  bool exact = false;
+  std::optional<Costs::NanoSeconds> time =
+      op_costs_->PredictTime(MatMulInfo(10, 10, 10), &exact);
+  ASSERT_TRUE(time.has_value());
+  EXPECT_TRUE(exact);
+  EXPECT_EQ(150, time->count());
+}
+
+TEST_F(MeasuredOpCostsTest, Interpolates) {
+  bool exact = true;
+  // 750 elements, i.e. halfway between the measurements.
+  std::optional<Costs::NanoSeconds> time =
+      op_costs_->PredictTime(MatMulInfo(5, 20, 26), &exact);
+  ASSERT_TRUE(time.has_value());
+  EXPECT_FALSE(exact);
+  EXPECT_NEAR(575, time->count(), 1e-6);
+}
+
+TEST_F(MeasuredOpCostsTest, Extrapolates) {
+  bool exact = true;
+  // 4800 elements, i.e. 4 times the largest measurement.
+  std::optional<Costs::NanoSeconds> time =
+      op_costs_->PredictTime(MatMulInfo(40, 40, 40), &exact);
+  ASSERT_TRUE(time.has_value());
+  EXPECT_FALSE(exact);
+  EXPECT_NEAR(4000, time->count(), 1e-6);
+  // 75 elements, i.e. a quarter of the smallest measurement.
+  time = op_costs_->PredictTime(MatMulInfo(5, 5, 5), &exact);
+  ASSERT_TRUE(time.has_value());
+  EXPECT_NEAR(37.5, time->count(), 1e-6);
+}
+
+TEST_F(MeasuredOpCostsTest, IgnoresOtherOpsAndDevices) {
+  bool exact = false;
+  OpInfo op_info = MatMulInfo(10, 10, 10);
+  op_info.mutable_device()->set_type("CPU");
+  EXPECT_FALSE(op_costs_->PredictTime(op_info, &exact).has_value());
+  op_info = MatMulInfo(10, 10, 10);
+  op_info.set_op("BatchMatMul");
+  EXPECT_FALSE(op_costs_->PredictTime(op_info, &exact).has_value());
+  op_info = MatMulInfo(10, 10, 10);
+  op_info.mutable_inputs(0)->mutable_shape()->mutable_dim(0)->set_size(-1);
+  EXPECT_FALSE(op_costs_->PredictTime(op_info, &exact).has_value());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -363,7 +363,8 @@ std::vector<int64_t> MaybeGetMinimumShape(
   return minimal_shape;
 }
 
-OpLevelCostEstimator::OpLevelCostEstimator() {
+OpLevelCostEstimator::OpLevelCostEstimator()
+    : measured_op_costs_(MeasuredOpCosts::Global()) {
   // Syntactic sugar to build and return a lambda that takes an OpInfo and
   // returns a cost.
   typedef absl::Status (OpLevelCostEstimator::*CostImpl)(
@@ -662,7 +663,9 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
   NodeCosts node_costs;
   if (PredictNodeCosts(op_context, &node_costs).ok()) {
     if (node_costs.has_costs) {
-      return node_costs.costs;
+      costs = node_costs.costs;
+      ApplyMeasuredOpCosts(op_context, &costs);
+      return costs;
     }
     // Convert NodeCosts to Costs.
     if (node_costs.minimum_cost_op) {
@@ -682,6 +685,7 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
       costs = PredictOpCountBasedCost(
           node_costs.num_compute_ops, node_costs.num_total_read_bytes(),
           node_costs.num_total_write_bytes(), op_context.op_info);
+      ApplyMeasuredOpCosts(op_context, &costs);
     }
     VLOG(1) << "Operation " << op_context.op_info.op() << " takes "
             << costs.execution_time.count() << " ns.";
@@ -703,6 +707,24 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
   return costs;
 }
 
+void OpLevelCostEstimator::ApplyMeasuredOpCosts(const OpContext& op_context,
+                                                Costs* costs) const {
+  if (measured_op_costs_ == nullptr) return;
+  bool exact = false;
+  std::optional<Costs::NanoSeconds> time =
+      measured_op_costs_->PredictTime(op_context.op_info, &exact);
+  if (!time.has_value()) return;
+  VLOG(2) << "Using the " << (exact ? "measured" : "interpolated") << " time "
+          << time->count() << " ns of " << op_context.op_info.op();
+  // The measured time includes the memory accesses of the op.
+  costs->compute_time = *time;
+  costs->memory_time = 0;
+  costs->intermediate_memory_time = 0;
+  costs->intermediate_memory_read_time = 0;
+  costs->intermediate_memory_write_time = 0;
+  costs->execution_time = *time;
+}
+
 absl::Status OpLevelCostEstimator::PredictNodeCosts(
     const OpContext& op_context, NodeCosts* node_costs) const {
   const auto& op_info = op_context.op_info;
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/measured_op_costs.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/platform/types.h"
@@ -106,6 +107,13 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Uses `measured_op_costs`, which must outlive this estimator, for the
+  // execution time of the ops it covers. Defaults to
+  // MeasuredOpCosts::Global().
+  void set_measured_op_costs(const MeasuredOpCosts* measured_op_costs) {
+    measured_op_costs_ = measured_op_costs;
+  }
+
  protected:
   // TODO(dyoon): Consider to remove PredictOpCountBasedCosts() with OpInfo.
   // Naive cost estimate based on the given operations count and total
@@ -337,6 +345,11 @@ class OpLevelCostEstimator {
   std::set<string> persistent_ops_;
 
  private:
+  // Replaces the times of `costs` with the measured time of the op, if any.
+  void ApplyMeasuredOpCosts(const OpContext& op_context, Costs* costs) const;
+
+  const MeasuredOpCosts* measured_op_costs_;  // Not owned, may be null.
+
   friend class OpLevelCostEstimatorTest;
 };
 
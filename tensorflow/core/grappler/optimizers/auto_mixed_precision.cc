@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -31,6 +36,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -1028,6 +1036,85 @@ std::unordered_map<string, DeviceProperties> GetDevices(Cluster* cluster) {
   return devices;
 }
 
+// Computes a minimum cut between two nodes of a flow network with Dinic's
+// algorithm.
+class MinCutSolver {
+ public:
+  explicit MinCutSolver(int num_nodes)
+      : edges_(num_nodes), level_(num_nodes), next_edge_(num_nodes) {}
+
+  // Adds an edge, whose capacity may be infinite. Every path from the source
+  // to the sink must have a finite capacity.
+  void AddEdge(int from, int to, double capacity) {
+    edges_[from].push_back({to, static_cast<int>(edges_[to].size()), capacity});
+    edges_[to].push_back({from, static_cast<int>(edges_[from].size()) - 1, 0});
+  }
+
+  // Returns which nodes are on the source side of a minimum cut.
+  std::vector<bool> SourceSide(int source, int sink) {
+    while (BuildLevels(source, sink)) {
+      std::fill(next_edge_.begin(), next_edge_.end(), 0);
+      while (Augment(source, sink, std::numeric_limits<double>::infinity()) >
+             0) {
+      }
+    }
+    BuildLevels(source, sink);
+    std::vector<bool> source_side(edges_.size());
+    for (int node = 0; node < static_cast<int>(edges_.size()); ++node) {
+      source_side[node] = level_[node] >= 0;
+    }
+    return source_side;
+  }
+
+ private:
+  struct Edge {
+    int to;
+    int reverse;  // Index of the reverse edge in the edges of `to`.
+    double capacity;
+  };
+
+  // Sets the BFS levels of the residual network from `source`, and returns
+  // whether `sink` is reachable.
+  bool BuildLevels(int source, int sink) {
+    std::fill(level_.begin(), level_.end(), -1);
+    std::deque<int> queue = {source};
+    level_[source] = 0;
+    while (!queue.empty()) {
+      const int node = queue.front();
+      queue.pop_front();
+      for (const Edge& edge : edges_[node]) {
+        if (edge.capacity > 0 && level_[edge.to] < 0) {
+          level_[edge.to] = level_[node] + 1;
+          queue.push_back(edge.to);
+        }
+      }
+    }
+    return level_[sink] >= 0;
+  }
+
+  // Pushes up to `flow` along a shortest path to `sink`.
+  double Augment(int node, int sink, double flow) {
+    if (node == sink) return flow;
+    for (int& i = next_edge_[node]; i < static_cast<int>(edges_[node].size());
+         ++i) {
+      Edge& edge = edges_[node][i];
+      if (edge.capacity <= 0 || level_[edge.to] != level_[node] + 1) continue;
+      const double pushed =
+          Augment(edge.to, sink, std::min(flow, edge.capacity));
+      if (pushed > 0) {
+        edge.capacity -= pushed;
+        edges_[edge.to][edge.reverse].capacity += pushed;
+        return pushed;
+      }
+    }
+    return 0;
+  }
+
+  std::vector<std::vector<Edge>> edges_;
+  std::vector<int> level_;
+  std::vector<int> next_edge_;
+};
+
 class AutoMixedPrecisionImpl {
  public:
   // CastType indicates the type of inserted Cast op
@@ -1110,6 +1197,8 @@ class AutoMixedPrecisionImpl {
                                     absl::flat_hash_set<int>* allow_set) const;
   void PropagateAllowThroughClear(const absl::flat_hash_set<int>& deny_set,
                                   absl::flat_hash_set<int>* allow_set) const;
+  Status PaintAllowByMinCut(const absl::flat_hash_set<int>& deny_set,
+                            absl::flat_hash_set<int>* allow_set) const;
   Status ForceColorMatchOnRecurrentEdges(
       absl::flat_hash_set<int>* allow_set) const;
   void MakeCastsAllowIfAllOutputsAllow(
@@ -1140,6 +1229,7 @@ class AutoMixedPrecisionImpl {
   GraphTypeTopologyView graph_type_view_;
   bool force_all_fp16_;
   bool treat_infer_as_deny_;
+  bool cost_based_;
   AutoMixedPrecisionMode mode_;
   gtl::FlatSet<string> f16_allowlist_;
   gtl::FlatSet<string> f16_denylist_;
@@ -1393,6 +1483,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
   }
 
   treat_infer_as_deny_ = optimization_level == "TREAT_INFER_AS_DENY";
+  cost_based_ = optimization_level == "COST_BASED";
   VLOG(2) << "Optimization Level: " << optimization_level;
 
   std::unique_ptr<AutoMixedPrecisionLists> mp_lists =
@@ -1492,6 +1583,10 @@ Status AutoMixedPrecisionImpl::Optimize() {
   //    connected to a node in the allow_set via other clearlist nodes.
   //    This is done to increase the number of ops in the allow_set without
   //    affecting numerical stability.
+  //
+  // With the COST_BASED level, steps 3-5 are replaced by a minimum cut that
+  // chooses which of the allow, clear and infer nodes to change to f16 by
+  // weighing their estimated speedup against the cost of the casts.
 
   absl::flat_hash_set<int> allow_set;
   VLOG(2) << "Beginning pass 1 to add allowlist ops";
@@ -1513,20 +1608,37 @@ Status AutoMixedPrecisionImpl::Optimize() {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
   }
 
-  VLOG(2) << "Beginning pass 3 to set clear and infer nodes to allow if they "
-             "are between allow ops";
-  AddClearAndInferToAllowIfBetweenAllow(deny_set, &allow_set);
-  VLOG(2) << "Finished pass 3";
+  bool painted_by_min_cut = false;
+  if (cost_based_) {
+    VLOG(2) << "Beginning cost-based pass to choose allow nodes by a minimum "
+               "cut";
+    Status status = PaintAllowByMinCut(deny_set, &allow_set);
+    if (status.ok()) {
+      painted_by_min_cut = true;
+    } else {
+      LOG(WARNING) << "Failed to choose the allow nodes by their costs, "
+                      "falling back to the lists: "
+                   << status;
+    }
+    VLOG(2) << "Finished cost-based pass";
+  }
+
+  if (!painted_by_min_cut) {
+    VLOG(2) << "Beginning pass 3 to set clear and infer nodes to allow if they "
+               "are between allow ops";
+    AddClearAndInferToAllowIfBetweenAllow(deny_set, &allow_set);
+    VLOG(2) << "Finished pass 3";
 
-  VLOG(2) << "Beginning pass 4 to add infer list ops to allow if they "
-             "directly follow allow nodes";
-  AddInferToAllowIfFollowAllow(deny_set, &allow_set);
-  VLOG(2) << "Finished pass 4";
+    VLOG(2) << "Beginning pass 4 to add infer list ops to allow if they "
+               "directly follow allow nodes";
+    AddInferToAllowIfFollowAllow(deny_set, &allow_set);
+    VLOG(2) << "Finished pass 4";
 
-  VLOG(2) << "Beginning pass 5 to propagate allow from allow nodes through "
-             "clearlist ops";
-  PropagateAllowThroughClear(deny_set, &allow_set);
-  VLOG(2) << "Finished pass 5";
+    VLOG(2) << "Beginning pass 5 to propagate allow from allow nodes through "
+               "clearlist ops";
+    PropagateAllowThroughClear(deny_set, &allow_set);
+    VLOG(2) << "Finished pass 5";
+  }
 
   VLOG(2) << "Beginning pass 6 to remove some nodes which could not be changed "
              "to F16"
@@ -1852,6 +1964,133 @@ void AutoMixedPrecisionImpl::PropagateAllowThroughClear(
   }
 }
 
+// Chooses the nodes to change to f16 by a minimum cut of the graph, where the
+// source side is f16 and the sink side is f32. Each allow, clear or infer node
+// is connected to the source by its estimated speedup in f16, the other nodes
+// are tied to the sink, and each edge costs the cast of its tensor. The speedup
+// of a node halves its memory time, and also its compute time for allow ops;
+// infer ops get no speedup so that they only change to f16 to save casts.
+Status AutoMixedPrecisionImpl::PaintAllowByMinCut(
+    const absl::flat_hash_set<int>& deny_set,
+    absl::flat_hash_set<int>* allow_set) const {
+  // Fixed cost of a Cast, e.g. to launch its kernel.
+  constexpr double kCastOverheadNs = 1000;
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+  GrapplerItem item;
+  item.graph = *graph_;
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_input_tensor_values=*/false));
+  OpLevelCostEstimator estimator;
+  const auto predict_costs = [&](OpContext* op_context, const NodeDef& node) {
+    *op_context->op_info.mutable_device() = virtual_placer_.get_device(node);
+    return estimator.PredictCosts(*op_context);
+  };
+
+  // Returns the estimated time in ns that running `item` in f16 saves, or
+  // infinity for allow ops whose time is unknown, which keeps them f16.
+  const auto f16_gain = [&](const NodeTypeId& item, bool is_allow) -> double {
+    if (f16_inferlist_.count(item.node->op())) return 0;
+    OpContext op_context;
+    op_context.name = item.node->name();
+    op_context.device_name = item.node->device();
+    op_context.op_info.set_op(item.node->op());
+    *op_context.op_info.mutable_attr() = item.node->attr();
+    for (const auto& input : properties.GetInputProperties(item.node->name())) {
+      *op_context.op_info.add_inputs() = input;
+    }
+    for (const auto& output :
+         properties.GetOutputProperties(item.node->name())) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    const Costs costs = predict_costs(&op_context, *item.node);
+    double gain = costs.memory_time.count() / 2.0;
+    if (is_allow) gain += costs.compute_time.count() / 2.0;
+    if (costs.inaccurate || !std::isfinite(gain)) {
+      return is_allow ? kInfinity : 0;
+    }
+    return gain;
+  };
+
+  // Returns the estimated time in ns of casting the outputs of `item`.
+  const auto cast_cost = [&](const NodeTypeId& item) -> double {
+    const auto& outputs = properties.GetOutputProperties(item.node->name());
+    double cost = kCastOverheadNs;
+    for (int port = 0; port < static_cast<int>(outputs.size()); ++port) {
+      if (!(node_type_map_.GetOutputTypeAttr(*item.node, port) ==
+            item.type_attr)) {
+        continue;
+      }
+      OpContext op_context;
+      op_context.name = item.node->name();
+      op_context.op_info.set_op("Cast");
+      *op_context.op_info.add_inputs() = outputs[port];
+      *op_context.op_info.add_outputs() = outputs[port];
+      op_context.op_info.mutable_outputs(0)->set_dtype(target_dtype_);
+      const Costs costs = predict_costs(&op_context, *item.node);
+      if (!costs.inaccurate && std::isfinite(costs.execution_time.count())) {
+        cost += costs.execution_time.count();
+      }
+    }
+    return cost;
+  };
+
+  const int num_nodes = graph_type_view_.num_nodes();
+  const int source = num_nodes;
+  const int sink = num_nodes + 1;
+  MinCutSolver solver(num_nodes + 2);
+  for (int idx = 0; idx < num_nodes; ++idx) {
+    const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+    if (!IsFloat32(item)) continue;
+    const bool is_allow = allow_set->count(idx) > 0;
+    const bool can_change =
+        is_allow ||
+        (ShouldProcess(*item.node) && !deny_set.count(idx) &&
+         SupportsF16(item) &&
+         ((f16_clearlist_.count(item.node->op()) &&
+           !NodeImplicitlyReadsNonResourceVariable(*item.node)) ||
+          f16_inferlist_.count(item.node->op())));
+    if (!can_change) {
+      solver.AddEdge(idx, sink, kInfinity);
+    } else if (const double gain = f16_gain(item, is_allow); gain > 0) {
+      solver.AddEdge(source, idx, gain);
+    }
+
+    bool has_float32_fanout = false;
+    for (const int fanout : graph_type_view_.GetFanout(idx)) {
+      has_float32_fanout |= IsFloat32(*graph_type_view_.GetNode(fanout));
+    }
+    if (!has_float32_fanout) continue;
+    const double cost = cast_cost(item);
+    for (const int fanout : graph_type_view_.GetFanout(idx)) {
+      if (!IsFloat32(*graph_type_view_.GetNode(fanout))) continue;
+      solver.AddEdge(idx, fanout, cost);
+      solver.AddEdge(fanout, idx, cost);
+    }
+  }
+
+  const std::vector<bool> f16_side = solver.SourceSide(source, sink);
+  for (int idx = 0; idx < num_nodes; ++idx) {
+    const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+    if (f16_side[idx]) {
+      bool inserted = allow_set->insert(idx).second;
+      if (VLOG_IS_ON(2) && inserted) {
+        VLOG(2) << "Painting type " << item.type_attr.DebugString() << " of "
+                << item.node->op() << " node " << item.node->name()
+                << " ALLOW because it saves more than its casts cost";
+      }
+    } else if (allow_set->erase(idx) && VLOG_IS_ON(2)) {
+      VLOG(2) << "UnPainting type " << item.type_attr.DebugString()
+              << " of node " << item.node->name()
+              << " ALLOW because its casts cost more than it saves";
+    }
+  }
+  return OkStatus();
+}
+
 // Set infer node to allow if its immediate upstream node is in allow set
 void AutoMixedPrecisionImpl::AddInferToAllowIfFollowAllow(
     const absl::flat_hash_set<int>& deny_set,
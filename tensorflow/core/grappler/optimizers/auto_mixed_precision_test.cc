@@ -390,6 +390,50 @@ TEST_F(AutoMixedPrecisionTest, NoInferOp) {
   unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL");
 }
 
+TEST_F(AutoMixedPrecisionTest, CostBased) {
+  setenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL", "COST_BASED",
+         1 /* replace */);
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output large = ops::Const(s.WithOpName("large"), 1.f / 1024, {1024, 1024});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), large, large);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+  Output fetch1 = ops::Identity(s.WithOpName("fetch1"), clr1);
+  // The speedup of a small MatMul does not make up for its casts.
+  Output small = ops::Const(s.WithOpName("small"), 1.f / 4, {4, 4});
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), small);
+  Output allow2 = ops::MatMul(s.WithOpName("allow2"), deny1, deny1);
+  Output fetch2 = ops::Identity(s.WithOpName("fetch2"), allow2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch1", "fetch2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DeviceProperties device_properties;
+  device_properties.set_type("GPU");
+  device_properties.set_num_cores(80);
+  device_properties.set_frequency(1500);
+  device_properties.set_bandwidth(900000000);
+  device_properties.mutable_environment()->insert({"architecture", "7"});
+  device_properties.mutable_environment()->insert({"cuda", "9010"});
+  VirtualCluster cluster({{"/GPU:1", device_properties}});
+  TF_ASSERT_OK(cluster.Provision());
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+  unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL");
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_HALF);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_HALF);
+  EXPECT_EQ(output_view.GetNode("deny1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow2")->attr().at("T").type(), DT_FLOAT);
+  TF_EXPECT_OK(cluster.Shutdown());
+}
+
 TEST_F(AutoMixedPrecisionTest, BidirectionalClearChain) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
@@ -0,0 +1,282 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/filter_pushdown.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFilterDataset[] = "FilterDataset";
+constexpr char kPredicate[] = "predicate";
+constexpr char kTarguments[] = "Targuments";
+
+bool IsMapNode(const NodeDef& node) {
+  return node.op() == "MapDataset" || node.op() == "ParallelMapDataset" ||
+         node.op() == "ParallelMapDatasetV2";
+}
+
+int NumCapturedInputs(const NodeDef& node) {
+  return node.attr().at(kTarguments).list().type_size();
+}
+
+// Returns whether all arguments of the function have a fixed type.
+bool HasSimpleSignature(const FunctionDef& func) {
+  const OpDef& signature = func.signature();
+  if (signature.attr_size() > 0) return false;
+  for (const auto& arg : signature.input_arg()) {
+    if (arg.type() == DT_INVALID || !arg.number_attr().empty()) return false;
+  }
+  return true;
+}
+
+bool IsReferenced(const string& name, const FunctionDef& func) {
+  const auto references = [&name](const string& input) {
+    return input == strings::StrCat("^", name) ||
+           input.substr(0, input.find(':')) == name;
+  };
+  for (const NodeDef& node : func.node_def()) {
+    for (const string& input : node.input()) {
+      if (references(input)) return true;
+    }
+  }
+  for (const auto& ret : func.ret()) {
+    if (references(ret.second)) return true;
+  }
+  return false;
+}
+
+// Returns the index of the input component that `tensor` forwards unchanged,
+// possibly through Identity nodes, or -1 if it is computed from the inputs.
+int ForwardedComponent(const FunctionDef& func, int num_components,
+                       string tensor) {
+  for (int i = 0; i <= func.node_def_size(); ++i) {
+    const string name = tensor.substr(0, tensor.find(':'));
+    const int arg = function_utils::FindFunctionInputWithName(name, func);
+    if (arg >= 0) return arg < num_components ? arg : -1;
+    const int node = function_utils::FindFunctionNodeWithName(name, func);
+    if (node < 0) return -1;
+    const NodeDef& node_def = func.node_def(node);
+    if (node_def.op() != "Identity" || node_def.input_size() != 1) return -1;
+    tensor = node_def.input(0);
+  }
+  return -1;
+}
+
+// Rewrites the predicate of a filter that follows a map to read the input
+// components of the map instead of its outputs. Returns nullptr if the
+// predicate reads an output that the map function does not forward.
+FunctionDef* MakePushedPredicate(const FunctionDef& map_func,
+                                 int num_map_components,
+                                 const FunctionDef& predicate,
+                                 int num_captured_inputs,
+                                 FunctionDefLibrary* library) {
+  const OpDef& map_signature = map_func.signature();
+  const OpDef& predicate_signature = predicate.signature();
+  const int num_components = map_signature.output_arg_size();
+  if (predicate_signature.input_arg_size() !=
+      num_components + num_captured_inputs) {
+    return nullptr;
+  }
+
+  FunctionDef pushed = predicate;
+  OpDef* signature = pushed.mutable_signature();
+  signature->clear_input_arg();
+  pushed.clear_arg_attr();
+  pushed.clear_resource_arg_unique_id();
+  std::vector<string> component_names;
+  for (int i = 0; i < num_map_components; ++i) {
+    string name = strings::StrCat("map_input_", i);
+    while (function_utils::FindFunctionInputWithName(name, predicate) >= 0 ||
+           function_utils::FindFunctionNodeWithName(name, predicate) >= 0) {
+      strings::StrAppend(&name, "_");
+    }
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    *arg = map_signature.input_arg(i);
+    arg->set_name(name);
+    if (const auto* arg_attr = gtl::FindOrNull(map_func.arg_attr(), i)) {
+      (*pushed.mutable_arg_attr())[i] = *arg_attr;
+    }
+    component_names.push_back(name);
+  }
+
+  for (int i = 0; i < num_components; ++i) {
+    const string& name = predicate_signature.input_arg(i).name();
+    if (!IsReferenced(name, predicate)) continue;
+    const string* ret =
+        gtl::FindOrNull(map_func.ret(), map_signature.output_arg(i).name());
+    const int component =
+        ret == nullptr ? -1
+                       : ForwardedComponent(map_func, num_map_components, *ret);
+    if (component < 0) {
+      VLOG(1) << "Can't push the filter through the map because the predicate "
+                 "reads the output "
+              << i << " of the map function";
+      return nullptr;
+    }
+    function_utils::ReplaceReferences(name, component_names[component],
+                                      &pushed);
+    function_utils::ReplaceReferences(
+        strings::StrCat("^", name),
+        strings::StrCat("^", component_names[component]), &pushed);
+  }
+
+  for (int i = num_components; i < predicate_signature.input_arg_size(); ++i) {
+    *signature->add_input_arg() = predicate_signature.input_arg(i);
+    if (const auto* arg_attr = gtl::FindOrNull(predicate.arg_attr(), i)) {
+      (*pushed.mutable_arg_attr())[signature->input_arg_size() - 1] =
+          *arg_attr;
+    }
+  }
+  graph_utils::SetUniqueGraphFunctionName("pushed_predicate", library,
+                                          &pushed);
+  FunctionDef* result = library->add_function();
+  *result = std::move(pushed);
+  return result;
+}
+
+NodeDef MakePushedFilterNode(const NodeDef& filter_node,
+                             const NodeDef& map_node,
+                             const NodeDef& map_input_node,
+                             const FunctionDef& predicate,
+                             MutableGraphView* graph) {
+  NodeDef pushed_filter;
+  graph_utils::SetUniqueGraphNodeName("pushed_filter", graph->graph(),
+                                      &pushed_filter);
+  pushed_filter.set_op(kFilterDataset);
+  pushed_filter.add_input(map_node.input(0));
+  for (int i = 1; i < filter_node.input_size(); ++i) {
+    pushed_filter.add_input(filter_node.input(i));
+  }
+
+  auto attr = filter_node.attr().at(kPredicate);
+  attr.mutable_func()->set_name(predicate.signature().name());
+  (*pushed_filter.mutable_attr())[kPredicate] = std::move(attr);
+  graph_utils::CopyAttribute(kTarguments, filter_node, &pushed_filter);
+  graph_utils::CopyShapesAndTypesAttrs(map_input_node, &pushed_filter);
+  if (gtl::FindOrNull(filter_node.attr(), "metadata")) {
+    graph_utils::CopyAttribute("metadata", filter_node, &pushed_filter);
+  }
+  return pushed_filter;
+}
+
+}  // namespace
+
+Status FilterPushdown::OptimizeAndCollectStats(Cluster* cluster,
+                                               const GrapplerItem& item,
+                                               GraphDef* output,
+                                               OptimizationStats* stats) {
+  GraphDef sorted_old_graph = item.graph;
+  TF_RETURN_IF_ERROR(TopologicalSort(&sorted_old_graph));
+  *output = sorted_old_graph;
+
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             output->library());
+
+  // Returns the map that `filter_node` can be pushed through, or nullptr.
+  auto get_map_node = [&](const NodeDef& filter_node) -> const NodeDef* {
+    if (filter_node.op() != kFilterDataset ||
+        nodes_to_preserve.count(filter_node.name()) > 0) {
+      return nullptr;
+    }
+    const NodeDef* map_node = graph_utils::GetInputNode(filter_node, graph);
+    if (map_node == nullptr || !IsMapNode(*map_node) ||
+        nodes_to_preserve.count(map_node->name()) > 0) {
+      return nullptr;
+    }
+    // The map must only feed the filter, which is the case of its original
+    // fanout after a previous push.
+    int num_fanouts = 0;
+    for (const auto& fanout : graph.GetFanouts(*map_node, true)) {
+      if (!nodes_to_delete.contains(fanout.node->name())) ++num_fanouts;
+    }
+    return num_fanouts == 1 ? map_node : nullptr;
+  };
+
+  for (const NodeDef& node : sorted_old_graph.node()) {
+    const NodeDef* filter_node = graph.GetNode(node.name());
+    const NodeDef* map_node;
+    while ((map_node = get_map_node(*filter_node)) != nullptr) {
+      const NodeDef* map_input_node =
+          graph_utils::GetInputNode(*map_node, graph);
+      NodeDef unused;
+      if (map_input_node == nullptr ||
+          !graph_utils::CopyShapesAndTypesAttrs(*map_input_node, &unused)) {
+        break;
+      }
+      const FunctionDef* map_func =
+          function_library.Find(map_node->attr().at("f").func().name());
+      const FunctionDef* predicate = function_library.Find(
+          filter_node->attr().at(kPredicate).func().name());
+      if (map_func == nullptr || predicate == nullptr ||
+          !HasSimpleSignature(*map_func) || !HasSimpleSignature(*predicate) ||
+          function_utils::IsFunctionStateful(function_library, *map_func)) {
+        break;
+      }
+      const int num_map_components = map_func->signature().input_arg_size() -
+                                     NumCapturedInputs(*map_node);
+      const FunctionDef* pushed_predicate = MakePushedPredicate(
+          *map_func, num_map_components, *predicate,
+          NumCapturedInputs(*filter_node), output->mutable_library());
+      if (pushed_predicate == nullptr) break;
+      TF_RETURN_IF_ERROR(function_library.AddFunctionDef(*pushed_predicate));
+
+      const NodeDef* pushed_filter = graph.AddNode(MakePushedFilterNode(
+          *filter_node, *map_node, *map_input_node, *pushed_predicate, &graph));
+      NodeDef pushed_map = *map_node;
+      graph_utils::SetUniqueGraphNodeName(map_node->name(), graph.graph(),
+                                          &pushed_map);
+      pushed_map.set_input(0, pushed_filter->name());
+      const NodeDef* new_map = graph.AddNode(std::move(pushed_map));
+      TF_RETURN_IF_ERROR(
+          graph.UpdateFanouts(filter_node->name(), new_map->name()));
+
+      nodes_to_delete.insert(map_node->name());
+      nodes_to_delete.insert(filter_node->name());
+      stats->num_changes++;
+      filter_node = pushed_filter;
+    }
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(FilterPushdown, "filter_pushdown");
+
+}  // namespace grappler
+}  // namespace tensorflow
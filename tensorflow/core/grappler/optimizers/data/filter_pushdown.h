@@ -0,0 +1,54 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FILTER_PUSHDOWN_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FILTER_PUSHDOWN_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This transformation moves filters above the maps they follow, when the
+// predicate only reads components that the map function forwards unchanged.
+//
+// In symbols, we transform map(x, y -> x, f(y)).filter(x, z -> p(x)) into
+// filter(x, y -> p(x)).map(x, y -> x, f(y)), so that the (possibly expensive)
+// map function is only applied to the elements that pass the filter. Only
+// stateless map functions are considered, and a filter is pushed through as
+// many maps as possible.
+class FilterPushdown : public TFDataOptimizerBase {
+ public:
+  FilterPushdown() = default;
+  ~FilterPushdown() override = default;
+
+  string name() const override { return "filter_pushdown"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FILTER_PUSHDOWN_H_
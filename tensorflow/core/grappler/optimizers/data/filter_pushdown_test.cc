@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/filter_pushdown.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeFilterNode;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+// (x) -> (x, x * x)
+FunctionDef ForwardAndSquare() {
+  return FunctionDefHelper::Create(
+      "ForwardAndSquare", {"x: int64"}, {"x_out: int64", "y: int64"}, {},
+      {{{"square"}, "Mul", {"x", "x"}, {{"T", DT_INT64}}}},
+      {{"x_out", "x"}, {"y", "square:z:0"}});
+}
+
+// (x, y) -> x == 0 if `component` is 0, and y == 0 otherwise.
+FunctionDef ComponentIsZero(const string& name, int component) {
+  return FunctionDefHelper::Create(
+      name, {"x: int64", "y: int64"}, {"z: bool"}, {},
+      {{{"zero"}, "Const", {}, {{"value", int64_t{0}}, {"dtype", DT_INT64}}},
+       {{"equal"},
+        "Equal",
+        {component == 0 ? "x" : "y", "zero:output:0"},
+        {{"T", DT_INT64}}}},
+      {{"z", "equal:z:0"}});
+}
+
+GraphDef MakeMapAndFilterGraph(const string& predicate) {
+  return test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", int64_t{0}}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", int64_t{10}}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", int64_t{1}}, {"dtype", DT_INT64}}),
+       NDef("filename", "Const", {}, {{"value", ""}, {"dtype", DT_STRING}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       MakeMapNode("map", "range", "ForwardAndSquare"),
+       MakeFilterNode("filter", "map", predicate),
+       NDef("cache", "CacheDataset", {"filter", "filename"}, {})},
+      {ForwardAndSquare(), ComponentIsZero("FirstIsZero", 0),
+       ComponentIsZero("SecondIsZero", 1)});
+}
+
+TEST(FilterPushdownTest, PushFilterAboveMap) {
+  GrapplerItem item;
+  item.graph = MakeMapAndFilterGraph("FirstIsZero");
+
+  FilterPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("filter", output));
+
+  const NodeDef& filter_node = output.node(
+      graph_utils::FindGraphNodeWithOp("FilterDataset", output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const NodeDef& cache_node =
+      output.node(graph_utils::FindGraphNodeWithName("cache", output));
+  EXPECT_EQ(filter_node.input(0), "range");
+  EXPECT_EQ(map_node.input(0), filter_node.name());
+  EXPECT_EQ(cache_node.input(0), map_node.name());
+  EXPECT_EQ(filter_node.attr().at("output_types").list().type_size(), 1);
+
+  const FunctionDef& predicate = output.library().function(
+      graph_utils::FindGraphFunctionWithName(
+          filter_node.attr().at("predicate").func().name(), output.library()));
+  ASSERT_EQ(predicate.signature().input_arg_size(), 1);
+  EXPECT_EQ(predicate.signature().input_arg(0).type(), DT_INT64);
+  const string& arg_name = predicate.signature().input_arg(0).name();
+  bool reads_arg = false;
+  for (const NodeDef& node : predicate.node_def()) {
+    if (node.name() == "equal") reads_arg = node.input(0) == arg_name;
+  }
+  EXPECT_TRUE(reads_arg);
+}
+
+TEST(FilterPushdownTest, DoNotPushFilterReadingMappedComponent) {
+  GrapplerItem item;
+  item.graph = MakeMapAndFilterGraph("SecondIsZero");
+
+  FilterPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("filter", output));
+  const NodeDef& filter_node =
+      output.node(graph_utils::FindGraphNodeWithName("filter", output));
+  EXPECT_EQ(filter_node.input(0), "map");
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
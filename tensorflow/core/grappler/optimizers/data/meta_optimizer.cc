@@ -38,13 +38,14 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 21> kTFDataOptimizations = {
+constexpr std::array<const char*, 22> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
     "shuffle_and_repeat_fusion",
     "map_parallelization",
     "map_fusion",
+    "filter_pushdown",
     "filter_fusion",
     "map_and_filter_fusion",
     "map_and_batch_fusion",
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -385,6 +386,59 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
 #endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 }
 
+TEST_F(GenericLayoutOptimizerTest, CPUDeviceNHWCToNCHW) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Tensor input_data(DT_FLOAT, TensorShape({8, 4, 4, 3}));
+  test::FillIota<float>(&input_data, 1.0f);
+  Output input =
+      ops::Const(s.WithOpName("Input"), Input::Initializer(input_data));
+  Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 3, 2}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  Output filter =
+      ops::Const(s.WithOpName("Filter"), Input::Initializer(filter_data));
+  Output conv = ops::Conv2D(s.WithOpName("Conv2D").WithDevice("/CPU:0"), input,
+                            filter, {1, 1, 1, 1}, "VALID",
+                            ops::Conv2D::Attrs().DataFormat("NHWC"));
+  auto relu = ops::Relu(s.WithOpName("Relu").WithDevice("/CPU:0"), conv);
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {relu});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NHWC_TO_NCHW);
+  GraphDef output;
+  Status optimize_status =
+      optimizer.Optimize(virtual_cluster_.get(), item, &output);
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  if (!IsMKLEnabled()) {
+    EXPECT_TRUE(errors::IsAborted(optimize_status));
+    return;
+  }
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  TF_ASSERT_OK(optimize_status);
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+#else
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  // The layout agnostic Relu stays in NCHW, followed by the only transpose
+  // back to NHWC.
+  auto* fetch_node = graph_view.GetNode("Fetch");
+  ASSERT_NE(fetch_node, nullptr);
+  ASSERT_EQ(fetch_node->NumRegularFanins(), 1);
+  const auto* transpose_node = fetch_node->GetRegularFanin(0).node_view();
+  EXPECT_EQ(transpose_node->GetOp(), "Transpose");
+  ASSERT_GE(transpose_node->NumRegularFanins(), 1);
+  EXPECT_EQ(transpose_node->GetRegularFanin(0).node_view()->GetName(),
+            "Relu");
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+}
+
 TEST_F(GenericLayoutOptimizerTest, NoOptimizeIntegerConvolution) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D<int32>(&s, 4, 2, "VALID", "");
@@ -107,6 +107,25 @@ bool IsNonFloatingConv3D(const utils::MutableNodeView& node) {
   return false;
 }
 
+// Returns whether oneDNN implements the layout sensitive op in channels-first
+// format on CPU. The other CPU kernels mostly only support channels-last.
+bool IsOneDnnChannelsFirstOp(const utils::MutableNodeView& node) {
+  const NodeDef& node_def = *node.node();
+  if (!IsConv2D(node_def) && !IsConv2DBackpropFilter(node_def) &&
+      !IsConv2DBackpropInput(node_def) && !IsConv3D(node_def) &&
+      !IsConv3DBackpropFilterV2(node_def) &&
+      !IsConv3DBackpropInputV2(node_def) && node_def.op() != "AvgPool" &&
+      !IsAvgPoolGrad(node_def) && node_def.op() != "MaxPool" &&
+      !IsMaxPoolGrad(node_def) && !IsMaxPool3D(node_def) &&
+      !IsFusedBatchNorm(node_def) && !IsFusedBatchNormGrad(node_def) &&
+      !IsBiasAdd(node_def) && !IsBiasAddGrad(node_def)) {
+    return false;
+  }
+  const auto* attr = node.GetAttr(kAttrT);
+  return attr != nullptr &&
+         (attr->type() == DT_FLOAT || attr->type() == DT_BFLOAT16);
+}
+
 // Utils for layout agnostic transposer.
 
 bool IsComparisonOp(const NodeDef& node) {
@@ -293,8 +312,14 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
   const bool is_integer_conv3d = IsNonFloatingConv3D(node);
 
+  // Only oneDNN has channels-first kernels of layout sensitive ops on CPU.
+  const bool is_supported_format =
+      !IsLayoutSensitiveOp(*node_def) || context.target_device != kCPU ||
+      (context.dst_format != "NCHW" && context.dst_format != "NCDHW") ||
+      IsOneDnnChannelsFirstOp(node);
+
   return is_on_target_device && data_format_match && !is_integer_conv2d &&
-         !is_integer_conv3d &&
+         !is_integer_conv3d && is_supported_format &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
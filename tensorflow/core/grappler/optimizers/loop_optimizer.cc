@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
@@ -715,6 +717,459 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return OkStatus();
 }
 
+// Loops with at most kMaxUnrollTripCount iterations are unrolled, if the
+// unrolled copies of their body have at most kMaxUnrolledNodes nodes. For such
+// loops the executor spends more time in frame bookkeeping than in the body.
+constexpr int kMaxUnrollTripCount = 8;
+constexpr int kMaxUnrolledNodes = 512;
+
+bool GetIntegerScalar(const NodeDef& node, int64_t* value) {
+  if (!IsConstant(node)) {
+    return false;
+  }
+  const auto it = node.attr().find("value");
+  Tensor tensor;
+  if (it == node.attr().end() || !tensor.FromProto(it->second.tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.flat<int32>()(0);
+    return true;
+  }
+  if (tensor.dtype() == DT_INT64) {
+    *value = tensor.flat<int64_t>()(0);
+    return true;
+  }
+  return false;
+}
+
+bool IsInvariantEnter(const NodeDef& node) {
+  if (!IsEnter(node)) {
+    return false;
+  }
+  const auto it = node.attr().find("is_constant");
+  return it != node.attr().end() && it->second.b();
+}
+
+// Unrolls the while loop of a single frame without nested frames, if its trip
+// count is statically known and small. The loop must be of the form
+//
+//   i = Merge(Enter(Const init), NextIteration(Add(Identity(Switch:1), step)))
+//   LoopCond(Less(i, bound))
+//
+// where `step` and `bound` are constants, and its body must be free of side
+// effects. The body is copied once per iteration outside of the frame, and the
+// Exit nodes are replaced by Identity nodes of the values of the last
+// iteration.
+class WhileLoopUnroller {
+ public:
+  WhileLoopUnroller(const GraphDef& graph,
+                    const absl::flat_hash_map<string, int>& node_index,
+                    const std::vector<int>& frame_nodes)
+      : graph_(graph), node_index_(node_index), frame_nodes_(frame_nodes) {}
+
+  // Returns false if the loop can't be unrolled, otherwise appends the
+  // unrolled body and the new Exit nodes to `new_nodes`.
+  bool Unroll(const std::unordered_set<string>& nodes_to_preserve,
+              const absl::flat_hash_set<string>& feed_nodes,
+              std::vector<NodeDef>* new_nodes);
+
+ private:
+  const NodeDef* GetNode(const string& input) const {
+    const auto it = node_index_.find(NodeName(input));
+    return it == node_index_.end() ? nullptr : &graph_.node(it->second);
+  }
+
+  bool InFrame(const NodeDef* node) const {
+    return node != nullptr && frame_.contains(node->name());
+  }
+
+  // Returns the constant read by `input`, looking through invariant Enters.
+  bool GetConstantInput(const string& input, int64_t* value) const;
+
+  bool ClassifyNodes(const std::unordered_set<string>& nodes_to_preserve,
+                     const absl::flat_hash_set<string>& feed_nodes);
+
+  bool GetTripCount(int64_t* trip_count) const;
+
+  // Maps an input of a body node to the corresponding input of its copy for
+  // the given iteration. Returns false if the input can't be mapped.
+  bool MapInput(const string& input, int iteration,
+                const absl::flat_hash_map<const NodeDef*, string>& values,
+                string* mapped) const;
+
+  const GraphDef& graph_;
+  const absl::flat_hash_map<string, int>& node_index_;
+  const std::vector<int>& frame_nodes_;
+
+  absl::flat_hash_set<string> frame_;
+  const NodeDef* loop_cond_ = nullptr;
+  std::vector<const NodeDef*> merges_;
+  std::vector<const NodeDef*> exits_;
+  // Maps the loop variables, i.e. the Merge nodes, to their Enter, Switch and
+  // NextIteration nodes.
+  absl::flat_hash_map<const NodeDef*, const NodeDef*> enter_;
+  absl::flat_hash_map<const NodeDef*, const NodeDef*> switch_;
+  absl::flat_hash_map<const NodeDef*, const NodeDef*> next_iteration_;
+  // Maps the Switch nodes back to their Merge nodes.
+  absl::flat_hash_map<const NodeDef*, const NodeDef*> merge_of_switch_;
+};
+
+bool WhileLoopUnroller::GetConstantInput(const string& input,
+                                         int64_t* value) const {
+  const NodeDef* node = GetNode(input);
+  if (node == nullptr || IsControlInput(input)) {
+    return false;
+  }
+  if (IsEnter(*node)) {
+    if (!IsInvariantEnter(*node)) {
+      return false;
+    }
+    node = GetNode(node->input(0));
+    if (node == nullptr || InFrame(node)) {
+      return false;
+    }
+  }
+  return GetIntegerScalar(*node, value);
+}
+
+bool WhileLoopUnroller::ClassifyNodes(
+    const std::unordered_set<string>& nodes_to_preserve,
+    const absl::flat_hash_set<string>& feed_nodes) {
+  for (int index : frame_nodes_) {
+    frame_.insert(graph_.node(index).name());
+  }
+  std::vector<const NodeDef*> switches;
+  for (int index : frame_nodes_) {
+    const NodeDef& node = graph_.node(index);
+    if (feed_nodes.contains(node.name()) ||
+        (!IsExit(node) && nodes_to_preserve.count(node.name()) > 0)) {
+      return false;
+    }
+    if (IsLoopCond(node)) {
+      if (loop_cond_ != nullptr) {
+        return false;
+      }
+      loop_cond_ = &node;
+    } else if (IsMerge(node)) {
+      merges_.push_back(&node);
+    } else if (IsSwitch(node)) {
+      switches.push_back(&node);
+    } else if (IsExit(node)) {
+      exits_.push_back(&node);
+    } else if (IsEnter(node)) {
+      // Non-constant Enter nodes are checked with their Merge nodes below.
+      if (node.input_size() != 1) {
+        return false;
+      }
+    } else if (!IsNextIteration(node) && !IsFreeOfSideEffect(node)) {
+      return false;
+    }
+  }
+  if (loop_cond_ == nullptr) {
+    return false;
+  }
+
+  int num_variant_enters = 0;
+  for (int index : frame_nodes_) {
+    const NodeDef& node = graph_.node(index);
+    if (IsEnter(node) && !IsInvariantEnter(node)) {
+      ++num_variant_enters;
+    }
+  }
+  for (const NodeDef* merge : merges_) {
+    if (merge->input_size() != 2) {
+      return false;
+    }
+    for (const string& input : merge->input()) {
+      const NodeDef* fanin = GetNode(input);
+      if (!InFrame(fanin) || IsControlInput(input)) {
+        return false;
+      }
+      if (IsEnter(*fanin) && !IsInvariantEnter(*fanin)) {
+        enter_[merge] = fanin;
+      } else if (IsNextIteration(*fanin) && fanin->input_size() == 1) {
+        next_iteration_[merge] = fanin;
+      }
+    }
+    if (!enter_.contains(merge) || !next_iteration_.contains(merge)) {
+      return false;
+    }
+  }
+  // Every variant Enter must feed a single loop variable.
+  if (num_variant_enters != static_cast<int>(enter_.size())) {
+    return false;
+  }
+
+  for (const NodeDef* sw : switches) {
+    if (sw->input_size() != 2 || NodeName(sw->input(1)) != loop_cond_->name()) {
+      return false;
+    }
+    int port;
+    const NodeDef* merge = GetNode(sw->input(0));
+    ParseNodeName(sw->input(0), &port);
+    if (port != 0 || !InFrame(merge) || !IsMerge(*merge) ||
+        switch_.contains(merge)) {
+      return false;
+    }
+    switch_[merge] = sw;
+    merge_of_switch_[sw] = merge;
+  }
+  if (switch_.size() != merges_.size()) {
+    return false;
+  }
+
+  for (const NodeDef* exit_node : exits_) {
+    int port;
+    const NodeDef* sw = exit_node->input_size() == 1
+                            ? GetNode(exit_node->input(0))
+                            : nullptr;
+    if (sw == nullptr || !merge_of_switch_.contains(sw)) {
+      return false;
+    }
+    ParseNodeName(exit_node->input(0), &port);
+    if (port != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool WhileLoopUnroller::GetTripCount(int64_t* trip_count) const {
+  if (loop_cond_->input_size() == 0) {
+    return false;
+  }
+  const NodeDef* less = GetNode(loop_cond_->input(0));
+  if (!InFrame(less) || !IsLess(*less) || less->input_size() < 2) {
+    return false;
+  }
+  const NodeDef* counter = GetNode(less->input(0));
+  int port;
+  ParseNodeName(less->input(0), &port);
+  if (!InFrame(counter) || !IsMerge(*counter) || port != 0) {
+    return false;
+  }
+  int64_t init, bound, step = 0;
+  if (!GetConstantInput(enter_.at(counter)->input(0), &init) ||
+      !GetConstantInput(less->input(1), &bound)) {
+    return false;
+  }
+  const NodeDef* add = GetNode(next_iteration_.at(counter)->input(0));
+  if (!InFrame(add) || !IsAdd(*add) || add->input_size() != 2) {
+    return false;
+  }
+  for (int i = 0; i < 2; ++i) {
+    string input = add->input(i);
+    const NodeDef* fanin = GetNode(input);
+    if (InFrame(fanin) && IsIdentity(*fanin) && fanin->input_size() == 1) {
+      input = fanin->input(0);
+      fanin = GetNode(input);
+    }
+    ParseNodeName(input, &port);
+    if (fanin == switch_.at(counter) && port == 1 &&
+        GetConstantInput(add->input(1 - i), &step)) {
+      break;
+    }
+    step = 0;
+  }
+  if (step <= 0) {
+    return false;
+  }
+  *trip_count = init < bound ? (bound - init - 1) / step + 1 : 0;
+  return true;
+}
+
+bool WhileLoopUnroller::MapInput(
+    const string& input, int iteration,
+    const absl::flat_hash_map<const NodeDef*, string>& values,
+    string* mapped) const {
+  const NodeDef* fanin = GetNode(input);
+  if (!InFrame(fanin)) {
+    return false;
+  }
+  int port;
+  ParseNodeName(input, &port);
+  const bool is_control = port < 0;
+  const NodeDef* merge = nullptr;
+  if (IsMerge(*fanin) && port <= 0) {
+    merge = fanin;
+  } else if (IsSwitch(*fanin) && (is_control || port == 1)) {
+    merge = merge_of_switch_.at(fanin);
+  }
+  if (merge != nullptr) {
+    const string& value = values.at(merge);
+    *mapped = is_control ? AsControlDependency(NodeName(value)) : value;
+    return true;
+  }
+  if (IsEnter(*fanin)) {
+    if (!IsInvariantEnter(*fanin) || port > 0) {
+      return false;
+    }
+    *mapped = is_control ? AsControlDependency(NodeName(fanin->input(0)))
+                         : fanin->input(0);
+    return true;
+  }
+  if (IsLoopCond(*fanin) || IsSwitch(*fanin) || IsMerge(*fanin) ||
+      IsNextIteration(*fanin) || IsExit(*fanin)) {
+    return false;
+  }
+  const string name = StrCat(fanin->name(), "/unrolled_", iteration);
+  if (is_control) {
+    *mapped = AsControlDependency(name);
+  } else {
+    *mapped = port == 0 ? name : StrCat(name, ":", port);
+  }
+  return true;
+}
+
+bool WhileLoopUnroller::Unroll(
+    const std::unordered_set<string>& nodes_to_preserve,
+    const absl::flat_hash_set<string>& feed_nodes,
+    std::vector<NodeDef>* new_nodes) {
+  int64_t trip_count;
+  if (!ClassifyNodes(nodes_to_preserve, feed_nodes) ||
+      !GetTripCount(&trip_count) || trip_count > kMaxUnrollTripCount) {
+    return false;
+  }
+
+  // The body consists of the nodes needed to compute the next values of the
+  // loop variables. The other nodes of the frame, e.g. the loop condition,
+  // are free of side effects and can be dropped.
+  std::vector<const NodeDef*> body;
+  absl::flat_hash_set<const NodeDef*> in_body;
+  std::vector<const NodeDef*> stack;
+  for (const NodeDef* merge : merges_) {
+    stack.push_back(GetNode(next_iteration_.at(merge)->input(0)));
+  }
+  while (!stack.empty()) {
+    const NodeDef* node = stack.back();
+    stack.pop_back();
+    if (!InFrame(node) || IsEnter(*node) || IsMerge(*node) ||
+        IsSwitch(*node) || !in_body.insert(node).second) {
+      continue;
+    }
+    body.push_back(node);
+    for (const string& input : node->input()) {
+      stack.push_back(GetNode(input));
+    }
+  }
+  if (trip_count * static_cast<int64_t>(body.size()) > kMaxUnrolledNodes) {
+    return false;
+  }
+  for (const NodeDef* node : body) {
+    for (int i = 0; i < trip_count; ++i) {
+      if (node_index_.contains(StrCat(node->name(), "/unrolled_", i))) {
+        return false;
+      }
+    }
+  }
+  // Copies the body nodes in the order of the graph, which keeps the unrolled
+  // body deterministic.
+  std::vector<const NodeDef*> ordered_body;
+  for (int index : frame_nodes_) {
+    if (in_body.contains(&graph_.node(index))) {
+      ordered_body.push_back(&graph_.node(index));
+    }
+  }
+
+  absl::flat_hash_map<const NodeDef*, string> values;
+  for (const NodeDef* merge : merges_) {
+    values[merge] = enter_.at(merge)->input(0);
+  }
+  std::vector<NodeDef> unrolled;
+  for (int i = 0; i < trip_count; ++i) {
+    for (const NodeDef* node : ordered_body) {
+      NodeDef copy = *node;
+      copy.set_name(StrCat(node->name(), "/unrolled_", i));
+      copy.clear_input();
+      // The colocation constraints may refer to the removed loop nodes.
+      copy.mutable_attr()->erase("_class");
+      for (const string& input : node->input()) {
+        if (!MapInput(input, i, values, copy.add_input())) {
+          return false;
+        }
+      }
+      unrolled.push_back(std::move(copy));
+    }
+    absl::flat_hash_map<const NodeDef*, string> next_values;
+    for (const NodeDef* merge : merges_) {
+      if (!MapInput(next_iteration_.at(merge)->input(0), i, values,
+                    &next_values[merge])) {
+        return false;
+      }
+    }
+    values = std::move(next_values);
+  }
+
+  for (const NodeDef* exit_node : exits_) {
+    NodeDef identity;
+    identity.set_name(exit_node->name());
+    identity.set_op("Identity");
+    identity.set_device(exit_node->device());
+    const NodeDef* sw = GetNode(exit_node->input(0));
+    identity.add_input(values.at(merge_of_switch_.at(sw)));
+    const auto it = exit_node->attr().find("T");
+    if (it != exit_node->attr().end()) {
+      (*identity.mutable_attr())["T"] = it->second;
+    }
+    unrolled.push_back(std::move(identity));
+  }
+  VLOG(2) << "Unrolled " << trip_count << " iterations of the while loop of "
+          << loop_cond_->name();
+  for (NodeDef& node : unrolled) {
+    new_nodes->push_back(std::move(node));
+  }
+  return true;
+}
+
+Status UnrollLoops(const std::unordered_set<string>& nodes_to_preserve,
+                   const absl::flat_hash_set<string>& feed_nodes,
+                   GraphDef* optimized_graph) {
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+  if (frame_view.num_frames() == 0) {
+    return OkStatus();
+  }
+
+  // Only the loops that neither contain nor are contained in another loop are
+  // unrolled.
+  std::vector<std::vector<int>> frame_nodes(frame_view.num_frames());
+  std::vector<bool> is_flat_frame(frame_view.num_frames(), true);
+  absl::flat_hash_map<string, int> node_index;
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    const NodeDef& node = optimized_graph->node(i);
+    node_index[node.name()] = i;
+    const std::vector<int>& frame_ids = frame_view.Frames(node);
+    if (frame_ids.size() == 1) {
+      frame_nodes[frame_ids[0]].push_back(i);
+    } else {
+      for (int frame_id : frame_ids) {
+        is_flat_frame[frame_id] = false;
+      }
+    }
+  }
+
+  std::vector<NodeDef> new_nodes;
+  std::set<int> nodes_to_delete;
+  for (int frame_id = 0; frame_id < frame_view.num_frames(); ++frame_id) {
+    if (!is_flat_frame[frame_id]) {
+      continue;
+    }
+    WhileLoopUnroller unroller(*optimized_graph, node_index,
+                               frame_nodes[frame_id]);
+    if (unroller.Unroll(nodes_to_preserve, feed_nodes, &new_nodes)) {
+      nodes_to_delete.insert(frame_nodes[frame_id].begin(),
+                             frame_nodes[frame_id].end());
+    }
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  for (NodeDef& node : new_nodes) {
+    *optimized_graph->add_node() = std::move(node);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -726,7 +1181,7 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -734,7 +1189,8 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      !options_.enable_loop_unrolling) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
@@ -755,6 +1211,14 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
+  if (options_.enable_loop_unrolling) {
+    absl::flat_hash_set<string> feed_nodes;
+    for (const auto& feed : item.feed) {
+      feed_nodes.insert(NodeName(feed.first));
+    }
+    TF_RETURN_IF_ERROR(
+        UnrollLoops(item.NodesToPreserve(), feed_nodes, optimized_graph));
+  }
 
   return OkStatus();
 }
@@ -53,9 +53,12 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    // Unrolls while loops with a small constant trip count.
+    bool enable_loop_unrolling = false;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_loop_unrolling = opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
@@ -71,11 +72,89 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyLoopUnrolling(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_dead_branch_removal = false;
+    optimizer->options_.enable_loop_unrolling = true;
+  }
+
+  // Builds the loop
+  //   for (i = 0; i < bound; ++i) x = x * x;
+  // whose Exit nodes are "while/Exit" for i and "while/Exit_1" for x.
+  void BuildSquaringLoop(int bound, GraphDef* graph) const {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output init = ops::Const(s.WithOpName("init"), 0);
+    Output bound_const = ops::Const(s.WithOpName("bound"), bound);
+    Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {2});
+    Output step = ops::Const(s.WithOpName("while/add/y"), 1);
+    TF_CHECK_OK(s.ToGraphDef(graph));
+    for (NodeDef& node : *graph->mutable_node()) {
+      if (node.name() == "while/add/y") {
+        node.add_input("^while/Identity");
+      }
+    }
+
+    const auto attrs = [](DataType type, bool is_enter = false,
+                          bool is_constant = false) {
+      std::vector<std::pair<string, AttrValue>> attributes;
+      AttrValue value;
+      value.set_type(type);
+      attributes.emplace_back("T", value);
+      if (is_enter) {
+        value.set_s("while");
+        attributes.emplace_back("frame_name", value);
+        value.set_b(is_constant);
+        attributes.emplace_back("is_constant", value);
+        value.set_i(10);
+        attributes.emplace_back("parallel_iterations", value);
+      }
+      return attributes;
+    };
+    auto merge_attrs = attrs(DT_INT32);
+    AttrValue n;
+    n.set_i(2);
+    merge_attrs.emplace_back("N", n);
+    auto merge_1_attrs = attrs(DT_FLOAT);
+    merge_1_attrs.emplace_back("N", n);
+
+    AddNode("while/Enter", "Enter", {"init"}, attrs(DT_INT32, true), graph);
+    AddNode("while/Enter_1", "Enter", {"x"}, attrs(DT_FLOAT, true), graph);
+    AddNode("while/Enter_2", "Enter", {"bound"}, attrs(DT_INT32, true, true),
+            graph);
+    AddNode("while/Merge", "Merge", {"while/Enter", "while/NextIteration"},
+            merge_attrs, graph);
+    AddNode("while/Merge_1", "Merge",
+            {"while/Enter_1", "while/NextIteration_1"}, merge_1_attrs, graph);
+    AddNode("while/Less", "Less", {"while/Merge", "while/Enter_2"},
+            attrs(DT_INT32), graph);
+    AddNode("while/LoopCond", "LoopCond", {"while/Less"}, {}, graph);
+    AddNode("while/Switch", "Switch", {"while/Merge", "while/LoopCond"},
+            attrs(DT_INT32), graph);
+    AddNode("while/Switch_1", "Switch", {"while/Merge_1", "while/LoopCond"},
+            attrs(DT_FLOAT), graph);
+    AddNode("while/Identity", "Identity", {"while/Switch:1"}, attrs(DT_INT32),
+            graph);
+    AddNode("while/Identity_1", "Identity", {"while/Switch_1:1"},
+            attrs(DT_FLOAT), graph);
+    AddNode("while/add", "Add", {"while/Identity", "while/add/y"},
+            attrs(DT_INT32), graph);
+    AddNode("while/mul", "Mul", {"while/Identity_1", "while/Identity_1"},
+            attrs(DT_FLOAT), graph);
+    AddNode("while/NextIteration", "NextIteration", {"while/add"},
+            attrs(DT_INT32), graph);
+    AddNode("while/NextIteration_1", "NextIteration", {"while/mul"},
+            attrs(DT_FLOAT), graph);
+    AddNode("while/Exit", "Exit", {"while/Switch"}, attrs(DT_INT32), graph);
+    AddNode("while/Exit_1", "Exit", {"while/Switch_1"}, attrs(DT_FLOAT),
+            graph);
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
     options.enable_stack_push_removal = false;
+    options.enable_loop_unrolling = false;
     optimizer->options_ = options;
   }
 };
@@ -1802,5 +1881,61 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, UnrollLoopWithConstantTripCount) {
+  GrapplerItem item;
+  BuildSquaringLoop(3, &item.graph);
+  item.fetch = {"while/Exit", "while/Exit_1"};
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 2);
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopUnrolling(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The 3 constants, 3 copies of the 5 body nodes and the 2 new Exit nodes.
+  EXPECT_EQ(output.node_size(), 20);
+  for (const NodeDef& node : output.node()) {
+    EXPECT_FALSE(IsEnter(node) || IsMerge(node) || IsSwitch(node) ||
+                 IsLoopCond(node) || IsNextIteration(node) || IsExit(node))
+        << node.name();
+    if (node.name() == "while/Exit") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "while/add/unrolled_2");
+    } else if (node.name() == "while/Exit_1") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "while/mul/unrolled_2");
+    } else if (node.name() == "while/Identity_1/unrolled_0") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "x");
+    } else if (node.name() == "while/add/y/unrolled_1") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "^while/Identity/unrolled_1");
+    }
+  }
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorEqual<int32>(tensors[0], tensors_expected[0]);
+  test::ExpectTensorEqual<float>(tensors[1], tensors_expected[1]);
+  test::ExpectTensorEqual<float>(
+      tensors[1], test::AsTensor<float>({1.0f, 256.0f}, {2}));
+}
+
+TEST_F(LoopOptimizerTest, DoNotUnrollLoopWithLargeTripCount) {
+  GrapplerItem item;
+  BuildSquaringLoop(100, &item.graph);
+  item.fetch = {"while/Exit_1"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopUnrolling(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  VerifyGraphsEqual(item.graph, output, __FUNCTION__);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
@@ -977,13 +978,11 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
-static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
-    std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
-    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+// Infers the memory usage of `item` in `*memory_ptr`, unless already done.
+static bool InferMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                             std::unique_ptr<GraphMemory>* memory_ptr) {
   if ((*memory_ptr) == nullptr) {
-    memory_ptr->reset(new GraphMemory(*item));
+    memory_ptr->reset(new GraphMemory(item));
     Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
     if (!s.ok()) {
       memory_ptr->reset();
@@ -991,6 +990,383 @@ static bool IdentifySwappingCandidates(
       return false;
     }
   }
+  return true;
+}
+
+// Simulates the execution of `item` on the devices of `cluster`, and records
+// the completion time and, if `op_durations` is not null, the execution time
+// of each node.
+static bool EstimateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times,
+    std::unordered_map<string, Costs::NanoSeconds>* op_durations) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+      if (op_durations != nullptr) {
+        op_durations->emplace(
+            node_stats.node_name(),
+            Costs::NanoSeconds(node_stats.op_end_rel_nanos() -
+                               node_stats.op_start_rel_nanos()));
+      }
+    }
+  }
+  return true;
+}
+
+// A tensor consumed by the ops reordered by the OrderingPass.
+struct OrderedTensor {
+  int64_t size = 0;
+  // The number of ops of the window consuming the tensor.
+  int num_consumers = 0;
+  // Whether the tensor is deallocated once its consumers in the window ran,
+  // i.e. it is not a variable, is not fetched and has no other consumers.
+  bool freeable = false;
+};
+
+// An op reordered by the OrderingPass.
+struct OrderedOp {
+  NodeDef* node = nullptr;
+  int64_t output_size = 0;
+  // The size of the outputs without consumers, deallocated right away.
+  int64_t transient_size = 0;
+  // The tensors consumed by the op, without duplicates.
+  std::vector<const OrderedTensor*> inputs;
+  // The ops of the window that depend on this op, and the number of ops of
+  // the window this op depends on.
+  std::vector<int> fanouts;
+  int num_fanins = 0;
+};
+
+using RemainingConsumers = std::unordered_map<const OrderedTensor*, int>;
+
+RemainingConsumers InitRemainingConsumers(
+    const std::unordered_map<string, OrderedTensor>& tensors) {
+  RemainingConsumers remaining;
+  for (const auto& tensor : tensors) {
+    remaining[&tensor.second] = tensor.second.num_consumers;
+  }
+  return remaining;
+}
+
+// Returns the memory allocated by running `op`, minus the memory deallocated
+// once it ran.
+int64_t MemoryDelta(const OrderedOp& op, const RemainingConsumers& remaining) {
+  int64_t delta = op.output_size - op.transient_size;
+  for (const OrderedTensor* input : op.inputs) {
+    if (input->freeable && remaining.at(input) == 1) {
+      delta -= input->size;
+    }
+  }
+  return delta;
+}
+
+// Runs `op`, and returns the memory it deallocates.
+int64_t RunOp(const OrderedOp& op, RemainingConsumers* remaining) {
+  int64_t freed = op.transient_size;
+  for (const OrderedTensor* input : op.inputs) {
+    if (--(*remaining)[input] == 0 && input->freeable) {
+      freed += input->size;
+    }
+  }
+  return freed;
+}
+
+// Returns the peak of the memory allocated while running `ops` in `order`,
+// relative to the memory allocated before.
+int64_t SimulatePeakMemory(
+    const std::vector<int>& order, const std::vector<OrderedOp>& ops,
+    const std::unordered_map<string, OrderedTensor>& tensors) {
+  RemainingConsumers remaining = InitRemainingConsumers(tensors);
+  int64_t usage = 0;
+  int64_t peak = 0;
+  for (int i : order) {
+    usage += ops[i].output_size;
+    peak = std::max(peak, usage);
+    usage -= RunOp(ops[i], &remaining);
+  }
+  return peak;
+}
+
+// Returns the name of the tensor `input` refers to, without the ":0" suffix.
+string CanonicalTensorName(const string& input) {
+  int port = 0;
+  const string node_name = ParseNodeName(input, &port);
+  return port == 0 ? node_name : strings::StrCat(node_name, ":", port);
+}
+
+// Reorders the ops of `device` that complete in [window_start, window_end]
+// in the simulation, so that fewer tensors are live at the same time. Ops
+// are picked greedily among the ready ones, preferring the ops that allocate
+// the least memory once their dead inputs are deallocated. The new order is
+// enforced by control dependencies between the consecutive ops it inverts,
+// if it lowers the peak memory usage of the window by at least 10%.
+bool ReorderCriticalOps(
+    const string& device, Costs::Duration window_start,
+    Costs::Duration window_end,
+    const std::unordered_map<string, Costs::NanoSeconds>& completion_times,
+    const GraphProperties& properties, const VirtualPlacer& placer,
+    GrapplerItem* item) {
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  std::unordered_set<string> fetches;
+  for (const string& fetch : item->fetch) {
+    fetches.insert(CanonicalTensorName(fetch));
+  }
+
+  // Count the consumers of each tensor, and collect the ops of the window in
+  // the order of the simulation.
+  std::unordered_map<string, int> num_consumers;
+  std::unordered_map<string, NodeDef*> name_to_node;
+  std::vector<std::pair<Costs::NanoSeconds, NodeDef*>> window;
+  for (NodeDef& node : *item->graph.mutable_node()) {
+    name_to_node[node.name()] = &node;
+    std::unordered_set<string> inputs;
+    for (const string& input : node.input()) {
+      if (!IsControlInput(input)) {
+        inputs.insert(CanonicalTensorName(input));
+      }
+    }
+    for (const string& input : inputs) {
+      ++num_consumers[input];
+    }
+    if (placer.get_canonical_device_name(node) != device) continue;
+    // The completion times are only estimated to the microsecond.
+    auto it = completion_times.find(node.name());
+    if (it == completion_times.end() ||
+        it->second + Costs::MicroSeconds(1) < window_start ||
+        it->second > window_end + Costs::MicroSeconds(1)) {
+      continue;
+    }
+    window.emplace_back(it->second, &node);
+  }
+  constexpr int kMaxWindowSize = 4096;
+  if (window.size() < 3 || window.size() > kMaxWindowSize) {
+    return false;
+  }
+  std::stable_sort(window.begin(), window.end(),
+                   [](const std::pair<Costs::NanoSeconds, NodeDef*>& a,
+                      const std::pair<Costs::NanoSeconds, NodeDef*>& b) {
+                     return a.first < b.first;
+                   });
+
+  const int num_ops = window.size();
+  std::vector<OrderedOp> ops(num_ops);
+  std::unordered_map<const NodeDef*, int> position;
+  for (int i = 0; i < num_ops; ++i) {
+    ops[i].node = window[i].second;
+    position[ops[i].node] = i;
+  }
+  std::unordered_map<string, OrderedTensor> tensors;
+  for (int i = 0; i < num_ops; ++i) {
+    OrderedOp& op = ops[i];
+    const NodeDef& node = *op.node;
+    const std::vector<OpInfo::TensorProperties>& outputs =
+        properties.GetOutputProperties(node.name());
+    for (int port = 0; port < outputs.size(); ++port) {
+      const int64_t size = CalculateTensorSize(outputs[port]);
+      const string tensor_name = CanonicalTensorName(
+          port == 0 ? node.name() : strings::StrCat(node.name(), ":", port));
+      op.output_size += size;
+      if (num_consumers[tensor_name] == 0 && !fetches.count(tensor_name)) {
+        op.transient_size += size;
+      }
+    }
+
+    std::unordered_set<int> fanins;
+    for (const string& input : node.input()) {
+      auto producer = name_to_node.find(NodeName(input));
+      if (producer == name_to_node.end()) continue;
+      auto it = position.find(producer->second);
+      if (it != position.end() && fanins.insert(it->second).second) {
+        ops[it->second].fanouts.push_back(i);
+        ++op.num_fanins;
+      }
+      if (IsControlInput(input)) continue;
+
+      const string tensor_name = CanonicalTensorName(input);
+      auto inserted = tensors.emplace(tensor_name, OrderedTensor());
+      OrderedTensor& tensor = inserted.first->second;
+      if (inserted.second) {
+        const NodeDef& producer_node = *producer->second;
+        int port = 0;
+        ParseNodeName(input, &port);
+        const std::vector<OpInfo::TensorProperties>& producer_outputs =
+            properties.GetOutputProperties(producer_node.name());
+        if (port < producer_outputs.size()) {
+          tensor.size = CalculateTensorSize(producer_outputs[port]);
+        }
+        tensor.freeable =
+            !IsVariable(producer_node) && !fetches.count(tensor_name) &&
+            placer.get_canonical_device_name(producer_node) == device;
+      }
+      if (std::find(op.inputs.begin(), op.inputs.end(), &tensor) ==
+          op.inputs.end()) {
+        ++tensor.num_consumers;
+        op.inputs.push_back(&tensor);
+      }
+    }
+  }
+  // Tensors with consumers out of the window stay live after it.
+  for (auto& tensor : tensors) {
+    if (tensor.second.num_consumers < num_consumers[tensor.first]) {
+      tensor.second.freeable = false;
+    }
+  }
+
+  // Greedily build a topological order of the window.
+  std::vector<int> order;
+  order.reserve(num_ops);
+  std::vector<int> pending(num_ops);
+  std::set<int> ready;
+  for (int i = 0; i < num_ops; ++i) {
+    pending[i] = ops[i].num_fanins;
+    if (pending[i] == 0) ready.insert(i);
+  }
+  RemainingConsumers remaining = InitRemainingConsumers(tensors);
+  while (!ready.empty()) {
+    int best = -1;
+    int64_t best_delta = 0;
+    for (int i : ready) {
+      const int64_t delta = MemoryDelta(ops[i], remaining);
+      if (best < 0 || delta < best_delta) {
+        best = i;
+        best_delta = delta;
+      }
+    }
+    ready.erase(best);
+    order.push_back(best);
+    RunOp(ops[best], &remaining);
+    for (int fanout : ops[best].fanouts) {
+      if (--pending[fanout] == 0) ready.insert(fanout);
+    }
+  }
+  if (order.size() != num_ops) {
+    VLOG(1) << "Failed to order the ops of " << device;
+    return false;
+  }
+
+  std::vector<int> original_order(num_ops);
+  for (int i = 0; i < num_ops; ++i) original_order[i] = i;
+  const int64_t original_peak =
+      SimulatePeakMemory(original_order, ops, tensors);
+  const int64_t new_peak = SimulatePeakMemory(order, ops, tensors);
+  VLOG(1) << "Reordering " << num_ops << " ops of " << device
+          << " changes their peak memory usage from " << original_peak
+          << " to " << new_peak << " bytes";
+  if (new_peak >= original_peak * 0.9) {
+    return false;
+  }
+
+  bool updated_graph = false;
+  for (int i = 1; i < num_ops; ++i) {
+    const int prev = order[i - 1];
+    const int next = order[i];
+    if (prev < next) continue;
+    NodeDef* node = ops[next].node;
+    if (IsVariable(*node) || IsPlaceholder(*node) ||
+        feeds.count(node->name())) {
+      continue;
+    }
+    const string ctrl_dep = AsControlDependency(ops[prev].node->name());
+    if (std::find(node->input().begin(), node->input().end(), ctrl_dep) !=
+        node->input().end()) {
+      continue;
+    }
+    *node->add_input() = ctrl_dep;
+    updated_graph = true;
+  }
+  return updated_graph;
+}
+
+// Enforces a low peak memory order on the ops that run while the tensors live
+// at the peak memory usage of a device are allocated, for the devices whose
+// peak exceeds 80% of their memory.
+bool OrderingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
+                  GrapplerItem* item) {
+  // Control dependencies can't cross frames, and may make ops dead.
+  for (const NodeDef& node : item->graph.node()) {
+    if (IsControlFlow(node)) {
+      return false;
+    }
+  }
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unique_ptr<GraphProperties> properties;
+  VirtualPlacer placer(cluster->GetDevices());
+  bool updated_graph = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.memory_size() <= 0) {
+      VLOG(1) << "Available memory unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= prop.memory_size() * 0.8 ||
+        mem_usage.live_tensors.empty()) {
+      continue;
+    }
+    Costs::Duration window_start = Costs::Duration::infinity();
+    Costs::Duration window_end = 0;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      window_start = std::min(window_start, live_tensor.allocation_time);
+      window_end = std::max(window_end, live_tensor.deallocation_time);
+    }
+
+    if (properties == nullptr) {
+      if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                           /*op_durations=*/nullptr)) {
+        return updated_graph;
+      }
+      properties = std::make_unique<GraphProperties>(*item);
+      if (!properties
+               ->InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false)
+               .ok()) {
+        return updated_graph;
+      }
+    }
+    if (ReorderCriticalOps(name, window_start, window_end, op_completion_times,
+                           *properties, placer, item)) {
+      updated_graph = true;
+    }
+  }
+  return updated_graph;
+}
+
+static bool IdentifySwappingCandidates(
+    Cluster* cluster, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
   const GraphMemory& memory = **memory_ptr;
 
   bool updated_graph = false;
@@ -1012,29 +1388,9 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                         /*op_durations=*/nullptr)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1146,17 +1502,259 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// A tensor live at the peak memory usage, and the cheapest way to free its
+// memory until its uses after the peak.
+struct MemorySaving {
+  MutableGraphView::OutputPort port;
+  int64_t memory_used;
+  std::vector<MutableGraphView::InputPort> uses_left;
+  bool recompute;
+  // The time added to the step.
+  Costs::NanoSeconds cost;
+
+  bool operator<(const MemorySaving& other) const {
+    // Fewest nanoseconds per byte saved first, i.e. comparing
+    // cost / memory_used without the division.
+    return static_cast<double>(cost.count()) * other.memory_used <
+           static_cast<double>(other.cost.count()) * memory_used;
+  }
+};
+
+// Returns true if the producer of `port` can be run again after the peak
+// memory usage instead of keeping its output, without keeping more memory at
+// the peak: its inputs must be live at the peak anyway.
+static bool IsRecomputable(
+    const MutableGraphView& graph, MutableGraphView::OutputPort port,
+    const std::unordered_set<string>& live_tensors,
+    const std::unordered_set<string>& feeds,
+    const std::unordered_set<string>& skip_list) {
+  const NodeDef& node = *port.node;
+  // Inputs that refer to other outputs of a node are not rewritten by
+  // RecomputeSubgraph(). Identity and Reshape forward the memory of their
+  // input, which is live at the peak.
+  if (port.port_id != 0 || node.op() == "Identity" || node.op() == "Reshape" ||
+      feeds.count(node.name()) != 0 ||
+      skip_list.count(node.name()) != 0 || IsControlFlow(node) ||
+      IsPersistent(node) || !IsFreeOfSideEffect(node)) {
+    return false;
+  }
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) {
+      continue;
+    }
+    const NodeDef* fanin = graph.GetNode(NodeName(input));
+    if (fanin == nullptr) {
+      return false;
+    }
+    const TensorId tensor = ParseTensorName(input);
+    if (!IsPersistent(*fanin) &&
+        live_tensors.count(strings::StrCat(tensor.node(), ":",
+                                           tensor.index())) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Chooses, for each large enough tensor live at the peak memory usage of a GPU
+// beyond its memory, between swapping it to the host, recomputing it for its
+// uses after the peak, or keeping it in memory. The tensors that save the most
+// memory per nanosecond added to the step are picked first, until the peak fits
+// in the memory of the GPU.
+//
+// Swapping costs the time of the transfers that cannot overlap with the ops
+// that run between the producer and the peak, and between the peak and the
+// next use. Recomputing costs the execution time of the producer.
+static bool IdentifyCostBasedCandidates(
+    Cluster* cluster, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap,
+    std::vector<RecomputedSubGraph>* subgraphs_to_recompute) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  bool updated_graph = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    if (prop.memory_size() <= 0) {
+      VLOG(1) << "Peak memory usage unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= prop.memory_size()) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - prop.memory_size();
+
+    std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+    std::unordered_map<string, Costs::NanoSeconds> op_durations;
+    if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                         &op_durations)) {
+      return false;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_tensors.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<MemorySaving> savings;
+    MutableGraphView graph(&item->graph);
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+      MemorySaving saving;
+      saving.port = port;
+      saving.memory_used = live_tensor.memory_used;
+      bool swappable = IsSwappable(graph, port);
+      bool valid = true;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(strings::StrCat(input.node->name(), ":",
+                                            input.port_id)) !=
+                skip_list->end()) {
+          valid = false;
+          break;
+        }
+        swappable = swappable && IsSwappable(input);
+        saving.uses_left.emplace_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || saving.uses_left.empty()) {
+        continue;
+      }
+
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const Costs::NanoSeconds transfer_time(saving.memory_used / 16);
+      const Costs::NanoSeconds swap_cost =
+          std::max<Costs::NanoSeconds>(
+              transfer_time - (peak_time - live_tensor.allocation_time), 0) +
+          std::max<Costs::NanoSeconds>(
+              transfer_time - (earliest_use - peak_time), 0);
+      auto duration = op_durations.find(port.node->name());
+      const bool recomputable =
+          duration != op_durations.end() &&
+          IsRecomputable(graph, port, live_tensors, feeds, *skip_list);
+      if (recomputable && (!swappable || duration->second <= swap_cost)) {
+        saving.recompute = true;
+        saving.cost = duration->second;
+      } else if (swappable) {
+        saving.recompute = false;
+        saving.cost = swap_cost;
+      } else {
+        continue;
+      }
+      savings.push_back(saving);
+    }
+
+    std::sort(savings.begin(), savings.end());
+    for (const MemorySaving& saving : savings) {
+      if (required_savings < 0) {
+        break;
+      }
+      VLOG(1) << "Will " << (saving.recompute ? "recompute" : "swap")
+              << " tensor " << saving.port.node->name() << ":"
+              << saving.port.port_id << " of size " << saving.memory_used
+              << " for " << saving.uses_left.size() << " uses, adding "
+              << saving.cost.count() << "ns";
+      if (saving.recompute) {
+        RecomputedSubGraph subgraph;
+        subgraph.recomputed_source_nodes.insert(saving.port.node);
+        for (const MutableGraphView::InputPort& use : saving.uses_left) {
+          subgraph.target_nodes.insert(use.node);
+        }
+        subgraphs_to_recompute->push_back(std::move(subgraph));
+        // Recompute the tensor only once, and never recompute the copy.
+        skip_list->insert(saving.port.node->name());
+        skip_list->insert(
+            AddPrefixToNodeName(saving.port.node->name(),
+                                kRecomputedNodePrefix));
+      } else {
+        for (const MutableGraphView::InputPort& use : saving.uses_left) {
+          (*nodes_to_swap)[use.node].inputs_to_swap.push_back(use.port_id);
+        }
+      }
+      required_savings -= saving.memory_used;
+      updated_graph = true;
+    }
+  }
+  return updated_graph;
+}
+
+// Recomputes `subgraphs`, whose source nodes are distinct.
+static bool RecomputeSubgraphs(const std::vector<RecomputedSubGraph>& subgraphs,
+                               GraphDef* graph) {
+  std::vector<const NodeDef*> topo_order;
+  if (!ComputeTopologicalOrder(*graph, &topo_order).ok()) {
+    return false;
+  }
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int i = 0; i < topo_order.size(); ++i) {
+    topological_numbering[topo_order[i]] = topo_order.size() - i - 1;
+  }
+  NodeMap node_map(graph);
+  for (const RecomputedSubGraph& subgraph : subgraphs) {
+    RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
+                      node_map, topological_numbering, graph);
+  }
+  return true;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                   Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
-      optimization_level == RewriterConfig::HEURISTICS) {
+      optimization_level == RewriterConfig::HEURISTICS ||
+      optimization_level == RewriterConfig::ORDERING_HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, memory, skip_list,
                                &nodes_to_swap);
   }
+  bool recomputed = false;
+  if (optimization_level == RewriterConfig::COST_BASED_HEURISTICS) {
+    std::vector<RecomputedSubGraph> subgraphs_to_recompute;
+    IdentifyCostBasedCandidates(cluster, item, memory, skip_list,
+                                &nodes_to_swap, &subgraphs_to_recompute);
+    if (!subgraphs_to_recompute.empty()) {
+      recomputed = RecomputeSubgraphs(subgraphs_to_recompute, &item->graph);
+    }
+  }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
     if (node.attr().count("_swap_to_host") != 0) {
@@ -1174,7 +1772,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   }
   if (nodes_to_swap.empty()) {
     // Nothing to do.
-    return false;
+    return recomputed;
   }
 
   // Estimate the size of the data to swap for each node.
@@ -1184,7 +1782,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                             /*aggressive_shape_inference=*/false,
                             /*include_tensor_values=*/false)
            .ok()) {
-    return false;
+    return recomputed;
   }
   for (auto& swap : nodes_to_swap) {
     const NodeDef* node = swap.first;
@@ -1202,7 +1800,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
   if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
-    return false;
+    return recomputed;
   }
 
   std::unordered_map<string, const NodeDef*> name_map;
@@ -1267,7 +1865,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       skip_list->insert(swap_nodes.second->name());
     }
   }
-  return updated_graph;
+  return updated_graph || recomputed;
 }
 
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
@@ -1406,6 +2004,14 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   // SchedulingPass() and SwappingPass() rely on defined fetches in order to
   // infer the memory usage, so skip optimization if there are no fetches.
   std::unique_ptr<GraphMemory> memory;
+  if (optimization_level_ == RewriterConfig::ORDERING_HEURISTICS &&
+      !item.fetch.empty() && cluster != nullptr) {
+    if (OrderingPass(cluster, &memory, &optimized_item)) {
+      // Reset the inferred memory usage since the graph changed.
+      memory.reset();
+    }
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+  }
   if (!item.fetch.empty() && cluster != nullptr) {
     bool updated_graph = true;
     for (int i = 0; i < 25 && updated_graph; ++i) {
@@ -1413,7 +2019,9 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       updated_graph = false;
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
-           optimization_level_ == RewriterConfig::HEURISTICS) &&
+           optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::COST_BASED_HEURISTICS ||
+           optimization_level_ == RewriterConfig::ORDERING_HEURISTICS) &&
           cluster != nullptr) {
         if (SchedulingPass(cluster, &memory, &optimized_item)) {
           // Reset the inferred memory usage since the graph changed.
@@ -1426,6 +2034,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::COST_BASED_HEURISTICS ||
+           optimization_level_ == RewriterConfig::ORDERING_HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
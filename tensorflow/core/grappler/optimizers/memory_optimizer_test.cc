@@ -346,6 +346,99 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, CostBasedRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g"};
+  item.init_ops = {init.name()};
+
+  // With a fast GPU, recomputing b costs less than the transfers to and from
+  // the host, which cannot overlap with the few ops around the peak.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  std::unordered_map<string, DeviceProperties> devices =
+      cluster->GetDevices();
+  for (auto& device : devices) {
+    device.second.set_bandwidth(1000 * 1000 * 1000);
+  }
+  cluster = std::make_unique<VirtualCluster>(devices);
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED_HEURISTICS);
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_b = node_map.GetNode("Recomputed/b");
+  ASSERT_NE(nullptr, recomputed_b);
+  EXPECT_EQ("Square", recomputed_b->op());
+  EXPECT_EQ("v", recomputed_b->input(0));
+  EXPECT_EQ("Recomputed/b", node_map.GetNode("g")->input(0));
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
+TEST_F(MemoryOptimizerTest, OrderingHeuristics) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 7}, DT_FLOAT);
+  Output a1 = ops::Square(s.WithOpName("a1").WithDevice("/gpu:0"), v);
+  Output a2 = ops::Sqrt(s.WithOpName("a2").WithDevice("/gpu:0"), v);
+  Output axis = ops::Const(s.WithOpName("axis").WithDevice("/gpu:0"),
+                           {0, 1, 2}, {3});
+  Output b1 = ops::Sum(s.WithOpName("b1").WithDevice("/gpu:0"), a1, axis);
+  Output b2 = ops::Sum(s.WithOpName("b2").WithDevice("/gpu:0"), a2, axis);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"b1", "b2"};
+
+  // The simulation runs a1 and a2 before reducing either of them, which
+  // keeps both live. Running b1 before a2 avoids that.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  MemoryOptimizer optimizer(RewriterConfig::ORDERING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* new_a2 = node_map.GetNode("a2");
+  ASSERT_NE(nullptr, new_a2);
+  ASSERT_EQ(2, new_a2->input_size());
+  EXPECT_EQ("v", new_a2->input(0));
+  EXPECT_EQ("^b1", new_a2->input(1));
+  EXPECT_EQ(2, node_map.GetNode("b1")->input_size());
+
+  // The order is already enforced the second time.
+  GrapplerItem optimized_item = item.WithGraph(std::move(output));
+  GraphDef second_output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), optimized_item,
+                                  &second_output));
+  NodeMap second_node_map(&second_output);
+  EXPECT_EQ(2, second_node_map.GetNode("a2")->input_size());
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -17,10 +17,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -49,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -62,7 +66,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -103,6 +110,15 @@ int NumIterations(const RewriterConfig& cfg) {
              : cfg.meta_optimizer_iterations();
 }
 
+// The default maximum number of threads optimizing functions concurrently.
+constexpr int kMaxFunctionThreads = 16;
+
+int NumFunctionThreads(const RewriterConfig& cfg) {
+  return cfg.meta_optimizer_function_threads() > 0
+             ? cfg.meta_optimizer_function_threads()
+             : std::min(port::MaxParallelism(), kMaxFunctionThreads);
+}
+
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
@@ -883,7 +899,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -938,10 +957,13 @@ Status MetaOptimizer::RunOptimizer(
       {kGrapplerCategory, optimizer->name()});
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
-  auto duration_ms = timings.DurationMicroSec().value() / 1000.0f;
+  const int64_t duration_us = timings.DurationMicroSec().value();
+  auto duration_ms = duration_us / 1000.0f;
   timings.ReportAndStop();
 
   string message;
+  OptimizerResult optimizer_result{optimizer->name(), "", OkStatus(),
+                                   duration_us};
   if (!status.ok()) {
     *optimized_graph = std::move(optimized_item->graph);
     if (absl::IsAborted(status)) {
@@ -965,6 +987,18 @@ Status MetaOptimizer::RunOptimizer(
         PrintSizesBeforeAfter(optimized_item->graph, *optimized_graph),
         ", time = ", duration_ms, "ms.");
     VLOG(1) << optimizer->name() << ": " << message;
+    // The serialized size of the graph is a cheap estimate of the memory it
+    // keeps alive, e.g. the constants.
+    optimizer_result.num_nodes_delta =
+        optimized_graph->node_size() - optimized_item->graph.node_size();
+    optimizer_result.num_edges_delta =
+        NumEdges(*optimized_graph) - NumEdges(optimized_item->graph);
+    optimizer_result.memory_bytes_delta =
+        static_cast<int64_t>(optimized_graph->ByteSizeLong()) -
+        static_cast<int64_t>(optimized_item->graph.ByteSizeLong());
+    metrics::UpdateGrapplerPassGraphDelta(
+        optimizer->name(), optimizer_result.num_nodes_delta,
+        optimizer_result.num_edges_delta, optimizer_result.memory_bytes_delta);
   }
 
   // Swap function library back into the main graph.
@@ -973,7 +1007,8 @@ Status MetaOptimizer::RunOptimizer(
         optimized_graph_function_library.release());
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  optimizer_result.message = message;
+  optimizer_result.status = status;
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok()) {
@@ -1043,6 +1078,66 @@ void PropagateTFDataAttrs(const FunctionLibraryDefinition& flib,
   }
 }
 
+Status MetaOptimizer::OptimizeFunction(
+    Cluster* cluster, const FunctionDef& func,
+    const FunctionLibraryDefinition& flib, int producer,
+    bool allow_non_differentiable_rewrites, bool is_tpu_graph,
+    GrapplerFunctionItem* func_item, GraphDef* optimized_func_graph) {
+  GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+
+  // Make a GrapplerItem from a FunctionDef.
+  TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+  // If we need to compute the gradient of optimized function at runtime, we
+  // can't perform non-differentiable rewrites.
+  func_item->optimization_options().allow_non_differentiable_rewrites =
+      allow_non_differentiable_rewrites;
+
+  // Device set available to the function is defined only by the runtime,
+  // when we instantiate and execute the function. We can't use all devices
+  // available to the main graph, because after partitioning the function
+  // call node might execute on a remote worker.
+  if (!func_item->devices().empty()) {
+    return errors::Internal("GrapplerFunctionItem devices must be empty.");
+  }
+
+  // We are not allowed to prune certain types of ops from the graph
+  // instantiated by the function definition, because we must guarantee
+  // function execution semantics wrt side effects (see
+  // function_optimizer.cc).
+  func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+      false;
+
+  // Optimize function body graph.
+  if (is_tpu_graph) {
+    // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+    // passes do not handle TPU functions correctly in a variety of ways
+    // (Note that due to the pre-placement TPU graph rewriting passes, the
+    // TPU-related ops are encapsulated away into functions). For example,
+    // TPU graphs contain TPUReplicateMetadata node that carries relevant
+    // TPU metadata and Grappler passes could prune that away. Grappler
+    // passes could also cause issues around shape inference. Since the
+    // desired and existing behavior is to not optimize TPU functions with
+    // Grappler, this check preserves that. The only exception is
+    // implementation selector what is required to swap in some TPU specific
+    // lowering code and is verified the work correctly on TPUs.
+    ImplementationSelector implementation_selector;
+
+    // Implementation selector needs to have access to valid function
+    // signature and attributes, and it doesn't need actual function body.
+    std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+        func_item->graph.release_library());
+    *func_item->graph.mutable_library() =
+        GetFunctionDefLibraryStub(*func_item_function_library);
+
+    return implementation_selector.Optimize(cluster, *func_item,
+                                            optimized_func_graph);
+  }
+  GrapplerFunctionItem func_item_copy = *func_item;
+  return OptimizeGraph(cluster, std::move(func_item_copy),
+                       optimized_func_graph);
+}
+
 Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                                           GraphDef* optimized_graph) {
   tensorflow::metrics::ScopedCounter<2> timings(
@@ -1074,6 +1169,18 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  std::unique_ptr<MetaOptimizerCache> cache;
+  string cache_key;
+  if (!cfg_.meta_optimizer_cache_dir().empty()) {
+    cache =
+        std::make_unique<MetaOptimizerCache>(cfg_.meta_optimizer_cache_dir());
+    cache_key = MetaOptimizerCache::Key(item, cluster, config_proto_);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Read the optimized graph from the cache: " << cache_key;
+      return OkStatus();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1163,11 +1270,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1187,75 +1293,78 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
-      // Function optimization might specialize nested function calls, so we
-      // have to reset the flag and do at least one more pass over the library.
-      optimize_function_library = true;
+      funcs.push_back(&func);
+    }
+    if (funcs.empty()) break;
+
+    // Function optimization might specialize nested function calls, so we
+    // have to do at least one more pass over the library.
+    optimize_function_library = true;
+    absl::flat_hash_map<string, int> func_index;
+    for (int i = 0; i < funcs.size(); ++i) {
+      const string& func_name = funcs[i]->signature().name();
       optimized_funcs.insert(func_name);
+      func_index[func_name] = i;
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    // The functions are optimized concurrently against the library as of the
+    // start of this pass, and the results are merged into the library in the
+    // library order, so the optimized library does not depend on the thread
+    // scheduling.
+    std::vector<GrapplerFunctionItem> func_items(funcs.size());
+    std::vector<GraphDef> optimized_func_graphs(funcs.size());
+    std::vector<Status> statuses(funcs.size());
+    const auto optimize_function = [&](int i) {
+      const string& func_name = funcs[i]->signature().name();
+      VLOG(3) << "Optimize function: function=" << func_name << " [" << i
+              << " of " << funcs.size() << "]";
+      statuses[i] = OptimizeFunction(
+          cluster, *funcs[i], flib, producer,
+          /*allow_non_differentiable_rewrites=*/
+          !differentiable_functions.contains(func_name), is_tpu_graph,
+          &func_items[i], &optimized_func_graphs[i]);
+    };
+    size_t first_result;
+    {
+      mutex_lock l(results_mu_);
+      first_result = optimization_results_.size();
+    }
+    const int num_threads = std::min(NumFunctionThreads(cfg_),
+                                     static_cast<int>(funcs.size()));
+    if (num_threads <= 1) {
+      for (int i = 0; i < funcs.size(); ++i) optimize_function(i);
+    } else {
+      thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                              num_threads);
+      BlockingCounter counter(funcs.size());
+      for (int i = 0; i < funcs.size(); ++i) {
+        pool.Schedule([&optimize_function, &counter, i]() {
+          optimize_function(i);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
+    }
+    {
+      mutex_lock l(results_mu_);
+      std::stable_sort(
+          optimization_results_.begin() + first_result,
+          optimization_results_.end(),
+          [&func_index](const GraphOptimizationResult& a,
+                        const GraphOptimizationResult& b) {
+            return gtl::FindWithDefault(func_index, a.id, -1) <
+                   gtl::FindWithDefault(func_index, b.id, -1);
+          });
+    }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
-      }
+    for (int i = 0; i < funcs.size(); ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      const string func_name = funcs[i]->signature().name();
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           optimized_func_graphs[i].library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
@@ -1263,17 +1372,15 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      func_items[i].SwapFunctionBody(std::move(optimized_func_graphs[i]));
+      TF_RETURN_IF_ERROR(MakeFunctionDef(func_items[i], flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
       TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
-    // If optimized at least one function, update the graph library.
-    if (optimize_function_library) {
-      *optimized_graph->mutable_library() = flib.ToProto();
-    }
+    // Update the graph library with the optimized functions.
+    *optimized_graph->mutable_library() = flib.ToProto();
   }
 
   // Run module-level TFG optimizations at the end of the meta-optimizer.
@@ -1301,6 +1408,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   }
 #endif
 
+  if (cache != nullptr) {
+    cache->Insert(cache_key, *optimized_graph);
+  }
+
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
@@ -1330,6 +1441,23 @@ string MetaOptimizer::GetResultString() const {
 
 void MetaOptimizer::PrintResult() { VLOG(1) << GetResultString(); }
 
+void MetaOptimizer::GetPassStats(
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats)
+    const {
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    for (const OptimizerResult& result : graph_result.results) {
+      RunMetadata::GrapplerPassStats* stats = pass_stats->Add();
+      stats->set_item_id(graph_result.id);
+      stats->set_optimizer_name(result.optimizer_name);
+      stats->set_wall_time_us(result.wall_time_us);
+      stats->set_num_nodes_delta(result.num_nodes_delta);
+      stats->set_num_edges_delta(result.num_edges_delta);
+      stats->set_memory_bytes_delta(result.memory_bytes_delta);
+      stats->set_ok(result.status.ok());
+    }
+  }
+}
+
 bool MetaOptimizerEnabled(const ConfigProto& cfg) {
   const auto& rewrite_cfg = cfg.graph_options().rewrite_options();
   if (rewrite_cfg.disable_meta_optimizer()) {
@@ -1361,14 +1489,17 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          !rewrite_cfg.custom_optimizers().empty();
 }
 
-Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
-                        DeviceBase* cpu_device, Cluster* cluster,
-                        GraphDef* optimized_graph) {
+Status RunMetaOptimizer(
+    GrapplerItem&& item, const ConfigProto& cfg, DeviceBase* cpu_device,
+    Cluster* cluster, GraphDef* optimized_graph,
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats) {
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  Status status = optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                optimized_graph);
+  if (pass_stats != nullptr) optimizer.GetPassStats(pass_stats);
+  return status;
 }
 
 Status OptimizeGraph(
@@ -22,8 +22,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -54,6 +56,12 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintResult();
 
+  // Appends the results of the passes run by the last optimization, for the
+  // main graph and the functions, in the order they ran.
+  void GetPassStats(
+      protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats)
+      const;
+
  private:
   std::unique_ptr<GraphOptimizer> MakeNewOptimizer(
       const string& optimizer, const std::set<string>& device_types) const;
@@ -97,6 +105,14 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                        GraphDef* optimized_graph);
 
+  // Makes a GrapplerFunctionItem from `func` and optimizes its body. May be
+  // called concurrently for the functions of the library.
+  Status OptimizeFunction(Cluster* cluster, const FunctionDef& func,
+                          const FunctionLibraryDefinition& flib, int producer,
+                          bool allow_non_differentiable_rewrites,
+                          bool is_tpu_graph, GrapplerFunctionItem* func_item,
+                          GraphDef* optimized_func_graph);
+
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
@@ -106,6 +122,11 @@ class MetaOptimizer : public GraphOptimizer {
     string optimizer_name;
     string message;
     Status status;
+    int64_t wall_time_us = 0;
+    // The changes to the graph, zero if the optimizer failed.
+    int64_t num_nodes_delta = 0;
+    int64_t num_edges_delta = 0;
+    int64_t memory_bytes_delta = 0;
   };
 
   struct GraphOptimizationResult {
@@ -118,6 +139,8 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Guards optimization_results_ while functions are optimized concurrently.
+  mutex results_mu_;
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
@@ -129,9 +152,13 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg);
 // during constant folding; if NULL, a new device is created for doing constant
 // folding. For performance, it is recommended to pass in an existing cpu_device
 // when possible.
-Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
-                        DeviceBase* cpu_device, Cluster* cluster,
-                        GraphDef* optimized_graph);
+//
+// If <pass_stats> is non-null, the results of the passes are appended to it.
+Status RunMetaOptimizer(
+    GrapplerItem&& item, const ConfigProto& cfg, DeviceBase* cpu_device,
+    Cluster* cluster, GraphDef* optimized_graph,
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats>* pass_stats =
+        nullptr);
 
 // Wrapper around RunMetaOptimizer convenient for optimizing
 // function graphs.
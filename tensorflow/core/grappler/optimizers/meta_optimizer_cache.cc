@@ -0,0 +1,165 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void AppendField(absl::string_view field, string* key) {
+  absl::StrAppend(key, field.size(), ":", field, ";");
+}
+
+void AppendProto(const protobuf::MessageLite& proto, string* key) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, key);
+}
+
+template <typename Container>
+void AppendSorted(const Container& fields, string* key) {
+  std::vector<string> sorted(fields.begin(), fields.end());
+  std::sort(sorted.begin(), sorted.end());
+  AppendField(absl::StrCat(sorted.size()), key);
+  for (const string& field : sorted) AppendField(field, key);
+}
+
+template <typename Container>
+void AppendInOrder(const Container& fields, string* key) {
+  AppendField(absl::StrCat(fields.size()), key);
+  for (const string& field : fields) AppendField(field, key);
+}
+
+}  // namespace
+
+MetaOptimizerCache::MetaOptimizerCache(const string& dir, Env* env)
+    : dir_(dir), env_(env) {}
+
+/*static*/ string MetaOptimizerCache::Key(const GrapplerItem& item,
+                                          const Cluster* cluster,
+                                          const ConfigProto& config) {
+  string key;
+  AppendField(TF_VERSION_STRING, &key);
+  AppendField(absl::StrCat(TF_GRAPH_DEF_VERSION), &key);
+  AppendProto(item.graph, &key);
+
+  AppendField(absl::StrCat(item.feed.size()), &key);
+  for (const auto& feed : item.feed) {
+    AppendField(feed.first, &key);
+    TensorProto tensor;
+    feed.second.AsProtoTensorContent(&tensor);
+    AppendProto(tensor, &key);
+  }
+  AppendInOrder(item.fetch, &key);
+  AppendInOrder(item.init_ops, &key);
+  AppendInOrder(item.keep_ops, &key);
+  AppendField(item.save_op, &key);
+  AppendField(item.restore_op, &key);
+  AppendField(item.save_restore_loc_tensor, &key);
+  AppendField(absl::StrCat(item.queue_runners.size()), &key);
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendProto(queue_runner, &key);
+  }
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  AppendField(absl::StrCat(options.allow_non_differentiable_rewrites,
+                           options.allow_pruning_stateful_and_dataset_ops,
+                           options.optimize_function_library,
+                           options.is_eager_mode, ",",
+                           options.intra_op_parallelism_threads),
+              &key);
+  AppendSorted(item.devices(), &key);
+
+  if (cluster != nullptr) {
+    std::vector<std::pair<string, DeviceProperties>> devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    std::sort(devices.begin(), devices.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    AppendField(absl::StrCat(devices.size()), &key);
+    for (const auto& [name, properties] : devices) {
+      AppendField(name, &key);
+      AppendProto(properties, &key);
+    }
+  }
+
+  // The location of the cache does not change the result.
+  ConfigProto key_config = config;
+  key_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_meta_optimizer_cache_dir();
+  AppendProto(key_config, &key);
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+string MetaOptimizerCache::Path(const string& key) const {
+  return io::JoinPath(dir_, absl::StrCat(key, ".pb"));
+}
+
+bool MetaOptimizerCache::Lookup(const string& key,
+                                GraphDef* optimized_graph) const {
+  const string path = Path(key);
+  if (!env_->FileExists(path).ok()) return false;
+  GraphDef graph;
+  Status s = ReadBinaryProto(env_, path, &graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring the unreadable optimized graph " << path << ": "
+                 << s;
+    return false;
+  }
+  *optimized_graph = std::move(graph);
+  return true;
+}
+
+void MetaOptimizerCache::Insert(const string& key,
+                                const GraphDef& optimized_graph) const {
+  const string path = Path(key);
+  // The temporary file is in the same directory, so that it can be renamed.
+  const string tmp_path = absl::StrCat(path, ".tmp.", random::New64());
+  Status s = env_->RecursivelyCreateDir(dir_);
+  if (s.ok()) {
+    s = WriteBinaryProto(env_, tmp_path, optimized_graph);
+  }
+  if (s.ok()) {
+    s = env_->RenameFile(tmp_path, path);
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to cache the optimized graph in " << path << ": "
+                 << s;
+    env_->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
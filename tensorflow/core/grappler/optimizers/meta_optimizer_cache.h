@@ -0,0 +1,69 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class Cluster;
+struct GrapplerItem;
+
+// An on-disk cache of the graphs optimized by the MetaOptimizer, shared by all
+// the processes that use the same directory, e.g. the replicas of a model
+// server loading the same SavedModel.
+//
+// The entries are keyed by a fingerprint of everything the result depends
+// on: the graph and its function library, the nodes to preserve, the
+// devices, the configuration and the TensorFlow version. They are written
+// atomically, so a concurrent reader either misses or reads a whole graph.
+// Builds of the same version with different optimizers must not share a
+// directory.
+class MetaOptimizerCache {
+ public:
+  explicit MetaOptimizerCache(const string& dir, Env* env = Env::Default());
+
+  // Returns the key of the optimized graph of `item` on `cluster`, which may
+  // be null, with `config`.
+  static string Key(const GrapplerItem& item, const Cluster* cluster,
+                    const ConfigProto& config);
+
+  // Sets `optimized_graph` and returns true if the cache has an entry for
+  // `key`.
+  bool Lookup(const string& key, GraphDef* optimized_graph) const;
+
+  // Stores `optimized_graph` for `key`. Errors are only logged, as the cache
+  // is best effort.
+  void Insert(const string& key, const GraphDef& optimized_graph) const;
+
+ private:
+  string Path(const string& key) const;
+
+  const string dir_;
+  Env* const env_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
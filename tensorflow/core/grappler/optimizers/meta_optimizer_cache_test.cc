@@ -0,0 +1,90 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+GrapplerItem MakeItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+TEST(MetaOptimizerCacheTest, KeyDependsOnItemAndConfig) {
+  const GrapplerItem item = MakeItem();
+  ConfigProto config;
+  const string key = MetaOptimizerCache::Key(item, nullptr, config);
+  EXPECT_EQ(key, MetaOptimizerCache::Key(MakeItem(), nullptr, config));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("other");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_fetch, nullptr, config));
+
+  GrapplerItem other_graph = item;
+  other_graph.graph.mutable_node(0)->set_name("other");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_graph, nullptr, config));
+
+  ConfigProto other_config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerCache::Key(item, nullptr, other_config));
+
+  // The location of the cache is not part of the key.
+  ConfigProto cache_config;
+  cache_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_meta_optimizer_cache_dir("/some/dir");
+  EXPECT_EQ(key, MetaOptimizerCache::Key(item, nullptr, cache_config));
+}
+
+TEST(MetaOptimizerCacheTest, LooksUpInsertedGraphs) {
+  const string dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache_test");
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  MetaOptimizerCache cache(dir);
+  const GrapplerItem item = MakeItem();
+  const string key = MetaOptimizerCache::Key(item, nullptr, ConfigProto());
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(key, &graph));
+  cache.Insert(key, item.graph);
+  ASSERT_TRUE(cache.Lookup(key, &graph));
+  EXPECT_EQ(item.graph.DebugString(), graph.DebugString());
+
+  // Another instance on the same directory shares the entries.
+  MetaOptimizerCache other_cache(dir);
+  EXPECT_TRUE(other_cache.Lookup(key, &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
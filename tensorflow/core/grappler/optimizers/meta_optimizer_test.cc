@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <atomic>
+#include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -420,6 +422,64 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  using test::function::NDef;
+
+  // Define a library of functions MyTimesTwo<i>(x) = x * 2, and a graph
+  // calling each of them.
+  constexpr int kNumFunctions = 8;
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string func_name = absl::StrCat("MyTimesTwo", i);
+    FunctionDef func = FunctionDefHelper::Create(
+        func_name, {"x:float"}, {"z:float"}, {},
+        {{{"two"}, "Const", {}, {{"value", 2.0f}, {"dtype", DT_FLOAT}}},
+         {{"mul"}, "Mul", {"x", "two:output:0"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "mul:z:0"}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(func);
+    nodes.push_back(
+        NDef(absl::StrCat("call", i), func_name, {"a"}, {}, kDevice));
+  }
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+  for (int i = 0; i < kNumFunctions; ++i) {
+    item.fetch.push_back(absl::StrCat("call", i));
+  }
+
+  // The optimized library and the order of the results do not depend on the
+  // number of threads.
+  const auto optimize = [&item](int num_threads, GraphDef* output,
+                                std::vector<string>* item_ids) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.add_optimizers("arithmetic");
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_disable_tfg_optimizer(true);
+    rewriter_config.set_meta_optimizer_function_threads(num_threads);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, output));
+    protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats> pass_stats;
+    optimizer.GetPassStats(&pass_stats);
+    for (const auto& stats : pass_stats) item_ids->push_back(stats.item_id());
+  };
+  GraphDef output_1, output_4;
+  std::vector<string> item_ids_1, item_ids_4;
+  optimize(1, &output_1, &item_ids_1);
+  optimize(4, &output_4, &item_ids_4);
+
+  EXPECT_EQ(output_1.library().function_size(), kNumFunctions);
+  EXPECT_EQ(output_1.library().DebugString(), output_4.library().DebugString());
+  EXPECT_EQ(item_ids_1, item_ids_4);
+  EXPECT_EQ(item_ids_1.size(), kNumFunctions + 1);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -1033,6 +1093,42 @@ TEST_F(MetaOptimizerTest, CompressConstants) {
   }
 }
 
+TEST_F(MetaOptimizerTest, ReportsPassStats) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(scope.WithOpName("x"), 1.0f, {16});
+  Output id1 = ops::Identity(scope.WithOpName("id1"), x);
+  Output id2 = ops::Identity(scope.WithOpName("id2"), id1);
+  GrapplerItem item;
+  item.id = "main";
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch = {"id2"};
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("pruning");
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_disable_tfg_optimizer(true);
+  MetaOptimizer optimizer(/*cpu_device=*/nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+  EXPECT_EQ(output.node_size(), 2);
+
+  protobuf::RepeatedPtrField<RunMetadata::GrapplerPassStats> pass_stats;
+  optimizer.GetPassStats(&pass_stats);
+  ASSERT_EQ(pass_stats.size(), 1);
+  const RunMetadata::GrapplerPassStats& stats = pass_stats.Get(0);
+  EXPECT_EQ(stats.item_id(), "main");
+  EXPECT_EQ(stats.optimizer_name(), "model_pruner");
+  EXPECT_TRUE(stats.ok());
+  EXPECT_GE(stats.wall_time_us(), 0);
+  // Removing `id1` drops a node and an edge.
+  EXPECT_EQ(stats.num_nodes_delta(), -1);
+  EXPECT_EQ(stats.num_edges_delta(), -1);
+  EXPECT_LT(stats.memory_bytes_delta(), 0);
+}
+
 TEST_F(MetaOptimizerTest, TestTFGRemoveDeadArguments) {
   using test::function::NDef;
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdlib>
+#include <iterator>
 #include <map>
 #include <set>
 #include <string>
@@ -24,7 +25,11 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -33,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/pattern_utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
@@ -91,6 +97,9 @@ constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kResourceApplyAdam[] = "ResourceApplyAdam";
+constexpr char kResourceApplyAdamMulti[] = "ResourceApplyAdamMulti";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
@@ -123,6 +132,7 @@ struct RemapperContext {
   bool inferred_graph_properties;
   RewriterConfig::CpuLayout cpu_layout_conversion;
   bool xla_auto_clustering_on;
+  bool fuse_elementwise_chains = false;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -167,6 +177,19 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of elementwise ops that can be replaced with a _FusedElementwise.
+struct FusedElementwise {
+  FusedElementwise() = default;
+
+  int root = kMissingIndex;
+  string input;
+  // One of the operands of each binary op, in the order of the chain.
+  std::vector<string> args;
+  std::vector<string> fused_ops;
+  // The nodes of the chain other than the root.
+  std::vector<int> fused_nodes;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2675,6 +2698,152 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns true if chains of elementwise ops on CPU should be fused.
+bool ElementwiseChainFusionEnabled() {
+  bool is_enabled = false;
+  TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+      "TF_REMAPPER_FUSE_ELEMENTWISE_CHAINS", /*default_val=*/false,
+      &is_enabled));
+  return is_enabled;
+}
+
+// WARN: This should be consistent with fused_elementwise_op.cc.
+bool IsFusableUnaryOp(const string& op) {
+  static const auto* ops = new absl::flat_hash_set<string>(
+      {"Abs", "Ceil", "Cos", "Exp", "Expm1", "Floor", "Inv", "Log", "Log1p",
+       "Neg", "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt", "Sigmoid", "Sin",
+       "Sqrt", "Square", "Tanh"});
+  return ops->contains(op);
+}
+
+// Returns true if `op` is a binary op that _FusedElementwise supports, and
+// sets `commutative` to whether the result of the chain can be its second
+// operand.
+bool IsFusableBinaryOp(const string& op, bool* commutative) {
+  static const auto* commutative_ops = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Maximum", "Minimum", "Mul", "SquaredDifference"});
+  static const auto* other_ops =
+      new absl::flat_hash_set<string>({"Div", "RealDiv", "Sub"});
+  *commutative = commutative_ops->contains(op);
+  return *commutative || other_ops->contains(op);
+}
+
+// Returns true if `node` can be part of a _FusedElementwise of type `dtype`.
+bool IsFusableElementwise(const NodeDef& node, DataType dtype) {
+  if (GetDataTypeFromAttr(node, "T") != dtype || !NodeIsOnCpu(&node)) {
+    return false;
+  }
+  if (node.op() == "_UnaryOpsComposition") {
+    std::vector<string> op_names;
+    return TryGetNodeAttr(node, "op_names", &op_names) &&
+           absl::c_all_of(op_names, IsFusableUnaryOp);
+  }
+  bool commutative;
+  return IsFusableUnaryOp(node.op()) ||
+         IsFusableBinaryOp(node.op(), &commutative);
+}
+
+// Finds the input of an elementwise op that the chain continues through. For
+// a binary op, it must have the shape of the output, and the other input must
+// have the same shape or be a scalar.
+bool FindElementwiseChainPort(const RemapperContext& ctx,
+                              const utils::MutableNodeView& node_view,
+                              int* port) {
+  const NodeDef* node = node_view.node();
+  bool commutative;
+  if (!IsFusableBinaryOp(node->op(), &commutative)) {
+    *port = 0;
+    return node_view.NumRegularFanins() == 1;
+  }
+  if (node_view.NumRegularFanins() != 2) return false;
+  const auto& inputs = ctx.graph_properties.GetInputProperties(node->name());
+  const auto& outputs = ctx.graph_properties.GetOutputProperties(node->name());
+  if (inputs.size() != 2 || outputs.size() != 1) return false;
+  const TensorShapeProto& output_shape = outputs[0].shape();
+  const auto is_chain_port = [&](int p) {
+    const TensorShapeProto& arg_shape = inputs[1 - p].shape();
+    const bool arg_is_scalar = NumCoefficients(arg_shape) == 1 &&
+                               Rank(arg_shape) <= Rank(output_shape);
+    return ShapesSymbolicallyEqual(inputs[p].shape(), output_shape) &&
+           (arg_is_scalar || ShapesSymbolicallyEqual(arg_shape, output_shape));
+  };
+  const bool port_0 = is_chain_port(0);
+  const bool port_1 = commutative && is_chain_port(1);
+  // Follow the input that extends the chain, if only one does.
+  const DataType dtype = GetDataTypeFromAttr(*node, "T");
+  if (port_0 && port_1 &&
+      !IsFusableElementwise(*node_view.GetRegularFanin(0).node_view()->node(),
+                            dtype)) {
+    *port = 1;
+    return true;
+  }
+  *port = port_0 ? 0 : 1;
+  return port_0 || port_1;
+}
+
+// Finds the longest chain of elementwise ops ending in `node_index`, where
+// every op but the last one only feeds the next one.
+bool FindFusedElementwise(const RemapperContext& ctx, int node_index,
+                          FusedElementwise* matched) {
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root = root_view->node();
+  const DataType dtype = GetDataTypeFromAttr(*root, "T");
+  if ((dtype != DT_FLOAT && dtype != DT_HALF && dtype != DT_DOUBLE) ||
+      !IsFusableElementwise(*root, dtype) ||
+      HasControlFaninOrFanout(*root_view)) {
+    return false;
+  }
+
+  // The nodes and the ports of their chain inputs, from the root.
+  std::vector<std::pair<const utils::MutableNodeView*, int>> chain;
+  const utils::MutableNodeView* node_view = root_view;
+  while (true) {
+    int port;
+    if (!FindElementwiseChainPort(ctx, *node_view, &port)) break;
+    const auto& fanin = node_view->GetRegularFanin(port);
+    const NodeDef* input = fanin.node_view()->node();
+    // Leave activations of contractions and batch norms to their fusions.
+    if (node_view->NumRegularFanins() == 1 &&
+        (IsConvOrMatMul(*input) || IsBiasAdd(*input) ||
+         IsFusedBatchNorm(*input))) {
+      break;
+    }
+    chain.emplace_back(node_view, port);
+    const auto* input_view = fanin.node_view();
+    if (fanin.index() != 0 || !IsFusableElementwise(*input, dtype) ||
+        HasControlFaninOrFanout(*input_view) ||
+        !HasAtMostOneFanoutAtPort0(*input_view) ||
+        IsInPreserveSet(ctx, input) || input->device() != root->device()) {
+      break;
+    }
+    node_view = input_view;
+  }
+  if (chain.size() < 2) return false;
+
+  FusedElementwise pattern;
+  pattern.root = node_index;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const NodeDef* node = it->first->node();
+    const int port = it->second;
+    if (it == chain.rbegin()) pattern.input = node->input(port);
+    if (node->op() == "_UnaryOpsComposition") {
+      std::vector<string> op_names;
+      TF_CHECK_OK(GetNodeAttr(*node, "op_names", &op_names));
+      absl::c_copy(op_names, std::back_inserter(pattern.fused_ops));
+    } else {
+      pattern.fused_ops.push_back(node->op());
+    }
+    if (it->first->NumRegularFanins() == 2) {
+      pattern.args.push_back(node->input(1 - port));
+    }
+    if (it->first != root_view) {
+      pattern.fused_nodes.push_back(it->first->node_index());
+    }
+  }
+  *matched = std::move(pattern);
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -4289,6 +4458,39 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const NodeDef& root = ctx->graph_view.graph()->node(matched.root);
+  VLOG(2) << "Fuse elementwise ops: root=" << root.name() << " fused_ops=["
+          << absl::StrJoin(matched.fused_ops, ", ") << "]";
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  fused_op.add_input(matched.input);  // 0: input
+  for (const string& arg : matched.args) fused_op.add_input(arg);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.root] = true;
+  for (int node_index : matched.fused_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4618,6 +4820,132 @@ Status ReplaceSoftplusTanhAndMulWithMish(
   return OkStatus();
 }
 
+// Returns true if independent ResourceApplyAdam nodes should be grouped.
+bool ResourceApplyAdamGroupingEnabled() {
+  bool is_enabled = false;
+  TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+      "TF_REMAPPER_GROUP_RESOURCE_APPLY_ADAM", /*default_val=*/false,
+      &is_enabled));
+  return is_enabled;
+}
+
+// Replaces each group of ResourceApplyAdam nodes with the same device,
+// attributes, hyperparameter inputs and frames with a ResourceApplyAdamMulti,
+// if none of the nodes of the group depends on another one. The control
+// fanins of the group are merged, and its control fanouts are redirected to
+// the new node.
+Status GroupResourceApplyAdams(
+    const std::unordered_set<string>& nodes_to_preserve, GraphDef* graph) {
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*graph, &topo_order));
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*graph));
+
+  // The maximum number of ResourceApplyAdam candidates on a path to each
+  // node, including the node. Candidates with the same number of candidates
+  // before them do not depend on each other.
+  absl::flat_hash_map<string, int> depths;
+  std::map<std::vector<string>, std::vector<const NodeDef*>> groups;
+  for (const NodeDef* node : topo_order) {
+    int depth = 0;
+    for (const string& input : node->input()) {
+      auto it = depths.find(NodeName(input));
+      if (it != depths.end()) depth = std::max(depth, it->second);
+    }
+    DataType dtype;
+    if (node->op() == kResourceApplyAdam && node->input_size() >= 10 &&
+        (NodeIsOnCpu(node) || NodeIsOnGpu(node)) &&
+        nodes_to_preserve.count(node->name()) == 0 &&
+        TryGetNodeAttr(*node, "T", &dtype)) {
+      bool use_locking = false;
+      bool use_nesterov = false;
+      TryGetNodeAttr(*node, "use_locking", &use_locking);
+      TryGetNodeAttr(*node, "use_nesterov", &use_nesterov);
+      std::vector<string> key = {
+          node->device(), DataTypeString(dtype), use_locking ? "1" : "0",
+          use_nesterov ? "1" : "0",
+          absl::StrJoin(frame_view.Frames(*node), ","), absl::StrCat(depth)};
+      // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+      for (int i = 3; i < 9; ++i) key.push_back(node->input(i));
+      groups[std::move(key)].push_back(node);
+      ++depth;
+    }
+    depths[node->name()] = depth;
+  }
+
+  absl::flat_hash_set<string> node_names;
+  for (const NodeDef& node : graph->node()) node_names.insert(node.name());
+  std::vector<NodeDef> multi_nodes;
+  // The names of the grouped nodes and of the nodes that replace them.
+  absl::flat_hash_map<string, string> replacements;
+  for (const auto& [key, group] : groups) {
+    if (group.size() < 2) continue;
+    const NodeDef& first = *group.front();
+    NodeDef multi;
+    string name = absl::StrCat(first.name(), "/", kResourceApplyAdamMulti);
+    while (!node_names.insert(name).second) absl::StrAppend(&name, "_");
+    multi.set_name(name);
+    multi.set_op(kResourceApplyAdamMulti);
+    multi.set_device(first.device());
+    // var, m and v.
+    for (int i = 0; i < 3; ++i) {
+      for (const NodeDef* node : group) multi.add_input(node->input(i));
+    }
+    for (int i = 3; i < 9; ++i) multi.add_input(first.input(i));
+    for (const NodeDef* node : group) multi.add_input(node->input(9));
+    absl::flat_hash_set<string> control_inputs;
+    for (const NodeDef* node : group) {
+      for (int i = 10; i < node->input_size(); ++i) {
+        if (control_inputs.insert(node->input(i)).second) {
+          multi.add_input(node->input(i));
+        }
+      }
+      replacements[node->name()] = name;
+    }
+    *multi.mutable_attr() = first.attr();
+    SetAttrValue(static_cast<int>(group.size()), &(*multi.mutable_attr())["N"]);
+    VLOG(2) << "Group " << group.size() << " ResourceApplyAdam nodes into "
+            << name;
+    multi_nodes.push_back(std::move(multi));
+  }
+  if (replacements.empty()) return OkStatus();
+
+  const int num_nodes = graph->node_size();
+  for (NodeDef& multi : multi_nodes) {
+    *graph->add_node() = std::move(multi);
+  }
+  std::set<int> nodes_to_delete;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    NodeDef* node = graph->mutable_node(i);
+    if (i < num_nodes && replacements.contains(node->name())) {
+      nodes_to_delete.insert(i);
+      continue;
+    }
+    // Only control fanouts, as ResourceApplyAdam has no outputs.
+    bool has_replaced_input = false;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input) && replacements.contains(NodeName(input))) {
+        has_replaced_input = true;
+        break;
+      }
+    }
+    if (!has_replaced_input) continue;
+    std::vector<string> inputs(node->input().begin(), node->input().end());
+    node->clear_input();
+    absl::flat_hash_set<string> control_inputs;
+    for (string& input : inputs) {
+      if (IsControlInput(input)) {
+        auto it = replacements.find(NodeName(input));
+        if (it != replacements.end()) input = AsControlDependency(it->second);
+        if (!control_inputs.insert(input).second) continue;
+      }
+      node->add_input(std::move(input));
+    }
+  }
+  EraseNodesFromGraph(nodes_to_delete, graph);
+  return OkStatus();
+}
+
 // Check if a node is a candidate to one of the patterns that require inferred
 // shapes:
 //   (1) Splitting FusedBatchNorm into primitives.
@@ -4762,6 +5090,13 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a _FusedElementwise, whose binary ops need shapes.
+  const auto is_fused_elementwise_candidate = [&]() -> bool {
+    return ctx.fuse_elementwise_chains &&
+           IsFusableElementwise(*node_def, GetDataTypeFromAttr(*node_def, "T"));
+  };
+  if (is_fused_elementwise_candidate()) return true;
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
@@ -4779,10 +5114,18 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
 Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
                           GraphDef* optimized_graph) {
   GrapplerItem mutable_item = item;
+  // ResourceApplyAdamMulti has no XLA kernel.
+  if (!xla_auto_clustering_on_ && ResourceApplyAdamGroupingEnabled()) {
+    TF_RETURN_IF_ERROR(GroupResourceApplyAdams(mutable_item.NodesToPreserve(),
+                                               &mutable_item.graph));
+  }
   Status status;
   RemapperContext ctx(&mutable_item, &status, cpu_layout_conversion_,
                       xla_auto_clustering_on_);
   TF_RETURN_IF_ERROR(status);
+  // XLA fuses such chains itself, and would not cluster _FusedElementwise.
+  ctx.fuse_elementwise_chains =
+      !xla_auto_clustering_on_ && ElementwiseChainFusionEnabled();
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
   TF_RETURN_IF_ERROR(
@@ -5117,6 +5460,16 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap chains of elementwise ops into the _FusedElementwise, after the
+    // fusions above took their activations.
+    FusedElementwise fused_elementwise;
+    if (allow_non_differentiable_rewrites && ctx.fuse_elementwise_chains &&
+        FindFusedElementwise(ctx, i, &fused_elementwise)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -1766,6 +1766,148 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+  setenv("TF_REMAPPER_FUSE_ELEMENTWISE_CHAINS", "1", 1 /* replace */);
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({4, 8});
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT, shape);
+  auto two = ops::Const(s.WithOpName("two"), 2.0f);
+  auto mul = ops::Mul(s.WithOpName("mul"), x, two);
+  auto add = ops::AddV2(s.WithOpName("add"), y, mul);
+  auto relu = ops::Relu(s.WithOpName("relu"), add);
+  // Tanh has two consumers, so it ends the chain of Square.
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), relu);
+  auto square = ops::Square(s.WithOpName("square"), tanh);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), square);
+  auto fetch_tanh = ops::Identity(s.WithOpName("fetch_tanh"), tanh);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "fetch_tanh"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({4, 8})},
+               {"y", GenerateRandomTensor<DT_FLOAT>({4, 8})}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  unsetenv("TF_REMAPPER_FUSE_ELEMENTWISE_CHAINS");
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "relu");
+    if (node.name() == "tanh") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "two");
+      EXPECT_EQ(node.input(2), "y");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+      const auto& fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Relu");
+      EXPECT_EQ(fused_ops[3], "Tanh");
+      found++;
+    }
+    if (node.name() == "square") {
+      EXPECT_EQ(node.op(), "Square");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-6);
+}
+
+TEST_F(RemapperTest, GroupResourceApplyAdams) {
+  setenv("TF_REMAPPER_GROUP_RESOURCE_APPLY_ADAM", "1", 1 /* replace */);
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto beta1_power = ops::Const(s.WithOpName("beta1_power"), 0.9f);
+  auto beta2_power = ops::Const(s.WithOpName("beta2_power"), 0.999f);
+  auto lr = ops::Const(s.WithOpName("lr"), 0.01f);
+  auto beta1 = ops::Const(s.WithOpName("beta1"), 0.9f);
+  auto beta2 = ops::Const(s.WithOpName("beta2"), 0.999f);
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 1e-7f);
+  std::vector<Operation> applies;
+  for (int i = 0; i < 3; ++i) {
+    const string suffix = std::to_string(i);
+    const PartialTensorShape shape({static_cast<int64_t>(i + 1)});
+    auto var = ops::VarHandleOp(s.WithOpName("var" + suffix), DT_FLOAT, shape);
+    auto m = ops::VarHandleOp(s.WithOpName("m" + suffix), DT_FLOAT, shape);
+    auto v = ops::VarHandleOp(s.WithOpName("v" + suffix), DT_FLOAT, shape);
+    auto grad = ops::Const(s.WithOpName("grad" + suffix), 1.0f,
+                           TensorShape({static_cast<int64_t>(i + 1)}));
+    // The last update runs after the first one, so it is not grouped.
+    Scope apply_scope = s.WithOpName("apply" + suffix);
+    if (i == 2) apply_scope = apply_scope.WithControlDependencies({applies[0]});
+    applies.push_back(ops::ResourceApplyAdam(apply_scope, var, m, v,
+                                             beta1_power, beta2_power, lr,
+                                             beta1, beta2, epsilon, grad)
+                          .operation);
+  }
+  auto train =
+      ops::NoOp(s.WithOpName("train").WithControlDependencies(applies));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  unsetenv("TF_REMAPPER_GROUP_RESOURCE_APPLY_ADAM");
+
+  const string multi_name = "apply0/ResourceApplyAdamMulti";
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "apply0");
+    EXPECT_NE(node.name(), "apply1");
+    if (node.name() == multi_name) {
+      EXPECT_EQ(node.op(), "ResourceApplyAdamMulti");
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      ASSERT_EQ(node.input_size(), 14);
+      EXPECT_EQ(node.input(0), "var0");
+      EXPECT_EQ(node.input(1), "var1");
+      EXPECT_EQ(node.input(2), "m0");
+      EXPECT_EQ(node.input(5), "v1");
+      EXPECT_EQ(node.input(6), "beta1_power");
+      EXPECT_EQ(node.input(11), "epsilon");
+      EXPECT_EQ(node.input(12), "grad0");
+      EXPECT_EQ(node.input(13), "grad1");
+      found++;
+    } else if (node.name() == "apply2") {
+      EXPECT_EQ(node.op(), "ResourceApplyAdam");
+      ASSERT_EQ(node.input_size(), 11);
+      EXPECT_EQ(node.input(10), AsControlDependency(multi_name));
+      found++;
+    } else if (node.name() == "train") {
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), AsControlDependency(multi_name));
+      EXPECT_EQ(node.input(1), "^apply2");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
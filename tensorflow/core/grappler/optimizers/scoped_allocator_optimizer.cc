@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -24,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 // Like TF_RETURN_IF_ERROR, but also logs a WARNING.
@@ -891,7 +895,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1096,6 +1100,20 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
     // TODO(ezhulenev): Pass a GraphView when this optimizer will be migrated
     // from NodeMap.
     LOG_WARNING_AND_RETURN_IF_ERROR(frame_view.InferFromGraph(*graph));
+    // The positions of the nodes in a topological order, which the rewrites
+    // keep valid for the nodes that they do not remove.
+    absl::flat_hash_map<const NodeDef*, int> topo_positions;
+    if (max_bucket_bytes_ > 0) {
+      std::vector<const NodeDef*> topo_order;
+      Status s = ComputeTopologicalOrder(*graph, &topo_order);
+      if (s.ok()) {
+        for (int i = 0; i < topo_order.size(); ++i) {
+          topo_positions[topo_order[i]] = i;
+        }
+      } else {
+        VLOG(1) << "Not ordering buckets by data dependencies: " << s;
+      }
+    }
 
     for (auto& dt : occ) {
       VLOG(2) << "Processing device " << dt.first;
@@ -1124,6 +1142,7 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
+                                         &graph_properties, &topo_positions,
                                          &op_name, invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
@@ -1131,14 +1150,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             std::vector<std::vector<NodeDef*>> loop_groups;
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
-              if (lg.size() > 1) {
-                bool applied = false;
-                Status s = OrderNodeSet(&lg);
-                TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+              std::vector<std::vector<NodeDef*>> buckets;
+              PartitionIntoBuckets(graph_properties, topo_positions,
+                                   std::move(lg), &buckets);
+              for (auto& bucket : buckets) {
+                if (bucket.size() > 1) {
+                  bool applied = false;
+                  Status s = OrderNodeSet(&bucket);
+                  TF_RETURN_IF_ERROR(s);
+                  VLOG(1) << "Applying Rewriter for " << op_name;
+                  s = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                        bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
@@ -1207,6 +1231,54 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return OkStatus();
 }
 
+void ScopedAllocatorOptimizer::PartitionIntoBuckets(
+    const GraphProperties& graph_properties,
+    const absl::flat_hash_map<const NodeDef*, int>& topo_positions,
+    std::vector<NodeDef*> nodes,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  if (max_bucket_bytes_ <= 0 || nodes.size() <= 1) {
+    buckets->push_back(std::move(nodes));
+    return;
+  }
+  // The same graph on every worker yields the same buckets, and so the same
+  // collectives.
+  OrderNodeSet(&nodes).IgnoreError();
+  if (!topo_positions.empty()) {
+    auto position = [&topo_positions](const NodeDef* node) {
+      auto it = topo_positions.find(node);
+      return it == topo_positions.end() ? std::numeric_limits<int>::max()
+                                        : it->second;
+    };
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [&position](const NodeDef* a, const NodeDef* b) {
+                       return position(a) < position(b);
+                     });
+  }
+
+  int64_t bucket_bytes = 0;
+  for (NodeDef* node : nodes) {
+    int64_t num_bytes = 0;
+    const std::vector<OpInfo::TensorProperties>& props =
+        graph_properties.GetInputProperties(node->name());
+    if (!props.empty()) {
+      const int64_t num_elements =
+          PartialTensorShape(props[0].shape()).num_elements();
+      num_bytes = std::max<int64_t>(num_elements, 0) *
+                  DataTypeSize(BaseType(props[0].dtype()));
+    }
+    if (buckets->empty() ||
+        (bucket_bytes > 0 && bucket_bytes + num_bytes > max_bucket_bytes_)) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(node);
+    bucket_bytes += num_bytes;
+  }
+  VLOG(1) << "Partitioned " << nodes.size() << " nodes into "
+          << buckets->size() << " buckets of at most " << max_bucket_bytes_
+          << " bytes";
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
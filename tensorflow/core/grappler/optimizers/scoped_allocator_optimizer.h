@@ -107,7 +107,17 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Splits `nodes` into buckets of inputs of at most max_bucket_bytes_, in the
+  // order of `topo_positions`, or returns a single bucket if
+  // max_bucket_bytes_ <= 0.
+  void PartitionIntoBuckets(
+      const GraphProperties& graph_properties,
+      const absl::flat_hash_map<const NodeDef*, int>& topo_positions,
+      std::vector<NodeDef*> nodes,
+      std::vector<std::vector<NodeDef*>>* buckets) const;
+
   RewriterConfig::Toggle opt_level_;
+  int64_t max_bucket_bytes_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
   absl::flat_hash_map<string, Rewriter*> rewriters_;
@@ -596,6 +596,54 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+// Test that max_bucket_bytes splits the ops into buckets with a
+// ScopedAllocator each.
+TEST_F(ScopedAllocatorOptimizerTest, Buckets) {
+  GrapplerItem item;
+  {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    std::vector<Output> sums = {ops::Add(s.WithOpName("s1"), a, b),
+                                ops::Add(s.WithOpName("s2"), a, a),
+                                ops::Add(s.WithOpName("s3"), b, a),
+                                ops::Add(s.WithOpName("s4"), b, b)};
+    for (int i = 0; i < sums.size(); ++i) {
+      Output abs =
+          ops::Abs(s.WithOpName(strings::StrCat("a", i + 1)), sums[i]);
+      ops::Reshape(s.WithOpName(strings::StrCat("r", i + 1)), abs, {1, 4});
+    }
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  }
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  // Each Abs has an input of 16 bytes.
+  opts.set_max_bucket_bytes(32);
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  int num_scoped_allocators = 0;
+  int num_abs_ops = 0;
+  for (const NodeDef& node : optimized_graph.node()) {
+    if (node.op() == "_ScopedAllocator") {
+      ++num_scoped_allocators;
+      EXPECT_EQ(2, node.attr().at("expected_call_count").i());
+    } else if (node.op() == "Abs") {
+      ++num_abs_ops;
+    }
+  }
+  // The 4 Abs ops are replaced by one Abs per bucket of 2.
+  EXPECT_EQ(2, num_scoped_allocators);
+  EXPECT_EQ(2, num_abs_ops);
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
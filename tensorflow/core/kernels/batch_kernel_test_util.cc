@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batch_kernel_test_util.h"
 
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -33,6 +34,10 @@ bool BatchFunctionKernelTestAccess::enable_adaptive_batch_threads() const {
   return kernel_->enable_adaptive_batch_threads_;
 }
 
+const std::string& BatchFunctionKernelTestAccess::shared_name() const {
+  return kernel_->shared_name_;
+}
+
 Status BatchFunctionKernelTestBase::Init(bool enable_adaptive_scheduler) {
   std::vector<DataType> input_dtypes({DataType::DT_INT64, DataType::DT_INT64});
   std::vector<NodeDefBuilder::NodeOut> inputs(
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCH_KERNEL_TEST_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_BATCH_KERNEL_TEST_UTIL_H_
 
+#include <string>
+
 #include <gtest/gtest.h>
 #include "tensorflow/core/kernels/batch_kernels.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -31,6 +33,8 @@ class BatchFunctionKernelTestAccess {
 
   bool enable_adaptive_batch_threads() const;
 
+  const std::string& shared_name() const;
+
  private:
   const BatchFunctionKernel* const kernel_;
 };
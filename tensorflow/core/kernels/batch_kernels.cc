@@ -22,11 +22,14 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -43,7 +46,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/numbers.h"
@@ -139,6 +144,53 @@ static thread::ThreadPool* GetOrCreateBatchThreadsPool() {
   return shared_thread_pool;
 }
 
+// Returns the resource manager holding the batch resources shared by the
+// BatchFunction ops of all the sessions of the process (see the
+// `enable_cross_model_batching` attribute).
+static ResourceMgr* GetCrossModelBatchResourceMgr() {
+  static ResourceMgr* resource_mgr = new ResourceMgr("cross_model_batching");
+  return resource_mgr;
+}
+
+// Returns a key identifying the body of the function `func` of the
+// BatchFunction op of `c` and its batching attributes, which is the same for
+// the ops of models sharing a backbone. Functions are named after the model
+// that defines them, so their names are ignored.
+static Status GetCrossModelBatchingKey(OpKernelConstruction* c,
+                                       const NameAttrList& func, string* key) {
+  if (c->function_library() == nullptr) {
+    return errors::Internal("No function library");
+  }
+  const FunctionDef* fdef =
+      c->function_library()->GetFunctionLibraryDefinition()->Find(func.name());
+  if (fdef == nullptr) {
+    return errors::NotFound("Failed to find definition for function \"",
+                            func.name(), "\"");
+  }
+  FunctionDef function = *fdef;
+  function.mutable_signature()->clear_name();
+
+  NodeDef batching_attrs;
+  for (const auto& [name, value] : c->def().attr()) {
+    if (name != "f" && name != "container" && name != "shared_name" &&
+        name != "batching_queue" && !absl::StartsWith(name, "_")) {
+      (*batching_attrs.mutable_attr())[name] = value;
+    }
+  }
+  *(*batching_attrs.mutable_attr())["f"].mutable_func()->mutable_attr() =
+      func.attr();
+
+  string serialized_function, serialized_attrs;
+  if (!SerializeToStringDeterministic(function, &serialized_function) ||
+      !SerializeToStringDeterministic(batching_attrs, &serialized_attrs)) {
+    return errors::Internal("Failed to serialize function \"", func.name(),
+                            "\"");
+  }
+  *key = absl::StrCat("cross_model_batch_", Fingerprint64(serialized_function),
+                      "_", Fingerprint64(serialized_attrs));
+  return OkStatus();
+}
+
 // A class encapsulating the state and logic for batching tensors.
 class BatchResource : public serving::BatchResourceBase {
  public:
@@ -327,6 +379,46 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     shared_name_ = name();
   }
 
+  if (c->HasAttr("enable_cross_model_batching")) {
+    OP_REQUIRES_OK(c, c->GetAttr("enable_cross_model_batching",
+                                 &enable_cross_model_batching_));
+  }
+  if (enable_cross_model_batching_) {
+    // All the ops with the same key share a batch resource and queue.
+    OP_REQUIRES_OK(c, GetCrossModelBatchingKey(c, func_, &shared_name_));
+    batcher_queue_ = shared_name_;
+  }
+
+  if (c->HasAttr("enable_deadline_based_batching")) {
+    OP_REQUIRES_OK(c, c->GetAttr("enable_deadline_based_batching",
+                                 &enable_deadline_based_batching_));
+  }
+  OP_REQUIRES(c,
+              !(enable_deadline_based_batching_ &&
+                enable_adaptive_batch_threads_),
+              errors::InvalidArgument(
+                  "Deadline-based batching is not supported with the adaptive "
+                  "batch scheduler."));
+
+  if (c->HasAttr("enable_ragged_batching")) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr("enable_ragged_batching", &enable_ragged_batching_));
+  }
+  // Splitting a task would cut its sequence across batches, and the adaptive
+  // scheduler always splits large tasks.
+  OP_REQUIRES(c,
+              !(enable_ragged_batching_ && (enable_large_batch_splitting_ ||
+                                            enable_adaptive_batch_threads_)),
+              errors::InvalidArgument(
+                  "Ragged batching requires large batch splitting to be "
+                  "disabled and is not supported with the adaptive batch "
+                  "scheduler."));
+
+  if (c->HasAttr("enable_cost_based_batch_splitting")) {
+    OP_REQUIRES_OK(c, c->GetAttr("enable_cost_based_batch_splitting",
+                                 &enable_cost_based_batch_splitting_));
+  }
+
   OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
 }
 
@@ -407,9 +499,11 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           &new_resource));
-      if (session_metadata) {
+      if (session_metadata && !enable_cross_model_batching_) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_enable_cost_based_batch_splitting(
+          enable_cost_based_batch_splitting_);
       *r = new_resource.release();
       return OkStatus();
     };
@@ -424,26 +518,48 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           low_priority_batch_timeout_micros_,
           low_priority_max_enqueued_batches_, low_priority_allowed_batch_sizes_,
           enable_large_batch_splitting_, &new_resource));
-      if (session_metadata) {
+      if (session_metadata && !enable_cross_model_batching_) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_enable_deadline_based_batching(
+          enable_deadline_based_batching_);
+      new_resource->set_enable_ragged_batching(enable_ragged_batching_);
+      new_resource->set_enable_cost_based_batch_splitting(
+          enable_cost_based_batch_splitting_);
       *r = new_resource.release();
       return OkStatus();
     };
   }
 
+  ResourceMgr* resource_manager = c->resource_manager();
+  if (enable_cross_model_batching_) {
+    // The captured inputs of a batch are those of one of its tasks, which
+    // could belong to another model.
+    OpInputList captured_tensors;
+    OP_REQUIRES_OK_ASYNC(
+        c, c->input_list("captured_tensors", &captured_tensors), done);
+    OP_REQUIRES_ASYNC(c, captured_tensors.size() == 0,
+                      errors::InvalidArgument(
+                          "Cross-model batching requires a function without "
+                          "captured inputs, but got ",
+                          captured_tensors.size(), " captured inputs."),
+                      done);
+    resource_manager = GetCrossModelBatchResourceMgr();
+  }
+
   BatchResource* br;
-  OP_REQUIRES_OK_ASYNC(c,
-                       c->resource_manager()->LookupOrCreate(
-                           container_, shared_name_, &br, creator),
-                       done);
+  OP_REQUIRES_OK_ASYNC(
+      c,
+      resource_manager->LookupOrCreate(container_, shared_name_, &br, creator),
+      done);
   const uint64_t guid = random::New64();
   auto create_batch_task_fn = [handle]()
       -> StatusOr<std::unique_ptr<serving::BatchResourceBase::BatchTask>> {
     return {std::make_unique<BatchResource::BatchTask>(handle)};
   };
   Status status;
-  if (serving::ShouldWarmupAllBatchSizes(c)) {
+  if (serving::ShouldWarmupAllBatchSizes(c) ||
+      !serving::GetWarmupSignatures(c).empty()) {
     status = br->RegisterWarmupInputs(guid, c, batcher_queue_,
                                       create_batch_task_fn, done);
   } else {
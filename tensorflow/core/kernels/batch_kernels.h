@@ -114,6 +114,12 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_ = false;
   bool has_attribute_enable_large_batch_splitting_ = false;
   bool enable_adaptive_batch_threads_ = false;
+  // If true, `shared_name_` and `batcher_queue_` identify the function body
+  // and batching attributes, and the batch resource is process-wide.
+  bool enable_cross_model_batching_ = false;
+  bool enable_deadline_based_batching_ = false;
+  bool enable_ragged_batching_ = false;
+  bool enable_cost_based_batch_splitting_ = false;
 
   mutex mu_;
 
@@ -17,19 +17,27 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/batch_kernel_test_util.h"
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -277,5 +285,424 @@ TEST_P(BatchFunctionKernelParallelWarmupTest, ParallelWarmupAutoBatch) {
 INSTANTIATE_TEST_SUITE_P(BatchFunctionKernelParallelWarmupTestSuite,
                          BatchFunctionKernelParallelWarmupTest,
                          ::testing::Bool());
+
+class BatchFunctionKernelCrossModelTestState : public OpsTestBase {
+ public:
+  // Init test fixture with a cross-model batch kernel instance, whose function
+  // `function_name` checks that its batches have `batch_size` rows.
+  Status Init(const std::string &function_name, int64_t batch_size) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name(function_name);
+    FunctionDef func = FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64"},
+        // out_def
+        {"o:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"},
+          "EnsureShape",
+          {"x"},
+          {{"T", DataType::DT_INT64}, {"shape", TensorShape({batch_size})}}}},
+        // ret_def
+        {{"o", "o:output"}});
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(func));
+
+    pflr_ = std::make_unique<ProcessFunctionLibraryRuntime>(
+        device_mgr_.get(), Env::Default(), /*config=*/nullptr,
+        TF_GRAPH_DEF_VERSION, flib_def_.get(), OptimizerOptions(),
+        /*thread_pool=*/nullptr, /*parent=*/nullptr,
+        /*session_metadata=*/nullptr,
+        Rendezvous::Factory{[](const int64_t, const DeviceMgr *device_mgr,
+                               tsl::core::RefCountPtr<Rendezvous> *r) {
+          *r = tsl::core::RefCountPtr<Rendezvous>(
+              new IntraProcessRendezvous(device_mgr));
+          return OkStatus();
+        }});
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_CHECK_OK(NodeDefBuilder("BatchBackbone", "BatchFunction")
+                    .Attr("max_batch_size", 2)
+                    .Attr("num_batch_threads", 1)
+                    .Attr("batch_timeout_micros", 10 * 1000 * 1000)
+                    .Attr("max_enqueued_batches", 10)
+                    .Attr("enable_cross_model_batching", true)
+                    .Attr("Tin", {DataType::DT_INT64})
+                    .Input(inputs)
+                    .Attr("Tcaptured", std::vector<DataType>{})
+                    .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                    .Attr("Tout", std::vector<DataType>{DT_INT64})
+                    .Attr("f", f)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  std::string shared_name() {
+    return test_util::BatchFunctionKernelTestAccess(
+               dynamic_cast<BatchFunctionKernel *>(op_kernel()))
+        .shared_name();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelCrossModelTest, KeyIgnoresFunctionName) {
+  BatchFunctionKernelCrossModelTestState model_a, model_b, model_c;
+  TF_ASSERT_OK(model_a.Init("model_a_backbone", /*batch_size=*/2));
+  TF_ASSERT_OK(model_b.Init("model_b_backbone", /*batch_size=*/2));
+  TF_ASSERT_OK(model_c.Init("model_c_backbone", /*batch_size=*/3));
+
+  EXPECT_EQ(model_a.shared_name(), model_b.shared_name());
+  EXPECT_NE(model_a.shared_name(), model_c.shared_name());
+}
+
+TEST(BatchFunctionKernelCrossModelTest, BatchesAcrossModels) {
+  // Each model sends a single row. The batch function checks the batches have
+  // two rows, so both requests succeed only if they are batched together.
+  tsl::BlockingCounter blocking_counter(2);
+  for (const std::string model_name : {"model_a", "model_b"}) {
+    Env::Default()->SchedClosure([&blocking_counter, model_name]() {
+      SessionMetadata session_metadata;
+      session_metadata.set_name(model_name);
+      session_metadata.set_version(1);
+      BatchFunctionKernelCrossModelTestState test;
+      test.set_session_metadata(session_metadata);
+      TF_CHECK_OK(test.Init(absl::StrCat(model_name, "_backbone"),
+                            /*batch_size=*/2));
+      test.AddInputFromList<int64_t>(TensorShape({1}), {123});
+      TF_EXPECT_OK(test.RunOpKernel());
+      test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                       test::AsTensor<int64_t>({123}));
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+
+class BatchFunctionKernelDeadlineTestState : public OpsTestBase {
+ public:
+  // Init test fixture with a batch kernel instance whose batches wait up to
+  // 10 seconds for more inputs, unless `enable_deadline_based_batching`.
+  Status Init(bool enable_deadline_based_batching, int32_t num_batch_threads) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("func_to_batch");
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64"},
+        // out_def
+        {"o:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"}, "Identity", {"x"}, {{"T", DataType::DT_INT64}}}},
+        // ret_def
+        {{"o", "o:output"}})));
+
+    pflr_ = std::make_unique<ProcessFunctionLibraryRuntime>(
+        device_mgr_.get(), Env::Default(), /*config=*/nullptr,
+        TF_GRAPH_DEF_VERSION, flib_def_.get(), OptimizerOptions(),
+        /*thread_pool=*/nullptr, /*parent=*/nullptr,
+        /*session_metadata=*/nullptr,
+        Rendezvous::Factory{[](const int64_t, const DeviceMgr *device_mgr,
+                               tsl::core::RefCountPtr<Rendezvous> *r) {
+          *r = tsl::core::RefCountPtr<Rendezvous>(
+              new IntraProcessRendezvous(device_mgr));
+          return OkStatus();
+        }});
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_CHECK_OK(NodeDefBuilder("BatchTPUInput", "BatchFunction")
+                    .Attr("max_batch_size", 8)
+                    .Attr("num_batch_threads", num_batch_threads)
+                    .Attr("batch_timeout_micros", 10 * 1000 * 1000)
+                    .Attr("max_enqueued_batches", 10)
+                    .Attr("enable_deadline_based_batching",
+                          enable_deadline_based_batching)
+                    .Attr("Tin", {DataType::DT_INT64})
+                    .Input(inputs)
+                    .Attr("Tcaptured", std::vector<DataType>{})
+                    .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                    .Attr("Tout", std::vector<DataType>{DT_INT64})
+                    .Attr("f", f)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelDeadlineTest, ProcessesBatchByRequestDeadline) {
+  BatchFunctionKernelDeadlineTestState test;
+  TF_ASSERT_OK(test.Init(/*enable_deadline_based_batching=*/true,
+                         /*num_batch_threads=*/1));
+  test.set_deadline(absl::Now() + absl::Milliseconds(50));
+  test.AddInputFromList<int64_t>(TensorShape({1}), {123});
+
+  // The lone input would wait 10 seconds for more inputs without its deadline.
+  const absl::Time start = absl::Now();
+  TF_ASSERT_OK(test.RunOpKernel());
+  EXPECT_LT(absl::Now() - start, absl::Seconds(5));
+  test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                   test::AsTensor<int64_t>({123}));
+}
+
+TEST(BatchFunctionKernelDeadlineTest, RejectsAdaptiveScheduler) {
+  BatchFunctionKernelDeadlineTestState test;
+  EXPECT_FALSE(test.Init(/*enable_deadline_based_batching=*/true,
+                         /*num_batch_threads=*/0)
+                   .ok());
+}
+
+class BatchFunctionKernelRaggedTestState : public OpsTestBase {
+ public:
+  // Init test fixture with a ragged batch kernel instance, whose function
+  // checks that its batches have 5 rows and returns them with the row lengths
+  // of its sequences.
+  Status Init(bool enable_large_batch_splitting) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("ragged_func_to_batch");
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64", "row_splits:int64"},
+        // out_def
+        {"o:int64", "row_lengths:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"},
+          "EnsureShape",
+          {"x"},
+          {{"T", DataType::DT_INT64}, {"shape", TensorShape({5})}}},
+         FunctionDefHelper::Const<int32_t>("zero", {0}),
+         FunctionDefHelper::Const<int32_t>("one", {1}),
+         FunctionDefHelper::Const<int32_t>("two", {2}),
+         {{"starts"},
+          "Slice",
+          {"row_splits", "zero:output:0", "two:output:0"},
+          {{"T", DataType::DT_INT64}, {"Index", DataType::DT_INT32}}},
+         {{"limits"},
+          "Slice",
+          {"row_splits", "one:output:0", "two:output:0"},
+          {{"T", DataType::DT_INT64}, {"Index", DataType::DT_INT32}}},
+         {{"l"},
+          "Sub",
+          {"limits:output:0", "starts:output:0"},
+          {{"T", DataType::DT_INT64}}}},
+        // ret_def
+        {{"o", "o:output"}, {"row_lengths", "l:z:0"}})));
+
+    pflr_ = std::make_unique<ProcessFunctionLibraryRuntime>(
+        device_mgr_.get(), Env::Default(), /*config=*/nullptr,
+        TF_GRAPH_DEF_VERSION, flib_def_.get(), OptimizerOptions(),
+        /*thread_pool=*/nullptr, /*parent=*/nullptr,
+        /*session_metadata=*/nullptr,
+        Rendezvous::Factory{[](const int64_t, const DeviceMgr *device_mgr,
+                               tsl::core::RefCountPtr<Rendezvous> *r) {
+          *r = tsl::core::RefCountPtr<Rendezvous>(
+              new IntraProcessRendezvous(device_mgr));
+          return OkStatus();
+        }});
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_CHECK_OK(NodeDefBuilder("BatchRagged", "BatchFunction")
+                    .Attr("max_batch_size", 5)
+                    .Attr("num_batch_threads", 1)
+                    .Attr("batch_timeout_micros", 10 * 1000 * 1000)
+                    .Attr("max_enqueued_batches", 10)
+                    .Attr("enable_large_batch_splitting",
+                          enable_large_batch_splitting)
+                    .Attr("enable_ragged_batching", true)
+                    .Attr("Tin", {DataType::DT_INT64})
+                    .Input(inputs)
+                    .Attr("Tcaptured", std::vector<DataType>{})
+                    .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                    .Attr("Tout", std::vector<DataType>{DT_INT64, DT_INT64})
+                    .Attr("f", f)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelRaggedTest, BatchesSequencesWithoutPadding) {
+  // The batch function checks the batches have five rows, so both sequences
+  // succeed only if they are batched together without padding.
+  const std::vector<std::vector<int64_t>> sequences = {{1, 2, 3}, {4, 5}};
+  tsl::BlockingCounter blocking_counter(sequences.size());
+  for (const std::vector<int64_t> &sequence : sequences) {
+    Env::Default()->SchedClosure([&blocking_counter, &sequence]() {
+      BatchFunctionKernelRaggedTestState test;
+      TF_CHECK_OK(test.Init(/*enable_large_batch_splitting=*/false));
+      const int64_t num_rows = sequence.size();
+      test.AddInputFromArray<int64_t>(TensorShape({num_rows}), sequence);
+      TF_EXPECT_OK(test.RunOpKernel());
+      test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                       test::AsTensor<int64_t>(sequence));
+      test::ExpectTensorEqual<int64_t>(*test.GetOutput(1),
+                                       test::AsTensor<int64_t>({num_rows}));
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+
+TEST(BatchFunctionKernelRaggedTest, RejectsLargeBatchSplitting) {
+  BatchFunctionKernelRaggedTestState test;
+  EXPECT_FALSE(test.Init(/*enable_large_batch_splitting=*/true).ok());
+}
+
+// Returns its input, after sleeping for 50ms if it has at least 4 rows, and
+// records the number of rows of every input it receives.
+class SlowLargeBatchIdentityOp : public OpKernel {
+ public:
+  explicit SlowLargeBatchIdentityOp(OpKernelConstruction *c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext *c) override {
+    const Tensor &input = c->input(0);
+    if (input.dim_size(0) >= 4) {
+      Env::Default()->SleepForMicroseconds(50 * 1000);
+    }
+    {
+      mutex_lock l(mu_);
+      batch_sizes().push_back(input.dim_size(0));
+    }
+    c->set_output(0, input);
+  }
+
+  static std::vector<int64_t> GetBatchSizes() {
+    mutex_lock l(mu_);
+    return batch_sizes();
+  }
+
+ private:
+  static std::vector<int64_t> &batch_sizes() {
+    static auto *const batch_sizes = new std::vector<int64_t>();
+    return *batch_sizes;
+  }
+
+  static mutex mu_;
+};
+
+mutex SlowLargeBatchIdentityOp::mu_(LINKER_INITIALIZED);
+
+REGISTER_OP("SlowLargeBatchIdentity").Input("x: int64").Output("y: int64");
+
+REGISTER_KERNEL_BUILDER(Name("SlowLargeBatchIdentity").Device(DEVICE_CPU),
+                        SlowLargeBatchIdentityOp);
+
+class BatchFunctionKernelCostBasedSplittingTestState : public OpsTestBase {
+ public:
+  // Init test fixture with a batch kernel instance with allowed batch sizes 1
+  // and 4, whose function is `SlowLargeBatchIdentity`.
+  Status Init() {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("slow_func_to_batch");
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64"},
+        // out_def
+        {"o:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"}, "SlowLargeBatchIdentity", {"x"}, {}}},
+        // ret_def
+        {{"o", "o:y:0"}})));
+
+    pflr_ = std::make_unique<ProcessFunctionLibraryRuntime>(
+        device_mgr_.get(), Env::Default(), /*config=*/nullptr,
+        TF_GRAPH_DEF_VERSION, flib_def_.get(), OptimizerOptions(),
+        /*thread_pool=*/nullptr, /*parent=*/nullptr,
+        /*session_metadata=*/nullptr,
+        Rendezvous::Factory{[](const int64_t, const DeviceMgr *device_mgr,
+                               tsl::core::RefCountPtr<Rendezvous> *r) {
+          *r = tsl::core::RefCountPtr<Rendezvous>(
+              new IntraProcessRendezvous(device_mgr));
+          return OkStatus();
+        }});
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_CHECK_OK(NodeDefBuilder("BatchCostBasedSplitting", "BatchFunction")
+                    .Attr("max_batch_size", 4)
+                    .Attr("num_batch_threads", 1)
+                    .Attr("batch_timeout_micros", 1000)
+                    .Attr("max_enqueued_batches", 10)
+                    .Attr("allowed_batch_sizes", {1, 4})
+                    .Attr("enable_cost_based_batch_splitting", true)
+                    .Attr("Tin", {DataType::DT_INT64})
+                    .Input(inputs)
+                    .Attr("Tcaptured", std::vector<DataType>{})
+                    .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                    .Attr("Tout", std::vector<DataType>{DT_INT64})
+                    .Attr("f", f)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelCostBasedSplittingTest, SplitsWhenFaster) {
+  // Measures the processing time of the batches of 4 and 1 rows, in that
+  // order, and then processes a batch of 2 rows.
+  for (const std::vector<int64_t> &rows :
+       std::vector<std::vector<int64_t>>{{1, 2, 3, 4}, {5}, {6, 7}}) {
+    BatchFunctionKernelCostBasedSplittingTestState test;
+    TF_ASSERT_OK(test.Init());
+    const int64_t num_rows = rows.size();
+    test.AddInputFromArray<int64_t>(TensorShape({num_rows}), rows);
+    TF_ASSERT_OK(test.RunOpKernel());
+    test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                     test::AsTensor<int64_t>(rows));
+  }
+
+  // Processing 2 rows as two batches of 1 row was measured to be faster than
+  // padding them to 4 rows.
+  EXPECT_THAT(SlowLargeBatchIdentityOp::GetBatchSizes(),
+              ::testing::ElementsAre(4, 1, 1, 1));
+}
+
 }  // namespace
 }  // namespace tensorflow
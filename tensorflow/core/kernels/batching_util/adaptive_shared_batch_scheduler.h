@@ -132,6 +132,14 @@ class AdaptiveSharedBatchScheduler
     // full_batch_scheduling_boost_micros==zero) for backward compatibility of
     // API.
     bool fifo_scheduling = false;
+
+    // Share of the scheduled batches reserved for batches of lower priority
+    // (see `QueueOptions.priority`), so that they never starve while batches
+    // of higher priority keep arriving. Whenever batches of several priorities
+    // are schedulable, a lower-priority batch is scheduled instead of the
+    // highest-priority batch if fewer than this share of such decisions went
+    // to lower priorities. Must be in [0, 1]. Ignored with `fifo_scheduling`.
+    double low_priority_batch_share = 0;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -171,6 +179,13 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // Priority class of the batches of this queue. Schedulable batches of
+    // higher priority are scheduled before the batches of lower priority,
+    // regardless of their age, except for the share of batches guaranteed to
+    // lower priorities by `Options.low_priority_batch_share`. Ignored with
+    // `Options.fifo_scheduling`.
+    int priority = 0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -277,6 +292,11 @@ class AdaptiveSharedBatchScheduler
   // batch.
   DelayStats batch_delay_stats_ TF_GUARDED_BY(mu_);
 
+  // Accumulates `Options.low_priority_batch_share` every time batches of
+  // several priorities are schedulable. A lower-priority batch is scheduled
+  // whenever it reaches 1, which then consumes 1.
+  double low_priority_credit_ TF_GUARDED_BY(mu_) = 0;
+
   // Max adjustment size (as a fraction of in_flight_batches_limit_).
   constexpr static double kMaxStepSizeMultiplier = 0.125;  // 1/8;
   // Min adjustment size (as a fraction of in_flight_batches_limit_).
@@ -322,6 +342,8 @@ class ASBSQueue : public BatchScheduler<TaskType> {
 
   size_t max_task_size() const override { return options_.max_batch_size; }
 
+  int priority() const { return options_.priority; }
+
  private:
   // Number of size 1 tasks which could currently be scheduled without failing.
   size_t SchedulingCapacityLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -423,6 +445,12 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.low_priority_batch_share < 0 ||
+      options.low_priority_batch_share > 1) {
+    return errors::InvalidArgument(
+        "low_priority_batch_share must be in [0, 1]; was ",
+        options.low_priority_batch_share);
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return OkStatus();
 }
@@ -568,22 +596,45 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
     return;
   }
 
+  int64_t now_micros = GetEnv()->NowMicros();
+  // The highest priority of the schedulable batches.
+  int top_priority = (std::numeric_limits<int>::min)();
+  for (const internal::ASBSBatch<TaskType>* batch : batches_) {
+    if (batch->schedulable_time_micros() > now_micros) continue;
+    top_priority = std::max(top_priority, batch->queue()->priority());
+  }
+  // The best schedulable batch of the highest priority, and of lower
+  // priorities.
   auto best_it = batches_.end();
+  auto best_low_priority_it = batches_.end();
   double best_score = (std::numeric_limits<double>::max)();
-  int64_t now_micros = GetEnv()->NowMicros();
+  double best_low_priority_score = (std::numeric_limits<double>::max)();
   for (auto it = batches_.begin(); it != batches_.end(); it++) {
     if ((*it)->schedulable_time_micros() > now_micros) continue;
     const double score =
         (*it)->creation_time_micros() -
         options_.full_batch_scheduling_boost_micros * (*it)->size() /
             static_cast<double>((*it)->queue()->max_task_size());
-    if (best_it == batches_.end() || score < best_score) {
+    if ((*it)->queue()->priority() < top_priority) {
+      if (best_low_priority_it == batches_.end() ||
+          score < best_low_priority_score) {
+        best_low_priority_score = score;
+        best_low_priority_it = it;
+      }
+    } else if (best_it == batches_.end() || score < best_score) {
       best_score = score;
       best_it = it;
     }
   }
   // No schedulable batches.
   if (best_it == batches_.end()) return;
+  if (best_low_priority_it != batches_.end()) {
+    low_priority_credit_ += options_.low_priority_batch_share;
+    if (low_priority_credit_ >= 1) {
+      low_priority_credit_ -= 1;
+      best_it = best_low_priority_it;
+    }
+  }
   const internal::ASBSBatch<TaskType>* batch = *best_it;
   batches_.erase(best_it);
   // Queue may destroy itself after ReleaseBatch is called.
@@ -611,20 +662,25 @@ void AdaptiveSharedBatchScheduler<
   int available_threads =
       static_cast<int>(options_.num_batch_threads - in_flight_batches_ -
                        in_flight_express_batches_);
-  for (auto it = batches_.begin();
-       it != batches_.end() && available_threads > 0;) {
-    if ((*it)->IsClosed()) {
-      const internal::ASBSBatch<TaskType>* batch = *it;
-      it = batches_.erase(it);
-      batch->queue()->ReleaseBatch(batch);
-      batch_thread_pool_->Schedule(
-          std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
-                    this, batch, queues_and_callbacks_[batch->queue()], true));
-      in_flight_express_batches_++;
-      available_threads--;
-    } else {
-      ++it;
+  while (available_threads > 0) {
+    // The oldest closed batch of the highest priority.
+    auto best_it = batches_.end();
+    for (auto it = batches_.begin(); it != batches_.end(); ++it) {
+      if ((*it)->IsClosed() &&
+          (best_it == batches_.end() ||
+           (*it)->queue()->priority() > (*best_it)->queue()->priority())) {
+        best_it = it;
+      }
     }
+    if (best_it == batches_.end()) break;
+    const internal::ASBSBatch<TaskType>* batch = *best_it;
+    batches_.erase(best_it);
+    batch->queue()->ReleaseBatch(batch);
+    batch_thread_pool_->Schedule(
+        std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
+                  this, batch, queues_and_callbacks_[batch->queue()], true));
+    in_flight_express_batches_++;
+    available_threads--;
   }
 }
 
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -96,6 +99,9 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.low_priority_batch_share = 1.5;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -344,6 +350,82 @@ TEST(AdaptiveSharedBatchSchedulerTest, FIFO) {
   stop_teardown.Notify();
 }
 
+// Schedules one full low-priority batch which blocks the only batch thread,
+// then `num_high_priority_batches` full high-priority batches and
+// `num_low_priority_batches` full low-priority batches, and returns the
+// priorities of the batches in the order they were processed.
+std::vector<int> ProcessedPriorities(double low_priority_batch_share,
+                                     int num_high_priority_batches,
+                                     int num_low_priority_batches) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  mutex mu;
+  std::vector<int> processed_priorities;
+  {
+    AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.initial_in_flight_batches_limit = 1;
+    options.num_batch_threads = 1;
+    options.batches_to_average_over = 1000;
+    options.low_priority_batch_share = low_priority_batch_share;
+    Notification finish_processing;
+    auto make_callback = [&](int priority) {
+      return [&, priority](std::unique_ptr<Batch<FakeTask>> batch) {
+        finish_processing.WaitForNotification();
+        mutex_lock l(mu);
+        processed_priorities.push_back(priority);
+      };
+    };
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_CHECK_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 100;
+    std::unique_ptr<BatchScheduler<FakeTask>> low_priority_queue;
+    queue_options.priority = 0;
+    TF_CHECK_OK(scheduler->AddQueue(queue_options, make_callback(0),
+                                    &low_priority_queue));
+    std::unique_ptr<BatchScheduler<FakeTask>> high_priority_queue;
+    queue_options.priority = 1;
+    TF_CHECK_OK(scheduler->AddQueue(queue_options, make_callback(1),
+                                    &high_priority_queue));
+
+    // First batch immediately processed.
+    TF_CHECK_OK(ScheduleTask(100, low_priority_queue.get()));
+    while (low_priority_queue->NumEnqueuedTasks() > 0) {
+    }
+    for (int i = 0; i < num_low_priority_batches; ++i) {
+      TF_CHECK_OK(ScheduleTask(100, low_priority_queue.get()));
+      env.AdvanceByMicroseconds(10);
+    }
+    for (int i = 0; i < num_high_priority_batches; ++i) {
+      TF_CHECK_OK(ScheduleTask(100, high_priority_queue.get()));
+      env.AdvanceByMicroseconds(10);
+    }
+
+    finish_processing.Notify();
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+  return processed_priorities;
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, HighPriorityFirst) {
+  EXPECT_EQ(ProcessedPriorities(/*low_priority_batch_share=*/0,
+                                /*num_high_priority_batches=*/2,
+                                /*num_low_priority_batches=*/2),
+            std::vector<int>({0, 1, 1, 0, 0}));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LowPriorityBatchShare) {
+  EXPECT_EQ(ProcessedPriorities(/*low_priority_batch_share=*/0.5,
+                                /*num_high_priority_batches=*/2,
+                                /*num_low_priority_batches=*/2),
+            std::vector<int>({0, 1, 0, 1, 0}));
+}
+
 TEST(AdaptiveSharedBatchSchedulerTest, DeleteQueue) {
   AdaptiveSharedBatchScheduler<FakeTask>::Options options;
   options.initial_in_flight_batches_limit = 1;
@@ -231,6 +231,11 @@ class BasicBatchScheduler : public BatchScheduler<TaskType> {
     // are returned at queue creation time.
     bool enable_lazy_split = false;
 
+    // If true, concurrent Schedule() calls enqueue their tasks in groups, to
+    // reduce lock contention under high QPS. See
+    // `SharedBatchScheduler::QueueOptions::enable_combining_enqueue`.
+    bool enable_combining_enqueue = false;
+
     // `split_input_task_func` specifies how to split `input_task` into
     // `output_tasks`.
     //
@@ -333,6 +338,8 @@ Status BasicBatchScheduler<TaskType>::Create(
   shared_scheduler_queue_options.split_input_task_func =
       options.split_input_task_func;
   shared_scheduler_queue_options.enable_lazy_split = options.enable_lazy_split;
+  shared_scheduler_queue_options.enable_combining_enqueue =
+      options.enable_combining_enqueue;
   shared_scheduler_queue_options.max_execution_batch_size =
       options.max_execution_batch_size;
   std::unique_ptr<BatchScheduler<TaskType>> shared_scheduler_queue;
@@ -285,19 +285,15 @@ string LatencyBenchmark::ReportLatencyBatchSz() {
       "ms,batchsz_p99=", batch_size_histogram_.Percentile(99));
 }
 
-// Injects a large number of tasks into a batch scheduler and measures
-// the total time to process all the tasks.
+// Injects a large number of tasks into a batch scheduler created with
+// `scheduler_options` and measures the total time to process all the tasks.
 //
 // Multi-threaded (thread > 1) version simulates N concurrent request streams.
-void ThroughputBM(::testing::benchmark::State& state) {
+void RunThroughputBenchmark(
+    ::testing::benchmark::State& state,
+    const BasicBatchScheduler<BenchmarkBatchTask>::Options& scheduler_options) {
   static std::unique_ptr<ThroughputBenchmark> bm;
   if (state.thread_index() == 0) {
-    BasicBatchScheduler<BenchmarkBatchTask>::Options scheduler_options;
-    const int kMaxBatchSize = 100;
-    scheduler_options.max_batch_size = kMaxBatchSize;
-    scheduler_options.batch_timeout_micros = state.range(0) * 1000;
-    scheduler_options.num_batch_threads = state.range(1);
-    scheduler_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
     bm.reset(new ThroughputBenchmark(scheduler_options));
   }
 
@@ -322,6 +318,16 @@ void ThroughputBM(::testing::benchmark::State& state) {
   }
   state.SetItemsProcessed(state.iterations() * kNumTasksPerIteration);
 }
+
+void ThroughputBM(::testing::benchmark::State& state) {
+  BasicBatchScheduler<BenchmarkBatchTask>::Options scheduler_options;
+  const int kMaxBatchSize = 100;
+  scheduler_options.max_batch_size = kMaxBatchSize;
+  scheduler_options.batch_timeout_micros = state.range(0) * 1000;
+  scheduler_options.num_batch_threads = state.range(1);
+  scheduler_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+  RunThroughputBenchmark(state, scheduler_options);
+}
 BENCHMARK(ThroughputBM)
     ->UseRealTime()
     ->Threads(1)
@@ -330,6 +336,32 @@ BENCHMARK(ThroughputBM)
     ->ArgNames({"timeout", "batch_threads"})
     ->ArgsProduct({{0, 2, 10}, {1, 4, 8, 16}});
 
+// Measures how the throughput of a single model's queue scales with the number
+// of concurrent request streams, i.e. the contention of high-QPS enqueues, with
+// and without combining enqueue.
+void SingleQueueScalingBM(::testing::benchmark::State& state) {
+  BasicBatchScheduler<BenchmarkBatchTask>::Options scheduler_options;
+  const int kMaxBatchSize = 100;
+  scheduler_options.max_batch_size = kMaxBatchSize;
+  scheduler_options.batch_timeout_micros = 0;
+  scheduler_options.num_batch_threads = 4;
+  scheduler_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+  scheduler_options.enable_combining_enqueue = state.range(0);
+  RunThroughputBenchmark(state, scheduler_options);
+}
+BENCHMARK(SingleQueueScalingBM)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    ->ArgNames({"combining_enqueue"})
+    ->Arg(0)
+    ->Arg(1);
+
 // Latency benchmark is a long running fixed interval (by time) benchmark and is
 // run once (see ->Iterations(1) below). We measure and report latency over this
 // fixed interval.
@@ -0,0 +1,70 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Smallest variance of the observed batch sizes for which a slope is fitted.
+constexpr double kMinSizeVariance = 1e-6;
+
+}  // namespace
+
+BatchLatencyModel::BatchLatencyModel(double decay) : decay_(decay) {
+  DCHECK_GE(decay, 0);
+  DCHECK_LT(decay, 1);
+}
+
+void BatchLatencyModel::Record(int64_t batch_size, int64_t latency_micros) {
+  const double x = static_cast<double>(batch_size);
+  const double y = static_cast<double>(latency_micros);
+  weight_sum_ = decay_ * weight_sum_ + 1;
+  size_sum_ = decay_ * size_sum_ + x;
+  latency_sum_ = decay_ * latency_sum_ + y;
+  size_squared_sum_ = decay_ * size_squared_sum_ + x * x;
+  size_latency_sum_ = decay_ * size_latency_sum_ + x * y;
+}
+
+int64_t BatchLatencyModel::PredictMicros(int64_t batch_size) const {
+  if (empty()) {
+    return 0;
+  }
+  const double mean_size = size_sum_ / weight_sum_;
+  const double mean_latency = latency_sum_ / weight_sum_;
+  const double size_variance =
+      size_squared_sum_ / weight_sum_ - mean_size * mean_size;
+  double slope = 0;
+  if (size_variance > kMinSizeVariance) {
+    const double covariance =
+        size_latency_sum_ / weight_sum_ - mean_size * mean_latency;
+    // Larger batches never take less time to process; a negative slope is
+    // measurement noise.
+    slope = std::max(0.0, covariance / size_variance);
+  }
+  const double prediction =
+      mean_latency + slope * (static_cast<double>(batch_size) - mean_size);
+  return std::max<int64_t>(0, std::llround(prediction));
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+namespace serving {
+
+// Online model of the processing latency of a batch as a function of its size.
+//
+// The model is the line `latency = intercept + slope * batch_size`, fitted by
+// least squares over the observed batches, where older observations are
+// exponentially discounted so that the model follows changes of the load or of
+// the hardware. Until two different batch sizes have been observed, the model
+// predicts the (discounted) average observed latency.
+//
+// Not thread-safe.
+class BatchLatencyModel {
+ public:
+  // `decay` is the weight given to the previous observations whenever a new one
+  // is recorded, and must be in [0, 1).
+  explicit BatchLatencyModel(double decay = 0.95);
+
+  // Records that processing a batch of `batch_size` took `latency_micros`.
+  void Record(int64_t batch_size, int64_t latency_micros);
+
+  // Returns the predicted processing latency of a batch of `batch_size`, or 0
+  // if no batch has been recorded yet.
+  int64_t PredictMicros(int64_t batch_size) const;
+
+  // Whether the model has recorded at least one batch.
+  bool empty() const { return weight_sum_ == 0; }
+
+ private:
+  const double decay_;
+
+  // Discounted sums of the weights, sizes, latencies, squared sizes and
+  // products of sizes and latencies of the observations.
+  double weight_sum_ = 0;
+  double size_sum_ = 0;
+  double latency_sum_ = 0;
+  double size_squared_sum_ = 0;
+  double size_latency_sum_ = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
@@ -0,0 +1,71 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(BatchLatencyModelTest, Empty) {
+  BatchLatencyModel model;
+  EXPECT_TRUE(model.empty());
+  EXPECT_EQ(model.PredictMicros(10), 0);
+}
+
+TEST(BatchLatencyModelTest, SingleBatchSize) {
+  BatchLatencyModel model;
+  model.Record(/*batch_size=*/4, /*latency_micros=*/100);
+  model.Record(/*batch_size=*/4, /*latency_micros=*/100);
+  EXPECT_FALSE(model.empty());
+  EXPECT_EQ(model.PredictMicros(4), 100);
+  EXPECT_EQ(model.PredictMicros(8), 100);
+}
+
+TEST(BatchLatencyModelTest, LinearLatency) {
+  BatchLatencyModel model;
+  for (int i = 0; i < 10; ++i) {
+    for (int64_t batch_size : {1, 2, 4, 8}) {
+      model.Record(batch_size, 50 + 10 * batch_size);
+    }
+  }
+  EXPECT_EQ(model.PredictMicros(1), 60);
+  EXPECT_EQ(model.PredictMicros(8), 130);
+  EXPECT_EQ(model.PredictMicros(16), 210);
+}
+
+TEST(BatchLatencyModelTest, NoNegativeSlope) {
+  BatchLatencyModel model;
+  model.Record(/*batch_size=*/1, /*latency_micros=*/200);
+  model.Record(/*batch_size=*/8, /*latency_micros=*/100);
+  EXPECT_GE(model.PredictMicros(16), model.PredictMicros(1));
+}
+
+TEST(BatchLatencyModelTest, FollowsChanges) {
+  BatchLatencyModel model(/*decay=*/0.5);
+  for (int i = 0; i < 5; ++i) {
+    model.Record(/*batch_size=*/4, /*latency_micros=*/100);
+  }
+  for (int i = 0; i < 20; ++i) {
+    model.Record(/*batch_size=*/4, /*latency_micros=*/1000);
+  }
+  EXPECT_EQ(model.PredictMicros(4), 1000);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -258,6 +259,48 @@ const string& GetModelName(OpKernelContext* ctx) {
   return ctx->session_metadata()->name();
 }
 
+// The weight of the previous measurements in the moving average of the
+// processing time of batches of a given size.
+constexpr double kBatchCostDecay = 0.9;
+
+// Records the stats of `batch`, padded to `padded_batch_size` rows, whose
+// processing starts at `current_time` (in nanoseconds). Returns the recorder
+// of the batch, to record its processing time.
+BatchQueueStatsRecorder* RecordBatchStats(
+    const BatchResourceBase::BatchT& batch, int padded_batch_size,
+    uint64 current_time, const string& model_name, const string& op_name) {
+  uint64 first_start_time = batch.task(0).start_time;
+  uint64 last_start_time = first_start_time;
+  BatchPriority priority = BatchPriority::kLow;
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const BatchResourceBase::BatchTask& task = batch.task(i);
+    first_start_time = std::min(first_start_time, task.start_time);
+    last_start_time = std::max(last_start_time, task.start_time);
+    if (GetBatchPriority(task.criticality) == BatchPriority::kHigh) {
+      priority = BatchPriority::kHigh;
+    }
+  }
+  BatchQueueStatsRecorder* recorder =
+      GetGlobalBatchStatsRegistry().GetOrCreate(model_name, op_name, priority);
+  recorder->RecordBatch(
+      (last_start_time - first_start_time) / 1000,
+      (current_time - std::min(current_time, last_start_time)) / 1000,
+      batch.num_tasks(), batch.size(), padded_batch_size);
+  return recorder;
+}
+
+// Returns the row splits of sequences with `row_lengths` rows each.
+Tensor RowSplitsTensor(const std::vector<int64_t>& row_lengths) {
+  const int64_t num_sequences = row_lengths.size();
+  Tensor row_splits(DT_INT64, TensorShape({num_sequences + 1}));
+  auto row_splits_flat = row_splits.vec<int64_t>();
+  row_splits_flat(0) = 0;
+  for (int64_t i = 0; i < num_sequences; ++i) {
+    row_splits_flat(i + 1) = row_splits_flat(i) + row_lengths[i];
+  }
+  return row_splits;
+}
+
 }  // namespace
 
 std::unique_ptr<BatchResourceBase::BatchTask>
@@ -276,6 +319,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->status = this->status;
   task->is_partial = true;
   task->start_time = this->start_time;
+  task->request_deadline_micros = this->request_deadline_micros;
   task->request_cost = this->request_cost;
 
   return task;
@@ -300,16 +344,33 @@ Status BatchResourceBase::RegisterWarmupInputs(
     int64_t guid, OpKernelContext* context, const string& batcher_queue_name,
     const CreateBatchTaskFn& create_batch_task_fn,
     AsyncOpKernel::DoneCallback done) {
-  auto warmup_counter =
-      std::make_shared<absl::BlockingCounter>(allowed_batch_sizes_.size());
+  const std::vector<int32> warmup_batch_sizes =
+      ShouldWarmupAllBatchSizes(context) ? allowed_batch_sizes_
+                                         : std::vector<int32>();
+  const std::vector<WarmupSignature> warmup_signatures =
+      GetWarmupSignatures(context);
+  auto warmup_counter = std::make_shared<absl::BlockingCounter>(
+      warmup_batch_sizes.size() + warmup_signatures.size());
   // Enqueue warmup batches.
-  for (int i = 0; i < allowed_batch_sizes_.size(); ++i) {
+  for (int i = 0; i < warmup_batch_sizes.size(); ++i) {
+    Status status = RegisterInput(
+        guid, context, batcher_queue_name, create_batch_task_fn,
+        [warmup_counter = warmup_counter.get()]() {
+          warmup_counter->DecrementCount();
+        },
+        warmup_batch_sizes[i]);
+    if (!status.ok()) return status;
+  }
+  // Enqueue a batch of synthetic inputs for each recorded signature.
+  for (const WarmupSignature& signature : warmup_signatures) {
+    std::vector<Tensor> warmup_inputs;
+    TF_RETURN_IF_ERROR(MakeWarmupInputs(signature, &warmup_inputs));
     Status status = RegisterInput(
         guid, context, batcher_queue_name, create_batch_task_fn,
         [warmup_counter = warmup_counter.get()]() {
           warmup_counter->DecrementCount();
         },
-        allowed_batch_sizes_[i]);
+        signature.batch_size, &warmup_inputs);
     if (!status.ok()) return status;
   }
   // Enqueue real batch if the other batches were enqueued successfully.
@@ -323,17 +384,29 @@ Status BatchResourceBase::RegisterWarmupInputs(
 Status BatchResourceBase::RegisterInput(
     int64_t guid, OpKernelContext* context, const string& batcher_queue_name,
     const CreateBatchTaskFn& create_batch_task_fn,
-    AsyncOpKernel::DoneCallback done_callback, int forced_warmup_batch_size) {
+    AsyncOpKernel::DoneCallback done_callback, int forced_warmup_batch_size,
+    const std::vector<Tensor>* warmup_inputs) {
   TF_ASSIGN_OR_RETURN(std::unique_ptr<BatchTask> batch_components,
                       create_batch_task_fn());
   batch_components->start_time = EnvTime::NowNanos();
   batch_components->guid = guid;
   batch_components->propagated_context = Context(ContextKind::kThread);
+  if (context->deadline().has_value()) {
+    batch_components->request_deadline_micros =
+        std::max<int64_t>(0, absl::ToUnixMicros(*context->deadline()));
+  }
 
   if (batcher_queue_options_.enable_priority_queue) {
     batch_components->criticality = tsl::criticality::GetCriticality();
   }
 
+  if (enable_ragged_batching_ &&
+      (batcher_queue_options_.enable_large_batch_splitting ||
+       adaptive_batcher_queue_options_.split_input_task_func != nullptr)) {
+    return errors::InvalidArgument(
+        "Ragged batching requires large batch splitting to be disabled.");
+  }
+
   OpInputList tensors;
   TF_RETURN_IF_ERROR(context->input_list("in_tensors", &tensors));
   batch_components->inputs.reserve(tensors.size());
@@ -353,6 +426,14 @@ Status BatchResourceBase::RegisterInput(
     }
     batch_components->inputs.push_back(tensor);
   }
+  if (forced_warmup_batch_size > 0 && warmup_inputs != nullptr) {
+    if (warmup_inputs->size() != tensors.size()) {
+      return errors::InvalidArgument("Expected ", tensors.size(),
+                                     " warmup inputs, got ",
+                                     warmup_inputs->size());
+    }
+    batch_components->inputs = *warmup_inputs;
+  }
   RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context),
                        context->op_kernel().name());
   RecordInputBatchSizeV2(tensors[0].shape().dim_size(0), GetModelName(context),
@@ -421,6 +502,8 @@ Status BatchResourceBase::RegisterInput(
   BatcherQueueT* batcher_queue;
   TF_RETURN_IF_ERROR(
       LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  const BatchPriority priority =
+      GetBatchPriority(batch_components->criticality);
 
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
@@ -435,7 +518,14 @@ Status BatchResourceBase::RegisterInput(
     num_outstanding_batched_items_ += batch_components->size();
   }
 
-  return batcher_queue->Schedule(&batch_components);
+  const Status status = batcher_queue->Schedule(&batch_components);
+  if (!status.ok()) {
+    GetGlobalBatchStatsRegistry()
+        .GetOrCreate(GetModelName(context), context->op_kernel().name(),
+                     priority)
+        ->RecordRejectedTask();
+  }
+  return status;
 }
 
 /*static*/ BatchResourceBase::BatcherT::QueueOptions
@@ -565,7 +655,8 @@ BatchResourceBase::GetAdaptiveBatcherQueueOptions(
 // or equal to 'batch_size'. If 'allowed_batch_sizes_' is empty, simply
 // returns 'batch_size'.
 int BatchResourceBase::RoundToLowestAllowedBatchSize(int batch_size) const {
-  if (batcher_queue_options_.disable_padding || allowed_batch_sizes_.empty()) {
+  if (batcher_queue_options_.disable_padding || enable_ragged_batching_ ||
+      allowed_batch_sizes_.empty()) {
     return batch_size;
   }
   for (int allowed_size : allowed_batch_sizes_) {
@@ -656,6 +747,130 @@ Status BatchResourceBase::ConcatInputTensors(
     TF_RETURN_IF_ERROR(concat_status);
     concatenated_tensors->push_back(concatenated_tensor);
   }
+
+  if (warmup_signature_recorder_ != nullptr && !just_for_warmup) {
+    warmup_signature_recorder_->Record(context->op_kernel().name(),
+                                       padded_batch_size,
+                                       *concatenated_tensors);
+  }
+
+  if (enable_ragged_batching_) {
+    // Ragged batches are only padded for warmup, with sequences of one row.
+    std::vector<int64_t> row_lengths;
+    row_lengths.reserve(batch.num_tasks() + padding_amount);
+    if (!just_for_warmup) {
+      for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+        row_lengths.push_back(batch.task(task_idx).size());
+      }
+    }
+    row_lengths.insert(row_lengths.end(), padding_amount, 1);
+    concatenated_tensors->push_back(RowSplitsTensor(row_lengths));
+  }
+  return OkStatus();
+}
+
+void BatchResourceBase::RecordBatchCost(int padded_batch_size,
+                                        uint64 cost_micros) const {
+  if (!enable_cost_based_batch_splitting_) {
+    return;
+  }
+  mutex_lock l(batch_costs_mu_);
+  auto it = batch_costs_micros_.find(padded_batch_size);
+  if (it == batch_costs_micros_.end()) {
+    batch_costs_micros_[padded_batch_size] = cost_micros;
+  } else {
+    it->second = kBatchCostDecay * it->second +
+                 (1 - kBatchCostDecay) * static_cast<double>(cost_micros);
+  }
+}
+
+int BatchResourceBase::GetSplitBatchSize(int batch_size) const {
+  if (!enable_cost_based_batch_splitting_ || !has_process_batch_function_ ||
+      enable_ragged_batching_ || batcher_queue_options_.disable_padding ||
+      allowed_batch_sizes_.empty()) {
+    return 0;
+  }
+  mutex_lock l(batch_costs_mu_);
+  return ChooseSplitBatchSize(allowed_batch_sizes_, batch_costs_micros_,
+                              batch_size);
+}
+
+/*static*/ int BatchResourceBase::ChooseSplitBatchSize(
+    const std::vector<int32>& allowed_batch_sizes,
+    const std::map<int, double>& batch_costs_micros, int batch_size) {
+  auto round_up = [&allowed_batch_sizes](int size) {
+    for (int allowed_size : allowed_batch_sizes) {
+      if (allowed_size >= size) {
+        return allowed_size;
+      }
+    }
+    return size;
+  };
+  auto cost = [&batch_costs_micros](int size) -> std::optional<double> {
+    auto it = batch_costs_micros.find(size);
+    if (it == batch_costs_micros.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+
+  const int padded_batch_size = round_up(batch_size);
+  const std::optional<double> padded_cost = cost(padded_batch_size);
+  if (!padded_cost.has_value()) {
+    return 0;
+  }
+  double best_cost = *padded_cost;
+  int best_first_batch_size = 0;
+  for (int first_batch_size : allowed_batch_sizes) {
+    if (first_batch_size >= batch_size) {
+      continue;
+    }
+    const int second_batch_size = round_up(batch_size - first_batch_size);
+    if (first_batch_size + second_batch_size > padded_batch_size) {
+      continue;
+    }
+    const std::optional<double> first_cost = cost(first_batch_size);
+    const std::optional<double> second_cost = cost(second_batch_size);
+    if (!first_cost.has_value() || !second_cost.has_value()) {
+      continue;
+    }
+    if (*first_cost + *second_cost < best_cost) {
+      best_cost = *first_cost + *second_cost;
+      best_first_batch_size = first_batch_size;
+    }
+  }
+  return best_first_batch_size;
+}
+
+/*static*/ Status BatchResourceBase::SplitRaggedOutputTensor(
+    const Tensor& output_tensor, const std::vector<int64_t>& row_lengths,
+    std::vector<Tensor>* split_tensors) {
+  if (output_tensor.shape().dims() == 0) {
+    return errors::FailedPrecondition("Batched output tensor has 0 dimensions");
+  }
+  int64_t num_rows = 0;
+  for (int64_t row_length : row_lengths) {
+    num_rows += row_length;
+  }
+  const int64_t num_sequences = row_lengths.size();
+  const int64_t output_size = output_tensor.shape().dim_size(0);
+  std::vector<int64_t> split_sizes;
+  if (output_size == num_rows) {
+    split_sizes = row_lengths;
+  } else if (output_size == num_sequences) {
+    split_sizes.assign(num_sequences, 1);
+  } else {
+    return errors::FailedPrecondition(
+        "Ragged batched output tensor's 0th dimension (", output_size,
+        ") equals neither the number of rows (", num_rows,
+        ") nor the number of sequences (", num_sequences, ") of the batch");
+  }
+  TF_RETURN_IF_ERROR(tensor::Split(output_tensor, split_sizes, split_tensors));
+  if (split_tensors->size() != split_sizes.size()) {
+    return errors::Internal(
+        "Tensor split operation did not work as expected; got ",
+        split_tensors->size(), " splits; expected ", split_sizes.size());
+  }
   return OkStatus();
 }
 
@@ -755,7 +970,8 @@ Status BatchResourceBase::ConcatInputTensors(
 }
 
 Status BatchResourceBase::SplitOutputTensors(
-    const std::vector<Tensor>& combined_outputs, BatchT* batch) const {
+    const std::vector<Tensor>& combined_outputs, BatchT* batch,
+    int padded_batch_size) const {
   DCHECK_GE(batch->num_tasks(), 1);
   if (batch->num_tasks() < 1) {
     return errors::Internal("Batch size expected to be positive; was ",
@@ -767,10 +983,7 @@ Status BatchResourceBase::SplitOutputTensors(
   for (int i = 0; i < batch->num_tasks(); ++i) {
     task_sizes_plus_optional_padding.push_back(batch->task(i).size());
   }
-  const int padding_size =
-      batcher_queue_options_.disable_padding
-          ? 0
-          : RoundToLowestAllowedBatchSize(batch->size()) - batch->size();
+  const int padding_size = padded_batch_size - batch->size();
   if (padding_size > 0) {
     task_sizes_plus_optional_padding.push_back(padding_size);
   }
@@ -785,6 +998,16 @@ Status BatchResourceBase::SplitOutputTensors(
   // within the batch, and use this to populate context outputs.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
     const Tensor& output_tensor = combined_outputs[i];
+    std::vector<Tensor> split_tensor;
+    if (enable_ragged_batching_) {
+      // Ragged batches are never padded, so there is one split per task.
+      TF_RETURN_IF_ERROR(SplitRaggedOutputTensor(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor));
+      for (int j = 0; j < batch->num_tasks(); ++j) {
+        batch->mutable_task(j)->context->set_output(i, split_tensor[j]);
+      }
+      continue;
+    }
     if (output_tensor.shape().dims() == 0) {
       return errors::FailedPrecondition(
           "Batched output tensor has 0 dimensions");
@@ -796,7 +1019,6 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
     const Status split_status = tensor::Split(
         output_tensor, task_sizes_plus_optional_padding, &split_tensor);
     DCHECK(split_status.ok()) << split_status;
@@ -842,6 +1064,7 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   const CostMeasurement::Context batching_context{/*is_per_query=*/false};
   std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements =
       CreateCostMeasurements(batching_context);
+  const uint64 processing_start_time = EnvTime::NowNanos();
 
   auto& last_task = batch->task(batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
@@ -858,7 +1081,8 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
       return;
     }
     SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
-                                    processed_size, *batch);
+                                    processed_size, *batch,
+                                    processing_start_time);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
     batch_cost_measurements.clear();
@@ -888,6 +1112,36 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   if (!status.ok()) {
     return;
   }
+  // The number of rows of the batched inputs, including padding.
+  const int padded_batch_size = concatenated_tensors[0].dim_size(0);
+
+  // If processing the batch as two batches of smaller allowed sizes is faster
+  // than padding it, split the padded inputs into the inputs of both batches.
+  const int first_batch_size = last_task.forced_warmup_batch_size == 0
+                                   ? GetSplitBatchSize(batch->size())
+                                   : 0;
+  const int second_batch_size =
+      first_batch_size == 0
+          ? 0
+          : RoundToLowestAllowedBatchSize(batch->size() - first_batch_size);
+  std::vector<Tensor> first_batch_inputs, second_batch_inputs;
+  if (first_batch_size > 0) {
+    processed_size = first_batch_size + second_batch_size;
+    std::vector<int64_t> split_sizes = {first_batch_size, second_batch_size};
+    if (padded_batch_size > processed_size) {
+      split_sizes.push_back(padded_batch_size - processed_size);
+    }
+    for (const Tensor& concatenated_tensor : concatenated_tensors) {
+      std::vector<Tensor> split_tensors;
+      status = Split(last_task_context, concatenated_tensor, split_sizes,
+                     &split_tensors);
+      if (!status.ok()) {
+        return;
+      }
+      first_batch_inputs.push_back(std::move(split_tensors[0]));
+      second_batch_inputs.push_back(std::move(split_tensors[1]));
+    }
+  }
 
   std::vector<Tensor> combined_outputs;
   std::vector<Tensor> args(concatenated_tensors.begin(),
@@ -905,28 +1159,108 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
   }
+  // Warmup batches are not recorded, as they do not reflect the traffic.
+  BatchQueueStatsRecorder* stats_recorder =
+      last_task.forced_warmup_batch_size == 0
+          ? RecordBatchStats(*batch, padded_batch_size, current_time,
+                             model_name, last_task_context->op_kernel().name())
+          : nullptr;
+  const uint64 processing_start_time_micros = EnvTime::NowMicros();
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
+  if (first_batch_size == 0) {
+    const uint64 start_time_micros = EnvTime::NowMicros();
+    ProcessFuncBatchImpl(
+        last_task, args, &combined_outputs, [&](const Status& run_status) {
+          Status final_status;
+          auto run_finally = gtl::MakeCleanup([&]() {
+            // We do the cleanup here as an optimization, so that
+            // it runs in the underlying TF inter-op threadpool.
+            // Running it in the threadpool, let's the ensuing
+            // ops be scheduled faster, because the executor will
+            // add them to the front of the threadpool's task
+            // queue rather than the end.
+            cleanup_fn(final_status);
+          });
+          final_status = run_status;
+          if (!final_status.ok()) {
+            return;
+          }
+          RecordBatchCost(padded_batch_size,
+                          EnvTime::NowMicros() - start_time_micros);
+          if (stats_recorder != nullptr) {
+            stats_recorder->RecordProcessing(EnvTime::NowMicros() -
+                                             processing_start_time_micros);
+          }
+          if (last_task.forced_warmup_batch_size == 0) {
+            final_status = SplitOutputTensors(combined_outputs, batch.get(),
+                                              padded_batch_size);
+          }
+        });
+    return;
+  }
+
+  // Processes the two batches one after the other. `ProcessFuncBatchImpl`
+  // returns once `done` has run.
+  first_batch_inputs.insert(first_batch_inputs.end(), captured_inputs.begin(),
+                            captured_inputs.end());
+  second_batch_inputs.insert(second_batch_inputs.end(), captured_inputs.begin(),
+                             captured_inputs.end());
+  std::vector<Tensor> first_batch_outputs;
+  Status first_batch_status;
+  bool first_batch_done = false;
+  uint64 start_time_micros = EnvTime::NowMicros();
+  ProcessFuncBatchImpl(last_task, first_batch_inputs, &first_batch_outputs,
+                       [&](const Status& run_status) {
+                         first_batch_status = run_status;
+                         first_batch_done = true;
+                       });
+  DCHECK(first_batch_done)
+      << "ProcessFuncBatchImpl returned before running its done callback.";
+  if (!first_batch_status.ok()) {
+    cleanup_fn(first_batch_status);
+    return;
+  }
+  RecordBatchCost(first_batch_size, EnvTime::NowMicros() - start_time_micros);
+
+  std::vector<Tensor> second_batch_outputs;
+  start_time_micros = EnvTime::NowMicros();
   ProcessFuncBatchImpl(
-      last_task, args, &combined_outputs, [&](const Status& run_status) {
+      last_task, second_batch_inputs, &second_batch_outputs,
+      [&](const Status& run_status) {
         Status final_status;
-        auto run_finally = gtl::MakeCleanup([&]() {
-          // We do the cleanup here as an optimization, so that
-          // it runs in the underlying TF inter-op threadpool.
-          // Running it in the threadpool, let's the ensuing
-          // ops be scheduled faster, because the executor will
-          // add them to the front of the threadpool's task
-          // queue rather than the end.
-          cleanup_fn(final_status);
-        });
+        auto run_finally =
+            gtl::MakeCleanup([&]() { cleanup_fn(final_status); });
         final_status = run_status;
         if (!final_status.ok()) {
           return;
         }
-        if (last_task.forced_warmup_batch_size == 0) {
-          final_status = SplitOutputTensors(combined_outputs, batch.get());
+        RecordBatchCost(second_batch_size,
+                        EnvTime::NowMicros() - start_time_micros);
+        if (stats_recorder != nullptr) {
+          stats_recorder->RecordProcessing(EnvTime::NowMicros() -
+                                           processing_start_time_micros);
+        }
+        if (first_batch_outputs.size() != second_batch_outputs.size()) {
+          final_status = errors::Internal(
+              "Split batches have different numbers of outputs: ",
+              first_batch_outputs.size(), " and ", second_batch_outputs.size());
+          return;
         }
+        combined_outputs.reserve(first_batch_outputs.size());
+        for (int i = 0; i < first_batch_outputs.size(); ++i) {
+          Tensor output;
+          final_status = Concat(
+              last_task_context,
+              {first_batch_outputs[i], second_batch_outputs[i]}, &output);
+          if (!final_status.ok()) {
+            return;
+          }
+          combined_outputs.push_back(std::move(output));
+        }
+        final_status =
+            SplitOutputTensors(combined_outputs, batch.get(), processed_size);
       });
 }
 
@@ -946,6 +1280,7 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   const CostMeasurement::Context batching_context{/*is_per_query=*/false};
   std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements =
       CreateCostMeasurements(batching_context);
+  const uint64 processing_start_time = EnvTime::NowNanos();
 
   int64_t processed_size = batch->size();
 
@@ -957,7 +1292,8 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
 
   auto batch_cost_cleanup = gtl::MakeCleanup([&] {
     SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
-                                    processed_size, *batch);
+                                    processed_size, *batch,
+                                    processing_start_time);
   });
 
   OP_REQUIRES_OK_ASYNC(last_task_context, ValidateBatch(*batch),
@@ -970,6 +1306,11 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
       ConcatInputTensors(*batch, last_task_context, &concatenated_tensors);
   processed_size = RoundToLowestAllowedBatchSize(batch->size());
   OP_REQUIRES_OK_ASYNC(last_task_context, concat_status, last_task_callback);
+  // The batch is processed by the ops downstream, so only its formation and
+  // queueing are recorded.
+  RecordBatchStats(*batch, concatenated_tensors[0].dim_size(0),
+                   EnvTime::NowNanos(), model_name,
+                   last_task_context->op_kernel().name());
 
   // Process each input edge one at a time (the typical case has just one).
   for (int i = 0; i < num_input_edges; ++i) {
@@ -1079,7 +1420,8 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     const std::string& model_name,
     const std::vector<std::unique_ptr<CostMeasurement>>&
         batch_cost_measurements,
-    const int64_t processed_size, BatchT& batch) {
+    const int64_t processed_size, BatchT& batch,
+    const uint64 processing_start_time_ns) {
   // 1. Split the batch costs to each task.
   for (const auto& batch_cost_measurement : batch_cost_measurements) {
     if (batch_cost_measurement->GetTotalCost() <= absl::ZeroDuration()) {
@@ -1141,9 +1483,24 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     // Skip recording the metrics if the request_cost is null.
     if (!request_cost) continue;
 
-    request_cost->RecordBatchMetrics(RequestCost::BatchMetrics{
+    RequestCost::BatchMetrics batch_metrics{
         processed_size, static_cast<int64_t>(batch.task(i).size()),
-        padding_size, batch_costs});
+        padding_size, batch_costs};
+    if (processing_start_time_ns > 0) {
+      batch_metrics.queueing_time = absl::Nanoseconds(
+          processing_start_time_ns -
+          std::min(processing_start_time_ns, batch.task(i).start_time));
+    }
+    if (padding_size > 0 && batch.size() > 0) {
+      // The cost of the padding is the difference between the smeared and the
+      // non-smeared costs.
+      for (const auto& [cost_type, total_cost] : batch_costs) {
+        batch_metrics.padding_costs[cost_type] =
+            total_cost / batch.size() * batch.task(i).size() -
+            total_cost / processed_size * batch.task(i).size();
+      }
+    }
+    request_cost->RecordBatchMetrics(batch_metrics);
   }
 }
 
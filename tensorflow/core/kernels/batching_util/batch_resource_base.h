@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
+#include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -95,8 +96,14 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // The deadline of the session run of the invocation, in microseconds since
+    // the Unix epoch, or 0 if it has none.
+    uint64 request_deadline_micros = 0;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    uint64 deadline_micros() const override { return request_deadline_micros; }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -160,22 +167,74 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Enables ragged batching, for invocations whose inputs each hold the rows
+  // of one variable-length sequence (e.g. its tokens) along the 0th dimension.
+  // The inputs of the tasks of a batch are concatenated without padding, and
+  // the batch function receives, after the concatenated inputs and before the
+  // captured inputs, an int64 `row_splits` vector such that the rows of the
+  // k-th sequence are [row_splits[k], row_splits[k+1]). Each output is split
+  // back by `row_splits` if it has one row per input row, or one row per
+  // sequence if it has one row per sequence (see `SplitRaggedOutputTensor`).
+  //
+  // Requires large batch splitting to be disabled, so that sequences are never
+  // split across batches; `allowed_batch_sizes` are ignored.
+  void set_enable_ragged_batching(bool enable_ragged_batching) {
+    enable_ragged_batching_ = enable_ragged_batching;
+  }
+
+  bool enable_ragged_batching() const { return enable_ragged_batching_; }
+
+  // Enables deadline-based batch formation in the queues of the shared batch
+  // scheduler (see `QueueOptions.enable_deadline_based_batching`), where the
+  // deadline of a task is that of the session run of its invocation. Must be
+  // called before the first input is registered, since the queues are created
+  // with the options they have then.
+  void set_enable_deadline_based_batching(bool enable_deadline_based_batching) {
+    batcher_queue_options_.enable_deadline_based_batching =
+        enable_deadline_based_batching;
+  }
+
+  // Enables measuring the processing time of batches of each allowed batch
+  // size, and processing a batch as two batches of smaller allowed sizes
+  // instead of padding it up whenever that was measured to be faster (e.g. a
+  // batch of 65 as batches of 64 and 1 instead of one of 128). Only applies
+  // with a batch function and `allowed_batch_sizes`. Sizes are measured when
+  // batches naturally have them, including warmup batches. The two batches
+  // are processed one after the other by the batch thread.
+  void set_enable_cost_based_batch_splitting(
+      bool enable_cost_based_batch_splitting) {
+    enable_cost_based_batch_splitting_ = enable_cost_based_batch_splitting;
+  }
+
+  // Records the signature of every batch processed on demand traffic into
+  // `recorder`, so that it can be replayed on the next model load (see
+  // `WarmupStateRegistry::PerModelData::warmup_signatures`).
+  void set_warmup_signature_recorder(
+      std::shared_ptr<WarmupSignatureRecorder> recorder) {
+    warmup_signature_recorder_ = std::move(recorder);
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
   // Like `RegisterInput`, but extra "dummy" batches are processed for each
-  // batch size. Only the real request's outputs are propagated to the caller.
+  // batch size if `ShouldWarmupAllBatchSizes`, and for each signature returned
+  // by `GetWarmupSignatures`. Only the real request's outputs are propagated
+  // to the caller.
   Status RegisterWarmupInputs(int64_t guid, OpKernelContext* context,
                               const string& batcher_queue_name,
                               const CreateBatchTaskFn& create_batch_task_fn,
                               AsyncOpKernel::DoneCallback done);
   // Ingests data from one invocation of the batch op. The data is enqueued to
-  // be combined with others into a batch, asynchronously.
+  // be combined with others into a batch, asynchronously. If
+  // `forced_warmup_batch_size` is positive, `warmup_inputs` optionally replace
+  // the data of the invocation as the rows used to pad the warmup batch.
   Status RegisterInput(int64_t guid, OpKernelContext* context,
                        const string& batcher_queue_name,
                        const CreateBatchTaskFn& create_batch_task_fn,
                        AsyncOpKernel::DoneCallback done_callback,
-                       int forced_warmup_batch_size = 0);
+                       int forced_warmup_batch_size = 0,
+                       const std::vector<Tensor>* warmup_inputs = nullptr);
 
   static BatcherT::QueueOptions GetBatcherQueueOptions(
       int32_t num_batch_threads, int32_t max_batch_size,
@@ -218,6 +277,25 @@ class BatchResourceBase : public ResourceBase {
       int max_batch_size,
       std::vector<std::unique_ptr<BatchTask>>* output_tasks);
 
+  // Splits `output_tensor`, an output of a ragged batch of sequences with
+  // `row_lengths` rows each, into one tensor per sequence. The 0th dimension of
+  // `output_tensor` must either be the total number of rows, in which case it
+  // is split by `row_lengths`, or the number of sequences, in which case each
+  // sequence gets one row.
+  static Status SplitRaggedOutputTensor(const Tensor& output_tensor,
+                                        const std::vector<int64_t>& row_lengths,
+                                        std::vector<Tensor>* split_tensors);
+
+  // Returns the size of the first of two batches, each padded to one of
+  // `allowed_batch_sizes`, which process a batch of `batch_size` faster than
+  // padding it to the smallest allowed size that fits, according to the
+  // processing times in `batch_costs_micros` (keyed on batch size). Returns 0
+  // if padding is faster, or if the costs of the batch sizes are not known.
+  // The two batches never process more rows than the padded batch.
+  static int ChooseSplitBatchSize(
+      const std::vector<int32>& allowed_batch_sizes,
+      const std::map<int, double>& batch_costs_micros, int batch_size);
+
   // Splits the batch costs to each task.
   //
   // Inputs:
@@ -238,14 +316,21 @@ class BatchResourceBase : public ResourceBase {
   //   1) the batch size;
   //   2) the input size from this task;
   //   3) the padding amount.
+  //
+  // The queueing time of the tasks is measured until
+  // `processing_start_time_ns`, if it is set.
   static void SplitBatchCostsAndRecordMetrics(
       const std::string& model_name,
       const std::vector<std::unique_ptr<CostMeasurement>>&
           batch_cost_measurements,
-      int64_t processed_size, BatchT& batch);
+      int64_t processed_size, BatchT& batch,
+      uint64 processing_start_time_ns = 0);
 
  private:
-  // Implementation of calling the process batch function.
+  // Implementation of calling the process batch function. Must have run `done`
+  // when it returns: `ProcessFuncBatch` passes `combined_outputs` and a `done`
+  // referencing its own stack, and processes split batches one after the
+  // other.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
       absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
@@ -263,8 +348,19 @@ class BatchResourceBase : public ResourceBase {
   Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
                             std::vector<Tensor>* concatenated_tensors) const;
 
+  // Splits outputs with `padded_batch_size` rows (including padding) among
+  // the tasks of `batch`.
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
-                            BatchT* batch) const;
+                            BatchT* batch, int padded_batch_size) const;
+
+  // Records that processing a batch of `padded_batch_size` took
+  // `cost_micros`, if cost-based batch splitting is enabled.
+  void RecordBatchCost(int padded_batch_size, uint64 cost_micros) const;
+
+  // Returns the size of the first of the two batches to process a batch of
+  // `batch_size` as, or 0 to process it as a single padded batch. See
+  // `set_enable_cost_based_batch_splitting`.
+  int GetSplitBatchSize(int batch_size) const;
 
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
@@ -312,6 +408,20 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // See `set_enable_ragged_batching`.
+  bool enable_ragged_batching_ = false;
+
+  // See `set_warmup_signature_recorder`.
+  std::shared_ptr<WarmupSignatureRecorder> warmup_signature_recorder_;
+
+  // See `set_enable_cost_based_batch_splitting`.
+  bool enable_cost_based_batch_splitting_ = false;
+  mutable mutex batch_costs_mu_;
+  // The exponential moving average of the processing time of batches, in
+  // microseconds, keyed on their size after padding.
+  mutable std::map<int, double> batch_costs_micros_
+      TF_GUARDED_BY(batch_costs_mu_);
 };
 
 }  // namespace serving
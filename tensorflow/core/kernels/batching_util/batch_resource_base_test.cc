@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -28,7 +29,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace serving {
@@ -76,6 +80,7 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnNoCostMeasurement) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
+                  ::testing::IsEmpty(), /*queueing_time=*/absl::ZeroDuration(),
                   ::testing::IsEmpty())));
 }
 
@@ -95,6 +100,7 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroCost) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
+                  ::testing::IsEmpty(), /*queueing_time=*/absl::ZeroDuration(),
                   ::testing::IsEmpty())));
 }
 
@@ -149,7 +155,9 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(5))))));
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
       UnorderedElementsAre(Pair("test_tpu_with_smear", absl::Milliseconds(90)),
@@ -158,7 +166,9 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(45))))));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
@@ -188,7 +198,10 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(5)),
+                               Pair("test_gcu", absl::Milliseconds(10))))));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -201,7 +214,10 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(45)),
+                               Pair("test_gcu", absl::Milliseconds(90))))));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
@@ -228,7 +244,9 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(5))))));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -238,7 +256,114 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_time=*/absl::ZeroDuration(),
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(45))))));
+}
+
+TEST(SplitBatchCostsAndRecordMetricsTest, RecordQueueingTime) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.mutable_task(0)->start_time = 1000000;
+  batch.mutable_task(1)->start_time = 3000000;
+  batch.Close();
+
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  BatchResourceBase::SplitBatchCostsAndRecordMetrics(
+      "model_name", batch_cost_measurements, /*processed_size=*/10, batch,
+      /*processing_start_time_ns=*/5000000);
+
+  EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/10, /*input_size=*/1, /*padding_size=*/0,
+                  ::testing::IsEmpty(),
+                  /*queueing_time=*/absl::Milliseconds(4),
+                  ::testing::IsEmpty())));
+  EXPECT_THAT(batch.task(1).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/10, /*input_size=*/9, /*padding_size=*/0,
+                  ::testing::IsEmpty(),
+                  /*queueing_time=*/absl::Milliseconds(2),
+                  ::testing::IsEmpty())));
+}
+
+TEST(SplitRaggedOutputTensorTest, SplitByRows) {
+  const Tensor output =
+      test::AsTensor<float>({0, 1, 2, 3, 4, 5}, TensorShape({3, 2}));
+  std::vector<Tensor> split_tensors;
+  TF_ASSERT_OK(BatchResourceBase::SplitRaggedOutputTensor(
+      output, /*row_lengths=*/{2, 0, 1}, &split_tensors));
+  ASSERT_EQ(split_tensors.size(), 3);
+  test::ExpectTensorEqual<float>(
+      split_tensors[0],
+      test::AsTensor<float>({0, 1, 2, 3}, TensorShape({2, 2})));
+  EXPECT_EQ(split_tensors[1].shape(), TensorShape({0, 2}));
+  test::ExpectTensorEqual<float>(
+      split_tensors[2], test::AsTensor<float>({4, 5}, TensorShape({1, 2})));
+}
+
+TEST(SplitRaggedOutputTensorTest, SplitBySequences) {
+  const Tensor output = test::AsTensor<float>({0, 1}, TensorShape({2}));
+  std::vector<Tensor> split_tensors;
+  TF_ASSERT_OK(BatchResourceBase::SplitRaggedOutputTensor(
+      output, /*row_lengths=*/{3, 2}, &split_tensors));
+  ASSERT_EQ(split_tensors.size(), 2);
+  test::ExpectTensorEqual<float>(split_tensors[0],
+                                 test::AsTensor<float>({0}, TensorShape({1})));
+  test::ExpectTensorEqual<float>(split_tensors[1],
+                                 test::AsTensor<float>({1}, TensorShape({1})));
+}
+
+TEST(SplitRaggedOutputTensorTest, InvalidOutputSize) {
+  const Tensor output = test::AsTensor<float>({0, 1, 2}, TensorShape({3}));
+  std::vector<Tensor> split_tensors;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      BatchResourceBase::SplitRaggedOutputTensor(
+          output, /*row_lengths=*/{3, 2}, &split_tensors)));
+}
+
+TEST(ChooseSplitBatchSizeTest, SplitWhenCheaper) {
+  // Processing 64 and 32 rows is faster than processing 128 rows.
+  const std::map<int, double> batch_costs_micros = {
+      {32, 100}, {64, 150}, {128, 400}};
+  EXPECT_EQ(BatchResourceBase::ChooseSplitBatchSize(
+                /*allowed_batch_sizes=*/{32, 64, 128}, batch_costs_micros,
+                /*batch_size=*/65),
+            64);
+}
+
+TEST(ChooseSplitBatchSizeTest, PadWhenCheaper) {
+  const std::map<int, double> batch_costs_micros = {
+      {32, 100}, {64, 150}, {128, 200}};
+  EXPECT_EQ(BatchResourceBase::ChooseSplitBatchSize(
+                /*allowed_batch_sizes=*/{32, 64, 128}, batch_costs_micros,
+                /*batch_size=*/65),
+            0);
+}
+
+TEST(ChooseSplitBatchSizeTest, UnknownCosts) {
+  EXPECT_EQ(BatchResourceBase::ChooseSplitBatchSize(
+                /*allowed_batch_sizes=*/{32, 64, 128},
+                /*batch_costs_micros=*/{{64, 150}, {128, 400}},
+                /*batch_size=*/65),
+            0);
+  EXPECT_EQ(BatchResourceBase::ChooseSplitBatchSize(
+                /*allowed_batch_sizes=*/{32, 64, 128},
+                /*batch_costs_micros=*/{{32, 100}, {64, 150}},
+                /*batch_size=*/65),
+            0);
+}
+
+TEST(ChooseSplitBatchSizeTest, NeverProcessesMoreRows) {
+  // Splitting 40 rows into 32 and 32 rows processes more rows than padding to
+  // 48 rows.
+  const std::map<int, double> batch_costs_micros = {{32, 10}, {48, 400}};
+  EXPECT_EQ(BatchResourceBase::ChooseSplitBatchSize(
+                /*allowed_batch_sizes=*/{32, 48}, batch_costs_micros,
+                /*batch_size=*/40),
+            0);
 }
 
 }  // namespace
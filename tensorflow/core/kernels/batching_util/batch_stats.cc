@@ -0,0 +1,259 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tsl/platform/criticality.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+monitoring::Sampler<3>* BatchFormationUsMetric() {
+  static auto* metric = monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_formation_us",
+       "Tracks the time (in microseconds) from the scheduling of the first "
+       "task of a batch to the scheduling of its last task, by model_name, op "
+       "name and priority.",
+       "model_name", "op_name", "priority"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024, DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  return metric;
+}
+
+monitoring::Sampler<3>* QueueDelayUsMetric() {
+  static auto* metric = monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/queue_delay_us",
+       "Tracks the time (in microseconds) from the scheduling of the last task "
+       "of a batch to the start of its processing, by model_name, op name and "
+       "priority.",
+       "model_name", "op_name", "priority"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  return metric;
+}
+
+monitoring::Sampler<3>* ProcessingUsMetric() {
+  static auto* metric = monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/processing_us",
+       "Tracks the processing time (in microseconds) of the batches, by "
+       "model_name, op name and priority.",
+       "model_name", "op_name", "priority"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  return metric;
+}
+
+monitoring::Sampler<3>* BatchFillRatioMetric() {
+  static auto* metric = monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_fill_ratio",
+       "Tracks the number of rows of the batches over their number of rows "
+       "after padding, by model_name, op name and priority.",
+       "model_name", "op_name", "priority"},
+      monitoring::Buckets::Explicit(
+          {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0}));
+  return metric;
+}
+
+monitoring::Counter<3>* RejectedTasksMetric() {
+  static auto* metric = monitoring::Counter<3>::New(
+      "/tensorflow/serving/batching/rejected_tasks",
+      "Tracks the number of tasks which could not be scheduled, by model_name, "
+      "op name and priority.",
+      "model_name", "op_name", "priority");
+  return metric;
+}
+
+}  // namespace
+
+BatchPriority GetBatchPriority(tsl::criticality::Criticality criticality) {
+  switch (criticality) {
+    case tsl::criticality::Criticality::kSheddable:
+    case tsl::criticality::Criticality::kSheddablePlus:
+      return BatchPriority::kLow;
+    default:
+      return BatchPriority::kHigh;
+  }
+}
+
+absl::string_view BatchPriorityName(BatchPriority priority) {
+  return priority == BatchPriority::kHigh ? "high" : "low";
+}
+
+void BatchQueueStatsRecorder::Distribution::Add(double value) {
+  histogram.Add(value);
+  max = count == 0 ? value : std::max(max, value);
+  ++count;
+}
+
+BatchStatsDistribution BatchQueueStatsRecorder::Distribution::Summarize()
+    const {
+  BatchStatsDistribution summary;
+  if (count == 0) {
+    return summary;
+  }
+  summary.count = count;
+  summary.mean = histogram.Average();
+  summary.p50 = histogram.Percentile(50);
+  summary.p90 = histogram.Percentile(90);
+  summary.p99 = histogram.Percentile(99);
+  summary.max = max;
+  return summary;
+}
+
+void BatchQueueStatsRecorder::Distribution::Clear() {
+  histogram.Clear();
+  count = 0;
+  max = 0;
+}
+
+BatchQueueStatsRecorder::BatchQueueStatsRecorder(absl::string_view model_name,
+                                                 absl::string_view op_name,
+                                                 BatchPriority priority)
+    : model_name_(model_name),
+      op_name_(op_name),
+      priority_(priority),
+      batch_formation_us_cell_(BatchFormationUsMetric()->GetCell(
+          model_name_, op_name_, std::string(BatchPriorityName(priority)))),
+      queue_delay_us_cell_(QueueDelayUsMetric()->GetCell(
+          model_name_, op_name_, std::string(BatchPriorityName(priority)))),
+      processing_us_cell_(ProcessingUsMetric()->GetCell(
+          model_name_, op_name_, std::string(BatchPriorityName(priority)))),
+      batch_fill_ratio_cell_(BatchFillRatioMetric()->GetCell(
+          model_name_, op_name_, std::string(BatchPriorityName(priority)))),
+      rejected_tasks_cell_(RejectedTasksMetric()->GetCell(
+          model_name_, op_name_, std::string(BatchPriorityName(priority)))) {}
+
+void BatchQueueStatsRecorder::RecordBatch(int64_t batch_formation_us,
+                                          int64_t queue_delay_us,
+                                          int num_tasks, int batch_size,
+                                          int padded_batch_size) {
+  const double fill_ratio =
+      padded_batch_size > 0
+          ? static_cast<double>(batch_size) / padded_batch_size
+          : 1.0;
+  batch_formation_us_cell_->Add(batch_formation_us);
+  queue_delay_us_cell_->Add(queue_delay_us);
+  batch_fill_ratio_cell_->Add(fill_ratio);
+
+  absl::MutexLock l(&mu_);
+  ++num_batches_;
+  num_tasks_ += num_tasks;
+  batch_formation_us_.Add(batch_formation_us);
+  queue_delay_us_.Add(queue_delay_us);
+  batch_fill_ratio_.Add(fill_ratio);
+}
+
+void BatchQueueStatsRecorder::RecordProcessing(int64_t processing_us) {
+  processing_us_cell_->Add(processing_us);
+
+  absl::MutexLock l(&mu_);
+  processing_us_.Add(processing_us);
+}
+
+void BatchQueueStatsRecorder::RecordRejectedTask() {
+  rejected_tasks_cell_->IncrementBy(1);
+
+  absl::MutexLock l(&mu_);
+  ++num_rejected_tasks_;
+}
+
+BatchQueueStats BatchQueueStatsRecorder::Snapshot(bool reset) {
+  BatchQueueStats stats;
+  stats.model_name = model_name_;
+  stats.op_name = op_name_;
+  stats.priority = priority_;
+
+  absl::MutexLock l(&mu_);
+  stats.num_batches = num_batches_;
+  stats.num_tasks = num_tasks_;
+  stats.num_rejected_tasks = num_rejected_tasks_;
+  stats.batch_formation_us = batch_formation_us_.Summarize();
+  stats.queue_delay_us = queue_delay_us_.Summarize();
+  stats.processing_us = processing_us_.Summarize();
+  stats.batch_fill_ratio = batch_fill_ratio_.Summarize();
+  if (reset) {
+    num_batches_ = 0;
+    num_tasks_ = 0;
+    num_rejected_tasks_ = 0;
+    batch_formation_us_.Clear();
+    queue_delay_us_.Clear();
+    processing_us_.Clear();
+    batch_fill_ratio_.Clear();
+  }
+  return stats;
+}
+
+BatchQueueStatsRecorder* BatchStatsRegistry::GetOrCreate(
+    absl::string_view model_name, absl::string_view op_name,
+    BatchPriority priority) {
+  absl::MutexLock l(&mu_);
+  std::unique_ptr<BatchQueueStatsRecorder>& recorder =
+      recorders_[Key(model_name, op_name, priority)];
+  if (recorder == nullptr) {
+    recorder = std::make_unique<BatchQueueStatsRecorder>(model_name, op_name,
+                                                         priority);
+  }
+  return recorder.get();
+}
+
+std::optional<BatchQueueStats> BatchStatsRegistry::GetStats(
+    absl::string_view model_name, absl::string_view op_name,
+    BatchPriority priority, bool reset) {
+  BatchQueueStatsRecorder* recorder;
+  {
+    absl::MutexLock l(&mu_);
+    auto it = recorders_.find(Key(model_name, op_name, priority));
+    if (it == recorders_.end()) {
+      return std::nullopt;
+    }
+    recorder = it->second.get();
+  }
+  return recorder->Snapshot(reset);
+}
+
+std::vector<BatchQueueStats> BatchStatsRegistry::GetAllStats(bool reset) {
+  std::vector<BatchQueueStatsRecorder*> recorders;
+  {
+    absl::MutexLock l(&mu_);
+    recorders.reserve(recorders_.size());
+    for (const auto& [key, recorder] : recorders_) {
+      recorders.push_back(recorder.get());
+    }
+  }
+  std::vector<BatchQueueStats> stats;
+  stats.reserve(recorders.size());
+  for (BatchQueueStatsRecorder* recorder : recorders) {
+    stats.push_back(recorder->Snapshot(reset));
+  }
+  return stats;
+}
+
+BatchStatsRegistry& GetGlobalBatchStatsRegistry() {
+  static auto* const registry = new BatchStatsRegistry;
+  return *registry;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,183 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tsl/platform/criticality.h"
+
+namespace tensorflow {
+namespace serving {
+
+// The priority of a batched task.
+enum class BatchPriority { kHigh, kLow };
+
+// Returns the priority of the tasks of the given criticality: sheddable tasks
+// have a low priority.
+BatchPriority GetBatchPriority(tsl::criticality::Criticality criticality);
+
+// Returns "high" or "low".
+absl::string_view BatchPriorityName(BatchPriority priority);
+
+// A summary of the samples of a distribution.
+struct BatchStatsDistribution {
+  int64_t count = 0;
+  double mean = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+// The stats of the tasks of one priority of a batching queue.
+//
+// The latency of a task between its scheduling and the completion of its
+// batch is split into:
+//   - the batch formation time, from the scheduling of the first task of the
+//     batch to the scheduling of its last task, during which the batch is
+//     open;
+//   - the queueing delay, from the scheduling of the last task of the batch to
+//     the start of its processing, during which the batch waits for its
+//     timeout or for a batch thread;
+//   - the processing time of the batch.
+struct BatchQueueStats {
+  std::string model_name;
+  std::string op_name;
+  BatchPriority priority = BatchPriority::kHigh;
+
+  // The number of processed batches and tasks.
+  int64_t num_batches = 0;
+  int64_t num_tasks = 0;
+  // The number of tasks which the queue failed to schedule, e.g. because it
+  // was full.
+  int64_t num_rejected_tasks = 0;
+
+  // Per-batch distributions, in microseconds.
+  BatchStatsDistribution batch_formation_us;
+  BatchStatsDistribution queue_delay_us;
+  BatchStatsDistribution processing_us;
+  // Per-batch distribution of the number of rows of a batch over its number
+  // of rows after padding.
+  BatchStatsDistribution batch_fill_ratio;
+};
+
+// Records the stats of the tasks of one priority of a batching queue, both
+// in-process (see `Snapshot`) and to monitoring metrics. Thread-safe.
+//
+// A batch counts toward the highest priority of its tasks.
+class BatchQueueStatsRecorder {
+ public:
+  BatchQueueStatsRecorder(absl::string_view model_name,
+                          absl::string_view op_name, BatchPriority priority);
+
+  BatchQueueStatsRecorder(const BatchQueueStatsRecorder&) = delete;
+  BatchQueueStatsRecorder& operator=(const BatchQueueStatsRecorder&) = delete;
+
+  // Records a batch of `num_tasks` tasks and `batch_size` rows, padded to
+  // `padded_batch_size` rows, when its processing starts.
+  void RecordBatch(int64_t batch_formation_us, int64_t queue_delay_us,
+                   int num_tasks, int batch_size, int padded_batch_size);
+
+  // Records the processing time of a batch, once it has been processed.
+  void RecordProcessing(int64_t processing_us);
+
+  // Records a task which could not be scheduled.
+  void RecordRejectedTask();
+
+  // Returns the stats recorded since the creation of the recorder, or since
+  // the last call with `reset` set to true.
+  BatchQueueStats Snapshot(bool reset = false);
+
+ private:
+  // A histogram with the sample count and maximum, which the histogram does
+  // not expose.
+  struct Distribution {
+    histogram::Histogram histogram;
+    int64_t count = 0;
+    double max = 0;
+
+    void Add(double value);
+    BatchStatsDistribution Summarize() const;
+    void Clear();
+  };
+
+  const std::string model_name_;
+  const std::string op_name_;
+  const BatchPriority priority_;
+
+  // The cells of the exported metrics.
+  monitoring::SamplerCell* const batch_formation_us_cell_;
+  monitoring::SamplerCell* const queue_delay_us_cell_;
+  monitoring::SamplerCell* const processing_us_cell_;
+  monitoring::SamplerCell* const batch_fill_ratio_cell_;
+  monitoring::CounterCell* const rejected_tasks_cell_;
+
+  absl::Mutex mu_;
+  int64_t num_batches_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_tasks_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_rejected_tasks_ ABSL_GUARDED_BY(mu_) = 0;
+  Distribution batch_formation_us_ ABSL_GUARDED_BY(mu_);
+  Distribution queue_delay_us_ ABSL_GUARDED_BY(mu_);
+  Distribution processing_us_ ABSL_GUARDED_BY(mu_);
+  Distribution batch_fill_ratio_ ABSL_GUARDED_BY(mu_);
+};
+
+// Global registry of the stats of the batching queues, so that e.g.
+// autoscalers can query the saturation of the batch schedulers.
+class BatchStatsRegistry {
+ public:
+  // Returns the recorder of the given queue and priority, creating it if
+  // needed. The recorder lives as long as the registry.
+  BatchQueueStatsRecorder* GetOrCreate(absl::string_view model_name,
+                                       absl::string_view op_name,
+                                       BatchPriority priority);
+
+  // Returns the stats of the given queue and priority, or nullopt if nothing
+  // has been recorded for it. See `BatchQueueStatsRecorder::Snapshot`.
+  std::optional<BatchQueueStats> GetStats(absl::string_view model_name,
+                                          absl::string_view op_name,
+                                          BatchPriority priority,
+                                          bool reset = false);
+
+  // Returns the stats of all the queues and priorities.
+  std::vector<BatchQueueStats> GetAllStats(bool reset = false);
+
+ private:
+  using Key = std::tuple<std::string, std::string, BatchPriority>;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<Key, std::unique_ptr<BatchQueueStatsRecorder>> recorders_
+      ABSL_GUARDED_BY(mu_);
+};
+
+BatchStatsRegistry& GetGlobalBatchStatsRegistry();
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
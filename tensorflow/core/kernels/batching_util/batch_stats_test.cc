@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/criticality.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(BatchStatsTest, GetBatchPriority) {
+  EXPECT_EQ(GetBatchPriority(tsl::criticality::Criticality::kCriticalPlus),
+            BatchPriority::kHigh);
+  EXPECT_EQ(GetBatchPriority(tsl::criticality::Criticality::kCritical),
+            BatchPriority::kHigh);
+  EXPECT_EQ(GetBatchPriority(tsl::criticality::Criticality::kSheddablePlus),
+            BatchPriority::kLow);
+  EXPECT_EQ(GetBatchPriority(tsl::criticality::Criticality::kSheddable),
+            BatchPriority::kLow);
+}
+
+TEST(BatchStatsTest, RecordsBatches) {
+  BatchQueueStatsRecorder recorder("model", "op", BatchPriority::kHigh);
+  recorder.RecordBatch(/*batch_formation_us=*/100, /*queue_delay_us=*/10,
+                       /*num_tasks=*/2, /*batch_size=*/3,
+                       /*padded_batch_size=*/4);
+  recorder.RecordBatch(/*batch_formation_us=*/300, /*queue_delay_us=*/30,
+                       /*num_tasks=*/1, /*batch_size=*/4,
+                       /*padded_batch_size=*/4);
+  recorder.RecordProcessing(1000);
+  recorder.RecordRejectedTask();
+
+  BatchQueueStats stats = recorder.Snapshot();
+  EXPECT_EQ(stats.model_name, "model");
+  EXPECT_EQ(stats.op_name, "op");
+  EXPECT_EQ(stats.priority, BatchPriority::kHigh);
+  EXPECT_EQ(stats.num_batches, 2);
+  EXPECT_EQ(stats.num_tasks, 3);
+  EXPECT_EQ(stats.num_rejected_tasks, 1);
+  EXPECT_EQ(stats.batch_formation_us.count, 2);
+  EXPECT_DOUBLE_EQ(stats.batch_formation_us.mean, 200);
+  EXPECT_DOUBLE_EQ(stats.batch_formation_us.max, 300);
+  EXPECT_DOUBLE_EQ(stats.queue_delay_us.mean, 20);
+  EXPECT_DOUBLE_EQ(stats.queue_delay_us.max, 30);
+  EXPECT_EQ(stats.processing_us.count, 1);
+  EXPECT_DOUBLE_EQ(stats.processing_us.max, 1000);
+  EXPECT_DOUBLE_EQ(stats.batch_fill_ratio.mean, 0.875);
+  EXPECT_DOUBLE_EQ(stats.batch_fill_ratio.max, 1.0);
+}
+
+TEST(BatchStatsTest, SnapshotResets) {
+  BatchQueueStatsRecorder recorder("model", "op", BatchPriority::kLow);
+  recorder.RecordBatch(/*batch_formation_us=*/100, /*queue_delay_us=*/10,
+                       /*num_tasks=*/1, /*batch_size=*/1,
+                       /*padded_batch_size=*/1);
+  EXPECT_EQ(recorder.Snapshot(/*reset=*/true).num_batches, 1);
+
+  BatchQueueStats stats = recorder.Snapshot();
+  EXPECT_EQ(stats.num_batches, 0);
+  EXPECT_EQ(stats.num_tasks, 0);
+  EXPECT_EQ(stats.queue_delay_us.count, 0);
+  EXPECT_DOUBLE_EQ(stats.queue_delay_us.max, 0);
+}
+
+TEST(BatchStatsTest, Registry) {
+  BatchStatsRegistry registry;
+  EXPECT_FALSE(registry.GetStats("model", "op", BatchPriority::kHigh));
+
+  BatchQueueStatsRecorder* recorder =
+      registry.GetOrCreate("model", "op", BatchPriority::kHigh);
+  EXPECT_EQ(registry.GetOrCreate("model", "op", BatchPriority::kHigh),
+            recorder);
+  EXPECT_NE(registry.GetOrCreate("model", "op", BatchPriority::kLow),
+            recorder);
+  recorder->RecordRejectedTask();
+
+  std::optional<BatchQueueStats> stats =
+      registry.GetStats("model", "op", BatchPriority::kHigh);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_rejected_tasks, 1);
+  EXPECT_EQ(registry.GetAllStats().size(), 2);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
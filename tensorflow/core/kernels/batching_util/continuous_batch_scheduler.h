@@ -0,0 +1,292 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A BatchScheduler for iterative workloads, such as autoregressive decoding,
+// where each task is a sequence which needs a variable number of steps of
+// processing (e.g. one step per generated token).
+//
+// Instead of forming a batch, processing it to completion and then forming the
+// next one, the scheduler keeps a running batch of sequences and processes it
+// one step at a time. Between two steps, finished sequences leave the running
+// batch, and enqueued sequences join it as long as the sum of the task sizes of
+// the running batch stays within `max_batch_size`. Short sequences therefore
+// never wait for the longest sequence of their batch to finish, and new
+// sequences never wait for the running batch to drain.
+//
+// The state of a sequence between its steps (e.g. its attention key/value
+// cache, or a handle to it) lives in its task, which the scheduler owns from
+// Schedule() until the sequence is finished.
+//
+// All steps run on a single thread owned by the scheduler. The destructor
+// blocks until all the scheduled sequences are finished.
+//
+// Type parameter TaskType must be a subclass of BatchTask.
+template <typename TaskType>
+class ContinuousBatchScheduler : public BatchScheduler<TaskType> {
+ public:
+  struct Options {
+    // The name of the thread running the steps.
+    string thread_name = {"continuous_batch_threads"};
+
+    // The maximum sum of the task sizes of the running batch.
+    size_t max_batch_size = 32;
+
+    // The maximum number of enqueued sequences, which have been scheduled but
+    // have not joined the running batch yet. Schedule() returns an UNAVAILABLE
+    // error once this limit is reached.
+    size_t max_enqueued_tasks = 256;
+
+    // The environment to use (typically only overridden by test code).
+    Env* env = Env::Default();
+  };
+
+  // Processes one step of all the sequences of the running batch, and sets
+  // `(*finished)[i]` to true if `tasks[i]` is finished after this step.
+  // `finished` has the size of `tasks`, and is initially all false. Errors
+  // must be recorded in the tasks, and finish them.
+  using StepCallback = std::function<void(const std::vector<TaskType*>& tasks,
+                                          std::vector<bool>* finished)>;
+
+  // Called with each sequence as soon as the step that finished it returns.
+  using DoneCallback = std::function<void(std::unique_ptr<TaskType> task)>;
+
+  static Status Create(const Options& options, StepCallback step_callback,
+                       DoneCallback done_callback,
+                       std::unique_ptr<ContinuousBatchScheduler>* scheduler);
+
+  ~ContinuousBatchScheduler() override;
+
+  Status Schedule(std::unique_ptr<TaskType>* task) override;
+
+  // Returns the number of sequences which have been scheduled but have not
+  // joined the running batch yet.
+  size_t NumEnqueuedTasks() const override;
+
+  // Returns how many more sequences of size 1 can be scheduled before
+  // Schedule() returns UNAVAILABLE.
+  size_t SchedulingCapacity() const override;
+
+  size_t max_task_size() const override { return options_.max_batch_size; }
+
+  // Returns the number of sequences in the running batch.
+  size_t NumRunningTasks() const;
+
+ private:
+  ContinuousBatchScheduler(const Options& options, StepCallback step_callback,
+                           DoneCallback done_callback);
+
+  // Runs steps until the scheduler is destroyed and all the sequences are
+  // finished.
+  void ThreadLogic();
+
+  const Options options_;
+  const StepCallback step_callback_;
+  const DoneCallback done_callback_;
+
+  mutable mutex mu_;
+  condition_variable tasks_cv_;
+
+  // Whether the destructor has started. No sequence can be scheduled then.
+  bool closed_ TF_GUARDED_BY(mu_) = false;
+
+  // The sequences waiting to join the running batch, in scheduling order.
+  std::deque<std::unique_ptr<TaskType>> enqueued_tasks_ TF_GUARDED_BY(mu_);
+
+  // The sequences of the running batch. Only accessed by the step thread.
+  std::vector<std::unique_ptr<TaskType>> running_tasks_;
+
+  // The number of sequences of the running batch.
+  size_t num_running_tasks_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+
+  ContinuousBatchScheduler(const ContinuousBatchScheduler&) = delete;
+  void operator=(const ContinuousBatchScheduler&) = delete;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Create(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback,
+    std::unique_ptr<ContinuousBatchScheduler>* scheduler) {
+  if (options.max_batch_size == 0) {
+    return errors::InvalidArgument("max_batch_size must be positive; was ",
+                                   options.max_batch_size);
+  }
+  if (options.max_enqueued_tasks == 0) {
+    return errors::InvalidArgument("max_enqueued_tasks must be positive; was ",
+                                   options.max_enqueued_tasks);
+  }
+  if (step_callback == nullptr || done_callback == nullptr) {
+    return errors::InvalidArgument(
+        "step_callback and done_callback must be set");
+  }
+  scheduler->reset(new ContinuousBatchScheduler<TaskType>(
+      options, std::move(step_callback), std::move(done_callback)));
+  return OkStatus();
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::ContinuousBatchScheduler(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback)
+    : options_(options),
+      step_callback_(std::move(step_callback)),
+      done_callback_(std::move(done_callback)) {
+  thread_.reset(options_.env->StartThread(
+      {}, options_.thread_name, [this] { this->ThreadLogic(); }));
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::~ContinuousBatchScheduler() {
+  {
+    mutex_lock l(mu_);
+    closed_ = true;
+  }
+  tasks_cv_.notify_all();
+  // Blocks until the step thread has finished all the sequences.
+  thread_.reset();
+}
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Schedule(
+    std::unique_ptr<TaskType>* task) {
+  if ((*task)->size() > options_.max_batch_size) {
+    return errors::InvalidArgument("Task size ", (*task)->size(),
+                                   " is larger than maximum batch size ",
+                                   options_.max_batch_size);
+  }
+  {
+    mutex_lock l(mu_);
+    if (closed_) {
+      return errors::Unavailable("The scheduler is being destroyed");
+    }
+    if (enqueued_tasks_.size() >= options_.max_enqueued_tasks) {
+      return errors::Unavailable(
+          "The continuous batch scheduler is full; currently ",
+          enqueued_tasks_.size(), " tasks enqueued and max_enqueued_tasks is ",
+          options_.max_enqueued_tasks);
+    }
+    enqueued_tasks_.push_back(std::move(*task));
+  }
+  tasks_cv_.notify_one();
+  return OkStatus();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumEnqueuedTasks() const {
+  mutex_lock l(mu_);
+  return enqueued_tasks_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::SchedulingCapacity() const {
+  mutex_lock l(mu_);
+  return options_.max_enqueued_tasks - enqueued_tasks_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumRunningTasks() const {
+  mutex_lock l(mu_);
+  return num_running_tasks_;
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::ThreadLogic() {
+  size_t running_batch_size = 0;
+  for (;;) {
+    {
+      mutex_lock l(mu_);
+      // Waits for work if the running batch is empty.
+      while (running_tasks_.empty() && enqueued_tasks_.empty() && !closed_) {
+        tasks_cv_.wait(l);
+      }
+      if (running_tasks_.empty() && enqueued_tasks_.empty()) {
+        return;
+      }
+      // Admits the enqueued sequences between two steps, in scheduling
+      // order, as long as they fit into the running batch.
+      while (!enqueued_tasks_.empty() &&
+             running_batch_size + enqueued_tasks_.front()->size() <=
+                 options_.max_batch_size) {
+        running_batch_size += enqueued_tasks_.front()->size();
+        running_tasks_.push_back(std::move(enqueued_tasks_.front()));
+        enqueued_tasks_.pop_front();
+      }
+      num_running_tasks_ = running_tasks_.size();
+    }
+
+    std::vector<TaskType*> tasks;
+    tasks.reserve(running_tasks_.size());
+    for (const std::unique_ptr<TaskType>& task : running_tasks_) {
+      tasks.push_back(task.get());
+    }
+    std::vector<bool> finished(tasks.size(), false);
+    {
+      profiler::TraceMe trace_me([&] {
+        return profiler::TraceMeEncode(
+            "ContinuousBatchingStep",
+            {{"num_sequences", tasks.size()},
+             {"batch_size", running_batch_size}});
+      });
+      step_callback_(tasks, &finished);
+    }
+
+    // Releases the finished sequences right away.
+    std::vector<std::unique_ptr<TaskType>> unfinished_tasks;
+    unfinished_tasks.reserve(running_tasks_.size());
+    for (int i = 0; i < running_tasks_.size(); ++i) {
+      if (finished[i]) {
+        running_batch_size -= running_tasks_[i]->size();
+        done_callback_(std::move(running_tasks_[i]));
+      } else {
+        unfinished_tasks.push_back(std::move(running_tasks_[i]));
+      }
+    }
+    running_tasks_ = std::move(unfinished_tasks);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
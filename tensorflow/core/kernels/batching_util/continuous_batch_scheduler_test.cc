@@ -0,0 +1,202 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/continuous_batch_scheduler.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// A sequence which needs `num_steps` steps of processing.
+class FakeTask : public BatchTask {
+ public:
+  FakeTask(int id, int num_steps) : id_(id), remaining_steps_(num_steps) {}
+
+  size_t size() const override { return 1; }
+
+  int id() const { return id_; }
+
+  // Processes one step, and returns whether the sequence is finished.
+  bool Step() { return --remaining_steps_ == 0; }
+
+ private:
+  const int id_;
+  int remaining_steps_;
+};
+
+Status ScheduleTask(int id, int num_steps,
+                    ContinuousBatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(new FakeTask(id, num_steps));
+  Status status = scheduler->Schedule(&task);
+  // Schedule() should have consumed 'task' iff it returned Status::OK.
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
+// Records the steps and finished sequences of a scheduler. The first step
+// blocks until `Unblock()` is called, so that tests can schedule sequences
+// while a step is running.
+class StepRecorder {
+ public:
+  ContinuousBatchScheduler<FakeTask>::StepCallback step_callback() {
+    return [this](const std::vector<FakeTask*>& tasks,
+                  std::vector<bool>* finished) {
+      {
+        mutex_lock l(mu_);
+        step_sizes_.push_back(tasks.size());
+      }
+      if (!first_step_started_.HasBeenNotified()) {
+        first_step_started_.Notify();
+        unblock_.WaitForNotification();
+      }
+      for (int i = 0; i < tasks.size(); ++i) {
+        (*finished)[i] = tasks[i]->Step();
+      }
+    };
+  }
+
+  ContinuousBatchScheduler<FakeTask>::DoneCallback done_callback() {
+    return [this](std::unique_ptr<FakeTask> task) {
+      mutex_lock l(mu_);
+      finished_ids_.push_back(task->id());
+    };
+  }
+
+  void WaitForFirstStep() { first_step_started_.WaitForNotification(); }
+
+  void Unblock() { unblock_.Notify(); }
+
+  std::vector<int> step_sizes() const {
+    mutex_lock l(mu_);
+    return step_sizes_;
+  }
+
+  std::vector<int> finished_ids() const {
+    mutex_lock l(mu_);
+    return finished_ids_;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::vector<int> step_sizes_ TF_GUARDED_BY(mu_);
+  std::vector<int> finished_ids_ TF_GUARDED_BY(mu_);
+  Notification first_step_started_;
+  Notification unblock_;
+};
+
+TEST(ContinuousBatchSchedulerTest, AdmitsAndReleasesSequencesBetweenSteps) {
+  StepRecorder recorder;
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    options.max_batch_size = 4;
+    std::unique_ptr<ContinuousBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(ContinuousBatchScheduler<FakeTask>::Create(
+        options, recorder.step_callback(), recorder.done_callback(),
+        &scheduler));
+    TF_ASSERT_OK(ScheduleTask(/*id=*/0, /*num_steps=*/2, scheduler.get()));
+    recorder.WaitForFirstStep();
+    // Sequences 1 and 2 join the running batch after the first step.
+    TF_ASSERT_OK(ScheduleTask(/*id=*/1, /*num_steps=*/1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleTask(/*id=*/2, /*num_steps=*/3, scheduler.get()));
+    EXPECT_EQ(scheduler->NumEnqueuedTasks(), 2);
+    recorder.Unblock();
+  }
+  EXPECT_EQ(recorder.step_sizes(), std::vector<int>({1, 3, 1, 1}));
+  EXPECT_EQ(recorder.finished_ids(), std::vector<int>({0, 1, 2}));
+}
+
+TEST(ContinuousBatchSchedulerTest, ObeysMaxBatchSize) {
+  StepRecorder recorder;
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    options.max_batch_size = 2;
+    std::unique_ptr<ContinuousBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(ContinuousBatchScheduler<FakeTask>::Create(
+        options, recorder.step_callback(), recorder.done_callback(),
+        &scheduler));
+    TF_ASSERT_OK(ScheduleTask(/*id=*/0, /*num_steps=*/3, scheduler.get()));
+    recorder.WaitForFirstStep();
+    TF_ASSERT_OK(ScheduleTask(/*id=*/1, /*num_steps=*/1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleTask(/*id=*/2, /*num_steps=*/1, scheduler.get()));
+    recorder.Unblock();
+  }
+  // Sequence 2 takes the place of sequence 1 once it is finished.
+  EXPECT_EQ(recorder.step_sizes(), std::vector<int>({1, 2, 2}));
+  EXPECT_EQ(recorder.finished_ids(), std::vector<int>({1, 0, 2}));
+}
+
+TEST(ContinuousBatchSchedulerTest, RejectsTasksWhenFull) {
+  StepRecorder recorder;
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    options.max_enqueued_tasks = 1;
+    std::unique_ptr<ContinuousBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(ContinuousBatchScheduler<FakeTask>::Create(
+        options, recorder.step_callback(), recorder.done_callback(),
+        &scheduler));
+    TF_ASSERT_OK(ScheduleTask(/*id=*/0, /*num_steps=*/1, scheduler.get()));
+    recorder.WaitForFirstStep();
+    EXPECT_EQ(scheduler->NumRunningTasks(), 1);
+    TF_ASSERT_OK(ScheduleTask(/*id=*/1, /*num_steps=*/1, scheduler.get()));
+    EXPECT_EQ(scheduler->SchedulingCapacity(), 0);
+    EXPECT_TRUE(errors::IsUnavailable(
+        ScheduleTask(/*id=*/2, /*num_steps=*/1, scheduler.get())));
+    recorder.Unblock();
+  }
+  EXPECT_EQ(recorder.finished_ids(), std::vector<int>({0, 1}));
+}
+
+TEST(ContinuousBatchSchedulerTest, BadOptions) {
+  StepRecorder recorder;
+  std::unique_ptr<ContinuousBatchScheduler<FakeTask>> scheduler;
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    options.max_batch_size = 0;
+    EXPECT_FALSE(ContinuousBatchScheduler<FakeTask>::Create(
+                     options, recorder.step_callback(),
+                     recorder.done_callback(), &scheduler)
+                     .ok());
+  }
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    options.max_enqueued_tasks = 0;
+    EXPECT_FALSE(ContinuousBatchScheduler<FakeTask>::Create(
+                     options, recorder.step_callback(),
+                     recorder.done_callback(), &scheduler)
+                     .ok());
+  }
+  {
+    ContinuousBatchScheduler<FakeTask>::Options options;
+    EXPECT_FALSE(ContinuousBatchScheduler<FakeTask>::Create(
+                     options, nullptr, recorder.done_callback(), &scheduler)
+                     .ok());
+  }
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
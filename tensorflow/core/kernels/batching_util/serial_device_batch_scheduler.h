@@ -18,10 +18,12 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <random>
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/serving_device_selector.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -61,6 +63,11 @@ class SDBSQueue;
 // processing thread becomes available. SDBS prioritizes batches primarily by
 // age (i.e. the batch's oldest request) along with a configurable preference
 // for scheduling larger batches first.
+//
+// On hosts with several serial devices, SDBS keeps a separate limit for each
+// device, tuned from the feedback of that device, and the overall limit is
+// their sum. Each batch is routed to the least loaded device, or to the device
+// chosen by a ServingDeviceSelector.
 
 
 template <typename TaskType>
@@ -83,11 +90,25 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     int64_t full_batch_scheduling_boost_micros = 0;
     // The environment to use (typically only overridden by test code).
     Env* env = Env::Default();
-    // Initial limit for number of batches being concurrently processed.
+    // Initial limit for number of batches being concurrently processed, per
+    // device.
     int64_t initial_in_flight_batches_limit = 3;
     // Returns the current number of batches directly waiting to be processed
-    // by the serial device (i.e. GPU, TPU).
+    // by the serial device (i.e. GPU, TPU). Only used with a single device.
     std::function<int64()> get_pending_on_serial_device;
+    // The number of serial devices processing the batches.
+    int num_devices = 1;
+    // Returns the current number of batches directly waiting to be processed
+    // by the serial device `device_index` in [0, num_devices). Required if
+    // `num_devices` is larger than 1.
+    std::function<int64(int device_index)> get_pending_on_device;
+    // If set, chooses the device processing each batch, which is reserved
+    // while the batch is processed. Otherwise a batch is routed to the device
+    // with the smallest number of in-flight batches relative to its limit.
+    // The selector must outlive the scheduler, and select a device in
+    // [0, num_devices). `thread_pool_name` is the program fingerprint passed
+    // to the selector.
+    ServingDeviceSelector* device_selector = nullptr;
     // Desired average number of batches directly waiting to be processed by the
     // serial device. Small numbers of O(1) should deliver the best latency.
     double target_pending = 2;
@@ -112,16 +133,32 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
 
+  // Processes a batch on the device `device_index`.
+  using DeviceBatchProcessor = std::function<void(
+      std::unique_ptr<Batch<TaskType>>, int device_index)>;
+
   // Adds queue (and its callback) to be managed by this scheduler.
   Status AddQueue(const QueueOptions& options,
                   BatchProcessor process_batch_callback,
                   std::unique_ptr<BatchScheduler<TaskType>>* queue);
 
+  // Same as above, for callbacks which process the batches on the device SDBS
+  // routed them to.
+  Status AddQueue(const QueueOptions& options,
+                  DeviceBatchProcessor process_batch_callback,
+                  std::unique_ptr<BatchScheduler<TaskType>>* queue);
+
+  // Returns the sum of the limits of all the devices.
   double in_flight_batches_limit() {
     mutex_lock l(mu_);
     return in_flight_batches_limit_;
   }
 
+  double in_flight_batches_limit(int device_index) {
+    mutex_lock l(mu_);
+    return devices_[device_index].in_flight_batches_limit;
+  }
+
   double recent_low_traffic_ratio() {
     mutex_lock l(mu_);
     return recent_low_traffic_ratio_;
@@ -142,42 +179,70 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   // Removes queue from scheduler.
   void RemoveQueue(const internal::SDBSQueue<TaskType>* queue);
 
+  // Returns the device with the fewest in-flight batches relative to its
+  // limit, preferably one below its limit.
+  int SelectLeastLoadedDevice() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the number of batches directly waiting on the device.
+  int64_t GetPendingOnDevice(int device_index) const;
+
+  // Adjusts the in-flight batches limit of the device from the feedback
+  // collected over its last `batches_to_average_over` batches.
+  void AdjustInFlightBatchesLimit(int device_index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Env* env() const { return options_.env; }
 
   const Options options_;
 
+  // The state of a serial device.
+  struct DeviceState {
+    // Limit on number of batches which can be concurrently processed by the
+    // device.
+    int64_t in_flight_batches_limit = 0;
+    // Number of batches being processed by the device.
+    int64_t in_flight_batches = 0;
+    // Number of batches processed by the device since the last adjustment of
+    // its limit.
+    int64_t batch_count = 0;
+    // Sum of batches pending on the device since the last adjustment.
+    int64_t pending_sum = 0;
+    // Sum of the latencies of the batches of the device since the last
+    // adjustment.
+    int64_t batch_latency_sum = 0;
+    // Values of `batch_count_` and `no_batch_count_` at the last adjustment.
+    int64_t start_batch_count = 0;
+    int64_t start_no_batch_count = 0;
+  };
+
   // Collection of batches added by AddBatch. Owned by scheduler until they are
   // released for processing.
   std::vector<const internal::SDBSBatch<TaskType>*> batches_ TF_GUARDED_BY(mu_);
 
   // Unowned queues and callbacks added by AddQueue.
-  std::unordered_map<const internal::SDBSQueue<TaskType>*, BatchProcessor>
+  std::unordered_map<const internal::SDBSQueue<TaskType>*,
+                     DeviceBatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
+  std::vector<DeviceState> devices_ TF_GUARDED_BY(mu_);
+
   // Responsible for running the batch processing callbacks.
   std::unique_ptr<thread::ThreadPool> batch_thread_pool_;
 
-  // Limit on number of batches which can be concurrently processed.
+  // Limit on number of batches which can be concurrently processed, i.e. the
+  // sum of the limits of the devices.
   int64_t in_flight_batches_limit_ TF_GUARDED_BY(mu_);
 
   // Number of batch processing threads.
   int64_t processing_threads_ TF_GUARDED_BY(mu_) = 0;
 
-  // Number of batches processed since the last in_flight_batches_limit_
-  // adjustment.
+  // Number of batches processed.
   int64_t batch_count_ TF_GUARDED_BY(mu_) = 0;
 
-  // Number of times since the last in_flight_batches_limit_ adjustment when a
-  // processing thread was available but there were no batches to process.
+  // Number of times when a processing thread was available but there were no
+  // batches to process.
   int64_t no_batch_count_ TF_GUARDED_BY(mu_) = 0;
 
-  // Sum of batches pending on the serial device since the last
-  // in_flight_batches_limit_ adjustment.
-  int64_t pending_sum_ = 0;
-
-  // Sum of batch latencies since the last in_flight_batches_limit_ adjustment.
-  int64_t batch_latency_sum_ = 0;
-
   // Average period between which two consecutive batches begin processing.
   int64_t batch_period_micros_ = 0;
 
@@ -274,11 +339,16 @@ Status SerialDeviceBatchScheduler<TaskType>::Create(
         "initial_in_flight_batches_limit must be positive; was ",
         options.initial_in_flight_batches_limit);
   }
-  if (options.initial_in_flight_batches_limit > options.num_batch_threads) {
+  if (options.num_devices < 1) {
+    return errors::InvalidArgument("num_devices must be positive; was ",
+                                   options.num_devices);
+  }
+  if (options.initial_in_flight_batches_limit * options.num_devices >
+      options.num_batch_threads) {
     return errors::InvalidArgument(
         "initial_in_flight_batches_limit (",
-        options.initial_in_flight_batches_limit,
-        ") should not be larger than num_batch_threads (",
+        options.initial_in_flight_batches_limit, ") times num_devices (",
+        options.num_devices, ") should not be larger than num_batch_threads (",
         options.num_batch_threads, ")");
   }
   if (options.full_batch_scheduling_boost_micros < 0) {
@@ -297,7 +367,11 @@ Status SerialDeviceBatchScheduler<TaskType>::Create(
         "target_pending should be larger than zero; was ",
         options.target_pending);
   }
-  if (!options.get_pending_on_serial_device) {
+  if (options.num_devices > 1 && !options.get_pending_on_device) {
+    return errors::InvalidArgument(
+        "get_pending_on_device must be specified with several devices");
+  }
+  if (!options.get_pending_on_serial_device && !options.get_pending_on_device) {
     return errors::InvalidArgument(
         "get_pending_on_serial_device must be "
         "specified");
@@ -310,8 +384,13 @@ template <typename TaskType>
 SerialDeviceBatchScheduler<TaskType>::SerialDeviceBatchScheduler(
     const Options& options)
     : options_(options),
-      in_flight_batches_limit_(options.initial_in_flight_batches_limit),
-      processing_threads_(options.initial_in_flight_batches_limit) {
+      devices_(options.num_devices),
+      in_flight_batches_limit_(options.initial_in_flight_batches_limit *
+                               options.num_devices),
+      processing_threads_(in_flight_batches_limit_) {
+  for (DeviceState& device : devices_) {
+    device.in_flight_batches_limit = options.initial_in_flight_batches_limit;
+  }
   batch_thread_pool_.reset(new thread::ThreadPool(
       env(), options.thread_pool_name, options.num_batch_threads));
   for (int i = 0; i < processing_threads_; i++) {
@@ -335,6 +414,20 @@ template <typename TaskType>
 Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
     const QueueOptions& options, BatchProcessor process_batch_callback,
     std::unique_ptr<BatchScheduler<TaskType>>* queue) {
+  return AddQueue(
+      options,
+      DeviceBatchProcessor(
+          [process_batch_callback = std::move(process_batch_callback)](
+              std::unique_ptr<Batch<TaskType>> batch, int device_index) {
+            process_batch_callback(std::move(batch));
+          }),
+      queue);
+}
+
+template <typename TaskType>
+Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
+    const QueueOptions& options, DeviceBatchProcessor process_batch_callback,
+    std::unique_ptr<BatchScheduler<TaskType>>* queue) {
   if (options.max_batch_size <= 0) {
     return errors::InvalidArgument("max_batch_size must be positive; was ",
                                    options.max_batch_size);
@@ -366,11 +459,39 @@ void SerialDeviceBatchScheduler<TaskType>::RemoveQueue(
   queues_and_callbacks_.erase(queue);
 }
 
+template <typename TaskType>
+int SerialDeviceBatchScheduler<TaskType>::SelectLeastLoadedDevice() {
+  int best_device = 0;
+  bool best_has_capacity = false;
+  double best_load = 0;
+  for (int i = 0; i < devices_.size(); ++i) {
+    const DeviceState& device = devices_[i];
+    const bool has_capacity =
+        device.in_flight_batches < device.in_flight_batches_limit;
+    const double load = device.in_flight_batches /
+                        static_cast<double>(device.in_flight_batches_limit);
+    if (i == 0 || (has_capacity && !best_has_capacity) ||
+        (has_capacity == best_has_capacity && load < best_load)) {
+      best_device = i;
+      best_has_capacity = has_capacity;
+      best_load = load;
+    }
+  }
+  return best_device;
+}
+
+template <typename TaskType>
+int64_t SerialDeviceBatchScheduler<TaskType>::GetPendingOnDevice(
+    int device_index) const {
+  if (options_.get_pending_on_device) {
+    return options_.get_pending_on_device(device_index);
+  }
+  return options_.get_pending_on_serial_device();
+}
+
 template <typename TaskType>
 void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
   const int64_t kIdleThreadSleepTimeMicros = 1000;
-  const double kMaxNoBatchRatio = .1;
-  const double kLowTrafficMovingAverageFactor = .1;
   for (;;) {
     mu_.lock();
     if (processing_threads_ < 1 ||
@@ -407,60 +528,97 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
     // Queue may destroy itself after ReleaseBatch is called.
     batch->queue()->ReleaseBatch(batch);
     auto callback = queues_and_callbacks_[batch->queue()];
+    int device_index = 0;
+    if (options_.device_selector == nullptr) {
+      device_index = SelectLeastLoadedDevice();
+      devices_[device_index].in_flight_batches++;
+    }
     mu_.unlock();
+    // The reservation is released once the batch is processed.
+    std::optional<DeviceReservation> reservation;
+    if (options_.device_selector != nullptr) {
+      reservation.emplace(
+          options_.device_selector->ReserveDevice(options_.thread_pool_name));
+      device_index = reservation->device_index();
+      DCHECK_GE(device_index, 0);
+      DCHECK_LT(device_index, options_.num_devices);
+      mutex_lock l(mu_);
+      devices_[device_index].in_flight_batches++;
+    }
     int64_t start_time = env()->NowMicros();
     callback(std::unique_ptr<Batch<TaskType>>(
-        const_cast<internal::SDBSBatch<TaskType>*>(batch)));
+                 const_cast<internal::SDBSBatch<TaskType>*>(batch)),
+             device_index);
     int64_t end_time = env()->NowMicros();
+    reservation.reset();
     mu_.lock();
     batch_count_++;
-    batch_latency_sum_ += end_time - start_time;
-    pending_sum_ += options_.get_pending_on_serial_device();
-    if (batch_count_ == options_.batches_to_average_over) {
-      recent_low_traffic_ratio_ *= (1 - kLowTrafficMovingAverageFactor);
-      // Only adjust in_flight_batches_limit_ if external load is large enough
-      // to consistently provide batches. Otherwise we would (mistakenly) assume
-      // that the device is underutilized because in_flight_batches_limit_ is
-      // too small.
-      if (no_batch_count_ < kMaxNoBatchRatio * batch_count_) {
-        double avg_pending = pending_sum_ / static_cast<double>(batch_count_);
-        // Avg processing time / # of concurrent batches gives the avg period
-        // between which two consecutive batches begin processing. Used to set a
-        // reasonable sleep time for idle batch processing threads.
-        batch_period_micros_ =
-            batch_latency_sum_ / batch_count_ / in_flight_batches_limit_;
-        // When the processing pipeline is consistently busy, the average number
-        // of pending batches differs from in_flight_batches_limit_ by a
-        // load-dependent offset. Adjust in_flight_batches_limit_to maintain
-        // the desired target pending.
-        in_flight_batches_limit_ +=
-            std::round(options_.target_pending - avg_pending);
-        in_flight_batches_limit_ =
-            std::max(in_flight_batches_limit_, int64_t{1});
-        in_flight_batches_limit_ =
-            std::min(in_flight_batches_limit_, options_.num_batch_threads);
-        // Add extra processing threads if necessary.
-        if (processing_threads_ > 0 &&
-            processing_threads_ < in_flight_batches_limit_) {
-          int extra_threads = in_flight_batches_limit_ - processing_threads_;
-          for (int i = 0; i < extra_threads; i++) {
-            batch_thread_pool_->Schedule(std::bind(
-                &SerialDeviceBatchScheduler<TaskType>::ProcessBatches, this));
-          }
-          processing_threads_ = in_flight_batches_limit_;
-        }
-      } else {
-        recent_low_traffic_ratio_ += kLowTrafficMovingAverageFactor;
-      }
-      batch_count_ = 0;
-      no_batch_count_ = 0;
-      pending_sum_ = 0;
-      batch_latency_sum_ = 0;
+    DeviceState& device = devices_[device_index];
+    device.in_flight_batches--;
+    device.batch_count++;
+    device.batch_latency_sum += end_time - start_time;
+    device.pending_sum += GetPendingOnDevice(device_index);
+    if (device.batch_count == options_.batches_to_average_over) {
+      AdjustInFlightBatchesLimit(device_index);
     }
     mu_.unlock();
   }
 }
 
+template <typename TaskType>
+void SerialDeviceBatchScheduler<TaskType>::AdjustInFlightBatchesLimit(
+    int device_index) {
+  const double kMaxNoBatchRatio = .1;
+  const double kLowTrafficMovingAverageFactor = .1;
+  DeviceState& device = devices_[device_index];
+  recent_low_traffic_ratio_ *= (1 - kLowTrafficMovingAverageFactor);
+  // Only adjust the limit if external load is large enough to consistently
+  // provide batches. Otherwise we would (mistakenly) assume that the device is
+  // underutilized because its limit is too small.
+  if (no_batch_count_ - device.start_no_batch_count <
+      kMaxNoBatchRatio * (batch_count_ - device.start_batch_count)) {
+    double avg_pending =
+        device.pending_sum / static_cast<double>(device.batch_count);
+    // Avg processing time / # of concurrent batches gives the avg period
+    // between which two consecutive batches begin processing on the device,
+    // and the devices process batches in parallel. Used to set a reasonable
+    // sleep time for idle batch processing threads.
+    batch_period_micros_ = device.batch_latency_sum / device.batch_count /
+                           device.in_flight_batches_limit / devices_.size();
+    // When the processing pipeline is consistently busy, the average number
+    // of pending batches differs from the limit by a load-dependent offset.
+    // Adjust the limit to maintain the desired target pending.
+    const int64_t other_devices_limit =
+        in_flight_batches_limit_ - device.in_flight_batches_limit;
+    device.in_flight_batches_limit +=
+        std::round(options_.target_pending - avg_pending);
+    device.in_flight_batches_limit =
+        std::max(device.in_flight_batches_limit, int64_t{1});
+    device.in_flight_batches_limit =
+        std::min(device.in_flight_batches_limit,
+                 options_.num_batch_threads - other_devices_limit);
+    in_flight_batches_limit_ =
+        other_devices_limit + device.in_flight_batches_limit;
+    // Add extra processing threads if necessary.
+    if (processing_threads_ > 0 &&
+        processing_threads_ < in_flight_batches_limit_) {
+      int extra_threads = in_flight_batches_limit_ - processing_threads_;
+      for (int i = 0; i < extra_threads; i++) {
+        batch_thread_pool_->Schedule(std::bind(
+            &SerialDeviceBatchScheduler<TaskType>::ProcessBatches, this));
+      }
+      processing_threads_ = in_flight_batches_limit_;
+    }
+  } else {
+    recent_low_traffic_ratio_ += kLowTrafficMovingAverageFactor;
+  }
+  device.batch_count = 0;
+  device.pending_sum = 0;
+  device.batch_latency_sum = 0;
+  device.start_batch_count = batch_count_;
+  device.start_no_batch_count = no_batch_count_;
+}
+
 // ---------------- SDBSQueue ----------------
 
 namespace internal {
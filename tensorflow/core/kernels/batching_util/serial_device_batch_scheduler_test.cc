@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/serial_device_batch_scheduler.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/serving_device_selector.h"
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -390,6 +396,154 @@ TEST(SerialDeviceBatchSchedulerTest, QueueCapacityInfo) {
   EXPECT_EQ(queue2->SchedulingCapacity(), 8 * 1000 + 300);
   finish_processing.Notify();
 }
+
+TEST(SerialDeviceBatchSchedulerTest, MultipleDevicesBadOptions) {
+  using Scheduler = SerialDeviceBatchScheduler<FakeTask>;
+  std::shared_ptr<Scheduler> scheduler;
+  Scheduler::Options default_options;
+  default_options.num_batch_threads = 4;
+  default_options.initial_in_flight_batches_limit = 2;
+  default_options.num_devices = 2;
+  default_options.get_pending_on_device = [](int device_index) { return 0; };
+  TF_EXPECT_OK(Scheduler::Create(default_options, &scheduler));
+  Scheduler::Options options = default_options;
+  options.num_devices = 0;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = default_options;
+  options.num_devices = 3;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = default_options;
+  options.get_pending_on_device = nullptr;
+  options.get_pending_on_serial_device = []() { return 0; };
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+}
+
+TEST(SerialDeviceBatchSchedulerTest, RoutesToLeastLoadedDevice) {
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 2;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_devices = 2;
+  options.get_pending_on_device = [](int device_index) { return 0; };
+  mutex mu;
+  std::vector<int> device_indices;
+  Notification finish_processing;
+  auto queue_callback = [&mu, &device_indices, &finish_processing](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            int device_index) {
+    bool both_started;
+    {
+      mutex_lock l(mu);
+      device_indices.push_back(device_index);
+      both_started = device_indices.size() == 2;
+    }
+    // Both batches are in flight at the same time, one on each device.
+    if (both_started) {
+      finish_processing.Notify();
+    }
+    finish_processing.WaitForNotification();
+  };
+  {
+    std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+    std::unique_ptr<BatchScheduler<FakeTask>> queue1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue2;
+    TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue1));
+    TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue2));
+    TF_ASSERT_OK(ScheduleTask(100, queue1.get()));
+    TF_ASSERT_OK(ScheduleTask(100, queue2.get()));
+  }
+  std::sort(device_indices.begin(), device_indices.end());
+  EXPECT_EQ(device_indices, (std::vector<int>{0, 1}));
+}
+
+TEST(SerialDeviceBatchSchedulerTest, PerDeviceInFlightBatchesLimit) {
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 4;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_devices = 2;
+  options.batches_to_average_over = 1;
+  options.target_pending = 3;
+  // Device 0 is underutilized, device 1 is at its target.
+  options.get_pending_on_device = [](int device_index) {
+    return device_index == 0 ? 1 : 3;
+  };
+  const int kNumBatches = 50;
+  mutex mu;
+  int processed_batches = 0;
+  condition_variable processed_cv;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            int device_index) {
+    Env::Default()->SleepForMicroseconds(100);
+    mutex_lock l(mu);
+    ++processed_batches;
+    processed_cv.notify_all();
+  };
+  std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(
+      SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  SerialDeviceBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 1;
+  queue_options.max_enqueued_batches = kNumBatches;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+  for (int i = 0; i < kNumBatches; i++) {
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  }
+  {
+    mutex_lock l(mu);
+    while (processed_batches < kNumBatches) {
+      processed_cv.wait(l);
+    }
+  }
+  // The limit of device 0 grows up to the threads left by device 1.
+  EXPECT_EQ(scheduler->in_flight_batches_limit(0), 3);
+  EXPECT_EQ(scheduler->in_flight_batches_limit(1), 1);
+  EXPECT_EQ(scheduler->in_flight_batches_limit(), 4);
+}
+
+// Always selects the last device.
+class LastDeviceSelector : public ServingDeviceSelector {
+ public:
+  explicit LastDeviceSelector(int num_devices) : num_devices_(num_devices) {}
+
+  DeviceReservation ReserveDevice(
+      absl::string_view program_fingerprint) override {
+    return DeviceReservation(num_devices_ - 1, this);
+  }
+
+ private:
+  void FreeDeviceReservation(const DeviceReservation& reservation) override {}
+
+  const int num_devices_;
+};
+
+TEST(SerialDeviceBatchSchedulerTest, DeviceSelector) {
+  LastDeviceSelector device_selector(/*num_devices=*/2);
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 2;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_devices = 2;
+  options.get_pending_on_device = [](int device_index) { return 0; };
+  options.device_selector = &device_selector;
+  mutex mu;
+  std::vector<int> device_indices;
+  auto queue_callback = [&mu, &device_indices](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            int device_index) {
+    mutex_lock l(mu);
+    device_indices.push_back(device_index);
+  };
+  {
+    std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue));
+    TF_ASSERT_OK(ScheduleTask(100, queue.get()));
+  }
+  EXPECT_EQ(device_indices, std::vector<int>{1});
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
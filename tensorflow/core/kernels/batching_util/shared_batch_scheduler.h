@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <list>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "absl/time/clock.h"
 #include "absl/types/variant.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -227,6 +229,28 @@ class SharedBatchScheduler
     // inputs into two sub queues.
     bool enable_priority_queue = false;
 
+    // If true, the open batch also becomes schedulable once waiting any longer
+    // would make one of its tasks miss its deadline (see
+    // `BatchTask::deadline_micros()`), given the processing latency predicted
+    // for the batch by a model learned from the latencies of the batches
+    // processed so far. `batch_timeout_micros` still bounds the time a batch
+    // stays open, including for tasks without a deadline.
+    //
+    // This forms batches as large as the deadlines allow under low load, and
+    // small batches that meet the deadlines under bursty load, instead of
+    // waiting for a fixed timeout.
+    bool enable_deadline_based_batching = false;
+
+    // If true, concurrent Schedule() calls publish their tasks to a lock-free
+    // list, and the caller that acquires the queue lock enqueues all the
+    // published tasks in publication order on behalf of the others, which wait
+    // for their task to be enqueued without taking the lock. This replaces
+    // one lock handoff per task by one per group of concurrent tasks under
+    // high-QPS contention, with the same ordering and capacity semantics.
+    //
+    // Ignored if `enable_lazy_split` is true.
+    bool enable_combining_enqueue = false;
+
     // A separate set of queue options for different priority inputs.
     // Use iff `enable_priority_queue` is true.
     struct PriorityQueueOptions {
@@ -409,6 +433,32 @@ class Queue {
     }
   }
 
+  // A task published by `ScheduleWithCombining`, and waiting to be enqueued
+  // by the holder of 'mu_'. Lives on the stack of the publishing thread.
+  struct PendingTask {
+    std::unique_ptr<TaskType>* task;
+    Status status;
+    PendingTask* next = nullptr;
+    // Set once `task` was enqueued (or rejected with `status`), after which
+    // the publishing thread may destroy this object.
+    std::atomic<bool> done{false};
+  };
+
+  // Enqueues `task` as it is OR splits it inline (eagerly), and sets
+  // `notify_of_schedulable_batch` if a batch became schedulable. Leaves `task`
+  // untouched on error.
+  Status EnqueueTask(std::unique_ptr<TaskType>* task,
+                     bool* notify_of_schedulable_batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Publishes `task` to 'pending_tasks_', and waits until it is enqueued by
+  // this or another thread. Used iff `QueueOptions.enable_combining_enqueue`.
+  Status ScheduleWithCombining(std::unique_ptr<TaskType>* task);
+
+  // Enqueues all the tasks of 'pending_tasks_' in publication order. Returns
+  // whether a batch became schedulable.
+  bool EnqueuePendingTasks() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -431,6 +481,16 @@ class Queue {
   bool IsOpenBatchSchedulableAfterEagerSplit() const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Whether waiting any longer for tasks to join the open batch of size
+  // `open_batch_size` would make one of its tasks miss its deadline. Always
+  // false if `QueueOptions.enable_deadline_based_batching` is false.
+  bool IsOpenBatchDeadlineReached(size_t open_batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Updates the deadline of the open batch after `task` was added to it.
+  void UpdateOpenBatchDeadline(uint64 task_deadline_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Same as SchedulingCapacity(), but assumes the caller already holds a
   // lock on 'mu_'.
   size_t SchedulingCapacityInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -480,6 +540,10 @@ class Queue {
   // for the duration of this object's life.
   std::atomic<bool> closed_ TF_GUARDED_BY(mu_){false};
 
+  // The tasks published by `ScheduleWithCombining` and not enqueued yet, most
+  // recently published first.
+  std::atomic<PendingTask*> pending_tasks_{nullptr};
+
   // The enqueued batches.
   //
   // Each element corresponds to the `task` enqueued in `Queue::Schedule`; the
@@ -513,6 +577,16 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks of the open (back-most) batch, or 0 if
+  // none of them has a deadline. Only maintained if
+  // `QueueOptions.enable_deadline_based_batching` is true.
+  uint64 open_batch_deadline_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // Predicts the processing latency of the open batch from the latencies of
+  // the batches processed so far. Only used if
+  // `QueueOptions.enable_deadline_based_batching` is true.
+  BatchLatencyModel latency_model_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -826,6 +900,7 @@ template <typename TaskType>
 Queue<TaskType>::~Queue() {
   mutex_lock l(mu_);
   DCHECK(IsEmptyInternal());
+  DCHECK(pending_tasks_.load() == nullptr);
 
   // Close the (empty) open batch, so its destructor doesn't block.
   if (options_.enable_lazy_split) {
@@ -857,6 +932,8 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
   });
   // The max size to be enqueued.
   const int max_execution_batch_size = options_.max_execution_batch_size;
+  // The tasks split from `task` share its deadline.
+  const uint64 task_deadline_micros = (*task)->deadline_micros();
 
   bool notify_of_schedulable_batch = false;
   {
@@ -883,7 +960,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
+        open_batch_deadline_micros_ = 0;
       }
+      UpdateOpenBatchDeadline(task_deadline_micros);
       profiler::TraceMeProducer trace_me(
           [&task_handles, i] {
             return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -926,65 +1005,139 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         {{"batching_input_task_size", (*task)->size()}});
   });
 
+  if (options_.enable_combining_enqueue) {
+    return ScheduleWithCombining(task);
+  }
+
   bool notify_of_schedulable_batch = false;
   {
     mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(EnqueueTask(task, &notify_of_schedulable_batch));
+  }
 
-    DCHECK(!closed_);
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
 
-    // TODO(b/161857471):
-    // Add test coverage when when concurrent incoming batches arrives and
-    // use up all queue capacity.
-    TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+  return OkStatus();
+}
 
-    std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+template <typename TaskType>
+Status Queue<TaskType>::EnqueueTask(std::unique_ptr<TaskType>* task,
+                                    bool* notify_of_schedulable_batch) {
+  DCHECK(!closed_);
 
-    const int64_t open_batch_remaining_slot =
-        max_execution_batch_size() - batches.back()->size();
+  const bool large_batch_splitting = options_.enable_large_batch_splitting;
+  const uint64 task_deadline_micros = (*task)->deadline_micros();
 
-    const int64_t input_task_size = (*task)->size();
+  // TODO(b/161857471):
+  // Add test coverage when when concurrent incoming batches arrives and
+  // use up all queue capacity.
+  TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
 
-    std::vector<std::unique_ptr<TaskType>> output_tasks;
+  std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
 
-    if (input_task_size <= open_batch_remaining_slot ||
-        !large_batch_splitting) {
-      // This is the fast path when input doesn't need to be split.
-      output_tasks.push_back(std::move(*task));
-    } else {
-      TF_RETURN_IF_ERROR(SplitInputBatchIntoSubtasks(task, &output_tasks));
+  const int64_t open_batch_remaining_slot =
+      max_execution_batch_size() - batches.back()->size();
+
+  const int64_t input_task_size = (*task)->size();
+
+  std::vector<std::unique_ptr<TaskType>> output_tasks;
+
+  if (input_task_size <= open_batch_remaining_slot || !large_batch_splitting) {
+    // This is the fast path when input doesn't need to be split.
+    output_tasks.push_back(std::move(*task));
+  } else {
+    TF_RETURN_IF_ERROR(SplitInputBatchIntoSubtasks(task, &output_tasks));
+  }
+
+  for (int i = 0; i < output_tasks.size(); ++i) {
+    if (batches.back()->size() + output_tasks[i]->size() >
+        max_execution_batch_size()) {
+      StartNewBatch();
+    }
+    if (batches.back()->empty()) {
+      open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_deadline_micros_ = 0;
     }
+    UpdateOpenBatchDeadline(task_deadline_micros);
+    profiler::TraceMeProducer trace_me(
+        [&output_tasks, i] {
+          return profiler::TraceMeEncode("ScheduleOutputTask",
+                                         {{"size", output_tasks[i]->size()}});
+        },
+        profiler::ContextType::kSharedBatchScheduler,
+        batches.back()->traceme_context_id());
+    batches.back()->AddTask(std::move(output_tasks[i]));
+  }
 
-    for (int i = 0; i < output_tasks.size(); ++i) {
-      if (batches.back()->size() + output_tasks[i]->size() >
-          max_execution_batch_size()) {
-        StartNewBatch();
-      }
-      if (batches.back()->empty()) {
-        open_batch_start_time_micros_ = env_->NowMicros();
-      }
-      profiler::TraceMeProducer trace_me(
-          [&output_tasks, i] {
-            return profiler::TraceMeEncode("ScheduleOutputTask",
-                                           {{"size", output_tasks[i]->size()}});
-          },
-          profiler::ContextType::kSharedBatchScheduler,
-          batches.back()->traceme_context_id());
-      batches.back()->AddTask(std::move(output_tasks[i]));
+  if (!schedulable_batch_) {
+    if (batches.size() > 1 || IsOpenBatchSchedulable()) {
+      schedulable_batch_ = true;
+      *notify_of_schedulable_batch = true;
     }
+  }
+  return OkStatus();
+}
 
-    if (!schedulable_batch_) {
-      if (batches.size() > 1 || IsOpenBatchSchedulable()) {
-        schedulable_batch_ = true;
-        notify_of_schedulable_batch = true;
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleWithCombining(std::unique_ptr<TaskType>* task) {
+  // The number of attempts to acquire 'mu_' without blocking, while another
+  // thread may be enqueuing the published task, before blocking on it.
+  constexpr int kMaxTryLockAttempts = 64;
+
+  PendingTask pending_task;
+  pending_task.task = task;
+  PendingTask* head = pending_tasks_.load(std::memory_order_relaxed);
+  do {
+    pending_task.next = head;
+  } while (!pending_tasks_.compare_exchange_weak(head, &pending_task,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+
+  for (int attempt = 1; !pending_task.done.load(std::memory_order_acquire);
+       ++attempt) {
+    bool notify_of_schedulable_batch = false;
+    if (attempt <= kMaxTryLockAttempts) {
+      if (!mu_.try_lock()) {
+        continue;
       }
+      notify_of_schedulable_batch = EnqueuePendingTasks();
+      mu_.unlock();
+    } else {
+      mutex_lock l(mu_);
+      notify_of_schedulable_batch = EnqueuePendingTasks();
+    }
+    if (notify_of_schedulable_batch) {
+      schedulable_batch_callback_();
     }
   }
+  return pending_task.status;
+}
 
-  if (notify_of_schedulable_batch) {
-    schedulable_batch_callback_();
+template <typename TaskType>
+bool Queue<TaskType>::EnqueuePendingTasks() {
+  // Reverses the published tasks into publication order.
+  PendingTask* published = pending_tasks_.exchange(nullptr,
+                                                   std::memory_order_acquire);
+  PendingTask* pending_task = nullptr;
+  while (published != nullptr) {
+    PendingTask* next = published->next;
+    published->next = pending_task;
+    pending_task = published;
+    published = next;
   }
 
-  return OkStatus();
+  bool notify_of_schedulable_batch = false;
+  while (pending_task != nullptr) {
+    // `pending_task` may be destroyed as soon as it is done.
+    PendingTask* next = pending_task->next;
+    pending_task->status =
+        EnqueueTask(pending_task->task, &notify_of_schedulable_batch);
+    pending_task->done.store(true, std::memory_order_release);
+    pending_task = next;
+  }
+  return notify_of_schedulable_batch;
 }
 
 template <typename TaskType>
@@ -1136,10 +1289,16 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const int64_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (options_.enable_deadline_based_batching) {
+      latency_model_.Record(batch_size,
+                            env_->NowMicros() - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1213,7 +1372,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchDeadlineReached(open_batch->size());
 }
 
 template <typename TaskType>
@@ -1228,7 +1388,33 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchDeadlineReached(open_batch->size());
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsOpenBatchDeadlineReached(size_t open_batch_size) const {
+  if (!options_.enable_deadline_based_batching ||
+      open_batch_deadline_micros_ == 0) {
+    return false;
+  }
+  // Processing the open batch now is predicted to finish just in time for its
+  // earliest deadline; processing a larger batch later would not.
+  const uint64 predicted_latency_micros =
+      latency_model_.PredictMicros(open_batch_size);
+  return env_->NowMicros() + predicted_latency_micros >=
+         open_batch_deadline_micros_;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateOpenBatchDeadline(uint64 task_deadline_micros) {
+  if (!options_.enable_deadline_based_batching || task_deadline_micros == 0) {
+    return;
+  }
+  if (open_batch_deadline_micros_ == 0 ||
+      task_deadline_micros < open_batch_deadline_micros_) {
+    open_batch_deadline_micros_ = task_deadline_micros;
+  }
 }
 
 template <typename TaskType>
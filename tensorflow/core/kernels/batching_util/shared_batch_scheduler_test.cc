@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/container/fixed_array.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -44,14 +47,18 @@ using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, uint64 deadline_micros = 0)
+      : size_(size), deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  uint64 deadline_micros() const override { return deadline_micros_; }
+
  private:
   const size_t size_;
+  const uint64 deadline_micros_;
 
   FakeTask(const FakeTask&) = delete;
   void operator=(const FakeTask&) = delete;
@@ -67,8 +74,9 @@ using SplitFunc =
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    uint64 deadline_micros = 0) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, deadline_micros));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -399,6 +407,59 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, ObeysDeadlines) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (!first_batch_processed.HasBeenNotified()) {
+        // Processing a batch takes 100 microseconds.
+        env.AdvanceByMicroseconds(100);
+        first_batch_processed.Notify();
+        return;
+      }
+      second_batch_processed.Notify();
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+
+    const size_t input_batch_size_limit = 4;
+    const size_t batch_timeout_micros = 1000 * 1000;
+    const size_t max_enqueued_batches = 2;
+    QueueOptions options =
+        CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                           batch_timeout_micros, max_enqueued_batches);
+    options.enable_deadline_based_batching = true;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Without any processed batch, the batch is closed at its deadline.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), env.NowMicros() + 50));
+    env.AdvanceByMicroseconds(49);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(first_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    first_batch_processed.WaitForNotification();
+
+    // Once the processing latency is known, the batch is closed early enough
+    // to be processed by its deadline.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), env.NowMicros() + 150));
+    env.AdvanceByMicroseconds(49);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST_P(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -733,6 +794,88 @@ TEST_P(SharedBatchSchedulerTest, QueueDestructorBlocksUntilAllTasksProcessed) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, CombiningEnqueueProcessesAllTasks) {
+  mutex mu;
+  int num_processed_tasks = 0;
+  auto callback = [&mu, &num_processed_tasks](
+                      std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_LE(batch->size(), 10);
+    mutex_lock l(mu);
+    num_processed_tasks += batch->num_tasks();
+  };
+  {
+    auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/2);
+    QueueOptions queue_options =
+        CreateQueueOptions(/*max_execution_batch_size=*/10,
+                           /*input_batch_size_limit=*/10,
+                           /*batch_timeout_micros=*/1000,
+                           /*max_enqueued_batches=*/1000 * 1000);
+    queue_options.enable_combining_enqueue = true;
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+
+    constexpr int kNumThreads = 8;
+    constexpr int kNumTasksPerThread = 1000;
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          {}, "ScheduleThread", [&queue] {
+            for (int j = 0; j < kNumTasksPerThread; ++j) {
+              TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+            }
+          }));
+    }
+    threads.clear();
+  }
+  EXPECT_EQ(num_processed_tasks, 8 * 1000);
+}
+
+TEST_P(SharedBatchSchedulerTest, CombiningEnqueueObeysCapacity) {
+  Notification first_callback_started, proceed;
+  auto callback = [&first_callback_started,
+                   &proceed](std::unique_ptr<Batch<FakeTask>> batch) {
+    if (!first_callback_started.HasBeenNotified()) {
+      first_callback_started.Notify();
+    }
+    proceed.WaitForNotification();
+  };
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options =
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/0,
+                         /*max_enqueued_batches=*/2);
+  queue_options.enable_combining_enqueue = true;
+  auto queue = CreateQueue(scheduler, queue_options, callback);
+
+  // Clog up the batch thread.
+  TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  first_callback_started.WaitForNotification();
+
+  // Only two of the concurrently scheduled tasks fit into the queue.
+  std::atomic<int> num_accepted_tasks(0);
+  std::atomic<int> num_rejected_tasks(0);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          {}, "ScheduleThread",
+          [&queue, &num_accepted_tasks, &num_rejected_tasks] {
+            const Status status = ScheduleTask(10, queue.get());
+            if (status.ok()) {
+              ++num_accepted_tasks;
+            } else {
+              EXPECT_EQ(error::UNAVAILABLE, status.code());
+              ++num_rejected_tasks;
+            }
+          }));
+    }
+  }
+  EXPECT_EQ(num_accepted_tasks, 2);
+  EXPECT_EQ(num_rejected_tasks, 2);
+  proceed.Notify();
+}
+
 // Tests that `enable_lazy_split` could be enabled only if
 // `enable_large_batch_splitting` is enabled.
 TEST_P(SharedBatchSchedulerTest, InvalidLazySplitOptions) {
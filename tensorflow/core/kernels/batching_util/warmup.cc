@@ -14,18 +14,203 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
 namespace serving {
+namespace {
+
+constexpr char kSignaturesMagic[] = "TFWSIG01";
+constexpr size_t kSignaturesMagicSize = sizeof(kSignaturesMagic) - 1;
+constexpr size_t kSignaturesFooterSize = sizeof(uint32_t);
+
+// Appends `signature` to `out`, as varints and length-prefixed strings.
+void EncodeSignature(const WarmupSignature& signature, std::string* out) {
+  core::PutVarint32(out, signature.op_name.size());
+  out->append(signature.op_name);
+  core::PutVarint32(out, signature.batch_size);
+  core::PutVarint32(out, signature.dtypes.size());
+  for (int i = 0; i < signature.dtypes.size(); ++i) {
+    core::PutVarint32(out, signature.dtypes[i]);
+    const TensorShape& shape = signature.row_shapes[i];
+    core::PutVarint32(out, shape.dims());
+    for (int d = 0; d < shape.dims(); ++d) {
+      core::PutVarint64(out, shape.dim_size(d));
+    }
+  }
+}
+
+// Decodes a signature encoded by `EncodeSignature` from the front of `in`.
+bool DecodeSignature(StringPiece* in, WarmupSignature* signature) {
+  uint32_t op_name_size;
+  if (!core::GetVarint32(in, &op_name_size) || in->size() < op_name_size) {
+    return false;
+  }
+  signature->op_name = std::string(in->substr(0, op_name_size));
+  in->remove_prefix(op_name_size);
+  uint32_t batch_size, num_inputs;
+  if (!core::GetVarint32(in, &batch_size) ||
+      !core::GetVarint32(in, &num_inputs)) {
+    return false;
+  }
+  signature->batch_size = batch_size;
+  signature->dtypes.clear();
+  signature->row_shapes.clear();
+  for (uint32_t i = 0; i < num_inputs; ++i) {
+    uint32_t dtype, dims;
+    if (!core::GetVarint32(in, &dtype) || !DataType_IsValid(dtype) ||
+        !core::GetVarint32(in, &dims)) {
+      return false;
+    }
+    TensorShape shape;
+    for (uint32_t d = 0; d < dims; ++d) {
+      uint64_t dim_size;
+      if (!core::GetVarint64(in, &dim_size) ||
+          !shape.AddDimWithStatus(dim_size).ok()) {
+        return false;
+      }
+    }
+    signature->dtypes.push_back(static_cast<DataType>(dtype));
+    signature->row_shapes.push_back(std::move(shape));
+  }
+  return true;
+}
+
+}  // namespace
+
+void WarmupSignatureRecorder::Record(absl::string_view op_name,
+                                     int batch_size,
+                                     absl::Span<const Tensor> inputs) {
+  WarmupSignature signature;
+  signature.op_name = std::string(op_name);
+  signature.batch_size = batch_size;
+  for (const Tensor& input : inputs) {
+    TensorShape row_shape = input.shape();
+    if (row_shape.dims() == 0) {
+      return;
+    }
+    row_shape.set_dim(0, 1);
+    signature.dtypes.push_back(input.dtype());
+    signature.row_shapes.push_back(std::move(row_shape));
+  }
+  std::string encoded_signature;
+  EncodeSignature(signature, &encoded_signature);
+
+  absl::MutexLock l(&mu_);
+  if (signatures_.size() >= max_signatures_ ||
+      !encoded_signatures_.insert(std::move(encoded_signature)).second) {
+    return;
+  }
+  VLOG(1) << "Recording warmup signature of batch size " << batch_size
+          << " for " << op_name;
+  signatures_.push_back(std::move(signature));
+}
+
+std::vector<WarmupSignature> WarmupSignatureRecorder::signatures() const {
+  absl::MutexLock l(&mu_);
+  return signatures_;
+}
+
+Status WriteWarmupSignatures(Env* env, const std::string& filename,
+                             absl::Span<const WarmupSignature> signatures) {
+  std::string contents(kSignaturesMagic, kSignaturesMagicSize);
+  core::PutVarint32(&contents, signatures.size());
+  for (const WarmupSignature& signature : signatures) {
+    if (signature.dtypes.size() != signature.row_shapes.size()) {
+      return errors::InvalidArgument("Warmup signature of ",
+                                     signature.op_name,
+                                     " has mismatched types and shapes");
+    }
+    EncodeSignature(signature, &contents);
+  }
+  const uint32_t crc = crc32c::Value(contents.data(), contents.size());
+  core::PutFixed32(&contents, crc32c::Mask(crc));
+  return WriteStringToFile(env, filename, contents);
+}
+
+Status ReadWarmupSignatures(Env* env, const std::string& filename,
+                            std::vector<WarmupSignature>* signatures) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  if (contents.size() < kSignaturesMagicSize + kSignaturesFooterSize ||
+      absl::string_view(contents.data(), kSignaturesMagicSize) !=
+          kSignaturesMagic) {
+    return errors::DataLoss("Invalid warmup signatures file ", filename);
+  }
+  const size_t data_size = contents.size() - kSignaturesFooterSize;
+  const uint32_t crc =
+      crc32c::Unmask(core::DecodeFixed32(contents.data() + data_size));
+  if (crc != crc32c::Value(contents.data(), data_size)) {
+    return errors::DataLoss("Corrupted warmup signatures file ", filename);
+  }
+  StringPiece in(contents.data() + kSignaturesMagicSize,
+                 data_size - kSignaturesMagicSize);
+  uint32_t num_signatures;
+  if (!core::GetVarint32(&in, &num_signatures)) {
+    return errors::DataLoss("Invalid warmup signatures file ", filename);
+  }
+  signatures->clear();
+  for (uint32_t i = 0; i < num_signatures; ++i) {
+    WarmupSignature signature;
+    if (!DecodeSignature(&in, &signature)) {
+      return errors::DataLoss("Invalid warmup signature ", i, " in ",
+                              filename);
+    }
+    signatures->push_back(std::move(signature));
+  }
+  if (!in.empty()) {
+    return errors::DataLoss("Trailing data in warmup signatures file ",
+                            filename);
+  }
+  return OkStatus();
+}
+
+Status MakeWarmupInputs(const WarmupSignature& signature,
+                        std::vector<Tensor>* inputs) {
+  if (signature.dtypes.size() != signature.row_shapes.size()) {
+    return errors::InvalidArgument("Warmup signature of ", signature.op_name,
+                                   " has mismatched types and shapes");
+  }
+  inputs->clear();
+  inputs->reserve(signature.dtypes.size());
+  for (int i = 0; i < signature.dtypes.size(); ++i) {
+    const DataType dtype = signature.dtypes[i];
+    if (dtype == DT_RESOURCE || dtype == DT_VARIANT) {
+      return errors::InvalidArgument("Cannot synthesize warmup inputs of type ",
+                                     DataTypeString(dtype));
+    }
+    Tensor input(dtype, signature.row_shapes[i]);
+    // Strings are default constructed empty.
+    if (DataTypeCanUseMemcpy(dtype)) {
+      std::memset(input.data(), 0, input.TotalBytes());
+    }
+    inputs->push_back(std::move(input));
+  }
+  return OkStatus();
+}
 
 void WarmupStateRegistry::Handle::Release() {
   if (!key_.has_value()) {
@@ -78,5 +263,24 @@ bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
   return per_model_data && per_model_data->warmup_all_batch_sizes;
 }
 
+std::vector<WarmupSignature> GetWarmupSignatures(const OpKernelContext* c) {
+  auto metadata = c->session_metadata();
+  if (metadata == nullptr || metadata->name().empty()) {
+    return {};
+  }
+  serving::WarmupStateRegistry::Key key(metadata->name(), metadata->version());
+  auto per_model_data = serving::GetGlobalWarmupStateRegistry().Lookup(key);
+  if (per_model_data == nullptr) {
+    return {};
+  }
+  std::vector<WarmupSignature> signatures;
+  for (const WarmupSignature& signature : per_model_data->warmup_signatures) {
+    if (signature.op_name == c->op_kernel().name()) {
+      signatures.push_back(signature);
+    }
+  }
+  return signatures;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
@@ -20,18 +20,83 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
 namespace serving {
 
+// The signature of a batch processed by a batch op: the inputs of the batch
+// function, which determine the compilations and autotuning it triggers.
+struct WarmupSignature {
+  // The name of the batch op.
+  std::string op_name;
+  // The size of the batch after padding.
+  int batch_size = 0;
+  // The type and the shape of one row (i.e. with a 0th dimension of 1) of
+  // each batched input.
+  std::vector<DataType> dtypes;
+  std::vector<TensorShape> row_shapes;
+};
+
+// Records the distinct signatures of the batches processed on production
+// traffic, so that they can be replayed when the model is loaded again (see
+// `WarmupStateRegistry::PerModelData::warmup_signatures`). Thread-safe.
+class WarmupSignatureRecorder {
+ public:
+  // At most `max_signatures` signatures are recorded, to bound the memory and
+  // warmup time of models with unbounded input shapes.
+  explicit WarmupSignatureRecorder(int max_signatures = 1024)
+      : max_signatures_(max_signatures) {}
+
+  // Records the signature of a batch of `inputs`, which have been padded to
+  // `batch_size` rows, processed by the batch op `op_name`.
+  void Record(absl::string_view op_name, int batch_size,
+              absl::Span<const Tensor> inputs);
+
+  // Returns the recorded signatures, in recording order.
+  std::vector<WarmupSignature> signatures() const;
+
+ private:
+  const int max_signatures_;
+
+  mutable absl::Mutex mu_;
+  // The encoded signatures, used to record each signature only once.
+  absl::flat_hash_set<std::string> encoded_signatures_ ABSL_GUARDED_BY(mu_);
+  std::vector<WarmupSignature> signatures_ ABSL_GUARDED_BY(mu_);
+};
+
+// Writes `signatures` to the file `filename`, in a compact binary format
+// protected by a checksum.
+Status WriteWarmupSignatures(Env* env, const std::string& filename,
+                             absl::Span<const WarmupSignature> signatures);
+
+// Reads the signatures written by `WriteWarmupSignatures`. Returns `DataLoss`
+// if the file is corrupted.
+Status ReadWarmupSignatures(Env* env, const std::string& filename,
+                            std::vector<WarmupSignature>* signatures);
+
+// Returns zero-filled inputs of one row which match `signature`, to be padded
+// to `signature.batch_size` rows. Returns `InvalidArgument` for types which
+// cannot be synthesized (e.g. resources).
+Status MakeWarmupInputs(const WarmupSignature& signature,
+                        std::vector<Tensor>* inputs);
+
 // Global registry for model's warm-up states. Before a model executes warm-up
 // requests, it is registered here so that the runtime can distinguish demand
 // requests vs. warm-up requests and apply warm-up specific optimizations.
@@ -59,6 +124,11 @@ class WarmupStateRegistry {
     // for all `allowed_batch_sizes` of that batch op. This removes the
     // need to issue separate warmup requests for each batch size.
     bool warmup_all_batch_sizes = false;
+
+    // Signatures recorded from production traffic by a
+    // `WarmupSignatureRecorder`. Supported batch ops execute the model on a
+    // dummy batch for each of their signatures.
+    std::vector<WarmupSignature> warmup_signatures;
   };
 
   // RAII handle for registered models.
@@ -126,6 +196,10 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Returns the signatures to replay for the batch op of `c`, based on the state
+// of WarmupStateRegistry.
+std::vector<WarmupSignature> GetWarmupSignatures(const OpKernelContext* c);
+
 }  // namespace serving
 }  // namespace tensorflow
 
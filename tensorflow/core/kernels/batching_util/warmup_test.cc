@@ -0,0 +1,127 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(WarmupSignatureRecorderTest, RecordsDistinctSignatures) {
+  WarmupSignatureRecorder recorder;
+  recorder.Record("batch", 8,
+                  {Tensor(DT_FLOAT, {8, 3}), Tensor(DT_INT64, {8})});
+  recorder.Record("batch", 8,
+                  {Tensor(DT_FLOAT, {8, 3}), Tensor(DT_INT64, {8})});
+  recorder.Record("batch", 16,
+                  {Tensor(DT_FLOAT, {16, 3}), Tensor(DT_INT64, {16})});
+  recorder.Record("batch", 8,
+                  {Tensor(DT_FLOAT, {8, 5}), Tensor(DT_INT64, {8})});
+  recorder.Record("other_batch", 8, {Tensor(DT_FLOAT, {8, 3})});
+
+  const std::vector<WarmupSignature> signatures = recorder.signatures();
+  ASSERT_EQ(signatures.size(), 4);
+  EXPECT_EQ(signatures[0].op_name, "batch");
+  EXPECT_EQ(signatures[0].batch_size, 8);
+  EXPECT_EQ(signatures[0].dtypes, std::vector<DataType>({DT_FLOAT, DT_INT64}));
+  EXPECT_EQ(signatures[0].row_shapes[0], TensorShape({1, 3}));
+  EXPECT_EQ(signatures[0].row_shapes[1], TensorShape({1}));
+  EXPECT_EQ(signatures[1].batch_size, 16);
+  EXPECT_EQ(signatures[2].row_shapes[0], TensorShape({1, 5}));
+  EXPECT_EQ(signatures[3].op_name, "other_batch");
+}
+
+TEST(WarmupSignatureRecorderTest, MaxSignatures) {
+  WarmupSignatureRecorder recorder(/*max_signatures=*/2);
+  for (int batch_size = 1; batch_size <= 4; ++batch_size) {
+    recorder.Record("batch", batch_size, {Tensor(DT_FLOAT, {batch_size})});
+  }
+  EXPECT_EQ(recorder.signatures().size(), 2);
+}
+
+TEST(WarmupSignaturesTest, WriteAndRead) {
+  WarmupSignatureRecorder recorder;
+  recorder.Record("batch", 8,
+                  {Tensor(DT_FLOAT, {8, 3, 2}), Tensor(DT_STRING, {8})});
+  recorder.Record("other_batch", 64, {Tensor(DT_INT32, {64, 1000})});
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "warmup_signatures");
+  TF_ASSERT_OK(
+      WriteWarmupSignatures(Env::Default(), filename, recorder.signatures()));
+
+  std::vector<WarmupSignature> signatures;
+  TF_ASSERT_OK(ReadWarmupSignatures(Env::Default(), filename, &signatures));
+  ASSERT_EQ(signatures.size(), 2);
+  EXPECT_EQ(signatures[0].op_name, "batch");
+  EXPECT_EQ(signatures[0].batch_size, 8);
+  EXPECT_EQ(signatures[0].dtypes, std::vector<DataType>({DT_FLOAT, DT_STRING}));
+  EXPECT_EQ(signatures[0].row_shapes[0], TensorShape({1, 3, 2}));
+  EXPECT_EQ(signatures[0].row_shapes[1], TensorShape({1}));
+  EXPECT_EQ(signatures[1].op_name, "other_batch");
+  EXPECT_EQ(signatures[1].batch_size, 64);
+  EXPECT_EQ(signatures[1].dtypes, std::vector<DataType>({DT_INT32}));
+  EXPECT_EQ(signatures[1].row_shapes[0], TensorShape({1, 1000}));
+}
+
+TEST(WarmupSignaturesTest, CorruptedFile) {
+  WarmupSignatureRecorder recorder;
+  recorder.Record("batch", 8, {Tensor(DT_FLOAT, {8, 3})});
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "corrupted_warmup_signatures");
+  TF_ASSERT_OK(
+      WriteWarmupSignatures(Env::Default(), filename, recorder.signatures()));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[contents.size() / 2] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  std::vector<WarmupSignature> signatures;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ReadWarmupSignatures(Env::Default(), filename, &signatures)));
+}
+
+TEST(WarmupSignaturesTest, MakeWarmupInputs) {
+  WarmupSignature signature;
+  signature.op_name = "batch";
+  signature.batch_size = 4;
+  signature.dtypes = {DT_FLOAT, DT_STRING};
+  signature.row_shapes = {TensorShape({1, 2}), TensorShape({1})};
+  std::vector<Tensor> inputs;
+  TF_ASSERT_OK(MakeWarmupInputs(signature, &inputs));
+  ASSERT_EQ(inputs.size(), 2);
+  test::ExpectTensorEqual<float>(
+      inputs[0], test::AsTensor<float>({0, 0}, TensorShape({1, 2})));
+  test::ExpectTensorEqual<tstring>(inputs[1],
+                                   test::AsTensor<tstring>({""}, {1}));
+
+  signature.dtypes = {DT_RESOURCE};
+  signature.row_shapes = {TensorShape({1})};
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeWarmupInputs(signature, &inputs)));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -32,10 +32,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
@@ -50,6 +52,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudgetBytes;
+/* static */ constexpr const char* const CacheDatasetOp::kUseMmap;
 
 namespace {
 
@@ -65,6 +69,10 @@ constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheCompleted[] = "cache_completed";
+constexpr char kNumSpilled[] = "num_spilled";
+constexpr char kSpillPrefix[] = "spill_prefix";
+constexpr char kRestoredSpillSuffix[] = "_restored_";
+constexpr char kSpillKeyStrFormat[] = "%07zu_%05zu";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
@@ -74,6 +82,32 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// A `TensorBuffer` that points into a memory-mapped cache file. The buffer
+// holds a reference to the mapping so that the mapping outlives every tensor
+// produced from it. The buffer does not own its memory, which prevents kernels
+// from forwarding it as a mutable output.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MappedCacheFile");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 class PartialCache {
@@ -137,11 +171,15 @@ class PartialCache {
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
+  // If `use_mmap` is true, the cache is written with tensor data aligned for
+  // direct access and read back by memory-mapping the cache files, so that
+  // the produced tensors alias the mapping instead of owning a copy.
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, bool use_mmap = false)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        use_mmap_(use_mmap),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -193,6 +231,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
+  const bool use_mmap_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -444,11 +483,20 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 WriterOptions());
         return OkStatus();
       }
 
      private:
+      BundleWriter::Options WriterOptions() const {
+        BundleWriter::Options options;
+        if (dataset()->use_mmap_) {
+          options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+        }
+        return options;
+      }
+
       Status EnsureLockFileExists(bool* end_of_sequence)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -506,7 +554,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 WriterOptions());
         lockfile_created_ = true;
         return OkStatus();
       }
@@ -561,7 +610,16 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
             reader_(dataset()->env_, dataset()->filename_),
-            iterator_restored_(false) {}
+            iterator_restored_(false) {
+        if (dataset()->use_mmap_ && reader_.status().ok() && reader_.Valid() &&
+            reader_.key() == kHeaderEntryKey) {
+          BundleHeaderProto header;
+          if (header.ParseFromArray(reader_.value().data(),
+                                    reader_.value().size())) {
+            mapped_shards_.resize(header.num_shards());
+          }
+        }
+      }
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
@@ -592,7 +650,13 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
           StringPiece key = reader_.key();
           DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-          TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          bool mapped = false;
+          if (!mapped_shards_.empty()) {
+            TF_RETURN_IF_ERROR(ReadCurrentMapped(&(*out_tensors)[i], &mapped));
+          }
+          if (!mapped) {
+            TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          }
           TF_RETURN_IF_ERROR(reader_.status());
         }
         cur_index_++;
@@ -638,10 +702,76 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       }
 
      private:
+      // Attempts to produce the tensor at the reader's current position as a
+      // view into the memory-mapped data file. Sets `*mapped` to false if the
+      // entry cannot be aliased (e.g. non-POD dtypes, misaligned data or a
+      // filesystem without memory-mapping support), in which case the caller
+      // falls back to copying the tensor. Note that aliased tensors are not
+      // checksummed, since that would touch every byte of the mapping.
+      Status ReadCurrentMapped(Tensor* val, bool* mapped)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        *mapped = false;
+        BundleEntryProto entry;
+        if (!entry.ParseFromArray(reader_.value().data(),
+                                  reader_.value().size())) {
+          return errors::DataLoss("Unable to parse cache entry for key ",
+                                  reader_.key());
+        }
+        if (!DataTypeCanUseMemcpy(entry.dtype()) || entry.slices_size() > 0 ||
+            entry.shard_id() < 0 ||
+            static_cast<size_t>(entry.shard_id()) >= mapped_shards_.size()) {
+          return OkStatus();
+        }
+        std::shared_ptr<ReadOnlyMemoryRegion>& region =
+            mapped_shards_[entry.shard_id()];
+        if (!region) {
+          std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+          Status s = dataset()->env_->NewReadOnlyMemoryRegionFromFile(
+              DataFilename(dataset()->filename_, entry.shard_id(),
+                           mapped_shards_.size()),
+              &new_region);
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to memory-map cache file, falling back to "
+                            "copying reads: "
+                         << s;
+            mapped_shards_.clear();
+            return OkStatus();
+          }
+          region = std::move(new_region);
+        }
+        if (entry.offset() < 0 || entry.size() < 0 ||
+            entry.offset() + entry.size() > region->length()) {
+          return errors::DataLoss("Cache entry for key ", reader_.key(),
+                                  " lies outside of its data file.");
+        }
+        const char* data =
+            static_cast<const char*>(region->data()) + entry.offset();
+        if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+          return OkStatus();
+        }
+        TensorShape shape;
+        TF_RETURN_IF_ERROR(
+            TensorShape::BuildTensorShape(entry.shape(), &shape));
+        if (shape.num_elements() * DataTypeSize(entry.dtype()) !=
+            entry.size()) {
+          return errors::DataLoss("Cache entry for key ", reader_.key(),
+                                  " has an inconsistent size.");
+        }
+        core::RefCountPtr<TensorBuffer> buffer(
+            new MappedTensorBuffer(region, data, entry.size()));
+        *val = Tensor(entry.dtype(), shape, std::move(buffer));
+        *mapped = true;
+        return OkStatus();
+      }
+
       mutex mu_;
       size_t cur_index_ TF_GUARDED_BY(mu_);
       BundleReader reader_ TF_GUARDED_BY(mu_);
       bool iterator_restored_ TF_GUARDED_BY(mu_);
+      // Memory-mapped data files indexed by shard id, or empty if memory
+      // mapping is disabled.
+      std::vector<std::shared_ptr<ReadOnlyMemoryRegion>> mapped_shards_
+          TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -695,7 +825,11 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                     {std::make_pair(kUseMmap, use_mmap)},
+                                     output));
     return OkStatus();
   }
 };
@@ -704,8 +838,8 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                          string filename, Env* env,
-                         const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+                         const Tensor& resource_handle, bool use_mmap = false)
+      : FileDatasetBase(ctx, input, filename, env, use_mmap),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -718,8 +852,11 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        {std::make_pair(kUseMmap, use_mmap)}, output));
     return OkStatus();
   }
 
@@ -729,11 +866,18 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
+  // If `memory_budget_bytes` is positive, elements are cached in memory until
+  // their total size exceeds the budget, after which the remaining elements are
+  // spilled to a tensor bundle with prefix `spill_prefix`.
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             string spill_prefix = "",
+                             int64_t memory_budget_bytes = 0)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        spill_prefix_(std::move(spill_prefix)),
+        memory_budget_bytes_(memory_budget_bytes) {
     input_->Ref();
   }
 
@@ -763,6 +907,14 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType, params);
   }
 
+  // Returns whether elements that do not fit the memory budget are spilled to
+  // disk.
+  bool spill_enabled() const { return memory_budget_bytes_ > 0; }
+
+  static string SpillKey(size_t element_index, size_t tensor_index) {
+    return strings::Printf(kSpillKeyStrFormat, element_index, tensor_index);
+  }
+
   int64_t CardinalityInternal(CardinalityOptions options) const override {
     return input_->Cardinality(options);
   };
@@ -827,6 +979,18 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        // The spilled elements stay on disk: the checkpoint refers to a copy
+        // of the spill bundle, since the bundle is deleted with the cache.
+        if (cache_->num_spilled() > 0) {
+          string spill_prefix;
+          TF_RETURN_IF_ERROR(
+              cache_->CheckpointSpillBundle(Env::Default(), &spill_prefix));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              prefix(), kNumSpilled,
+              static_cast<int64_t>(cache_->num_spilled())));
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(prefix(), kSpillPrefix, spill_prefix));
+        }
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -840,7 +1004,23 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         std::vector<std::vector<Tensor>> temp_cache;
         TF_RETURN_IF_ERROR(
             ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache));
-        cache_->Complete(std::move(temp_cache));
+        string spill_prefix;
+        size_t num_spilled = 0;
+        if (reader->Contains(prefix(), kNumSpilled)) {
+          int64_t temp;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumSpilled, &temp));
+          num_spilled = static_cast<size_t>(temp);
+          tstring checkpoint_spill_prefix;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSpillPrefix,
+                                                &checkpoint_spill_prefix));
+          // Copies the bundle of the checkpoint to one owned by this cache,
+          // which deletes it when it is reset.
+          spill_prefix = strings::StrCat(checkpoint_spill_prefix,
+                                         kRestoredSpillSuffix, random::New64());
+          TF_RETURN_IF_ERROR(CopyTensorBundle(
+              ctx->env(), checkpoint_spill_prefix, spill_prefix));
+        }
+        cache_->Complete(std::move(temp_cache), spill_prefix, num_spilled);
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
       return RestoreInput(ctx, reader, iterator_);
@@ -854,10 +1034,27 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if ((!temp_cache_.empty() || spill_writer_) &&
+            !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
+        if (spill_writer_) {
+          // Discard the partially written spill bundle, whose files are all
+          // named after its prefix and a dot. This keeps the bundles of
+          // restored caches, which have other prefixes.
+          Env* env = Env::Default();
+          std::vector<string> spill_files;
+          Status s = env->GetMatchingPaths(
+              strings::StrCat(dataset()->spill_prefix_, ".*"), &spill_files);
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to get matching files on "
+                         << dataset()->spill_prefix_ << ".* : " << s;
+          }
+          for (const string& path : spill_files) {
+            env->DeleteFile(path).IgnoreError();
+          }
+        }
       }
 
       Status Initialize(IteratorContext* ctx) override {
@@ -874,16 +1071,24 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(Complete());
           }
           return OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        if (ShouldSpill(*out_tensors)) {
+          TF_RETURN_IF_ERROR(Spill(ctx->env(), *out_tensors));
+        } else {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          for (const Tensor& t : *out_tensors) {
+            cached_bytes_ += t.TotalBytes();
+          }
+          temp_cache_.emplace_back(*out_tensors);
+        }
+        if (temp_cache_.size() + num_spilled_ ==
+            dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(Complete());
         }
         return OkStatus();
       }
@@ -899,6 +1104,12 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
+          if (num_spilled_ > 0) {
+            return errors::Unimplemented(
+                "Checkpointing a cache iterator that has spilled elements to ",
+                dataset()->spill_prefix_,
+                " before the cache was completed is not supported.");
+          }
           TF_RETURN_IF_ERROR(
               WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
         }
@@ -911,15 +1122,72 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (!reader->Contains(prefix(), kCacheCompleted)) {
           TF_RETURN_IF_ERROR(
               ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          cached_bytes_ = 0;
+          for (const auto& element : temp_cache_) {
+            for (const Tensor& t : element) {
+              cached_bytes_ += t.TotalBytes();
+            }
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      // Returns whether `element` should be written to the spill bundle rather
+      // than kept in memory. Once spilling starts, all subsequent elements are
+      // spilled so that the cache is a memory prefix followed by a disk suffix.
+      bool ShouldSpill(const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!dataset()->spill_enabled()) {
+          return false;
+        }
+        if (spill_writer_) {
+          return true;
+        }
+        int64_t element_bytes = 0;
+        for (const Tensor& t : element) {
+          element_bytes += t.TotalBytes();
+        }
+        return cached_bytes_ + element_bytes > dataset()->memory_budget_bytes_;
+      }
+
+      Status Spill(Env* env, const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!spill_writer_) {
+          VLOG(2) << "Memory budget of " << dataset()->memory_budget_bytes_
+                  << " bytes reached after " << temp_cache_.size()
+                  << " elements; spilling to " << dataset()->spill_prefix_;
+          spill_writer_ =
+              std::make_unique<BundleWriter>(env, dataset()->spill_prefix_);
+        }
+        TF_RETURN_IF_ERROR(spill_writer_->status());
+        for (size_t i = 0; i < element.size(); ++i) {
+          TF_RETURN_IF_ERROR(spill_writer_->Add(SpillKey(num_spilled_, i),
+                                                element[i]));
+        }
+        num_spilled_++;
+        return OkStatus();
+      }
+
+      Status Complete() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_writer_) {
+          TF_RETURN_IF_ERROR(spill_writer_->Finish());
+          spill_writer_.reset();
+        }
+        cache_->Complete(std::move(temp_cache_), dataset()->spill_prefix_,
+                         num_spilled_);
+        return OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      // Total size of the tensors in `temp_cache_`.
+      int64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+      // Writer for the elements that did not fit the memory budget.
+      std::unique_ptr<BundleWriter> spill_writer_ TF_GUARDED_BY(mu_);
+      size_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -953,6 +1221,11 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           index_++;
           *end_of_sequence = false;
           return OkStatus();
+        } else if (index_ < cache_->size() + cache_->num_spilled()) {
+          TF_RETURN_IF_ERROR(ReadSpilled(ctx->env(), out_tensors));
+          index_++;
+          *end_of_sequence = false;
+          return OkStatus();
         } else {
           *end_of_sequence = true;
           return OkStatus();
@@ -985,13 +1258,42 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           }
           index_ = static_cast<size_t>(temp);
         }
+        // The spill reader is reopened and positioned lazily on the next read.
+        spill_reader_.reset();
         return OkStatus();
       }
 
      private:
+      // Reads the element at `index_` from the spill bundle. Elements are read
+      // sequentially, so the reader only needs to seek when it is (re)opened.
+      Status ReadSpilled(Env* env, std::vector<Tensor>* out_tensors)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const size_t spill_index = index_ - cache_->size();
+        const size_t num_tensors = dataset()->output_dtypes().size();
+        if (!spill_reader_) {
+          spill_reader_ =
+              std::make_unique<BundleReader>(env, cache_->spill_prefix());
+          TF_RETURN_IF_ERROR(spill_reader_->status());
+          spill_reader_->Seek(SpillKey(spill_index, 0));
+        }
+        out_tensors->resize(num_tensors);
+        for (size_t i = 0; i < num_tensors; ++i) {
+          if (!spill_reader_->Valid() ||
+              spill_reader_->key() != SpillKey(spill_index, i)) {
+            return errors::DataLoss("Cache spill bundle ",
+                                    cache_->spill_prefix(),
+                                    " is missing element ", spill_index);
+          }
+          TF_RETURN_IF_ERROR(spill_reader_->ReadCurrent(&(*out_tensors)[i]));
+          spill_reader_->Next();
+        }
+        return spill_reader_->status();
+      }
+
       mutex mu_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<BundleReader> spill_reader_ TF_GUARDED_BY(mu_);
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -1019,6 +1321,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  const string spill_prefix_;
+  const int64_t memory_budget_bytes_;
   mutable std::unique_ptr<PartialCache> partial_cache_ TF_GUARDED_BY(mu_);
 };  // MemoryDatasetBase
 
@@ -1028,8 +1332,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                string spill_prefix = "", int64_t memory_budget_bytes = 0)
+      : MemoryDatasetBase(ctx, input, manager->get(), std::move(spill_prefix),
+                          memory_budget_bytes),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -1050,9 +1356,12 @@ class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
     Node* input_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
-    TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_node, filename_node}, output));
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(spill_prefix_), &filename_node));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_node, filename_node},
+        {std::make_pair(kMemoryBudgetBytes, memory_budget_bytes)}, output));
     return OkStatus();
   }
 
@@ -1070,8 +1379,10 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, string spill_prefix = "",
+                  int64_t memory_budget_bytes = 0)
+      : MemoryDatasetBase(ctx, input, manager->get(), std::move(spill_prefix),
+                          memory_budget_bytes),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1095,13 +1406,16 @@ class CacheDatasetOp::MemoryDatasetV2
     Node* input_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
-    TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(spill_prefix_), &filename_node));
     Node* resource_handle_node = nullptr;
     Tensor handle(DT_RESOURCE, TensorShape({}));
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        {std::make_pair(kMemoryBudgetBytes, memory_budget_bytes)}, output));
     return OkStatus();
   }
 
@@ -1114,14 +1428,33 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2),
+      memory_budget_bytes_(0),
+      use_mmap_(false) {
+  if (ctx->HasAttr(kMemoryBudgetBytes)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kMemoryBudgetBytes, &memory_budget_bytes_));
+  }
+  if (ctx->HasAttr(kUseMmap)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  }
+  OP_REQUIRES(ctx, memory_budget_bytes_ >= 0,
+              errors::InvalidArgument("`", kMemoryBudgetBytes,
+                                      "` must be non-negative, got ",
+                                      memory_budget_bytes_));
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   // Parse out the filenames tensor.
   tstring filename;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
-  if (filename.empty()) {
+  // In hybrid mode the cache is kept in memory up to `memory_budget_bytes_` and
+  // `filename` is used as the prefix of the spill files.
+  const bool hybrid = !filename.empty() && memory_budget_bytes_ > 0;
+  const string spill_prefix = hybrid ? string(filename) : "";
+  const int64_t memory_budget_bytes = hybrid ? memory_budget_bytes_ : 0;
+  if (filename.empty() || hybrid) {
     static std::atomic<int64_t> resource_id_counter(0);
     const string& container = ctx->resource_manager()->default_container();
     auto name = strings::StrCat(ctx->op_kernel().name(), "/", kMemoryCache, "_",
@@ -1147,7 +1480,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, spill_prefix,
+                                    memory_budget_bytes);
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1159,14 +1493,15 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  spill_prefix, memory_budget_bytes);
     }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(),
+                                  ctx->input(2), use_mmap_);
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), use_mmap_);
     }
   }
 }
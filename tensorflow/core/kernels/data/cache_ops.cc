@@ -22,21 +22,57 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
+constexpr char kCheckpointSpillSuffix[] = "_checkpoint_";
 
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+MemoryCache::~MemoryCache() {
+  mutex_lock l(mu_);
+  DeleteSpillFiles();
+}
+
+void MemoryCache::DeleteSpillFiles() {
+  if (spill_prefix_.empty()) {
+    return;
+  }
+  Env* env = Env::Default();
+  for (const string& path :
+       {MetaFilename(spill_prefix_), DataFilename(spill_prefix_, 0, 1)}) {
+    Status s = env->DeleteFile(path);
+    if (!s.ok() && !errors::IsNotFound(s)) {
+      LOG(WARNING) << "Failed to delete cache spill file " << path << ": "
+                   << s;
+    }
+  }
+  spill_prefix_.clear();
+  checkpoint_spill_prefix_.clear();
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*spill_prefix=*/"", /*num_spilled=*/0);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           const std::string& spill_prefix,
+                           size_t num_spilled) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    if (num_spilled > 0) {
+      spill_prefix_ = spill_prefix;
+    }
+    num_spilled_ = num_spilled;
     completed_ = true;
   }
 }
@@ -50,6 +86,8 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  DeleteSpillFiles();
+  num_spilled_ = 0;
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -63,11 +101,43 @@ size_t MemoryCache::size() {
   return cache_.size();
 }
 
+size_t MemoryCache::num_spilled() {
+  tf_shared_lock l(mu_);
+  return num_spilled_;
+}
+
+std::string MemoryCache::spill_prefix() {
+  tf_shared_lock l(mu_);
+  return num_spilled_ > 0 ? spill_prefix_ : "";
+}
+
+Status MemoryCache::CheckpointSpillBundle(Env* env,
+                                          std::string* checkpoint_prefix) {
+  mutex_lock l(mu_);
+  if (num_spilled_ == 0) {
+    return errors::FailedPrecondition("The cache has no spilled elements.");
+  }
+  if (checkpoint_spill_prefix_.empty()) {
+    const std::string prefix =
+        strings::StrCat(spill_prefix_, kCheckpointSpillSuffix, random::New64());
+    TF_RETURN_IF_ERROR(CopyTensorBundle(env, spill_prefix_, prefix));
+    checkpoint_spill_prefix_ = prefix;
+  }
+  *checkpoint_prefix = checkpoint_spill_prefix_;
+  return OkStatus();
+}
+
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   tf_shared_lock l(mu_);
   return cache_;
 }
 
+Status CopyTensorBundle(Env* env, const std::string& from,
+                        const std::string& to) {
+  TF_RETURN_IF_ERROR(env->CopyFile(MetaFilename(from), MetaFilename(to)));
+  return env->CopyFile(DataFilename(from, 0, 1), DataFilename(to, 0, 1));
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
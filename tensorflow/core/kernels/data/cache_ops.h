@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -27,36 +28,70 @@ namespace data {
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// When the cache is populated in hybrid mode, only a prefix of the elements is
+// kept in memory and the remaining `num_spilled()` elements are stored in a
+// tensor bundle with prefix `spill_prefix()`. The spill files are owned by the
+// cache and deleted when it is reset or destroyed, so checkpoints refer to a
+// copy of the bundle made by `CheckpointSpillBundle()` instead.
 class MemoryCache {
  public:
   MemoryCache() = default;
+  ~MemoryCache();
 
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed, recording that `num_spilled` elements
+  // following the in-memory elements are stored in the bundle `spill_prefix`.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                const std::string& spill_prefix, size_t num_spilled);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
-  // Resets the cache.
+  // Resets the cache, deleting its spill files.
   void Reset();
 
   // Returns the element at the given index.
   const std::vector<Tensor>& at(int64_t index);
 
-  // Returns the size of the cache.
+  // Returns the number of elements held in memory.
   size_t size();
 
+  // Returns the number of elements stored in the spill bundle.
+  size_t num_spilled();
+
+  // Returns the prefix of the spill bundle, or an empty string if no elements
+  // were spilled.
+  std::string spill_prefix();
+
+  // Sets `checkpoint_prefix` to the prefix of a copy of the spill bundle that
+  // is not deleted with the cache, for checkpoints to refer to. The copy is
+  // made on disk by the first call after the cache is completed, and shared
+  // by the following ones.
+  Status CheckpointSpillBundle(Env* env, std::string* checkpoint_prefix);
+
   // Returns a reference to the cache's data. The returned reference will be
   // invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
  private:
+  void DeleteSpillFiles() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::string spill_prefix_ TF_GUARDED_BY(mu_);
+  size_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
+  std::string checkpoint_spill_prefix_ TF_GUARDED_BY(mu_);
 };
 
+// Copies the files of the tensor bundle with prefix `from` to the prefix `to`.
+Status CopyTensorBundle(Env* env, const std::string& from,
+                        const std::string& to);
+
 // A resource wrapping a shared instance of a memory cache.
 class MemoryCacheManager : public ResourceBase {
  public:
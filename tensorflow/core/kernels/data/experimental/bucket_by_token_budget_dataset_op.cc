@@ -0,0 +1,442 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_token_budget_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kTokenBudget;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+constexpr char kBufferSize[] = "buffer_size";
+
+// Returns the length of `element` used for bucketing.
+Status ElementLength(const std::vector<Tensor>& element, int64_t* length) {
+  if (element.empty() || element[0].dims() == 0) {
+    return errors::InvalidArgument(
+        "BucketByTokenBudgetDataset requires the first component of each "
+        "element to have rank of at least 1.");
+  }
+  *length = element[0].dim_size(0);
+  return OkStatus();
+}
+
+}  // namespace
+
+class BucketByTokenBudgetDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64_t token_budget, int64_t buffer_size,
+          std::vector<Tensor> padding_values, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        token_budget_(token_budget),
+        buffer_size_(buffer_size),
+        padding_values_(std::move(padding_values)),
+        input_(input) {
+    input_->Ref();
+
+    const auto& input_shapes = input_->output_shapes();
+    output_shapes_.reserve(input_shapes.size());
+    for (const auto& input_shape : input_shapes) {
+      output_shapes_.emplace_back(
+          PartialTensorShape({-1}).Concatenate(input_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    // The number of batches depends on the lengths of the elements.
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* token_budget = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(token_budget_, &token_budget));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {{0, input_graph_node}, {1, token_budget}, {2, buffer_size}},
+        {{3, padding_values}}, {{kOutputTypes, output_types}}, output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        while (input_impl_ && buffer_.size() < dataset()->buffer_size_) {
+          bool end_of_input;
+          std::vector<Tensor> element;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            break;
+          }
+          int64_t length;
+          TF_RETURN_IF_ERROR(ElementLength(element, &length));
+          buffer_.push_back(std::move(element));
+        }
+        if (buffer_.empty()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        std::vector<size_t> batch_indices;
+        TF_RETURN_IF_ERROR(SelectBatch(&batch_indices));
+        batch_elements.reserve(batch_indices.size());
+        for (size_t index : batch_indices) {
+          batch_elements.push_back(std::move(buffer_[index]));
+        }
+        // `batch_indices` is sorted, so the remaining elements keep their
+        // arrival order.
+        std::deque<std::vector<Tensor>> remaining;
+        for (size_t i = 0, next = 0; i < buffer_.size(); ++i) {
+          if (next < batch_indices.size() && batch_indices[next] == i) {
+            ++next;
+            continue;
+          }
+          remaining.push_back(std::move(buffer_[i]));
+        }
+        buffer_ = std::move(remaining);
+      }
+      TF_RETURN_IF_ERROR(CopyBatch(ctx, batch_elements, out_tensors));
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kInputImplEmpty), ""));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kBufferSize), buffer_.size()));
+      for (int64_t i = 0; i < buffer_.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat("buffer[", i, "]_size")),
+            buffer_[i].size()));
+        for (int64_t j = 0; j < buffer_[i].size(); ++j) {
+          TF_RETURN_IF_ERROR(writer->WriteTensor(
+              full_name(strings::StrCat("buffer[", i, "][", j, "]")),
+              buffer_[i][j]));
+        }
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (!reader->Contains(full_name(kInputImplEmpty))) {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+      int64_t buffer_size = 0;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kBufferSize), &buffer_size));
+      buffer_.clear();
+      buffer_.resize(buffer_size);
+      for (int64_t i = 0; i < buffer_size; ++i) {
+        int64_t element_size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(strings::StrCat("buffer[", i, "]_size")), &element_size));
+        buffer_[i].resize(element_size);
+        for (int64_t j = 0; j < element_size; ++j) {
+          TF_RETURN_IF_ERROR(reader->ReadTensor(
+              ctx->flr(),
+              full_name(strings::StrCat("buffer[", i, "][", j, "]")),
+              &buffer_[i][j]));
+        }
+      }
+      return OkStatus();
+    }
+
+   private:
+    // Stores in `batch_indices` the (sorted) buffer indices of the elements
+    // of the next batch.
+    //
+    // In the buffer sorted by length, a batch whose longest element is the
+    // j-th one holds at most `token_budget / length_j` elements, and holds
+    // the most real values when it extends as far back as the budget allows.
+    // Among the windows which contain the oldest element, the one with the
+    // most real values is picked.
+    Status SelectBatch(std::vector<size_t>* batch_indices)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const size_t n = buffer_.size();
+      std::vector<int64_t> lengths(n);
+      for (size_t i = 0; i < n; ++i) {
+        TF_RETURN_IF_ERROR(ElementLength(buffer_[i], &lengths[i]));
+      }
+      std::vector<size_t> order(n);
+      for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+      }
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return lengths[a] < lengths[b];
+      });
+      std::vector<int64_t> prefix_sums(n + 1, 0);
+      size_t oldest = 0;
+      for (size_t i = 0; i < n; ++i) {
+        prefix_sums[i + 1] = prefix_sums[i] + lengths[order[i]];
+        if (order[i] == 0) {
+          oldest = i;
+        }
+      }
+
+      size_t best_begin = oldest;
+      size_t best_end = oldest + 1;
+      int64_t best_real_tokens = -1;
+      for (size_t end = oldest + 1; end <= n; ++end) {
+        const int64_t max_length =
+            std::max<int64_t>(lengths[order[end - 1]], 1);
+        const size_t max_count = static_cast<size_t>(
+            std::max<int64_t>(dataset()->token_budget_ / max_length, 1));
+        if (end - oldest > max_count) {
+          // Longer batches can only hold fewer elements.
+          break;
+        }
+        const size_t begin = end > max_count ? end - max_count : 0;
+        const int64_t real_tokens = prefix_sums[end] - prefix_sums[begin];
+        if (real_tokens > best_real_tokens) {
+          best_real_tokens = real_tokens;
+          best_begin = begin;
+          best_end = end;
+        }
+      }
+      batch_indices->assign(order.begin() + best_begin,
+                            order.begin() + best_end);
+      std::sort(batch_indices->begin(), batch_indices->end());
+      return OkStatus();
+    }
+
+    Status CopyBatch(IteratorContext* ctx,
+                     std::vector<std::vector<Tensor>>& batch_elements,
+                     std::vector<Tensor>* out_tensors) {
+      const size_t num_components = batch_elements[0].size();
+      const int64_t batch_size = batch_elements.size();
+      int64_t num_real_tokens = 0;
+      int64_t max_length = 0;
+      for (const auto& element : batch_elements) {
+        int64_t length;
+        TF_RETURN_IF_ERROR(ElementLength(element, &length));
+        num_real_tokens += length;
+        max_length = std::max(max_length, length);
+      }
+      for (size_t component_index = 0; component_index < num_components;
+           ++component_index) {
+        TensorShape max_shape = batch_elements[0][component_index].shape();
+        for (int64_t i = 1; i < batch_size; ++i) {
+          const TensorShape& shape = batch_elements[i][component_index].shape();
+          if (shape.dims() != max_shape.dims()) {
+            return errors::InvalidArgument(
+                "Cannot batch tensors with different ranks in component ",
+                component_index, ". First element had shape ",
+                max_shape.DebugString(), " and element ", i, " had shape ",
+                shape.DebugString(), ".");
+          }
+          for (int d = 0; d < shape.dims(); ++d) {
+            if (shape.dim_size(d) > max_shape.dim_size(d)) {
+              max_shape.set_dim(d, shape.dim_size(d));
+            }
+          }
+        }
+        TensorShape batch_component_shape({batch_size});
+        batch_component_shape.AppendShape(max_shape);
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->output_dtypes()[component_index],
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, dataset()->padding_values_[component_index]));
+        for (int64_t i = 0; i < batch_size; ++i) {
+          Tensor& element = batch_elements[i][component_index];
+          if (element.shape() == max_shape) {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                std::move(element), &batch_component, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                element, &batch_component, i));
+          }
+        }
+      }
+      metrics::RecordTFDataBucketingTokens(
+          num_real_tokens, batch_size * max_length - num_real_tokens);
+      return OkStatus();
+    }
+
+    mutex mu_;
+    // Buffered elements in arrival order.
+    std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+  };
+
+  const int64_t token_budget_;
+  const int64_t buffer_size_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+void BucketByTokenBudgetDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                               DatasetBase* input,
+                                               DatasetBase** output) {
+  int64_t token_budget = 0;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<int64_t>(ctx, kTokenBudget, &token_budget));
+  OP_REQUIRES(
+      ctx, token_budget > 0,
+      errors::InvalidArgument("Token budget must be greater than zero."));
+  int64_t buffer_size = 0;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(
+      ctx, buffer_size > 0,
+      errors::InvalidArgument("Buffer size must be greater than zero."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  padding_values.reserve(padding_values_list.size());
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, token_budget, buffer_size,
+                        std::move(padding_values), input);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("BucketByTokenBudgetDataset").Device(DEVICE_CPU),
+                        BucketByTokenBudgetDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,255 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_token_budget_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_token_budget_dataset";
+
+class BucketByTokenBudgetDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketByTokenBudgetDatasetParams(
+      T input_dataset_params, int64_t token_budget, int64_t buffer_size,
+      std::vector<Tensor> padding_values, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      kNodeName),
+        token_budget_(token_budget),
+        buffer_size_(buffer_size),
+        padding_values_(std::move(padding_values)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {
+        CreateTensor<int64_t>(TensorShape({}), {token_budget_}),
+        CreateTensor<int64_t>(TensorShape({}), {buffer_size_})};
+    for (const Tensor& padding_value : padding_values_) {
+      input_tensors.push_back(padding_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketByTokenBudgetDatasetOp::kInputDataset,
+                    BucketByTokenBudgetDatasetOp::kTokenBudget,
+                    BucketByTokenBudgetDatasetOp::kBufferSize};
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketByTokenBudgetDatasetOp::kPaddingValues, "_", i));
+    }
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attributes) const override {
+    *attributes = {{"output_types", output_dtypes_},
+                   {"output_shapes", output_shapes_},
+                   {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return BucketByTokenBudgetDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t token_budget_;
+  int64_t buffer_size_;
+  std::vector<Tensor> padding_values_;
+};
+
+class BucketByTokenBudgetDatasetOpTest : public DatasetOpsTestBase {};
+
+// Three elements of length 3 followed by two elements of length 1.
+ConcatenateDatasetParams MixedLengthsDatasetParams() {
+  auto long_elements = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 3},
+                                            {{0, 1, 2, 3, 4, 5, 6, 7, 8}}),
+      /*node_name=*/"tensor_slice_0");
+  auto short_elements = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{2, 1}, {{9, 10}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(long_elements),
+                                  std::move(short_elements),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+BucketByTokenBudgetDatasetParams BucketByTokenBudgetDatasetParams1() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/6,
+      /*buffer_size=*/5,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+// A buffer of one element produces batches of one element.
+BucketByTokenBudgetDatasetParams BucketByTokenBudgetDatasetParams2() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/6,
+      /*buffer_size=*/1,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+// A token budget smaller than the element lengths produces batches of one
+// element.
+BucketByTokenBudgetDatasetParams SmallTokenBudgetParams() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/1,
+      /*buffer_size=*/5,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+BucketByTokenBudgetDatasetParams InvalidTokenBudgetParams() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/0,
+      /*buffer_size=*/5,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+BucketByTokenBudgetDatasetParams InvalidBufferSizeParams() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/6,
+      /*buffer_size=*/0,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+BucketByTokenBudgetDatasetParams InvalidPaddingValueTypeParams() {
+  return BucketByTokenBudgetDatasetParams(
+      MixedLengthsDatasetParams(),
+      /*token_budget=*/6,
+      /*buffer_size=*/5,
+      /*padding_values=*/{CreateTensor<tstring>(TensorShape{}, {""})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})});
+}
+
+std::vector<Tensor> ExpectedBatches1() {
+  // The two full elements of length 3 fill the budget, then the last long
+  // element is batched with the newest short element, which holds more real
+  // values than batching the two short elements.
+  return {CreateTensor<int64_t>(TensorShape{2, 3}, {0, 1, 2, 3, 4, 5}),
+          CreateTensor<int64_t>(TensorShape{2, 3}, {6, 7, 8, 10, -1, -1}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {9})};
+}
+
+std::vector<Tensor> ExpectedUnbatchedElements() {
+  return {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+          CreateTensor<int64_t>(TensorShape{1, 3}, {3, 4, 5}),
+          CreateTensor<int64_t>(TensorShape{1, 3}, {6, 7, 8}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {9}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {10})};
+}
+
+std::vector<GetNextTestCase<BucketByTokenBudgetDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/BucketByTokenBudgetDatasetParams1(),
+           /*expected_outputs=*/ExpectedBatches1()},
+          {/*dataset_params=*/BucketByTokenBudgetDatasetParams2(),
+           /*expected_outputs=*/ExpectedUnbatchedElements()},
+          {/*dataset_params=*/SmallTokenBudgetParams(),
+           /*expected_outputs=*/ExpectedUnbatchedElements()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketByTokenBudgetDatasetOpTest,
+                         BucketByTokenBudgetDatasetParams, GetNextTestCases())
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = BucketByTokenBudgetDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = BucketByTokenBudgetDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketByTokenBudgetDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = BucketByTokenBudgetDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({-1, -1})}));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, Cardinality) {
+  auto dataset_params = BucketByTokenBudgetDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = BucketByTokenBudgetDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(BucketByTokenBudgetDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketByTokenBudgetDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/BucketByTokenBudgetDatasetParams1(),
+           /*breakpoints=*/{0, 1, 2, 4},
+           /*expected_outputs=*/ExpectedBatches1()},
+          {/*dataset_params=*/BucketByTokenBudgetDatasetParams2(),
+           /*breakpoints=*/{0, 2, 6},
+           /*expected_outputs=*/ExpectedUnbatchedElements()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketByTokenBudgetDatasetOpTest,
+                                 BucketByTokenBudgetDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidInputTest
+    : public BucketByTokenBudgetDatasetOpTest,
+      public ::testing::WithParamInterface<BucketByTokenBudgetDatasetParams> {
+};
+
+TEST_P(ParameterizedInvalidInputTest, InvalidInput) {
+  auto dataset_params = GetParam();
+  EXPECT_FALSE(Initialize(dataset_params).ok());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BucketByTokenBudgetDatasetOpTest, ParameterizedInvalidInputTest,
+    ::testing::ValuesIn({InvalidTokenBudgetParams(), InvalidBufferSizeParams(),
+                         InvalidPaddingValueTypeParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
@@ -20,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/csv_scanner.h"
 
 namespace tensorflow {
 namespace data {
@@ -562,7 +565,9 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
 
           } else {
-            pos_++;
+            // Skip to the next quotation mark.
+            pos_ = std::min(StringPiece(buffer_).find('"', pos_),
+                            buffer_.size());
           }
         }
       }
@@ -641,7 +646,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter scans to the next delimiting char
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +662,11 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip to the next character which may end the field.
+          pos_ = FindCsvFieldEnd(buffer_, pos_, dataset()->delim_,
+                                 dataset()->use_quote_delim_);
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -59,6 +59,7 @@ namespace experimental {
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kOutputShapes;
 /* static */ constexpr const char* const
     MapAndBatchDatasetOp::kPreserveCardinality;
+/* static */ constexpr const char* const MapAndBatchDatasetOp::kVectorized;
 
 // Maximum number of batch results to buffer.
 
@@ -79,6 +80,23 @@ constexpr char kStatus[] = "status";
 // Computes ceil(x / y).
 inline int64_t CeilDiv(int64_t x, int64_t y) { return (x + y - 1) / y; }
 
+// Returns true if all `elements` have the same component dtypes and shapes, so
+// that they can be stacked into a batch.
+bool HaveSameShapes(const std::vector<std::vector<Tensor>>& elements) {
+  for (size_t i = 1; i < elements.size(); ++i) {
+    if (elements[i].size() != elements[0].size()) {
+      return false;
+    }
+    for (size_t j = 0; j < elements[i].size(); ++j) {
+      if (elements[i][j].dtype() != elements[0][j].dtype() ||
+          elements[i][j].shape() != elements[0][j].shape()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 class MapAndBatchDatasetOp::Dataset : public DatasetBase {
@@ -88,7 +106,7 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes,
           std::unique_ptr<CapturedFunction> captured_func,
-          bool preserve_cardinality)
+          bool preserve_cardinality, bool vectorized)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         batch_size_(batch_size),
@@ -98,12 +116,14 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         output_shapes_(output_shapes),
         captured_func_(std::move(captured_func)),
         preserve_cardinality_(preserve_cardinality),
+        vectorized_(vectorized),
         traceme_metadata_(
             {{"autotune",
               num_parallel_calls == model::kAutotune ? "true" : "false"},
              {"batch_size",
               strings::Printf("%lld", static_cast<long long>(batch_size))},
-             {"drop_remainder", drop_remainder ? "true" : "false"}}) {
+             {"drop_remainder", drop_remainder ? "true" : "false"},
+             {"vectorized", vectorized ? "true" : "false"}}) {
     input_->Ref();
   }
 
@@ -169,6 +189,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
     AttrValue preserve_cardinality_attr;
     b->BuildAttrValue(preserve_cardinality_, &preserve_cardinality_attr);
+    AttrValue vectorized_attr;
+    b->BuildAttrValue(vectorized_, &vectorized_attr);
 
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
@@ -179,8 +201,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         {std::make_pair(1, other_arguments)},      // Tensor list inputs.
         {std::make_pair(kFunc, f),
          std::make_pair(kTarguments, other_arguments_types_attr),
-         std::make_pair(kPreserveCardinality,
-                        preserve_cardinality_attr)},  // Attrs
+         std::make_pair(kPreserveCardinality, preserve_cardinality_attr),
+         std::make_pair(kVectorized, vectorized_attr)},  // Attrs
         output));
     return OkStatus();
   }
@@ -450,59 +472,178 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       std::shared_ptr<std::vector<Tensor>> return_values =
           std::make_shared<std::vector<Tensor>>();
       auto done = [this, ctx, result, return_values, offset](Status status) {
+        StoreResult(ctx, result, return_values, offset, status);
+        CallCompleted(ctx, result);
+      };
+
+      // Apply the map function on `input_element`, storing the result in
+      // `return_values`, and invoking `done` when finished.
+      instantiated_captured_func_->RunAsync(ctx.get(), std::move(input_element),
+                                            return_values.get(),
+                                            std::move(done), model_node());
+    }
+
+    // Converts the `status` of the map function invocation for the element
+    // at `offset` and copies its `return_values` into the batch.
+    void StoreResult(const std::shared_ptr<IteratorContext>& ctx,
+                     const std::shared_ptr<BatchResult>& result,
+                     const std::shared_ptr<std::vector<Tensor>>& return_values,
+                     int64_t offset, Status status) TF_LOCKS_EXCLUDED(*mu_) {
+      if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
+        // To guarantee that the transformation preserves the cardinality of
+        // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
+        // former may be interpreted by a caller as the end of sequence.
+        status = errors::InvalidArgument(
+            "Function invocation produced OutOfRangeError: ",
+            status.message());
+      }
+      result->UpdateStatus(status, offset);
+      if (status.ok()) {
+        Status allocate_status =
+            EnsureOutputAllocated(ctx, result, return_values);
+        if (!allocate_status.ok()) {
+          result->UpdateStatus(allocate_status, offset);
+        } else {
+          for (size_t i = 0; i < return_values->size(); ++i) {
+            Tensor& tensor = return_values->at(i);
+            Tensor* batch = &(result->output)[i];
+            if (tensor.NumElements() !=
+                (batch->NumElements() / batch->dim_size(0))) {
+              TensorShape batch_shape = batch->shape();
+              batch_shape.RemoveDim(0);
+              result->UpdateStatus(
+                  errors::InvalidArgument(
+                      "Cannot add tensor to the batch: number of elements "
+                      "does not match. Shapes are: [tensor]: ",
+                      tensor.shape().DebugString(),
+                      ", [batch]: ", batch_shape.DebugString()),
+                  offset);
+              break;
+            }
+            // TODO(mrry): Add a version of DoParallelConcat that allows us
+            // to move `tensor` where possible, to speed up string tensor
+            // batching.
+            Status copy_status = batch_util::CopyElementToSlice(
+                std::move(tensor), batch, offset);
+            if (!copy_status.ok()) {
+              result->UpdateStatus(copy_status, offset);
+              break;
+            }
+          }
+        }
+        {
+          mutex_lock l(result->mu);
+          result->num_elements++;
+        }
+      }
+    }
+
+    // Invokes the map function once on the stacked input elements of a whole
+    // batch, instead of once per element. The function is expected to be
+    // vectorizable, i.e. applying it to the stacked elements must produce the
+    // stacked per-element results. If the input elements do not all have the
+    // same shapes, they cannot be stacked and the function is instead invoked
+    // once per element.
+    void CallVectorizedFunction(std::shared_ptr<IteratorContext> ctx,
+                                const std::shared_ptr<BatchResult>& result)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      profiler::TraceMe traceme([&] {
+        return profiler::TraceMeEncode("MapAndBatchProduce",
+                                       {{"element_id", result->uid}});
+      });
+      // Get the input elements of the batch.
+      std::vector<std::vector<Tensor>> input_elements;
+      input_elements.reserve(dataset()->batch_size_);
+      bool end_of_input = false;
+      Status status;
+      const size_t batch_size = dataset()->batch_size_;
+      while (input_elements.size() < batch_size && !end_of_input) {
+        std::vector<Tensor> input_element;
+        status = input_impl_->GetNext(ctx.get(), &input_element, &end_of_input);
+        if (!status.ok()) {
+          break;
+        }
+        if (!end_of_input) {
+          input_elements.push_back(std::move(input_element));
+        }
+      }
+      bool return_early;
+      {
+        mutex_lock l(result->mu);
+        result->checkpoint.Merge(ctx->checkpoint());
+        result->end_of_input = result->end_of_input || end_of_input;
+        result->status.Update(status);
+        return_early = input_elements.empty() || !result->status.ok();
+      }
+      if (return_early) {
+        CallCompleted(ctx, result);
+        return;
+      }
+
+      const int64_t num_elements = input_elements.size();
+      if (!HaveSameShapes(input_elements)) {
+        auto num_pending = std::make_shared<std::atomic<int64_t>>(num_elements);
+        for (int64_t i = 0; i < num_elements; ++i) {
+          auto return_values = std::make_shared<std::vector<Tensor>>();
+          auto done = [this, ctx, result, return_values, num_pending,
+                       i](Status status) {
+            StoreResult(ctx, result, return_values, i, status);
+            if (--(*num_pending) == 0) {
+              CallCompleted(ctx, result);
+            }
+          };
+          instantiated_captured_func_->RunAsync(
+              ctx.get(), std::move(input_elements[i]), return_values.get(),
+              std::move(done), model_node());
+        }
+        return;
+      }
+
+      std::vector<Tensor> batched_input;
+      status = CopyBatch(CopyBatchParams(ctx.get()), input_elements,
+                         /*parallel_copy=*/false,
+                         /*allocation_callback=*/nullptr, &batched_input);
+      if (!status.ok()) {
+        result->UpdateStatus(status, /*offset=*/0);
+        CallCompleted(ctx, result);
+        return;
+      }
+      input_elements.clear();
+
+      std::shared_ptr<std::vector<Tensor>> return_values =
+          std::make_shared<std::vector<Tensor>>();
+      auto done = [this, ctx, result, return_values,
+                   num_elements](Status status) {
         if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
-          // To guarantee that the transformation preserves the cardinality of
-          // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
-          // former may be interpreted by a caller as the end of sequence.
           status = errors::InvalidArgument(
               "Function invocation produced OutOfRangeError: ",
               status.message());
         }
-        result->UpdateStatus(status, offset);
-        if (status.ok()) {
-          Status allocate_status =
-              EnsureOutputAllocated(ctx, result, return_values);
-          if (!allocate_status.ok()) {
-            result->UpdateStatus(allocate_status, offset);
-          } else {
-            for (size_t i = 0; i < return_values->size(); ++i) {
-              Tensor& tensor = return_values->at(i);
-              Tensor* batch = &(result->output)[i];
-              if (tensor.NumElements() !=
-                  (batch->NumElements() / batch->dim_size(0))) {
-                TensorShape batch_shape = batch->shape();
-                batch_shape.RemoveDim(0);
-                result->UpdateStatus(
-                    errors::InvalidArgument(
-                        "Cannot add tensor to the batch: number of elements "
-                        "does not match. Shapes are: [tensor]: ",
-                        tensor.shape().DebugString(),
-                        ", [batch]: ", batch_shape.DebugString()),
-                    offset);
-                break;
-              }
-              // TODO(mrry): Add a version of DoParallelConcat that allows us
-              // to move `tensor` where possible, to speed up string tensor
-              // batching.
-              Status copy_status = batch_util::CopyElementToSlice(
-                  std::move(tensor), batch, offset);
-              if (!copy_status.ok()) {
-                result->UpdateStatus(copy_status, offset);
-                break;
-              }
-            }
-          }
-          {
-            mutex_lock l(result->mu);
-            result->num_elements++;
+        for (size_t i = 0; status.ok() && i < return_values->size(); ++i) {
+          const Tensor& tensor = return_values->at(i);
+          if (tensor.dims() == 0 || tensor.dim_size(0) != num_elements) {
+            status = errors::InvalidArgument(
+                "Vectorized map function must return tensors whose leading "
+                "dimension matches the number of input elements (",
+                num_elements, "), but component ", i, " has shape ",
+                tensor.shape().DebugString(),
+                ". Disable `vectorized` if the function is not vectorizable.");
           }
         }
+        result->UpdateStatus(status, /*offset=*/0);
+        if (status.ok()) {
+          mutex_lock l(result->mu);
+          result->output = std::move(*return_values);
+          result->output_allocated = true;
+          result->num_elements = num_elements;
+          RecordBufferEnqueue(ctx.get(), result->output);
+        }
         CallCompleted(ctx, result);
       };
 
-      // Apply the map function on `input_element`, storing the result in
+      // Apply the map function on the batched input, storing the result in
       // `return_values`, and invoking `done` when finished.
-      instantiated_captured_func_->RunAsync(ctx.get(), std::move(input_element),
+      instantiated_captured_func_->RunAsync(ctx.get(), std::move(batched_input),
                                             return_values.get(),
                                             std::move(done), model_node());
     }
@@ -596,6 +737,16 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           }
 
           while (!busy()) {
+            if (dataset()->vectorized_) {
+              // Each batch is produced by a single vectorized call.
+              batch_results_.push_back(std::make_shared<BatchResult>(
+                  dataset()->batch_size_, ctx.get()));
+              batch_results_.back()->num_calls = 1;
+              call_counter_ += dataset()->batch_size_;
+              new_calls.emplace_back(batch_results_.back(), /*offset=*/0);
+              num_calls_++;
+              continue;
+            }
             if (call_counter_ % dataset()->batch_size_ == 0) {
               batch_results_.push_back(std::make_shared<BatchResult>(
                   dataset()->batch_size_, ctx.get()));
@@ -615,7 +766,11 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
               num_elements());
         }
         for (const auto& call : new_calls) {
-          CallFunction(ctx, call.first, call.second);
+          if (dataset()->vectorized_) {
+            CallVectorizedFunction(ctx, call.first);
+          } else {
+            CallFunction(ctx, call.first, call.second);
+          }
         }
         new_calls.clear();
       }
@@ -734,6 +889,7 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
   const std::vector<PartialTensorShape> output_shapes_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const bool preserve_cardinality_;
+  const bool vectorized_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -745,6 +901,9 @@ MapAndBatchDatasetOp::MapAndBatchDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx,
                  ctx->GetAttr(kPreserveCardinality, &preserve_cardinality_));
+  if (ctx->HasAttr(kVectorized)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kVectorized, &vectorized_));
+  }
 }
 
 void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -776,7 +935,8 @@ void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new Dataset(ctx, input, batch_size, num_parallel_calls,
                         drop_remainder, output_types_, output_shapes_,
-                        std::move(captured_func), preserve_cardinality_);
+                        std::move(captured_func), preserve_cardinality_,
+                        vectorized_);
 }
 
 namespace {
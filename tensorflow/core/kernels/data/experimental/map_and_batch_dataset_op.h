@@ -39,6 +39,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kPreserveCardinality =
       "preserve_cardinality";
+  static constexpr const char* const kVectorized = "vectorized";
 
   explicit MapAndBatchDatasetOp(OpKernelConstruction* ctx);
 
@@ -52,6 +53,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   bool preserve_cardinality_;
+  bool vectorized_ = false;
 };
 
 }  // namespace experimental
@@ -29,7 +29,8 @@ class MapAndBatchDatasetParams : public DatasetParams {
       FunctionDefHelper::AttrValueWrapper func,
       std::vector<FunctionDef> func_lib, DataTypeVector type_arguments,
       bool preserve_cardinality, DataTypeVector output_dtypes,
-      std::vector<PartialTensorShape> output_shapes, string node_name)
+      std::vector<PartialTensorShape> output_shapes, string node_name,
+      bool vectorized = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         other_arguments_(std::move(other_arguments)),
@@ -39,7 +40,8 @@ class MapAndBatchDatasetParams : public DatasetParams {
         func_(std::move(func)),
         func_lib_(std::move(func_lib)),
         type_arguments_(std::move(type_arguments)),
-        preserve_cardinality_(preserve_cardinality) {
+        preserve_cardinality_(preserve_cardinality),
+        vectorized_(vectorized) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -76,7 +78,8 @@ class MapAndBatchDatasetParams : public DatasetParams {
                     {"output_shapes", output_shapes_},
                     {"output_types", output_dtypes_},
                     {"preserve_cardinality", preserve_cardinality_},
-                    {"metadata", ""}};
+                    {"metadata", ""},
+                    {"vectorized", vectorized_}};
     return OkStatus();
   }
 
@@ -95,6 +98,7 @@ class MapAndBatchDatasetParams : public DatasetParams {
   std::vector<FunctionDef> func_lib_;
   DataTypeVector type_arguments_;
   bool preserve_cardinality_;
+  bool vectorized_;
 };
 
 class MapAndBatchDatasetOpTest : public DatasetOpsTestBase {};
@@ -209,6 +213,25 @@ MapAndBatchDatasetParams MapAndBatchDatasetParams6() {
       /*node_name=*/kNodeName);
 }
 
+// test case 7: num_parallel_calls = 2, drop_remainder = false,
+// preserve_cardinality = true, MapFunc = XTimesFour, vectorized = true
+MapAndBatchDatasetParams MapAndBatchDatasetParams7() {
+  return MapAndBatchDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*other_arguments=*/{},
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/2,
+      /*drop_remainder=*/false,
+      /*func=*/MapFunc("XTimesFour", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo(), test::function::XTimesFour()},
+      /*type_arguments*/ {},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2})},
+      /*node_name=*/kNodeName,
+      /*vectorized=*/true);
+}
+
 MapAndBatchDatasetParams InvalidNumParallelCallsMapAndBatchDatasetParams() {
   return MapAndBatchDatasetParams(
       RangeDatasetParams(0, 10, 2),
@@ -260,6 +283,11 @@ std::vector<GetNextTestCase<MapAndBatchDatasetParams>> GetNextTestCases() {
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape({2}), {{0, 8}, {16, 24}})},
           {/*dataset_params=*/MapAndBatchDatasetParams6(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({2}), {0, 8}),
+            CreateTensor<int64_t>(TensorShape({2}), {16, 24}),
+            CreateTensor<int64_t>(TensorShape({1}), {32})}},
+          {/*dataset_params=*/MapAndBatchDatasetParams7(),
            /*expected_outputs=*/
            {CreateTensor<int64_t>(TensorShape({2}), {0, 8}),
             CreateTensor<int64_t>(TensorShape({2}), {16, 24}),
@@ -396,6 +424,12 @@ IteratorSaveAndRestoreTestCases() {
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape({2}), {{0, 8}, {16, 24}})},
           {/*dataset_params=*/MapAndBatchDatasetParams6(),
+           /*breakpoints=*/{0, 1, 4},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({2}), {0, 8}),
+            CreateTensor<int64_t>(TensorShape({2}), {16, 24}),
+            CreateTensor<int64_t>(TensorShape({1}), {32})}},
+          {/*dataset_params=*/MapAndBatchDatasetParams7(),
            /*breakpoints=*/{0, 1, 4},
            /*expected_outputs=*/
            {CreateTensor<int64_t>(TensorShape({2}), {0, 8}),
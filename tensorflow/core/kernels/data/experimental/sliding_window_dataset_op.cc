@@ -12,7 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <deque>
+#include <limits>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset.h"
@@ -202,12 +204,18 @@ class SlidingWindowDatasetOp : public UnaryDatasetOpKernel {
 
           // Drop the data before the next iteration.
           if (window_shift >= buffer_.size()) {
-            for (size_t i = buffer_.size(); i < window_shift && input_impl_;
-                 ++i) {
-              bool end_of_input;
-              std::vector<Tensor> element;
-              TF_RETURN_IF_ERROR(
-                  input_impl_->GetNext(ctx, &element, &end_of_input));
+            // The elements between two windows are skipped rather than
+            // produced.
+            int64_t num_to_skip = window_shift - buffer_.size();
+            while (num_to_skip > 0 && input_impl_) {
+              bool end_of_input = false;
+              int num_skipped = 0;
+              TF_RETURN_IF_ERROR(input_impl_->Skip(
+                  ctx,
+                  static_cast<int>(std::min<int64_t>(
+                      num_to_skip, std::numeric_limits<int>::max())),
+                  &end_of_input, &num_skipped));
+              num_to_skip -= num_skipped;
               if (end_of_input) {
                 input_impl_.reset();
               }
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -67,6 +70,9 @@ const char kAnonymousIteratorV3[] = "AnonymousIteratorV3";
 const char kIteratorVariantTypeName[] = "tensorflow::Iterator";
 const char kOutputShapes[] = "output_shapes";
 const char kOutputTypes[] = "output_types";
+const char kWorkStealingRunner[] = "work_stealing_runner";
+const char kIteratorPrefix[] = "Iterator";
+const char kReplayNumElements[] = "replay_num_elements";
 
 bool SymbolicCheckpointEnabled(const Options& options) {
   return options.optional_symbolic_checkpoint_case() ==
@@ -74,6 +80,58 @@ bool SymbolicCheckpointEnabled(const Options& options) {
          options.symbolic_checkpoint();
 }
 
+bool ReplayCheckpointEnabled(const Options& options) {
+  return options.optional_replay_checkpoint_case() ==
+             Options::kReplayCheckpoint &&
+         options.replay_checkpoint();
+}
+
+// Fast-forwards `iterator` by `num_elements` elements, which is how an iterator
+// is restored from a replay checkpoint.
+Status SkipElements(IteratorContext* ctx, int64_t num_elements,
+                    IteratorBase* iterator) {
+  int64_t num_remaining = num_elements;
+  while (num_remaining > 0) {
+    const int num_to_skip = static_cast<int>(
+        std::min<int64_t>(num_remaining, std::numeric_limits<int>::max()));
+    bool end_of_sequence = false;
+    int num_skipped = 0;
+    TF_RETURN_IF_ERROR(
+        iterator->Skip(ctx, num_to_skip, &end_of_sequence, &num_skipped));
+    num_remaining -= num_skipped;
+    if (end_of_sequence) {
+      break;
+    }
+  }
+  if (num_remaining > 0) {
+    return errors::FailedPrecondition(
+        "Failed to restore the iterator from a replay checkpoint: the "
+        "checkpoint was taken after ",
+        num_elements, " elements but the input pipeline only produced ",
+        num_elements - num_remaining,
+        " elements. Replay checkpoints require a deterministic input "
+        "pipeline.");
+  }
+  return OkStatus();
+}
+
+// Returns the number of work-stealing threads of the iterator thread pool.
+int NumWorkStealingThreads() {
+  return GetExperiments().contains(kWorkStealingRunner)
+             ? port::MaxParallelism()
+             : 0;
+}
+
+// Runs the iterator's function invocations on the work-stealing threads of
+// `thread_pool`, if it has any.
+void MaybeUseNonBlockingRunner(UnboundedThreadPool& thread_pool,
+                               IteratorContext::Params& params) {
+  if (thread_pool.NumWorkStealingThreads() > 0) {
+    params.runner = thread_pool.get_non_blocking_runner();
+    params.runner_threadpool_size = thread_pool.NumWorkStealingThreads();
+  }
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const
@@ -87,7 +145,8 @@ IteratorResource::IteratorResource(
     std::unique_ptr<ProcessFunctionLibraryRuntime> pflr,
     FunctionLibraryRuntime* flr)
     : metrics_collector_(flr->device()->device_type(), *env),
-      unbounded_thread_pool_(env, "tf_data_iterator_resource"),
+      unbounded_thread_pool_(env, "tf_data_iterator_resource", ThreadOptions(),
+                             NumWorkStealingThreads()),
       env_(*env),
       device_mgr_(std::move(device_mgr)),
       iterator_state_(std::make_shared<State>(std::move(flib_def),
@@ -127,6 +186,7 @@ Status IteratorResource::GetNext(OpKernelContext* ctx,
   params.symbolic_checkpoint = SymbolicCheckpointEnabled(dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNonBlockingRunner(unbounded_thread_pool_, params);
   params.id_registry = captured_state->id_registry();
   params.warm_start = dataset->options().warm_start();
   std::function<void()> deregister_fn;
@@ -138,6 +198,9 @@ Status IteratorResource::GetNext(OpKernelContext* ctx,
   IteratorContext iter_ctx(std::move(params));
   const absl::Time start_time = metrics_collector_.RecordStart();
   auto status = iterator->GetNext(&iter_ctx, out_tensors, end_of_sequence);
+  if (status.ok() && !*end_of_sequence) {
+    captured_state->IncrementNumElements();
+  }
   metrics_collector_.RecordStop(start_time, *out_tensors);
   const int64_t get_next_latency_micros =
       env_.NowMicros() - absl::ToUnixMicros(start_time);
@@ -177,6 +240,16 @@ Status IteratorResource::Save(OpKernelContext* ctx,
   params.external_state_policy = external_state_policy;
   params.symbolic_checkpoint = SymbolicCheckpointEnabled(dataset->options());
   SerializationContext serialization_ctx(params);
+  if (ReplayCheckpointEnabled(dataset->options())) {
+    // Replaying the input pipeline reproduces its state only if it does not
+    // depend on external state.
+    TF_RETURN_IF_ERROR(serialization_ctx.HandleCheckExternalStateStatus(
+        iterator->dataset()->CheckExternalState()));
+    VLOG(2) << "Saving replay checkpoint after "
+            << captured_state->num_elements() << " elements";
+    return writer->WriteScalar(kIteratorPrefix, kReplayNumElements,
+                               captured_state->num_elements());
+  }
   return iterator->Save(&serialization_ctx, writer);
 }
 
@@ -214,6 +287,7 @@ Status IteratorResource::Restore(OpKernelContext* ctx,
       SymbolicCheckpointEnabled(input_dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNonBlockingRunner(unbounded_thread_pool_, params);
   params.id_registry = new_state->id_registry();
   params.warm_start = dataset->options().warm_start();
   std::function<void()> deregister_fn;
@@ -224,8 +298,19 @@ Status IteratorResource::Restore(OpKernelContext* ctx,
   auto cleanup = gtl::MakeCleanup(std::move(deregister_fn));
   IteratorContext iter_ctx(IteratorContext(std::move(params)));
   std::unique_ptr<IteratorBase> iterator_base;
-  TF_RETURN_IF_ERROR(dataset->MakeIteratorFromCheckpoint(
-      &iter_ctx, "Iterator", reader, &iterator_base));
+  if (reader->Contains(kIteratorPrefix, kReplayNumElements)) {
+    int64_t num_elements;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(kIteratorPrefix, kReplayNumElements, &num_elements));
+    TF_RETURN_IF_ERROR(dataset->MakeIterator(&iter_ctx, /*parent=*/nullptr,
+                                             kIteratorPrefix, &iterator_base));
+    TF_RETURN_IF_ERROR(
+        SkipElements(&iter_ctx, num_elements, iterator_base.get()));
+    new_state->SetNumElements(num_elements);
+  } else {
+    TF_RETURN_IF_ERROR(dataset->MakeIteratorFromCheckpoint(
+        &iter_ctx, kIteratorPrefix, reader, &iterator_base));
+  }
   new_state->DowncastAndSetIteratorAndDataset(std::move(iterator_base),
                                               input_dataset);
   new_state->MergeCheckpoint(iter_ctx.checkpoint());
@@ -254,6 +339,7 @@ Status IteratorResource::SetIteratorFromDataset(OpKernelContext* ctx,
   params.symbolic_checkpoint = SymbolicCheckpointEnabled(dataset->options());
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
+  MaybeUseNonBlockingRunner(unbounded_thread_pool_, params);
   params.id_registry = new_state->id_registry();
   params.warm_start = dataset->options().warm_start();
   std::function<void()> deregister_fn;
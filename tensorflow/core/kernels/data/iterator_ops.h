@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_ITERATOR_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_ITERATOR_OPS_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -130,6 +132,12 @@ class IteratorResource : public ResourceBase {
       return id_registry_;
     }
 
+    // Number of elements produced by the iterator, which is all that a replay
+    // checkpoint stores.
+    int64_t num_elements() const { return num_elements_; }
+    void IncrementNumElements() { ++num_elements_; }
+    void SetNumElements(int64_t num_elements) { num_elements_ = num_elements; }
+
    private:
     std::shared_ptr<FunctionLibraryDefinition> flib_def_;
     FunctionLibraryRuntime* flr_ = nullptr;  // not owned
@@ -141,6 +149,7 @@ class IteratorResource : public ResourceBase {
     core::RefCountPtr<DatasetBase> dataset_;
     std::shared_ptr<MemoryCheckpoint::IdRegistry> id_registry_;
     MemoryCheckpoint checkpoint_;
+    std::atomic<int64_t> num_elements_ = 0;
   };
 
   IteratorMetricsCollector metrics_collector_;
@@ -156,6 +156,10 @@ class MapDatasetOp::Dataset : public DatasetBase {
     Status Initialize(IteratorContext* ctx) override {
       TF_RETURN_IF_ERROR(
           dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      // When `f` is stateless and cannot end the iteration, skipping an
+      // element does not need to compute its output.
+      skip_function_ = dataset()->preserve_cardinality_ &&
+                       dataset()->captured_func_->CheckExternalState().ok();
       return dataset()->captured_func_->Instantiate(
           ctx, &instantiated_captured_func_);
     }
@@ -192,6 +196,15 @@ class MapDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      if (!skip_function_) {
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
+      return input_impl_->Skip(ctx, num_to_skip, end_of_sequence, num_skipped);
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -215,6 +228,7 @@ class MapDatasetOp::Dataset : public DatasetBase {
    private:
     std::unique_ptr<IteratorBase> input_impl_;
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
+    bool skip_function_ = false;
   };
 
   const DatasetBase* const input_;
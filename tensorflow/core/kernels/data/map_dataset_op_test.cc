@@ -105,6 +105,21 @@ std::vector<GetNextTestCase<MapDatasetParams>> GetNextTestCases() {
 
 ITERATOR_GET_NEXT_TEST_P(MapDatasetOpTest, MapDatasetParams, GetNextTestCases())
 
+std::vector<SkipTestCase<MapDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/MapDatasetParams3(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{24}})},
+          {/*dataset_params=*/MapDatasetParams2(),
+           /*num_to_skip*/ 1, /*expected_num_skipped*/ 1, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({2}), {{8, 2}})},
+          {/*dataset_params=*/MapDatasetParams3(),
+           /*num_to_skip*/ 5, /*expected_num_skipped*/ 4, /*get_next*/ false}};
+}
+
+ITERATOR_SKIP_TEST_P(MapDatasetOpTest, MapDatasetParams, SkipTestCases())
+
 TEST_F(MapDatasetOpTest, DatasetNodeName) {
   auto dataset_params = MapDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
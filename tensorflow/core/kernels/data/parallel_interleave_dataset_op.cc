@@ -365,6 +365,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
+          autotune_cycle_length_(!deterministic &&
+                                 params.dataset->input_cycle_length_ ==
+                                     model::kAutotune),
+          active_cycle_length_(std::make_shared<model::SharedState>(
+              autotune_cycle_length_ ? model::kAutotune
+                                     : params.dataset->cycle_length_,
+              mu_, num_parallel_calls_cond_var_)),
           current_elements_(params.dataset->cycle_length_) {}
 
     ~ParallelInterleaveIterator() override { CancelThreads(/*wait=*/true); }
@@ -400,6 +407,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      if (active_cycle_length_->value == model::kAutotune) {
+        // Start with as many open inputs as there are parallel calls and let
+        // autotuning grow or shrink the cycle from there.
+        active_cycle_length_->value = num_parallel_calls_->value;
+      }
       cancellation_manager_ = std::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
       params.interleave_depth += 1;
@@ -479,8 +491,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
                                 /*max=*/dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kCycleLength,
-                                          dataset()->cycle_length_),
+           autotune_cycle_length_
+               ? model::MakeParameter(kCycleLength, active_cycle_length_,
+                                      /*min=*/1,
+                                      /*max=*/dataset()->cycle_length_)
+               : model::MakeNonTunableParameter(kCycleLength,
+                                                dataset()->cycle_length_),
            model::MakeNonTunableParameter(kDeterministic,
                                           deterministic_ ? 1.0 : 0.0),
            model::MakeNonTunableParameter(
@@ -707,7 +723,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     void EnsureInitialElementsCreated(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        const int64_t active_cycle_length = ActiveCycleLength();
+        for (int i = 0; i < active_cycle_length; ++i) {
           current_elements_[i] = MakeElement(ctx);
           if (!current_elements_[i]) {
             break;
@@ -756,6 +773,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // points to a valid result or is null if end of input has been reached.
     bool Consume(IteratorContext* ctx, std::shared_ptr<Result>* result)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (autotune_cycle_length_) {
+        MaybeGrowCycle(ctx);
+      }
       if (deterministic_) {
         return ConsumeHelper(ctx, result);
       }
@@ -811,8 +831,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
+        // available. If autotuning shrank the cycle below this position, the
+        // position is retired instead.
+        if (cycle_index_ >= ActiveCycleLength()) {
+          current_elements_[cycle_index_] = nullptr;
+          UpdateLastValidCurrentElement();
+        } else if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -833,15 +857,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             element->cycle_index = cycle_index_;
             current_workers_cond_var_.notify_one();
           }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
-          }
+          UpdateLastValidCurrentElement();
         }
         if (last_valid_current_element_ != -1) {
           AdvanceToNextInCycle();
@@ -849,6 +865,49 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Moves `last_valid_current_element_` down past trailing null elements.
+    void UpdateLastValidCurrentElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (last_valid_current_element_ >= 0 &&
+             !current_elements_[last_valid_current_element_]) {
+        last_valid_current_element_--;
+        if (cycle_index_ > last_valid_current_element_) {
+          // We are about to move the cycle index below in
+          // AdvanceToNextInCycle().
+          cycle_index_ = last_valid_current_element_;
+        }
+      }
+    }
+
+    // Returns the number of cycle positions that are currently kept open.
+    int64_t ActiveCycleLength() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return autotune_cycle_length_
+                 ? static_cast<int64_t>(active_cycle_length_->value)
+                 : dataset()->cycle_length_;
+    }
+
+    // Opens new elements in the empty positions of the cycle that are below
+    // the active cycle length, which autotuning may have increased.
+    void MaybeGrowCycle(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!initial_elements_created_) {
+        return;
+      }
+      const int64_t active_cycle_length = ActiveCycleLength();
+      for (int64_t i = 0; i < active_cycle_length && !end_of_input_; ++i) {
+        if (current_elements_[i]) {
+          continue;
+        }
+        current_elements_[i] = MakeElement(ctx);
+        if (!current_elements_[i]) {
+          break;
+        }
+        current_elements_[i]->cycle_index = i;
+        elements_to_process_.push_back(i);
+        last_valid_current_element_ =
+            std::max(last_valid_current_element_, i);
+        current_workers_cond_var_.notify_one();
+      }
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1669,6 +1728,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // Determines whether the number of open cycle positions is autotuned. This
+    // is only done when the cycle length is `tf.data.AUTOTUNE` and outputs are
+    // not required to be produced in deterministic order, because changing the
+    // cycle length changes the order in which elements are interleaved.
+    const bool autotune_cycle_length_;
+
+    // Identifies the number of positions of `current_elements_` into which new
+    // elements are opened. Bounded by `dataset()->cycle_length_`.
+    const std::shared_ptr<model::SharedState> active_cycle_length_;
+
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -52,6 +53,8 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
 /* static */ constexpr const char* const PrefetchDatasetOp::kBufferSizeMin;
+/* static */ constexpr const char* const
+    PrefetchDatasetOp::kStageInPinnedMemory;
 
 namespace {
 
@@ -63,18 +66,46 @@ constexpr char kSizeSuffix[] = ".size";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessageSuffix[] = ".error_message";
 
+// Copies the memcpy-able components of `element` into GPU-compatible host
+// memory, so that a subsequent host-to-device copy of the element can be
+// performed by DMA directly from the prefetch buffer instead of going through
+// an intermediate pinned staging buffer on the critical path.
+Status CopyToPinnedHostMemory(IteratorContext* ctx,
+                              std::vector<Tensor>* element) {
+  AllocatorAttributes attr;
+  attr.set_gpu_compatible(true);
+  Allocator* allocator = ctx->allocator(attr);
+  for (size_t i = 0; i < element->size(); ++i) {
+    Tensor& component = (*element)[i];
+    if (!DataTypeCanUseMemcpy(component.dtype()) ||
+        component.NumElements() == 0) {
+      continue;
+    }
+    Tensor pinned(allocator, component.dtype(), component.shape());
+    if (!pinned.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate pinned host memory for component ", i);
+    }
+    tensor::DeepCopy(component, &pinned);
+    component = std::move(pinned);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          bool stage_in_pinned_memory)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        stage_in_pinned_memory_(stage_in_pinned_memory) {
     input_->Ref();
   }
 
@@ -130,12 +161,16 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(legacy_autotune_, &legacy_autotune_attr);
     AttrValue buffer_size_min_attr;
     b->BuildAttrValue(buffer_size_min_, &buffer_size_min_attr);
+    AttrValue stage_in_pinned_memory_attr;
+    b->BuildAttrValue(stage_in_pinned_memory_, &stage_in_pinned_memory_attr);
 
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {input_graph_node, buffer_size},
                       {std::make_pair(kSlackPeriod, slack_period_attr),
                        std::make_pair(kLegacyAutotune, legacy_autotune_attr),
-                       std::make_pair(kBufferSizeMin, buffer_size_min_attr)},
+                       std::make_pair(kBufferSizeMin, buffer_size_min_attr),
+                       std::make_pair(kStageInPinnedMemory,
+                                      stage_in_pinned_memory_attr)},
                       output));
     return OkStatus();
   }
@@ -546,6 +581,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           buffer_element.status = input_impl_->GetNext(
               ctx.get(), &buffer_element.value, &end_of_sequence);
           buffer_element.checkpoint.Merge(ctx->checkpoint());
+          if (dataset()->stage_in_pinned_memory_ &&
+              buffer_element.status.ok() && !end_of_sequence) {
+            buffer_element.status =
+                CopyToPinnedHostMemory(ctx.get(), &buffer_element.value);
+          }
         }
         if (buffer_element.status.ok() && end_of_sequence) {
           mutex_lock l(*mu_);
@@ -655,6 +695,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // Determines whether prefetched elements are copied into GPU-compatible
+  // (pinned) host memory.
+  const bool stage_in_pinned_memory_ = false;
+
   TraceMeMetadata traceme_metadata_;
 };
 
@@ -669,6 +713,10 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kBufferSizeMin)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeMin, &buffer_size_min_));
   }
+  if (ctx->HasAttr(kStageInPinnedMemory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kStageInPinnedMemory,
+                                     &stage_in_pinned_memory_));
+  }
   if (GetExperiments().contains("autotune_buffer_optimization")) {
     legacy_autotune_ = false;
     buffer_size_min_ = std::max(static_cast<int64_t>(1), buffer_size_min_);
@@ -690,7 +738,8 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_,
+                        stage_in_pinned_memory_);
 }
 
 namespace {
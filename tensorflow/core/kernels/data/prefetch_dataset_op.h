@@ -33,6 +33,8 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kSlackPeriod = "slack_period";
   static constexpr const char* const kLegacyAutotune = "legacy_autotune";
   static constexpr const char* const kBufferSizeMin = "buffer_size_min";
+  static constexpr const char* const kStageInPinnedMemory =
+      "stage_in_pinned_memory";
 
   explicit PrefetchDatasetOp(OpKernelConstruction* ctx);
 
@@ -45,6 +47,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   int64_t slack_period_ = 0;
   bool legacy_autotune_ = true;
   int64_t buffer_size_min_ = 0;
+  bool stage_in_pinned_memory_ = false;
 };
 
 }  // namespace data
@@ -29,13 +29,15 @@ class PrefetchDatasetParams : public DatasetParams {
                         DataTypeVector output_dtypes,
                         std::vector<PartialTensorShape> output_shapes,
                         int64_t slack_period, bool legacy_autotune,
-                        int64_t buffer_size_min, string node_name)
+                        int64_t buffer_size_min, string node_name,
+                        bool stage_in_pinned_memory = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        stage_in_pinned_memory_(stage_in_pinned_memory) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -61,6 +63,8 @@ class PrefetchDatasetParams : public DatasetParams {
     attr_vector->emplace_back("legacy_autotune", legacy_autotune_);
     attr_vector->emplace_back("buffer_size_min", buffer_size_min_);
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back("stage_in_pinned_memory",
+                              stage_in_pinned_memory_);
     return OkStatus();
   }
 
@@ -73,6 +77,7 @@ class PrefetchDatasetParams : public DatasetParams {
   int64_t slack_period_;
   bool legacy_autotune_;
   int64_t buffer_size_min_;
+  bool stage_in_pinned_memory_;
 };
 
 // Test case 1: positive buffer size.
@@ -177,6 +182,27 @@ PrefetchDatasetParams PrefetchDatasetParams6() {
       /*node_name=*/kNodeName);
 }
 
+// Test case 7: stage_in_pinned_memory = true.
+PrefetchDatasetParams PrefetchDatasetParams7() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{10, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}),
+                      CreateTensor<tstring>(TensorShape{10, 1},
+                                            {"a", "b", "c", "d", "e", "f", "g",
+                                             "h", "i", "j"})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/5,
+      /*output_dtypes=*/{DT_INT64, DT_STRING},
+      /*output_shapes=*/{PartialTensorShape({1}), PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*buffer_size_min=*/0,
+      /*node_name=*/kNodeName,
+      /*stage_in_pinned_memory=*/true);
+}
+
 PrefetchDatasetParams InvalidBufferSizePrefetchDatasetParams() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
       /*components=*/{CreateTensor<int64_t>(TensorShape{10, 1},
@@ -223,7 +249,30 @@ std::vector<GetNextTestCase<PrefetchDatasetParams>> GetNextTestCases() {
        /*expected_outputs=*/
        CreateTensors<int64_t>(
            TensorShape{1},
-           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{1}, {0}),
+        CreateTensor<tstring>(TensorShape{1}, {"a"}),
+        CreateTensor<int64_t>(TensorShape{1}, {1}),
+        CreateTensor<tstring>(TensorShape{1}, {"b"}),
+        CreateTensor<int64_t>(TensorShape{1}, {2}),
+        CreateTensor<tstring>(TensorShape{1}, {"c"}),
+        CreateTensor<int64_t>(TensorShape{1}, {3}),
+        CreateTensor<tstring>(TensorShape{1}, {"d"}),
+        CreateTensor<int64_t>(TensorShape{1}, {4}),
+        CreateTensor<tstring>(TensorShape{1}, {"e"}),
+        CreateTensor<int64_t>(TensorShape{1}, {5}),
+        CreateTensor<tstring>(TensorShape{1}, {"f"}),
+        CreateTensor<int64_t>(TensorShape{1}, {6}),
+        CreateTensor<tstring>(TensorShape{1}, {"g"}),
+        CreateTensor<int64_t>(TensorShape{1}, {7}),
+        CreateTensor<tstring>(TensorShape{1}, {"h"}),
+        CreateTensor<int64_t>(TensorShape{1}, {8}),
+        CreateTensor<tstring>(TensorShape{1}, {"i"}),
+        CreateTensor<int64_t>(TensorShape{1}, {9}),
+        CreateTensor<tstring>(TensorShape{1}, {"j"})}}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(PrefetchDatasetOpTest, PrefetchDatasetParams,
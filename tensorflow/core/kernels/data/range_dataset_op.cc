@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/range_dataset_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
 #include <utility>
@@ -105,6 +106,18 @@ class RangeCounter {
     return result;
   }
 
+  // Advances the counter by up to `num_to_skip` values without producing
+  // them. Returns the number of values skipped.
+  int64_t Skip(int64_t num_to_skip) {
+    mutex_lock l(mu_);
+    const int64_t remaining = RangeCardinality(next_, stop_, step_);
+    const int64_t num_skipped =
+        remaining == kInfiniteCardinality ? num_to_skip
+                                          : std::min(num_to_skip, remaining);
+    next_ += num_skipped * step_;
+    return num_skipped;
+  }
+
   int64_t Peek() const {
     mutex_lock l(mu_);
     return next_;
@@ -293,6 +306,18 @@ class RangeDatasetOp::Dataset : public DatasetBase {
       return ConvertOutputTypes(output_dtypes(), out_tensors, value);
     }
 
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      if (split_provider_ != nullptr) {
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
+      // Skipping a range only moves the counter, so no output is produced.
+      *num_skipped = counter_->Skip(num_to_skip);
+      *end_of_sequence = *num_skipped < num_to_skip;
+      return OkStatus();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -74,6 +74,23 @@ std::vector<GetNextTestCase<RangeDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(RangeDatasetOpTest, RangeDatasetParams,
                          GetNextTestCases())
 
+std::vector<SkipTestCase<RangeDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/PositiveStepRangeDatasetParams(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{6}})},
+          {/*dataset_params=*/NegativeStepRangeDatasetParams(),
+           /*num_to_skip*/ 3, /*expected_num_skipped*/ 3, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{1}})},
+          {/*dataset_params=*/PositiveStepRangeDatasetParams(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ false},
+          {/*dataset_params=*/PositiveStepRangeDatasetParams(),
+           /*num_to_skip*/ 10, /*expected_num_skipped*/ 4, /*get_next*/ false}};
+}
+
+ITERATOR_SKIP_TEST_P(RangeDatasetOpTest, RangeDatasetParams, SkipTestCases())
+
 TEST_F(RangeDatasetOpTest, DatasetNodeName) {
   auto range_dataset_params = PositiveStepRangeDatasetParams();
   TF_ASSERT_OK(Initialize(range_dataset_params));
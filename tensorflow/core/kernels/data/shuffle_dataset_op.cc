@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -29,10 +31,13 @@ limitations under the License.
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -63,6 +68,10 @@ namespace data {
 
 const int64_t kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64_t kMaxEpochsInBuffer = 3;
+// Buffers at least this large are filled with multiple concurrent calls to the
+// input iterator when the pipeline does not require determinism.
+const int64_t kMinParallelFillBufferSize = 10000;
+const int64_t kMaxParallelFillThreads = 16;
 
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
@@ -443,6 +452,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     Status FillBuffer(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       int64_t start_micros = EnvTime::NowMicros();
       int64_t num_log_entries = 0;
+      const bool initial_fill = num_elements_ == 0 && ShouldFillBuffer();
+      if (initial_fill && ShouldFillInParallel(ctx)) {
+        TF_RETURN_IF_ERROR(ParallelFillBuffer(ctx));
+      }
       while (ShouldFillBuffer()) {
         if (EnvTime::NowMicros() >
             ((num_log_entries + 1) * kLogIntervalMicros) + start_micros) {
@@ -479,9 +492,86 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       if (num_log_entries > 0) {
         LOG(INFO) << "Shuffle buffer filled.";
       }
+      if (initial_fill && num_elements_ > 0) {
+        metrics::RecordTFDataShuffleBufferFillTime(EnvTime::NowMicros() -
+                                                   start_micros);
+      }
       return OkStatus();
     }
 
+    // Returns whether the buffer should be filled by concurrent calls to the
+    // input iterator. Concurrent calls make the order in which input elements
+    // enter the buffer (and hence the shuffle order) nondeterministic, so this
+    // is only done when the user has opted out of determinism.
+    bool ShouldFillInParallel(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const Options& options = dataset()->options();
+      return !IsShuffleAll() && buffer_->size() >= kMinParallelFillBufferSize &&
+             ctx->runner_threadpool_size() > 1 &&
+             options.optional_deterministic_case() ==
+                 Options::kDeterministic &&
+             !options.deterministic();
+    }
+
+    // Fills the buffer with up to `buffer_->size() - num_elements_` elements
+    // of the current epoch using multiple threads. Each thread accumulates
+    // elements into its own shard, and the shards are interleaved into the
+    // buffer once all threads finish, which keeps the buffer layout (and
+    // hence checkpointing) identical to the sequential fill.
+    Status ParallelFillBuffer(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!input_impl_) {
+        TF_RETURN_IF_ERROR(PrepareNextEpoch(ctx));
+      }
+      const int64_t num_threads = std::min<int64_t>(
+          ctx->runner_threadpool_size(), kMaxParallelFillThreads);
+      VLOG(1) << "Filling shuffle buffer of size " << BufferSizeString()
+              << " using " << num_threads << " threads.";
+      IteratorBase* input_impl = input_impl_.get();
+      std::vector<std::vector<std::vector<Tensor>>> shards(num_threads);
+      std::atomic<int64_t> remaining(buffer_->size() - num_elements_);
+      std::atomic<bool> end_of_input(false);
+      mutex status_mu;
+      Status status;
+      BlockingCounter counter(num_threads);
+      for (int64_t i = 0; i < num_threads; ++i) {
+        (*ctx->runner())([&, i]() {
+          while (!end_of_input && remaining.fetch_sub(1) > 0) {
+            std::vector<Tensor> element;
+            bool end_of_sequence = false;
+            Status s = input_impl->GetNext(ctx, &element, &end_of_sequence);
+            if (!s.ok()) {
+              mutex_lock l(status_mu);
+              status.Update(s);
+            }
+            if (!s.ok() || end_of_sequence) {
+              end_of_input = true;
+              break;
+            }
+            shards[i].push_back(std::move(element));
+          }
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+      // Interleave the shards so that elements from all threads are spread
+      // over the buffer.
+      size_t max_shard_size = 0;
+      for (const auto& shard : shards) {
+        max_shard_size = std::max(max_shard_size, shard.size());
+      }
+      for (size_t j = 0; j < max_shard_size; ++j) {
+        for (auto& shard : shards) {
+          if (j < shard.size()) {
+            AddToShuffleBuffer(ctx, std::move(shard[j]));
+          }
+        }
+      }
+      // If the input was exhausted, the sequential fill that follows observes
+      // the end of sequence and takes care of advancing to the next epoch.
+      return status;
+    }
+
     bool ShouldFillBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!input_impl_ && dataset()->count_ != -1 &&
           epoch_ >= dataset()->count_) {
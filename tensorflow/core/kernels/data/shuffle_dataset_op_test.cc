@@ -11,12 +11,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -594,6 +598,43 @@ TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   }
 }
 
+TEST_F(ShuffleDatasetOpTest, ParallelFillProducesEveryElementOnce) {
+  // Opting out of determinism allows large buffers to be filled in parallel.
+  Options options;
+  options.set_deterministic(false);
+  constexpr int64_t kNumElements = 20000;
+  auto dataset_params = ShuffleDatasetParams(
+      OptionsDatasetParams(RangeDatasetParams(0, kNumElements, 1),
+                           options.SerializeAsString(),
+                           /*output_dtypes=*/{DT_INT64},
+                           /*output_shapes=*/{PartialTensorShape({})},
+                           /*node_name=*/"options_dataset"),
+      /*buffer_size=*/kNumElements / 2,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*count=*/1,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  std::vector<int64_t> values;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    for (const Tensor& t : next) {
+      values.push_back(t.scalar<int64_t>()());
+    }
+  }
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected(kNumElements);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(values, expected);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
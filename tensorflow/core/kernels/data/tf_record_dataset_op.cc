@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/readahead_file.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -37,6 +43,7 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const TFRecordDatasetOp::kReadaheadBlocks;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
@@ -45,6 +52,8 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+constexpr size_t kReadaheadBlockSize = 1 << 20;  // 1MB.
+constexpr int64_t kMaxReadaheadThreads = 8;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -58,14 +67,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   int64_t readahead_blocks, const string& index_cache_dir)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        readahead_blocks_(readahead_blocks),
+        index_cache_dir_(index_cache_dir) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -102,6 +114,54 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return OkStatus(); }
 
+  // Counting the records needs the index of every file, which may have to be
+  // built by scanning the record headers of the files that have no valid
+  // index in `index_cache_dir_`. This is only done when random access is
+  // requested.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() !=
+        CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    mutex_lock l(index_mu_);
+    if (!EnsureRecordIndexLocked(Env::Default()).ok()) {
+      return kUnknownCardinality;
+    }
+    return cumulative_num_records_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    {
+      mutex_lock l(index_mu_);
+      TF_RETURN_IF_ERROR(EnsureRecordIndexLocked(ctx->env()));
+    }
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    size_t file_index;
+    uint64 offset;
+    {
+      tf_shared_lock l(index_mu_);
+      file_index = std::upper_bound(cumulative_num_records_.begin(),
+                                    cumulative_num_records_.end(), index) -
+                   cumulative_num_records_.begin() - 1;
+      offset = record_offsets_[file_index]
+                              [index - cumulative_num_records_[file_index]];
+    }
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+        TranslateFileName(filenames_[file_index]), &file));
+    io::RecordReader reader(file.get());
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx->get_allocator({}), DT_STRING,
+                              TensorShape({}));
+    TF_RETURN_IF_ERROR(
+        reader.ReadRecord(&offset, &out_tensors->back().scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(out_tensors->back().scalar<tstring>()().size());
+    return OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -112,8 +172,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue readahead_blocks;
+    b->BuildAttrValue(readahead_blocks_, &readahead_blocks);
+    AttrValue index_cache_dir;
+    b->BuildAttrValue(index_cache_dir_, &index_cache_dir);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kReadaheadBlocks, readahead_blocks),
+         std::make_pair(kIndexCacheDir, index_cache_dir)},
+        output));
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
     return OkStatus();
@@ -263,6 +330,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
           &file_));
+      if (dataset()->readahead_blocks_ > 0) {
+        if (!readahead_thread_pool_) {
+          readahead_thread_pool_ = std::make_unique<thread::ThreadPool>(
+              env, ThreadOptions(), "tf_data_tf_record_readahead",
+              std::min(dataset()->readahead_blocks_, kMaxReadaheadThreads),
+              /*low_latency_hint=*/false);
+        }
+        file_ = std::make_unique<ReadaheadFile>(
+            std::move(file_), readahead_thread_pool_.get(),
+            kReadaheadBlockSize, dataset()->readahead_blocks_);
+      }
       reader_ = std::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       if (!dataset()->byte_offsets_.empty()) {
@@ -281,22 +359,85 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
+    // Runs the block reads issued by `file_` when readahead is enabled. Must
+    // outlive `file_`.
+    std::unique_ptr<thread::ThreadPool> readahead_thread_pool_
+        TF_GUARDED_BY(mu_);
+
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Loads the record offsets of all files. The indices are kept in memory, and
+  // only persisted if the user names an index cache directory.
+  Status EnsureRecordIndexLocked(Env* env) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(index_mu_) {
+    if (!cumulative_num_records_.empty()) {
+      return OkStatus();
+    }
+    if (options_.compression_type != io::RecordReaderOptions::NONE) {
+      return errors::FailedPrecondition(
+          "Random access is only supported for uncompressed TFRecord files, "
+          "but the compression type is ", compression_type_, ".");
+    }
+    std::vector<std::vector<uint64>> record_offsets;
+    record_offsets.reserve(filenames_.size());
+    std::vector<int64_t> cumulative_num_records = {0};
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      TFRecordIndex index;
+      TF_RETURN_IF_ERROR(LoadOrBuildTFRecordIndex(
+          env, index_cache_dir_, TranslateFileName(filenames_[i]), &index));
+      std::vector<uint64>& offsets = record_offsets.emplace_back(
+          index.offsets.begin(), index.offsets.end());
+      if (!byte_offsets_.empty()) {
+        // Records before the requested byte offset are not part of the
+        // dataset.
+        offsets.erase(offsets.begin(),
+                      std::lower_bound(offsets.begin(), offsets.end(),
+                                       static_cast<uint64>(byte_offsets_[i])));
+      }
+      cumulative_num_records.push_back(cumulative_num_records.back() +
+                                       offsets.size());
+    }
+    record_offsets_ = std::move(record_offsets);
+    cumulative_num_records_ = std::move(cumulative_num_records);
+    return OkStatus();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  const int64_t readahead_blocks_;
+  const string index_cache_dir_;
+
+  // Guards the record index used for random access, which is loaded on the
+  // first call to `Get()` or `Cardinality()` with moderate compute level.
+  mutable mutex index_mu_;
+  // The offsets of the records of each file.
+  mutable std::vector<std::vector<uint64>> record_offsets_
+      TF_GUARDED_BY(index_mu_);
+  // `cumulative_num_records_[i]` is the number of records in the files before
+  // the `i`-th file. Empty until the index is loaded.
+  mutable std::vector<int64_t> cumulative_num_records_
+      TF_GUARDED_BY(index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  if (ctx->HasAttr(kReadaheadBlocks)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadaheadBlocks, &readahead_blocks_));
+    OP_REQUIRES(ctx, readahead_blocks_ >= 0,
+                errors::InvalidArgument("`readahead_blocks` must be >= 0."));
+  }
+  if (ctx->HasAttr(kIndexCacheDir)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kIndexCacheDir, &index_cache_dir_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -361,7 +502,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        readahead_blocks_, index_cache_dir_);
 }
 
 namespace {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_DATASET_OP_H_
 
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -27,6 +29,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kByteOffsets = "byte_offsets";
+  static constexpr const char* const kReadaheadBlocks = "readahead_blocks";
+  static constexpr const char* const kIndexCacheDir = "index_cache_dir";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -36,6 +40,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  int64_t readahead_blocks_ = 0;
+  std::string index_cache_dir_;
 };
 
 }  // namespace data
@@ -46,13 +46,17 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        std::vector<int64_t> byte_offsets, string node_name)
+                        std::vector<int64_t> byte_offsets, string node_name,
+                        int64_t readahead_blocks = 0,
+                        string index_cache_dir = "")
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         buffer_size_(buffer_size),
-        byte_offsets_(std::move(byte_offsets)) {
+        byte_offsets_(std::move(byte_offsets)),
+        readahead_blocks_(readahead_blocks),
+        index_cache_dir_(std::move(index_cache_dir)) {
     op_version_ = 2;
   }
 
@@ -80,6 +84,10 @@ class TFRecordDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kReadaheadBlocks,
+                              readahead_blocks_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kIndexCacheDir,
+                              index_cache_dir_);
     return OkStatus();
   }
 
@@ -92,6 +100,8 @@ class TFRecordDatasetParams : public DatasetParams {
   CompressionType compression_type_;
   int64_t buffer_size_;
   std::vector<int64_t> byte_offsets_;
+  int64_t readahead_blocks_;
+  string index_cache_dir_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -208,6 +218,26 @@ TFRecordDatasetParams InvalidByteOffsets() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 6: multiple text files with GZIP compression, read through the
+// readahead path.
+TFRecordDatasetParams TFRecordDatasetParams6() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::GZIP;
+  absl::Status status = CreateTestFiles(filenames, contents, compression_type);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*readahead_blocks=*/4);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -223,7 +253,10 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}),
-           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})}};
+           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -333,6 +366,83 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+TEST_F(TFRecordDatasetOpTest, Get) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 6);
+  std::vector<tstring> expected = {"ccc", "1", "bb", "333", "a", "22"};
+  std::vector<int64_t> indices = {5, 0, 4, 2, 3, 1};
+  for (int i = 0; i < indices.size(); ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), indices[i], &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(dataset_ctx_.get(), 6, &out_tensors).code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, GetKeepsIndexInMemory) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), 0, &out_tensors));
+  std::vector<string> index_files;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_*.*"),
+      &index_files));
+  EXPECT_TRUE(index_files.empty());
+}
+
+TEST_F(TFRecordDatasetOpTest, GetWithIndexCacheDir) {
+  const string cache_dir =
+      absl::StrCat(testing::TmpDir(), "/tf_record_index_cache");
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_2")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}, {"a", "bb"}},
+                               CompressionType::UNCOMPRESSED));
+  TFRecordDatasetParams dataset_params(filenames,
+                                       CompressionType::UNCOMPRESSED,
+                                       /*buffer_size=*/10,
+                                       /*byte_offsets=*/{},
+                                       /*node_name=*/kNodeName,
+                                       /*readahead_blocks=*/0, cache_dir);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), 4, &out_tensors));
+  EXPECT_EQ(out_tensors[0].scalar<tstring>()(), "bb");
+  std::vector<string> index_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &index_files));
+  EXPECT_EQ(index_files.size(), 2);
+}
+
+TEST_F(TFRecordDatasetOpTest, GetWithByteOffsets) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<tstring> expected = {"1", "22", "333", "bb", "ccc", "zzz"};
+  for (int i = 0; i < expected.size(); ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), i, &out_tensors));
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+}
+
+TEST_F(TFRecordDatasetOpTest, GetCompressed) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(dataset_ctx_.get(), 0, &out_tensors).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -346,6 +456,10 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/window_dataset.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -33,12 +34,23 @@ constexpr char kWindow[] = "Window";
 constexpr char kWindowOp[] = "WindowOp";
 constexpr char kCurIndex[] = "i";
 
+// Represents the elements `start`, `start + stride`, ... of `elements`. If
+// `component` is not `kAllComponents`, only that component of each element is
+// part of the window.
 class Window : public DatasetBase {
  public:
-  Window(std::vector<std::vector<Tensor>> elements, DataTypeVector output_types,
+  static constexpr int64_t kAllComponents = -1;
+
+  Window(std::shared_ptr<const std::vector<std::vector<Tensor>>> elements,
+         int64_t component, int64_t start, int64_t stride,
+         int64_t num_elements, DataTypeVector output_types,
          std::vector<PartialTensorShape> output_shapes)
       : DatasetBase(DatasetContext({kWindowOp, kWindow})),
         elements_(std::move(elements)),
+        component_(component),
+        start_(start),
+        stride_(stride),
+        num_elements_(num_elements),
         output_types_(std::move(output_types)),
         output_shapes_(std::move(output_shapes)) {}
 
@@ -56,22 +68,22 @@ class Window : public DatasetBase {
 
   int64_t AllocatedBytes() const override {
     int64_t allocated_bytes = 0;
-    for (auto& element : elements_) {
-      allocated_bytes += GetAllocatedBytes(element);
+    for (int64_t i = 0; i < num_elements_; ++i) {
+      allocated_bytes += GetAllocatedBytes(Element(i));
     }
     return allocated_bytes;
   }
 
   int64_t TotalBytes() const override {
     int64_t total_bytes = 0;
-    for (auto& element : elements_) {
-      total_bytes += GetTotalBytes(element);
+    for (int64_t i = 0; i < num_elements_; ++i) {
+      total_bytes += GetTotalBytes(Element(i));
     }
     return total_bytes;
   }
 
   int64_t CardinalityInternal(CardinalityOptions options) const override {
-    return elements_.size();
+    return num_elements_;
   }
 
   string DebugString() const override { return kWindow; }
@@ -94,8 +106,8 @@ class Window : public DatasetBase {
                                    " does not support serialization");
     }
     std::vector<Node*> input_nodes;
-    for (const auto& element : elements_) {
-      for (const auto& t : element) {
+    for (int64_t i = 0; i < num_elements_; ++i) {
+      for (const auto& t : Element(i)) {
         Node* node;
         TF_RETURN_IF_ERROR(b->AddDatasetOrTensor(ctx, t, &node));
         input_nodes.emplace_back(node);
@@ -115,11 +127,11 @@ class Window : public DatasetBase {
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       mutex_lock l(mu_);
-      if (i_ == dataset()->elements_.size()) {
+      if (i_ == dataset()->num_elements_) {
         *end_of_sequence = true;
       } else {
         *end_of_sequence = false;
-        *out_tensors = dataset()->elements_[i_++];
+        *out_tensors = dataset()->Element(i_++);
       }
       return OkStatus();
     }
@@ -136,15 +148,28 @@ class Window : public DatasetBase {
       mutex_lock l(mu_);
       int64_t i;
       TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kCurIndex, &i));
-      i_ = size_t(i);
+      i_ = i;
       return OkStatus();
     }
 
     mutex mu_;
-    size_t i_ TF_GUARDED_BY(mu_) = 0;
+    int64_t i_ TF_GUARDED_BY(mu_) = 0;
   };
 
-  const std::vector<std::vector<Tensor>> elements_;
+  // Returns the `i`-th element of the window.
+  std::vector<Tensor> Element(int64_t i) const {
+    const std::vector<Tensor>& element = (*elements_)[start_ + i * stride_];
+    if (component_ == kAllComponents) {
+      return element;
+    }
+    return {element[component_]};
+  }
+
+  const std::shared_ptr<const std::vector<std::vector<Tensor>>> elements_;
+  const int64_t component_;
+  const int64_t start_;
+  const int64_t stride_;
+  const int64_t num_elements_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
 };
@@ -170,7 +195,12 @@ class WindowOp : public DatasetOpKernel {
       }
       elements.push_back(std::move(element));
     }
-    *output = new Window(std::move(elements), output_types_, output_shapes_);
+    const int64_t num_window_elements = elements.size();
+    *output = new Window(
+        std::make_shared<const std::vector<std::vector<Tensor>>>(
+            std::move(elements)),
+        Window::kAllComponents, /*start=*/0, /*stride=*/1, num_window_elements,
+        output_types_, output_shapes_);
   }
 
  private:
@@ -188,7 +218,23 @@ Status NewWindow(std::vector<std::vector<Tensor>> elements,
                  DatasetBase** out_dataset) {
   // TODO(mrry): If this becomes more public, we must validate that
   // the elements match the output_types and output_shapes.
-  *out_dataset = new Window(std::move(elements), std::move(output_types),
+  const int64_t num_elements = elements.size();
+  *out_dataset = new Window(
+      std::make_shared<const std::vector<std::vector<Tensor>>>(
+          std::move(elements)),
+      Window::kAllComponents, /*start=*/0, /*stride=*/1, num_elements,
+      std::move(output_types), std::move(output_shapes));
+  (*out_dataset)->Initialize(/*metadata=*/{});
+  return OkStatus();
+}
+
+Status NewWindowView(
+    std::shared_ptr<const std::vector<std::vector<Tensor>>> elements,
+    int64_t component, int64_t start, int64_t stride, int64_t num_elements,
+    DataTypeVector output_types, std::vector<PartialTensorShape> output_shapes,
+    DatasetBase** out_dataset) {
+  *out_dataset = new Window(std::move(elements), component, start, stride,
+                            num_elements, std::move(output_types),
                             std::move(output_shapes));
   (*out_dataset)->Initialize(/*metadata=*/{});
   return OkStatus();
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_WINDOW_DATASET_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_WINDOW_DATASET_H_
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset.h"
@@ -44,6 +45,20 @@ Status NewWindow(std::vector<std::vector<Tensor>> elements,
                  std::vector<PartialTensorShape> output_shapes,
                  DatasetBase** out_dataset);
 
+// Creates a window dataset whose elements are views into `elements`, which
+// may be shared by many windows. The window contains the `component`-th
+// component of `num_elements` elements, starting at `elements[start]` and
+// taking every `stride`-th element. The referenced elements must not be
+// modified while the window is alive.
+//
+// REQUIRES: `output_types` and `output_shapes` must have a single entry,
+// matching the `component`-th component of the elements.
+Status NewWindowView(
+    std::shared_ptr<const std::vector<std::vector<Tensor>>> elements,
+    int64_t component, int64_t start, int64_t stride, int64_t num_elements,
+    DataTypeVector output_types, std::vector<PartialTensorShape> output_shapes,
+    DatasetBase** out_dataset);
+
 }  // namespace data
 }  // namespace tensorflow
 
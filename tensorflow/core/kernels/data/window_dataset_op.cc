@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/window_dataset_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/kernels/data/window_dataset.h"
@@ -140,7 +146,10 @@ class WindowDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          target_buffer_size_(
+              TargetBufferSize(params.dataset->window_size_,
+                               params.dataset->window_stride_)) {}
 
     Status Initialize(IteratorContext* ctx) override {
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
@@ -149,18 +158,19 @@ class WindowDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      const int64_t window_size = dataset()->window_size_;
       const int64_t window_shift = dataset()->window_shift_;
       const int64_t window_stride = dataset()->window_stride_;
-      std::vector<std::vector<Tensor>> window_elements;
+      std::shared_ptr<const std::vector<std::vector<Tensor>>> window_elements;
+      int64_t window_start = 0;
+      int64_t num_window_elements = 0;
       Status status = OkStatus();
       {
-        const size_t target_size = TargetBufferSize(window_size, window_stride);
+        const int64_t target_size = target_buffer_size_;
 
         mutex_lock l(mu_);
         if (!input_impl_ &&
-            (buffer_.empty() ||
-             (dataset()->drop_remainder_ && buffer_.size() < target_size))) {
+            (BufferSizeLocked() == 0 || (dataset()->drop_remainder_ &&
+                                         BufferSizeLocked() < target_size))) {
           *end_of_sequence = true;
           return OkStatus();
         }
@@ -168,14 +178,14 @@ class WindowDatasetOp::Dataset : public DatasetBase {
         // Add elements to the buffer.
         if (input_impl_) {
           *end_of_sequence = false;
-          for (size_t i = buffer_.size(); i < target_size && !*end_of_sequence;
-               ++i) {
+          for (int64_t i = BufferSizeLocked();
+               i < target_size && !*end_of_sequence; ++i) {
             std::vector<Tensor> element;
             Status status =
                 input_impl_->GetNext(ctx, &element, end_of_sequence);
             if (!*end_of_sequence) {
               RecordBufferEnqueue(ctx, element);
-              buffer_.emplace_back(std::move(element), status);
+              AppendLocked(std::move(element), status);
             } else {
               input_impl_.reset();
             }
@@ -184,26 +194,27 @@ class WindowDatasetOp::Dataset : public DatasetBase {
 
         // If there are not enough elements and `drop_remainder` is set, we do
         // not wish to return a smaller window.
-        if (buffer_.empty() ||
-            (dataset()->drop_remainder_ && buffer_.size() < target_size)) {
+        const int64_t buffer_size = BufferSizeLocked();
+        if (buffer_size == 0 ||
+            (dataset()->drop_remainder_ && buffer_size < target_size)) {
           DCHECK(*end_of_sequence);
           return OkStatus();
         }
 
-        int num_elements = 1 + (buffer_.size() - 1) / window_stride;
-        window_elements.reserve(num_elements);
-        for (size_t i = 0; i < num_elements; ++i) {
-          status.Update(buffer_[window_stride * i].status);
+        num_window_elements = 1 + (buffer_size - 1) / window_stride;
+        for (int64_t i = 0; i < num_window_elements; ++i) {
+          status.Update(statuses_[begin_ + window_stride * i]);
           if (!status.ok()) {
             break;
           }
-          window_elements.emplace_back(buffer_[window_stride * i].result);
         }
+        // The buffer is append-only, so the windows can refer to it directly.
+        window_elements = elements_;
+        window_start = begin_;
 
         // Shift the window, discarding elements if necessary.
-        int buffer_size = buffer_.size();
         if (window_shift >= buffer_size) {
-          for (size_t i = buffer_size; input_impl_ && i < window_shift; ++i) {
+          for (int64_t i = buffer_size; input_impl_ && i < window_shift; ++i) {
             bool end_of_input;
             std::vector<Tensor> element;
             // Ignore non-error status of discarded elements.
@@ -212,16 +223,12 @@ class WindowDatasetOp::Dataset : public DatasetBase {
               input_impl_.reset();
             }
           }
-          for (size_t i = 0; i < buffer_.size(); ++i) {
-            RecordBufferDequeue(ctx, buffer_.at(i).result);
-          }
-          buffer_.clear();
-        } else {
-          for (size_t i = 0; i < window_shift; ++i) {
-            RecordBufferDequeue(ctx, buffer_.at(i).result);
-          }
-          buffer_.erase(buffer_.begin(), buffer_.begin() + window_shift);
         }
+        const int64_t num_dropped = std::min(window_shift, buffer_size);
+        for (int64_t i = 0; i < num_dropped; ++i) {
+          RecordBufferDequeue(ctx, (*elements_)[begin_ + i]);
+        }
+        begin_ += num_dropped;
       }
 
       if (!status.ok()) {
@@ -229,25 +236,18 @@ class WindowDatasetOp::Dataset : public DatasetBase {
       }
 
       // Construct output tensors.
-      const size_t num_tuple_components = window_elements[0].size();
-      const int64_t num_window_elements = window_elements.size();
+      const size_t num_tuple_components =
+          dataset()->input_->output_dtypes().size();
       *end_of_sequence = false;
       for (size_t idx = 0; idx < num_tuple_components; ++idx) {
         DatasetBase* window_dataset;
-        std::vector<std::vector<Tensor>> window_component_elements;
-        window_component_elements.reserve(num_window_elements);
-        // Build the output tuple component by copying one slice
-        // from each input element in the window.
-        for (size_t i = 0; i < num_window_elements; ++i) {
-          std::vector<Tensor> component_element;
-          component_element.push_back(std::move(window_elements[i][idx]));
-          window_component_elements.push_back(component_element);
-        }
         DataTypeVector output_types({dataset()->input_->output_dtypes()[idx]});
         std::vector<PartialTensorShape> output_shapes(
             {dataset()->input_->output_shapes()[idx]});
-        TF_RETURN_IF_ERROR(NewWindow(window_component_elements, output_types,
-                                     output_shapes, &window_dataset));
+        TF_RETURN_IF_ERROR(NewWindowView(window_elements, idx, window_start,
+                                         window_stride, num_window_elements,
+                                         output_types, output_shapes,
+                                         &window_dataset));
         out_tensors->emplace_back(DT_VARIANT, TensorShape({}));
         TF_RETURN_IF_ERROR(
             StoreDatasetInVariantTensor(window_dataset, &out_tensors->back()));
@@ -271,17 +271,20 @@ class WindowDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
       }
       // Save buffer.
+      const int64_t buffer_size = BufferSizeLocked();
       TF_RETURN_IF_ERROR(
-          writer->WriteScalar(prefix(), kBufferSize, buffer_.size()));
-      for (int64_t i = 0; i < buffer_.size(); i++) {
-        TF_RETURN_IF_ERROR(WriteStatusLocked(writer, i, buffer_[i].status));
+          writer->WriteScalar(prefix(), kBufferSize, buffer_size));
+      for (int64_t i = 0; i < buffer_size; i++) {
+        const std::vector<Tensor>& element = (*elements_)[begin_ + i];
+        TF_RETURN_IF_ERROR(
+            WriteStatusLocked(writer, i, statuses_[begin_ + i]));
         TF_RETURN_IF_ERROR(writer->WriteScalar(
             prefix(), strings::StrCat(kBuffer, "[", i, "]", kSizeSuffix),
-            buffer_[i].result.size()));
-        for (int64_t j = 0; j < buffer_[i].result.size(); j++) {
+            element.size()));
+        for (int64_t j = 0; j < element.size(); j++) {
           TF_RETURN_IF_ERROR(writer->WriteTensor(
               prefix(), strings::StrCat(kBuffer, "[", i, "][", j, "]"),
-              buffer_[i].result[j]));
+              element[j]));
         }
       }
       return OkStatus();
@@ -299,20 +302,25 @@ class WindowDatasetOp::Dataset : public DatasetBase {
       int64_t buffer_size = 0;
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(prefix(), kBufferSize, &buffer_size));
-      buffer_.resize(buffer_size);
+      if (buffer_size < 0 || buffer_size > target_buffer_size_) {
+        return errors::DataLoss("Invalid window buffer size: ", buffer_size);
+      }
+      ResetBufferLocked();
       for (int64_t i = 0; i < buffer_size; i++) {
         int64_t vector_size;
-        TF_RETURN_IF_ERROR(ReadStatusLocked(reader, i, &buffer_[i].status));
+        Status status;
+        TF_RETURN_IF_ERROR(ReadStatusLocked(reader, i, &status));
         TF_RETURN_IF_ERROR(reader->ReadScalar(
             prefix(), strings::StrCat(kBuffer, "[", i, "]", kSizeSuffix),
             &vector_size));
-        buffer_[i].result.resize(vector_size);
+        std::vector<Tensor> element(vector_size);
         for (int64_t j = 0; j < vector_size; j++) {
           TF_RETURN_IF_ERROR(
               reader->ReadTensor(ctx->flr(), prefix(),
                                  strings::StrCat(kBuffer, "[", i, "][", j, "]"),
-                                 &buffer_[i].result[j]));
+                                 &element[j]));
         }
+        AppendLocked(std::move(element), status);
       }
       return OkStatus();
     }
@@ -322,14 +330,43 @@ class WindowDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
-    struct InvocationResult {
-      InvocationResult() = default;
-      InvocationResult(std::vector<Tensor>&& result, const Status& status)
-          : result(result), status(status) {}
+    int64_t BufferSizeLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+      return end_ - begin_;
+    }
+
+    // Appends an element to the buffer. The buffer is append-only so that the
+    // windows produced so far, which refer to earlier elements, stay valid.
+    // When it is full, the buffered elements are copied to a new buffer,
+    // leaving the old one to the windows which still refer to it. The buffer
+    // has room for twice the elements of a window, so each element is copied
+    // at most once.
+    void AppendLocked(std::vector<Tensor>&& element, const Status& status)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!elements_ || end_ == static_cast<int64_t>(elements_->size())) {
+        auto elements =
+            std::make_shared<std::vector<std::vector<Tensor>>>(
+                2 * target_buffer_size_);
+        std::vector<Status> statuses(elements->size());
+        for (int64_t i = begin_; i < end_; ++i) {
+          (*elements)[i - begin_] = (*elements_)[i];
+          statuses[i - begin_] = statuses_[i];
+        }
+        end_ -= begin_;
+        begin_ = 0;
+        elements_ = std::move(elements);
+        statuses_ = std::move(statuses);
+      }
+      (*elements_)[end_] = std::move(element);
+      statuses_[end_] = status;
+      ++end_;
+    }
 
-      std::vector<Tensor> result;
-      Status status;
-    };
+    void ResetBufferLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      elements_.reset();
+      statuses_.clear();
+      begin_ = 0;
+      end_ = 0;
+    }
 
     Status WriteStatusLocked(IteratorStateWriter* writer, size_t index,
                              const Status& status)
@@ -369,12 +406,22 @@ class WindowDatasetOp::Dataset : public DatasetBase {
       return strings::StrCat(kBuffer, "[", index, "]", kErrorMessage);
     }
 
-    size_t TargetBufferSize(int64_t window_size, int64_t window_stride) {
+    static int64_t TargetBufferSize(int64_t window_size,
+                                    int64_t window_stride) {
       return (window_size - 1) * window_stride + 1;
     }
 
+    // Number of buffered elements needed to produce a full window.
+    const int64_t target_buffer_size_;
+
     mutex mu_;
-    std::deque<InvocationResult> buffer_ TF_GUARDED_BY(mu_);
+    // The buffered elements are `(*elements_)[begin_, end_)`, and their
+    // statuses are `statuses_[begin_, end_)`.
+    std::shared_ptr<std::vector<std::vector<Tensor>>> elements_
+        TF_GUARDED_BY(mu_);
+    std::vector<Status> statuses_ TF_GUARDED_BY(mu_);
+    int64_t begin_ TF_GUARDED_BY(mu_) = 0;
+    int64_t end_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
 
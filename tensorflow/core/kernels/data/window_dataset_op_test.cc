@@ -201,7 +201,29 @@ WindowDatasetParams WindowDatasetParams10() {
                              /*node_name=*/kNodeName);
 }
 
-// Test case 11: size=0, shift=2, stride=2, drop_remainder=true.
+// Test case 11: size=3, shift=1, stride=1, drop_remainder=true, over enough
+// elements for the windows to span several buffers.
+WindowDatasetParams WindowDatasetParams11() {
+  return WindowDatasetParams(RangeDatasetParams(0, 10, 1),
+                             /*size=*/3,
+                             /*shift=*/1,
+                             /*stride=*/1,
+                             /*drop_remainder=*/true,
+                             /*output_dtypes=*/{DT_VARIANT},
+                             /*output_shapes=*/{PartialTensorShape({})},
+                             /*node_name=*/kNodeName);
+}
+
+std::vector<std::vector<Tensor>> WindowDatasetParams11Outputs() {
+  std::vector<std::vector<Tensor>> outputs;
+  for (int64_t i = 0; i < 8; ++i) {
+    outputs.push_back(
+        CreateTensors<int64_t>(TensorShape({}), {{i}, {i + 1}, {i + 2}}));
+  }
+  return outputs;
+}
+
+// Test case 12: size=0, shift=2, stride=2, drop_remainder=true.
 WindowDatasetParams WindowDatasetParamsWithInvalidWindowSize() {
   return WindowDatasetParams(RangeDatasetParams(0, 7, 1),
                              /*size=*/0,
@@ -213,7 +235,7 @@ WindowDatasetParams WindowDatasetParamsWithInvalidWindowSize() {
                              /*node_name=*/kNodeName);
 }
 
-// Test case 12: size=2, shift=0, stride=2, drop_remainder=true.
+// Test case 13: size=2, shift=0, stride=2, drop_remainder=true.
 WindowDatasetParams WindowDatasetParamswithInvalidWindowShift() {
   return WindowDatasetParams(RangeDatasetParams(0, 7, 1),
                              /*size=*/2,
@@ -225,7 +247,7 @@ WindowDatasetParams WindowDatasetParamswithInvalidWindowShift() {
                              /*node_name=*/kNodeName);
 }
 
-// Test case 13: size=2, shift=2, stride=0, drop_remainder=true.
+// Test case 14: size=2, shift=2, stride=0, drop_remainder=true.
 WindowDatasetParams WindowDatasetParamsWithInvalidWindowStride() {
   return WindowDatasetParams(RangeDatasetParams(0, 7, 1),
                              /*size=*/2,
@@ -281,7 +303,9 @@ std::vector<GetNextTestCase<WindowDatasetParams>> GetNextTestCases() {
            /*expected_outputs=*/
            {CreateTensors<int64_t>(TensorShape({}), {{0}, {2}, {4}, {6}})}},
           {/*dataset_params=*/WindowDatasetParams10(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/WindowDatasetParams11(),
+           /*expected_outputs=*/WindowDatasetParams11Outputs()}};
 }
 
 class ParameterizedGetNextTest : public WindowDatasetOpTest,
@@ -333,6 +357,45 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_CASE_P(WindowDatasetOpTest, ParameterizedGetNextTest,
                         ::testing::ValuesIn(GetNextTestCases()));
 
+// The windows refer to the buffer of the iterator, so they must stay valid
+// after the iterator has moved past them.
+TEST_F(WindowDatasetOpTest, WindowsOutliveIteration) {
+  auto dataset_params = WindowDatasetParams11();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> windows;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    windows.insert(windows.end(), out_tensors.begin(), out_tensors.end());
+  }
+  iterator_.reset();
+
+  std::vector<std::vector<Tensor>> expected_outputs =
+      WindowDatasetParams11Outputs();
+  ASSERT_EQ(windows.size(), expected_outputs.size());
+  for (int i = 0; i < windows.size(); ++i) {
+    DatasetBase* window_dataset;
+    TF_ASSERT_OK(GetDatasetFromVariantTensor(windows[i], &window_dataset));
+    std::unique_ptr<IteratorBase> window_dataset_iterator;
+    TF_ASSERT_OK(window_dataset->MakeIterator(
+        iterator_ctx_.get(), /*parent=*/nullptr,
+        dataset_params.iterator_prefix(), &window_dataset_iterator));
+    std::vector<Tensor> window_elements;
+    bool end_of_window_dataset = false;
+    while (!end_of_window_dataset) {
+      std::vector<Tensor> next_element;
+      TF_ASSERT_OK(window_dataset_iterator->GetNext(
+          iterator_ctx_.get(), &next_element, &end_of_window_dataset));
+      window_elements.insert(window_elements.end(), next_element.begin(),
+                             next_element.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(window_elements, expected_outputs[i],
+                             /*compare_order=*/true));
+  }
+}
+
 TEST_F(WindowDatasetOpTest, DatasetTypeString) {
   auto dataset_params = WindowDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -379,7 +442,9 @@ DatasetCardinalityTestCases() {
           {/*dataset_params=*/WindowDatasetParams9(),
            /*expected_cardinality=*/1},
           {/*dataset_params=*/WindowDatasetParams10(),
-           /*expected_cardinality=*/0}};
+           /*expected_cardinality=*/0},
+          {/*dataset_params=*/WindowDatasetParams11(),
+           /*expected_cardinality=*/8}};
 }
 
 DATASET_CARDINALITY_TEST_P(WindowDatasetOpTest, WindowDatasetParams,
@@ -0,0 +1,278 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  using InputBuffer = typename TTypes<T>::ConstFlat;
+  using OutputBuffer = typename TTypes<T>::Flat;
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "Fused elementwise op must have at least one op"));
+
+    const auto& unary_fns = UnaryFns();
+    const auto& binary_fns = BinaryFns();
+    for (const string& op_name : fused_ops) {
+      const auto unary_it = unary_fns.find(op_name);
+      const auto binary_it = binary_fns.find(op_name);
+      OP_REQUIRES(
+          context, unary_it != unary_fns.end() || binary_it != binary_fns.end(),
+          errors::InvalidArgument(
+              "Do not have a compute function registered for op: ", op_name));
+      Step step;
+      if (unary_it != unary_fns.end()) {
+        step.unary_fn = unary_it->second.fn;
+        cost_ += unary_it->second.cost;
+      } else {
+        step.binary_fn = binary_it->second.fn;
+        step.arg = num_binary_ops_++;
+        cost_ += binary_it->second.cost;
+      }
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, num_binary_ops_ == num_args,
+                errors::InvalidArgument("Expected ", num_binary_ops_,
+                                        " args for the binary ops, got ",
+                                        num_args));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    std::vector<const T*> args(num_binary_ops_);
+    std::vector<bool> args_are_scalars(num_binary_ops_);
+    bool can_forward_input = true;
+    for (int i = 0; i < num_binary_ops_; ++i) {
+      const Tensor& arg = ctx->input(i + 1);
+      // An arg with one element broadcasts to the input unless it has more
+      // dimensions.
+      const bool is_scalar = arg.NumElements() == 1 && arg.dims() <= in.dims();
+      OP_REQUIRES(ctx, is_scalar || arg.shape() == in.shape(),
+                  errors::InvalidArgument(
+                      "Args of a fused elementwise op must be scalars or have "
+                      "the shape of the input ",
+                      in.shape().DebugString(), ", got ",
+                      arg.shape().DebugString()));
+      args[i] = arg.flat<T>().data();
+      args_are_scalars[i] = is_scalar;
+      // The result overwrites the input block by block, so an arg that is
+      // read after that must not be the input.
+      if (arg.SharesBufferWith(in)) can_forward_input = false;
+    }
+
+    Tensor* out = nullptr;
+    if (can_forward_input) {
+      OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                              {0}, 0, in.shape(), &out));
+    } else {
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, in.shape(), &out));
+    }
+
+    const T* in_data = in.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+    // Applies all the ops to a cache-sized block before moving on to the next
+    // one, so the intermediate results never go to memory.
+    auto compute_fn = [this, in_data, out_data, &args, &args_are_scalars](
+                          int64_t begin, int64_t end) {
+      for (int64_t block = begin; block < end; block += kBlockSize) {
+        const int64_t len = std::min(kBlockSize, end - block);
+        const InputBuffer in_slice(in_data + block, len);
+        const InputBuffer scratch_slice(out_data + block, len);
+        OutputBuffer out_slice(out_data + block, len);
+        for (size_t i = 0; i < steps_.size(); ++i) {
+          const InputBuffer& src = i == 0 ? in_slice : scratch_slice;
+          const Step& step = steps_[i];
+          if (step.unary_fn != nullptr) {
+            step.unary_fn(src, &out_slice);
+          } else if (args_are_scalars[step.arg]) {
+            step.binary_fn(src, args[step.arg], /*is_scalar=*/true,
+                           &out_slice);
+          } else {
+            step.binary_fn(src, args[step.arg] + block, /*is_scalar=*/false,
+                           &out_slice);
+          }
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int num_steps = static_cast<int>(steps_.size());
+    Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/sizeof(T) * (1 + num_binary_ops_),
+        /*bytes_stored=*/sizeof(T), num_steps * 10 + cost_);
+    device.parallelFor(in.NumElements(), cost, AlignBlockSize,
+                       std::move(compute_fn));
+  }
+
+ private:
+  using UnaryFn = void (*)(const InputBuffer&, OutputBuffer*);
+  // Takes the values of the arg, or the value if `is_scalar`.
+  using BinaryFn = void (*)(const InputBuffer&, const T* arg, bool is_scalar,
+                            OutputBuffer*);
+
+  template <typename Fn>
+  struct Registration {
+    Fn fn;
+    int cost;
+  };
+
+  struct Step {
+    UnaryFn unary_fn = nullptr;
+    BinaryFn binary_fn = nullptr;
+    int arg = -1;
+  };
+
+  // 16KB of floats, which leaves room in L1 for the block of an arg.
+  static constexpr int64_t kBlockSize = 4096;
+
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  static constexpr int kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  static inline int64_t AlignBlockSize(int64_t block_size) {
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
+  template <typename Functor>
+  static void ComputeUnary(const InputBuffer& in, OutputBuffer* out) {
+    *out = in.unaryExpr(typename Functor::func());
+  }
+
+  static void ComputeRelu(const InputBuffer& in, OutputBuffer* out) {
+    *out = in.cwiseMax(static_cast<T>(0));
+  }
+
+  static void ComputeRelu6(const InputBuffer& in, OutputBuffer* out) {
+    *out = in.cwiseMax(static_cast<T>(0)).cwiseMin(static_cast<T>(6));
+  }
+
+  template <typename Functor>
+  static void ComputeBinary(const InputBuffer& in, const T* arg,
+                            bool is_scalar, OutputBuffer* out) {
+    if (is_scalar) {
+      *out = in.binaryExpr(in.constant(*arg), typename Functor::func());
+    } else {
+      *out = in.binaryExpr(InputBuffer(arg, in.size()),
+                           typename Functor::func());
+    }
+  }
+
+  template <typename Functor>
+  static Registration<UnaryFn> Unary() {
+    return {ComputeUnary<Functor>,
+            Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  template <typename Functor>
+  static Registration<BinaryFn> Binary() {
+    return {ComputeBinary<Functor>,
+            Eigen::internal::functor_traits<typename Functor::func>::Cost};
+  }
+
+  // WARN: This should be consistent with the remapper.
+  static const std::unordered_map<string, Registration<UnaryFn>>& UnaryFns() {
+    static const auto* fns =
+        new std::unordered_map<string, Registration<UnaryFn>>({
+            {"Abs", Unary<functor::abs<T>>()},
+            {"Ceil", Unary<functor::ceil<T>>()},
+            {"Cos", Unary<functor::cos<T>>()},
+            {"Exp", Unary<functor::exp<T>>()},
+            {"Expm1", Unary<functor::expm1<T>>()},
+            {"Floor", Unary<functor::floor<T>>()},
+            {"Inv", Unary<functor::inverse<T>>()},
+            {"Log", Unary<functor::log<T>>()},
+            {"Log1p", Unary<functor::log1p<T>>()},
+            {"Neg", Unary<functor::neg<T>>()},
+            {"Reciprocal", Unary<functor::inverse<T>>()},
+            {"Round", Unary<functor::round<T>>()},
+            {"Rsqrt", Unary<functor::rsqrt<T>>()},
+            {"Sigmoid", Unary<functor::sigmoid<T>>()},
+            {"Sin", Unary<functor::sin<T>>()},
+            {"Sqrt", Unary<functor::sqrt<T>>()},
+            {"Square", Unary<functor::square<T>>()},
+            {"Tanh", Unary<functor::tanh<T>>()},
+            {"Relu",
+             {ComputeRelu,
+              Eigen::internal::functor_traits<
+                  Eigen::internal::scalar_max_op<T>>::Cost}},
+            {"Relu6",
+             {ComputeRelu6,
+              Eigen::internal::functor_traits<
+                  Eigen::internal::scalar_max_op<T>>::Cost +
+                  Eigen::internal::functor_traits<
+                      Eigen::internal::scalar_min_op<T>>::Cost}},
+        });
+    return *fns;
+  }
+
+  // WARN: This should be consistent with the remapper.
+  static const std::unordered_map<string, Registration<BinaryFn>>&
+  BinaryFns() {
+    static const auto* fns =
+        new std::unordered_map<string, Registration<BinaryFn>>({
+            {"Add", Binary<functor::add<T>>()},
+            {"AddV2", Binary<functor::add<T>>()},
+            {"Div", Binary<functor::div<T>>()},
+            {"Maximum", Binary<functor::maximum<T>>()},
+            {"Minimum", Binary<functor::minimum<T>>()},
+            {"Mul", Binary<functor::mul<T>>()},
+            {"RealDiv", Binary<functor::div<T>>()},
+            {"SquaredDifference", Binary<functor::squared_difference<T>>()},
+            {"Sub", Binary<functor::sub<T>>()},
+        });
+    return *fns;
+  }
+
+  std::vector<Step> steps_;
+  int num_binary_ops_ = 0;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(Eigen::half);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
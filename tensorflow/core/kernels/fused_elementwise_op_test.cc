@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(const std::vector<string>& fused_ops, int num_args) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("T", DT_FLOAT)
+                           .Attr("num_args", num_args)
+                           .Attr("fused_ops", fused_ops)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, UnaryAndBinaryOps) {
+  TF_ASSERT_OK(MakeOp({"Mul", "Sub", "Relu", "Sqrt"}, 2));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {3, 0, 2, -1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // sqrt(relu(x * 2 - y)).
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 2, 2, 3});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, LargerThanABlock) {
+  TF_ASSERT_OK(MakeOp({"Add", "Square"}, 1));
+  const int n = 10000;
+  std::vector<float> x(n), y(n), expected_values(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = i % 7;
+    y[i] = -(i % 5);
+    expected_values[i] = (x[i] + y[i]) * (x[i] + y[i]);
+  }
+  AddInputFromArray<float>(TensorShape({n}), x);
+  AddInputFromArray<float>(TensorShape({n}), y);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({n}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsArgsThatBroadcast) {
+  TF_ASSERT_OK(MakeOp({"Add"}, 1));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsUnknownOps) {
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp({"Pow"}, 1)));
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp({"Add"}, 0)));
+}
+
+}  // namespace
+}  // namespace tensorflow
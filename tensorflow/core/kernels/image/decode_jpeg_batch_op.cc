@@ -0,0 +1,277 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// A rough number of cycles to decode an image, high enough for the images to
+// be decoded by different threads.
+constexpr int64_t kCostPerImage = 1 << 20;
+
+// Returns the largest ratio libjpeg can downscale by during the decoding that
+// keeps a `height` x `width` region at least `target_height` x `target_width`.
+int ChooseRatio(int height, int width, int target_height, int target_width) {
+  for (int ratio = 8; ratio > 1; ratio /= 2) {
+    if (height / ratio >= target_height && width / ratio >= target_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+struct InterpolationWeight {
+  int lower;
+  int upper;
+  float lerp;
+};
+
+// Returns the weights to bilinearly resize a dimension from `in_size` to
+// `out_size` with half pixel centers.
+std::vector<InterpolationWeight> ComputeWeights(int in_size, int out_size) {
+  std::vector<InterpolationWeight> weights(out_size);
+  const float scale = static_cast<float>(in_size) / out_size;
+  for (int i = 0; i < out_size; ++i) {
+    const float in = (i + 0.5f) * scale - 0.5f;
+    const float in_floor = std::floor(in);
+    weights[i].lower = std::max(static_cast<int>(in_floor), 0);
+    weights[i].upper = std::min(static_cast<int>(std::ceil(in)), in_size - 1);
+    weights[i].lerp = in - in_floor;
+  }
+  return weights;
+}
+
+// Resizes the `in_height` x `in_width` image `in` to the `out_height` x
+// `out_width` image `out`, as tf.image.resize does with the bilinear method.
+void ResizeBilinear(const uint8* in, int in_height, int in_width, int channels,
+                    uint8* out, int out_height, int out_width) {
+  const std::vector<InterpolationWeight> ys =
+      ComputeWeights(in_height, out_height);
+  const std::vector<InterpolationWeight> xs =
+      ComputeWeights(in_width, out_width);
+  const int64_t in_row_size = static_cast<int64_t>(in_width) * channels;
+  for (int y = 0; y < out_height; ++y) {
+    const uint8* top = in + ys[y].lower * in_row_size;
+    const uint8* bottom = in + ys[y].upper * in_row_size;
+    for (int x = 0; x < out_width; ++x) {
+      const int left = xs[x].lower * channels;
+      const int right = xs[x].upper * channels;
+      for (int c = 0; c < channels; ++c) {
+        const float top_value =
+            top[left + c] + (top[right + c] - top[left + c]) * xs[x].lerp;
+        const float bottom_value =
+            bottom[left + c] +
+            (bottom[right + c] - bottom[left + c]) * xs[x].lerp;
+        const float value = top_value + (bottom_value - top_value) * ys[y].lerp;
+        *out++ = static_cast<uint8>(value + 0.5f);
+      }
+    }
+  }
+}
+
+// Decodes a batch of JPEG images, each cropped to its window and resized to
+// the same size, into one tensor. The images are decoded in parallel, at the
+// smallest scale libjpeg supports that keeps their window larger than the
+// output size, and only the rows and MCU columns of their window are decoded.
+class DecodeJpegBatchOp : public OpKernel {
+ public:
+  explicit DecodeJpegBatchOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("output_height", &output_height_));
+    OP_REQUIRES_OK(context, context->GetAttr("output_width", &output_width_));
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &flags_.components));
+    OP_REQUIRES(context, flags_.components == 1 || flags_.components == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        flags_.components));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const int64_t batch_size = contents.dim_size(0);
+    const Tensor& crop_windows = context->input(1);
+    OP_REQUIRES(context,
+                crop_windows.dims() == 2 &&
+                    crop_windows.dim_size(0) == batch_size &&
+                    crop_windows.dim_size(1) == 4,
+                errors::InvalidArgument(
+                    "crop_windows must have shape [", batch_size,
+                    ", 4], got ", crop_windows.shape().DebugString()));
+
+    Tensor* images = nullptr;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0,
+            TensorShape({batch_size, output_height_, output_width_,
+                         flags_.components}),
+            &images));
+    if (batch_size == 0) {
+      return;
+    }
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto windows = crop_windows.matrix<int32>();
+    uint8* images_data = images->flat<uint8>().data();
+    const int64_t image_size = static_cast<int64_t>(output_height_) *
+                               output_width_ * flags_.components;
+    mutex mu;
+    Status status;
+    auto decode_range = [&](int64_t start, int64_t limit) {
+      // The images that are resized after the decoding are decoded into this
+      // buffer, which is reused for all the images of the range.
+      std::vector<uint8> buffer;
+      for (int64_t i = start; i < limit; ++i) {
+        Status s = DecodeImage(contents_vec(i), windows(i, 0), windows(i, 1),
+                               windows(i, 2), windows(i, 3),
+                               images_data + i * image_size, &buffer);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          status.Update(errors::CreateWithUpdatedMessage(
+              s, strings::StrCat("Image ", i, ": ", s.message())));
+          return;
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          kCostPerImage, decode_range);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  // Decodes the `crop_height` x `crop_width` window at (`crop_y`, `crop_x`) of
+  // the JPEG image `contents` into the output image `output`, or the whole
+  // image if the window is empty.
+  Status DecodeImage(StringPiece contents, int crop_y, int crop_x,
+                     int crop_height, int crop_width, uint8* output,
+                     std::vector<uint8>* buffer) const {
+    if (contents.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     contents.size());
+    }
+    int height = 0;
+    int width = 0;
+    if (!jpeg::GetImageInfo(contents.data(), contents.size(), &width, &height,
+                            nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ",
+                                     contents.size());
+    }
+    if (crop_height == 0 || crop_width == 0) {
+      crop_y = 0;
+      crop_x = 0;
+      crop_height = height;
+      crop_width = width;
+    } else if (crop_y < 0 || crop_x < 0 || crop_height < 0 || crop_width < 0 ||
+               static_cast<int64_t>(crop_y) + crop_height > height ||
+               static_cast<int64_t>(crop_x) + crop_width > width) {
+      return errors::InvalidArgument(
+          "Crop window [", crop_y, ", ", crop_x, ", ", crop_height, ", ",
+          crop_width, "] is not inside the image of size ", height, "x",
+          width);
+    }
+
+    // The window is scaled along with the image, rounding it outwards.
+    jpeg::UncompressFlags flags = flags_;
+    const int ratio =
+        ChooseRatio(crop_height, crop_width, output_height_, output_width_);
+    flags.ratio = ratio;
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    flags.crop_y = crop_y / ratio;
+    flags.crop_x = crop_x / ratio;
+    flags.crop_height =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width) -
+        flags.crop_x;
+    flags.crop = flags.crop_height < scaled_height ||
+                 flags.crop_width < scaled_width;
+
+    // Images decoded at the output size are decoded in place.
+    const bool decode_to_output = flags.crop_height == output_height_ &&
+                                  flags.crop_width == output_width_;
+    uint8* decoded = jpeg::Uncompress(
+        contents.data(), contents.size(), flags, nullptr,
+        [&](int w, int h, int c) -> uint8* {
+          if (w != flags.crop_width || h != flags.crop_height ||
+              c != flags.components) {
+            return nullptr;
+          }
+          if (decode_to_output) {
+            return output;
+          }
+          buffer->resize(static_cast<int64_t>(w) * h * c);
+          return buffer->data();
+        });
+    if (decoded == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data.");
+    }
+    if (!decode_to_output) {
+      ResizeBilinear(decoded, flags.crop_height, flags.crop_width,
+                     flags.components, output, output_height_, output_width_);
+    }
+    return OkStatus();
+  }
+
+  int32 output_height_;
+  int32 output_width_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeJpegBatch").Device(DEVICE_CPU),
+                        DecodeJpegBatchOp);
+
+}  // namespace
+}  // namespace tensorflow
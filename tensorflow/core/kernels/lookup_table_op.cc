@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <array>
+#include <functional>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -212,8 +215,14 @@ class MutableHashTableOfScalars final : public LookupInterface {
   std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps unordered_maps. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
+//
+// The keys are striped over kNumShards maps with a lock each, so that the
+// Finds and Inserts of many threads only contend when they touch the same
+// shard, and a rehash only stalls the users of its shard. Each call locks
+// every shard it touches once. The operations on the whole table take `mu_`
+// exclusively, the others shared.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
  public:
@@ -228,7 +237,12 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   size_t size() const override {
     tf_shared_lock l(mu_);
-    return table_.size();
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock shard_lock(shard.mu);
+      size += shard.table.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -242,24 +256,32 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
+    const std::vector<std::vector<int64_t>> shard_indices =
+        GroupByShard(key_values);
+
     tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_indices[s].empty()) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock shard_lock(shard.mu);
+      for (int64_t i : shard_indices[s]) {
+        const ValueArray* value_vec = gtl::FindOrNull(
+            shard.table, SubtleMustCopyIfIntegral(key_values(i)));
+        if (value_vec != nullptr) {
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) = value_vec->at(j);
+          }
+        } else {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) =
+                is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+          }
         }
       }
     }
@@ -272,18 +294,33 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
+    const std::vector<std::vector<int64_t>> shard_indices =
+        GroupByShard(key_values);
+    auto insert_shard = [&](int s) {
+      Shard& shard = shards_[s];
+      mutex_lock shard_lock(shard.mu);
+      if (clear) {
+        shard.table.clear();
+      }
+      for (int64_t i : shard_indices[s]) {
+        ValueArray value_vec;
+        for (int64_t j = 0; j < value_dim; j++) {
+          V value = value_values(i, j);
+          value_vec.push_back(value);
+        }
+        gtl::InsertOrUpdate(&shard.table,
+                            SubtleMustCopyIfIntegral(key_values(i)), value_vec);
+      }
+    };
+
     if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
-      for (int64_t j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
+      mutex_lock l(mu_);
+      for (int s = 0; s < kNumShards; ++s) insert_shard(s);
+    } else {
+      tf_shared_lock l(mu_);
+      for (int s = 0; s < kNumShards; ++s) {
+        if (!shard_indices[s].empty()) insert_shard(s);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
     }
     return OkStatus();
   }
@@ -296,9 +333,16 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    const std::vector<std::vector<int64_t>> shard_indices =
+        GroupByShard(key_values);
+    tf_shared_lock l(mu_);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_indices[s].empty()) continue;
+      Shard& shard = shards_[s];
+      mutex_lock shard_lock(shard.mu);
+      for (int64_t i : shard_indices[s]) {
+        shard.table.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
     }
     return OkStatus();
   }
@@ -309,8 +353,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    mutex_lock l(mu_);
+    int64_t size = SizeLocked();
     int64_t value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -334,20 +378,23 @@ class MutableHashTableOfTensors final : public LookupInterface {
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
     tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock shard_lock(shard.mu);
+      for (unsigned i = 0; i < shard.table.bucket_count(); ++i) {
+        size_t bucket_size = shard.table.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
       }
     }
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    mutex_lock l(mu_);
+    int64_t size = SizeLocked();
     Tensor keys(key_dtype(), TensorShape({size}));
     Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
     ExportKeysAndValues(&keys, &values);
@@ -384,28 +431,66 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
+  static constexpr int kNumShards = 16;
+
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
+  struct Shard {
+    mutable mutex mu;
+    std::unordered_map<K, ValueArray> table TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard of `key`, from the top bits of its mixed hash so that
+  // the shards do not repeat the low bits the maps bucket by.
+  static int ShardOf(const K& key) {
+    const uint64 hash = std::hash<K>()(key) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>(hash >> 60);
+  }
+
+  // Returns the positions of `key_values` in each shard.
+  static std::vector<std::vector<int64_t>> GroupByShard(
+      const typename TTypes<K>::ConstFlat& key_values) {
+    std::vector<std::vector<int64_t>> shard_indices(kNumShards);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      shard_indices[ShardOf(SubtleMustCopyIfIntegral(key_values(i)))]
+          .push_back(i);
+    }
+    return shard_indices;
+  }
+
+  int64_t SizeLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    int64_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock shard_lock(shard.mu);
+      size += shard.table.size();
+    }
+    return size;
+  }
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
+  // must point to tensors of size `SizeLocked()`.
   void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Shard& shard : shards_) {
+      tf_shared_lock shard_lock(shard.mu);
+      for (auto it = shard.table.begin(); it != shard.table.end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
   mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  std::array<Shard, kNumShards> shards_;
 };
 
 namespace {
@@ -56,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/matmul_util.h"
 #include "tensorflow/core/kernels/numeric_options_utils.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/util/autotune_maps/matmul_autotune_maps.h"
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #if GOOGLE_CUDA
 #include "third_party/gpus/cuda/include/cuda.h"
@@ -473,22 +474,6 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
   }
 };
 
-#if GOOGLE_CUDA || TF_HIPBLASLT
-
-namespace {
-// A dummy type to group matmul autotune results together.
-struct BlasLtMatmulAutoTuneGroup {
-  static string name() { return "MatmulLt"; }
-};
-
-typedef AutotuneSingleton<BlasLtMatmulAutoTuneGroup, BlasLtMatmulPlanParams,
-                          se::blas::AlgorithmConfig,
-                          absl::Hash<BlasLtMatmulPlanParams>>
-    AutoTuneBatchMatmul;
-
-}  // namespace
-
-#endif  // GOOGLE_CUDA
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 class BlasScratchAllocator : public se::ScratchAllocator {
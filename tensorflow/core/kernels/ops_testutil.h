@@ -23,6 +23,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -159,6 +161,9 @@ class OpsTestBase : public ::testing::Test {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Sets the deadline of the next runs of the kernel.
+  void set_deadline(absl::Time deadline) { deadline_ = deadline; }
+
  protected:
   void CreateContext();
   Tensor* AddInput(DataType dtype, const TensorShape& shape);
@@ -201,6 +206,7 @@ class OpsTestBase : public ::testing::Test {
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   SessionMetadata session_metadata_;
+  absl::optional<absl::Time> deadline_;
 
  private:
   OpsTestBase(const OpsTestBase&) = delete;
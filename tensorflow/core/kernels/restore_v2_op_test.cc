@@ -26,14 +26,19 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -356,5 +361,129 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+// Restores like RestoreV2, with the RestoreTensorsV2Options in the attrs.
+REGISTER_OP("RestoreV2WithOptions")
+    .Input("prefix: string")
+    .Input("tensor_names: string")
+    .Input("shape_and_slices: string")
+    .Output("tensors: dtypes")
+    .Attr("dtypes: list(type)")
+    .Attr("batch_bytes: int")
+    .Attr("num_readers: int")
+    .SetIsStateful();
+
+class RestoreV2WithOptionsOp : public OpKernel {
+ public:
+  explicit RestoreV2WithOptionsOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("batch_bytes", &options_.batch_bytes));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("num_readers", &options_.num_readers));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, context->input(0),
+                                    context->input(1), context->input(2),
+                                    dtypes_, options_));
+  }
+
+ private:
+  DataTypeVector dtypes_;
+  RestoreTensorsV2Options options_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("RestoreV2WithOptions").Device(DEVICE_CPU),
+                        RestoreV2WithOptionsOp);
+
+class RestoreV2BatchesTest : public OpsTestBase {
+ protected:
+  static constexpr int kNumTensors = 12;
+
+  // Writes kNumTensors float tensors of different sizes to a bundle, and adds
+  // the inputs to restore all of them, the last one as a slice.
+  void WriteBundle() {
+    const string prefix =
+        io::JoinPath(testing::TmpDir(), "restore_v2_batches");
+    BundleWriter writer(Env::Default(), prefix);
+    std::vector<string> tensor_names;
+    for (int i = 0; i < kNumTensors; ++i) {
+      tensor_names.push_back(strings::StrCat("tensor_", i));
+      TF_ASSERT_OK(writer.Add(
+          tensor_names.back(),
+          MakeInput<float>(TensorShape({4, 10 * (i + 1)}),
+                           [i](int x) -> float { return i * 1000 + x; })));
+    }
+    TF_ASSERT_OK(writer.Finish());
+
+    AddInput<tstring>(TensorShape({}),
+                      [&](int x) -> tstring { return prefix; });
+    AddInput<tstring>(TensorShape({kNumTensors}), [&](int x) -> tstring {
+      return tensor_names[x];
+    });
+    AddInput<tstring>(TensorShape({kNumTensors}), [](int x) -> tstring {
+      return x == kNumTensors - 1 ? "4 120 1,2:-" : "";
+    });
+  }
+
+  Status RunRestore(int64_t batch_bytes, int num_readers,
+                    std::vector<Tensor>* outputs) {
+    const DataTypeVector dtypes(kNumTensors, DT_FLOAT);
+    TF_RETURN_IF_ERROR(NodeDefBuilder("myop", "RestoreV2WithOptions")
+                           .Input(FakeInput())
+                           .Input(FakeInput())
+                           .Input(FakeInput())
+                           .Attr("dtypes", dtypes)
+                           .Attr("batch_bytes", batch_bytes)
+                           .Attr("num_readers", num_readers)
+                           .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    outputs->clear();
+    for (int i = 0; i < kNumTensors; ++i) {
+      outputs->push_back(*GetOutput(i));
+    }
+    return OkStatus();
+  }
+};
+
+TEST_F(RestoreV2BatchesTest, MultipleBatchesMatchSerialRestore) {
+  WriteBundle();
+  // All the tensors fit in one batch, which is restored on the op thread.
+  std::vector<Tensor> serial_outputs;
+  TF_ASSERT_OK(RunRestore(/*batch_bytes=*/1 << 20, /*num_readers=*/8,
+                          &serial_outputs));
+  ASSERT_EQ(serial_outputs.size(), kNumTensors);
+  for (int i = 0; i < kNumTensors - 1; ++i) {
+    test::ExpectTensorEqual<float>(
+        serial_outputs[i],
+        MakeInput<float>(TensorShape({4, 10 * (i + 1)}),
+                         [i](int x) -> float { return i * 1000 + x; }));
+  }
+  test::ExpectTensorEqual<float>(
+      serial_outputs[kNumTensors - 1],
+      MakeInput<float>(TensorShape({2, 120}), [](int x) -> float {
+        return (kNumTensors - 1) * 1000 + 120 + x;
+      }));
+
+  // One batch per tensor, restored by fewer readers than batches.
+  std::vector<Tensor> batched_outputs;
+  TF_ASSERT_OK(RunRestore(/*batch_bytes=*/1, /*num_readers=*/3,
+                          &batched_outputs));
+  ASSERT_EQ(batched_outputs.size(), kNumTensors);
+  for (int i = 0; i < kNumTensors; ++i) {
+    test::ExpectTensorEqual<float>(batched_outputs[i], serial_outputs[i]);
+  }
+}
+
+TEST_F(RestoreV2BatchesTest, RejectsNoReaders) {
+  WriteBundle();
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      RunRestore(/*batch_bytes=*/1, /*num_readers=*/0, &outputs)));
+}
+
 }  // namespace
 }  // namespace tensorflow
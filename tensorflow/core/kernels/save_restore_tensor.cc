@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -31,8 +35,12 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -250,6 +258,37 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// The other tensors are restored in batches of consecutive tensors, see
+// RestoreTensorsV2Options. If there is more than one batch, the batches are
+// restored from the thread-pool, so that the reads of different shards and
+// parts of the shards overlap.
+
+// Returns the value of the boolean environment variable "name", or false if it
+// is not set or invalid.
+bool ReadBoolFlag(const char* name) {
+  bool value = false;
+  Status status = ReadBoolFromEnvVar(name, false, &value);
+  if (!status.ok()) {
+    LOG(WARNING) << status;
+  }
+  return value;
+}
+
+// Whether SaveTensorsV2() aligns the tensors so that they can be memory mapped.
+bool SaveMemmappable() {
+  static const bool memmappable = ReadBoolFlag("TF_SAVE_V2_MEMMAPPABLE");
+  return memmappable;
+}
+
+// Whether RestoreTensorsV2() memory maps the full tensors it can, instead of
+// reading them. The restored tensors are read-only and keep the data files
+// mapped, so this is meant for serving models from files that are not
+// modified in place, e.g. on a local disk.
+bool RestoreMemmapped() {
+  static const bool memmapped = ReadBoolFlag("TF_RESTORE_V2_MEMMAP");
+  return memmapped;
+}
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -282,6 +321,23 @@ struct RestoreOp {
     return restored_full_shape.num_elements() > kLargeShapeThreshold;
   }
 
+  // Returns an estimate of the number of bytes of the tensor in the bundle, or
+  // 0 if it is unknown. Variable-sized elements, e.g. strings, are counted as
+  // one byte each.
+  int64_t bundle_bytes(BundleReader* reader) const {
+    DataType restored_dtype;
+    TensorShape restored_full_shape;
+    // Ignore status here; we'll catch the error later.
+    if (!reader
+             ->LookupDtypeAndShape(tensor_name, &restored_dtype,
+                                   &restored_full_shape)
+             .ok()) {
+      return 0;
+    }
+    return restored_full_shape.num_elements() *
+           std::max(DataTypeSize(restored_dtype), 1);
+  }
+
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader() {
     BundleReader reader(Env::Default(), reader_prefix);
@@ -301,7 +357,10 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && RestoreMemmapped() &&
+        MaybeMapOutput(reader)) {
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -349,6 +408,19 @@ struct RestoreOp {
     return OkStatus();
   }
 
+  // Sets the output to the memory mapped tensor, and returns whether it could
+  // be mapped.
+  bool MaybeMapOutput(BundleReader* reader) {
+    Tensor mapped;
+    Status status = reader->LookupMapped(tensor_name, &mapped);
+    if (!status.ok()) {
+      VLOG(1) << "Reading tensor " << tensor_name << ": " << status;
+      return false;
+    }
+    context->set_output(idx, mapped);
+    return true;
+  }
+
   OpKernelContext* context;
   int idx;
   string tensor_name;
@@ -364,7 +436,13 @@ struct RestoreOp {
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes,
+                        const RestoreTensorsV2Options& options) {
+  if (options.batch_bytes <= 0 || options.num_readers <= 0) {
+    return errors::InvalidArgument(
+        "The restore batch size and number of readers must be positive, got ",
+        options.batch_bytes, " and ", options.num_readers);
+  }
   const string& prefix_string = prefix.scalar<tstring>()();
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
@@ -412,21 +490,58 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   }
 
+  // The restore ops are sorted by file offset, so each batch reads a mostly
+  // contiguous range of a shard.
+  std::vector<std::vector<RestoreOp*>> batches;
+  int64_t batch_bytes = 0;
+  for (RestoreOp* op : direct_restore_ops) {
+    if (batches.empty() || batch_bytes >= options.batch_bytes) {
+      batches.emplace_back();
+      batch_bytes = 0;
+    }
+    batches.back().push_back(op);
+    batch_bytes += op->bundle_bytes(&default_reader);
+  }
+
+  std::vector<Status> batch_reader_statuses;
   {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+    if (!pool_restore_ops.empty() || batches.size() > 1) {
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", options.num_readers));
       for (auto* op : pool_restore_ops) {
         reader_pool->Schedule([op]() { op->run_with_new_reader(); });
       }
     }
 
-    // Read small tensors from the op thread
-    for (auto* op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    if (batches.size() > 1) {
+      // Each reader restores the next batch that no other reader took yet.
+      // The batch_reader_statuses are only written before the pool shuts down.
+      auto next_batch = std::make_shared<std::atomic<size_t>>(0);
+      const int num_batch_readers =
+          std::min<int>(batches.size(), options.num_readers);
+      batch_reader_statuses.resize(num_batch_readers);
+      for (int i = 0; i < num_batch_readers; ++i) {
+        reader_pool->Schedule([&batches, &batch_reader_statuses, &prefix_string,
+                               next_batch, i]() {
+          BundleReader reader(Env::Default(), prefix_string);
+          if (!reader.status().ok()) {
+            batch_reader_statuses[i] = reader.status();
+            return;
+          }
+          for (size_t b = (*next_batch)++; b < batches.size();
+               b = (*next_batch)++) {
+            for (RestoreOp* op : batches[b]) op->status = op->run(&reader);
+          }
+        });
+      }
+    } else {
+      // Read small tensors from the op thread
+      for (auto* op : direct_restore_ops) {
+        TF_RETURN_IF_ERROR(op->run(&default_reader));
+      }
     }
   }
 
@@ -434,6 +549,14 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto* op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (const Status& status : batch_reader_statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  if (batches.size() > 1) {
+    for (auto* op : direct_restore_ops) {
+      TF_RETURN_IF_ERROR(op->status);
+    }
+  }
 
   for (const RestoreOp& restore_op : restore_ops) {
     if (restore_op.dtype != context->mutable_output(restore_op.idx)->dtype()) {
@@ -447,4 +570,128 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   return OkStatus();
 }
 
+namespace {
+
+// The bundles being written by SaveTensorsV2Async(), by prefix.
+class PendingSavesV2 {
+ public:
+  static PendingSavesV2* Global() {
+    static PendingSavesV2* pending_saves = new PendingSavesV2;
+    return pending_saves;
+  }
+
+  void Start(const string& prefix) {
+    mutex_lock l(mu_);
+    // Two saves to the same prefix would write the same files.
+    while (prefixes_.count(prefix) > 0) cv_.wait(l);
+    prefixes_.insert(prefix);
+  }
+
+  void Finish(const string& prefix, const Status& status) {
+    mutex_lock l(mu_);
+    prefixes_.erase(prefix);
+    if (!status.ok()) errors_[prefix].Update(status);
+    cv_.notify_all();
+  }
+
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    while (prefixes_.count(prefix) > 0) cv_.wait(l);
+    auto it = errors_.find(prefix);
+    if (it == errors_.end()) return OkStatus();
+    Status status = it->second;
+    errors_.erase(it);
+    return status;
+  }
+
+ private:
+  mutex mu_;
+  condition_variable cv_;
+  std::unordered_set<string> prefixes_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, Status> errors_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+Status SaveTensorsV2(const string& prefix,
+                     gtl::ArraySlice<tstring> tensor_names,
+                     gtl::ArraySlice<tstring> shape_and_slices,
+                     gtl::ArraySlice<Tensor> tensors) {
+  BundleWriter::Options options;
+  if (SaveMemmappable()) {
+    options.data_alignment = kMemmappableDataAlignment;
+  }
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (int i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names[i];
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return OkStatus();
+}
+
+void SaveTensorsV2Async(const string& prefix, const Tensor& tensor_names,
+                        const Tensor& shape_and_slices,
+                        std::vector<Tensor> tensors) {
+  PendingSavesV2::Global()->Start(prefix);
+  Env::Default()->SchedClosure([prefix, tensor_names, shape_and_slices,
+                                tensors = std::move(tensors)]() {
+    Status status = SaveTensorsV2(
+        prefix, gtl::ArraySlice<tstring>(tensor_names.flat<tstring>()),
+        gtl::ArraySlice<tstring>(shape_and_slices.flat<tstring>()), tensors);
+    if (!status.ok()) {
+      LOG(ERROR) << "Asynchronous save to " << prefix << " failed: " << status;
+    }
+    PendingSavesV2::Global()->Finish(prefix, status);
+  });
+}
+
+Status WaitForSavesV2(const string& prefix) {
+  return PendingSavesV2::Global()->Wait(prefix);
+}
+
 }  // namespace tensorflow
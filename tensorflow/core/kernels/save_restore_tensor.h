@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -55,6 +58,17 @@ void RestoreTensor(OpKernelContext* context,
 
 // V2 checkpoint format.
 
+// Options for RestoreTensorsV2().
+struct RestoreTensorsV2Options {
+  // The tensors that are not large enough to be restored on their own are
+  // restored in batches of consecutive tensors of about this many bytes.
+  int64_t batch_bytes = 64 << 20;  // 64MB
+
+  // If there is more than one batch, the batches and the large tensors are
+  // restored concurrently by this many readers.
+  int num_readers = 8;
+};
+
 // Invokes the V2 checkpoint read path to read tensors.
 //
 // "context" is only used for allocating outputs.  In particular, the inputs are
@@ -66,7 +80,30 @@ void RestoreTensor(OpKernelContext* context,
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes,
+                        const RestoreTensorsV2Options& options = {});
+
+// Writes "tensors" under "tensor_names" to the bundle at "prefix". A non-empty
+// element of "shape_and_slices" saves the corresponding tensor as a slice of a
+// larger tensor.
+Status SaveTensorsV2(const string& prefix,
+                     gtl::ArraySlice<tstring> tensor_names,
+                     gtl::ArraySlice<tstring> shape_and_slices,
+                     gtl::ArraySlice<Tensor> tensors);
+
+// Like SaveTensorsV2(), but writes the bundle on a background thread and
+// returns right away. "tensor_names" and "shape_and_slices" are string vectors
+// and "tensors" must not be modified until the save is done, e.g. they are
+// snapshots of the tensors to save.
+//
+// Blocks until the previous asynchronous save to "prefix" is done.
+void SaveTensorsV2Async(const string& prefix, const Tensor& tensor_names,
+                        const Tensor& shape_and_slices,
+                        std::vector<Tensor> tensors);
+
+// Blocks until the asynchronous saves to "prefix" are done, and returns the
+// errors of those that failed since the last call.
+Status WaitForSavesV2(const string& prefix);
 
 }  // namespace tensorflow
 
@@ -18,12 +18,14 @@ limitations under the License.
 #include <cstddef>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
@@ -33,7 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"  // IWYU pragma: keep
 #include "tensorflow/core/platform/types.h"
-#include "tensorflow/core/util/saved_tensor_slice_util.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -95,7 +97,13 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    // With TF_ASYNC_SAVE_V2=1, the op is done once it has copied its inputs,
+    // and the bundle is written in the background. RestoreV2 and
+    // MergeV2Checkpoints wait for the writes of their prefixes.
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_ASYNC_SAVE_V2", false, &async_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -108,60 +116,28 @@ class SaveV2 : public OpKernel {
     const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
     const int num_tensors = static_cast<int>(tensor_names.NumElements());
     const string& prefix_string = prefix.scalar<tstring>()();
-    const auto& tensor_names_flat = tensor_names.flat<tstring>();
-    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
-
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+    const gtl::ArraySlice<tstring> tensor_names_flat(
+        tensor_names.flat<tstring>());
+    const gtl::ArraySlice<tstring> shape_and_slices_flat(
+        shape_and_slices.flat<tstring>());
 
+    std::vector<Tensor> tensors;
+    tensors.reserve(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
+      tensors.push_back(context->input(i + kFixedInputs));
+    }
+    if (async_) {
+      // Variables may be updated in place once the op is done, so the bundle
+      // is written from copies of the tensors.
+      for (Tensor& tensor : tensors) {
+        tensor = tensor::DeepCopy(tensor);
       }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      SaveTensorsV2Async(prefix_string, tensor_names, shape_and_slices,
+                         std::move(tensors));
+    } else {
+      OP_REQUIRES_OK(context, SaveTensorsV2(prefix_string, tensor_names_flat,
+                                            shape_and_slices_flat, tensors));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -182,6 +158,10 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  // Whether to write the bundle in the background.
+  bool async_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -205,6 +185,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, WaitForSavesV2(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -285,6 +266,9 @@ class MergeV2Checkpoints : public OpKernel {
 
     const gtl::ArraySlice<tstring> input_prefixes =
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, WaitForSavesV2(input_prefix));
+    }
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
     OP_REQUIRES_OK(context,
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -340,5 +341,65 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    setenv("TF_ASYNC_SAVE_V2", "1", 1 /* overwrite */);
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                     .Input(FakeInput())            // prefix
+                     .Input(FakeInput())            // tensor_names
+                     .Input(FakeInput())            // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT}))  // tensors
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    unsetenv("TF_ASYNC_SAVE_V2");
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, SavesSnapshotOfInputs) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  MakeOp();
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_float"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({2, 4}),
+                  [](int x) -> float { return static_cast<float>(x) / 10; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Updates of the input once the op is done are not saved.
+  Tensor input = GetInput(3);
+  input.flat<float>().setZero();
+  TF_ASSERT_OK(WaitForSavesV2(prefix));
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(static_cast<float>(i) / 10, val.flat<float>()(i));
+  }
+}
+
+TEST_F(AsyncSaveV2OpTest, ReportsErrorsOnWait) {
+  // The parent of the prefix is a file, so the bundle cannot be written.
+  const string file = io::JoinPath(testing::TmpDir(), "async_not_a_dir");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, ""));
+  const string prefix = io::JoinPath(file, "tensor_async");
+  MakeOp();
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_float"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({2}), [](int x) -> float { return x; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_FALSE(WaitForSavesV2(prefix).ok());
+  // The error is only returned once.
+  TF_EXPECT_OK(WaitForSavesV2(prefix));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
 
 #include "tensorflow/core/framework/op_requires.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include "absl/base/prefetch.h"
 #include "absl/container/flat_hash_map.h"
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -126,81 +128,117 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
-    Index start = 0, end = 1;
+    // Validate the segment ids up front, so that the segments can be reduced
+    // in parallel.
+    const Index* segment_ids_data = segment_vec.data();
+    Index out_index = internal::SubtleMustCopy(segment_vec(0));
+    OP_REQUIRES(
+        context, FastBoundsCheck(out_index, output_rows),
+        errors::InvalidArgument(
+            "Segment id ", out_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted."));
+    for (int64_t i = 1; i < num_indices; ++i) {
+      const Index next_index = internal::SubtleMustCopy(segment_vec(i));
+      OP_REQUIRES(context, out_index <= next_index,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      out_index = next_index;
+    }
 
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
+    // The input rows are split into blocks of about kElementsPerBlock
+    // elements, each extended to the end of its last segment, so that the
+    // work is balanced however large the segments are.
+    constexpr int64_t kElementsPerBlock = 1 << 14;
+    const int64_t rows_per_block =
+        std::max<int64_t>(1, kElementsPerBlock / std::max<int64_t>(num_col, 1));
+    const int64_t num_blocks =
+        (num_indices + rows_per_block - 1) / rows_per_block;
+    // Returns the first row of the first segment that starts in `block`.
+    auto block_start = [&](int64_t block) -> int64_t {
+      const int64_t row = std::min(block * rows_per_block, num_indices);
+      if (row == 0 || row == num_indices) return row;
+      return std::upper_bound(segment_ids_data + row,
+                              segment_ids_data + num_indices,
+                              segment_ids_data[row - 1]) -
+             segment_ids_data;
+    };
 
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
-    Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
+    auto reduce_blocks = [&](int64_t begin_block, int64_t end_block) {
+      Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
+      Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
+      const int64_t begin = block_start(begin_block);
+      const int64_t end = block_start(end_block);
+      // Index from which the output is not set.
+      Index uninitialized_index =
+          begin > 0 ? internal::SubtleMustCopy(segment_ids_data[begin - 1]) + 1
+                    : 0;
+      int64_t start = begin;
+      while (start < end) {
+        const Index out_index =
+            internal::SubtleMustCopy(segment_ids_data[start]);
+        int64_t segment_end = start + 1;
+        while (segment_end < end &&
+               internal::SubtleMustCopy(segment_ids_data[segment_end]) ==
+                   out_index) {
+          ++segment_end;
+        }
+        // The ids were validated above, so this only skips segments whose ids
+        // were changed since.
+        if (!FastBoundsCheck(out_index, output_rows) ||
+            out_index < uninitialized_index) {
+          start = segment_end;
           continue;
         }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(T(default_value));
-      }
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(T(default_value));
+        }
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
+        // Process segment [start, segment_end)
+        const T* in_slice_ptr = &input_flat(start, 0);
+        typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
                                  Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
-        out_slice = in_slice;
-      } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
-                                                           num_col);
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
-
-        out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+            OutT;
+        T* out_slice_ptr = &output_flat(out_index, 0);
+        OutT out_slice(out_slice_ptr, out_slice_shape);
+        // We don't use out_slice.device(context->eigen_device<Device>)
+        // because these pieces of work are likely to be very small and
+        // the context switching overhead dwarfs any benefit we get from
+        // using another thread to do this work.
+        if (start == segment_end - 1) {
+          typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
+                                   Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, out_slice_shape);
+          out_slice = in_slice;
+        } else {
+          Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(
+              segment_end - start, num_col);
+          typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+                                   Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, in_slice_shape);
+
+          out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+        }
+        uninitialized_index = out_index + 1;
+        start = segment_end;
       }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-    }
+    };
+    const int64_t block_elements = rows_per_block * num_col;
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/block_elements * sizeof(T),
+        /*bytes_stored=*/num_col * sizeof(T),
+        /*compute_cycles=*/block_elements *
+            Eigen::TensorOpCost::AddCost<T>());
+    context->eigen_cpu_device().parallelFor(num_blocks, cost,
+                                            std::move(reduce_blocks));
   }
 };
 
@@ -390,8 +428,9 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // Nothing to reduce. All output values equal to `InitialValueF()`.
     if (num_reductions == 0) return;
 
-    // Parallelize by `num_segments`. It's simple, efficient and safe
-    // (no data dependency):
+    // Sort the input rows by segment with a counting sort, which keeps the
+    // rows of each segment in order, so that each segment is reduced by one
+    // worker from the rows of that segment only:
     //
     //   input   segment_ids                 num_segments  operation
     //   | a0 |  | 0 |            worker 1:  |0|           f(a0, a1)
@@ -399,27 +438,57 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // N | c0 |  | 2 |       -->  worker 3:  |2|           f(c0)
     //   | b1 |  | 1 |
     //   | a1 |  | 0 |
-    //
-    // TODO(intel-tf): Balance workload in `row_counter` to make parallelism
-    //                 more efficient.
-    auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data.template chip<0>(i), output.template chip<0>(j));
+    std::vector<int64_t> segment_offsets(num_segments + 1, 0);
+    for (int64_t j = 0; j < num_segments; ++j) {
+      segment_offsets[j + 1] = segment_offsets[j] + row_counter[j];
+    }
+    // `segment_ends[j]` ends the rows of segment `j` in `sorted_rows`. It
+    // only differs from `segment_offsets[j + 1]` if the segment ids were
+    // changed since they were counted.
+    std::vector<int64_t> segment_ends(segment_offsets.begin(),
+                                      segment_offsets.end() - 1);
+    std::vector<Index> sorted_rows(num_real_segment);
+    for (int64_t i = 0; i < N; ++i) {
+      Index j = internal::SubtleMustCopy(segment_ids(i));
+      if (FastBoundsCheck(j, num_segments) &&
+          segment_ends[j] < segment_offsets[j + 1]) {
+        sorted_rows[segment_ends[j]++] = i;
+      }
+    }
+
+    // The segments are split into blocks of about kElementsPerBlock input
+    // elements, so that the work is balanced even if the sizes of the
+    // segments are skewed.
+    constexpr int64_t kElementsPerBlock = 1 << 14;
+    const int64_t rows_per_block = std::max<int64_t>(
+        1, kElementsPerBlock / std::max<int64_t>(inner_dim, 1));
+    const int64_t num_blocks =
+        (num_real_segment + rows_per_block - 1) / rows_per_block;
+    // Returns the first segment whose rows start in `block`.
+    auto block_start = [&](int64_t block) -> int64_t {
+      if (block >= num_blocks) return num_segments;
+      return std::lower_bound(segment_offsets.begin(),
+                              segment_offsets.end() - 1,
+                              block * rows_per_block) -
+             segment_offsets.begin();
+    };
+    auto reductionWorker = [&](int64_t begin_block, int64_t end_block) {
+      const int64_t end = block_start(end_block);
+      for (int64_t j = block_start(begin_block); j < end; ++j) {
+        for (int64_t k = segment_offsets[j]; k < segment_ends[j]; ++k) {
+          reduction(data.template chip<0>(sorted_rows[k]),
+                    output.template chip<0>(j));
         }
       }
     };
 
     // Reduction functors includes Sum, Max, Min, etc. Simply consider it
     // will cost 5 cycles per operation.
-    const int64_t kAverTaskSize = num_real_segment / num_segments;
-    const int64_t compute_cycles = 5 * inner_dim * kAverTaskSize;
-    const int64_t input_bytes = sizeof(T) * inner_dim * kAverTaskSize;
-    const int64_t output_bytes = sizeof(T) * inner_dim * kAverTaskSize;
+    const int64_t compute_cycles = 5 * inner_dim * rows_per_block;
+    const int64_t input_bytes = sizeof(T) * inner_dim * rows_per_block;
+    const int64_t output_bytes = sizeof(T) * inner_dim * rows_per_block;
     const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
-    cpu_device.parallelFor(num_segments, cost, reductionWorker);
+    cpu_device.parallelFor(num_blocks, cost, reductionWorker);
   }
 };
 
@@ -634,6 +703,10 @@ class SparseSegmentReductionOpBase : public OpKernel {
         gap_slice.setConstant(default_value_);
       }
 
+      // Fetches the first rows of the next segments while this one is reduced.
+      PrefetchRows<T, Index>(input_flat, indices_vec, end,
+                             std::min(end + kPrefetchRows, num_indices));
+
       auto out = output_flat.template chip<0>(out_index);
       auto temp = temp_flat.template chip<0>(out_index);
       const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
@@ -662,6 +735,31 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // The number of rows of `input` gathered ahead of their reduction.
+  static constexpr int64_t kPrefetchRows = 8;
+
+  // Prefetches the rows of `input_flat` at the indices in [begin, end) into the
+  // cache, since their addresses are not predictable by the hardware. Out of
+  // range indices are skipped and reported by Reduce().
+  template <typename Tin, typename Tindex>
+  EIGEN_ALWAYS_INLINE void PrefetchRows(
+      const typename TTypes<Tin>::ConstMatrix& input_flat,
+      const typename TTypes<Tindex>::ConstVec& indices_vec, int64_t begin,
+      int64_t end) {
+    constexpr int64_t kCacheLineBytes = 64;
+    const int64_t row_bytes = input_flat.dimension(1) * sizeof(Tin);
+    if (row_bytes == 0) return;
+    for (int64_t i = begin; i < end; ++i) {
+      const Tindex index = indices_vec(i);
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const char* row = reinterpret_cast<const char*>(input_flat.data()) +
+                        static_cast<int64_t>(index) * row_bytes;
+      for (int64_t offset = 0; offset < row_bytes; offset += kCacheLineBytes) {
+        absl::PrefetchToLocalCache(row + offset);
+      }
+    }
+  }
+
   const DataType dtidx_;
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
@@ -823,6 +921,8 @@ class SparseSegmentReductionOpBase : public OpKernel {
         }
       }
       for (; r < num; r += 8) {
+        PrefetchRows<Tin, Tindex>(input_flat, indices_vec, start + r + 8,
+                                  start + std::min(r + 16, num));
         INDEX(0, r);
         INDEX(1, r + 1);
         INDEX(2, r + 2);
@@ -290,4 +290,40 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+// Looks up and sums `num_indices` scattered rows of a large embedding table,
+// 8 per segment.
+static void BM_SparseSegmentSumLookup(::testing::benchmark::State& state) {
+  const int num_indices = state.range(0);
+  const int dim = state.range(1);
+  constexpr int kNumRows = 1 << 20;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, dim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  for (int i = 0; i < num_indices; ++i) {
+    indices.flat<int32>()(i) = (i * 1000003LL) % kNumRows;
+    segments.flat<int32>()(i) = i / 8;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * dim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSumLookup)
+    ->UseRealTime()
+    ->ArgPair(100000, 16)
+    ->ArgPair(100000, 64)
+    ->ArgPair(100000, 256);
+
 }  // namespace tensorflow
@@ -19,6 +19,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -264,10 +267,6 @@ Status SparseTensorDenseMatMulImpl(
   const int lhs_index_a = ADJ_A ? 1 : 0;
   const int rhs_index_a = ADJ_A ? 0 : 1;
 
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
-
   if (rhs_right < kNumVectorize) {
     // Disable vectorization if the RHS of output is too small
     auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
@@ -321,6 +320,115 @@ Status SparseTensorDenseMatMulImpl(
   }
   return OkStatus();
 }
+
+// Multiplies the rows of the output in parallel. The nonzeros of `a` are
+// first sorted by output row with a stable counting sort, into a CSR matrix,
+// so that every output element sums the same products in the same order as
+// SparseTensorDenseMatMulImpl.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulByRows(
+    const CPUDevice& d, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const std::size_t nnz = a_values.size();
+  const int64_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int64_t out_rows = out.dimension(0);
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+
+  // The nonzeros of output row `m` are at [row_offsets[m], row_offsets[m + 1])
+  // of `columns` and `values`.
+  std::vector<int64_t> row_offsets(out_rows + 1, 0);
+  std::vector<Tindices> ms(nnz);
+  std::vector<Tindices> ks(nnz);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    ms[i] = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    ks[i] = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(ks[i], lhs_right)) {
+      return KOutOfBoundsError(ks[i], i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(ms[i], out_rows)) {
+      return MOutOfBoundsError(ms[i], i, lhs_index_a, out_rows);
+    }
+    ++row_offsets[ms[i] + 1];
+  }
+  for (int64_t m = 0; m < out_rows; ++m) {
+    row_offsets[m + 1] += row_offsets[m];
+  }
+  std::vector<Tindices> columns(nnz);
+  std::vector<T> values(nnz);
+  {
+    std::vector<int64_t> next(row_offsets.begin(), row_offsets.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const int64_t pos = next[ms[i]]++;
+      columns[pos] = ks[i];
+      values[pos] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+    }
+  }
+
+  // The rows of B, or of its adjoint, are contiguous.
+  Eigen::Tensor<T, 2, Eigen::RowMajor> adjoint_b;
+  if (ADJ_B) {
+    adjoint_b.resize(lhs_right, rhs_right);
+    Eigen::array<int, 2> shuffle(1, 0);
+    adjoint_b.device(d) = b.shuffle(shuffle).conjugate();
+  }
+  const T* b_data = ADJ_B ? adjoint_b.data() : b.data();
+
+  // The output rows are split into blocks of about kElementsPerBlock
+  // multiply-adds, so that the work is balanced however skewed the rows are.
+  constexpr int64_t kElementsPerBlock = 1 << 14;
+  const int64_t nnz_per_block =
+      std::max<int64_t>(1, kElementsPerBlock / rhs_right);
+  const int64_t num_blocks = (nnz + nnz_per_block - 1) / nnz_per_block;
+  // Returns the first output row whose nonzeros start in `block`.
+  auto block_start = [&](int64_t block) -> int64_t {
+    if (block >= num_blocks) return out_rows;
+    return std::lower_bound(row_offsets.begin(), row_offsets.end() - 1,
+                            block * nnz_per_block) -
+           row_offsets.begin();
+  };
+  auto multiply_rows = [&](int64_t begin_block, int64_t end_block) {
+    const int64_t end = block_start(end_block);
+    for (int64_t m = block_start(begin_block); m < end; ++m) {
+      Tsum* out_row = &out(m, 0);
+      for (int64_t pos = row_offsets[m]; pos < row_offsets[m + 1]; ++pos) {
+        const Tsum a_value = static_cast<Tsum>(values[pos]);
+        const T* b_row = b_data + columns[pos] * rhs_right;
+        for (int64_t n = 0; n < rhs_right; ++n) {
+          out_row[n] += a_value * static_cast<Tsum>(b_row[n]);
+        }
+      }
+    }
+  };
+  const int64_t block_elements = nnz_per_block * rhs_right;
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/block_elements * sizeof(T),
+      /*bytes_stored=*/block_elements * sizeof(Tsum),
+      /*compute_cycles=*/block_elements *
+          (Eigen::TensorOpCost::AddCost<Tsum>() +
+           Eigen::TensorOpCost::MulCost<Tsum>()));
+  d.parallelFor(num_blocks, cost, std::move(multiply_rows));
+  return OkStatus();
+}
+
+// Multiplies on the calling thread below this number of multiply-adds.
+constexpr int64_t kMinElementsByRows = 1 << 15;
+
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCpu(
+    const CPUDevice& d, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  if (static_cast<int64_t>(a_values.size()) * out.dimension(1) <
+      kMinElementsByRows) {
+    return SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        out, a_indices, a_values, b);
+  }
+  return SparseTensorDenseMatMulByRows<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+      d, out, a_indices, a_values, b);
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -338,8 +446,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+          SparseTensorDenseMatMulCpu<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx->eigen_cpu_device(), temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -348,8 +456,9 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          SparseTensorDenseMatMulCpu<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx->eigen_cpu_device(), out_workaround, a_indices, a_values,
+              b));
     }
     return OkStatus();
   }
@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -45,17 +47,39 @@ class StringToHashBucketOp : public OpKernel {
     auto output_flat = output_tensor->flat<int64_t>();
 
     typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
+    const Index size = input_flat.size();
+    auto hash_range = [&](int64_t start, int64_t limit) {
+      for (Index i = start; i < limit; ++i) {
+        // The characters of long strings are on the heap, away from the
+        // tstring. Fetch those of a later string while hashing this one.
+        if (i + kPrefetchDistance < limit) {
+          absl::PrefetchToLocalCache(input_flat(i + kPrefetchDistance).data());
+        }
+        const uint64 input_hash = hash(input_flat(i));
+        const uint64 bucket_id = input_hash % num_buckets_;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output_flat(i) = static_cast<int64_t>(bucket_id);
+      }
+    };
+    if (size < kMinParallelSize) {
+      hash_range(0, size);
+      return;
     }
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, size,
+          kCostPerString, hash_range);
   }
 
  private:
+  // Smaller inputs are hashed on the calling thread.
+  static constexpr int64_t kMinParallelSize = 4096;
+  // A rough number of cycles to hash a short string.
+  static constexpr int64_t kCostPerString = 100;
+  static constexpr int64_t kPrefetchDistance = 8;
+
   int64_t num_buckets_;
 
   StringToHashBucketOp(const StringToHashBucketOp&) = delete;
@@ -129,6 +129,68 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Orders the columns of a row by decreasing value, and the columns with equal
+// values by increasing index.
+template <typename T, typename Tidx>
+struct TopKGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* input_data;
+};
+
+template <typename T, typename Tidx>
+using TopKFilter = gtl::TopN<Tidx, TopKGreater<T, Tidx>>;
+
+// Pushes the columns [begin, end) of a row into the empty `filter`.
+//
+// Once `filter` is full, a column can only enter it if its value is greater
+// than the smallest value in `filter`, because on ties the columns pushed
+// earlier win. So most columns of a long row are rejected by comparing blocks
+// of values to that threshold in a branch-free loop, which the compiler
+// vectorizes, rather than by calling the comparator of `filter` per column.
+template <typename T, typename Tidx>
+void PushColumns(const T* input_data, int64_t begin, int64_t end,
+                 TopKFilter<T, Tidx>* filter) {
+  constexpr int64_t kBlockSize = 64;
+  // After limit + 1 pushes `filter` is a heap, whose bottom is known.
+  const int64_t fill_end =
+      std::min<int64_t>(end, begin + filter->limit() + 1);
+  int64_t c = begin;
+  for (; c < fill_end; ++c) {
+    filter->push(static_cast<Tidx>(c));
+  }
+  if (c == end) return;
+  T threshold = input_data[filter->peek_bottom()];
+  while (c < end) {
+    const int64_t block_end = std::min(end, c + kBlockSize);
+    bool any_greater = false;
+    for (int64_t i = c; i < block_end; ++i) {
+      any_greater |= input_data[i] > threshold;
+    }
+    if (any_greater) {
+      for (int64_t i = c; i < block_end; ++i) {
+        if (input_data[i] > threshold) {
+          filter->push(static_cast<Tidx>(i));
+          threshold = input_data[filter->peek_bottom()];
+        }
+      }
+    }
+    c = block_end;
+  }
+}
+
+// Rows with fewer than this many columns per thread are not split between
+// threads.
+constexpr int64_t kMinColumnsPerTopKChunk = 1 << 15;
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,19 +223,65 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
-    auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
-      for (int32_t b = start_batch; b < limit_batch; ++b) {
+    // Writes the columns in `filter` to row `b` of the outputs.
+    auto WriteTopK = [&](int64_t b, TopKFilter<T, Tidx>* filter) {
+      int32_t i = 0;
+      if (sorted) {
+        std::unique_ptr<std::vector<Tidx>> top_k(filter->Extract());
+        for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+             ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      } else {
+        for (auto top_k_it = filter->unsorted_begin();
+             top_k_it != filter->unsorted_end(); ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      }
+      std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                     [b, &input](const Tidx loc) { return input(b, loc); });
+    };
+
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+
+    // With fewer rows than threads, long rows are split into chunks of
+    // columns. The top k of each chunk are found in parallel, then merged.
+    const int64_t num_chunks = std::min<int64_t>(
+        worker_threads.num_threads, num_cols / kMinColumnsPerTopKChunk);
+    if (num_rows < worker_threads.num_threads && num_chunks > 1 &&
+        4 * k <= num_cols / num_chunks) {
+      std::vector<std::vector<Tidx>> chunk_top_k(num_chunks);
+      for (int64_t b = 0; b < num_rows; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
+        auto FilterChunks = [&](int64_t start_chunk, int64_t limit_chunk) {
+          for (int64_t chunk = start_chunk; chunk < limit_chunk; ++chunk) {
+            TopKFilter<T, Tidx> filter(k, TopKGreater<T, Tidx>{input_data});
+            PushColumns(input_data, num_cols * chunk / num_chunks,
+                        num_cols * (chunk + 1) / num_chunks, &filter);
+            chunk_top_k[chunk].assign(filter.unsorted_begin(),
+                                      filter.unsorted_end());
           }
         };
+        Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+              static_cast<int64_t>(cmp_cost * num_cols / num_chunks),
+              FilterChunks);
+        TopKFilter<T, Tidx> filter(k, TopKGreater<T, Tidx>{input_data});
+        filter.reserve(num_chunks * k);
+        for (const auto& top_k : chunk_top_k) {
+          for (const Tidx c : top_k) {
+            filter.push(c);
+          }
+        }
+        WriteTopK(b, &filter);
+      }
+      return OkStatus();
+    }
+
+    auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int32_t b = start_batch; b < limit_batch; ++b) {
+        const T* input_data = &input(b, 0);
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
@@ -204,39 +312,23 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+          // Now that the indices are sorted, copy the values over in
+          // sorted order.
+          std::transform(
+              &indices(b, 0), &indices(b, k), &values(b, 0),
+              [b, &input](const Tidx loc) { return input(b, loc); });
         } else {
           // Use the TopN heap object to sort.
-          gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
+          TopKFilter<T, Tidx> filter(k, TopKGreater<T, Tidx>{input_data});
           filter.reserve(num_cols);
-          for (Tidx c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32_t i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          PushColumns(input_data, 0, num_cols, &filter);
+          WriteTopK(b, &filter);
         }
-        // Now that the indices are sorted, copy the values over in
-        // sorted order.
-        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
-                       [b, &input](const Tidx loc) { return input(b, loc); });
       }  // for (Tidx b = ...
     };
 
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
     // If K == N, assume the cost is N*log(K + 1).
-    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
-                            Eigen::TensorOpCost::AddCost<T>();
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
@@ -247,7 +339,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
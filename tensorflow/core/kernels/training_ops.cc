@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -771,6 +773,42 @@ struct SparseApplyAdadelta<CPUDevice, T, Tindex> {
   }
 };
 
+// Applies the Adam update with the learning rate `alpha` to `size` elements.
+template <typename T>
+void ApplyAdamToRange(T* var_ptr, T* m_ptr, T* v_ptr, const T* g_ptr,
+                      Index size, T alpha, T beta1, T beta2, T epsilon,
+                      bool use_nesterov) {
+  auto var = typename TTypes<T>::UnalignedTensor(var_ptr, size);
+  auto m = typename TTypes<T>::UnalignedTensor(m_ptr, size);
+  auto v = typename TTypes<T>::UnalignedTensor(v_ptr, size);
+  auto g = typename TTypes<T>::UnalignedConstTensor(g_ptr, size);
+
+  if (use_nesterov) {
+    m += (g - m) * (T(1) - beta1);
+    v += (g.square() - v) * (T(1) - beta2);
+    var -= ((g * (T(1) - beta1) + beta1 * m) * alpha) / (v.sqrt() + epsilon);
+  } else {
+    m += (g - m) * (T(1) - beta1);
+    v += (g.square() - v) * (T(1) - beta2);
+    var -= (m * alpha) / (v.sqrt() + epsilon);
+  }
+}
+
+// The cost of the Adam update of one element.
+template <typename T>
+Eigen::TensorOpCost ApplyAdamCost() {
+  // Input data: var, v, m, grad.
+  // Output data: var, v, m.
+  return Eigen::TensorOpCost(
+      sizeof(T) * 4, sizeof(T) * 3,
+      // Consider Sub as Add
+      Eigen::TensorOpCost::AddCost<int>() * 5 +
+          Eigen::TensorOpCost::MulCost<int>() * 2 +
+          Eigen::TensorOpCost::AddCost<T>() * 10 +
+          Eigen::TensorOpCost::MulCost<T>() * 6 +
+          Eigen::TensorOpCost::DivCost<T>());
+}
+
 template <typename Device, typename T>
 struct ApplyAdamNonCuda {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -806,36 +844,13 @@ struct ApplyAdamNonCuda {
                   use_nesterov, packet_size](int begin, int end) {
       int t_size = (end - begin) * packet_size;
       begin = begin * packet_size;
-      auto var = typename TTypes<T>::UnalignedTensor(var_ptr + begin, t_size);
-      auto m = typename TTypes<T>::UnalignedTensor(m_ptr + begin, t_size);
-      auto v = typename TTypes<T>::UnalignedTensor(v_ptr + begin, t_size);
-      auto g = typename TTypes<T>::UnalignedConstTensor(g_ptr + begin, t_size);
-
-      if (use_nesterov) {
-        m += (g - m) * (T(1) - beta1());
-        v += (g.square() - v) * (T(1) - beta2());
-        var -= ((g * (T(1) - beta1()) + beta1() * m) * alpha) /
-               (v.sqrt() + epsilon());
-      } else {
-        m += (g - m) * (T(1) - beta1());
-        v += (g.square() - v) * (T(1) - beta2());
-        var -= (m * alpha) / (v.sqrt() + epsilon());
-      }
+      ApplyAdamToRange(var_ptr + begin, m_ptr + begin, v_ptr + begin,
+                       g_ptr + begin, t_size, alpha, beta1(), beta2(),
+                       epsilon(), use_nesterov);
     };
 
-    // Input data: var, v, m, grad.
-    // Output data: var, v, m.
-    const int input_bytes = length * packet_size * sizeof(T) * 4;
-    const int output_bytes = length * packet_size * sizeof(T) * 3;
-    const int compute_cycles =
-        // Consider Sub as Add
-        (Eigen::TensorOpCost::AddCost<int>() * 5 +
-         Eigen::TensorOpCost::MulCost<int>() * 2 +
-         Eigen::TensorOpCost::AddCost<T>() * 10 +
-         Eigen::TensorOpCost::MulCost<T>() * 6 +
-         Eigen::TensorOpCost::DivCost<T>()) *
-        length;
-    const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
+    const Eigen::TensorOpCost cost =
+        ApplyAdamCost<T>() * static_cast<double>(length * packet_size);
 
     // Eigen device must update 3 variables with 3 different expressions,
     // which is bad for cache locality on CPU. Here use ParallelFor instead of
@@ -3654,6 +3669,186 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace functor {
+
+// Applies the Adam update to each variable in turn.
+template <typename Device, typename T>
+struct ApplyAdamMulti {
+  void operator()(const Device& d, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<const Tensor*>& grad, bool use_nesterov) {
+    for (int i = 0; i < var->size(); ++i) {
+      ApplyAdam<Device, T>()(d, (*var)[i].flat<T>(), (*m)[i].flat<T>(),
+                             (*v)[i].flat<T>(), beta1_power, beta2_power, lr,
+                             beta1, beta2, epsilon, grad[i]->flat<T>(),
+                             use_nesterov);
+    }
+  }
+};
+
+// Applies the Adam update to all the variables in one parallel loop over
+// blocks of their elements, so that small variables are updated together
+// instead of one after the other.
+template <typename T>
+struct ApplyAdamMulti<CPUDevice, T> {
+  static constexpr Index kBlockSize = 4096;
+
+  void operator()(const CPUDevice& d, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<const Tensor*>& grad, bool use_nesterov) {
+    // The first block of each variable, in the blocks of all the variables.
+    std::vector<Index> first_blocks(var->size() + 1, 0);
+    for (int i = 0; i < var->size(); ++i) {
+      first_blocks[i + 1] =
+          first_blocks[i] +
+          Eigen::divup<Index>((*var)[i].NumElements(), kBlockSize);
+    }
+    const T alpha = lr() * Eigen::numext::sqrt(T(1) - beta2_power()) /
+                    (T(1) - beta1_power());
+
+    auto shard = [&](Index begin, Index end) {
+      int i = std::upper_bound(first_blocks.begin(), first_blocks.end(),
+                               begin) -
+              first_blocks.begin() - 1;
+      while (begin < end) {
+        const Index var_end = std::min(end, first_blocks[i + 1]);
+        const Index offset = (begin - first_blocks[i]) * kBlockSize;
+        const Index size =
+            std::min((*var)[i].NumElements(),
+                     (var_end - first_blocks[i]) * kBlockSize) -
+            offset;
+        ApplyAdamToRange((*var)[i].flat<T>().data() + offset,
+                         (*m)[i].flat<T>().data() + offset,
+                         (*v)[i].flat<T>().data() + offset,
+                         grad[i]->flat<T>().data() + offset, size, alpha,
+                         beta1(), beta2(), epsilon(), use_nesterov);
+        begin = var_end;
+        ++i;
+      }
+    };
+    d.parallelFor(first_blocks.back(),
+                  ApplyAdamCost<T>() * static_cast<double>(kBlockSize), shard);
+  }
+};
+
+}  // namespace functor
+
+// Applies the Adam update to N variables in one op, with the same
+// hyperparameters for all of them.
+template <typename Device, typename T>
+class ApplyAdamMultiOp : public OpKernel {
+ public:
+  explicit ApplyAdamMultiOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    const int n = num_vars_;
+    // The var, m and v inputs.
+    std::vector<int> variable_inputs(3 * n);
+    std::iota(variable_inputs.begin(), variable_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, sparse, variable_inputs);
+
+    std::vector<Tensor> vars(3 * n);
+    for (int i = 0; i < 3 * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                              ctx, i, use_exclusive_lock_, sparse, &vars[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+    std::vector<Tensor> var(vars.begin(), vars.begin() + n);
+    std::vector<Tensor> m(vars.begin() + n, vars.begin() + 2 * n);
+    std::vector<Tensor> v(vars.begin() + 2 * n, vars.end());
+
+    static constexpr const char* kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    for (int i = 0; i < 6; ++i) {
+      const Tensor& scalar = ctx->input(3 * n + i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar.shape().DebugString()));
+    }
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+
+    std::vector<const Tensor*> grad(n);
+    for (int i = 0; i < n; ++i) {
+      grad[i] = &ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(ctx, var[i].shape().IsSameSize(m[i].shape()),
+                  errors::InvalidArgument(
+                      "var and m do not have the same shape for variable ", i,
+                      ": ", var[i].shape().DebugString(), " ",
+                      m[i].shape().DebugString()));
+      OP_REQUIRES(ctx, var[i].shape().IsSameSize(v[i].shape()),
+                  errors::InvalidArgument(
+                      "var and v do not have the same shape for variable ", i,
+                      ": ", var[i].shape().DebugString(), " ",
+                      v[i].shape().DebugString()));
+      OP_REQUIRES(ctx, var[i].shape().IsSameSize(grad[i]->shape()),
+                  errors::InvalidArgument(
+                      "var and grad do not have the same shape for variable ",
+                      i, ": ", var[i].shape().DebugString(), " ",
+                      grad[i]->shape().DebugString()));
+    }
+
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::ApplyAdamMulti<Device, T>()(
+        device, &var, &m, &v, beta1_power.scalar<T>(), beta2_power.scalar<T>(),
+        lr.scalar<T>(), beta1.scalar<T>(), beta2.scalar<T>(),
+        epsilon.scalar<T>(), grad, use_nesterov_);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+  int num_vars_;
+};
+
+#define REGISTER_KERNELS(D, T)                                \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamMulti")      \
+                              .HostMemory("var")              \
+                              .HostMemory("m")                \
+                              .HostMemory("v")                \
+                              .Device(DEVICE_##D)             \
+                              .TypeConstraint<T>("T"),        \
+                          ApplyAdamMultiOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+REGISTER_KERNELS(GPU, complex64);
+REGISTER_KERNELS(GPU, complex128);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
@@ -85,6 +85,7 @@ inline void ReduceTransposeDimensions(const TensorShape& shape,
     // If input dimension is already 1, no need to reduce dimension.
     new_perm->resize(1);
     (*new_perm)[0] = perm[0];
+    new_dims->resize(1);
     (*new_dims)[0] = shape.dim_size(0);
     return;
   }
@@ -108,14 +109,16 @@ inline void ReduceTransposeDimensions(const TensorShape& shape,
       combined_dims[dim_idx] = shape.dim_size(cur_head);
     }
   }
-  // Compact the new permutations and dimension sizes.
+  // Compact the new permutations and dimension sizes. The combined dimensions
+  // keep the order of their first input dimension, and the dimension at
+  // position `new_perm_idx` of the output is the `dim_idx`-th of them.
   new_perm->resize(dim_idx + 1);
   new_dims->resize(dim_idx + 1);
   dim_idx = 0;
   for (int i = 0; i < new_dim_position.size(); ++i) {
     if (new_dim_position[i] >= 0) {
       int new_perm_idx = new_dim_position[i];
-      (*new_perm)[dim_idx] = new_perm_idx;
+      (*new_perm)[new_perm_idx] = dim_idx;
       (*new_dims)[dim_idx] = combined_dims[new_perm_idx];
       dim_idx++;
     }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -31,41 +32,164 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 namespace tensorflow {
 namespace {
 
+// The size in bytes of the side of the tiles of TransposeTiles.
+constexpr int64_t kTileBytes = 128;
+
 template <typename T, bool conjugate>
-void TransposeSimple(const CPUDevice& device, const Tensor& in,
-                     const gtl::ArraySlice<int32> perm, Tensor* out) {
-  const int ndims = in.dims();
-  gtl::InlinedVector<int64_t, 8> in_strides =
-      ComputeStride<int64_t>(in.shape());
-  gtl::InlinedVector<int64_t, 8> out_strides =
-      ComputeStride<int64_t>(out->shape());
-  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
-  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
-  auto transpose_fn = [=, &in_strides, &out_strides, &perm](int64_t begin,
-                                                            int64_t end) {
-    for (int64_t o_idx = begin; o_idx < end; ++o_idx) {
-      int64_t i_idx = 0;
-      int64_t t = o_idx;
-      for (int i = 0; i < ndims; ++i) {
-        const int64_t ratio = t / out_strides[i];
-        t -= ratio * out_strides[i];
-        i_idx += ratio * in_strides[perm[i]];
-      }
+inline void CopyElement(const T& from, T* to) {
+  if (conjugate) {
+    *to = Eigen::numext::conj(from);
+  } else {
+    *to = from;
+  }
+}
+
+// Returns the strides of the dimensions `dims` of a row-major tensor.
+internal::TransposeDimsVec ComputeStrides(
+    const internal::TransposeDimsVec& dims) {
+  internal::TransposeDimsVec strides(dims.size());
+  int64_t stride = 1;
+  for (int i = dims.size() - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= dims[i];
+  }
+  return strides;
+}
+
+// Transposes the input of dimensions `dims` by `perm`, which keeps the
+// innermost dimension in place, by copying the rows of that dimension.
+template <typename T, bool conjugate>
+void TransposeRows(const CPUDevice& device, const T* in, T* out,
+                   const internal::TransposeDimsVec& dims,
+                   const internal::TransposePermsVec& perm) {
+  const int ndims = dims.size();
+  const int64_t row_size = dims[ndims - 1];
+  const internal::TransposeDimsVec in_strides = ComputeStrides(dims);
+  // The output dimensions but the innermost one, and the input strides along
+  // them.
+  internal::TransposeDimsVec out_dims(ndims - 1);
+  internal::TransposeDimsVec strides(ndims - 1);
+  int64_t num_rows = 1;
+  for (int i = 0; i < ndims - 1; ++i) {
+    out_dims[i] = dims[perm[i]];
+    strides[i] = in_strides[perm[i]];
+    num_rows *= out_dims[i];
+  }
+  auto copy_rows = [&](int64_t begin, int64_t end) {
+    // The index of the current row in `out_dims`, and its input offset, which
+    // are updated as the rows are copied.
+    internal::TransposeDimsVec index(ndims - 1);
+    int64_t in_offset = 0;
+    int64_t rest = begin;
+    for (int i = ndims - 2; i >= 0; --i) {
+      index[i] = rest % out_dims[i];
+      rest /= out_dims[i];
+      in_offset += index[i] * strides[i];
+    }
+    for (int64_t row = begin; row < end; ++row) {
+      const T* src = in + in_offset;
+      T* dst = out + row * row_size;
       if (conjugate) {
-        q[o_idx] = Eigen::numext::conj(p[i_idx]);
+        for (int64_t j = 0; j < row_size; ++j) {
+          CopyElement<T, conjugate>(src[j], dst + j);
+        }
       } else {
-        q[o_idx] = p[i_idx];
+        std::copy(src, src + row_size, dst);
+      }
+      for (int i = ndims - 2; i >= 0; --i) {
+        in_offset += strides[i];
+        if (++index[i] < out_dims[i]) break;
+        in_offset -= index[i] * strides[i];
+        index[i] = 0;
+      }
+    }
+  };
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/row_size * sizeof(T),
+      /*bytes_stored=*/row_size * sizeof(T),
+      /*compute_cycles=*/(conjugate ? row_size : 0) +
+          ndims * Eigen::TensorOpCost::AddCost<int64_t>());
+  device.parallelFor(num_rows, cost, std::move(copy_rows));
+}
+
+// Transposes the input of dimensions `dims` by `perm`, which moves the
+// innermost dimension, as a batch of matrix transposes. They are done in
+// square tiles, which are read along the innermost input dimension and
+// written along the innermost output dimension while they stay in cache.
+template <typename T, bool conjugate>
+void TransposeTiles(const CPUDevice& device, const T* in, T* out,
+                    const internal::TransposeDimsVec& dims,
+                    const internal::TransposePermsVec& perm) {
+  const int ndims = dims.size();
+  // The input dimensions that are innermost in the input and in the output.
+  const int in_inner = ndims - 1;
+  const int out_inner = perm[ndims - 1];
+  const internal::TransposeDimsVec in_strides = ComputeStrides(dims);
+  // The output strides along the input dimensions.
+  internal::TransposeDimsVec out_dims(ndims);
+  for (int i = 0; i < ndims; ++i) out_dims[i] = dims[perm[i]];
+  const internal::TransposeDimsVec out_position_strides =
+      ComputeStrides(out_dims);
+  internal::TransposeDimsVec out_strides(ndims);
+  for (int i = 0; i < ndims; ++i) {
+    out_strides[perm[i]] = out_position_strides[i];
+  }
+  // The other dimensions index the matrices.
+  gtl::InlinedVector<int, 8> outer_dims;
+  int64_t num_matrices = 1;
+  for (int i = 0; i < ndims; ++i) {
+    if (i != in_inner && i != out_inner) {
+      outer_dims.push_back(i);
+      num_matrices *= dims[i];
+    }
+  }
+
+  const int64_t tile_size =
+      std::max<int64_t>(8, kTileBytes / static_cast<int64_t>(sizeof(T)));
+  const int64_t num_rows = dims[out_inner];
+  const int64_t num_cols = dims[in_inner];
+  const int64_t row_tiles = (num_rows + tile_size - 1) / tile_size;
+  const int64_t col_tiles = (num_cols + tile_size - 1) / tile_size;
+  const int64_t row_stride = in_strides[out_inner];
+  const int64_t col_stride = out_strides[in_inner];
+  auto transpose_tiles = [&](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; ++tile) {
+      int64_t rest = tile;
+      const int64_t col_tile = rest % col_tiles;
+      rest /= col_tiles;
+      const int64_t row_tile = rest % row_tiles;
+      rest /= row_tiles;
+      int64_t in_offset = 0;
+      int64_t out_offset = 0;
+      for (int i = outer_dims.size() - 1; i >= 0; --i) {
+        const int dim = outer_dims[i];
+        const int64_t index = rest % dims[dim];
+        rest /= dims[dim];
+        in_offset += index * in_strides[dim];
+        out_offset += index * out_strides[dim];
+      }
+      const int64_t row_begin = row_tile * tile_size;
+      const int64_t row_end = std::min(row_begin + tile_size, num_rows);
+      const int64_t col_begin = col_tile * tile_size;
+      const int64_t col_end = std::min(col_begin + tile_size, num_cols);
+      for (int64_t col = col_begin; col < col_end; ++col) {
+        const T* src = in + in_offset + col;
+        T* dst = out + out_offset + col * col_stride;
+        for (int64_t row = row_begin; row < row_end; ++row) {
+          CopyElement<T, conjugate>(src[row * row_stride], dst + row);
+        }
       }
     }
   };
-  double cycles_per_element =
-      (conjugate ? 1 : 0) +
-      ndims * (Eigen::TensorOpCost::DivCost<int64_t>() +
-               2 * Eigen::TensorOpCost::MulCost<int64_t>() +
-               2 * Eigen::TensorOpCost::AddCost<int64_t>());
-  Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T),
-                           /*bytes_stored=*/sizeof(T), cycles_per_element);
-  device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
+  const double tile_elements = tile_size * tile_size;
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/tile_elements * sizeof(T),
+      /*bytes_stored=*/tile_elements * sizeof(T),
+      /*compute_cycles=*/(conjugate ? tile_elements : 0) +
+          ndims * (Eigen::TensorOpCost::DivCost<int64_t>() +
+                   2 * Eigen::TensorOpCost::MulCost<int64_t>()));
+  device.parallelFor(num_matrices * row_tiles * col_tiles, cost,
+                     std::move(transpose_tiles));
 }
 
 }  // namespace
@@ -74,38 +198,38 @@ template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
-    switch (in.dims()) {
-      case 2:
-        internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 3:
-        internal::TransposeUsingEigen<CPUDevice, T, 3>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 4:
-        internal::TransposeUsingEigen<CPUDevice, T, 4>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 5:
-        internal::TransposeUsingEigen<CPUDevice, T, 5>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 6:
-        internal::TransposeUsingEigen<CPUDevice, T, 6>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 7:
-        internal::TransposeUsingEigen<CPUDevice, T, 7>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 8:
-        internal::TransposeUsingEigen<CPUDevice, T, 8>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      default:
-        TransposeSimple<T, conjugate>(d, in, perm, out);
-        break;
+    if (in.NumElements() == 0) return;
+    // Drops the singleton dimensions, then merges the dimensions that stay
+    // next to each other, which leaves as few and as large dimensions as
+    // possible to iterate over.
+    TensorShape shape;
+    internal::TransposePermsVec new_index(in.dims(), -1);
+    for (int i = 0; i < in.dims(); ++i) {
+      if (in.dim_size(i) != 1) {
+        new_index[i] = shape.dims();
+        shape.AddDim(in.dim_size(i));
+      }
+    }
+    internal::TransposePermsVec reduced_perm;
+    for (int i = 0; i < in.dims(); ++i) {
+      if (new_index[perm[i]] >= 0) reduced_perm.push_back(new_index[perm[i]]);
+    }
+    internal::TransposePermsVec new_perm;
+    internal::TransposeDimsVec new_dims;
+    if (shape.dims() < 2) {
+      new_perm = {0};
+      new_dims = {in.NumElements()};
+    } else {
+      internal::ReduceTransposeDimensions(shape, reduced_perm, &new_perm,
+                                          &new_dims);
+    }
+
+    const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+    T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+    if (new_perm.back() == static_cast<int32>(new_perm.size()) - 1) {
+      TransposeRows<T, conjugate>(d, p, q, new_dims, new_perm);
+    } else {
+      TransposeTiles<T, conjugate>(d, p, q, new_dims, new_perm);
     }
   }
 };
@@ -85,6 +85,12 @@ TEST_F(TransposeUtilTest, NormalDimensionReduction) {
   TestDimensionReduction({2, 3, 4}, {0, 1, 2}, {0}, {24});
 
   TestDimensionReduction({2, 3}, {0, 1}, {0}, {6});
+
+  TestDimensionReduction({2, 3, 4, 5}, {2, 0, 3, 1}, {2, 0, 3, 1},
+                         {2, 3, 4, 5});
+
+  TestDimensionReduction({2, 3, 4, 5, 6}, {3, 4, 0, 2, 1}, {3, 0, 2, 1},
+                         {2, 3, 4, 30});
 }
 
 TEST_F(TransposeUtilTest, LargeDimensionReduction) {
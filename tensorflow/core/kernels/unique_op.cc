@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +72,192 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Integer inputs with at least this many elements are uniquified by a parallel
+// radix sort rather than a hash map, when several intra-op threads are
+// available. Below it, the hash map is faster than the passes of the sort.
+constexpr int64_t kMinElementsForSortUnique = 1 << 16;
+// The minimum number of elements each thread sorts.
+constexpr int64_t kMinElementsPerSortChunk = 1 << 14;
+
+template <typename T>
+constexpr bool kCanSortUnique =
+    std::is_same_v<T, int32> || std::is_same_v<T, int64_t>;
+
+// Uniquifies the elements of the 1D `input` like the hash map path of
+// `UniqueOp`, but with all the intra-op threads.
+//
+// The (value, position) pairs of the input are sorted by a stable LSD radix
+// sort on the bits of the values, with one byte per pass. Each thread
+// histograms and scatters a contiguous chunk of the pairs, and passes over
+// bytes that are the same for all the values are skipped, so small IDs take
+// few passes. The sort groups equal values with their first occurrence at the
+// front. The unique values are numbered in the order of their first
+// occurrences by a prefix sum over the input positions, which gives `idx`, the
+// output values and, if `with_counts`, the sizes of the groups as counts.
+template <typename T, typename TIndex>
+Status SortUnique(OpKernelContext* context, const Tensor& input, int64_t axis,
+                  bool with_counts, typename TTypes<TIndex>::Vec idx_vec,
+                  int64_t* uniq_size) {
+  using Key = std::make_unsigned_t<T>;
+  struct Entry {
+    Key key;
+    int32 position;
+  };
+  constexpr int kRadixBits = 8;
+  constexpr int kNumBuckets = 1 << kRadixBits;
+  constexpr int kNumPasses = sizeof(Key) * 8 / kRadixBits;
+
+  auto Tin = input.flat<T>();
+  const int64_t n = Tin.size();
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64_t num_chunks =
+      std::max<int64_t>(1, std::min<int64_t>(worker_threads.num_threads,
+                                             n / kMinElementsPerSortChunk));
+  auto chunk_begin = [n, num_chunks](int64_t chunk) {
+    return n * chunk / num_chunks;
+  };
+  // Runs `fn(chunk, begin, end)` for each chunk, in parallel.
+  auto for_each_chunk = [&](const std::function<void(int64_t, int64_t,
+                                                     int64_t)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+          /*cost_per_unit=*/n / num_chunks * 10,
+          [&](int64_t first, int64_t last) {
+            for (int64_t chunk = first; chunk < last; ++chunk) {
+              fn(chunk, chunk_begin(chunk), chunk_begin(chunk + 1));
+            }
+          });
+  };
+
+  std::vector<Entry> entries(n);
+  std::vector<Entry> scratch(n);
+  const Key first_key = static_cast<Key>(Tin(0));
+  std::vector<Key> chunk_varying_bits(num_chunks, 0);
+  for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+    Key varying_bits = 0;
+    for (int64_t i = begin; i < end; ++i) {
+      const Key key = static_cast<Key>(Tin(i));
+      entries[i] = {key, static_cast<int32>(i)};
+      varying_bits |= key ^ first_key;
+    }
+    chunk_varying_bits[chunk] = varying_bits;
+  });
+  Key varying_bits = 0;
+  for (Key bits : chunk_varying_bits) varying_bits |= bits;
+
+  std::vector<int64_t> offsets(num_chunks * kNumBuckets);
+  for (int pass = 0; pass < kNumPasses; ++pass) {
+    const int shift = pass * kRadixBits;
+    if (((varying_bits >> shift) & (kNumBuckets - 1)) == 0) continue;
+    for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+      int64_t* counts = &offsets[chunk * kNumBuckets];
+      std::fill(counts, counts + kNumBuckets, 0);
+      for (int64_t i = begin; i < end; ++i) {
+        ++counts[(entries[i].key >> shift) & (kNumBuckets - 1)];
+      }
+    });
+    // The entries of a bucket go in the order of the chunks, which keeps the
+    // sort stable.
+    int64_t offset = 0;
+    for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        const int64_t count = offsets[chunk * kNumBuckets + bucket];
+        offsets[chunk * kNumBuckets + bucket] = offset;
+        offset += count;
+      }
+    }
+    for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+      int64_t* chunk_offsets = &offsets[chunk * kNumBuckets];
+      for (int64_t i = begin; i < end; ++i) {
+        scratch[chunk_offsets[(entries[i].key >> shift) &
+                              (kNumBuckets - 1)]++] = entries[i];
+      }
+    });
+    entries.swap(scratch);
+  }
+  scratch = std::vector<Entry>();
+
+  auto is_group_start = [&entries](int64_t i) {
+    return i == 0 || entries[i].key != entries[i - 1].key;
+  };
+  // Flags the first occurrences, then turns the flags into their exclusive
+  // prefix sum, i.e. the index of the unique value of each first occurrence.
+  std::vector<TIndex> first_index(n, 0);
+  for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (is_group_start(i)) first_index[entries[i].position] = 1;
+    }
+  });
+  std::vector<int64_t> chunk_offsets(num_chunks);
+  std::vector<int64_t> last_group_starts(num_chunks);
+  for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+    int64_t count = 0;
+    for (int64_t i = begin; i < end; ++i) count += first_index[i];
+    chunk_offsets[chunk] = count;
+    int64_t last_group_start = -1;
+    for (int64_t i = end - 1; i >= begin; --i) {
+      if (is_group_start(i)) {
+        last_group_start = i;
+        break;
+      }
+    }
+    last_group_starts[chunk] = last_group_start;
+  });
+  int64_t num_unique = 0;
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const int64_t count = chunk_offsets[chunk];
+    chunk_offsets[chunk] = num_unique;
+    num_unique += count;
+  }
+  for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+    TIndex index = chunk_offsets[chunk];
+    for (int64_t i = begin; i < end; ++i) {
+      const TIndex is_first = first_index[i];
+      first_index[i] = index;
+      index += is_first;
+    }
+  });
+
+  *uniq_size = num_unique;
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, num_unique);
+  Tensor* output = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  Tensor* count_output = nullptr;
+  if (with_counts) {
+    TF_RETURN_IF_ERROR(context->allocate_output(
+        2, TensorShape({num_unique}), &count_output));
+  }
+
+  // The group that the first entry of each chunk belongs to may start in an
+  // earlier chunk.
+  std::vector<int64_t> chunk_group_starts(num_chunks);
+  for (int64_t chunk = 0, group_start = 0; chunk < num_chunks; ++chunk) {
+    chunk_group_starts[chunk] = group_start;
+    if (last_group_starts[chunk] >= 0) {
+      group_start = last_group_starts[chunk];
+    }
+  }
+  for_each_chunk([&](int64_t chunk, int64_t begin, int64_t end) {
+    TIndex index = first_index[entries[chunk_group_starts[chunk]].position];
+    for (int64_t i = begin; i < end; ++i) {
+      const int32 position = entries[i].position;
+      if (is_group_start(i)) {
+        index = first_index[position];
+        Tout(index) = Tin(position);
+        if (count_output != nullptr) {
+          int64_t group_end = i + 1;
+          while (group_end < n && !is_group_start(group_end)) ++group_end;
+          count_output->vec<TIndex>()(index) = group_end - i;
+        }
+      }
+      idx_vec(position) = index;
+    }
+  });
+  return OkStatus();
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -143,6 +333,17 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
+    if constexpr (kCanSortUnique<T>) {
+      if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+          new_sizes[1] >= kMinElementsForSortUnique &&
+          context->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+        OP_REQUIRES_OK(context, SortUnique<T, TIndex>(
+                                    context, input, axis,
+                                    /*with_counts=*/num_outputs() > 2, idx_vec,
+                                    &uniq_size));
+        return;
+      }
+    }
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
@@ -60,6 +60,27 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'enable_cross_model_batching' is true, the batching resource is shared
+    // by all the BatchFunction ops of the process whose function 'f' and
+    // batching attributes are identical, e.g. the ops of several models sharing
+    // a frozen backbone, instead of being local to the session. 'f' must not
+    // capture any input ('captured_tensors' must be empty).
+    .Attr("enable_cross_model_batching: bool = false")
+    // If 'enable_deadline_based_batching' is true, a batch is also processed
+    // as soon as waiting any longer would make the deadline of one of its
+    // requests unmet, given the predicted processing time of the batch.
+    .Attr("enable_deadline_based_batching: bool = false")
+    // If 'enable_ragged_batching' is true, each invocation holds the rows of
+    // one variable-length sequence, the inputs of a batch are concatenated
+    // without padding, and 'f' receives an int64 'row_splits' vector after the
+    // batched inputs. Requires 'enable_large_batch_splitting' to be false and
+    // 'num_batch_threads' to be positive.
+    .Attr("enable_ragged_batching: bool = false")
+    // If 'enable_cost_based_batch_splitting' is true, the processing time of
+    // the batches of each of 'allowed_batch_sizes' is measured, and a batch is
+    // processed as two batches of smaller allowed sizes instead of being padded
+    // up whenever that was measured to be faster.
+    .Attr("enable_cost_based_batch_splitting: bool = false")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
@@ -526,6 +526,42 @@ REGISTER_OP("DecodeAndCropJpeg")
       return OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeJpegBatch")
+    .Input("contents: string")
+    .Input("crop_windows: int32")
+    .Attr("output_height: int >= 1")
+    .Attr("output_width: int >= 1")
+    .Attr("channels: int = 3")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("images: uint8")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      ShapeHandle crop_windows;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &crop_windows));
+      DimensionHandle batch_size = c->Dim(contents, 0);
+      TF_RETURN_IF_ERROR(
+          c->Merge(batch_size, c->Dim(crop_windows, 0), &batch_size));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(crop_windows, 1), 4, &unused));
+
+      int32_t output_height;
+      TF_RETURN_IF_ERROR(c->GetAttr("output_height", &output_height));
+      int32_t output_width;
+      TF_RETURN_IF_ERROR(c->GetAttr("output_width", &output_width));
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      c->set_output(0, c->MakeShape({batch_size, output_height, output_width,
+                                     channels}));
+      return OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -352,6 +352,23 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, half, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies `fused_ops` in order to `x`. Unary ops take the result of the previous
+op, binary ops take it as their first operand and the next of `args` as their
+second one, which must either be a scalar or have the shape of `x`.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -826,6 +826,42 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+static Status ApplyAdamMultiShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+  for (int i = 3 * n; i < 3 * n + 6; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);  // var
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, n + i), &s));  // m
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, 2 * n + i), &s));  // v
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(3 * n + 6 + i), &s));  // grad
+  }
+  return OkStatus();
+}
+
+REGISTER_OP("ResourceApplyAdamMulti")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyAdamMultiShapeFn);
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -0,0 +1,294 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_visitor.h"
+#include "tsl/profiler/utils/tf_op_utils.h"
+#include "tsl/profiler/utils/tf_xplane_visitor.h"
+#include "tsl/profiler/utils/timespan.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// An op of the critical path waited for a thread if the time between its
+// inputs being ready and its start is at least this fraction of the step.
+constexpr double kMinWaitFraction = 0.05;
+
+struct OpNode {
+  absl::string_view name;
+  absl::string_view type;
+  // The runs of the op in the step, with the line they ran on.
+  std::vector<std::pair<int64_t, tsl::profiler::Timespan>> runs;
+  uint64_t begin_ps = UINT64_MAX;
+  uint64_t end_ps = 0;
+  uint64_t duration_ps = 0;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+};
+
+// Returns the name of the node producing the graph input `input`.
+absl::string_view InputNodeName(absl::string_view input) {
+  input = absl::StripPrefix(input, "^");
+  return input.substr(0, input.find(':'));
+}
+
+bool IsNextIteration(absl::string_view op) {
+  return op == "NextIteration" || op == "RefNextIteration";
+}
+
+// Collects the TF ops of the step, merging the runs of ops with the same name.
+void CollectOpNodes(const XPlane& host_plane, std::optional<int64_t> group_id,
+                    std::vector<OpNode>* nodes,
+                    absl::flat_hash_map<absl::string_view, int>* node_ids) {
+  absl::flat_hash_map<int64_t, tsl::profiler::TfOp> tf_ops;
+  for (const auto& id_metadata : host_plane.event_metadata()) {
+    tsl::profiler::TfOp tf_op =
+        tsl::profiler::ParseTfOpFullname(id_metadata.second.name());
+    if (tf_op.category == tsl::profiler::Category::kTensorFlow) {
+      tf_ops.try_emplace(id_metadata.first, tf_op);
+    }
+  }
+  if (tf_ops.empty()) return;
+  XPlaneVisitor plane = tsl::profiler::CreateTfXPlaneVisitor(&host_plane);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      auto tf_op = tf_ops.find(event.Id());
+      if (tf_op == tf_ops.end()) return;
+      if (group_id.has_value()) {
+        std::optional<XStatVisitor> stat = event.GetStat(StatType::kGroupId);
+        if (!stat.has_value() ||
+            stat->IntOrUintValue() != static_cast<uint64_t>(*group_id)) {
+          return;
+        }
+      }
+      auto [it, inserted] =
+          node_ids->try_emplace(tf_op->second.name, nodes->size());
+      if (inserted) {
+        nodes->emplace_back();
+        nodes->back().name = tf_op->second.name;
+        nodes->back().type = tf_op->second.type;
+      }
+      OpNode& node = (*nodes)[it->second];
+      tsl::profiler::Timespan span = event.GetTimespan();
+      node.runs.emplace_back(line.Id(), span);
+      node.begin_ps = std::min(node.begin_ps, span.begin_ps());
+      node.end_ps = std::max(node.end_ps, span.end_ps());
+      node.duration_ps += span.duration_ps();
+    });
+  });
+}
+
+// Adds the edges of `graph` between the collected ops, except back edges.
+void AddEdges(const GraphDef& graph,
+              const absl::flat_hash_map<absl::string_view, int>& node_ids,
+              std::vector<OpNode>* nodes) {
+  absl::flat_hash_map<absl::string_view, absl::string_view> op_types;
+  for (const NodeDef& node_def : graph.node()) {
+    op_types[node_def.name()] = node_def.op();
+  }
+  for (const NodeDef& node_def : graph.node()) {
+    auto dst = node_ids.find(node_def.name());
+    if (dst == node_ids.end()) continue;
+    absl::flat_hash_set<int> inputs;
+    for (const std::string& input : node_def.input()) {
+      absl::string_view input_name = InputNodeName(input);
+      auto op_type = op_types.find(input_name);
+      if (op_type != op_types.end() && IsNextIteration(op_type->second)) {
+        continue;
+      }
+      auto src = node_ids.find(input_name);
+      if (src == node_ids.end() || src->second == dst->second ||
+          !inputs.insert(src->second).second) {
+        continue;
+      }
+      (*nodes)[dst->second].inputs.push_back(src->second);
+      (*nodes)[src->second].outputs.push_back(dst->second);
+    }
+  }
+}
+
+// Returns the nodes in topological order, preferring the ones that started
+// first, or an empty vector if there is a cycle.
+std::vector<int> TopologicalOrder(const std::vector<OpNode>& nodes) {
+  std::vector<int> num_pending_inputs(nodes.size());
+  using Ready = std::pair<uint64_t, int>;
+  std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready;
+  for (int i = 0; i < nodes.size(); ++i) {
+    num_pending_inputs[i] = nodes[i].inputs.size();
+    if (num_pending_inputs[i] == 0) ready.emplace(nodes[i].begin_ps, i);
+  }
+  std::vector<int> order;
+  order.reserve(nodes.size());
+  while (!ready.empty()) {
+    int node = ready.top().second;
+    ready.pop();
+    order.push_back(node);
+    for (int output : nodes[node].outputs) {
+      if (--num_pending_inputs[output] == 0) {
+        ready.emplace(nodes[output].begin_ps, output);
+      }
+    }
+  }
+  if (order.size() != nodes.size()) order.clear();
+  return order;
+}
+
+bool Overlaps(const OpNode& node, tsl::profiler::Timespan window) {
+  for (const auto& run : node.runs) {
+    if (run.second.begin_ps() < window.end_ps() &&
+        window.begin_ps() < run.second.end_ps()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+absl::StatusOr<CriticalPathAnalysis> ConvertXPlaneToCriticalPathAnalysis(
+    const XPlane& host_plane, const GraphDef& graph,
+    std::optional<int64_t> group_id) {
+  std::vector<OpNode> nodes;
+  absl::flat_hash_map<absl::string_view, int> node_ids;
+  CollectOpNodes(host_plane, group_id, &nodes, &node_ids);
+  if (nodes.empty()) {
+    return errors::InvalidArgument("No TensorFlow ops found in the step");
+  }
+  AddEdges(graph, node_ids, &nodes);
+  std::vector<int> order = TopologicalOrder(nodes);
+  if (order.empty()) {
+    return errors::InvalidArgument(
+        "The dependencies between the ops of the step form a cycle");
+  }
+
+  uint64_t step_begin_ps = UINT64_MAX;
+  uint64_t step_end_ps = 0;
+  for (const OpNode& node : nodes) {
+    step_begin_ps = std::min(step_begin_ps, node.begin_ps);
+    step_end_ps = std::max(step_end_ps, node.end_ps);
+  }
+
+  // The schedule where every op starts as soon as its inputs are done.
+  const int num_nodes = nodes.size();
+  std::vector<uint64_t> earliest_start(num_nodes, 0);
+  std::vector<uint64_t> ready_ps(num_nodes, step_begin_ps);
+  uint64_t critical_path_ps = 0;
+  for (int node : order) {
+    for (int input : nodes[node].inputs) {
+      earliest_start[node] =
+          std::max(earliest_start[node],
+                   earliest_start[input] + nodes[input].duration_ps);
+      ready_ps[node] = std::max(ready_ps[node], nodes[input].end_ps);
+    }
+    critical_path_ps = std::max(
+        critical_path_ps, earliest_start[node] + nodes[node].duration_ps);
+  }
+  // The latest end of every op in that schedule that keeps its length.
+  std::vector<uint64_t> latest_end(num_nodes, critical_path_ps);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    for (int output : nodes[*it].outputs) {
+      latest_end[*it] = std::min(
+          latest_end[*it], latest_end[output] - nodes[output].duration_ps);
+    }
+  }
+
+  CriticalPathAnalysis analysis;
+  analysis.set_step_time_ps(step_end_ps - step_begin_ps);
+  analysis.set_critical_path_time_ps(critical_path_ps);
+  std::vector<int> positions(num_nodes);
+  std::vector<tsl::profiler::Timespan> wait_windows;
+  for (int node : order) {
+    const OpNode& op_node = nodes[node];
+    positions[node] = analysis.ops_size();
+    CriticalPathOp* op = analysis.add_ops();
+    op->set_name(std::string(op_node.name));
+    op->set_type(std::string(op_node.type));
+    op->set_start_time_ps(op_node.begin_ps - step_begin_ps);
+    op->set_duration_ps(op_node.duration_ps);
+    op->set_occurrences(op_node.runs.size());
+    op->set_wait_ps(op_node.begin_ps > ready_ps[node]
+                        ? op_node.begin_ps - ready_ps[node]
+                        : 0);
+    op->set_earliest_start_time_ps(earliest_start[node]);
+    op->set_slack_ps(latest_end[node] - earliest_start[node] -
+                     op_node.duration_ps);
+    op->set_on_critical_path(op->slack_ps() == 0);
+    if (!op->on_critical_path()) continue;
+    if (op->wait_ps() > 0 &&
+        op->wait_ps() >= kMinWaitFraction * analysis.step_time_ps()) {
+      op->set_suggestion(CriticalPathOp::PARALLELIZE);
+      wait_windows.push_back(tsl::profiler::Timespan::FromEndPoints(
+          ready_ps[node], op_node.begin_ps));
+    } else {
+      op->set_suggestion(CriticalPathOp::SPEED_UP);
+    }
+  }
+  for (int node = 0; node < num_nodes; ++node) {
+    CriticalPathOp* op = analysis.mutable_ops(positions[node]);
+    if (op->on_critical_path()) continue;
+    for (tsl::profiler::Timespan window : wait_windows) {
+      if (Overlaps(nodes[node], window)) {
+        op->set_suggestion(CriticalPathOp::MOVE);
+        break;
+      }
+    }
+  }
+
+  // Walks back from the op ending last in the schedule above, through the
+  // inputs that end right when their consumer can start.
+  std::vector<int> path;
+  int last = order.front();
+  for (int node : order) {
+    if (earliest_start[node] + nodes[node].duration_ps == critical_path_ps) {
+      last = node;
+      break;
+    }
+  }
+  for (std::optional<int> node = last; node.has_value();) {
+    path.push_back(*node);
+    std::optional<int> prev;
+    for (int input : nodes[*node].inputs) {
+      if (earliest_start[input] + nodes[input].duration_ps ==
+          earliest_start[*node]) {
+        prev = input;
+        break;
+      }
+    }
+    node = prev;
+  }
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    analysis.add_critical_path(positions[*it]);
+  }
+  return analysis;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,44 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Computes the critical path of a step from the TF ops on the host threads of
+// `host_plane`. The dependencies between the ops are the edges of `graph`, the
+// graph run by the executor (e.g. a partition graph of RunMetadata), without
+// the back edges of loops. If `group_id` is set, only the ops of that step
+// (as grouped by GroupTfEvents) are analyzed, otherwise all ops of the plane.
+//
+// Returns InvalidArgument if the plane has no such ops, or if their
+// dependencies form a cycle.
+absl::StatusOr<CriticalPathAnalysis> ConvertXPlaneToCriticalPathAnalysis(
+    const XPlane& host_plane, const GraphDef& graph,
+    std::optional<int64_t> group_id = std::nullopt);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
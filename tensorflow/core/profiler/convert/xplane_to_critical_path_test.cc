@@ -0,0 +1,189 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_test_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::testing::ElementsAre;
+
+void AddNode(absl::string_view name, absl::string_view op,
+             const std::vector<std::string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(std::string(name));
+  node->set_op(std::string(op));
+  for (const std::string& input : inputs) node->add_input(input);
+}
+
+void AddOp(absl::string_view name, int64_t start_ps, int64_t duration_ps,
+           XPlaneBuilder* plane, XLineBuilder* line, int64_t group_id = 1) {
+  CreateXEvent(plane, line, absl::StrCat(name, ":Op"), start_ps, duration_ps,
+               {{StatType::kGroupId, group_id}});
+}
+
+std::vector<std::string> CriticalPathNames(
+    const CriticalPathAnalysis& analysis) {
+  std::vector<std::string> names;
+  for (int index : analysis.critical_path()) {
+    names.push_back(analysis.ops(index).name());
+  }
+  return names;
+}
+
+const CriticalPathOp& FindOp(const CriticalPathAnalysis& analysis,
+                             absl::string_view name) {
+  for (const CriticalPathOp& op : analysis.ops()) {
+    if (op.name() == name) return op;
+  }
+  ADD_FAILURE() << "No op " << name;
+  return CriticalPathOp::default_instance();
+}
+
+class CriticalPathTest : public ::testing::Test {
+ protected:
+  CriticalPathTest() : plane_(&xplane_) {}
+
+  XPlane xplane_;
+  XPlaneBuilder plane_;
+  GraphDef graph_;
+};
+
+TEST_F(CriticalPathTest, Diamond) {
+  AddNode("a", "Op", {}, &graph_);
+  AddNode("b", "Op", {"a"}, &graph_);
+  AddNode("c", "Op", {"a:1"}, &graph_);
+  AddNode("d", "Op", {"b", "c", "^a"}, &graph_);
+  XLineBuilder thread1 = plane_.GetOrCreateLine(1);
+  XLineBuilder thread2 = plane_.GetOrCreateLine(2);
+  AddOp("a", 0, 10, &plane_, &thread1);
+  AddOp("b", 10, 30, &plane_, &thread1);
+  AddOp("c", 10, 10, &plane_, &thread2);
+  AddOp("d", 40, 10, &plane_, &thread1);
+
+  TF_ASSERT_OK_AND_ASSIGN(CriticalPathAnalysis analysis,
+                          ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_));
+  EXPECT_EQ(50, analysis.step_time_ps());
+  EXPECT_EQ(50, analysis.critical_path_time_ps());
+  EXPECT_THAT(CriticalPathNames(analysis), ElementsAre("a", "b", "d"));
+  const CriticalPathOp& b = FindOp(analysis, "b");
+  EXPECT_TRUE(b.on_critical_path());
+  EXPECT_EQ(CriticalPathOp::SPEED_UP, b.suggestion());
+  const CriticalPathOp& c = FindOp(analysis, "c");
+  EXPECT_FALSE(c.on_critical_path());
+  EXPECT_EQ(10, c.earliest_start_time_ps());
+  EXPECT_EQ(20, c.slack_ps());
+  EXPECT_EQ(CriticalPathOp::NONE, c.suggestion());
+  EXPECT_EQ(40, FindOp(analysis, "d").earliest_start_time_ps());
+}
+
+TEST_F(CriticalPathTest, SuggestsToParallelizeAndMove) {
+  AddNode("a", "Op", {}, &graph_);
+  AddNode("b", "Op", {"a"}, &graph_);
+  AddNode("c", "Op", {}, &graph_);
+  AddNode("d", "Op", {"b"}, &graph_);
+  // b waits for c, which is off the critical path, to free the only thread.
+  XLineBuilder thread = plane_.GetOrCreateLine(1);
+  AddOp("a", 0, 10, &plane_, &thread);
+  AddOp("c", 10, 20, &plane_, &thread);
+  AddOp("b", 30, 10, &plane_, &thread);
+  AddOp("d", 40, 10, &plane_, &thread);
+
+  TF_ASSERT_OK_AND_ASSIGN(CriticalPathAnalysis analysis,
+                          ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_));
+  EXPECT_EQ(50, analysis.step_time_ps());
+  EXPECT_EQ(30, analysis.critical_path_time_ps());
+  EXPECT_THAT(CriticalPathNames(analysis), ElementsAre("a", "b", "d"));
+  const CriticalPathOp& b = FindOp(analysis, "b");
+  EXPECT_EQ(20, b.wait_ps());
+  EXPECT_EQ(CriticalPathOp::PARALLELIZE, b.suggestion());
+  const CriticalPathOp& c = FindOp(analysis, "c");
+  EXPECT_EQ(10, c.slack_ps());
+  EXPECT_EQ(CriticalPathOp::MOVE, c.suggestion());
+  EXPECT_EQ(CriticalPathOp::SPEED_UP, FindOp(analysis, "d").suggestion());
+}
+
+TEST_F(CriticalPathTest, MergesRunsOfLoopOps) {
+  AddNode("enter", "Enter", {}, &graph_);
+  AddNode("merge", "Merge", {"enter", "next"}, &graph_);
+  AddNode("body", "Op", {"merge"}, &graph_);
+  AddNode("next", "NextIteration", {"body"}, &graph_);
+  XLineBuilder thread = plane_.GetOrCreateLine(1);
+  AddOp("enter", 0, 10, &plane_, &thread);
+  AddOp("merge", 10, 10, &plane_, &thread);
+  AddOp("body", 20, 20, &plane_, &thread);
+  AddOp("next", 40, 10, &plane_, &thread);
+  AddOp("merge", 50, 10, &plane_, &thread);
+  AddOp("body", 60, 20, &plane_, &thread);
+
+  TF_ASSERT_OK_AND_ASSIGN(CriticalPathAnalysis analysis,
+                          ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_));
+  EXPECT_EQ(4, analysis.ops_size());
+  const CriticalPathOp& body = FindOp(analysis, "body");
+  EXPECT_EQ(2, body.occurrences());
+  EXPECT_EQ(40, body.duration_ps());
+  EXPECT_THAT(CriticalPathNames(analysis),
+              ElementsAre("enter", "merge", "body", "next"));
+}
+
+TEST_F(CriticalPathTest, FiltersByGroupId) {
+  AddNode("a", "Op", {}, &graph_);
+  AddNode("b", "Op", {"a"}, &graph_);
+  XLineBuilder thread = plane_.GetOrCreateLine(1);
+  AddOp("a", 0, 10, &plane_, &thread, /*group_id=*/1);
+  AddOp("b", 10, 10, &plane_, &thread, /*group_id=*/1);
+  AddOp("a", 100, 10, &plane_, &thread, /*group_id=*/2);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      CriticalPathAnalysis analysis,
+      ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_, /*group_id=*/2));
+  EXPECT_EQ(1, analysis.ops_size());
+  EXPECT_EQ(10, analysis.step_time_ps());
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_, /*group_id=*/3)
+          .status()));
+}
+
+TEST_F(CriticalPathTest, RejectsCycles) {
+  AddNode("a", "Op", {"b"}, &graph_);
+  AddNode("b", "Op", {"a"}, &graph_);
+  XLineBuilder thread = plane_.GetOrCreateLine(1);
+  AddOp("a", 0, 10, &plane_, &thread);
+  AddOp("b", 10, 10, &plane_, &thread);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      ConvertXPlaneToCriticalPathAnalysis(xplane_, graph_).status()));
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,202 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#endif
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Returns the value of the environment variable `name`, or `default_value` if
+// it is not set or cannot be parsed.
+int64_t ReadInt64FlagOrDefault(const char* name, int64_t default_value) {
+  int64_t value;
+  Status s = ReadInt64FromEnvVar(name, default_value, &value);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << name << ": " << s;
+    return default_value;
+  }
+  return value;
+}
+
+}  // namespace
+
+SamplingProfiler::ScopedStep::ScopedStep(SamplingProfiler* profiler)
+    : profiler_(profiler) {
+#if !defined(IS_MOBILE_PLATFORM)
+  if (profiler_ != nullptr) {
+    session_ = profiler_->MaybeStartSession();
+  }
+#endif
+}
+
+SamplingProfiler::ScopedStep::~ScopedStep() {
+#if !defined(IS_MOBILE_PLATFORM)
+  if (session_ != nullptr) {
+    profiler_->EndSession(std::move(session_));
+  }
+#endif
+}
+
+bool SamplingProfiler::ScopedStep::sampled() const {
+#if !defined(IS_MOBILE_PLATFORM)
+  return session_ != nullptr;
+#else
+  return false;
+#endif
+}
+
+SamplingProfiler::SamplingProfiler(const Options& options)
+    : options_(options),
+      thread_pool_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "sampling_profiler", 1)) {
+  CHECK_GT(options_.sample_every_n_steps, 0);
+  CHECK_GT(options_.max_samples, 0);
+}
+
+SamplingProfiler::~SamplingProfiler() {
+  // Waits for the pending conversions.
+  thread_pool_.reset();
+}
+
+/*static*/ SamplingProfiler* SamplingProfiler::Global() {
+  static SamplingProfiler* profiler = []() -> SamplingProfiler* {
+    Options options;
+    options.sample_every_n_steps =
+        ReadInt64FlagOrDefault("TF_SAMPLING_PROFILER_STEPS", 0);
+    const int64_t max_samples = ReadInt64FlagOrDefault(
+        "TF_SAMPLING_PROFILER_MAX_SAMPLES", options.max_samples);
+    if (options.sample_every_n_steps <= 0) return nullptr;
+    options.max_samples = std::max<int64_t>(max_samples, 1);
+    LOG(INFO) << "Sampling profiler enabled, tracing one in "
+              << options.sample_every_n_steps << " steps.";
+    return new SamplingProfiler(options);
+  }();
+  return profiler;
+}
+
+#if !defined(IS_MOBILE_PLATFORM)
+std::unique_ptr<ProfilerSession> SamplingProfiler::MaybeStartSession() {
+  if (step_count_.fetch_add(1, std::memory_order_relaxed) %
+          options_.sample_every_n_steps !=
+      0) {
+    return nullptr;
+  }
+  if (tracing_.exchange(true)) return nullptr;
+  ProfileOptions options = ProfilerSession::DefaultOptions();
+  options.set_enable_hlo_proto(false);
+  std::unique_ptr<ProfilerSession> session = ProfilerSession::Create(options);
+  if (!session->Status().ok()) {
+    // The process is being profiled explicitly.
+    VLOG(1) << "Not sampling a step: " << session->Status();
+    tracing_ = false;
+    return nullptr;
+  }
+  mutex_lock l(mu_);
+  ++num_pending_;
+  return session;
+}
+
+void SamplingProfiler::EndSession(std::unique_ptr<ProfilerSession> session) {
+  auto space = std::make_shared<XSpace>();
+  Status status = session->CollectData(space.get());
+  session.reset();
+  tracing_ = false;
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to collect a sampled step: " << status;
+    mutex_lock l(mu_);
+    --num_pending_;
+    pending_cv_.notify_all();
+    return;
+  }
+  thread_pool_->Schedule([this, space]() {
+    Sample sample;
+    if (const XPlane* host_plane =
+            FindPlaneWithName(*space, kHostThreadsPlaneName)) {
+      sample.host_op_metrics_db =
+          ConvertHostThreadsXPlaneToOpMetricsDb(*host_plane);
+    }
+    OpMetricsDbCombiner device_combiner(&sample.device_op_metrics_db);
+    for (const XPlane* device_plane :
+         FindPlanesWithPrefix(*space, kGpuPlanePrefix)) {
+      device_combiner.Combine(
+          ConvertDeviceTraceXPlaneToOpMetricsDb(*device_plane));
+    }
+    mutex_lock l(mu_);
+    samples_.push_back(std::move(sample));
+    if (samples_.size() > static_cast<size_t>(options_.max_samples)) {
+      samples_.pop_front();
+    }
+    ++num_sampled_steps_;
+    --num_pending_;
+    pending_cv_.notify_all();
+  });
+}
+#endif
+
+OpMetricsDb SamplingProfiler::GetHostOpMetricsDb() const {
+  OpMetricsDb db;
+#if !defined(IS_MOBILE_PLATFORM)
+  OpMetricsDbCombiner combiner(&db);
+  mutex_lock l(mu_);
+  for (const Sample& sample : samples_) {
+    combiner.Combine(sample.host_op_metrics_db);
+  }
+#endif
+  return db;
+}
+
+OpMetricsDb SamplingProfiler::GetDeviceOpMetricsDb() const {
+  OpMetricsDb db;
+#if !defined(IS_MOBILE_PLATFORM)
+  OpMetricsDbCombiner combiner(&db);
+  mutex_lock l(mu_);
+  for (const Sample& sample : samples_) {
+    combiner.Combine(sample.device_op_metrics_db);
+  }
+#endif
+  return db;
+}
+
+int64_t SamplingProfiler::num_sampled_steps() const {
+  mutex_lock l(mu_);
+  return num_sampled_steps_;
+}
+
+void SamplingProfiler::Flush() {
+  mutex_lock l(mu_);
+  while (num_pending_ > 0) {
+    pending_cv_.wait(l);
+  }
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#endif
+
+namespace tensorflow {
+namespace profiler {
+
+// Profiles a small sample of the steps of a process continuously, cheaply
+// enough to stay enabled in production. One in `sample_every_n_steps` steps is
+// traced with a ProfilerSession, and the op metrics of the last `max_samples`
+// traced steps are aggregated into OpMetricsDbs in the background.
+//
+// A step is not sampled while another step is being traced, or while the
+// process is being profiled explicitly.
+//
+// Thread-safety: SamplingProfiler is thread-safe.
+class SamplingProfiler {
+ public:
+  struct Options {
+    // Traces one in this many steps.
+    int64_t sample_every_n_steps = 1000;
+    // Number of traced steps whose op metrics are kept.
+    int max_samples = 16;
+  };
+
+  // Traces the current step while it is alive, if the step is sampled.
+  class ScopedStep {
+   public:
+    // Does not trace the step if `profiler` is nullptr.
+    explicit ScopedStep(SamplingProfiler* profiler);
+    ~ScopedStep();
+
+    bool sampled() const;
+
+   private:
+    SamplingProfiler* const profiler_;
+#if !defined(IS_MOBILE_PLATFORM)
+    std::unique_ptr<ProfilerSession> session_;
+#endif
+
+    ScopedStep(const ScopedStep&) = delete;
+    void operator=(const ScopedStep&) = delete;
+  };
+
+  explicit SamplingProfiler(const Options& options);
+  ~SamplingProfiler();
+
+  // Returns the profiler that samples the steps of DirectSession, or nullptr
+  // if sampling is disabled. It is enabled by setting the environment variable
+  // TF_SAMPLING_PROFILER_STEPS to the `sample_every_n_steps` to use, and
+  // TF_SAMPLING_PROFILER_MAX_SAMPLES sets `max_samples`.
+  static SamplingProfiler* Global();
+
+  // Returns the metrics of the host and device ops aggregated over the kept
+  // steps.
+  OpMetricsDb GetHostOpMetricsDb() const;
+  OpMetricsDb GetDeviceOpMetricsDb() const;
+
+  // Returns the total number of steps aggregated so far.
+  int64_t num_sampled_steps() const;
+
+  // Blocks until the steps traced so far are aggregated.
+  void Flush();
+
+ private:
+  struct Sample {
+    OpMetricsDb host_op_metrics_db;
+    OpMetricsDb device_op_metrics_db;
+  };
+
+#if !defined(IS_MOBILE_PLATFORM)
+  // Starts tracing the current step if it is sampled, and returns nullptr
+  // otherwise.
+  std::unique_ptr<ProfilerSession> MaybeStartSession();
+
+  // Stops tracing the step traced by `session`, and aggregates its op metrics
+  // in the background.
+  void EndSession(std::unique_ptr<ProfilerSession> session);
+#endif
+
+  const Options options_;
+  std::atomic<int64_t> step_count_{0};
+  // Whether a step is being traced.
+  std::atomic<bool> tracing_{false};
+  // Converts the traces to op metrics.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  mutable mutex mu_;
+  condition_variable pending_cv_;
+  int num_pending_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<Sample> samples_ TF_GUARDED_BY(mu_);
+  int64_t num_sampled_steps_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_SAMPLING_PROFILER_H_
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/sampling_profiler.h"
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TEST(SamplingProfilerTest, AggregatesSampledSteps) {
+  SamplingProfiler::Options options;
+  options.sample_every_n_steps = 2;
+  options.max_samples = 2;
+  SamplingProfiler profiler(options);
+  for (int i = 0; i < 8; ++i) {
+    SamplingProfiler::ScopedStep step(&profiler);
+    EXPECT_EQ(i % 2 == 0, step.sampled());
+    TraceMe trace_me("MatMul_1:MatMul");
+  }
+  profiler.Flush();
+  EXPECT_EQ(4, profiler.num_sampled_steps());
+
+  // Only the last two sampled steps are kept.
+  OpMetricsDb db = profiler.GetHostOpMetricsDb();
+  bool found = false;
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == "MatMul_1") {
+      found = true;
+      EXPECT_EQ("MatMul", metrics.category());
+      EXPECT_EQ(2, metrics.occurrences());
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST(SamplingProfilerTest, SkipsStepsWhileTracing) {
+  SamplingProfiler::Options options;
+  options.sample_every_n_steps = 1;
+  SamplingProfiler profiler(options);
+  SamplingProfiler::ScopedStep step(&profiler);
+  SamplingProfiler::ScopedStep concurrent_step(&profiler);
+  EXPECT_TRUE(step.sampled());
+  EXPECT_FALSE(concurrent_step.sampled());
+}
+
+TEST(SamplingProfilerTest, IgnoresNullProfiler) {
+  SamplingProfiler::ScopedStep step(nullptr);
+  EXPECT_FALSE(step.sampled());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -281,6 +281,26 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` like above, but allocates
+  /// the i-th fetched tensor with `fetch_allocators[i]` if not null, so that
+  /// it is produced straight into caller-owned memory, e.g. preregistered
+  /// pinned host or device buffers. An empty `fetch_allocators` allocates all
+  /// the fetched tensors as usual.
+  ///
+  /// A fetched tensor only comes from its allocator if the kernel producing
+  /// it allocates its output, rather than e.g. forwarding an input. The
+  /// allocator must return memory suitable for the device of that kernel.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Allocator*>& fetch_allocators) {
+    return absl::UnimplementedError(
+        "RunCallable with fetch allocators is not supported for this "
+        "session.");
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
@@ -134,6 +134,20 @@ BatchFunctionFallbackKernelBase::BatchFunctionFallbackKernelBase(
     return;
   }
 
+  if (c->HasAttr("enable_ragged_batching")) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr("enable_ragged_batching", &enable_ragged_batching_));
+  }
+  // Splitting a task would cut its sequence across batches, and the adaptive
+  // scheduler always splits large tasks.
+  OP_REQUIRES(c,
+              !(enable_ragged_batching_ && (enable_large_batch_splitting_ ||
+                                            enable_adaptive_batch_threads_)),
+              errors::InvalidArgument(
+                  "Ragged batching requires large batch splitting to be "
+                  "disabled and is not supported with the adaptive batch "
+                  "scheduler."));
+
   if (enable_adaptive_batch_threads_) {
     // One scheduler instance contains a couple of queue instances,
     // `batcher_queue_` is the key to find queue for this batch-op in the
@@ -81,6 +81,8 @@ class BatchFunctionFallbackKernelBase : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool disable_padding_;
+  // See `BatchResourceBase::set_enable_ragged_batching`.
+  bool enable_ragged_batching_ = false;
 
   // Parameters for adaptive batch scheduler only.
   // Note 'num_batch_threads_' above is shared by two implementations of batch
@@ -209,6 +211,7 @@ void BatchFunctionFallbackKernel<BatchResourceType>::ComputeAsync(
           max_enqueued_batches_, allowed_batch_sizes_, batch_function_,
           enable_large_batch_splitting_, disable_padding_, &new_resource);
       if (!status.ok()) return status;
+      new_resource->set_enable_ragged_batching(enable_ragged_batching_);
       if (c->session_metadata() != nullptr) {
         new_resource->set_session_metadata(*c->session_metadata());
       }
@@ -232,6 +235,14 @@ void BatchFunctionFallbackKernel<BatchResourceType>::ComputeAsync(
           "Provided BEF function doesn't match with BatchResource. Expected:",
           expected_name, " Received:", received_name)),
       done);
+  // The batch resource may have been created by another signature of the
+  // model, and the inputs of a ragged batch function differ.
+  OP_REQUIRES_ASYNC(
+      c, (*br)->get()->enable_ragged_batching() == enable_ragged_batching_,
+      errors::InvalidArgument(
+          "enable_ragged_batching doesn't match with BatchResource ",
+          shared_name_),
+      done);
   const uint64_t guid = random::New64();
   auto create_batch_task_fn = [c]() {
     return BatchResourceType::CreateBatchTask(c);
@@ -415,6 +415,7 @@ REGISTER_OP("_BatchFunctionFallback")
     .Attr("Tout: list(type)")
     .Attr("enable_large_batch_splitting: bool = false")
     .Attr("disable_padding: bool = false")
+    .Attr("enable_ragged_batching: bool = false")
     // An opaque function handle for the batch function.
     .Attr("opaque_function_handle: int")
     .SetShapeFn(shape_inference::UnknownShape);
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -25,18 +28,29 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+// In asynchronous mode, summaries are dropped once this many times max_queue
+// events, and at least kMinMaxPendingEvents, wait to be written.
+constexpr int kMaxPendingEventsPerQueueSize = 10;
+constexpr int kMinMaxPendingEvents = 100;
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  // In asynchronous mode, the events are serialized and written in batches by
+  // a background thread, so that writing summaries never blocks on the file.
+  SummaryFileWriter(int max_queue, int flush_millis, bool async, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        async_(async),
+        max_pending_(std::max(kMaxPendingEventsPerQueueSize * max_queue,
+                              kMinMaxPendingEvents)),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -56,13 +70,20 @@ class SummaryFileWriter : public SummaryWriterInterface {
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
     mutex_lock ml(mu_);
-    events_writer_ =
-        std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(uniquified_filename_suffix),
-        "Could not initialize events writer.");
+    {
+      mutex_lock writer_lock(writer_mu_);
+      events_writer_ =
+          std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(uniquified_filename_suffix),
+          "Could not initialize events writer.");
+    }
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (async_) {
+      writer_thread_.reset(env_->StartThread(
+          ThreadOptions(), "summary_file_writer", [this] { WriteLoop(); }));
+    }
     return OkStatus();
   }
 
@@ -71,11 +92,26 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    if (!async_) {
+      return InternalFlush();
+    }
+    const int64_t flush = ++num_requested_flushes_;
+    cv_.notify_all();
+    while (num_completed_flushes_ < flush) {
+      cv_.wait(ml);
+    }
+    return TakeWriteStatus();
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      stopping_ = true;
+      cv_.notify_all();
+    }
+    // Joins the thread.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -152,12 +188,27 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    if (async_ && queue_.size() >= max_pending_ && event->has_summary()) {
+      // The writer thread does not keep up, so drop the summary rather than
+      // block the caller. The other events, e.g. graphs, are always written.
+      if (num_dropped_summaries_++ % 1000 == 0) {
+        LOG(WARNING) << "Dropped " << num_dropped_summaries_
+                     << " summaries since " << max_pending_
+                     << " events wait to be written to the events file.";
+      }
+      return TakeWriteStatus();
+    }
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      if (!async_) {
+        return InternalFlush();
+      }
+      ++num_requested_flushes_;
+      last_flush_ = env_->NowMicros();
+      cv_.notify_all();
     }
-    return OkStatus();
+    return async_ ? TakeWriteStatus() : OkStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -168,25 +219,78 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    const Status status = WriteBatch(queue_);
+    queue_.clear();
+    TF_RETURN_IF_ERROR(status);
+    last_flush_ = env_->NowMicros();
+    return OkStatus();
+  }
+
+  // Writes the events and flushes the events file.
+  Status WriteBatch(const std::vector<std::unique_ptr<Event>>& batch)
+      TF_LOCKS_EXCLUDED(writer_mu_) {
+    mutex_lock ml(writer_mu_);
+    for (const std::unique_ptr<Event>& e : batch) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return OkStatus();
   }
 
+  // Writes the queued events whenever a flush is requested, until the writer
+  // is destroyed. Runs on writer_thread_.
+  void WriteLoop() TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      std::vector<std::unique_ptr<Event>> batch;
+      int64_t flush;
+      {
+        mutex_lock ml(mu_);
+        while (num_completed_flushes_ == num_requested_flushes_ &&
+               !stopping_) {
+          cv_.wait(ml);
+        }
+        if (num_completed_flushes_ == num_requested_flushes_) return;
+        flush = num_requested_flushes_;
+        batch.swap(queue_);
+      }
+      const Status status = WriteBatch(batch);
+      mutex_lock ml(mu_);
+      write_status_.Update(status);
+      num_completed_flushes_ = flush;
+      cv_.notify_all();
+    }
+  }
+
+  // Returns the first error of the writer thread since the last call.
+  Status TakeWriteStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status status = write_status_;
+    write_status_ = OkStatus();
+    return status;
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
+  const bool async_;
+  const size_t max_pending_;
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // The state of the writer thread in asynchronous mode. Flushes are numbered,
+  // and WriteLoop() completes every flush requested before a batch it writes.
+  condition_variable cv_;
+  int64_t num_requested_flushes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_completed_flushes_ TF_GUARDED_BY(mu_) = 0;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  Status write_status_ TF_GUARDED_BY(mu_);
+  int64_t num_dropped_summaries_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<Thread> writer_thread_;
+  // Acquired after mu_, if both are acquired.
+  mutex writer_mu_ TF_ACQUIRED_AFTER(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -197,7 +301,11 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  bool async = false;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_ASYNC_SUMMARY_WRITER", false, &async));
+  SummaryFileWriter* w =
+      new SummaryFileWriter(max_queue, flush_millis, async, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
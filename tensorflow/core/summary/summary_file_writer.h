@@ -33,6 +33,11 @@ namespace tensorflow {
 /// filename_suffix. The caller owns a reference to result if the
 /// returned status is ok. The Env object must not be destroyed until
 /// after the returned writer.
+///
+/// If the environment variable TF_ASYNC_SUMMARY_WRITER is true, the summaries
+/// are serialized and written by a background thread instead, and summaries
+/// are dropped rather than block the caller when too many are pending.
+/// Flush() still waits until the queued summaries are written.
 Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
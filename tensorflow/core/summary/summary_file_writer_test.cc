@@ -281,5 +281,47 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+TEST_F(SummaryFileWriterTest, WriteAsynchronously) {
+  const string test_name = "async_test";
+  setenv("TF_ASYNC_SUMMARY_WRITER", "1", 1);
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(), test_name,
+                                      &env_, &writer));
+  unsetenv("TF_ASYNC_SUMMARY_WRITER");
+  {
+    core::ScopedUnref deleter(writer);
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    for (int step = 0; step < 50; ++step) {
+      TF_CHECK_OK(writer->WriteScalar(step, one, "name"));
+    }
+    TF_CHECK_OK(writer->Flush());
+  }
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  files.erase(std::remove_if(files.begin(), files.end(),
+                             [test_name](string f) {
+                               return !absl::StrContains(f, test_name);
+                             }),
+              files.end());
+  ASSERT_EQ(files.size(), 1);
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env_.NewRandomAccessFile(
+      io::JoinPath(testing::TmpDir(), files[0]), &read_file));
+  io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+  tstring record;
+  uint64 offset = 0;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The file version.
+  // All the events are written, in order.
+  for (int step = 0; step < 50; ++step) {
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    Event e;
+    ASSERT_TRUE(e.ParseFromString(record));
+    EXPECT_EQ(e.step(), step);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <string>
 
@@ -68,6 +70,37 @@ Status CostRecorder::WriteToFile() const {
                                     measured_cost_path, op_cost_map_proto);
 }
 
+double CostRecorder::RelativeDrift(const CostRecorder& baseline) const {
+  absl::flat_hash_map<int64_t, uint64_t> avg_op_costs;
+  {
+    tf_shared_lock l(op_cost_map_mutex_);
+    for (const auto& [op_key, op_cost] : op_cost_map_) {
+      avg_op_costs[op_key] = op_cost.first / op_cost.second;
+    }
+  }
+
+  double total_diff = 0;
+  double total_baseline_cost = 0;
+  {
+    tf_shared_lock l(baseline.op_cost_map_mutex_);
+    for (const auto& [op_key, avg_op_cost] : avg_op_costs) {
+      const auto iter = baseline.op_cost_map_.find(op_key);
+      if (iter == baseline.op_cost_map_.end()) {
+        total_diff += avg_op_cost;
+        continue;
+      }
+      const double baseline_cost = iter->second.first / iter->second.second;
+      total_diff += std::abs(static_cast<double>(avg_op_cost) - baseline_cost);
+      total_baseline_cost += baseline_cost;
+    }
+  }
+
+  if (total_baseline_cost == 0) {
+    return total_diff == 0 ? 0 : std::numeric_limits<double>::infinity();
+  }
+  return total_diff / total_baseline_cost;
+}
+
 size_t CostRecorder::size() const {
   tf_shared_lock l(op_cost_map_mutex_);
   return op_cost_map_.size();
@@ -47,6 +47,14 @@ class CostRecorder {
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
   Status WriteToFile() const;
 
+  // Returns how far the average execution durations recorded here drifted
+  // from those in `baseline`, i.e. the sum of the absolute differences of the
+  // average durations of the ops recorded here, divided by the sum of their
+  // average durations in `baseline`. Ops without a baseline count fully.
+  // Returns infinity if `baseline` has no record for any of these ops, unless
+  // there is no record here either.
+  double RelativeDrift(const CostRecorder& baseline) const;
+
   size_t size() const;
 
   static const char* MesuredCostPathEnvVarName() {
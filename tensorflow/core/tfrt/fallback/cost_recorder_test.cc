@@ -56,6 +56,26 @@ TEST(CostRecorderTest, GetCostDefaultValueTest) {
             std::numeric_limits<uint32_t>::max());
 }
 
+TEST(CostRecorderTest, RelativeDriftTest) {
+  CostRecorder baseline;
+  baseline.RecordCost(kTestOpKey, 100);
+  baseline.RecordCost(kTestOpKey + 1, 300);
+
+  CostRecorder recorder;
+  recorder.RecordCost(kTestOpKey, 100);
+  recorder.RecordCost(kTestOpKey + 1, 200);
+  EXPECT_DOUBLE_EQ(recorder.RelativeDrift(baseline), 0.25);
+  EXPECT_DOUBLE_EQ(baseline.RelativeDrift(baseline), 0);
+
+  // Ops missing in the baseline count fully.
+  recorder.RecordCost(kTestOpKey + 2, 100);
+  EXPECT_DOUBLE_EQ(recorder.RelativeDrift(baseline), 0.5);
+
+  EXPECT_EQ(recorder.RelativeDrift(CostRecorder()),
+            std::numeric_limits<double>::infinity());
+  EXPECT_DOUBLE_EQ(CostRecorder().RelativeDrift(CostRecorder()), 0);
+}
+
 TEST(CostRecorderTest, WriteToFileTest) {
   CostRecorder recorder;
   ASSERT_EQ(recorder.size(), 0);
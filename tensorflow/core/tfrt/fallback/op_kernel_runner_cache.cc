@@ -20,9 +20,37 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/hash/hash.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+// The capacity of the first table of runners.
+constexpr size_t kInitialTableCapacity = 16;
+
+}  // namespace
+
+/*static*/ OpKernelRunner* OpKernelRunnerCache::Find(const Table* table,
+                                                     const OpLocationKey& key) {
+  if (table == nullptr) return nullptr;
+  for (size_t i = absl::Hash<OpLocationKey>()(key) & table->mask;;
+       i = (i + 1) & table->mask) {
+    const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr) return nullptr;
+    if (entry->key == key) return entry->runner.get();
+  }
+}
+
+/*static*/ void OpKernelRunnerCache::Insert(Table* table, const Entry* entry) {
+  for (size_t i = absl::Hash<OpLocationKey>()(entry->key) & table->mask;;
+       i = (i + 1) & table->mask) {
+    if (table->slots[i].load(std::memory_order_relaxed) == nullptr) {
+      table->slots[i].store(entry, std::memory_order_release);
+      return;
+    }
+  }
+}
 
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -32,21 +60,17 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     const tensorflow::ProcessFunctionLibraryRuntime&
         process_function_library_runtime) {
   OpLocationKey key(loc);
-  {
-    tf_shared_lock lock(mu_);
-    auto it = map_.find(key);
-    if (it != map_.end()) {
-      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
-    }
+  if (auto* runner = Find(table_.load(std::memory_order_acquire), key)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
   }
 
   mutex_lock lock(mu_);
 
-  auto it = map_.find(key);
-  if (it != map_.end()) {
-    DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-    return it->second.get();
+  Table* table = table_.load(std::memory_order_relaxed);
+  if (auto* runner = Find(table, key)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
@@ -60,13 +84,23 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
                        op_name, node_name, device_name, num_args, attr_builder,
                        device_manager, process_function_library_runtime));
 
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
+  entries_.push_back(std::make_unique<Entry>(
+      Entry{key, std::make_unique<OpKernelRunner>(std::move(runner))}));
+  const Entry* entry = entries_.back().get();
 
-  auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
-  DCHECK(r);
+  if (table == nullptr || 2 * entries_.size() > table->mask + 1) {
+    auto new_table = std::make_unique<Table>(
+        table == nullptr ? kInitialTableCapacity : 2 * (table->mask + 1));
+    for (const auto& e : entries_) {
+      Insert(new_table.get(), e.get());
+    }
+    table_.store(new_table.get(), std::memory_order_release);
+    tables_.push_back(std::move(new_table));
+  } else {
+    Insert(table, entry);
+  }
 
-  return runner_ptr;
+  return entry->runner.get();
 }
 
 }  // namespace tfrt_stub
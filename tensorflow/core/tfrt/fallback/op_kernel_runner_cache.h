@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
@@ -46,7 +48,9 @@ class OpLocationKey {
   tfrt::Location loc_;
 };
 
-// OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+// OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe. The
+// lookups of existing runners do not take a lock, as they vastly outnumber the
+// creations of runners, which happen once per location.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
@@ -60,9 +64,38 @@ class OpKernelRunnerCache {
           process_function_library_runtime);
 
  private:
+  struct Entry {
+    OpLocationKey key;
+    std::unique_ptr<OpKernelRunner> runner;
+  };
+
+  // An open-addressing hash table of entries, at most half full. Its slots are
+  // only filled, under mu_, so lookups can probe them without synchronization.
+  struct Table {
+    explicit Table(size_t capacity)
+        : slots(new std::atomic<const Entry*>[capacity]()),
+          mask(capacity - 1) {}
+
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+    const size_t mask;
+  };
+
+  // Returns the runner of `key` in `table`, or null if there is none.
+  static OpKernelRunner* Find(const Table* table, const OpLocationKey& key);
+
+  // Adds `entry` to `table`, which must have an empty slot.
+  static void Insert(Table* table, const Entry* entry);
+
+  // The current table. Once it would be more than half full, its entries are
+  // moved to a new table of twice the capacity.
+  std::atomic<Table*> table_{nullptr};
+
   mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
-      TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<const Entry>> entries_ TF_GUARDED_BY(mu_);
+  // All the published tables, as concurrent lookups may still read the
+  // previous ones. Their total capacity is at most twice that of the current
+  // table.
+  std::vector<std::unique_ptr<Table>> tables_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tfrt_stub
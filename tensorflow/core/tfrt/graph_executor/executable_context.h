@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
+#include "tsl/platform/file_system.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
 #include "tfrt/bef_executor/bef_file.h"  // from @tf_runtime
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
@@ -35,6 +36,12 @@ struct ExecutableContext {
       : bytecode_buffer(std::move(bytecode_buffer)),
         bytecode_executable(std::move(bytecode_executable)) {}
 
+  // For bytecode in a read-only memory region, e.g. of a client graph bundle.
+  ExecutableContext(std::unique_ptr<tsl::ReadOnlyMemoryRegion> bytecode_region,
+                    std::unique_ptr<mlrt::LoadedExecutable> bytecode_executable)
+      : bytecode_region(std::move(bytecode_region)),
+        bytecode_executable(std::move(bytecode_executable)) {}
+
   ExecutableContext(tfrt::BefBuffer bef,
                     tfrt::RCReference<tfrt::BEFFile> bef_file)
       : bef(std::move(bef)), bef_file(std::move(bef_file)) {}
@@ -45,6 +52,8 @@ struct ExecutableContext {
 
   // For the MLRT path.
   mlrt::bc::Buffer bytecode_buffer;
+  // Holds the bytecode instead of `bytecode_buffer` if it is memory-mapped.
+  std::unique_ptr<tsl::ReadOnlyMemoryRegion> bytecode_region;
   std::unique_ptr<mlrt::LoadedExecutable> bytecode_executable;
 
   // For the TFRT path.
@@ -96,6 +96,16 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // Upon reset, the executable is only recompiled if the recorded op costs
+    // drifted from the ones it was compiled with by more than this fraction
+    // (see `CostRecorder::RelativeDrift()`). 0 means always recompile.
+    double recompilation_drift_threshold = 0;
+
+    // If true, the recompilation upon reset runs on the work queue of the
+    // runtime instead of delaying the run that triggered it. The runs keep
+    // using the previous executable until the new one is swapped in.
+    bool recompile_in_background = false;
   };
 
   CostAnalysisOptions cost_analysis_options;
@@ -104,6 +114,12 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool enable_mlrt = false;
 
+  // If true, the batch functions of all signatures share the batchers of the
+  // graph executor, keyed by their `shared_name`, instead of each loaded client
+  // graph having its own. So the signatures invoking the same batched function
+  // of a model fill the same batches.
+  bool share_batching_across_signatures = false;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -51,10 +52,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -65,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_utils.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/graph_executor/client_graph_bundle.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/export_mlir.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
@@ -97,6 +104,7 @@ limitations under the License.
 #include "tfrt/host_context/host_context.h"  // from @tf_runtime
 #include "tfrt/host_context/request_deadline_tracker.h"  // from @tf_runtime
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
+#include "tfrt/host_context/task_function.h"  // from @tf_runtime
 #include "tfrt/support/forward_decls.h"  // from @tf_runtime
 #include "tfrt/support/ref_count.h"  // from @tf_runtime
 #include "tfrt/support/string_util.h"  // from @tf_runtime
@@ -217,9 +225,14 @@ StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
     request_info->request_queue = work_queue;
   } else {
     request_id = GetNextStepId().id;
-    // Otherwise we use the global queue in `runtime`.
-    TF_ASSIGN_OR_RETURN(request_info->request_queue_owner,
-                        runtime.CreateRequestQueue(request_id));
+    // Otherwise we use the global queue in `runtime`, which may schedule the
+    // request by its priority and deadline.
+    WorkQueueInterface::RequestOptions request_queue_options;
+    request_queue_options.priority = run_options.priority;
+    request_queue_options.deadline = run_options.deadline;
+    TF_ASSIGN_OR_RETURN(
+        request_info->request_queue_owner,
+        runtime.CreateRequestQueue(request_id, request_queue_options));
     request_info->request_queue = request_info->request_queue_owner.get();
   }
   auto* request_queue = request_info->request_queue;
@@ -247,8 +260,11 @@ StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
               &process_function_library_runtime);
 
   fallback_request_state.set_cost_recorder(cost_recorder);
+  // The batch kernels fall back to the per-graph-executor resource context
+  // when there is no client graph one.
   fallback_request_state.set_client_graph_resource_context(
-      client_graph_resource_context);
+      options.share_batching_across_signatures ? nullptr
+                                               : client_graph_resource_context);
   fallback_request_state.set_runtime_config(&options.runtime_config);
   fallback_request_state.set_cancellation_manager(
       &request_info->cancellation_manager);
@@ -468,6 +484,13 @@ GraphExecutor::GraphExecutor(
   SetSessionCreatedMetric();
 }
 
+GraphExecutor::~GraphExecutor() {
+  tensorflow::mutex_lock lock(background_recompilations_mu_);
+  while (num_background_recompilations_ > 0) {
+    background_recompilations_cv_.wait(lock);
+  }
+}
+
 StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
     Options options, std::unique_ptr<FallbackState> fallback_state,
     std::unique_ptr<tfrt::ResourceContext> resource_context,
@@ -525,6 +548,88 @@ void CreateSortedNamesAndOriginalIndices(absl::Span<const std::string> names,
   }
 }
 
+// Returns the name of the client graph with the given sorted names, in the
+// format illustrated as in the following example:
+// input1-input2^output1-output2^target1-target2
+std::string JoinClientGraphName(
+    absl::Span<const std::string> input_tensor_names,
+    absl::Span<const std::string> output_tensor_names,
+    absl::Span<const std::string> target_tensor_names) {
+  return absl::StrCat(
+      absl::StrJoin(input_tensor_names, kTensorNameJoiningDelimiter),
+      kArgumentTypeJoiningDelimiter,
+      absl::StrJoin(output_tensor_names, kTensorNameJoiningDelimiter),
+      kArgumentTypeJoiningDelimiter,
+      absl::StrJoin(target_tensor_names, kTensorNameJoiningDelimiter));
+}
+
+GraphExecutor::ClientGraph CreateClientGraph(
+    std::string name, absl::Span<const std::string> input_tensor_names,
+    absl::Span<const tensorflow::DataType> input_tensor_dtypes,
+    absl::Span<const std::string> output_tensor_names,
+    absl::Span<const std::string> target_tensor_names) {
+  tensorflow::GraphImportConfig::InputArrays input_nodes;
+  DCHECK_EQ(input_tensor_names.size(), input_tensor_dtypes.size());
+  for (int i = 0; i < input_tensor_names.size(); ++i) {
+    const auto& input_name = input_tensor_names[i];
+    auto input_dtype = input_tensor_dtypes[i];
+
+    tensorflow::ArrayInfo array_info;
+    array_info.imported_dtype = input_dtype;
+    array_info.shape.set_unknown_rank(true);
+    input_nodes[input_name] = array_info;
+  }
+  return GraphExecutor::ClientGraph{
+      std::move(name),
+      std::move(input_nodes),
+      {output_tensor_names.begin(), output_tensor_names.end()},
+      {target_tensor_names.begin(), target_tensor_names.end()}};
+}
+
+// Sorts the names of `client_graph` the same way as `GraphExecutor::Run`.
+void SortClientGraphNames(ClientGraphBundle::ClientGraph& client_graph) {
+  std::vector<std::string> input_names(client_graph.input_names().begin(),
+                                       client_graph.input_names().end());
+  std::vector<std::string> sorted_input_names;
+  std::vector<int> input_original_indices;
+  CreateSortedNamesAndOriginalIndices(input_names, sorted_input_names,
+                                      input_original_indices);
+  std::vector<int> input_dtypes(client_graph.input_dtypes().begin(),
+                                client_graph.input_dtypes().end());
+  client_graph.clear_input_names();
+  client_graph.clear_input_dtypes();
+  for (int i = 0; i < sorted_input_names.size(); ++i) {
+    client_graph.add_input_names(sorted_input_names[i]);
+    client_graph.add_input_dtypes(static_cast<tensorflow::DataType>(
+        input_dtypes.at(input_original_indices[i])));
+  }
+  std::sort(client_graph.mutable_output_names()->begin(),
+            client_graph.mutable_output_names()->end());
+  std::sort(client_graph.mutable_target_names()->begin(),
+            client_graph.mutable_target_names()->end());
+}
+
+constexpr char kClientGraphBundleManifest[] = "client_graph_bundle.pb";
+
+// Returns a fingerprint of the graph that the client graphs of a bundle are
+// compiled from, or 0 if there is none.
+uint64_t GraphFingerprint(const GraphDef* graph_def) {
+  if (graph_def == nullptr) return 0;
+  std::string serialized;
+  SerializeToStringDeterministic(*graph_def, &serialized);
+  return Fingerprint64(serialized);
+}
+
+// Returns a fingerprint of the options that affect the compilation of client
+// graphs.
+uint64_t OptionsFingerprint(const GraphExecutionOptions& options) {
+  std::ostringstream os;
+  os << options.compile_options << ";" << options.enable_mlrt << ";"
+     << options.run_placer_grappler_on_functions << ";"
+     << options.enable_grappler_function_optimizer;
+  return Fingerprint64(os.str());
+}
+
 }  // namespace
 
 tensorflow::Status GraphExecutor::Run(
@@ -612,13 +717,36 @@ tensorflow::Status GraphExecutor::Run(
       cost_recorder));
 
   if (do_recompilation) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
-    tensorflow::mutex_lock l(num_recompilations_mu_);
-    num_recompilations_ += 1;
-  }
-  if (cost_recorder != nullptr) {
-    loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+    if (options_.cost_analysis_options.recompile_in_background) {
+      // `cost_recorder` stays alive until the next cycle starts, which is after
+      // the recompilation.
+      {
+        tensorflow::mutex_lock lock(background_recompilations_mu_);
+        ++num_background_recompilations_;
+      }
+      auto recompile = [this, &loaded_client_graph, cost_recorder, now]() {
+        Status status =
+            RecompileWithCosts(loaded_client_graph, *cost_recorder, now);
+        if (!status.ok()) {
+          LOG(ERROR) << "TFRT failed to recompile loaded client graph "
+                     << loaded_client_graph.name() << ": " << status;
+        }
+        tensorflow::mutex_lock lock(background_recompilations_mu_);
+        if (--num_background_recompilations_ == 0) {
+          background_recompilations_cv_.notify_all();
+        }
+      };
+      auto task = runtime().work_queue()->AddBlockingTask(
+          tfrt::TaskFunction(recompile), /*allow_queuing=*/true);
+      // Recompile inline if the work queue does not accept the task.
+      if (task.has_value()) (*task)();
+    } else {
+      TF_RETURN_IF_ERROR(
+          RecompileWithCosts(loaded_client_graph, *cost_recorder, now));
+    }
+  } else if (cost_recorder != nullptr) {
+    loaded_client_graph.UpdateCostAnalysisData(now, /*do_recompilation=*/false,
+                                               /*recompiled=*/false);
   }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -862,18 +990,10 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
     absl::Span<const std::string> target_tensor_names,
     tensorflow::tfrt_stub::WorkQueueInterface* work_queue,
     std::optional<const std::string> graph_name) {
-  // The format of the joined name is illustrated as in the following example:
-  // input1-input2^output1-output2^target1-target2
   const auto joined_name =
-      graph_name
-          ? *graph_name
-          : absl::StrCat(
-                absl::StrJoin(input_tensor_names, kTensorNameJoiningDelimiter),
-                kArgumentTypeJoiningDelimiter,
-                absl::StrJoin(output_tensor_names, kTensorNameJoiningDelimiter),
-                kArgumentTypeJoiningDelimiter,
-                absl::StrJoin(target_tensor_names,
-                              kTensorNameJoiningDelimiter));
+      graph_name ? *graph_name
+                 : JoinClientGraphName(input_tensor_names, output_tensor_names,
+                                       target_tensor_names);
 
   tensorflow::mutex_lock l(loaded_client_graphs_mu_);
 
@@ -889,22 +1009,9 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
   }
 
   // Cache miss; populate a `ClientGraph` and load it.
-  tensorflow::GraphImportConfig::InputArrays input_nodes;
-  DCHECK_EQ(input_tensor_names.size(), input_tensor_dtypes.size());
-  for (int i = 0; i < input_tensor_names.size(); ++i) {
-    const auto& input_name = input_tensor_names[i];
-    auto input_dtype = input_tensor_dtypes[i];
-
-    tensorflow::ArrayInfo array_info;
-    array_info.imported_dtype = input_dtype;
-    array_info.shape.set_unknown_rank(true);
-    input_nodes[input_name] = array_info;
-  }
-  ClientGraph client_graph{
-      joined_name,
-      std::move(input_nodes),
-      {output_tensor_names.begin(), output_tensor_names.end()},
-      {target_tensor_names.begin(), target_tensor_names.end()}};
+  ClientGraph client_graph =
+      CreateClientGraph(joined_name, input_tensor_names, input_tensor_dtypes,
+                        output_tensor_names, target_tensor_names);
   TF_ASSIGN_OR_RETURN(auto loaded_client_graph,
                       LoadClientGraph(client_graph, work_queue));
 
@@ -982,6 +1089,38 @@ CostRecorder* GraphExecutor::LoadedClientGraph::MaybeGetCostRecorder(
   return nullptr;
 }
 
+Status GraphExecutor::RecompileWithCosts(LoadedClientGraph& loaded_client_graph,
+                                         const CostRecorder& cost_recorder,
+                                         absl::Time now) {
+  const bool recompile = loaded_client_graph.CostsDrifted(
+      cost_recorder,
+      options_.cost_analysis_options.recompilation_drift_threshold);
+  Status status;
+  if (recompile) {
+    status = loaded_client_graph.UpdateCost(cost_recorder, runtime());
+    if (status.ok()) {
+      tensorflow::mutex_lock l(num_recompilations_mu_);
+      num_recompilations_ += 1;
+    }
+  } else {
+    VLOG(1) << "TFRT skipping recompilation of loaded client graph "
+            << loaded_client_graph.name() << " as its op costs did not drift";
+  }
+  loaded_client_graph.UpdateCostAnalysisData(now, /*do_recompilation=*/true,
+                                             recompile && status.ok());
+  return status;
+}
+
+bool GraphExecutor::LoadedClientGraph::CostsDrifted(
+    const CostRecorder& cost_recorder, double threshold) const {
+  tensorflow::mutex_lock lock(cost_analysis_data_.mu);
+  if (threshold <= 0 || cost_analysis_data_.compiled_cost_recorder == nullptr) {
+    return true;
+  }
+  return cost_recorder.RelativeDrift(
+             *cost_analysis_data_.compiled_cost_recorder) > threshold;
+}
+
 Status GraphExecutor::LoadedClientGraph::UpdateCost(
     const CostRecorder& cost_recorder, const Runtime& runtime) {
   LOG(INFO) << "TFRT updating op costs of loaded client graph (" << this << ") "
@@ -1066,7 +1205,11 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
               return OkStatus();
             }}) {
   const auto& options = graph_executor_->options().cost_analysis_options;
-  if (options.version != Options::CostAnalysisOptions::kDisabled) {
+  // The client graphs loaded from a bundle have no MLIR to recompile.
+  const bool has_mlir = executable_context_->IsForMlrt()
+                            ? static_cast<bool>(tf_mlir_with_op_keys)
+                            : static_cast<bool>(tfrt_mlir);
+  if (options.version != Options::CostAnalysisOptions::kDisabled && has_mlir) {
     // Initialize in a way that ensures recompilation on the first run.
     cost_analysis_data_.start_time = absl::Now() - options.reset_interval;
     cost_analysis_data_.is_available = true;
@@ -1082,7 +1225,7 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
 }
 
 void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
-    absl::Time now, bool do_recompilation) {
+    absl::Time now, bool do_recompilation, bool recompiled) {
   tensorflow::mutex_lock lock(cost_analysis_data_.mu);
   if (!do_recompilation) {
     cost_analysis_data_.num_cost_updates += 1;
@@ -1097,7 +1240,12 @@ void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
     cost_analysis_data_.tf_mlir_with_op_keys = nullptr;
     cost_analysis_data_.cost_recorder = nullptr;
   } else {
-    // Update cost analysis data.
+    // Update cost analysis data, keeping the costs of the recompilation to
+    // measure their drift.
+    if (recompiled) {
+      cost_analysis_data_.compiled_cost_recorder =
+          std::move(cost_analysis_data_.cost_recorder);
+    }
     cost_analysis_data_.cost_recorder = std::make_unique<CostRecorder>();
     cost_analysis_data_.is_available = true;
     cost_analysis_data_.start_time = now;
@@ -1118,6 +1266,118 @@ tensorflow::Status GraphExecutor::CompileGraph(
       .status();
 }
 
+tensorflow::Status GraphExecutor::ExportClientGraphBundle(
+    absl::Span<const ClientGraphBundle::ClientGraph> client_graphs,
+    const std::string& bundle_dir) {
+  if (!options_.enable_mlrt) {
+    return absl::UnimplementedError(
+        "Client graph bundles are only supported in MLRT.");
+  }
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(bundle_dir));
+
+  ClientGraphBundle bundle;
+  bundle.set_graph_fingerprint(
+      GraphFingerprint(graph_execution_state_->original_graph_def()));
+  bundle.set_options_fingerprint(OptionsFingerprint(options_));
+  for (const auto& client_graph_spec : client_graphs) {
+    ClientGraphBundle::ClientGraph& exported = *bundle.add_client_graphs();
+    exported = client_graph_spec;
+    SortClientGraphNames(exported);
+    std::vector<std::string> input_names(exported.input_names().begin(),
+                                         exported.input_names().end());
+    std::vector<tensorflow::DataType> input_dtypes;
+    for (int dtype : exported.input_dtypes()) {
+      input_dtypes.push_back(static_cast<tensorflow::DataType>(dtype));
+    }
+    std::vector<std::string> output_names(exported.output_names().begin(),
+                                          exported.output_names().end());
+    std::vector<std::string> target_names(exported.target_names().begin(),
+                                          exported.target_names().end());
+    ClientGraph client_graph = CreateClientGraph(
+        JoinClientGraphName(input_names, output_names, target_names),
+        input_names, input_dtypes, output_names, target_names);
+    TF_ASSIGN_OR_RETURN(auto loaded_client_graph,
+                        ImportAndCompileClientGraph(client_graph));
+
+    const mlrt::bc::Buffer& bytecode =
+        loaded_client_graph->executable_context()->bytecode_buffer;
+    exported.set_bytecode_file(
+        absl::StrCat("client_graph_", bundle.client_graphs_size() - 1,
+                     ".mlrt"));
+    TF_RETURN_IF_ERROR(WriteStringToFile(
+        env, tensorflow::io::JoinPath(bundle_dir, exported.bytecode_file()),
+        absl::string_view(bytecode.data(), bytecode.size())));
+    *exported.mutable_library() = loaded_client_graph->flib_def().ToProto();
+    LOG(INFO) << "TFRT exported client graph " << client_graph.name << " to "
+              << exported.bytecode_file();
+  }
+  return WriteBinaryProto(
+      env, tensorflow::io::JoinPath(bundle_dir, kClientGraphBundleManifest),
+      bundle);
+}
+
+tensorflow::Status GraphExecutor::LoadClientGraphBundle(
+    const std::string& bundle_dir) {
+  if (!options_.enable_mlrt || kernel_registry_ == nullptr) {
+    return absl::UnimplementedError(
+        "Client graph bundles are only supported in MLRT.");
+  }
+  Env* env = Env::Default();
+  ClientGraphBundle bundle;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(
+      env, tensorflow::io::JoinPath(bundle_dir, kClientGraphBundleManifest),
+      &bundle));
+  if (bundle.graph_fingerprint() !=
+      GraphFingerprint(graph_execution_state_->original_graph_def())) {
+    return errors::FailedPrecondition("The client graph bundle in ", bundle_dir,
+                                      " was compiled from another graph.");
+  }
+  if (bundle.options_fingerprint() != OptionsFingerprint(options_)) {
+    return errors::FailedPrecondition("The client graph bundle in ", bundle_dir,
+                                      " was compiled with other options.");
+  }
+
+  for (const auto& client_graph : bundle.client_graphs()) {
+    std::vector<std::string> input_names(client_graph.input_names().begin(),
+                                         client_graph.input_names().end());
+    std::vector<std::string> output_names(client_graph.output_names().begin(),
+                                          client_graph.output_names().end());
+    std::vector<std::string> target_names(client_graph.target_names().begin(),
+                                          client_graph.target_names().end());
+    std::string name =
+        JoinClientGraphName(input_names, output_names, target_names);
+
+    // The bytecode is read lazily through the page cache, instead of being
+    // copied to the heap.
+    std::unique_ptr<ReadOnlyMemoryRegion> bytecode_region;
+    TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(
+        tensorflow::io::JoinPath(bundle_dir, client_graph.bytecode_file()),
+        &bytecode_region));
+    mlrt::bc::Executable executable(
+        static_cast<const char*>(bytecode_region->data()));
+    auto bytecode_executable =
+        std::make_unique<mlrt::LoadedExecutable>(executable, *kernel_registry_);
+    auto executable_context = std::make_shared<ExecutableContext>(
+        std::move(bytecode_region), std::move(bytecode_executable));
+
+    FunctionLibraryDefinition flib_def(OpRegistry::Global(),
+                                       client_graph.library());
+    auto loaded_client_graph = std::make_unique<LoadedClientGraph>(
+        name, SymbolUids(), this, std::make_unique<mlir::MLIRContext>(),
+        /*tf_mlir_with_op_keys=*/nullptr, /*tfrt_mlir=*/nullptr,
+        std::move(executable_context), /*stream_callback_id=*/std::nullopt,
+        std::move(flib_def));
+    TF_RETURN_IF_ERROR(InitBytecode(loaded_client_graph.get()));
+
+    tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+    loaded_client_graphs_.try_emplace(name, std::move(loaded_client_graph));
+  }
+  LOG(INFO) << "TFRT loaded " << bundle.client_graphs_size()
+            << " client graphs from " << bundle_dir;
+  return OkStatus();
+}
+
 void RegisterMlirDialect(mlir::DialectRegistry& registry) {
   registry.insert<mlir::BuiltinDialect, mlir::func::FuncDialect>();
   mlir::RegisterAllTensorFlowDialects(registry);
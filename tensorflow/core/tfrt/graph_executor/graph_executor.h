@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/graph_executor/client_graph_bundle.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
@@ -153,9 +154,17 @@ class GraphExecutor {
     // `cost_recorder`.
     Status UpdateCost(const CostRecorder& cost_recorder,
                       const Runtime& runtime);
+    // Returns whether the costs in `cost_recorder` drifted by more than
+    // `threshold` from the costs the executable was last recompiled with.
+    // Always true before the first recompilation or if `threshold` is not
+    // positive.
+    bool CostsDrifted(const CostRecorder& cost_recorder,
+                      double threshold) const;
     // Updates `cost_analysis_data_` to make it accurate for the next execution.
-    // Assumes a cost update occurred this cycle.
-    void UpdateCostAnalysisData(absl::Time now, bool do_recompilation);
+    // Assumes a cost update occurred this cycle. `recompiled` tells whether
+    // `UpdateCost()` was called with the costs of this cycle.
+    void UpdateCostAnalysisData(absl::Time now, bool do_recompilation,
+                                bool recompiled);
     // Getters.
     std::shared_ptr<ExecutableContext> executable_context() const {
       tensorflow::mutex_lock lock(executable_context_mu_);
@@ -177,6 +186,8 @@ class GraphExecutor {
       return pflr_;
     }
 
+    const FunctionLibraryDefinition& flib_def() const { return flib_def_; }
+
    private:
     std::string name_;
     SymbolUids symbol_uids_;
@@ -199,6 +210,8 @@ class GraphExecutor {
       absl::Time start_time TF_GUARDED_BY(mu) = absl::Now();
       // Cost recordings within the current measurement cycle.
       int num_cost_updates TF_GUARDED_BY(mu) = 0;
+      // The costs used by the last recompilation, if any.
+      std::unique_ptr<CostRecorder> compiled_cost_recorder TF_GUARDED_BY(mu);
     };
     CostAnalysisData cost_analysis_data_;
 
@@ -243,6 +256,9 @@ class GraphExecutor {
                     graph_execution_state,
                 std::unique_ptr<mlrt::KernelRegistry> kernel_registry);
 
+  // Waits for the pending background recompilations.
+  ~GraphExecutor();
+
   // Runs on the graph according to given input/output.
   tensorflow::Status Run(
       const RunOptions& run_options,
@@ -296,6 +312,22 @@ class GraphExecutor {
     return *kernel_registry_;
   }
 
+  // Compiles the client graphs with the inputs, outputs and targets of
+  // `client_graphs` to MLRT bytecode, and writes their bytecode along with a
+  // `ClientGraphBundle` manifest to `bundle_dir`. Requires MLRT.
+  tensorflow::Status ExportClientGraphBundle(
+      absl::Span<const ClientGraphBundle::ClientGraph> client_graphs,
+      const std::string& bundle_dir);
+
+  // Loads and initializes the client graphs of a bundle written by
+  // `ExportClientGraphBundle` for the same graph and options, memory-mapping
+  // their bytecode, so that the runs with their inputs, outputs and targets
+  // skip importing and compiling them. Online cost analysis is disabled for
+  // these client graphs. Returns a FailedPrecondition error, without loading
+  // any client graph, if the bundle was written for another graph or options.
+  tensorflow::Status LoadClientGraphBundle(const std::string& bundle_dir)
+      TF_LOCKS_EXCLUDED(loaded_client_graphs_mu_);
+
  private:
   // A set of methods to load a client graph.
   StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>> LoadClientGraph(
@@ -315,6 +347,13 @@ class GraphExecutor {
 
   tensorflow::Status InitBytecode(LoadedClientGraph* loaded_graph);
 
+  // Recompiles `loaded_client_graph` with the costs in `cost_recorder` at the
+  // end of a cost measurement cycle, unless they did not drift enough, and
+  // starts the next cycle.
+  tensorflow::Status RecompileWithCosts(LoadedClientGraph& loaded_client_graph,
+                                        const CostRecorder& cost_recorder,
+                                        absl::Time now);
+
   // Returns a `LoadedClientGraph` given input/output tensor info. If there is
   // no existing one yet, creates one first.
   StatusOr<std::reference_wrapper<GraphExecutor::LoadedClientGraph>>
@@ -348,6 +387,11 @@ class GraphExecutor {
 
   std::unique_ptr<tfrt::ResourceContext> resource_context_;
 
+  tensorflow::mutex background_recompilations_mu_;
+  tensorflow::condition_variable background_recompilations_cv_;
+  int num_background_recompilations_
+      TF_GUARDED_BY(background_recompilations_mu_) = 0;
+
  protected:
   // For testing basic Cost Analysis functionality.
   absl::Duration simulated_duration_ = absl::ZeroDuration();
@@ -31,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
@@ -331,6 +333,104 @@ TEST_P(GraphExecutorTest, OnlineCostAnalysisPeriodic) {
   EXPECT_EQ(graph_executor->num_recompilations(), 3);
 }
 
+TEST_P(GraphExecutorTest, OnlineCostAnalysisSkipsRecompilationWithoutDrift) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.cost_analysis_options.version =
+      GraphExecutionOptions::CostAnalysisOptions::kPeriodic;
+  options.cost_analysis_options.reset_interval = absl::ZeroDuration();
+  options.cost_analysis_options.updates_per_interval = 1;
+  options.cost_analysis_options.recompilation_drift_threshold = 1e9;
+  options.enable_mlrt = GetParam();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor_base,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+  auto graph_executor = std::unique_ptr<GraphExecutorForTestingCostAnalysis>(
+      static_cast<GraphExecutorForTestingCostAnalysis*>(
+          graph_executor_base.release()));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+
+  // Only the first reset recompiles, as the costs never drift that much.
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+    EXPECT_EQ(graph_executor->num_recompilations(), 1);
+  }
+}
+
+TEST_P(GraphExecutorTest, OnlineCostAnalysisInBackground) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.cost_analysis_options.version =
+      GraphExecutionOptions::CostAnalysisOptions::kOnce;
+  options.cost_analysis_options.recompile_in_background = true;
+  options.enable_mlrt = GetParam();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor_base,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+  auto graph_executor = std::unique_ptr<GraphExecutorForTestingCostAnalysis>(
+      static_cast<GraphExecutorForTestingCostAnalysis*>(
+          graph_executor_base.release()));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+
+  // The recompilation eventually swaps in the new executable.
+  while (graph_executor->num_recompilations() == 0) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  EXPECT_EQ(graph_executor->num_recompilations(), 1);
+
+  TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+  EXPECT_EQ(graph_executor->num_recompilations(), 1);
+}
+
 REGISTER_OP("TestCancel")
     .Input("x: T")
     .Output("z: T")
@@ -536,6 +636,56 @@ TEST_F(GraphExecutorTest, DisableCompilation) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_F(GraphExecutorTest, LoadClientGraphBundle) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto create_graph_executor = [&]() {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = true;
+    auto fallback_state = tensorflow::tfrt_stub::FallbackState::Create(
+        CreateDefaultSessionOptions(options), graph_def.library());
+    TF_CHECK_OK(fallback_state.status());
+    auto graph_executor = GraphExecutor::Create(
+        std::move(options), std::move(*fallback_state),
+        std::make_unique<tfrt::ResourceContext>(), graph_def,
+        GetKernelRegistry());
+    TF_CHECK_OK(graph_executor.status());
+    return std::move(*graph_executor);
+  };
+
+  const std::string bundle_dir =
+      tensorflow::io::JoinPath(::testing::TempDir(), "client_graph_bundle");
+  ClientGraphBundle::ClientGraph client_graph;
+  client_graph.add_input_names("input");
+  client_graph.add_input_dtypes(DT_INT32);
+  client_graph.add_output_names("rank");
+  TF_ASSERT_OK(create_graph_executor()->ExportClientGraphBundle(
+      {client_graph}, bundle_dir));
+
+  auto graph_executor = create_graph_executor();
+  TF_ASSERT_OK(graph_executor->LoadClientGraphBundle(bundle_dir));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+
+  // The client graph is loaded from the bundle, so it needs no compilation.
+  GraphExecutor::RunOptions run_options;
+  run_options.disable_compilation = true;
+  TF_ASSERT_OK(graph_executor->Run(run_options, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+}
+
 TEST_F(GraphExecutorTest, SyncExecute) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -29,10 +32,13 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "llvm/Support/Casting.h"
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/tf2hlo.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
 #include "xla/hlo/ir/hlo_sharding.h"
+#include "xla/layout_util.h"
+#include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/client.h"
@@ -43,12 +49,15 @@ limitations under the License.
 #include "xla/python/ifrt/memory.h"
 #include "xla/python/ifrt/shape.h"
 #include "xla/python/ifrt/sharding.h"
+#include "xla/python/pjrt_ifrt/pjrt_array.h"
 #include "xla/python/pjrt_ifrt/xla_compiler.h"
 #include "xla/service/computation_placer.h"
 #include "xla/xla_data.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_tensor_utils.h"
@@ -139,7 +148,9 @@ CreateArrayFromHostTensorForSingleDevice(xla::ifrt::Client& ifrt_client,
   return ifrt_client.MakeArrayFromHostBuffer(
       tensor.data(), dtype, ToIfrtShape(tensor.shape()),
       /*byte_strides=*/{}, std::move(single_device_sharding),
-      xla::ifrt::Client::HostBufferSemantics::kImmutableUntilTransferCompletes,
+      // On CPU, the array may alias the buffer of the tensor, which the
+      // callback keeps alive. Elsewhere this waits for the transfer only.
+      xla::ifrt::Client::HostBufferSemantics::kZeroCopy,
       [tensor]() {
         // Keep tensor alive
         VLOG(2) << "Done with single device host buffer for slice "
@@ -147,8 +158,157 @@ CreateArrayFromHostTensorForSingleDevice(xla::ifrt::Client& ifrt_client,
       });
 }
 
+// A tensor buffer aliasing a PjRt buffer in host memory, which it keeps alive.
+class HostResidentPjRtBuffer : public tensorflow::TensorBuffer {
+ public:
+  HostResidentPjRtBuffer(
+      std::unique_ptr<xla::PjRtBuffer::ExternalReference> external_reference,
+      std::shared_ptr<xla::PjRtBuffer> buffer, size_t size)
+      : TensorBuffer(external_reference->OpaqueDeviceMemoryDataPointer()),
+        external_reference_(std::move(external_reference)),
+        buffer_(std::move(buffer)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(
+      tensorflow::AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ifrt_host_resident_array");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  std::unique_ptr<xla::PjRtBuffer::ExternalReference> external_reference_;
+  std::shared_ptr<xla::PjRtBuffer> buffer_;
+  size_t size_;
+};
+
+// Returns a tensor of `dtype` and `shape` aliasing the buffer of `array` if it
+// is a single PjRt buffer in host memory with the layout of tensors, or
+// nullopt if the array has to be copied.
+std::optional<tensorflow::Tensor> AliasHostResidentArray(
+    xla::ifrt::Array& array, tensorflow::DataType dtype,
+    const tensorflow::TensorShape& shape) {
+  auto* pjrt_array = llvm::dyn_cast<xla::ifrt::PjRtCompatibleArray>(&array);
+  if (pjrt_array == nullptr || pjrt_array->pjrt_buffers().size() != 1 ||
+      !DataTypeCanUseMemcpy(dtype)) {
+    return std::nullopt;
+  }
+  std::shared_ptr<xla::PjRtBuffer> buffer = pjrt_array->pjrt_buffers()[0];
+  const size_t size = shape.num_elements() * DataTypeSize(dtype);
+  if (!buffer->IsOnCpu() || !buffer->on_device_shape().IsArray() ||
+      !xla::LayoutUtil::IsMonotonicWithDim0Major(buffer->layout())) {
+    return std::nullopt;
+  }
+  auto on_device_size = buffer->GetOnDeviceSizeInBytes();
+  if (!on_device_size.ok() || *on_device_size != size ||
+      !buffer->GetReadyFuture().Await().ok()) {
+    return std::nullopt;
+  }
+  auto external_reference = buffer->AcquireExternalReference();
+  if (!external_reference.ok()) return std::nullopt;
+  // Tensors are expected to be aligned by the kernels.
+  if (reinterpret_cast<uintptr_t>(
+          (*external_reference)->OpaqueDeviceMemoryDataPointer()) %
+          EIGEN_MAX_ALIGN_BYTES !=
+      0) {
+    return std::nullopt;
+  }
+  auto* tensor_buffer = new HostResidentPjRtBuffer(
+      *std::move(external_reference), std::move(buffer), size);
+  tensorflow::Tensor tensor(dtype, shape, tensor_buffer);
+  tensor_buffer->Unref();
+  return tensor;
+}
+
+// Returns the dimension 0 shared by all `inputs`, or nullopt if there is none
+// or the inputs cannot be padded along it.
+std::optional<int64_t> GetBatchSize(
+    absl::Span<const tensorflow::Tensor> inputs) {
+  if (inputs.empty() || inputs[0].dims() == 0) return std::nullopt;
+  const int64_t batch_size = inputs[0].dim_size(0);
+  for (const auto& tensor : inputs) {
+    if (tensor.dims() == 0 || tensor.dim_size(0) != batch_size ||
+        !DataTypeCanUseMemcpy(tensor.dtype())) {
+      return std::nullopt;
+    }
+  }
+  return batch_size;
+}
+
+// Returns `tensor` with its dimension 0 padded with zeros to `batch_size`.
+tensorflow::Tensor PadBatch(const tensorflow::Tensor& tensor,
+                            int64_t batch_size) {
+  tensorflow::TensorShape padded_shape = tensor.shape();
+  padded_shape.set_dim(0, batch_size);
+  tensorflow::Tensor padded(tensor.dtype(), padded_shape);
+  const size_t num_bytes = tensor.TotalBytes();
+  char* padded_data = static_cast<char*>(padded.data());
+  std::memcpy(padded_data, tensor.data(), num_bytes);
+  std::memset(padded_data + num_bytes, 0, padded.TotalBytes() - num_bytes);
+  return padded;
+}
+
 }  // namespace
 
+std::vector<int64_t> IfrtServingExecutable::MostFrequentBatchSizes(
+    const absl::flat_hash_map<int64_t, int64_t>& histogram,
+    int max_num_batch_sizes) {
+  std::vector<std::pair<int64_t, int64_t>> counts(histogram.begin(),
+                                                  histogram.end());
+  // Ties are broken by the smaller batch size, to be deterministic.
+  std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  std::vector<int64_t> batch_sizes;
+  for (const auto& [batch_size, count] : counts) {
+    if (batch_sizes.size() >= static_cast<size_t>(max_num_batch_sizes)) break;
+    batch_sizes.push_back(batch_size);
+  }
+  return batch_sizes;
+}
+
+int64_t IfrtServingExecutable::GetBucketBatchSize(int64_t batch_size) const {
+  auto it = std::lower_bound(options_.batch_buckets.begin(),
+                             options_.batch_buckets.end(), batch_size);
+  return it == options_.batch_buckets.end() ? batch_size : *it;
+}
+
+void IfrtServingExecutable::PrecompileInBackground(
+    absl::Span<const tensorflow::Tensor> example_inputs,
+    absl::Span<const int64_t> batch_sizes) {
+  absl::MutexLock lock(&mutex_);
+  if (precompile_thread_pool_ == nullptr) {
+    precompile_thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "IfrtPrecompile",
+        std::max(options_.num_precompile_threads, 1));
+  }
+  for (int64_t batch_size : batch_sizes) {
+    std::vector<tensorflow::Tensor> inputs;
+    inputs.reserve(example_inputs.size());
+    for (const auto& tensor : example_inputs) {
+      // Only the shapes and types of the inputs are used by the compilation.
+      tensorflow::TensorShape shape = tensor.shape();
+      if (shape.dims() > 0) shape.set_dim(0, batch_size);
+      inputs.push_back(tensorflow::Tensor(tensor.dtype(), shape));
+    }
+    ++num_pending_precompilations_;
+    precompile_thread_pool_->Schedule([this, inputs = std::move(inputs)]() {
+      absl::Status status =
+          LookUpOrCreateExecutable(absl::MakeConstSpan(inputs))
+              .Await()
+              .status();
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to precompile " << signature_name() << ": "
+                     << status;
+      }
+      absl::MutexLock lock(&mutex_);
+      --num_pending_precompilations_;
+    });
+  }
+}
+
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
 IfrtServingExecutable::ConvertTensorToArray(
     const tensorflow::Tensor& tensor, const xla::ifrt::DeviceList& device_list,
@@ -269,7 +429,8 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
 
     const auto it = executable_bundles_.find(key);
     if (it != executable_bundles_.end()) {
-      return it->second;
+      it->second.last_use = ++use_count_;
+      return it->second.future;
     }
 
     // Only create promise and future when cache missed.
@@ -277,19 +438,85 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
         absl::StatusOr<CachedExecutableBundle>>::CreatePromise();
     future = xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>>(promise);
 
-    executable_bundles_.emplace(key, future);
+    CacheEntry entry;
+    entry.future = future;
+    entry.last_use = ++use_count_;
+    executable_bundles_.emplace(key, std::move(entry));
   }
 
   LOG(INFO) << "Cache missed. Building executable";
   absl::StatusOr<CachedExecutableBundle> executable_bundle =
       CreateExecutableSynchronously(inputs);
 
+  {
+    absl::MutexLock lock(&mutex_);
+    OnExecutableCompiled(key, executable_bundle);
+  }
+
   promise.Set(std::move(executable_bundle));
   return future;
 }
 
+void IfrtServingExecutable::OnExecutableCompiled(
+    const Key& key, const absl::StatusOr<CachedExecutableBundle>& bundle) {
+  auto it = executable_bundles_.find(key);
+  if (it == executable_bundles_.end()) return;
+  it->second.compiled = true;
+  if (bundle.ok()) {
+    auto memory_stats = bundle->ifrt_executable->GetCompiledMemoryStats();
+    if (memory_stats.ok()) {
+      it->second.memory_bytes = memory_stats->generated_code_size_in_bytes +
+                                memory_stats->temp_size_in_bytes;
+    } else {
+      it->second.memory_bytes =
+          bundle->ifrt_executable->SizeOfGeneratedCodeInBytes();
+    }
+    // Counts at least a byte, for the clients without memory stats.
+    it->second.memory_bytes = std::max<int64_t>(it->second.memory_bytes, 1);
+    executable_memory_bytes_ += it->second.memory_bytes;
+  }
+  if (options_.executable_memory_budget_bytes <= 0) return;
+
+  // The executables being compiled and the one just compiled are not evicted.
+  // The executions holding an evicted executable keep it alive until they
+  // are done.
+  while (executable_memory_bytes_ > options_.executable_memory_budget_bytes) {
+    auto lru = executable_bundles_.end();
+    for (auto entry_it = executable_bundles_.begin();
+         entry_it != executable_bundles_.end(); ++entry_it) {
+      if (!entry_it->second.compiled || entry_it->first == key) continue;
+      if (lru == executable_bundles_.end() ||
+          entry_it->second.last_use < lru->second.last_use) {
+        lru = entry_it;
+      }
+    }
+    if (lru == executable_bundles_.end()) break;
+    VLOG(1) << "Evicting an executable of " << signature_name() << " with "
+            << lru->second.memory_bytes << " bytes";
+    executable_memory_bytes_ -= lru->second.memory_bytes;
+    executable_bundles_.erase(lru);
+  }
+}
+
 absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
     absl::Span<const tensorflow::Tensor> inputs) {
+  // Pads the batch of the inputs to its bucket, if any.
+  const std::optional<int64_t> batch_size = GetBatchSize(inputs);
+  const int64_t bucket_batch_size =
+      batch_size.has_value() ? GetBucketBatchSize(*batch_size) : 0;
+  std::vector<tensorflow::Tensor> padded_inputs;
+  if (batch_size.has_value()) {
+    if (bucket_batch_size != *batch_size) {
+      padded_inputs.reserve(inputs.size());
+      for (const auto& tensor : inputs) {
+        padded_inputs.push_back(PadBatch(tensor, bucket_batch_size));
+      }
+      inputs = padded_inputs;
+    }
+    absl::MutexLock lock(&mutex_);
+    ++batch_size_histogram_[bucket_batch_size];
+  }
+
   TF_ASSIGN_OR_RETURN(CachedExecutableBundle executable_bundle,
                       LookUpOrCreateExecutable(inputs).Await());
 
@@ -351,8 +578,6 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
     TF_ASSIGN_OR_RETURN(tensorflow::DataType data_type,
                         ToTensorDataType(array_for_copy->dtype()));
 
-    tensorflow::Tensor tensor(data_type, std::move(tensor_shape));
-
     // IFRT's return does not contain sufficient information; so we use
     // sharding spec from metadata.
     VLOG(2) << "Output sharding: " << array_for_copy->sharding().DebugString();
@@ -372,13 +597,23 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
                             xla::ifrt::ArrayCopySemantics::kDonateInput));
 
     if (fully_replicated_array->shape() !=
-        xla::ifrt::Shape(tensor.shape().dim_sizes())) {
+        xla::ifrt::Shape(tensor_shape.dim_sizes())) {
       return absl::UnimplementedError(
           absl::StrCat("Not fully replicated output. Expected ",
-                       tensor.shape().DebugString(), " but got ",
+                       tensor_shape.DebugString(), " but got ",
                        fully_replicated_array->shape().DebugString()));
     }
 
+    // Host resident outputs are handed to the fallback kernels without a copy.
+    std::optional<tensorflow::Tensor> aliased_tensor =
+        AliasHostResidentArray(*fully_replicated_array, data_type,
+                               tensor_shape);
+    if (aliased_tensor.has_value()) {
+      outputs.push_back(*std::move(aliased_tensor));
+      continue;
+    }
+
+    tensorflow::Tensor tensor(data_type, tensor_shape);
     xla::ifrt::Future<absl::Status> copy_future =
         fully_replicated_array->CopyToHostBuffer(
             tensor.data(), /*byte_strides=*/std::nullopt,
@@ -390,6 +625,15 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
 
   TF_RETURN_IF_ERROR(
       xla::ifrt::JoinFutures(absl::MakeSpan(output_futures)).Await());
+
+  // Drops the padding of the batch from the outputs.
+  if (batch_size.has_value() && bucket_batch_size != *batch_size) {
+    for (auto& output : outputs) {
+      if (output.dims() > 0 && output.dim_size(0) == bucket_batch_size) {
+        output = output.Slice(0, *batch_size);
+      }
+    }
+  }
   return outputs;
 }
 
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,22 +45,42 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
 #include "tsl/concurrency/ref_count.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tensorflow {
 namespace ifrt_serving {
 
+struct IfrtServingExecutableOptions {
+  // If not empty, the ascending batch sizes that executables are compiled
+  // for. When all inputs have the same dimension 0, they are padded with zeros
+  // along it to the smallest batch size that fits, and the outputs with that
+  // dimension 0 are sliced back, so that dynamic batches share executables.
+  // Batches larger than the last bucket are compiled for their own shapes.
+  std::vector<int64_t> batch_buckets;
+
+  // If positive, the least recently used executables are evicted, and later
+  // compiled again, when the compiled executables need more memory.
+  int64_t executable_memory_budget_bytes = 0;
+
+  // The number of threads compiling the batch buckets of
+  // `PrecompileInBackground`.
+  int num_precompile_threads = 1;
+};
+
 class IfrtServingExecutable {
  public:
   IfrtServingExecutable(
       absl::string_view model_name, absl::string_view signature_name,
       mlir::OwningOpRef<mlir::ModuleOp> module,
       std::shared_ptr<xla::ifrt::Client> client,
-      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn)
+      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
+      IfrtServingExecutableOptions options = {})
       : model_name_(std::string(model_name)),
         signature_name_(std::string(signature_name)),
         module_(std::move(module)),
         ifrt_client_(std::move(client)),
-        shape_representation_fn_(std::move(shape_representation_fn)) {}
+        shape_representation_fn_(std::move(shape_representation_fn)),
+        options_(std::move(options)) {}
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -78,6 +100,35 @@ class IfrtServingExecutable {
     return executable_bundles_.size();
   }
 
+  // Returns the number of requests per batch size, after bucketing, among the
+  // requests whose inputs share their dimension 0, so that the buckets
+  // expected for a model can be precompiled, e.g. when a new version of it is
+  // loaded.
+  absl::flat_hash_map<int64_t, int64_t> batch_size_histogram() const {
+    absl::MutexLock lock(&mutex_);
+    return batch_size_histogram_;
+  }
+
+  // Returns up to `max_num_batch_sizes` batch sizes of `histogram`, most
+  // frequent first.
+  static std::vector<int64_t> MostFrequentBatchSizes(
+      const absl::flat_hash_map<int64_t, int64_t>& histogram,
+      int max_num_batch_sizes);
+
+  // Compiles in the background the executables of `example_inputs` with their
+  // dimension 0 replaced by each of `batch_sizes`.
+  void PrecompileInBackground(
+      absl::Span<const tensorflow::Tensor> example_inputs,
+      absl::Span<const int64_t> batch_sizes);
+
+  // Blocks until the compilations of `PrecompileInBackground` are done.
+  void WaitForPrecompilations() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](int* num_pending) { return *num_pending == 0; },
+        &num_pending_precompilations_));
+  }
+
  private:
   // In memory cache key.
   struct Key {
@@ -102,6 +153,15 @@ class IfrtServingExecutable {
     tensorflow::tpu::TPUCompileMetadataProto compile_metadata;
   };
 
+  struct CacheEntry {
+    xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>> future;
+    // The value of `use_count_` at the last lookup.
+    int64_t last_use = 0;
+    // Only set once the executable is compiled.
+    int64_t memory_bytes = 0;
+    bool compiled = false;
+  };
+
   std::string model_name_;
   std::string signature_name_;
 
@@ -112,10 +172,22 @@ class IfrtServingExecutable {
 
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
 
+  IfrtServingExecutableOptions options_;
+
   mutable absl::Mutex mutex_;
-  absl::flat_hash_map<Key,
-                      xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>>>
-      executable_bundles_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, CacheEntry> executable_bundles_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t use_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The memory of the compiled executables in `executable_bundles_`.
+  int64_t executable_memory_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<int64_t, int64_t> batch_size_histogram_
+      ABSL_GUARDED_BY(mutex_);
+  int num_pending_precompilations_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Declared last so that it is destroyed, waiting for the pending
+  // compilations, before the members they use.
+  std::unique_ptr<tsl::thread::ThreadPool> precompile_thread_pool_
+      ABSL_GUARDED_BY(mutex_);
 
   absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> ConvertTensorToArray(
       const tensorflow::Tensor& tensor,
@@ -127,6 +199,16 @@ class IfrtServingExecutable {
   absl::StatusOr<IfrtServingExecutable::CachedExecutableBundle>
   CreateExecutableSynchronously(absl::Span<const tensorflow::Tensor> inputs);
 
+  // Records the memory of the executable compiled for `key` and evicts the
+  // least recently used other executables while over the memory budget.
+  void OnExecutableCompiled(
+      const Key& key, const absl::StatusOr<CachedExecutableBundle>& bundle)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns the smallest batch bucket that fits `batch_size`, or `batch_size`
+  // itself if none does.
+  int64_t GetBucketBatchSize(int64_t batch_size) const;
+
   absl::StatusOr<std::unique_ptr<xla::ifrt::Sharding>> CreateSharding(
       int num_devices, const xla::ifrt::Shape& arg_xla_shape,
       const xla::ifrt::Shape& sharded_shapes);
@@ -37,6 +37,7 @@ limitations under the License.
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/test_util.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_matcher.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -50,6 +51,41 @@ namespace ifrt_serving {
 namespace {
 using ::tensorflow::test::TensorEq;
 using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+// Parses the test module of `file_name`.
+mlir::OwningOpRef<mlir::ModuleOp> ParseTestModule(absl::string_view file_name,
+                                                  mlir::MLIRContext& context) {
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/", file_name));
+  return mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+}
+
+mlir::DialectRegistry CreateTestDialectRegistry() {
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+  return registry;
+}
+
+// Returns `batch_size` rows of 2 elements counting from 1.
+tensorflow::Tensor CreateBatch(int batch_size) {
+  std::vector<int32_t> values(batch_size * 2);
+  for (int i = 0; i < batch_size * 2; ++i) values[i] = i + 1;
+  return tensorflow::test::AsTensor<int32_t>(
+      values, tensorflow::TensorShape({batch_size, 2}));
+}
+
+// Returns twice `CreateBatch(batch_size)`.
+tensorflow::Tensor CreateExpectedSum(int batch_size) {
+  std::vector<int32_t> values(batch_size * 2);
+  for (int i = 0; i < batch_size * 2; ++i) values[i] = 2 * (i + 1);
+  return tensorflow::test::AsTensor<int32_t>(
+      values, tensorflow::TensorShape({batch_size, 2}));
+}
 
 TEST(IfrtServingExecutableTest, Basic) {
   // Create test input module
@@ -279,6 +315,117 @@ TEST(IfrtServingExecutableTest, NoReturn) {
   ASSERT_EQ(result.size(), 0);
 }
 
+TEST(IfrtServingExecutableTest, BatchBuckets) {
+  mlir::MLIRContext context(CreateTestDialectRegistry());
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      ParseTestModule("batch_executable.mlir", context);
+  ASSERT_TRUE(mlir_module);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutableOptions options;
+  options.batch_buckets = {2, 4};
+  IfrtServingExecutable executable(
+      "test", "main", std::move(mlir_module), client,
+      tensorflow::IdentityShapeRepresentationFn(), options);
+
+  for (int batch_size : {1, 2, 3, 4, 5}) {
+    std::vector<tensorflow::Tensor> inputs{CreateBatch(batch_size),
+                                           CreateBatch(batch_size)};
+    TF_ASSERT_OK_AND_ASSIGN(auto result,
+                            executable.Execute(absl::MakeSpan(inputs)));
+    EXPECT_THAT(result, ElementsAre(TensorEq(CreateExpectedSum(batch_size))));
+  }
+
+  // The batch of 5 does not fit any bucket.
+  EXPECT_EQ(executable.num_executables(), 3);
+  EXPECT_THAT(executable.batch_size_histogram(),
+              UnorderedElementsAre(Pair(2, 2), Pair(4, 2), Pair(5, 1)));
+  EXPECT_THAT(IfrtServingExecutable::MostFrequentBatchSizes(
+                  executable.batch_size_histogram(), 2),
+              ElementsAre(2, 4));
+}
+
+TEST(IfrtServingExecutableTest, EvictsExecutablesOverMemoryBudget) {
+  mlir::MLIRContext context(CreateTestDialectRegistry());
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      ParseTestModule("batch_executable.mlir", context);
+  ASSERT_TRUE(mlir_module);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutableOptions options;
+  options.executable_memory_budget_bytes = 1;
+  IfrtServingExecutable executable(
+      "test", "main", std::move(mlir_module), client,
+      tensorflow::IdentityShapeRepresentationFn(), options);
+
+  for (int batch_size : {1, 2, 1}) {
+    std::vector<tensorflow::Tensor> inputs{CreateBatch(batch_size),
+                                           CreateBatch(batch_size)};
+    TF_ASSERT_OK_AND_ASSIGN(auto result,
+                            executable.Execute(absl::MakeSpan(inputs)));
+    EXPECT_THAT(result, ElementsAre(TensorEq(CreateExpectedSum(batch_size))));
+    // Only the last executable is kept.
+    EXPECT_EQ(executable.num_executables(), 1);
+  }
+}
+
+TEST(IfrtServingExecutableTest, PrecompileInBackground) {
+  mlir::MLIRContext context(CreateTestDialectRegistry());
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      ParseTestModule("batch_executable.mlir", context);
+  ASSERT_TRUE(mlir_module);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutable executable("test", "main", std::move(mlir_module),
+                                   client,
+                                   tensorflow::IdentityShapeRepresentationFn());
+
+  std::vector<tensorflow::Tensor> example_inputs{CreateBatch(1),
+                                                 CreateBatch(1)};
+  const std::vector<int64_t> batch_sizes = {2, 4};
+  executable.PrecompileInBackground(example_inputs, batch_sizes);
+  executable.WaitForPrecompilations();
+  EXPECT_EQ(executable.num_executables(), 2);
+
+  std::vector<tensorflow::Tensor> inputs{CreateBatch(4), CreateBatch(4)};
+  TF_ASSERT_OK_AND_ASSIGN(auto result,
+                          executable.Execute(absl::MakeSpan(inputs)));
+  EXPECT_THAT(result, ElementsAre(TensorEq(CreateExpectedSum(4))));
+  EXPECT_EQ(executable.num_executables(), 2);
+}
+
+TEST(IfrtServingExecutableTest, OutputsAliasHostResidentArrays) {
+  mlir::MLIRContext context(CreateTestDialectRegistry());
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      ParseTestModule("batch_executable.mlir", context);
+  ASSERT_TRUE(mlir_module);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutable executable("test", "main", std::move(mlir_module),
+                                   client,
+                                   tensorflow::IdentityShapeRepresentationFn());
+
+  std::vector<tensorflow::Tensor> inputs{CreateBatch(4), CreateBatch(4)};
+  TF_ASSERT_OK_AND_ASSIGN(auto result,
+                          executable.Execute(absl::MakeSpan(inputs)));
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_THAT(result[0], TensorEq(CreateExpectedSum(4)));
+
+  // The output of the CPU client is not copied.
+  tensorflow::TensorDescription description;
+  result[0].FillDescription(&description);
+  EXPECT_EQ(description.allocation_description().allocator_name(),
+            "ifrt_host_resident_array");
+}
+
 }  // namespace
 }  // namespace ifrt_serving
 }  // namespace tensorflow
@@ -163,8 +163,9 @@ SplitAndCreateArraysFromHostBuffer(
               tensor.data(), dtype,
               xla::ifrt::Shape(tensor.shape().dim_sizes()),
               /*byte_strides=*/{}, std::move(single_device_sharding),
-              xla::ifrt::Client::HostBufferSemantics::
-                  kImmutableUntilTransferCompletes,
+              // The callback keeps the slice alive while the array may alias
+              // it on CPU.
+              xla::ifrt::Client::HostBufferSemantics::kZeroCopy,
               [tensor, slice_idx]() {
                 // Keep tensor alive
                 LOG(INFO) << "Done with host buffer for slice " << slice_idx
@@ -22,6 +22,8 @@ limitations under the License.
 
 #include "google/protobuf/text_format.h"
 #include "absl/base/optimization.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.h"
@@ -300,12 +302,22 @@ void MlrtBatchResource::ProcessFuncBatchImpl(
     arguments.emplace_back(tfrt_stub::FallbackTensor(input));
   }
 
-  std::vector<mlrt::Value> results(batch_function_.output_regs().size());
-
   const auto& task = down_cast<const MlrtBatchTask&>(last_task);
-  DCHECK(task.context);
+  DCHECK(task.caller_context);
   mlrt::ExecutionContext& caller_context = *task.caller_context;
 
+  // The batch resource may be shared by the signatures of a model, with one
+  // executable each, so the function of the caller's executable is run.
+  mlrt::bc::Function batch_function =
+      caller_context.loaded_executable().GetFunction(batch_function_.name());
+  if (!batch_function) {
+    done(absl::InternalError(
+        absl::StrCat("Batch function not found: ", batch_function_.name())));
+    return;
+  }
+
+  std::vector<mlrt::Value> results(batch_function.output_regs().size());
+
   auto& caller_tf_context = caller_context.GetUserContext<tf_mlrt::Context>();
   const auto& caller_fallback_request_state =
       caller_tf_context.fallback_request_state();
@@ -361,7 +373,7 @@ void MlrtBatchResource::ProcessFuncBatchImpl(
   execution_context.set_exit_handler(
       [chain]() mutable { chain.SetStateConcrete(); });
 
-  execution_context.CallByMove(batch_function_, absl::MakeSpan(arguments),
+  execution_context.CallByMove(batch_function, absl::MakeSpan(arguments),
                                absl::MakeSpan(results));
 
   work_queue->AddTask(
@@ -410,6 +422,7 @@ REGISTER_OP(kMlrtBatchFunctionName)
     .Attr("Tout: list(type)")
     .Attr("enable_large_batch_splitting: bool = false")
     .Attr("disable_padding: bool = false")
+    .Attr("enable_ragged_batching: bool = false")
     // An opaque function handle, which is an int64_t, for passing the batch
     // function.
     .Attr("opaque_function_handle: int")
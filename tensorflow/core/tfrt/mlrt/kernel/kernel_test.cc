@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -1214,7 +1215,8 @@ TEST(KernelTest, PromiseFutureOp) {
       results[1].Get<tfrt_stub::FallbackTensor>().tensor(), expected);
 }
 
-mlrt::bc::Buffer CreateExecutableForBatchFunctionOp() {
+mlrt::bc::Buffer CreateExecutableForBatchFunctionOp(
+    int max_batch_size = 1, int batch_timeout_micros = 0) {
   mlrt::bc::Buffer buffer;
   mlrt::bc::Allocator allocator(&buffer);
 
@@ -1250,71 +1252,73 @@ mlrt::bc::Buffer CreateExecutableForBatchFunctionOp() {
 
   // attributes[3] is NodeDef for batch function.
   attributes.Add("batch_node_def_str",
-                 R"pb(name: "BatchFunction"
-                      op: "MlrtBatchFunction"
-                      input: "dummy_arg"
-                      input: "dummy_arg"
-                      device: "/job:localhost/replica:0/task:0/device:CPU:0"
-                      attr {
-                        key: "num_batch_threads"
-                        value: { i: 16 }
-                      }
-                      attr {
-                        key: "max_batch_size"
-                        value { i: 1 }
-                      }
-                      attr {
-                        key: "allowed_batch_sizes"
-                        value { list { i: 1 } }
-                      }
-                      attr {
-                        key: "batch_timeout_micros"
-                        value { i: 0 }
-                      }
-                      attr {
-                        key: "low_priority_max_batch_size"
-                        value { i: 1 }
-                      }
-                      attr {
-                        key: "low_priority_batch_timeout_micros"
-                        value { i: 0 }
-                      }
-                      attr {
-                        key: "low_priority_allowed_batch_sizes"
-                        value { list { i: 1 } }
-                      }
-                      attr {
-                        key: "low_priority_max_enqueued_batches"
-                        value { i: 1 }
-                      }
-                      attr {
-                        key: "container"
-                        value { s: "container" }
-                      }
-                      attr {
-                        key: "shared_name"
-                        value { s: "shared_name" }
-                      }
-                      attr {
-                        key: "batching_queue"
-                        value { s: "batching_queue" }
-                      }
-                      attr {
-                        key: "enable_large_batch_splitting"
-                        value { b: false }
-                      }
-                      attr {
-                        key: "Tin"
-                        value { list { type: DT_INT32 type: DT_INT32 } }
-                      }
-                      attr {
-                        key: "Tcaptured"
-                        value { list {} }
-                      }
-                      attr {
-                        key: "Tout"
-                        value { list { type: DT_INT32 } }
-                      })pb");
+                 absl::Substitute(
+                     R"pb(name: "BatchFunction"
+                          op: "MlrtBatchFunction"
+                          input: "dummy_arg"
+                          input: "dummy_arg"
+                          device: "/job:localhost/replica:0/task:0/device:CPU:0"
+                          attr {
+                            key: "num_batch_threads"
+                            value: { i: 16 }
+                          }
+                          attr {
+                            key: "max_batch_size"
+                            value { i: $0 }
+                          }
+                          attr {
+                            key: "allowed_batch_sizes"
+                            value { list { i: $0 } }
+                          }
+                          attr {
+                            key: "batch_timeout_micros"
+                            value { i: $1 }
+                          }
+                          attr {
+                            key: "low_priority_max_batch_size"
+                            value { i: 1 }
+                          }
+                          attr {
+                            key: "low_priority_batch_timeout_micros"
+                            value { i: 0 }
+                          }
+                          attr {
+                            key: "low_priority_allowed_batch_sizes"
+                            value { list { i: 1 } }
+                          }
+                          attr {
+                            key: "low_priority_max_enqueued_batches"
+                            value { i: 1 }
+                          }
+                          attr {
+                            key: "container"
+                            value { s: "container" }
+                          }
+                          attr {
+                            key: "shared_name"
+                            value { s: "shared_name" }
+                          }
+                          attr {
+                            key: "batching_queue"
+                            value { s: "batching_queue" }
+                          }
+                          attr {
+                            key: "enable_large_batch_splitting"
+                            value { b: false }
+                          }
+                          attr {
+                            key: "Tin"
+                            value { list { type: DT_INT32 type: DT_INT32 } }
+                          }
+                          attr {
+                            key: "Tcaptured"
+                            value { list {} }
+                          }
+                          attr {
+                            key: "Tout"
+                            value { list { type: DT_INT32 } }
+                          })pb",
+                     max_batch_size, batch_timeout_micros));
 
   attributes.Add("device", "/device:CPU:0");
 
@@ -1464,6 +1468,90 @@ TEST(KernelTest, BatchFunctionOp) {
       result.Get<tfrt_stub::FallbackTensor>().tensor(), expected);
 }
 
+// Two signatures of a model, with one executable each, invoke the same batched
+// function. Without a client graph resource context, as with
+// `share_batching_across_signatures`, they share the batch resource in the
+// per-model resource context and their requests are batched together.
+TEST(KernelTest, BatchFunctionOpSharedAcrossSignatures) {
+  constexpr int kNumSignatures = 2;
+  // A batch is only processed once the requests of all signatures fill it.
+  auto buffer = CreateExecutableForBatchFunctionOp(
+      /*max_batch_size=*/kNumSignatures,
+      /*batch_timeout_micros=*/absl::ToInt64Microseconds(absl::Minutes(10)));
+
+  mlrt::bc::Executable executable(buffer.data());
+
+  mlrt::KernelRegistry registry;
+  RegisterTfMlrtKernels(registry);
+  RegisterTfMlrtBatchKernels(registry);
+
+  auto work_queue = tfrt::CreateMultiThreadedWorkQueue(
+      /*num_threads=*/4, /*num_blocking_threads=*/4);
+
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state, tfrt_stub::FallbackState::Create(
+                                                   session_options, fdef_lib));
+
+  std::function<void(std::function<void()>)> runner =
+      [](const std::function<void()>& f) { f(); };
+  tfrt::ResourceContext resource_context;
+
+  struct Signature {
+    std::unique_ptr<mlrt::LoadedExecutable> loaded_executable;
+    tfrt_stub::OpKernelRunnerTable runner_table;
+    tfd::FallbackResourceArray resource_array;
+    std::unique_ptr<tfd::KernelFallbackCompatRequestState>
+        fallback_request_state;
+    std::unique_ptr<mlrt::ExecutionContext> execution_context;
+    mlrt::Value arg;
+    mlrt::Value result;
+    absl::Notification notification;
+  };
+  std::vector<Signature> signatures(kNumSignatures);
+  for (int i = 0; i < kNumSignatures; ++i) {
+    Signature& signature = signatures[i];
+    signature.loaded_executable =
+        std::make_unique<mlrt::LoadedExecutable>(executable, registry);
+    signature.execution_context = std::make_unique<mlrt::ExecutionContext>(
+        signature.loaded_executable.get());
+    signature.execution_context->set_work_queue(work_queue.get());
+    signature.fallback_request_state =
+        std::make_unique<tfd::KernelFallbackCompatRequestState>(
+            &runner, &fallback_state->device_manager(), /*step_id=*/i,
+            &signature.runner_table, &signature.resource_array,
+            /*user_intra_op_threadpool=*/nullptr,
+            /*model_metadata=*/std::nullopt,
+            &fallback_state->process_function_library_runtime());
+    signature.execution_context->AddUserContext(std::make_unique<Context>(
+        signature.fallback_request_state.get(), &resource_context));
+
+    tensorflow::Tensor input_tensor(tensorflow::DT_INT32, {1});
+    input_tensor.flat<int32_t>()(0) = 100 * (i + 1);
+    signature.arg.Set(tfrt_stub::FallbackTensor(std::move(input_tensor)));
+    signature.execution_context->set_exit_handler(
+        [&signature]() { signature.notification.Notify(); });
+    std::vector<uint8_t> last_uses = {true};
+    signature.execution_context->Call(executable.functions()[0], last_uses,
+                                      absl::MakeSpan(&signature.arg, 1),
+                                      absl::MakeSpan(&signature.result, 1));
+    work_queue->AddTask([&signature]() {
+      mlrt::Execute(*signature.execution_context);
+    });
+  }
+
+  for (int i = 0; i < kNumSignatures; ++i) {
+    Signature& signature = signatures[i];
+    signature.notification.WaitForNotification();
+    TF_ASSERT_OK(signature.execution_context->status());
+
+    tensorflow::Tensor expected(tensorflow::DT_INT32, {1});
+    expected.flat<int32_t>()(0) = 200 * (i + 1);
+    tensorflow::test::ExpectEqual(
+        signature.result.Get<tfrt_stub::FallbackTensor>().tensor(), expected);
+  }
+}
+
 mlrt::bc::Buffer CreateExecutableForCancelOp() {
   mlrt::bc::Buffer buffer;
   mlrt::bc::Allocator allocator(&buffer);
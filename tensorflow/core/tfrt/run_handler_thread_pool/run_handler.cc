@@ -16,6 +16,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -684,6 +685,7 @@ class RunHandler::Impl {
   internal::ThreadWorkSource* tws() { return &tws_; }
 
   int64_t priority() const { return options_.priority; }
+  int64_t deadline_us() const { return options_.deadline_us; }
 
  private:
   class RunHandlerEigenThreadPool
@@ -812,19 +814,17 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority;
-      auto it = sorted_active_handlers_.cbegin();
-      bool new_handler_inserted = false;
-      for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
-          sorted_active_handlers_.insert(it, handler_impl);
-          new_handler_inserted = true;
-          // Point to the newly added handler.
-          --it;
-        }
-        (*thread_work_sources)[i] = (*it)->tws();
-        ++it;
+      // The sort is stable, so the new handler goes after the ones that
+      // compare equal to it.
+      sorted_active_handlers_.push_back(handler_impl);
+      const int64_t now_us = tensorflow::EnvTime::NowMicros();
+      sorted_active_handlers_.sort(
+          [now_us](const RunHandler::Impl* a, const RunHandler::Impl* b) {
+            return Precedes(*a, *b, now_us);
+          });
+      int i = 0;
+      for (RunHandler::Impl* active_handler : sorted_active_handlers_) {
+        (*thread_work_sources)[i++] = active_handler->tws();
       }
       version = ++version_;
     }
@@ -881,6 +881,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    tensorflow::mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
   void Quiesce() TF_LOCKS_EXCLUDED(mu_) {
     while (true) {
       {
@@ -903,6 +913,25 @@ class RunHandlerPool::Impl {
   }
 
  private:
+  // Returns whether the work of `a` should be scheduled before the work of `b`
+  // at `now_us`: the requests with a higher priority go first, then the ones
+  // with an earlier deadline. The requests past their deadline are cancelled,
+  // so they go last to keep their remaining work from delaying the others.
+  static bool Precedes(const RunHandler::Impl& a, const RunHandler::Impl& b,
+                       int64_t now_us) {
+    const bool a_expired = a.deadline_us() > 0 && a.deadline_us() <= now_us;
+    const bool b_expired = b.deadline_us() > 0 && b.deadline_us() <= now_us;
+    if (a_expired != b_expired) return b_expired;
+    if (a.priority() != b.priority()) return a.priority() > b.priority();
+    const int64_t a_deadline = a.deadline_us() > 0
+                                   ? a.deadline_us()
+                                   : std::numeric_limits<int64_t>::max();
+    const int64_t b_deadline = b.deadline_us() > 0
+                                   ? b.deadline_us()
+                                   : std::numeric_limits<int64_t>::max();
+    return a_deadline < b_deadline;
+  }
+
   void RecomputePoolStats(
       int num_active_requests, uint64_t version,
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
@@ -921,8 +950,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then deadline, then start time (see
+  // `Precedes()`).
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1040,6 +1069,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting()
+    const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 void RunHandlerPool::Quiesce() const { impl_->Quiesce(); }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
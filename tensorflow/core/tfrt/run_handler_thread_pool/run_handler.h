@@ -44,10 +44,15 @@ class RunHandler;
 
 // Options for RunHanler.
 struct RunHandlerOptions {
-  RunHandlerOptions() : priority(0) {}
+  RunHandlerOptions() : priority(0), deadline_us(0) {}
 
   // Request priority.
   int priority;
+
+  // Request deadline in microseconds since the Unix epoch, or 0 if the request
+  // has no deadline. The requests with the same priority are scheduled
+  // earliest-deadline-first.
+  int64_t deadline_us;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -128,6 +133,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the same order as
+  // `GetActiveHandlerPrioritiesForTesting()`.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
   // Block until the system is quiescent (no pending work and no inflight work).
   void Quiesce() const;
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -61,7 +62,19 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
 
 tensorflow::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
 RunHandlerThreadWorkQueue::InitializeRequest(int64_t request_id) const {
+  return InitializeRequestWithOptions(request_id, RequestOptions());
+}
+
+tensorflow::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+RunHandlerThreadWorkQueue::InitializeRequestWithOptions(
+    int64_t request_id, const RequestOptions& request_options) const {
   RunHandlerOptions options;
+  options.priority = request_options.priority;
+  if (request_options.deadline.has_value()) {
+    options.deadline_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              request_options.deadline->time_since_epoch())
+                              .count();
+  }
   std::unique_ptr<RunHandler> handler =
       handler_pool_->Get(request_id, options_.init_timeout_ms, options);
   if (!handler) {
@@ -95,6 +95,12 @@ class RunHandlerThreadWorkQueue
       std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
   InitializeRequest(int64_t request_id) const override;
 
+  // Gets a run handler with the priority and deadline of `options`.
+  tensorflow::StatusOr<
+      std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+  InitializeRequestWithOptions(int64_t request_id,
+                               const RequestOptions& options) const override;
+
   int GetParallelismLevel() const override {
     return options_.num_main_threads + options_.num_complementary_threads;
   }
@@ -181,14 +181,16 @@ class Runtime {
     create_request_queue_fn_ = std::move(create_request_queue_fn);
   }
 
-  // Creates a work queue for a request.
+  // Creates a work queue for a request. `options` are scheduling hints for the
+  // work queue; they are not passed to `create_request_queue_fn_`.
   StatusOr<std::unique_ptr<WorkQueueInterface>> CreateRequestQueue(
-      int64_t request_id) const {
+      int64_t request_id,
+      const WorkQueueInterface::RequestOptions& options = {}) const {
     if (create_request_queue_fn_) {
       return create_request_queue_fn_(request_id);
     }
 
-    return work_queue_->InitializeRequest(request_id);
+    return work_queue_->InitializeRequestWithOptions(request_id, options);
   }
 
  private:
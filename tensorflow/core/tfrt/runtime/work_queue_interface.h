@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_RUNTIME_WORK_QUEUE_INTERFACE_H_
 #define TENSORFLOW_CORE_TFRT_RUNTIME_WORK_QUEUE_INTERFACE_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -61,6 +63,23 @@ class WorkQueueInterface : public tfrt::ConcurrentWorkQueue {
     return {nullptr};
   }
 
+  // The scheduling hints for the per-request work queue of a request.
+  struct RequestOptions {
+    // Larger number means higher priority.
+    int priority = 0;
+    // The deadline of the request, if any.
+    std::optional<std::chrono::system_clock::time_point> deadline;
+  };
+
+  // Same as `InitializeRequest()`, but the implementation may use `options` to
+  // schedule the tasks of the request against the ones of other requests. By
+  // default, the options are ignored.
+  virtual StatusOr<std::unique_ptr<WorkQueueInterface>>
+  InitializeRequestWithOptions(int64_t request_id,
+                               const RequestOptions& options) const {
+    return InitializeRequest(request_id);
+  }
+
  private:
   int64_t id_ = 0;
   thread::ThreadPoolInterface* intra_op_threadpool_ = nullptr;
@@ -78,6 +78,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_util.h"
 #include "tensorflow/core/tfrt/saved_model/utils/serialize_utils.h"
+#include "tensorflow/core/tfrt/saved_model/utils/shared_variable_store.h"
 #include "tensorflow/core/tfrt/stubs/model_config_stub.h"
 #include "tensorflow/core/tfrt/utils/error_util.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
@@ -618,6 +619,12 @@ SavedModelImpl::LoadSavedModel(Options options,
     }
   }
 
+  // The graph def is moved into the graph executor below.
+  std::vector<VariableName> variables;
+  if (options.share_variables) {
+    variables = GetResourceVariableNames(meta_graph_def.graph_def());
+  }
+
   ASSIGN_OR_RETURN_WITH_STAGE_INFO(
       "graph_executor creation", auto graph_executor,
       GraphExecutor::Create(options.graph_execution_options,
@@ -662,6 +669,29 @@ SavedModelImpl::LoadSavedModel(Options options,
         aot_exist || options.aot_generation));
   }
 
+  if (!options.client_graph_bundle_dir.empty()) {
+    LOG(INFO) << "Loading client graph bundle from "
+              << options.client_graph_bundle_dir;
+    Status s =
+        graph_executor->LoadClientGraphBundle(options.client_graph_bundle_dir);
+    if (absl::IsFailedPrecondition(s)) {
+      // A stale bundle is ignored, and the client graphs are compiled lazily.
+      LOG(WARNING) << "Ignoring the client graph bundle: " << s;
+    } else {
+      RETURN_IF_ERROR_IN_INIT(s);
+    }
+  }
+
+  if (options.share_variables) {
+    // Small values are not worth the lookups.
+    constexpr int64_t kMinSharedVariableBytes = 1024;
+    const int64_t num_shared_bytes = ShareVariables(
+        graph_executor->fallback_state().device_manager(), variables,
+        kMinSharedVariableBytes, SharedVariableStore::Global());
+    LOG(INFO) << "TFRT shares " << num_shared_bytes
+              << " bytes of variables with other savedmodels.";
+  }
+
   const auto init_duration = absl::Now() - init_start_time;
   saved_model_init_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(init_duration));
@@ -110,6 +110,21 @@ class SavedModel {
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If non-empty, the directory of a client graph bundle written by
+    // `AotCompileClientGraphBundle` for this SavedModel. Its client graphs are
+    // loaded along with the SavedModel, so that the first runs with their
+    // inputs and outputs skip importing and compiling them. Requires MLRT.
+    // Note that signatures only run through client graphs with lazy loading
+    // and `lazy_loading_use_graph_executor`.
+    std::string client_graph_bundle_dir;
+
+    // If true, the restored values of the resource variables on CPU are shared
+    // with the equal values of the other SavedModels loaded in the process with
+    // this option, e.g. the other versions of the same model, instead of each
+    // SavedModel holding its own copy. A variable gets its own copy again once
+    // it is updated.
+    bool share_variables = false;
+
     GraphExecutionOptions graph_execution_options;
   };
 
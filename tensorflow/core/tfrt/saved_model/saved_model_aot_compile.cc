@@ -290,6 +290,42 @@ StatusOr<AotResult> AotCompileSavedModel(absl::string_view input_model_dir,
   return AotResult{std::move(bef), std::move(xla_functions)};
 }
 
+std::vector<ClientGraphBundle::ClientGraph> GetSignatureClientGraphs(
+    const MetaGraphDef& meta_graph_def) {
+  std::vector<ClientGraphBundle::ClientGraph> client_graphs;
+  for (const auto& [name, signature_def] : meta_graph_def.signature_def()) {
+    ClientGraphBundle::ClientGraph client_graph;
+    bool is_dense = true;
+    for (const auto& [key, tensor_info] : signature_def.inputs()) {
+      is_dense &= tensor_info.encoding_case() == TensorInfo::kName;
+      client_graph.add_input_names(tensor_info.name());
+      client_graph.add_input_dtypes(tensor_info.dtype());
+    }
+    for (const auto& [key, tensor_info] : signature_def.outputs()) {
+      is_dense &= tensor_info.encoding_case() == TensorInfo::kName;
+      client_graph.add_output_names(tensor_info.name());
+    }
+    if (!is_dense) {
+      LOG(WARNING) << "Skipping signature " << name
+                   << " with non-dense tensors.";
+      continue;
+    }
+    client_graphs.push_back(std::move(client_graph));
+  }
+  return client_graphs;
+}
+
+Status AotCompileClientGraphBundle(
+    const MetaGraphDef& meta_graph_def,
+    absl::Span<const ClientGraphBundle::ClientGraph> client_graphs,
+    GraphExecutor& graph_executor, const std::string& output_dir) {
+  std::vector<ClientGraphBundle::ClientGraph> all_client_graphs =
+      GetSignatureClientGraphs(meta_graph_def);
+  all_client_graphs.insert(all_client_graphs.end(), client_graphs.begin(),
+                           client_graphs.end());
+  return graph_executor.ExportClientGraphBundle(all_client_graphs, output_dir);
+}
+
 StatusOr<std::unique_ptr<xla::PjRtExecutable>> AotCompileToGpuPjRtExecutable(
     const FunctionLibraryDefinition* flib_def, const NameAttrList& function,
     int graph_def_version, const std::vector<XlaCompiler::Argument>& args,
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -32,7 +33,9 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/tfrt/graph_executor/client_graph_bundle.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
+#include "tensorflow/core/tfrt/graph_executor/graph_executor.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tensorflow/core/tfrt/runtime/runtime.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
@@ -99,6 +102,23 @@ StatusOr<std::string> AotCompileToGpuPjRtLoadedExecutableWithDevice(
     int graph_def_version, const std::vector<XlaCompiler::Argument>& args,
     bool has_ref_vars, bool may_alias_resource_update,
     XlaCompiler::CompilationResult** compilation_result);
+
+// Returns the client graphs that run the signatures of `meta_graph_def` by
+// tensor names, as `SavedModel::Run` does with lazy loading through the graph
+// executor.
+std::vector<ClientGraphBundle::ClientGraph> GetSignatureClientGraphs(
+    const MetaGraphDef& meta_graph_def);
+
+// AOT compiles the client graphs of the signatures of `meta_graph_def` and
+// `client_graphs`, e.g. the common feeds and fetches of `Session::Run`-style
+// requests, and writes them to `output_dir` as a client graph bundle for
+// `SavedModel::Options::client_graph_bundle_dir`. `graph_executor` must be the
+// graph executor of a SavedModel loaded from `meta_graph_def` with the options
+// of the SavedModel that loads the bundle.
+Status AotCompileClientGraphBundle(
+    const MetaGraphDef& meta_graph_def,
+    absl::Span<const ClientGraphBundle::ClientGraph> client_graphs,
+    GraphExecutor& graph_executor, const std::string& output_dir);
 }  // namespace tensorflow::tfrt_stub
 
 #endif  // TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_AOT_COMPILE_H_
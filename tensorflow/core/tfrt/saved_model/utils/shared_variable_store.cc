@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/saved_model/utils/shared_variable_store.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+uint64_t TensorFingerprint(const Tensor& tensor) {
+  uint64_t fingerprint = Fingerprint64(tensor.tensor_data());
+  fingerprint = FingerprintCat64(fingerprint, tensor.dtype());
+  for (int64_t dim : tensor.shape().dim_sizes()) {
+    fingerprint = FingerprintCat64(fingerprint, dim);
+  }
+  return fingerprint;
+}
+
+bool TensorsEqual(const Tensor& a, const Tensor& b) {
+  return a.dtype() == b.dtype() && a.shape() == b.shape() &&
+         a.tensor_data() == b.tensor_data();
+}
+
+}  // namespace
+
+SharedVariableStore& SharedVariableStore::Global() {
+  static auto* const store = new SharedVariableStore();
+  return *store;
+}
+
+Tensor SharedVariableStore::Share(const Tensor& tensor) {
+  DCHECK(DataTypeCanUseMemcpy(tensor.dtype()));
+  const uint64_t fingerprint = TensorFingerprint(tensor);
+  mutex_lock lock(mu_);
+  auto& tensors = tensors_[fingerprint];
+  for (const Tensor& shared : tensors) {
+    if (TensorsEqual(shared, tensor)) return shared;
+  }
+  tensors.push_back(tensor);
+  return tensor;
+}
+
+void SharedVariableStore::Prune() {
+  mutex_lock lock(mu_);
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    auto& tensors = it->second;
+    tensors.erase(std::remove_if(tensors.begin(), tensors.end(),
+                                 [](const Tensor& tensor) {
+                                   return tensor.RefCountIsOne();
+                                 }),
+                  tensors.end());
+    if (tensors.empty()) {
+      tensors_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t SharedVariableStore::size() const {
+  mutex_lock lock(mu_);
+  size_t size = 0;
+  for (const auto& [fingerprint, tensors] : tensors_) size += tensors.size();
+  return size;
+}
+
+std::vector<VariableName> GetResourceVariableNames(const GraphDef& graph_def) {
+  std::vector<VariableName> variables;
+  for (const NodeDef& node : graph_def.node()) {
+    if (node.op() != "VarHandleOp") continue;
+    std::string container;
+    std::string shared_name = node.name();
+    if (auto it = node.attr().find("container"); it != node.attr().end()) {
+      container = it->second.s();
+    }
+    if (auto it = node.attr().find("shared_name");
+        it != node.attr().end() && !it->second.s().empty()) {
+      shared_name = it->second.s();
+    }
+    variables.push_back({std::move(container), std::move(shared_name)});
+  }
+  return variables;
+}
+
+int64_t ShareVariables(const DeviceMgr& device_mgr,
+                       absl::Span<const VariableName> variables,
+                       int64_t min_bytes, SharedVariableStore& store) {
+  // Drops the values of the unloaded SavedModels first.
+  store.Prune();
+
+  int64_t num_shared_bytes = 0;
+  for (Device* device : device_mgr.ListDevices()) {
+    if (device->device_type() != DEVICE_CPU) continue;
+    ResourceMgr* resource_mgr = device->resource_manager();
+    for (const auto& [container, name] : variables) {
+      Var* var = nullptr;
+      if (!resource_mgr
+               ->Lookup<Var>(container.empty()
+                                 ? resource_mgr->default_container()
+                                 : container,
+                             name, &var)
+               .ok()) {
+        continue;
+      }
+      core::ScopedUnref unref(var);
+      mutex_lock lock(*var->mu());
+      Tensor* tensor = var->tensor();
+      if (!var->is_initialized || !tensor->IsInitialized() ||
+          !DataTypeCanUseMemcpy(tensor->dtype()) ||
+          tensor->TotalBytes() < min_bytes) {
+        continue;
+      }
+      Tensor shared = store.Share(*tensor);
+      if (!shared.SharesBufferWith(*tensor)) {
+        num_shared_bytes += tensor->TotalBytes();
+        *tensor = std::move(shared);
+      }
+    }
+  }
+  return num_shared_bytes;
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_UTILS_SHARED_VARIABLE_STORE_H_
+#define TENSORFLOW_CORE_TFRT_SAVED_MODEL_UTILS_SHARED_VARIABLE_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+// A content-addressed store of variable values, so that the SavedModels loaded
+// in a process, e.g. several versions of a model during a rollout, hold a
+// single copy of the variables they have in common.
+//
+// The variables share their buffers with the store. This is safe because the
+// resource variable ops copy the buffer of a variable before updating it if it
+// is shared. The store drops a value when no variable uses it anymore.
+//
+// This class is thread-safe.
+class SharedVariableStore {
+ public:
+  // Returns the store shared by all SavedModels in the process.
+  static SharedVariableStore& Global();
+
+  // Returns a tensor equal to `tensor` that shares its buffer with the equal
+  // tensor in the store, if any. Otherwise adds `tensor` to the store and
+  // returns it. `tensor` must have a dtype that can be memcpy'ed.
+  Tensor Share(const Tensor& tensor) TF_LOCKS_EXCLUDED(mu_);
+
+  // Drops the tensors that are only referenced by the store.
+  void Prune() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of tensors in the store.
+  size_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable mutex mu_;
+  // Maps the fingerprints of the dtype, shape and contents of the tensors to
+  // the tensors.
+  absl::flat_hash_map<uint64_t, std::vector<Tensor>> tensors_
+      TF_GUARDED_BY(mu_);
+};
+
+// The container and the shared name of a resource variable.
+using VariableName = std::pair<std::string, std::string>;
+
+// Returns the names of the resource variables of the VarHandleOps in
+// `graph_def`.
+std::vector<VariableName> GetResourceVariableNames(const GraphDef& graph_def);
+
+// Makes the initialized `variables` in the resource managers of the CPU devices
+// of `device_mgr` share their values with the equal values in `store`. The
+// values smaller than `min_bytes` are left alone. Returns the number of bytes
+// of the values that got replaced by the ones in `store`.
+int64_t ShareVariables(const DeviceMgr& device_mgr,
+                       absl::Span<const VariableName> variables,
+                       int64_t min_bytes, SharedVariableStore& store);
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_SAVED_MODEL_UTILS_SHARED_VARIABLE_STORE_H_
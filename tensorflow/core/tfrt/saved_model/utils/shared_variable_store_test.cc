@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/saved_model/utils/shared_variable_store.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+std::unique_ptr<DeviceMgr> CreateDeviceMgr() {
+  return std::make_unique<StaticDeviceMgr>(DeviceFactory::NewDevice(
+      "CPU", SessionOptions(), "/job:localhost/replica:0/task:0"));
+}
+
+Tensor CreateVariable(const DeviceMgr& device_mgr, const std::string& name,
+                      const Tensor& value) {
+  ResourceMgr* resource_mgr = device_mgr.ListDevices()[0]->resource_manager();
+  Var* var = new Var(value.dtype());
+  *var->tensor() = tensor::DeepCopy(value);
+  var->is_initialized = true;
+  TF_CHECK_OK(
+      resource_mgr->Create(resource_mgr->default_container(), name, var));
+  return *var->tensor();
+}
+
+Tensor GetVariable(const DeviceMgr& device_mgr, const std::string& name) {
+  ResourceMgr* resource_mgr = device_mgr.ListDevices()[0]->resource_manager();
+  Var* var = nullptr;
+  TF_CHECK_OK(resource_mgr->Lookup<Var>(resource_mgr->default_container(),
+                                        name, &var));
+  core::ScopedUnref unref(var);
+  return *var->tensor();
+}
+
+TEST(SharedVariableStoreTest, SharesEqualTensors) {
+  SharedVariableStore store;
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor b = tensor::DeepCopy(a);
+  Tensor c = test::AsTensor<float>({1, 2, 3, 5});
+  Tensor d = test::AsTensor<float>({1, 2, 3, 4}, TensorShape({2, 2}));
+
+  EXPECT_TRUE(store.Share(a).SharesBufferWith(a));
+  EXPECT_TRUE(store.Share(b).SharesBufferWith(a));
+  EXPECT_TRUE(store.Share(c).SharesBufferWith(c));
+  EXPECT_TRUE(store.Share(d).SharesBufferWith(d));
+  EXPECT_EQ(store.size(), 3);
+}
+
+TEST(SharedVariableStoreTest, PrunesUnusedTensors) {
+  SharedVariableStore store;
+  {
+    Tensor a = test::AsTensor<float>({1, 2, 3, 4});
+    store.Share(a);
+    store.Prune();
+    EXPECT_EQ(store.size(), 1);
+  }
+  store.Prune();
+  EXPECT_EQ(store.size(), 0);
+}
+
+TEST(SharedVariableStoreTest, GetResourceVariableNames) {
+  GraphDef graph_def;
+  NodeDef* var = graph_def.add_node();
+  var->set_name("var");
+  var->set_op("VarHandleOp");
+  NodeDef* shared_var = graph_def.add_node();
+  shared_var->set_name("shared_var");
+  shared_var->set_op("VarHandleOp");
+  (*shared_var->mutable_attr())["container"].set_s("container");
+  (*shared_var->mutable_attr())["shared_name"].set_s("shared_name");
+  graph_def.add_node()->set_op("Const");
+
+  EXPECT_THAT(GetResourceVariableNames(graph_def),
+              ElementsAre(Pair("", "var"), Pair("container", "shared_name")));
+}
+
+TEST(SharedVariableStoreTest, ShareVariables) {
+  SharedVariableStore store;
+  const Tensor value = test::AsTensor<float>({1, 2, 3, 4});
+  const Tensor other_value = test::AsTensor<float>({5, 6, 7, 8});
+  const std::vector<VariableName> variables = {
+      {"", "x"}, {"", "y"}, {"", "small"}, {"", "missing"}};
+
+  auto device_mgr1 = CreateDeviceMgr();
+  CreateVariable(*device_mgr1, "x", value);
+  CreateVariable(*device_mgr1, "y", other_value);
+  CreateVariable(*device_mgr1, "small", test::AsScalar<float>(1));
+  EXPECT_EQ(ShareVariables(*device_mgr1, variables, /*min_bytes=*/16, store),
+            0);
+
+  auto device_mgr2 = CreateDeviceMgr();
+  CreateVariable(*device_mgr2, "x", value);
+  CreateVariable(*device_mgr2, "y", value);
+  CreateVariable(*device_mgr2, "small", test::AsScalar<float>(1));
+  EXPECT_EQ(ShareVariables(*device_mgr2, variables, /*min_bytes=*/16, store),
+            32);
+
+  const Tensor x1 = GetVariable(*device_mgr1, "x");
+  EXPECT_TRUE(GetVariable(*device_mgr2, "x").SharesBufferWith(x1));
+  EXPECT_TRUE(GetVariable(*device_mgr2, "y").SharesBufferWith(x1));
+  EXPECT_FALSE(GetVariable(*device_mgr2, "small")
+                   .SharesBufferWith(GetVariable(*device_mgr1, "small")));
+  test::ExpectTensorEqual<float>(GetVariable(*device_mgr2, "y"), value);
+  EXPECT_EQ(store.size(), 2);
+
+  // The values of the first device manager are dropped once it is gone, but
+  // the shared one is still used by the second one.
+  device_mgr1.reset();
+  store.Prune();
+  EXPECT_EQ(store.size(), 1);
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -16,20 +16,29 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cctype>
+#include <cstdlib>
 #include <map>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/autotune_maps/matmul_autotune_maps.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/lib/strings/proto_serialization.h"
 #include "tsl/protobuf/dnn.pb.h"
 
@@ -169,9 +178,109 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+#if GOOGLE_CUDA || TF_HIPBLASLT
+BlasLtMatmulParametersProto MatmulParametersToProto(
+    const BlasLtMatmulPlanParams &params) {
+  BlasLtMatmulParametersProto proto;
+  proto.set_dtype(static_cast<int32>(params.dtype));
+  proto.set_m(params.m);
+  proto.set_n(params.n);
+  proto.set_k(params.k);
+  proto.set_trans_a(static_cast<int32>(params.trans_a));
+  proto.set_trans_b(static_cast<int32>(params.trans_b));
+  proto.set_batch_count(params.batch_count);
+  proto.set_broadcast_a(params.broadcast_a);
+  proto.set_broadcast_b(params.broadcast_b);
+  proto.set_epilogue(static_cast<int32>(params.epilogue));
+  return proto;
+}
+
+BlasLtMatmulPlanParams MatmulParametersFromProto(
+    const BlasLtMatmulParametersProto &proto) {
+  BlasLtMatmulPlanParams params;
+  params.dtype = static_cast<se::blas::DataType>(proto.dtype());
+  params.m = proto.m();
+  params.n = proto.n();
+  params.k = proto.k();
+  params.trans_a = static_cast<se::blas::Transpose>(proto.trans_a());
+  params.trans_b = static_cast<se::blas::Transpose>(proto.trans_b());
+  params.batch_count = proto.batch_count();
+  params.broadcast_a = proto.broadcast_a();
+  params.broadcast_b = proto.broadcast_b();
+  params.epilogue = static_cast<se::gpu::BlasLt::Epilogue>(proto.epilogue());
+  return params;
+}
+
+StatusOr<MatmulMapProto> MatmulMapToProto(
+    const AutoTuneBatchMatmul::AutotuneType &autotune_map) {
+  MatmulMapProto proto;
+  // Sorts the entries by their serialized key, as in ConvMapToProto.
+  std::map<string, MatmulMapProto::Entry> sorted_map;
+  for (auto const &p : autotune_map.GetMap()) {
+    MatmulMapProto::Entry kv;
+    *kv.mutable_key() = MatmulParametersToProto(p.first);
+    kv.set_algorithm(p.second.algorithm());
+    std::string serialized_params;
+    TF_RET_CHECK(
+        tsl::SerializeToStringDeterministic(kv.key(), &serialized_params));
+    sorted_map.insert(std::make_pair(std::move(serialized_params), kv));
+  }
+  for (auto const &p : sorted_map) {
+    *proto.add_kv_pairs() = p.second;
+  }
+  return proto;
+}
+
+void PopulateMatmulMap(const MatmulMapProto &m,
+                       AutoTuneBatchMatmul::AutotuneType *autotune_map) {
+  for (const MatmulMapProto::Entry &kv : m.kv_pairs()) {
+    autotune_map->Insert(MatmulParametersFromProto(kv.key()),
+                         se::blas::AlgorithmConfig(kv.algorithm()));
+  }
+}
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+namespace {
+
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  std::string serialized;
+  Status status = ReadFileToString(Env::Default(), path, &serialized);
+  if (errors::IsNotFound(status)) {
+    VLOG(1) << "No autotune maps saved in " << path;
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(LoadSerializedAutotuneMaps(serialized));
+  VLOG(1) << "Loaded the autotune maps from " << path;
+  return OkStatus();
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+  // Keeps the entries saved by other processes since this one loaded them.
+  Status status = LoadAutotuneMapsFromFile(path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Overwriting the autotune maps in " << path << ": "
+                 << status;
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+  Env *env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(io::Dirname(path))));
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file for ", path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, serialized));
+  TF_RETURN_IF_ERROR(env->RenameFile(tmp_path, path));
+  VLOG(1) << "Saved the autotune maps to " << path;
+  return OkStatus();
+}
+
+}  // namespace
+
 Status SerializeAutotuneMaps(std::string *output) {
   AutotuneMapsProto proto;
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -180,6 +289,10 @@ Status SerializeAutotuneMaps(std::string *output) {
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  TF_ASSIGN_OR_RETURN(*proto.mutable_matmul_map(),
+                      MatmulMapToProto(*AutoTuneBatchMatmul::GetInstance()));
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return OkStatus();
 }
@@ -198,6 +311,9 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
                                      FusedConvAutotuneMap::GetInstance()));
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  PopulateMatmulMap(proto.matmul_map(), AutoTuneBatchMatmul::GetInstance());
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
   // TODO(b/189530096): Populate autotune maps for more ops.
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   return OkStatus();
@@ -208,6 +324,91 @@ void ResetAutotuneMaps() {
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  AutoTuneBatchMatmul::GetInstance()->ClearMap();
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+}
+
+StatusOr<std::string> AutotuneMapsFileName() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  TF_ASSIGN_OR_RETURN(
+      se::Platform * platform,
+      se::MultiPlatformManager::PlatformWithName(se::GpuPlatformName()));
+  if (platform->VisibleDeviceCount() <= 0) {
+    return errors::FailedPrecondition("No visible GPU");
+  }
+  std::set<std::string> models;
+  for (int i = 0; i < platform->VisibleDeviceCount(); i++) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<se::DeviceDescription> device_desc,
+                        platform->DescriptionForDevice(i));
+    models.insert(device_desc->model_str());
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<se::DeviceDescription> device_desc,
+                      platform->DescriptionForDevice(0));
+  std::string dnn_version = "none";
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                      platform->ExecutorForDevice(0));
+  if (se::dnn::DnnSupport *dnn = executor->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+    if (version.ok()) {
+      dnn_version = absl::StrCat(version->major_version(), ".",
+                                 version->minor_version(), ".",
+                                 version->patch());
+    }
+  }
+  std::string file_name = absl::StrCat(
+      str_util::Join(models, "+"), "_driver", device_desc->driver_version(),
+      "_runtime", device_desc->runtime_version(), "_dnn", dnn_version, ".pb");
+  for (char &c : file_name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' &&
+        c != '_' && c != '+') {
+      c = '-';
+    }
+  }
+  return file_name;
+#else
+  return errors::Unimplemented("Autotune maps are only supported on GPUs");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+Status LoadAutotuneMapsFromDirectory(absl::string_view dir) {
+  TF_ASSIGN_OR_RETURN(std::string file_name, AutotuneMapsFileName());
+  return LoadAutotuneMapsFromFile(io::JoinPath(dir, file_name));
+}
+
+Status SaveAutotuneMapsToDirectory(absl::string_view dir) {
+  TF_ASSIGN_OR_RETURN(std::string file_name, AutotuneMapsFileName());
+  return SaveAutotuneMapsToFile(io::JoinPath(dir, file_name));
+}
+
+void MaybeEnablePersistentAutotuneMaps() {
+  // The path is computed once, as the GPUs may no longer be usable at exit.
+  static const std::string *path = []() -> const std::string * {
+    std::string dir;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_MAPS_DIR", "", &dir));
+    if (dir.empty()) return nullptr;
+    StatusOr<std::string> file_name = AutotuneMapsFileName();
+    if (!file_name.ok()) {
+      LOG(WARNING) << "Not persisting the autotune maps: "
+                   << file_name.status();
+      return nullptr;
+    }
+    auto *path = new std::string(io::JoinPath(dir, *file_name));
+    Status status = LoadAutotuneMapsFromFile(*path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the autotune maps from " << *path << ": "
+                   << status;
+    }
+    return path;
+  }();
+  static const bool registered = path != nullptr && std::atexit([] {
+    Status status = SaveAutotuneMapsToFile(*path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to save the autotune maps to " << *path << ": "
+                   << status;
+    }
+  }) == 0;
+  (void)registered;
 }
 
 }  // namespace tensorflow
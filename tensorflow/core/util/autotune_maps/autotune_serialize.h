@@ -27,7 +27,9 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 
@@ -43,6 +45,26 @@ Status SerializeAutotuneMaps(std::string* output);
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
+// Returns the name of the file to persist the autotune maps of this process
+// in, which identifies the models of the visible GPUs and the versions of the
+// GPU driver, runtime and DNN library the autotune results are valid for.
+StatusOr<std::string> AutotuneMapsFileName();
+
+// Loads the autotune maps persisted by SaveAutotuneMapsToDirectory in `dir`
+// for the GPUs and libraries of this process. `dir` may be any path supported
+// by Env, e.g. on a remote file system shared by a fleet. It is not an error
+// if there is no such file yet.
+Status LoadAutotuneMapsFromDirectory(absl::string_view dir);
+
+// Saves all the autotune maps to `dir`, replacing the file atomically so that
+// several processes may save to the same directory.
+Status SaveAutotuneMapsToDirectory(absl::string_view dir);
+
+// If the TF_AUTOTUNE_MAPS_DIR environment variable is set, loads the autotune
+// maps from that directory, and saves them back there when the process exits.
+// Only the first call has an effect.
+void MaybeEnablePersistentAutotuneMaps();
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
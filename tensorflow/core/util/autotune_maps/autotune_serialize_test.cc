@@ -19,11 +19,14 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/autotune_maps/matmul_autotune_maps.h"
 #include "tensorflow/core/util/tensor_format.h"
 
 namespace tensorflow {
@@ -180,6 +183,60 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+#if GOOGLE_CUDA
+// Tests that the matmul autotune map survives a round trip.
+TEST(AutotuneSerializeTest, MatmulConsistency) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  BlasLtMatmulPlanParams params{se::blas::DataType::kFloat,
+                                /*m=*/16,
+                                /*n=*/32,
+                                /*k=*/64,
+                                se::blas::Transpose::kTranspose,
+                                se::blas::Transpose::kNoTranspose,
+                                /*batch_count=*/4,
+                                /*broadcast_a=*/true,
+                                /*broadcast_b=*/false,
+                                se::gpu::BlasLt::Epilogue::kBias};
+  AutoTuneBatchMatmul::GetInstance()->Insert(params,
+                                             se::blas::AlgorithmConfig(3));
+
+  std::string serialized_string;
+  TF_CHECK_OK(SerializeAutotuneMaps(&serialized_string));
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadSerializedAutotuneMaps(serialized_string));
+  auto matmul_map = AutoTuneBatchMatmul::GetInstance()->GetMap();
+  ASSERT_EQ(matmul_map.size(), 1);
+  EXPECT_TRUE(matmul_map.begin()->first == params);
+  EXPECT_EQ(matmul_map.begin()->second.algorithm(), 3);
+}
+
+// Tests that the autotune maps can be saved to and loaded from a directory.
+TEST(AutotuneSerializeTest, Directory) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  const std::string dir = io::JoinPath(testing::TmpDir(), "autotune_maps");
+  // There is nothing to load yet.
+  TF_CHECK_OK(LoadAutotuneMapsFromDirectory(dir));
+
+  BlasLtMatmulPlanParams params{se::blas::DataType::kHalf,
+                                /*m=*/8,
+                                /*n=*/8,
+                                /*k=*/8,
+                                se::blas::Transpose::kNoTranspose,
+                                se::blas::Transpose::kNoTranspose};
+  AutoTuneBatchMatmul::GetInstance()->Insert(params,
+                                             se::blas::AlgorithmConfig(1));
+  TF_CHECK_OK(SaveAutotuneMapsToDirectory(dir));
+  const std::string file_name = AutotuneMapsFileName().value();
+  TF_CHECK_OK(Env::Default()->FileExists(io::JoinPath(dir, file_name)));
+
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromDirectory(dir));
+  EXPECT_EQ(AutoTuneBatchMatmul::GetInstance()->GetMap().size(), 1);
+}
+#endif  // GOOGLE_CUDA
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
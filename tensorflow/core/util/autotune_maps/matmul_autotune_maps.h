@@ -0,0 +1,54 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// For Google-internal use only.
+//
+// This file defines the map data structure for storing autotuning results for
+// the cuBLASLt matmuls of the MatMul, BatchMatMul and fused MatMul kernels.
+//
+// The key of the map identifies a matmul while the value is the index of the
+// autotuned algorithm among those returned by GetPlanAndAlgorithms.
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_MATMUL_AUTOTUNE_MAPS_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_MATMUL_AUTOTUNE_MAPS_H_
+
+#if TENSORFLOW_USE_ROCM
+#include "rocm/rocm_config.h"
+#endif
+
+#if GOOGLE_CUDA || TF_HIPBLASLT
+#include <string>
+
+#include "absl/hash/hash.h"
+#include "tensorflow/core/kernels/gpu_utils.h"
+#include "tensorflow/core/kernels/matmul_util.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+// A dummy type to group matmul autotune results together.
+struct BlasLtMatmulAutoTuneGroup {
+  static string name() { return "MatmulLt"; }
+};
+
+using AutoTuneBatchMatmul =
+    AutotuneSingleton<BlasLtMatmulAutoTuneGroup, BlasLtMatmulPlanParams,
+                      se::blas::AlgorithmConfig,
+                      absl::Hash<BlasLtMatmulPlanParams>>;
+
+}  // namespace tensorflow
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_MATMUL_AUTOTUNE_MAPS_H_
@@ -0,0 +1,78 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_UTIL_CSV_SCANNER_H_
+#define TENSORFLOW_CORE_UTIL_CSV_SCANNER_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace csv_internal {
+
+constexpr uint64_t kLowBits = 0x0101010101010101ULL;
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+// Sets the high bit of the bytes of `word` which are equal to `c`. Bytes after
+// the first match may be marked spuriously, so only the lowest marked byte is
+// meaningful.
+inline uint64_t MatchByte(uint64_t word, char c) {
+  const uint64_t x = word ^ (kLowBits * static_cast<uint8_t>(c));
+  return (x - kLowBits) & ~x & kHighBits;
+}
+
+}  // namespace csv_internal
+
+// Returns the position of the first byte of `data` at or after `pos` which
+// ends an unquoted CSV field: `delim`, '\n', '\r' or, if `use_quote_delim`,
+// '"'. Returns `data.size()` if there is none.
+//
+// Bytes are classified a machine word at a time, so that fields can be copied
+// in bulk instead of byte by byte.
+inline size_t FindCsvFieldEnd(StringPiece data, size_t pos, char delim,
+                              bool use_quote_delim) {
+  // Without quoting, matching '\n' twice keeps the loop branch-free.
+  const char quote = use_quote_delim ? '"' : '\n';
+  const char* const bytes = data.data();
+  const size_t size = data.size();
+  size_t i = pos;
+  if (port::kLittleEndian) {
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      const uint64_t matches = csv_internal::MatchByte(word, delim) |
+                               csv_internal::MatchByte(word, '\n') |
+                               csv_internal::MatchByte(word, '\r') |
+                               csv_internal::MatchByte(word, quote);
+      if (matches != 0) {
+        return i + absl::countr_zero(matches) / 8;
+      }
+    }
+  }
+  for (; i < size; ++i) {
+    const char ch = bytes[i];
+    if (ch == delim || ch == '\n' || ch == '\r' || ch == quote) {
+      return i;
+    }
+  }
+  return size;
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_CSV_SCANNER_H_
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/csv_scanner.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Reference implementation which scans a byte at a time.
+size_t FindCsvFieldEndSlow(StringPiece data, size_t pos, char delim,
+                           bool use_quote_delim) {
+  for (; pos < data.size(); ++pos) {
+    const char ch = data[pos];
+    if (ch == delim || ch == '\n' || ch == '\r' ||
+        (use_quote_delim && ch == '"')) {
+      return pos;
+    }
+  }
+  return data.size();
+}
+
+TEST(CsvScannerTest, FindsFieldEnd) {
+  EXPECT_EQ(FindCsvFieldEnd("abc,def", 0, ',', true), 3);
+  EXPECT_EQ(FindCsvFieldEnd("abc,def", 4, ',', true), 7);
+  EXPECT_EQ(FindCsvFieldEnd("abcdefghijk\r\n", 0, ',', true), 11);
+  EXPECT_EQ(FindCsvFieldEnd("abcdefghijklmnop|q", 0, '|', true), 16);
+  EXPECT_EQ(FindCsvFieldEnd("", 0, ',', true), 0);
+}
+
+TEST(CsvScannerTest, Quotes) {
+  EXPECT_EQ(FindCsvFieldEnd("abcdefgh\"ij,", 0, ',', true), 8);
+  EXPECT_EQ(FindCsvFieldEnd("abcdefgh\"ij,", 0, ',', false), 11);
+}
+
+TEST(CsvScannerTest, MatchesByteAtATimeScan) {
+  const std::string alphabet = "ab,|\"\n\r\x80\xff";
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data += alphabet[(i * 7 + i / 13) % alphabet.size()];
+  }
+  for (size_t pos = 0; pos <= data.size(); ++pos) {
+    for (char delim : {',', '|', '\t'}) {
+      for (bool use_quote_delim : {true, false}) {
+        EXPECT_EQ(FindCsvFieldEnd(data, pos, delim, use_quote_delim),
+                  FindCsvFieldEndSlow(data, pos, delim, use_quote_delim));
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
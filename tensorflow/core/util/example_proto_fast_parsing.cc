@@ -15,12 +15,14 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/numeric/bits.h"
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
@@ -113,6 +115,68 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+template <typename A>
+auto Reserve(A* a, size_t n) -> decltype(a->reserve(n), void()) {
+  a->reserve(a->size() + n);
+}
+
+template <typename A>
+void Reserve(A&& a, size_t n) {}
+
+// High bit of every byte of a little-endian machine word. Varint bytes with the
+// high bit clear terminate a value.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints terminating in `[begin, end)`.
+size_t CountVarints(const uint8* begin, const uint8* end) {
+  size_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    count += absl::popcount(~word & kVarintContinuationBits);
+  }
+  for (; p != end; ++p) {
+    count += (*p & 0x80) == 0;
+  }
+  return count;
+}
+
+// Decodes the packed varints in `[begin, end)` and appends them to `result`.
+// Packed int64 features are dominated by small values, so the bytes are
+// scanned a machine word at a time and runs of eight single-byte varints are
+// decoded without branching on each byte. Returns false if the input is
+// malformed.
+template <typename Result>
+bool DecodePackedVarint64s(const uint8* begin, const uint8* end,
+                           Result* result) {
+  Reserve(result, CountVarints(begin, end));
+  const uint8* p = begin;
+  while (p != end) {
+    if (end - p >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          result->push_back(static_cast<int64_t>(p[i]));
+        }
+        p += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      // A varint is at most 10 bytes long.
+      if (p == end || shift >= 70) return false;
+      const uint8 byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    result->push_back(static_cast<int64_t>(value));
+  }
+  return true;
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -303,15 +367,21 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        const void* packed_data;
+        int size;
+        if (packed_length > 0) {
+          if (!stream.GetDirectBufferPointer(&packed_data, &size) ||
+              static_cast<uint32>(size) < packed_length) {
+            return false;
+          }
+          const uint8* packed_begin = static_cast<const uint8*>(packed_data);
+          if (!DecodePackedVarint64s(packed_begin,
+                                     packed_begin + packed_length,
+                                     int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -172,6 +172,27 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64sOfMixedWidths) {
+  // Runs of single-byte varints take a different decoding path than values
+  // which need several bytes, so lists mix both at different offsets.
+  for (int size = 0; size < 40; ++size) {
+    Example example;
+    Int64List* int64_list =
+        (*example.mutable_features()->mutable_feature())["int64_list"]
+            .mutable_int64_list();
+    for (int i = 0; i < size; ++i) {
+      if (i % 11 == 5) {
+        int64_list->add_value(-i);
+      } else if (i % 7 == 3) {
+        int64_list->add_value(int64_t{1} << (i + 20));
+      } else {
+        int64_list->add_value(i);
+      }
+    }
+    TestCorrectness(Serialize(example));
+  }
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
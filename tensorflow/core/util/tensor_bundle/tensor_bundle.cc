@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -73,12 +75,17 @@ static const int kBufferSize = 1024 * 1024;
 // bundle.
 const char* const kHeaderEntryKey = "";
 
+const int kMemmappableDataAlignment = 64;
+
 // The size threshold for multi-threaded tensor loading.
-const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 32;
+const int64_t kLargeTensorThreshold = static_cast<int64_t>(64) << 20;
 // Maximum number of threads to load the tensor from the file.
 const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
-const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
+const int64_t kMinSectionSize = static_cast<int64_t>(16) << 20;
+// The sections start at multiples of this file offset, so that the reads of
+// neighboring sections do not share pages or file system blocks.
+const int64_t kSectionAlignment = 1 << 20;
 
 namespace {
 
@@ -422,6 +429,69 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// A read-only tensor buffer in a memory mapped data file, which it keeps
+// mapped. It does not own its memory, so that Tensor::RefCountIsOne() is false
+// and kernels never forward it to outputs they write.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MappedTensorBuffer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Returns whether the elements of "intersection", a sub-slice of
+// "stored_slice", are a strict subset of the stored slice that is contiguous
+// in its row-major layout, and sets "first_element" to the index of their
+// first element in the stored slice.
+bool GetContiguousRangeInSlice(const TensorShape& full_shape,
+                               const TensorSlice& stored_slice,
+                               const TensorSlice& intersection,
+                               int64_t* first_element) {
+  const int dims = full_shape.dims();
+  std::vector<int64_t> starts(dims);
+  std::vector<int64_t> lengths(dims);
+  std::vector<int64_t> stored_lengths(dims);
+  int last_partial_dim = -1;
+  for (int d = 0; d < dims; ++d) {
+    const int64_t stored_start =
+        stored_slice.IsFullAt(d) ? 0 : stored_slice.start(d);
+    stored_lengths[d] = stored_slice.IsFullAt(d) ? full_shape.dim_size(d)
+                                                 : stored_slice.length(d);
+    starts[d] =
+        (intersection.IsFullAt(d) ? 0 : intersection.start(d)) - stored_start;
+    lengths[d] = intersection.IsFullAt(d) ? full_shape.dim_size(d)
+                                          : intersection.length(d);
+    if (lengths[d] != stored_lengths[d]) last_partial_dim = d;
+  }
+  if (last_partial_dim < 0) return false;
+  // The range is contiguous if it spans the stored slice in the minor
+  // dimensions and a single index in the major ones.
+  for (int d = 0; d < last_partial_dim; ++d) {
+    if (lengths[d] != 1) return false;
+  }
+  *first_element = 0;
+  int64_t stride = 1;
+  for (int d = dims - 1; d >= 0; --d) {
+    *first_element += starts[d] * stride;
+    stride *= stored_lengths[d];
+  }
+  return true;
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -898,80 +968,16 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
 
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
-    size_t unused_bytes_read;
-    if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      if (!enable_multi_threading_for_testing_ &&
-          entry.size() < kLargeTensorThreshold) {
-        TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-            entry.offset(), entry.size(), &sp, backing_buffer));
-        if (sp.data() != backing_buffer) {
-          memmove(backing_buffer, sp.data(), entry.size());
-        }
-      } else {
-        int64_t section_size = kMinSectionSize;
-        int64_t thread_pool_size =
-            (entry.size() + kMinSectionSize - 1) / kMinSectionSize;
-        if (thread_pool_size > kMaxFileReadThreads ||
-            enable_multi_threading_for_testing_) {
-          thread_pool_size = kMaxFileReadThreads;
-          section_size =
-              (entry.size() + kMaxFileReadThreads - 1) / kMaxFileReadThreads;
-        }
-
-        std::vector<Status> statuses(thread_pool_size);
-        auto reader_pool = std::make_unique<thread::ThreadPool>(
-            Env::Default(), "restore_large_tensor", thread_pool_size);
-
-        for (int i = 0; i < thread_pool_size; ++i) {
-          reader_pool->Schedule([&, i]() {
-            int64_t offset = i * section_size;
-            int64_t size = i == thread_pool_size - 1 ? entry.size() - offset
-                                                     : section_size;
-            std::unique_ptr<RandomAccessFile> section_reader = nullptr;
-            StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
-                !file_status.ok()) {
-              statuses[i] = file_status;
-              return;
-            }
-
-            auto backing_buffer_current_pos = backing_buffer + offset;
-            auto status = section_reader->Read(entry.offset() + offset, size,
-                                               &sp, backing_buffer_current_pos);
-            if (sp.data() != backing_buffer_current_pos) {
-              memmove(backing_buffer_current_pos, sp.data(), size);
-            }
-            statuses[i] = std::move(status);
-          });
-        }
-        for (const auto& status : statuses) {
-          TF_RETURN_IF_ERROR(status);
-        }
-      }
-    } else {
-      TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
-                                                   &unused_bytes_read));
-    }
+    TF_RETURN_IF_ERROR(ReadBytes(buffered_file, entry.offset(), entry.size(),
+                                 backing_buffer));
     // Note that we compute the checksum *before* byte-swapping. The checksum
     // should be on the bytes in the order they appear in the file.
     actual_crc32c = crc32c::Value(backing_buffer, entry.size());
@@ -1010,6 +1016,116 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return OkStatus();
 }
 
+Status BundleReader::GetDataFile(int32_t shard_id,
+                                 io::InputBuffer** buffered_file) {
+  // Open the data file if it has not been opened.
+  io::InputBuffer*& data_file = data_[shard_id];
+  if (data_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    Status status = env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file);
+    if (!status.ok()) {
+      data_.erase(shard_id);
+      return status;
+    }
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_file = new io::InputBuffer(file.release(), kBufferSize);
+  }
+  *buffered_file = data_file;
+  return OkStatus();
+}
+
+Status BundleReader::ReadBytes(io::InputBuffer* buffered_file, int64_t offset,
+                               int64_t size, char* backing_buffer) {
+  if (size <= kBufferSize) {
+    size_t unused_bytes_read;
+    TF_RETURN_IF_ERROR(buffered_file->Seek(offset));
+    return buffered_file->ReadNBytes(size, backing_buffer, &unused_bytes_read);
+  }
+  StringPiece sp;
+  if (!enable_multi_threading_for_testing_ && size < kLargeTensorThreshold) {
+    TF_RETURN_IF_ERROR(
+        buffered_file->file()->Read(offset, size, &sp, backing_buffer));
+    if (sp.data() != backing_buffer) {
+      memmove(backing_buffer, sp.data(), size);
+    }
+    return OkStatus();
+  }
+
+  int64_t section_size = kMinSectionSize;
+  int64_t thread_pool_size = (size + kMinSectionSize - 1) / kMinSectionSize;
+  if (thread_pool_size > kMaxFileReadThreads ||
+      enable_multi_threading_for_testing_) {
+    thread_pool_size = kMaxFileReadThreads;
+    section_size = (size + kMaxFileReadThreads - 1) / kMaxFileReadThreads;
+  }
+
+  // Returns the offset in the range of the start of the i-th section.
+  const int64_t alignment =
+      enable_multi_threading_for_testing_ ? 1 : kSectionAlignment;
+  auto section_start = [&](int64_t i) -> int64_t {
+    if (i == 0) return 0;
+    if (i == thread_pool_size) return size;
+    const int64_t file_offset =
+        (offset + i * section_size + alignment - 1) / alignment * alignment;
+    return std::min<int64_t>(file_offset - offset, size);
+  };
+
+  std::vector<Status> statuses(thread_pool_size);
+  {
+    auto reader_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "restore_large_tensor", thread_pool_size);
+    // RandomAccessFile::Read() is safe for concurrent use, so the sections are
+    // read from the file already opened for the shard.
+    RandomAccessFile* file = buffered_file->file();
+    for (int i = 0; i < thread_pool_size; ++i) {
+      const int64_t section_offset = section_start(i);
+      const int64_t section_bytes = section_start(i + 1) - section_offset;
+      if (section_bytes == 0) continue;
+      reader_pool->Schedule([&statuses, file, backing_buffer, offset,
+                             section_offset, section_bytes, i]() {
+        StringPiece sp;
+        char* backing_buffer_current_pos = backing_buffer + section_offset;
+        Status status = file->Read(offset + section_offset, section_bytes, &sp,
+                                   backing_buffer_current_pos);
+        if (status.ok() && sp.size() != section_bytes) {
+          status = errors::DataLoss("Read ", sp.size(), " of ", section_bytes,
+                                    " bytes of a tensor section");
+        }
+        if (status.ok() && sp.data() != backing_buffer_current_pos) {
+          memmove(backing_buffer_current_pos, sp.data(), section_bytes);
+        }
+        statuses[i] = std::move(status);
+      });
+    }
+  }
+  for (const auto& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
+Status BundleReader::GetValueRange(const BundleEntryProto& entry,
+                                   int64_t first_element, Tensor* val) {
+  const int64_t offset = first_element * DataTypeSize(entry.dtype());
+  const int64_t size = val->TotalBytes();
+  if (offset + size > entry.size()) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                            "; stored size ", entry.size(),
+                            "; expected at least ", offset + size, " bytes");
+  }
+  if (size == 0) return OkStatus();
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+  TF_RETURN_IF_ERROR(
+      ReadBytes(buffered_file, entry.offset() + offset, size,
+                const_cast<char*>(val->tensor_data().data())));
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(val));
+  }
+  return OkStatus();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1024,6 +1140,59 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_) {
+    return errors::Unimplemented("Cannot map tensor ", key, " of type ",
+                                 DataTypeString(entry.dtype()));
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(entry.shape(), &shape));
+  const size_t size = shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            size);
+  }
+  if (size == 0) {
+    *val = Tensor(entry.dtype(), shape);
+    return OkStatus();
+  }
+
+  std::shared_ptr<ReadOnlyMemoryRegion>& region =
+      mapped_data_[entry.shard_id()];
+  if (region == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    Status status = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &new_region);
+    if (!status.ok()) {
+      mapped_data_.erase(entry.shard_id());
+      return errors::Unimplemented("Cannot map the data file of ", key, ": ",
+                                   status.message());
+    }
+    region = std::move(new_region);
+  }
+  if (entry.offset() + size > region->length()) {
+    return errors::DataLoss("Tensor ", key, " at offset ", entry.offset(),
+                            " of size ", size,
+                            " exceeds the data file of size ",
+                            region->length());
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return errors::Unimplemented("Cannot map tensor ", key,
+                                 " whose data is not aligned to ",
+                                 EIGEN_MAX_ALIGN_BYTES, " bytes");
+  }
+  *val = Tensor(entry.dtype(), shape,
+                core::RefCountPtr<TensorBuffer>(
+                    new MappedTensorBuffer(region, data, size)));
+  return OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1140,8 +1309,36 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       return status_;
     }
 
-    Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
-    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+    // When the part of the stored slice to copy is contiguous in the file,
+    // e.g. rows of a tensor restored with a different sharding, only that
+    // part is read instead of the whole slice. Its checksum covers the whole
+    // slice, so it is not validated then.
+    TensorSlice source_slice = stored_slice;
+    Tensor source_tensor;
+    TensorSlice intersection;
+    int64_t first_element;
+    if (DataTypeCanUseMemcpy(stored_slice_entry.dtype()) &&
+        stored_slice.Intersect(slice_spec, &intersection) &&
+        GetContiguousRangeInSlice(full_shape, stored_slice, intersection,
+                                  &first_element)) {
+      if (intersection == slice_spec) {
+        VLOG(1) << "Reading the requested slice directly from stored slice "
+                << stored_slice.DebugString()
+                << "; spec: " << slice_spec.DebugString();
+        status_ = GetValueRange(stored_slice_entry, first_element, val);
+        return status_;
+      }
+      TensorShape intersection_shape;
+      status_ = intersection.SliceTensorShape(full_shape, &intersection_shape);
+      if (!status_.ok()) return status_;
+      source_slice = intersection;
+      source_tensor = Tensor(stored_slice_entry.dtype(), intersection_shape);
+      status_ =
+          GetValueRange(stored_slice_entry, first_element, &source_tensor);
+    } else {
+      source_tensor = Tensor(stored_slice_entry.dtype(), stored_slice_shape);
+      status_ = GetValue(stored_slice_entry, &source_tensor);
+    }
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
@@ -1150,8 +1347,8 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 #define HANDLE_COPY(T)                                                 \
   case DataTypeToEnum<T>::value:                                       \
     CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
-        stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
+        full_shape, source_slice, slice_spec,                          \
+        source_tensor.flat<T>().data(), val->flat<T>().data()));       \
     break;
 
       HANDLE_COPY(float)
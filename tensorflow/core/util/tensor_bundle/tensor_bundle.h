@@ -106,6 +106,10 @@ extern const int kTensorBundleVersion;
 // corresponding value is a BundleHeaderProto.
 extern const char* const kHeaderEntryKey;
 
+// The data alignment of bundles whose tensors can be memory mapped by
+// BundleReader::LookupMapped(), whatever EIGEN_MAX_ALIGN_BYTES the reader has.
+extern const int kMemmappableDataAlignment;
+
 // Builds a string-string table of tensor names to BundleEntryProto (metadata).
 //
 // On construction, attempts to create a directory given by the dirname of
@@ -251,6 +255,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensor keyed by "key" as a read-only tensor that points into
+  // the memory mapped data file, so that the tensor is neither allocated nor
+  // read. The pages of the tensor are loaded on first access, and processes
+  // mapping the same file share them. The tensor does not own its memory, so
+  // kernels copy it instead of updating it in place.
+  //
+  // Returns an Unimplemented error if the tensor cannot be mapped, i.e. if it
+  // is partitioned, its dtype cannot be memcpy'd, its data is not aligned (see
+  // kMemmappableDataAlignment), its endianness differs, or the file system
+  // cannot map the data file. Callers can then fall back to Lookup().
+  //
+  // Unlike Lookup(), does not validate the checksum, which would read the whole
+  // tensor.
+  // REQUIRES: status().ok()
+  Status LookupMapped(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -273,6 +293,10 @@ class BundleReader {
   // Looks up a specific slice of a partitioned tensor.
   // It is only required that the stored slices cover the requested slice,
   // namely "slice_spec" is a subset of the union of the stored slices.
+  //
+  // Only reads the part of a stored slice that "slice_spec" covers when that
+  // part is contiguous in the data file, e.g. a range of rows, in which case
+  // the checksum of the stored slice is not validated.
   // REQUIRES: status().ok()
   Status LookupSlice(absl::string_view full_tensor_key,
                      const TensorSlice& slice_spec,
@@ -309,6 +333,23 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the buffered data file of shard "shard_id", which is opened on
+  // first use.
+  Status GetDataFile(int32_t shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // Reads "size" bytes at "offset" of "buffered_file" into "backing_buffer".
+  // Large reads are split into sections that are read in parallel.
+  Status ReadBytes(io::InputBuffer* buffered_file, int64_t offset, int64_t size,
+                   char* backing_buffer) TF_MUST_USE_RESULT;
+
+  // Reads the "val->NumElements()" elements of the tensor described by "entry"
+  // starting at element "first_element" into "val", without validating the
+  // checksum of the tensor.
+  // REQUIRES: DataTypeCanUseMemcpy(entry.dtype())
+  Status GetValueRange(const BundleEntryProto& entry, int64_t first_element,
+                       Tensor* val) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -327,6 +368,9 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
+  // The data files mapped by LookupMapped(), which the mapped tensors share.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
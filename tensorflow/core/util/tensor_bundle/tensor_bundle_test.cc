@@ -648,6 +648,47 @@ TEST(TensorBundleTest, PartitionedVariables) {
   }
 }
 
+TEST(TensorBundleTest, ContiguousPartsOfSlices) {
+  const TensorShape kFullShape({4, 6});
+  // Element (r, c) of the full tensor is 10 * r + c.
+  auto slice_value = [&](const TensorSlice& slice) {
+    TensorShape shape;
+    TF_CHECK_OK(slice.SliceTensorShape(kFullShape, &shape));
+    Tensor val(DT_FLOAT, shape);
+    const int64_t start_row = slice.IsFullAt(0) ? 0 : slice.start(0);
+    const int64_t start_col = slice.IsFullAt(1) ? 0 : slice.start(1);
+    const int64_t cols = shape.dim_size(1);
+    test::FillFn<float>(&val, [&](int offset) -> float {
+      return 10 * (start_row + offset / cols) + start_col + offset % cols;
+    });
+    return val;
+  };
+  const TensorSlice kTopRows = TensorSlice::ParseOrDie("0,2:-");
+  const TensorSlice kBottomRows = TensorSlice::ParseOrDie("2,2:-");
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(writer.Add("full", slice_value(TensorSlice(2))));
+    TF_ASSERT_OK(
+        writer.AddSlice("rows", kFullShape, kTopRows, slice_value(kTopRows)));
+    TF_ASSERT_OK(writer.AddSlice("rows", kFullShape, kBottomRows,
+                                 slice_value(kBottomRows)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  // Rows within a stored slice, rows across stored slices, a part of a row,
+  // and columns, which are not contiguous.
+  for (const char* spec : {"1,1:-", "1,2:-", "3,1:2,3", "-:1,2", "1,2:1,2"}) {
+    const TensorSlice slice = TensorSlice::ParseOrDie(spec);
+    const Tensor expected = slice_value(slice);
+    for (const char* key : {"full", "rows"}) {
+      Tensor val(DT_FLOAT, expected.shape());
+      TF_ASSERT_OK(reader.LookupSlice(key, slice, &val));
+      test::ExpectTensorEqual<float>(val, expected);
+    }
+  }
+}
+
 TEST(TensorBundleTest, EquivalentSliceTest) {
   const TensorShape kFullShape({5, 10});
   const Tensor kExpected(Constant<float>(1., kFullShape));
@@ -1201,6 +1242,34 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = kMemmappableDataAlignment;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped_float;
+  Tensor mapped_int;
+  {
+    BundleReader reader(Env::Default(), Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("float", &mapped_float));
+    TF_ASSERT_OK(reader.LookupMapped("int", &mapped_int));
+    Tensor val;
+    EXPECT_TRUE(errors::IsUnimplemented(reader.LookupMapped("string", &val)));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &val)));
+  }
+  // The mapped tensors outlive the reader.
+  test::ExpectTensorEqual<float>(mapped_float, Constant_2x3<float>(1));
+  test::ExpectTensorEqual<int32>(mapped_int, Constant_2x3<int32>(2));
+  // Kernels must not update the mapped tensors in place.
+  EXPECT_FALSE(mapped_float.RefCountIsOne());
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
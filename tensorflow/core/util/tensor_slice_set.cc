@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_slice_set.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -40,15 +41,26 @@ Status TensorSliceSet::Register(const TensorSlice& slice, const string& tag) {
 
   if (slices_.empty()) {
     slices_hull_ = slice;
+    index_dim_ = slice.dims() > 0 ? 0 : -1;
+    for (int d = 0; d < slice.dims(); ++d) {
+      if (!slice.IsFullAt(d)) {
+        index_dim_ = d;
+        break;
+      }
+    }
   } else {
     // We check if there is any intersection between this slice and any of the
     // registered slices.
     if (slices_hull_.Overlaps(slice)) {
-      for (const auto& x : slices_) {
-        if (slice.Overlaps(x.second.slice)) {
-          return errors::Internal("Overlapping slices: existing slice = ",
-                                  x.first, ", new slice = ", str);
-        }
+      const SliceInfo* overlapping = nullptr;
+      ForEachCandidate(slice, [&](const SliceInfo& info) {
+        if (slice.Overlaps(info.slice)) overlapping = &info;
+        return overlapping == nullptr;
+      });
+      if (overlapping != nullptr) {
+        return errors::Internal("Overlapping slices: existing slice = ",
+                                overlapping->slice.DebugString(),
+                                ", new slice = ", str);
       }
     }
     // No overlap: we can now insert the slice
@@ -56,10 +68,40 @@ Status TensorSliceSet::Register(const TensorSlice& slice, const string& tag) {
   }
 
   TensorSliceSet::SliceInfo info = {slice, tag, result_shape.num_elements()};
-  slices_.insert(std::make_pair(str, info));
+  auto inserted = slices_.insert(std::make_pair(str, info));
+  if (index_dim_ >= 0 && inserted.second) {
+    const auto extent = IndexExtent(slice);
+    index_.emplace(extent.first, &inserted.first->second);
+    max_index_length_ =
+        std::max(max_index_length_, extent.second - extent.first);
+  }
   return OkStatus();
 }
 
+std::pair<int64_t, int64_t> TensorSliceSet::IndexExtent(
+    const TensorSlice& slice) const {
+  if (slice.IsFullAt(index_dim_)) {
+    return {0, shape_.dim_size(index_dim_)};
+  }
+  return {slice.start(index_dim_), slice.end(index_dim_)};
+}
+
+void TensorSliceSet::ForEachCandidate(
+    const TensorSlice& slice,
+    const std::function<bool(const SliceInfo&)>& fn) const {
+  if (index_dim_ < 0) {
+    for (const auto& x : slices_) {
+      if (!fn(x.second)) return;
+    }
+    return;
+  }
+  const auto extent = IndexExtent(slice);
+  for (auto it = index_.upper_bound(extent.first - max_index_length_);
+       it != index_.end() && it->first < extent.second; ++it) {
+    if (!fn(*it->second)) return;
+  }
+}
+
 bool TensorSliceSet::QueryMeta(
     const TensorSlice& slice,
     std::vector<std::pair<TensorSlice, string>>* results) const {
@@ -90,16 +132,19 @@ bool TensorSliceSet::QueryMeta(
     int64_t overlap_size = 0;
     TensorSlice intersection;
     TensorShape inter_shape;
-    for (const auto& x : slices_) {
-      if (slice.Intersect(x.second.slice, &intersection)) {
+    ForEachCandidate(slice, [&](const SliceInfo& info) {
+      if (slice.Intersect(info.slice, &intersection)) {
         s = intersection.SliceTensorShape(shape_, &inter_shape);
-        if (!s.ok()) {
-          LOG(WARNING) << s;
-          return false;
-        }
+        if (!s.ok()) return false;
         overlap_size += inter_shape.num_elements();
-        results->emplace_back(std::make_pair(x.second.slice, x.second.tag));
+        results->emplace_back(std::make_pair(info.slice, info.tag));
       }
+      return true;
+    });
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+      results->clear();
+      return false;
     }
     if (total_size == overlap_size) {
       // We have it!
@@ -19,6 +19,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_TENSOR_SLICE_SET_H_
 #define TENSORFLOW_CORE_UTIL_TENSOR_SLICE_SET_H_
 
+#include <functional>
+#include <map>
 #include <string>  // for string
 #include <unordered_map>
 #include <utility>
@@ -68,6 +70,15 @@ class TensorSliceSet {
   }
 
  private:
+  // Returns the extent [start, end) of "slice" along index_dim_.
+  std::pair<int64_t, int64_t> IndexExtent(const TensorSlice& slice) const;
+
+  // Calls "fn" on the registered slices that may intersect "slice", i.e. whose
+  // extents along index_dim_ intersect the one of "slice", until it returns
+  // false.
+  void ForEachCandidate(const TensorSlice& slice,
+                        const std::function<bool(const SliceInfo&)>& fn) const;
+
   const TensorShape shape_;
   const DataType type_;
   // We maintain a mapping from the slice string to the slice information.
@@ -76,6 +87,20 @@ class TensorSliceSet {
   // Minimal slice which contains all presented slices. Used for speeding up
   // overlap check when slices are being added consequently.
   TensorSlice slices_hull_;
+
+  // Interval index of the slices along one dimension, so that the slices
+  // intersecting a given one are found without scanning all of them: the
+  // registered slices keyed by their start along index_dim_, and the longest
+  // extent of a slice along it. The slices intersecting [start, end) along
+  // index_dim_ start in [start - max_index_length_ + 1, end), which costs
+  // O(log n) plus the number of candidates for evenly partitioned tensors.
+  //
+  // index_dim_ is the first partitioned dimension of the first registered
+  // slice (0 if it is not partitioned), or -1 for scalars, in which case all
+  // slices are candidates.
+  int index_dim_ = -1;
+  std::multimap<int64_t, const SliceInfo*> index_;
+  int64_t max_index_length_ = 0;
 };
 
 // Registers "slice" in the TensorSliceSet stored in "tensor_slices", under key
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_slice_set.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -146,6 +148,31 @@ TEST(TensorSliceSetTest, QueryMetaTwoD) {
   }
 }
 
+// Registers the rows of a matrix in a shuffled order, as they come from the
+// index of a checkpoint, and queries slices spanning several of them.
+TEST(TensorSliceSetTest, ManySlices) {
+  const int kNumRows = 1000;
+  TensorShape shape({kNumRows, 3});
+  TensorSliceSet tss(shape, DT_FLOAT);
+  for (int i = 0; i < kNumRows; ++i) {
+    const int row = (i * 7) % kNumRows;
+    TensorSlice slice({{row, 1}, {0, -1}});
+    TF_CHECK_OK(tss.Register(slice, strings::StrCat("row_", row)));
+  }
+  EXPECT_FALSE(tss.Register(TensorSlice({{10, 2}, {1, 1}}), "overlap").ok());
+
+  std::vector<std::pair<TensorSlice, string>> results;
+  EXPECT_TRUE(tss.QueryMeta(TensorSlice({{500, 3}, {0, 2}}), &results));
+  ASSERT_EQ(3, results.size());
+  std::vector<string> tags;
+  for (const auto& result : results) tags.push_back(result.second);
+  std::sort(tags.begin(), tags.end());
+  EXPECT_EQ((std::vector<string>{"row_500", "row_501", "row_502"}), tags);
+
+  EXPECT_TRUE(tss.QueryMeta(TensorSlice::ParseOrDie("-:-"), &results));
+  EXPECT_EQ(kNumRows, results.size());
+}
+
 static void BM_RegisterOneByOne(::testing::benchmark::State& state) {
   TensorShape shape({static_cast<int>(state.max_iterations), 41});
   TensorSliceSet slice_set(shape, DT_INT32);
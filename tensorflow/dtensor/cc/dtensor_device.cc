@@ -85,6 +85,7 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_operation.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
 #include "tensorflow/dtensor/cc/parallel_executor.h"
+#include "tensorflow/dtensor/cc/pending_parallel_executions.h"
 #include "tensorflow/dtensor/cc/small_constant_optimization.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
 #include "tensorflow/dtensor/cc/tpu_system_interface.h"
@@ -148,6 +149,10 @@ class DTensorDevice {
                              in_flight_nodes_limit);
   }
 
+  // Waits for the pending parallel executions, whose outputs may still be
+  // filled.
+  ~DTensorDevice() { pending_parallel_executions_.AwaitAll().IgnoreError(); }
+
   bool use_parallel_executor() const { return parallel_executor_ != nullptr; }
 
   void AddMesh(Mesh mesh_config, bool is_host_mesh) {
@@ -332,6 +337,15 @@ class DTensorDevice {
       first_bad_status.reset(status);
     }
 
+    Status parallel_execution_status = pending_parallel_executions_.AwaitAll();
+    if (!parallel_execution_status.ok() &&
+        (first_bad_status == nullptr ||
+         TF_GetCode(first_bad_status.get()) == TF_CANCELLED)) {
+      first_bad_status.reset(TF_NewStatus());
+      Set_TF_Status_from_Status(first_bad_status.get(),
+                                parallel_execution_status);
+    }
+
     for (const auto& pair : mesh_to_device_map_) {
       std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> async_wait_status(
           TF_NewStatus(), TF_DeleteStatus);
@@ -416,6 +430,7 @@ class DTensorDevice {
         function_manager_(new ExecutableManager<ExecutionFunctions>()),
         cancellation_manager_(std::make_unique<CancellationManager>()),
         parallel_executor_(std::move(parallel_executor)),
+        pending_parallel_executions_(in_flight_nodes_limit),
         eager_executor_(std::move(eager_executor)) {}
 
   // Stores states of a DTensorOperation that will be used for lowering,
@@ -712,6 +727,10 @@ class DTensorDevice {
   // Dispatchs functions for Pathways.
   std::unique_ptr<ParallelExecutor> parallel_executor_;
 
+  // Executions of the ParallelExecutor which have not been awaited yet in
+  // async mode.
+  PendingParallelExecutions pending_parallel_executions_;
+
   // Dispatchs functions for TensorFlow.
   std::unique_ptr<EagerExecutor> eager_executor_;
 
@@ -848,6 +867,13 @@ std::unique_ptr<TensorWithLayout> DTensorDevice::Broadcast(
   if (TF_GetCode(status) != TF_OK) {
     return nullptr;
   }
+  // The broadcast is ordered after the pending executions, as for the other
+  // ops that do not go through Execute.
+  Status pending_status = pending_parallel_executions_.AwaitAll();
+  if (!pending_status.ok()) {
+    Set_TF_Status_from_Status(status, pending_status);
+    return nullptr;
+  }
   auto tensor_with_layout_pw =
       parallel_executor_->Broadcast(tensor, mesh, const_value);
   if (!tensor_with_layout_pw.ok()) {
@@ -974,6 +1000,12 @@ TFE_TensorHandle* DTensorDevice::ToTensorHandle(TFE_Context* context,
                                                 TF_Status* status) {
   TFE_TensorHandle* tensor_handle = nullptr;
   if (parallel_executor_) {
+    // `input` may be an output of a pending execution.
+    Status pending_status = pending_parallel_executions_.AwaitAll();
+    if (!pending_status.ok()) {
+      Set_TF_Status_from_Status(status, pending_status);
+      return tensor_handle;
+    }
     StatusOr<Tensor> tensor = parallel_executor_->ToHostBuffer(input).Await();
     if (!tensor.ok()) {
       TF_SetStatus(status, TF_INTERNAL, tensor.status().ToString().c_str());
@@ -1367,6 +1399,12 @@ std::vector<std::unique_ptr<tensorflow::dtensor::TensorWithLayout>>
 DTensorDevice::Disassemble(TFE_Context* context, TensorWithLayout* t,
                            TF_Status* status) {
   if (parallel_executor_) {
+    // `t` may be an output of a pending execution.
+    Status pending_status = pending_parallel_executions_.AwaitAll();
+    if (!pending_status.ok()) {
+      Set_TF_Status_from_Status(status, pending_status);
+      return {};
+    }
     StatusOr<
         std::vector<std::unique_ptr<tensorflow::dtensor::TensorWithLayout>>>
         tensor_with_layouts = parallel_executor_->Disassemble(t);
@@ -1826,7 +1864,14 @@ void DTensorDevice::ParallelExecuteRegularOperation(
       ParallelExecutor::ExecutionResult execution_result,
       parallel_executor_->Execute(context, inputs, mlir_module, attributes),
       status);
-  RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  // In async mode the outputs may be passed to the next operations before
+  // they are filled, and the ParallelExecutor orders those executions after
+  // this one. Errors surface in AsyncWait.
+  if (is_async_) {
+    pending_parallel_executions_.Add(std::move(execution_result.status));
+  } else {
+    RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  }
 
   std::vector<TensorWithLayout*> typed_outputs = execution_result.outputs;
   // assign outputs and take outputs' ownership
@@ -55,7 +55,8 @@ class ParallelExecutor {
   struct ExecutionResult {
     Future<Status> status;
     // The pointed data of `outputs` are filled after `status` future resolves
-    // as ok.
+    // as ok. The outputs may be passed as inputs to later calls of `Execute`
+    // before that, in which case those executions must wait for them.
     std::vector<TensorWithLayout*> outputs;
   };
   virtual StatusOr<ExecutionResult> Execute(
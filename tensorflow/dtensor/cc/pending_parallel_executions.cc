@@ -0,0 +1,54 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pending_parallel_executions.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+void PendingParallelExecutions::Add(Future<Status> status) {
+  mutex_lock lock(mu_);
+  pending_.push_back(std::move(status));
+  // The executions resolve without taking `mu_`, so they can be awaited while
+  // holding it.
+  while (limit_ > 0 && static_cast<int64_t>(pending_.size()) > limit_) {
+    AwaitOldest();
+  }
+}
+
+Status PendingParallelExecutions::AwaitAll() {
+  mutex_lock lock(mu_);
+  while (!pending_.empty()) {
+    AwaitOldest();
+  }
+  Status status = status_;
+  status_ = OkStatus();
+  return status;
+}
+
+void PendingParallelExecutions::AwaitOldest() {
+  Status status = pending_.front().Await();
+  pending_.pop_front();
+  if (!status.ok() && (status_.ok() || errors::IsCancelled(status_))) {
+    status_ = std::move(status);
+  }
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
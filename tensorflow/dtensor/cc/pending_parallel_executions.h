@@ -0,0 +1,63 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_DTENSOR_CC_PENDING_PARALLEL_EXECUTIONS_H_
+#define TENSORFLOW_DTENSOR_CC_PENDING_PARALLEL_EXECUTIONS_H_
+
+#include <cstdint>
+#include <deque>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/dtensor/cc/parallel_executor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+// Tracks the executions of a ParallelExecutor which have not resolved yet, so
+// that in async mode consecutive operations are pipelined instead of waiting
+// for each other. Reading an output of a pending execution, or reporting its
+// errors, must first await the pending executions.
+//
+// Thread-safe.
+class PendingParallelExecutions {
+ public:
+  // At most `limit` executions are pending, or any number if `limit` is 0.
+  explicit PendingParallelExecutions(int64_t limit) : limit_(limit) {}
+
+  // Adds an execution which is pending until `status` resolves. Awaits the
+  // oldest pending executions while more than `limit` are pending.
+  void Add(Future<Status> status);
+
+  // Awaits the pending executions, and returns the first error among the
+  // executions added since the last call. A cancellation is only returned
+  // when no other error happened, since it is usually caused by that error.
+  Status AwaitAll();
+
+ private:
+  // Awaits the oldest pending execution.
+  void AwaitOldest() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t limit_;
+  mutex mu_;
+  std::deque<Future<Status>> pending_ TF_GUARDED_BY(mu_);
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace dtensor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_DTENSOR_CC_PENDING_PARALLEL_EXECUTIONS_H_
@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pending_parallel_executions.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/dtensor/cc/parallel_executor.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+constexpr int64_t kBlockedTimeoutUs = 100 * 1000;
+
+// Executes asynchronously, like a ParallelExecutor: each execution resolves
+// when the test completes it.
+class FakeAsyncExecutor {
+ public:
+  Future<Status> Execute() {
+    mutex_lock lock(mu_);
+    promises_.push_back(Future<Status>::CreatePromise());
+    return Future<Status>(promises_.back());
+  }
+
+  void Complete(int i, const Status& status = OkStatus()) {
+    Future<Status>::Promise promise;
+    {
+      mutex_lock lock(mu_);
+      promise = promises_[i];
+    }
+    promise.Set(status);
+  }
+
+ private:
+  mutex mu_;
+  std::vector<Future<Status>::Promise> promises_ TF_GUARDED_BY(mu_);
+};
+
+TEST(PendingParallelExecutionsTest, AwaitAllWaitsForPendingExecutions) {
+  FakeAsyncExecutor executor;
+  PendingParallelExecutions pending(/*limit=*/0);
+  pending.Add(executor.Execute());
+  pending.Add(executor.Execute());
+
+  Status status;
+  Notification awaited;
+  std::unique_ptr<Thread> waiter(Env::Default()->StartThread(
+      ThreadOptions(), "waiter", [&pending, &status, &awaited]() {
+        status = pending.AwaitAll();
+        awaited.Notify();
+      }));
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&awaited, kBlockedTimeoutUs));
+  executor.Complete(1);
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&awaited, kBlockedTimeoutUs));
+  executor.Complete(0);
+  awaited.WaitForNotification();
+  waiter.reset();
+  TF_EXPECT_OK(status);
+}
+
+TEST(PendingParallelExecutionsTest, AwaitAllReturnsFirstErrorOnce) {
+  FakeAsyncExecutor executor;
+  PendingParallelExecutions pending(/*limit=*/0);
+  for (int i = 0; i < 4; ++i) {
+    pending.Add(executor.Execute());
+  }
+  executor.Complete(0);
+  executor.Complete(1, errors::Cancelled("cancelled"));
+  executor.Complete(2, errors::Internal("failed"));
+  executor.Complete(3, errors::Unavailable("failed later"));
+
+  // The cancellation is likely caused by the error that follows it.
+  Status status = pending.AwaitAll();
+  EXPECT_TRUE(errors::IsInternal(status)) << status;
+  TF_EXPECT_OK(pending.AwaitAll());
+
+  pending.Add(executor.Execute());
+  executor.Complete(4, errors::Cancelled("cancelled"));
+  EXPECT_TRUE(errors::IsCancelled(pending.AwaitAll()));
+}
+
+TEST(PendingParallelExecutionsTest, AddAwaitsOldestExecutionsAtLimit) {
+  FakeAsyncExecutor executor;
+  PendingParallelExecutions pending(/*limit=*/2);
+  pending.Add(executor.Execute());
+  pending.Add(executor.Execute());
+
+  Notification added;
+  std::unique_ptr<Thread> adder(Env::Default()->StartThread(
+      ThreadOptions(), "adder", [&pending, &executor, &added]() {
+        pending.Add(executor.Execute());
+        added.Notify();
+      }));
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&added, kBlockedTimeoutUs));
+  // Completing a later execution does not make room, since the oldest one is
+  // awaited first.
+  executor.Complete(1);
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&added, kBlockedTimeoutUs));
+  executor.Complete(0, errors::Internal("failed"));
+  added.WaitForNotification();
+  adder.reset();
+
+  executor.Complete(2);
+  EXPECT_TRUE(errors::IsInternal(pending.AwaitAll()));
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
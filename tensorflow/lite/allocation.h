@@ -95,6 +95,17 @@ class MMAPAllocation : public Allocation {
     return offset_of_buffer_in_file_;
   }
 
+  // Hints that the mmapped buffer is read in random order, so that the OS only
+  // reads in the pages that are used, e.g. the weights of the nodes that run,
+  // rather than reading ahead. Returns false if the hint isn't supported.
+  bool AdviseRandomAccess() const;
+
+  // Hints that the pages entirely within [ptr, ptr + size) of the mmapped
+  // buffer won't be used soon, so that the OS reclaims them first under
+  // memory pressure. They are read in again from the file on their next use.
+  // Returns false if the hint isn't supported.
+  bool AdviseCold(const void* ptr, size_t size) const;
+
   static bool IsSupported();
 
  protected:
@@ -63,6 +63,21 @@ TEST(MMAPAllocation, TestInvalidFileDescriptor) {
   EXPECT_FALSE(allocation.valid());
 }
 
+TEST(MMAPAllocation, TestAdvice) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(
+      "tensorflow/lite/testdata/empty_model.bin", &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  EXPECT_TRUE(allocation.AdviseRandomAccess());
+  // Ranges beyond the mmapped buffer are rejected.
+  const char* base = static_cast<const char*>(allocation.base());
+  EXPECT_FALSE(allocation.AdviseCold(base, allocation.bytes() + 1));
+}
+
 TEST(MMAPAllocation, TestInvalidSizeAndOffset) {
   if (!MMAPAllocation::IsSupported()) {
     return;
@@ -33,6 +33,8 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Number of allocation plans cached for different tensor sizes.
+constexpr size_t kMaxCachedPlans = 8;
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -45,7 +47,9 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
-      last_active_node_(kLastActiveNodeUndefined) {}
+      last_active_node_(kLastActiveNodeUndefined),
+      allocations_reset_(false),
+      plan_use_count_(0) {}
 
 ArenaPlanner::~ArenaPlanner() {
   arena_.ReleaseBuffer();
@@ -71,6 +75,7 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   // all allocs to be cleared. if this is not set, the slow path is taken
   // (Purge) which inspects each alloc. Both paths give the exact same result.
   last_active_node_ = kLastActiveNodeUndefined;
+  allocations_reset_ = true;
   return kTfLiteOk;
 }
 
@@ -91,6 +96,7 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
     arena_.PurgeAfter(node);
   }
   last_active_node_ = node;
+  allocations_reset_ = false;
   return kTfLiteOk;
 }
 
@@ -201,6 +207,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -501,6 +508,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     }
   }
 
+  const bool allocations_reset = allocations_reset_;
+  allocations_reset_ = false;
   if (tensors_allocated->empty()) {
     last_active_node_ = last_node;
     return kTfLiteOk;
@@ -511,7 +520,18 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
   } else {
     // NOMUTANTS -- This function has no impact on the results, it only makes
     // exection faster.
-    arena_.PurgeActiveAllocs(first_node);
+    arena_.PurgeActiveAllocs(ExecutionGroupBegin(first_node));
+  }
+  // When all the nodes up to `last_node` are allocated from scratch, the
+  // allocations only depend on the sizes and usage of their tensors, so they
+  // are reused if they were computed before for the same ones.
+  std::vector<int64_t> signature;
+  if (allocations_reset && first_node == 0) {
+    signature = GetPlanSignature(last_node, tensors_to_allocate);
+    if (RestoreCachedPlan(signature)) {
+      last_active_node_ = last_node;
+      return kTfLiteOk;
+    }
   }
   CreateTensorAllocationVector(tensors_allocated);
   // Vector of ids of already allocated tensors, ordered by offset.
@@ -537,10 +557,11 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_, tensor.bytes, tensor_index,
+          ExecutionGroupBegin(alloc_node_[tensor_index]),
+          ExecutionGroupEnd(dealloc_node_[tensor_index]),
+          &allocs_[tensor_index]));
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -549,16 +570,100 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       if (allocs_[tensor_index].size < tensor.bytes) {
         TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
             context_, tensor_alignment_, tensor.bytes, tensor_index,
-            /*first_node=*/alloc_node_[tensor_index],
+            /*first_node=*/ExecutionGroupBegin(alloc_node_[tensor_index]),
             /*last_node=*/std::numeric_limits<int32_t>::max(),
             &allocs_[tensor_index]));
       }
     }
   }
+  if (!signature.empty()) {
+    CachePlan(std::move(signature));
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+std::vector<int64_t> ArenaPlanner::GetPlanSignature(
+    int last_node, const std::vector<int32_t>& tensors_to_allocate) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<int32_t> sorted_tensors = tensors_to_allocate;
+  std::sort(sorted_tensors.begin(), sorted_tensors.end());
+  std::vector<std::pair<int32_t, int32_t>> shared_tensors(
+      actual_tensor_id_.begin(), actual_tensor_id_.end());
+  std::sort(shared_tensors.begin(), shared_tensors.end());
+
+  std::vector<int64_t> signature;
+  signature.reserve(3 + 5 * sorted_tensors.size() + 4 * shared_tensors.size());
+  signature.push_back(graph_info_->num_tensors());
+  signature.push_back(last_node);
+  signature.push_back(sorted_tensors.size());
+  for (int32_t tensor_index : sorted_tensors) {
+    signature.push_back(tensor_index);
+    signature.push_back(tensors[tensor_index].bytes);
+    signature.push_back(tensors[tensor_index].allocation_type);
+    signature.push_back(alloc_node_[tensor_index]);
+    signature.push_back(dealloc_node_[tensor_index]);
+  }
+  // Whether a tensor still shares the buffer of another depends on the latter.
+  for (const auto& shared_tensor : shared_tensors) {
+    signature.push_back(shared_tensor.first);
+    signature.push_back(shared_tensor.second);
+    signature.push_back(tensors[shared_tensor.second].bytes);
+    signature.push_back(tensors[shared_tensor.second].allocation_type);
+  }
+  return signature;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<int64_t>& signature) {
+  for (CachedPlan& plan : cached_plans_) {
+    if (plan.signature == signature) {
+      plan.last_use = ++plan_use_count_;
+      allocs_ = plan.allocs;
+      actual_tensor_id_ = plan.actual_tensor_id;
+      arena_.RestorePlan(plan.arena_plan);
+      persistent_arena_.RestorePlan(plan.persistent_arena_plan);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(std::vector<int64_t> signature) {
+  CachedPlan* plan;
+  if (cached_plans_.size() < kMaxCachedPlans) {
+    cached_plans_.emplace_back();
+    plan = &cached_plans_.back();
+  } else {
+    plan = &*std::min_element(
+        cached_plans_.begin(), cached_plans_.end(),
+        [](const CachedPlan& a, const CachedPlan& b) {
+          return a.last_use < b.last_use;
+        });
+  }
+  plan->signature = std::move(signature);
+  plan->allocs = allocs_;
+  plan->actual_tensor_id = actual_tensor_id_;
+  plan->arena_plan = arena_.GetPlan();
+  plan->persistent_arena_plan = persistent_arena_.GetPlan();
+  plan->last_use = ++plan_use_count_;
+}
+
+int32_t ArenaPlanner::ExecutionGroupBegin(int32_t node) const {
+  if (node < 0 ||
+      static_cast<size_t>(node) >= graph_info_->num_execution_nodes()) {
+    return node;
+  }
+  return graph_info_->execution_group_begin(node);
+}
+
+int32_t ArenaPlanner::ExecutionGroupEnd(int32_t node) const {
+  if (node < 0 ||
+      static_cast<size_t>(node) >= graph_info_->num_execution_nodes()) {
+    return node;
+  }
+  return graph_info_->execution_group_end(node);
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -120,6 +120,41 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the first and last node of the group of nodes that may run
+  // concurrently with `node`. A tensor used by the nodes [first, last] is thus
+  // allocated during the nodes
+  // [ExecutionGroupBegin(first), ExecutionGroupEnd(last)].
+  int32_t ExecutionGroupBegin(int32_t node) const;
+  int32_t ExecutionGroupEnd(int32_t node) const;
+
+  // Returns all the state that the allocations of `tensors_to_allocate`, i.e.
+  // of the tensors used by nodes [0, last_node], depend on after a call to
+  // ResetAllocations().
+  std::vector<int64_t> GetPlanSignature(
+      int last_node, const std::vector<int32_t>& tensors_to_allocate);
+
+  // Restores the allocations computed for `signature` if they are cached, and
+  // returns whether they were.
+  bool RestoreCachedPlan(const std::vector<int64_t>& signature);
+
+  // Caches the allocations just computed for `signature`, dropping the least
+  // recently used plan if there are already kMaxCachedPlans.
+  void CachePlan(std::vector<int64_t> signature);
+
+  // The allocations of the tensors used by nodes [0, last_node] computed by
+  // CalculateAllocations, right after ResetAllocations(), for one set of
+  // tensor sizes.
+  struct CachedPlan {
+    std::vector<int64_t> signature;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+    SimpleMemoryArena::Plan arena_plan;
+    SimpleMemoryArena::Plan persistent_arena_plan;
+    // Value of `plan_use_count_` when the plan was last used.
+    int64_t last_use;
+  };
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +201,14 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // True if no allocations were calculated since ResetAllocations().
+  bool allocations_reset_;
+
+  // Plans computed for the most recently used tensor sizes, so that resizing
+  // the inputs back to previous shapes doesn't recompute the offsets.
+  std::vector<CachedPlan> cached_plans_;
+  int64_t plan_use_count_;
 };
 
 }  // namespace tflite
@@ -148,6 +148,16 @@ class TestGraph {
     variables_ = variables;
   }
 
+  const std::vector<int>& group_begins() { return group_begins_; }
+  const std::vector<int>& group_ends() { return group_ends_; }
+
+  // Sets the first and last node of the execution group of each node.
+  void SetExecutionGroups(const std::vector<int>& group_begins,
+                          const std::vector<int>& group_ends) {
+    group_begins_ = group_begins;
+    group_ends_ = group_ends;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -163,6 +173,8 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<int> group_begins_;
+  std::vector<int> group_ends_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -189,6 +201,13 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t execution_group_begin(size_t index) const override {
+    return graph_->group_begins().empty() ? index
+                                          : graph_->group_begins()[index];
+  }
+  size_t execution_group_end(size_t index) const override {
+    return graph_->group_ends().empty() ? index : graph_->group_ends()[index];
+  }
 
  private:
   TestGraph* graph_;
@@ -330,6 +349,34 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, SeparatesTensorsOfExecutionGroup) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},  // First op
+                      {{1}, {2}, {}},  // Second op
+                      {{2}, {3}, {}},  // Third op
+                      {{3}, {4}, {}},  // Fourth op
+                  },
+                  {4});
+  (*graph.tensors())[3].bytes = 4;
+  (*graph.tensors())[4].bytes = 4;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // Tensor 3 reuses the buffer of tensor 1, which the second op deallocates.
+  EXPECT_EQ(GetOffset(3), GetOffset(1));
+
+  // The second and third ops may run concurrently, so tensor 1 lives until the
+  // third op.
+  graph.SetExecutionGroups({0, 1, 1, 3}, {0, 2, 2, 3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_TRUE(GetOffset(3) >= GetOffsetAfter(1) ||
+              GetOffsetAfter(3) <= GetOffset(1));
+  EXPECT_TRUE(GetOffset(3) >= GetOffsetAfter(2) ||
+              GetOffsetAfter(3) <= GetOffset(2));
+}
+
 TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   TestGraph graph({0, 1},
                   {
@@ -370,6 +417,79 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ReusesAllocationsForPreviousSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> small_offsets;
+  for (int i = 0; i < 6; ++i) {
+    small_offsets.push_back(GetOffset(i));
+  }
+
+  // Resizing the inputs changes the allocations...
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  ResetAllocations();
+  tensors[0].bytes = 40;
+  tensors[2].bytes = 40;
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> large_offsets;
+  for (int i = 0; i < 6; ++i) {
+    large_offsets.push_back(GetOffset(i));
+  }
+  EXPECT_NE(large_offsets, small_offsets);
+  const std::intptr_t base_pointer = planner_->BasePointer(kTfLiteArenaRw);
+
+  // ... and resizing them back gives the same ones as before.
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    ResetAllocations();
+    tensors[0].bytes = 3;
+    tensors[2].bytes = 9;
+    Execute(0, graph.nodes().size() - 1);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(GetOffset(i), small_offsets[i]);
+    }
+    EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base_pointer);
+
+    ResetAllocations();
+    tensors[0].bytes = 40;
+    tensors[2].bytes = 40;
+    Execute(0, graph.nodes().size() - 1);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(GetOffset(i), large_offsets[i]);
+    }
+    EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base_pointer);
+  }
+
+  // The allocations of the next nodes are computed on top of reused ones.
+  std::vector<std::ptrdiff_t> incremental_offsets;
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    ResetAllocations();
+    tensors[0].bytes = 3;
+    tensors[2].bytes = 9;
+    Execute(0, 0);
+    Execute(1, graph.nodes().size() - 1);
+    for (int i = 0; i < 6; ++i) {
+      if (repeat == 0) {
+        incremental_offsets.push_back(GetOffset(i));
+      } else {
+        EXPECT_EQ(GetOffset(i), incremental_offsets[i]);
+      }
+    }
+
+    ResetAllocations();
+    tensors[0].bytes = 40;
+    tensors[2].bytes = 40;
+    Execute(0, graph.nodes().size() - 1);
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
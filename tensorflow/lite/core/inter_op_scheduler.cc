@@ -0,0 +1,193 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_scheduler.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <numeric>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+namespace {
+
+bool UsesVariableTensor(const TfLiteIntArray* tensor_indices,
+                        const TfLiteTensor* tensors) {
+  if (tensor_indices == nullptr) return false;
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    const int tensor_index = tensor_indices->data[i];
+    if (tensor_index != kTfLiteOptionalTensor &&
+        tensors[tensor_index].is_variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool CanRunConcurrently(const TfLiteNode& node,
+                        const TfLiteRegistration& registration,
+                        const TfLiteTensor* tensors) {
+  if (node.delegate != nullptr ||
+      registration.registration_external != nullptr) {
+    return false;
+  }
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinAssignVariable:
+    case kTfLiteBuiltinCall:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    case kTfLiteBuiltinHashtable:
+    case kTfLiteBuiltinHashtableFind:
+    case kTfLiteBuiltinHashtableImport:
+    case kTfLiteBuiltinHashtableSize:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinReadVariable:
+    case kTfLiteBuiltinStablehloCustomCall:
+    case kTfLiteBuiltinStablehloWhile:
+    case kTfLiteBuiltinVarHandle:
+    case kTfLiteBuiltinWhile:
+      return false;
+    default:
+      break;
+  }
+  return !UsesVariableTensor(node.inputs, tensors) &&
+         !UsesVariableTensor(node.outputs, tensors);
+}
+
+std::vector<int> GroupIndependentNodes(
+    const std::vector<int>& execution_plan,
+    const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
+        nodes_and_registration,
+    const std::function<bool(int node_index)>& can_run_concurrently,
+    size_t num_tensors, std::vector<int>* group_ends) {
+  const int num_nodes = static_cast<int>(execution_plan.size());
+  // The group of the node producing each tensor, or -1 for the tensors that
+  // are not produced by a node, e.g. inputs and constants.
+  std::vector<int> tensor_groups(num_tensors, -1);
+  std::vector<int> groups(num_nodes);
+  // The nodes must be in groups after `first_group`, i.e. after the last node
+  // that can't run concurrently.
+  int first_group = 0;
+  int num_groups = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan[i];
+    const TfLiteNode& node = nodes_and_registration[node_index].first;
+    int group = first_group;
+    if (!can_run_concurrently(node_index)) {
+      group = num_groups;
+      first_group = group + 1;
+    } else {
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int tensor_index = node.inputs->data[j];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          group = std::max(group, tensor_groups[tensor_index] + 1);
+        }
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_groups[tensor_index] = group;
+      }
+    }
+    groups[i] = group;
+    num_groups = std::max(num_groups, group + 1);
+  }
+
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&groups](int a, int b) { return groups[a] < groups[b]; });
+  std::vector<int> grouped_plan(num_nodes);
+  group_ends->resize(num_nodes);
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    grouped_plan[i] = execution_plan[order[i]];
+    const bool last_of_group =
+        i + 1 == num_nodes || groups[order[i + 1]] != groups[order[i]];
+    (*group_ends)[i] = last_of_group ? i : (*group_ends)[i + 1];
+  }
+  return grouped_plan;
+}
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int thread = 1; thread < num_threads; ++thread) {
+    workers_.emplace_back([this, thread] { WorkerLoop(thread); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::Run(int num_tasks,
+                            const std::function<void(int, int)>& fn) {
+  std::unique_lock<std::mutex> lock(mu_);
+  fn_ = &fn;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  num_pending_tasks_ = num_tasks;
+  ++generation_;
+  work_available_.notify_all();
+  RunTasks(/*thread=*/0, &lock);
+  work_done_.wait(lock, [this] { return num_pending_tasks_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int thread) {
+  std::unique_lock<std::mutex> lock(mu_);
+  int64_t last_generation = 0;
+  while (true) {
+    work_available_.wait(lock, [this, last_generation] {
+      return stopping_ || generation_ != last_generation;
+    });
+    if (stopping_) return;
+    last_generation = generation_;
+    RunTasks(thread, &lock);
+  }
+}
+
+void InterOpThreadPool::RunTasks(int thread,
+                                 std::unique_lock<std::mutex>* lock) {
+  while (fn_ != nullptr && next_task_ < num_tasks_) {
+    const int task = next_task_++;
+    const std::function<void(int, int)>& fn = *fn_;
+    lock->unlock();
+    fn(task, thread);
+    lock->lock();
+    if (--num_pending_tasks_ == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+// Returns whether `node` may run concurrently with other nodes of its graph.
+// Delegate kernels, custom ops, control flow and ops on resources or variable
+// tensors may have side effects that aren't visible as data dependencies, or
+// share state with other nodes, so they always run alone.
+bool CanRunConcurrently(const TfLiteNode& node,
+                        const TfLiteRegistration& registration,
+                        const TfLiteTensor* tensors);
+
+// Reorders `execution_plan` into groups of nodes that don't depend on each
+// other, so that the nodes of a group may run concurrently once the previous
+// groups are done. Each node is placed in the earliest group after the ones of
+// the nodes producing its inputs, and keeps its relative order in the plan
+// within its group. Nodes for which `can_run_concurrently` returns false are
+// alone in their group, and keep their order relative to all other nodes.
+//
+// Returns the reordered plan, and sets `group_ends` to the index in it of the
+// last node of the group of each node.
+std::vector<int> GroupIndependentNodes(
+    const std::vector<int>& execution_plan,
+    const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
+        nodes_and_registration,
+    const std::function<bool(int node_index)>& can_run_concurrently,
+    size_t num_tensors, std::vector<int>* group_ends);
+
+// A fixed set of threads that run the nodes of a group concurrently.
+//
+// This class is thread-compatible: Run() must not be called concurrently.
+class InterOpThreadPool {
+ public:
+  // Creates `num_threads - 1` threads, the thread calling Run() being the
+  // first of the `num_threads` threads of the pool.
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls `fn(task, thread)` for each task in [0, num_tasks) on the threads of
+  // the pool, and returns once all the calls returned. `thread` is the index
+  // in [0, num_threads()) of the thread running the task, 0 being the caller.
+  void Run(int num_tasks, const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop(int thread);
+
+  // Runs the tasks of the current call to Run() until there are none left.
+  void RunTasks(int thread, std::unique_lock<std::mutex>* lock);
+
+  std::mutex mu_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_pending_tasks_ = 0;
+  // Incremented by each call to Run(), to wake up the workers.
+  int64_t generation_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
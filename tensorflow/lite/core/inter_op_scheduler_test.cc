@@ -0,0 +1,153 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_scheduler.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+
+class GroupIndependentNodesTest : public ::testing::Test {
+ protected:
+  ~GroupIndependentNodesTest() override {
+    for (auto& node_and_registration : nodes_and_registration_) {
+      TfLiteIntArrayFree(node_and_registration.first.inputs);
+      TfLiteIntArrayFree(node_and_registration.first.outputs);
+    }
+  }
+
+  void AddNode(const std::vector<int>& inputs,
+               const std::vector<int>& outputs) {
+    TfLiteNode node = {};
+    node.inputs = ConvertVectorToTfLiteIntArray(inputs);
+    node.outputs = ConvertVectorToTfLiteIntArray(outputs);
+    TfLiteRegistration registration = {};
+    registration.builtin_code = kTfLiteBuiltinAdd;
+    nodes_and_registration_.emplace_back(node, registration);
+  }
+
+  std::vector<int> Group(const std::vector<int>& execution_plan,
+                         const std::vector<int>& barriers = {}) {
+    return GroupIndependentNodes(
+        execution_plan, nodes_and_registration_,
+        [&barriers](int node_index) {
+          for (int barrier : barriers) {
+            if (barrier == node_index) return false;
+          }
+          return true;
+        },
+        /*num_tensors=*/8, &group_ends_);
+  }
+
+  std::vector<std::pair<TfLiteNode, TfLiteRegistration>>
+      nodes_and_registration_;
+  std::vector<int> group_ends_;
+};
+
+TEST_F(GroupIndependentNodesTest, GroupsBranches) {
+  AddNode({0}, {1});
+  AddNode({1}, {2});
+  AddNode({1}, {3});
+  AddNode({2, 3}, {4});
+  EXPECT_THAT(Group({0, 1, 2, 3}), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(group_ends_, ElementsAre(0, 2, 2, 3));
+}
+
+TEST_F(GroupIndependentNodesTest, InterleavesTowers) {
+  AddNode({0}, {1});
+  AddNode({1}, {2});
+  AddNode({0}, {3});
+  AddNode({3, kTfLiteOptionalTensor}, {4});
+  EXPECT_THAT(Group({0, 1, 2, 3}), ElementsAre(0, 2, 1, 3));
+  EXPECT_THAT(group_ends_, ElementsAre(1, 1, 3, 3));
+}
+
+TEST_F(GroupIndependentNodesTest, RunsBarriersAlone) {
+  AddNode({0}, {1});
+  AddNode({1}, {2});
+  AddNode({0}, {3});
+  AddNode({3}, {4});
+  EXPECT_THAT(Group({0, 1, 2, 3}, /*barriers=*/{1}), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(group_ends_, ElementsAre(0, 1, 2, 3));
+}
+
+TEST_F(GroupIndependentNodesTest, SkipsNodesNotInPlan) {
+  AddNode({0}, {1});
+  AddNode({0}, {2});
+  AddNode({0}, {3});
+  EXPECT_THAT(Group({2, 0}), ElementsAre(2, 0));
+  EXPECT_THAT(group_ends_, ElementsAre(1, 1));
+}
+
+TEST(CanRunConcurrentlyTest, ExcludesNodesWithSideEffects) {
+  TfLiteTensor tensors[2] = {};
+  tensors[1].is_variable = true;
+  TfLiteNode node = {};
+  node.inputs = ConvertVectorToTfLiteIntArray({0});
+  node.outputs = ConvertVectorToTfLiteIntArray({0});
+  TfLiteRegistration registration = {};
+  registration.builtin_code = kTfLiteBuiltinAdd;
+  EXPECT_TRUE(CanRunConcurrently(node, registration, tensors));
+
+  registration.builtin_code = kTfLiteBuiltinWhile;
+  EXPECT_FALSE(CanRunConcurrently(node, registration, tensors));
+
+  registration.builtin_code = kTfLiteBuiltinAdd;
+  node.outputs->data[0] = 1;
+  EXPECT_FALSE(CanRunConcurrently(node, registration, tensors));
+
+  TfLiteIntArrayFree(node.inputs);
+  TfLiteIntArrayFree(node.outputs);
+}
+
+TEST(InterOpThreadPoolTest, RunsAllTasks) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    std::atomic<bool> valid_threads(true);
+    pool.Run(num_tasks, [&](int task, int thread) {
+      ++runs[task];
+      if (thread < 0 || thread >= 4) valid_threads = false;
+    });
+    for (const std::atomic<int>& run : runs) {
+      EXPECT_EQ(run, 1);
+    }
+    EXPECT_TRUE(valid_threads);
+  }
+}
+
+TEST(InterOpThreadPoolTest, RunsOnCallerWithOneThread) {
+  InterOpThreadPool pool(1);
+  int sum = 0;
+  pool.Run(5, [&sum](int task, int thread) {
+    EXPECT_EQ(thread, 0);
+    sum += task;
+  });
+  EXPECT_EQ(sum, 10);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,167 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/pipelined_runner.h"
+
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+
+namespace tflite {
+
+namespace {
+
+// Copies the outputs of `from` to the inputs of `to`, resizing them first if
+// their shapes differ.
+TfLiteStatus CopyOutputsToInputs(Interpreter* from, Interpreter* to) {
+  bool resized = false;
+  for (size_t i = 0; i < to->inputs().size(); ++i) {
+    const TfLiteTensor* src = from->output_tensor(i);
+    const TfLiteTensor* dst = to->input_tensor(i);
+    if (src->type != dst->type) {
+      TF_LITE_REPORT_ERROR(to->error_reporter(),
+                           "Output %zu of a pipeline stage has type %s, but "
+                           "the next stage expects %s.",
+                           i, TfLiteTypeGetName(src->type),
+                           TfLiteTypeGetName(dst->type));
+      return kTfLiteError;
+    }
+    if (!TfLiteIntArrayEqual(src->dims, dst->dims)) {
+      const std::vector<int> shape(src->dims->data,
+                                   src->dims->data + src->dims->size);
+      TF_LITE_ENSURE_STATUS(to->ResizeInputTensor(to->inputs()[i], shape));
+      resized = true;
+    }
+  }
+  if (resized) TF_LITE_ENSURE_STATUS(to->AllocateTensors());
+  for (size_t i = 0; i < to->inputs().size(); ++i) {
+    TF_LITE_ENSURE_STATUS(
+        TfLiteTensorCopy(from->output_tensor(i), to->input_tensor(i)));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+std::unique_ptr<PipelinedRunner> PipelinedRunner::Create(
+    std::vector<Interpreter*> stages) {
+  if (stages.empty()) return nullptr;
+  for (size_t i = 0; i + 1 < stages.size(); ++i) {
+    if (stages[i]->outputs().size() != stages[i + 1]->inputs().size()) {
+      return nullptr;
+    }
+  }
+  return std::unique_ptr<PipelinedRunner>(
+      new PipelinedRunner(std::move(stages)));
+}
+
+PipelinedRunner::PipelinedRunner(std::vector<Interpreter*> stages)
+    : stages_(stages.size()) {
+  for (size_t i = 0; i < stages.size(); ++i) {
+    stages_[i].interpreter = stages[i];
+  }
+  threads_.reserve(stages_.size());
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    threads_.emplace_back([this, i] { StageLoop(static_cast<int>(i)); });
+  }
+}
+
+PipelinedRunner::~PipelinedRunner() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void PipelinedRunner::Submit(InputFn fill_inputs, DoneFn done) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    ++num_pending_requests_;
+    stages_[0].queue.push_back({std::move(fill_inputs), std::move(done)});
+  }
+  cv_.notify_all();
+}
+
+void PipelinedRunner::Wait() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] { return num_pending_requests_ == 0; });
+}
+
+void PipelinedRunner::StageLoop(int stage_index) {
+  Stage& stage = stages_[stage_index];
+  const bool is_last_stage =
+      stage_index + 1 == static_cast<int>(stages_.size());
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock,
+               [this, &stage] { return stopping_ || !stage.queue.empty(); });
+      if (stage.queue.empty()) return;
+      request = std::move(stage.queue.front());
+      stage.queue.pop_front();
+      stage.busy = true;
+    }
+
+    // A failed request still goes through the later stages, so that the
+    // requests are done in order.
+    Interpreter* interpreter = stage.interpreter;
+    if (stage_index == 0 && request.status == kTfLiteOk) {
+      request.status = request.fill_inputs(interpreter);
+    }
+    if (request.status == kTfLiteOk) request.status = interpreter->Invoke();
+
+    if (is_last_stage) {
+      request.done(request.status,
+                   request.status == kTfLiteOk ? interpreter : nullptr);
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        stage.busy = false;
+        --num_pending_requests_;
+      }
+      cv_.notify_all();
+      continue;
+    }
+
+    // The inputs of the next stage can only be overwritten once it is done
+    // with its current request.
+    Stage& next_stage = stages_[stage_index + 1];
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [&next_stage] {
+        return !next_stage.busy && next_stage.queue.empty();
+      });
+    }
+    if (request.status == kTfLiteOk) {
+      request.status =
+          CopyOutputsToInputs(interpreter, next_stage.interpreter);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      next_stage.queue.push_back(std::move(request));
+      stage.busy = false;
+    }
+    cv_.notify_all();
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,100 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_PIPELINED_RUNNER_H_
+#define TENSORFLOW_LITE_CORE_PIPELINED_RUNNER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+
+namespace tflite {
+
+// Runs consecutive requests through a chain of interpreters, overlapping the
+// stages of different requests.
+//
+// Each stage is an interpreter whose outputs are the inputs of the next stage,
+// in order, e.g. the parts of a model split where the nodes supported by one
+// delegate end, each part with its own delegate applied. Each stage runs on
+// its own thread, so that while stage k runs request i, stage k - 1 runs
+// request i + 1, and different accelerators are busy at the same time.
+//
+// The interpreters must have their tensors allocated, must outlive the runner
+// and must not be used otherwise while it has pending requests.
+//
+// This class is thread-safe.
+class PipelinedRunner {
+ public:
+  // Fills the inputs of the first stage.
+  using InputFn = std::function<TfLiteStatus(Interpreter* first_stage)>;
+  // Reads the outputs of the last stage, which is nullptr if a stage failed.
+  using DoneFn =
+      std::function<void(TfLiteStatus status, Interpreter* last_stage)>;
+
+  // Returns nullptr if `stages` is empty, or if the number of outputs of a
+  // stage isn't the number of inputs of the next one.
+  static std::unique_ptr<PipelinedRunner> Create(
+      std::vector<Interpreter*> stages);
+
+  // Waits for the pending requests.
+  ~PipelinedRunner();
+  PipelinedRunner(const PipelinedRunner&) = delete;
+  PipelinedRunner& operator=(const PipelinedRunner&) = delete;
+
+  // Queues a request. `fill_inputs` is called on the thread of the first
+  // stage, and `done` on the thread of the last stage, in the order of the
+  // calls to Submit().
+  void Submit(InputFn fill_inputs, DoneFn done);
+
+  // Returns once all the submitted requests are done.
+  void Wait();
+
+ private:
+  struct Request {
+    InputFn fill_inputs;
+    DoneFn done;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  struct Stage {
+    Interpreter* interpreter = nullptr;
+    // Only the queue of the first stage holds more than one request, as the
+    // previous stage waits for a stage to be idle to fill its inputs.
+    std::deque<Request> queue;
+    bool busy = false;
+  };
+
+  explicit PipelinedRunner(std::vector<Interpreter*> stages);
+
+  void StageLoop(int stage_index);
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<Stage> stages_;
+  int64_t num_pending_requests_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_PIPELINED_RUNNER_H_
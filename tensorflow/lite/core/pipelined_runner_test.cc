@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/pipelined_runner.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace {
+
+TfLiteStatus PrepareUnary(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+  TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
+TfLiteStatus InvokeIncrement(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+  TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+  for (int i = 0; i < NumElements(input); ++i) {
+    output->data.f[i] = input->data.f[i] + 1.0f;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus InvokeDouble(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+  TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+  for (int i = 0; i < NumElements(input); ++i) {
+    if (input->data.f[i] < 0) return kTfLiteError;
+    output->data.f[i] = input->data.f[i] * 2.0f;
+  }
+  return kTfLiteOk;
+}
+
+// Builds an interpreter applying `invoke` to a float input of `size`.
+std::unique_ptr<Interpreter> BuildStage(
+    TfLiteStatus (*invoke)(TfLiteContext*, TfLiteNode*), int size) {
+  auto interpreter = std::make_unique<Interpreter>();
+  interpreter->AddTensors(2);
+  interpreter->SetInputs({0});
+  interpreter->SetOutputs({1});
+  TfLiteQuantizationParams quant;
+  interpreter->SetTensorParametersReadWrite(0, kTfLiteFloat32, "", {size},
+                                            quant);
+  interpreter->SetTensorParametersReadWrite(1, kTfLiteFloat32, "", {size},
+                                            quant);
+  TfLiteRegistration registration = {nullptr, nullptr, PrepareUnary, invoke};
+  interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                     &registration);
+  EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  return interpreter;
+}
+
+TEST(PipelinedRunner, RunsRequestsInOrderThroughStages) {
+  auto first = BuildStage(InvokeIncrement, 2);
+  auto second = BuildStage(InvokeDouble, 2);
+  auto third = BuildStage(InvokeIncrement, 2);
+  auto runner =
+      PipelinedRunner::Create({first.get(), second.get(), third.get()});
+  ASSERT_NE(runner, nullptr);
+
+  // The second stage fails on negative inputs.
+  std::vector<TfLiteStatus> statuses;
+  std::vector<float> outputs;
+  for (int i = 0; i < 16; ++i) {
+    const float value = i == 5 ? -10.0f : i;
+    runner->Submit(
+        [value](Interpreter* interpreter) {
+          interpreter->typed_input_tensor<float>(0)[0] = value;
+          interpreter->typed_input_tensor<float>(0)[1] = value;
+          return kTfLiteOk;
+        },
+        [&statuses, &outputs](TfLiteStatus status, Interpreter* interpreter) {
+          statuses.push_back(status);
+          outputs.push_back(
+              interpreter == nullptr
+                  ? 0.0f
+                  : interpreter->typed_output_tensor<float>(0)[1]);
+        });
+  }
+  runner->Wait();
+  ASSERT_EQ(outputs.size(), 16u);
+  for (int i = 0; i < 16; ++i) {
+    if (i == 5) {
+      EXPECT_EQ(statuses[i], kTfLiteError);
+    } else {
+      EXPECT_EQ(statuses[i], kTfLiteOk);
+      EXPECT_EQ(outputs[i], (i + 1) * 2.0f + 1.0f);
+    }
+  }
+}
+
+TEST(PipelinedRunner, ResizesInputsOfNextStage) {
+  auto first = BuildStage(InvokeIncrement, 2);
+  auto second = BuildStage(InvokeDouble, 2);
+  auto runner = PipelinedRunner::Create({first.get(), second.get()});
+  ASSERT_NE(runner, nullptr);
+  int output_size = 0;
+  runner->Submit(
+      [](Interpreter* interpreter) {
+        TF_LITE_ENSURE_STATUS(
+            interpreter->ResizeInputTensor(interpreter->inputs()[0], {3}));
+        TF_LITE_ENSURE_STATUS(interpreter->AllocateTensors());
+        for (int i = 0; i < 3; ++i) {
+          interpreter->typed_input_tensor<float>(0)[i] = i;
+        }
+        return kTfLiteOk;
+      },
+      [&output_size](TfLiteStatus status, Interpreter* interpreter) {
+        ASSERT_EQ(status, kTfLiteOk);
+        output_size = NumElements(interpreter->output_tensor(0));
+        EXPECT_EQ(interpreter->typed_output_tensor<float>(0)[2], 6.0f);
+      });
+  runner->Wait();
+  EXPECT_EQ(output_size, 3);
+}
+
+TEST(PipelinedRunner, RejectsMismatchedStages) {
+  EXPECT_EQ(PipelinedRunner::Create({}), nullptr);
+  auto first = BuildStage(InvokeIncrement, 2);
+  Interpreter no_inputs;
+  EXPECT_EQ(PipelinedRunner::Create({first.get(), &no_inputs}), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -131,6 +131,55 @@ bool HasDynamicTensor(const TfLiteContext& context,
                               dynamic_tensor_index);
 }
 
+// Returns true if the builtin op computes its outputs from its inputs only,
+// without any state or side effect, so that its node can be evaluated once if
+// its inputs are constant. These are the ops of typical shape computations.
+bool IsFoldableBuiltinOp(int32_t builtin_code) {
+  switch (builtin_code) {
+    case kTfLiteBuiltinAdd:
+    case kTfLiteBuiltinBroadcastArgs:
+    case kTfLiteBuiltinBroadcastTo:
+    case kTfLiteBuiltinCast:
+    case kTfLiteBuiltinConcatenation:
+    case kTfLiteBuiltinDiv:
+    case kTfLiteBuiltinEqual:
+    case kTfLiteBuiltinExpandDims:
+    case kTfLiteBuiltinFill:
+    case kTfLiteBuiltinFloorDiv:
+    case kTfLiteBuiltinFloorMod:
+    case kTfLiteBuiltinGather:
+    case kTfLiteBuiltinGreater:
+    case kTfLiteBuiltinGreaterEqual:
+    case kTfLiteBuiltinLess:
+    case kTfLiteBuiltinLessEqual:
+    case kTfLiteBuiltinMaximum:
+    case kTfLiteBuiltinMinimum:
+    case kTfLiteBuiltinMul:
+    case kTfLiteBuiltinNotEqual:
+    case kTfLiteBuiltinPack:
+    case kTfLiteBuiltinRange:
+    case kTfLiteBuiltinRank:
+    case kTfLiteBuiltinReduceMax:
+    case kTfLiteBuiltinReduceMin:
+    case kTfLiteBuiltinReduceProd:
+    case kTfLiteBuiltinReshape:
+    case kTfLiteBuiltinSelect:
+    case kTfLiteBuiltinSelectV2:
+    case kTfLiteBuiltinShape:
+    case kTfLiteBuiltinSlice:
+    case kTfLiteBuiltinSqueeze:
+    case kTfLiteBuiltinStridedSlice:
+    case kTfLiteBuiltinSub:
+    case kTfLiteBuiltinSum:
+    case kTfLiteBuiltinTile:
+    case kTfLiteBuiltinTranspose:
+    case kTfLiteBuiltinUnpack:
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Gets the legacy TfLiteQuantizationParams from the current TfLiteQuantization.
 TfLiteQuantizationParams GetLegacyQuantization(
     const TfLiteQuantization& quantization) {
@@ -199,7 +248,11 @@ TfLiteStatus VerifyCustomAllocationForTensor(
 // indices.
 class InterpreterInfo : public GraphInfo {
  public:
-  explicit InterpreterInfo(Subgraph* subgraph) : subgraph_(subgraph) {}
+  InterpreterInfo(Subgraph* subgraph, const std::vector<int>* group_begins,
+                  const std::vector<int>* group_ends)
+      : subgraph_(subgraph),
+        group_begins_(group_begins),
+        group_ends_(group_ends) {}
 
   size_t num_tensors() const override { return subgraph_->tensors_size(); }
 
@@ -241,8 +294,18 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  size_t execution_group_begin(size_t index) const override {
+    return index < group_begins_->size() ? (*group_begins_)[index] : index;
+  }
+
+  size_t execution_group_end(size_t index) const override {
+    return index < group_ends_->size() ? (*group_ends_)[index] : index;
+  }
+
  public:
   Subgraph* subgraph_;
+  const std::vector<int>* group_begins_;
+  const std::vector<int>* group_ends_;
 };
 
 Subgraph::Subgraph(ErrorReporter* error_reporter,
@@ -564,6 +627,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   GetDelegateKernalName(registration), node_subsets.size());
 
   execution_plan_.clear();
+  ClearInterOpGroups();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -623,7 +687,16 @@ TfLiteExternalContext* Subgraph::GetExternalContext(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     struct TfLiteContext* context, TfLiteExternalContextType type) {
-  return static_cast<Subgraph*>(context->impl_)->GetExternalContext(type);
+  Subgraph* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    // The nodes run by the inter-op threads use their own CPU backend context.
+    for (int i = 0; i < subgraph->inter_op_contexts_.size(); ++i) {
+      if (context == &subgraph->inter_op_contexts_[i]) {
+        return subgraph->inter_op_cpu_backend_contexts_[i].get();
+      }
+    }
+  }
+  return subgraph->GetExternalContext(type);
 }
 
 void Subgraph::SetExternalContext(TfLiteExternalContextType type,
@@ -1003,10 +1076,12 @@ TfLiteStatus Subgraph::AllocateTensors() {
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
+  UnfoldConstantNodes();
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
+  TF_LITE_ENSURE_STATUS(ScheduleInterOpGroups());
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
   state_ = kStateInvokable;
@@ -1042,6 +1117,19 @@ TfLiteStatus Subgraph::AllocateTensors() {
       }
     }
   }
+
+  TF_LITE_ENSURE_STATUS(FoldConstantNodes());
+
+  // Preparing the nodes may have read in some weights. Nodes read them in
+  // again when they run, so they can be reclaimed until then.
+  if (const MMAPAllocation* allocation = PagedWeightsAllocation()) {
+    allocation->AdviseRandomAccess();
+    for (const TfLiteTensor& tensor : tensors_) {
+      if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+        allocation->AdviseCold(tensor.data.raw, tensor.bytes);
+      }
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -1133,6 +1221,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  ClearInterOpGroups();
   return kTfLiteOk;
 }
 
@@ -1602,6 +1691,14 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (CanInvokeInterOpGroups()) {
+    status = InvokeInterOpGroups();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1614,6 +1711,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
                                     execution_plan_index);
     }
     int node_index = execution_plan_[execution_plan_index];
+    if (IsFoldedNode(node_index)) continue;
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
@@ -1636,37 +1734,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1712,6 +1780,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     }
     // Release dynamic tensor memory if configured by the user.
     MaybeReleaseDynamicTensors(node, node_index);
+    MaybeAdviseColdWeights(node);
 
 #ifdef TF_LITE_TENSORFLOW_PROFILER
     tflite::OnTfLiteOpInvokeEnd(trace_op);
@@ -1723,6 +1792,185 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::ClearInterOpGroups() {
+  execution_group_begins_.clear();
+  execution_group_ends_.clear();
+}
+
+TfLiteStatus Subgraph::ScheduleInterOpGroups() {
+  if (NumInterOpThreads() <= 1 && execution_group_ends_.empty()) {
+    return kTfLiteOk;
+  }
+  std::vector<int> execution_plan = execution_plan_;
+  std::vector<int> group_begins;
+  std::vector<int> group_ends;
+  if (NumInterOpThreads() > 1) {
+    execution_plan = GroupIndependentNodes(
+        execution_plan_, nodes_and_registration_,
+        [this](int node_index) {
+          return CanRunConcurrently(nodes_and_registration_[node_index].first,
+                                    nodes_and_registration_[node_index].second,
+                                    tensors_.data());
+        },
+        tensors_.size(), &group_ends);
+    group_begins.resize(group_ends.size());
+    for (int i = 0; i < group_ends.size(); ++i) {
+      const bool same_group = i > 0 && group_ends[i - 1] == group_ends[i];
+      group_begins[i] = same_group ? group_begins[i - 1] : i;
+    }
+  }
+  inter_op_execution_plan_ = execution_plan;
+  if (execution_plan == execution_plan_ &&
+      group_ends == execution_group_ends_) {
+    return kTfLiteOk;
+  }
+  execution_plan_ = std::move(execution_plan);
+  execution_group_begins_ = std::move(group_begins);
+  execution_group_ends_ = std::move(group_ends);
+  if (memory_planner_) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanInvokeInterOpGroups() const {
+  // Profiling and dynamic tensors need the nodes to run one at a time.
+  if (NumInterOpThreads() <= 1 || profiler_ != nullptr ||
+      has_dynamic_tensors_ ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size() ||
+      execution_group_ends_.size() != execution_plan_.size() ||
+      execution_plan_ != inter_op_execution_plan_) {
+    return false;
+  }
+  for (int i = 0; i < execution_group_ends_.size(); ++i) {
+    if (execution_group_ends_[i] != i) return true;
+  }
+  return false;
+}
+
+TfLiteStatus Subgraph::InvokeInterOpGroups() {
+  const int num_threads = NumInterOpThreads();
+  if (inter_op_thread_pool_ == nullptr ||
+      inter_op_thread_pool_->num_threads() != num_threads) {
+    inter_op_thread_pool_ = std::make_unique<InterOpThreadPool>(num_threads);
+    inter_op_contexts_.resize(num_threads - 1);
+    inter_op_cpu_backend_contexts_.clear();
+    for (int i = 1; i < num_threads; ++i) {
+      inter_op_cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+  }
+
+  const int num_nodes = execution_plan_.size();
+  std::vector<TfLiteStatus> statuses;
+  for (int group_begin = 0; group_begin < num_nodes;
+       group_begin = execution_group_ends_[group_begin] + 1) {
+    const int group_end = execution_group_ends_[group_begin];
+    const int group_size = group_end - group_begin + 1;
+    for (int i = group_begin; i <= group_end; ++i) {
+      TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+      const TfLiteRegistration& registration =
+          nodes_and_registration_[execution_plan_[i]].second;
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+      MayAllocateOpOutput(&node);
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    EnsureTensorsVectorCapacity();
+    tensor_resized_since_op_invoke_ = false;
+    statuses.assign(group_size, kTfLiteOk);
+    if (group_size == 1) {
+      auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[group_begin]];
+      if (!IsFoldedNode(execution_plan_[group_begin])) {
+        statuses[0] = OpInvoke(node_and_registration.second,
+                               &node_and_registration.first);
+      }
+    } else {
+      // The nodes of a group are only builtin ops, see CanRunConcurrently(),
+      // so their kernels are called directly.
+      for (TfLiteContext& context : inter_op_contexts_) {
+        context = context_;
+      }
+      inter_op_thread_pool_->Run(group_size, [&](int task, int thread) {
+        if (IsFoldedNode(execution_plan_[group_begin + task])) return;
+        auto& node_and_registration =
+            nodes_and_registration_[execution_plan_[group_begin + task]];
+        TfLiteContext* context =
+            thread == 0 ? &context_ : &inter_op_contexts_[thread - 1];
+        const TfLiteRegistration& registration = node_and_registration.second;
+        statuses[task] =
+            registration.invoke == nullptr
+                ? kTfLiteError
+                : registration.invoke(context, &node_and_registration.first);
+      });
+    }
+
+    for (int i = group_begin; i <= group_end; ++i) {
+      const int node_index = execution_plan_[i];
+      TfLiteNode& node = nodes_and_registration_[node_index].first;
+      const TfLiteRegistration& registration =
+          nodes_and_registration_[node_index].second;
+      if (const TfLiteStatus s = statuses[i - group_begin]; s != kTfLiteOk) {
+        auto err = ReportOpError(&context_, node, registration, node_index,
+                                 "failed to invoke");
+        return s == kTfLiteCancelled ? s : err;
+      }
+      // Release dynamic tensor memory if configured by the user.
+      MaybeReleaseDynamicTensors(node, node_index);
+      MaybeAdviseColdWeights(node);
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1955,6 +2203,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  ClearInterOpGroups();
   return kTfLiteOk;
 }
 
@@ -2093,6 +2342,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  ClearInterOpGroups();
 
   // Handling FP16 delegation (if applies).
   //
@@ -2205,6 +2455,8 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 }
 
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
+  // The folded tensors aren't in the arena, so they'd be missing from the plan.
+  UnfoldConstantNodes();
   if (memory_planner_) {
     state_ = kStateUninvokable;
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
@@ -2247,6 +2499,12 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
 
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
+  // The delegate should see the graph as the model defines it. The nodes are
+  // folded again when the tensors are allocated.
+  if (!folded_nodes_.empty()) {
+    UnfoldConstantNodes();
+    if (state_ == kStateInvokable) state_ = kStateUninvokable;
+  }
 
   const bool delegate_supports_dynamic_shapes =
       TfLiteDelegateGetFlagsInternal(delegate) &
@@ -2395,7 +2653,8 @@ void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
 }
 
 std::unique_ptr<GraphInfo> Subgraph::CreateGraphInfo() {
-  return std::unique_ptr<GraphInfo>(new InterpreterInfo(this));
+  return std::unique_ptr<GraphInfo>(new InterpreterInfo(
+      this, &execution_group_begins_, &execution_group_ends_));
 }
 
 void Subgraph::InitializeTensorReleaseMap() {
@@ -2475,4 +2734,104 @@ void Subgraph::MaybeReleaseDynamicTensors(const TfLiteNode& node,
   }
 }
 
+const MMAPAllocation* Subgraph::PagedWeightsAllocation() const {
+  if (!ShouldPageWeightsOnDemand() || !allocation_ ||
+      allocation_->type() != Allocation::Type::kMMap) {
+    return nullptr;
+  }
+  return static_cast<const MMAPAllocation*>(allocation_);
+}
+
+void Subgraph::MaybeAdviseColdWeights(const TfLiteNode& node) {
+  const MMAPAllocation* allocation = PagedWeightsAllocation();
+  if (!allocation) return;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      allocation->AdviseCold(tensor.data.raw, tensor.bytes);
+    }
+  }
+}
+
+TfLiteStatus Subgraph::FoldConstantNodes() {
+  if (!ShouldFoldConstantNodes() || has_dynamic_tensors_) return kTfLiteOk;
+  // The outputs of the subgraph stay where the callers expect them.
+  std::vector<bool> is_subgraph_output(tensors_.size(), false);
+  for (int tensor_index : outputs_) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      is_subgraph_output[tensor_index] = true;
+    }
+  }
+  auto is_constant = [](const TfLiteTensor& tensor) {
+    return tensor.allocation_type == kTfLiteMmapRo ||
+           tensor.allocation_type == kTfLitePersistentRo;
+  };
+
+  folded_nodes_.assign(nodes_and_registration_.size(), false);
+  bool any_folded = false;
+  for (int node_index : execution_plan_) {
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    if (node.delegate != nullptr ||
+        !IsFoldableBuiltinOp(registration.builtin_code)) {
+      continue;
+    }
+    bool computed_when_prepared = true;
+    bool can_fold = true;
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      computed_when_prepared &= tensor.allocation_type == kTfLitePersistentRo;
+      can_fold &= tensor.allocation_type == kTfLiteArenaRw &&
+                  !tensor.is_variable && tensor.type != kTfLiteString &&
+                  !is_subgraph_output[tensor_index];
+    }
+    if (!computed_when_prepared) {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        can_fold &= is_constant(tensors_[tensor_index]);
+      }
+      if (!can_fold) continue;
+      // The kernel writes into the arena as planned, as some kernels skip
+      // persistent read-only outputs, which they expect to be computed when
+      // preparing. The outputs are then copied out of the arena.
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+      if (OpInvoke(registration, &node) != kTfLiteOk) {
+        return ReportOpError(&context_, node, registration, node_index,
+                             "failed to fold");
+      }
+      for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        TfLiteTensor& tensor = tensors_[tensor_index];
+        const char* arena_data = tensor.data.raw;
+        tensor.data.raw = nullptr;
+        tensor.allocation_type = kTfLitePersistentRo;
+        folded_tensors_.push_back(tensor_index);
+        TF_LITE_ENSURE_STATUS(TfLiteTensorRealloc(tensor.bytes, &tensor));
+        if (tensor.bytes > 0) {
+          std::memcpy(tensor.data.raw, arena_data, tensor.bytes);
+        }
+      }
+    }
+    folded_nodes_[node_index] = true;
+    any_folded = true;
+  }
+  if (!any_folded) folded_nodes_.clear();
+  return kTfLiteOk;
+}
+
+void Subgraph::UnfoldConstantNodes() {
+  if (folded_nodes_.empty()) return;
+  for (int tensor_index : folded_tensors_) {
+    TfLiteTensor& tensor = tensors_[tensor_index];
+    TfLiteTensorDataFree(&tensor);
+    tensor.allocation_type = kTfLiteArenaRw;
+  }
+  folded_tensors_.clear();
+  folded_nodes_.clear();
+}
+
 }  // namespace tflite
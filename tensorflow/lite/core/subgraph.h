@@ -33,9 +33,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_scheduler.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -474,6 +476,24 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if the weights of a memory-mapped model should be paged in on demand.
+  bool ShouldPageWeightsOnDemand() const {
+    return (options_ && options_->GetPageWeightsOnDemand());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the nodes whose inputs are all constant should be folded.
+  bool ShouldFoldConstantNodes() const {
+    return (options_ && options_->GetFoldConstantNodes());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // The number of threads that run independent nodes concurrently.
+  int NumInterOpThreads() const {
+    return options_ ? options_->GetNumInterOpThreads() : 1;
+  }
+
   // Retrieves the corresponding TfLiteContext of a subgraph given a subgraph
   // index and switches to the delegate context for this subgraph. If an invalid
   // subgraph index is given, returns kTfLiteError.
@@ -658,6 +678,27 @@ class Subgraph {
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
+  // Checks that the inputs of `node` have data, and makes those produced by
+  // delegates readable.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Forgets the groups of nodes scheduled by ScheduleInterOpGroups(), e.g.
+  // when the execution plan changes.
+  void ClearInterOpGroups();
+
+  // When several inter-op threads are enabled, reorders the execution plan
+  // into groups of nodes that may run concurrently, and replans the tensor
+  // allocations so that the tensors of a group don't share memory.
+  TfLiteStatus ScheduleInterOpGroups();
+
+  // Returns whether InvokeInterOpGroups() can run the current execution plan.
+  bool CanInvokeInterOpGroups() const;
+
+  // Invokes the groups of nodes scheduled by ScheduleInterOpGroups(), running
+  // the nodes of each group concurrently on inter_op_thread_pool_.
+  TfLiteStatus InvokeInterOpGroups();
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -923,6 +964,33 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Returns the memory-mapped allocation of the model if its weights should be
+  // paged in on demand, or nullptr.
+  const MMAPAllocation* PagedWeightsAllocation() const;
+
+  // Hints the OS that the memory-mapped weights of `node` won't be read again
+  // soon once it ran, if the weights are paged in on demand.
+  void MaybeAdviseColdWeights(const TfLiteNode& node);
+
+  // Evaluates the nodes of stateless builtin ops whose inputs are all constant
+  // and moves their outputs out of the arena into persistent read-only
+  // buffers, if the constant nodes should be folded. Marks those nodes, and
+  // the ones whose outputs the kernels computed when preparing them, as folded
+  // so that Invoke() skips them. Requires the whole execution plan to be
+  // prepared and allocated.
+  TfLiteStatus FoldConstantNodes();
+
+  // Moves the outputs that FoldConstantNodes() moved back to the arena, so that
+  // they're planned again, and unmarks the folded nodes. The tensors must then
+  // be allocated again before invoking.
+  void UnfoldConstantNodes();
+
+  // True if Invoke() should skip the node at `node_index`.
+  bool IsFoldedNode(int node_index) const {
+    return static_cast<size_t>(node_index) < folded_nodes_.size() &&
+           folded_nodes_[node_index];
+  }
+
   // The state of the Subgraph.
   enum State {
     // The Subgraph isn't ready to be invoked.
@@ -1138,6 +1206,29 @@ class Subgraph {
   /// The allocator used for holding memory of the model. Note that this will
   /// be null if the client provides a tflite::Model directly.
   const Allocation* allocation_ = nullptr;
+
+  // The execution plan as reordered by ScheduleInterOpGroups(), and the
+  // indices in it of the first and last node of the group of each node. They
+  // are empty when the nodes run one at a time.
+  std::vector<int> inter_op_execution_plan_;
+  std::vector<int> execution_group_begins_;
+  std::vector<int> execution_group_ends_;
+
+  // The threads running the nodes of a group, created by the first call to
+  // InvokeInterOpGroups().
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // The contexts passed to the nodes run by the threads of the pool but the
+  // calling one, which each have their own CPU backend context, as those
+  // aren't thread-safe.
+  std::vector<TfLiteContext> inter_op_contexts_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
+
+  // Whether each node is folded, see FoldConstantNodes(). Empty if none is.
+  std::vector<bool> folded_nodes_;
+  // The tensors that FoldConstantNodes() moved out of the arena.
+  std::vector<int> folded_tensors_;
 };
 
 }  // namespace tflite
@@ -692,13 +692,16 @@ CreateGpuModelInfo GetCreateInfo(const Environment& environment,
 
 class InferenceBuilderImpl : public InferenceBuilder {
  public:
-  explicit InferenceBuilderImpl(Environment* environment)
-      : environment_(environment) {}
+  InferenceBuilderImpl(Environment* environment,
+                       SharedIntermediateBuffer* shared_intermediate_buffer)
+      : environment_(environment),
+        shared_intermediate_buffer_(shared_intermediate_buffer) {}
 
   absl::Status Initialize(const InferenceOptions& options,
                           const InferenceEnvironmentOptions& env_options,
                           const GraphFloat32& graph) {
     context_ = std::make_unique<InferenceContext>();
+    context_->SetSharedIntermediateBuffer(shared_intermediate_buffer_);
     CreateGpuModelInfo create_info = GetCreateInfo(*environment_, options);
     RETURN_IF_ERROR(context_->InitFromGraph(create_info, graph, environment_));
 
@@ -723,6 +726,7 @@ class InferenceBuilderImpl : public InferenceBuilder {
   absl::Status Initialize(const InferenceEnvironmentOptions& env_options,
                           const absl::Span<const uint8_t> serialized_model) {
     context_ = std::make_unique<InferenceContext>();
+    context_->SetSharedIntermediateBuffer(shared_intermediate_buffer_);
     RETURN_IF_ERROR(
         context_->RestoreDeserialized(serialized_model, environment_));
 
@@ -853,6 +857,7 @@ class InferenceBuilderImpl : public InferenceBuilder {
   std::unique_ptr<GlInteropFabric> gl_interop_fabric_;
 #endif
   Environment* environment_;
+  SharedIntermediateBuffer* shared_intermediate_buffer_;  // Not owned.
 
   std::vector<TensorTieDef> inputs_;
   std::vector<TensorTieDef> outputs_;
@@ -971,7 +976,8 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     }
 
     RETURN_IF_ERROR(RunGraphTransformsForGpuModel(&model));
-    auto builder_impl = std::make_unique<InferenceBuilderImpl>(&environment_);
+    auto builder_impl = std::make_unique<InferenceBuilderImpl>(
+        &environment_, shared_intermediate_buffer());
     RETURN_IF_ERROR(
         builder_impl->Initialize(resolved_options, options_, model));
     *builder = std::move(builder_impl);
@@ -990,7 +996,8 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
           .IgnoreError();
     }
 
-    auto builder_impl = std::make_unique<InferenceBuilderImpl>(&environment_);
+    auto builder_impl = std::make_unique<InferenceBuilderImpl>(
+        &environment_, shared_intermediate_buffer());
     RETURN_IF_ERROR(builder_impl->Initialize(options_, serialized_model));
     *builder = std::move(builder_impl);
     return absl::OkStatus();
@@ -1010,9 +1017,15 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
   }
 
  private:
+  SharedIntermediateBuffer* shared_intermediate_buffer() {
+    return options_.share_intermediate_buffers ? &shared_intermediate_buffer_
+                                               : nullptr;
+  }
+
   const InferenceEnvironmentOptions options_;
   Environment environment_;
   InferenceEnvironmentProperties properties_;
+  SharedIntermediateBuffer shared_intermediate_buffer_;
 };
 
 }  // namespace
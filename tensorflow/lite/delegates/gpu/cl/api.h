@@ -129,6 +129,11 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // Whether the inference runners created from the environment share the
+  // memory of their intermediate tensors. The runners must then never run at
+  // the same time, e.g. when they are partitions of the same model.
+  bool share_intermediate_buffers = false;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
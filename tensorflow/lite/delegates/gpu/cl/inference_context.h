@@ -63,6 +63,21 @@ struct CLNode {
 
 enum class TensorType { kVariable, kConst, kExternal, kRuntime };
 
+// A buffer for the intermediate tensors of inference contexts that never run
+// at the same time, e.g. the partitions of a model that run one after the
+// other on the same queue, so that they don't each allocate their own.
+class SharedIntermediateBuffer {
+ public:
+  // Returns a buffer of at least `size` bytes. It is only replaced by a larger
+  // one when a context needs more memory than the previous ones, which keep
+  // the buffer they got alive.
+  absl::Status Get(size_t size, CLContext* context,
+                   std::shared_ptr<Buffer>* buffer);
+
+ private:
+  std::shared_ptr<Buffer> buffer_;
+};
+
 class InferenceContext {
  public:
   absl::Status InitFromGraph(const CreateGpuModelInfo& create_info,
@@ -76,6 +91,12 @@ class InferenceContext {
 
   absl::Status AddToCommanBuffer(cl_command_buffer_khr cb);
 
+  // Allocates the buffer based intermediate tensors in `shared_buffer`, which
+  // must outlive the initialization. Must be called before it.
+  void SetSharedIntermediateBuffer(SharedIntermediateBuffer* shared_buffer) {
+    shared_intermediate_buffer_ = shared_buffer;
+  }
+
   // Applies OpenCL-specific transformations to the graph before the
   // initialization. These transformations are either impossible or useless in
   // other backends.
@@ -129,6 +150,9 @@ class InferenceContext {
   absl::Status AllocateVariableTensors(const GpuModel& gpu_model,
                                        CLContext* context);
 
+  // Sets shared_buffers_parent_ptr_ to a buffer of at least `size` bytes.
+  absl::Status AllocateSharedBuffersParent(size_t size, CLContext* context);
+
   absl::Status AllocateBufferBasedTensors(const GpuModel& gpu_model,
                                           const GpuInfo& gpu_info,
                                           const CreateGpuModelInfo* create_info,
@@ -182,7 +206,8 @@ class InferenceContext {
   std::map<ValueId, ValueId> variable_ids_and_refs_;
   std::map<ValueId, Tensor> variable_tensors_;
 
-  std::unique_ptr<Buffer> shared_buffers_parent_;
+  SharedIntermediateBuffer* shared_intermediate_buffer_ = nullptr;
+  std::shared_ptr<Buffer> shared_buffers_parent_;
   Buffer* shared_buffers_parent_ptr_ = nullptr;
   std::vector<Buffer> shared_buffers_;
   std::vector<Tensor>
@@ -174,9 +174,7 @@ class Delegate {
     if (options_.max_delegated_partitions <= 0) {
       options_.max_delegated_partitions = 1;
     }
-    if (options_.experimental_flags &
-            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
-        options_.model_token && options_.serialization_dir) {
+    if (options_.model_token && options_.serialization_dir) {
       SerializationParams params;
       params.model_token = options_.model_token;
       params.cache_dir = options_.serialization_dir;
@@ -188,6 +186,22 @@ class Delegate {
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
+
+  // Returns the OpenCL environment shared by the kernels of this delegate, so
+  // that they share the memory of their intermediate tensors.
+  absl::Status GetSharedClEnvironment(
+      cl::InferenceEnvironmentOptions env_options,
+      cl::InferenceEnvironmentProperties* properties,
+      cl::InferenceEnvironment** environment) {
+    if (shared_cl_environment_ == nullptr) {
+      env_options.share_intermediate_buffers = true;
+      RETURN_IF_ERROR(cl::NewInferenceEnvironment(
+          env_options, &shared_cl_environment_, &shared_cl_properties_));
+    }
+    if (properties) *properties = shared_cl_properties_;
+    *environment = shared_cl_environment_.get();
+    return absl::OkStatus();
+  }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
   bool async() const { return async_; }
 
@@ -210,6 +224,9 @@ class Delegate {
 
   std::unique_ptr<Serialization> serialization_;
 
+  std::unique_ptr<cl::InferenceEnvironment> shared_cl_environment_;
+  cl::InferenceEnvironmentProperties shared_cl_properties_;
+
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
 
   bool async_;
@@ -280,10 +297,17 @@ class DelegateKernelCore {
       cl::InferenceOptions* options, Serialization* serialization,
       const std::vector<uint8_t>& serialized_model);
 
+  // Sets cl_environment_ to the environment of the delegate if its kernels
+  // share their intermediate buffers, or else to a new one.
+  absl::Status InitializeClEnvironment(
+      const cl::InferenceEnvironmentOptions& env_options,
+      cl::InferenceEnvironmentProperties* properties);
+
   // The Delegate instance that's shared across all DelegateKernel instances.
   Delegate* const delegate_;  // doesn't own the memory.
 
-  std::unique_ptr<cl::InferenceEnvironment> cl_environment_;
+  cl::InferenceEnvironment* cl_environment_ = nullptr;
+  std::unique_ptr<cl::InferenceEnvironment> own_cl_environment_;
 #ifndef CL_DELEGATE_NO_GL
   std::unique_ptr<gl::InferenceEnvironment> gl_environment_;
 #endif
@@ -478,8 +502,7 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
 
   if (!serialization) {
     // This path is faster when there is no serialization involved.
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(env_options, &properties));
     *graph_is_destroyed = true;
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
@@ -492,8 +515,7 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
       return absl::OkStatus();
     }
 
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(env_options, &properties));
     *graph_is_destroyed = true;
     std::vector<uint8_t> serialized_model;
     RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
@@ -501,8 +523,16 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     RETURN_IF_ERROR(
         cl_environment_->NewInferenceBuilder(serialized_model, builder));
 
-    RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
-                                         serialization, serialized_model));
+    const absl::Status save_status = SaveSerializedOpenCL(
+        context, delegate_params, &options, serialization, serialized_model);
+    if (delegate_options.experimental_flags &
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION) {
+      RETURN_IF_ERROR(save_status);
+    } else if (!save_status.ok()) {
+      // Serializing is only an optimization of the next initializations.
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING, "%s",
+                      std::string(save_status.message()).c_str());
+    }
   }
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
@@ -510,6 +540,22 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
   return absl::OkStatus();
 }
 
+absl::Status DelegateKernelCore::InitializeClEnvironment(
+    const cl::InferenceEnvironmentOptions& env_options,
+    cl::InferenceEnvironmentProperties* properties) {
+  // Kernels of the async API may run concurrently.
+  if (!delegate_->async() &&
+      (delegate_->options().experimental_flags &
+       TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_BUFFERS)) {
+    return delegate_->GetSharedClEnvironment(env_options, properties,
+                                             &cl_environment_);
+  }
+  RETURN_IF_ERROR(cl::NewInferenceEnvironment(
+      env_options, &own_cl_environment_, properties));
+  cl_environment_ = own_cl_environment_.get();
+  return absl::OkStatus();
+}
+
 // Returns Ok only if serialized data is successfully found.
 absl::Status DelegateKernelCore::InitializeOpenGlApi(
     GraphFloat32* graph, std::unique_ptr<InferenceBuilder>* builder) {
@@ -555,8 +601,7 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
   if (model_data_status == kTfLiteOk) {
     absl::Span<const uint8_t> model_span = absl::Span<const uint8_t>{
         reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size()};
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(*env_options, &cl_environment_,
-                                                properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(*env_options, properties));
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(model_span, builder));
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                          "Initialized OpenCL-based API from serialized data.");
@@ -762,6 +807,13 @@ class DelegateAsyncKernel : public BackendAsyncKernelInterface {
   TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node,
                         TfLiteExecutionTask* task);
 
+  // Returns the OpenGL buffer bound to the AHardwareBuffer of `handle`, which
+  // is only created on the first call for the handle. Must be called on the
+  // thread the EGL environment was created on.
+  absl::Status GetOpenGlBuffer(TfLiteBufferHandle handle,
+                               const TensorObjectDef& tensor_def, GLuint* id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(eval_mutex_);
+
   using UniquePtrAHardwareBuffer =
       std::unique_ptr<AHardwareBuffer, void (*)(AHardwareBuffer*)>;
   static UniquePtrAHardwareBuffer Acquire(AHardwareBuffer* ahwb) {
@@ -813,6 +865,17 @@ class DelegateAsyncKernel : public BackendAsyncKernelInterface {
   absl::flat_hash_map<TfLiteBufferHandle, UniquePtrAHardwareBuffer>
       buffer_by_handle_ ABSL_GUARDED_BY(eval_mutex_);
   std::vector<SyncType> output_sync_types_ ABSL_GUARDED_BY(eval_mutex_);
+
+  // Kept across calls to Eval on the same thread, so that the registered
+  // buffers are bound to OpenGL buffers only once.
+  std::unique_ptr<gl::EglEnvironment> egl_environment_
+      ABSL_GUARDED_BY(eval_mutex_);
+  std::thread::id egl_thread_id_ ABSL_GUARDED_BY(eval_mutex_);
+  absl::flat_hash_map<TfLiteBufferHandle, GLuint> gl_buffer_by_handle_
+      ABSL_GUARDED_BY(eval_mutex_);
+  // The OpenGL buffers of unregistered buffers, deleted by the next Eval as
+  // the EGL context may not be current when UnregisterBuffer is called.
+  std::vector<GLuint> released_gl_buffers_ ABSL_GUARDED_BY(eval_mutex_);
 };
 
 absl::Status DelegateAsyncKernel::Init(TfLiteContext* context,
@@ -1112,9 +1175,28 @@ TfLiteStatus DelegateAsyncKernel::UnregisterBufferImpl(
   TFLITE_RET_CHECK_STATUS(it != buffer_by_handle_.end(),
                           "UnregisterBuffer called with unknown handle");
   buffer_by_handle_.erase(it);
+  auto gl_it = gl_buffer_by_handle_.find(handle);
+  if (gl_it != gl_buffer_by_handle_.end()) {
+    released_gl_buffers_.push_back(gl_it->second);
+    gl_buffer_by_handle_.erase(gl_it);
+  }
   return kTfLiteOk;
 }
 
+absl::Status DelegateAsyncKernel::GetOpenGlBuffer(
+    TfLiteBufferHandle handle, const TensorObjectDef& tensor_def, GLuint* id) {
+  auto it = gl_buffer_by_handle_.find(handle);
+  if (it != gl_buffer_by_handle_.end()) {
+    *id = it->second;
+    return absl::OkStatus();
+  }
+  AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
+  AsyncBuffer async_buffer = AsyncBuffer(tensor_def, ahwb);
+  RETURN_IF_ERROR(async_buffer.GetOpenGlBuffer(*id));
+  gl_buffer_by_handle_[handle] = *id;
+  return absl::OkStatus();
+}
+
 TfLiteStatus DelegateAsyncKernel::Eval(TfLiteOpaqueContext* opaque_context,
                                        TfLiteOpaqueNode* opaque_node,
                                        TfLiteExecutionTask* task) {
@@ -1170,35 +1252,45 @@ TfLiteStatus DelegateAsyncKernel::EvalImpl(TfLiteContext* context,
   const auto waitfor = WaitForAllFds(unique_input_cpu_sync_fds_vec);
   TFLITE_RET_CHECK_STATUS(waitfor.has_value(), "wait for input fds");
 
-  // Needed for cl inference. For gl it re-uses the existing context.
-  std::unique_ptr<gl::EglEnvironment> env;
-  TFLITE_RETURN_IF_ABSL_ERROR(gl::EglEnvironment::NewEglEnvironment(&env));
-  for (int i = 0; i < core_.runner()->inputs().size(); i++) {
-    TensorObjectDef tensor_def = core_.runner()->inputs()[i];
-    TfLiteBufferHandle handle =
-        TfLiteExecutionTaskGetBufferByIndex(task, core_.input_indices()[i]);
-    TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
-
-    absl::MutexLock eval_lock(&eval_mutex_);
-    AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
-    AsyncBuffer async_buffer = AsyncBuffer(tensor_def, ahwb);
-    OpenGlBuffer buffer;
-    TFLITE_RETURN_IF_ABSL_ERROR(async_buffer.GetOpenGlBuffer(buffer.id));
-    TFLITE_RETURN_IF_ABSL_ERROR(
-        core_.runner()->SetInputObject(i, std::move(buffer)));
-  }
-  for (int i = 0; i < core_.runner()->outputs().size(); i++) {
-    TensorObjectDef tensor_def = core_.runner()->outputs()[i];
-    TfLiteBufferHandle handle =
-        TfLiteExecutionTaskGetBufferByIndex(task, core_.output_indices()[i]);
-    TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
+  {
     absl::MutexLock eval_lock(&eval_mutex_);
-    AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
-    AsyncBuffer async_buffer = AsyncBuffer(tensor_def, ahwb);
-    OpenGlBuffer buffer;
-    TFLITE_RETURN_IF_ABSL_ERROR(async_buffer.GetOpenGlBuffer(buffer.id));
-    TFLITE_RETURN_IF_ABSL_ERROR(
-        core_.runner()->SetOutputObject(i, std::move(buffer)));
+    // Needed for cl inference. For gl it re-uses the existing context. The
+    // EGL context is only current on the thread that created it, so the
+    // OpenGL buffers are bound again if Eval is called from another thread.
+    if (egl_environment_ == nullptr ||
+        egl_thread_id_ != std::this_thread::get_id()) {
+      gl_buffer_by_handle_.clear();
+      released_gl_buffers_.clear();
+      egl_environment_.reset();
+      TFLITE_RETURN_IF_ABSL_ERROR(
+          gl::EglEnvironment::NewEglEnvironment(&egl_environment_));
+      egl_thread_id_ = std::this_thread::get_id();
+    }
+    if (!released_gl_buffers_.empty()) {
+      glDeleteBuffers(released_gl_buffers_.size(),
+                      released_gl_buffers_.data());
+      released_gl_buffers_.clear();
+    }
+    for (int i = 0; i < core_.runner()->inputs().size(); i++) {
+      TfLiteBufferHandle handle =
+          TfLiteExecutionTaskGetBufferByIndex(task, core_.input_indices()[i]);
+      TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
+      OpenGlBuffer buffer;
+      TFLITE_RETURN_IF_ABSL_ERROR(GetOpenGlBuffer(
+          handle, core_.runner()->inputs()[i], &buffer.id));
+      TFLITE_RETURN_IF_ABSL_ERROR(
+          core_.runner()->SetInputObject(i, std::move(buffer)));
+    }
+    for (int i = 0; i < core_.runner()->outputs().size(); i++) {
+      TfLiteBufferHandle handle =
+          TfLiteExecutionTaskGetBufferByIndex(task, core_.output_indices()[i]);
+      TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
+      OpenGlBuffer buffer;
+      TFLITE_RETURN_IF_ABSL_ERROR(GetOpenGlBuffer(
+          handle, core_.runner()->outputs()[i], &buffer.id));
+      TFLITE_RETURN_IF_ABSL_ERROR(
+          core_.runner()->SetOutputObject(i, std::move(buffer)));
+    }
   }
   TFLITE_RETURN_IF_ABSL_ERROR(core_.runner()->Run());
   // Add sync objects
@@ -61,16 +61,21 @@ enum TfLiteGpuExperimentalFlags {
   // Enforces execution with the provided backend.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY = 1 << 1,
   TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY = 1 << 2,
-  // Enable serialization of GPU kernels & model data. Speeds up initialization
-  // at the cost of space on disk.
+  // Requires serialization of GPU kernels & model data, i.e. the compiled
+  // programs and tuned work group sizes. Speeds up initialization at the cost
+  // of space on disk.
   // Delegate performs serialization the first time it is applied with a new
-  // model or inference params. Later initializations are fast.
-  // ModifyGraphWithDelegate will fail if data cannot be serialized.
-  //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // model, inference params or GPU driver. Later initializations are fast.
+  // Serialization already happens whenever serialization_dir & model_token are
+  // set in TfLiteGpuDelegateOptionsV2; with this flag,
+  // ModifyGraphWithDelegate will also fail if data cannot be serialized.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Makes the delegated partitions of all the subgraphs share the memory of
+  // their intermediate tensors, as they run one after the other. The delegate
+  // must then only be used with a single interpreter.
+  // Currently works only if CL backend is used, and not with the async API.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_BUFFERS = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -118,8 +123,9 @@ typedef struct {
   int32_t max_delegated_partitions;
 
   // The nul-terminated directory to use for serialization.
-  // Whether serialization actually happens or not is dependent on backend used
-  // and validity of this directory.
+  // Serialization is enabled when both this and model_token are set. Whether
+  // it actually happens or not is dependent on backend used and validity of
+  // this directory.
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
   // delegate will not try serialization.
   //
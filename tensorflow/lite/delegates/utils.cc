@@ -135,6 +135,58 @@ std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
   return ops_to_replace;
 }
 
+std::vector<TfLiteDelegateParams*>
+GraphPartitionHelper::GetPartitionsWithLowestCost(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<std::pair<double, TfLiteDelegateParams*>> savings;
+  for (TfLiteDelegateParams* partition : partitions_) {
+    double saving = 0;
+    bool has_all_nodes = true;
+    for (int node_index : TfLiteIntArrayView(partition->nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      if (context_->GetNodeAndRegistration(context_, node_index, &node,
+                                           &registration) != kTfLiteOk) {
+        has_all_nodes = false;
+        break;
+      }
+      saving += cost_model.cpu_cost(context_, node_index, node, registration) -
+                cost_model.delegate_cost(context_, node_index, node,
+                                         registration);
+    }
+    for (const TfLiteIntArray* tensors :
+         {partition->input_tensors, partition->output_tensors}) {
+      if (tensors == nullptr) continue;
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        saving -= cost_model.transfer_cost(context_, tensor_index);
+      }
+    }
+    if (has_all_nodes && saving > 0) savings.emplace_back(saving, partition);
+  }
+  std::stable_sort(savings.begin(), savings.end(),
+                   [](const auto& left, const auto& right) {
+                     return left.first > right.first;
+                   });
+
+  std::vector<TfLiteDelegateParams*> results;
+  for (int i = 0; i < std::min<int>(savings.size(), n); ++i) {
+    results.push_back(savings[i].second);
+  }
+  return results;
+}
+
+std::vector<int> GraphPartitionHelper::GetNodesOfPartitionsWithLowestCost(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<int> ops_to_replace;
+  for (const auto p : GetPartitionsWithLowestCost(cost_model, n)) {
+    auto nodes = p->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 TfLiteStatus GraphPartitionHelper::PrepareSupportedNodes(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
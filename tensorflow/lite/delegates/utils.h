@@ -96,6 +96,25 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Estimates of the latencies, in any consistent unit, that
+// GraphPartitionHelper::GetPartitionsWithLowestCost() minimizes. Delegates may
+// derive them from the op types and tensor sizes, or calibrate them with a
+// quick timing pass on the device.
+struct PartitionCostModel {
+  using NodeCostFn = std::function<double(TfLiteContext*, int node_index,
+                                          TfLiteNode*, TfLiteRegistration*)>;
+  using TensorCostFn = std::function<double(TfLiteContext*, int tensor_index)>;
+
+  // The latency of running a node on the CPU.
+  NodeCostFn cpu_cost;
+  // The latency of running a node in the delegate.
+  NodeCostFn delegate_cost;
+  // The latency of moving a tensor between the CPU and the delegate at the
+  // boundary of a partition. Constant tensors, which delegates usually copy
+  // once when they're prepared, should cost nothing.
+  TensorCostFn transfer_cost;
+};
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -160,6 +179,25 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns the partitions whose delegation lowers the estimated latency of
+  // the graph per `cost_model`, at most `n` of them, by decreasing saving.
+  // The saving of a partition is the CPU cost of its nodes minus their
+  // delegate cost and minus the transfer cost of its input and output
+  // tensors. As the CPU runs the nodes between any two partitions, the savings
+  // are independent, so this returns the set of partitions with the lowest
+  // total latency when `n` doesn't limit it.
+  // The returned TfLiteDelegateParams objects are *owned* by the TfLite
+  // runtime.
+  std::vector<TfLiteDelegateParams*> GetPartitionsWithLowestCost(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
+  // Returns a list of node indices of all nodes from the partitions returned
+  // by GetPartitionsWithLowestCost().
+  std::vector<int> GetNodesOfPartitionsWithLowestCost(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
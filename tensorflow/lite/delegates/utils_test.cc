@@ -253,6 +253,39 @@ TEST(GraphPartitionHelper, CheckPartitions) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+TEST(GraphPartitionHelper, CheckPartitionsWithLowestCost) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6},
+  // without input and output tensors.
+  MockTfLiteContext mocked_context;
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+
+  // Only the odd nodes run faster in the delegate.
+  PartitionCostModel cost_model;
+  cost_model.cpu_cost = [](TfLiteContext*, int node_index, TfLiteNode*,
+                           TfLiteRegistration*) { return 10.0; };
+  cost_model.delegate_cost = [](TfLiteContext*, int node_index, TfLiteNode*,
+                                TfLiteRegistration*) {
+    return node_index % 2 ? 1.0 : 12.0;
+  };
+  cost_model.transfer_cost = [](TfLiteContext*, int) { return 100.0; };
+
+  // Savings: {1}: 9, {0,3,7,8}: 14, {2,4,9}: 5, {5,6}: 7.
+  auto partitions = helper.GetPartitionsWithLowestCost(cost_model);
+  EXPECT_THAT(GetNodesToReplaceFromPartitions(partitions),
+              testing::ElementsAreArray({0, 3, 7, 8, 1, 5, 6, 2, 4, 9}));
+  EXPECT_THAT(helper.GetNodesOfPartitionsWithLowestCost(cost_model, 2),
+              testing::ElementsAreArray({0, 3, 7, 8, 1}));
+
+  // Savings: {1}: 9, {0,3,7,8}: 8, {2,4,9}: -1, {5,6}: 4.
+  cost_model.delegate_cost = [](TfLiteContext*, int node_index, TfLiteNode*,
+                                TfLiteRegistration*) {
+    return node_index % 2 ? 1.0 : 15.0;
+  };
+  EXPECT_THAT(helper.GetNodesOfPartitionsWithLowestCost(cost_model),
+              testing::ElementsAreArray({1, 0, 3, 7, 8, 5, 6}));
+}
+
 TfLiteStatus ErrorGetExecutionPlan(TfLiteContext* context,
                                    TfLiteIntArray** execution_plan) {
   return kTfLiteError;
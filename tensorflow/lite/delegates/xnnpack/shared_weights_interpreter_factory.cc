@@ -0,0 +1,107 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_interpreter_factory.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace xnnpack {
+
+std::unique_ptr<SharedWeightsInterpreterFactory>
+SharedWeightsInterpreterFactory::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const TfLiteXNNPackDelegateOptions* options) {
+  std::unique_ptr<SharedWeightsInterpreterFactory> factory(
+      new SharedWeightsInterpreterFactory(
+          model, op_resolver,
+          options != nullptr ? *options
+                             : TfLiteXNNPackDelegateOptionsDefault()));
+  if (factory->weights_cache_ == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to create the weights cache.");
+    return nullptr;
+  }
+  // Applying the delegate to a first interpreter packs the weights into the
+  // cache. The packed weights live as long as the cache, so the interpreter
+  // is not needed afterwards.
+  std::unique_ptr<Interpreter> interpreter;
+  if (factory->BuildInterpreter(&interpreter) != kTfLiteOk) {
+    return nullptr;
+  }
+  // The number of interpreters is not known in advance, so the cache is only
+  // soft-finalized, which still allows the lookups of the next delegates.
+  if (!TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(
+          factory->weights_cache_.get())) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to finalize the weights cache.");
+    return nullptr;
+  }
+  return factory;
+}
+
+SharedWeightsInterpreterFactory::SharedWeightsInterpreterFactory(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const TfLiteXNNPackDelegateOptions& options)
+    : model_(model),
+      op_resolver_(op_resolver),
+      options_(options),
+      weights_cache_(TfLiteXNNPackDelegateWeightsCacheCreate(),
+                     TfLiteXNNPackDelegateWeightsCacheDelete) {
+  options_.weights_cache = weights_cache_.get();
+}
+
+SharedWeightsInterpreterFactory::~SharedWeightsInterpreterFactory() = default;
+
+std::unique_ptr<Interpreter>
+SharedWeightsInterpreterFactory::CreateInterpreter() const {
+  std::unique_ptr<Interpreter> interpreter;
+  if (BuildInterpreter(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return interpreter;
+}
+
+TfLiteStatus SharedWeightsInterpreterFactory::BuildInterpreter(
+    std::unique_ptr<Interpreter>* interpreter) const {
+  if (InterpreterBuilder(model_, op_resolver_)(interpreter) != kTfLiteOk ||
+      *interpreter == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to build an interpreter.");
+    return kTfLiteError;
+  }
+  Interpreter::TfLiteDelegatePtr delegate(
+      TfLiteXNNPackDelegateCreate(&options_), TfLiteXNNPackDelegateDelete);
+  if (delegate == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to create the XNNPACK delegate.");
+    return kTfLiteError;
+  }
+  // The interpreter takes ownership of its delegate.
+  if ((*interpreter)->ModifyGraphWithDelegate(std::move(delegate)) !=
+      kTfLiteOk) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to apply the XNNPACK delegate.");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
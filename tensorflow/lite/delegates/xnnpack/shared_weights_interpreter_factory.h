@@ -0,0 +1,83 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
+
+#include <memory>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace xnnpack {
+
+// Creates interpreters that run one model concurrently, e.g. to serve
+// concurrent requests, without duplicating its weights.
+//
+// All the interpreters read the constant tensors from the model buffer, and
+// apply their own XNNPACK delegate with one weights cache, so the weights are
+// only packed once, when the factory is created. Each interpreter only owns
+// its tensor arenas and the runtime of its delegate. An interpreter must still
+// be used by one thread at a time, but different interpreters can run
+// concurrently.
+//
+// The nodes that the XNNPACK delegate doesn't support run with the kernels of
+// each interpreter. Their prepacked weights, if any, are not shared.
+//
+// WARNING: This is an experimental API and subject to change.
+class SharedWeightsInterpreterFactory {
+ public:
+  // Creates an interpreter for `model` to pack its weights with `options`,
+  // or the default options if nullptr. The weights cache of `options` is
+  // replaced by the shared one. Returns nullptr on failure.
+  //
+  // `model` and `op_resolver` must outlive the factory. `op_resolver` should
+  // not apply the XNNPACK delegate by default, e.g. use
+  // BuiltinOpResolverWithoutDefaultDelegates.
+  static std::unique_ptr<SharedWeightsInterpreterFactory> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const TfLiteXNNPackDelegateOptions* options = nullptr);
+
+  ~SharedWeightsInterpreterFactory();
+
+  // Returns a new interpreter for the model, with its tensors allocated, or
+  // nullptr on failure. Thread-safe. The factory must outlive the interpreter.
+  std::unique_ptr<Interpreter> CreateInterpreter() const;
+
+ private:
+  SharedWeightsInterpreterFactory(const FlatBufferModel& model,
+                                  const OpResolver& op_resolver,
+                                  const TfLiteXNNPackDelegateOptions& options);
+
+  // Builds an interpreter using the shared weights cache, and applies the
+  // delegate, but doesn't allocate the tensors.
+  TfLiteStatus BuildInterpreter(
+      std::unique_ptr<Interpreter>* interpreter) const;
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  TfLiteXNNPackDelegateOptions options_;
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+      weights_cache_;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
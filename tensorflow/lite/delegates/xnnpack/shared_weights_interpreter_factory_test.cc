@@ -0,0 +1,84 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_interpreter_factory.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// Runs `interpreter` on an input that only depends on the element index, and
+// returns the output.
+std::vector<float> RunOnFixedInput(Interpreter* interpreter) {
+  TfLiteTensor* input = interpreter->input_tensor(0);
+  float* input_data = interpreter->typed_input_tensor<float>(0);
+  for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+    input_data[i] = static_cast<float>(i % 17) / 17.0f - 0.5f;
+  }
+  EXPECT_EQ(kTfLiteOk, interpreter->Invoke());
+  const TfLiteTensor* output = interpreter->output_tensor(0);
+  const float* output_data = interpreter->typed_output_tensor<float>(0);
+  return std::vector<float>(output_data,
+                            output_data + output->bytes / sizeof(float));
+}
+
+TEST(SharedWeightsInterpreterFactory, RunsInterpretersConcurrently) {
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromBuffer(buffer.data(), buffer.size());
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<SharedWeightsInterpreterFactory> factory =
+      SharedWeightsInterpreterFactory::Create(*model, resolver);
+  ASSERT_NE(factory, nullptr);
+
+  std::unique_ptr<Interpreter> interpreter = factory->CreateInterpreter();
+  ASSERT_NE(interpreter, nullptr);
+  const std::vector<float> expected_output =
+      RunOnFixedInput(interpreter.get());
+
+  const size_t num_threads =
+      std::min<size_t>(4, std::max(2u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&factory, &expected_output] {
+      std::unique_ptr<Interpreter> interpreter = factory->CreateInterpreter();
+      ASSERT_NE(interpreter, nullptr);
+      for (int run = 0; run < 3; ++run) {
+        EXPECT_EQ(RunOnFixedInput(interpreter.get()), expected_output);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
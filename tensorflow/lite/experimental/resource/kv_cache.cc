@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/kv_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus KVCache::Initialize(int max_seq_len, int num_heads,
+                                 int head_dim) {
+  if (max_seq_len <= 0 || num_heads <= 0 || head_dim <= 0) {
+    return kTfLiteError;
+  }
+  if (IsInitialized()) {
+    return max_seq_len == max_seq_len_ && num_heads == num_heads_ &&
+                   head_dim == head_dim_
+               ? kTfLiteOk
+               : kTfLiteError;
+  }
+  const size_t num_elements =
+      static_cast<size_t>(max_seq_len) * num_heads * head_dim;
+  keys_.resize(num_elements);
+  values_.resize(num_elements);
+  max_seq_len_ = max_seq_len;
+  num_heads_ = num_heads;
+  head_dim_ = head_dim;
+  size_ = 0;
+  return kTfLiteOk;
+}
+
+TfLiteStatus KVCache::Write(int position, int num_positions, const float* keys,
+                            const float* values) {
+  if (!IsInitialized() || position < 0 || position > size_ ||
+      num_positions < 0 || num_positions > max_seq_len_ - position) {
+    return kTfLiteError;
+  }
+  const size_t position_size = static_cast<size_t>(num_heads_) * head_dim_;
+  const size_t offset = position * position_size;
+  const size_t num_elements = num_positions * position_size;
+  std::copy_n(keys, num_elements, keys_.begin() + offset);
+  std::copy_n(values, num_elements, values_.begin() + offset);
+  size_ = position + num_positions;
+  return kTfLiteOk;
+}
+
+void CreateKVCacheIfNotAvailable(ResourceMap* resources, int resource_id) {
+  if (resources->count(resource_id) != 0) {
+    return;
+  }
+  resources->emplace(resource_id, std::make_unique<KVCache>());
+}
+
+KVCache* GetKVCache(ResourceMap* resources, int resource_id) {
+  auto it = resources->find(resource_id);
+  if (it != resources->end()) {
+    return static_cast<KVCache*>(it->second.get());
+  }
+  return nullptr;
+}
+
+}  // namespace resource
+}  // namespace tflite
@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_KV_CACHE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_KV_CACHE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// The keys and values of the attention layer of a decoder for the positions
+// of a sequence, so that each step only computes those of its new positions.
+// The cache is allocated once for `max_seq_len` positions, and written in
+// place, so that a step doesn't copy the previous positions.
+class KVCache : public ResourceBase {
+ public:
+  KVCache() = default;
+
+  KVCache(const KVCache&) = delete;
+  KVCache& operator=(const KVCache&) = delete;
+
+  // Allocates the cache for `max_seq_len` positions of `num_heads` keys and
+  // values of `head_dim` floats each. Does nothing if the cache is already
+  // allocated with the same dimensions, and fails if it has different ones.
+  TfLiteStatus Initialize(int max_seq_len, int num_heads, int head_dim);
+
+  // Writes the keys and values of the `num_positions` positions from
+  // `position`, each laid out as [num_positions, num_heads, head_dim], and
+  // drops the positions after them. E.g. a decoder writes its prompt at
+  // position 0, then each new token at the next position. Fails if the
+  // positions don't fit in the cache or aren't contiguous with the cached
+  // ones.
+  TfLiteStatus Write(int position, int num_positions, const float* keys,
+                     const float* values);
+
+  // Returns the keys or values of the cached positions, laid out as
+  // [size(), num_heads(), head_dim()].
+  const float* keys() const { return keys_.data(); }
+  const float* values() const { return values_.data(); }
+
+  // Returns the number of cached positions.
+  int size() const { return size_; }
+
+  int max_seq_len() const { return max_seq_len_; }
+  int num_heads() const { return num_heads_; }
+  int head_dim() const { return head_dim_; }
+
+  // Returns true if `Initialize` was called.
+  bool IsInitialized() override { return max_seq_len_ > 0; }
+
+  size_t GetMemoryUsage() override {
+    return (keys_.size() + values_.size()) * sizeof(float);
+  }
+
+ private:
+  std::vector<float> keys_;
+  std::vector<float> values_;
+  int max_seq_len_ = 0;
+  int num_heads_ = 0;
+  int head_dim_ = 0;
+  int size_ = 0;
+};
+
+// Creates a KV cache, shared among all the subgraphs with the given resource
+// id if there is an existing one.
+// WARNING: Experimental interface, subject to change.
+void CreateKVCacheIfNotAvailable(ResourceMap* resources, int resource_id);
+
+// Returns the corresponding KV cache, or nullptr if none.
+// WARNING: Experimental interface, subject to change.
+KVCache* GetKVCache(ResourceMap* resources, int resource_id);
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_KV_CACHE_H_
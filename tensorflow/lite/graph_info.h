@@ -70,6 +70,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the execution-plan indices of the first and last node of the group
+  // of consecutive nodes that the node at `index` belongs to. The nodes of a
+  // group may run concurrently, so the tensors that they use must not share
+  // memory. By default, the nodes run one at a time.
+  virtual size_t execution_group_begin(size_t index) const { return index; }
+  virtual size_t execution_group_end(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -29,7 +29,10 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_num_inter_op_threads_(1),
+        experimental_page_weights_on_demand_(false),
+        experimental_fold_constant_nodes_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +96,53 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  // Sets the number of threads that run independent nodes of the graph
+  // concurrently, e.g. the branches of a multi-tower model. The default, 1,
+  // runs the nodes one at a time. Only static graphs that don't use delegates,
+  // control flow or resources have independent nodes.
+  // WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int value) {
+    experimental_num_inter_op_threads_ = value > 1 ? value : 1;
+  }
+
+  // Returns the number of threads that run independent nodes concurrently.
+  // WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() { return experimental_num_inter_op_threads_; }
+
+  // If value == true, the weights of a memory-mapped model are only read in
+  // from the file when the nodes using them run, and are reclaimed first under
+  // memory pressure once they ran, so that the resident memory of large models
+  // tracks the weights in use rather than the whole model.
+  // WARNING: This is an experimental API and subject to change.
+  void SetPageWeightsOnDemand(bool value = true) {
+    experimental_page_weights_on_demand_ = value;
+  }
+
+  // Returns if the `experimental_page_weights_on_demand_` feature is enabled.
+  // WARNING: This is an experimental API and subject to change.
+  bool GetPageWeightsOnDemand() { return experimental_page_weights_on_demand_; }
+
+  // If value == true, the nodes of stateless builtin ops whose inputs are all
+  // constant once the input shapes are set, e.g. shape computations, are
+  // evaluated by AllocateTensors() and skipped by Invoke(). So are the nodes
+  // whose outputs the kernels already computed when preparing them.
+  // WARNING: This is an experimental API and subject to change.
+  void SetFoldConstantNodes(bool value = true) {
+    experimental_fold_constant_nodes_ = value;
+  }
+
+  // Returns if the `experimental_fold_constant_nodes_` feature is enabled.
+  // WARNING: This is an experimental API and subject to change.
+  bool GetFoldConstantNodes() { return experimental_fold_constant_nodes_; }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  int experimental_num_inter_op_threads_;
+  bool experimental_page_weights_on_demand_;
+  bool experimental_fold_constant_nodes_;
 };
 
 }  // namespace tflite
@@ -1127,6 +1127,74 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, FoldConstantNodes) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetFoldConstantNodes();
+  interpreter.ApplyOptions(&options);
+  interpreter.AddTensors(5);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({4});
+  TfLiteQuantizationParams quant;
+  static const float kConstant1[] = {1.0f, 2.0f};
+  static const float kConstant2[] = {10.0f, 20.0f};
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/0, /*type=*/kTfLiteFloat32, /*name=*/"", /*dims=*/{2},
+      /*quantization=*/quant);
+  interpreter.SetTensorParametersReadOnly(
+      /*tensor_index=*/1, /*type=*/kTfLiteFloat32, /*name=*/"", /*dims=*/{2},
+      /*quantization=*/quant, reinterpret_cast<const char*>(kConstant1),
+      sizeof(kConstant1));
+  interpreter.SetTensorParametersReadOnly(
+      /*tensor_index=*/2, /*type=*/kTfLiteFloat32, /*name=*/"", /*dims=*/{2},
+      /*quantization=*/quant, reinterpret_cast<const char*>(kConstant2),
+      sizeof(kConstant2));
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/3, /*type=*/kTfLiteFloat32, /*name=*/"", /*dims=*/{2},
+      /*quantization=*/quant);
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/4, /*type=*/kTfLiteFloat32, /*name=*/"", /*dims=*/{2},
+      /*quantization=*/quant);
+
+  // The first node only has constant inputs, unlike the second one.
+  auto* add_params =
+      reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  add_params->activation = kTfLiteActNone;
+  add_params->pot_scale_int16 = false;
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {1, 2}, {3}, nullptr, 0, add_params,
+                tflite::ops::builtin::Register_ADD()),
+            kTfLiteOk);
+  auto* mul_params =
+      reinterpret_cast<TfLiteMulParams*>(malloc(sizeof(TfLiteMulParams)));
+  mul_params->activation = kTfLiteActNone;
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {0, 3}, {4}, nullptr, 0, mul_params,
+                tflite::ops::builtin::Register_MUL()),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(3)->allocation_type, kTfLitePersistentRo);
+  EXPECT_EQ(interpreter.tensor(4)->allocation_type, kTfLiteArenaRw);
+
+  interpreter.typed_tensor<float>(0)[0] = 2.0f;
+  interpreter.typed_tensor<float>(0)[1] = 3.0f;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_THAT(std::vector<float>(interpreter.typed_tensor<float>(4),
+                                 interpreter.typed_tensor<float>(4) + 2),
+              ElementsAre(22.0f, 66.0f));
+
+  // Reallocating the tensors folds the node again.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(3)->allocation_type, kTfLitePersistentRo);
+  interpreter.typed_tensor<float>(0)[0] = 1.0f;
+  interpreter.typed_tensor<float>(0)[1] = -1.0f;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_THAT(std::vector<float>(interpreter.typed_tensor<float>(4),
+                                 interpreter.typed_tensor<float>(4) + 2),
+              ElementsAre(11.0f, -22.0f));
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -28,12 +28,14 @@ TfLiteRegistration* Register_HASHTABLE_FIND();
 TfLiteRegistration* Register_HASHTABLE_IMPORT();
 TfLiteRegistration* Register_HASHTABLE_SIZE();
 TfLiteRegistration* Register_IRFFT2D();
+TfLiteRegistration* Register_KV_CACHE_APPEND();
 TfLiteRegistration* Register_MAX_POOL_3D();
 TfLiteRegistration* Register_MULTINOMIAL();
 TfLiteRegistration* Register_RANDOM_STANDARD_NORMAL();
 TfLiteRegistration* Register_RANDOM_UNIFORM();
 TfLiteRegistration* Register_RANDOM_UNIFORM_INT();
 TfLiteRegistration* Register_ROLL();
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION();
 TfLiteRegistration* Register_SIGN();
 TfLiteRegistration* Register_TABLE();
 
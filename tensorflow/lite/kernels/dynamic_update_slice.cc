@@ -129,6 +129,22 @@ void DynamicUpdateSlice(const TfLiteTensor* input, const TfLiteTensor* update,
   if (update_shape.FlatSize() == 0) {
     return;
   }
+  if (input_dims == 0) {
+    output_data[0] = update_data[0];
+    return;
+  }
+
+  // The update is contiguous in the output along its innermost dimensions that
+  // span those of the output, and the next one, e.g. along the rows appended
+  // to a KV cache. So it's copied in runs along those dimensions, and only the
+  // outer dimensions are iterated.
+  int outer_dims = input_dims;
+  int run_size = 1;
+  while (outer_dims > 0) {
+    --outer_dims;
+    run_size *= update_shape.Dims(outer_dims);
+    if (update_shape.Dims(outer_dims) != input_shape.Dims(outer_dims)) break;
+  }
 
   std::vector<int> current_dim(input_dims, 0);
   // Overwrites update to output.
@@ -138,8 +154,9 @@ void DynamicUpdateSlice(const TfLiteTensor* input, const TfLiteTensor* update,
     int flat_input_index =
         TensorIndexToFlat(current_dim.data(), input_dims, input_shape,
                           clamped_start_indices.data());
-    output_data[flat_input_index] = update_data[flat_update_index];
-  } while (NextIndex(input_dims,
+    std::copy_n(update_data + flat_update_index, run_size,
+                output_data + flat_input_index);
+  } while (NextIndex(outer_dims,
                      reinterpret_cast<const int*>(update_shape.DimsData()),
                      current_dim.data()));
 }
@@ -168,6 +185,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     case kTfLiteInt8:
       DynamicUpdateSlice<int8_t>(operand, update, indice, output);
       break;
+    case kTfLiteInt16:
+    case kTfLiteFloat16:
+      // Only copied, so half floats are moved around as 16-bit integers.
+      DynamicUpdateSlice<int16_t>(operand, update, indice, output);
+      break;
     case kTfLiteInt32:
       DynamicUpdateSlice<int32_t>(operand, update, indice, output);
       break;
@@ -177,7 +199,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     default:
       TF_LITE_KERNEL_LOG(context,
                          "DynamicUpdateSlice only currently supports "
-                         "1-bit/8-bit/32-bit/64-bit integer or "
+                         "1-bit/8-bit/16-bit/32-bit/64-bit integer or "
                          "float type, got %d.",
                          operand->type);
       return kTfLiteError;
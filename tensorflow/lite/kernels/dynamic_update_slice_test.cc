@@ -197,6 +197,36 @@ TEST(DynamicUpdateSliceOpTest, SimpleTestI64) {
                                                         7, -2, 9}));
 }
 
+TEST(DynamicUpdateSliceOpTest, SimpleTestI16) {
+  DynamicUpdateSliceOpModel m({TensorType_INT16, {3, 3}},
+                              {TensorType_INT16, {2, 1}},
+                              {TensorType_INT32, {2}});
+  m.SetInput<int16_t>({1, 2, 3,  //
+                       4, 5, 6,  //
+                       7, 8, 9});
+  m.SetUpdate<int16_t>({-1, -2});
+  m.SetStartIndices<int32_t>({1, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput<int16_t>(), ElementsAreArray({1, 2, 3,   //
+                                                        4, -1, 6,  //
+                                                        7, -2, 9}));
+}
+
+TEST(DynamicUpdateSliceOpTest, UpdatesInnerRowsF32) {
+  DynamicUpdateSliceOpModel m({TensorType_FLOAT32, {2, 3, 2}},
+                              {TensorType_FLOAT32, {2, 2, 2}},
+                              {TensorType_INT32, {3}});
+  m.SetInput<float>({1, 2, 3, 4, 5, 6,  //
+                     7, 8, 9, 10, 11, 12});
+  m.SetUpdate<float>({-1, -2, -3, -4,  //
+                      -5, -6, -7, -8});
+  m.SetStartIndices<int32_t>({0, 1, 0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput<float>(),
+              ElementsAreArray(ArrayFloatNear({1, 2, -1, -2, -3, -4,  //
+                                               7, 8, -5, -6, -7, -8})));
+}
+
 TEST(DynamicUpdateSliceOpTest, BoundaryTest) {
   DynamicUpdateSliceOpModel m({TensorType_FLOAT32, {3, 3}},
                               {TensorType_FLOAT32, {2, 2}},
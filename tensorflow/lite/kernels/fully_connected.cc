@@ -135,6 +135,15 @@ struct OpData {
   bool ledger_initialized;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
+  // The int8 values of a constant int4 filter, unpacked by the first Eval when
+  // the CPU backend caches prepacked weights. Mutable since Eval only gets a
+  // const OpData. Note that this copy is twice the size of the packed filter,
+  // and stays alive with the op.
+  mutable std::unique_ptr<int8_t[]> unpacked_int4_filter = nullptr;
+  // The sparsity metadata of a 1x8 block sparse float filter, split into 1x4
+  // blocks by the first Eval.
+  std::vector<int> sparse_1x4_segments;
+  std::vector<int> sparse_1x4_indices;
   TfLiteType quantized_bias_type = kTfLiteNoType;
 };
 
@@ -150,6 +159,33 @@ constexpr int kScalingFactorsTensor = 1;
 constexpr int kAccumulatorTensor = 2;
 constexpr int kInputOffsetsTensor = 3;
 
+// Returns the values of an int4 `filter` unpacked to int8. When the CPU backend
+// caches prepacked weights, constant filters are unpacked once and kept in
+// `data`, since the backend can only cache the packed filter if its address
+// doesn't change. The unpacked copy takes twice the memory of the packed
+// filter for the lifetime of the op, which is only worth it when the backend
+// already trades memory for time. Other filters are unpacked at each call to
+// `unpacked_filter_data`.
+const int8_t* UnpackInt4Filter(
+    const TfLiteTensor* filter, const OpData* data,
+    CpuBackendContext* cpu_backend_context,
+    std::unique_ptr<int8_t[]>* unpacked_filter_data) {
+  const bool keep =
+      IsConstantTensor(filter) && cpu_backend_context->use_caching();
+  if (keep && data->unpacked_int4_filter) {
+    return data->unpacked_int4_filter.get();
+  }
+  const size_t bytes_unpacked = filter->bytes * 2;
+  auto unpacked = std::make_unique<int8_t[]>(bytes_unpacked);
+  tflite::tensor_utils::UnpackDenseInt4IntoInt8(
+      GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
+      unpacked.get());
+  std::unique_ptr<int8_t[]>* owner =
+      keep ? &data->unpacked_int4_filter : unpacked_filter_data;
+  *owner = std::move(unpacked);
+  return owner->get();
+}
+
 inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                const TfLiteTensor* input,
                                const TfLiteTensor* filter,
@@ -713,12 +749,9 @@ TfLiteStatus EvalHybridDense(
   const int8_t* filter_data = nullptr;
   std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
   if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
+    filter_data = UnpackInt4Filter(filter, data,
+                                   CpuBackendContext::GetFromContext(context),
+                                   &unpacked_filter_data);
   } else {
     filter_data = GetTensorData<int8_t>(filter);
   }
@@ -1070,12 +1103,10 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
 
   if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
+    filter_data = UnpackInt4Filter(filter, data, cpu_backend_context,
+                                   &unpacked_filter_data);
+    // A filter unpacked for this call only must not be cached by address.
+    op_params.lhs_cacheable = data->unpacked_int4_filter != nullptr;
   } else {
     filter_data = GetTensorData<int8>(filter);
   }
@@ -1510,6 +1541,21 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+                 sparsity.dim_metadata[2].dense_size == 8) {
+        // Block sparse with block size of 1x8, run as pairs of 1x4 blocks.
+        if (data->sparse_1x4_segments.empty()) {
+          optimized_ops::Split1x8BlockSparsity(sparsity,
+                                               &data->sparse_1x4_segments,
+                                               &data->sparse_1x4_indices);
+        }
+        optimized_ops::FullyConnectedSparseWeight1x4(
+            data->sparse_1x4_segments.data(), data->sparse_1x4_indices.data(),
+            op_params, input_shape, GetTensorData<float>(input),
+            filter_shape, GetTensorData<float>(filter), bias_shape,
+            GetTensorData<float>(bias), output_shape,
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -34,6 +34,8 @@ limitations under the License.
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -361,6 +363,45 @@ class QuantizedFullyConnectedOpModel : public BaseFullyConnectedOpModel {
   }
 };
 
+// A fully connected op with a constant int4 filter, run with a CPU backend
+// context that may cache prepacked weights.
+class ConstInt4FullyConnectedOpModel : public SingleOpModel {
+ public:
+  ConstInt4FullyConnectedOpModel(TfLiteRegistration* registration,
+                                 const std::vector<int8_t>& packed_weights,
+                                 int units, int input_size,
+                                 ExternalCpuBackendContext* external_context) {
+    input_ = AddInput({TensorType_INT8, {1, input_size}, 0, 0, 1.0});
+    AddConstInput(TensorData{TensorType_INT4, {units, input_size}, 0, 0, 1.0},
+                  packed_weights);
+    bias_ = AddInput({TensorType_INT32, {units}, 0, 0, 1.0});
+    output_ = AddOutput({TensorType_INT8, {}, 0, 0, 1.0});
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_,
+                                             ActivationFunctionType_NONE)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({{1, input_size}, {units, input_size}, {units}});
+    interpreter_->SetExternalContext(kTfLiteCpuBackendContext,
+                                     external_context);
+  }
+
+  void SetInput(const std::vector<int8_t>& data) {
+    PopulateTensor(input_, data);
+  }
+  void SetBias(const std::vector<int32_t>& data) {
+    PopulateTensor(bias_, data);
+  }
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
 class PerChannelQuantizedFullyConnectedOpModel
     : public BaseFullyConnectedOpModel {
  public:
@@ -744,6 +785,35 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt4) {
   EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(63, 63, 67, 81, 81, 86));
 }
 
+TEST_P(QuantizedFullyConnectedOpTest, ConstInt4FilterWithAndWithoutCaching) {
+  for (bool use_caching : {false, true}) {
+    SCOPED_TRACE(use_caching);
+    // Outlives the interpreter of the model.
+    ExternalCpuBackendContext external_context;
+    auto* cpu_backend_context = new CpuBackendContext();
+    cpu_backend_context->SetUseCaching(use_caching);
+    external_context.set_internal_backend_context(
+        std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
+    // The filter {{1, 2, 3, 4}, {-1, -2, 7, -8}}, packed two values per byte
+    // with the first one in the low nibble.
+    ConstInt4FullyConnectedOpModel m(GetRegistration(), {0x21, 0x43, -17, -121},
+                                     /*units=*/2, /*input_size=*/4,
+                                     &external_context);
+    m.SetBias({1, 2});
+
+    // Unpacked filters are either kept or rebuilt at each Eval, so the op
+    // should give the same results when invoked again.
+    for (int i = 0; i < 2; ++i) {
+      m.SetInput({1, 2, 3, 4});
+      ASSERT_EQ(m.Invoke(), kTfLiteOk);
+      EXPECT_THAT(m.GetOutput(), ElementsAre(31, -14));
+      m.SetInput({-1, 0, 1, 0});
+      ASSERT_EQ(m.Invoke(), kTfLiteOk);
+      EXPECT_THAT(m.GetOutput(), ElementsAre(3, 10));
+    }
+  }
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt8) {
   QuantizedFullyConnectedOpModel m(
       GetRegistration(), /*units=*/3, /*batches*/ 2,
@@ -1858,6 +1928,36 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4Test) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(289, 290, 291, 81, 82, 83));
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple1x8Test) {
+  std::initializer_list<float> weight_data = {
+      1, 2, 3, 4, 5, 6, 7, 8, 0, 0,  0,  0,  0,  0,  0,  0,   // u = 0
+      0, 0, 0, 0, 0, 0, 0, 0, 1, 2,  3,  4,  5,  6,  7,  8,   // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {3, 16};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {8};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/3, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 16}},
+                                       weight, weight_data);
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 1, 1, 1, 1, 1, 1, 1, 1, 1,  1,  1,  1,  1,  1,  1,   // b = 0
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(37, 38, 139, 205, 494, 1499));
+}
+
 TEST_P(SparseFullyConnectedOpTest, Simple1x4TestNoBias) {
   std::initializer_list<float> weight_data = {
       1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 0
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
 
 #include <algorithm>
+#include <vector>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
@@ -113,7 +114,8 @@ inline void FullyConnectedSparseWeight1x16Impl(
 }
 
 inline void FullyConnectedSparseWeight1x4Impl(
-    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const int* w1_segments, const int* w1_indices,
+    const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
     const RuntimeShape& bias_shape, const float* bias_data,
@@ -132,8 +134,6 @@ inline void FullyConnectedSparseWeight1x4Impl(
                                       input_shape, input_dims_count - 1);
   const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
                                        output_shape, output_dims_count - 1);
-  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
-  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
   tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
       weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
@@ -153,13 +153,15 @@ inline void FullyConnectedSparseWeight1x4Impl(
 
 struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   FullyConnectedSparseWeight1x4Task(
-      const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+      const int* w1_segments, const int* w1_indices,
+      const FullyConnectedParams& params,
       const RuntimeShape& input_shape, const float* input_data,
       const RuntimeShape& weights_shape, const float* weights_data,
       const RuntimeShape& bias_shape, const float* bias_data,
       const RuntimeShape& output_shape, float* output_data, int thread_start,
       int thread_end, const CpuBackendContext& cpu_backend_context_x)
-      : sparsity(sparsity),
+      : w1_segments(w1_segments),
+        w1_indices(w1_indices),
         params(params),
         input_shape(input_shape),
         input_data(input_data),
@@ -175,13 +177,14 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
 
   void Run() override {
     FullyConnectedSparseWeight1x4Impl(
-        sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, thread_start,
-        thread_end, cpu_backend_context);
+        w1_segments, w1_indices, params, input_shape, input_data,
+        weights_shape, weights_data, bias_shape, bias_data, output_shape,
+        output_data, thread_start, thread_end, cpu_backend_context);
   }
 
  private:
-  const TfLiteSparsity& sparsity;
+  const int* w1_segments;
+  const int* w1_indices;
   const FullyConnectedParams& params;
   const RuntimeShape& input_shape;
   const float* input_data;
@@ -216,12 +219,35 @@ inline void FullyConnectedSparseWeight1x16(
       *cpu_backend_context);
 }
 
+// Splits the 1x8 blocks of `sparsity` into pairs of 1x4 blocks, whose weights
+// are in the same order, so that the matrix can be multiplied by the 1x4
+// kernels. Sets `segments` and `indices` to the metadata of the 1x4 blocks.
+inline void Split1x8BlockSparsity(const TfLiteSparsity& sparsity,
+                                  std::vector<int>* segments,
+                                  std::vector<int>* indices) {
+  const TfLiteIntArray* w1_segments = sparsity.dim_metadata[1].array_segments;
+  const TfLiteIntArray* w1_indices = sparsity.dim_metadata[1].array_indices;
+  segments->resize(w1_segments->size);
+  for (int i = 0; i < w1_segments->size; ++i) {
+    (*segments)[i] = 2 * w1_segments->data[i];
+  }
+  indices->resize(2 * w1_indices->size);
+  for (int i = 0; i < w1_indices->size; ++i) {
+    (*indices)[2 * i] = 2 * w1_indices->data[i];
+    (*indices)[2 * i + 1] = 2 * w1_indices->data[i] + 1;
+  }
+}
+
+// Takes the segments and indices of the 1x4 blocks of the weights, e.g. from
+// Split1x8BlockSparsity().
+//
 // The multi-threaded kernel slices the workload along the batch dimension. If
 // there's not enough batches of data, the number of threads used is equal to
 // the batch size. We can improve this later with slicing along the row
 // dimension of the weight.
 inline void FullyConnectedSparseWeight1x4(
-    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const int* w1_segments, const int* w1_indices,
+    const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
     const RuntimeShape& bias_shape, const float* bias_data,
@@ -236,9 +262,9 @@ inline void FullyConnectedSparseWeight1x4(
   const int thread_count = std::max(1, std::min(batches, max_threads));
   if (thread_count == 1) {
     return FullyConnectedSparseWeight1x4Impl(
-        sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, 0, batches,
-        *cpu_backend_context);
+        w1_segments, w1_indices, params, input_shape, input_data,
+        weights_shape, weights_data, bias_shape, bias_data, output_shape,
+        output_data, 0, batches, *cpu_backend_context);
   }
   std::vector<FullyConnectedSparseWeight1x4Task> tasks;
   tasks.reserve(thread_count);
@@ -250,16 +276,31 @@ inline void FullyConnectedSparseWeight1x4(
     int thread_end = thread_start + batches / thread_count;
     if (i < batches % thread_count) thread_end++;
 
-    tasks.emplace_back(sparsity, params, input_shape, input_data, weights_shape,
-                       weights_data, bias_shape, bias_data, output_shape,
-                       output_data, thread_start, thread_end,
-                       *cpu_backend_context);
+    tasks.emplace_back(w1_segments, w1_indices, params, input_shape,
+                       input_data, weights_shape, weights_data, bias_shape,
+                       bias_data, output_shape, output_data, thread_start,
+                       thread_end, *cpu_backend_context);
     thread_start = thread_end;
   }
   cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
                                   cpu_backend_context);
 }
 
+// Same as above, with the 1x4 blocks of the weights described by `sparsity`.
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1x4(
+      sparsity.dim_metadata[1].array_segments->data,
+      sparsity.dim_metadata[1].array_indices->data, params, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
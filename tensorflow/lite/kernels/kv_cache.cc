@@ -0,0 +1,319 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/resource/kv_cache.h"
+#include "tensorflow/lite/kernels/custom_ops_register.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace kv_cache {
+
+// KVCacheAppend writes the keys and values of the new positions of a sequence
+// in place into the KV cache resource "cache_id", and returns the handle of
+// the cache. Its ScaledDotProductAttention consumers read the cache directly,
+// so that a decode step neither copies nor reallocates the cache.
+//
+// Inputs:
+//   0: keys of the new positions, float32 [num_positions, num_heads, head_dim]
+//   1: values of the new positions, same shape as the keys
+//   2: int32 position of the first new position in the sequence
+// Outputs:
+//   0: handle of the KV cache
+namespace append {
+
+constexpr int kKeysTensor = 0;
+constexpr int kValuesTensor = 1;
+constexpr int kPositionTensor = 2;
+constexpr int kResourceHandleTensor = 0;
+
+struct OpData {
+  int cache_id;
+  int max_seq_len;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* op_data = new OpData;
+  const flexbuffers::Map& m =
+      flexbuffers::GetRoot(reinterpret_cast<const uint8_t*>(buffer), length)
+          .AsMap();
+  op_data->cache_id = m["cache_id"].AsInt32();
+  op_data->max_seq_len = m["max_seq_len"].AsInt32();
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  const auto* op_data = reinterpret_cast<const OpData*>(node->user_data);
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  TF_LITE_ENSURE(context, op_data->max_seq_len > 0);
+
+  const TfLiteTensor* keys;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeysTensor, &keys));
+  const TfLiteTensor* values;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuesTensor, &values));
+  const TfLiteTensor* position;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_TYPES_EQ(context, keys->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, values->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(keys), 3);
+  TF_LITE_ENSURE(context, HaveSameShapes(keys, values));
+  TF_LITE_ENSURE(context, SizeOfDimension(keys, 0) <= op_data->max_seq_len);
+  TF_LITE_ENSURE_TYPES_EQ(context, position->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, NumElements(position), 1);
+
+  TfLiteTensor* resource_handle;
+  TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node,
+                                           kResourceHandleTensor,
+                                           &resource_handle));
+  TF_LITE_ENSURE_EQ(context, resource_handle->type, kTfLiteResource);
+  // Realloc space for an integer handle value.
+  const size_t bytes_required = sizeof(int32_t);
+  TfLiteTensorRealloc(bytes_required, resource_handle);
+  resource_handle->bytes = bytes_required;
+  TfLiteIntArray* output_size = TfLiteIntArrayCreate(1);
+  output_size->data[0] = 1;
+  if (resource_handle->dims) TfLiteIntArrayFree(resource_handle->dims);
+  resource_handle->dims = output_size;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const auto* op_data = reinterpret_cast<const OpData*>(node->user_data);
+  const TfLiteTensor* keys;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeysTensor, &keys));
+  const TfLiteTensor* values;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuesTensor, &values));
+  const TfLiteTensor* position;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TfLiteTensor* resource_handle;
+  TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node,
+                                           kResourceHandleTensor,
+                                           &resource_handle));
+
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  resource::CreateKVCacheIfNotAvailable(&resources, op_data->cache_id);
+  resource::KVCache* cache =
+      resource::GetKVCache(&resources, op_data->cache_id);
+  TF_LITE_ENSURE(context, cache != nullptr);
+  TF_LITE_ENSURE_MSG(
+      context,
+      cache->Initialize(op_data->max_seq_len, SizeOfDimension(keys, 1),
+                        SizeOfDimension(keys, 2)) == kTfLiteOk,
+      "The KV cache was created with different dimensions.");
+
+  const int first_position = *GetTensorData<int32_t>(position);
+  const int num_positions = SizeOfDimension(keys, 0);
+  if (cache->Write(first_position, num_positions, GetTensorData<float>(keys),
+                   GetTensorData<float>(values)) != kTfLiteOk) {
+    TF_LITE_KERNEL_LOG(context,
+                       "Cannot write %d positions from position %d to a KV "
+                       "cache of %d positions, of which %d are cached.",
+                       num_positions, first_position, cache->max_seq_len(),
+                       cache->size());
+    return kTfLiteError;
+  }
+
+  *GetTensorData<int32_t>(resource_handle) = op_data->cache_id;
+  return kTfLiteOk;
+}
+
+}  // namespace append
+
+// ScaledDotProductAttention computes the causal attention of the queries of
+// the last positions of a KV cache, reading the keys and values from the
+// cache. The query heads are split into groups that share the keys and values
+// of one cache head, which covers multi-head, multi-query and grouped-query
+// attention.
+//
+// Inputs:
+//   0: queries, float32 [num_queries, num_query_heads, head_dim], of the last
+//      num_queries cached positions
+//   1: handle of the KV cache
+// Outputs:
+//   0: float32 [num_queries, num_query_heads, head_dim]
+// Options:
+//   scale: the factor of the dot products of the queries and the keys, 1 /
+//     sqrt(head_dim) if not set.
+namespace attention {
+
+constexpr int kQueryTensor = 0;
+constexpr int kResourceHandleTensor = 1;
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  float scale = 0.0f;
+  // The attention weights of one query.
+  std::vector<float> weights;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* op_data = new OpData;
+  if (buffer != nullptr && length > 0) {
+    const flexbuffers::Map& m =
+        flexbuffers::GetRoot(reinterpret_cast<const uint8_t*>(buffer), length)
+            .AsMap();
+    if (!m["scale"].IsNull()) op_data->scale = m["scale"].AsFloat();
+  }
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* resource_handle;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kResourceHandleTensor,
+                                          &resource_handle));
+  TF_LITE_ENSURE_TYPES_EQ(context, query->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(query), 3);
+  TF_LITE_ENSURE(context, (resource_handle->type == kTfLiteResource ||
+                           resource_handle->type == kTfLiteInt32));
+  TF_LITE_ENSURE_EQ(context, NumElements(resource_handle), 1);
+
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(query->dims));
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* resource_handle;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kResourceHandleTensor,
+                                          &resource_handle));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  const resource::KVCache* cache =
+      resource::GetKVCache(&resources, resource_handle->data.i32[0]);
+  TF_LITE_ENSURE(context, cache != nullptr);
+
+  const int num_queries = SizeOfDimension(query, 0);
+  const int num_query_heads = SizeOfDimension(query, 1);
+  const int head_dim = SizeOfDimension(query, 2);
+  const int num_kv_heads = cache->num_heads();
+  TF_LITE_ENSURE_EQ(context, head_dim, cache->head_dim());
+  TF_LITE_ENSURE(context, num_kv_heads > 0);
+  TF_LITE_ENSURE_EQ(context, num_query_heads % num_kv_heads, 0);
+  TF_LITE_ENSURE(context, num_queries <= cache->size());
+
+  const float scale = op_data->scale != 0.0f
+                          ? op_data->scale
+                          : 1.0f / sqrtf(static_cast<float>(head_dim));
+  const int group_size = num_query_heads / num_kv_heads;
+  // The position of the first query.
+  const int first_position = cache->size() - num_queries;
+  const float* queries = GetTensorData<float>(query);
+  const float* keys = cache->keys();
+  const float* values = cache->values();
+  float* outputs = GetTensorData<float>(output);
+  std::vector<float>& weights = op_data->weights;
+  weights.resize(cache->size());
+
+  for (int q = 0; q < num_queries; ++q) {
+    // The query attends to its position and the previous ones.
+    const int num_positions = first_position + q + 1;
+    for (int h = 0; h < num_query_heads; ++h) {
+      const int kv_head = h / group_size;
+      const float* query_data =
+          queries + (static_cast<size_t>(q) * num_query_heads + h) * head_dim;
+      float max_weight = -std::numeric_limits<float>::infinity();
+      for (int p = 0; p < num_positions; ++p) {
+        const float* key_data =
+            keys + (static_cast<size_t>(p) * num_kv_heads + kv_head) * head_dim;
+        float dot = 0.0f;
+        for (int d = 0; d < head_dim; ++d) dot += query_data[d] * key_data[d];
+        weights[p] = dot * scale;
+        max_weight = std::max(max_weight, weights[p]);
+      }
+      float sum = 0.0f;
+      for (int p = 0; p < num_positions; ++p) {
+        weights[p] = expf(weights[p] - max_weight);
+        sum += weights[p];
+      }
+
+      float* output_data =
+          outputs + (static_cast<size_t>(q) * num_query_heads + h) * head_dim;
+      std::fill_n(output_data, head_dim, 0.0f);
+      for (int p = 0; p < num_positions; ++p) {
+        const float weight = weights[p] / sum;
+        const float* value_data =
+            values +
+            (static_cast<size_t>(p) * num_kv_heads + kv_head) * head_dim;
+        for (int d = 0; d < head_dim; ++d) {
+          output_data[d] += weight * value_data[d];
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace attention
+}  // namespace kv_cache
+
+TfLiteRegistration* Register_KV_CACHE_APPEND() {
+  static TfLiteRegistration r = {kv_cache::append::Init,
+                                 kv_cache::append::Free,
+                                 kv_cache::append::Prepare,
+                                 kv_cache::append::Eval};
+  return &r;
+}
+
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION() {
+  static TfLiteRegistration r = {
+      kv_cache::attention::Init, kv_cache::attention::Free,
+      kv_cache::attention::Prepare, kv_cache::attention::Eval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,199 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/kv_cache.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/kernels/custom_ops_register.h"
+#include "tensorflow/lite/kernels/test_util.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+class KVCacheAppendOpModel : public SingleOpModel {
+ public:
+  KVCacheAppendOpModel(int cache_id, int max_seq_len,
+                       const std::vector<int>& shape) {
+    keys_ = AddInput({TensorType_FLOAT32, shape});
+    values_ = AddInput({TensorType_FLOAT32, shape});
+    position_ = AddInput({TensorType_INT32, {1}});
+    output_ = AddOutput(TensorType_RESOURCE);
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Int("cache_id", cache_id);
+      fbb.Int("max_seq_len", max_seq_len);
+    });
+    fbb.Finish();
+    SetCustomOp("KVCacheAppend", fbb.GetBuffer(),
+                ops::custom::Register_KV_CACHE_APPEND);
+    BuildInterpreter({GetShape(keys_), GetShape(values_), GetShape(position_)});
+  }
+
+  void SetInputs(const std::vector<float>& keys,
+                 const std::vector<float>& values, int position) {
+    PopulateTensor(keys_, keys);
+    PopulateTensor(values_, values);
+    PopulateTensor(position_, {position});
+  }
+
+  int GetOutput() { return interpreter_->tensor(output_)->data.i32[0]; }
+
+  resource::ResourceMap& GetResources() {
+    return interpreter_->primary_subgraph().resources();
+  }
+
+ private:
+  int keys_;
+  int values_;
+  int position_;
+  int output_;
+};
+
+TEST(KVCacheAppendOpTest, WritesInPlace) {
+  constexpr int kCacheId = 3;
+  KVCacheAppendOpModel m(kCacheId, /*max_seq_len=*/4, /*shape=*/{2, 1, 2});
+  m.SetInputs({1, 2, 3, 4}, {-1, -2, -3, -4}, /*position=*/0);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(m.GetOutput(), kCacheId);
+  resource::KVCache* cache = resource::GetKVCache(&m.GetResources(), kCacheId);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->size(), 2);
+  EXPECT_EQ(cache->num_heads(), 1);
+  EXPECT_EQ(cache->head_dim(), 2);
+  const float* keys = cache->keys();
+  const float* values = cache->values();
+
+  m.SetInputs({5, 6, 7, 8}, {-5, -6, -7, -8}, /*position=*/2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(cache->size(), 4);
+  EXPECT_EQ(cache->keys(), keys);
+  EXPECT_EQ(cache->values(), values);
+  EXPECT_THAT(std::vector<float>(keys, keys + 8),
+              ElementsAre(1, 2, 3, 4, 5, 6, 7, 8));
+  EXPECT_THAT(std::vector<float>(values, values + 8),
+              ElementsAre(-1, -2, -3, -4, -5, -6, -7, -8));
+
+  // Writing from position 0 starts a new sequence, which drops the positions
+  // of the previous one.
+  m.SetInputs({9, 10, 11, 12}, {-9, -10, -11, -12}, /*position=*/0);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(cache->size(), 2);
+  EXPECT_THAT(std::vector<float>(keys, keys + 4),
+              ElementsAre(9, 10, 11, 12));
+}
+
+TEST(KVCacheAppendOpTest, FailsWhenFull) {
+  KVCacheAppendOpModel m(/*cache_id=*/1, /*max_seq_len=*/3,
+                         /*shape=*/{2, 1, 1});
+  m.SetInputs({1, 2}, {1, 2}, /*position=*/0);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  m.SetInputs({3, 4}, {3, 4}, /*position=*/2);
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+}
+
+TEST(KVCacheAppendOpTest, FailsOnGap) {
+  KVCacheAppendOpModel m(/*cache_id=*/1, /*max_seq_len=*/8,
+                         /*shape=*/{1, 1, 1});
+  m.SetInputs({1}, {1}, /*position=*/1);
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+}
+
+class ScaledDotProductAttentionOpModel : public SingleOpModel {
+ public:
+  ScaledDotProductAttentionOpModel(const std::vector<int>& query_shape,
+                                   float scale) {
+    query_ = AddInput({TensorType_FLOAT32, query_shape});
+    resource_id_ = AddInput({TensorType_INT32, {1}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", scale); });
+    fbb.Finish();
+    SetCustomOp("ScaledDotProductAttention", fbb.GetBuffer(),
+                ops::custom::Register_SCALED_DOT_PRODUCT_ATTENTION);
+    BuildInterpreter({GetShape(query_), GetShape(resource_id_)});
+  }
+
+  void SetQuery(const std::vector<float>& query) {
+    PopulateTensor(query_, query);
+  }
+
+  void SetResourceId(int resource_id) {
+    PopulateTensor(resource_id_, {resource_id});
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+  resource::ResourceMap& GetResources() {
+    return interpreter_->primary_subgraph().resources();
+  }
+
+ private:
+  int query_;
+  int resource_id_;
+  int output_;
+};
+
+TEST(ScaledDotProductAttentionOpTest, GroupedQueryAttention) {
+  constexpr int kCacheId = 5;
+  // Two queries with two heads each, sharing the single head of a cache of
+  // three positions. The queries are those of the last two positions.
+  ScaledDotProductAttentionOpModel m(/*query_shape=*/{2, 2, 2},
+                                     /*scale=*/1.0f);
+  resource::CreateKVCacheIfNotAvailable(&m.GetResources(), kCacheId);
+  resource::KVCache* cache = resource::GetKVCache(&m.GetResources(), kCacheId);
+  ASSERT_EQ(cache->Initialize(/*max_seq_len=*/4, /*num_heads=*/1,
+                              /*head_dim=*/2),
+            kTfLiteOk);
+  const std::vector<float> keys = {1, 0, 0, 1, 1, 1};
+  const std::vector<float> values = {1, 2, 3, 4, 5, 6};
+  ASSERT_EQ(cache->Write(/*position=*/0, /*num_positions=*/3, keys.data(),
+                         values.data()),
+            kTfLiteOk);
+
+  m.SetResourceId(kCacheId);
+  m.SetQuery({1, 0, 0, 2, 0, 0, 1, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 2, 2));
+  // The first query attends to the first two positions, the second one to all
+  // three.
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({1.537883, 2.537883, 2.761594,
+                                               3.761594, 3.0, 4.0, 3.728351,
+                                               4.728351})));
+}
+
+TEST(ScaledDotProductAttentionOpTest, FailsWithoutCache) {
+  ScaledDotProductAttentionOpModel m(/*query_shape=*/{1, 1, 2},
+                                     /*scale=*/1.0f);
+  m.SetResourceId(7);
+  m.SetQuery({1, 1});
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
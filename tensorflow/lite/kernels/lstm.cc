@@ -59,6 +59,9 @@ struct OpData {
   // Only used for sparse hybrid lstm kernels.
   int ledger_index;
   bool ledger_initialized;
+
+  // Only used by float full kernels with a single batch.
+  lstm_eval::PackedLstmFloatWeights packed_float_weights;
 };
 
 namespace full {
@@ -1431,6 +1434,27 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                                      scratch_buffer_size));
   }
 
+  // Streaming float LSTMs run a step with a single batch at a time, for
+  // which all the gates are computed by one matrix-vector product.
+  if (input_to_output_weights->type == kTfLiteFloat32 && n_batch == 1) {
+    lstm_eval::PackLstmFloatWeights(
+        GetOptionalInputTensor(context, node, kInputToInputWeightsTensor),
+        GetInput(context, node, kInputToForgetWeightsTensor),
+        GetInput(context, node, kInputToCellWeightsTensor),
+        input_to_output_weights,
+        GetOptionalInputTensor(context, node, kRecurrentToInputWeightsTensor),
+        GetInput(context, node, kRecurrentToForgetWeightsTensor),
+        GetInput(context, node, kRecurrentToCellWeightsTensor),
+        recurrent_to_output_weights,
+        GetOptionalInputTensor(context, node, kInputGateBiasTensor),
+        GetInput(context, node, kForgetGateBiasTensor),
+        GetInput(context, node, kCellGateBiasTensor),
+        GetInput(context, node, kOutputGateBiasTensor), use_layer_norm,
+        &op_data->packed_float_weights);
+  } else {
+    op_data->packed_float_weights = lstm_eval::PackedLstmFloatWeights();
+  }
+
   if (is_hybrid_op) {
     if (!is_sparse_op) {
       op_data->compute_row_sums = true;
@@ -1934,7 +1958,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          &op_data->packed_float_weights);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -995,6 +995,67 @@ inline void LstmStepFloat(
 // LINT.ThenChange(../tools/optimize/calibration/builtin_logging_ops/lstm.cc,\
 //                 ../experimental/kernels/fp16/lstm_eval.cc)
 
+// Same as LstmStepFloat for a single batch without auxiliary input, layer
+// norm or diagonal recurrent weights, with the gate weights packed by
+// PackLstmFloatWeights. All the gates are computed by one matrix-vector
+// product over the concatenated input and output state, into the gate
+// scratch buffers that follow each other in |gate_scratch|.
+inline void LstmStepFloatPacked(
+    const float* input_ptr, PackedLstmFloatWeights* packed_weights,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr,
+    const float* projection_weights_ptr, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, bool use_cifg, int n_cell, int n_input,
+    int n_output, float* output_state_ptr, float* cell_state_ptr,
+    float* gate_scratch, float* accumulation_scratch_buffer,
+    float* output_ptr, CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("LstmStepFloatPacked");
+  float* input_and_output_state = packed_weights->input_scratch.data();
+  std::copy_n(input_ptr, n_input, input_and_output_state);
+  std::copy_n(output_state_ptr, n_output, input_and_output_state + n_input);
+  const int num_gates = use_cifg ? 3 : 4;
+  MatrixBatchVectorMultiplyAccumulate(
+      packed_weights->weights.data(), input_and_output_state,
+      packed_weights->bias.data(), gate_scratch, num_gates * n_cell,
+      n_input + n_output, /*n_batch=*/1, context);
+
+  float* input_gate = use_cifg ? nullptr : gate_scratch;
+  float* cell_gate = use_cifg ? gate_scratch : gate_scratch + n_cell;
+  float* forget_gate = cell_gate + n_cell;
+  float* output_gate = forget_gate + n_cell;
+  if (!use_cifg) {
+    if (cell_to_input_weights_ptr) {
+      tensor_utils::VectorVectorCwiseProductAccumulate(
+          cell_to_input_weights_ptr, cell_state_ptr, n_cell, input_gate);
+    }
+    tensor_utils::ApplyActivationToVector(input_gate, n_cell,
+                                          kTfLiteActSigmoid, input_gate);
+  }
+  if (cell_to_forget_weights_ptr) {
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_to_forget_weights_ptr, cell_state_ptr, n_cell, forget_gate);
+  }
+  tensor_utils::ApplyActivationToVector(forget_gate, n_cell, kTfLiteActSigmoid,
+                                        forget_gate);
+  tensor_utils::ApplyActivationToVector(cell_gate, n_cell, params->activation,
+                                        cell_gate);
+  UpdateLstmCellFloat(/*n_batch=*/1, n_cell, cell_state_ptr, input_gate,
+                      forget_gate, cell_gate, use_cifg, params->cell_clip);
+  if (cell_to_output_weights_ptr) {
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_to_output_weights_ptr, cell_state_ptr, n_cell, output_gate);
+  }
+  tensor_utils::ApplyActivationToVector(output_gate, n_cell, kTfLiteActSigmoid,
+                                        output_gate);
+  CalculateLstmOutputFloat(/*n_batch=*/1, n_cell, n_output, cell_state_ptr,
+                           output_gate, params->activation,
+                           projection_weights_ptr, projection_bias_ptr,
+                           params->proj_clip, output_state_ptr, cell_gate,
+                           accumulation_scratch_buffer, context);
+  std::copy_n(output_state_ptr, n_output, output_ptr);
+}
+
 // Same as above but with quantized weight matrices. In detail:
 // Input of size 'n_batch * n_input':
 //   input_ptr
@@ -1789,6 +1850,70 @@ inline void LstmStepInteger8x8_8(
 
 }  // namespace
 
+void PackLstmFloatWeights(const TfLiteTensor* input_to_input_weights,
+                          const TfLiteTensor* input_to_forget_weights,
+                          const TfLiteTensor* input_to_cell_weights,
+                          const TfLiteTensor* input_to_output_weights,
+                          const TfLiteTensor* recurrent_to_input_weights,
+                          const TfLiteTensor* recurrent_to_forget_weights,
+                          const TfLiteTensor* recurrent_to_cell_weights,
+                          const TfLiteTensor* recurrent_to_output_weights,
+                          const TfLiteTensor* input_gate_bias,
+                          const TfLiteTensor* forget_gate_bias,
+                          const TfLiteTensor* cell_gate_bias,
+                          const TfLiteTensor* output_gate_bias,
+                          bool use_layer_norm, PackedLstmFloatWeights* packed) {
+  packed->weights.clear();
+  packed->bias.clear();
+  packed->input_scratch.clear();
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  std::vector<const TfLiteTensor*> input_weights = {
+      input_to_cell_weights, input_to_forget_weights, input_to_output_weights};
+  std::vector<const TfLiteTensor*> recurrent_weights = {
+      recurrent_to_cell_weights, recurrent_to_forget_weights,
+      recurrent_to_output_weights};
+  std::vector<const TfLiteTensor*> biases = {cell_gate_bias, forget_gate_bias,
+                                             output_gate_bias};
+  if (!use_cifg) {
+    input_weights.insert(input_weights.begin(), input_to_input_weights);
+    recurrent_weights.insert(recurrent_weights.begin(),
+                             recurrent_to_input_weights);
+    biases.insert(biases.begin(), input_gate_bias);
+  }
+  if (use_layer_norm) return;
+  for (size_t gate = 0; gate < input_weights.size(); ++gate) {
+    for (const TfLiteTensor* tensor :
+         {input_weights[gate], recurrent_weights[gate], biases[gate]}) {
+      if (tensor == nullptr || tensor->type != kTfLiteFloat32 ||
+          tensor->allocation_type != kTfLiteMmapRo) {
+        return;
+      }
+    }
+    if (recurrent_weights[gate]->dims->size != 2) return;
+  }
+
+  const int n_cell = input_to_output_weights->dims->data[0];
+  const int n_input = input_to_output_weights->dims->data[1];
+  const int n_output = recurrent_to_output_weights->dims->data[1];
+  const int n_columns = n_input + n_output;
+  packed->weights.resize(input_weights.size() * n_cell * n_columns);
+  packed->bias.resize(input_weights.size() * n_cell);
+  packed->input_scratch.resize(n_columns);
+  for (size_t gate = 0; gate < input_weights.size(); ++gate) {
+    const float* input_weights_ptr = GetTensorData<float>(input_weights[gate]);
+    const float* recurrent_weights_ptr =
+        GetTensorData<float>(recurrent_weights[gate]);
+    for (int c = 0; c < n_cell; ++c) {
+      float* row = packed->weights.data() + (gate * n_cell + c) * n_columns;
+      std::copy_n(input_weights_ptr + c * n_input, n_input, row);
+      std::copy_n(recurrent_weights_ptr + c * n_output, n_output,
+                  row + n_input);
+    }
+    std::copy_n(GetTensorData<float>(biases[gate]), n_cell,
+                packed->bias.data() + gate * n_cell);
+  }
+}
+
 // LINT.IfChange
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -1819,7 +1944,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, PackedLstmFloatWeights* packed_weights) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1866,7 +1991,30 @@ TfLiteStatus EvalFloat(
 
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
-  if (time_major) {
+  // With a single batch, the gate scratch buffers follow each other in the
+  // order of the packed gate weights.
+  const bool use_packed_weights = packed_weights != nullptr &&
+                                  !packed_weights->weights.empty() &&
+                                  n_batch == 1 && aux_input == nullptr;
+  if (use_packed_weights) {
+    const int input_step = n_input;
+    const int output_step = output_batch_leading_dim;
+    for (int t = 0; t < max_time; t++) {
+      const int t_rel = forward_sequence ? t : max_time - t - 1;
+      LstmStepFloatPacked(
+          GetTensorData<float>(input) + t_rel * input_step, packed_weights,
+          GetTensorData<float>(cell_to_input_weights),
+          GetTensorData<float>(cell_to_forget_weights),
+          GetTensorData<float>(cell_to_output_weights),
+          GetTensorData<float>(projection_weights),
+          GetTensorData<float>(projection_bias), params, use_cifg, n_cell,
+          n_input, n_output, GetTensorData<float>(output_state),
+          GetTensorData<float>(cell_state), scratch_buffer_ptr,
+          accumulation_scratch_buffer,
+          GetTensorData<float>(output) + t_rel * output_step + output_offset,
+          context);
+    }
+  } else if (time_major) {
     // Loop through the sequence.
     const int input_step = n_batch * n_input;
     const int output_step = n_batch * output_batch_leading_dim;
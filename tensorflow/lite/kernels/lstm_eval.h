@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -95,6 +96,37 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Gate weights of a float LSTM packed so that a step with a single batch
+// computes all its gates with one matrix-vector product. The rows hold the
+// input weights followed by the recurrent weights of a gate, for the input
+// (unless CIFG), cell, forget and output gates in turn, in the order of the
+// gate scratch buffers.
+struct PackedLstmFloatWeights {
+  std::vector<float> weights;
+  std::vector<float> bias;
+  // Holds the input followed by the output state of a step.
+  std::vector<float> input_scratch;
+};
+
+// Packs the gate weights if they and the biases are constant and the LSTM
+// has no layer norm and no diagonal recurrent weights, and clears |packed|
+// otherwise.
+void PackLstmFloatWeights(const TfLiteTensor* input_to_input_weights,
+                          const TfLiteTensor* input_to_forget_weights,
+                          const TfLiteTensor* input_to_cell_weights,
+                          const TfLiteTensor* input_to_output_weights,
+                          const TfLiteTensor* recurrent_to_input_weights,
+                          const TfLiteTensor* recurrent_to_forget_weights,
+                          const TfLiteTensor* recurrent_to_cell_weights,
+                          const TfLiteTensor* recurrent_to_output_weights,
+                          const TfLiteTensor* input_gate_bias,
+                          const TfLiteTensor* forget_gate_bias,
+                          const TfLiteTensor* cell_gate_bias,
+                          const TfLiteTensor* output_gate_bias,
+                          bool use_layer_norm, PackedLstmFloatWeights* packed);
+
+// If |packed_weights| is not null and holds packed weights, the steps with a
+// single batch and no auxiliary input use them.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,7 +156,8 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    CpuBackendContext* context,
+    PackedLstmFloatWeights* packed_weights = nullptr);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -18,7 +18,9 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -969,5 +971,134 @@ TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTM) {
   TestOneHybridAsymmLSTM();
 }
 
+// A float tensor of the given shape holding |data|.
+class FloatTensor {
+ public:
+  FloatTensor(std::vector<float> data, const std::vector<int>& shape,
+              bool is_constant)
+      : data_(std::move(data)) {
+    tensor_.type = kTfLiteFloat32;
+    tensor_.dims = TfLiteIntArrayCreate(shape.size());
+    std::copy(shape.begin(), shape.end(), tensor_.dims->data);
+    tensor_.allocation_type = is_constant ? kTfLiteMmapRo : kTfLiteArenaRw;
+    tensor_.data.f = data_.data();
+    tensor_.bytes = data_.size() * sizeof(float);
+  }
+  ~FloatTensor() { TfLiteIntArrayFree(tensor_.dims); }
+
+  TfLiteTensor* get() { return &tensor_; }
+  const std::vector<float>& data() const { return data_; }
+
+ private:
+  std::vector<float> data_;
+  TfLiteTensor tensor_ = {};
+};
+
+std::vector<float> Values(int size, float seed) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = 0.5f * std::sin(seed + 1.7f * i);
+  }
+  return values;
+}
+
+// Runs a float LSTM with batch 1 over a few steps, with or without packed
+// gate weights, and returns its output.
+std::vector<float> RunFloatLstm(bool use_cifg, bool use_peephole,
+                                bool use_packed_weights) {
+  const int n_time = 3, n_input = 3, n_cell = 4, n_output = 4;
+  auto weight = [](const std::vector<int>& shape, float seed) {
+    int size = 1;
+    for (int dim : shape) size *= dim;
+    return std::make_unique<FloatTensor>(Values(size, seed), shape,
+                                         /*is_constant=*/true);
+  };
+  std::unique_ptr<FloatTensor> i2i, r2i, c2i, c2f, c2o, input_gate_bias;
+  if (!use_cifg) {
+    i2i = weight({n_cell, n_input}, 1);
+    r2i = weight({n_cell, n_output}, 2);
+    input_gate_bias = weight({n_cell}, 3);
+  }
+  if (use_peephole) {
+    if (!use_cifg) c2i = weight({n_cell}, 4);
+    c2f = weight({n_cell}, 5);
+    c2o = weight({n_cell}, 6);
+  }
+  auto i2f = weight({n_cell, n_input}, 7);
+  auto i2c = weight({n_cell, n_input}, 8);
+  auto i2o = weight({n_cell, n_input}, 9);
+  auto r2f = weight({n_cell, n_output}, 10);
+  auto r2c = weight({n_cell, n_output}, 11);
+  auto r2o = weight({n_cell, n_output}, 12);
+  auto forget_gate_bias = weight({n_cell}, 13);
+  auto cell_gate_bias = weight({n_cell}, 14);
+  auto output_gate_bias = weight({n_cell}, 15);
+  FloatTensor input(Values(n_time * n_input, 16), {n_time, 1, n_input},
+                    /*is_constant=*/false);
+  FloatTensor scratch(std::vector<float>(5 * n_cell), {1, 5 * n_cell},
+                      /*is_constant=*/false);
+  FloatTensor output_state(std::vector<float>(n_output), {1, n_output},
+                           /*is_constant=*/false);
+  FloatTensor cell_state(std::vector<float>(n_cell), {1, n_cell},
+                         /*is_constant=*/false);
+  FloatTensor output(std::vector<float>(n_time * n_output),
+                     {n_time, 1, n_output}, /*is_constant=*/false);
+  auto get = [](const std::unique_ptr<FloatTensor>& tensor) {
+    return tensor ? tensor->get() : nullptr;
+  };
+
+  ops::builtin::lstm_eval::PackedLstmFloatWeights packed_weights;
+  if (use_packed_weights) {
+    ops::builtin::lstm_eval::PackLstmFloatWeights(
+        get(i2i), i2f->get(), i2c->get(), i2o->get(), get(r2i), r2f->get(),
+        r2c->get(), r2o->get(), get(input_gate_bias), forget_gate_bias->get(),
+        cell_gate_bias->get(), output_gate_bias->get(),
+        /*use_layer_norm=*/false, &packed_weights);
+    EXPECT_FALSE(packed_weights.weights.empty());
+  }
+  const TfLiteLSTMParams params = {kTfLiteActTanh, /*cell_clip=*/0.0f,
+                                   /*proj_clip=*/0.0f, kTfLiteLSTMFullKernel,
+                                   false};
+  CpuBackendContext context;
+  EXPECT_EQ(
+      kTfLiteOk,
+      ops::builtin::lstm_eval::EvalFloat(
+          input.get(), get(i2i), i2f->get(), i2c->get(), i2o->get(), get(r2i),
+          r2f->get(), r2c->get(), r2o->get(), get(c2i), get(c2f), get(c2o),
+          /*input_layer_norm_coefficients=*/nullptr,
+          /*forget_layer_norm_coefficients=*/nullptr,
+          /*cell_layer_norm_coefficients=*/nullptr,
+          /*output_layer_norm_coefficients=*/nullptr, /*aux_input=*/nullptr,
+          /*aux_input_to_input_weights=*/nullptr,
+          /*aux_input_to_forget_weights=*/nullptr,
+          /*aux_input_to_cell_weights=*/nullptr,
+          /*aux_input_to_output_weights=*/nullptr, get(input_gate_bias),
+          forget_gate_bias->get(), cell_gate_bias->get(),
+          output_gate_bias->get(), /*projection_weights=*/nullptr,
+          /*projection_bias=*/nullptr, &params, /*forward_sequence=*/true,
+          /*time_major=*/true, /*output_offset=*/0, scratch.get(),
+          output_state.get(), cell_state.get(), output.get(),
+          /*recurrent_to_input_is_diag=*/false,
+          /*recurrent_to_forget_is_diag=*/false,
+          /*recurrent_to_cell_is_diag=*/false,
+          /*recurrent_to_output_is_diag=*/false, &context,
+          use_packed_weights ? &packed_weights : nullptr));
+  return output.data();
+}
+
+TEST(TestPackedFloatLSTM, MatchesUnpackedWeights) {
+  for (bool use_cifg : {false, true}) {
+    for (bool use_peephole : {false, true}) {
+      const std::vector<float> expected =
+          RunFloatLstm(use_cifg, use_peephole, /*use_packed_weights=*/false);
+      const std::vector<float> result =
+          RunFloatLstm(use_cifg, use_peephole, /*use_packed_weights=*/true);
+      EXPECT_TRUE(
+          ArrayFloatNear(result.data(), expected.data(), expected.size(), 1e-5))
+          << "use_cifg: " << use_cifg << ", use_peephole: " << use_peephole;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tflite
@@ -49,6 +49,9 @@ struct OpData {
   bool recurrent_to_output_is_diag = false;
 
   lstm_eval::IntegerLstmParameter integer_lstm_param;
+
+  // Only used by float kernels with a single batch.
+  lstm_eval::PackedLstmFloatWeights packed_float_weights;
 };
 
 TfLiteStatus PopulateQuantizedLstmParams8x8_16(
@@ -1019,6 +1022,29 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
+  // Streaming float LSTMs run a step with a single batch at a time, for
+  // which all the gates are computed by one matrix-vector product.
+  if (input_to_output_weights->type == kTfLiteFloat32 && n_batch == 1) {
+    lstm_eval::PackLstmFloatWeights(
+        input_to_input_weights,
+        GetInput(context, node, lstm::full::kInputToForgetWeightsTensor),
+        GetInput(context, node, lstm::full::kInputToCellWeightsTensor),
+        input_to_output_weights,
+        GetOptionalInputTensor(context, node,
+                               lstm::full::kRecurrentToInputWeightsTensor),
+        GetInput(context, node, lstm::full::kRecurrentToForgetWeightsTensor),
+        GetInput(context, node, lstm::full::kRecurrentToCellWeightsTensor),
+        recurrent_to_output_weights,
+        GetOptionalInputTensor(context, node,
+                               lstm::full::kInputGateBiasTensor),
+        GetInput(context, node, lstm::full::kForgetGateBiasTensor),
+        GetInput(context, node, lstm::full::kCellGateBiasTensor),
+        GetInput(context, node, lstm::full::kOutputGateBiasTensor),
+        op_data->use_layer_norm, &op_data->packed_float_weights);
+  } else {
+    op_data->packed_float_weights = lstm_eval::PackedLstmFloatWeights();
+  }
+
   if (IsHybridOp(input, input_to_output_weights)) {
     op_data->compute_row_sums = true;
     // Allocate temporary tensors to store quantized values of input,
@@ -1392,7 +1418,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          &op_data->packed_float_weights);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
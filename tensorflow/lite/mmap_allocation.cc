@@ -20,6 +20,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -40,6 +41,15 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+size_t GetPageSize() {
+#ifdef __ANDROID__
+  static int pagesize = getpagesize();
+#else
+  static int pagesize = sysconf(_SC_PAGE_SIZE);
+#endif
+  return pagesize;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
@@ -81,12 +91,7 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
-#ifdef __ANDROID__
-  static int pagesize = getpagesize();
-#else
-  static int pagesize = sysconf(_SC_PAGE_SIZE);
-#endif
-
+  const size_t pagesize = GetPageSize();
   offset_in_buffer_ = offset % pagesize;
   offset_of_buffer_in_file_ = offset - offset_in_buffer_;
 
@@ -129,6 +134,32 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+bool MMAPAllocation::AdviseRandomAccess() const {
+  return valid() && madvise(const_cast<void*>(mmapped_buffer_),
+                            mmapped_buffer_size(), MADV_RANDOM) == 0;
+}
+
+bool MMAPAllocation::AdviseCold(const void* ptr, size_t size) const {
+#ifdef MADV_COLD
+  if (!valid()) return false;
+  // Only the pages entirely within the range are advised, as the others also
+  // hold data that may be used soon.
+  const uintptr_t page_mask = GetPageSize() - 1;
+  const uintptr_t buffer_begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t buffer_end = buffer_begin + mmapped_buffer_size();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t end = begin + size;
+  if (begin < buffer_begin || end > buffer_end) return false;
+  const uintptr_t first_page = (begin + page_mask) & ~page_mask;
+  const uintptr_t pages_end = end & ~page_mask;
+  if (first_page >= pages_end) return true;
+  return madvise(reinterpret_cast<void*>(first_page), pages_end - first_page,
+                 MADV_COLD) == 0;
+#else
+  return false;
+#endif  // MADV_COLD
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
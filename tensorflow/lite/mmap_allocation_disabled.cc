@@ -45,6 +45,12 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+bool MMAPAllocation::AdviseRandomAccess() const { return false; }
+
+bool MMAPAllocation::AdviseCold(const void* ptr, size_t size) const {
+  return false;
+}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
@@ -16,9 +16,11 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_BUFFERED_PROFILER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 
 namespace tflite {
@@ -116,6 +118,18 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Records the hardware counters of the calling thread over the operator
+  // invoke events, which should then happen on that thread. Returns whether
+  // the platform supports them.
+  bool EnableHardwareCounters() {
+    hw_counter_reader_ = std::make_unique<hardware::HardwareCounterReader>();
+    if (!hw_counter_reader_->IsSupported()) {
+      hw_counter_reader_.reset();
+    }
+    buffer_.SetHardwareCounterReader(hw_counter_reader_.get());
+    return hw_counter_reader_ != nullptr;
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -137,6 +151,7 @@ class BufferedProfiler : public tflite::Profiler {
   ProfileBuffer* GetProfileBuffer() { return &buffer_; }
   ProfileBuffer buffer_;
   const uint64_t supported_event_types_;
+  std::unique_ptr<hardware::HardwareCounterReader> hw_counter_reader_;
 };
 
 }  // namespace profiling
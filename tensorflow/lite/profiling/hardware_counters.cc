@@ -0,0 +1,110 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif  // __linux__
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+#if defined(__linux__)
+namespace {
+
+int OpenCounter(uint32_t type, uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Counting only user space keeps the counters available with the default
+  // perf_event_paranoid setting of Android.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+}  // namespace
+
+HardwareCounterReader::HardwareCounterReader() {
+  const struct {
+    uint32_t type;
+    uint64_t config;
+  } kEvents[kNum] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  };
+  for (int i = 0; i < kNum; ++i) {
+    fds_[i] = OpenCounter(kEvents[i].type, kEvents[i].config, group_fd_);
+    positions_[i] = fds_[i] >= 0 ? num_open_++ : -1;
+    if (i == kCycles) {
+      if (fds_[i] < 0) break;
+      group_fd_ = fds_[i];
+    }
+  }
+}
+
+HardwareCounterReader::~HardwareCounterReader() {
+  if (group_fd_ < 0) return;
+  for (int i = 0; i < kNum; ++i) {
+    if (positions_[i] >= 0) close(fds_[i]);
+  }
+}
+
+HardwareCounters HardwareCounterReader::Read() const {
+  HardwareCounters result;
+  if (group_fd_ < 0) return result;
+  // The layout of a read of a group: the number of counters, then the value of
+  // each counter in the order of opening.
+  uint64_t values[1 + kNum];
+  const ssize_t size = (1 + num_open_) * sizeof(uint64_t);
+  if (read(group_fd_, values, size) != size) return result;
+  auto value = [&](Counter counter) -> uint64_t {
+    return positions_[counter] >= 0 ? values[1 + positions_[counter]] : 0;
+  };
+  result.cycles = value(kCycles);
+  result.instructions = value(kInstructions);
+  result.l1d_read_misses = value(kL1dReadMisses);
+  result.llc_misses = value(kLlcMisses);
+  return result;
+}
+
+#else
+
+HardwareCounterReader::HardwareCounterReader() {}
+
+HardwareCounterReader::~HardwareCounterReader() {}
+
+HardwareCounters HardwareCounterReader::Read() const {
+  return HardwareCounters();
+}
+
+#endif  // __linux__
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,97 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+// Values of the hardware performance counters, or their differences between
+// two points in time.
+struct HardwareCounters {
+  // The size of the cache lines in bytes, used to estimate the bytes moved
+  // from memory.
+  static constexpr uint64_t kCacheLineBytes = 64;
+
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  // Read misses of the level 1 data cache.
+  uint64_t l1d_read_misses = 0;
+  // Misses of the last level cache, i.e. the accesses that go to memory.
+  uint64_t llc_misses = 0;
+
+  // An estimate of the bytes moved between memory and the caches.
+  uint64_t MemoryBytes() const { return llc_misses * kCacheLineBytes; }
+
+  HardwareCounters operator+(const HardwareCounters& obj) const {
+    HardwareCounters res;
+    res.cycles = cycles + obj.cycles;
+    res.instructions = instructions + obj.instructions;
+    res.l1d_read_misses = l1d_read_misses + obj.l1d_read_misses;
+    res.llc_misses = llc_misses + obj.llc_misses;
+    return res;
+  }
+
+  HardwareCounters operator-(const HardwareCounters& obj) const {
+    HardwareCounters res;
+    res.cycles = cycles - obj.cycles;
+    res.instructions = instructions - obj.instructions;
+    res.l1d_read_misses = l1d_read_misses - obj.l1d_read_misses;
+    res.llc_misses = llc_misses - obj.llc_misses;
+    return res;
+  }
+};
+
+// Reads the hardware performance counters of the thread that created it,
+// through perf_event on Linux and Android. Only the user space work of that
+// thread is counted, so the work of e.g. the threads of a kernel thread pool
+// is not.
+// The counters that the platform, or its perf_event_paranoid setting, does not
+// provide read as 0. This class is *not thread safe*.
+class HardwareCounterReader {
+ public:
+  HardwareCounterReader();
+  ~HardwareCounterReader();
+
+  HardwareCounterReader(const HardwareCounterReader&) = delete;
+  HardwareCounterReader& operator=(const HardwareCounterReader&) = delete;
+
+  // Indicates whether at least the cycles can be counted.
+  bool IsSupported() const { return group_fd_ >= 0; }
+
+  // Returns the current values of the counters, or all zeros if they are not
+  // supported.
+  HardwareCounters Read() const;
+
+ private:
+  enum Counter { kCycles, kInstructions, kL1dReadMisses, kLlcMisses, kNum };
+
+  // The file descriptor of the group leader, which counts the cycles.
+  int group_fd_ = -1;
+  int fds_[kNum];
+  // The position of each counter in a read of the group, or -1 if the counter
+  // could not be opened.
+  int positions_[kNum];
+  int num_open_ = 0;
+};
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
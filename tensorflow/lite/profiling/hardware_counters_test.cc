@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+TEST(HardwareCounters, AddAndSub) {
+  HardwareCounters counters1, counters2;
+  counters1.cycles = 500;
+  counters1.instructions = 800;
+  counters1.l1d_read_misses = 30;
+  counters1.llc_misses = 4;
+
+  counters2.cycles = 200;
+  counters2.instructions = 300;
+  counters2.l1d_read_misses = 10;
+  counters2.llc_misses = 1;
+
+  const auto sum = counters1 + counters2;
+  EXPECT_EQ(700, sum.cycles);
+  EXPECT_EQ(1100, sum.instructions);
+  EXPECT_EQ(40, sum.l1d_read_misses);
+  EXPECT_EQ(5, sum.llc_misses);
+
+  const auto diff = counters1 - counters2;
+  EXPECT_EQ(300, diff.cycles);
+  EXPECT_EQ(500, diff.instructions);
+  EXPECT_EQ(20, diff.l1d_read_misses);
+  EXPECT_EQ(3, diff.llc_misses);
+  EXPECT_EQ(3 * HardwareCounters::kCacheLineBytes, diff.MemoryBytes());
+}
+
+TEST(HardwareCounterReader, Read) {
+  HardwareCounterReader reader;
+  const HardwareCounters begin = reader.Read();
+  volatile int sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  const HardwareCounters end = reader.Read();
+
+  if (!reader.IsSupported()) {
+    // E.g. in a virtual machine, or with a restrictive perf_event_paranoid.
+    EXPECT_EQ(0, end.cycles);
+    EXPECT_EQ(0, end.instructions);
+    return;
+  }
+  EXPECT_GT(end.cycles, begin.cycles);
+  EXPECT_GE(end.instructions, begin.instructions);
+}
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
@@ -43,6 +43,12 @@ uint32_t ProfileBuffer::BeginEvent(const char* tag,
   if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
     event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
   }
+  // Holds the begin values until the event ends.
+  event_buffer_[index].hw_counters =
+      event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+              hw_counter_reader_ != nullptr
+          ? hw_counter_reader_->Read()
+          : hardware::HardwareCounters();
   current_index_++;
   return index;
 }
@@ -61,6 +67,12 @@ void ProfileBuffer::EndEvent(uint32_t event_handle,
   }
 
   int event_index = event_handle % max_size;
+  if (event_buffer_[event_index].event_type ==
+          Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+      hw_counter_reader_ != nullptr) {
+    event_buffer_[event_index].hw_counters =
+        hw_counter_reader_->Read() - event_buffer_[event_index].hw_counters;
+  }
   event_buffer_[event_index].elapsed_time =
       time::NowMicros() - event_buffer_[event_index].begin_timestamp_us;
   if (event_buffer_[event_index].event_type !=
@@ -105,6 +117,7 @@ void ProfileBuffer::AddEvent(const char* tag,
   event_buffer_[index].extra_event_metadata = event_metadata2;
   event_buffer_[index].begin_timestamp_us = 0;
   event_buffer_[index].elapsed_time = elapsed_time;
+  event_buffer_[index].hw_counters = hardware::HardwareCounters();
   current_index_++;
 }
 
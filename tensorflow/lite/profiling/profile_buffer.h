@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -50,6 +51,10 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // The hardware counters over an OPERATOR_INVOKE_EVENT, if the buffer has a
+  // HardwareCounterReader. All zeros otherwise.
+  hardware::HardwareCounters hw_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -83,6 +88,14 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets the reader of the hardware counters to record over operator invoke
+  // events, or nullptr to not record them. The reader should remain valid till
+  // it is reset or the buffer is destroyed.
+  void SetHardwareCounterReader(
+      const hardware::HardwareCounterReader* hw_counter_reader) {
+    hw_counter_reader_ = hw_counter_reader;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -119,6 +132,7 @@ class ProfileBuffer {
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
+  const hardware::HardwareCounterReader* hw_counter_reader_ = nullptr;
 };
 
 }  // namespace profiling
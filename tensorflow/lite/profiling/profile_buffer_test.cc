@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/hardware_counters.h"
 
 namespace tflite {
 namespace profiling {
@@ -83,6 +84,31 @@ TEST(ProfileBufferTest, EndEventWithMetadata) {
   EXPECT_GE(event->elapsed_time, 0);
 }
 
+TEST(ProfileBufferTest, RecordsHardwareCountersOfOperators) {
+  hardware::HardwareCounterReader reader;
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.SetHardwareCounterReader(&reader);
+  auto op_handle =
+      buffer.BeginEvent("op", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+                        /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  auto other_handle =
+      buffer.BeginEvent("other", ProfileEvent::EventType::DEFAULT,
+                        /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  volatile int sum = 0;
+  for (int i = 0; i < 10000; ++i) sum += i;
+  buffer.EndEvent(other_handle);
+  buffer.EndEvent(op_handle);
+
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(0, events[1]->hw_counters.cycles);
+  if (reader.IsSupported()) {
+    EXPECT_GT(events[0]->hw_counters.cycles, 0);
+  } else {
+    EXPECT_EQ(0, events[0]->hw_counters.cycles);
+  }
+}
+
 TEST(ProfileBufferTest, OverFlow) {
   const int max_size = 4;
   ProfileBuffer buffer{max_size, true};
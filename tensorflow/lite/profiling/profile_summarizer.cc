@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -139,6 +143,13 @@ void ProfileSummarizer::ProcessProfiles(
 
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, node_exec_time, 0 /*memory */);
+      if (event->hw_counters.cycles > 0) {
+        auto& op_counters =
+            operator_counters_[{subgraph_index, node_name_in_stats}];
+        op_counters.type = type_in_stats;
+        ++op_counters.num_runs;
+        op_counters.counters = op_counters.counters + event->hw_counters;
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -203,6 +214,51 @@ void ProfileSummarizer::ProcessProfiles(
   }
 }
 
+std::string ProfileSummarizer::GetRooflineReport(double ridge_point) const {
+  if (operator_counters_.empty()) return "";
+
+  // Lists the operators by decreasing cycles.
+  std::vector<const std::pair<const std::pair<uint32_t, std::string>,
+                              OperatorCounters>*>
+      ops;
+  for (const auto& op : operator_counters_) ops.push_back(&op);
+  std::sort(ops.begin(), ops.end(), [](const auto* a, const auto* b) {
+    return a->second.counters.cycles > b->second.counters.cycles;
+  });
+
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(2);
+  stream << "Roofline of operators (averages per run, memory-bound below "
+         << ridge_point << " instructions per byte):\n";
+  stream << std::setw(24) << "[node type]" << std::setw(12) << "[subgraph]"
+         << std::setw(14) << "[cycles]" << std::setw(8) << "[IPC]"
+         << std::setw(14) << "[L1D misses]" << std::setw(14) << "[LLC misses]"
+         << std::setw(14) << "[KB moved]" << std::setw(14) << "[instr/byte]"
+         << std::setw(16) << "[bound]"
+         << "\t[Name]\n";
+  for (const auto* op : ops) {
+    const OperatorCounters& op_counters = op->second;
+    const hardware::HardwareCounters& counters = op_counters.counters;
+    const double runs = op_counters.num_runs;
+    const double intensity =
+        counters.MemoryBytes() > 0
+            ? static_cast<double>(counters.instructions) /
+                  counters.MemoryBytes()
+            : std::numeric_limits<double>::infinity();
+    stream << std::setw(24) << op_counters.type << std::setw(12)
+           << op->first.first << std::setw(14) << counters.cycles / runs
+           << std::setw(8)
+           << static_cast<double>(counters.instructions) / counters.cycles
+           << std::setw(14) << counters.l1d_read_misses / runs << std::setw(14)
+           << counters.llc_misses / runs << std::setw(14)
+           << counters.MemoryBytes() / runs / 1024.0 << std::setw(14)
+           << intensity << std::setw(16)
+           << (intensity < ridge_point ? "memory-bound" : "compute-bound")
+           << "\t" << op->first.second << "\n";
+  }
+  return stream.str();
+}
+
 tensorflow::StatsCalculator* ProfileSummarizer::GetStatsCalculator(
     uint32_t subgraph_index) {
   if (stats_calculator_map_.count(subgraph_index) == 0) {
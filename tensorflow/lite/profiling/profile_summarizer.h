@@ -20,10 +20,12 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
@@ -33,6 +35,12 @@ namespace profiling {
 // Creates a summary of operator invocations in the interpreter.
 class ProfileSummarizer {
  public:
+  // The default machine balance, in instructions per byte moved from memory,
+  // which separates the memory-bound operators from the compute-bound ones.
+  // It roughly fits a mobile or server core that retires a few instructions
+  // and gets a few bytes from memory per cycle.
+  static constexpr double kDefaultRooflineRidgePoint = 1.0;
+
   explicit ProfileSummarizer(
       std::shared_ptr<ProfileSummaryFormatter> summary_formatter =
           std::make_shared<ProfileSummaryDefaultFormatter>());
@@ -54,6 +62,14 @@ class ProfileSummarizer {
                                                *delegate_stats_calculator_);
   }
 
+  // Returns a report of the hardware counters of the operators, each of which
+  // is classified as memory-bound if it retires less than `ridge_point`
+  // instructions per byte moved from memory, as compute-bound otherwise.
+  // Returns an empty string if no hardware counters were recorded, see
+  // BufferedProfiler::EnableHardwareCounters().
+  std::string GetRooflineReport(
+      double ridge_point = kDefaultRooflineRidgePoint) const;
+
   tensorflow::StatsCalculator* GetStatsCalculator(uint32_t subgraph_index);
 
   bool HasProfiles() {
@@ -71,6 +87,16 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // The hardware counters of an operator, accumulated over its invocations.
+  struct OperatorCounters {
+    std::string type;
+    int64_t num_runs = 0;
+    hardware::HardwareCounters counters;
+  };
+  // Map storing the hardware counters per subgraph index and node name.
+  std::map<std::pair<uint32_t, std::string>, OperatorCounters>
+      operator_counters_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
@@ -127,6 +127,42 @@ TEST(ProfileSummarizerTest, Interpreter) {
   ASSERT_TRUE(output.find("Invoke") == std::string::npos) << output;  // NOLINT
 }
 
+TEST(ProfileSummarizerTest, RooflineReport) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  profiler.StopProfiling();
+  ProfileSummarizer summarizer;
+  // Without hardware counters, there is no report.
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  EXPECT_TRUE(summarizer.GetRooflineReport().empty());
+
+  // Fakes the counters of an operator that moves a lot of memory.
+  std::vector<ProfileEvent> events;
+  for (const ProfileEvent* event : profiler.GetProfileEvents()) {
+    events.push_back(*event);
+    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      events.back().hw_counters.cycles = 1000;
+      events.back().hw_counters.instructions = 2000;
+      events.back().hw_counters.llc_misses = 100;
+    }
+  }
+  std::vector<const ProfileEvent*> event_ptrs;
+  for (const ProfileEvent& event : events) event_ptrs.push_back(&event);
+  summarizer.ProcessProfiles(event_ptrs, *interpreter);
+  auto report = summarizer.GetRooflineReport();
+  EXPECT_THAT(report, ::testing::HasSubstr("SimpleOpEval"));
+  EXPECT_THAT(report, ::testing::HasSubstr("memory-bound"));
+  // 2000 instructions per 6400 bytes are above a lower ridge point.
+  EXPECT_THAT(summarizer.GetRooflineReport(/*ridge_point=*/0.1),
+              ::testing::HasSubstr("compute-bound"));
+}
+
 TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
   BufferedProfiler profiler(1024);
   SimpleOpModel m;
@@ -293,6 +293,11 @@ TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestorePlan(const Plan& plan) {
+  active_allocs_ = plan.active_allocs;
+  high_water_mark_ = plan.high_water_mark;
+}
+
 TfLiteStatus SimpleMemoryArena::ResolveAlloc(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc,
     char** output_ptr) {
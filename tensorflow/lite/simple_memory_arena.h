@@ -107,6 +107,13 @@ class ResizableAlignedBuffer {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
+  // The allocs scheduled since the last call to ClearPlan(), and the buffer
+  // size they require.
+  struct Plan {
+    std::vector<ArenaAllocWithUsageInterval> active_allocs;
+    size_t high_water_mark = 0;
+  };
+
   explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0)
       : committed_(false),
         high_water_mark_(0),
@@ -144,6 +151,14 @@ class SimpleMemoryArena {
 
   TfLiteStatus Commit(bool* arena_reallocated);
 
+  // Returns the allocs scheduled so far, so that the same allocation requests
+  // can later be replayed with RestorePlan() instead of calling Allocate().
+  Plan GetPlan() const { return {active_allocs_, high_water_mark_}; }
+
+  // Replaces the scheduled allocs by `plan`. Like after Allocate(), the arena
+  // must be committed and the allocs resolved before using it again.
+  void RestorePlan(const Plan& plan);
+
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
                             const ArenaAllocWithUsageInterval& alloc,
                             char** output_ptr);
@@ -19,10 +19,12 @@ limitations under the License.
 #include <unistd.h>
 #endif  // __linux__
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
@@ -35,6 +37,17 @@ using tensorflow::Stat;
 
 constexpr int kMemoryCheckIntervalMs = 50;
 
+namespace {
+
+// Returns the `percent`-th percentile of `values`, which are reordered.
+int64_t Percentile(std::vector<int64_t>* values, int percent) {
+  const size_t rank = (values->size() - 1) * percent / 100;
+  std::nth_element(values->begin(), values->begin() + rank, values->end());
+  return (*values)[rank];
+}
+
+}  // namespace
+
 #ifdef __linux__
 void GetRssStats(size_t* vsize, size_t* rss, size_t* shared, size_t* code) {
   FILE* fp = fopen("/proc/self/statm", "rt");
@@ -208,6 +221,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
                                   float max_secs, RunType run_type,
                                   TfLiteStatus* invoke_status) {
   Stat<int64_t> run_stats;
+  std::vector<int64_t> run_times_us;
   TFLITE_LOG(INFO) << "Running benchmark for at least " << min_num_times
                    << " iterations and at least " << min_secs << " seconds but"
                    << " terminate if exceeding " << max_secs << " seconds.";
@@ -232,6 +246,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
     listeners_.OnSingleRunEnd();
 
     run_stats.UpdateStat(end_us - start_us);
+    run_times_us.push_back(end_us - start_us);
     if (run_frequency > 0) {
       inter_run_sleep_time =
           next_run_finish_time - profiling::time::NowMicros() * 1e-6;
@@ -250,6 +265,14 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
   std::stringstream stream;
   run_stats.OutputToStream(&stream);
   TFLITE_LOG(INFO) << stream.str() << std::endl;
+  // Tail latencies are what matter when e.g. the input shapes vary between
+  // runs, and they are hidden by the average.
+  if (!run_times_us.empty()) {
+    TFLITE_LOG(INFO) << "Percentiles in us: "
+                     << "p50=" << Percentile(&run_times_us, 50)
+                     << " p90=" << Percentile(&run_times_us, 90)
+                     << " p99=" << Percentile(&run_times_us, 99);
+  }
 
   return run_stats;
 }
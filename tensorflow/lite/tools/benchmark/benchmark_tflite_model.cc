@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
@@ -354,6 +355,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("input_layer_shape",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("input_layer_shape_sequence",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("input_layer_value_range",
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("input_layer_value_files",
@@ -370,6 +373,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -423,6 +428,12 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<std::string>("input_layer", &params_, "input layer names"),
       CreateFlag<std::string>("input_layer_shape", &params_,
                               "input layer shape"),
+      CreateFlag<std::string>(
+          "input_layer_shape_sequence", &params_,
+          "A ';'-separated list of input layer shapes in the format of "
+          "--input_layer_shape, e.g. '1,128:1,128;1,512:1,512'. The runs cycle "
+          "through the list, resizing the input layers whenever their shapes "
+          "change. The resizing is not part of the measured run time."),
       CreateFlag<std::string>(
           "input_layer_value_range", &params_,
           "A map-like string representing value range for *integer* input "
@@ -452,6 +463,11 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<bool>(
+          "enable_op_hardware_counters", &params_,
+          "record the hardware counters of each op and report whether it is "
+          "compute-bound or memory-bound, requires --enable_op_profiling and "
+          "perf_event, i.e. Linux or Android"),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -501,6 +517,8 @@ void BenchmarkTfLiteModel::LogParams() {
   LOG_BENCHMARK_PARAM(std::string, "input_layer", "Input layers", verbose);
   LOG_BENCHMARK_PARAM(std::string, "input_layer_shape", "Input shapes",
                       verbose);
+  LOG_BENCHMARK_PARAM(std::string, "input_layer_shape_sequence",
+                      "Input shape sequence", verbose);
   LOG_BENCHMARK_PARAM(std::string, "input_layer_value_range",
                       "Input value ranges", verbose);
   LOG_BENCHMARK_PARAM(std::string, "input_layer_value_files",
@@ -518,6 +536,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -552,11 +572,40 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     return kTfLiteError;
   }
 
-  return PopulateInputLayerInfo(
+  TF_LITE_ENSURE_STATUS(PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
       params_.Get<std::string>("input_layer_shape"),
       params_.Get<std::string>("input_layer_value_range"),
-      params_.Get<std::string>("input_layer_value_files"), &inputs_);
+      params_.Get<std::string>("input_layer_value_files"), &inputs_));
+
+  input_shape_sequence_.clear();
+  next_input_shapes_ = 0;
+  const std::string shape_sequence =
+      params_.Get<std::string>("input_layer_shape_sequence");
+  if (shape_sequence.empty()) return kTfLiteOk;
+  if (inputs_.empty()) {
+    TFLITE_LOG(ERROR) << "--input_layer_shape_sequence requires --input_layer"
+                      << " and --input_layer_shape to be specified.";
+    return kTfLiteError;
+  }
+  for (const std::string& item : Split(shape_sequence, ';')) {
+    std::vector<std::string> shapes = Split(item, ':');
+    if (shapes.size() != inputs_.size()) {
+      TFLITE_LOG(ERROR) << "Each item of --input_layer_shape_sequence must "
+                        << "have " << inputs_.size() << " shapes, but '" << item
+                        << "' has " << shapes.size() << ".";
+      return kTfLiteError;
+    }
+    input_shape_sequence_.emplace_back(shapes.size());
+    for (int i = 0; i < shapes.size(); ++i) {
+      if (!util::SplitAndParse(shapes[i], ',',
+                               &input_shape_sequence_.back()[i])) {
+        TFLITE_LOG(ERROR) << "Incorrect size string specified: " << shapes[i];
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
 }
 
 uint64_t BenchmarkTfLiteModel::ComputeInputBytes() {
@@ -687,7 +736,37 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
   return kTfLiteOk;
 }
 
+TfLiteStatus BenchmarkTfLiteModel::ResizeInputs(
+    const std::vector<std::vector<int>>& shapes) {
+  auto interpreter_inputs = interpreter_->inputs();
+  bool resized = false;
+  for (int j = 0; j < shapes.size(); ++j) {
+    int i = interpreter_inputs[j];
+    TfLiteTensor* t = interpreter_->tensor(i);
+    if (t->type == kTfLiteString ||
+        std::equal(shapes[j].begin(), shapes[j].end(), t->dims->data,
+                   t->dims->data + t->dims->size)) {
+      continue;
+    }
+    TF_LITE_ENSURE_STATUS(interpreter_->ResizeInputTensor(i, shapes[j]));
+    resized = true;
+  }
+  if (!resized) return kTfLiteOk;
+  if (interpreter_->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to allocate tensors after resizing inputs!";
+    return kTfLiteError;
+  }
+  return PrepareInputData();
+}
+
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
+  if (!input_shape_sequence_.empty()) {
+    const auto& shapes = input_shape_sequence_[next_input_shapes_];
+    next_input_shapes_ =
+        (next_input_shapes_ + 1) % input_shape_sequence_.size();
+    TF_LITE_ENSURE_STATUS(ResizeInputs(shapes));
+  }
+
   auto interpreter_inputs = interpreter_->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
@@ -957,7 +1036,8 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<bool>("enable_op_hardware_counters")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
@@ -118,6 +118,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Resizes the non-string inputs whose shapes differ from `shapes`, then
+  // reallocates the tensors and regenerates the input data.
+  TfLiteStatus ResizeInputs(const std::vector<std::vector<int>>& shapes);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -126,6 +130,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
 
   std::vector<std::unique_ptr<BenchmarkListener>> owned_listeners_;
   std::mt19937 random_engine_;
+  // The input shapes of --input_layer_shape_sequence, and the index of those
+  // of the next run.
+  std::vector<std::vector<std::vector<int>>> input_shape_sequence_;
+  size_t next_input_shapes_ = 0;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
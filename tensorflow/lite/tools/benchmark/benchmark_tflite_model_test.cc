@@ -92,6 +92,36 @@ TEST(BenchmarkTfLiteModelTest, ResizeInputWithDelegate) {
   EXPECT_EQ(benchmark.Run(), kTfLiteOk);
 }
 
+TEST(BenchmarkTfLiteModelTest, CyclesThroughInputShapeSequence) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_runs", 3);
+  params.Set<int>("warmup_runs", 0);
+  params.Set<float>("min_secs", 0.0f);
+  params.Set<std::string>("input_layer", "input_87");
+  params.Set<std::string>("input_layer_shape", "1,224,224,3");
+  params.Set<std::string>("input_layer_shape_sequence",
+                          "1,224,224,3;2,224,224,3");
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+  TestBenchmarkListener listener;
+  benchmark.AddListener(&listener);
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteOk);
+  EXPECT_EQ(listener.results_.inference_time_us().count(), 3);
+}
+
+TEST(BenchmarkTfLiteModelTest, RejectsInputShapeSequenceOfWrongArity) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<std::string>("input_layer", "input_87");
+  params.Set<std::string>("input_layer_shape", "1,224,224,3");
+  params.Set<std::string>("input_layer_shape_sequence",
+                          "1,224,224,3:1,10");
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
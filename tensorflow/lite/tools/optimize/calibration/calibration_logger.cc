@@ -48,6 +48,16 @@ TfLiteStatus MinMax::Update(const float* values, size_t tensor_size,
   return kTfLiteOk;
 }
 
+void MinMax::Merge(const MinMax& other) {
+  if (!other.has_values_) return;
+  if (!has_values_) {
+    *this = other;
+    return;
+  }
+  min_ = std::min<float>(min_, other.min_);
+  max_ = std::max<float>(max_, other.max_);
+}
+
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
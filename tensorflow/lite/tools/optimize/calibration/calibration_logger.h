@@ -39,6 +39,9 @@ class MinMax {
     return kTfLiteOk;
   }
 
+  // Widens the range to include the values observed by `other`.
+  void Merge(const MinMax& other);
+
  private:
   bool has_values_ = false;
   float min_ = std::numeric_limits<float>::max();
@@ -57,6 +60,13 @@ class Logger {
                                                error_reporter);
   }
 
+  // Merges the values logged by `other` into this logger.
+  void Merge(const Logger& other) {
+    for (const auto& tensorid_stat : other.tensor_id_to_stats_map_) {
+      tensor_id_to_stats_map_[tensorid_stat.first].Merge(tensorid_stat.second);
+    }
+  }
+
   // Returns a map from tensor_index -> observed min max values.
   const absl::flat_hash_map<std::tuple<int, int>, MinMax>&
   GetCalibrationValues() const {
@@ -14,9 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/optimize/calibration/calibrator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <fstream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -336,14 +341,50 @@ string GetOpName(const tflite::OperatorCode& opcode) {
 class Reader : public CalibrationReader {
  public:
   Reader(const TfLiteContext* context, const Logger* logger)
-      : CalibrationReader(logger), context_(context) {}
+      : CalibrationReader(logger), context_(context), logger_(logger) {}
 
   ~Reader() override { GetCalibratorRegistry()->RemoveCalibrator(context_); }
 
+  const Logger* logger() const { return logger_; }
+
  private:
   const TfLiteContext* context_;
+  const Logger* logger_;
+};
+
+// A |CalibrationReader| that owns its logger.
+class OwningReader : public CalibrationReader {
+ public:
+  explicit OwningReader(std::unique_ptr<Logger> logger)
+      : CalibrationReader(logger.get()), logger_(std::move(logger)) {}
+
+ private:
+  std::unique_ptr<Logger> logger_;
 };
 
+// Returns true if no range of |current| moved by more than |tolerance| times
+// its width from the same range in |previous|.
+bool HasConverged(const Logger& previous, const Logger& current,
+                  float tolerance) {
+  const auto& previous_stats = previous.GetCalibrationValues();
+  for (const auto& tensorid_stat : current.GetCalibrationValues()) {
+    float min, max;
+    if (tensorid_stat.second.Get(&min, &max) != kTfLiteOk) continue;
+    auto it = previous_stats.find(tensorid_stat.first);
+    float previous_min, previous_max;
+    if (it == previous_stats.end() ||
+        it->second.Get(&previous_min, &previous_max) != kTfLiteOk) {
+      return false;
+    }
+    const float max_delta = tolerance * (max - min);
+    if (std::abs(min - previous_min) > max_delta ||
+        std::abs(max - previous_max) > max_delta) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HasInputs(BuiltinOperator code) {
   switch (code) {
     case BuiltinOperator_CALL_ONCE:
@@ -489,6 +530,80 @@ TfLiteStatus BuildLoggingInterpreter(
   return kTfLiteOk;
 }
 
+TfLiteStatus CalibrateInParallel(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_samples, const SetCalibrationInputsFn& set_inputs,
+    const ParallelCalibrationOptions& options,
+    std::unique_ptr<CalibrationReader>* calibration_reader,
+    int* num_samples_run) {
+  ErrorReporter* error_reporter = model.error_reporter();
+  if (error_reporter == nullptr) {
+    error_reporter = DefaultErrorReporter();
+  }
+  const int num_threads = std::max(1, options.num_threads);
+  std::vector<std::unique_ptr<Interpreter>> interpreters(num_threads);
+  std::vector<std::unique_ptr<CalibrationReader>> readers(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    TF_LITE_ENSURE_STATUS(BuildLoggingInterpreter(model, op_resolver,
+                                                  &interpreters[i],
+                                                  &readers[i]));
+    TF_LITE_ENSURE_STATUS(interpreters[i]->AllocateTensors());
+  }
+
+  const int check_interval = options.convergence_check_interval > 0
+                                 ? options.convergence_check_interval
+                                 : std::max(num_samples, 1);
+  auto merged_logger = std::make_unique<Logger>();
+  int next_sample = 0;
+  while (next_sample < num_samples) {
+    // Runs the samples up to the next convergence check in parallel.
+    const int end_sample = std::min(num_samples, next_sample + check_interval);
+    std::atomic<int> sample_counter(next_sample);
+    std::mutex status_mutex;
+    TfLiteStatus status = kTfLiteOk;
+    auto run_samples = [&](Interpreter* interpreter) {
+      for (int sample = sample_counter++; sample < end_sample;
+           sample = sample_counter++) {
+        TfLiteStatus sample_status = set_inputs(sample, interpreter);
+        if (sample_status == kTfLiteOk) sample_status = interpreter->Invoke();
+        if (sample_status != kTfLiteOk) {
+          std::lock_guard<std::mutex> lock(status_mutex);
+          status = sample_status;
+          return;
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads; ++i) {
+      threads.emplace_back(run_samples, interpreters[i].get());
+    }
+    run_samples(interpreters[0].get());
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    if (status != kTfLiteOk) {
+      error_reporter->Report("Failed to run calibration sample");
+      return status;
+    }
+    next_sample = end_sample;
+
+    auto logger = std::make_unique<Logger>();
+    for (const auto& reader : readers) {
+      logger->Merge(*static_cast<const Reader*>(reader.get())->logger());
+    }
+    const bool converged =
+        options.convergence_check_interval > 0 &&
+        HasConverged(*merged_logger, *logger, options.convergence_tolerance);
+    merged_logger = std::move(logger);
+    if (converged) break;
+  }
+
+  if (num_samples_run) *num_samples_run = next_sample;
+  *calibration_reader =
+      std::make_unique<OwningReader>(std::move(merged_logger));
+  return kTfLiteOk;
+}
+
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_CALIBRATOR_H_
 #define TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_CALIBRATOR_H_
 
+#include <functional>
 #include <memory>
 
 #include "tensorflow/lite/core/api/op_resolver.h"
@@ -66,6 +67,39 @@ TfLiteStatus BuildLoggingInterpreter(
     std::unique_ptr<CalibrationReader>* calibration_reader,
     const Allocation* allocation = nullptr);
 
+// Options for |CalibrateInParallel|.
+struct ParallelCalibrationOptions {
+  // Number of logging interpreters that run samples in parallel.
+  int num_threads = 1;
+  // If positive, the statistics are checked for convergence after every
+  // |convergence_check_interval| samples, and calibration stops once no
+  // tensor range moved by more than |convergence_tolerance| times its width
+  // since the previous check.
+  int convergence_check_interval = 0;
+  float convergence_tolerance = 0.01f;
+};
+
+// Sets the inputs of |interpreter| to the |sample_index|-th sample of the
+// representative dataset. It is called concurrently for different
+// interpreters, after their tensors are allocated.
+using SetCalibrationInputsFn =
+    std::function<TfLiteStatus(int sample_index, Interpreter* interpreter)>;
+
+// Runs up to |num_samples| samples through |options.num_threads| logging
+// interpreters in parallel, and returns in |calibration_reader| the
+// statistics merged over all of them. |num_samples_run|, if not null, is set
+// to the number of samples run, which is smaller than |num_samples| when
+// calibration stops early.
+//
+// This must not be called concurrently with |BuildLoggingInterpreter|, or
+// while a reader returned by it is destroyed.
+TfLiteStatus CalibrateInParallel(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_samples, const SetCalibrationInputsFn& set_inputs,
+    const ParallelCalibrationOptions& options,
+    std::unique_ptr<CalibrationReader>* calibration_reader,
+    int* num_samples_run = nullptr);
+
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
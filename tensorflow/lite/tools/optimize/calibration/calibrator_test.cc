@@ -699,6 +699,77 @@ TEST(CalibratorTest, CalibrationWithCallOnce) {
     EXPECT_NEAR(e.second.max, expected_result.max, eps);
   }
 }
+
+// Fills input tensor i of multi_add.bin with (i + 1) * (sample_index + 1).
+TfLiteStatus SetMultiAddInputs(int sample_index, Interpreter* interpreter) {
+  for (size_t i = 0; i < interpreter->inputs().size(); i++) {
+    TfLiteTensor* tensor = interpreter->tensor(interpreter->inputs()[i]);
+    for (size_t j = 0; j < tensor->bytes / sizeof(float); j++) {
+      tensor->data.f[j] = (i + 1) * (sample_index + 1);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TEST(CalibratorTest, CalibrateInParallelMergesStats) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  ParallelCalibrationOptions options;
+  options.num_threads = 3;
+  std::unique_ptr<CalibrationReader> reader;
+  int num_samples_run = 0;
+  auto status = CalibrateInParallel(*model, ops::builtin::BuiltinOpResolver{},
+                                    /*num_samples=*/8, SetMultiAddInputs,
+                                    options, &reader, &num_samples_run);
+  ASSERT_EQ(kTfLiteOk, status);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(8, num_samples_run);
+
+  absl::flat_hash_map<std::tuple<int, int>, CalibrationReader::CalibrationStats>
+      stats;
+  status = reader->GetTensorStatsAsMap(&stats);
+  EXPECT_EQ(kTfLiteOk, status);
+  EXPECT_EQ(7, stats.size());
+  // The ranges span the first and the last samples over all interpreters.
+  const float eps = 1e-6f;
+  const float expected_values[] = {1, 2, 3, 4, 5, 6, 9};
+  for (int tensor_idx = 0; tensor_idx < 7; tensor_idx++) {
+    EXPECT_NEAR(stats.find({0, tensor_idx})->second.min,
+                expected_values[tensor_idx], eps);
+    EXPECT_NEAR(stats.find({0, tensor_idx})->second.max,
+                8 * expected_values[tensor_idx], eps);
+  }
+}
+
+TEST(CalibratorTest, CalibrateInParallelStopsWhenRangesConverge) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  ParallelCalibrationOptions options;
+  options.num_threads = 2;
+  options.convergence_check_interval = 4;
+  std::unique_ptr<CalibrationReader> reader;
+  int num_samples_run = 0;
+  // Every sample has the same values, so the ranges do not move after the
+  // first check.
+  auto status = CalibrateInParallel(
+      *model, ops::builtin::BuiltinOpResolver{}, /*num_samples=*/100,
+      [](int sample_index, Interpreter* interpreter) {
+        return SetMultiAddInputs(0, interpreter);
+      },
+      options, &reader, &num_samples_run);
+  ASSERT_EQ(kTfLiteOk, status);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(8, num_samples_run);
+
+  absl::flat_hash_map<std::tuple<int, int>, CalibrationReader::CalibrationStats>
+      stats;
+  status = reader->GetTensorStatsAsMap(&stats);
+  EXPECT_EQ(kTfLiteOk, status);
+  EXPECT_EQ(7, stats.size());
+  const float eps = 1e-6f;
+  EXPECT_NEAR(stats.find({0, 6})->second.min, 9, eps);
+  EXPECT_NEAR(stats.find({0, 6})->second.max, 9, eps);
+}
 }  // namespace
 }  // namespace calibration
 }  // namespace optimize
@@ -285,6 +285,14 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
       return 1;
     }
 
+    case BuiltinOperator_DYNAMIC_UPDATE_SLICE:
+      // Version 2 supports int16 and float16 inputs.
+      if (op_sig.inputs.at(0).type == kTfLiteInt16 ||
+          op_sig.inputs.at(0).type == kTfLiteFloat16) {
+        return 2;
+      }
+      return 1;
+
     case BuiltinOperator_SIGN:
       // Version 2 supports int32 inputs
       if (op_sig.inputs.at(0).type == kTfLiteInt32) {
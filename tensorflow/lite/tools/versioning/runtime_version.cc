@@ -421,6 +421,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
            {{BuiltinOperator_GELU, 1}, "2.9.0"},
            {{BuiltinOperator_GELU, 2}, "2.9.0"},
            {{BuiltinOperator_DYNAMIC_UPDATE_SLICE, 1}, "2.9.0"},
+           {{BuiltinOperator_DYNAMIC_UPDATE_SLICE, 2}, "2.16.0"},
            {{BuiltinOperator_UNSORTED_SEGMENT_PROD, 1}, "2.10.0"},
            {{BuiltinOperator_UNSORTED_SEGMENT_MAX, 1}, "2.10.0"},
            {{BuiltinOperator_UNSORTED_SEGMENT_MIN, 1}, "2.11.0"},
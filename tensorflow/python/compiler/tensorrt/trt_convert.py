@@ -122,13 +122,15 @@ PROFILE_STRATEGY_RANGE = "Range"
 PROFILE_STRATEGY_OPTIMAL = "Optimal"
 PROFILE_STRATEGY_RANGE_OPTIMAL = "Range+Optimal"
 PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE = "ImplicitBatchModeCompatible"
+PROFILE_STRATEGY_CLUSTERED = "Clustered"
 
 
 def supported_profile_strategies():
   return [
       PROFILE_STRATEGY_RANGE, PROFILE_STRATEGY_OPTIMAL,
       PROFILE_STRATEGY_RANGE_OPTIMAL,
-      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE
+      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE,
+      PROFILE_STRATEGY_CLUSTERED
   ]
 
 
@@ -567,6 +567,32 @@ class ShuffleCheckpointTest(checkpoint_test_base.CheckpointTestBase,
         num_outputs,
     )
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          checkpoint_test_base.default_test_combinations(),
+          combinations.combine(buffer_size=[1, 3, 5, 10]),
+      )
+  )
+  def testReplayCheckpoint(self, verify_fn, buffer_size):
+    range_limit = 5
+    num_repeats = 2
+    num_outputs = range_limit * num_repeats
+
+    def ds_fn():
+      dataset = self._build_shuffle_dataset(
+          range_limit=range_limit,
+          num_repeats=num_repeats,
+          buffer_size=buffer_size,
+          seed=55,
+          reshuffle_each_iteration=False,
+      )
+      options = options_lib.Options()
+      options.experimental_replay_checkpoint = True
+      return dataset.with_options(options)
+
+    verify_fn(self, ds_fn, num_outputs)
+
   @combinations.generate(
       combinations.combine(
           tf_api_version=1,
@@ -564,6 +564,17 @@ class Options(options_lib.OptionsBase):
       "`tf.data.experimental.OptimizationOptions` for more details.",
       default_factory=OptimizationOptions)
 
+  experimental_replay_checkpoint = options_lib.create_option(
+      name="experimental_replay_checkpoint",
+      ty=bool,
+      docstring="Whether to checkpoint iterators by only recording the number "
+      "of elements produced. Restoring such a checkpoint recreates the "
+      "iterator and skips over the elements that were already produced, "
+      "without storing the buffers of transformations in the checkpoint. "
+      "This requires the input pipeline to be deterministic, i.e. random "
+      "transformations must use fixed seeds and must not reshuffle each "
+      "iteration. If None, defaults to False.")
+
   experimental_slack = options_lib.create_option(
       name="experimental_slack",
       ty=bool,
@@ -656,6 +667,8 @@ class Options(options_lib.OptionsBase):
           ExternalStatePolicy._to_proto(  # pylint: disable=protected-access
               self.experimental_external_state_policy))
     pb.optimization_options.CopyFrom(self.experimental_optimization._to_proto())  # pylint: disable=protected-access
+    if self.experimental_replay_checkpoint is not None:
+      pb.replay_checkpoint = self.experimental_replay_checkpoint
     if self.experimental_slack is not None:
       pb.slack = self.experimental_slack
     if self.experimental_symbolic_checkpoint is not None:
@@ -677,6 +690,8 @@ class Options(options_lib.OptionsBase):
           ExternalStatePolicy._from_proto(  # pylint: disable=protected-access
               pb.external_state_policy))
     self.experimental_optimization._from_proto(pb.optimization_options)  # pylint: disable=protected-access
+    if pb.WhichOneof("optional_replay_checkpoint") is not None:
+      self.experimental_replay_checkpoint = pb.replay_checkpoint
     if pb.WhichOneof("optional_slack") is not None:
       self.experimental_slack = pb.slack
     if pb.WhichOneof("optional_symbolic_checkpoint") is not None:
@@ -20,10 +20,15 @@ from tensorflow.python.util.tf_export import tf_export
 
 
 @tf_export("experimental.dlpack.to_dlpack", v1=[])
-def to_dlpack(tf_tensor):
+def to_dlpack(tf_tensor, stream=None):
   """Returns the dlpack capsule representing the tensor.
 
   This operation ensures the underlying data memory is ready when returns.
+  Alternatively, for a GPU tensor, `stream` can be the integer handle of the
+  CUDA or ROCm stream of the consumer, as in the `__dlpack__` protocol: the
+  work later enqueued on that stream is then ordered after the pending writes
+  to the tensor, without blocking the host. 1 and 2 denote the legacy and
+  per-thread default CUDA streams, and -1 skips the synchronization.
 
     ```python
     a = tf.tensor([1, 10])
@@ -33,12 +38,14 @@ def to_dlpack(tf_tensor):
 
   Args:
     tf_tensor: Tensorflow eager tensor, to be converted to dlpack capsule.
+    stream: Optional integer handle of the stream of the consumer.
 
   Returns:
     A PyCapsule named as dltensor, which shares the underlying memory to other
      framework. This PyCapsule can be consumed only once.
   """
-  return pywrap_tfe.TFE_ToDlpackCapsule(tf_tensor)
+  return pywrap_tfe.TFE_ToDlpackCapsule(tf_tensor,
+                                        0 if stream is None else stream)
 
 
 @tf_export("experimental.dlpack.from_dlpack", v1=[])
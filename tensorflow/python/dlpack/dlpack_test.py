@@ -74,6 +74,15 @@ class DLPackTest(parameterized.TestCase, test.TestCase):
     else:
       self.assertEqual(tf_tensor_device, tf_tensor2.device)
 
+  def testDLPackWithStream(self):
+    np_array = np.arange(12, dtype=np.float32).reshape(3, 4)
+    tf_tensor = array_ops.identity(constant_op.constant(np_array))
+    # -1 leaves the synchronization to the consumer and 1 is the legacy
+    # default CUDA stream.
+    for stream in (-1, 1):
+      dlcapsule = dlpack.to_dlpack(tf_tensor, stream=stream)
+      self.assertAllClose(np_array, dlpack.from_dlpack(dlcapsule))
+
   def testTensorsCanBeConsumedOnceOnly(self):
     np.random.seed(42)
     np_array = np.random.randint(0, 10, (2, 3, 4))
@@ -313,6 +313,23 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeIntegers(self):
+    # Large enough for the kernel to sort rather than hash the values.
+    for dtype, high in [(np.int32, 1000), (np.int32, 2**31 - 1),
+                        (np.int64, 2**62)]:
+      x = np.random.randint(-high, high=high, size=300000, dtype=dtype)
+      values, first, inverse, counts = np.unique(
+          x, return_index=True, return_inverse=True, return_counts=True)
+      order = np.argsort(first)
+      rank = np.empty_like(order)
+      rank[order] = np.arange(len(order))
+      for out_idx in [dtypes.int32, dtypes.int64]:
+        y, idx, count = array_ops.unique_with_counts(x, out_idx=out_idx)
+        tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+        self.assertAllEqual(tf_y, values[order])
+        self.assertAllEqual(tf_idx, rank[inverse])
+        self.assertAllEqual(tf_count, counts[order])
+
 
 if __name__ == '__main__':
   test.main()
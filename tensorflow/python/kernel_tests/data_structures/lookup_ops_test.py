@@ -3719,6 +3719,40 @@ class MutableHashTableOpTest(test.TestCase):
     sorted_expected_values = np.sort([[4, 5], [2, 3], [0, 1]], axis=0)
     self.assertAllEqual(sorted_expected_values, sorted_values)
 
+  def testMutableHashTableOfTensorsManyKeys(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    # Enough keys to spread over all the shards of the table.
+    num_keys = 1000
+    default_val = constant_op.constant([-1, -1], dtypes.int64)
+    keys = constant_op.constant(np.arange(num_keys), dtypes.int64)
+    values = constant_op.constant(
+        np.stack([np.arange(num_keys), -np.arange(num_keys)], axis=1),
+        dtypes.int64)
+    table = lookup_ops.MutableHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_val,
+        experimental_is_anonymous=is_anonymous)
+    self.evaluate(table.insert(keys, values))
+    self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+    self.evaluate(table.remove(constant_op.constant([0, 999], dtypes.int64)))
+    self.assertAllEqual(num_keys - 2, self.evaluate(table.size()))
+
+    output = table.lookup(constant_op.constant([999, 500, 0, 1], dtypes.int64))
+    self.assertAllEqual([[-1, -1], [500, -500], [-1, -1], [1, -1]],
+                        self.evaluate(output))
+
+    exported_keys, exported_values = table.export()
+    exported_keys, exported_values = self.evaluate(
+        [exported_keys, exported_values])
+    order = np.argsort(exported_keys)
+    self.assertAllEqual(np.arange(1, num_keys - 1), exported_keys[order])
+    self.assertAllEqual(
+        np.stack([np.arange(1, num_keys - 1), -np.arange(1, num_keys - 1)],
+                 axis=1), exported_values[order])
+
   def testMutableHashTableExportInsert(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
       self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
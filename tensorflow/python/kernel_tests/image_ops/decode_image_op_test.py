@@ -20,6 +20,7 @@ import numpy as np
 
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_image_ops
 from tensorflow.python.ops import image_ops
 from tensorflow.python.ops import io_ops
 import tensorflow.python.ops.nn_grad  # pylint: disable=unused-import
@@ -114,5 +115,59 @@ class DecodeImageOpTest(test.TestCase):
         self.evaluate(decode)
 
 
+class DecodeJpegBatchOpTest(test.TestCase):
+
+  def _readJpeg(self):
+    # A 256x128 RGB image.
+    path = os.path.join(prefix_path, "jpeg", "testdata", "jpeg_merge_test1.jpg")
+    return self.evaluate(io_ops.read_file(path))
+
+  def testDecodesScaledImages(self):
+    jpeg0 = self._readJpeg()
+    images = gen_image_ops.decode_jpeg_batch(
+        [jpeg0, jpeg0], [[0, 0, 0, 0], [0, 0, 256, 128]],
+        output_height=128,
+        output_width=64)
+    expected = image_ops.decode_jpeg(jpeg0, channels=3, ratio=2)
+    images, expected = self.evaluate([images, expected])
+    self.assertEqual(images.shape, (2, 128, 64, 3))
+    self.assertAllEqual(images[0], expected)
+    self.assertAllEqual(images[1], expected)
+
+  def testCropsImages(self):
+    jpeg0 = self._readJpeg()
+    images = gen_image_ops.decode_jpeg_batch(
+        [jpeg0, jpeg0], [[64, 32, 128, 64], [0, 0, 0, 0]],
+        output_height=32,
+        output_width=16)
+    # The first window is decoded at a quarter of its size, the whole image
+    # at an eighth.
+    cropped = gen_image_ops.decode_and_crop_jpeg(
+        jpeg0, [16, 8, 32, 16], channels=3, ratio=4)
+    scaled = image_ops.decode_jpeg(jpeg0, channels=3, ratio=8)
+    images, cropped, scaled = self.evaluate([images, cropped, scaled])
+    self.assertAllEqual(images[0], cropped)
+    self.assertAllEqual(images[1], scaled)
+
+  def testResizesImages(self):
+    jpeg0 = self._readJpeg()
+    images = gen_image_ops.decode_jpeg_batch(
+        [jpeg0], [[0, 0, 0, 0]], output_height=100, output_width=50)
+    expected = image_ops.resize_images_v2(
+        image_ops.decode_jpeg(jpeg0, channels=3, ratio=2), [100, 50])
+    images, expected = self.evaluate([images, expected])
+    self.assertEqual(images.shape, (1, 100, 50, 3))
+    self.assertAllClose(images[0], np.round(expected), atol=1)
+
+  def testInvalidCropWindow(self):
+    jpeg0 = self._readJpeg()
+    with self.assertRaisesRegex(errors_impl.InvalidArgumentError,
+                                "is not inside the image"):
+      self.evaluate(
+          gen_image_ops.decode_jpeg_batch([jpeg0], [[200, 0, 100, 64]],
+                                          output_height=32,
+                                          output_width=32))
+
+
 if __name__ == "__main__":
   test.main()
@@ -215,6 +215,23 @@ class SegmentReductionOpTest(SegmentReductionHelper, parameterized.TestCase):
         tf_ans = self.evaluate(s)
         self.assertAllClose(np_ans, tf_ans)
 
+  def testSkewedSegmentsCpu(self):
+    # The segments span several blocks of work, or share one, and have holes.
+    sizes = [1, 9000, 3, 0, 0, 1, 4000, 2, 7, 0, 5000]
+    indices = np.repeat(np.arange(len(sizes)), sizes)
+    np_x = np.arange(len(indices) * 3).reshape([len(indices), 3]) % 1001
+    np_x = np_x.astype(np.int32)
+    np_sum = np.zeros([len(sizes), 3], dtype=np.int32)
+    np.add.at(np_sum, indices, np_x)
+    np_max = np.full([len(sizes), 3], np.iinfo(np.int32).min, dtype=np.int32)
+    np.maximum.at(np_max, indices, np_x)
+    np_max[np.array(sizes) == 0] = 0
+    with self.cached_session(use_gpu=False):
+      self.assertAllEqual(
+          np_sum, math_ops.segment_sum(data=np_x, segment_ids=indices))
+      self.assertAllEqual(
+          np_max, math_ops.segment_max(data=np_x, segment_ids=indices))
+
   @test_util.run_deprecated_v1
   def testSegmentIdsInvalid1(self):
     shape = [4, 4]
@@ -587,6 +604,20 @@ class UnsortedSegmentTest(SegmentReductionHelper, parameterized.TestCase):
         self.assertAllClose(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, s)
 
+  def testSkewedSegmentsCpu(self):
+    # Most rows go to a few segments, and some are dropped.
+    num_segments = 1000
+    rng = np.random.RandomState(0)
+    indices = np.minimum(rng.zipf(1.5, size=30000), num_segments) - 2
+    np_x = rng.randint(-100, 100, size=[len(indices), 5]).astype(np.int32)
+    np_ans = np.zeros([num_segments, 5], dtype=np.int32)
+    np.add.at(np_ans, indices[indices >= 0], np_x[indices >= 0])
+    with self.cached_session(use_gpu=False):
+      self.assertAllEqual(
+          np_ans,
+          math_ops.unsorted_segment_sum(
+              data=np_x, segment_ids=indices, num_segments=num_segments))
+
   @test_util.run_deprecated_v1
   def testAllNegatives(self):
     with self.session(use_gpu=False):
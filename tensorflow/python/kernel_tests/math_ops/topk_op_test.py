@@ -195,6 +195,16 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testStableSortLongRow(self):
+    # Long enough for the row to be split between threads.
+    n = 1 << 20
+    for k in [2, 1000]:
+      for high in [4, n]:
+        inputs = np.random.randint(0, high, size=(1, n), dtype=np.int32)
+        indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+        values = -np.sort(-inputs, axis=1)[:, :k]
+        self._validateTopK(inputs, k, values, indices)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
@@ -434,6 +434,18 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testPartialTilesCpu(self):
+    # The dimensions are not multiples of the tile sizes, and the inner ones
+    # are small.
+    shape = [3, 37, 2, 41, 3]
+    for dtype in [np.int8, np.float32, np.complex128]:
+      x = np.arange(np.prod(shape)).reshape(shape).astype(dtype)
+      for perm in itertools.permutations(range(len(shape))):
+        with self.subTest(dtype=dtype, perm=perm):
+          with self.cached_session(use_gpu=False):
+            self.assertAllEqual(
+                np.transpose(x, perm), array_ops.transpose(x, perm))
+
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
     for use_gpu in [False, True]:
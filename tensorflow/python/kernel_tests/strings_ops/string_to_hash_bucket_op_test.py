@@ -13,6 +13,8 @@
 # limitations under the License.
 # ==============================================================================
 """Tests for StringToHashBucket op from string_ops."""
+import numpy as np
+
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
@@ -45,6 +47,21 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  @test_util.run_deprecated_v1
+  def testStringToHashBucketsFastLargeInput(self):
+    # Large inputs are hashed by several threads.
+    strings = [('%d' % i) * (i % 40) for i in range(10000)]
+    with self.cached_session():
+      input_string = array_ops.placeholder(dtypes.string)
+      output = string_ops.string_to_hash_bucket_fast(input_string, 1000)
+      result = output.eval(feed_dict={input_string: strings})
+      expected = [
+          output.eval(feed_dict={input_string: strings[i:i + 100]})
+          for i in range(0, len(strings), 100)
+      ]
+
+      self.assertAllEqual(np.concatenate(expected), result)
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -1824,7 +1824,7 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
         py::return_value_policy::reference);
 
   // DLPack functions
-  m.def("TFE_ToDlpackCapsule", [](py::handle& o) {
+  m.def("TFE_ToDlpackCapsule", [](py::handle& o, int64_t stream) {
     PyObject* eager_tensor_pyobject_ptr = o.ptr();
     tensorflow::Safe_TF_StatusPtr status =
         tensorflow::make_safe(TF_NewStatus());
@@ -1836,7 +1836,8 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
     }
 
     TFE_TensorHandle* thandle = EagerTensor_Handle(eager_tensor_pyobject_ptr);
-    void* dlm_ptr = tensorflow::TFE_HandleToDLPack(thandle, status.get());
+    void* dlm_ptr =
+        tensorflow::TFE_HandleToDLPackWithStream(thandle, stream, status.get());
     tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
 
     py::capsule capsule(
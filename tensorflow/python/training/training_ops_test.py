@@ -456,6 +456,37 @@ class TrainingOpsTest(TensorFlowTestCase):
     param_t = param - alpha_t * m_t / (np.sqrt(v_t) + epsilon)
     return param_t, m_t, v_t
 
+  @test_util.run_v2_only
+  def testResourceApplyAdamMulti(self):
+    dtype = np.float32
+    # Sizes around the block size of the CPU kernel.
+    sizes = [3, 4095, 4097, 10000]
+    var = [np.arange(n).astype(dtype) for n in sizes]
+    m = [np.arange(1, n + 1).astype(dtype) for n in sizes]
+    v = [np.arange(n + 1, 2 * n + 1).astype(dtype) for n in sizes]
+    grad = [np.linspace(-1, 1, n).astype(dtype) for n in sizes]
+    beta1 = np.array(0.9, dtype=dtype)
+    beta2 = np.array(0.999, dtype=dtype)
+    lr = np.array(0.001, dtype=dtype)
+    epsilon = np.array(1e-8, dtype=dtype)
+    var_t = [variables.Variable(x) for x in var]
+    m_t = [variables.Variable(x) for x in m]
+    v_t = [variables.Variable(x) for x in v]
+    self.evaluate(variables.global_variables_initializer())
+
+    self.evaluate(
+        gen_training_ops.resource_apply_adam_multi(
+            [x.handle for x in var_t], [x.handle for x in m_t],
+            [x.handle for x in v_t], beta1, beta2, lr, beta1, beta2, epsilon,
+            grad))
+    for i in range(len(sizes)):
+      new_var, new_m, new_v = self._adamUpdateNumpy(var[i], grad[i], 1, m[i],
+                                                    v[i], lr, beta1, beta2,
+                                                    epsilon)
+      self.assertAllCloseAccordingToType(new_var, self.evaluate(var_t[i]))
+      self.assertAllCloseAccordingToType(new_m, self.evaluate(m_t[i]))
+      self.assertAllCloseAccordingToType(new_v, self.evaluate(v_t[i]))
+
   @test_util.run_v2_only
   def testResourceSparseApplyAdagradV2AndDisableCopyOnReadRace(self):
     dtype = np.float32
@@ -20,12 +20,14 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -94,6 +96,15 @@ struct CoordinatedTaskEqual {
   }
 };
 
+// Returns a fingerprint of `tasks` that does not depend on their order.
+uint64_t TasksFingerprint(const std::vector<CoordinatedTask>& tasks) {
+  uint64_t sum = 0;
+  for (const CoordinatedTask& task : tasks) {
+    sum += CoordinatedTaskHash()(task);
+  }
+  return absl::HashOf(sum, tasks.size());
+}
+
 // Standalone implementation of the coordination service.
 class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
  public:
@@ -162,6 +173,9 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
         "Invalid barrier result.");  // Only valid if `passed` is true.
     uint64_t deadline_in_micros = 0;
     int num_pending_tasks = 0;
+    // The TasksFingerprint of the participating tasks of the first call, if
+    // they are distinct.
+    std::optional<uint64_t> tasks_fingerprint;
     // Specifies which tasks have called the barrier so far.
     absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
                         CoordinatedTaskEqual>
@@ -1026,6 +1040,10 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     StatusCallback done) {
   VLOG(3) << "Task " << GetTaskName(task) << "invoked BarrierAsync("
           << barrier_id << ").";
+  // Every task of a barrier passes the participating tasks, so checking them
+  // costs O(N) per call. They are fingerprinted before taking `state_mu_`, so
+  // that the calls of N tasks do not spend O(N^2) time under the lock.
+  const uint64_t tasks_fingerprint = TasksFingerprint(participating_tasks);
   mutex_lock l(state_mu_);
   auto pair = barriers_.try_emplace(barrier_id);
   auto it = pair.first;
@@ -1060,6 +1078,10 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
       }
     }
     barrier->num_pending_tasks = barrier->tasks_at_barrier.size();
+    if (participating_tasks.empty() ||
+        barrier->tasks_at_barrier.size() == participating_tasks.size()) {
+      barrier->tasks_fingerprint = tasks_fingerprint;
+    }
 
     // Fail the barrier immediately if any tasks are already in error.
     for (const auto& pending_task : barrier->tasks_at_barrier) {
@@ -1123,8 +1145,10 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     return;
   }
 
-  // Check if task args are specified consistently across barrier calls.
-  if (!ValidateTaskArgs(participating_tasks, barrier->tasks_at_barrier,
+  // Check if task args are specified consistently across barrier calls. The
+  // full check is only needed if they differ from those of the first call.
+  if (tasks_fingerprint != barrier->tasks_fingerprint &&
+      !ValidateTaskArgs(participating_tasks, barrier->tasks_at_barrier,
                         cluster_state_.size())) {
     Status error = MakeCoordinationError(errors::InvalidArgument(absl::StrCat(
         "Conflicting tasks specified for the same barrier: ", barrier_id)));
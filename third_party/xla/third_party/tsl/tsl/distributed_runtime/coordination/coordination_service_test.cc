@@ -931,6 +931,44 @@ TEST_F(CoordinationBarrierTest, BarrierWithMismatchedTasks) {
   EXPECT_TRUE(absl::IsInvalidArgument(barrier_status_1));
 }
 
+TEST_F(CoordinationBarrierTest, BarrierWithReorderedTasks) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status_0;
+  Status barrier_status_1;
+
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*participating_tasks=*/{GetTask(0), GetTask(1)},
+      [&barrier_status_0](Status s) { barrier_status_0 = s; });
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(1),
+      /*participating_tasks=*/{GetTask(1), GetTask(0)},
+      [&barrier_status_1](Status s) { barrier_status_1 = s; });
+
+  TF_EXPECT_OK(barrier_status_0);
+  TF_EXPECT_OK(barrier_status_1);
+}
+
+TEST_F(CoordinationBarrierTest, BarrierWithDuplicatedTasks) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status_0;
+  Status barrier_status_1;
+
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*participating_tasks=*/{GetTask(0), GetTask(1), GetTask(1)},
+      [&barrier_status_0](Status s) { barrier_status_0 = s; });
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(1),
+      /*participating_tasks=*/{GetTask(0), GetTask(1), GetTask(1)},
+      [&barrier_status_1](Status s) { barrier_status_1 = s; });
+
+  EXPECT_TRUE(absl::IsInvalidArgument(barrier_status_0));
+  EXPECT_TRUE(absl::IsInvalidArgument(barrier_status_1));
+}
+
 TEST_F(CoordinationBarrierTest, BarrierByNonParticipatingTask) {
   const std::string barrier_id = "barrier_id";
   absl::Duration timeout = absl::Seconds(5);
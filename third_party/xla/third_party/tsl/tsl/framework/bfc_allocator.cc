@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <utility>
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -66,6 +68,8 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
   memory_limit_ = total_memory;
   stats_.bytes_limit = static_cast<int64_t>(total_memory);
 
+  memory_events_.resize(opts.memory_event_history_size);
+
   // Create a bunch of bins of various good sizes.
 
   // We create bins to fit all possible ranges that cover the
@@ -167,10 +171,20 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
       std::max(*stats_.pool_bytes, *stats_.peak_pool_bytes);
   VLOG(1) << "Total allocated bytes: "
           << strings::HumanReadableNumBytes(*stats_.pool_bytes);
+  RecordMemoryEvent(MemoryEventType::kExtend, mem_addr, bytes_received, 0);
 
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes_received);
 
+  sub_allocations_.insert(
+      std::upper_bound(sub_allocations_.begin(), sub_allocations_.end(),
+                       mem_addr,
+                       [](const void* ptr, const SubAllocation& sub) {
+                         return ptr < sub.ptr;
+                       }),
+      {mem_addr, bytes_received, /*freed_since_check=*/false,
+       /*idle_since_micros=*/0});
+
   AllocationRegion* maybe_extended_region = nullptr;
   if (coalesce_regions_) {
     maybe_extended_region =
@@ -410,12 +424,132 @@ void BFCAllocator::DeallocateRegions(
     }
 
     // Deallocate the memory.
+    sub_allocations_.erase(
+        std::remove_if(sub_allocations_.begin(), sub_allocations_.end(),
+                       [&it](const SubAllocation& sub) {
+                         return sub.ptr >= it->ptr() && sub.ptr < it->end_ptr();
+                       }),
+        sub_allocations_.end());
     sub_allocator_->Free(it->ptr(), it->memory_size());
     *stats_.pool_bytes -= it->memory_size();
+    RecordMemoryEvent(MemoryEventType::kRelease, it->ptr(), it->memory_size(),
+                      0);
     it = region_manager_.RemoveAllocationRegion(it);
   }
 }
 
+size_t BFCAllocator::ReleaseFreeMemory(size_t num_bytes) {
+  mutex_lock l(lock_);
+  return ReleaseTrailingFreeMemory(num_bytes, /*only_idle=*/false);
+}
+
+void BFCAllocator::MaybeReleaseIdleMemory(const void* freed_ptr,
+                                          size_t freed_bytes) {
+  // The memory that was just in use is not idle.
+  const void* freed_end = static_cast<const char*>(freed_ptr) + freed_bytes;
+  auto it = std::upper_bound(sub_allocations_.begin(), sub_allocations_.end(),
+                             freed_ptr,
+                             [](const void* ptr, const SubAllocation& sub) {
+                               return ptr < sub.ptr;
+                             });
+  DCHECK(it != sub_allocations_.begin());
+  for (--it; it != sub_allocations_.end() && it->ptr < freed_end; ++it) {
+    it->freed_since_check = true;
+  }
+
+  const uint64 now = Env::Default()->NowMicros();
+  if (now < next_idle_check_micros_) return;
+  next_idle_check_micros_ =
+      now + std::max<int64_t>(opts_.release_idle_memory_micros / 4, 1);
+  ReleaseTrailingFreeMemory(std::numeric_limits<size_t>::max(),
+                            /*only_idle=*/true);
+}
+
+size_t BFCAllocator::ReleaseTrailingFreeMemory(size_t num_bytes,
+                                               bool only_idle) {
+  const uint64 now = only_idle ? Env::Default()->NowMicros() : 0;
+  auto sub_allocation_less = [](const SubAllocation& sub, const void* ptr) {
+    return sub.ptr < ptr;
+  };
+  size_t bytes_released = 0;
+  std::vector<AllocationRegion>& regions = region_manager_.mutable_regions();
+  for (int r = regions.size() - 1; r >= 0 && bytes_released < num_bytes; --r) {
+    AllocationRegion& region = regions[r];
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (ChunkFromHandle(h)->next != kInvalidChunkHandle) {
+      h = ChunkFromHandle(h)->next;
+    }
+    Chunk* c = ChunkFromHandle(h);
+    // Chunks freed at a count may still be in use on the device.
+    const void* free_begin = (c->in_use() || c->freed_at_count > 0)
+                                 ? region.end_ptr()
+                                 : c->ptr;
+
+    auto first =
+        std::lower_bound(sub_allocations_.begin(), sub_allocations_.end(),
+                         region.ptr(), sub_allocation_less);
+    auto last = std::lower_bound(first, sub_allocations_.end(),
+                                 region.end_ptr(), sub_allocation_less);
+    if (only_idle) {
+      for (auto it = first; it != last; ++it) {
+        if (it->ptr < free_begin) {
+          it->idle_since_micros = 0;
+        } else if (it->freed_since_check || it->idle_since_micros == 0) {
+          it->idle_since_micros = now;
+        }
+        it->freed_since_check = false;
+      }
+    }
+
+    // Releases the free sub-allocations at the end of the region.
+    auto release = last;
+    size_t bytes = 0;
+    while (release != first && bytes_released + bytes < num_bytes) {
+      const SubAllocation& sub = *(release - 1);
+      if (sub.ptr < free_begin ||
+          (only_idle &&
+           now - sub.idle_since_micros <
+               static_cast<uint64>(opts_.release_idle_memory_micros))) {
+        break;
+      }
+      bytes += sub.size;
+      --release;
+    }
+    if (release == last) continue;
+
+    const void* release_begin = release->ptr;
+    VLOG(1) << "Releasing " << strings::HumanReadableNumBytes(bytes)
+            << " of free memory at " << release_begin << " for " << Name();
+    RemoveFreeChunkFromBin(h);
+    if (release_begin == c->ptr) {
+      if (c->prev != kInvalidChunkHandle) {
+        ChunkFromHandle(c->prev)->next = kInvalidChunkHandle;
+      }
+      DeleteChunk(h);
+    } else {
+      c->size = static_cast<const char*>(release_begin) -
+                static_cast<const char*>(c->ptr);
+      InsertFreeChunkIntoBin(h);
+    }
+    if (release_begin == region.ptr()) {
+      region_manager_.RemoveAllocationRegion(regions.begin() + r);
+    } else {
+      region.shrink(bytes);
+    }
+
+    // Frees the highest addresses first, so that a sub-allocator that maps
+    // memory at the end of a reserved range can take them back.
+    for (auto it = last; it != release; --it) {
+      sub_allocator_->Free((it - 1)->ptr, (it - 1)->size);
+    }
+    sub_allocations_.erase(release, last);
+    *stats_.pool_bytes -= bytes;
+    RecordMemoryEvent(MemoryEventType::kRelease, release_begin, bytes, 0);
+    bytes_released += bytes;
+  }
+  return bytes_released;
+}
+
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
@@ -517,6 +651,84 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+bool BFCAllocator::ShouldCompact() {
+  if (opts_.compaction_fragmentation_threshold <= 0) return false;
+  mutex_lock l(lock_);
+  if (*stats_.pool_bytes <= stats_.bytes_in_use) return false;
+  return GetFragmentation() > opts_.compaction_fragmentation_threshold;
+}
+
+BFCAllocator::ChunkHandle BFCAllocator::FindLowerFreeChunk(size_t size,
+                                                           const void* ptr) {
+  // The bins and the chunks in a bin are sorted by size, so the first chunk
+  // that fits is the best fit.
+  for (BinNum bin_num = BinNumForSize(size); bin_num < kNumBins; bin_num++) {
+    for (const ChunkHandle h : BinFromIndex(bin_num)->free_chunks) {
+      const Chunk* chunk = ChunkFromHandle(h);
+      // Chunks freed at a count may still be in use on the device.
+      if (chunk->size >= size && chunk->ptr < ptr &&
+          chunk->freed_at_count == 0) {
+        return h;
+      }
+    }
+  }
+  return kInvalidChunkHandle;
+}
+
+int64_t BFCAllocator::Compact(absl::Span<void* const> ptrs,
+                              const RelocateFn& relocate) {
+  std::vector<void*> sorted_ptrs(ptrs.begin(), ptrs.end());
+  // Moving the highest allocations first frees the end of the regions.
+  std::sort(sorted_ptrs.begin(), sorted_ptrs.end(), std::greater<void*>());
+
+  mutex_lock l(lock_);
+  int64_t bytes_moved = 0;
+  for (void* ptr : sorted_ptrs) {
+    const ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    const size_t size = ChunkFromHandle(h)->size;
+    CHECK(ChunkFromHandle(h)->in_use() && ChunkFromHandle(h)->ptr == ptr);
+
+    const ChunkHandle h_new = FindLowerFreeChunk(size, ptr);
+    if (h_new == kInvalidChunkHandle) continue;
+    RemoveFreeChunkFromBin(h_new);
+    if (ChunkFromHandle(h_new)->size > size) {
+      SplitChunk(h_new, size);
+    }
+
+    // SplitChunk may have moved the chunks.
+    Chunk* chunk = ChunkFromHandle(h);
+    Chunk* new_chunk = ChunkFromHandle(h_new);
+    new_chunk->requested_size = chunk->requested_size;
+    new_chunk->allocation_id = chunk->allocation_id;
+#ifdef TENSORFLOW_MEM_DEBUG
+    new_chunk->op_name = chunk->op_name;
+    new_chunk->step_id = chunk->step_id;
+#endif
+    stats_.bytes_in_use += size;
+    RecordMemoryEvent(MemoryEventType::kAllocate, new_chunk->ptr, size,
+                      new_chunk->requested_size);
+
+    // Free the chunk that is left, the same way as DeallocateRawInternal.
+    ChunkHandle h_free = h_new;
+    if (relocate(new_chunk->ptr, ptr, size)) {
+      VLOG(4) << "Compact moved " << size << " bytes from " << ptr << " to "
+              << new_chunk->ptr;
+      h_free = h;
+      bytes_moved += size;
+    }
+    MarkFree(h_free);
+    if (timing_counter_) {
+      InsertFreeChunkIntoBin(h_free);
+      timestamped_chunks_.push_back(h_free);
+    } else {
+      InsertFreeChunkIntoBin(TryToCoalesce(h_free, false));
+    }
+  }
+  VLOG(1) << "Compact moved " << bytes_moved << " bytes of " << Name();
+  return bytes_moved;
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -611,6 +823,8 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        RecordMemoryEvent(MemoryEventType::kAllocate, chunk->ptr, chunk->size,
+                          num_bytes);
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -719,6 +933,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
 
+  if (opts_.release_idle_memory_micros > 0) {
+    MaybeReleaseIdleMemory(chunk_ptr, alloc_bytes);
+  }
+
   // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
   // correct aggregation stats (bytes_in_use, fragmentation).
   AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
@@ -811,6 +1029,8 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  RecordMemoryEvent(MemoryEventType::kDeallocate, c->ptr, c->size,
+                    c->requested_size);
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -1117,6 +1337,12 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
   LOG(INFO) << "Stats: \n" << stats_.DebugString();
+  if (!memory_events_.empty() && std::getenv("TF_BFC_MEMORY_DUMP") == nullptr) {
+    LOG(INFO) << "Set TF_BFC_MEMORY_DUMP to write the "
+              << std::min<int64_t>(num_memory_events_, memory_events_.size())
+              << " recorded memory events on OOM, see bfc_dump_reader "
+                 "--timeline.";
+  }
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1144,6 +1370,38 @@ MemoryDump BFCAllocator::RecordMemoryMap() {
   return RecordMemoryMapInternal();
 }
 
+void BFCAllocator::RecordMemoryEvent(MemoryEventType type, const void* ptr,
+                                     int64_t size, int64_t requested_size) {
+  if (memory_events_.empty()) return;
+  MemoryEvent& event =
+      memory_events_[num_memory_events_++ % memory_events_.size()];
+  event.type = type;
+  event.op_name_id = -1;
+  event.step_id = 0;
+  if (type == MemoryEventType::kAllocate) {
+    const auto& annotation =
+        profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+    if (annotation.pending_op_name != nullptr) {
+      const absl::string_view op_name = annotation.pending_op_name;
+      auto it = op_name_ids_.find(op_name);
+      if (it == op_name_ids_.end()) {
+        it = op_name_ids_
+                 .emplace(string(op_name), static_cast<int32>(op_names_.size()))
+                 .first;
+        op_names_.push_back(it->first);
+      }
+      event.op_name_id = it->second;
+    }
+    event.step_id = annotation.pending_step_id;
+  }
+  event.timestamp_micros = Env::Default()->NowMicros();
+  event.ptr = ptr;
+  event.size = size;
+  event.requested_size = requested_size;
+  event.bytes_in_use = stats_.bytes_in_use;
+  event.pool_bytes = *stats_.pool_bytes;
+}
+
 MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   MemoryDump md;
   md.set_allocator_name(Name());
@@ -1207,6 +1465,24 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   }
 #endif
 
+  for (int64_t i = std::max<int64_t>(
+           num_memory_events_ - static_cast<int64_t>(memory_events_.size()), 0);
+       i < num_memory_events_; ++i) {
+    const MemoryEvent& event = memory_events_[i % memory_events_.size()];
+    tensorflow::MemEvent* me = md.add_event();
+    me->set_type(static_cast<tensorflow::MemEvent::Type>(event.type));
+    me->set_timestamp_micros(event.timestamp_micros);
+    me->set_address(reinterpret_cast<uint64>(event.ptr));
+    me->set_size(event.size);
+    me->set_requested_size(event.requested_size);
+    if (event.op_name_id >= 0) {
+      me->set_op_name(op_names_[event.op_name_id]);
+    }
+    me->set_step_id(event.step_id);
+    me->set_bytes_in_use(event.bytes_in_use);
+    me->set_pool_bytes(event.pool_bytes);
+  }
+
   return md;
 }
 
@@ -18,12 +18,15 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
 #include "tsl/framework/shared_counter.h"
@@ -68,6 +71,20 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If > 0, ShouldCompact() returns true once the fraction of the free
+    // memory that is not part of the largest free chunk exceeds it.
+    double compaction_fragmentation_threshold = 0;
+
+    // If > 0, the free memory at the end of the regions that stays idle for
+    // this long is returned to the sub-allocator, see ReleaseFreeMemory().
+    // Checked when memory is freed.
+    int64_t release_idle_memory_micros = 0;
+
+    // If > 0, the allocator keeps the most recent allocations, deallocations
+    // and changes of its memory pool, up to this many, which are part of the
+    // MemoryDump of RecordMemoryMap() and of the dump written on OOM.
+    size_t memory_event_history_size = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,6 +124,32 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Copies `num_bytes` from `src` to `dst` in the memory of this allocator, and
+  // makes the owner of the allocation at `src` refer to `dst` instead. Returns
+  // false if the allocation cannot move, in which case it stays at `src`.
+  // Must not call this allocator.
+  using RelocateFn =
+      std::function<bool(void* dst, const void* src, size_t num_bytes)>;
+
+  // Returns true if the free memory is fragmented enough for Compact() to run,
+  // see Options::compaction_fragmentation_threshold.
+  bool ShouldCompact();
+
+  // Moves the allocations of `ptrs`, which the caller can relocate, to free
+  // chunks at lower addresses, so that the free memory coalesces at the end of
+  // the regions. The allocations must not be in use, e.g. by pending kernels,
+  // until Compact() returns. Returns the number of bytes moved.
+  int64_t Compact(absl::Span<void* const> ptrs, const RelocateFn& relocate);
+
+  // Returns the free memory at the end of the regions to the sub-allocator,
+  // until at least `num_bytes` are released or none is left, and returns the
+  // bytes released. The memory is released in the units it was allocated from
+  // the sub-allocator, so a sub-allocator that supports coalescing, e.g. one
+  // that maps physical memory into a reserved address range, can shrink a
+  // region from its end. Lets the processes sharing a device reclaim memory
+  // from each other.
+  size_t ReleaseFreeMemory(size_t num_bytes);
+
  private:
   struct Bin;
 
@@ -311,6 +354,14 @@ class BFCAllocator : public Allocator {
     void* ptr() const { return ptr_; }
     void* end_ptr() const { return end_ptr_; }
     size_t memory_size() const { return memory_size_; }
+    void shrink(size_t size) {
+      DCHECK_LT(size, memory_size_);
+      memory_size_ -= size;
+      DCHECK_EQ(0, memory_size_ % kMinAllocationSize);
+
+      end_ptr_ = static_cast<void*>(static_cast<char*>(end_ptr_) - size);
+      handles_.resize(memory_size_ / kMinAllocationSize);
+    }
     void extend(size_t size) {
       memory_size_ += size;
       DCHECK_EQ(0, memory_size_ % kMinAllocationSize);
@@ -409,6 +460,8 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    std::vector<AllocationRegion>& mutable_regions() { return regions_; }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -466,6 +519,21 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Releases the free memory at the end of the regions, which is idle for
+  // opts_.release_idle_memory_micros if `only_idle`, until at least
+  // `num_bytes` are released. Returns the bytes released.
+  size_t ReleaseTrailingFreeMemory(size_t num_bytes, bool only_idle)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Releases the idle free memory if it was not checked recently.
+  void MaybeReleaseIdleMemory(const void* freed_ptr, size_t freed_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the best-fitting free chunk of at least `size` bytes below `ptr`,
+  // or kInvalidChunkHandle if there is none.
+  ChunkHandle FindLowerFreeChunk(size_t size, const void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -502,6 +570,20 @@ class BFCAllocator : public Allocator {
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void MaybeWriteMemoryMap() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // The types of tensorflow::MemEvent, in the same order.
+  enum class MemoryEventType : int8 {
+    kAllocate,
+    kDeallocate,
+    kExtend,
+    kRelease,
+  };
+
+  // Records an event in memory_events_, if
+  // opts_.memory_event_history_size > 0.
+  void RecordMemoryEvent(MemoryEventType type, const void* ptr,
+                         int64_t size, int64_t requested_size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle AllocateChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void DeallocateChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -591,6 +673,20 @@ class BFCAllocator : public Allocator {
   const bool coalesce_regions_;
 
   std::unique_ptr<SubAllocator> sub_allocator_;
+
+  // The memory allocated from the sub-allocator, sorted by address, which may
+  // be coalesced into fewer regions.
+  struct SubAllocation {
+    void* ptr;
+    size_t size;
+    // Whether its memory was freed since the last check for idle memory.
+    bool freed_since_check;
+    // When it was found free at the end of its region, or 0.
+    uint64 idle_since_micros;
+  };
+  std::vector<SubAllocation> sub_allocations_ TF_GUARDED_BY(lock_);
+  uint64 next_idle_check_micros_ TF_GUARDED_BY(lock_) = 0;
+
   string name_;
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
@@ -612,6 +708,26 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // A ring buffer of the most recent events. Their op names are interned in
+  // op_names_, which are indexed by op_name_ids_.
+  struct MemoryEvent {
+    MemoryEventType type;
+    // The index of the op name in op_names_, or -1.
+    int32 op_name_id;
+    uint64 timestamp_micros;
+    const void* ptr;
+    int64_t size;
+    int64_t requested_size;
+    uint64 step_id;
+    int64_t bytes_in_use;
+    int64_t pool_bytes;
+  };
+  std::vector<MemoryEvent> memory_events_ TF_GUARDED_BY(lock_);
+  int64_t num_memory_events_ TF_GUARDED_BY(lock_) = 0;
+  std::vector<string> op_names_ TF_GUARDED_BY(lock_);
+  absl::flat_hash_map<string, int32> op_name_ids_ TF_GUARDED_BY(lock_);
+
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -0,0 +1,367 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/bgzf.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tsl/platform/coding.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// Size of the gzip header up to and including the length of the extra field.
+constexpr size_t kFixedHeaderSize = 12;
+// Size of the CRC32 and ISIZE fields that end every block.
+constexpr size_t kFooterSize = 8;
+// Number of blocks inflated by each thread per batch.
+constexpr int kBlocksPerThread = 16;
+// Rough number of cycles needed to inflate a full block.
+constexpr int64_t kInflateCostPerBlock = 1 << 18;
+
+// Returns the size of the gzip member starting with `header`, i.e. of its
+// header and `extra` field, or 0 if the member has no 'BC' extra subfield.
+size_t GetBlockSize(StringPiece header, StringPiece extra) {
+  if (header.size() < kFixedHeaderSize ||
+      static_cast<uint8>(header[0]) != 0x1f ||
+      static_cast<uint8>(header[1]) != 0x8b || header[2] != Z_DEFLATED ||
+      (header[3] & 0x04) == 0) {
+    return 0;
+  }
+  while (extra.size() >= 4) {
+    const size_t length = core::DecodeFixed16(extra.data() + 2);
+    if (extra.size() < 4 + length) return 0;
+    if (extra[0] == 'B' && extra[1] == 'C' && length == 2) {
+      return core::DecodeFixed16(extra.data() + 4) + 1;
+    }
+    extra.remove_prefix(4 + length);
+  }
+  return 0;
+}
+
+// Inflates `block` into the `output_size` bytes at `output`.
+Status InflateBlock(StringPiece block, char* output, size_t output_size) {
+  const size_t header_size =
+      kFixedHeaderSize + core::DecodeFixed16(block.data() + 10);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib: ", stream.msg);
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(block.data() + header_size));
+  stream.avail_in = block.size() - header_size - kFooterSize;
+  stream.next_out = reinterpret_cast<Bytef*>(output);
+  stream.avail_out = output_size;
+  const int error = inflate(&stream, Z_FINISH);
+  const size_t inflated_size = stream.total_out;
+  inflateEnd(&stream);
+  if (error != Z_STREAM_END || inflated_size != output_size) {
+    return errors::DataLoss("Corrupt BGZF block");
+  }
+  const uint32 crc = core::DecodeFixed32(block.end() - kFooterSize);
+  if (crc32(0, reinterpret_cast<const Bytef*>(output), output_size) != crc) {
+    return errors::DataLoss("Checksum mismatch in BGZF block");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+bool IsBgzfHeader(StringPiece header) {
+  if (header.size() < kBgzfHeaderSize) return false;
+  const size_t extra_size = core::DecodeFixed16(header.data() + 10);
+  return GetBlockSize(header.substr(0, kFixedHeaderSize),
+                      header.substr(kFixedHeaderSize,
+                                    std::min<size_t>(extra_size, 6))) > 0;
+}
+
+bool IsBgzfFile(RandomAccessFile* file) {
+  char scratch[kBgzfHeaderSize];
+  StringPiece header;
+  Status s = file->Read(0, kBgzfHeaderSize, &header, scratch);
+  return (s.ok() || errors::IsOutOfRange(s)) && IsBgzfHeader(header);
+}
+
+BgzfOutputBuffer::BgzfOutputBuffer(WritableFile* file,
+                                   const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      zlib_options_(zlib_options),
+      block_(new char[kBgzfMaxBlockSize]) {
+  input_.reserve(kBgzfMaxBlockInputSize);
+}
+
+BgzfOutputBuffer::~BgzfOutputBuffer() {
+  if (!closed_) {
+    LOG(WARNING) << "BgzfOutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status BgzfOutputBuffer::WriteBlock() {
+  char* block = block_.get();
+  int compression_level = zlib_options_.compression_level;
+  size_t compressed_size;
+  while (true) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, compression_level, Z_DEFLATED, -MAX_WBITS,
+                     zlib_options_.mem_level,
+                     zlib_options_.compression_strategy) != Z_OK) {
+      return errors::Internal("Failed to initialize zlib: ", stream.msg);
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(input_.data());
+    stream.avail_in = input_.size();
+    stream.next_out = reinterpret_cast<Bytef*>(block + kBgzfHeaderSize);
+    stream.avail_out = kBgzfMaxBlockSize - kBgzfHeaderSize - kFooterSize;
+    const int error = deflate(&stream, Z_FINISH);
+    compressed_size = stream.total_out;
+    deflateEnd(&stream);
+    if (error == Z_STREAM_END) break;
+    if (compression_level == 0 || (error != Z_OK && error != Z_BUF_ERROR)) {
+      return errors::DataLoss("Failed to deflate a BGZF block: ", error);
+    }
+    // The input did not compress well enough to fit in a block, so it is
+    // stored instead.
+    compression_level = 0;
+  }
+
+  const size_t block_size = kBgzfHeaderSize + compressed_size + kFooterSize;
+  static constexpr char kHeader[kBgzfHeaderSize - 2] = {
+      '\x1f', '\x8b', Z_DEFLATED, '\x04', 0, 0, 0, 0,  // magic, FEXTRA, MTIME
+      0,      '\xff', 6,          0,                   // XFL, OS, XLEN
+      'B',    'C',    2,          0};                  // 'BC' subfield
+  memcpy(block, kHeader, sizeof(kHeader));
+  core::EncodeFixed16(block + sizeof(kHeader), block_size - 1);
+  char* footer = block + kBgzfHeaderSize + compressed_size;
+  core::EncodeFixed32(
+      footer, crc32(0, reinterpret_cast<const Bytef*>(input_.data()),
+                    input_.size()));
+  core::EncodeFixed32(footer + 4, input_.size());
+  input_.clear();
+  return file_->Append(StringPiece(block, block_size));
+}
+
+Status BgzfOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("BgzfOutputBuffer is closed");
+  }
+  while (!data.empty()) {
+    const size_t size =
+        std::min(data.size(), kBgzfMaxBlockInputSize - input_.size());
+    input_.append(data.data(), size);
+    data.remove_prefix(size);
+    if (input_.size() == kBgzfMaxBlockInputSize) {
+      TF_RETURN_IF_ERROR(WriteBlock());
+    }
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status BgzfOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status BgzfOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("BgzfOutputBuffer is closed");
+  }
+  if (!input_.empty()) {
+    TF_RETURN_IF_ERROR(WriteBlock());
+  }
+  return file_->Flush();
+}
+
+Status BgzfOutputBuffer::Close() {
+  if (closed_) return OkStatus();
+  if (!input_.empty()) {
+    TF_RETURN_IF_ERROR(WriteBlock());
+  }
+  // The empty block marks the end of the stream.
+  TF_RETURN_IF_ERROR(WriteBlock());
+  closed_ = true;
+  return OkStatus();
+}
+
+Status BgzfOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status BgzfOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status BgzfOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+BgzfInputStream::BgzfInputStream(InputStreamInterface* input_stream,
+                                 int num_threads, bool owns_input_stream)
+    : input_stream_(input_stream),
+      owns_input_stream_(owns_input_stream),
+      num_threads_(std::max(num_threads, 1)) {
+  if (num_threads_ > 1) {
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "bgzf_inflate", num_threads_);
+  }
+}
+
+BgzfInputStream::~BgzfInputStream() {
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status BgzfInputStream::ReadBlock(std::string* block) {
+  // Reads exactly `size` bytes, which are part of the current block.
+  auto read_block_bytes = [this](size_t size, tstring* bytes) {
+    Status s = input_stream_->ReadNBytes(size, bytes);
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("Truncated BGZF block");
+    }
+    return s;
+  };
+
+  tstring header;
+  Status s = input_stream_->ReadNBytes(kFixedHeaderSize, &header);
+  if (errors::IsOutOfRange(s) && header.empty()) return s;
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated BGZF block");
+  }
+  TF_RETURN_IF_ERROR(s);
+  tstring extra;
+  if (header[0] == '\x1f' && header[1] == '\x8b') {
+    TF_RETURN_IF_ERROR(
+        read_block_bytes(core::DecodeFixed16(header.data() + 10), &extra));
+  }
+  const size_t block_size = GetBlockSize(header, extra);
+  if (block_size == 0) {
+    return errors::DataLoss("Not a BGZF block at offset ",
+                            input_stream_->Tell() - header.size() -
+                                extra.size());
+  }
+  if (block_size < header.size() + extra.size() + kFooterSize) {
+    return errors::DataLoss("Invalid BGZF block size: ", block_size);
+  }
+  tstring data;
+  TF_RETURN_IF_ERROR(read_block_bytes(
+      block_size - header.size() - extra.size(), &data));
+  block->clear();
+  block->reserve(block_size);
+  block->append(header.data(), header.size());
+  block->append(extra.data(), extra.size());
+  block->append(data.data(), data.size());
+  return OkStatus();
+}
+
+Status BgzfInputStream::ReadBatch() {
+  const size_t max_blocks = kBlocksPerThread * num_threads_;
+  blocks_.resize(max_blocks);
+  size_t num_blocks = 0;
+  while (num_blocks < max_blocks) {
+    Status s = ReadBlock(&blocks_[num_blocks]);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    ++num_blocks;
+  }
+  if (num_blocks == 0) {
+    return errors::OutOfRange("End of BGZF stream");
+  }
+
+  // The inflated size of every block is in its footer, so the blocks are
+  // inflated directly into their place in `output_`.
+  std::vector<size_t> offsets(num_blocks + 1, 0);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    const size_t inflated_size =
+        core::DecodeFixed32(blocks_[i].data() + blocks_[i].size() - 4);
+    if (inflated_size > kBgzfMaxBlockSize) {
+      return errors::DataLoss("Invalid inflated BGZF block size: ",
+                              inflated_size);
+    }
+    offsets[i + 1] = offsets[i] + inflated_size;
+  }
+  output_.resize(offsets.back());
+  output_pos_ = 0;
+  std::vector<Status> statuses(num_blocks);
+  auto inflate_blocks = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      statuses[i] = InflateBlock(blocks_[i], output_.data() + offsets[i],
+                                 offsets[i + 1] - offsets[i]);
+    }
+  };
+  if (thread_pool_ != nullptr) {
+    thread_pool_->ParallelFor(num_blocks, kInflateCostPerBlock,
+                              inflate_blocks);
+  } else {
+    inflate_blocks(0, num_blocks);
+  }
+  for (const Status& status : statuses) {
+    if (!status.ok()) {
+      output_.clear();
+      return status;
+    }
+  }
+  return OkStatus();
+}
+
+Status BgzfInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (output_pos_ == output_.size()) {
+      Status s = ReadBatch();
+      if (errors::IsOutOfRange(s)) {
+        return errors::OutOfRange("End of BGZF stream reached");
+      }
+      TF_RETURN_IF_ERROR(s);
+      continue;
+    }
+    const size_t size = std::min(bytes_to_read - result->size(),
+                                 output_.size() - output_pos_);
+    result->append(output_.data() + output_pos_, size);
+    output_pos_ += size;
+    bytes_read_ += size;
+  }
+  return OkStatus();
+}
+
+int64_t BgzfInputStream::Tell() const { return bytes_read_; }
+
+Status BgzfInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  output_.clear();
+  output_pos_ = 0;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
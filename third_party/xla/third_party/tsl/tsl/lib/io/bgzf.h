@@ -0,0 +1,164 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_BGZF_H_
+#define TENSORFLOW_TSL_LIB_IO_BGZF_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Support for blocked gzip (BGZF) streams, as used by samtools and htslib.
+//
+// A BGZF stream is a series of independent gzip members of at most
+// kBgzfMaxBlockSize bytes. The header of each member carries an extra field
+// ('B', 'C') holding the size of the member, so the members can be found
+// without inflating them. Any gzip reader, including ZlibInputStream, can
+// still inflate the stream serially.
+
+// Size of the header written in front of every block.
+constexpr size_t kBgzfHeaderSize = 18;
+// Maximum size of a compressed block, header and footer included.
+constexpr size_t kBgzfMaxBlockSize = 1 << 16;
+// Maximum number of uncompressed bytes deflated into one block, chosen so that
+// even incompressible input always fits in a block.
+constexpr size_t kBgzfMaxBlockInputSize = 0xff00;
+
+// Returns true if `header` starts with the header of a BGZF block.
+bool IsBgzfHeader(StringPiece header);
+
+// Returns true if `file` starts with a BGZF block.
+bool IsBgzfFile(RandomAccessFile* file);
+
+// Writes the data appended to it to `file` as a BGZF stream. Every Flush()
+// ends the current block, and Close() appends the empty end-of-file block.
+//
+// A given instance of a BgzfOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class BgzfOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`. Only the compression_level, mem_level
+  // and compression_strategy of `zlib_options` are used.
+  BgzfOutputBuffer(WritableFile* file,
+                   const ZlibCompressionOptions& zlib_options);
+
+  ~BgzfOutputBuffer() override;
+
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Deflates any cached input into a block and flushes the file.
+  Status Flush() override;
+
+  // Deflates any cached input and writes the end-of-file block. This must be
+  // called before the destructor to avoid any data loss. Does not close the
+  // file. Any further call to `Append()` or `Flush()` fails.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Deflates any cached input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect cached, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Deflates `input_` into a block, even if it is empty, and appends the block
+  // to `file_`.
+  Status WriteBlock();
+
+  WritableFile* file_;  // Not owned
+  const ZlibCompressionOptions zlib_options_;
+  std::string input_;
+  std::unique_ptr<char[]> block_;
+  bool closed_ = false;
+
+  BgzfOutputBuffer(const BgzfOutputBuffer&) = delete;
+  void operator=(const BgzfOutputBuffer&) = delete;
+};
+
+// An InputStreamInterface that inflates a BGZF stream read from another
+// InputStreamInterface. The compressed blocks are read sequentially in batches,
+// and the blocks of a batch are inflated in parallel.
+//
+// A given instance of a BgzfInputStream is NOT safe for concurrent use by
+// multiple threads.
+class BgzfInputStream : public InputStreamInterface {
+ public:
+  // Inflates the blocks of `input_stream` with `num_threads` threads. Takes
+  // ownership of `input_stream` iff `owns_input_stream` is true.
+  BgzfInputStream(InputStreamInterface* input_stream, int num_threads,
+                  bool owns_input_stream);
+
+  ~BgzfInputStream() override;
+
+  // Reads `bytes_to_read` inflated bytes. Returns OUT_OF_RANGE, with the
+  // remaining bytes in `result`, at the end of the stream, and DATA_LOSS if
+  // the stream is not a valid BGZF stream.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  // Returns the number of inflated bytes read so far.
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Reads the next batch of blocks from `input_stream_` and inflates them into
+  // `output_`. Returns OUT_OF_RANGE if there are no more blocks.
+  Status ReadBatch();
+
+  // Reads the next compressed block into `block`. Returns OUT_OF_RANGE if the
+  // stream ends before the block.
+  Status ReadBlock(std::string* block);
+
+  InputStreamInterface* input_stream_;
+  const bool owns_input_stream_;
+  const int num_threads_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // The compressed blocks of the current batch.
+  std::vector<std::string> blocks_;
+  // The inflated contents of the current batch, and the read position in it.
+  std::string output_;
+  size_t output_pos_ = 0;
+  int64_t bytes_read_ = 0;
+
+  BgzfInputStream(const BgzfInputStream&) = delete;
+  void operator=(const BgzfInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_BGZF_H_
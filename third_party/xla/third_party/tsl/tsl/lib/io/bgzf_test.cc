@@ -0,0 +1,144 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/bgzf.h"
+
+#include <memory>
+#include <string>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/lib/io/zlib_inputstream.h"
+#include "tsl/lib/io/zlib_outputbuffer.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/random.h"
+#include "tsl/platform/strcat.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// Returns `size` bytes that compress reasonably well, followed by `size` random
+// bytes, which do not compress at all.
+string GenTestString(size_t size) {
+  string result;
+  for (size_t i = 0; result.size() < size; ++i) {
+    strings::StrAppend(&result, "record ", i, " ");
+  }
+  result.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    result.push_back(static_cast<char>(random::New64()));
+  }
+  return result;
+}
+
+void WriteBgzfFile(const string& fname, const string& data) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  BgzfOutputBuffer out(file.get(), ZlibCompressionOptions::GZIP());
+  // Appends in uneven pieces, with a flush, so that blocks of all kinds of
+  // sizes are written.
+  for (size_t pos = 0; pos < data.size(); pos += 12345) {
+    TF_ASSERT_OK(out.Append(StringPiece(data).substr(pos, 12345)));
+    if (pos == 12345 * 10) TF_ASSERT_OK(out.Flush());
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file->Close());
+}
+
+TEST(BgzfTest, ReadsInParallel) {
+  const string data = GenTestString(1 << 20);
+  string fname = testing::TmpDir() + "/bgzf_parallel_test";
+  WriteBgzfFile(fname, data);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  EXPECT_TRUE(IsBgzfFile(file.get()));
+  for (int num_threads : {1, 4}) {
+    BgzfInputStream in(new RandomAccessInputStream(file.get()), num_threads,
+                       true);
+    tstring result;
+    TF_ASSERT_OK(in.ReadNBytes(1000, &result));
+    EXPECT_EQ(data.substr(0, 1000), result);
+    TF_ASSERT_OK(in.ReadNBytes(data.size() - 2000, &result));
+    EXPECT_EQ(data.substr(1000, data.size() - 2000), result);
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(2000, &result)));
+    EXPECT_EQ(data.substr(data.size() - 1000), result);
+    EXPECT_EQ(static_cast<int64_t>(data.size()), in.Tell());
+
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.ReadNBytes(10, &result));
+    EXPECT_EQ(data.substr(0, 10), result);
+  }
+}
+
+TEST(BgzfTest, ReadableAsGzip) {
+  const string data = GenTestString(1 << 18);
+  string fname = testing::TmpDir() + "/bgzf_gzip_test";
+  WriteBgzfFile(fname, data);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  RandomAccessInputStream input_stream(file.get());
+  ZlibInputStream in(&input_stream, 1 << 16, 1 << 16,
+                     ZlibCompressionOptions::GZIP());
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(data, result);
+}
+
+TEST(BgzfTest, RejectsPlainGzip) {
+  string fname = testing::TmpDir() + "/bgzf_plain_gzip_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+    ZlibOutputBuffer out(file.get(), 1 << 10, 1 << 10,
+                         ZlibCompressionOptions::GZIP());
+    TF_ASSERT_OK(out.Init());
+    TF_ASSERT_OK(out.Append(GenTestString(1 << 10)));
+    TF_ASSERT_OK(out.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  EXPECT_FALSE(IsBgzfFile(file.get()));
+  BgzfInputStream in(new RandomAccessInputStream(file.get()), 2, true);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(10, &result)));
+}
+
+TEST(BgzfTest, DetectsCorruption) {
+  const string data = GenTestString(1 << 16);
+  string fname = testing::TmpDir() + "/bgzf_corruption_test";
+  WriteBgzfFile(fname, data);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  contents[kBgzfHeaderSize + 100] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  BgzfInputStream in(new RandomAccessInputStream(file.get()), 2, true);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(data.size(), &result)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
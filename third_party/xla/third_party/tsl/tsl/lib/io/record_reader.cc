@@ -16,6 +16,9 @@ limitations under the License.
 #include "tsl/lib/io/record_reader.h"
 
 #include <limits.h>
+#if !defined(IS_SLIM_BUILD)
+#include <zlib.h>
+#endif  // IS_SLIM_BUILD
 
 #include "tsl/lib/hash/crc32c.h"
 #include "tsl/lib/io/buffered_inputstream.h"
@@ -24,6 +27,9 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tsl/lib/io/bgzf.h"
+#endif  // IS_SLIM_BUILD
 
 namespace tsl {
 namespace io {
@@ -68,7 +74,14 @@ RecordReader::RecordReader(RandomAccessFile* file,
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (options.compression_type == RecordReaderOptions::ZLIB_COMPRESSION) {
+  if (options.compression_type == RecordReaderOptions::ZLIB_COMPRESSION &&
+      options.zlib_options.num_inflate_threads > 1 &&
+      options.zlib_options.window_bits > MAX_WBITS && IsBgzfFile(file)) {
+    input_stream_.reset(new BgzfInputStream(
+        input_stream_.release(), options.zlib_options.num_inflate_threads,
+        true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZLIB_COMPRESSION) {
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
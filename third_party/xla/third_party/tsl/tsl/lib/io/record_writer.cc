@@ -19,6 +19,9 @@ limitations under the License.
 #include "tsl/lib/io/compression.h"
 #include "tsl/platform/coding.h"
 #include "tsl/platform/env.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tsl/lib/io/bgzf.h"
+#endif  // IS_SLIM_BUILD
 
 namespace tsl {
 namespace io {
@@ -65,7 +68,10 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (IsZlibCompressed(options)) {
+  if (IsZlibCompressed(options) && options.zlib_options.independent_blocks &&
+      options.zlib_options.window_bits > MAX_WBITS) {
+    dest_ = new BgzfOutputBuffer(dest, options.zlib_options);
+  } else if (IsZlibCompressed(options)) {
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
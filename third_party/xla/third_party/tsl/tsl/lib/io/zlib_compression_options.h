@@ -117,6 +117,21 @@ class ZlibCompressionOptions {
   //
   // This option is ignored for `ZlibOutputBuffer`.
   bool soft_fail_on_error = false;  // NOLINT
+
+  // When this is set to true and window_bits selects gzip encoding,
+  // RecordWriter writes a blocked gzip (BGZF) stream: a series of independent
+  // gzip members of up to 64KB, each of which records its own size. Any gzip
+  // reader can still inflate the stream, and RecordReader can inflate its
+  // blocks in parallel. Defaults to false.
+  //
+  // This option is ignored for `ZlibInputStream` and `ZlibOutputBuffer`.
+  bool independent_blocks = false;  // NOLINT
+
+  // Number of threads that RecordReader uses to inflate a BGZF stream. Other
+  // gzip and zlib streams are always inflated serially. Defaults to 1.
+  //
+  // This option is ignored for `ZlibInputStream` and `ZlibOutputBuffer`.
+  int32 num_inflate_threads = 1;
 };
 
 inline ZlibCompressionOptions ZlibCompressionOptions::DEFAULT() {
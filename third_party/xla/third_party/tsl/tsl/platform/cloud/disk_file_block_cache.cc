@@ -0,0 +1,289 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/hash.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/strcat.h"
+
+namespace tsl {
+
+namespace {
+
+// The suffix of the blocks being written, which are renamed once complete.
+constexpr char kTempSuffix[] = ".tmp";
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(const string& cache_dir,
+                                       size_t block_size, size_t max_bytes,
+                                       BlockFetcher block_fetcher, Env* env)
+    : cache_dir_(cache_dir),
+      block_size_(block_size),
+      max_bytes_(max_bytes),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  if (block_size_ == 0 || max_bytes_ == 0 || cache_dir_.empty()) {
+    return;
+  }
+  Status status = env_->RecursivelyCreateDir(cache_dir_);
+  if (!status.ok()) {
+    LOG(WARNING) << "Disabling the disk block cache in " << cache_dir_ << ": "
+                 << status;
+    return;
+  }
+  enabled_ = true;
+  LoadIndex();
+}
+
+string DiskFileBlockCache::BlockName(const string& filename, int64_t signature,
+                                     size_t offset) const {
+  return strings::StrCat(
+      strings::Hex(Hash64(filename), strings::kZeroPad16), "_",
+      strings::Hex(signature, strings::kZeroPad16), "_",
+      strings::Hex(block_size_), "_", strings::Hex(offset));
+}
+
+void DiskFileBlockCache::LoadIndex() {
+  std::vector<string> children;
+  Status status = env_->GetChildren(cache_dir_, &children);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to list the disk block cache in " << cache_dir_
+                 << ": " << status;
+    return;
+  }
+  // The blocks sorted by modification time.
+  std::vector<std::tuple<int64_t, string, size_t>> blocks;
+  for (const string& name : children) {
+    const string path = io::JoinPath(cache_dir_, name);
+    if (absl::EndsWith(name, kTempSuffix)) {
+      // Left by a process that died while writing the block.
+      env_->DeleteFile(path).IgnoreError();
+      continue;
+    }
+    FileStatistics stat;
+    if (env_->Stat(path, &stat).ok() && !stat.is_directory) {
+      blocks.emplace_back(stat.mtime_nsec, name, stat.length);
+    }
+  }
+  std::sort(blocks.begin(), blocks.end());
+  mutex_lock lock(mu_);
+  for (const auto& block : blocks) {
+    const string& name = std::get<1>(block);
+    lru_list_.push_front(name);
+    index_[name] = Entry{std::get<2>(block), lru_list_.begin()};
+    cache_size_ += std::get<2>(block);
+  }
+  Trim_Locked();
+  VLOG(1) << "Loaded " << index_.size() << " blocks (" << cache_size_
+          << " bytes) from the disk block cache in " << cache_dir_;
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return OkStatus();
+  }
+  int64_t signature = 0;
+  bool known_signature = false;
+  if (enabled_) {
+    tf_shared_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it != file_signature_map_.end()) {
+      signature = it->second;
+      known_signature = true;
+    }
+  }
+  if (!known_signature) {
+    // Without a signature, a cached block might be stale.
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  string data;
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    TF_RETURN_IF_ERROR(ReadBlock(filename, signature, pos, &data));
+    if (offset >= pos + data.size()) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    size_t begin = offset > pos ? offset - pos : 0;
+    size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], &data[begin], end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return OkStatus();
+}
+
+Status DiskFileBlockCache::ReadBlock(const string& filename, int64_t signature,
+                                     size_t offset, string* data) {
+  const string name = BlockName(filename, signature, offset);
+  bool cached = false;
+  {
+    mutex_lock lock(mu_);
+    if (index_.count(name) > 0) {
+      Touch_Locked(name);
+      cached = true;
+    }
+  }
+  if (cached) {
+    Status status =
+        ReadFileToString(env_, io::JoinPath(cache_dir_, name), data);
+    if (status.ok()) {
+      if (cache_stats_ != nullptr) {
+        cache_stats_->RecordCacheHitBlockSize(data->size());
+      }
+      return OkStatus();
+    }
+    // The block was evicted since the lookup, or deleted by another process.
+    VLOG(1) << "Failed to read block " << name << " from the disk: " << status;
+    mutex_lock lock(mu_);
+    if (index_.count(name) > 0) {
+      Evict_Locked(name);
+    }
+  }
+  data->resize(block_size_);
+  size_t bytes_transferred = 0;
+  TF_RETURN_IF_ERROR(block_fetcher_(filename, offset, block_size_,
+                                    &(*data)[0], &bytes_transferred));
+  data->resize(bytes_transferred);
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+  }
+  WriteBlock(name, *data);
+  return OkStatus();
+}
+
+void DiskFileBlockCache::WriteBlock(const string& name, const string& data) {
+  const string path = io::JoinPath(cache_dir_, name);
+  // Concurrent writers of the same block use distinct temporary files, and the
+  // rename makes complete blocks visible atomically.
+  const string temp_path = strings::StrCat(
+      path, ".", env_->GetCurrentThreadId(), "_", env_->NowMicros(),
+      kTempSuffix);
+  Status status = WriteStringToFile(env_, temp_path, data);
+  if (status.ok()) {
+    status = env_->RenameFile(temp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write block " << name
+                 << " to the disk block cache: " << status;
+    env_->DeleteFile(temp_path).IgnoreError();
+    return;
+  }
+  mutex_lock lock(mu_);
+  if (index_.count(name) > 0) {
+    Touch_Locked(name);
+    return;
+  }
+  lru_list_.push_front(name);
+  index_[name] = Entry{data.size(), lru_list_.begin()};
+  cache_size_ += data.size();
+  Trim_Locked();
+}
+
+void DiskFileBlockCache::Touch_Locked(const string& name) {
+  Entry& entry = index_[name];
+  lru_list_.splice(lru_list_.begin(), lru_list_, entry.lru_iterator);
+}
+
+void DiskFileBlockCache::Evict_Locked(const string& name) {
+  auto it = index_.find(name);
+  cache_size_ -= it->second.size;
+  lru_list_.erase(it->second.lru_iterator);
+  index_.erase(it);
+  env_->DeleteFile(io::JoinPath(cache_dir_, name)).IgnoreError();
+}
+
+void DiskFileBlockCache::Trim_Locked() {
+  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
+    Evict_Locked(lru_list_.back());
+  }
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64_t file_signature) {
+  mutex_lock lock(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    // The blocks of other signatures are never read again.
+    RemoveFile_Locked(filename);
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  RemoveFile_Locked(filename);
+}
+
+void DiskFileBlockCache::RemoveFile_Locked(const string& filename) {
+  const string prefix = strings::StrCat(
+      strings::Hex(Hash64(filename), strings::kZeroPad16), "_");
+  auto it = index_.lower_bound(prefix);
+  while (it != index_.end() && absl::StartsWith(it->first, prefix)) {
+    const string name = (it++)->first;
+    Evict_Locked(name);
+  }
+}
+
+void DiskFileBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  while (!lru_list_.empty()) {
+    Evict_Locked(lru_list_.back());
+  }
+  file_signature_map_.clear();
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  tf_shared_lock lock(mu_);
+  return cache_size_;
+}
+
+}  // namespace tsl
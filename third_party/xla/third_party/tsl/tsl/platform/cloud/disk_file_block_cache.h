@@ -0,0 +1,171 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tsl/platform/cloud/file_block_cache.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+/// \brief An LRU block cache of file contents on a local disk, keyed by
+/// {filename, signature, offset}.
+///
+/// Blocks are stored as files in `cache_dir`, so that they survive the process
+/// and can be shared by the jobs of a host. The cache is meant to be a second
+/// tier below a RamFileBlockCache, for local SSDs which are much larger than
+/// the memory of a host but much faster than the remote filesystem.
+///
+/// The signature of a file (e.g. the generation of a GCS object) is part of
+/// the key, so a modified file never hits the blocks of its former contents.
+/// Reads of files whose signature is unknown, i.e. which were not passed to
+/// ValidateAndUpdateFileSignature, go straight to the block fetcher.
+///
+/// The cache is best effort: failures to write blocks to the disk are logged
+/// and do not fail reads.
+///
+/// This class is thread safe, but processes sharing `cache_dir` only learn
+/// about the blocks written by each other when they start.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  /// The callback executed when a block is not found in the cache, and needs
+  /// to be fetched from the backing filesystem. This callback is provided when
+  /// the cache is constructed. The returned Status should be OK as long as the
+  /// read from the remote filesystem succeeded (similar to the semantics of the
+  /// read(2) system call).
+  typedef std::function<Status(const string& filename, size_t offset,
+                               size_t buffer_size, char* buffer,
+                               size_t* bytes_transferred)>
+      BlockFetcher;
+
+  /// Creates a cache in `cache_dir`, which is created if it does not exist.
+  /// The blocks left in `cache_dir` by earlier processes are reused.
+  DiskFileBlockCache(const string& cache_dir, size_t block_size,
+                     size_t max_bytes, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  ~DiskFileBlockCache() override = default;
+
+  /// Read `n` bytes from `filename` starting at `offset` into `buffer`. This
+  /// method will return:
+  ///
+  /// 1) The error from the remote filesystem, if the read from the remote
+  ///    filesystem failed.
+  /// 2) OUT_OF_RANGE if the read from the remote filesystem succeeded, but
+  ///    the file contents do not extend past `offset` and thus nothing was
+  ///    placed in `out`.
+  /// 3) OK otherwise (i.e. the read succeeded, and at least one byte was placed
+  ///    in `out`).
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  // Validate the given file signature with the existing file signature in the
+  // cache. Returns true if the signature doesn't change or the file doesn't
+  // exist before. If the signature changes, drop the cached blocks of the file
+  // and return false.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached blocks for `filename`.
+  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached data.
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return 0; }
+
+  /// The current size (in bytes) of the cache.
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the cache is enabled, i.e. if its directory could be
+  // created and both its block size and max bytes are positive.
+  bool IsCacheEnabled() const override { return enabled_; }
+
+ private:
+  /// The name of the file in cache_dir_ holding the block at `offset`.
+  string BlockName(const string& filename, int64_t signature,
+                   size_t offset) const;
+
+  /// Reads the block at `offset` from the disk, or fetches and stores it.
+  Status ReadBlock(const string& filename, int64_t signature, size_t offset,
+                   string* data) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Writes a fetched block to the disk and adds it to the index.
+  void WriteBlock(const string& name, const string& data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Rebuilds the index from the blocks in cache_dir_, oldest first.
+  void LoadIndex() TF_LOCKS_EXCLUDED(mu_);
+
+  /// Moves the block to the front of the LRU list.
+  void Touch_Locked(const string& name) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Deletes a block from the index and the disk.
+  void Evict_Locked(const string& name) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Deletes the least recently used blocks until the cache fits max_bytes_.
+  void Trim_Locked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Deletes the blocks of all signatures of `filename`.
+  void RemoveFile_Locked(const string& filename)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string cache_dir_;
+  const size_t block_size_;
+  const size_t max_bytes_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;
+  bool enabled_ = false;
+
+  struct Entry {
+    size_t size;
+    std::list<string>::iterator lru_iterator;
+  };
+
+  mutable mutex mu_;
+
+  /// The blocks on the disk by name. Since names start with the hash of the
+  /// filename, the blocks of a file are contiguous.
+  std::map<string, Entry> index_ TF_GUARDED_BY(mu_);
+
+  /// The block names, most recently used first.
+  std::list<string> lru_list_ TF_GUARDED_BY(mu_);
+
+  /// The total size of the blocks in the index.
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The signatures of the files, by filename.
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+class DiskFileBlockCacheTest : public ::testing::Test {
+ protected:
+  DiskFileBlockCacheTest()
+      : cache_dir_(io::JoinPath(testing::TmpDir(), "disk_block_cache")) {
+    int64_t undeleted_files, undeleted_dirs;
+    Env::Default()
+        ->DeleteRecursively(cache_dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+
+  // Fills the buffer with the offsets of its bytes in a file of 40 bytes.
+  DiskFileBlockCache::BlockFetcher Fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      ++calls_;
+      size_t bytes = offset < 40 ? std::min<size_t>(n, 40 - offset) : 0;
+      for (size_t i = 0; i < bytes; ++i) {
+        buffer[i] = static_cast<char>(offset + i);
+      }
+      *bytes_transferred = bytes;
+      return OkStatus();
+    };
+  }
+
+  void ExpectOffsets(const std::vector<char>& out, size_t offset, size_t n) {
+    ASSERT_EQ(out.size(), n);
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(out[i], static_cast<char>(offset + i));
+    }
+  }
+
+  const string cache_dir_;
+  int calls_ = 0;
+};
+
+TEST_F(DiskFileBlockCacheTest, IsCacheEnabled) {
+  DiskFileBlockCache cache1(cache_dir_, 0, 32, Fetcher());
+  DiskFileBlockCache cache2(cache_dir_, 16, 0, Fetcher());
+  DiskFileBlockCache cache3("", 16, 32, Fetcher());
+  DiskFileBlockCache cache4(cache_dir_, 16, 32, Fetcher());
+
+  EXPECT_FALSE(cache1.IsCacheEnabled());
+  EXPECT_FALSE(cache2.IsCacheEnabled());
+  EXPECT_FALSE(cache3.IsCacheEnabled());
+  EXPECT_TRUE(cache4.IsCacheEnabled());
+}
+
+TEST_F(DiskFileBlockCacheTest, UnknownSignatureBypassesCache) {
+  DiskFileBlockCache cache(cache_dir_, 16, 64, Fetcher());
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "file", 3, 5, &out));
+  ExpectOffsets(out, 3, 5);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 3, 5, &out));
+  EXPECT_EQ(calls_, 2);
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
+TEST_F(DiskFileBlockCacheTest, ReadsBlocksFromDisk) {
+  std::vector<char> out;
+  {
+    DiskFileBlockCache cache(cache_dir_, 16, 64, Fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+    // Reads blocks 0 and 1.
+    TF_EXPECT_OK(ReadCache(&cache, "file", 10, 12, &out));
+    ExpectOffsets(out, 10, 12);
+    EXPECT_EQ(calls_, 2);
+    // Reads block 1 again, and the partial block 2.
+    TF_EXPECT_OK(ReadCache(&cache, "file", 20, 30, &out));
+    ExpectOffsets(out, 20, 20);
+    EXPECT_EQ(calls_, 3);
+    EXPECT_TRUE(errors::IsOutOfRange(ReadCache(&cache, "file", 40, 8, &out)));
+    EXPECT_EQ(calls_, 3);
+    EXPECT_EQ(cache.CacheSize(), 40);
+  }
+  // A new cache over the same directory reuses the blocks.
+  DiskFileBlockCache cache(cache_dir_, 16, 64, Fetcher());
+  EXPECT_EQ(cache.CacheSize(), 40);
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 40, &out));
+  ExpectOffsets(out, 0, 40);
+  EXPECT_EQ(calls_, 3);
+
+  // A new signature drops the blocks of the file.
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("file", 2));
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(calls_, 4);
+}
+
+TEST_F(DiskFileBlockCacheTest, EvictsLeastRecentlyUsedBlocks) {
+  DiskFileBlockCache cache(cache_dir_, 16, 32, Fetcher());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("b", 1));
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls_, 2);
+  // Evicts the block of "b".
+  TF_EXPECT_OK(ReadCache(&cache, "a", 16, 16, &out));
+  EXPECT_EQ(cache.CacheSize(), 32);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls_, 3);
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls_, 4);
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir_, &children));
+  EXPECT_EQ(children.size(), 2);
+
+  cache.RemoveFile("b");
+  EXPECT_EQ(cache.CacheSize(), 16);
+  cache.Flush();
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir_, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+}  // namespace
+}  // namespace tsl
@@ -30,6 +30,7 @@ limitations under the License.
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,6 +43,7 @@ limitations under the License.
 #include "absl/base/macros.h"
 #include "json/json.h"
 #include "tsl/platform/cloud/curl_http_request.h"
+#include "tsl/platform/cloud/disk_file_block_cache.h"
 #include "tsl/platform/cloud/file_block_cache.h"
 #include "tsl/platform/cloud/google_auth_provider.h"
 #include "tsl/platform/cloud/ram_file_block_cache.h"
@@ -56,6 +58,7 @@ limitations under the License.
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/stringprintf.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 #ifdef _WIN32
@@ -163,6 +166,14 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that enables parallel composite uploads of new
+// files, in parts of the given size in MB. The parts are uploaded to temporary
+// objects in the background while the file is written, and composed into the
+// object on the first Flush() or Close(). Disabled (0) by default.
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+// The maximum number of source objects of a compose request.
+constexpr size_t kMaxComposeSources = 32;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return OkStatus();
@@ -472,6 +483,7 @@ class GcsWritableFile : public WritableFile {
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
                   RetryConfig retry_config, bool compose_append,
+                  uint64 upload_part_size, int max_pending_parts,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
                   GenerationGetter generation_getter)
@@ -484,6 +496,8 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        upload_part_size_(upload_part_size),
+        max_pending_parts_(max_pending_parts),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
@@ -518,6 +532,8 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        upload_part_size_(0),
+        max_pending_parts_(0),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
@@ -531,6 +547,8 @@ class GcsWritableFile : public WritableFile {
 
   ~GcsWritableFile() override {
     Close().IgnoreError();
+    // Waits for the parts still being uploaded if Close() failed.
+    upload_pool_.reset();
     std::remove(tmp_content_filename_.c_str());
   }
 
@@ -543,6 +561,13 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (upload_part_size_ > 0) {
+      part_buffer_.append(data.data(), data.size());
+      while (part_buffer_.size() >= upload_part_size_) {
+        StartPartUpload(part_buffer_.substr(0, upload_part_size_));
+        part_buffer_.erase(0, upload_part_size_);
+      }
+    }
     return OkStatus();
   }
 
@@ -602,6 +627,14 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    if (!part_objects_.empty()) {
+      Status status = SyncParts();
+      if (status.ok()) return OkStatus();
+      // The whole file is still in the temporary file, so it is uploaded as
+      // usual below.
+      LOG(WARNING) << "Parallel composite upload to " << GetGcsPath()
+                   << " failed, uploading the whole file: " << status;
+    }
     UploadSessionHandle session_handle;
     uint64 start_offset = 0;
     string object_to_upload = object_;
@@ -611,9 +644,9 @@ class GcsWritableFile : public WritableFile {
       // Only compose if the object has already been uploaded to GCS
       should_compose = start_offset > 0;
       if (should_compose) {
-        object_to_upload =
-            strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
-                            io::Basename(object_), ".", start_offset_);
+        object_to_upload = io::JoinPath(
+            io::Dirname(object_), ".tmpcompose",
+            strings::StrCat(io::Basename(object_), ".", start_offset_));
       }
     }
     TF_RETURN_IF_ERROR(CreateNewUploadSession(start_offset, object_to_upload,
@@ -661,6 +694,128 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  /// Uploads `data`, the next part of the file, to a temporary object from
+  /// upload_pool_. Blocks while max_pending_parts_ parts are uploading, so that
+  /// a file written faster than it uploads does not buffer all its parts.
+  void StartPartUpload(string data) {
+    if (upload_pool_ == nullptr) {
+      upload_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(), "gcs_upload_parts", max_pending_parts_);
+    }
+    {
+      mutex_lock l(parts_mu_);
+      while (num_pending_parts_ >= max_pending_parts_) {
+        parts_cv_.wait(l);
+      }
+      ++num_pending_parts_;
+    }
+    const string part_object = io::JoinPath(
+        io::Dirname(object_), ".tmpcompose",
+        strings::StrCat(io::Basename(object_), ".part", part_objects_.size()));
+    part_objects_.push_back(part_object);
+    upload_pool_->Schedule([this, part_object, data = std::move(data)]() {
+      Status status = RetryingUtils::CallWithRetries(
+          [this, &part_object, &data]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+            request->SetUri(strings::StrCat(
+                kGcsUploadUriBase, "b/", bucket_, "/o?uploadType=media&name=",
+                request->EscapeString(part_object)));
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->write);
+            request->SetPostFromBuffer(data.data(), data.size());
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(
+                request->Send(), " when uploading ",
+                GetGcsPathWithObject(part_object));
+            return OkStatus();
+          },
+          retry_config_);
+      mutex_lock l(parts_mu_);
+      parts_status_.Update(status);
+      --num_pending_parts_;
+      parts_cv_.notify_one();
+    });
+  }
+
+  /// Uploads the rest of the file as its last part, waits for the parts, and
+  /// composes them into the object. Later syncs upload the whole file.
+  Status SyncParts() {
+    if (!part_buffer_.empty()) StartPartUpload(std::move(part_buffer_));
+    part_buffer_.clear();
+    upload_part_size_ = 0;
+    upload_pool_.reset();
+    std::vector<string> part_objects;
+    part_objects.swap(part_objects_);
+    Status status;
+    {
+      mutex_lock l(parts_mu_);
+      status = parts_status_;
+    }
+    if (status.ok()) status = ComposeParts(part_objects);
+    for (const string& part_object : part_objects) {
+      const string part_object_path = GetGcsPathWithObject(part_object);
+      RetryingUtils::DeleteWithRetries(
+          [&part_object_path, this]() {
+            return filesystem_->DeleteFile(part_object_path, nullptr);
+          },
+          retry_config_)
+          .IgnoreError();
+    }
+    TF_RETURN_IF_ERROR(status);
+    file_cache_erase_();
+    return GetCurrentFileSize(&start_offset_);
+  }
+
+  /// Composes `part_objects`, in order, into the object.
+  Status ComposeParts(const std::vector<string>& part_objects) {
+    VLOG(3) << "ComposeParts: " << part_objects.size() << " parts to "
+            << GetGcsPath();
+    size_t num_composed = 0;
+    while (num_composed < part_objects.size()) {
+      // A compose request takes at most kMaxComposeSources sources, so the
+      // object composed so far is a source of the following requests. Like in
+      // AppendObject(), its generation must match, so that a retried request
+      // does not append the same parts twice.
+      string sources;
+      size_t num_sources = 0;
+      if (num_composed > 0) {
+        int64_t generation = 0;
+        TF_RETURN_IF_ERROR(
+            generation_getter_(GetGcsPath(), bucket_, object_, &generation));
+        sources = strings::StrCat(
+            "{'name': '", object_,
+            "','objectPrecondition':{'ifGenerationMatch':", generation, "}}");
+        ++num_sources;
+      }
+      for (; num_sources < kMaxComposeSources &&
+             num_composed < part_objects.size();
+           ++num_sources, ++num_composed) {
+        strings::StrAppend(&sources, sources.empty() ? "" : ",", "{'name': '",
+                           part_objects[num_composed], "'}");
+      }
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [&sources, this]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+            request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                            request->EscapeString(object_),
+                                            "/compose"));
+            const string request_body =
+                strings::StrCat("{'sourceObjects': [", sources, "]}");
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->metadata);
+            request->AddHeader("content-type", "application/json");
+            request->SetPostFromBuffer(request_body.c_str(),
+                                       request_body.size());
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(
+                request->Send(), " when composing to ", GetGcsPath());
+            return OkStatus();
+          },
+          retry_config_));
+    }
+    return OkStatus();
+  }
+
   Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -776,6 +931,19 @@ class GcsWritableFile : public WritableFile {
   RetryConfig retry_config_ = GetGcsRetryConfig();
   bool compose_append_;
   uint64 start_offset_;
+  // The size of the parts of a parallel composite upload, or 0.
+  uint64 upload_part_size_;
+  // The maximum number of parts uploading at the same time.
+  const int max_pending_parts_;
+  // The data appended since the last part was uploaded.
+  string part_buffer_;
+  // The temporary objects of the parts uploaded so far, in order.
+  std::vector<string> part_objects_;
+  std::unique_ptr<thread::ThreadPool> upload_pool_;
+  mutex parts_mu_;
+  condition_variable parts_cv_;
+  int num_pending_parts_ TF_GUARDED_BY(parts_mu_) = 0;
+  Status parts_status_ TF_GUARDED_BY(parts_mu_);
   // Callbacks to the file system used to upload object into GCS.
   const SessionCreator session_creator_;
   const ObjectUploader object_uploader_;
@@ -855,6 +1023,26 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
           << "max staleness = " << max_staleness;
+  StringPiece disk_cache_dir;
+  if (make_default_cache &&
+      GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir)) {
+    size_t disk_max_bytes = kDefaultDiskCacheMaxSize;
+    if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &value)) {
+      disk_max_bytes = value * 1024 * 1024;
+    }
+    VLOG(1) << "GCS disk cache dir = " << disk_cache_dir << " ; "
+            << "max size = " << disk_max_bytes;
+    disk_block_cache_ = std::make_unique<DiskFileBlockCache>(
+        string(disk_cache_dir), block_size_, disk_max_bytes,
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromGCS(filename, offset, n, buffer,
+                                   bytes_transferred);
+        });
+    if (!disk_block_cache_->IsCacheEnabled()) {
+      disk_block_cache_.reset();
+    }
+  }
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -976,6 +1164,10 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     compose_append_ = false;
   }
 
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    upload_part_size_ = value * 1024 * 1024;
+  }
+
   retry_config_ = GetGcsRetryConfig();
 }
 
@@ -1031,6 +1223,10 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      if (disk_block_cache_ != nullptr) {
+        disk_block_cache_->ValidateAndUpdateFileSignature(
+            fname, stat.generation_number);
+      }
       *result = StringPiece();
       size_t bytes_transferred;
       TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
@@ -1078,16 +1274,28 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  size_t readahead_blocks = kDefaultReadaheadBlocks;
+  uint64 value;
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_blocks = value;
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
+        if (disk_block_cache_ != nullptr) {
+          return disk_block_cache_->Read(filename, offset, n, buffer,
+                                         bytes_transferred);
+        }
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), readahead_blocks));
 
-  // Check if cache is enabled here to avoid unnecessary mutex contention.
-  cache_enabled_ = file_block_cache->IsCacheEnabled();
+  // Check if cache is enabled here to avoid unnecessary mutex contention. A
+  // disabled RAM cache passes the reads through to the disk tier.
+  cache_enabled_ =
+      file_block_cache->IsCacheEnabled() || disk_block_cache_ != nullptr;
   return file_block_cache;
 }
 
@@ -1303,6 +1511,9 @@ Status GcsFileSystem::ParseGcsPath(StringPiece fname, bool empty_object_ok,
 void GcsFileSystem::ClearFileCaches(const string& fname) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->RemoveFile(fname);
+  if (disk_block_cache_ != nullptr) {
+    disk_block_cache_->RemoveFile(fname);
+  }
   stat_cache_->Delete(fname);
   // TODO(rxsang): Remove the patterns that matche the file in
   // MatchingPathsCache as well.
@@ -1350,8 +1561,8 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
-      compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      compose_append_, upload_part_size_, max_pending_upload_parts_,
+      session_creator, object_uploader, status_poller, generation_getter));
   return OkStatus();
 }
 
@@ -2115,6 +2326,9 @@ Status GcsFileSystem::DeleteRecursively(const string& dirname,
 void GcsFileSystem::FlushCaches(TransactionToken* token) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->Flush();
+  if (disk_block_cache_ != nullptr) {
+    disk_block_cache_->Flush();
+  }
   stat_cache_->Clear();
   matching_paths_cache_->Clear();
   bucket_location_cache_->Clear();
@@ -2128,6 +2342,12 @@ void GcsFileSystem::SetStats(GcsStatsInterface* stats) {
   stats_->Configure(this, &throttle_, file_block_cache_.get());
 }
 
+void GcsFileSystem::SetParallelUploads(uint64 part_size,
+                                       int max_pending_parts) {
+  upload_part_size_ = part_size;
+  max_pending_upload_parts_ = std::max(1, max_pending_parts);
+}
+
 void GcsFileSystem::SetCacheStats(FileBlockCacheStatsInterface* cache_stats) {
   tf_shared_lock l(block_cache_lock_);
   if (file_block_cache_ == nullptr) {
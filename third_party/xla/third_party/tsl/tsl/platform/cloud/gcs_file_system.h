@@ -62,6 +62,20 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of blocks fetched from GCS
+// ahead of sequential reads. Multi-block reads fetch their blocks in parallel
+// when it is set. A value of 0 (the default) disables reading ahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+constexpr size_t kDefaultReadaheadBlocks = 0;
+// The environment variable that sets a directory on a local disk (e.g. an SSD)
+// for a second tier of the block cache, below the one in memory. Its blocks are
+// keyed by object generation, so they stay valid across processes. The disk
+// tier is disabled when it is not set.
+constexpr char kDiskCacheDir[] = "GCS_DISK_CACHE_DIR";
+// The environment variable that overrides the max size of the disk tier of the
+// block cache. Specified in MB.
+constexpr char kDiskCacheMaxSize[] = "GCS_DISK_CACHE_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 10240LL * 1024LL * 1024LL;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -195,6 +209,11 @@ class GcsFileSystem : public FileSystem {
   /// Set an object to collect file block cache stats.
   void SetCacheStats(FileBlockCacheStatsInterface* cache_stats);
 
+  /// Uploads new files in parts of `part_size` bytes while they are written,
+  /// with at most `max_pending_parts` parts uploading at the same time. A
+  /// `part_size` of 0 disables the parallel composite uploads.
+  void SetParallelUploads(uint64 part_size, int max_pending_parts);
+
   /// These accessors are mainly for testing purposes, to verify that the
   /// environment variables that control these parameters are handled correctly.
   size_t block_size() {
@@ -421,6 +440,10 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<FileBlockCache> file_block_cache_
       TF_GUARDED_BY(block_cache_lock_);
 
+  // The blocks missing from file_block_cache_ are read through this local disk
+  // cache when it is set. It is only set at construction.
+  std::unique_ptr<FileBlockCache> disk_block_cache_;
+
   bool cache_enabled_;
   std::unique_ptr<GcsDnsCache> dns_cache_;
   GcsThrottle throttle_;
@@ -435,6 +458,10 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  // The part size of the parallel composite uploads of new files, or 0.
+  uint64 upload_part_size_ = 0;
+  // The maximum number of parts of a file uploading at the same time.
+  int max_pending_upload_parts_ = 8;
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
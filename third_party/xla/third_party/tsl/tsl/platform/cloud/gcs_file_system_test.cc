@@ -19,7 +19,9 @@ limitations under the License.
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/cloud/http_request_fake.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/notification.h"
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
@@ -1331,6 +1333,161 @@ TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
       fs.NewWritableFile("gs://bucket/", nullptr, &file)));
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUploadOfSinglePart) {
+  std::vector<HttpRequest*> requests(
+      {// The part is uploaded while the file is written.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: content1\n",
+           ""),
+       // It is composed into the object on close, and deleted.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "writeable/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'.tmpcompose/writeable.part0'}]}\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           ".tmpcompose%2Fwriteable.part0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetParallelUploads(/*part_size=*/8, /*max_pending_parts=*/1);
+
+  // An object at the root of the bucket has its parts at the root as well.
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
+// A FakeHttpRequest whose Send() notifies `started` and then waits for
+// `unblock`.
+class BlockingFakeHttpRequest : public FakeHttpRequest {
+ public:
+  BlockingFakeHttpRequest(const string& request, Notification* started,
+                          Notification* unblock)
+      : FakeHttpRequest(request, ""), started_(started), unblock_(unblock) {}
+
+  Status Send() override {
+    started_->Notify();
+    unblock_->WaitForNotification();
+    return FakeHttpRequest::Send();
+  }
+
+ private:
+  Notification* started_;
+  Notification* unblock_;
+};
+
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUploadOfSequentialParts) {
+  Notification part0_started;
+  Notification unblock_part0;
+  std::vector<HttpRequest*> requests(
+      {new BlockingFakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: content1\n",
+           &part0_started, &unblock_part0),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part1\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: content2\n",
+           ""),
+       // The rest of the file is uploaded as the last part on close.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part2\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: ,end\n",
+           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2Fwriteable/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'path/.tmpcompose/writeable.part0'},{'name': "
+                           "'path/.tmpcompose/writeable.part1'},{'name': "
+                           "'path/.tmpcompose/writeable.part2'}]}\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part2\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // With one pending part, the parts upload one after the other.
+  fs.SetParallelUploads(/*part_size=*/8, /*max_pending_parts=*/1);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1"));
+  part0_started.WaitForNotification();
+  // The next part waits for the upload of the first one.
+  Notification appended;
+  std::unique_ptr<Thread> writer(
+      Env::Default()->StartThread(ThreadOptions(), "writer", [&]() {
+        TF_EXPECT_OK(wfile->Append("content2,end"));
+        appended.Notify();
+      }));
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&appended, 100 * 1000));
+  unblock_part0.Notify();
+  appended.WaitForNotification();
+  writer.reset();
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewAppendableFile) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tsl/platform/env.h"
@@ -33,13 +36,16 @@ bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
 }
 
 std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
-    const Key& key) {
+    const Key& key, bool prefetch) {
   mutex_lock lock(mu_);
   auto entry = block_map_.find(key);
   if (entry != block_map_.end()) {
     if (BlockNotStale(entry->second)) {
-      if (cache_stats_ != nullptr) {
-        cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
+      if (!prefetch) {
+        if (cache_stats_ != nullptr) {
+          cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
+        }
+        if (fetch_pool_ != nullptr) ++file_stats_[key.first].hits;
       }
       return entry->second;
     } else {
@@ -57,6 +63,10 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   new_entry->lra_iterator = lra_list_.begin();
   new_entry->timestamp = env_->NowSeconds();
   block_map_.emplace(std::make_pair(key, new_entry));
+  if (fetch_pool_ != nullptr) {
+    FileStats& stats = file_stats_[key.first];
+    ++(prefetch ? stats.prefetches : stats.misses);
+  }
   return new_entry;
 }
 
@@ -84,12 +94,16 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // incomplete reads may still go undetected. The blocks read ahead past the
+  // end of the file are empty.
   if (block->data.size() < block_size_) {
-    Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    for (auto it = block_map_.upper_bound(key);
+         it != block_map_.end() && it->first.first == key.first; ++it) {
+      mutex_lock l(it->second->mu);
+      if (it->second->state == FetchState::FINISHED &&
+          !it->second->data.empty()) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -167,6 +181,46 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
       "Control flow should never reach the end of RamFileBlockCache::Fetch.");
 }
 
+void RamFileBlockCache::FetchAsync(const Key& key,
+                                   std::shared_ptr<Block> block) {
+  {
+    mutex_lock l(block->mu);
+    if (block->state != FetchState::CREATED) return;
+  }
+  fetch_pool_->Schedule([this, key, block = std::move(block)]() {
+    Status status = MaybeFetch(key, block);
+    if (status.ok()) status = UpdateLRU(key, block);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to fetch block " << key.first << "@" << key.second
+              << " in the background: " << status;
+    }
+  });
+}
+
+void RamFileBlockCache::MaybeReadAhead(const string& filename, size_t offset,
+                                       size_t n, size_t finish) {
+  {
+    mutex_lock lock(mu_);
+    auto it = read_ends_.find(filename);
+    const bool sequential =
+        offset == 0 || (it != read_ends_.end() && it->second == offset);
+    read_ends_[filename] = offset + n;
+    if (!sequential) return;
+  }
+  // Reading ahead more than half of the cache would evict the blocks before
+  // they are read.
+  const size_t num_blocks =
+      std::min(num_readahead_blocks_, max_bytes_ / block_size_ / 2);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    Key key = std::make_pair(filename, finish + i * block_size_);
+    {
+      mutex_lock lock(mu_);
+      if (block_map_.count(key) > 0) continue;
+    }
+    FetchAsync(key, Lookup(key, /*prefetch=*/true));
+  }
+}
+
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
   *bytes_transferred = 0;
@@ -184,13 +238,25 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  std::vector<std::shared_ptr<Block>> blocks;
+  if (fetch_pool_ != nullptr) {
+    // Look up all the blocks first, and fetch the missing ones but the first
+    // in the background, so that the fetches overlap.
+    for (size_t pos = start; pos < finish; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      blocks.push_back(Lookup(key));
+      if (pos != start) FetchAsync(key, blocks.back());
+    }
+    MaybeReadAhead(filename, offset, n, finish);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
     // Look up the block, fetching and inserting it if necessary, and update the
     // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
+    std::shared_ptr<Block> block =
+        blocks.empty() ? Lookup(key) : blocks[(pos - start) / block_size_];
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
@@ -251,6 +317,13 @@ size_t RamFileBlockCache::CacheSize() const {
   return cache_size_;
 }
 
+RamFileBlockCache::FileStats RamFileBlockCache::GetFileStats(
+    const string& filename) const {
+  mutex_lock lock(mu_);
+  auto it = file_stats_.find(filename);
+  return it == file_stats_.end() ? FileStats() : it->second;
+}
+
 void RamFileBlockCache::Prune() {
   while (!WaitForNotificationWithTimeout(&stop_pruning_thread_, 1000000)) {
     mutex_lock lock(mu_);
@@ -274,6 +347,8 @@ void RamFileBlockCache::Flush() {
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  read_ends_.clear();
+  file_stats_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -289,6 +364,8 @@ void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
     RemoveBlock(it);
     it = next;
   }
+  read_ends_.erase(filename);
+  file_stats_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
@@ -298,7 +375,15 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   lru_list_.erase(entry->second->lru_iterator);
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
+  // Drops the read state of the file along with its last block, so that it is
+  // bounded by the number of cached files.
+  const string filename = entry->first.first;
   block_map_.erase(entry);
+  auto it = block_map_.lower_bound(std::make_pair(filename, size_t{0}));
+  if (it == block_map_.end() || it->first.first != filename) {
+    read_ends_.erase(filename);
+    file_stats_.erase(filename);
+  }
 }
 
 }  // namespace tsl
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -50,22 +51,34 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// With `num_readahead_blocks` > 0, the blocks of a read spanning several
+  /// blocks are fetched in parallel, and sequential reads of a file, i.e. the
+  /// reads at its start or at the end of the previous read, fetch the next
+  /// `num_readahead_blocks` blocks in the background.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t num_readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        num_readahead_blocks_(num_readahead_blocks) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && num_readahead_blocks_ > 0) {
+      fetch_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_fetch_FBC", num_readahead_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Waits for the blocks being fetched in the background.
+    fetch_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -113,6 +126,18 @@ class RamFileBlockCache : public FileBlockCache {
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
 
+  /// The numbers of blocks of a file that reads found in the cache, that
+  /// reads fetched, and that were fetched ahead of the reads.
+  struct FileStats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t prefetches = 0;
+  };
+
+  /// Returns the stats of the reads of `filename` since its blocks were last
+  /// removed from the cache. Stats are only kept when reading ahead.
+  FileStats GetFileStats(const string& filename) const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns true if the cache is enabled. If false, the BlockFetcher callback
   // is always executed during Read.
   bool IsCacheEnabled() const override {
@@ -131,6 +156,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The number of blocks to fetch ahead of sequential reads.
+  const size_t num_readahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -194,12 +221,23 @@ class RamFileBlockCache : public FileBlockCache {
   bool BlockNotStale(const std::shared_ptr<Block>& block)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  /// Look up a Key in the block cache.
-  std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
+  /// Look up a Key in the block cache. `prefetch` tells whether the block is
+  /// looked up to be fetched ahead of the reads.
+  std::shared_ptr<Block> Lookup(const Key& key, bool prefetch = false)
+      TF_LOCKS_EXCLUDED(mu_);
 
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Fetch the block at `key` from fetch_pool_, unless it is fetched already.
+  void FetchAsync(const Key& key, std::shared_ptr<Block> block)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// If the read of `n` bytes at `offset` of `filename` is sequential, fetch
+  /// the blocks that follow `finish`, the end of its last block.
+  void MaybeReadAhead(const string& filename, size_t offset, size_t n,
+                      size_t finish) TF_LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -243,6 +281,15 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  // A filename->end of the last read map, to detect sequential reads.
+  std::map<string, size_t> read_ends_ TF_GUARDED_BY(mu_);
+
+  // A filename->stats map.
+  std::map<string, FileStats> file_stats_ TF_GUARDED_BY(mu_);
+
+  /// The threads fetching blocks in the background, if reading ahead.
+  std::unique_ptr<thread::ThreadPool> fetch_pool_;
 };
 
 }  // namespace tsl
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "tsl/lib/core/status_test_util.h"
@@ -566,5 +567,101 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+// Returns a fetcher of a file of `file_size` bytes whose i-th byte is i % 256.
+RamFileBlockCache::BlockFetcher FileFetcher(size_t file_size) {
+  return [file_size](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    *bytes_transferred =
+        offset < file_size ? std::min(n, file_size - offset) : 0;
+    for (size_t i = 0; i < *bytes_transferred; ++i) {
+      buffer[i] = static_cast<char>((offset + i) % 256);
+    }
+    return OkStatus();
+  };
+}
+
+TEST(RamFileBlockCacheTest, ReadsAheadOfSequentialReads) {
+  const size_t block_size = 16;
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, FileFetcher(1024),
+                          Env::Default(), /*num_readahead_blocks=*/2);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  RamFileBlockCache::FileStats stats = cache.GetFileStats("a");
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.prefetches, 2);
+
+  // The next block was read ahead.
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  ASSERT_EQ(out.size(), block_size);
+  EXPECT_EQ(out[0], static_cast<char>(block_size));
+  stats = cache.GetFileStats("a");
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.prefetches, 3);
+
+  // A random read does not read ahead.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 10 * block_size, block_size, &out));
+  stats = cache.GetFileStats("a");
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.prefetches, 3);
+  EXPECT_EQ(cache.GetFileStats("b").misses, 0);
+}
+
+TEST(RamFileBlockCacheTest, ReadsAheadPastEndOfFile) {
+  const size_t block_size = 16;
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, FileFetcher(20),
+                          Env::Default(), /*num_readahead_blocks=*/4);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size, &out));
+  EXPECT_EQ(out.size(), block_size);
+  // The empty blocks read ahead past the end of the file do not make the last,
+  // partial block inconsistent.
+  TF_EXPECT_OK(ReadCache(&cache, "", block_size, block_size, &out));
+  EXPECT_EQ(out.size(), 4);
+  EXPECT_EQ(ReadCache(&cache, "", 2 * block_size, block_size, &out).code(),
+            error::OUT_OF_RANGE);
+}
+
+TEST(RamFileBlockCacheTest, FetchesBlocksOfReadInParallel) {
+  const size_t block_size = 16;
+  BlockingCounter counter(2);
+  auto fetcher = [&counter, block_size](const string& filename, size_t offset,
+                                        size_t n, char* buffer,
+                                        size_t* bytes_transferred) {
+    if (offset < 2 * block_size) {
+      // Both blocks of the read are fetched at the same time.
+      counter.DecrementCount();
+      EXPECT_TRUE(counter.WaitFor(std::chrono::milliseconds(10000)));
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(), /*num_readahead_blocks=*/2);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, 2 * block_size, &out));
+  EXPECT_EQ(out.size(), 2 * block_size);
+}
+
+TEST(RamFileBlockCacheTest, DropsFileStatsWithBlocks) {
+  const size_t block_size = 16;
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, FileFetcher(1024),
+                          Env::Default(), /*num_readahead_blocks=*/2);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  EXPECT_EQ(cache.GetFileStats("a").misses, 1);
+  cache.RemoveFile("a");
+  EXPECT_EQ(cache.GetFileStats("a").misses, 0);
+  EXPECT_EQ(cache.GetFileStats("a").prefetches, 0);
+
+  // Without reading ahead, no stats are kept.
+  RamFileBlockCache no_readahead_cache(block_size, 16 * block_size, 0,
+                                       FileFetcher(1024), Env::Default());
+  TF_EXPECT_OK(ReadCache(&no_readahead_cache, "a", 0, block_size, &out));
+  EXPECT_EQ(no_readahead_cache.GetFileStats("a").misses, 0);
+}
+
 }  // namespace
 }  // namespace tsl